@@ -0,0 +1,100 @@
+// GameOverlay - AdaptiveResolution.cpp
+// Closed-loop render scale and browser quality control against an overlay GPU time budget
+
+#include "AdaptiveResolution.h"
+#include <algorithm>
+#include <cmath>
+
+void AdaptiveResolutionController::Configure(float budgetMs, float minScale, float maxScale) {
+    m_budgetMs = std::max(budgetMs, 0.1f);
+    m_minScale = std::clamp(minScale, 0.25f, 1.0f);
+    m_maxScale = std::clamp(maxScale, m_minScale, 1.0f);
+    m_scale = std::clamp(m_scale, m_minScale, m_maxScale);
+    m_appliedScale = std::clamp(m_appliedScale, m_minScale, m_maxScale);
+    m_appliedBrowserQuality = std::clamp(m_appliedBrowserQuality, m_minScale, m_maxScale);
+}
+
+void AdaptiveResolutionController::Reset(float scale) {
+    m_scale = std::clamp(scale, m_minScale, m_maxScale);
+    m_integral = m_scale / KI; // Bumpless: with no error the output holds the scale
+    m_previousError = 0.0f;
+    m_hasSample = false;
+    m_started = false;
+    m_appliedScale = Quantize(m_scale, SCALE_STEP);
+    m_appliedBrowserQuality = Quantize(m_scale, BROWSER_QUALITY_STEP);
+    m_browserCandidate = m_appliedBrowserQuality;
+}
+
+float AdaptiveResolutionController::Quantize(float value, float step) const {
+    float quantized = std::round(value / step) * step;
+    return std::clamp(quantized, m_minScale, m_maxScale);
+}
+
+bool AdaptiveResolutionController::AddSample(float gpuFrameMs, std::chrono::steady_clock::time_point now) {
+    if (gpuFrameMs <= 0.0f) return false;
+
+    m_filteredGpuMs = m_hasSample ? m_filteredGpuMs + (gpuFrameMs - m_filteredGpuMs) * SAMPLE_SMOOTHING : gpuFrameMs;
+    m_hasSample = true;
+
+    if (!m_started) {
+        m_started = true;
+        m_lastControlTime = now;
+        m_scaleCandidateSince = now;
+        m_browserCandidateSince = now;
+        return false;
+    }
+    auto sinceControl = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastControlTime);
+    if (sinceControl.count() < CONTROL_INTERVAL_MS) return false;
+    float dt = std::min(sinceControl.count() / 1000.0f, 1.0f);
+    m_lastControlTime = now;
+
+    // Positive with headroom, negative over budget
+    float error = std::clamp((m_budgetMs - m_filteredGpuMs) / m_budgetMs, -1.0f, 1.0f);
+    float derivative = (error - m_previousError) / dt;
+    m_previousError = error;
+
+    float integral = m_integral + error * dt;
+    float output = KP * error + KI * integral + KD * derivative;
+    float scale = std::clamp(output, m_minScale, m_maxScale);
+    // Anti-windup: stop integrating while pinned at a limit in the error's direction
+    if (output == scale || (output > m_maxScale) != (error > 0.0f)) {
+        m_integral = integral;
+    }
+    m_scale = scale;
+
+    bool changed = false;
+
+    // Render scale: down as soon as the continuous scale is most of a step below, up only
+    // once it has stayed a step above for RAISE_HOLD_MS
+    float stepped = Quantize(m_scale, SCALE_STEP);
+    if (m_scale <= m_appliedScale - SCALE_STEP * 0.75f) {
+        changed = stepped != m_appliedScale;
+        m_appliedScale = stepped;
+        m_scaleCandidateSince = now;
+    }
+    else if (m_scale >= m_appliedScale + SCALE_STEP * 0.75f) {
+        if (now - m_scaleCandidateSince >= std::chrono::milliseconds(RAISE_HOLD_MS)) {
+            changed = stepped != m_appliedScale;
+            m_appliedScale = stepped;
+            m_scaleCandidateSince = now;
+        }
+    }
+    else {
+        m_scaleCandidateSince = now;
+    }
+
+    // Browser quality follows the same loop in coarser steps with longer holds
+    float browserStepped = Quantize(m_scale, BROWSER_QUALITY_STEP);
+    if (browserStepped != m_browserCandidate) {
+        m_browserCandidate = browserStepped;
+        m_browserCandidateSince = now;
+    }
+    if (m_browserCandidate != m_appliedBrowserQuality) {
+        int64_t hold = m_browserCandidate < m_appliedBrowserQuality ? BROWSER_LOWER_HOLD_MS : BROWSER_RAISE_HOLD_MS;
+        if (now - m_browserCandidateSince >= std::chrono::milliseconds(hold)) {
+            m_appliedBrowserQuality = m_browserCandidate;
+            changed = true;
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,71 @@
+// GameOverlay - AdaptiveResolution.h
+// Closed-loop render scale and browser quality control against an overlay GPU time budget
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// A PID loop on the overlay's GPU frame time (timestamp queries, so it lags by the readback
+// latency). The error is the budget headroom as a fraction of the budget; the output is a
+// continuous scale, which is only applied in steps and with hysteresis: each render scale step
+// re-creates the scaled render target and each browser quality step resizes CEF's view, so
+// small corrections are absorbed and raising the scale waits for the headroom to last.
+class AdaptiveResolutionController {
+public:
+    static constexpr float SCALE_STEP = 0.05f;
+    static constexpr float BROWSER_QUALITY_STEP = 0.125f;
+    static constexpr int64_t CONTROL_INTERVAL_MS = 100;
+    static constexpr int64_t RAISE_HOLD_MS = 1000;          // Before a render scale step up
+    static constexpr int64_t BROWSER_LOWER_HOLD_MS = 500;
+    static constexpr int64_t BROWSER_RAISE_HOLD_MS = 3000;
+
+    AdaptiveResolutionController() = default;
+    ~AdaptiveResolutionController() = default;
+
+    // Disable copy and move
+    AdaptiveResolutionController(const AdaptiveResolutionController&) = delete;
+    AdaptiveResolutionController& operator=(const AdaptiveResolutionController&) = delete;
+    AdaptiveResolutionController(AdaptiveResolutionController&&) = delete;
+    AdaptiveResolutionController& operator=(AdaptiveResolutionController&&) = delete;
+
+    void Configure(float budgetMs, float minScale, float maxScale);
+    // Restarts the loop from a scale (e.g. when the performance state changed the ceiling)
+    void Reset(float scale);
+
+    // One new GPU timing sample; true when the applied scale or browser quality moved
+    bool AddSample(float gpuFrameMs, std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    float GetScale() const { return m_appliedScale; }
+    float GetBrowserQuality() const { return m_appliedBrowserQuality; }
+    float GetContinuousScale() const { return m_scale; }
+    float GetFilteredGpuMs() const { return m_filteredGpuMs; }
+    float GetBudgetMs() const { return m_budgetMs; }
+
+private:
+    // Gains on the normalized error (headroom / budget); the integral carries the steady state
+    static constexpr float KP = 0.25f;
+    static constexpr float KI = 0.6f;  // Per second
+    static constexpr float KD = 0.02f; // Seconds
+    static constexpr float SAMPLE_SMOOTHING = 0.3f;
+
+    float Quantize(float value, float step) const;
+
+    float m_budgetMs = 4.0f;
+    float m_minScale = 0.5f;
+    float m_maxScale = 1.0f;
+
+    float m_filteredGpuMs = 0.0f;
+    bool m_hasSample = false;
+    float m_integral = 0.0f;
+    float m_previousError = 0.0f;
+    float m_scale = 1.0f;
+    std::chrono::steady_clock::time_point m_lastControlTime;
+    bool m_started = false;
+
+    float m_appliedScale = 1.0f;
+    float m_appliedBrowserQuality = 1.0f;
+    std::chrono::steady_clock::time_point m_scaleCandidateSince;    // Continuous scale above the applied one
+    std::chrono::steady_clock::time_point m_browserCandidateSince;  // Browser step differing from the applied one
+    float m_browserCandidate = 1.0f;
+};
@@ -0,0 +1,157 @@
+// GameOverlay - AllocationTracker.cpp
+// Heap allocation counts per frame and per profiler zone, for keeping the steady state allocation-free
+
+#include "AllocationTracker.h"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+std::atomic<bool> AllocationTracker::s_zoneAttribution{ false };
+
+namespace {
+
+// Constant-initialized, so touching them from operator new needs no thread-local constructor
+thread_local AllocationCounters t_counters;
+thread_local AllocationCounters t_attributed; // Already charged to a closed zone
+
+struct FrameZones {
+    ZoneAllocations zones[AllocationTracker::MAX_FRAME_ZONES];
+    size_t count = 0;
+};
+
+thread_local FrameZones t_currentZones;
+thread_local FrameZones t_lastZones;
+thread_local AllocationCounters t_frameStart;
+thread_local AllocationCounters t_lastFrame;
+
+AllocationCounters Subtract(const AllocationCounters& a, const AllocationCounters& b) {
+    return { a.allocations - b.allocations, a.bytes - b.bytes };
+}
+
+} // namespace
+
+bool AllocationTracker::IsCompiledIn() {
+#if GAMEOVERLAY_ALLOCATION_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocationCounters AllocationTracker::GetThreadCounters() {
+    return t_counters;
+}
+
+AllocationCounters AllocationTracker::EndFrame() {
+    const AllocationCounters now = t_counters;
+    t_lastFrame = Subtract(now, t_frameStart);
+    t_frameStart = now;
+
+    FrameZones& last = t_lastZones;
+    last = t_currentZones;
+    std::sort(last.zones, last.zones + last.count, [](const ZoneAllocations& a, const ZoneAllocations& b) {
+        return a.counters.allocations > b.counters.allocations;
+        });
+    t_currentZones.count = 0;
+    return t_lastFrame;
+}
+
+AllocationCounters AllocationTracker::GetLastFrame() {
+    return t_lastFrame;
+}
+
+size_t AllocationTracker::GetLastFrameZones(ZoneAllocations* zones, size_t capacity) {
+    const FrameZones& last = t_lastZones;
+    size_t count = std::min(capacity, last.count);
+    std::copy(last.zones, last.zones + count, zones);
+    return count;
+}
+
+void AllocationTracker::BeginZone(AllocationZoneMark& mark) {
+    mark.total = t_counters;
+    mark.attributed = t_attributed;
+}
+
+void AllocationTracker::EndZone(const char* name, const AllocationZoneMark& mark) {
+    // Inclusive minus what nested zones already took; the whole span then counts as attributed
+    // for the enclosing zone
+    const AllocationCounters inclusive = Subtract(t_counters, mark.total);
+    const AllocationCounters nested = Subtract(t_attributed, mark.attributed);
+    t_attributed.allocations = mark.attributed.allocations + inclusive.allocations;
+    t_attributed.bytes = mark.attributed.bytes + inclusive.bytes;
+
+    const AllocationCounters own = Subtract(inclusive, nested);
+    if (own.allocations == 0) return;
+
+    FrameZones& current = t_currentZones;
+    for (size_t i = 0; i < current.count; i++) {
+        if (current.zones[i].name == name) {
+            current.zones[i].counters.allocations += own.allocations;
+            current.zones[i].counters.bytes += own.bytes;
+            return;
+        }
+    }
+    if (current.count < MAX_FRAME_ZONES) {
+        current.zones[current.count++] = { name, own };
+    }
+}
+
+#if GAMEOVERLAY_ALLOCATION_TRACKING
+
+// --- Global Operator New/Delete ---
+// malloc/_aligned_malloc underneath, as the CRT's own versions use; the aligned forms must be
+// freed with _aligned_free, which is why every delete overload is replaced too.
+
+namespace {
+
+void* TrackedAllocate(size_t size, size_t alignment, bool nothrow) {
+    if (size == 0) size = 1;
+    for (;;) {
+        void* block = alignment > 0 ? _aligned_malloc(size, alignment) : malloc(size);
+        if (block) {
+            t_counters.allocations++;
+            t_counters.bytes += size;
+            return block;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            if (nothrow) return nullptr;
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+} // namespace
+
+void* operator new(size_t size) { return TrackedAllocate(size, 0, false); }
+void* operator new[](size_t size) { return TrackedAllocate(size, 0, false); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return TrackedAllocate(size, 0, true); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return TrackedAllocate(size, 0, true); }
+void* operator new(size_t size, std::align_val_t alignment) {
+    return TrackedAllocate(size, static_cast<size_t>(alignment), false);
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return TrackedAllocate(size, static_cast<size_t>(alignment), false);
+}
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return TrackedAllocate(size, static_cast<size_t>(alignment), true);
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return TrackedAllocate(size, static_cast<size_t>(alignment), true);
+}
+
+void operator delete(void* block) noexcept { free(block); }
+void operator delete[](void* block) noexcept { free(block); }
+void operator delete(void* block, size_t) noexcept { free(block); }
+void operator delete[](void* block, size_t) noexcept { free(block); }
+void operator delete(void* block, const std::nothrow_t&) noexcept { free(block); }
+void operator delete[](void* block, const std::nothrow_t&) noexcept { free(block); }
+void operator delete(void* block, std::align_val_t) noexcept { _aligned_free(block); }
+void operator delete[](void* block, std::align_val_t) noexcept { _aligned_free(block); }
+void operator delete(void* block, size_t, std::align_val_t) noexcept { _aligned_free(block); }
+void operator delete[](void* block, size_t, std::align_val_t) noexcept { _aligned_free(block); }
+void operator delete(void* block, std::align_val_t, const std::nothrow_t&) noexcept { _aligned_free(block); }
+void operator delete[](void* block, std::align_val_t, const std::nothrow_t&) noexcept { _aligned_free(block); }
+
+#endif // GAMEOVERLAY_ALLOCATION_TRACKING
@@ -0,0 +1,55 @@
+// GameOverlay - AllocationTracker.h
+// Heap allocation counts per frame and per profiler zone, for keeping the steady state allocation-free
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+struct AllocationCounters {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0; // Requested sizes
+};
+
+// Allocations made directly inside one zone on one thread (nested zones count their own)
+struct ZoneAllocations {
+    const char* name = nullptr;
+    AllocationCounters counters;
+};
+
+// Where a zone started; kept by CpuProfileZone
+struct AllocationZoneMark {
+    AllocationCounters total;
+    AllocationCounters attributed;
+};
+
+// Opt-in (GAMEOVERLAY_ALLOCATION_TRACKING): the executable then replaces the global operator
+// new/delete with versions that count every allocation into the allocating thread's counters,
+// a thread-local increment and no lock. Only this module's allocations are seen; CEF and the
+// D3D runtime use their own heaps. Without the option every query reports zero.
+// The frame and zone figures belong to the thread that calls EndFrame (the main loop) and are
+// read on it; zones are the PROFILE_ZONE scopes, attributed while zone attribution is enabled.
+class AllocationTracker {
+public:
+    static constexpr size_t MAX_FRAME_ZONES = 64; // Distinct allocating zones kept per frame
+
+    static bool IsCompiledIn();
+    static AllocationCounters GetThreadCounters(); // Running totals of the calling thread
+
+    // Frame boundary: what the calling thread allocated since the previous call
+    static AllocationCounters EndFrame();
+    static AllocationCounters GetLastFrame();
+    // The last frame's allocating zones, most allocations first; returns the count written
+    static size_t GetLastFrameZones(ZoneAllocations* zones, size_t capacity);
+
+    static void SetZoneAttributionEnabled(bool enabled) { s_zoneAttribution.store(enabled, std::memory_order_relaxed); }
+    static bool IsZoneAttributionEnabled() { return s_zoneAttribution.load(std::memory_order_relaxed); }
+
+    // Used by CpuProfileZone
+    static void BeginZone(AllocationZoneMark& mark);
+    static void EndZone(const char* name, const AllocationZoneMark& mark);
+
+private:
+    static std::atomic<bool> s_zoneAttribution;
+};
@@ -0,0 +1,982 @@
+// GameOverlay - Benchmarks.cpp
+// Microbenchmarks of the hot paths (GameOverlayBench), timed with <chrono>; no framework.
+// Each runs alone and, where more than one thread uses it, contended. Then the frame scenarios, whose
+// per-phase CPU and GPU times go to a JSON report (--json=path, GameOverlayBench.json by default).
+// --assert-zero-alloc fails the run (exit code 3) when a measured idle or repaint frame allocates.
+// Where the machine reports power (PowerSampler), each scenario is also run paced at 60 Hz for its watts.
+
+#include <Windows.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cfloat>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include "imgui.h"
+#include "PixelCopy.h"
+#include "HotkeyManager.h"
+#include "RenderSystem.h"
+#include "ResourceManager.h"
+#include "PipelineStateManager.h"
+#include "CommandAllocatorPool.h"
+#include "ImGuiSystem.h"
+#include "BrowserView.h"
+#include "JobSystem.h"
+#include "AllocationTracker.h"
+#include "PowerSampler.h"
+
+namespace {
+
+constexpr auto MIN_RUN_TIME = std::chrono::milliseconds(200);
+constexpr int RUNS = 5;
+constexpr unsigned MAX_CONTENDED_THREADS = 4;
+
+// Mean nanoseconds per call in the fastest of RUNS runs, each of at least MIN_RUN_TIME, after one
+// warm-up call
+template <typename Fn>
+double MeasureNs(Fn&& fn) {
+    fn();
+    double bestNs = DBL_MAX;
+    for (int run = 0; run < RUNS; run++) {
+        uint64_t calls = 0;
+        const auto start = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::duration elapsed;
+        do {
+            fn();
+            calls++;
+            elapsed = std::chrono::steady_clock::now() - start;
+        } while (elapsed < MIN_RUN_TIME);
+        bestNs = std::min(bestNs, std::chrono::duration<double, std::nano>(elapsed).count() / calls);
+    }
+    return bestNs;
+}
+
+// The contended variant: fn(thread) on every thread at once for MIN_RUN_TIME, the threads released
+// together. Mean nanoseconds per call on one thread, in the fastest of RUNS runs.
+template <typename Fn>
+double MeasureContendedNs(unsigned threadCount, Fn&& fn) {
+    double bestNs = DBL_MAX;
+    for (int run = 0; run < RUNS; run++) {
+        std::atomic<unsigned> ready{ 0 };
+        std::atomic<bool> go{ false };
+        std::atomic<bool> stop{ false };
+        std::vector<uint64_t> calls(threadCount, 0);
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < threadCount; t++) {
+            threads.emplace_back([&, t]() {
+                fn(t); // Warm-up
+                ready++;
+                while (!go.load(std::memory_order_acquire)) {
+                    YieldProcessor();
+                }
+                uint64_t count = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    fn(t);
+                    count++;
+                }
+                calls[t] = count;
+            });
+        }
+        while (ready.load() < threadCount) {
+            std::this_thread::yield();
+        }
+        const auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        std::this_thread::sleep_for(MIN_RUN_TIME);
+        stop = true;
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        const double elapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        uint64_t totalCalls = 0;
+        for (uint64_t count : calls) totalCalls += count;
+        if (totalCalls > 0) {
+            bestNs = std::min(bestNs, elapsedNs * threadCount / totalCalls);
+        }
+    }
+    return bestNs;
+}
+
+unsigned GetContendedThreadCount() {
+    return std::clamp(std::thread::hardware_concurrency(), 2u, MAX_CONTENDED_THREADS);
+}
+
+// bytes > 0 adds the throughput
+void Report(const char* name, double ns, double bytes = 0.0) {
+    if (bytes > 0.0) {
+        printf("%-56s %12.1f us %8.2f GB/s\n", name, ns / 1000.0, bytes / ns);
+    }
+    else {
+        printf("%-56s %12.1f ns\n", name, ns);
+    }
+}
+
+// --- Pixel Copy ---
+// Browser paints into an upload slot: per-row memcpy (what OnPaint did before CopyPixelRows)
+// against the SIMD kernel, into cached memory and into write-combined memory, which is what an
+// upload heap is on most GPUs. A full frame keeps the pitches equal; the half-width dirty rect
+// converts between CEF's tight pitch and the slot's.
+void BenchmarkPixelCopy() {
+    struct Resolution {
+        const char* name;
+        size_t width;
+        size_t height;
+    };
+    static const Resolution RESOLUTIONS[] = { { "1080p", 1920, 1080 }, { "1440p", 2560, 1440 }, { "4K", 3840, 2160 } };
+    constexpr size_t PITCH_ALIGNMENT = 256; // D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+
+    printf("Pixel copy kernel: %s\n", GetPixelCopyKernelName());
+    for (const Resolution& resolution : RESOLUTIONS) {
+        const size_t srcPitch = resolution.width * 4;
+        const size_t dstPitch = (srcPitch + PITCH_ALIGNMENT - 1) & ~(PITCH_ALIGNMENT - 1);
+        std::vector<uint8_t> src(srcPitch * resolution.height);
+        for (size_t i = 0; i < src.size(); i++) {
+            src[i] = static_cast<uint8_t>(i * 31 + (i >> 12));
+        }
+
+        for (bool writeCombined : { false, true }) {
+            const size_t dstBytes = dstPitch * resolution.height;
+            uint8_t* dst = static_cast<uint8_t*>(VirtualAlloc(nullptr, dstBytes, MEM_COMMIT | MEM_RESERVE,
+                PAGE_READWRITE | (writeCombined ? PAGE_WRITECOMBINE : 0)));
+            if (!dst) {
+                printf("%s: failed to allocate the destination\n", resolution.name);
+                continue;
+            }
+            const char* memory = writeCombined ? "write-combined" : "cached";
+
+            struct Region {
+                const char* name;
+                size_t rowBytes;
+                size_t rows;
+            };
+            const Region regions[] = {
+                { "frame", srcPitch, resolution.height },
+                { "half rect", srcPitch / 2, resolution.height / 2 },
+            };
+            for (const Region& region : regions) {
+                const double bytes = static_cast<double>(region.rowBytes * region.rows);
+                char name[96];
+                snprintf(name, sizeof(name), "memcpy rows, %s %s (%s)", resolution.name, region.name, memory);
+                Report(name, MeasureNs([&]() {
+                    for (size_t row = 0; row < region.rows; row++) {
+                        memcpy(dst + row * dstPitch, src.data() + row * srcPitch, region.rowBytes);
+                    }
+                }), bytes);
+
+                snprintf(name, sizeof(name), "CopyPixelRows, %s %s (%s)", resolution.name, region.name, memory);
+                Report(name, MeasureNs([&]() {
+                    CopyPixelRows(dst, dstPitch, src.data(), srcPitch, region.rowBytes, region.rows);
+                }), bytes);
+
+                snprintf(name, sizeof(name), "CopyPixelRows premultiplied, %s %s (%s)", resolution.name, region.name, memory);
+                Report(name, MeasureNs([&]() {
+                    CopyPixelRows(dst, dstPitch, src.data(), srcPitch, region.rowBytes, region.rows, true);
+                }), bytes);
+            }
+            VirtualFree(dst, 0, MEM_RELEASE);
+        }
+
+        // Several threads streaming frames at once (tile uploads, the widget atlas), each into
+        // its own write-combined slot
+        const unsigned threadCount = GetContendedThreadCount();
+        std::vector<uint8_t*> slots(threadCount, nullptr);
+        bool allocated = true;
+        for (uint8_t*& slot : slots) {
+            slot = static_cast<uint8_t*>(VirtualAlloc(nullptr, dstPitch * resolution.height, MEM_COMMIT | MEM_RESERVE,
+                PAGE_READWRITE | PAGE_WRITECOMBINE));
+            allocated = allocated && slot;
+        }
+        if (allocated) {
+            char name[96];
+            snprintf(name, sizeof(name), "CopyPixelRows, %s frame, %u threads (write-combined)", resolution.name, threadCount);
+            Report(name, MeasureContendedNs(threadCount, [&](unsigned thread) {
+                CopyPixelRows(slots[thread], dstPitch, src.data(), srcPitch, srcPitch, resolution.height);
+            }), static_cast<double>(srcPitch * resolution.height));
+        }
+        for (uint8_t* slot : slots) {
+            if (slot) VirtualFree(slot, 0, MEM_RELEASE);
+        }
+    }
+}
+
+// --- Hotkey Dispatch ---
+// A key press dispatched through the published table (what the hook does per key: lookup,
+// input stamp, the bound action), alone and with other threads dispatching while one rebinds an
+// action every millisecond
+static thread_local uint64_t t_hotkeyDispatches = 0;
+
+void BenchmarkHotkeyDispatch() {
+    HotkeyManager hotkeys(nullptr);
+    const Hotkey bound('B', true, true, true);
+    const Hotkey unbound('Q', true, true, true);
+    if (!hotkeys.RegisterHotkey("bench", bound, []() { t_hotkeyDispatches++; })) {
+        printf("Hotkey dispatch: failed to register the binding\n");
+        return;
+    }
+    uint64_t matches = 0;
+    Report("DispatchHotkey (bound)", MeasureNs([&]() { matches += hotkeys.DispatchHotkey(bound); }));
+    Report("DispatchHotkey (unbound)", MeasureNs([&]() { matches += hotkeys.DispatchHotkey(unbound); }));
+
+    const unsigned threadCount = GetContendedThreadCount();
+    std::atomic<bool> stop{ false };
+    std::thread rebinder([&]() {
+        bool alternate = false;
+        while (!stop) {
+            hotkeys.UpdateHotkey("show_links", alternate ? Hotkey('3', false, true) : Hotkey('3', true, true));
+            alternate = !alternate;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    struct alignas(64) ThreadMatches {
+        uint64_t count = 0;
+    };
+    std::vector<ThreadMatches> threadMatches(threadCount);
+    char name[96];
+    snprintf(name, sizeof(name), "DispatchHotkey (bound), %u threads while rebinding", threadCount);
+    Report(name, MeasureContendedNs(threadCount, [&](unsigned thread) {
+        threadMatches[thread].count += hotkeys.DispatchHotkey(bound);
+    }));
+    stop = true;
+    rebinder.join();
+    if (matches == 0 || t_hotkeyDispatches == 0) printf("(no hotkey dispatched)\n");
+}
+
+// --- Device Benchmarks ---
+// Descriptor allocation, command allocator recycling, pipeline cache hits and barrier tracking on a
+// hidden window's RenderSystem (the default adapter)
+HWND CreateBenchmarkWindow(int width = 256, int height = 256) {
+    WNDCLASSEXW windowClass = { sizeof(windowClass) };
+    windowClass.lpfnWndProc = DefWindowProcW;
+    windowClass.hInstance = GetModuleHandleW(nullptr);
+    windowClass.lpszClassName = L"GameOverlayBench";
+    RegisterClassExW(&windowClass);
+    RECT rect = { 0, 0, width, height }; // Client area
+    AdjustWindowRectEx(&rect, WS_OVERLAPPEDWINDOW, FALSE, 0);
+    return CreateWindowExW(0, windowClass.lpszClassName, L"GameOverlayBench", WS_OVERLAPPEDWINDOW,
+        0, 0, rect.right - rect.left, rect.bottom - rect.top, nullptr, nullptr, windowClass.hInstance, nullptr);
+}
+
+void BenchmarkDescriptors(ResourceManager& resources) {
+    const D3D12_DESCRIPTOR_HEAP_TYPE type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    Report("AllocateDescriptor + FreeDescriptor", MeasureNs([&]() {
+        resources.FreeDescriptor(resources.AllocateDescriptor(type));
+    }));
+
+    // A fuller heap: the bit scans have to skip allocated words
+    std::vector<ResourceDescriptor> held;
+    for (int i = 0; i < 4096; i++) {
+        held.push_back(resources.AllocateDescriptor(type));
+    }
+    Report("AllocateDescriptor + FreeDescriptor, 4096 held", MeasureNs([&]() {
+        resources.FreeDescriptor(resources.AllocateDescriptor(type));
+    }));
+
+    const unsigned threadCount = GetContendedThreadCount();
+    char name[96];
+    snprintf(name, sizeof(name), "AllocateDescriptor + FreeDescriptor, %u threads", threadCount);
+    Report(name, MeasureContendedNs(threadCount, [&](unsigned) {
+        resources.FreeDescriptor(resources.AllocateDescriptor(type));
+    }));
+    for (const ResourceDescriptor& descriptor : held) {
+        resources.FreeDescriptor(descriptor);
+    }
+}
+
+void BenchmarkCommandAllocators(ID3D12Device* device) {
+    // Released at fence 0, so every acquire recycles (reset included, as on the render thread)
+    CommandAllocatorPool pool(device, D3D12_COMMAND_LIST_TYPE_DIRECT);
+    Report("CommandAllocatorPool acquire + release", MeasureNs([&]() {
+        pool.ReleaseCommandAllocator(0, pool.GetCommandAllocator(0));
+    }));
+
+    const unsigned threadCount = GetContendedThreadCount();
+    char name[96];
+    snprintf(name, sizeof(name), "CommandAllocatorPool acquire + release, %u threads", threadCount);
+    Report(name, MeasureContendedNs(threadCount, [&](unsigned) {
+        pool.ReleaseCommandAllocator(0, pool.GetCommandAllocator(0));
+    }));
+}
+
+void BenchmarkPipelineLookups(PipelineStateManager& pipelines) {
+    PipelineStateKey key; // Created by Initialize
+    if (!pipelines.GetPipelineState(key)) {
+        printf("Pipeline lookups skipped: the default pipeline failed to create\n");
+        return;
+    }
+    Report("GetPipelineState (hit)", MeasureNs([&]() { pipelines.GetPipelineState(key); }));
+
+    const unsigned threadCount = GetContendedThreadCount();
+    char name[96];
+    snprintf(name, sizeof(name), "GetPipelineState (hit), %u threads", threadCount);
+    Report(name, MeasureContendedNs(threadCount, [&](unsigned) { pipelines.GetPipelineState(key); }));
+}
+
+void BenchmarkTransitions(ID3D12Device* device, ResourceManager& resources) {
+    // Render thread only by design (barrier batching records into the frame's list), so there is
+    // no contended variant. The list is never executed; it is reset before it grows large.
+    ComPtr<ID3D12CommandAllocator> allocator;
+    ComPtr<ID3D12GraphicsCommandList> commandList;
+    if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&allocator))) ||
+        FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, allocator.Get(), nullptr, IID_PPV_ARGS(&commandList)))) {
+        printf("Transitions skipped: no command list\n");
+        return;
+    }
+    ComPtr<ID3D12Resource> texture = resources.CreateTexture2D(256, 256);
+    if (!texture) {
+        printf("Transitions skipped: no texture\n");
+        return;
+    }
+
+    D3D12_RESOURCE_STATES next = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    uint32_t recorded = 0;
+    Report("QueueTransition + FlushBarriers", MeasureNs([&]() {
+        resources.QueueTransition(texture.Get(), next);
+        resources.FlushBarriers(commandList.Get());
+        next = next == D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE ? D3D12_RESOURCE_STATE_COPY_DEST :
+            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+        if (++recorded == 4096) {
+            recorded = 0;
+            commandList->Close();
+            allocator->Reset();
+            commandList->Reset(allocator.Get(), nullptr);
+        }
+    }));
+    commandList->Close();
+}
+
+void BenchmarkDevice() {
+    HWND hwnd = CreateBenchmarkWindow();
+    if (!hwnd) {
+        printf("Device benchmarks skipped: no window\n");
+        return;
+    }
+    try {
+        RenderSystem renderSystem(hwnd, 256, 256);
+        ResourceManager* resources = renderSystem.GetResourceManager();
+        PipelineStateManager pipelines(&renderSystem);
+        pipelines.Initialize();
+
+        BenchmarkDescriptors(*resources);
+        BenchmarkCommandAllocators(renderSystem.GetDevice());
+        BenchmarkPipelineLookups(pipelines);
+        BenchmarkTransitions(renderSystem.GetDevice(), *resources);
+    }
+    catch (const std::exception& e) {
+        printf("Device benchmarks skipped: %s\n", e.what());
+    }
+    DestroyWindow(hwnd);
+}
+
+// --- Frame Scenarios ---
+// Scripted overlay frames, recorded and presented as in the main loop (vsync off) on a hidden window
+// of the scenario's size. The browser takes synthetic paints in place of CEF
+// (BrowserView::SetExternalPaints), copied out as OnPaint would on the render thread. Each phase is
+// timed on the CPU every frame, the GPU from the frames' timestamps. Written to the JSON report.
+constexpr int SCENARIO_WARMUP_FRAMES = 60;
+constexpr int SCENARIO_FRAMES = 300;
+// Power: whole-machine watts over the frames, paced as the frame limiter would (nothing else should
+// be running), and over an idle machine before the scenarios for the difference
+constexpr auto SCENARIO_POWER_TIME = std::chrono::seconds(3);
+constexpr auto SCENARIO_POWER_FRAME_INTERVAL = std::chrono::microseconds(16667); // 60 Hz
+constexpr std::chrono::milliseconds POWER_SAMPLE_INTERVAL{ 250 };
+
+enum class FramePhase {
+    Events,      // Resizes, tab switches and scroll offsets from the script
+    Paint,       // SignalTextureUpdateFromHandler (CEF's thread in the overlay)
+    BeginFrame,
+    BrowserCopy, // Recording the browser texture update
+    Ui,          // ImGui frame with the page image, recorded
+    EndFrame,    // Execute and present
+    Count
+};
+
+const char* GetFramePhaseName(FramePhase phase) {
+    switch (phase) {
+    case FramePhase::Events: return "events";
+    case FramePhase::Paint: return "paint";
+    case FramePhase::BeginFrame: return "beginFrame";
+    case FramePhase::BrowserCopy: return "browserCopy";
+    case FramePhase::Ui: return "ui";
+    case FramePhase::EndFrame: return "endFrame";
+    default: return "unknown";
+    }
+}
+
+struct Distribution {
+    double meanMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+};
+
+// Nearest rank
+Distribution Summarize(std::vector<double> samples) {
+    Distribution distribution;
+    if (samples.empty()) return distribution;
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](double fraction) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()))];
+    };
+    double sum = 0.0;
+    for (double sample : samples) sum += sample;
+    distribution.meanMs = sum / samples.size();
+    distribution.p50Ms = percentile(0.50);
+    distribution.p95Ms = percentile(0.95);
+    distribution.p99Ms = percentile(0.99);
+    distribution.maxMs = samples.back();
+    return distribution;
+}
+
+// A browser paint for the frame, in CEF's layout (tight pitch); null buffer for none
+struct ScenarioPaint {
+    const uint8_t* buffer = nullptr;
+    int width = 0;
+    int height = 0;
+    std::vector<RECT> rects;
+};
+
+// Pixels whose every row differs from every other (scroll detection hashes rows), seeded so two
+// canvases of one size share no tile
+std::vector<uint8_t> CreateCanvas(int width, int height, uint32_t seed) {
+    std::vector<uint8_t> canvas(static_cast<size_t>(width) * height * 4);
+    uint32_t* pixels = reinterpret_cast<uint32_t*>(canvas.data());
+    for (int y = 0; y < height; y++) {
+        const uint32_t rowValue = (static_cast<uint32_t>(y) + seed * 7919u) * 2654435761u;
+        for (int x = 0; x < width; x++) {
+            pixels[static_cast<size_t>(y) * width + x] = (rowValue ^ (static_cast<uint32_t>(x) * 40503u)) | 0xFF000000u;
+        }
+    }
+    return canvas;
+}
+
+struct PowerReading {
+    int samples = 0;
+    double packageWatts = 0.0; // Without the integrated GPU, as PerformanceMonitor attributes it
+    double gpuWatts = 0.0;     // Integrated and discrete
+};
+
+// Mean of the samples collected while step runs over and over for duration; the first new one is
+// dropped, as its interval began before
+template <typename Fn>
+PowerReading MeasurePower(PowerSampler& sampler, std::chrono::steady_clock::duration duration, Fn&& step) {
+    PowerReading reading;
+    uint64_t seen = sampler.GetSampleCount();
+    bool first = true;
+    const auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end) {
+        step();
+        sampler.Poll();
+        const uint64_t count = sampler.GetSampleCount();
+        PowerSample sample;
+        if (count == seen || !sampler.GetLatestSample(sample)) continue;
+        seen = count;
+        if (first) {
+            first = false;
+            continue;
+        }
+        const float integratedGpuWatts = sample.packageMeasured ?
+            std::min(sample.integratedGpuWatts, sample.packageWatts) : sample.integratedGpuWatts;
+        reading.samples++;
+        reading.packageWatts += sample.packageWatts - (sample.packageMeasured ? integratedGpuWatts : 0.0f);
+        reading.gpuWatts += sample.discreteGpuWatts + integratedGpuWatts;
+    }
+    if (reading.samples > 0) {
+        reading.packageWatts /= reading.samples;
+        reading.gpuWatts /= reading.samples;
+    }
+    return reading;
+}
+
+class FrameHarness;
+struct Scenario {
+    const char* name;
+    const char* resolution;
+    int width;
+    int height;
+    // Before the paint: script the frame's events, fill in its paint
+    std::function<void(FrameHarness& harness, int frame, ScenarioPaint& paint)> step;
+    bool allocationFree = false; // Steady state must not touch the heap (idle and repaint frames)
+    float renderScale = 1.0f;
+    UpscaleMode upscaleMode = UpscaleMode::Shader;
+};
+
+struct ScenarioResult {
+    std::string name;
+    std::string resolution;
+    int width = 0;
+    int height = 0;
+    float renderScale = 1.0f;
+    UpscaleMode upscaleMode = UpscaleMode::Shader; // As run: SwapChain falls back to Shader without SetSourceSize
+    int frames = 0;
+    double seconds = 0.0;
+    Distribution cpuFrame;
+    Distribution cpuPhases[static_cast<size_t>(FramePhase::Count)];
+    int gpuFrames = 0; // Frames with timestamps
+    Distribution gpuFrame;
+    Distribution gpuPasses[static_cast<size_t>(GpuPass::Count)];
+    double uploadedMB = 0.0;
+    double uploadMBPerSecond = 0.0;
+    // Measured frames, counted on this thread (AllocationTracker)
+    int allocatingFrames = 0;
+    uint64_t maxFrameAllocations = 0;
+    const char* worstZone = nullptr; // Of the frame with the most
+    PowerReading power; // Paced frames after the measured ones; no samples without a power source
+};
+
+// RenderSystem, ImGuiSystem and a BrowserView without CEF, frames made as in the main loop
+class FrameHarness {
+public:
+    FrameHarness(HWND hwnd, int width, int height)
+        : m_renderSystem(hwnd, width, height), m_pipelines(&m_renderSystem), m_imgui(hwnd, 1.0f),
+        m_width(width), m_height(height) {
+        m_renderSystem.SetVSync(false);
+        m_pipelines.Initialize();
+        m_renderSystem.SetPipelineStateManager(&m_pipelines);
+        m_imgui.LoadFonts();
+        m_imgui.InitializeRenderer(&m_renderSystem);
+        m_browserView = std::make_unique<BrowserView>(&m_renderSystem);
+        m_browserView->SetExternalPaints();
+        m_browserView->Resize(width, height);
+        if (!m_browserView->StartBrowser()) {
+            throw std::runtime_error("Failed to create the browser textures");
+        }
+    }
+    ~FrameHarness() {
+        m_renderSystem.WaitForGpu();
+        m_browserView.reset();
+        m_renderSystem.SetPipelineStateManager(nullptr); // Destroyed before the render system
+    }
+
+    // Disable copy and move
+    FrameHarness(const FrameHarness&) = delete;
+    FrameHarness& operator=(const FrameHarness&) = delete;
+    FrameHarness(FrameHarness&&) = delete;
+    FrameHarness& operator=(FrameHarness&&) = delete;
+
+    RenderSystem& GetRenderSystem() { return m_renderSystem; }
+    BrowserView& GetBrowserView() { return *m_browserView; }
+
+    // Both the swap chain (debounced, as a window resize) and the browser view
+    void Resize(int width, int height) {
+        m_renderSystem.Resize(width, height);
+        m_browserView->Resize(width, height);
+        m_width = width;
+        m_height = height;
+    }
+
+    // One frame; phases in milliseconds
+    void RunFrame(const Scenario& scenario, int frame, double (&phaseMs)[static_cast<size_t>(FramePhase::Count)]) {
+        MSG msg;
+        while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
+        JobSystem::Get().RunRenderThreadContinuations();
+
+        auto phaseStart = std::chrono::steady_clock::now();
+        auto endPhase = [&](FramePhase phase) {
+            const auto now = std::chrono::steady_clock::now();
+            phaseMs[static_cast<size_t>(phase)] = std::chrono::duration<double, std::milli>(now - phaseStart).count();
+            phaseStart = now;
+        };
+
+        m_paint.buffer = nullptr;
+        m_paint.rects.clear();
+        scenario.step(*this, frame, m_paint);
+        endPhase(FramePhase::Events);
+
+        if (m_paint.buffer) {
+            LARGE_INTEGER qpc;
+            QueryPerformanceCounter(&qpc);
+            m_browserView->SignalTextureUpdateFromHandler(m_paint.buffer, m_paint.width, m_paint.height, m_paint.rects,
+                qpc.QuadPart);
+        }
+        endPhase(FramePhase::Paint);
+
+        m_renderSystem.BeginFrame();
+        ID3D12GraphicsCommandList* commandList = m_renderSystem.GetCommandList();
+        endPhase(FramePhase::BeginFrame);
+
+        RecordBrowserCopy(commandList);
+        endPhase(FramePhase::BrowserCopy);
+
+        m_imgui.BeginFrame();
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+        ImGui::SetNextWindowSize(ImVec2(static_cast<float>(m_width), static_cast<float>(m_height)));
+        ImGui::Begin("Browser", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoSavedSettings);
+        float contentU = 1.0f;
+        float contentV = 1.0f;
+        m_browserView->GetContentExtent(contentU, contentV);
+        const D3D12_GPU_DESCRIPTOR_HANDLE texture = m_browserView->GetTextureGpuHandle();
+        ImGui::Image(reinterpret_cast<ImTextureID>(texture.ptr), ImGui::GetContentRegionAvail(),
+            ImVec2(0.0f, 0.0f), ImVec2(contentU, contentV));
+        ImGui::End();
+        m_imgui.AddLiveTexture(texture);
+        m_imgui.EndFrame();
+        endPhase(FramePhase::Ui);
+
+        m_renderSystem.EndFrame();
+        m_renderSystem.FlushPendingSubmission(); // A recording still running submits from its continuation
+        endPhase(FramePhase::EndFrame);
+    }
+
+private:
+    // The main loop's browser copy, without CEF's shared texture
+    void RecordBrowserCopy(ID3D12GraphicsCommandList* commandList) {
+        if (m_browserView->RecordTabThumbnailCapture(commandList) || !m_browserView->TextureNeedsGPUCopy()) return;
+        m_browserView->ClearTextureUpdateFlag();
+        m_renderSystem.GetResourceManager()->NotifyResourceUsed(m_browserView->GetTexture());
+        std::lock_guard<ProfiledMutex> lock(m_browserView->m_bufferMutex);
+        if (m_browserView->UsesGpuConversion()) {
+            m_renderSystem.BeginGpuPass(GpuPass::BrowserCopy);
+            if (BrowserView::UploadSlot* slot = m_browserView->TakePublishedUploadSlot()) {
+                if (!m_browserView->RecordFrameConversion(commandList, slot)) {
+                    m_browserView->RequestFullUpload();
+                }
+                m_browserView->ReleaseUploadSlot(slot, m_renderSystem.GetCurrentFenceValue());
+            }
+            m_renderSystem.EndGpuPass(GpuPass::BrowserCopy);
+        }
+        else if (m_browserView->UsesGpuUploadTextures()) {
+            if (BrowserView::UploadSlot* slot = m_browserView->TakePublishedUploadSlot()) {
+                m_browserView->ShowUploadSlot(slot, m_renderSystem.GetCurrentFenceValue());
+            }
+        }
+        else if (m_browserView->GetTexture()) {
+            m_browserView->RecordScheduledUploads(commandList);
+        }
+    }
+
+    RenderSystem m_renderSystem;
+    PipelineStateManager m_pipelines;
+    ImGuiSystem m_imgui;
+    std::unique_ptr<BrowserView> m_browserView;
+    ScenarioPaint m_paint; // Reused each frame
+    int m_width = 0;
+    int m_height = 0;
+};
+
+// powerSampler: null to skip the power run
+ScenarioResult RunScenario(const Scenario& scenario, PowerSampler* powerSampler) {
+    ScenarioResult result;
+    result.name = scenario.name;
+    result.resolution = scenario.resolution;
+    result.width = scenario.width;
+    result.height = scenario.height;
+
+    HWND hwnd = CreateBenchmarkWindow(scenario.width, scenario.height);
+    if (!hwnd) throw std::runtime_error("Failed to create the window");
+    try {
+        FrameHarness harness(hwnd, scenario.width, scenario.height);
+        harness.GetRenderSystem().SetUpscaleMode(scenario.upscaleMode);
+        harness.GetRenderSystem().SetRenderScale(scenario.renderScale);
+        result.renderScale = harness.GetRenderSystem().GetRenderScale();
+
+        // Reserved, so recording a sample doesn't count as the frame's allocation
+        std::vector<double> frameSamples;
+        std::vector<double> phaseSamples[static_cast<size_t>(FramePhase::Count)];
+        std::vector<double> gpuFrameSamples;
+        std::vector<double> gpuPassSamples[static_cast<size_t>(GpuPass::Count)];
+        frameSamples.reserve(SCENARIO_FRAMES);
+        gpuFrameSamples.reserve(SCENARIO_FRAMES);
+        for (std::vector<double>& samples : phaseSamples) samples.reserve(SCENARIO_FRAMES);
+        for (std::vector<double>& samples : gpuPassSamples) samples.reserve(SCENARIO_FRAMES);
+        double phaseMs[static_cast<size_t>(FramePhase::Count)] = {};
+
+        for (int frame = 0; frame < SCENARIO_WARMUP_FRAMES; frame++) {
+            harness.RunFrame(scenario, frame, phaseMs);
+        }
+        const UINT64 uploadedBefore = harness.GetBrowserView().GetUploadedBytes();
+        const auto start = std::chrono::steady_clock::now();
+        for (int frame = SCENARIO_WARMUP_FRAMES; frame < SCENARIO_WARMUP_FRAMES + SCENARIO_FRAMES; frame++) {
+            AllocationTracker::EndFrame(); // Only the frame itself counts
+            harness.RunFrame(scenario, frame, phaseMs);
+            const AllocationCounters frameAllocations = AllocationTracker::EndFrame();
+            if (frameAllocations.allocations > 0) {
+                result.allocatingFrames++;
+                if (frameAllocations.allocations > result.maxFrameAllocations) {
+                    result.maxFrameAllocations = frameAllocations.allocations;
+                    ZoneAllocations worst;
+                    result.worstZone = AllocationTracker::GetLastFrameZones(&worst, 1) > 0 ? worst.name : nullptr;
+                }
+            }
+            double frameMs = 0.0;
+            for (size_t phase = 0; phase < static_cast<size_t>(FramePhase::Count); phase++) {
+                phaseSamples[phase].push_back(phaseMs[phase]);
+                frameMs += phaseMs[phase];
+            }
+            frameSamples.push_back(frameMs);
+
+            // The latest resolved timestamps, a frame or two behind
+            const RenderSystem& renderSystem = harness.GetRenderSystem();
+            if (renderSystem.GetGpuFrameTimeMs() > 0.0f) {
+                gpuFrameSamples.push_back(renderSystem.GetGpuFrameTimeMs());
+                for (size_t pass = 0; pass < static_cast<size_t>(GpuPass::Count); pass++) {
+                    gpuPassSamples[pass].push_back(renderSystem.GetGpuPassTimeMs(static_cast<GpuPass>(pass)));
+                }
+            }
+        }
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.upscaleMode = harness.GetRenderSystem().GetUpscaleMode();
+        result.frames = SCENARIO_FRAMES;
+        result.cpuFrame = Summarize(std::move(frameSamples));
+        for (size_t phase = 0; phase < static_cast<size_t>(FramePhase::Count); phase++) {
+            result.cpuPhases[phase] = Summarize(std::move(phaseSamples[phase]));
+        }
+        result.gpuFrames = static_cast<int>(gpuFrameSamples.size());
+        result.gpuFrame = Summarize(std::move(gpuFrameSamples));
+        for (size_t pass = 0; pass < static_cast<size_t>(GpuPass::Count); pass++) {
+            result.gpuPasses[pass] = Summarize(std::move(gpuPassSamples[pass]));
+        }
+        result.uploadedMB = (harness.GetBrowserView().GetUploadedBytes() - uploadedBefore) / (1024.0 * 1024.0);
+        result.uploadMBPerSecond = result.seconds > 0.0 ? result.uploadedMB / result.seconds : 0.0;
+
+        if (powerSampler) {
+            int frame = SCENARIO_WARMUP_FRAMES + SCENARIO_FRAMES;
+            auto nextFrame = std::chrono::steady_clock::now();
+            result.power = MeasurePower(*powerSampler, SCENARIO_POWER_TIME, [&]() {
+                harness.RunFrame(scenario, frame++, phaseMs);
+                nextFrame += SCENARIO_POWER_FRAME_INTERVAL;
+                std::this_thread::sleep_until(nextFrame);
+            });
+        }
+    }
+    catch (...) {
+        DestroyWindow(hwnd);
+        throw;
+    }
+    DestroyWindow(hwnd);
+    return result;
+}
+
+// Idle, both upscale modes, full repaints at each resolution, scrolling, resize storms and tab switches
+std::vector<Scenario> CreateScenarios() {
+    struct Resolution {
+        const char* name;
+        int width;
+        int height;
+    };
+    static const Resolution RESOLUTIONS[] = { { "1080p", 1920, 1080 }, { "1440p", 2560, 1440 }, { "4K", 3840, 2160 } };
+    constexpr int SCROLL_STEP = 40;     // Pixels per frame, a wheel notch
+    constexpr int TAB_SWITCH_FRAMES = 10;
+    constexpr int RESIZE_WIDTH = 1600;  // Alternates with 1080p every frame
+    constexpr int RESIZE_HEIGHT = 900;
+    static const float UPSCALE_RENDER_SCALES[] = { 0.5f, 0.75f };
+
+    // Shared by the scenarios' steps, which outlive this call
+    struct Canvases {
+        std::vector<uint8_t> frames[std::size(RESOLUTIONS)][2];
+        std::vector<uint8_t> tall;  // Three 1080p views high, scrolled through
+        std::vector<uint8_t> resized;
+    };
+    auto canvases = std::make_shared<Canvases>();
+    for (size_t i = 0; i < std::size(RESOLUTIONS); i++) {
+        for (uint32_t seed = 0; seed < 2; seed++) {
+            canvases->frames[i][seed] = CreateCanvas(RESOLUTIONS[i].width, RESOLUTIONS[i].height, seed);
+        }
+    }
+    canvases->tall = CreateCanvas(1920, 1080 * 3, 2);
+    canvases->resized = CreateCanvas(RESIZE_WIDTH, RESIZE_HEIGHT, 3);
+
+    auto fullPaint = [](ScenarioPaint& paint, const std::vector<uint8_t>& canvas, int width, int height) {
+        paint.buffer = canvas.data();
+        paint.width = width;
+        paint.height = height;
+        paint.rects.push_back({ 0, 0, width, height });
+    };
+
+    std::vector<Scenario> scenarios;
+    // Shown page, nothing painting: the frame's fixed cost. The first frame paints the page.
+    scenarios.push_back({ "idle", "1080p", 1920, 1080, [canvases, fullPaint](FrameHarness&, int frame, ScenarioPaint& paint) {
+        if (frame == 0) fullPaint(paint, canvases->frames[0][0], 1920, 1080);
+    }, true });
+    // Reduced render scales brought back up by the upscale pass or by DXGI (SetSourceSize), over a
+    // shown page: the difference is what each mode costs
+    for (float renderScale : UPSCALE_RENDER_SCALES) {
+        for (UpscaleMode mode : { UpscaleMode::Shader, UpscaleMode::SwapChain }) {
+            scenarios.push_back({ mode == UpscaleMode::Shader ? "upscaleShader" : "upscaleSwapChain", "1440p", 2560, 1440,
+                [canvases, fullPaint](FrameHarness&, int frame, ScenarioPaint& paint) {
+                    if (frame == 0) fullPaint(paint, canvases->frames[1][0], 2560, 1440);
+                }, false, renderScale, mode });
+        }
+    }
+    // Every pixel changes every frame (video, canvas animations)
+    for (size_t i = 0; i < std::size(RESOLUTIONS); i++) {
+        const Resolution resolution = RESOLUTIONS[i];
+        scenarios.push_back({ "fullRepaint", resolution.name, resolution.width, resolution.height,
+            [canvases, fullPaint, i, resolution](FrameHarness&, int frame, ScenarioPaint& paint) {
+                fullPaint(paint, canvases->frames[i][frame & 1], resolution.width, resolution.height);
+            }, true });
+    }
+    // A wheel scroll down a long page every frame: CEF repaints the view after the offset changes
+    scenarios.push_back({ "scroll", "1080p", 1920, 1080, [canvases](FrameHarness& harness, int frame, ScenarioPaint& paint) {
+        const int offset = (frame * SCROLL_STEP) % (1080 * 2);
+        harness.GetBrowserView().SignalScrollOffsetFromHandler(0.0, offset);
+        paint.buffer = canvases->tall.data() + static_cast<size_t>(offset) * 1920 * 4;
+        paint.width = 1920;
+        paint.height = 1080;
+        paint.rects.push_back({ 0, 0, 1920, 1080 });
+    } });
+    // A window edge dragged back and forth: every frame a new size, and the page repainted at it
+    scenarios.push_back({ "resizeStorm", "1080p", 1920, 1080, [canvases, fullPaint](FrameHarness& harness, int frame, ScenarioPaint& paint) {
+        if (frame & 1) {
+            harness.Resize(RESIZE_WIDTH, RESIZE_HEIGHT);
+            fullPaint(paint, canvases->resized, RESIZE_WIDTH, RESIZE_HEIGHT);
+        }
+        else {
+            harness.Resize(1920, 1080);
+            fullPaint(paint, canvases->frames[0][(frame >> 1) & 1], 1920, 1080);
+        }
+    } });
+    // Another tab takes the view every few frames and paints it whole; a caret blinks in between
+    scenarios.push_back({ "tabSwitch", "1080p", 1920, 1080, [canvases, fullPaint](FrameHarness& harness, int frame, ScenarioPaint& paint) {
+        const int tab = frame / TAB_SWITCH_FRAMES;
+        if (frame % TAB_SWITCH_FRAMES == 0) {
+            harness.GetBrowserView().OnActiveTabChanged();
+            fullPaint(paint, canvases->frames[0][tab & 1], 1920, 1080);
+        }
+        else {
+            paint.buffer = canvases->frames[0][tab & 1].data();
+            paint.width = 1920;
+            paint.height = 1080;
+            paint.rects.push_back({ 400, 300, 402, 320 });
+        }
+    } });
+    return scenarios;
+}
+
+void WriteDistribution(FILE* file, const char* name, const Distribution& distribution, bool last) {
+    fprintf(file, "        \"%s\": { \"meanMs\": %.4f, \"p50Ms\": %.4f, \"p95Ms\": %.4f, \"p99Ms\": %.4f, \"maxMs\": %.4f }%s\n",
+        name, distribution.meanMs, distribution.p50Ms, distribution.p95Ms, distribution.p99Ms, distribution.maxMs,
+        last ? "" : ",");
+}
+
+bool WriteScenarioReport(const std::string& path, const std::vector<ScenarioResult>& results, const PowerReading& idlePower) {
+    FILE* file = nullptr;
+    if (fopen_s(&file, path.c_str(), "w") != 0 || !file) return false;
+    fprintf(file, "{\n  \"idlePower\": { \"samples\": %d, \"packageWatts\": %.2f, \"gpuWatts\": %.2f },\n",
+        idlePower.samples, idlePower.packageWatts, idlePower.gpuWatts);
+    fprintf(file, "  \"scenarios\": [");
+    for (size_t i = 0; i < results.size(); i++) {
+        const ScenarioResult& result = results[i];
+        fprintf(file, "%s\n    {\n", i > 0 ? "," : "");
+        fprintf(file, "      \"name\": \"%s\", \"resolution\": \"%s\", \"width\": %d, \"height\": %d,\n",
+            result.name.c_str(), result.resolution.c_str(), result.width, result.height);
+        fprintf(file, "      \"renderScale\": %.2f, \"upscaleMode\": \"%s\",\n", result.renderScale,
+            result.upscaleMode == UpscaleMode::SwapChain ? "swapChain" : "shader");
+        fprintf(file, "      \"frames\": %d, \"seconds\": %.3f,\n", result.frames, result.seconds);
+        fprintf(file, "      \"cpu\": {\n");
+        WriteDistribution(file, "frame", result.cpuFrame, false);
+        for (size_t phase = 0; phase < static_cast<size_t>(FramePhase::Count); phase++) {
+            WriteDistribution(file, GetFramePhaseName(static_cast<FramePhase>(phase)), result.cpuPhases[phase],
+                phase + 1 == static_cast<size_t>(FramePhase::Count));
+        }
+        fprintf(file, "      },\n      \"gpu\": {\n        \"frames\": %d,\n", result.gpuFrames);
+        WriteDistribution(file, "frame", result.gpuFrame, false);
+        for (size_t pass = 0; pass < static_cast<size_t>(GpuPass::Count); pass++) {
+            WriteDistribution(file, GetGpuPassName(static_cast<GpuPass>(pass)), result.gpuPasses[pass],
+                pass + 1 == static_cast<size_t>(GpuPass::Count));
+        }
+        fprintf(file, "      },\n      \"upload\": { \"totalMB\": %.2f, \"MBPerSecond\": %.2f },\n",
+            result.uploadedMB, result.uploadMBPerSecond);
+        fprintf(file, "      \"power\": { \"samples\": %d, \"packageWatts\": %.2f, \"gpuWatts\": %.2f, "
+            "\"packageWattsOverIdle\": %.2f, \"gpuWattsOverIdle\": %.2f },\n", result.power.samples,
+            result.power.packageWatts, result.power.gpuWatts, result.power.packageWatts - idlePower.packageWatts,
+            result.power.gpuWatts - idlePower.gpuWatts);
+        fprintf(file, "      \"allocations\": { \"tracked\": %s, \"allocatingFrames\": %d, \"maxPerFrame\": %llu, \"worstZone\": \"%s\" }\n    }",
+            AllocationTracker::IsCompiledIn() ? "true" : "false", result.allocatingFrames,
+            static_cast<unsigned long long>(result.maxFrameAllocations), result.worstZone ? result.worstZone : "");
+    }
+    fprintf(file, "\n  ]\n}\n");
+    const bool written = ferror(file) == 0;
+    fclose(file);
+    return written;
+}
+
+// False when assertZeroAlloc and an allocation-free scenario allocated (or couldn't run)
+bool BenchmarkScenarios(const std::string& reportPath, bool assertZeroAlloc) {
+    std::vector<ScenarioResult> results;
+    bool allocationFree = true;
+
+    PowerSampler powerSampler(POWER_SAMPLE_INTERVAL);
+    const PowerReading idlePower = MeasurePower(powerSampler, SCENARIO_POWER_TIME, []() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    });
+    const bool powerMeasured = idlePower.samples > 0;
+    if (powerMeasured) {
+        printf("Idle machine: package %.2f W, GPU %.2f W\n", idlePower.packageWatts, idlePower.gpuWatts);
+    }
+    else {
+        printf("Scenario power skipped: no Energy Meter counters or NVML\n");
+    }
+
+    for (const Scenario& scenario : CreateScenarios()) {
+        try {
+            ScenarioResult result = RunScenario(scenario, powerMeasured ? &powerSampler : nullptr);
+            printf("Scenario %-16s %-6s x%.2f CPU %7.3f ms (p99 %7.3f)  GPU %7.3f ms (p99 %7.3f)  %8.1f MB/s\n",
+                result.name.c_str(), result.resolution.c_str(), result.renderScale, result.cpuFrame.meanMs, result.cpuFrame.p99Ms,
+                result.gpuFrame.meanMs, result.gpuFrame.p99Ms, result.uploadMBPerSecond);
+            if (result.power.samples > 0) {
+                printf("  at 60 Hz: package %.2f W, GPU %.2f W (%+.2f W, %+.2f W over idle)\n", result.power.packageWatts,
+                    result.power.gpuWatts, result.power.packageWatts - idlePower.packageWatts,
+                    result.power.gpuWatts - idlePower.gpuWatts);
+            }
+            if (result.upscaleMode != scenario.upscaleMode) {
+                printf("Scenario %s %s: SetSourceSize failed, measured the shader pass\n", scenario.name, scenario.resolution);
+            }
+            if (assertZeroAlloc && scenario.allocationFree && result.allocatingFrames > 0) {
+                printf("Scenario %s %s: %d of %d frames allocated (at most %llu, most in %s)\n", scenario.name,
+                    scenario.resolution, result.allocatingFrames, result.frames,
+                    static_cast<unsigned long long>(result.maxFrameAllocations), result.worstZone ? result.worstZone : "no zone");
+                allocationFree = false;
+            }
+            results.push_back(std::move(result));
+        }
+        catch (const std::exception& e) {
+            printf("Scenario %s %s skipped: %s\n", scenario.name, scenario.resolution, e.what());
+            allocationFree = allocationFree && !scenario.allocationFree;
+        }
+    }
+    if (!WriteScenarioReport(reportPath, results, idlePower)) {
+        printf("Failed to write %s\n", reportPath.c_str());
+    }
+    else {
+        printf("Scenario report: %s\n", reportPath.c_str());
+    }
+    return !assertZeroAlloc || allocationFree;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string reportPath = "GameOverlayBench.json";
+    bool assertZeroAlloc = false;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--json=", 7) == 0) reportPath = argv[i] + 7;
+        if (strcmp(argv[i], "--assert-zero-alloc") == 0) assertZeroAlloc = true;
+    }
+    if (assertZeroAlloc) {
+        if (!AllocationTracker::IsCompiledIn()) {
+            printf("--assert-zero-alloc needs a GAMEOVERLAY_ALLOCATION_TRACKING build\n");
+            return 3;
+        }
+        AllocationTracker::SetZoneAttributionEnabled(true);
+    }
+
+    BenchmarkPixelCopy();
+    BenchmarkHotkeyDispatch();
+    BenchmarkDevice();
+    if (!BenchmarkScenarios(reportPath, assertZeroAlloc)) {
+        return 3; // Allocation check failed
+    }
+    return 0;
+}
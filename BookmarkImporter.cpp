@@ -0,0 +1,424 @@
+// GameOverlay - BookmarkImporter.cpp
+// Streaming import of Chrome/Edge JSON and Netscape HTML bookmark files
+
+#include "BookmarkImporter.h"
+#include "Log.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+
+void AppendUtf8(std::string& text, uint32_t codepoint) {
+    if (codepoint < 0x80) {
+        text += static_cast<char>(codepoint);
+    }
+    else if (codepoint < 0x800) {
+        text += static_cast<char>(0xC0 | (codepoint >> 6));
+        text += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+    else if (codepoint < 0x10000) {
+        text += static_cast<char>(0xE0 | (codepoint >> 12));
+        text += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        text += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+    else {
+        text += static_cast<char>(0xF0 | (codepoint >> 18));
+        text += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+        text += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        text += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+}
+
+int HexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+std::string Trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return std::string();
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+// The entities Netscape files use, and numeric references
+std::string DecodeEntities(const std::string& text) {
+    std::string decoded;
+    decoded.reserve(text.size());
+    for (size_t i = 0; i < text.size(); i++) {
+        size_t end = text[i] == '&' ? text.find(';', i) : std::string::npos;
+        if (end == std::string::npos || end - i > 10) {
+            decoded += text[i];
+            continue;
+        }
+        std::string entity = text.substr(i + 1, end - i - 1);
+        if (entity == "amp") decoded += '&';
+        else if (entity == "lt") decoded += '<';
+        else if (entity == "gt") decoded += '>';
+        else if (entity == "quot") decoded += '"';
+        else if (entity == "apos") decoded += '\'';
+        else if (entity.size() > 1 && entity[0] == '#') {
+            bool hex = entity[1] == 'x' || entity[1] == 'X';
+            uint32_t codepoint = static_cast<uint32_t>(strtoul(entity.c_str() + (hex ? 2 : 1), nullptr, hex ? 16 : 10));
+            AppendUtf8(decoded, codepoint ? codepoint : 0xFFFD);
+        }
+        else {
+            decoded += text[i];
+            continue;
+        }
+        i = end;
+    }
+    return decoded;
+}
+
+// Value of a quoted (or bare) attribute of a tag, case-insensitive name
+std::string FindAttribute(const std::string& tag, const char* name) {
+    size_t nameLength = strlen(name);
+    for (size_t i = 0; i + nameLength < tag.size(); i++) {
+        if (_strnicmp(tag.c_str() + i, name, nameLength) != 0 || tag[i + nameLength] != '=') continue;
+        if (i > 0 && !isspace(static_cast<unsigned char>(tag[i - 1]))) continue;
+        size_t begin = i + nameLength + 1;
+        if (begin < tag.size() && (tag[begin] == '"' || tag[begin] == '\'')) {
+            size_t end = tag.find(tag[begin], begin + 1);
+            return tag.substr(begin + 1, end == std::string::npos ? std::string::npos : end - begin - 1);
+        }
+        size_t end = tag.find_first_of(" \t\r\n", begin);
+        return tag.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+    }
+    return std::string();
+}
+
+const char* GetJsonRootName(const std::string& key) {
+    if (key == "bookmark_bar") return "Bookmarks Bar";
+    if (key == "other") return "Other Bookmarks";
+    if (key == "synced") return "Mobile Bookmarks";
+    return nullptr;
+}
+
+} // namespace
+
+BookmarkImporter::~BookmarkImporter() {
+    Cancel();
+    m_jobs.Wait(); // The job reads the file and the parser state
+}
+
+bool BookmarkImporter::Start(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_running || !m_jobs.IsDone()) return false;
+    }
+
+    std::error_code error;
+    std::filesystem::path filePath = std::filesystem::u8path(path);
+    uint64_t fileSize = std::filesystem::file_size(filePath, error);
+    m_file.open(filePath, std::ios::binary);
+    if (error || !m_file) {
+        m_file.close();
+        LOG_WARNING("Bookmark import: can't open %s", path.c_str());
+        return false;
+    }
+
+    m_format = Format::Unknown;
+    m_started = false;
+    m_chunk.resize(CHUNK_SIZE);
+    m_jsonStack.clear();
+    m_jsonState = JsonState::Value;
+    m_highSurrogate = 0;
+    m_htmlState = HtmlState::Text;
+    m_htmlCapture = HtmlCapture::None;
+    m_pendingFolder.clear();
+    m_htmlFolders.clear();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.clear();
+    m_running = true;
+    m_stalled = false;
+    m_failed = false;
+    m_cancel.store(false, std::memory_order_relaxed);
+    m_bytesRead.store(0, std::memory_order_relaxed);
+    m_fileSize = fileSize;
+    m_parsed.store(0, std::memory_order_relaxed);
+    SubmitChunk();
+    return true;
+}
+
+void BookmarkImporter::Cancel() {
+    m_cancel.store(true, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.clear();
+    // A stopped chain has no job to see the flag: one more closes the file
+    if (m_stalled) {
+        m_stalled = false;
+        SubmitChunk();
+    }
+}
+
+size_t BookmarkImporter::TakeBatch(std::vector<Bookmark>& batch, size_t maxCount) {
+    batch.clear();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = std::min(maxCount, m_queue.size());
+    for (size_t i = 0; i < count; i++) {
+        batch.push_back(std::move(m_queue.front()));
+        m_queue.pop_front();
+    }
+    if (m_stalled && m_queue.size() < MAX_QUEUED / 2) {
+        m_stalled = false;
+        SubmitChunk();
+    }
+    return count;
+}
+
+BookmarkImporter::Progress BookmarkImporter::GetProgress() const {
+    Progress progress;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    progress.active = m_running || !m_queue.empty();
+    progress.failed = m_failed;
+    progress.bytesRead = m_bytesRead.load(std::memory_order_relaxed);
+    progress.fileSize = m_fileSize;
+    progress.bookmarks = m_parsed.load(std::memory_order_relaxed);
+    return progress;
+}
+
+void BookmarkImporter::SubmitChunk() {
+    JobDesc job;
+    job.name = "Import Bookmarks";
+    job.priority = JobPriority::Low;
+    job.jobClass = JobClass::Efficiency;
+    job.counter = &m_jobs;
+    JobSystem::Get().Submit(job, [this]() { ReadChunk(); });
+}
+
+void BookmarkImporter::ReadChunk() {
+    if (m_cancel.load(std::memory_order_acquire)) {
+        Finish(false);
+        return;
+    }
+
+    m_file.read(m_chunk.data(), static_cast<std::streamsize>(m_chunk.size()));
+    size_t size = static_cast<size_t>(m_file.gcount());
+    Parse(m_chunk.data(), size);
+    m_bytesRead.fetch_add(size, std::memory_order_relaxed);
+
+    if (m_started && m_format == Format::Unknown) {
+        LOG_WARNING("Bookmark import: not a JSON or HTML bookmark file");
+        Finish(true);
+        return;
+    }
+    if (size < m_chunk.size()) {
+        Finish(m_file.bad());
+        return;
+    }
+
+    // The next chunk, unless the page has enough waiting already
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_queue.size() >= MAX_QUEUED) {
+        m_stalled = true;
+    }
+    else {
+        SubmitChunk();
+    }
+}
+
+void BookmarkImporter::Parse(const char* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        char c = data[i];
+        if (!m_started) {
+            // The UTF-8 byte order mark and whitespace before the first character
+            if (isspace(static_cast<unsigned char>(c)) || c == '\xEF' || c == '\xBB' || c == '\xBF') continue;
+            m_started = true;
+            m_format = c == '{' ? Format::Json : c == '<' ? Format::Html : Format::Unknown;
+        }
+        if (m_format == Format::Json) ParseJson(c);
+        else if (m_format == Format::Html) ParseHtml(c);
+        else return;
+    }
+}
+
+void BookmarkImporter::ParseJson(char c) {
+    switch (m_jsonState) {
+    case JsonState::String:
+        if (c == '\\') m_jsonState = JsonState::Escape;
+        else if (c == '"') FinishJsonString();
+        else if (m_jsonCapture) m_jsonString += c;
+        break;
+
+    case JsonState::Escape:
+        m_jsonState = JsonState::String;
+        if (c == 'u') {
+            m_jsonState = JsonState::Unicode;
+            m_unicode = 0;
+            m_unicodeDigits = 0;
+        }
+        else if (m_jsonCapture) {
+            m_jsonString += c == 'n' ? '\n' : c == 't' ? '\t' : c == 'r' ? '\r' : c == 'b' ? '\b' : c == 'f' ? '\f' : c;
+        }
+        break;
+
+    case JsonState::Unicode:
+        m_unicode = (m_unicode << 4) | static_cast<uint32_t>(std::max(0, HexDigit(c)));
+        if (++m_unicodeDigits < 4) break;
+        m_jsonState = JsonState::String;
+        if (m_unicode >= 0xD800 && m_unicode < 0xDC00) {
+            m_highSurrogate = m_unicode; // Its pair follows as another escape
+        }
+        else if (m_jsonCapture) {
+            if (m_unicode >= 0xDC00 && m_unicode < 0xE000 && m_highSurrogate) {
+                AppendUtf8(m_jsonString, 0x10000 + ((m_highSurrogate - 0xD800) << 10) + (m_unicode - 0xDC00));
+            }
+            else {
+                AppendUtf8(m_jsonString, m_unicode);
+            }
+            m_highSurrogate = 0;
+        }
+        break;
+
+    case JsonState::Literal:
+        // Numbers, true, false and null are skipped; the delimiter ends them
+        if (c != ',' && c != '}' && c != ']' && !isspace(static_cast<unsigned char>(c))) break;
+        m_jsonState = JsonState::Value;
+        ParseJson(c);
+        break;
+
+    case JsonState::Value:
+        if (c == '{' || c == '[') {
+            JsonFrame frame;
+            frame.object = c == '{';
+            frame.expectKey = frame.object;
+            if (!m_jsonStack.empty()) {
+                const JsonFrame& parent = m_jsonStack.back();
+                frame.folder = parent.folder;
+                const char* root = nullptr;
+                if (parent.object && m_jsonStack.size() >= 2 && m_jsonStack[m_jsonStack.size() - 2].key == "roots") {
+                    root = GetJsonRootName(parent.key);
+                }
+                if (root) frame.folder = root;
+            }
+            m_jsonStack.push_back(std::move(frame));
+        }
+        else if (c == '}' || c == ']') {
+            if (m_jsonStack.empty()) break;
+            JsonFrame frame = std::move(m_jsonStack.back());
+            m_jsonStack.pop_back();
+            if (frame.object && frame.type == "url") {
+                Emit(std::move(frame.folder), std::move(frame.name), std::move(frame.url));
+            }
+        }
+        else if (c == ',') {
+            if (!m_jsonStack.empty() && m_jsonStack.back().object) m_jsonStack.back().expectKey = true;
+        }
+        else if (c == '"') {
+            m_jsonState = JsonState::String;
+            m_jsonString.clear();
+            m_highSurrogate = 0;
+            // Only keys and the values a bookmark needs are kept
+            m_jsonCapture = false;
+            if (!m_jsonStack.empty() && m_jsonStack.back().object) {
+                const JsonFrame& frame = m_jsonStack.back();
+                m_jsonCapture = frame.expectKey || frame.key == "type" || frame.key == "name" || frame.key == "url";
+            }
+        }
+        else if (c != ':' && !isspace(static_cast<unsigned char>(c))) {
+            m_jsonState = JsonState::Literal;
+        }
+        break;
+    }
+
+    if (m_jsonString.size() > MAX_VALUE_LENGTH) {
+        m_jsonString.clear();
+        m_jsonCapture = false;
+    }
+}
+
+void BookmarkImporter::FinishJsonString() {
+    m_jsonState = JsonState::Value;
+    if (m_jsonStack.empty() || !m_jsonStack.back().object) return;
+    JsonFrame& frame = m_jsonStack.back();
+    if (frame.expectKey) {
+        frame.key = std::move(m_jsonString);
+        frame.expectKey = false;
+    }
+    else if (frame.key == "type") frame.type = std::move(m_jsonString);
+    else if (frame.key == "name") frame.name = std::move(m_jsonString);
+    else if (frame.key == "url") frame.url = std::move(m_jsonString);
+    m_jsonString.clear();
+}
+
+void BookmarkImporter::ParseHtml(char c) {
+    if (m_htmlState == HtmlState::Tag) {
+        if (c == '>') {
+            FinishHtmlTag();
+            m_htmlState = HtmlState::Text;
+        }
+        else if (m_htmlTag.size() < MAX_VALUE_LENGTH) {
+            m_htmlTag += c;
+        }
+    }
+    else if (c == '<') {
+        m_htmlState = HtmlState::Tag;
+        m_htmlTag.clear();
+    }
+    else if (m_htmlCapture != HtmlCapture::None && m_htmlText.size() < MAX_VALUE_LENGTH) {
+        m_htmlText += c;
+    }
+}
+
+void BookmarkImporter::FinishHtmlTag() {
+    size_t nameEnd = m_htmlTag.find_first_of(" \t\r\n");
+    std::string name = m_htmlTag.substr(0, nameEnd);
+    std::transform(name.begin(), name.end(), name.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (name == "h3") {
+        m_htmlCapture = HtmlCapture::Folder;
+        m_htmlText.clear();
+    }
+    else if (name == "/h3" && m_htmlCapture == HtmlCapture::Folder) {
+        m_pendingFolder = Trim(DecodeEntities(m_htmlText));
+        m_htmlCapture = HtmlCapture::None;
+    }
+    else if (name == "a") {
+        m_htmlCapture = HtmlCapture::Link;
+        m_htmlHref = m_htmlTag.size() < MAX_VALUE_LENGTH ? FindAttribute(m_htmlTag, "href") : std::string();
+        m_htmlText.clear();
+    }
+    else if (name == "/a" && m_htmlCapture == HtmlCapture::Link) {
+        Emit(m_htmlFolders.empty() ? std::string() : m_htmlFolders.back(), Trim(DecodeEntities(m_htmlText)),
+            Trim(DecodeEntities(m_htmlHref)));
+        m_htmlCapture = HtmlCapture::None;
+    }
+    else if (name == "dl") {
+        // The outermost list has no heading; the rest belong to the folder just named
+        m_htmlFolders.push_back(m_pendingFolder);
+        m_pendingFolder.clear();
+    }
+    else if (name == "/dl" && !m_htmlFolders.empty()) {
+        m_htmlFolders.pop_back();
+    }
+}
+
+void BookmarkImporter::Emit(std::string folder, std::string name, std::string url) {
+    if (url.empty()) return;
+    if (name.empty()) name = url;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.push_back(Bookmark{ std::move(folder), std::move(name), std::move(url) });
+    m_parsed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BookmarkImporter::Finish(bool failed) {
+    m_file.close();
+    m_file.clear();
+    m_chunk.clear();
+    m_chunk.shrink_to_fit();
+    m_jsonStack.clear();
+    m_htmlFolders.clear();
+    LOG_INFO("Bookmark import: %zu bookmarks read", m_parsed.load(std::memory_order_relaxed));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_running = false;
+    m_failed = failed;
+    if (m_cancel.load(std::memory_order_relaxed)) m_queue.clear();
+}
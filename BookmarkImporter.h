@@ -0,0 +1,119 @@
+// GameOverlay - BookmarkImporter.h
+// Streaming import of Chrome/Edge JSON and Netscape HTML bookmark files
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "JobSystem.h"
+
+// The file is read in 64 KB chunks, one low priority job per chunk: each job feeds its chunk to an
+// incremental parser (whose state carries over between chunks, so nothing but the chunk and the
+// values being read are ever in memory) and queues the bookmarks it finished. The page takes them
+// in batches on the main thread. Once more than MAX_QUEUED wait, the chain of jobs stops and
+// TakeBatch starts it again when the queue has drained, so a slow consumer holds back the reader.
+//
+// Chrome and Edge write a folder's name after its children, so a JSON bookmark is filed under its
+// root ("Bookmarks Bar", "Other Bookmarks", "Mobile Bookmarks"); an HTML one goes in the nearest
+// folder. The format is told by the first character of the file.
+class BookmarkImporter {
+public:
+    struct Bookmark {
+        std::string folder; // Empty outside any folder
+        std::string name;
+        std::string url;
+    };
+
+    struct Progress {
+        bool active = false;     // Reading, or bookmarks are still queued
+        bool failed = false;     // Unreadable or unknown format; what was read so far is kept
+        uint64_t bytesRead = 0;
+        uint64_t fileSize = 0;
+        size_t bookmarks = 0;    // Parsed so far
+    };
+
+    BookmarkImporter() = default;
+    ~BookmarkImporter(); // Cancels and waits for the job
+
+    // Disable copy and move
+    BookmarkImporter(const BookmarkImporter&) = delete;
+    BookmarkImporter& operator=(const BookmarkImporter&) = delete;
+    BookmarkImporter(BookmarkImporter&&) = delete;
+    BookmarkImporter& operator=(BookmarkImporter&&) = delete;
+
+    // Main thread. False while an import runs or when the file can't be opened
+    bool Start(const std::string& path);
+    void Cancel(); // The queued bookmarks are dropped
+    // Moves up to maxCount parsed bookmarks into batch (cleared first); returns how many
+    size_t TakeBatch(std::vector<Bookmark>& batch, size_t maxCount);
+    Progress GetProgress() const;
+
+private:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+    static constexpr size_t MAX_QUEUED = 4096;
+    static constexpr size_t MAX_VALUE_LENGTH = 64 * 1024; // Longer names and URLs are dropped
+
+    enum class Format { Unknown, Json, Html };
+
+    // JSON: one frame per open object or array
+    struct JsonFrame {
+        bool object = false;
+        bool expectKey = false;
+        std::string key;         // Of the value being read
+        std::string folder;      // Inherited by the frames inside
+        std::string type, name, url;
+    };
+    enum class JsonState { Value, String, Escape, Unicode, Literal };
+
+    enum class HtmlState { Text, Tag };
+    enum class HtmlCapture { None, Folder, Link };
+
+    void SubmitChunk(); // Job chain; one chunk per job
+    void ReadChunk();
+    void Parse(const char* data, size_t size);
+    void ParseJson(char c);
+    void FinishJsonString();
+    void ParseHtml(char c);
+    void FinishHtmlTag();
+    void Emit(std::string folder, std::string name, std::string url);
+    void Finish(bool failed);
+
+    // Parser state; only the job running the chunk touches it
+    std::ifstream m_file;
+    Format m_format = Format::Unknown;
+    bool m_started = false; // Past the byte order mark and the leading whitespace
+    std::vector<char> m_chunk;
+
+    std::vector<JsonFrame> m_jsonStack;
+    JsonState m_jsonState = JsonState::Value;
+    std::string m_jsonString;
+    bool m_jsonCapture = false;  // The string being read is kept (a key, or a value we want)
+    uint32_t m_unicode = 0;
+    int m_unicodeDigits = 0;
+    uint32_t m_highSurrogate = 0;
+
+    HtmlState m_htmlState = HtmlState::Text;
+    HtmlCapture m_htmlCapture = HtmlCapture::None;
+    std::string m_htmlTag;
+    std::string m_htmlText;
+    std::string m_htmlHref;
+    std::string m_pendingFolder; // Last <H3>, becomes the folder at its <DL>
+    std::vector<std::string> m_htmlFolders;
+
+    // Shared with the main thread
+    mutable std::mutex m_mutex;
+    std::deque<Bookmark> m_queue;
+    bool m_running = false;
+    bool m_stalled = false; // Stopped on a full queue; TakeBatch resubmits
+    bool m_failed = false;
+    std::atomic<bool> m_cancel = false;
+    std::atomic<uint64_t> m_bytesRead = 0;
+    uint64_t m_fileSize = 0;
+    std::atomic<size_t> m_parsed = 0;
+    JobCounter m_jobs;
+};
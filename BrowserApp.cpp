@@ -3,18 +3,119 @@
 // CEF application implementation
 
 #include "BrowserApp.h"
+#include "BrowserManager.h"
+#include "TelemetryBridge.h"
+#include "ThreadCycles.h"
+#include <string>
+#include <cstring>
 
-BrowserApp::BrowserApp() {
+// Backs the extension's native functions (render process)
+class BridgeV8Handler : public CefV8Handler {
+public:
+    bool Execute(const CefString& name, CefRefPtr<CefV8Value> object, const CefV8ValueList& arguments,
+        CefRefPtr<CefV8Value>& retval, CefString& exception) override {
+        if (name != "SendMessage") return false;
+        if (arguments.size() < 2 || !arguments[0]->IsString()) {
+            exception = "gameoverlay.sendMessage(name, message) expects a name string";
+            return true;
+        }
+
+        CefRefPtr<CefV8Context> context = CefV8Context::GetCurrentContext();
+        CefRefPtr<CefFrame> frame = context ? context->GetFrame() : nullptr;
+        if (!frame) {
+            retval = CefV8Value::CreateBool(false);
+            return true;
+        }
+
+        CefRefPtr<CefProcessMessage> message = CefProcessMessage::Create(TelemetryBridge::SEND_MESSAGE);
+        CefRefPtr<CefListValue> args = message->GetArgumentList();
+        args->SetString(0, arguments[0]->GetStringValue());
+        args->SetString(1, arguments[1]->IsString() ? arguments[1]->GetStringValue() : CefString());
+        frame->SendProcessMessage(PID_BROWSER, message);
+
+        retval = CefV8Value::CreateBool(true);
+        return true;
+    }
+
+private:
+    IMPLEMENT_REFCOUNTING(BridgeV8Handler);
+};
+
+// Frees telemetry ArrayBuffer storage once V8 collects the buffer
+class TelemetryBufferRelease : public CefV8ArrayBufferReleaseCallback {
+public:
+    void ReleaseBuffer(void* buffer) override { delete[] static_cast<double*>(buffer); }
+
+private:
+    IMPLEMENT_REFCOUNTING(TelemetryBufferRelease);
+};
+
+BrowserApp::BrowserApp(BrowserManager* manager)
+    : m_browserManager(manager) {
+}
+
+void BrowserApp::OnBeforeCommandLineProcessing(const CefString& process_type,
+    CefRefPtr<CefCommandLine> command_line) {
+    // Browser process only (empty type); switches are forwarded to the children
+    if (!process_type.empty() || !m_browserManager) return;
+
+    // Cap the disk cache; Chromium evicts least recently used entries beyond it
+    unsigned int cacheSizeMB = m_browserManager->GetCacheSizeLimitMB();
+    if (cacheSizeMB > 0 && !m_browserManager->GetCachePath().empty()) {
+        command_line->AppendSwitchWithValue("disk-cache-size",
+            std::to_string(static_cast<unsigned long long>(cacheSizeMB) * 1024 * 1024));
+    }
+
+    // GPU policy
+    switch (m_browserManager->GetGpuPolicy()) {
+    case BrowserGpuPolicy::SoftwareRaster:
+        command_line->AppendSwitch("disable-gpu-rasterization");
+        break;
+    case BrowserGpuPolicy::Software:
+        command_line->AppendSwitch("disable-gpu");
+        command_line->AppendSwitch("disable-gpu-compositing");
+        break;
+    default:
+        break;
+    }
+
+    // Renderer process model
+    const BrowserManager::ProcessModelConfig& processModel = m_browserManager->GetProcessModel();
+    if (processModel.processPerSite) {
+        // Strict site isolation would still split cross-site frames into their own processes
+        command_line->AppendSwitch("process-per-site");
+        command_line->AppendSwitch("disable-site-isolation-trials");
+    }
+    if (processModel.rendererProcessLimit > 0) {
+        command_line->AppendSwitchWithValue("renderer-process-limit", std::to_string(processModel.rendererProcessLimit));
+    }
+    if (processModel.v8HeapLimitMB > 0) {
+        command_line->AppendSwitchWithValue("js-flags", "--max-old-space-size=" + std::to_string(processModel.v8HeapLimitMB));
+    }
+    if (!processModel.throttleBackgroundTimers) {
+        command_line->AppendSwitch("disable-background-timer-throttling");
+        command_line->AppendSwitch("disable-renderer-backgrounding");
+    }
 }
 
 void BrowserApp::OnContextInitialized() {
-    // CEF browser context is initialized
+    // On the CEF UI thread: its own with the multi-threaded message loop, else the main thread
+    // (already registered, so this is a no-op)
+    ThreadCycles::RegisterThread(ThreadSubsystem::Browser);
+}
+
+void BrowserApp::OnScheduleMessagePumpWork(int64_t delay_ms) {
+    // May be called from any thread; the main loop does the actual pumping
+    if (m_browserManager) {
+        m_browserManager->SchedulePumpWork(delay_ms);
+    }
 }
 
 void BrowserApp::OnWebKitInitialized() {
     // WebKit is initialized in the render process
 
-    // Register native JS functions for browser<->application communication
+    // Register native JS functions for browser<->application communication.
+    // Telemetry arrives as one Float64Array per batch, indexed like gameoverlay.telemetryKeys.
     static const char* extension_code =
         "var gameoverlay = gameoverlay || {};"
         "(function() {"
@@ -22,9 +123,15 @@ void BrowserApp::OnWebKitInitialized() {
         "    native function SendMessage();"
         "    return SendMessage(name, message);"
         "  };"
+        "  gameoverlay.telemetryKeys = [];"
+        "  gameoverlay.ontelemetry = null;"
+        "  gameoverlay._deliverTelemetry = function(buffer) {"
+        "    if (typeof gameoverlay.ontelemetry === 'function')"
+        "      gameoverlay.ontelemetry(new Float64Array(buffer), gameoverlay.telemetryKeys);"
+        "  };"
         "})();";
 
-    CefRegisterExtension("v8/gameoverlay", extension_code, nullptr);
+    CefRegisterExtension("v8/gameoverlay", extension_code, new BridgeV8Handler());
 }
 
 void BrowserApp::OnContextCreated(CefRefPtr<CefBrowser> browser,
@@ -39,4 +146,69 @@ void BrowserApp::OnContextCreated(CefRefPtr<CefBrowser> browser,
         "window.gameOverlayPhase = 'Phase 2: CEF Integration';";
 
     frame->ExecuteJavaScript(customCode, frame->GetURL(), 0);
+
+    // A new page starts without telemetry key names; ask for them again
+    if (frame->IsMain()) {
+        m_telemetryKeyGenerations.erase(browser->GetIdentifier());
+        frame->SendProcessMessage(PID_BROWSER, CefProcessMessage::Create(TelemetryBridge::KEYS_REQUEST_MESSAGE));
+    }
+}
+
+void BrowserApp::OnBrowserDestroyed(CefRefPtr<CefBrowser> browser) {
+    m_telemetryKeyGenerations.erase(browser->GetIdentifier());
+}
+
+bool BrowserApp::OnProcessMessageReceived(CefRefPtr<CefBrowser> browser,
+    CefRefPtr<CefFrame> frame,
+    CefProcessId source_process,
+    CefRefPtr<CefProcessMessage> message) {
+    const std::string name = message->GetName().ToString();
+    if (name != TelemetryBridge::KEYS_MESSAGE && name != TelemetryBridge::VALUES_MESSAGE) {
+        return false;
+    }
+    if (!frame || !frame->IsMain()) return true;
+
+    CefRefPtr<CefV8Context> context = frame->GetV8Context();
+    if (!context || !context->Enter()) return true;
+
+    CefRefPtr<CefV8Value> gameoverlay = context->GetGlobal()->GetValue("gameoverlay");
+    if (gameoverlay && gameoverlay->IsObject()) {
+        if (name == TelemetryBridge::KEYS_MESSAGE) {
+            // Key names change rarely; keep them on the page object
+            CefRefPtr<CefListValue> args = message->GetArgumentList();
+            CefRefPtr<CefListValue> keys = args->GetList(1);
+            CefRefPtr<CefV8Value> keyArray = CefV8Value::CreateArray(keys ? static_cast<int>(keys->GetSize()) : 0);
+            for (size_t i = 0; keys && i < keys->GetSize(); i++) {
+                keyArray->SetValue(static_cast<int>(i), CefV8Value::CreateString(keys->GetString(i)));
+            }
+            gameoverlay->SetValue("telemetryKeys", keyArray, V8_PROPERTY_ATTRIBUTE_NONE);
+            m_telemetryKeyGenerations[browser->GetIdentifier()] = static_cast<uint32_t>(args->GetInt(0));
+        }
+        else if (CefRefPtr<CefSharedMemoryRegion> region = message->GetSharedMemoryRegion()) {
+            TelemetryBridge::ValuesHeader header;
+            if (region->IsValid() && region->Size() >= sizeof(header)) {
+                memcpy(&header, region->Memory(), sizeof(header));
+                size_t valuesSize = static_cast<size_t>(header.count) * sizeof(double);
+
+                // Values for keys the page doesn't know yet are dropped; the keys are on their way
+                auto generation = m_telemetryKeyGenerations.find(browser->GetIdentifier());
+                if (generation != m_telemetryKeyGenerations.end() && generation->second == header.keyGeneration &&
+                    region->Size() >= sizeof(header) + valuesSize && header.count > 0) {
+                    // The region is gone after this call, so V8 gets its own copy
+                    double* values = new double[header.count];
+                    memcpy(values, static_cast<const uint8_t*>(region->Memory()) + sizeof(header), valuesSize);
+                    CefRefPtr<CefV8Value> buffer = CefV8Value::CreateArrayBuffer(values, valuesSize,
+                        new TelemetryBufferRelease());
+
+                    CefRefPtr<CefV8Value> deliver = gameoverlay->GetValue("_deliverTelemetry");
+                    if (deliver && deliver->IsFunction()) {
+                        deliver->ExecuteFunction(gameoverlay, CefV8ValueList{ buffer });
+                    }
+                }
+            }
+        }
+    }
+
+    context->Exit();
+    return true;
 }
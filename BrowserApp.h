@@ -5,27 +5,46 @@
 #pragma once
 
 #include "cef_app.h"
+#include <map>
+#include <cstdint>
+
+class BrowserManager;
 
 class BrowserApp : public CefApp,
     public CefBrowserProcessHandler,
     public CefRenderProcessHandler {
 public:
-    BrowserApp();
+    // manager receives pump scheduling requests (browser process only, may be null)
+    explicit BrowserApp(BrowserManager* manager = nullptr);
 
     // CefApp methods
+    void OnBeforeCommandLineProcessing(const CefString& process_type,
+        CefRefPtr<CefCommandLine> command_line) override;
     CefRefPtr<CefBrowserProcessHandler> GetBrowserProcessHandler() override { return this; }
     CefRefPtr<CefRenderProcessHandler> GetRenderProcessHandler() override { return this; }
 
     // CefBrowserProcessHandler methods
     void OnContextInitialized() override;
+    void OnScheduleMessagePumpWork(int64_t delay_ms) override; // external_message_pump
 
     // CefRenderProcessHandler methods
     void OnWebKitInitialized() override;
+    void OnBrowserDestroyed(CefRefPtr<CefBrowser> browser) override;
     void OnContextCreated(CefRefPtr<CefBrowser> browser,
         CefRefPtr<CefFrame> frame,
         CefRefPtr<CefV8Context> context) override;
+    // Telemetry from TelemetryBridge, delivered to the page's gameoverlay object
+    bool OnProcessMessageReceived(CefRefPtr<CefBrowser> browser,
+        CefRefPtr<CefFrame> frame,
+        CefProcessId source_process,
+        CefRefPtr<CefProcessMessage> message) override;
 
 private:
+    BrowserManager* m_browserManager = nullptr; // Not owned
+
+    // Render process: telemetry key generation each page has received, by browser id
+    std::map<int, uint32_t> m_telemetryKeyGenerations;
+
     // Include CefBase ref counting
     IMPLEMENT_REFCOUNTING(BrowserApp);
 };
\ No newline at end of file
@@ -3,9 +3,51 @@
 // CEF client implementation for browser instance
 
 #include "BrowserClient.h"
+#include "ContentBlocker.h"
+#include "TelemetryBridge.h"
 
-BrowserClient::BrowserClient(CefRefPtr<BrowserHandler> handler)
-    : m_handler(handler) {
+BrowserClient::BrowserClient(CefRefPtr<BrowserHandler> handler, const ContentBlocker* blocker,
+    TelemetryBridge* bridge)
+    : m_handler(handler), m_contentBlocker(blocker), m_telemetryBridge(bridge) {
+}
+
+bool BrowserClient::OnProcessMessageReceived(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame,
+    CefProcessId source_process, CefRefPtr<CefProcessMessage> message) {
+    return m_telemetryBridge && m_telemetryBridge->HandleProcessMessage(message);
+}
+
+CefRefPtr<CefResourceRequestHandler> BrowserClient::GetResourceRequestHandler(CefRefPtr<CefBrowser> browser,
+    CefRefPtr<CefFrame> frame, CefRefPtr<CefRequest> request, bool is_navigation, bool is_download,
+    const CefString& request_initiator, bool& disable_default_handling) {
+    // No handler at all when blocking is off and no load is measured keeps CEF on its fast path.
+    // A main frame navigation is requested before its load starts, so it always gets one.
+    if (is_download) return nullptr;
+    bool blocking = m_contentBlocker && m_contentBlocker->IsEnabled();
+    bool measuring = m_handler && (m_handler->IsMeasuringNavigation() || (is_navigation && frame && frame->IsMain()));
+    return blocking || measuring ? this : nullptr;
+}
+
+CefResourceRequestHandler::ReturnValue BrowserClient::OnBeforeResourceLoad(CefRefPtr<CefBrowser> browser,
+    CefRefPtr<CefFrame> frame, CefRefPtr<CefRequest> request, CefRefPtr<CefCallback> callback) {
+    // IO thread. Pages the user opens are never blocked, only what they load.
+    if (m_contentBlocker && request->GetResourceType() != RT_MAIN_FRAME &&
+        m_contentBlocker->ShouldBlock(request->GetURL().ToString())) {
+        return RV_CANCEL;
+    }
+    return RV_CONTINUE;
+}
+
+void BrowserClient::OnResourceLoadComplete(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame,
+    CefRefPtr<CefRequest> request, CefRefPtr<CefResponse> response, URLRequestStatus status,
+    int64_t received_content_length) {
+    // IO thread; a request started during the load may finish after it and isn't counted
+    if (!m_handler) return;
+    if (request->GetResourceType() == RT_MAIN_FRAME) {
+        m_handler->AddMainDocumentBytes(received_content_length);
+    }
+    else if (m_handler->IsMeasuringNavigation()) {
+        m_handler->AddNavigationBytes(received_content_length);
+    }
 }
 
 bool BrowserClient::OnJSDialog(CefRefPtr<CefBrowser> browser, const CefString& origin_url,
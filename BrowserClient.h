@@ -5,11 +5,24 @@
 #pragma once
 
 #include "cef_client.h"
+#include "cef_request_handler.h"
+#include "cef_resource_request_handler.h"
 #include "BrowserHandler.h"
 
-class BrowserClient : public CefClient {
+class ContentBlocker;
+class TelemetryBridge;
+
+class BrowserClient : public CefClient,
+    public CefRequestHandler,
+    public CefResourceRequestHandler {
 public:
-    BrowserClient(CefRefPtr<BrowserHandler> handler);
+    // blocker filters subresource requests, bridge takes page messages (not owned, may be null)
+    BrowserClient(CefRefPtr<BrowserHandler> handler, const ContentBlocker* blocker = nullptr,
+        TelemetryBridge* bridge = nullptr);
+
+    // Messages from the page's gameoverlay object (renderer process)
+    bool OnProcessMessageReceived(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame,
+        CefProcessId source_process, CefRefPtr<CefProcessMessage> message) override;
 
     // Handler getters
     CefRefPtr<CefRenderHandler> GetRenderHandler() override { return m_handler; }
@@ -29,8 +42,22 @@ public:
     void OnBeforeContextMenu(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame,
         CefRefPtr<CefContextMenuParams> params, CefRefPtr<CefMenuModel> model) override;
 
+    // Request filtering - ads and trackers are cancelled before they hit the network
+    CefRefPtr<CefRequestHandler> GetRequestHandler() override { return this; }
+    CefRefPtr<CefResourceRequestHandler> GetResourceRequestHandler(CefRefPtr<CefBrowser> browser,
+        CefRefPtr<CefFrame> frame, CefRefPtr<CefRequest> request, bool is_navigation, bool is_download,
+        const CefString& request_initiator, bool& disable_default_handling) override;
+    ReturnValue OnBeforeResourceLoad(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame,
+        CefRefPtr<CefRequest> request, CefRefPtr<CefCallback> callback) override;
+    // Counts what a page receives while its navigation is measured (see BrowserHandler)
+    void OnResourceLoadComplete(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame,
+        CefRefPtr<CefRequest> request, CefRefPtr<CefResponse> response, URLRequestStatus status,
+        int64_t received_content_length) override;
+
 private:
     CefRefPtr<BrowserHandler> m_handler;
+    const ContentBlocker* m_contentBlocker = nullptr;
+    TelemetryBridge* m_telemetryBridge = nullptr;
 
     // Include CefBase ref counting
     IMPLEMENT_REFCOUNTING(BrowserClient);
@@ -11,16 +11,24 @@ void BrowserHandler::SetBrowserManager(BrowserManager* manager) {
     m_browserManager = manager;
 }
 
-void BrowserHandler::SetBrowserSize(int width, int height) {
+void BrowserHandler::SetBrowserSize(int width, int height, float deviceScaleFactor) {
     m_width = width;
     m_height = height;
+    m_deviceScaleFactor = deviceScaleFactor;
     // Note: CefBrowserHost::WasResized needs to be called externally
     // when the logical size changes.
 }
 
-std::string BrowserHandler::GetTitle() const {
+template <typename Change>
+void BrowserHandler::UpdatePageState(Change change) {
     std::lock_guard<std::mutex> lock(m_mutex);
-    return m_title;
+    auto state = std::make_shared<PageState>(*m_pageState);
+    change(*state);
+    std::atomic_store(&m_pageState, std::shared_ptr<const PageState>(std::move(state)));
+}
+
+void BrowserHandler::SetPendingUrl(const std::string& url) {
+    UpdatePageState([&url](PageState& state) { state.url = url; });
 }
 
 bool BrowserHandler::IsLoading() const {
@@ -38,14 +46,69 @@ bool BrowserHandler::GetViewRect(CefRefPtr<CefBrowser> browser, CefRect& rect) {
     return true;
 }
 
+bool BrowserHandler::GetScreenInfo(CefRefPtr<CefBrowser> browser, CefScreenInfo& screenInfo) {
+    // One screen exactly the size of the view
+    CefRect viewRect;
+    GetViewRect(browser, viewRect);
+    screenInfo.device_scale_factor = m_deviceScaleFactor;
+    screenInfo.depth = 24;
+    screenInfo.depth_per_component = 8;
+    screenInfo.is_monochrome = false;
+    screenInfo.rect = viewRect;
+    screenInfo.available_rect = viewRect;
+    return true;
+}
+
 void BrowserHandler::OnPaint(CefRefPtr<CefBrowser> browser, PaintElementType type,
     const RectList& dirtyRects, const void* buffer,
     int width, int height) {
-    // We only care about the main view paint events
-    if (type == PET_VIEW && buffer && m_browserManager) {
+    if (!buffer || !m_browserManager) return;
+
+    if (type == PET_VIEW) {
+        // Paint-to-photon starts here (resolved against the frame statistics)
+        LARGE_INTEGER paintTime;
+        QueryPerformanceCounter(&paintTime);
+        NotePaintForNavigation();
         // Directly call the manager's OnPaint method
         // This decouples the handler from the specific texture update mechanism
-        m_browserManager->OnPaint(buffer, width, height);
+        m_browserManager->OnPaint(m_tabId, buffer, width, height, dirtyRects, paintTime.QuadPart);
+    }
+    else if (type == PET_POPUP) {
+        m_browserManager->OnPopupPaint(m_tabId, buffer, width, height);
+    }
+}
+
+void BrowserHandler::OnAcceleratedPaint(CefRefPtr<CefBrowser> browser, PaintElementType type,
+    const RectList& dirtyRects, const CefAcceleratedPaintInfo& info) {
+    // The handle is only valid for the duration of this callback
+    if (!info.shared_texture_handle || !m_browserManager) return;
+
+    if (type == PET_VIEW) {
+        LARGE_INTEGER paintTime;
+        QueryPerformanceCounter(&paintTime);
+        NotePaintForNavigation();
+        m_browserManager->OnAcceleratedPaint(m_tabId, info.shared_texture_handle, paintTime.QuadPart);
+    }
+    else if (type == PET_POPUP) {
+        m_browserManager->OnPopupAcceleratedPaint(m_tabId, info.shared_texture_handle);
+    }
+}
+
+void BrowserHandler::OnPopupShow(CefRefPtr<CefBrowser> browser, bool show) {
+    if (m_browserManager) {
+        m_browserManager->OnPopupShow(m_tabId, show);
+    }
+}
+
+void BrowserHandler::OnPopupSize(CefRefPtr<CefBrowser> browser, const CefRect& rect) {
+    if (m_browserManager) {
+        m_browserManager->OnPopupSize(m_tabId, rect);
+    }
+}
+
+void BrowserHandler::OnScrollOffsetChanged(CefRefPtr<CefBrowser> browser, double x, double y) {
+    if (m_browserManager) {
+        m_browserManager->OnScrollOffsetChanged(m_tabId, x, y);
     }
 }
 
@@ -53,6 +116,9 @@ void BrowserHandler::OnPaint(CefRefPtr<CefBrowser> browser, PaintElementType typ
 
 void BrowserHandler::OnAfterCreated(CefRefPtr<CefBrowser> browser) {
     m_browserCreated = true;
+    if (m_browserManager) {
+        m_browserManager->OnBrowserCreated(m_tabId, browser);
+    }
 }
 
 bool BrowserHandler::DoClose(CefRefPtr<CefBrowser> browser) {
@@ -63,7 +129,9 @@ bool BrowserHandler::DoClose(CefRefPtr<CefBrowser> browser) {
 void BrowserHandler::OnBeforeClose(CefRefPtr<CefBrowser> browser) {
     m_browserCreated = false;
     m_isLoading = false;
-    // Reset any other relevant state if needed
+    if (m_browserManager) {
+        m_browserManager->OnBrowserClosed(m_tabId, browser);
+    }
 }
 
 // --- CefLoadHandler methods ---
@@ -72,6 +140,30 @@ void BrowserHandler::OnLoadStart(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFra
     TransitionType transition_type) {
     if (frame->IsMain()) {
         m_isLoading = true;
+
+        // Error pages and internal schemes aren't sites
+        std::string url = frame->GetURL().ToString();
+        bool measured = url.compare(0, 7, "http://") == 0 || url.compare(0, 8, "https://") == 0;
+        std::lock_guard<std::mutex> lock(m_navigationStartMutex);
+        if (measured) {
+            m_navigation = NavigationTiming();
+            m_navigation.url = std::move(url);
+            m_navigation.start = std::chrono::steady_clock::now();
+            m_navigationBytes = m_pendingDocumentBytes;
+        }
+        m_pendingDocumentBytes = 0;
+        m_navigationActive = measured;
+    }
+}
+
+void BrowserHandler::AddMainDocumentBytes(int64_t bytes) {
+    if (bytes <= 0) return;
+    std::lock_guard<std::mutex> lock(m_navigationStartMutex);
+    if (m_navigationActive) {
+        m_navigationBytes += static_cast<UINT64>(bytes);
+    }
+    else {
+        m_pendingDocumentBytes += static_cast<UINT64>(bytes);
     }
 }
 
@@ -79,6 +171,7 @@ void BrowserHandler::OnLoadEnd(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame
     int httpStatusCode) {
     if (frame->IsMain()) {
         m_isLoading = false;
+        FinishNavigation(httpStatusCode, 0);
     }
 }
 
@@ -90,8 +183,10 @@ void BrowserHandler::OnLoadError(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFra
 
         // Don't display an error page if the user initiated the stop
         if (errorCode == ERR_ABORTED) {
+            m_navigationActive = false; // Stopped or replaced by another navigation; not a load time
             return;
         }
+        FinishNavigation(0, errorCode);
 
         // Display error page within the frame
         std::string error_html = "<html><body bgcolor=\"#F0F0F0\">"
@@ -104,9 +199,45 @@ void BrowserHandler::OnLoadError(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFra
     }
 }
 
+void BrowserHandler::OnLoadingStateChange(CefRefPtr<CefBrowser> browser, bool isLoading,
+    bool canGoBack, bool canGoForward) {
+    const PageState& current = *GetPageState();
+    if (current.canGoBack == canGoBack && current.canGoForward == canGoForward) return;
+    UpdatePageState([canGoBack, canGoForward](PageState& state) {
+        state.canGoBack = canGoBack;
+        state.canGoForward = canGoForward;
+        });
+}
+
+void BrowserHandler::NotePaintForNavigation() {
+    if (m_navigationActive && m_navigation.firstPaintMs < 0.0f) {
+        m_navigation.firstPaintMs = std::chrono::duration<float, std::milli>(
+            std::chrono::steady_clock::now() - m_navigation.start).count();
+    }
+}
+
+void BrowserHandler::FinishNavigation(int httpStatus, int errorCode) {
+    if (!m_navigationActive) return;
+    m_navigationActive = false;
+    m_navigation.end = std::chrono::steady_clock::now();
+    m_navigation.loadMs = std::chrono::duration<float, std::milli>(m_navigation.end - m_navigation.start).count();
+    m_navigation.httpStatus = httpStatus;
+    m_navigation.errorCode = errorCode;
+    m_navigation.bytes = m_navigationBytes;
+    if (m_browserManager) {
+        m_browserManager->OnNavigationFinished(m_navigation);
+    }
+}
+
 // --- CefDisplayHandler methods ---
 
 void BrowserHandler::OnTitleChange(CefRefPtr<CefBrowser> browser, const CefString& title) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_title = title.ToString();
+    std::string text = title.ToString();
+    UpdatePageState([&text](PageState& state) { state.title = std::move(text); });
+}
+
+void BrowserHandler::OnAddressChange(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame, const CefString& url) {
+    if (!frame->IsMain()) return;
+    std::string text = url.ToString();
+    UpdatePageState([&text](PageState& state) { state.url = std::move(text); });
 }
@@ -9,8 +9,14 @@
 #include "cef_load_handler.h"
 #include "cef_display_handler.h"
 #include <d3d12.h>
+#include <chrono>
 #include <string>
 #include <mutex>
+#include <atomic>
+#include <memory>
+#include "PerformanceMonitor.h" // NavigationTiming
+
+class BrowserManager;
 
 class BrowserHandler : public CefRenderHandler,
     public CefLifeSpanHandler,
@@ -19,19 +25,53 @@ class BrowserHandler : public CefRenderHandler,
 public:
     BrowserHandler();
 
-    // Shared texture for DirectX 12 integration
-    void SetSharedTexture(void* texture) { m_sharedTexture = texture; }
-    void* GetSharedTexture() const { return m_sharedTexture; }
+    void SetBrowserManager(BrowserManager* manager);
+    void SetTabId(int tabId) { m_tabId = tabId; } // Tags callbacks for BrowserManager
+
+    // Page state as an immutable snapshot, replaced whole whenever CEF reports a change (title,
+    // address, history). Readers take the current one without a lock (std::atomic_load), so the UI
+    // never waits on CEF's UI thread and never copies strings; writers serialize on m_mutex.
+    struct PageState {
+        std::string title;
+        std::string url;
+        bool canGoBack = false;
+        bool canGoForward = false;
+    };
+    std::shared_ptr<const PageState> GetPageState() const { return std::atomic_load(&m_pageState); }
+    void SetPendingUrl(const std::string& url); // Shown until the browser reports its address
+
+    // Browser state access (thread-safe; callbacks run on CEF's UI thread, which may not be ours)
+    std::string GetTitle() const { return GetPageState()->title; }
+    bool IsLoading() const;
+    // The view rect the page lays out in, and the device scale factor it rasterizes at: paints are
+    // the view size times the factor, so render quality changes cost a raster pass, not a relayout
+    // (CefBrowserHost::NotifyScreenInfoChanged and WasResized are up to the caller)
+    void SetBrowserSize(int width, int height, float deviceScaleFactor);
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
 
-    // Browser state access
-    std::string GetTitle() const { return m_title; }
-    void SetBrowserSize(int width, int height);
+    // Navigation timing: the main frame load in progress is measured from OnLoadStart, and handed
+    // to BrowserManager::OnNavigationFinished when it ends. The request bytes come from
+    // BrowserClient on CEF's IO thread.
+    bool IsMeasuringNavigation() const { return m_navigationActive; }
+    void AddNavigationBytes(int64_t bytes) { if (bytes > 0) m_navigationBytes += static_cast<UINT64>(bytes); }
+    // The main frame's response, which may complete before its load starts
+    void AddMainDocumentBytes(int64_t bytes);
 
     // CefRenderHandler methods
     bool GetViewRect(CefRefPtr<CefBrowser> browser, CefRect& rect) override;
+    bool GetScreenInfo(CefRefPtr<CefBrowser> browser, CefScreenInfo& screenInfo) override;
     void OnPaint(CefRefPtr<CefBrowser> browser, PaintElementType type,
         const RectList& dirtyRects, const void* buffer,
         int width, int height) override;
+    // Shared texture mode: CEF's GPU process rendered into a D3D11 texture shared by NT handle
+    void OnAcceleratedPaint(CefRefPtr<CefBrowser> browser, PaintElementType type,
+        const RectList& dirtyRects, const CefAcceleratedPaintInfo& info) override;
+    // Popup widgets (PET_POPUP) are painted separately and composited as their own layer
+    void OnPopupShow(CefRefPtr<CefBrowser> browser, bool show) override;
+    void OnPopupSize(CefRefPtr<CefBrowser> browser, const CefRect& rect) override;
+    // Root scroll position in view coordinates, ahead of the paint that shows it
+    void OnScrollOffsetChanged(CefRefPtr<CefBrowser> browser, double x, double y) override;
 
     // CefLifeSpanHandler methods
     void OnAfterCreated(CefRefPtr<CefBrowser> browser) override;
@@ -46,24 +86,42 @@ public:
     void OnLoadError(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame,
         ErrorCode errorCode, const CefString& errorText,
         const CefString& failedUrl) override;
+    void OnLoadingStateChange(CefRefPtr<CefBrowser> browser, bool isLoading,
+        bool canGoBack, bool canGoForward) override;
 
     // CefDisplayHandler methods
     void OnTitleChange(CefRefPtr<CefBrowser> browser, const CefString& title) override;
+    void OnAddressChange(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame, const CefString& url) override;
 
 private:
-    // Shared texture for DirectX 12 integration
-    void* m_sharedTexture = nullptr;
+    // Copies the current snapshot, applies the change and publishes the copy
+    template <typename Change>
+    void UpdatePageState(Change change);
+    void NotePaintForNavigation();
+    void FinishNavigation(int httpStatus, int errorCode);
 
     // Browser state
-    std::string m_title;
-    bool m_isLoading = false;
-    bool m_browserCreated = false;
+    std::shared_ptr<const PageState> m_pageState = std::make_shared<const PageState>();
+    std::atomic<bool> m_isLoading = false;
+    std::atomic<bool> m_browserCreated = false;
 
     // Browser dimensions
-    int m_width = 1024;
-    int m_height = 768;
+    std::atomic<int> m_width = 1024;
+    std::atomic<int> m_height = 768;
+    std::atomic<float> m_deviceScaleFactor = 1.0f;
+
+    // Navigation in progress (CEF's UI thread, but the flag and the bytes)
+    NavigationTiming m_navigation;
+    std::atomic<bool> m_navigationActive = false;
+    std::atomic<UINT64> m_navigationBytes = 0;
+    std::mutex m_navigationStartMutex; // Hands m_pendingDocumentBytes to exactly one navigation
+    UINT64 m_pendingDocumentBytes = 0; // A main frame response completed before its OnLoadStart
+
+    // Not owned; receives paints and browser lifetime notifications
+    BrowserManager* m_browserManager = nullptr;
+    int m_tabId = 0;
 
-    // Thread safety
+    // Serializes page state writers
     std::mutex m_mutex;
 
     // Include CefBase ref counting
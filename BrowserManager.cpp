@@ -5,59 +5,227 @@
 #include "BrowserApp.h"
 #include "BrowserClient.h"
 #include "BrowserView.h" // Include for signalling
+#include "WebWidgetAtlas.h"
+#include "CpuProfiler.h"
+#include "FileUtil.h"
+#include "JobSystem.h"
 #include <sstream>
 #include <filesystem>
 #include <stdexcept> // Include for error checking
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <delayimp.h>
+#include "cef_task.h"
+
+// Wraps a callable for CefPostTask
+class FunctionTask : public CefTask {
+public:
+    explicit FunctionTask(std::function<void()> function) : m_function(std::move(function)) {}
+
+    void Execute() override {
+        if (m_function) m_function();
+    }
+
+private:
+    std::function<void()> m_function;
+
+    IMPLEMENT_REFCOUNTING(FunctionTask);
+};
+
+// How long Shutdown waits for CEF's UI thread to close the browser
+static constexpr int SHUTDOWN_CLOSE_TIMEOUT_MS = 2000;
+
+// Written into a cache directory the overlay created (or found empty); clearing the cache on exit
+// removes only a directory that has it, so a path typed in settings never deletes someone's folder
+static const char* const CACHE_MARKER_NAME = "GameOverlayCache.marker";
+
+static bool IsEmptyDirectory(const std::filesystem::path& path) {
+    std::error_code ec;
+    return std::filesystem::is_directory(path, ec) && std::filesystem::directory_iterator(path, ec) ==
+        std::filesystem::directory_iterator();
+}
+
+// The cache's own directory under %LOCALAPPDATA%\GameOverlay (even from before the marker), or one marked
+static bool IsOwnedCacheDirectory(const std::string& cachePath) {
+    std::error_code ec;
+    const std::filesystem::path path = std::filesystem::weakly_canonical(std::filesystem::u8path(cachePath), ec);
+    if (ec || path.empty() || !path.has_parent_path() || path == path.root_path()) return false;
+    if (cachePath == BrowserManager::GetDefaultCachePath()) return true;
+    return std::filesystem::is_regular_file(path / CACHE_MARKER_NAME, ec);
+}
+
+// Media the freeze paused is marked, so thawing doesn't start what the user had paused
+static const char* const PAUSE_MEDIA_SCRIPT =
+    "document.querySelectorAll('video,audio').forEach(function(m){"
+    "if(!m.paused){m.dataset.overlayFrozen='1';m.pause();}});";
+static const char* const RESUME_MEDIA_SCRIPT =
+    "document.querySelectorAll('video,audio').forEach(function(m){"
+    "if(m.dataset.overlayFrozen){delete m.dataset.overlayFrozen;m.play().catch(function(){});}});";
 
 // BrowserManager Constructor
 BrowserManager::BrowserManager(BrowserView* view)
-    : m_browserHandler(new BrowserHandler()), // Initialize handler first
-    m_browserClient(new BrowserClient(m_browserHandler)), // Initialize client with handler
-    m_browserView(view) // Store pointer to BrowserView
+    : m_browserView(view) // Store pointer to BrowserView
 {
     if (!m_browserView) {
         // Optional: Throw or log error if BrowserView is null
         // throw std::invalid_argument("BrowserView cannot be null in BrowserManager constructor");
     }
+
+    m_cachePath = GetDefaultCachePath();
+
+    // Auto-reset: one wake per request
+    m_pumpWorkEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!m_pumpWorkEvent) {
+        throw std::runtime_error("Failed to create CEF pump work event");
+    }
 }
 
 BrowserManager::~BrowserManager() {
     Shutdown();
-}
 
-bool BrowserManager::Initialize(HINSTANCE hInstance) {
-    // Check if already initialized or in subprocess
-    if (m_initialized || m_isSubprocess) {
-        return m_initialized;
+    if (m_pumpWorkEvent) {
+        CloseHandle(m_pumpWorkEvent);
+        m_pumpWorkEvent = nullptr;
     }
+}
 
-    // Check if we're a CEF subprocess
-    CefMainArgs main_args(hInstance);
+bool BrowserManager::ExecuteSubprocess(HINSTANCE hInstance) {
+    if (m_subprocessChecked) return m_isSubprocess;
+    m_subprocessChecked = true;
 
     // Create the CefApp for the browser process
-    CefRefPtr<BrowserApp> app(new BrowserApp());
+    m_app = new BrowserApp(this);
+
+    // The browser process has no --type; CefExecuteProcess would load libcef only to return -1
+    if (!wcsstr(GetCommandLineW(), L"--type=")) return false;
 
     // Check if this is a subprocess that needs to run CEF's logic and exit
-    int exit_code = CefExecuteProcess(main_args, app, nullptr);
+    CefMainArgs main_args(hInstance);
+    int exit_code = CefExecuteProcess(main_args, m_app, nullptr);
     if (exit_code >= 0) {
         // This is a subprocess - exit with returned code
         m_isSubprocess = true;
-        return false; // Indicate subprocess mode
+        m_subprocessExitCode = exit_code;
+    }
+    return m_isSubprocess;
+}
+
+bool BrowserManager::RunSubprocess(HINSTANCE hInstance, int& exitCode) {
+    // CEF marks every process it launches with --type; the browser process has none
+    if (!wcsstr(GetCommandLineW(), L"--type=")) return false;
+    BrowserManager manager(nullptr);
+    if (!manager.ExecuteSubprocess(hInstance)) return false;
+    exitCode = manager.GetSubprocessExitCode();
+    return true;
+}
+
+void BrowserManager::PrefetchRuntime() {
+    wchar_t modulePath[MAX_PATH];
+    DWORD length = GetModuleFileNameW(nullptr, modulePath, MAX_PATH);
+    if (length == 0 || length >= MAX_PATH) return;
+    std::filesystem::path directory = std::filesystem::path(modulePath).parent_path();
+
+    JobDesc job;
+    job.name = "Prefetch CEF Runtime";
+    job.priority = JobPriority::Low;
+    job.jobClass = JobClass::Efficiency;
+    JobSystem::Get().Submit(job, [directory]() {
+        // Background mode for the job: lowest I/O and memory priority, so the reads never delay
+        // the frame's
+        SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+
+        // Mapped as an image, like the loader will: its pages are shared with the later load
+        HMODULE image = LoadLibraryExW((directory / L"libcef.dll").c_str(), nullptr,
+            LOAD_LIBRARY_AS_IMAGE_RESOURCE | LOAD_LIBRARY_AS_DATAFILE);
+        if (image) {
+            auto* base = reinterpret_cast<uint8_t*>(reinterpret_cast<ULONG_PTR>(image) & ~static_cast<ULONG_PTR>(3));
+            auto* dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER*>(base);
+            auto* ntHeaders = reinterpret_cast<const IMAGE_NT_HEADERS*>(base + dosHeader->e_lfanew);
+            WIN32_MEMORY_RANGE_ENTRY range = { base, ntHeaders->OptionalHeader.SizeOfImage };
+            PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+            // Touching every page waits for the prefetch (and reads whatever it skipped)
+            volatile uint8_t sink = 0;
+            for (SIZE_T offset = 0; offset < range.NumberOfBytes; offset += 4096) {
+                sink = sink + base[offset];
+            }
+            FreeLibrary(image);
+        }
+
+        // Chromium maps its data files itself; reading them fills the file cache it maps from
+        static const wchar_t* const resourceFiles[] = {
+            L"chrome_elf.dll", L"icudtl.dat", L"resources.pak", L"chrome_100_percent.pak",
+            L"chrome_200_percent.pak", L"v8_context_snapshot.bin", L"locales\\en-US.pak",
+        };
+        std::vector<uint8_t> buffer(1024 * 1024);
+        for (const wchar_t* name : resourceFiles) {
+            HANDLE file = CreateFileW((directory / name).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE) continue;
+            DWORD bytesRead = 0;
+            while (ReadFile(file, buffer.data(), static_cast<DWORD>(buffer.size()), &bytesRead, nullptr) && bytesRead > 0) {
+            }
+            CloseHandle(file);
+        }
+
+        SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+    });
+}
+
+bool BrowserManager::Initialize(HINSTANCE hInstance) {
+    // Check if already initialized or in subprocess
+    if (m_initialized || ExecuteSubprocess(hInstance)) {
+        return m_initialized; // False in subprocess mode
     }
 
+    // Delay-loaded: a missing or broken libcef.dll fails here instead of raising at the first CEF call
+    if (FAILED(__HrLoadAllImportsForDll("libcef.dll"))) {
+        OutputDebugStringA("Error: Failed to load libcef.dll.\n");
+        return false;
+    }
+
+    CefMainArgs main_args(hInstance);
+
     // Initialize CEF settings
     CefSettings settings;
     settings.no_sandbox = true; // Required for many environments
-    settings.multi_threaded_message_loop = false; // We run the loop manually
+    // Either CEF runs its own UI thread, or we run the loop manually when CEF asks for it
+    // (OnScheduleMessagePumpWork)
+    settings.multi_threaded_message_loop = m_multiThreadedMessageLoop;
+    settings.external_message_pump = !m_multiThreadedMessageLoop;
     settings.windowless_rendering_enabled = true; // Essential for overlays
 
     // Enable remote debugging on port 8088 (optional, useful for development)
     settings.remote_debugging_port = 8088;
 
-    // Cache settings (adjust as needed)
+    // Cache settings: persistent disk cache when a path is set, incognito (in-memory) otherwise.
+    // The size cap is passed on the command line (BrowserApp::OnBeforeCommandLineProcessing).
     settings.persist_session_cookies = false;
     settings.persist_user_preferences = false;
-    // CefString(&settings.cache_path) = "path/to/cache"; // Optional: Specify a cache path
+    if (!m_cachePath.empty()) {
+        std::error_code ec;
+        const std::filesystem::path cacheDirectory = std::filesystem::u8path(m_cachePath);
+        bool fresh = !std::filesystem::exists(cacheDirectory, ec) || IsEmptyDirectory(cacheDirectory);
+        std::filesystem::create_directories(cacheDirectory, ec);
+        if (ec) {
+            OutputDebugStringA("Warning: Failed to create browser cache directory, using in-memory cache.\n");
+        }
+        else {
+            // Ours to clear from now on; a folder that already held something else never is
+            if (fresh) {
+                const char marker[] = "GameOverlay browser cache\n";
+                WriteFileAtomic((cacheDirectory / CACHE_MARKER_NAME).u8string(), marker, sizeof(marker) - 1);
+            }
+            // cache_path must be root_cache_path or a child of it
+            CefString(&settings.root_cache_path).FromString(m_cachePath);
+            CefString(&settings.cache_path).FromString(m_cachePath);
+        }
+    }
+
+    // No GPU compositing means no shared textures to open
+    if (m_gpuPolicy == BrowserGpuPolicy::Software) {
+        m_sharedTextureEnabled = false;
+    }
 
     // Get current executable path for subprocess
     char szPath[MAX_PATH];
@@ -67,8 +235,17 @@ bool BrowserManager::Initialize(HINSTANCE hInstance) {
     }
     CefString(&settings.browser_subprocess_path).FromASCII(szPath);
 
+    // Build the request filter before any browser can issue requests
+    m_contentBlocker.AddDefaultFilters();
+    std::filesystem::path filterListPath = std::filesystem::path(szPath).parent_path() / "filters.txt";
+    std::error_code existsError;
+    if (std::filesystem::exists(filterListPath, existsError) && !m_contentBlocker.LoadFilterList(filterListPath.string())) {
+        OutputDebugStringA("Warning: Failed to read filters.txt, using the default filter list only.\n");
+    }
+    m_contentBlocker.Compile();
+
     // Initialize CEF
-    if (!CefInitialize(main_args, settings, app, nullptr)) {
+    if (!CefInitialize(main_args, settings, m_app, nullptr)) {
         // Handle error - CEF initialization failed
         return false;
     }
@@ -78,34 +255,218 @@ bool BrowserManager::Initialize(HINSTANCE hInstance) {
 }
 
 void BrowserManager::Shutdown() {
-    // Close any existing browser
-    CloseBrowser(true);
+    m_paintRecorder.Stop();
+
+    // Close every tab's browser
+    std::vector<CefRefPtr<CefBrowser>> browsers;
+    {
+        std::lock_guard<std::mutex> lock(m_tabsMutex);
+        for (const auto& tab : m_tabs) {
+            if (tab->browser) browsers.push_back(tab->browser);
+        }
+    }
+    for (const auto& browser : browsers) {
+        if (browser->GetHost()) browser->GetHost()->CloseBrowser(true);
+    }
+
+    // CEF's UI thread closes them asynchronously; CefShutdown requires them to be gone
+    if (m_initialized && m_multiThreadedMessageLoop) {
+        for (int waitedMs = 0; HasOpenBrowsers() && waitedMs < SHUTDOWN_CLOSE_TIMEOUT_MS; waitedMs += 10) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
 
     // Shut down CEF if initialized and not in subprocess
     if (m_initialized && !m_isSubprocess) {
+        m_pageMetricsSampler->Clear(); // Normally empty by now: closed browsers forget themselves
         CefShutdown();
+
+        // The cache is unlocked only once CEF is down
+        if (m_clearCacheOnExit && !m_cachePath.empty()) {
+            if (!IsOwnedCacheDirectory(m_cachePath)) {
+                OutputDebugStringA("Warning: Not clearing a browser cache directory the overlay didn't create.\n");
+            }
+            else {
+                std::error_code ec;
+                std::filesystem::remove_all(std::filesystem::u8path(m_cachePath), ec);
+                if (ec) {
+                    OutputDebugStringA("Warning: Failed to clear the browser cache.\n");
+                }
+            }
+        }
     }
 
-    m_browser = nullptr;
-    m_browserClient = nullptr; // Release client ref
-    // m_browserHandler is ref-counted, CefClient handles its release
+    {
+        std::lock_guard<std::mutex> lock(m_tabsMutex);
+        m_tabs.clear(); // Releases the handler and client refs
+    }
+    m_activeTabId = 0;
 
     m_initialized = false;
 }
 
+BrowserManager::ProcessModelConfig BrowserManager::GetProcessModelPreset(ProcessModelPreset preset) {
+    ProcessModelConfig config;
+    switch (preset) {
+    case ProcessModelPreset::Default:
+        break;
+    case ProcessModelPreset::Balanced:
+        config.processPerSite = true;
+        config.rendererProcessLimit = 4;
+        config.v8HeapLimitMB = 512;
+        break;
+    case ProcessModelPreset::Minimal:
+        config.processPerSite = true;
+        config.rendererProcessLimit = 1;
+        config.v8HeapLimitMB = 256;
+        break;
+    }
+    return config;
+}
+
+bool BrowserManager::FindProcessModelPreset(const ProcessModelConfig& config, ProcessModelPreset& preset) {
+    for (ProcessModelPreset candidate : { ProcessModelPreset::Default, ProcessModelPreset::Balanced, ProcessModelPreset::Minimal }) {
+        ProcessModelConfig presetConfig = GetProcessModelPreset(candidate);
+        if (presetConfig.processPerSite == config.processPerSite &&
+            presetConfig.rendererProcessLimit == config.rendererProcessLimit &&
+            presetConfig.v8HeapLimitMB == config.v8HeapLimitMB) {
+            preset = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void BrowserManager::SetPagesFrozen(bool frozen) {
+    if (!m_initialized || frozen == m_pagesFrozen.exchange(frozen)) return;
+
+    // DevTools calls belong on CEF's UI thread; the calls only queue, so holding the lock is short
+    PostToUIThread([this, frozen]() {
+        std::lock_guard<std::mutex> lock(m_tabsMutex);
+        for (const auto& tab : m_tabs) {
+            if (tab->browser && !tab->pinned) SetPageFrozen(tab->browser, frozen, tab->mutedBeforeFreeze);
+        }
+    });
+}
+
+void BrowserManager::SetWidgetsFrozen(bool frozen) {
+    if (!m_initialized || frozen == m_widgetsFrozen.exchange(frozen)) return;
+
+    PostToUIThread([this, frozen]() {
+        std::lock_guard<std::mutex> lock(m_tabsMutex);
+        for (const auto& tab : m_tabs) {
+            if (!tab->browser || !tab->pinned) continue;
+            tab->browser->GetHost()->WasHidden(frozen);
+            SetPageFrozen(tab->browser, frozen, tab->mutedBeforeFreeze);
+        }
+    });
+}
+
+void BrowserManager::SetPageFrozen(CefRefPtr<CefBrowser> browser, bool frozen, bool& mutedBeforeFreeze) {
+    CefRefPtr<CefBrowserHost> host = browser->GetHost();
+    if (!host) return;
+
+    // Every frame, iframes included: an embedded player is in a frame of its own
+    auto runInFrames = [&browser](const char* script) {
+        std::vector<CefString> frameIds;
+        browser->GetFrameIdentifiers(frameIds);
+        for (const CefString& frameId : frameIds) {
+            CefRefPtr<CefFrame> frame = browser->GetFrameByIdentifier(frameId);
+            if (frame) frame->ExecuteJavaScript(script, frame->GetURL(), 0);
+        }
+    };
+
+    // Scripts don't run in a frozen page, so media is paused before and resumed after
+    CefRefPtr<CefDictionaryValue> params = CefDictionaryValue::Create();
+    params->SetString("state", frozen ? "frozen" : "active");
+    if (frozen) {
+        runInFrames(PAUSE_MEDIA_SCRIPT);
+        mutedBeforeFreeze = host->IsAudioMuted();
+        host->SetAudioMuted(true);
+        host->ExecuteDevToolsMethod(0, "Page.setWebLifecycleState", params);
+    }
+    else {
+        host->ExecuteDevToolsMethod(0, "Page.setWebLifecycleState", params);
+        host->SetAudioMuted(mutedBeforeFreeze); // A tab the user muted stays muted
+        runInFrames(RESUME_MEDIA_SCRIPT);
+    }
+}
+
+void BrowserManager::PollPageMetrics() {
+    if (!m_initialized) return;
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_lastPageMetricsPoll < std::chrono::milliseconds(PAGE_METRICS_INTERVAL_MS)) return;
+    m_lastPageMetricsPoll = now;
+
+    // DevTools calls belong on CEF's UI thread; the calls only queue, so holding the lock is short
+    PostToUIThread([this]() {
+        std::lock_guard<std::mutex> lock(m_tabsMutex);
+        for (const auto& tab : m_tabs) {
+            if (tab->browser) m_pageMetricsSampler->Poll(tab->browser, tab->id, tab->id == m_activeTabId);
+        }
+    });
+}
+
+void BrowserManager::FlushTelemetry() {
+    if (!m_initialized) return;
+    m_telemetryBridge.Flush(GetBrowser());
+}
+
+std::string BrowserManager::GetDefaultCachePath() {
+    std::string directory = GetAppDataDirectory();
+    if (directory.empty()) {
+        return std::string(); // No profile directory; fall back to the in-memory cache
+    }
+    return directory + "\\BrowserCache";
+}
+
+bool BrowserManager::HasOpenBrowsers() const {
+    std::lock_guard<std::mutex> lock(m_tabsMutex);
+    return std::any_of(m_tabs.begin(), m_tabs.end(), [](const auto& tab) { return tab->browser != nullptr; });
+}
+
 bool BrowserManager::CreateBrowser(const std::string& url) {
     if (!m_initialized || m_isSubprocess) return false;
 
-    // Close any existing browser first
+    int tabId = m_activeTabId;
+    if (tabId == 0) {
+        return OpenTab(url) != 0;
+    }
+
+    // Replace the active tab's browser; the view keeps its last frame until the new one paints
     CloseBrowser(true);
+    return CreateTabBrowser(tabId, url);
+}
+
+bool BrowserManager::CreateTabBrowser(int tabId, const std::string& url) {
+    CefRefPtr<BrowserClient> client;
+    bool pinned = false;
+    int frameRate = m_windowlessFrameRate;
+    {
+        std::lock_guard<std::mutex> lock(m_tabsMutex);
+        Tab* tab = FindTab(tabId);
+        if (!tab) return false;
+        tab->browser = nullptr; // A closing one reports through OnBrowserClosed
+        tab->discarded = false;
+        tab->restoreUrl = url;
+        tab->handler->SetPendingUrl(url);
+        client = tab->client;
+        pinned = tab->pinned;
+        if (pinned) frameRate = tab->frameRate;
+    }
 
     // Configure window info for off-screen rendering
     CefWindowInfo window_info;
     window_info.SetAsWindowless(nullptr); // No parent window needed
+    // Paint into a shared GPU texture (OnAcceleratedPaint) rather than a CPU buffer (OnPaint)
+    window_info.shared_texture_enabled = m_sharedTextureEnabled;
+    // Frames are driven by the render loop (SendExternalBeginFrame) rather than a CEF timer;
+    // pinned widgets keep CEF's timer at their own rate
+    window_info.external_begin_frame_enabled = m_externalBeginFrameEnabled && !pinned;
 
     // Browser settings
     CefBrowserSettings browser_settings;
-    browser_settings.windowless_frame_rate = 60; // Target FPS for rendering
+    browser_settings.windowless_frame_rate = frameRate; // Ignored with external begin frames
 
     // Optional: Set background color (e.g., transparent)
     // browser_settings.background_color = CefColorSetARGB(0, 0, 0, 0);
@@ -113,117 +474,769 @@ bool BrowserManager::CreateBrowser(const std::string& url) {
     // Optional: Web preferences
     // CefString(&browser_settings.default_encoding).FromASCII("UTF-8");
 
-    // Create the browser asynchronously (or use CreateBrowserSync if needed)
-    // Using sync here based on original code structure
-    m_browser = CefBrowserHost::CreateBrowserSync(
-        window_info,
-        m_browserClient, // Use the member client
-        url,
-        browser_settings,
+    // Never CreateBrowserSync: it blocks the calling (render) thread for the renderer process
+    // launch. OnAfterCreated delivers the browser to OnBrowserCreated, which finishes the setup;
+    // the view shows a placeholder until its first paint. False only if CEF rejected the request.
+    return CefBrowserHost::CreateBrowser(window_info, client, url, browser_settings,
         nullptr, // Extra info
         nullptr  // Request context
     );
+}
 
-    if (!m_browser) {
-        // Handle error - Browser creation failed
-        return false;
+CefRefPtr<CefBrowser> BrowserManager::GetBrowser() const {
+    std::lock_guard<std::mutex> lock(m_tabsMutex);
+    Tab* tab = FindTab(m_activeTabId);
+    return tab ? tab->browser : nullptr;
+}
+
+BrowserHandler* BrowserManager::GetBrowserHandler() const {
+    std::lock_guard<std::mutex> lock(m_tabsMutex);
+    Tab* tab = FindTab(m_activeTabId);
+    return tab ? tab->handler.get() : nullptr;
+}
+
+BrowserManager::Tab* BrowserManager::FindTab(int tabId) const {
+    auto it = std::find_if(m_tabs.begin(), m_tabs.end(), [tabId](const auto& tab) { return tab->id == tabId; });
+    return it != m_tabs.end() ? it->get() : nullptr;
+}
+
+void BrowserManager::OnBrowserCreated(int tabId, CefRefPtr<CefBrowser> browser) {
+    bool orphaned = false;
+    bool pinned = false;
+    int frameRate = m_windowlessFrameRate;
+    {
+        std::lock_guard<std::mutex> lock(m_tabsMutex);
+        Tab* tab = FindTab(tabId);
+        orphaned = !tab || tab->discarded;
+        if (!orphaned) {
+            tab->browser = browser;
+            pinned = tab->pinned;
+            if (pinned) frameRate = tab->frameRate;
+        }
+    }
+
+    if (!browser->GetHost()) return;
+
+    // The tab was closed or discarded while its browser was being created
+    if (orphaned) {
+        browser->GetHost()->CloseBrowser(true);
+        return;
+    }
+
+    // Need to explicitly tell the host the initial size and paint rate
+    browser->GetHost()->SetWindowlessFrameRate(frameRate);
+    browser->GetHost()->WasResized();
+    if (tabId != m_activeTabId && !pinned) {
+        browser->GetHost()->WasHidden(true);
+    }
+    if (pinned ? m_widgetsFrozen.load() : m_pagesFrozen.load()) {
+        if (pinned) browser->GetHost()->WasHidden(true);
+        bool muted = false; // A new browser starts unmuted, as the tab's mutedBeforeFreeze says
+        SetPageFrozen(browser, true, muted);
+    }
+}
+
+void BrowserManager::OnBrowserClosed(int tabId, CefRefPtr<CefBrowser> browser) {
+    // A replacement may already exist when the old browser finishes closing
+    std::lock_guard<std::mutex> lock(m_tabsMutex);
+    Tab* tab = FindTab(tabId);
+    if (tab && tab->browser && tab->browser->IsSame(browser)) {
+        tab->browser = nullptr;
+    }
+    m_pageMetricsSampler->Forget(browser);
+}
+
+int BrowserManager::OpenTab(const std::string& url, bool activate) {
+    return CreateTab(url, activate, false);
+}
+
+int BrowserManager::CreateTab(const std::string& url, bool activate, bool prerender) {
+    if (!m_initialized || m_isSubprocess) return 0;
+
+    auto tab = std::make_unique<Tab>();
+    tab->handler = new BrowserHandler();
+    tab->handler->SetBrowserManager(this);
+    tab->handler->SetBrowserSize(m_browserWidth, m_browserHeight, m_deviceScaleFactor);
+    tab->client = new BrowserClient(tab->handler, &m_contentBlocker, &m_telemetryBridge);
+    tab->restoreUrl = url;
+    tab->handler->SetPendingUrl(url);
+    tab->prerender = prerender;
+    tab->lastActiveTime = std::chrono::steady_clock::now();
+
+    int tabId = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_tabsMutex);
+        tabId = m_nextTabId++;
+        tab->id = tabId;
+        tab->handler->SetTabId(tabId);
+        m_tabs.push_back(std::move(tab));
+    }
+
+    // Activate first so the new browser isn't created hidden
+    if (activate || m_activeTabId == 0) {
+        ActivateTab(tabId);
+    }
+
+    if (!CreateTabBrowser(tabId, url)) {
+        CloseTab(tabId);
+        return 0;
+    }
+
+    EnforceLiveTabLimit();
+    return tabId;
+}
+
+int BrowserManager::PinWidget(const std::string& url, int width, int height, int frameRate, UINT64 uploadBudgetBytes) {
+    WebWidgetAtlas* atlas = m_browserView ? m_browserView->GetWebWidgetAtlas() : nullptr;
+    if (!m_initialized || m_isSubprocess || !atlas || width <= 0 || height <= 0) return 0;
+
+    auto tab = std::make_unique<Tab>();
+    tab->handler = new BrowserHandler();
+    tab->handler->SetBrowserManager(this);
+    tab->handler->SetBrowserSize(width, height, 1.0f); // Shown at its size, never scaled
+    tab->client = new BrowserClient(tab->handler, &m_contentBlocker, &m_telemetryBridge);
+    tab->restoreUrl = url;
+    tab->handler->SetPendingUrl(url);
+    tab->pinned = true;
+    tab->frameRate = std::clamp(frameRate, 1, 60);
+    tab->lastActiveTime = std::chrono::steady_clock::now();
+
+    int widgetId = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_tabsMutex);
+        widgetId = m_nextTabId++;
+        tab->id = widgetId;
+        tab->handler->SetTabId(widgetId);
+        m_tabs.push_back(std::move(tab));
+    }
+
+    // The region exists before the first paint can arrive
+    if (!atlas->AddWidget(widgetId, width, height, uploadBudgetBytes) || !CreateTabBrowser(widgetId, url)) {
+        UnpinWidget(widgetId);
+        return 0;
+    }
+    return widgetId;
+}
+
+void BrowserManager::UnpinWidget(int widgetId) {
+    {
+        std::lock_guard<std::mutex> lock(m_tabsMutex);
+        Tab* tab = FindTab(widgetId);
+        if (!tab || !tab->pinned) return;
+    }
+    CloseTab(widgetId);
+    if (WebWidgetAtlas* atlas = m_browserView ? m_browserView->GetWebWidgetAtlas() : nullptr) {
+        atlas->RemoveWidget(widgetId);
+    }
+}
+
+void BrowserManager::CloseTab(int tabId) {
+    CefRefPtr<CefBrowser> browser;
+    int nextActiveTabId = 0;
+    bool wasActive = tabId == m_activeTabId;
+    {
+        std::lock_guard<std::mutex> lock(m_tabsMutex);
+        auto it = std::find_if(m_tabs.begin(), m_tabs.end(), [tabId](const auto& tab) { return tab->id == tabId; });
+        if (it == m_tabs.end()) return;
+
+        browser = (*it)->browser;
+        m_tabs.erase(it);
+
+        // Fall back to the most recently used remaining tab
+        if (wasActive) {
+            m_activeTabId = 0;
+            const Tab* next = nullptr;
+            for (const auto& candidate : m_tabs) {
+                if (!candidate->pinned && (!next || candidate->lastActiveTime > next->lastActiveTime)) next = candidate.get();
+            }
+            if (next) nextActiveTabId = next->id;
+        }
+    }
+
+    if (browser && browser->GetHost()) {
+        browser->GetHost()->CloseBrowser(true);
+    }
+
+    if (wasActive) {
+        if (nextActiveTabId != 0) {
+            ActivateTab(nextActiveTabId);
+        }
+        else if (m_browserView) {
+            m_browserView->OnActiveTabChanged();
+        }
+    }
+    // After the switch, which would otherwise keep the closed tab's last frame
+    if (m_browserView) m_browserView->ForgetTabThumbnail(tabId);
+}
+
+bool BrowserManager::ActivateTab(int tabId) {
+    CefRefPtr<CefBrowser> previousBrowser;
+    CefRefPtr<CefBrowser> browser;
+    std::string restoreUrl;
+    bool restore = false;
+    {
+        std::lock_guard<std::mutex> lock(m_tabsMutex);
+        Tab* tab = FindTab(tabId);
+        if (!tab || tab->pinned) return false;
+        if (tabId == m_activeTabId) return true;
+
+        if (Tab* previous = FindTab(m_activeTabId)) {
+            previous->lastActiveTime = std::chrono::steady_clock::now();
+            previousBrowser = previous->browser;
+        }
+
+        m_activeTabId = tabId;
+        tab->lastActiveTime = std::chrono::steady_clock::now();
+        tab->handler->SetBrowserSize(m_browserWidth, m_browserHeight, m_deviceScaleFactor);
+        browser = tab->browser;
+        restore = tab->discarded;
+        restoreUrl = tab->restoreUrl;
+    }
+
+    // Hidden browsers stop painting and throttle their timers
+    if (previousBrowser && previousBrowser->GetHost()) {
+        previousBrowser->GetHost()->WasHidden(true);
+    }
+
+    // The view texture now belongs to this tab; everything is uploaded again
+    if (m_browserView) {
+        m_browserView->OnActiveTabChanged();
+    }
+
+    if (restore) {
+        CreateTabBrowser(tabId, restoreUrl.empty() ? "about:blank" : restoreUrl);
+        EnforceLiveTabLimit();
+    }
+    else if (browser && browser->GetHost()) {
+        browser->GetHost()->WasHidden(false);
+        browser->GetHost()->NotifyScreenInfoChanged(); // The scale factor may have changed meanwhile
+        browser->GetHost()->WasResized();
+        browser->GetHost()->Invalidate(PET_VIEW);
+    }
+    return true;
+}
+
+std::vector<BrowserManager::TabInfo> BrowserManager::GetTabs() const {
+    std::vector<TabInfo> tabs;
+
+    std::lock_guard<std::mutex> lock(m_tabsMutex);
+    tabs.reserve(m_tabs.size());
+    for (const auto& tab : m_tabs) {
+        if (tab->prerender || tab->pinned) continue;
+        TabInfo info;
+        info.id = tab->id;
+        info.active = tab->id == m_activeTabId;
+        info.discarded = tab->discarded;
+        info.loading = !tab->discarded && tab->handler->IsLoading();
+        info.page = tab->handler->GetPageState(); // Kept by the handler across a discard
+        tabs.push_back(std::move(info));
+    }
+    return tabs;
+}
+
+void BrowserManager::SetMaxLiveTabs(size_t maxLiveTabs) {
+    maxLiveTabs = std::max<size_t>(maxLiveTabs, 1); // The active tab always stays
+    if (m_maxLiveTabs != maxLiveTabs) {
+        m_maxLiveTabs = maxLiveTabs;
+        EnforceLiveTabLimit();
+    }
+}
+
+void BrowserManager::DiscardBackgroundTabs() {
+    ClosePrerenderTabs(0);
+
+    std::vector<int> tabIds;
+    {
+        std::lock_guard<std::mutex> lock(m_tabsMutex);
+        for (const auto& tab : m_tabs) {
+            if (tab->id != m_activeTabId && !tab->discarded && !tab->pinned) tabIds.push_back(tab->id);
+        }
+    }
+    for (int tabId : tabIds) {
+        DiscardTab(tabId);
+    }
+}
+
+bool BrowserManager::DiscardTab(int tabId) {
+    CefRefPtr<CefBrowser> browser;
+    {
+        std::lock_guard<std::mutex> lock(m_tabsMutex);
+        Tab* tab = FindTab(tabId);
+        if (!tab || tab->discarded || tab->pinned || tabId == m_activeTabId) return false;
+
+        // Keep what's needed to restore the tab; the handler's page state still shows it
+        std::shared_ptr<const BrowserHandler::PageState> page = tab->handler->GetPageState();
+        if (!page->url.empty()) {
+            tab->restoreUrl = page->url;
+        }
+        tab->discarded = true;
+        browser = tab->browser;
+        tab->browser = nullptr;
+    }
+
+    if (browser && browser->GetHost()) {
+        browser->GetHost()->CloseBrowser(true);
+    }
+    return true;
+}
+
+void BrowserManager::EnforceLiveTabLimit() {
+    // Discard least recently used background tabs until the live count fits
+    for (;;) {
+        int lruTabId = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_tabsMutex);
+            size_t liveTabs = 0;
+            const Tab* lru = nullptr;
+            for (const auto& tab : m_tabs) {
+                if (tab->discarded || tab->prerender || tab->pinned) continue; // Prerenders have their own budget
+                ++liveTabs;
+                if (tab->id != m_activeTabId && (!lru || tab->lastActiveTime < lru->lastActiveTime)) {
+                    lru = tab.get();
+                }
+            }
+            if (liveTabs <= m_maxLiveTabs || !lru) return;
+            lruTabId = lru->id;
+        }
+        DiscardTab(lruTabId);
+    }
+}
+
+void BrowserManager::SetSpeculativeLoadMode(SpeculativeLoadMode mode) {
+    m_speculativeLoadMode = mode;
+    if (mode != SpeculativeLoadMode::Prerender) {
+        ClosePrerenderTabs(0);
+    }
+}
+
+// Scheme and host of an http(s) URL; empty when it can't be embedded in script safely
+static std::string GetPreconnectOrigin(const std::string& url) {
+    size_t scheme = url.find("://");
+    if (scheme == std::string::npos) return std::string();
+    std::string schemeName = url.substr(0, scheme);
+    if (schemeName != "http" && schemeName != "https") return std::string();
+
+    size_t hostEnd = url.find_first_of("/?#", scheme + 3);
+    std::string origin = url.substr(0, hostEnd);
+    for (char c : origin) {
+        bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+            c == '.' || c == '-' || c == ':' || c == '/' || c == '[' || c == ']';
+        if (!safe) return std::string();
+    }
+    return origin;
+}
+
+void BrowserManager::SpeculateNavigation(const std::string& url) {
+    SpeculativeLoadMode mode = m_speculativeLoadMode;
+    if (!m_initialized || mode == SpeculativeLoadMode::Off || url.empty()) return;
+
+    auto now = std::chrono::steady_clock::now();
+    bool newHover = url != m_speculationUrl ||
+        now - m_lastSpeculationCall > std::chrono::milliseconds(HOVER_GAP_MS);
+    m_lastSpeculationCall = now;
+    if (newHover) {
+        m_speculationUrl = url;
+        m_speculationStart = now;
+
+        // Warm the connection from whatever page is showing
+        std::string origin = GetPreconnectOrigin(url);
+        CefRefPtr<CefBrowser> browser = GetBrowser();
+        if (!origin.empty() && origin != m_preconnectedOrigin && browser && browser->GetMainFrame()) {
+            m_preconnectedOrigin = origin;
+            std::string script =
+                "(function(){var l=document.createElement('link');l.rel='preconnect';l.href='" + origin + "';"
+                "(document.head||document.documentElement).appendChild(l);})();";
+            CefRefPtr<CefFrame> frame = browser->GetMainFrame();
+            frame->ExecuteJavaScript(script, frame->GetURL(), 0);
+        }
+        return;
+    }
+
+    // Prerender only links the user lingers on
+    if (mode != SpeculativeLoadMode::Prerender || m_maxPrerenderTabs == 0 ||
+        now - m_speculationStart < std::chrono::milliseconds(PRERENDER_HOVER_DELAY_MS)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_tabsMutex);
+        for (const auto& tab : m_tabs) {
+            if (tab->prerender && tab->restoreUrl == url) return; // Already loading
+        }
     }
+    // Make room within the budget (oldest first)
+    ClosePrerenderTabs(m_maxPrerenderTabs - 1);
+
+    CreateTab(url, false, true);
+}
 
-    // Need to explicitly tell the host the initial size
-    if (m_browser->GetHost()) {
-        m_browser->GetHost()->WasResized();
+bool BrowserManager::ActivatePrerenderedTab(const std::string& url) {
+    int tabId = 0;
+    int replacedTabId = m_activeTabId;
+    {
+        std::lock_guard<std::mutex> lock(m_tabsMutex);
+        for (const auto& tab : m_tabs) {
+            if (!tab->prerender || !tab->browser) continue;
+            bool matches = tab->restoreUrl == url || tab->handler->GetPageState()->url == url;
+            if (matches) {
+                tab->prerender = false;
+                tabId = tab->id;
+                break;
+            }
+        }
     }
+    if (tabId == 0) return false;
 
+    // The prerendered page takes the current tab's place
+    ActivateTab(tabId);
+    if (replacedTabId != 0 && replacedTabId != tabId) {
+        CloseTab(replacedTabId);
+    }
+    m_speculationUrl.clear();
     return true;
 }
 
+void BrowserManager::ClosePrerenderTabs(size_t keep) {
+    std::vector<int> tabIds;
+    {
+        std::lock_guard<std::mutex> lock(m_tabsMutex);
+        for (const auto& tab : m_tabs) {
+            if (tab->prerender) tabIds.push_back(tab->id); // Creation order, oldest first
+        }
+    }
+    for (size_t i = 0; i + keep < tabIds.size(); i++) {
+        CloseTab(tabIds[i]);
+    }
+}
+
+void BrowserManager::SetBrowserSize(int width, int height, float deviceScaleFactor) {
+    m_browserWidth = width;
+    m_browserHeight = height;
+    m_deviceScaleFactor = deviceScaleFactor;
+
+    // Background tabs pick the size up (and WasResized) when activated
+    if (BrowserHandler* handler = GetBrowserHandler()) {
+        handler->SetBrowserSize(width, height, deviceScaleFactor);
+    }
+}
+
+void BrowserManager::PostToUIThread(std::function<void()> task) {
+    if (!task) return;
+
+    if (!m_multiThreadedMessageLoop || CefCurrentlyOn(TID_UI)) {
+        task();
+        return;
+    }
+    CefPostTask(TID_UI, new FunctionTask(std::move(task)));
+}
+
+void BrowserManager::SetWindowlessFrameRate(int fps) {
+    m_windowlessFrameRate = fps;
+
+    // Hidden tabs don't paint, so only the active one needs it now
+    CefRefPtr<CefBrowser> browser = GetBrowser();
+    if (browser && browser->GetHost()) {
+        browser->GetHost()->SetWindowlessFrameRate(fps);
+    }
+}
+
+void BrowserManager::SendExternalBeginFrame() {
+    CefRefPtr<CefBrowser> browser = GetBrowser();
+    if (browser && browser->GetHost()) {
+        browser->GetHost()->SendExternalBeginFrame();
+    }
+}
+
 void BrowserManager::CloseBrowser(bool forceClose) {
-    if (m_browser && m_browser->GetHost()) {
-        m_browser->GetHost()->CloseBrowser(forceClose);
+    CefRefPtr<CefBrowser> browser = GetBrowser();
+    if (browser && browser->GetHost()) {
+        browser->GetHost()->CloseBrowser(forceClose);
     }
-    // CefLifeSpanHandler::OnBeforeClose will set m_browser to null later
+    // CefLifeSpanHandler::OnBeforeClose clears the tab's browser later (OnBrowserClosed)
 }
 
+// Navigation is posted so the calling (render) thread never waits on CEF's UI thread
+
 void BrowserManager::LoadURL(const std::string& url) {
-    if (m_browser && m_browser->GetMainFrame()) {
-        m_browser->GetMainFrame()->LoadURL(url);
-    }
+    // Already loaded in the background: show it instead of loading again
+    if (ActivatePrerenderedTab(url)) return;
+
+    CefRefPtr<CefBrowser> browser = GetBrowser();
+    if (!browser) return;
+
+    PostToUIThread([browser, url]() {
+        if (browser->GetMainFrame()) {
+            browser->GetMainFrame()->LoadURL(url);
+        }
+    });
 }
 
 void BrowserManager::GoBack() {
-    if (m_browser) {
-        m_browser->GoBack();
+    if (CefRefPtr<CefBrowser> browser = GetBrowser()) {
+        PostToUIThread([browser]() { browser->GoBack(); });
     }
 }
 
 void BrowserManager::GoForward() {
-    if (m_browser) {
-        m_browser->GoForward();
+    if (CefRefPtr<CefBrowser> browser = GetBrowser()) {
+        PostToUIThread([browser]() { browser->GoForward(); });
     }
 }
 
 void BrowserManager::Reload(bool ignoreCache) {
-    if (m_browser) {
-        if (ignoreCache) {
-            m_browser->ReloadIgnoreCache();
-        }
-        else {
-            m_browser->Reload();
-        }
+    if (CefRefPtr<CefBrowser> browser = GetBrowser()) {
+        PostToUIThread([browser, ignoreCache]() {
+            if (ignoreCache) {
+                browser->ReloadIgnoreCache();
+            }
+            else {
+                browser->Reload();
+            }
+        });
     }
 }
 
 void BrowserManager::StopLoad() {
-    if (m_browser) {
-        m_browser->StopLoad();
+    if (CefRefPtr<CefBrowser> browser = GetBrowser()) {
+        PostToUIThread([browser]() { browser->StopLoad(); });
     }
 }
 
 bool BrowserManager::IsLoading() const {
     // Check handler first as browser might be closing
-    return m_browserHandler && m_browserHandler->IsLoading();
+    BrowserHandler* handler = GetBrowserHandler();
+    return handler && handler->IsLoading();
 }
 
-bool BrowserManager::CanGoBack() const {
-    return m_browser ? m_browser->CanGoBack() : false;
+std::shared_ptr<const BrowserHandler::PageState> BrowserManager::GetPageState() const {
+    static const std::shared_ptr<const BrowserHandler::PageState> empty = std::make_shared<const BrowserHandler::PageState>();
+    BrowserHandler* handler = GetBrowserHandler();
+    return handler ? handler->GetPageState() : empty;
 }
 
-bool BrowserManager::CanGoForward() const {
-    return m_browser ? m_browser->CanGoForward() : false;
+void BrowserManager::DoMessageLoopWork() {
+    if (m_initialized && !m_isSubprocess && !m_multiThreadedMessageLoop) {
+        // Cleared first so work scheduled during the pump is kept
+        m_pumpWorkPending = false;
+        m_pumpWorkDeadlineMs = INT64_MAX;
+        {
+            PROFILE_ZONE("CEF Pump");
+            CefDoMessageLoopWork();
+        }
+
+        // Nothing scheduled (or the request got lost): check back at the capped delay
+        if (!m_pumpWorkPending && m_pumpWorkDeadlineMs == INT64_MAX) {
+            SchedulePumpWork(MAX_PUMP_DELAY_MS);
+        }
+    }
 }
 
-std::string BrowserManager::GetURL() const {
-    if (m_browser && m_browser->GetMainFrame()) {
-        return m_browser->GetMainFrame()->GetURL().ToString();
+bool BrowserManager::DoScheduledMessageLoopWork(std::chrono::steady_clock::time_point deadline,
+    std::chrono::steady_clock::duration maxSlice) {
+    if (!IsPumpWorkDue()) return false;
+
+    const bool overdue = m_pumpDeferredSinceMs != 0 &&
+        static_cast<int64_t>(GetTickCount64()) - m_pumpDeferredSinceMs >= MAX_PUMP_DELAY_MS;
+    auto now = std::chrono::steady_clock::now();
+
+    // The peak fades with time, not with slices: rare pumps would otherwise keep an old one forever
+    const float maxSliceMs = std::chrono::duration<float, std::milli>(maxSlice).count();
+    const float sinceDecayMs = std::chrono::duration<float, std::milli>(now - m_pumpSliceEstimateTime).count();
+    m_pumpSliceEstimateMs = std::min(m_pumpSliceEstimateMs * std::exp2(-sinceDecayMs / PUMP_SLICE_HALF_LIFE_MS),
+        maxSliceMs);
+    m_pumpSliceEstimateTime = now;
+    UINT slices = 0;
+    bool outOfBudget = false;
+    while (slices < MAX_PUMP_SLICES && IsPumpWorkDue()) {
+        const auto sliceEstimate = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<float, std::milli>(m_pumpSliceEstimateMs));
+        if (deadline - now < sliceEstimate && !(overdue && slices == 0)) {
+            outOfBudget = true;
+            break;
+        }
+
+        DoMessageLoopWork();
+        const auto sliceEnd = std::chrono::steady_clock::now();
+        const float sliceMs = std::chrono::duration<float, std::milli>(sliceEnd - now).count();
+        m_pumpSliceEstimateMs = std::min(std::max(sliceMs, m_pumpSliceEstimateMs), maxSliceMs);
+        m_pumpSliceEstimateTime = sliceEnd;
+        m_pumpFrame.ms += sliceMs;
+        m_pumpFrame.maxSliceMs = std::max(m_pumpFrame.maxSliceMs, sliceMs);
+        m_pumpFrame.slices++;
+        if (sliceEnd > deadline) m_pumpFrame.overruns++;
+        now = sliceEnd;
+        slices++;
+    }
+
+    // Left for after Present or the next wake
+    if (outOfBudget) {
+        m_pumpFrame.deferred = true;
+        if (m_pumpDeferredSinceMs == 0) m_pumpDeferredSinceMs = static_cast<int64_t>(GetTickCount64());
+    }
+    else {
+        m_pumpDeferredSinceMs = 0;
     }
-    return "";
+    return slices > 0;
 }
 
-std::string BrowserManager::GetTitle() const {
-    // Get title from handler as it's updated via callbacks
-    return m_browserHandler ? m_browserHandler->GetTitle() : "";
+CefPumpFrame BrowserManager::TakePumpFrame() {
+    CefPumpFrame frame = m_pumpFrame;
+    m_pumpFrame = CefPumpFrame();
+    return frame;
 }
 
-void BrowserManager::DoMessageLoopWork() {
-    if (m_initialized && !m_isSubprocess) {
-        CefDoMessageLoopWork();
+void BrowserManager::SchedulePumpWork(int64_t delayMs) {
+    if (delayMs <= 0) {
+        m_pumpWorkPending = true;
+        SetEvent(m_pumpWorkEvent);
+        return;
     }
+
+    // Keep the earliest deadline
+    delayMs = std::min(delayMs, MAX_PUMP_DELAY_MS);
+    int64_t deadline = static_cast<int64_t>(GetTickCount64()) + delayMs;
+    int64_t current = m_pumpWorkDeadlineMs.load();
+    while (deadline < current && !m_pumpWorkDeadlineMs.compare_exchange_weak(current, deadline)) {
+    }
+
+    // Wake the main loop so it picks up the new timeout
+    SetEvent(m_pumpWorkEvent);
+}
+
+bool BrowserManager::IsPumpWorkDue() const {
+    if (!m_initialized || m_isSubprocess || m_multiThreadedMessageLoop) return false;
+    if (m_pumpWorkPending) return true;
+
+    int64_t deadline = m_pumpWorkDeadlineMs.load();
+    return deadline != INT64_MAX && deadline <= static_cast<int64_t>(GetTickCount64());
+}
+
+DWORD BrowserManager::GetPumpWorkTimeoutMs() const {
+    if (!m_initialized || m_isSubprocess || m_multiThreadedMessageLoop) return INFINITE;
+    if (m_pumpDeferredSinceMs != 0) {
+        int64_t untilOverdue = m_pumpDeferredSinceMs + MAX_PUMP_DELAY_MS - static_cast<int64_t>(GetTickCount64());
+        return untilOverdue <= 0 ? 0 : static_cast<DWORD>(untilOverdue);
+    }
+    if (m_pumpWorkPending) return 0;
+
+    int64_t deadline = m_pumpWorkDeadlineMs.load();
+    if (deadline == INT64_MAX) return INFINITE;
+
+    int64_t remaining = deadline - static_cast<int64_t>(GetTickCount64());
+    if (remaining <= 0) return 0;
+    return static_cast<DWORD>(std::min<int64_t>(remaining, MAX_PUMP_DELAY_MS));
 }
 
 // This method is now called by BrowserHandler when OnPaint occurs
-void BrowserManager::OnPaint(const void* buffer, int width, int height) {
-    if (m_browserView && buffer) {
+void BrowserManager::OnPaint(int tabId, const void* buffer, int width, int height, const CefRenderHandler::RectList& dirtyRects,
+    LONGLONG paintQpc) {
+    // Pinned widgets paint into the atlas, which ignores other tabs
+    if (m_browserView && buffer && tabId != m_activeTabId) {
+        std::vector<RECT> rects;
+        rects.reserve(dirtyRects.size());
+        for (const CefRect& rect : dirtyRects) {
+            rects.push_back({ rect.x, rect.y, rect.x + rect.width, rect.y + rect.height });
+        }
+        if (WebWidgetAtlas* atlas = m_browserView->GetWebWidgetAtlas()) {
+            atlas->OnPaint(tabId, buffer, width, height, rects);
+            WakeMainLoopForPaint();
+        }
+        return;
+    }
+
+    // A tab switched away from may still deliver a last paint
+    if (m_browserView && buffer && tabId == m_activeTabId) {
+        std::vector<RECT> rects;
+        rects.reserve(dirtyRects.size());
+        for (const CefRect& rect : dirtyRects) {
+            rects.push_back({ rect.x, rect.y, rect.x + rect.width, rect.y + rect.height });
+        }
+
+        if (m_paintRecorder.IsRecording()) {
+            m_paintRecorder.RecordPaint(buffer, width, height, rects);
+        }
+
         // Signal BrowserView that new texture data is available in the upload buffer
-        m_browserView->SignalTextureUpdateFromHandler(buffer, width, height);
+        m_browserView->SignalTextureUpdateFromHandler(buffer, width, height, rects, paintQpc);
+        WakeMainLoopForPaint();
+    }
+}
+
+void BrowserManager::OnAcceleratedPaint(int tabId, HANDLE sharedHandle, LONGLONG paintQpc) {
+    if (m_browserView && sharedHandle && tabId != m_activeTabId) {
+        if (WebWidgetAtlas* atlas = m_browserView->GetWebWidgetAtlas()) {
+            atlas->OnAcceleratedPaint(tabId, sharedHandle);
+            WakeMainLoopForPaint();
+        }
+        return;
+    }
+    if (m_browserView && sharedHandle && tabId == m_activeTabId) {
+        m_browserView->SignalSharedTextureFromHandler(sharedHandle, paintQpc);
+        WakeMainLoopForPaint();
+    }
+}
+
+void BrowserManager::OnPopupShow(int tabId, bool show) {
+    if (m_browserView && tabId == m_activeTabId) {
+        m_browserView->SignalPopupShowFromHandler(show);
+        WakeMainLoopForPaint();
+    }
+}
+
+void BrowserManager::OnPopupSize(int tabId, const CefRect& rect) {
+    if (m_browserView && tabId == m_activeTabId) {
+        m_browserView->SignalPopupSizeFromHandler({ rect.x, rect.y, rect.x + rect.width, rect.y + rect.height });
+    }
+}
+
+void BrowserManager::OnScrollOffsetChanged(int tabId, double x, double y) {
+    if (m_browserView && tabId == m_activeTabId) {
+        m_browserView->SignalScrollOffsetFromHandler(x, y);
+    }
+}
+
+void BrowserManager::OnPopupPaint(int tabId, const void* buffer, int width, int height) {
+    if (m_browserView && buffer && tabId == m_activeTabId) {
+        m_browserView->SignalPopupPaintFromHandler(buffer, width, height);
+        WakeMainLoopForPaint();
+    }
+}
+
+void BrowserManager::OnPopupAcceleratedPaint(int tabId, HANDLE sharedHandle) {
+    if (m_browserView && sharedHandle && tabId == m_activeTabId) {
+        m_browserView->SignalPopupSharedTextureFromHandler(sharedHandle);
+        WakeMainLoopForPaint();
+    }
+}
+
+void BrowserManager::OnNavigationFinished(const NavigationTiming& timing) {
+    std::lock_guard<std::mutex> lock(m_navigationMutex);
+    if (m_finishedNavigations.size() >= MAX_QUEUED_NAVIGATIONS) {
+        m_finishedNavigations.erase(m_finishedNavigations.begin());
+    }
+    m_finishedNavigations.push_back(timing);
+}
+
+void BrowserManager::TakeNavigationTimings(std::vector<NavigationTiming>& timings) {
+    timings.clear();
+    std::lock_guard<std::mutex> lock(m_navigationMutex);
+    timings.swap(m_finishedNavigations);
+}
+
+void BrowserManager::WakeMainLoopForPaint() {
+    // Paints on CEF's own UI thread would otherwise wait for the next unrelated wake
+    if (m_multiThreadedMessageLoop) {
+        SetEvent(m_pumpWorkEvent);
     }
 }
 
 unsigned int BrowserManager::GetBrowserWidth() const {
     // Get dimensions from the handler, which holds the correct size
-    return m_browserHandler ? m_browserHandler->GetWidth() : 0;
+    BrowserHandler* handler = GetBrowserHandler();
+    return handler ? handler->GetWidth() : 0;
 }
 
 unsigned int BrowserManager::GetBrowserHeight() const {
     // Get dimensions from the handler
-    return m_browserHandler ? m_browserHandler->GetHeight() : 0;
+    BrowserHandler* handler = GetBrowserHandler();
+    return handler ? handler->GetHeight() : 0;
 }
\ No newline at end of file
@@ -8,10 +8,21 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <functional>
+#include <chrono>
 #include "cef_app.h"
 #include "cef_client.h"
 #include "cef_browser.h"
 #include "BrowserHandler.h"
+#include "BrowserClient.h"
+#include "PerformanceMonitor.h" // BrowserGpuPolicy
+#include "ContentBlocker.h"
+#include "TelemetryBridge.h"
+#include "PaintTrace.h"
+#include "PageMetricsSampler.h"
 
 // Forward declaration
 class BrowserView;
@@ -29,12 +40,84 @@ public:
     BrowserManager& operator=(BrowserManager&&) = delete;
 
     // CEF initialization
+    // ExecuteSubprocess must run first thing at startup; it returns true when this process is a
+    // CEF subprocess (which has already done its work). Initialize (CefInitialize) can come later.
+    bool ExecuteSubprocess(HINSTANCE hInstance);
+    int GetSubprocessExitCode() const { return m_subprocessExitCode; }
+    // For the top of WinMain, before any window or device exists: when the command line is a CEF
+    // subprocess's (--type=), runs it through a view-less manager and returns true with its exit code
+    static bool RunSubprocess(HINSTANCE hInstance, int& exitCode);
+    // libcef.dll is delay-loaded, so the browser process doesn't map it before WinMain; this starts
+    // a background job (low I/O priority) that reads it and CEF's resource files, so CefInitialize
+    // finds their pages in memory. Call once, early in the browser process.
+    static void PrefetchRuntime();
     bool Initialize(HINSTANCE hInstance);
     void Shutdown();
 
-    // Browser management
+    // Browser management (the active tab; CreateBrowser opens the first tab if there is none)
     bool CreateBrowser(const std::string& url);
     void CloseBrowser(bool forceClose = false);
+    CefRefPtr<CefBrowser> GetBrowser() const;
+
+    // Tabs: each has its own CEF browser, only the active one is visible and paints into the view's
+    // texture. Background tabs are hidden (WasHidden) so CEF stops painting them; past the live tab
+    // limit the least recently used ones are discarded (browser closed, URL kept) and restored
+    // when activated again.
+    struct TabInfo {
+        int id = 0;
+        std::shared_ptr<const BrowserHandler::PageState> page; // Title and URL, also of a discarded tab
+        bool active = false;
+        bool discarded = false;
+        bool loading = false;
+    };
+    int OpenTab(const std::string& url, bool activate = true); // Returns the tab id, 0 on failure
+    void CloseTab(int tabId);
+    bool ActivateTab(int tabId);
+    int GetActiveTabId() const { return m_activeTabId; }
+    std::vector<TabInfo> GetTabs() const;
+    void SetMaxLiveTabs(size_t maxLiveTabs);
+    size_t GetMaxLiveTabs() const { return m_maxLiveTabs; }
+    void DiscardBackgroundTabs(); // Memory pressure: close every hidden tab's browser
+    bool DiscardTab(int tabId);   // Closes a hidden tab's browser (never the active one); false if it had none
+
+    // While the overlay is hidden, WasHidden alone leaves timers, sockets and media decode running.
+    // Frozen, every tab and prerender (not pinned widgets) has its playing media paused in every
+    // frame, its audio muted and its page put in the frozen web lifecycle state (DevTools Page.setWebLifecycleState),
+    // so no task runs at all; thawing reverses it and resumes only what freezing paused.
+    void SetPagesFrozen(bool frozen);
+    bool ArePagesFrozen() const { return m_pagesFrozen; }
+
+    // Pinned web widgets (chat, alerts, a map): small browsers that stay visible, laid out at the
+    // widget size and painting on CEF's own clock at their own rate (no external begin frames)
+    // into their region of BrowserView's widget atlas. They aren't tabs: never listed, activated,
+    // discarded or counted against the live tab limit. Returns the widget id, 0 on failure.
+    int PinWidget(const std::string& url, int width, int height, int frameRate, UINT64 uploadBudgetBytes);
+    void UnpinWidget(int widgetId);
+    // While nothing shows the HUD (the overlay window hidden, minimized or covered) the widgets are
+    // hidden and frozen like tabs, and come back when it is shown again
+    void SetWidgetsFrozen(bool frozen);
+
+    // Speculative loading for links the user is pointing at (UI calls this every frame while a
+    // link is hovered). Preconnect injects <link rel=preconnect> into the active page, so DNS, TCP
+    // and TLS are done before the click. Prerender additionally loads the page in a hidden tab
+    // after a short hover; LoadURL on that URL then swaps the tab in instead of navigating.
+    enum class SpeculativeLoadMode {
+        Off,
+        Preconnect,
+        Prerender
+    };
+    void SetSpeculativeLoadMode(SpeculativeLoadMode mode);
+    SpeculativeLoadMode GetSpeculativeLoadMode() const { return m_speculativeLoadMode; }
+    void SetMaxPrerenderTabs(size_t maxTabs) { m_maxPrerenderTabs = maxTabs; } // Memory budget
+    void SpeculateNavigation(const std::string& url);
+
+    // Size for every tab's view rect; the active tab is told immediately, others on activation
+    // Layout size and the factor paints are scaled by (render quality), for every tab
+    void SetBrowserSize(int width, int height, float deviceScaleFactor);
+
+    // Lifetime notifications from BrowserHandler (CEF UI thread)
+    void OnBrowserCreated(int tabId, CefRefPtr<CefBrowser> browser);
+    void OnBrowserClosed(int tabId, CefRefPtr<CefBrowser> browser);
 
     // Browser interaction
     void LoadURL(const std::string& url);
@@ -43,38 +126,239 @@ public:
     void Reload(bool ignoreCache = false);
     void StopLoad();
 
-    // Browser state
+    // Browser state of the active tab. GetPageState is the snapshot the others read; hold on to it
+    // for a frame instead of fetching each field (never null)
+    std::shared_ptr<const BrowserHandler::PageState> GetPageState() const;
     bool IsLoading() const;
-    bool CanGoBack() const;
-    bool CanGoForward() const;
-    std::string GetURL() const;
-    std::string GetTitle() const;
+    bool CanGoBack() const { return GetPageState()->canGoBack; }
+    bool CanGoForward() const { return GetPageState()->canGoForward; }
+    std::string GetURL() const { return GetPageState()->url; }
+    std::string GetTitle() const { return GetPageState()->title; }
+
+    // Multi-threaded message loop: CEF runs its own UI thread, so layout and JS never stall a
+    // frame. Paints arrive on that thread and navigation is posted to it. Set before Initialize.
+    void SetMultiThreadedMessageLoopEnabled(bool enabled) { m_multiThreadedMessageLoop = enabled; }
+    bool IsMultiThreadedMessageLoop() const { return m_multiThreadedMessageLoop; }
+    void PostToUIThread(std::function<void()> task); // Runs inline in single-threaded mode
+
+    // Disk cache: with a path, repeat loads come from disk and Chromium's in-memory cache stays
+    // small; empty runs CEF in incognito mode (memory only). Chromium evicts least recently used
+    // entries once the cache reaches the cap. Set before Initialize.
+    void SetCachePath(const std::string& path) { m_cachePath = path; }
+    const std::string& GetCachePath() const { return m_cachePath; }
+    void SetCacheSizeLimitMB(unsigned int sizeMB) { m_cacheSizeLimitMB = sizeMB; } // 0 = Chromium's default
+    unsigned int GetCacheSizeLimitMB() const { return m_cacheSizeLimitMB; }
+    void SetClearCacheOnExit(bool clear) { m_clearCacheOnExit = clear; } // Deleted after CefShutdown, only if the overlay created it
+    bool GetClearCacheOnExit() const { return m_clearCacheOnExit; }
+    static std::string GetDefaultCachePath(); // %LOCALAPPDATA%\GameOverlay\BrowserCache
+
+    // Native values for web widgets; FlushTelemetry (once per frame) sends the changed batch to
+    // the active tab
+    TelemetryBridge& GetTelemetryBridge() { return m_telemetryBridge; }
+    void FlushTelemetry();
+
+    // Renderer-side metrics (JS heap, DOM size, layout and script time) of every live tab: the main
+    // loop calls PollPageMetrics each frame, which asks the tabs every PAGE_METRICS_INTERVAL_MS
+    static constexpr int PAGE_METRICS_INTERVAL_MS = 2000;
+    void PollPageMetrics();
+    std::shared_ptr<const std::vector<PageMetrics>> GetPageMetrics() const { return m_pageMetricsSampler->GetMetrics(); }
+
+    // Active tab's software paints, written to a file for PaintTraceReplay (shared texture
+    // paints carry no pixels, so disable them before the browser starts)
+    PaintTraceRecorder& GetPaintRecorder() { return m_paintRecorder; }
+
+    // Ad and tracker blocking for every tab. Filled with the default list plus filters.txt next
+    // to the executable (if present) on Initialize; toggling applies to new requests immediately.
+    ContentBlocker& GetContentBlocker() { return m_contentBlocker; }
+    const ContentBlocker& GetContentBlocker() const { return m_contentBlocker; }
+
+    // Chromium GPU usage; competes with the game for the GPU and its driver queues, so lighter
+    // policies trade browser smoothness for game frame time. Software also turns off shared
+    // texture paint (it needs GPU compositing). Process-wide switches: set before Initialize.
+    void SetGpuPolicy(BrowserGpuPolicy policy) { m_gpuPolicy = policy; }
+    BrowserGpuPolicy GetGpuPolicy() const { return m_gpuPolicy; }
+
+    // Renderer process model, applied as Chromium switches in BrowserApp::OnBeforeCommandLineProcessing.
+    // Every renderer process has its own fixed cost before page content, so sharing them matters
+    // while a game holds most of the memory:
+    //   Default  - site-per-process, no limit
+    //   Balanced - process-per-site, 4 renderers, 512 MB V8 heaps
+    //   Minimal  - process-per-site, 1 renderer, 256 MB V8 heap
+    // Minimal puts every tab in one renderer, so a crash or a busy page takes all of them down.
+    enum class ProcessModelPreset {
+        Default,
+        Balanced,
+        Minimal
+    };
+    struct ProcessModelConfig {
+        bool processPerSite = false;         // Share one renderer per site instead of one per site instance
+        int rendererProcessLimit = 0;        // 0 = Chromium's default (based on system memory)
+        int v8HeapLimitMB = 0;               // Old-space cap per renderer, 0 = V8's default
+        bool throttleBackgroundTimers = true; // Chromium's throttling of hidden-tab timers and frames
+    };
+    static ProcessModelConfig GetProcessModelPreset(ProcessModelPreset preset);
+    // The preset whose config matches (throttling aside); false for a config of its own
+    static bool FindProcessModelPreset(const ProcessModelConfig& config, ProcessModelPreset& preset);
+    void SetProcessModel(const ProcessModelConfig& config) { m_processModel = config; } // Set before Initialize
+    const ProcessModelConfig& GetProcessModel() const { return m_processModel; }
+
+    // Paint rate for CEF's own frame clock; applies immediately and to browsers created afterwards
+    void SetWindowlessFrameRate(int fps);
 
-    // CEF process handling
+    // CEF process handling (no-ops with the multi-threaded message loop)
     void DoMessageLoopWork();
+    // Pumps only if CEF asked for it, in slices while work stays due and the deadline leaves room
+    // for another one. A CefDoMessageLoopWork call can't be cut short, so a slice isn't started
+    // with less time left than recent slices took (a peak decaying with wall time, capped at
+    // maxSlice so one long slice can't defer CEF for good); the rest stays scheduled for the next
+    // call. Work deferred for MAX_PUMP_DELAY_MS gets one slice regardless of the deadline.
+    // Returns true if it pumped.
+    bool DoScheduledMessageLoopWork(std::chrono::steady_clock::time_point deadline, std::chrono::steady_clock::duration maxSlice);
+    CefPumpFrame TakePumpFrame(); // Pump time since the last call
 
-    // Rendering - Called by BrowserHandler's OnPaint via BrowserClient
-    void OnPaint(const void* buffer, int width, int height);
+    // Pump scheduling (thread-safe, called from BrowserApp::OnScheduleMessagePumpWork): the main
+    // loop waits on the event and the timeout, then calls DoScheduledMessageLoopWork. With the
+    // multi-threaded message loop the event only wakes the main loop for new paints. Deferred work
+    // doesn't end the wait early; the timeout runs until it is overdue.
+    void SchedulePumpWork(int64_t delayMs);
+    bool IsPumpWorkDue() const;
+    HANDLE GetPumpWorkEvent() const { return m_pumpWorkEvent; }
+    DWORD GetPumpWorkTimeoutMs() const;
+
+    // Rendering - Called by BrowserHandler's OnPaint via BrowserClient; background tabs are ignored
+    void OnPaint(int tabId, const void* buffer, int width, int height, const CefRenderHandler::RectList& dirtyRects,
+        LONGLONG paintQpc);
+    void OnAcceleratedPaint(int tabId, HANDLE sharedHandle, LONGLONG paintQpc);
+    void OnPopupShow(int tabId, bool show);
+    void OnPopupSize(int tabId, const CefRect& rect);
+    void OnPopupPaint(int tabId, const void* buffer, int width, int height);
+    void OnPopupAcceleratedPaint(int tabId, HANDLE sharedHandle);
+    void OnScrollOffsetChanged(int tabId, double x, double y);
+    // Navigation timing (thread-safe): finished loads of every tab, prerendered ones included,
+    // queued until the main loop takes them for PerformanceMonitor::RecordNavigation
+    void OnNavigationFinished(const NavigationTiming& timing);
+    void TakeNavigationTimings(std::vector<NavigationTiming>& timings); // Replaces the contents
     unsigned int GetBrowserWidth() const; // Use handler's width
     unsigned int GetBrowserHeight() const; // Use handler's height
 
-    // Handler access
-    BrowserHandler* GetBrowserHandler() { return m_browserHandler.get(); }
+    // Handler access (active tab)
+    BrowserHandler* GetBrowserHandler() const;
+
+    // External begin frames: CEF paints only after SendExternalBeginFrame instead of on its own
+    // windowless_frame_rate clock; applies to browsers created afterwards
+    void SetExternalBeginFrameEnabled(bool enabled) { m_externalBeginFrameEnabled = enabled; }
+    bool IsExternalBeginFrameEnabled() const { return m_externalBeginFrameEnabled && GetBrowser() != nullptr; }
+    void SendExternalBeginFrame();
+
+    // Shared texture (accelerated paint) mode; applies to browsers created afterwards
+    void SetSharedTextureEnabled(bool enabled) { m_sharedTextureEnabled = enabled; }
+    bool IsSharedTextureEnabled() const { return m_sharedTextureEnabled; }
 
 private:
     // Initialize CEF subprocess
     bool InitializeSubprocess();
 
-    // CEF objects
-    CefRefPtr<CefBrowser> m_browser;
-    CefRefPtr<BrowserHandler> m_browserHandler;
-    CefRefPtr<BrowserClient> m_browserClient; // Keep ref to client
+    void WakeMainLoopForPaint();
+
+    struct Tab {
+        int id = 0;
+        CefRefPtr<BrowserHandler> handler;
+        CefRefPtr<BrowserClient> client;   // Keep ref to client
+        CefRefPtr<CefBrowser> browser;     // Null while being created or when discarded
+        std::string restoreUrl;            // Last known URL, used to restore a discarded tab
+        bool discarded = false;
+        bool prerender = false;            // Hidden speculative load, not shown as a tab
+        bool pinned = false;               // Web widget: always visible, own size and paint rate
+        bool mutedBeforeFreeze = false;    // Audio mute state freezing found, restored by thawing
+        int frameRate = 0;                 // Pinned only
+        std::chrono::steady_clock::time_point lastActiveTime;
+    };
+    Tab* FindTab(int tabId) const; // Caller holds m_tabsMutex
+    int CreateTab(const std::string& url, bool activate, bool prerender);
+    bool CreateTabBrowser(int tabId, const std::string& url);
+    void EnforceLiveTabLimit();
+    bool HasOpenBrowsers() const;
+    bool ActivatePrerenderedTab(const std::string& url);
+    void ClosePrerenderTabs(size_t keep);
+
+    // CEF objects; browsers are set from OnAfterCreated, possibly on CEF's UI thread
+    mutable std::mutex m_tabsMutex;
+    std::vector<std::unique_ptr<Tab>> m_tabs;
+    std::atomic<int> m_activeTabId = 0;
+    int m_nextTabId = 1;
+    size_t m_maxLiveTabs = 4;
+    float m_deviceScaleFactor = 1.0f;
+    int m_browserWidth = 1024;
+    int m_browserHeight = 768;
+
+    // Speculative loading (UI thread)
+    static constexpr int PRERENDER_HOVER_DELAY_MS = 300;
+    static constexpr int HOVER_GAP_MS = 100; // Longer between calls means the hover ended
+    std::atomic<SpeculativeLoadMode> m_speculativeLoadMode = SpeculativeLoadMode::Preconnect;
+    std::atomic<size_t> m_maxPrerenderTabs = 1;
+    std::string m_speculationUrl;
+    std::string m_preconnectedOrigin;
+    std::chrono::steady_clock::time_point m_speculationStart;
+    std::chrono::steady_clock::time_point m_lastSpeculationCall;
+
+    // Page lifecycle (set on the main thread, read by OnBrowserCreated)
+    std::atomic<bool> m_pagesFrozen = false;
+    std::atomic<bool> m_widgetsFrozen = false;
+    // CEF UI thread. Freezing stores the mute state in mutedBeforeFreeze; thawing restores it
+    static void SetPageFrozen(CefRefPtr<CefBrowser> browser, bool frozen, bool& mutedBeforeFreeze);
 
     // State
     bool m_initialized = false;
+    bool m_sharedTextureEnabled = true; // GPU-to-GPU paint instead of CPU buffers
+    bool m_externalBeginFrameEnabled = true;
+    bool m_multiThreadedMessageLoop = false;
+    std::atomic<int> m_windowlessFrameRate = 60;
+
+    // Disk cache
+    std::string m_cachePath;
+    unsigned int m_cacheSizeLimitMB = 256;
+    bool m_clearCacheOnExit = false;
+
+    // Request filtering (read on CEF's IO thread)
+    ContentBlocker m_contentBlocker;
+
+    // Page telemetry
+    TelemetryBridge m_telemetryBridge;
+    CefRefPtr<PageMetricsSampler> m_pageMetricsSampler = new PageMetricsSampler();
+    std::chrono::steady_clock::time_point m_lastPageMetricsPoll;
+
+    // Paint recording (written from CEF's UI thread)
+    PaintTraceRecorder m_paintRecorder;
+
+    // Finished navigations; the oldest go when nobody takes them
+    static constexpr size_t MAX_QUEUED_NAVIGATIONS = 32;
+    std::mutex m_navigationMutex;
+    std::vector<NavigationTiming> m_finishedNavigations;
+
+    // GPU policy
+    BrowserGpuPolicy m_gpuPolicy = BrowserGpuPolicy::Full;
+
+    // Renderer processes
+    ProcessModelConfig m_processModel = GetProcessModelPreset(ProcessModelPreset::Balanced);
+
+    // Pump scheduling; delays are capped so a lost request can't stall CEF for long
+    static constexpr int64_t MAX_PUMP_DELAY_MS = 1000 / 30;
+    HANDLE m_pumpWorkEvent = nullptr;
+    std::atomic<bool> m_pumpWorkPending = false; // Immediate work requested
+    std::atomic<int64_t> m_pumpWorkDeadlineMs = INT64_MAX; // GetTickCount64 time, INT64_MAX = none
+    // Budgeted pumping (render thread)
+    static constexpr int MAX_PUMP_SLICES = 8;        // Per call, so messages are still handled in between
+    static constexpr float PUMP_SLICE_HALF_LIFE_MS = 250.0f; // Of the estimate, in wall time
+    float m_pumpSliceEstimateMs = 0.0f;
+    std::chrono::steady_clock::time_point m_pumpSliceEstimateTime; // Last decayed
+    int64_t m_pumpDeferredSinceMs = 0; // GetTickCount64 time, 0 = nothing deferred
+    CefPumpFrame m_pumpFrame;
 
     // Subprocess handling
+    CefRefPtr<CefApp> m_app;
+    bool m_subprocessChecked = false;
     bool m_isSubprocess = false;
+    int m_subprocessExitCode = 0;
 
     // Pointer back to BrowserView (not owned) to signal updates
     BrowserView* m_browserView = nullptr;
@@ -4,14 +4,31 @@
 
 #include "BrowserPage.h"
 #include "imgui.h"
+#include "ImGuiSystem.h"
+#include "FrameArena.h"
+#include "SettingsDatabase.h"
+#include "imgui_internal.h" // BringWindowToDisplayFront
 #include <algorithm>
-#include <cctype>
+#include <cctype> // For std::min/max if needed, <algorithm> includes it
+#include <cmath>
+#include <string> // For string operations
 
 BrowserPage::BrowserPage(BrowserView* browserView)
     : PageBase("Browser"), m_browserView(browserView) {
 
-    // Initialize URL buffer
-    strcpy_s(m_urlBuffer, "https://www.google.com");
+    // Initialize URL buffer with a default page
+    if (m_browserView && m_browserView->GetBrowserManager()) {
+         // Try to get initial URL if browser was created with one, else default
+         std::string initialUrl = m_browserView->GetBrowserManager()->GetURL();
+         if (initialUrl.empty() || initialUrl == "about:blank") {
+              strcpy_s(m_urlBuffer, "https://www.google.com");
+         } else {
+              strncpy_s(m_urlBuffer, initialUrl.c_str(), sizeof(m_urlBuffer) - 1);
+         }
+    } else {
+        strcpy_s(m_urlBuffer, "https://www.google.com");
+    }
+
 
     // Initialize bookmark examples for demo
     m_bookmarks = {
@@ -22,300 +39,773 @@ BrowserPage::BrowserPage(BrowserView* browserView)
         { "Wikipedia", "https://www.wikipedia.org", "📚" }
     };
 
-    // Clear URL history
-    for (auto& url : m_urlHistory) {
-        url.clear();
+    m_history.Load(UrlHistory::GetDefaultPath());
+    for (const Bookmark& bookmark : m_bookmarks) {
+        m_history.SetBookmarked(bookmark.url, bookmark.name, true);
     }
 }
 
 void BrowserPage::Render() {
-    // Render browser UI components
+    // CEF starts lazily; until then there is nothing to control
+    if (m_browserView && !m_browserView->IsBrowserStarted()) {
+        RenderStartupPlaceholder();
+        return;
+    }
+
+    // Render tabs, then browser UI components (address bar, buttons) for the active one
+    RenderTabStrip();
     RenderBrowserControls();
 
+    ImGui::Spacing();
+    ImGui::Separator(); // Add separator
     ImGui::Spacing();
 
-    // Render browser view
+    // Render browser view itself
     RenderBrowserView();
 
+    ImGui::Spacing();
+    ImGui::Separator(); // Add separator
+    ImGui::Spacing();
+
     // Render bookmarks section at the bottom
     RenderBookmarksSection();
 
-    // Bookmark dialog
+    // Handle bookmark dialog popup logic
     if (m_showBookmarkDialog) {
+        // OpenPopup must be called before BeginPopupModal
         ImGui::OpenPopup("Bookmark Dialog");
-        m_showBookmarkDialog = false;
+        m_showBookmarkDialog = false; // Reset flag after opening
     }
+    RenderBookmarkDialog(); // Render the dialog content if open
+}
 
-    // Centered popup
-    ImVec2 center = ImGui::GetMainViewport()->GetCenter();
-    ImGui::SetNextWindowPos(center, ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
-    ImGui::SetNextWindowSize(ImVec2(400, 0), ImGuiCond_Appearing);
-
-    if (ImGui::BeginPopupModal("Bookmark Dialog", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
-        if (m_isAddingBookmark) {
-            ImGui::Text("Add Bookmark");
-            ImGui::Separator();
-
-            // Pre-fill with current page title and URL
-            if (m_browserView && m_browserView->GetBrowserManager()) {
-                std::string currentTitle = m_browserView->GetBrowserManager()->GetTitle();
-                std::string currentUrl = m_browserView->GetBrowserManager()->GetURL();
-
-                if (strlen(m_bookmarkNameBuffer) == 0 && !currentTitle.empty()) {
-                    strcpy_s(m_bookmarkNameBuffer, currentTitle.c_str());
-                }
-
-                ImGui::Text("URL: %s", currentUrl.c_str());
-            }
+void BrowserPage::RenderStartupPlaceholder() {
+    if (m_browserView->HasBrowserStartFailed()) {
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "The browser failed to start.");
+        return;
+    }
 
-            ImGui::InputText("Name", m_bookmarkNameBuffer, sizeof(m_bookmarkNameBuffer));
+    // Opening the page is what starts the browser when startup is deferred
+    m_browserView->RequestBrowserStart();
 
-            ImGui::Spacing();
+    ImVec2 avail = ImGui::GetContentRegionAvail();
+    const char* text = "Starting browser...";
+    ImVec2 textSize = ImGui::CalcTextSize(text);
+    ImGui::SetCursorPos(ImVec2(ImGui::GetCursorPosX() + std::max(0.0f, (avail.x - textSize.x) * 0.5f),
+        ImGui::GetCursorPosY() + std::max(0.0f, (avail.y - textSize.y) * 0.5f)));
+    ImGui::TextDisabled("%s", text);
+}
 
-            if (ImGui::Button("Save", ImVec2(120, 0))) {
-                SaveCurrentPageAsBookmark();
-                ImGui::CloseCurrentPopup();
+void BrowserPage::RenderTabStrip() {
+    BrowserManager* mgr = m_browserView ? m_browserView->GetBrowserManager() : nullptr;
+    if (!mgr) return;
+
+    const int activeTabId = mgr->GetActiveTabId();
+    int tabToActivate = 0;
+    int tabToClose = 0;
+
+    ImGuiTabBarFlags tabBarFlags = ImGuiTabBarFlags_AutoSelectNewTabs | ImGuiTabBarFlags_FittingPolicyScroll |
+        ImGuiTabBarFlags_Reorderable;
+    if (ImGui::BeginTabBar("BrowserTabs", tabBarFlags)) {
+        FrameArena& arena = FrameArena::ForThread();
+        for (const BrowserManager::TabInfo& tab : mgr->GetTabs()) {
+            const std::string& name = tab.page->title.empty() ? tab.page->url : tab.page->title;
+            ImGuiSystem::RequestGlyphs(name);
+            std::string_view text = name;
+            if (text.empty()) text = "New Tab";
+            const bool truncated = text.size() > 24;
+            if (truncated) text = text.substr(0, 21);
+            const char* label = arena.Format("%s%.*s%s###Tab%d", tab.loading ? "* " : "", static_cast<int>(text.size()),
+                text.data(), truncated ? "..." : "", tab.id); // Stable ID while the title changes
+
+            // Selection follows the manager, so tabs activated elsewhere show up here too
+            bool open = true;
+            ImGuiTabItemFlags itemFlags = tab.id == activeTabId ? ImGuiTabItemFlags_SetSelected : 0;
+            if (ImGui::BeginTabItem(label, &open, itemFlags)) {
+                ImGui::EndTabItem();
             }
-
-            ImGui::SameLine();
-
-            if (ImGui::Button("Cancel", ImVec2(120, 0))) {
-                ImGui::CloseCurrentPopup();
+            if (ImGui::IsItemClicked() && tab.id != activeTabId) {
+                tabToActivate = tab.id;
             }
-        }
-        else {
-            ImGui::Text("Bookmark Management");
-            ImGui::Separator();
-
-            if (ImGui::BeginTable("BookmarksTable", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
-                ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
-                ImGui::TableSetupColumn("URL", ImGuiTableColumnFlags_WidthStretch);
-                ImGui::TableSetupColumn("Action", ImGuiTableColumnFlags_WidthFixed, 60.0f);
-                ImGui::TableHeadersRow();
-
-                for (size_t i = 0; i < m_bookmarks.size(); i++) {
-                    ImGui::TableNextRow();
-
-                    // Name column
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%s", m_bookmarks[i].name.c_str());
-
-                    // URL column
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%s", m_bookmarks[i].url.c_str());
-
-                    // Action column
-                    ImGui::TableNextColumn();
-                    ImGui::PushID(static_cast<int>(i));
-                    if (ImGui::Button("Delete")) {
-                        DeleteBookmark(i);
-                    }
-                    ImGui::PopID();
+            if (ImGui::IsItemHovered()) {
+                ImGui::BeginTooltip();
+                ImGui::Text("%s%s", tab.page->url.c_str(), tab.discarded ? " (unloaded, reloads when selected)" : "");
+                // The tab's frame from when it was last shown
+                D3D12_GPU_DESCRIPTOR_HANDLE thumbnail = {};
+                UINT thumbnailWidth = 0, thumbnailHeight = 0;
+                if (tab.id != activeTabId &&
+                    m_browserView->GetTabThumbnail(tab.id, thumbnail, thumbnailWidth, thumbnailHeight)) {
+                    const float width = std::min(static_cast<float>(thumbnailWidth), 320.0f);
+                    ImGui::Image(reinterpret_cast<ImTextureID>(thumbnail.ptr),
+                        ImVec2(width, width * thumbnailHeight / static_cast<float>(thumbnailWidth)));
                 }
-
-                ImGui::EndTable();
+                ImGui::EndTooltip();
             }
-
-            ImGui::Spacing();
-
-            if (ImGui::Button("Close", ImVec2(120, 0))) {
-                ImGui::CloseCurrentPopup();
+            if (!open) {
+                tabToClose = tab.id;
             }
         }
 
-        ImGui::EndPopup();
+        if (ImGui::TabItemButton("+", ImGuiTabItemFlags_Trailing | ImGuiTabItemFlags_NoTooltip)) {
+            // The home page from the browser settings; the settings database is main thread only
+            ImGuiSystem::RunOnRenderThread("New Tab", [mgr]() {
+                std::string homePage(SettingsDatabase::Get().GetString("browser.homePage"));
+                mgr->OpenTab(homePage.empty() ? "https://www.google.com" : homePage);
+            });
+        }
+        ImGui::EndTabBar();
+    }
+
+    // Applied after the tab bar so the list isn't changed while it's drawn; like OpenTab, on the
+    // render thread, which owns the tab list
+    if (tabToClose != 0) {
+        ImGuiSystem::RunOnRenderThread("Close Tab", [mgr, tabToClose]() { mgr->CloseTab(tabToClose); });
+    }
+    else if (tabToActivate != 0) {
+        ImGuiSystem::RunOnRenderThread("Activate Tab", [mgr, tabToActivate]() { mgr->ActivateTab(tabToActivate); });
     }
 }
 
 void BrowserPage::RenderBrowserControls() {
+    BrowserManager* mgr = m_browserView ? m_browserView->GetBrowserManager() : nullptr;
+
+    // One snapshot for the frame; CEF replaces it when the page changes
+    std::shared_ptr<const BrowserHandler::PageState> page = mgr ? mgr->GetPageState() : nullptr;
+
     // Navigation buttons
-    if (ImGui::Button("Back") && m_browserView && m_browserView->GetBrowserManager() &&
-        m_browserView->GetBrowserManager()->CanGoBack()) {
-        m_browserView->GetBrowserManager()->GoBack();
+    if (ImGui::Button("Back") && page && page->canGoBack) {
+        mgr->GoBack();
     }
-
     ImGui::SameLine();
-
-    if (ImGui::Button("Forward") && m_browserView && m_browserView->GetBrowserManager() &&
-        m_browserView->GetBrowserManager()->CanGoForward()) {
-        m_browserView->GetBrowserManager()->GoForward();
+    if (ImGui::Button("Forward") && page && page->canGoForward) {
+        mgr->GoForward();
     }
-
     ImGui::SameLine();
-
-    if (ImGui::Button("Reload") && m_browserView && m_browserView->GetBrowserManager()) {
-        m_browserView->GetBrowserManager()->Reload();
+    if (ImGui::Button("Reload") && mgr) {
+        mgr->Reload(); // Use simple reload by default
+        // Use mgr->Reload(true) for ignore cache version
     }
-
     ImGui::SameLine();
-
-    if (ImGui::Button("Stop") && m_browserView && m_browserView->GetBrowserManager() &&
-        m_browserView->GetBrowserManager()->IsLoading()) {
-        m_browserView->GetBrowserManager()->StopLoad();
+    bool isLoading = mgr && mgr->IsLoading();
+    if (ImGui::Button("Stop") && isLoading) {
+        mgr->StopLoad();
     }
+    // Optionally disable Stop button when not loading
+    // ImGui::BeginDisabled(!isLoading); ImGui::Button("Stop"); ImGui::EndDisabled();
 
     ImGui::SameLine();
-
-    if (ImGui::Button("Home")) {
-        if (m_browserView) {
-            m_browserView->Navigate("https://www.google.com");
-        }
+    if (ImGui::Button("Home") && m_browserView) {
+        // TODO: Make home page configurable via settings
+        m_browserView->Navigate("https://www.google.com");
+        strcpy_s(m_urlBuffer, "https://www.google.com");
     }
-
     ImGui::SameLine();
+    if (ImGui::Button("Maximize") && m_browserView) {
+        SetMaximized(true);
+    }
+
+    ImGui::Spacing(); // Add space before bookmark buttons
 
     // Add bookmark button
     if (ImGui::Button("Add Bookmark")) {
         m_isAddingBookmark = true;
         m_bookmarkNameBuffer[0] = '\0'; // Clear buffer
-        m_showBookmarkDialog = true;
+        m_showBookmarkDialog = true;    // Set flag to open dialog in Render()
     }
-
     ImGui::SameLine();
-
     // Manage bookmarks button
     if (ImGui::Button("Manage Bookmarks")) {
         m_isAddingBookmark = false;
-        m_showBookmarkDialog = true;
+        m_showBookmarkDialog = true;    // Set flag to open dialog in Render()
     }
 
+    ImGui::Spacing();
+
     // URL input bar
-    ImGui::SetNextItemWidth(-1); // Full width
-    if (ImGui::InputText("URL", m_urlBuffer, sizeof(m_urlBuffer), ImGuiInputTextFlags_EnterReturnsTrue)) {
-        // Check if input has http/https, add if missing
+    ImGui::PushItemWidth(-1); // Full width available
+    ImGuiInputTextFlags urlFlags = ImGuiInputTextFlags_EnterReturnsTrue | ImGuiInputTextFlags_CallbackHistory |
+        ImGuiInputTextFlags_CallbackEdit;
+    bool urlEntered = ImGui::InputText("##URLInput", m_urlBuffer, sizeof(m_urlBuffer), urlFlags, UrlInputCallback, this);
+    bool urlActive = ImGui::IsItemActive();
+    ImVec2 suggestionsPosition(ImGui::GetItemRectMin().x, ImGui::GetItemRectMax().y);
+    float suggestionsWidth = ImGui::GetItemRectSize().x;
+    if (urlEntered) {
+        // Enter on a picked suggestion opens it
+        const std::vector<uint32_t>& suggestions = m_history.Suggest(m_urlBuffer);
+        if (m_urlEdited && m_suggestionIndex >= 0 && m_suggestionIndex < static_cast<int>(suggestions.size())) {
+            strncpy_s(m_urlBuffer, m_history.GetEntry(suggestions[m_suggestionIndex]).url.c_str(), sizeof(m_urlBuffer) - 1);
+        }
+        m_urlEdited = false;
+        m_suggestionIndex = -1;
+
         std::string url = m_urlBuffer;
-        if (url.find("://") == std::string::npos) {
-            url = "https://" + url;
-            strcpy_s(m_urlBuffer, url.c_str());
+        // Add https:// prefix if no protocol is present
+        if (!url.empty() && url.find("://") == std::string::npos && url.find("about:") != 0 && url.find("data:") != 0) {
+            // Check for common TLDs or presence of '.' to guess if it's a URL vs search term
+            if (url.find('.') != std::string::npos) {
+                 url = "https://" + url;
+            } else {
+                 // Treat as search query (e.g., Google search)
+                 // TODO: Use search engine from settings
+                 url = "https://www.google.com/search?q=" + url;
+            }
+            // Update buffer only if modified
+             strncpy_s(m_urlBuffer, url.c_str(), sizeof(m_urlBuffer) - 1);
         }
 
-        // Navigate to URL
+        // Navigate if view exists (the visit is recorded once the page has loaded)
         if (m_browserView) {
             m_browserView->Navigate(url);
-
-            // Add to history
-            m_urlHistory[m_urlHistoryIndex] = url;
-            m_urlHistoryIndex = (m_urlHistoryIndex + 1) % URL_HISTORY_SIZE;
-            m_urlHistoryCount = std::min(m_urlHistoryCount + 1, URL_HISTORY_SIZE);
         }
     }
+    ImGui::PopItemWidth();
+    RenderUrlSuggestions(urlActive, suggestionsPosition, suggestionsWidth);
+
+    // Status info (Loading or Title)
+    if (mgr) {
+        const std::string& currentUrl = page->url;
+        // Update URL buffer if changed externally (e.g., link click, tab switch)
+        // Only update if the input field is not focused to avoid interrupting typing
+        bool tabChanged = m_displayedTabId != mgr->GetActiveTabId();
+        m_displayedTabId = mgr->GetActiveTabId();
+        if ((tabChanged || !urlActive) && !m_suggestionsHovered && !currentUrl.empty() && currentUrl != m_urlBuffer) {
+             strncpy_s(m_urlBuffer, currentUrl.c_str(), sizeof(m_urlBuffer) - 1);
+             m_urlEdited = false;
+        }
 
-    // Status info
-    if (m_browserView && m_browserView->GetBrowserManager()) {
-        std::string currentUrl = m_browserView->GetBrowserManager()->GetURL();
-        std::string currentTitle = m_browserView->GetBrowserManager()->GetTitle();
-        bool isLoading = m_browserView->GetBrowserManager()->IsLoading();
+        // Every finished load is a visit, whichever way it was reached (links, redirects, history)
+        if (!isLoading && !currentUrl.empty() && currentUrl != m_recordedUrl) {
+            m_recordedUrl = currentUrl;
+            m_recordedTitle = page->title;
+            m_history.RecordVisit(currentUrl, m_recordedTitle);
+        }
+        else if (!isLoading && currentUrl == m_recordedUrl && page->title != m_recordedTitle) {
+            m_recordedTitle = page->title;
+            m_history.SetTitle(currentUrl, page->title);
+        }
 
-        // Update URL buffer if changed externally (navigation, etc.)
-        if (!currentUrl.empty() && currentUrl != m_urlBuffer) {
-            strcpy_s(m_urlBuffer, currentUrl.c_str());
+        // Display loading status or page title
+        if (isLoading) {
+             ImGui::Text("Loading: %s", currentUrl.c_str());
+        } else {
+             const std::string& title = page->title;
+             ImGuiSystem::RequestGlyphs(title);
+             ImGui::Text("Title: %s", title.empty() ? currentUrl.c_str() : title.c_str());
         }
+    } else {
+         ImGui::Text("Browser not available.");
+    }
+}
 
-        // Show loading status or title
-        ImGui::Text("%s %s",
-            isLoading ? "Loading:" : "Title:",
-            isLoading ? currentUrl.c_str() : currentTitle.c_str());
+void BrowserPage::RenderUrlSuggestions(bool inputActive, const ImVec2& position, float width) {
+    if (!inputActive && !m_suggestionsHovered) {
+        m_urlEdited = false;
+        m_suggestionIndex = -1;
     }
+    m_suggestionsHovered = false;
+    if (!m_urlEdited) return;
+
+    // The trie walk resumes from the last keystroke's node, so this is cheap every frame
+    const std::vector<uint32_t>& suggestions = m_history.Suggest(m_urlBuffer);
+    if (suggestions.empty()) return;
+    m_suggestionIndex = std::min(m_suggestionIndex, static_cast<int>(suggestions.size()) - 1);
+
+    ImGui::SetNextWindowPos(position);
+    ImGui::SetNextWindowSizeConstraints(ImVec2(width, 0.0f), ImVec2(width, FLT_MAX));
+    ImGuiWindowFlags flags = ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize |
+        ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav |
+        ImGuiWindowFlags_AlwaysAutoResize;
+    if (ImGui::Begin("##UrlSuggestions", nullptr, flags)) {
+        // Unfocused so typing continues in the URL box, but drawn over the page
+        ImGui::BringWindowToDisplayFront(ImGui::GetCurrentWindow());
+        std::string urlToOpen;
+        for (int i = 0; i < static_cast<int>(suggestions.size()); i++) {
+            const UrlHistory::Entry& entry = m_history.GetEntry(suggestions[i]);
+            ImGuiSystem::RequestGlyphs(entry.title);
+            ImGui::PushID(i);
+            const char* label = entry.title.empty() ? entry.url.c_str() : entry.title.c_str();
+            if (ImGui::Selectable(label, i == m_suggestionIndex)) {
+                urlToOpen = entry.url;
+            }
+            ImGui::SameLine();
+            ImGui::TextDisabled("%s%s", entry.bookmarked ? "[bookmark] " : "", entry.url.c_str());
+            ImGui::PopID();
+        }
+        m_suggestionsHovered = ImGui::IsWindowHovered();
+
+        if (!urlToOpen.empty()) {
+            strncpy_s(m_urlBuffer, urlToOpen.c_str(), sizeof(m_urlBuffer) - 1);
+            m_urlEdited = false;
+            m_suggestionIndex = -1;
+            m_suggestionsHovered = false;
+            if (m_browserView) m_browserView->Navigate(urlToOpen);
+        }
+    }
+    ImGui::End();
+}
+
+int BrowserPage::UrlInputCallback(ImGuiInputTextCallbackData* data) {
+    BrowserPage* page = static_cast<BrowserPage*>(data->UserData);
+    if (data->EventFlag == ImGuiInputTextFlags_CallbackEdit) {
+        page->m_urlEdited = true;
+        page->m_suggestionIndex = -1;
+    }
+    else if (data->EventFlag == ImGuiInputTextFlags_CallbackHistory && page->m_urlEdited) {
+        // Clamped to the suggestion count when they are drawn
+        if (data->EventKey == ImGuiKey_UpArrow) page->m_suggestionIndex = std::max(-1, page->m_suggestionIndex - 1);
+        else if (data->EventKey == ImGuiKey_DownArrow) page->m_suggestionIndex++;
+    }
+    return 0;
 }
 
 void BrowserPage::RenderBrowserView() {
-    // Calculate available space for browser view
-    ImVec2 availSize = ImGui::GetContentRegionAvail();
-    availSize.y -= 100; // Reserve space for bookmarks bar at bottom
+    // Calculate available space for browser view, leaving room for controls/bookmarks
+    // Use ImGui::GetContentRegionAvail() for dynamic sizing within the current window/child
+    ImVec2 contentRegion = ImGui::GetContentRegionAvail();
+    // Example: If bookmarks section is fixed height, subtract it.
+    // float bookmarksHeight = 100.0f;
+    // ImVec2 viewSize = ImVec2(contentRegion.x, contentRegion.y - bookmarksHeight - ImGui::GetStyle().ItemSpacing.y);
+    ImVec2 viewSize = contentRegion; // Use full available space for now
+
+    // Ensure minimum size
+    viewSize.x = std::max(viewSize.x, 64.0f);
+    viewSize.y = std::max(viewSize.y, 64.0f);
+
+    // Render browser content texture within a child window for clipping/scrolling if needed
+    // ImGuiWindowFlags flags = ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse;
+    // ImGui::BeginChild("BrowserViewChild", viewSize, false, flags);
+
+    if (m_browserView) {
+        D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle = m_browserView->GetTextureGpuHandle();
+        if (gpuHandle.ptr != 0) {
+            // Texture exists, render it using ImGui::Image
+            // Lower render qualities paint the top left part of the texture
+            float contentU = 1.0f, contentV = 1.0f;
+            m_browserView->GetContentExtent(contentU, contentV);
+            // Just switched: the tab's thumbnail until its browser paints, rather than the last tab
+            D3D12_GPU_DESCRIPTOR_HANDLE placeholder = {};
+            const bool hasPlaceholder = m_browserView->GetSwitchPlaceholder(placeholder);
+            if (hasPlaceholder) {
+                gpuHandle = placeholder;
+                contentU = 1.0f;
+                contentV = 1.0f;
+            }
+            if (m_browserView->IsFullscreenCopied()) {
+                ImGui::Dummy(viewSize); // Already in the frame, under the UI
+            }
+            else if (!hasPlaceholder && m_browserView->IsAwaitingFirstPaint()) {
+                // A browser still being created (or a tab without a thumbnail): nothing to sample yet
+                ImVec2 p0 = ImGui::GetCursorScreenPos();
+                ImDrawList* drawList = ImGui::GetWindowDrawList();
+                drawList->AddRectFilled(p0, ImVec2(p0.x + viewSize.x, p0.y + viewSize.y), IM_COL32(40, 40, 40, 255));
+                const char* text = "Loading...";
+                ImVec2 textSize = ImGui::CalcTextSize(text);
+                drawList->AddText(ImVec2(p0.x + std::max(0.0f, (viewSize.x - textSize.x) * 0.5f),
+                    p0.y + std::max(0.0f, (viewSize.y - textSize.y) * 0.5f)),
+                    ImGui::GetColorU32(ImGuiCol_TextDisabled), text);
+                ImGui::Dummy(viewSize);
+            }
+            else {
+                ImGui::Image(
+                    reinterpret_cast<ImTextureID>(gpuHandle.ptr), // Cast GPU handle
+                    viewSize, // Use calculated size
+                    ImVec2(0.0f, 0.0f), ImVec2(contentU, contentV)
+                );
+            }
+
+            // Popup layer (dropdowns) on top, mapped from browser pixels to the image rect
+            D3D12_GPU_DESCRIPTOR_HANDLE popupHandle = {};
+            RECT popupRect = {};
+            int browserWidth = m_browserView->GetBrowserInternalWidth();
+            int browserHeight = m_browserView->GetBrowserInternalHeight();
+            ImVec2 imageMin = ImGui::GetItemRectMin();
+
+            // The part of the image the window doesn't clip, in browser pixels; uploads spread
+            // over frames copy it first
+            if (browserWidth > 0 && browserHeight > 0) {
+                const ImVec2 clipMin = ImGui::GetWindowDrawList()->GetClipRectMin();
+                const ImVec2 clipMax = ImGui::GetWindowDrawList()->GetClipRectMax();
+                const float toPixelsX = browserWidth / viewSize.x;
+                const float toPixelsY = browserHeight / viewSize.y;
+                RECT visible = {
+                    static_cast<LONG>((std::max(clipMin.x, imageMin.x) - imageMin.x) * toPixelsX),
+                    static_cast<LONG>((std::max(clipMin.y, imageMin.y) - imageMin.y) * toPixelsY),
+                    static_cast<LONG>(std::ceil((std::min(clipMax.x, imageMin.x + viewSize.x) - imageMin.x) * toPixelsX)),
+                    static_cast<LONG>(std::ceil((std::min(clipMax.y, imageMin.y + viewSize.y) - imageMin.y) * toPixelsY))
+                };
+                BrowserView* view = m_browserView;
+                ImGuiSystem::RunOnRenderThread("Browser Visible Region", [view, visible]() { view->SetVisibleRegion(visible); });
+            }
+            if (browserWidth > 0 && browserHeight > 0 && m_browserView->GetPopupLayer(popupHandle, popupRect)) {
+                float scaleX = viewSize.x / static_cast<float>(browserWidth);
+                float scaleY = viewSize.y / static_cast<float>(browserHeight);
+                ImGui::GetWindowDrawList()->AddImage(
+                    reinterpret_cast<ImTextureID>(popupHandle.ptr),
+                    ImVec2(imageMin.x + popupRect.left * scaleX, imageMin.y + popupRect.top * scaleY),
+                    ImVec2(imageMin.x + popupRect.right * scaleX, imageMin.y + popupRect.bottom * scaleY));
+            }
+
+            // Mouse and keyboard for the page, through an invisible button over the image so drags
+            // keep going to the page outside it and the wheel scrolls the page, not the window
+            ImVec2 cursor = ImGui::GetCursorScreenPos();
+            ImGui::SetCursorScreenPos(imageMin);
+            ImGui::InvisibleButton("##BrowserInput", viewSize,
+                ImGuiButtonFlags_MouseButtonLeft | ImGuiButtonFlags_MouseButtonRight | ImGuiButtonFlags_MouseButtonMiddle);
+            ImGui::SetItemKeyOwner(ImGuiKey_MouseWheelY);
+            ImGui::SetItemKeyOwner(ImGuiKey_MouseWheelX);
+            ForwardInput(imageMin, viewSize);
+            ImGui::SetCursorScreenPos(cursor);
+        } else {
+            // Texture handle is invalid (not created or descriptor issue)
+            ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.0f, 1.0f), "Browser texture not ready.");
+            // Display a placeholder rectangle
+            ImDrawList* draw_list = ImGui::GetWindowDrawList();
+            ImVec2 p0 = ImGui::GetCursorScreenPos();
+            ImVec2 p1 = ImVec2(p0.x + viewSize.x, p0.y + viewSize.y);
+            draw_list->AddRectFilled(p0, p1, IM_COL32(50, 50, 50, 200));
+            ImGui::Dummy(viewSize); // Advance cursor
+        }
+    } else {
+        // BrowserView object itself is null
+        ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "Browser component is unavailable.");
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        ImVec2 p0 = ImGui::GetCursorScreenPos();
+        ImVec2 p1 = ImVec2(p0.x + viewSize.x, p0.y + viewSize.y);
+        draw_list->AddRectFilled(p0, p1, IM_COL32(30, 30, 30, 200));
+        ImGui::Dummy(viewSize); // Advance cursor
+    }
 
-    // Create a child window for the browser view
-    ImGui::BeginChild("BrowserView", availSize, true, ImGuiWindowFlags_NoScrollbar);
+    // ImGui::EndChild(); // End child window if used
+}
 
-    // Render browser content if available
-    if (m_browserView && m_browserView->GetShaderResourceView()) {
-        ImGui::Image(
-            (void*)m_browserView->GetShaderResourceView(),
-            ImGui::GetContentRegionAvail()
-        );
+void BrowserPage::SetMaximized(bool maximized) {
+    if (maximized == m_maximized || !m_browserView) return;
+    m_maximized = maximized;
+    if (maximized) {
+        m_restoreWidth = m_browserView->GetWidth();
+        m_restoreHeight = m_browserView->GetHeight();
     }
     else {
-        // Show placeholder if browser not available
-        ImGui::TextColored(ImVec4(1, 0, 0, 1), "Browser content not available.");
+        BrowserView* view = m_browserView;
+        const int width = m_restoreWidth;
+        const int height = m_restoreHeight;
+        ImGuiSystem::RunOnRenderThread("Browser Resize", [view, width, height]() { view->Resize(width, height); });
     }
+}
 
-    ImGui::EndChild();
+void BrowserPage::RenderMaximized() {
+    // At the viewport's size a full quality paint covers the back buffer 1:1, and the frame copies
+    // it there instead of drawing it (BrowserView::RecordFullscreenCopy)
+    const ImGuiViewport* viewport = ImGui::GetMainViewport();
+    const int width = static_cast<int>(viewport->Size.x);
+    const int height = static_cast<int>(viewport->Size.y);
+    if (m_browserView->GetWidth() != width || m_browserView->GetHeight() != height) {
+        // Recreates the browser's textures, so on the render thread; until then this repeats
+        BrowserView* view = m_browserView;
+        ImGuiSystem::RunOnRenderThread("Browser Resize", [view, width, height]() { view->Resize(width, height); });
+    }
+
+    ImGuiWindowFlags viewFlags =
+        ImGuiWindowFlags_NoDecoration |
+        ImGuiWindowFlags_NoMove |
+        ImGuiWindowFlags_NoSavedSettings |
+        ImGuiWindowFlags_NoBackground |
+        ImGuiWindowFlags_NoScrollWithMouse |
+        ImGuiWindowFlags_NoBringToFrontOnFocus;
+    ImGui::SetNextWindowPos(viewport->Pos);
+    ImGui::SetNextWindowSize(viewport->Size);
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.0f);
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 0.0f);
+    if (ImGui::Begin("##BrowserMaximized", nullptr, viewFlags)) {
+        RenderBrowserView();
+    }
+    ImGui::End();
+    ImGui::PopStyleVar(3);
+
+    // The only other thing on screen
+    ImGuiWindowFlags restoreFlags =
+        ImGuiWindowFlags_NoDecoration |
+        ImGuiWindowFlags_NoMove |
+        ImGuiWindowFlags_NoSavedSettings |
+        ImGuiWindowFlags_AlwaysAutoResize |
+        ImGuiWindowFlags_NoFocusOnAppearing;
+    ImGui::SetNextWindowPos(ImVec2(viewport->Pos.x + viewport->Size.x - 8.0f, viewport->Pos.y + 8.0f), ImGuiCond_Always,
+        ImVec2(1.0f, 0.0f));
+    ImGui::SetNextWindowBgAlpha(0.6f);
+    if (ImGui::Begin("##BrowserRestore", nullptr, restoreFlags)) {
+        if (ImGui::Button("Restore")) {
+            SetMaximized(false);
+        }
+    }
+    ImGui::End();
+}
+
+void BrowserPage::OnHidden() {
+    if (!m_browserView) return;
+    BrowserView* view = m_browserView;
+    const bool mouseInPage = m_mouseInPage;
+    m_mouseInPage = false;
+    ImGuiSystem::RunOnRenderThread("Browser Input", [view, mouseInPage]() {
+        view->SetKeyboardFocus(false);
+        if (mouseInPage) view->SendMouseLeave(0);
+    });
+}
+
+void BrowserPage::ForwardInput(const ImVec2& imageMin, const ImVec2& imageSize) {
+    const ImGuiIO& io = ImGui::GetIO();
+    bool hovered = ImGui::IsItemHovered();
+    bool captured = ImGui::IsItemActive(); // A button went down over the page and is still held
+
+    uint32_t modifiers = 0;
+    if (io.KeyShift) modifiers |= EVENTFLAG_SHIFT_DOWN;
+    if (io.KeyCtrl) modifiers |= EVENTFLAG_CONTROL_DOWN;
+    if (io.KeyAlt) modifiers |= EVENTFLAG_ALT_DOWN;
+    if (io.MouseDown[ImGuiMouseButton_Left]) modifiers |= EVENTFLAG_LEFT_MOUSE_BUTTON;
+    if (io.MouseDown[ImGuiMouseButton_Right]) modifiers |= EVENTFLAG_RIGHT_MOUSE_BUTTON;
+    if (io.MouseDown[ImGuiMouseButton_Middle]) modifiers |= EVENTFLAG_MIDDLE_MOUSE_BUTTON;
+
+    // Read from ImGui here, sent on the render thread, which owns the view's input state
+    struct PageInput {
+        bool setFocus = false;
+        bool focus = false;
+        bool leave = false;
+        bool inPage = false;
+        float x = 0.0f;
+        float y = 0.0f;
+        float wheelX = 0.0f;
+        float wheelY = 0.0f;
+        int clickCount[3] = {}; // 0: no press this frame
+        bool released[3] = {};
+        uint32_t modifiers = 0;
+    } input;
+    input.modifiers = modifiers;
+
+    // Clicks elsewhere in the overlay take the keyboard back
+    if (ImGui::IsMouseClicked(ImGuiMouseButton_Left) || ImGui::IsMouseClicked(ImGuiMouseButton_Right)) {
+        input.setFocus = true;
+        input.focus = hovered;
+    }
+
+    input.inPage = hovered || captured;
+    input.leave = !input.inPage && m_mouseInPage;
+    m_mouseInPage = input.inPage;
+    if (!input.inPage && !input.leave && !input.setFocus) return;
+
+    // Only the last position and the summed wheel of the frame reach the browser (FlushInput)
+    input.x = (io.MousePos.x - imageMin.x) / imageSize.x;
+    input.y = (io.MousePos.y - imageMin.y) / imageSize.y;
+    if (hovered) {
+        input.wheelX = io.MouseWheelH;
+        input.wheelY = io.MouseWheel;
+    }
+    for (int button = 0; button < 3; button++) {
+        if (hovered && ImGui::IsMouseClicked(button)) {
+            input.clickCount[button] = io.MouseClickedCount[button];
+        }
+        input.released[button] = ImGui::IsMouseReleased(button) && input.inPage;
+    }
+
+    BrowserView* view = m_browserView;
+    ImGuiSystem::RunOnRenderThread("Browser Input", [view, input]() {
+        if (input.setFocus) view->SetKeyboardFocus(input.focus);
+        if (input.leave) view->SendMouseLeave(input.modifiers);
+        if (!input.inPage) return;
+
+        view->QueueMouseMove(input.x, input.y, input.modifiers);
+        view->QueueMouseWheel(input.wheelX, input.wheelY, input.modifiers);
+        for (int button = 0; button < 3; button++) {
+            if (input.clickCount[button] > 0) {
+                view->SendMouseClick(input.x, input.y, button, false, input.clickCount[button], input.modifiers);
+            }
+            if (input.released[button]) {
+                view->SendMouseClick(input.x, input.y, button, true, 1, input.modifiers);
+            }
+        }
+        view->FlushInput();
+    });
 }
 
 void BrowserPage::RenderBookmarksSection() {
-    ImGui::BeginChild("BookmarksBar", ImVec2(0, 80), true);
+    // Example: Fixed height child window at the bottom
+    float bookmarksBarHeight = 80.0f;
+     // Use BeginChild for a dedicated area, helps with layout
+    if (ImGui::BeginChild("BookmarksBarChild", ImVec2(0, bookmarksBarHeight), true, ImGuiWindowFlags_HorizontalScrollbar)) {
+
+        ImGui::Text("Bookmarks");
+        ImGui::Separator();
+        ImGui::Spacing();
+
+        // Render bookmarks as horizontal buttons
+        float buttonWidth = 120.0f; // Adjust width as needed
+        for (size_t i = 0; i < m_bookmarks.size(); ++i) {
+            if (i > 0) ImGui::SameLine(); // Place buttons horizontally
+
+            const auto& bm = m_bookmarks[i];
+            std::string label = bm.favicon + " " + bm.name;
+            ImGuiSystem::RequestGlyphs(label);
+
+            if (ImGui::Button(label.c_str(), ImVec2(buttonWidth, 0))) {
+                LoadBookmark(bm.url);
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("%s", bm.url.c_str());
+                m_browserView->SpeculateNavigation(bm.url);
+            }
+        }
+    }
+    ImGui::EndChild();
+}
 
-    ImGui::Text("Bookmarks");
-    ImGui::Separator();
+// --- Bookmark Dialog ---
+void BrowserPage::RenderBookmarkDialog() {
+    // Center the popup modal
+    ImVec2 center = ImGui::GetMainViewport()->GetCenter();
+    ImGui::SetNextWindowPos(center, ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
+    // Set initial size constraint
+    ImGui::SetNextWindowSize(ImVec2(450, 0), ImGuiCond_Appearing);
 
-    // Render bookmarks as horizontal buttons
-    float buttonWidth = 100.0f;
-    float windowWidth = ImGui::GetContentRegionAvail().x;
-    int buttonsPerRow = std::max(1, static_cast<int>(windowWidth / buttonWidth));
+    if (ImGui::BeginPopupModal("Bookmark Dialog", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+        if (m_isAddingBookmark) {
+            ImGui::Text("Add Bookmark");
+            ImGui::Separator();
+            ImGui::Spacing();
+
+            std::string currentUrl = "";
+            if (m_browserView && m_browserView->GetBrowserManager()) {
+                currentUrl = m_browserView->GetBrowserManager()->GetURL();
+                std::string currentTitle = m_browserView->GetBrowserManager()->GetTitle();
 
-    for (int i = 0; i < m_bookmarks.size(); i++) {
-        if (i % buttonsPerRow != 0)
+                // Pre-fill name buffer only if it's currently empty
+                if (strlen(m_bookmarkNameBuffer) == 0 && !currentTitle.empty()) {
+                     strncpy_s(m_bookmarkNameBuffer, currentTitle.c_str(), sizeof(m_bookmarkNameBuffer) - 1);
+                }
+            }
+
+            ImGui::InputText("Name", m_bookmarkNameBuffer, sizeof(m_bookmarkNameBuffer));
+            ImGui::Text("URL: %s", currentUrl.c_str()); // Display URL, don't allow editing here
+            // Add Favicon selection if needed
+
+            ImGui::Spacing();
+            ImGui::Separator();
+            ImGui::Spacing();
+
+            if (ImGui::Button("Save", ImVec2(120, 0))) {
+                if (strlen(m_bookmarkNameBuffer) > 0 && !currentUrl.empty()) {
+                    SaveCurrentPageAsBookmark();
+                    ImGui::CloseCurrentPopup();
+                } else {
+                     // Optional: Show error message if name/URL is missing
+                }
+            }
             ImGui::SameLine();
+            if (ImGui::Button("Cancel", ImVec2(120, 0))) {
+                ImGui::CloseCurrentPopup();
+            }
 
-        // Create button with bookmark name
-        if (ImGui::Button(m_bookmarks[i].name.c_str(), ImVec2(buttonWidth - 10, 0))) {
-            // Navigate to bookmark URL
-            LoadBookmark(m_bookmarks[i].url);
-        }
+        } else { // Managing bookmarks
+            ImGui::Text("Manage Bookmarks");
+            ImGui::Separator();
+            ImGui::Spacing();
 
-        // Tooltip with URL
-        if (ImGui::IsItemHovered()) {
-            ImGui::SetTooltip("%s", m_bookmarks[i].url.c_str());
+            // Table for listing bookmarks
+            if (ImGui::BeginTable("BookmarksTable", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
+                ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
+                ImGui::TableSetupColumn("URL", ImGuiTableColumnFlags_WidthStretch);
+                ImGui::TableSetupColumn("Action", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+                ImGui::TableHeadersRow();
+
+                // Use index for safe deletion while iterating
+                for (int i = 0; i < static_cast<int>(m_bookmarks.size()); ++i) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%s %s", m_bookmarks[i].favicon.c_str(), m_bookmarks[i].name.c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%s", m_bookmarks[i].url.c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::PushID(i); // Ensure unique ID for buttons within the loop
+                    if (ImGui::Button("Delete")) {
+                        DeleteBookmark(i);
+                        ImGui::PopID();
+                        break; // Exit loop after deletion as indices shift
+                    }
+                    ImGui::PopID();
+                }
+                ImGui::EndTable();
+            }
+
+            ImGui::Spacing();
+            ImGui::Separator();
+            ImGui::Spacing();
+
+            if (ImGui::Button("Close", ImVec2(120, 0))) {
+                ImGui::CloseCurrentPopup();
+            }
         }
+        ImGui::EndPopup();
     }
-
-    ImGui::EndChild();
 }
 
+
+// --- Bookmark Logic ---
+
 void BrowserPage::SaveCurrentPageAsBookmark() {
-    if (!m_browserView || !m_browserView->GetBrowserManager())
-        return;
+    if (!m_browserView || !m_browserView->GetBrowserManager()) return;
 
-    // Get name and URL
     std::string name = m_bookmarkNameBuffer;
     std::string url = m_browserView->GetBrowserManager()->GetURL();
+    std::string icon = "🔖"; // Default icon, could be made selectable
 
-    // Trim name if needed
+    // Use page title as name if buffer is empty
     if (name.empty()) {
         name = m_browserView->GetBrowserManager()->GetTitle();
-        if (name.empty()) {
-            name = "Unnamed Bookmark";
+        // Use URL domain as fallback if title is also empty
+        if (name.empty() && !url.empty()) {
+             size_t start = url.find("://");
+             if (start != std::string::npos) start += 3; else start = 0;
+             size_t end = url.find('/', start);
+             name = (end == std::string::npos) ? url.substr(start) : url.substr(start, end - start);
         }
+        // Final fallback
+        if (name.empty()) name = "Unnamed Bookmark";
     }
 
-    // Don't add if URL is empty
-    if (url.empty())
-        return;
+    // Don't add if URL is empty or invalid (e.g., about:blank)
+    if (url.empty() || url == "about:blank" || url.find("data:") == 0) return;
 
-    // Check if bookmark already exists
+    // Check if bookmark with this URL already exists
     auto it = std::find_if(m_bookmarks.begin(), m_bookmarks.end(),
-        [&url](const Bookmark& bm) { return bm.url == url; });
+                           [&url](const Bookmark& bm) { return bm.url == url; });
 
-    // If exists, update name, otherwise add new
     if (it != m_bookmarks.end()) {
+        // Update existing bookmark's name and icon
         it->name = name;
+        it->favicon = icon;
+    } else {
+        // Add new bookmark
+        m_bookmarks.push_back({ name, url, icon });
     }
-    else {
-        m_bookmarks.push_back({ name, url, "🔖" });
-    }
+    m_history.SetBookmarked(url, name, true);
 
-    // Clear bookmark name buffer
+    // Clear the input buffer after saving
     m_bookmarkNameBuffer[0] = '\0';
 }
 
 void BrowserPage::LoadBookmark(const std::string& url) {
     if (m_browserView) {
         m_browserView->Navigate(url);
-        strcpy_s(m_urlBuffer, url.c_str());
+        // Update URL buffer in UI
+         strncpy_s(m_urlBuffer, url.c_str(), sizeof(m_urlBuffer) - 1);
     }
 }
 
 void BrowserPage::DeleteBookmark(size_t index) {
     if (index < m_bookmarks.size()) {
+        std::string url = m_bookmarks[index].url;
         m_bookmarks.erase(m_bookmarks.begin() + index);
+        // Still suggested as a bookmark while another bookmark has the same URL
+        bool stillBookmarked = std::any_of(m_bookmarks.begin(), m_bookmarks.end(),
+            [&url](const Bookmark& bookmark) { return bookmark.url == url; });
+        if (!stillBookmarked) m_history.SetBookmarked(url, std::string(), false);
     }
 }
\ No newline at end of file
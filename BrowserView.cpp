@@ -3,9 +3,15 @@
 
 #include "BrowserView.h"
 #include "ResourceManager.h" // Include ResourceManager
+#include "PixelCopy.h"
+#include "CpuProfiler.h"
+#include "Log.h"
 #include <stdexcept>
 #include <algorithm>
+#include <cmath>
 #include <vector> // For intermediate buffer copy
+#include <functional>
+#include <thread>
 
 BrowserView::BrowserView(RenderSystem* renderSystem)
     : m_renderSystem(renderSystem),
@@ -15,6 +21,9 @@ BrowserView::BrowserView(RenderSystem* renderSystem)
     if (!m_renderSystem) {
         throw std::invalid_argument("RenderSystem cannot be null");
     }
+    m_textureConverter = std::make_unique<TextureConverter>(m_renderSystem);
+    m_webWidgetAtlas = std::make_unique<WebWidgetAtlas>(m_renderSystem); // Its texture comes with the first widget paint
+    m_tabThumbnails = std::make_unique<TabThumbnailCache>(m_renderSystem);
 }
 
 BrowserView::~BrowserView() {
@@ -22,53 +31,60 @@ BrowserView::~BrowserView() {
 }
 
 bool BrowserView::Initialize() {
-    // Initialize browser manager
+    // Only the subprocess check runs at startup; CefInitialize waits for StartBrowser.
+    // In a CEF subprocess this returns false once CEF's work is done and the app should exit.
+    return !m_browserManager->ExecuteSubprocess(GetModuleHandle(NULL));
+}
+
+bool BrowserView::StartBrowser() {
+    if (m_browserStarted || m_browserStartFailed) return m_browserStarted;
+
+    if (m_paintReplay || m_externalPaints) {
+        CreateBrowserTextureResources(m_width, m_height);
+        m_browserInternalWidth = static_cast<int>(m_width * m_renderQuality);
+        m_browserInternalHeight = static_cast<int>(m_height * m_renderQuality);
+        m_browserStarted = true;
+        return true;
+    }
+
     if (!m_browserManager->Initialize(GetModuleHandle(NULL))) {
-        // Initialization might fail if it's a CEF subprocess, which is expected.
-        // Or it could be a real error. BrowserManager returns false for subprocess.
-        // We might need a better way to distinguish these cases if necessary.
-        // OutputDebugStringA("BrowserManager Initialize failed.\n");
-        // For now, assume failure means error if not a subprocess (manager handles that check)
-        if (!m_browserManager->m_isSubprocess) { // Accessing member directly - consider a getter
-            OutputDebugStringA("Error: BrowserManager failed to initialize CEF.\n");
-            return false;
-        }
-        // If it's a subprocess, Initialize returns false but it's not an error state for the main app.
-        // The subprocess will exit via CefExecuteProcess. The main app continues.
-        // So we might return true here conceptually, but the main app needs to handle
-        // the case where the manager isn't fully usable.
-        // Let's refine: Initialize should only return false on *actual* error in the main process.
+        LOG_ERROR("BrowserManager failed to initialize CEF");
+        m_browserStartFailed = true;
+        return false;
     }
 
     // Create browser texture resources (GPU texture + upload buffer)
     CreateBrowserTextureResources(m_width, m_height);
 
-    // Create the actual browser instance
-    // Make sure manager is actually initialized (not a subprocess)
-    if (m_browserManager->m_initialized) { // Check initialization state
-        if (!m_browserManager->CreateBrowser("about:blank")) {
-            OutputDebugStringA("Error: Failed to create CEF browser instance.\n");
-            ReleaseBrowserTextureResources(); // Clean up textures if browser fails
-            return false;
-        }
-        // Set initial size for the browser handler via the manager
-        m_browserInternalWidth = static_cast<int>(m_width * m_renderQuality);
-        m_browserInternalHeight = static_cast<int>(m_height * m_renderQuality);
-        if (m_browserManager->GetBrowserHandler()) {
-            m_browserManager->GetBrowserHandler()->SetBrowserSize(m_browserInternalWidth, m_browserInternalHeight);
-        }
-        // Tell the host it was resized after creation
-        if (m_browserManager->GetBrowser() && m_browserManager->GetBrowser()->GetHost()) {
-            m_browserManager->GetBrowser()->GetHost()->WasResized();
-        }
-    }
-    else {
-        // This case implies Initialize returned false due to being a subprocess.
-        // The main application instance doesn't need a browser in this case.
-        // It might need adjustment depending on how subprocess handling is intended.
-        // Let's assume Initialize throws on real error, and returns false only for subprocess.
+    // Set initial size for every tab via the manager
+    m_browserInternalWidth = static_cast<int>(m_width * m_renderQuality);
+    m_browserInternalHeight = static_cast<int>(m_height * m_renderQuality);
+    m_browserManager->SetBrowserSize(m_width, m_height, m_renderQuality);
+
+    // Go straight to the URL requested before startup instead of loading about:blank first
+    std::string url = m_pendingUrl.empty() ? "about:blank" : m_pendingUrl;
+    m_pendingUrl.clear();
+    if (!m_browserManager->CreateBrowser(url)) {
+        LOG_ERROR("Failed to create CEF browser instance");
+        ReleaseBrowserTextureResources(); // Clean up textures if browser fails
+        m_browserStartFailed = true;
+        return false;
     }
+    // Created asynchronously: OnBrowserCreated sizes it, the frame rate applies once it exists
+    ApplyPaintFrameRate();
 
+    m_browserStarted = true;
+    return true;
+}
+
+bool BrowserView::StartPaintReplay(const std::string& path) {
+    if (m_browserStarted) return false;
+    auto replay = std::make_unique<PaintTraceReplay>();
+    if (!replay->Open(path)) {
+        LOG_WARNING("No paints to replay in %s", path);
+        return false;
+    }
+    m_paintReplay = std::move(replay);
     return true;
 }
 
@@ -78,18 +94,31 @@ void BrowserView::Shutdown() {
         m_browserManager->Shutdown();
     }
     m_browserManager.reset(); // Release manager itself
+    m_browserStarted = false;
 
     // Release texture resources
     ReleaseBrowserTextureResources();
+    ReleasePopupResources();
+    m_webWidgetAtlas.reset(); // The widget browsers closed with the manager
+    m_tabThumbnails.reset();
 
     // Nullify render system pointer (it's not owned)
     m_renderSystem = nullptr;
 }
 
 void BrowserView::Navigate(const std::string& url) {
-    if (m_browserManager && m_browserManager->m_initialized) {
+    if (m_browserStarted) {
         m_browserManager->LoadURL(url);
     }
+    else {
+        m_pendingUrl = url; // Loaded by StartBrowser
+    }
+}
+
+void BrowserView::SpeculateNavigation(const std::string& url) {
+    if (m_browserStarted) {
+        m_browserManager->SpeculateNavigation(url);
+    }
 }
 
 void BrowserView::Resize(int width, int height) {
@@ -101,7 +130,8 @@ void BrowserView::Resize(int width, int height) {
     m_width = width;
     m_height = height;
 
-    // Apply render quality to get internal browser dimensions
+    // Apply render quality to get internal browser dimensions (the size of the paints; CEF lays
+    // out at the logical size with the quality as its device scale factor)
     int newInternalWidth = std::max(1, static_cast<int>(width * m_renderQuality));
     int newInternalHeight = std::max(1, static_cast<int>(height * m_renderQuality));
 
@@ -111,19 +141,20 @@ void BrowserView::Resize(int width, int height) {
         internalSizeChanged = true;
     }
 
-    // Update browser handler size if it changed
-    if (internalSizeChanged && m_browserManager && m_browserManager->GetBrowserHandler()) {
-        m_browserManager->GetBrowserHandler()->SetBrowserSize(m_browserInternalWidth, m_browserInternalHeight);
+    // Update browser handler size if it changed; a quality change alone keeps the page's layout
+    // and only rasterizes it again
+    if ((internalSizeChanged || needsResize) && m_browserManager) {
+        m_browserManager->SetBrowserSize(m_width, m_height, m_renderQuality);
         // Notify the browser host about the resize
         if (m_browserManager->GetBrowser() && m_browserManager->GetBrowser()->GetHost()) {
+            m_browserManager->GetBrowser()->GetHost()->NotifyScreenInfoChanged();
             m_browserManager->GetBrowser()->GetHost()->WasResized();
         }
     }
 
     // Recreate texture resources only if logical dimensions changed
-    if (needsResize) {
-        // Wait for GPU before releasing resources tied to the swap chain/command lists
-        m_renderSystem->WaitForGpu();
+    // (the old ones are retired until frames in flight finish with them)
+    if (needsResize && m_browserStarted) {
         ReleaseBrowserTextureResources();
         CreateBrowserTextureResources(m_width, m_height);
     }
@@ -132,35 +163,1331 @@ void BrowserView::Resize(int width, int height) {
     m_textureNeedsGPUCopy = true; // Assume resize requires redraw
 }
 
-void BrowserView::Update() {
+void BrowserView::Update(std::chrono::steady_clock::time_point pumpDeadline,
+    std::chrono::steady_clock::duration frameInterval) {
     // Skip processing if suspended
     if (m_processingIsSuspended) {
         return;
     }
 
-    // Process message loop only according to frequency
-    m_frameCounter++;
-    if (m_frameCounter >= m_framesPerUpdate) {
-        m_frameCounter = 0;
-        if (m_browserManager && m_browserManager->m_initialized) {
-            m_browserManager->DoMessageLoopWork();
-        }
+    // Released while suspended; the new texture starts empty, so ask for a full repaint
+    if (m_textureResourcesReleased && m_browserStarted) {
+        CreateBrowserTextureResources(m_width, m_height);
+        RequestFullUpload();
+    }
+
+    if (m_paintReplay) {
+        m_paintReplay->Update(*this);
+        return;
+    }
+    if (m_externalPaints) return;
+
+    // CEF's GPU process may sit on another adapter; recreate the browser with software paint
+    if (m_sharedTextureFailed.exchange(false) && m_browserManager && m_browserManager->IsSharedTextureEnabled()) {
+        std::string url = m_browserManager->GetURL();
+        m_browserManager->SetSharedTextureEnabled(false);
+        m_browserManager->CreateBrowser(url.empty() ? "about:blank" : url);
+        ApplyPaintFrameRate();
+    }
+
+    // A paint found every upload slot in use; a fresh one picks up the pending regions
+    if (m_repaintRequested.exchange(false) && m_browserManager && m_browserManager->GetBrowser() &&
+        m_browserManager->GetBrowser()->GetHost()) {
+        m_browserManager->GetBrowser()->GetHost()->Invalidate(PET_VIEW);
+    }
+
+    // Pump only when CEF scheduled work; painting is throttled separately through the paint frame rate
+    if (m_browserManager && m_browserManager->m_initialized) {
+        m_browserManager->DoScheduledMessageLoopWork(pumpDeadline, frameInterval);
     }
     // Note: OnPaint is triggered by DoMessageLoopWork and calls SignalTextureUpdateFromHandler
 }
 
 // Called by BrowserManager when BrowserHandler::OnPaint fires
-void BrowserView::SignalTextureUpdateFromHandler(const void* buffer, int width, int height) {
-    // This is called from CEF's thread, so use a mutex if accessing shared members that aren't atomic
-    std::lock_guard<std::mutex> lock(m_bufferMutex);
-    m_cpuBufferData = buffer; // Store pointer temporarily
-    m_cpuBufferWidth = width;
-    m_cpuBufferHeight = height;
+void BrowserView::SignalTextureUpdateFromHandler(const void* buffer, int width, int height, const std::vector<RECT>& dirtyRects,
+    LONGLONG paintQpc) {
+    // CEF's buffer is only valid during OnPaint, so everything needed is copied out here.
+    // Runs on CEF's UI thread: the render thread in single-threaded mode, CEF's own otherwise.
+    // Slots are recreated on the render thread only after claiming them (see ReleaseBrowserTextureResources).
+    if (!buffer || width <= 0 || height <= 0) return;
+    PROFILE_ZONE("CEF Paint");
+
+    // An unconsumed paint is superseded; its regions are rewritten from this buffer
+    int previousSlot = m_publishedSlot.exchange(-1);
+    if (previousSlot < 0 && !m_publishedRects.empty()) {
+        // Taken: the texture it went into is shown, the other one lacks its regions
+        m_catchUpRects.swap(m_publishedRects);
+        m_publishedRects.clear();
+    }
+    if (previousSlot >= 0) {
+        UploadSlot& stale = m_uploadRing[previousSlot];
+        for (const RECT& rect : stale.rects) {
+            MergeDirtyRect(rect);
+            InvalidateTiles(rect); // Hashed, but never reached the GPU
+        }
+        for (const RECT& rect : stale.rects) {
+            InvalidateRows(rect);
+        }
+        // The moved rows never reached the texture either; the hashes already claim they did
+        for (const ScrollMove& move : stale.scrollMoves) {
+            const RECT rows = { 0, move.top, stale.width, move.bottom };
+            MergeDirtyRect(rows);
+            InvalidateTiles(rows);
+            InvalidateRows(rows);
+        }
+        stale.scrollMoves.clear();
+        stale.state = UploadSlotState::Free;
+        m_overwrittenPaintCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    for (const RECT& rect : dirtyRects) {
+        MergeDirtyRect(rect);
+    }
+
+    bool fullUpload = m_fullUploadPending.exchange(false) || width != m_uploadedWidth || height != m_uploadedHeight;
+
+    size_t srcRowPitch = static_cast<size_t>(width) * 4; // BGRA
+    size_t dstRowPitch = (srcRowPitch + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) & ~(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1);
+
+    UploadSlot* slot = AcquireFreeUploadSlot();
+    if (!slot) {
+        // Nothing can take the pixels now; keep the regions and ask CEF to paint again
+        m_fullUploadPending = m_fullUploadPending || fullUpload;
+        m_repaintRequested = true;
+        m_paintCount.fetch_add(1, std::memory_order_relaxed);
+        m_overwrittenPaintCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (dstRowPitch * height > slot->size) {
+        // Larger than the texture (resize in progress); the resize repaints everything
+        slot->state = UploadSlotState::Free;
+        m_fullUploadPending = true;
+        return;
+    }
+
+    // Scrolled since the last paint that reached a slot, in paint pixels
+    const LONG scrollDy = static_cast<LONG>(std::lround((m_scrollOffsetY - m_paintedScrollOffsetY) * m_renderQuality));
+    m_paintedScrollOffsetY = m_scrollOffsetY;
+
+    // Dirty regions round out to tiles; tiles that hash as before are left out
+    const uint8_t* pixels = static_cast<const uint8_t*>(buffer);
+    CollectChangedTiles(pixels, width, height, fullUpload, slot->rects);
+    m_dirtyRects.clear();
+    if (slot->rects.empty()) {
+        // CEF repainted what was already there: nothing to upload or redraw
+        slot->state = UploadSlotState::Free;
+        return;
+    }
+
+    // Scroll reuse moves rows within the shown texture, so only when paints are copied from the slots
+    const bool copiesFromSlots = m_uploadPath != BrowserUploadPath::GpuUploadTexture && !m_gpuConversionActive;
+    slot->scrollMoves.clear();
+    if (!copiesFromSlots) {
+        m_rowHashes.clear();
+    }
+    else if (fullUpload || m_rowHashes.size() != static_cast<size_t>(height)) {
+        m_rowHashes.assign(height, 0);
+        UpdateRowHashes(pixels, width, 0, height);
+    }
+    else if (scrollDy != 0 && std::abs(scrollDy) < height) {
+        DetectScroll(pixels, width, height, scrollDy, *slot);
+    }
+    else {
+        for (const RECT& rect : slot->rects) {
+            UpdateRowHashes(pixels, width, rect.top, rect.bottom);
+        }
+    }
+
+    // The back display texture lacks the previous paint; a scroll rewrites all of it anyway
+    slot->catchUpRects.clear();
+    if (copiesFromSlots && m_renderSystem->HasCopyQueue() && !fullUpload && slot->scrollMoves.empty()) {
+        const RECT bounds = { 0, 0, width, height };
+        for (const RECT& rect : m_catchUpRects) {
+            RECT clipped;
+            if (IntersectRect(&clipped, &rect, &bounds)) slot->catchUpRects.push_back(clipped);
+        }
+    }
+
+    // Upload memory is write-combined; the kernel streams each rect in one pass
+    // The compute path premultiplies on the GPU
+    const bool premultiplyAlpha = m_premultiplyAlpha && !m_gpuConversionActive;
+    UINT64 copiedBytes = 0;
+    if (m_uploadPath == BrowserUploadPath::GpuUploadTexture) {
+        copiedBytes = WriteSlotTexture(*slot, static_cast<const uint8_t*>(buffer), width, height, premultiplyAlpha);
+    }
+    else {
+        for (const std::vector<RECT>* rects : { &slot->rects, &slot->catchUpRects }) {
+            for (const RECT& rect : *rects) {
+                size_t rowOffset = static_cast<size_t>(rect.left) * 4;
+                copiedBytes += static_cast<UINT64>(rect.right - rect.left) * 4 * (rect.bottom - rect.top);
+                CopyPixelRows(
+                    slot->mappedData + rect.top * dstRowPitch + rowOffset, dstRowPitch,
+                    pixels + rect.top * srcRowPitch + rowOffset, srcRowPitch,
+                    static_cast<size_t>(rect.right - rect.left) * 4, static_cast<size_t>(rect.bottom - rect.top),
+                    premultiplyAlpha);
+            }
+        }
+    }
+    m_uploadedBytes.fetch_add(copiedBytes, std::memory_order_relaxed);
+    slot->rectBytes = copiedBytes;
+    slot->width = width;
+    slot->height = height;
+    slot->rowPitch = static_cast<UINT>(dstRowPitch);
+    slot->paintQpc = paintQpc;
+    m_paintCount.fetch_add(1, std::memory_order_relaxed);
+    m_uploadedWidth = width;
+    m_uploadedHeight = height;
+
+    // Publish; the render thread only records the GPU copy
+    m_publishedRects = slot->rects;
+    slot->state = UploadSlotState::Published;
+    m_publishedSlot = static_cast<int>(slot - m_uploadRing);
     m_textureNeedsGPUCopy = true; // Set the flag indicating GPU copy is required
 }
 
+// Called by BrowserManager when BrowserHandler::OnAcceleratedPaint fires
+void BrowserView::SignalSharedTextureFromHandler(HANDLE sharedHandle, LONGLONG paintQpc) {
+    if (!m_renderSystem || !m_renderSystem->GetDevice()) return;
+    PROFILE_EVENT("CEF Accelerated Paint");
+
+    SharedTextureCopier* copier = m_renderSystem->GetSharedTextureCopier();
+    if (!copier || !copier->IsAvailable()) {
+        LOG_WARNING("No copy queue for CEF shared textures, falling back to software paint");
+        m_sharedTextureFailed = true;
+        return;
+    }
+    const bool copied = CopyAcceleratedPaint(sharedHandle, m_bufferMutex, m_paintCopies, m_sharedTexture,
+        L"Browser Paint Copy", [this, paintQpc](bool replaced) {
+            // A paint that was never copied is simply replaced
+            if (replaced) m_overwrittenPaintCount.fetch_add(1, std::memory_order_relaxed);
+            m_paintCount.fetch_add(1, std::memory_order_relaxed);
+            m_sharedTexturePaintQpc = paintQpc;
+            m_textureNeedsGPUCopy = true;
+        });
+    if (!copied) {
+        m_repaintRequested = true; // Every copy still read by a frame in flight, or the copy failed
+    }
+}
+
+template <typename Mutex>
+bool BrowserView::CopyAcceleratedPaint(HANDLE sharedHandle, Mutex& mutex, std::vector<PaintCopy>& copies,
+    ComPtr<ID3D12Resource>& pending, const wchar_t* name, const std::function<void(bool replaced)>& publish) {
+    SharedTextureCopier* copier = m_renderSystem->GetSharedTextureCopier();
+    if (!copier || !copier->IsAvailable()) return false;
+
+    // Valid until the callback returns; the copy below finishes before that
+    ComPtr<ID3D12Resource> source;
+    if (FAILED(m_renderSystem->GetDevice()->OpenSharedHandle(sharedHandle, IID_PPV_ARGS(&source)))) {
+        LOG_WARNING("Failed to open a CEF shared texture");
+        return false;
+    }
+    const D3D12_RESOURCE_DESC sourceDesc = source->GetDesc();
+
+    // The pending copy (never recorded, so simply replaced), one whose last frame the GPU finished,
+    // or a new one; sized like the paint
+    ComPtr<ID3D12Resource> target;
+    bool replaced = false;
+    {
+        std::lock_guard<Mutex> lock(mutex);
+        const UINT64 completedFenceValue = m_renderSystem->GetCompletedFenceValue();
+        PaintCopy* copy = nullptr;
+        for (PaintCopy& candidate : copies) {
+            if (pending && candidate.texture.Get() == pending.Get()) copy = &candidate;
+        }
+        if (copy) {
+            pending.Reset(); // Not recorded from while it is written
+            replaced = true;
+        }
+        for (size_t i = 0; !copy && i < copies.size(); i++) {
+            PaintCopy& candidate = copies[i];
+            if (!candidate.writing && candidate.texture.Get() != pending.Get() &&
+                candidate.fenceValue <= completedFenceValue) {
+                copy = &candidate;
+            }
+        }
+        if (!copy && copies.size() < MAX_PAINT_COPIES) {
+            copies.emplace_back();
+            copy = &copies.back();
+        }
+        if (!copy) return false;
+
+        const D3D12_RESOURCE_DESC desc = copy->texture ? copy->texture->GetDesc() : D3D12_RESOURCE_DESC{};
+        if (!copy->texture || desc.Width != sourceDesc.Width || desc.Height != sourceDesc.Height ||
+            desc.Format != sourceDesc.Format) {
+            copy->texture = copier->CreateTarget(static_cast<UINT>(sourceDesc.Width), sourceDesc.Height,
+                sourceDesc.Format, name); // The old one is free: no frame reads it
+            if (!copy->texture) {
+                LOG_WARNING("Failed to create a CEF paint copy");
+                return false;
+            }
+        }
+        copy->writing = true;
+        target = copy->texture;
+    }
+
+    // Outside the lock: the render thread's recording doesn't wait on this GPU copy
+    UINT width = 0, height = 0;
+    const bool copied = copier->Copy(source.Get(), target.Get(), width, height);
+
+    std::lock_guard<Mutex> lock(mutex);
+    PaintCopy* copy = nullptr;
+    for (PaintCopy& candidate : copies) {
+        if (candidate.texture.Get() == target.Get()) copy = &candidate;
+    }
+    if (!copy) return false; // Retired meanwhile (the view's textures were released)
+    copy->writing = false;
+    if (!copied) {
+        LOG_WARNING("Failed to copy a CEF shared texture");
+        return false;
+    }
+    replaced = replaced || pending;
+    pending = target;
+    publish(replaced);
+    return true;
+}
+
+void BrowserView::MarkPaintCopyRead(std::vector<PaintCopy>& copies, ID3D12Resource* texture, UINT64 fenceValue) {
+    for (PaintCopy& copy : copies) {
+        if (copy.texture.Get() == texture) copy.fenceValue = fenceValue;
+    }
+}
+
+void BrowserView::RetirePaintCopies(std::vector<PaintCopy>& copies) {
+    // A copy being written stays alive in its callback, which then finds it gone
+    ResourceManager* resourceManager = m_renderSystem ? m_renderSystem->GetResourceManager() : nullptr;
+    for (PaintCopy& copy : copies) {
+        if (resourceManager && copy.texture) resourceManager->RetireResource(std::move(copy.texture));
+    }
+    copies.clear();
+}
+
+void BrowserView::SignalPopupShowFromHandler(bool show) {
+    std::lock_guard<std::mutex> lock(m_popupMutex);
+    m_popupVisible = show;
+    if (!show) {
+        // Content is stale once hidden; the next show comes with a fresh paint
+        m_popupRect = {};
+        m_popupPixelsDirty = false;
+        m_popupSharedTexture.Reset(); // Never recorded from: its paint copy is free again
+        m_popupHasContent = false;
+    }
+    m_textureNeedsGPUCopy = true; // Redraw with or without the popup
+}
+
+void BrowserView::SignalPopupSizeFromHandler(const RECT& rect) {
+    std::lock_guard<std::mutex> lock(m_popupMutex);
+    m_popupRect = rect;
+    m_textureNeedsGPUCopy = true;
+}
+
+void BrowserView::SignalPopupPaintFromHandler(const void* buffer, int width, int height) {
+    if (!buffer || width <= 0 || height <= 0) return;
+
+    // Popups are small; a plain copy under the lock is cheaper than another upload ring
+    std::lock_guard<std::mutex> lock(m_popupMutex);
+    size_t rowBytes = static_cast<size_t>(width) * 4;
+    m_popupPixels.resize(rowBytes * height);
+    CopyPixelRows(m_popupPixels.data(), rowBytes, static_cast<const uint8_t*>(buffer), rowBytes,
+        rowBytes, static_cast<size_t>(height), m_premultiplyAlpha);
+    m_popupPixelWidth = width;
+    m_popupPixelHeight = height;
+    m_popupPixelsDirty = true;
+    m_textureNeedsGPUCopy = true;
+}
+
+void BrowserView::SignalPopupSharedTextureFromHandler(HANDLE sharedHandle) {
+    if (!m_renderSystem || !m_renderSystem->GetDevice()) return;
+
+    CopyAcceleratedPaint(sharedHandle, m_popupMutex, m_popupPaintCopies, m_popupSharedTexture,
+        L"Browser Popup Paint Copy", [this](bool) { m_textureNeedsGPUCopy = true; });
+}
+
+void BrowserView::RecordPopupUpload(ID3D12GraphicsCommandList* commandList) {
+    ResourceManager* resourceManager = m_renderSystem ? m_renderSystem->GetResourceManager() : nullptr;
+    if (!commandList || !resourceManager) return;
+
+    std::lock_guard<std::mutex> lock(m_popupMutex);
+    if (!m_popupVisible || (!m_popupSharedTexture && !m_popupPixelsDirty)) return;
+
+    D3D12_TEXTURE_COPY_LOCATION dstLocation = {};
+    dstLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    dstLocation.SubresourceIndex = 0;
+
+    if (m_popupSharedTexture) {
+        // Accelerated paint: GPU-to-GPU copy
+        D3D12_RESOURCE_DESC srcDesc = m_popupSharedTexture->GetDesc();
+        if (!EnsurePopupTexture(static_cast<UINT>(srcDesc.Width), srcDesc.Height)) return;
+
+        D3D12_TEXTURE_COPY_LOCATION srcLocation = {};
+        srcLocation.pResource = m_popupSharedTexture.Get();
+        srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        srcLocation.SubresourceIndex = 0;
+        dstLocation.pResource = m_popupTexture.Get();
+
+        resourceManager->TransitionResource(commandList, m_popupTexture.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+        commandList->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, nullptr);
+        resourceManager->BeginSplitTransition(m_popupTexture.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        resourceManager->FlushBarriers(commandList); // Ended before ImGui samples it
+
+        MarkPaintCopyRead(m_popupPaintCopies, m_popupSharedTexture.Get(), m_renderSystem->GetCurrentFenceValue());
+        m_popupSharedTexture.Reset();
+    }
+    else {
+        UINT width = static_cast<UINT>(m_popupPixelWidth);
+        UINT height = static_cast<UINT>(m_popupPixelHeight);
+        if (!EnsurePopupTexture(width, height)) return;
+
+        // A buffer whose last copy the GPU has finished; otherwise retry next frame
+        UINT64 completedFenceValue = m_renderSystem->GetCompletedFenceValue();
+        PopupUploadBuffer* upload = nullptr;
+        for (PopupUploadBuffer& candidate : m_popupUploadRing) {
+            if (candidate.fenceValue <= completedFenceValue) {
+                upload = &candidate;
+                break;
+            }
+        }
+        if (!upload) {
+            m_textureNeedsGPUCopy = true;
+            return;
+        }
+
+        size_t srcRowPitch = static_cast<size_t>(width) * 4;
+        size_t dstRowPitch = (srcRowPitch + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) & ~(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1);
+        UINT64 requiredSize = static_cast<UINT64>(dstRowPitch) * height;
+        if (upload->size < requiredSize) {
+            if (upload->buffer) {
+                resourceManager->RetireResource(std::move(upload->buffer));
+            }
+            upload->buffer = resourceManager->CreateUploadBuffer(requiredSize);
+            void* mappedData = nullptr;
+            D3D12_RANGE readRange = { 0, 0 }; // We are writing, not reading
+            if (!upload->buffer || FAILED(upload->buffer->Map(0, &readRange, &mappedData))) {
+                LOG_WARNING("Failed to create popup upload buffer");
+                upload->buffer.Reset();
+                upload->mappedData = nullptr;
+                upload->size = 0;
+                return;
+            }
+            upload->buffer->SetName(L"Browser Popup Upload Buffer");
+            upload->mappedData = static_cast<uint8_t*>(mappedData);
+            upload->size = requiredSize;
+        }
+
+        CopyPixelRows(upload->mappedData, dstRowPitch, m_popupPixels.data(), srcRowPitch, srcRowPitch, height);
+
+        D3D12_TEXTURE_COPY_LOCATION srcLocation = {};
+        srcLocation.pResource = upload->buffer.Get();
+        srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        srcLocation.PlacedFootprint.Offset = 0;
+        srcLocation.PlacedFootprint.Footprint.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+        srcLocation.PlacedFootprint.Footprint.Width = width;
+        srcLocation.PlacedFootprint.Footprint.Height = height;
+        srcLocation.PlacedFootprint.Footprint.Depth = 1;
+        srcLocation.PlacedFootprint.Footprint.RowPitch = static_cast<UINT>(dstRowPitch);
+        dstLocation.pResource = m_popupTexture.Get();
+
+        resourceManager->TransitionResource(commandList, m_popupTexture.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+        commandList->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, nullptr);
+        resourceManager->BeginSplitTransition(m_popupTexture.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        resourceManager->FlushBarriers(commandList); // Ended before ImGui samples it
+
+        upload->fenceValue = m_renderSystem->GetCurrentFenceValue();
+        m_popupPixelsDirty = false;
+    }
+
+    m_popupHasContent = true;
+}
+
+bool BrowserView::EnsurePopupTexture(UINT width, UINT height) {
+    if (width == 0 || height == 0) return false;
+
+    if (m_popupTexture) {
+        D3D12_RESOURCE_DESC desc = m_popupTexture->GetDesc();
+        if (desc.Width == width && desc.Height == height) return true;
+    }
+
+    ResourceManager* resourceManager = m_renderSystem->GetResourceManager();
+    ID3D12Device* device = m_renderSystem->GetDevice();
+    if (!resourceManager || !device) return false;
+
+    // Popups change size as they open; the old one goes back to the pool, its descriptor is
+    // freed once the GPU is done with it
+    if (m_popupTexture) {
+        UINT srvDescriptorIndex = m_popupSrvDescriptorIndex;
+        resourceManager->RecycleTexture(std::move(m_popupTexture), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        resourceManager->RetireResource(nullptr, [resourceManager, srvDescriptorIndex]() {
+            resourceManager->FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, srvDescriptorIndex);
+        });
+        m_popupSrvDescriptorIndex = UINT_MAX;
+        m_popupHasContent = false;
+    }
+
+    m_popupTexture = resourceManager->AcquireTexture2D(width, height, DXGI_FORMAT_B8G8R8A8_UNORM,
+        D3D12_RESOURCE_FLAG_NONE, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    if (!m_popupTexture) {
+        LOG_WARNING("Failed to create browser popup texture");
+        return false;
+    }
+    m_popupTexture->SetName(L"Browser Popup Texture");
+
+    m_popupSrvDescriptorIndex = resourceManager->AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    if (m_popupSrvDescriptorIndex == UINT_MAX) {
+        LOG_WARNING("Failed to allocate descriptor for browser popup SRV");
+        resourceManager->RetireResource(std::move(m_popupTexture));
+        return false;
+    }
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Texture2D.MipLevels = 1;
+    device->CreateShaderResourceView(m_popupTexture.Get(), &srvDesc,
+        resourceManager->GetCpuDescriptorHandle(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, m_popupSrvDescriptorIndex));
+    return true;
+}
+
+void BrowserView::ReleasePopupResources() {
+    ResourceManager* resourceManager = m_renderSystem ? m_renderSystem->GetResourceManager() : nullptr;
+
+    std::lock_guard<std::mutex> lock(m_popupMutex);
+    if (resourceManager) {
+        UINT srvDescriptorIndex = m_popupSrvDescriptorIndex;
+        std::function<void()> freeDescriptor;
+        if (srvDescriptorIndex != UINT_MAX) {
+            freeDescriptor = [resourceManager, srvDescriptorIndex]() {
+                resourceManager->FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, srvDescriptorIndex);
+            };
+        }
+        resourceManager->RecycleTexture(std::move(m_popupTexture), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        resourceManager->RetireResource(nullptr, std::move(freeDescriptor));
+        for (PopupUploadBuffer& upload : m_popupUploadRing) {
+            resourceManager->RetireResource(std::move(upload.buffer));
+        }
+    }
+    m_popupTexture.Reset();
+    m_popupSharedTexture.Reset();
+    RetirePaintCopies(m_popupPaintCopies);
+    m_popupSrvDescriptorIndex = UINT_MAX;
+    for (PopupUploadBuffer& upload : m_popupUploadRing) {
+        upload = PopupUploadBuffer();
+    }
+    m_popupHasContent = false;
+    m_popupVisible = false;
+}
+
+bool BrowserView::GetPopupLayer(D3D12_GPU_DESCRIPTOR_HANDLE& gpuHandle, RECT& rect) const {
+    if (!m_popupHasContent || !m_renderSystem || !m_renderSystem->GetResourceManager()) return false;
+
+    std::lock_guard<std::mutex> lock(m_popupMutex);
+    if (!m_popupVisible || m_popupSrvDescriptorIndex == UINT_MAX ||
+        m_popupRect.right <= m_popupRect.left || m_popupRect.bottom <= m_popupRect.top) {
+        return false;
+    }
+
+    // Keeps it off the eviction list (and pages it back in if it was evicted)
+    m_renderSystem->GetResourceManager()->NotifyResourceUsed(m_popupTexture.Get());
+    gpuHandle = m_renderSystem->GetResourceManager()->GetGpuDescriptorHandle(
+        D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, m_popupSrvDescriptorIndex);
+    // CEF places popups in view coordinates; paints are scaled by the render quality
+    const float scale = m_renderQuality;
+    rect = { static_cast<LONG>(m_popupRect.left * scale), static_cast<LONG>(m_popupRect.top * scale),
+             static_cast<LONG>(std::ceil(m_popupRect.right * scale)), static_cast<LONG>(std::ceil(m_popupRect.bottom * scale)) };
+    return true;
+}
+
+void BrowserView::RequestFullUpload() {
+    m_fullUploadPending = true;
+    m_repaintRequested = true;
+}
+
+void BrowserView::OnActiveTabChanged() {
+    // What the texture shows stays until the new tab paints; it is kept as that tab's thumbnail
+    if (m_tabThumbnails && m_textureTabId != 0) m_tabThumbnails->RequestCapture(m_textureTabId);
+
+    // The previous tab's accelerated paint (and popup) must not be shown for the new one
+    {
+        std::lock_guard<ProfiledMutex> lock(m_bufferMutex);
+        ReleaseSharedTexture();
+    }
+    SignalPopupShowFromHandler(false);
+    RequestFullUpload();
+    m_textureNeedsGPUCopy = true; // Redraw even if the new tab is slow to paint
+}
+
+void BrowserView::MergeRect(std::vector<RECT>& rects, RECT rect) {
+    if (rect.right <= rect.left || rect.bottom <= rect.top) return;
+
+    // Absorb every rect the new one touches, repeating as the union grows
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (auto it = rects.begin(); it != rects.end(); ++it) {
+            if (rect.left <= it->right && it->left <= rect.right &&
+                rect.top <= it->bottom && it->top <= rect.bottom) {
+                UnionRect(&rect, &rect, &*it);
+                rects.erase(it);
+                merged = true;
+                break;
+            }
+        }
+    }
+    rects.push_back(rect);
+
+    if (rects.size() > MAX_DIRTY_RECTS) {
+        RECT bounds = rects.front();
+        for (const RECT& dirty : rects) {
+            UnionRect(&bounds, &bounds, &dirty);
+        }
+        rects.assign(1, bounds);
+    }
+}
+
+void BrowserView::CollectChangedTiles(const uint8_t* pixels, int width, int height, bool fullUpload,
+    std::vector<RECT>& uploadRects) {
+    PROFILE_ZONE("Tile Hash");
+    constexpr LONG TILE = UPLOAD_TILE_SIZE;
+    const int columns = (width + UPLOAD_TILE_SIZE - 1) / UPLOAD_TILE_SIZE;
+    const int rows = (height + UPLOAD_TILE_SIZE - 1) / UPLOAD_TILE_SIZE;
+    if (columns != m_tileColumns || rows != m_tileRows) {
+        // A size change is a full upload anyway
+        m_tileHashes.assign(static_cast<size_t>(columns) * rows, 0);
+        m_tileColumns = columns;
+        m_tileRows = rows;
+    }
+
+    // Tiles the dirty regions touch (merged dirty rects don't overlap)
+    const RECT bounds = { 0, 0, width, height };
+    UINT64 dirtyBytes = 0;
+    m_dirtyTiles.assign(m_tileHashes.size(), fullUpload ? 1 : 0);
+    if (fullUpload) {
+        dirtyBytes = static_cast<UINT64>(width) * height * 4;
+    }
+    else {
+        for (const RECT& dirty : m_dirtyRects) {
+            RECT rect;
+            if (!IntersectRect(&rect, &dirty, &bounds)) continue;
+            dirtyBytes += static_cast<UINT64>(rect.right - rect.left) * (rect.bottom - rect.top) * 4;
+            for (LONG ty = rect.top / TILE; ty <= (rect.bottom - 1) / TILE; ty++) {
+                for (LONG tx = rect.left / TILE; tx <= (rect.right - 1) / TILE; tx++) {
+                    m_dirtyTiles[static_cast<size_t>(ty) * columns + tx] = 1;
+                }
+            }
+        }
+    }
+
+    // Changed tiles in horizontal runs; a run spanning the same columns as one in the row above
+    // extends it, so changed blocks stay one rect each
+    const size_t rowPitch = static_cast<size_t>(width) * 4;
+    UINT64 hashedTiles = 0;
+    UINT64 unchangedTiles = 0;
+    uploadRects.clear();
+    for (int ty = 0; ty < rows; ty++) {
+        const LONG top = ty * TILE;
+        const LONG bottom = std::min<LONG>(top + TILE, height);
+        int runStart = -1;
+        for (int tx = 0; tx <= columns; tx++) {
+            bool changed = false;
+            const size_t index = static_cast<size_t>(ty) * columns + tx;
+            if (tx < columns && m_dirtyTiles[index]) {
+                const LONG left = tx * TILE;
+                const LONG right = std::min<LONG>(left + TILE, width);
+                // Never 0, which marks tiles the texture may not hold
+                const uint64_t hash = HashPixelRows(pixels + top * rowPitch + static_cast<size_t>(left) * 4, rowPitch,
+                    static_cast<size_t>(right - left) * 4, static_cast<size_t>(bottom - top)) | 1;
+                changed = fullUpload || hash != m_tileHashes[index];
+                m_tileHashes[index] = hash;
+                hashedTiles++;
+                if (!changed) unchangedTiles++;
+            }
+            if (changed) {
+                if (runStart < 0) runStart = tx;
+                continue;
+            }
+            if (runStart < 0) continue;
+
+            const RECT run = { runStart * TILE, top, std::min<LONG>(tx * TILE, width), bottom };
+            runStart = -1;
+            auto above = std::find_if(uploadRects.begin(), uploadRects.end(), [&run](const RECT& rect) {
+                return rect.left == run.left && rect.right == run.right && rect.bottom == run.top;
+            });
+            if (above != uploadRects.end()) {
+                above->bottom = run.bottom;
+            }
+            else {
+                uploadRects.push_back(run);
+            }
+        }
+    }
+
+    if (fullUpload) {
+        uploadRects.assign(1, bounds);
+    }
+    else if (uploadRects.size() > MAX_TILE_RECTS) {
+        // Each rect costs a copy command
+        RECT boundingBox = uploadRects.front();
+        for (const RECT& rect : uploadRects) {
+            UnionRect(&boundingBox, &boundingBox, &rect);
+        }
+        uploadRects.assign(1, boundingBox);
+    }
+
+    m_hashedTiles.fetch_add(hashedTiles, std::memory_order_relaxed);
+    m_unchangedTiles.fetch_add(unchangedTiles, std::memory_order_relaxed);
+    m_dirtyBytes.fetch_add(dirtyBytes, std::memory_order_relaxed);
+}
+
+void BrowserView::InvalidateTiles(const RECT& rect) {
+    if (m_tileColumns == 0 || rect.right <= rect.left || rect.bottom <= rect.top) return;
+    constexpr LONG TILE = UPLOAD_TILE_SIZE;
+    const LONG lastColumn = std::min<LONG>((rect.right - 1) / TILE, m_tileColumns - 1);
+    const LONG lastRow = std::min<LONG>((rect.bottom - 1) / TILE, m_tileRows - 1);
+    for (LONG ty = std::max<LONG>(rect.top / TILE, 0); ty <= lastRow; ty++) {
+        for (LONG tx = std::max<LONG>(rect.left / TILE, 0); tx <= lastColumn; tx++) {
+            m_tileHashes[static_cast<size_t>(ty) * m_tileColumns + tx] = 0;
+        }
+    }
+}
+
+void BrowserView::SignalScrollOffsetFromHandler(double x, double y) {
+    m_scrollOffsetY = y; // Horizontal scrolls are uploaded as usual
+}
+
+void BrowserView::UpdateRowHashes(const uint8_t* pixels, int width, LONG top, LONG bottom) {
+    const size_t rowPitch = static_cast<size_t>(width) * 4;
+    bottom = std::min<LONG>(bottom, static_cast<LONG>(m_rowHashes.size()));
+    for (LONG row = std::max<LONG>(top, 0); row < bottom; row++) {
+        m_rowHashes[row] = HashPixelRows(pixels + row * rowPitch, rowPitch, rowPitch, 1) | 1;
+    }
+}
+
+void BrowserView::InvalidateRows(const RECT& rect) {
+    const LONG bottom = std::min<LONG>(rect.bottom, static_cast<LONG>(m_rowHashes.size()));
+    for (LONG row = std::max<LONG>(rect.top, 0); row < bottom; row++) {
+        m_rowHashes[row] = 0;
+    }
+}
+
+bool BrowserView::DetectScroll(const uint8_t* pixels, int width, int height, LONG dy, UploadSlot& slot) {
+    PROFILE_ZONE("Scroll Detect");
+    const size_t rowPitch = static_cast<size_t>(width) * 4;
+    m_newRowHashes.resize(height);
+    for (int row = 0; row < height; row++) {
+        m_newRowHashes[row] = HashPixelRows(pixels + row * rowPitch, rowPitch, rowPitch, 1) | 1;
+    }
+
+    // Each row is found dy rows further along the shown frame (preferred, so blank rows don't
+    // split the moved runs), in its own place, or nowhere; runs of the same kind become one copy
+    std::vector<ScrollMove> moves;
+    std::vector<RECT> uploads;
+    LONG movedRows = 0;
+    LONG runTop = 0;
+    LONG runSource = -1; // Of the run's first row; -1 uploads
+    for (LONG row = 0; row <= height; row++) {
+        LONG source = -1;
+        if (row < height) {
+            const uint64_t hash = m_newRowHashes[row];
+            const LONG moved = row + dy;
+            if (moved >= 0 && moved < height && hash == m_rowHashes[moved]) source = moved;
+            else if (hash == m_rowHashes[row]) source = row;
+            if (source >= 0 && source == moved) movedRows++;
+        }
+        // The run goes on while rows keep coming from consecutive rows (or keep being uploaded)
+        const bool continues = row < height && row > 0 &&
+            (source < 0 ? runSource < 0 : runSource >= 0 && source == runSource + (row - runTop));
+        if (continues) continue;
+        if (row > 0) {
+            if (runSource >= 0) moves.push_back({ runTop, row, runSource });
+            else uploads.push_back({ 0, runTop, width, row });
+        }
+        runTop = row;
+        runSource = source;
+    }
+    m_rowHashes.swap(m_newRowHashes); // The texture holds this frame once the slot is copied, either way
+
+    UINT64 tileBytes = 0;
+    for (const RECT& rect : slot.rects) {
+        tileBytes += static_cast<UINT64>(rect.right - rect.left) * (rect.bottom - rect.top) * 4;
+    }
+    UINT64 uploadBytes = 0;
+    for (const RECT& rect : uploads) {
+        uploadBytes += static_cast<UINT64>(rect.bottom - rect.top) * rowPitch;
+    }
+    // Not a scroll (content changed under the offset) or too fragmented to be worth the copies
+    if (movedRows < height / 4 || moves.size() > MAX_SCROLL_MOVES || uploads.size() > MAX_TILE_RECTS ||
+        uploadBytes >= tileBytes) {
+        return false;
+    }
+
+    slot.rects = std::move(uploads);
+    slot.scrollMoves = std::move(moves);
+    m_scrollPaints.fetch_add(1, std::memory_order_relaxed);
+    m_scrollMovedBytes.fetch_add(static_cast<UINT64>(movedRows) * rowPitch, std::memory_order_relaxed);
+    return true;
+}
+
+BrowserPaintStats BrowserView::GetPaintStats() const {
+    BrowserPaintStats stats;
+    stats.paints = m_paintCount.load(std::memory_order_relaxed);
+    stats.overwritten = m_overwrittenPaintCount.load(std::memory_order_relaxed);
+    return stats;
+}
+
+BrowserTileStats BrowserView::GetTileStats() const {
+    BrowserTileStats stats;
+    stats.hashedTiles = m_hashedTiles.load(std::memory_order_relaxed);
+    stats.unchangedTiles = m_unchangedTiles.load(std::memory_order_relaxed);
+    stats.dirtyBytes = m_dirtyBytes.load(std::memory_order_relaxed);
+    stats.scrollPaints = m_scrollPaints.load(std::memory_order_relaxed);
+    stats.scrollMovedBytes = m_scrollMovedBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+UINT64 BrowserView::WriteSlotTexture(UploadSlot& slot, const uint8_t* pixels, int width, int height,
+    bool premultiplyAlpha) {
+    // The slot holds a whole frame, so it also catches up on what was painted into the others
+    for (const RECT& rect : slot.rects) {
+        MergeRect(slot.staleRects, rect);
+    }
+
+    const size_t rowPitch = static_cast<size_t>(width) * 4;
+    const RECT bounds = { 0, 0, width, height };
+    UINT64 writtenBytes = 0;
+    for (const RECT& stale : slot.staleRects) {
+        RECT rect;
+        if (!IntersectRect(&rect, &stale, &bounds)) continue;
+        const size_t rowBytes = static_cast<size_t>(rect.right - rect.left) * 4;
+        const size_t rowCount = static_cast<size_t>(rect.bottom - rect.top);
+        const uint8_t* source = pixels + rect.top * rowPitch + static_cast<size_t>(rect.left) * 4;
+        size_t sourcePitch = rowPitch;
+        if (premultiplyAlpha) {
+            // WriteToSubresource copies as is; premultiply into scratch first (grows to the largest rect)
+            if (m_premultiplyScratch.size() < rowBytes * rowCount) {
+                m_premultiplyScratch.resize(rowBytes * rowCount);
+            }
+            CopyPixelRows(m_premultiplyScratch.data(), rowBytes, source, rowPitch, rowBytes, rowCount, true);
+            source = m_premultiplyScratch.data();
+            sourcePitch = rowBytes;
+        }
+        const D3D12_BOX box = { static_cast<UINT>(rect.left), static_cast<UINT>(rect.top), 0,
+            static_cast<UINT>(rect.right), static_cast<UINT>(rect.bottom), 1 };
+        slot.texture->WriteToSubresource(0, &box, source, static_cast<UINT>(sourcePitch),
+            static_cast<UINT>(sourcePitch * rowCount));
+        writtenBytes += rowBytes * rowCount;
+    }
+    slot.staleRects.clear();
+
+    // The other slots are now behind by this paint
+    for (UploadSlot& other : m_uploadRing) {
+        if (&other == &slot) continue;
+        for (const RECT& rect : slot.rects) {
+            MergeRect(other.staleRects, rect);
+        }
+    }
+    return writtenBytes;
+}
+
+BrowserView::UploadSlot* BrowserView::AcquireFreeUploadSlot() {
+    if (!m_renderSystem) return nullptr;
+
+    UINT64 completedFenceValue = m_renderSystem->GetCompletedFenceValue();
+    for (UINT i = 0; i < UPLOAD_RING_SIZE; ++i) {
+        UploadSlot& slot = m_uploadRing[(m_uploadRingIndex + i) % UPLOAD_RING_SIZE];
+        UploadSlotState expected = UploadSlotState::Free;
+        if (!slot.buffer || slot.state.load() != UploadSlotState::Free || slot.fenceValue > completedFenceValue) {
+            continue;
+        }
+        if (slot.state.compare_exchange_strong(expected, UploadSlotState::Writing)) {
+            m_uploadRingIndex = (m_uploadRingIndex + i + 1) % UPLOAD_RING_SIZE;
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+BrowserView::UploadSlot* BrowserView::TakePublishedUploadSlot() {
+    int index = m_publishedSlot.exchange(-1);
+    if (index < 0) return nullptr;
+
+    UploadSlot& slot = m_uploadRing[index];
+    slot.state = UploadSlotState::Reading;
+    return &slot;
+}
+
+void BrowserView::ReleaseUploadSlot(UploadSlot* slot, UINT64 fenceValue) {
+    if (!slot) return;
+    slot->fenceValue = fenceValue;
+    slot->state = UploadSlotState::Free; // Makes the fence value visible to the CEF thread
+}
+
+void BrowserView::ShowUploadSlot(UploadSlot* slot, UINT64 fenceValue) {
+    if (!slot || !slot->texture) return;
+    UploadSlot* previous = m_shownSlot;
+    m_shownSlot = slot;
+    m_browserTexture = slot->texture;
+    m_srvDescriptorIndex = slot->srvDescriptorIndex;
+    SetShownContentSize(slot->width, slot->height);
+    NoteShownPaint(slot->paintQpc);
+    // Frames up to this one may still sample the one it replaces
+    if (previous && previous != slot) {
+        ReleaseUploadSlot(previous, fenceValue);
+    }
+}
+
+// --- Upload Scheduling ---
+
+bool BrowserView::RecordScheduledUploads(ID3D12GraphicsCommandList* commandList) {
+    if (!m_browserTexture) return false;
+    ResourceManager* resourceManager = m_renderSystem->GetResourceManager();
+    ScheduledUpload& scheduled = m_scheduledUpload;
+    const UINT64 budget = m_uploadBudgetBytes;
+
+    // A paint in the back texture is shown once the copy queue is done with it; newer paints wait
+    // in the ring meanwhile, superseding each other
+    if (m_backSlot) {
+        if (m_renderSystem->GetCompletedCopyFenceValue() < m_backCopyFenceValue) return false;
+        // Frames in flight may still sample the old front; the next copy into it waits for them
+        std::swap(m_browserTexture, m_backTexture);
+        std::swap(m_srvDescriptorIndex, m_backSrvDescriptorIndex);
+        SetShownContentSize(m_backSlot->width, m_backSlot->height);
+        NoteShownPaint(m_backSlot->paintQpc);
+        ReleaseUploadSlot(m_backSlot, m_renderSystem->GetCurrentFenceValue());
+        m_backSlot = nullptr;
+        return true;
+    }
+
+    // Each frame either starts a scheduled upload (only the snapshot of the shown texture), copies
+    // its next tiles, or finishes it (the small paints' regions, then the swap), so no copy reads
+    // or writes what another copy of the same list writes
+    UploadSlot* direct = nullptr; // Straight into the shown texture
+    UploadSlot* scrolled = nullptr; // Moved and uploaded into the second texture, shown at once
+    UploadSlot* back = nullptr;     // Into the back texture, shown once the copy is done
+    bool resync = false;            // Front copied into the back texture whole
+    bool snapshot = false;
+    bool finish = false;
+    m_uploadBatch.clear();
+    if (!scheduled.slot) {
+        UploadSlot* slot = m_heldUploadSlot ? m_heldUploadSlot : TakePublishedUploadSlot();
+        m_heldUploadSlot = nullptr;
+        if (!slot) return false;
+        if (!slot->scrollMoves.empty()) {
+            if (!AcquireScheduledTexture()) {
+                // Its rects alone would leave the moved rows stale; CEF paints everything again
+                LOG_WARNING("No texture for a browser scroll, repainting it whole");
+                ReleaseUploadSlot(slot, m_renderSystem->GetCurrentFenceValue());
+                RequestFullUpload();
+                return false;
+            }
+            scrolled = slot;
+        }
+        else if (budget == 0 || slot->rectBytes <= budget || !BeginScheduledUpload(slot)) {
+            direct = slot;
+        }
+        else {
+            snapshot = true;
+        }
+
+        // With the copy queue it goes into the back texture instead, brought up to date first
+        // (a frame of its own) when another path swapped textures since
+        if (direct && m_renderSystem->HasCopyQueue() &&
+            (m_backTexture || AcquireDisplayTexture(m_backTexture, m_backSrvDescriptorIndex, L"Browser Back Texture"))) {
+            const RECT whole = { 0, 0, direct->width, direct->height };
+            if (m_backValid || (direct->rects.size() == 1 && EqualRect(&direct->rects[0], &whole))) {
+                back = direct;
+                m_backValid = true;
+            }
+            else {
+                resync = true;
+                m_heldUploadSlot = direct;
+            }
+            direct = nullptr;
+        }
+    }
+    else if (scheduled.nextTile < scheduled.tiles.size()) {
+        // A small paint skips the queue; a large one waits for this upload (newer paints then
+        // collect in the ring, superseding each other)
+        if (!m_heldUploadSlot) {
+            if (UploadSlot* slot = TakePublishedUploadSlot()) {
+                // Same size as what is shown: a render quality change repaints everything anyway
+                if (slot->scrollMoves.empty() && slot->rectBytes <= std::min(budget, SMALL_UPLOAD_BYTES) &&
+                    slot->width == m_shownContentWidth && slot->height == m_shownContentHeight &&
+                    scheduled.overrideRects.size() + slot->rects.size() <= MAX_OVERRIDE_RECTS) {
+                    direct = slot;
+                    scheduled.overrideRects.insert(scheduled.overrideRects.end(), slot->rects.begin(), slot->rects.end());
+                }
+                else {
+                    m_heldUploadSlot = slot;
+                }
+            }
+        }
+        UINT64 batchBytes = 0;
+        while (scheduled.nextTile < scheduled.tiles.size()) {
+            const RECT& tile = scheduled.tiles[scheduled.nextTile];
+            const UINT64 tileBytes = static_cast<UINT64>(tile.right - tile.left) * (tile.bottom - tile.top) * 4;
+            if (budget > 0 && batchBytes > 0 && batchBytes + tileBytes > budget) break;
+            m_uploadBatch.push_back(tile);
+            batchBytes += tileBytes;
+            scheduled.nextTile++;
+        }
+    }
+    else {
+        finish = true;
+    }
+
+    ID3D12GraphicsCommandList* copyList = m_renderSystem->BeginCopyCommands();
+    const bool directQueue = copyList == nullptr;
+    if (directQueue) {
+        // On the copy queue the COMMON textures are promoted implicitly
+        copyList = commandList;
+        m_renderSystem->BeginGpuPass(GpuPass::BrowserCopy);
+    }
+
+    ID3D12Resource* shown = m_browserTexture.Get();
+    if (direct) {
+        RecordSlotCopy(copyList, directQueue, *direct, direct->rects, shown);
+    }
+    if (snapshot) {
+        if (directQueue) {
+            resourceManager->TransitionResource(copyList, shown, D3D12_RESOURCE_STATE_COPY_SOURCE);
+            resourceManager->TransitionResource(copyList, scheduled.texture.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+        }
+        copyList->CopyResource(scheduled.texture.Get(), shown);
+    }
+    if (!m_uploadBatch.empty()) {
+        RecordSlotCopy(copyList, directQueue, *scheduled.slot, m_uploadBatch, scheduled.texture.Get());
+    }
+    if (scrolled) {
+        // Every row of the new frame is written once: moved or kept rows from the shown texture
+        // (a copy can't overlap its own source), the rest from the slot
+        if (directQueue) {
+            resourceManager->TransitionResource(copyList, shown, D3D12_RESOURCE_STATE_COPY_SOURCE);
+            resourceManager->TransitionResource(copyList, scheduled.texture.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+        }
+        D3D12_TEXTURE_COPY_LOCATION srcLocation = {};
+        srcLocation.pResource = shown;
+        srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        D3D12_TEXTURE_COPY_LOCATION dstLocation = {};
+        dstLocation.pResource = scheduled.texture.Get();
+        dstLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        for (const ScrollMove& move : scrolled->scrollMoves) {
+            const D3D12_BOX box = { 0, static_cast<UINT>(move.sourceTop), 0, static_cast<UINT>(scrolled->width),
+                static_cast<UINT>(move.sourceTop + move.bottom - move.top), 1 };
+            copyList->CopyTextureRegion(&dstLocation, 0, static_cast<UINT>(move.top), 0, &srcLocation, &box);
+        }
+        RecordSlotCopy(copyList, directQueue, *scrolled, scrolled->rects, scheduled.texture.Get());
+    }
+    if (resync) {
+        copyList->CopyResource(m_backTexture.Get(), shown);
+        m_backValid = true; // The queue runs it before the next copy into the back texture
+    }
+    if (back) {
+        // Both lists come from the same paint, so where they overlap they write the same pixels
+        RecordSlotCopy(copyList, false, *back, back->rects, m_backTexture.Get());
+        RecordSlotCopy(copyList, false, *back, back->catchUpRects, m_backTexture.Get());
+    }
+    if (finish && !scheduled.overrideRects.empty()) {
+        // The shown texture holds the small paints; the scheduled one is older there
+        if (directQueue) {
+            resourceManager->TransitionResource(copyList, shown, D3D12_RESOURCE_STATE_COPY_SOURCE);
+            resourceManager->TransitionResource(copyList, scheduled.texture.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+        }
+        D3D12_TEXTURE_COPY_LOCATION srcLocation = {};
+        srcLocation.pResource = shown;
+        srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        D3D12_TEXTURE_COPY_LOCATION dstLocation = {};
+        dstLocation.pResource = scheduled.texture.Get();
+        dstLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        for (const RECT& rect : scheduled.overrideRects) {
+            const D3D12_BOX box = { static_cast<UINT>(rect.left), static_cast<UINT>(rect.top), 0,
+                static_cast<UINT>(rect.right), static_cast<UINT>(rect.bottom), 1 };
+            copyList->CopyTextureRegion(&dstLocation, box.left, box.top, 0, &srcLocation, &box);
+        }
+    }
+
+    if (directQueue) {
+        // Split barriers, ended before ImGui samples them
+        resourceManager->BeginSplitTransition(shown, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        if (scheduled.texture) {
+            resourceManager->BeginSplitTransition(scheduled.texture.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        }
+        resourceManager->FlushBarriers(commandList);
+        m_renderSystem->EndGpuPass(GpuPass::BrowserCopy);
+    }
+    else {
+        // This frame's direct submission waits for it on the GPU, unless it only wrote the back
+        // texture the frame doesn't sample
+        m_renderSystem->SubmitCopyCommands(!back && !resync);
+        if (back) {
+            m_backSlot = back;
+            m_backCopyFenceValue = m_renderSystem->GetLastCopyFenceValue();
+        }
+    }
+
+    // The direct queue waits for the copy, so this frame's fence covers both paths
+    const UINT64 fenceValue = m_renderSystem->GetCurrentFenceValue();
+    if (direct) {
+        SetShownContentSize(direct->width, direct->height);
+        NoteShownPaint(direct->paintQpc);
+        ReleaseUploadSlot(direct, fenceValue);
+    }
+    if (finish || scrolled) {
+        UploadSlot* slot = scrolled ? scrolled : scheduled.slot;
+        SetShownContentSize(slot->width, slot->height);
+        NoteShownPaint(slot->paintQpc);
+        // Shown from this frame on; frames in flight may still sample the texture it replaces
+        std::swap(m_browserTexture, scheduled.texture);
+        std::swap(m_srvDescriptorIndex, scheduled.srvDescriptorIndex);
+        ReleaseUploadSlot(slot, fenceValue);
+        scheduled.slot = nullptr;
+        ReleaseScheduledUpload();
+        m_backValid = false; // Behind the new front by more than a paint
+    }
+    return direct != nullptr || finish || scrolled != nullptr;
+}
+
+bool BrowserView::BeginScheduledUpload(UploadSlot* slot) {
+    if (!AcquireScheduledTexture()) {
+        LOG_WARNING("No texture for a scheduled browser upload, copying it at once");
+        return false;
+    }
+
+    // Tiles in rows, the visible ones first
+    ScheduledUpload& scheduled = m_scheduledUpload;
+    constexpr LONG TILE = UPLOAD_TILE_SIZE;
+    scheduled.tiles.clear();
+    for (const RECT& rect : slot->rects) {
+        for (LONG top = rect.top / TILE * TILE; top < rect.bottom; top += TILE) {
+            for (LONG left = rect.left / TILE * TILE; left < rect.right; left += TILE) {
+                const RECT tileBounds = { left, top, left + TILE, top + TILE };
+                RECT tile;
+                if (IntersectRect(&tile, &tileBounds, &rect)) {
+                    scheduled.tiles.push_back(tile);
+                }
+            }
+        }
+    }
+    const RECT visible = m_visibleRegion;
+    std::stable_partition(scheduled.tiles.begin(), scheduled.tiles.end(), [&visible](const RECT& tile) {
+        RECT overlap;
+        return IntersectRect(&overlap, &tile, &visible) != FALSE;
+    });
+    scheduled.nextTile = 0;
+    scheduled.overrideRects.clear();
+    scheduled.slot = slot;
+    return true;
+}
+
+bool BrowserView::AcquireScheduledTexture() {
+    ScheduledUpload& scheduled = m_scheduledUpload;
+    if (!AcquireDisplayTexture(scheduled.texture, scheduled.srvDescriptorIndex, L"Browser Scheduled Texture")) {
+        ReleaseScheduledUpload();
+        return false;
+    }
+    return true;
+}
+
+bool BrowserView::AcquireDisplayTexture(ComPtr<ID3D12Resource>& texture, UINT& srvDescriptorIndex, const wchar_t* name) {
+    ResourceManager* resourceManager = m_renderSystem->GetResourceManager();
+
+    // Same texture as the shown one, so the pool hands them back and forth
+    const D3D12_RESOURCE_DESC desc = m_browserTexture->GetDesc();
+    const D3D12_RESOURCE_STATES initialState = m_renderSystem->HasCopyQueue() ?
+        D3D12_RESOURCE_STATE_COMMON : D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    texture = resourceManager->AcquireTexture2D(static_cast<UINT>(desc.Width), desc.Height,
+        desc.Format, desc.Flags, D3D12_HEAP_TYPE_DEFAULT, initialState);
+    srvDescriptorIndex = resourceManager->AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    if (!texture || srvDescriptorIndex == UINT_MAX) return false;
+    texture->SetName(name); // Debug name
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = desc.Format;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Texture2D.MipLevels = 1;
+    m_renderSystem->GetDevice()->CreateShaderResourceView(texture.Get(), &srvDesc,
+        resourceManager->GetCpuDescriptorHandle(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, srvDescriptorIndex));
+    return true;
+}
+
+void BrowserView::RetireDisplayTexture(ComPtr<ID3D12Resource>& texture, UINT& srvDescriptorIndex) {
+    ResourceManager* resourceManager = m_renderSystem ? m_renderSystem->GetResourceManager() : nullptr;
+    if (resourceManager) {
+        std::function<void()> freeDescriptor;
+        if (srvDescriptorIndex != UINT_MAX) {
+            const UINT index = srvDescriptorIndex;
+            freeDescriptor = [resourceManager, index]() {
+                resourceManager->FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, index);
+            };
+        }
+        if (texture) {
+            const D3D12_RESOURCE_STATES textureState = m_renderSystem->HasCopyQueue() ?
+                D3D12_RESOURCE_STATE_COMMON : D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+            resourceManager->RecycleTexture(std::move(texture), textureState);
+        }
+        resourceManager->RetireResource(nullptr, std::move(freeDescriptor));
+    }
+    texture.Reset();
+    srvDescriptorIndex = UINT_MAX;
+}
+
+void BrowserView::ReleaseScheduledUpload() {
+    ScheduledUpload& scheduled = m_scheduledUpload;
+    RetireDisplayTexture(scheduled.texture, scheduled.srvDescriptorIndex);
+    scheduled.tiles.clear();
+    scheduled.nextTile = 0;
+    scheduled.overrideRects.clear();
+}
+
+void BrowserView::RecordSlotCopy(ID3D12GraphicsCommandList* copyList, bool directQueue, const UploadSlot& slot,
+    const std::vector<RECT>& rects, ID3D12Resource* target) {
+    // The texture may have been recreated smaller since the slot was written
+    D3D12_RESOURCE_DESC textureDesc = target->GetDesc();
+    if (static_cast<UINT64>(slot.width) > textureDesc.Width || static_cast<UINT>(slot.height) > textureDesc.Height) {
+        LOG_ERROR("Upload slot larger than the browser texture");
+        RequestFullUpload();
+        return;
+    }
+    if (directQueue) {
+        m_renderSystem->GetResourceManager()->TransitionResource(copyList, target, D3D12_RESOURCE_STATE_COPY_DEST);
+    }
+
+    D3D12_TEXTURE_COPY_LOCATION srcLocation = {};
+    srcLocation.pResource = slot.buffer.Get();
+    srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    srcLocation.PlacedFootprint.Offset = 0;
+    srcLocation.PlacedFootprint.Footprint.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    srcLocation.PlacedFootprint.Footprint.Width = slot.width;
+    srcLocation.PlacedFootprint.Footprint.Height = slot.height;
+    srcLocation.PlacedFootprint.Footprint.Depth = 1;
+    srcLocation.PlacedFootprint.Footprint.RowPitch = slot.rowPitch; // Aligned pitch
+
+    D3D12_TEXTURE_COPY_LOCATION dstLocation = {};
+    dstLocation.pResource = target;
+    dstLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    dstLocation.SubresourceIndex = 0;
+
+    for (const RECT& rect : rects) {
+        D3D12_BOX srcBox = {};
+        srcBox.left = static_cast<UINT>(rect.left);
+        srcBox.top = static_cast<UINT>(rect.top);
+        srcBox.right = static_cast<UINT>(rect.right);
+        srcBox.bottom = static_cast<UINT>(rect.bottom);
+        srcBox.back = 1;
+        copyList->CopyTextureRegion(&dstLocation, srcBox.left, srcBox.top, 0, &srcLocation, &srcBox);
+    }
+}
+
+BrowserUploadPath BrowserView::GetUploadPath() const {
+    if (!m_paintReplay && !m_externalPaints && m_browserManager && m_browserManager->IsSharedTextureEnabled()) {
+        return BrowserUploadPath::SharedTexture;
+    }
+    return m_uploadPath;
+}
+
+bool BrowserView::RecordFrameConversion(ID3D12GraphicsCommandList* commandList, const UploadSlot* slot) {
+    if (!slot || slot->rects.empty() || !m_browserTexture || !m_gpuConversionActive) return false;
+
+    // One dispatch per dirty rect, each widened to whole tiles for its mips; the space between
+    // disjoint rects (stale in the slot) isn't converted
+    UINT flags = (m_premultiplyAlpha ? TextureConvertPremultiply : 0) |
+        (m_linearMipFiltering ? TextureConvertLinearMips : 0);
+    if (!m_textureConverter->ConvertBuffer(commandList, slot->buffer.Get(), slot->rowPitch, slot->rects,
+        m_browserTexture.Get(), flags)) return false;
+    SetShownContentSize(slot->width, slot->height);
+    NoteShownPaint(slot->paintQpc);
+    return true;
+}
+
+bool BrowserView::RecordFrameConversion(ID3D12GraphicsCommandList* commandList, ID3D12Resource* sharedTexture) {
+    if (!sharedTexture || !m_browserTexture || !m_gpuConversionActive) return false;
+
+    // CEF's texture follows the browser size, below the logical size at lower render qualities
+    const D3D12_RESOURCE_DESC sharedDesc = sharedTexture->GetDesc();
+    RECT bounds = { 0, 0, std::min(m_width, static_cast<int>(sharedDesc.Width)), std::min(m_height, static_cast<int>(sharedDesc.Height)) };
+    UINT flags = (m_premultiplyAlpha ? TextureConvertPremultiply : 0) |
+        (m_linearMipFiltering ? TextureConvertLinearMips : 0);
+    if (!m_textureConverter->ConvertTexture(commandList, sharedTexture, bounds, m_browserTexture.Get(), flags)) return false;
+    SetShownContentSize(bounds.right, bounds.bottom);
+    return true;
+}
+
+void BrowserView::ReleaseSharedTexture() {
+    m_sharedTexture.Reset();
+}
+
+void BrowserView::ConsumeSharedTexture() {
+    if (!m_sharedTexture) return;
+    NoteShownPaint(m_sharedTexturePaintQpc);
+    MarkPaintCopyRead(m_paintCopies, m_sharedTexture.Get(), m_renderSystem->GetCurrentFenceValue());
+    ReleaseSharedTexture();
+}
+
+void BrowserView::GetContentExtent(float& u, float& v) const {
+    u = 1.0f;
+    v = 1.0f;
+    if (!m_browserTexture || m_shownContentWidth <= 0 || m_shownContentHeight <= 0) return;
+    const D3D12_RESOURCE_DESC desc = m_browserTexture->GetDesc();
+    u = std::min(static_cast<float>(m_shownContentWidth) / static_cast<float>(desc.Width), 1.0f);
+    v = std::min(static_cast<float>(m_shownContentHeight) / static_cast<float>(desc.Height), 1.0f);
+}
+
+void BrowserView::SetShownContentSize(int width, int height) {
+    m_shownContentWidth = width;
+    m_shownContentHeight = height;
+    m_textureTabId = m_browserManager ? m_browserManager->GetActiveTabId() : 0;
+}
+
+bool BrowserView::RecordFullscreenCopy(bool maximized) {
+    m_fullscreenCopied = false;
+    if (!maximized) return false;
+    // GPU upload textures keep their own states; a tab just switched to shows its thumbnail
+    D3D12_GPU_DESCRIPTOR_HANDLE placeholder = {};
+    if (!m_browserTexture || UsesGpuUploadTextures() || GetSwitchPlaceholder(placeholder)) return false;
+    if (m_shownContentWidth != m_renderSystem->GetWidth() || m_shownContentHeight != m_renderSystem->GetHeight()) {
+        return false; // Not 1:1: lower render quality, or the resize hasn't painted yet
+    }
+    m_renderSystem->GetResourceManager()->NotifyResourceUsed(m_browserTexture.Get());
+    m_fullscreenCopied = m_renderSystem->CopyToSceneTarget(m_browserTexture.Get());
+    return m_fullscreenCopied;
+}
+
+bool BrowserView::RecordTabThumbnailCapture(ID3D12GraphicsCommandList* commandList) {
+    if (!m_tabThumbnails || !m_tabThumbnails->HasPendingCapture()) return false;
+    // GPU upload textures live in the upload heap and keep their own states; those tabs get none
+    if (!m_browserTexture || UsesGpuUploadTextures() || m_shownContentWidth <= 0) {
+        m_tabThumbnails->RequestCapture(0);
+        return false;
+    }
+    float contentU = 1.0f, contentV = 1.0f;
+    GetContentExtent(contentU, contentV);
+    m_renderSystem->GetResourceManager()->NotifyResourceUsed(m_browserTexture.Get());
+    m_tabThumbnails->RecordCapture(commandList, m_browserTexture.Get(), contentU, contentV);
+    return true;
+}
+
+bool BrowserView::GetTabThumbnail(int tabId, D3D12_GPU_DESCRIPTOR_HANDLE& texture, UINT& width, UINT& height) const {
+    return m_tabThumbnails && m_tabThumbnails->GetThumbnail(tabId, texture, width, height);
+}
+
+bool BrowserView::IsAwaitingFirstPaint() const {
+    const int activeTabId = m_browserManager ? m_browserManager->GetActiveTabId() : 0;
+    return m_shownContentWidth <= 0 || (activeTabId != 0 && activeTabId != m_textureTabId);
+}
+
+bool BrowserView::GetSwitchPlaceholder(D3D12_GPU_DESCRIPTOR_HANDLE& texture) const {
+    const int activeTabId = m_browserManager ? m_browserManager->GetActiveTabId() : 0;
+    if (activeTabId == 0 || activeTabId == m_textureTabId) return false;
+    UINT width = 0, height = 0;
+    return GetTabThumbnail(activeTabId, texture, width, height);
+}
+
+void BrowserView::ForgetTabThumbnail(int tabId) {
+    if (m_tabThumbnails) m_tabThumbnails->Forget(tabId);
+}
+
 D3D12_GPU_DESCRIPTOR_HANDLE BrowserView::GetTextureGpuHandle() const {
     if (m_renderSystem && m_renderSystem->GetResourceManager() && m_srvDescriptorIndex != UINT_MAX) {
+        // Sampled this frame: keeps it off the eviction list (and pages it back in if it was evicted)
+        m_renderSystem->GetResourceManager()->NotifyResourceUsed(m_browserTexture.Get());
         // Ensure the descriptor index is valid before getting the handle
         return m_renderSystem->GetResourceManager()->GetGpuDescriptorHandle(
             D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, m_srvDescriptorIndex
@@ -180,31 +1507,104 @@ void BrowserView::CreateBrowserTextureResources(int width, int height) {
     // Ensure previous resources are released (important if called during resize)
     ReleaseBrowserTextureResources();
 
+    const bool gpuConversion = m_gpuConversionPreferred && m_textureConverter->IsAvailable();
+
+    // With the GPU upload heap, CEF's paints go straight into textures in VRAM the overlay samples:
+    // no upload buffer and no copy, one texture per slot
+    const bool sharedTextures = !m_paintReplay && !m_externalPaints && m_browserManager &&
+        m_browserManager->IsSharedTextureEnabled();
+    if (!gpuConversion && !sharedTextures && m_renderSystem->SupportsGpuUploadHeap() &&
+        CreateGpuUploadTextures(width, height)) {
+        m_gpuConversionActive = false;
+        m_uploadPath = BrowserUploadPath::GpuUploadTexture;
+        UploadSlot& shown = m_uploadRing[0];
+        shown.state = UploadSlotState::Reading; // Sampled until a newer paint is shown
+        shown.claimed = false;
+        m_shownSlot = &shown;
+        m_browserTexture = shown.texture;
+        m_srvDescriptorIndex = shown.srvDescriptorIndex;
+        for (UINT i = 1; i < UPLOAD_RING_SIZE; i++) {
+            m_uploadRing[i].claimed = false;
+            m_uploadRing[i].state = UploadSlotState::Free; // Publishes the slot to the paint thread
+        }
+        m_publishedSlot = -1;
+        m_textureResourcesReleased = false;
+        return;
+    }
+
     // 1. Create the target texture in the default heap (GPU optimal)
-    m_browserTexture = resourceManager->CreateTexture2D(
+    // The compute path writes it on the direct queue, with every mip level
+    const DXGI_FORMAT textureFormat = gpuConversion ?
+        TextureConverter::TARGET_FORMAT : DXGI_FORMAT_B8G8R8A8_UNORM; // Format CEF typically provides (BGRA)
+    const UINT16 mipLevels = gpuConversion ? TextureConverter::GetMipCount(width, height) : 1;
+    // Copy-queue uploads need COMMON; it promotes to COPY_DEST / PIXEL_SHADER_RESOURCE and decays back
+    D3D12_RESOURCE_STATES initialState = m_renderSystem->HasCopyQueue() && !gpuConversion ?
+        D3D12_RESOURCE_STATE_COMMON : D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    // Sizes recur (resizes back and forth, quality steps, tab switches), so textures are pooled
+    m_browserTexture = resourceManager->AcquireTexture2D(
         width, height,
-        DXGI_FORMAT_B8G8R8A8_UNORM, // Format CEF typically provides (BGRA)
-        D3D12_RESOURCE_FLAG_NONE,
+        textureFormat,
+        gpuConversion ? TextureConverter::TARGET_FLAGS : D3D12_RESOURCE_FLAG_NONE,
         D3D12_HEAP_TYPE_DEFAULT,
-        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE // Initial state for rendering
+        initialState,
+        nullptr,
+        mipLevels
     );
 
     if (!m_browserTexture) {
         throw std::runtime_error("Failed to create browser target texture (GPU)");
     }
     m_browserTexture->SetName(L"Browser Target Texture"); // Debug name
+    m_gpuConversionActive = gpuConversion; // Before the slots are handed to the paint thread
 
-    // 2. Create the upload heap texture for CPU writes
+    // 2. Create the upload ring for CPU writes, mapped once for the buffers' lifetime
     // Calculate required size based on pitch alignment
     // BGRA is 4 bytes per pixel
     size_t rowPitch = (static_cast<size_t>(width) * 4 + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) & ~(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1);
     size_t uploadBufferSize = rowPitch * height;
 
-    m_uploadTexture = resourceManager->CreateUploadBuffer(uploadBufferSize);
-    if (!m_uploadTexture) {
-        throw std::runtime_error("Failed to create browser upload texture (CPU)");
+    // The GPU upload heap keeps them in VRAM, so the copy (or the conversion) reads locally
+    BrowserUploadPath uploadPath = BrowserUploadPath::UploadRing;
+#if GAMEOVERLAY_GPU_UPLOAD_HEAP
+    if (m_renderSystem->SupportsGpuUploadHeap()) {
+        uploadPath = BrowserUploadPath::GpuUploadBuffer;
+    }
+#endif
+    D3D12_RANGE readRange = { 0, 0 }; // We are writing, not reading
+    for (UploadSlot& slot : m_uploadRing) {
+#if GAMEOVERLAY_GPU_UPLOAD_HEAP
+        if (uploadPath == BrowserUploadPath::GpuUploadBuffer) {
+            slot.buffer = resourceManager->CreateBuffer(uploadBufferSize, D3D12_RESOURCE_FLAG_NONE,
+                D3D12_HEAP_TYPE_GPU_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ);
+            if (slot.buffer) {
+                resourceManager->PinResource(slot.buffer.Get(), true); // Mapped for good; never evicted
+            }
+            else {
+                LOG_WARNING("Failed to create browser GPU upload buffer, using the upload heap");
+                uploadPath = BrowserUploadPath::UploadRing;
+            }
+        }
+#endif
+        if (!slot.buffer) {
+            slot.buffer = resourceManager->CreateUploadBuffer(uploadBufferSize);
+        }
+        if (!slot.buffer) {
+            throw std::runtime_error("Failed to create browser upload buffer (CPU)");
+        }
+        slot.buffer->SetName(L"Browser Upload Buffer"); // Debug name
+
+        void* mappedData = nullptr;
+        if (FAILED(slot.buffer->Map(0, &readRange, &mappedData))) {
+            throw std::runtime_error("Failed to map browser upload buffer");
+        }
+        slot.mappedData = static_cast<uint8_t*>(mappedData);
+        slot.size = uploadBufferSize;
+        slot.fenceValue = 0;
+        slot.claimed = false;
+        slot.state = UploadSlotState::Free; // Publishes the slot to the paint thread
     }
-    m_uploadTexture->SetName(L"Browser Upload Texture"); // Debug name
+    m_uploadPath = uploadPath; // Reported only; one fallback may leave the ring mixed
+    m_publishedSlot = -1;
 
     // 3. Create Shader Resource View (SRV) for the target texture
     m_srvDescriptorIndex = resourceManager->AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
@@ -213,10 +1613,10 @@ void BrowserView::CreateBrowserTextureResources(int width, int height) {
     }
 
     D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-    srvDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM; // Match texture format
+    srvDesc.Format = textureFormat; // Match texture format
     srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
     srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-    srvDesc.Texture2D.MipLevels = 1;
+    srvDesc.Texture2D.MipLevels = mipLevels;
     srvDesc.Texture2D.MostDetailedMip = 0;
     srvDesc.Texture2D.PlaneSlice = 0;
     srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
@@ -229,50 +1629,241 @@ void BrowserView::CreateBrowserTextureResources(int width, int height) {
     }
 
     device->CreateShaderResourceView(m_browserTexture.Get(), &srvDesc, srvHandle);
+    m_textureResourcesReleased = false;
 
-    // No initial transition needed here if CreateTexture2D creates it in PIXEL_SHADER_RESOURCE state
+    // No initial transition needed; both initial states are usable for sampling
 }
 
 void BrowserView::ReleaseBrowserTextureResources() {
     ResourceManager* resourceManager = m_renderSystem ? m_renderSystem->GetResourceManager() : nullptr;
 
-    // Free the descriptor if allocated
-    if (resourceManager && m_srvDescriptorIndex != UINT_MAX) {
-        resourceManager->FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, m_srvDescriptorIndex);
-        m_srvDescriptorIndex = UINT_MAX;
+    // Claim every slot so a paint on CEF's UI thread can't write into one being released;
+    // a slot it is currently filling is waited for (one copy at most)
+    m_publishedSlot = -1;
+    for (UploadSlot& slot : m_uploadRing) {
+        if (slot.claimed) continue; // Already released without a create since; waiting would spin forever
+        UploadSlotState state = slot.state.load();
+        while (state == UploadSlotState::Writing ||
+               !slot.state.compare_exchange_weak(state, UploadSlotState::Writing)) {
+            if (state == UploadSlotState::Writing) {
+                std::this_thread::yield();
+                state = slot.state.load();
+            }
+        }
+        slot.claimed = true;
+    }
+
+    // A scheduled upload is dropped; the full upload below replaces it
+    ReleaseScheduledUpload();
+    m_scheduledUpload.slot = nullptr;
+    m_heldUploadSlot = nullptr;
+    RetireDisplayTexture(m_backTexture, m_backSrvDescriptorIndex);
+    m_backValid = false;
+    m_backSlot = nullptr;
+
+    if (resourceManager && m_uploadPath == BrowserUploadPath::GpuUploadTexture) {
+        // The slots are the textures; each one's SRV goes with it
+        ReleaseGpuUploadTextures();
+        m_browserTexture.Reset();
+    }
+    else if (resourceManager) {
+        // The GPU may still sample the texture, read the upload buffer or use the SRV, so the
+        // descriptor is freed only when the texture is actually released
+        UINT srvDescriptorIndex = m_srvDescriptorIndex;
+        std::function<void()> freeDescriptor;
+        if (srvDescriptorIndex != UINT_MAX) {
+            freeDescriptor = [resourceManager, srvDescriptorIndex]() {
+                resourceManager->FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, srvDescriptorIndex);
+            };
+        }
+        // Copy-queue uploads leave it decayed to COMMON; direct uploads and conversions transition
+        // back for sampling
+        D3D12_RESOURCE_STATES textureState = m_renderSystem->HasCopyQueue() && !m_gpuConversionActive ?
+            D3D12_RESOURCE_STATE_COMMON : D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+        resourceManager->RecycleTexture(std::move(m_browserTexture), textureState);
+        resourceManager->RetireResource(nullptr, std::move(freeDescriptor));
+        // Upload buffers stay mapped; releasing them unmaps
+        for (UploadSlot& slot : m_uploadRing) {
+            if (!slot.buffer) continue;
+            resourceManager->ReleaseResource(slot.buffer.Get()); // GPU upload buffers are tracked and pinned
+            resourceManager->RetireResource(std::move(slot.buffer));
+        }
+    }
+    m_srvDescriptorIndex = UINT_MAX;
+    m_shownSlot = nullptr;
+    m_shownContentWidth = 0;
+    m_shownContentHeight = 0;
+    m_textureTabId = 0;
+    m_uploadPath = BrowserUploadPath::UploadRing;
+    {
+        std::lock_guard<ProfiledMutex> lock(m_bufferMutex);
+        ReleaseSharedTexture();
+        RetirePaintCopies(m_paintCopies);
     }
 
     // Release the texture resources (ComPtr handles this)
     m_browserTexture.Reset();
-    m_uploadTexture.Reset();
+    for (UploadSlot& slot : m_uploadRing) {
+        slot.buffer.Reset();
+        slot.mappedData = nullptr;
+        slot.size = 0;
+        slot.fenceValue = 0;
+        slot.rects.clear();
+        slot.catchUpRects.clear();
+        slot.staleRects.clear();
+        // Stays claimed until CreateBrowserTextureResources hands out new buffers
+    }
 
-    // Reset update state
+    // Reset update state; pending dirty rects belong to the paint thread and are replaced by
+    // the full upload
     m_textureNeedsGPUCopy = false;
-    m_cpuBufferData = nullptr;
-    m_cpuBufferWidth = 0;
-    m_cpuBufferHeight = 0;
+    m_fullUploadPending = true; // The next texture starts without content
+}
+
+bool BrowserView::CreateGpuUploadTextures(int width, int height) {
+#if GAMEOVERLAY_GPU_UPLOAD_HEAP
+    ID3D12Device* device = m_renderSystem->GetDevice();
+    ResourceManager* resourceManager = m_renderSystem->GetResourceManager();
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Texture2D.MipLevels = 1;
+
+    const size_t rowPitch = (static_cast<size_t>(width) * 4 + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) & ~(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1);
+    for (UploadSlot& slot : m_uploadRing) {
+        slot.texture = resourceManager->CreateTexture2D(
+            width, height, DXGI_FORMAT_B8G8R8A8_UNORM, D3D12_RESOURCE_FLAG_NONE,
+            D3D12_HEAP_TYPE_GPU_UPLOAD, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        // WriteToSubresource needs the texture mapped (no pointer for unknown layouts)
+        if (!slot.texture || FAILED(slot.texture->Map(0, nullptr, nullptr))) {
+            LOG_WARNING("Failed to create browser GPU upload texture, using the upload heap");
+            ReleaseGpuUploadTextures();
+            return false;
+        }
+        slot.texture->SetName(L"Browser Upload Texture"); // Debug name
+        resourceManager->PinResource(slot.texture.Get(), true); // Mapped for good; never evicted
+
+        slot.srvDescriptorIndex = resourceManager->AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        if (slot.srvDescriptorIndex == UINT_MAX) {
+            LOG_WARNING("Failed to allocate descriptor for browser GPU upload texture, using the upload heap");
+            ReleaseGpuUploadTextures();
+            return false;
+        }
+        device->CreateShaderResourceView(slot.texture.Get(), &srvDesc,
+            resourceManager->GetCpuDescriptorHandle(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, slot.srvDescriptorIndex));
+
+        slot.size = rowPitch * height; // What the paint size check expects
+        slot.fenceValue = 0;
+        slot.staleRects.assign(1, RECT{ 0, 0, width, height }); // Starts without content
+    }
+    return true;
+#else
+    (void)width;
+    (void)height;
+    return false;
+#endif
+}
+
+void BrowserView::ReleaseGpuUploadTextures() {
+    ResourceManager* resourceManager = m_renderSystem->GetResourceManager();
+    for (UploadSlot& slot : m_uploadRing) {
+        // Frames in flight may still sample a slot; its SRV is freed with it
+        UINT srvDescriptorIndex = slot.srvDescriptorIndex;
+        std::function<void()> freeDescriptor;
+        if (srvDescriptorIndex != UINT_MAX) {
+            freeDescriptor = [resourceManager, srvDescriptorIndex]() {
+                resourceManager->FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, srvDescriptorIndex);
+            };
+        }
+        if (slot.texture) {
+            resourceManager->ReleaseResource(slot.texture.Get());
+        }
+        resourceManager->RetireResource(std::move(slot.texture), std::move(freeDescriptor));
+        slot.texture.Reset();
+        slot.srvDescriptorIndex = UINT_MAX;
+        slot.staleRects.clear();
+    }
+}
+
+bool BrowserView::ReleaseSuspendedResources() {
+    if (!m_processingIsSuspended || !m_browserStarted || m_textureResourcesReleased) return false;
+
+    // Recycled into the texture pool and retired; the caller trims the pool afterwards
+    ReleaseBrowserTextureResources();
+    ReleasePopupResources();
+    m_textureResourcesReleased = true;
+    return true;
 }
 
 // --- Performance Optimization Methods ---
 
+bool BrowserView::SendBeginFrameIfDue(std::chrono::microseconds interval) {
+    if (m_processingIsSuspended || !m_browserManager || !m_browserManager->IsExternalBeginFrameEnabled()) {
+        return false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_lastBeginFrameTime < GetBeginFrameInterval(interval)) {
+        return false;
+    }
+
+    m_lastBeginFrameTime = now;
+    m_browserManager->SendExternalBeginFrame();
+    return true;
+}
+
+DWORD BrowserView::GetBeginFrameTimeoutMs(std::chrono::microseconds interval) const {
+    if (m_paintReplay && !m_processingIsSuspended) {
+        return m_paintReplay->GetNextPaintTimeoutMs();
+    }
+    if (m_processingIsSuspended || !m_browserManager || !m_browserManager->IsExternalBeginFrameEnabled()) {
+        return INFINITE;
+    }
+
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        m_lastBeginFrameTime + GetBeginFrameInterval(interval) - std::chrono::steady_clock::now());
+    return remaining.count() > 0 ? static_cast<DWORD>(remaining.count()) : 0;
+}
+
+std::chrono::microseconds BrowserView::GetBeginFrameInterval(std::chrono::microseconds renderInterval) const {
+    int paintFrameRate = m_paintFrameRate;
+    if (paintFrameRate <= 0) return renderInterval;
+    return std::max(renderInterval, std::chrono::microseconds(1000000 / paintFrameRate));
+}
+
+void BrowserView::SetWindowHidden(bool hidden) {
+    if (hidden == m_windowHidden || !m_browserManager || !m_browserManager->GetBrowser() ||
+        !m_browserManager->GetBrowser()->GetHost()) {
+        return;
+    }
+    m_windowHidden = hidden;
+    m_browserManager->GetBrowser()->GetHost()->WasHidden(hidden);
+    m_browserManager->SetPagesFrozen(hidden); // Hidden pages would still run timers and media
+}
+
 void BrowserView::AdaptToPerformanceState(PerformanceState state, ResourceUsageLevel level) {
     // Adjust browser parameters based on performance state
     float targetQuality = 1.0f;
-    int targetUpdateFreq = 1;
+    int targetPaintRate = 0; // Uncapped
     bool targetSuspend = false;
 
+    // Lower cap wins; 0 means uncapped
+    auto capPaintRate = [](int rate, int cap) { return rate == 0 ? cap : std::min(rate, cap); };
+
     switch (state) {
     case PerformanceState::Active:
-        targetQuality = 1.0f; targetUpdateFreq = 1; targetSuspend = false;
+        targetQuality = 1.0f; targetPaintRate = 0; targetSuspend = false;
         break;
     case PerformanceState::Inactive:
-        targetQuality = 0.75f; targetUpdateFreq = 3; targetSuspend = false; // Less frequent updates
+        targetQuality = 0.75f; targetPaintRate = 20; targetSuspend = false; // Less frequent paints
         break;
     case PerformanceState::Background:
-        targetQuality = 0.5f; targetUpdateFreq = 10; targetSuspend = true; // Suspend if configured
+        targetQuality = 0.5f; targetPaintRate = 6; targetSuspend = true; // Suspend if configured
         break;
     case PerformanceState::LowPower:
-        targetQuality = 0.25f; targetUpdateFreq = 15; targetSuspend = true;
+        targetQuality = 0.25f; targetPaintRate = 4; targetSuspend = true;
         break;
     }
 
@@ -280,12 +1871,12 @@ void BrowserView::AdaptToPerformanceState(PerformanceState state, ResourceUsageL
     switch (level) {
     case ResourceUsageLevel::Minimum:
         targetQuality = std::min(targetQuality, 0.25f);
-        targetUpdateFreq = std::max(targetUpdateFreq, 15);
+        targetPaintRate = capPaintRate(targetPaintRate, 4);
         if (state != PerformanceState::Active) targetSuspend = true;
         break;
     case ResourceUsageLevel::Low:
         targetQuality = std::min(targetQuality, 0.5f);
-        targetUpdateFreq = std::max(targetUpdateFreq, 10);
+        targetPaintRate = capPaintRate(targetPaintRate, 6);
         if (state == PerformanceState::Background || state == PerformanceState::LowPower) targetSuspend = true;
         break;
     case ResourceUsageLevel::Balanced:
@@ -296,7 +1887,7 @@ void BrowserView::AdaptToPerformanceState(PerformanceState state, ResourceUsageL
         // Maximum quality if active, less aggressive otherwise
         if (state == PerformanceState::Active) {
             targetQuality = 1.0f;
-            targetUpdateFreq = 1;
+            targetPaintRate = 0;
             targetSuspend = false;
         }
         else {
@@ -307,14 +1898,13 @@ void BrowserView::AdaptToPerformanceState(PerformanceState state, ResourceUsageL
 
     // Apply the calculated settings
     SetRenderQuality(targetQuality);
-    SetUpdateFrequency(targetUpdateFreq);
+    SetPaintFrameRate(targetPaintRate);
     SuspendProcessing(targetSuspend);
 
-    // Optional: Tell CEF about visibility/focus changes for its own optimizations
+    // Optional: Tell CEF about focus changes for its own optimizations; visibility follows the
+    // window (SetWindowHidden), since LowPower still shows the page
     if (m_browserManager && m_browserManager->GetBrowser() && m_browserManager->GetBrowser()->GetHost()) {
-        bool isVisible = (state != PerformanceState::Background && state != PerformanceState::LowPower);
         bool hasFocus = (state == PerformanceState::Active); // Assuming active means focused
-        m_browserManager->GetBrowser()->GetHost()->WasHidden(!isVisible);
         m_browserManager->GetBrowser()->GetHost()->SetFocus(hasFocus);
 
         // Optional: Send occlusion notification
@@ -326,24 +1916,58 @@ void BrowserView::AdaptToPerformanceState(PerformanceState state, ResourceUsageL
 }
 
 void BrowserView::SetRenderQuality(float quality) {
-    quality = std::max(0.1f, std::min(quality, 1.0f)); // Allow lower minimum quality
+    m_requestedRenderQuality = std::max(0.1f, std::min(quality, 1.0f)); // Allow lower minimum quality
+    ApplyRenderQuality();
+}
+
+void BrowserView::SetRenderQualityLimit(float limit) {
+    m_renderQualityLimit = std::max(0.1f, std::min(limit, 1.0f));
+    ApplyRenderQuality();
+}
+
+void BrowserView::ApplyRenderQuality() {
+    float quality = std::min(m_requestedRenderQuality, m_renderQualityLimit);
 
     if (m_renderQuality != quality) {
         m_renderQuality = quality;
-        // Trigger a resize to apply the new internal browser dimensions
+        // Only the browser's size changes: the texture stays at the logical size and the UI samples
+        // the painted part (GetContentExtent), so nothing is recreated or waited for
         Resize(m_width, m_height);
     }
 }
 
-void BrowserView::SetUpdateFrequency(int framesPerUpdate) {
-    framesPerUpdate = std::max(1, std::min(framesPerUpdate, 60)); // Clamp to reasonable range
+void BrowserView::SetPaintFrameRate(int fps) {
+    m_requestedPaintFrameRate = std::max(0, std::min(fps, 1000)); // Clamp to reasonable range
+    UpdatePaintFrameRate();
+}
 
-    if (m_framesPerUpdate != framesPerUpdate) {
-        m_framesPerUpdate = framesPerUpdate;
-        m_frameCounter = 0; // Reset counter
+void BrowserView::SetPaintFrameRateLimit(int fps) {
+    m_paintFrameRateLimit = std::max(0, std::min(fps, 1000));
+    UpdatePaintFrameRate();
+}
+
+void BrowserView::UpdatePaintFrameRate() {
+    // 0 means uncapped on either side
+    int fps = m_requestedPaintFrameRate;
+    if (m_paintFrameRateLimit > 0) {
+        fps = fps == 0 ? m_paintFrameRateLimit : std::min(fps, m_paintFrameRateLimit);
+    }
+
+    if (m_paintFrameRate != fps) {
+        m_paintFrameRate = fps;
+        ApplyPaintFrameRate();
     }
 }
 
+void BrowserView::ApplyPaintFrameRate() {
+    // With external begin frames the cap is applied in SendBeginFrameIfDue instead
+    if (!m_browserManager) return;
+
+    int fps = m_paintFrameRate;
+    int windowlessFrameRate = fps > 0 ? std::min(fps, MAX_WINDOWLESS_FRAME_RATE) : MAX_WINDOWLESS_FRAME_RATE;
+    m_browserManager->SetWindowlessFrameRate(windowlessFrameRate);
+}
+
 void BrowserView::SuspendProcessing(bool suspend) {
     if (m_processingIsSuspended != suspend) {
         m_processingIsSuspended = suspend;
@@ -353,4 +1977,125 @@ void BrowserView::SuspendProcessing(bool suspend) {
         }
         // Optional: Tell CEF host directly about suspension state if API exists
     }
-}
\ No newline at end of file
+}
+CefRefPtr<CefBrowserHost> BrowserView::GetInputHost() const {
+    CefRefPtr<CefBrowser> browser = m_browserManager ? m_browserManager->GetBrowser() : nullptr;
+    return browser ? browser->GetHost() : nullptr;
+}
+
+void BrowserView::ToBrowserPixels(float x, float y, int& browserX, int& browserY) const {
+    // CEF takes view coordinates: the logical size it lays out in, whatever the render quality
+    browserX = static_cast<int>(std::floor(x * static_cast<float>(m_width)));
+    browserY = static_cast<int>(std::floor(y * static_cast<float>(m_height)));
+}
+
+void BrowserView::QueueMouseMove(float x, float y, uint32_t modifiers) {
+    int browserX, browserY;
+    ToBrowserPixels(x, y, browserX, browserY);
+    if (m_mouseMovePending) m_coalescedInputCount++;
+    m_mouseMovePending = browserX != m_sentMouseX || browserY != m_sentMouseY || modifiers != m_mouseModifiers;
+    m_mouseX = browserX;
+    m_mouseY = browserY;
+    m_mouseModifiers = modifiers;
+}
+
+void BrowserView::QueueMouseWheel(float notchesX, float notchesY, uint32_t modifiers) {
+    if (notchesX == 0.0f && notchesY == 0.0f) return;
+    if (m_wheelX != 0.0f || m_wheelY != 0.0f) m_coalescedInputCount++;
+    m_wheelX += notchesX;
+    m_wheelY += notchesY;
+    m_wheelModifiers = modifiers;
+}
+
+void BrowserView::SendMouseClick(float x, float y, int button, bool mouseUp, int clickCount, uint32_t modifiers) {
+    CefRefPtr<CefBrowserHost> host = GetInputHost();
+    if (!host || button < 0 || button > 2) return;
+
+    // The page sees the pointer where the click happens
+    QueueMouseMove(x, y, modifiers);
+    FlushInput();
+
+    CefMouseEvent event;
+    event.x = m_mouseX;
+    event.y = m_mouseY;
+    event.modifiers = modifiers;
+    static const CefBrowserHost::MouseButtonType BUTTONS[3] = { MBT_LEFT, MBT_RIGHT, MBT_MIDDLE };
+    host->SendMouseClickEvent(event, BUTTONS[button], mouseUp, std::max(clickCount, 1));
+}
+
+void BrowserView::SendMouseLeave(uint32_t modifiers) {
+    m_mouseMovePending = false;
+    m_wheelX = m_wheelY = 0.0f;
+    m_sentMouseX = m_sentMouseY = INT_MIN;
+    if (CefRefPtr<CefBrowserHost> host = GetInputHost()) {
+        CefMouseEvent event;
+        event.x = m_mouseX;
+        event.y = m_mouseY;
+        event.modifiers = modifiers;
+        host->SendMouseMoveEvent(event, true);
+    }
+}
+
+void BrowserView::FlushInput() {
+    CefRefPtr<CefBrowserHost> host = GetInputHost();
+    if (!host) {
+        m_mouseMovePending = false;
+        m_wheelX = m_wheelY = 0.0f;
+        return;
+    }
+
+    CefMouseEvent event;
+    event.x = m_mouseX;
+    event.y = m_mouseY;
+    if (m_mouseMovePending) {
+        event.modifiers = m_mouseModifiers;
+        host->SendMouseMoveEvent(event, false);
+        m_sentMouseX = m_mouseX;
+        m_sentMouseY = m_mouseY;
+        m_mouseMovePending = false;
+    }
+    if (m_wheelX != 0.0f || m_wheelY != 0.0f) {
+        // Whole WHEEL_DELTA units per notch, the way Windows reports a wheel
+        event.modifiers = m_wheelModifiers;
+        host->SendMouseWheelEvent(event, static_cast<int>(m_wheelX * WHEEL_DELTA), static_cast<int>(m_wheelY * WHEEL_DELTA));
+        m_wheelX = m_wheelY = 0.0f;
+    }
+}
+
+void BrowserView::SetKeyboardFocus(bool focus) {
+    if (m_keyboardFocus == focus) return;
+    m_keyboardFocus = focus;
+    if (CefRefPtr<CefBrowserHost> host = GetInputHost()) {
+        host->SetFocus(focus);
+    }
+}
+
+bool BrowserView::HandleKeyMessage(UINT message, WPARAM wParam, LPARAM lParam) {
+    if (!m_keyboardFocus) return false;
+
+    CefKeyEvent event;
+    switch (message) {
+    case WM_KEYDOWN:
+    case WM_SYSKEYDOWN: event.type = KEYEVENT_RAWKEYDOWN; break;
+    case WM_KEYUP:
+    case WM_SYSKEYUP: event.type = KEYEVENT_KEYUP; break;
+    case WM_CHAR:
+    case WM_SYSCHAR: event.type = KEYEVENT_CHAR; break;
+    default: return false;
+    }
+    CefRefPtr<CefBrowserHost> host = GetInputHost();
+    if (!host) return false;
+
+    event.windows_key_code = static_cast<int>(wParam);
+    event.native_key_code = static_cast<int>(lParam);
+    event.is_system_key = message == WM_SYSKEYDOWN || message == WM_SYSKEYUP || message == WM_SYSCHAR;
+    uint32_t modifiers = 0;
+    if (GetKeyState(VK_SHIFT) & 0x8000) modifiers |= EVENTFLAG_SHIFT_DOWN;
+    if (GetKeyState(VK_CONTROL) & 0x8000) modifiers |= EVENTFLAG_CONTROL_DOWN;
+    if (GetKeyState(VK_MENU) & 0x8000) modifiers |= EVENTFLAG_ALT_DOWN;
+    if (GetKeyState(VK_CAPITAL) & 1) modifiers |= EVENTFLAG_CAPS_LOCK_ON;
+    if (event.type == KEYEVENT_RAWKEYDOWN && (lParam & (1 << 30))) modifiers |= EVENTFLAG_IS_REPEAT;
+    event.modifiers = modifiers;
+    host->SendKeyEvent(event);
+    return true;
+}
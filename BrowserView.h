@@ -7,10 +7,20 @@
 #include <wrl/client.h>
 #include <string>
 #include <memory>
+#include <vector>
+#include <cstdint>
 #include <atomic> // For atomic flags
+#include <chrono>
+#include <climits>
+#include <functional>
 #include "RenderSystem.h"
+#include "TextureConverter.h"
+#include "CpuProfiler.h"
 #include "BrowserManager.h" // Include BrowserManager definition
 #include "PerformanceOptimizer.h" // For performance state types
+#include "PaintTrace.h"
+#include "WebWidgetAtlas.h"
+#include "TabThumbnailCache.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -26,63 +36,335 @@ public:
     BrowserView& operator=(BrowserView&&) = delete;
 
     // Browser control
+    // Initialize only runs the CEF subprocess check (false in a subprocess, which should exit).
+    // StartBrowser does the expensive part (CefInitialize, textures, first browser) and is called
+    // once the overlay has presented its first frame, or when the browser page is first opened.
     bool Initialize();
+    bool StartBrowser();
+    bool IsBrowserStarted() const { return m_browserStarted; }
+    bool HasBrowserStartFailed() const { return m_browserStartFailed; }
+    void RequestBrowserStart() { m_browserStartRequested = true; } // UI: browser page opened
+    // UI: a link is hovered (call every frame while it is); see BrowserManager::SpeculateNavigation
+    void SpeculateNavigation(const std::string& url);
+    bool IsBrowserStartRequested() const { return m_browserStartRequested; }
+    // Instead of CEF, StartBrowser creates only the textures and Update plays the recorded paints
+    // (see PaintTraceRecorder); call before StartBrowser
+    bool StartPaintReplay(const std::string& path);
+    bool IsReplayingPaints() const { return m_paintReplay != nullptr; }
+    // Neither CEF nor a recording: StartBrowser creates only the textures and the caller delivers
+    // the paints (SignalTextureUpdateFromHandler), as GameOverlayBench does; call before StartBrowser
+    void SetExternalPaints() { m_externalPaints = true; }
     void Shutdown();
     void Navigate(const std::string& url);
     void Resize(int width, int height);
 
-    // Process browser message loop (call this frequently)
-    void Update();
+    // Process browser message loop (call this frequently); CEF work is pumped until pumpDeadline
+    // (BrowserManager::DoScheduledMessageLoopWork), frameInterval capping its slice estimate
+    void Update(std::chrono::steady_clock::time_point pumpDeadline, std::chrono::steady_clock::duration frameInterval);
 
     // Render browser content - This is now handled internally via Update and GPU copy
     // void Render(); // Removed - Update drives the process now
 
     // Called by BrowserManager when BrowserHandler::OnPaint fires
-    void SignalTextureUpdateFromHandler(const void* buffer, int width, int height);
+    // Writes the dirty regions straight into a free upload slot; CEF's buffer is not kept
+    // paintQpc is the QueryPerformanceCounter time BrowserHandler received the paint at
+    void SignalTextureUpdateFromHandler(const void* buffer, int width, int height, const std::vector<RECT>& dirtyRects,
+        LONGLONG paintQpc);
+    // Called by BrowserManager when BrowserHandler::OnAcceleratedPaint fires
+    void SignalSharedTextureFromHandler(HANDLE sharedHandle, LONGLONG paintQpc);
+    // Called by BrowserManager when BrowserHandler::OnScrollOffsetChanged fires (CEF thread). On
+    // the upload ring copy path, the next paint is checked for a pure vertical scroll: rows whose
+    // hash matches the row the offset says they came from are moved on the GPU, from the shown
+    // texture into a second one that replaces it, and only the rows that match nothing (the
+    // newly exposed strip, changed content) are uploaded. Rows that hash as before (fixed headers)
+    // are copied in place.
+    void SignalScrollOffsetFromHandler(double x, double y);
+
+    // Popup layer (<select> dropdowns, autocomplete): CEF paints it separately (PET_POPUP), so it
+    // lives in its own small texture and is composited over the view in the ImGui draw. Opening or
+    // scrolling a dropdown then uploads only the popup.
+    void SignalPopupShowFromHandler(bool show);
+    void SignalPopupSizeFromHandler(const RECT& rect); // View coordinates
+    void SignalPopupPaintFromHandler(const void* buffer, int width, int height);
+    void SignalPopupSharedTextureFromHandler(HANDLE sharedHandle);
+    // Render thread: upload a pending popup paint (direct command list, a few KB at most)
+    void RecordPopupUpload(ID3D12GraphicsCommandList* commandList);
+    // UI: the popup texture and where it goes in browser pixels; false when nothing to show
+    bool GetPopupLayer(D3D12_GPU_DESCRIPTOR_HANDLE& gpuHandle, RECT& rect) const;
 
     // Check if a GPU copy is needed
-    bool TextureNeedsGPUCopy() const { return m_textureNeedsGPUCopy; }
+    // Clear the flag before taking the published slot so a paint published meanwhile sets it again
+    // Or one is in progress: scheduled, waiting for the back texture to be brought up to date, or
+    // copied into it and waiting for the swap
+    bool TextureNeedsGPUCopy() const { return m_textureNeedsGPUCopy || m_scheduledUpload.slot || m_heldUploadSlot || m_backSlot; }
     void ClearTextureUpdateFlag() { m_textureNeedsGPUCopy = false; }
-    const void* GetCpuBufferData() const { return m_cpuBufferData; } // Temp storage
-    int GetCpuBufferWidth() const { return m_cpuBufferWidth; }
-    int GetCpuBufferHeight() const { return m_cpuBufferHeight; }
+    // Next paint uploads the whole frame (e.g. after a failed copy); asks CEF to repaint
+    void RequestFullUpload();
+    // Called by BrowserManager when another tab takes over the view texture
+    void OnActiveTabChanged();
+
+    // --- Tab Thumbnails ---
+    // A tab giving up the texture leaves its last frame behind as a small BC1 thumbnail (see
+    // TabThumbnailCache). Render thread, before the browser copy: records the pending capture, true
+    // when it did; that frame's paint copy then waits for the next one, so it can't land first.
+    bool RecordTabThumbnailCapture(ID3D12GraphicsCommandList* commandList);
+    bool GetTabThumbnail(int tabId, D3D12_GPU_DESCRIPTOR_HANDLE& texture, UINT& width, UINT& height) const;
+    // The active tab's thumbnail while the texture still holds another tab's frame
+    bool GetSwitchPlaceholder(D3D12_GPU_DESCRIPTOR_HANDLE& texture) const;
+    // Browsers are created asynchronously: the active tab hasn't painted into the texture yet
+    bool IsAwaitingFirstPaint() const;
+    void ForgetTabThumbnail(int tabId); // Called by BrowserManager when a tab closes
+    // Premultiply while uploading; CEF already paints premultiplied, so only for straight-alpha sources
+    void SetPremultiplyAlpha(bool premultiply) { m_premultiplyAlpha = premultiply; }
+    // The latest accelerated paint, copied out of CEF's shared texture during its callback; copy it
+    // GPU-to-GPU, then consume it (caller holds m_bufferMutex)
+    ID3D12Resource* GetSharedTexture() const { return m_sharedTexture.Get(); }
+    void ReleaseSharedTexture(); // Never recorded: its paint copy is free again at once
+    void ConsumeSharedTexture(); // After recording its copy: reused after this frame, its paint counted as shown
 
     // Access to browser manager
     BrowserManager* GetBrowserManager() { return m_browserManager.get(); }
 
+    // Pinned web widgets' shared texture (BrowserManager::PinWidget); null after Shutdown
+    WebWidgetAtlas* GetWebWidgetAtlas() const { return m_webWidgetAtlas.get(); }
+
     // Texture access for ImGui / Rendering
     ID3D12Resource* GetTexture() const { return m_browserTexture.Get(); } // The target GPU texture
-    ID3D12Resource* GetUploadTexture() const { return m_uploadTexture.Get(); } // The intermediate upload texture
+
+    // Upload ring for CPU paints: persistently mapped buffers filled by OnPaint
+    // A slot is reused only once the GPU has passed the fence value of the frame that copied from it.
+    // The CEF thread publishes one written slot at a time; a newer paint supersedes an unconsumed one.
+    // On the GPU upload texture path each slot is instead a whole frame in a texture the UI samples
+    // (ShowUploadSlot); the shown slot stays Reading until the next one replaces it.
+    enum class UploadSlotState { Free, Writing, Published, Reading };
+    struct ScrollMove {
+        LONG top = 0;       // Full-width rows top..bottom of the new frame
+        LONG bottom = 0;
+        LONG sourceTop = 0; // Where they are in the shown texture
+    };
+    struct UploadSlot {
+        ComPtr<ID3D12Resource> buffer;
+        uint8_t* mappedData = nullptr;
+        UINT64 size = 0;
+        UINT64 fenceValue = 0; // Written before the state returns to Free
+        std::atomic<UploadSlotState> state = UploadSlotState::Free;
+        bool claimed = false; // Held Writing by ReleaseBrowserTextureResources (render thread only)
+
+        // Published content, laid out like the whole frame; only these rects are valid
+        std::vector<RECT> rects;
+        UINT64 rectBytes = 0;
+        int width = 0;
+        int height = 0;
+        UINT rowPitch = 0;
+        LONGLONG paintQpc = 0;
+        // A scroll: the rows moved from the shown texture; rects then only cover the rest
+        std::vector<ScrollMove> scrollMoves;
+        // Copy queue: the previous paint's regions, which the back display texture lacks
+        std::vector<RECT> catchUpRects;
+
+        // GPU upload texture path
+        ComPtr<ID3D12Resource> texture;
+        UINT srvDescriptorIndex = UINT_MAX;
+        std::vector<RECT> staleRects; // Painted into other slots since this one was written (CEF thread)
+    };
+    // Render thread: take the published slot (nullptr if none), record the copy, then release it
+    // with the fence value of the frame that copies from it
+    UploadSlot* TakePublishedUploadSlot();
+    void ReleaseUploadSlot(UploadSlot* slot, UINT64 fenceValue);
+    // GPU upload texture path: the slot becomes the sampled texture, the one it replaces is
+    // released with fenceValue
+    void ShowUploadSlot(UploadSlot* slot, UINT64 fenceValue);
+    BrowserUploadPath GetUploadPath() const;
+
+    // --- Upload Scheduling ---
+    // Upload ring copy path (no conversion): at most bytesPerFrame of paint pixels are copied per
+    // frame, 0 = no limit; follows the PerformanceState. A larger paint is copied over several
+    // frames, tile by tile with the visible region first, into a second texture that replaces the
+    // shown one once complete, so it never appears half done. Small paints arriving meanwhile
+    // (typing, hover) skip the queue: they go straight to the shown texture.
+    void SetUploadBudget(UINT64 bytesPerFrame) { m_uploadBudgetBytes = bytesPerFrame; }
+    void SetVisibleRegion(const RECT& rect) { m_visibleRegion = rect; } // Browser pixels, from the UI
+    // Render thread: records this frame's copies; true when what the UI samples changed
+    // With the copy queue, paints that would be copied straight into the shown texture go into a
+    // back display texture instead, on a detached copy: the frame samples the front one without
+    // waiting for the copy or transitioning it, and the two swap once the copy fence has passed.
+    // Each paint also carries the previous one's regions (catchUpRects), which the back texture
+    // lacks; after a swap by another path the back one is first copied from the front whole.
+    bool RecordScheduledUploads(ID3D12GraphicsCommandList* commandList);
+    bool UsesGpuUploadTextures() const { return m_uploadPath == BrowserUploadPath::GpuUploadTexture; }
+
+    // Compute path: paints are converted to an RGBA texture with a full mip chain on the GPU
+    // (premultiplied there instead of in OnPaint), so a view shown smaller than the browser samples
+    // filtered levels. Without the compute pipeline the copy path is used; applies on the next resize.
+    void SetGpuConversion(bool enable) { m_gpuConversionPreferred = enable; }
+    bool UsesGpuConversion() const { return m_gpuConversionActive; }
+    void SetLinearMipFiltering(bool linear) { m_linearMipFiltering = linear; } // Average mips in linear light
+    // Render thread: record the conversion of a published slot or the shared texture on the direct list
+    bool RecordFrameConversion(ID3D12GraphicsCommandList* commandList, const UploadSlot* slot);
+    bool RecordFrameConversion(ID3D12GraphicsCommandList* commandList, ID3D12Resource* sharedTexture);
     UINT GetSRVDescriptorIndex() const { return m_srvDescriptorIndex; }
     D3D12_GPU_DESCRIPTOR_HANDLE GetTextureGpuHandle() const; // Get GPU handle for ImGui::Image
+    // The texture stays at the logical size; at lower render qualities paints cover its top left
+    // part, which the UI samples with these as the bottom right UVs
+    void GetContentExtent(float& u, float& v) const;
+    // Render thread: size of the paint the texture now shows (set by the copy paths)
+    void SetShownContentSize(int width, int height); // The frame now belongs to the active tab
+    // Render thread, before the UI: a paint the size of the whole target is copied straight into it
+    // (RenderSystem::CopyToSceneTarget) rather than drawn through the UI, when the page is maximized.
+    // IsFullscreenCopied tells the page the frame already shows it, until the next call
+    bool RecordFullscreenCopy(bool maximized);
+    bool IsFullscreenCopied() const { return m_fullscreenCopied; }
 
     // Dimensions
     int GetWidth() const { return m_width; }
     int GetHeight() const { return m_height; }
+    int GetBrowserInternalWidth() const { return m_browserInternalWidth; }   // Scaled by render quality
+    int GetBrowserInternalHeight() const { return m_browserInternalHeight; }
 
     // Performance optimization
     void AdaptToPerformanceState(PerformanceState state, ResourceUsageLevel level);
     void SetRenderQuality(float quality); // Scales internal browser size
-    float GetRenderQuality() const { return m_renderQuality; }
-    void SetUpdateFrequency(int framesPerUpdate); // Throttles DoMessageLoopWork calls
-    int GetUpdateFrequency() const { return m_framesPerUpdate; }
+    float GetRenderQuality() const { return m_renderQuality; } // After the limit
+    // Upper bound on the render quality (adaptive resolution); the lower of the two applies
+    void SetRenderQualityLimit(float limit);
+    // Paint rate cap in FPS, 0 = follow the render loop. Only painting is throttled; the message
+    // loop keeps being pumped so networking, timers and IPC run at full speed.
+    void SetPaintFrameRate(int fps);
+    int GetPaintFrameRate() const { return m_paintFrameRate; } // After the limit
+    // Upper bound on the paint rate (component budget), 0 = none; the lower of the two applies
+    void SetPaintFrameRateLimit(int fps);
     void SuspendProcessing(bool suspend);
     bool IsProcessingSuspended() const { return m_processingIsSuspended; }
+    // The overlay window hidden or minimized (not a performance state: LowPower can be visible).
+    // Hides the pages from CEF and freezes them (BrowserManager::SetPagesFrozen); call every frame
+    void SetWindowHidden(bool hidden);
+    // While suspended: releases the browser texture, its upload ring and the popup layer. They are
+    // recreated by the first Update after processing resumes, and CEF repaints into them.
+    // False when not suspended (paints would keep arriving) or already released.
+    bool ReleaseSuspendedResources();
+    // Pixels copied out of software paints since startup (changed tiles only), in bytes
+    UINT64 GetUploadedBytes() const { return m_uploadedBytes.load(std::memory_order_relaxed); }
+    BrowserTileStats GetTileStats() const;
+
+    // --- Paint Latency ---
+    // Render thread, after the browser copy: the paint time of the newest paint the frame made
+    // visible (0 if none), for RenderSystem::TagFrameBrowserPaint
+    LONGLONG TakeShownPaintTime() { LONGLONG paintQpc = m_shownPaintQpc; m_shownPaintQpc = 0; return paintQpc; }
+    BrowserPaintStats GetPaintStats() const;
+
+    // --- Input ---
+    // Positions are fractions of the displayed image (0..1 across), mapped to the browser's view
+    // coordinates, so they land right at any render quality. Moves and wheel deltas are only queued:
+    // FlushInput sends the newest position and the summed wheel once, so even a high polling rate
+    // mouse costs the browser process one message of each per frame. Clicks send the queued move
+    // first. Modifiers are CEF event flags.
+    void QueueMouseMove(float x, float y, uint32_t modifiers);
+    void QueueMouseWheel(float notchesX, float notchesY, uint32_t modifiers);
+    void SendMouseClick(float x, float y, int button, bool mouseUp, int clickCount, uint32_t modifiers); // 0 left, 1 right, 2 middle
+    void SendMouseLeave(uint32_t modifiers);
+    void FlushInput();
+    uint64_t GetCoalescedInputCount() const { return m_coalescedInputCount; } // Moves and wheel events never sent
+    // While the page has keyboard focus (clicked into) the window procedure passes key and
+    // character messages here instead of to ImGui
+    void SetKeyboardFocus(bool focus);
+    bool HasKeyboardFocus() const { return m_keyboardFocus; }
+    bool HandleKeyMessage(UINT message, WPARAM wParam, LPARAM lParam); // True when forwarded
+
+    // External begin frames: CEF only produces a frame when asked, so browser paints follow our
+    // cadence. Issues at most one per interval; the render loop skips it while halted.
+    bool SendBeginFrameIfDue(std::chrono::microseconds interval);
+    DWORD GetBeginFrameTimeoutMs(std::chrono::microseconds interval) const; // INFINITE when not used
 
 
 private:
     // Create texture resources (GPU texture and upload buffer)
     void CreateBrowserTextureResources(int width, int height);
     void ReleaseBrowserTextureResources();
+    static void MergeRect(std::vector<RECT>& rects, RECT rect); // Overlaps merge; past MAX_DIRTY_RECTS one bounding box
+    // CEF thread: the tiles m_dirtyRects touch whose pixels changed, as rects to upload
+    void CollectChangedTiles(const uint8_t* pixels, int width, int height, bool fullUpload, std::vector<RECT>& uploadRects);
+    void InvalidateTiles(const RECT& rect); // The texture may not hold what the hashes say
+    // CEF thread: row hashes of what the texture holds, for scroll detection
+    void UpdateRowHashes(const uint8_t* pixels, int width, LONG top, LONG bottom);
+    void InvalidateRows(const RECT& rect);
+    // CEF thread: replaces the slot's rects with moves and the rows left to upload when the paint
+    // is a scroll by dy pixels and that uploads less; false otherwise
+    bool DetectScroll(const uint8_t* pixels, int width, int height, LONG dy, UploadSlot& slot);
+    void MergeDirtyRect(RECT rect) { MergeRect(m_dirtyRects, rect); }
+    bool BeginScheduledUpload(UploadSlot* slot); // False when no second texture can be had
+    bool AcquireScheduledTexture(); // The second texture and its SRV, like the shown one
+    // A texture and SRV like the shown one, from the pool; RetireDisplayTexture sends it back
+    bool AcquireDisplayTexture(ComPtr<ID3D12Resource>& texture, UINT& srvDescriptorIndex, const wchar_t* name);
+    void RetireDisplayTexture(ComPtr<ID3D12Resource>& texture, UINT& srvDescriptorIndex);
+    void ReleaseScheduledUpload(); // Retires its texture; the slots are left to the caller
+    // Direct queue (not the copy queue): transitions the target to COPY_DEST first
+    void RecordSlotCopy(ID3D12GraphicsCommandList* copyList, bool directQueue, const UploadSlot& slot,
+        const std::vector<RECT>& rects, ID3D12Resource* target);
+    bool CreateGpuUploadTextures(int width, int height); // False (nothing left created) when not possible
+    void ReleaseGpuUploadTextures();
+    // CEF thread: the slot's regions and those it fell behind on; returns the bytes written
+    UINT64 WriteSlotTexture(UploadSlot& slot, const uint8_t* pixels, int width, int height, bool premultiplyAlpha);
+    void UpdatePaintFrameRate(); // Combines the requested rate and the limit
+    void ApplyPaintFrameRate(); // Pushes the paint rate to CEF's own frame clock
+    void ApplyRenderQuality();  // Resizes when the requested quality or the limit changed the effective one
+    std::chrono::microseconds GetBeginFrameInterval(std::chrono::microseconds renderInterval) const;
+    UploadSlot* AcquireFreeUploadSlot(); // CEF thread; nullptr when every slot is in use (never blocks)
+    bool EnsurePopupTexture(UINT width, UINT height);
+    void ReleasePopupResources();
 
     // DirectX 12 resources
     RenderSystem* m_renderSystem = nullptr;
     ComPtr<ID3D12Resource> m_browserTexture;        // Default heap texture (GPU-only) - Render target
-    ComPtr<ID3D12Resource> m_uploadTexture;         // Upload heap texture (CPU write, GPU read for copy)
+    static constexpr UINT UPLOAD_RING_SIZE = RenderSystem::MAX_FRAMES_IN_FLIGHT;
+    UploadSlot m_uploadRing[UPLOAD_RING_SIZE];      // Upload heap buffers (CPU write, GPU read for copy)
+    UINT m_uploadRingIndex = 0;                     // Next slot the CEF thread tries
+    std::atomic<int> m_publishedSlot = -1;          // Lock-free handoff to the render thread
+    std::atomic<BrowserUploadPath> m_uploadPath{ BrowserUploadPath::UploadRing }; // CPU paints
+    UploadSlot* m_shownSlot = nullptr;              // GPU upload texture path: the sampled slot (render thread)
+    std::vector<uint8_t> m_premultiplyScratch;      // GPU upload texture path: premultiplied rows (CEF thread)
+
+    // Upload scheduling (render thread)
+    struct ScheduledUpload {
+        UploadSlot* slot = nullptr;          // Copied tile by tile; Reading until shown
+        ComPtr<ID3D12Resource> texture;      // Replaces m_browserTexture once complete
+        UINT srvDescriptorIndex = UINT_MAX;
+        std::vector<RECT> tiles;             // Upload order
+        size_t nextTile = 0;                 // Its first frame only copies the shown texture in
+        std::vector<RECT> overrideRects;     // Small paints shown meanwhile; copied over before the swap
+    };
+    static constexpr UINT64 SMALL_UPLOAD_BYTES = 256 * 1024;
+    static constexpr size_t MAX_OVERRIDE_RECTS = 32;
+    ScheduledUpload m_scheduledUpload;
+    UploadSlot* m_heldUploadSlot = nullptr;  // Large paint taken during a scheduled one; next in line
+    // Back display texture (copy queue); swapped with m_browserTexture once m_backSlot is copied
+    ComPtr<ID3D12Resource> m_backTexture;
+    UINT m_backSrvDescriptorIndex = UINT_MAX;
+    bool m_backValid = false;                // Holds the front's frame but for the catch-up regions
+    UploadSlot* m_backSlot = nullptr;        // Copying into it; Reading until the swap
+    UINT64 m_backCopyFenceValue = 0;
+    UINT64 m_uploadBudgetBytes = 0;
+    RECT m_visibleRegion = {};
+    int m_shownContentWidth = 0; // 0: nothing painted yet, sampled whole
+    int m_shownContentHeight = 0;
+    bool m_fullscreenCopied = false;
+    std::vector<RECT> m_uploadBatch;         // Scratch: this frame's tiles
     UINT m_srvDescriptorIndex = UINT_MAX;           // SRV descriptor index for m_browserTexture
+    std::unique_ptr<TextureConverter> m_textureConverter;
+    std::atomic<bool> m_gpuConversionPreferred = true;
+    std::atomic<bool> m_gpuConversionActive = false; // m_browserTexture is RGBA with mips
+    std::atomic<bool> m_linearMipFiltering = true;
 
     // Browser resources
     std::unique_ptr<BrowserManager> m_browserManager;
+    std::unique_ptr<WebWidgetAtlas> m_webWidgetAtlas;
+    std::unique_ptr<TabThumbnailCache> m_tabThumbnails;
+    int m_textureTabId = 0; // Tab whose frame m_browserTexture shows, 0 for none (render thread)
+    std::unique_ptr<PaintTraceReplay> m_paintReplay;
+    bool m_externalPaints = false;
+    bool m_browserStarted = false;
+    bool m_browserStartFailed = false;
+    bool m_browserStartRequested = false;
+    std::string m_pendingUrl; // Navigate before StartBrowser
 
     // Dimensions
     int m_width = 1024;  // Logical width of the view/texture
@@ -92,14 +374,117 @@ private:
 
     // Performance optimization
     float m_renderQuality = 1.0f; // Scales browser internal size
-    std::atomic<int> m_framesPerUpdate = 1; // How often to call DoMessageLoopWork
-    int m_frameCounter = 0;
+    float m_requestedRenderQuality = 1.0f;
+    float m_renderQualityLimit = 1.0f;
+    static constexpr int MAX_WINDOWLESS_FRAME_RATE = 60; // CEF's limit without external begin frames
+    std::atomic<int> m_paintFrameRate = 0;
+    int m_requestedPaintFrameRate = 0;
+    int m_paintFrameRateLimit = 0;
+    std::chrono::steady_clock::time_point m_lastBeginFrameTime;
     std::atomic<bool> m_processingIsSuspended = false;
+    bool m_windowHidden = false; // SetWindowHidden, as last applied
+    bool m_textureResourcesReleased = false; // By ReleaseSuspendedResources
+
+    // Input (main thread)
+    CefRefPtr<CefBrowserHost> GetInputHost() const;
+    void ToBrowserPixels(float x, float y, int& browserX, int& browserY) const; // View coordinates
+    bool m_mouseMovePending = false;
+    int m_mouseX = 0;
+    int m_mouseY = 0;
+    uint32_t m_mouseModifiers = 0;
+    int m_sentMouseX = INT_MIN; // Last move sent
+    int m_sentMouseY = INT_MIN;
+    float m_wheelX = 0.0f;      // Queued notches
+    float m_wheelY = 0.0f;
+    uint32_t m_wheelModifiers = 0;
+    bool m_keyboardFocus = false;
+    uint64_t m_coalescedInputCount = 0;
 
     // Texture Update State
     std::atomic<bool> m_textureNeedsGPUCopy = false; // Flag indicating GPU copy is needed
-    const void* m_cpuBufferData = nullptr;          // Temporary pointer to CPU buffer from OnPaint
-    int m_cpuBufferWidth = 0;
-    int m_cpuBufferHeight = 0;
-    std::mutex m_bufferMutex; // Mutex for accessing CPU buffer details safely
+    std::atomic<UINT64> m_uploadedBytes = 0;
+
+    // Dirty regions not published yet (browser pixels, CEF thread only). Overlapping rects are
+    // merged; past the limit they collapse into their bounding box, as each one costs a copy command.
+    static constexpr size_t MAX_DIRTY_RECTS = 8;
+    std::vector<RECT> m_dirtyRects;
+    std::atomic<bool> m_fullUploadPending = true;
+
+    // Hash per tile of the pixels last handed to the GPU; 0 for tiles it may not hold (CEF thread)
+    static constexpr int UPLOAD_TILE_SIZE = 64;
+    static constexpr size_t MAX_TILE_RECTS = 64; // More changed runs upload their bounding box
+    std::vector<uint64_t> m_tileHashes;
+    std::vector<uint8_t> m_dirtyTiles; // Scratch: tiles this paint touches
+    int m_tileColumns = 0;
+    int m_tileRows = 0;
+    std::atomic<UINT64> m_hashedTiles = 0;
+    std::atomic<UINT64> m_unchangedTiles = 0;
+    std::atomic<UINT64> m_dirtyBytes = 0;
+
+    // Scroll reuse (CEF thread): a hash per full row of the frame the texture holds, 0 for rows
+    // it may not hold; kept only on the upload ring copy path
+    static constexpr size_t MAX_SCROLL_MOVES = 16;
+    std::vector<uint64_t> m_rowHashes;
+    std::vector<uint64_t> m_newRowHashes; // Scratch
+    double m_scrollOffsetY = 0.0;        // Latest from CEF, view coordinates
+    double m_paintedScrollOffsetY = 0.0; // As of the last paint
+    std::atomic<UINT64> m_scrollPaints = 0;
+    std::atomic<UINT64> m_scrollMovedBytes = 0; // Moved on the GPU instead of uploaded
+    // Regions of the published slot, and of the last one the render thread took (CEF thread)
+    std::vector<RECT> m_publishedRects;
+    std::vector<RECT> m_catchUpRects;
+
+    // Paint latency: counted on the CEF thread, shown paints noted on the render thread
+    std::atomic<UINT64> m_paintCount = 0;
+    std::atomic<UINT64> m_overwrittenPaintCount = 0;
+    LONGLONG m_shownPaintQpc = 0;
+    void NoteShownPaint(LONGLONG paintQpc) { m_shownPaintQpc = std::max(m_shownPaintQpc, paintQpc); }
+    std::atomic<bool> m_repaintRequested = false; // A paint found no free slot
+    std::atomic<bool> m_premultiplyAlpha = false;
+    int m_uploadedWidth = 0;
+    int m_uploadedHeight = 0;
+    // CEF reuses its shared texture once OnAcceleratedPaint returns, so each paint is copied out
+    // inside the callback (SharedTextureCopier) into a paint copy that no frame still reads
+    struct PaintCopy {
+        ComPtr<ID3D12Resource> texture;
+        UINT64 fenceValue = 0; // Of the last frame that read it
+        bool writing = false;  // The callback's copy into it is running
+    };
+    static constexpr size_t MAX_PAINT_COPIES = RenderSystem::MAX_FRAMES_IN_FLIGHT + 1;
+    // CEF thread. Copies the paint into a free paint copy, makes that pending (the previous
+    // pending copy is never recorded: replaced) and runs publish under mutex, which guards copies
+    // and pending; publish is told whether an unrecorded paint was replaced. False when no copy was
+    // free or the copy failed.
+    template <typename Mutex>
+    bool CopyAcceleratedPaint(HANDLE sharedHandle, Mutex& mutex, std::vector<PaintCopy>& copies,
+        ComPtr<ID3D12Resource>& pending, const wchar_t* name, const std::function<void(bool replaced)>& publish);
+    static void MarkPaintCopyRead(std::vector<PaintCopy>& copies, ID3D12Resource* texture, UINT64 fenceValue);
+    void RetirePaintCopies(std::vector<PaintCopy>& copies); // Caller holds the copies' mutex
+    std::vector<PaintCopy> m_paintCopies;             // m_bufferMutex
+    ComPtr<ID3D12Resource> m_sharedTexture;           // Latest accelerated paint (one of m_paintCopies)
+    LONGLONG m_sharedTexturePaintQpc = 0;
+    std::atomic<bool> m_sharedTextureFailed = false;  // Handle could not be opened, use software paint
+    PROFILE_MUTEX(m_bufferMutex, "BrowserView buffer"); // Guards the shared texture handoff
+
+    // Popup layer; m_popupMutex guards the CEF thread handoff (visibility, rect, pixels)
+    struct PopupUploadBuffer {
+        ComPtr<ID3D12Resource> buffer;
+        uint8_t* mappedData = nullptr;
+        UINT64 size = 0;
+        UINT64 fenceValue = 0; // Render thread only
+    };
+    mutable std::mutex m_popupMutex;
+    bool m_popupVisible = false;
+    RECT m_popupRect = {};
+    std::vector<uint8_t> m_popupPixels; // Latest software paint, tightly packed BGRA
+    int m_popupPixelWidth = 0;
+    int m_popupPixelHeight = 0;
+    bool m_popupPixelsDirty = false;
+    std::vector<PaintCopy> m_popupPaintCopies;
+    ComPtr<ID3D12Resource> m_popupSharedTexture; // Latest accelerated paint (one of m_popupPaintCopies)
+    // Render thread only
+    ComPtr<ID3D12Resource> m_popupTexture;
+    UINT m_popupSrvDescriptorIndex = UINT_MAX;
+    std::atomic<bool> m_popupHasContent = false;
+    PopupUploadBuffer m_popupUploadRing[UPLOAD_RING_SIZE];
 };
\ No newline at end of file
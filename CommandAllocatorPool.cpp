@@ -4,22 +4,18 @@
 
 #include "CommandAllocatorPool.h"
 #include <stdexcept>
+#include <algorithm>
+#include <iterator>
 
-CommandAllocatorPool::CommandAllocatorPool(ID3D12Device* device, D3D12_COMMAND_LIST_TYPE type)
-    : m_device(device), m_type(type) {
+CommandAllocatorPool::CommandAllocatorPool(ID3D12Device* device, D3D12_COMMAND_LIST_TYPE type, ID3D12Fence* fence)
+    : m_device(device), m_fence(fence), m_type(type) {
+
+    m_outstanding.reserve(RESERVED_OUTSTANDING);
+    m_freeAllocators.reserve(RESERVED_OUTSTANDING);
 
     // Pre-allocate some command allocators
     for (int i = 0; i < 3; i++) {
-        ComPtr<ID3D12CommandAllocator> allocator;
-        HRESULT hr = m_device->CreateCommandAllocator(m_type, IID_PPV_ARGS(&allocator));
-        if (SUCCEEDED(hr)) {
-            CommandAllocatorEntry entry;
-            entry.allocator = allocator;
-            entry.fenceValue = 0;
-
-            m_allocatorPool.push_back(entry);
-            m_availableAllocators.push(m_allocatorPool.size() - 1);
-        }
+        m_freeAllocators.push_back(CreateCommandAllocator());
     }
 }
 
@@ -27,81 +23,135 @@ CommandAllocatorPool::~CommandAllocatorPool() {
     Clear();
 }
 
-ID3D12CommandAllocator* CommandAllocatorPool::GetCommandAllocator(uint64_t completedFenceValue) {
-    std::lock_guard<std::mutex> lock(m_mutex);
+ID3D12CommandAllocator* CommandAllocatorPool::GetCommandAllocator() {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    return AcquireLocked(m_knownCompletedValue, m_fence != nullptr);
+}
 
-    // First check if there's an available allocator in the queue
-    if (!m_availableAllocators.empty()) {
-        size_t allocatorIndex = m_availableAllocators.front();
-        m_availableAllocators.pop();
+ID3D12CommandAllocator* CommandAllocatorPool::GetCommandAllocator(uint64_t completedFenceValue) {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    m_knownCompletedValue = std::max(m_knownCompletedValue, completedFenceValue);
+    return AcquireLocked(m_knownCompletedValue, false);
+}
 
-        CommandAllocatorEntry& entry = m_allocatorPool[allocatorIndex];
+ID3D12CommandAllocator* CommandAllocatorPool::AcquireLocked(uint64_t completedFenceValue, bool canReadFence) {
+    m_stats.acquires++;
 
-        // Reset the allocator if it's safe (GPU has finished using it)
-        if (entry.fenceValue <= completedFenceValue) {
-            entry.allocator->Reset();
-            return entry.allocator.Get();
+    // Only the oldest released allocator needs checking first; the fence is read only when the
+    // last known value doesn't already cover it
+    ComPtr<ID3D12CommandAllocator> allocator;
+    if (!m_inFlight.empty()) {
+        if (m_inFlight.front().fenceValue > completedFenceValue && canReadFence) {
+            m_knownCompletedValue = std::max(m_knownCompletedValue, m_fence->GetCompletedValue());
+            completedFenceValue = m_knownCompletedValue;
+        }
+        if (m_inFlight.front().fenceValue <= completedFenceValue) {
+            allocator = std::move(m_inFlight.front().allocator);
+            m_inFlight.pop_front();
+            m_stats.recycled++;
+            RetireCompletedLocked(completedFenceValue); // The ring only holds work still on the GPU
         }
     }
+    if (!allocator && !m_freeAllocators.empty()) {
+        allocator = std::move(m_freeAllocators.back());
+        m_freeAllocators.pop_back();
+    }
+    if (!allocator) {
+        allocator = CreateCommandAllocator(); // Every allocator is in use: grow
+    }
 
-    // If we get here, either there are no available allocators or none are ready to be reset
-    // Check all allocators to see if any are ready but not in the queue
-    for (CommandAllocatorEntry& entry : m_allocatorPool) {
-        if (entry.fenceValue <= completedFenceValue) {
-            entry.allocator->Reset();
-            return entry.allocator.Get();
-        }
+    HRESULT hr = allocator->Reset();
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to reset command allocator");
     }
 
-    // If we still don't have an allocator, create a new one
-    return CreateCommandAllocator();
+    ID3D12CommandAllocator* result = allocator.Get();
+    m_outstanding.push_back(std::move(allocator));
+
+    UINT inUse = static_cast<UINT>(m_outstanding.size() + m_inFlight.size());
+    m_stats.peakAllocators = std::max(m_stats.peakAllocators, inUse);
+    if (m_stats.acquires % SHRINK_WINDOW == 0) {
+        ShrinkLocked();
+    }
+    return result;
 }
 
 void CommandAllocatorPool::ReleaseCommandAllocator(uint64_t fenceValue, ID3D12CommandAllocator* allocator) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    // Find the allocator in the pool and update its fence value
-    for (size_t i = 0; i < m_allocatorPool.size(); i++) {
-        if (m_allocatorPool[i].allocator.Get() == allocator) {
-            m_allocatorPool[i].fenceValue = fenceValue;
-            m_availableAllocators.push(i);
-            return;
-        }
-    }
+    if (!allocator) return;
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
 
-    // If the allocator wasn't found, it might be a new one that was created on-demand
-    // Add it to the pool
     CommandAllocatorEntry entry;
-    entry.allocator = allocator;
+    auto it = std::find_if(m_outstanding.begin(), m_outstanding.end(),
+        [allocator](const ComPtr<ID3D12CommandAllocator>& outstanding) { return outstanding.Get() == allocator; });
+    if (it != m_outstanding.end()) {
+        entry.allocator = std::move(*it);
+        *it = std::move(m_outstanding.back());
+        m_outstanding.pop_back();
+    }
+    else {
+        entry.allocator = allocator; // Not from this pool; adopt it
+    }
     entry.fenceValue = fenceValue;
 
-    m_allocatorPool.push_back(entry);
-    m_availableAllocators.push(m_allocatorPool.size() - 1);
+    // Releases arrive in submission order, so this is a push_back; an older fence is placed
+    // from the back to keep the ring ordered
+    auto position = m_inFlight.end();
+    while (position != m_inFlight.begin() && std::prev(position)->fenceValue > fenceValue) {
+        --position;
+    }
+    m_inFlight.insert(position, std::move(entry));
+}
+
+void CommandAllocatorPool::RetireCompletedLocked(uint64_t completedFenceValue) {
+    while (!m_inFlight.empty() && m_inFlight.front().fenceValue <= completedFenceValue) {
+        m_freeAllocators.push_back(std::move(m_inFlight.front().allocator));
+        m_inFlight.pop_front();
+    }
+}
+
+void CommandAllocatorPool::ShrinkLocked() {
+    // Allocators the GPU is done with are spares too, however many the ring grew to
+    if (m_fence) {
+        m_knownCompletedValue = std::max(m_knownCompletedValue, m_fence->GetCompletedValue());
+    }
+    RetireCompletedLocked(m_knownCompletedValue);
+
+    // Keep enough for the busiest moment of the window, plus a spare
+    UINT inUse = static_cast<UINT>(m_outstanding.size() + m_inFlight.size());
+    UINT keep = std::max(m_stats.peakAllocators, inUse) + MIN_SPARE_ALLOCATORS;
+    UINT total = inUse + static_cast<UINT>(m_freeAllocators.size());
+    while (total > keep && !m_freeAllocators.empty()) {
+        m_freeAllocators.pop_back();
+        m_stats.destroyed++;
+        total--;
+    }
+    m_stats.peakAllocators = inUse;
 }
 
 void CommandAllocatorPool::Clear() {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
 
-    m_allocatorPool.clear();
+    m_inFlight.clear();
+    m_freeAllocators.clear();
+    m_outstanding.clear();
+}
 
-    // Clear the queue
-    while (!m_availableAllocators.empty()) {
-        m_availableAllocators.pop();
-    }
+CommandAllocatorPool::Stats CommandAllocatorPool::GetStats() const {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.outstandingAllocators = static_cast<UINT>(m_outstanding.size());
+    stats.inFlightAllocators = static_cast<UINT>(m_inFlight.size());
+    stats.freeAllocators = static_cast<UINT>(m_freeAllocators.size());
+    stats.totalAllocators = stats.outstandingAllocators + stats.inFlightAllocators + stats.freeAllocators;
+    return stats;
 }
 
-ID3D12CommandAllocator* CommandAllocatorPool::CreateCommandAllocator() {
+ComPtr<ID3D12CommandAllocator> CommandAllocatorPool::CreateCommandAllocator() {
     ComPtr<ID3D12CommandAllocator> allocator;
     HRESULT hr = m_device->CreateCommandAllocator(m_type, IID_PPV_ARGS(&allocator));
     if (FAILED(hr)) {
         throw std::runtime_error("Failed to create command allocator");
     }
-
-    CommandAllocatorEntry entry;
-    entry.allocator = allocator;
-    entry.fenceValue = 0;
-
-    m_allocatorPool.push_back(entry);
-
-    return allocator.Get();
+    m_stats.created++;
+    return allocator;
 }
@@ -7,8 +7,10 @@
 #include <d3d12.h>
 #include <wrl/client.h>
 #include <vector>
-#include <queue>
+#include <deque>
 #include <mutex>
+#include <cstdint>
+#include "CpuProfiler.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -18,10 +20,26 @@ struct CommandAllocatorEntry {
     uint64_t fenceValue = 0;
 };
 
-// Pool of command allocators for reuse
+// Pool of command allocators for reuse. Released allocators wait in a ring ordered by fence value,
+// so an acquire only checks from the oldest one: the completed ones at the front move to the free
+// list (the first is reused), and when none are complete a free or new allocator is handed out. The
+// pool grows under load and frees allocators beyond the recent peak once it is idle.
 class CommandAllocatorPool {
 public:
-    CommandAllocatorPool(ID3D12Device* device, D3D12_COMMAND_LIST_TYPE type);
+    struct Stats {
+        UINT totalAllocators = 0;
+        UINT outstandingAllocators = 0; // Handed out, not yet released
+        UINT inFlightAllocators = 0;    // Released, waiting for their fence
+        UINT freeAllocators = 0;
+        UINT peakAllocators = 0;        // Most in use at once during the current window
+        uint64_t acquires = 0;
+        uint64_t recycled = 0;          // Acquires served from the in-flight ring
+        uint64_t created = 0;
+        uint64_t destroyed = 0;         // Freed by shrinking
+    };
+
+    // Acquires check fence (when given) themselves; without one, pass the completed value
+    CommandAllocatorPool(ID3D12Device* device, D3D12_COMMAND_LIST_TYPE type, ID3D12Fence* fence = nullptr);
     ~CommandAllocatorPool();
 
     // Disable copy and move
@@ -30,31 +48,54 @@ public:
     CommandAllocatorPool(CommandAllocatorPool&&) = delete;
     CommandAllocatorPool& operator=(CommandAllocatorPool&&) = delete;
 
-    // Get a command allocator from the pool
+    // Get a reset command allocator from the pool
+    ID3D12CommandAllocator* GetCommandAllocator(); // Reads the pool's fence at most once
     ID3D12CommandAllocator* GetCommandAllocator(uint64_t completedFenceValue);
 
-    // Return a command allocator to the pool for reuse
+    // Return a command allocator to the pool for reuse once the GPU passes fenceValue
     void ReleaseCommandAllocator(uint64_t fenceValue, ID3D12CommandAllocator* allocator);
 
     // Clear all allocators
     void Clear();
 
+    Stats GetStats() const;
+
 private:
+    // Acquires per shrink window; spares beyond the window's peak are freed at its end
+    static constexpr uint64_t SHRINK_WINDOW = 512;
+    static constexpr UINT MIN_SPARE_ALLOCATORS = 1;
+
+    static constexpr size_t RESERVED_OUTSTANDING = 16; // Grows past it without losing track
+
+    ID3D12CommandAllocator* AcquireLocked(uint64_t completedFenceValue, bool canReadFence);
+    // Moves the completed allocators at the front of m_inFlight to m_freeAllocators
+    void RetireCompletedLocked(uint64_t completedFenceValue);
+
     // Create a new command allocator
-    ID3D12CommandAllocator* CreateCommandAllocator();
+    ComPtr<ID3D12CommandAllocator> CreateCommandAllocator();
+
+    void ShrinkLocked();
 
     // Device reference
     ID3D12Device* m_device = nullptr;
+    ID3D12Fence* m_fence = nullptr; // Optional
+    uint64_t m_knownCompletedValue = 0;
 
     // Command list type
     D3D12_COMMAND_LIST_TYPE m_type;
 
-    // Pool of command allocators
-    std::vector<CommandAllocatorEntry> m_allocatorPool;
+    // Released allocators in fence order (front is oldest)
+    std::deque<CommandAllocatorEntry> m_inFlight;
+
+    // Allocators whose fence has passed (reset when handed out)
+    std::vector<ComPtr<ID3D12CommandAllocator>> m_freeAllocators;
 
-    // Queue of available allocators
-    std::queue<size_t> m_availableAllocators;
+    // Handed-out allocators, owned here until released; a handful at a time, so searched linearly
+    // (reserved, so acquires don't allocate)
+    std::vector<ComPtr<ID3D12CommandAllocator>> m_outstanding;
+
+    Stats m_stats;
 
     // Thread safety
-    std::mutex m_mutex;
-};
\ No newline at end of file
+    mutable PROFILE_MUTEX(m_mutex, "CommandAllocatorPool");
+};
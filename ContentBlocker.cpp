@@ -0,0 +1,322 @@
+// GameOverlay - ContentBlocker.cpp
+// Request-level ad and tracker blocking for the embedded browser
+
+#include "ContentBlocker.h"
+#include <fstream>
+#include <queue>
+#include <chrono>
+#include <algorithm>
+
+// Hosts that serve ads, trackers and analytics on typical wiki and guide sites
+static const char* DEFAULT_BLOCKED_DOMAINS[] = {
+    "doubleclick.net", "googlesyndication.com", "googleadservices.com", "google-analytics.com",
+    "googletagmanager.com", "googletagservices.com", "adservice.google.com", "imasdk.googleapis.com",
+    "amazon-adsystem.com", "adnxs.com", "adsrvr.org", "advertising.com", "criteo.com", "criteo.net",
+    "pubmatic.com", "rubiconproject.com", "openx.net", "casalemedia.com", "indexww.com",
+    "smartadserver.com", "33across.com", "sharethrough.com", "teads.tv", "taboola.com", "outbrain.com",
+    "moatads.com", "scorecardresearch.com", "quantserve.com", "quantcount.com", "chartbeat.com",
+    "hotjar.com", "mixpanel.com", "segment.io", "newrelic.com", "nr-data.net", "krxd.net",
+    "bluekai.com", "demdex.net", "everesttech.net", "adsafeprotected.com", "doubleverify.com",
+    "btloader.com", "nitropay.com", "pub.network", "ezoic.net", "ezodn.com", "adthrive.com",
+    "mediavine.com", "exponential.com", "yieldmo.com", "lijit.com", "sovrn.com", "media.net",
+    "zemanta.com", "connect.facebook.net", "ads-twitter.com", "analytics.tiktok.com"
+};
+
+static const char* DEFAULT_BLOCKED_PATTERNS[] = {
+    "/pagead/", "/prebid", "/adserver/", "/ads.js", "/adsbygoogle", "/gpt.js", "/pixel.gif?"
+};
+
+ContentBlocker::ContentBlocker()
+    : m_filter(std::make_shared<CompiledFilter>()) {
+}
+
+static std::string NormalizeDomain(const std::string& domain) {
+    std::string result;
+    result.reserve(domain.size());
+    for (char c : domain) {
+        result.push_back(static_cast<char>((c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c));
+    }
+    // "*.example.com", ".example.com" and "example.com." all mean example.com and its subdomains
+    size_t start = result.find_first_not_of("*.");
+    size_t end = result.find_last_not_of('.');
+    if (start == std::string::npos || end == std::string::npos || end < start) return std::string();
+    return result.substr(start, end - start + 1);
+}
+
+void ContentBlocker::AddDomain(const std::string& domain) {
+    std::string normalized = NormalizeDomain(domain);
+    if (normalized.empty()) return;
+    std::lock_guard<std::mutex> lock(m_pendingMutex);
+    m_pendingDomains.push_back(std::move(normalized));
+}
+
+void ContentBlocker::AddUrlPattern(const std::string& pattern) {
+    if (pattern.empty()) return;
+    std::lock_guard<std::mutex> lock(m_pendingMutex);
+    m_pendingPatterns.push_back(pattern);
+}
+
+void ContentBlocker::AddDefaultFilters() {
+    for (const char* domain : DEFAULT_BLOCKED_DOMAINS) {
+        AddDomain(domain);
+    }
+    for (const char* pattern : DEFAULT_BLOCKED_PATTERNS) {
+        AddUrlPattern(pattern);
+    }
+}
+
+bool ContentBlocker::LoadFilterList(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        // Trim whitespace (and the CR of CRLF files)
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos) continue;
+        size_t last = line.find_last_not_of(" \t\r");
+        std::string rule = line.substr(first, last - first + 1);
+
+        // Comments, exceptions, cosmetic rules
+        if (rule[0] == '!' || rule[0] == '#' || rule[0] == '[') continue;
+        if (rule.compare(0, 2, "@@") == 0 || rule.find("##") != std::string::npos ||
+            rule.find("#@#") != std::string::npos) continue;
+
+        // Options ("$third-party" etc.) are not supported; match on the rule alone
+        size_t options = rule.find('$');
+        if (options != std::string::npos) rule.erase(options);
+
+        // "||host^" - domain anchor
+        if (rule.compare(0, 2, "||") == 0) {
+            std::string host = rule.substr(2);
+            size_t hostEnd = host.find_first_of("^/*");
+            if (hostEnd == std::string::npos || (host[hostEnd] == '^' && hostEnd + 1 == host.size())) {
+                AddDomain(host.substr(0, hostEnd));
+                continue;
+            }
+            rule = host; // Host plus path: treat as a pattern
+        }
+
+        // Hosts-file style "0.0.0.0 host"
+        size_t space = rule.find_first_of(" \t");
+        if (space != std::string::npos) {
+            AddDomain(rule.substr(rule.find_last_of(" \t") + 1));
+            continue;
+        }
+
+        // A bare host blocks the domain
+        if (rule.find_first_of("/*^?=&:") == std::string::npos && rule.find('.') != std::string::npos) {
+            AddDomain(rule);
+            continue;
+        }
+
+        // Everything else is a substring pattern; wildcards and separators are dropped
+        std::string pattern;
+        pattern.reserve(rule.size());
+        for (char c : rule) {
+            if (c != '*' && c != '^' && c != '|') pattern.push_back(c);
+        }
+        AddUrlPattern(pattern);
+    }
+    return true;
+}
+
+void ContentBlocker::ClearFilters() {
+    std::lock_guard<std::mutex> lock(m_pendingMutex);
+    m_pendingDomains.clear();
+    m_pendingPatterns.clear();
+}
+
+void ContentBlocker::Compile() {
+    auto filter = std::make_shared<CompiledFilter>();
+    constexpr int ALPHABET_SIZE = CompiledFilter::ALPHABET_SIZE;
+
+    std::lock_guard<std::mutex> lock(m_pendingMutex);
+
+    // Domains: one hash per rule, probed for every suffix of a host
+    filter->domainHashes.reserve(m_pendingDomains.size());
+    for (const std::string& domain : m_pendingDomains) {
+        filter->domainHashes.insert(HashDomainSuffix(domain.data(), domain.data() + domain.size()));
+    }
+
+    // Patterns: trie first...
+    if (!m_pendingPatterns.empty()) {
+        filter->transitions.assign(ALPHABET_SIZE, -1);
+        filter->accepting.assign(1, 0);
+        for (const std::string& pattern : m_pendingPatterns) {
+            int32_t node = 0;
+            for (char c : pattern) {
+                size_t slot = static_cast<size_t>(node) * ALPHABET_SIZE + FoldSymbol(c);
+                if (filter->transitions[slot] < 0) {
+                    filter->transitions[slot] = static_cast<int32_t>(filter->accepting.size());
+                    filter->accepting.push_back(0);
+                    filter->transitions.resize(filter->transitions.size() + ALPHABET_SIZE, -1);
+                }
+                node = filter->transitions[slot];
+            }
+            filter->accepting[node] = 1;
+        }
+
+        // ...then suffix links, breadth first, turned into full transitions so matching never
+        // follows a failure chain
+        std::vector<int32_t> fail(filter->accepting.size(), 0);
+        std::queue<int32_t> queue;
+        for (int s = 0; s < ALPHABET_SIZE; s++) {
+            int32_t& next = filter->transitions[s];
+            if (next < 0) {
+                next = 0;
+            }
+            else {
+                fail[next] = 0;
+                queue.push(next);
+            }
+        }
+        while (!queue.empty()) {
+            int32_t node = queue.front();
+            queue.pop();
+            filter->accepting[node] |= filter->accepting[fail[node]];
+            for (int s = 0; s < ALPHABET_SIZE; s++) {
+                int32_t& next = filter->transitions[static_cast<size_t>(node) * ALPHABET_SIZE + s];
+                int32_t viaFail = filter->transitions[static_cast<size_t>(fail[node]) * ALPHABET_SIZE + s];
+                if (next < 0) {
+                    next = viaFail;
+                }
+                else {
+                    fail[next] = viaFail;
+                    queue.push(next);
+                }
+            }
+        }
+    }
+
+    filter->ruleCount = m_pendingDomains.size() + m_pendingPatterns.size();
+    std::atomic_store(&m_filter, std::shared_ptr<const CompiledFilter>(std::move(filter)));
+}
+
+bool ContentBlocker::ShouldBlock(const std::string& url) const {
+    if (!m_enabled) return false;
+
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<const CompiledFilter> filter = std::atomic_load(&m_filter);
+
+    bool blocked = false;
+    const char* hostBegin = nullptr;
+    const char* hostEnd = nullptr;
+    if (ExtractHost(url, hostBegin, hostEnd)) {
+        blocked = MatchesDomain(*filter, hostBegin, hostEnd) || MatchesPattern(*filter, url);
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    m_checkTimeNs += static_cast<uint64_t>(elapsed.count());
+    m_checkedCount++;
+    if (blocked) m_blockedCount++;
+    return blocked;
+}
+
+size_t ContentBlocker::GetRuleCount() const {
+    return std::atomic_load(&m_filter)->ruleCount;
+}
+
+float ContentBlocker::GetAverageCheckMicroseconds() const {
+    uint64_t checked = m_checkedCount;
+    return checked > 0 ? static_cast<float>(m_checkTimeNs.load()) / 1000.0f / static_cast<float>(checked) : 0.0f;
+}
+
+// FNV-1a over the characters from the end backwards, lowercased. Hashing right to left lets
+// MatchesDomain test every suffix of a host ("cdn.ads.example.com", "ads.example.com", ...) in
+// one pass.
+uint64_t ContentBlocker::HashDomainSuffix(const char* begin, const char* end) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const char* p = end; p != begin;) {
+        char c = *--p;
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+bool ContentBlocker::MatchesDomain(const CompiledFilter& filter, const char* hostBegin, const char* hostEnd) {
+    if (filter.domainHashes.empty()) return false;
+
+    uint64_t hash = 14695981039346656037ull;
+    for (const char* p = hostEnd; p != hostBegin;) {
+        char c = *--p;
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+        // A whole label has been hashed: [p, hostEnd) is a candidate suffix
+        if ((p == hostBegin || *(p - 1) == '.') && filter.domainHashes.count(hash) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ContentBlocker::MatchesPattern(const CompiledFilter& filter, const std::string& url) {
+    if (filter.transitions.empty()) return false;
+
+    constexpr int ALPHABET_SIZE = CompiledFilter::ALPHABET_SIZE;
+    const int32_t* transitions = filter.transitions.data();
+    const uint8_t* accepting = filter.accepting.data();
+    int32_t node = 0;
+    for (char c : url) {
+        node = transitions[static_cast<size_t>(node) * ALPHABET_SIZE + FoldSymbol(c)];
+        if (accepting[node]) return true;
+    }
+    return false;
+}
+
+// Case-folded URL alphabet; rare characters share the last symbol, which can only cause a
+// false match for patterns that contain them
+int ContentBlocker::FoldSymbol(char c) {
+    if (c >= 'a' && c <= 'z') return c - 'a';
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= '0' && c <= '9') return 26 + (c - '0');
+    switch (c) {
+    case '-': return 36;
+    case '.': return 37;
+    case '_': return 38;
+    case '/': return 39;
+    case '?': return 40;
+    case '=': return 41;
+    case '&': return 42;
+    case '%': return 43;
+    case ':': return 44;
+    case '+': return 45;
+    case '~': return 46;
+    case '#': return 47;
+    case ';': return 48;
+    case ',': return 49;
+    case '!': return 50;
+    case '@': return 51;
+    case '$': return 52;
+    case '(': return 53;
+    case ')': return 54;
+    case '\'': return 55;
+    case '[': return 56;
+    case ']': return 57;
+    default: return CompiledFilter::ALPHABET_SIZE - 1;
+    }
+}
+
+bool ContentBlocker::ExtractHost(const std::string& url, const char*& begin, const char*& end) {
+    size_t scheme = url.find("://");
+    if (scheme == std::string::npos) return false; // data:, blob:, about: and the like
+
+    size_t hostStart = scheme + 3;
+    size_t authorityEnd = url.find_first_of("/?#", hostStart);
+    if (authorityEnd == std::string::npos) authorityEnd = url.size();
+
+    // Drop user info and port
+    size_t at = url.rfind('@', authorityEnd);
+    if (at != std::string::npos && at >= hostStart) hostStart = at + 1;
+    size_t hostEnd = authorityEnd;
+    if (hostStart < authorityEnd && url[hostStart] != '[') { // IPv6 literals are never listed
+        size_t colon = url.find(':', hostStart);
+        if (colon != std::string::npos && colon < authorityEnd) hostEnd = colon;
+    }
+    if (hostEnd <= hostStart) return false;
+
+    begin = url.data() + hostStart;
+    end = url.data() + hostEnd;
+    return true;
+}
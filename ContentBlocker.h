@@ -0,0 +1,83 @@
+// GameOverlay - ContentBlocker.h
+// Request-level ad and tracker blocking for the embedded browser
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <unordered_set>
+
+// Matches request URLs against a filter list: blocked domains (and their subdomains) are kept as
+// hashes of every domain suffix, so a host costs one hash pass and a set probe per label; URL
+// patterns are compiled into one Aho-Corasick automaton, so a URL costs one table lookup per
+// character however many patterns there are. A check is a few microseconds for typical URLs.
+//
+// Build the list with Add*/LoadFilterList, then Compile; ShouldBlock is thread-safe (CEF's IO
+// thread) and always sees a complete list, even while a new one is being compiled.
+class ContentBlocker {
+public:
+    ContentBlocker();
+    ~ContentBlocker() = default;
+
+    // Disable copy and move
+    ContentBlocker(const ContentBlocker&) = delete;
+    ContentBlocker& operator=(const ContentBlocker&) = delete;
+    ContentBlocker(ContentBlocker&&) = delete;
+    ContentBlocker& operator=(ContentBlocker&&) = delete;
+
+    // --- Filter list (pending until Compile) ---
+    void AddDomain(const std::string& domain);      // Blocks the domain and every subdomain
+    void AddUrlPattern(const std::string& pattern); // Blocks URLs containing the text
+    void AddDefaultFilters();                       // Common ad, tracker and analytics hosts
+    // One rule per line: "||host^" or a bare host blocks the domain, anything else is a URL
+    // pattern ('*' and '^' are dropped). '!', '#' and '[' start comments; '@@' exceptions and
+    // '##' element rules are skipped. Returns false if the file could not be read.
+    bool LoadFilterList(const std::string& path);
+    void ClearFilters();
+    void Compile(); // Publishes the pending rules
+
+    // --- Matching ---
+    bool ShouldBlock(const std::string& url) const;
+    void SetEnabled(bool enabled) { m_enabled = enabled; }
+    bool IsEnabled() const { return m_enabled; }
+
+    // --- Statistics ---
+    size_t GetRuleCount() const;
+    uint64_t GetCheckedCount() const { return m_checkedCount; }
+    uint64_t GetBlockedCount() const { return m_blockedCount; }
+    float GetAverageCheckMicroseconds() const;
+
+private:
+    // Immutable once published
+    struct CompiledFilter {
+        std::unordered_set<uint64_t> domainHashes;
+        // Aho-Corasick automaton with full transitions over a folded alphabet
+        static constexpr int ALPHABET_SIZE = 64;
+        std::vector<int32_t> transitions;  // node * ALPHABET_SIZE + symbol
+        std::vector<uint8_t> accepting;    // Node ends a pattern (directly or via its suffix link)
+        size_t ruleCount = 0;
+    };
+
+    static uint64_t HashDomainSuffix(const char* begin, const char* end);
+    static int FoldSymbol(char c);
+    static bool ExtractHost(const std::string& url, const char*& begin, const char*& end);
+    static bool MatchesDomain(const CompiledFilter& filter, const char* hostBegin, const char* hostEnd);
+    static bool MatchesPattern(const CompiledFilter& filter, const std::string& url);
+
+    // Pending rules
+    std::mutex m_pendingMutex;
+    std::vector<std::string> m_pendingDomains;
+    std::vector<std::string> m_pendingPatterns;
+
+    // Published filter, swapped atomically (std::atomic_load/atomic_store)
+    std::shared_ptr<const CompiledFilter> m_filter;
+
+    std::atomic<bool> m_enabled = true;
+    mutable std::atomic<uint64_t> m_checkedCount = 0;
+    mutable std::atomic<uint64_t> m_blockedCount = 0;
+    mutable std::atomic<uint64_t> m_checkTimeNs = 0;
+};
@@ -0,0 +1,203 @@
+// GameOverlay - CpuProfiler.cpp
+// Hierarchical CPU zone profiler for the in-overlay timeline view
+
+#include "CpuProfiler.h"
+#include <memory>
+#include <mutex>
+#include <algorithm>
+
+// Fields are relaxed atomics so a reader racing the writer sees stale values, never torn ones;
+// the write index tells it which slots to trust
+struct CpuProfileSlot {
+    std::atomic<const char*> name{ nullptr };
+    std::atomic<int64_t> beginTicks{ 0 };
+    std::atomic<int64_t> endTicks{ 0 };
+    std::atomic<uint32_t> depth{ 0 };
+    std::atomic<uint32_t> type{ 0 };
+};
+
+struct CpuProfileLane {
+    std::string name;                      // Guarded by g_registryMutex
+    uint32_t threadId = 0;
+    uint32_t depth = 0;                    // Owner thread only
+    std::atomic<uint64_t> writeIndex{ 0 }; // Zones published so far
+    CpuProfileSlot slots[CpuProfiler::ZONES_PER_THREAD];
+};
+
+namespace {
+
+// Lanes live until exit, so a thread that ended still shows its last zones
+std::mutex g_registryMutex;
+std::vector<std::unique_ptr<CpuProfileLane>> g_lanes;
+thread_local CpuProfileLane* t_lane = nullptr;
+
+// Frame boundaries, written by the main thread
+std::atomic<int64_t> g_frameMarks[CpuProfiler::FRAME_HISTORY];
+std::atomic<uint64_t> g_frameMarkCount{ 0 };
+
+CpuProfileLane* AddLane(std::string name, uint32_t threadId) {
+    auto lane = std::make_unique<CpuProfileLane>();
+    lane->name = std::move(name);
+    lane->threadId = threadId;
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    g_lanes.push_back(std::move(lane));
+    return g_lanes.back().get();
+}
+
+CpuProfileLane* GetThreadLane() {
+    if (!t_lane) {
+        DWORD threadId = GetCurrentThreadId();
+        t_lane = AddLane("Thread " + std::to_string(threadId), threadId);
+    }
+    return t_lane;
+}
+
+void WriteSlot(CpuProfileLane* lane, const char* name, int64_t beginTicks, int64_t endTicks, uint32_t depth,
+               CpuProfileRecordType type) {
+    uint64_t index = lane->writeIndex.load(std::memory_order_relaxed);
+    CpuProfileSlot& slot = lane->slots[index & (CpuProfiler::ZONES_PER_THREAD - 1)];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.beginTicks.store(beginTicks, std::memory_order_relaxed);
+    slot.endTicks.store(endTicks, std::memory_order_relaxed);
+    slot.depth.store(depth, std::memory_order_relaxed);
+    slot.type.store(static_cast<uint32_t>(type), std::memory_order_relaxed);
+    lane->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+} // namespace
+
+std::atomic<uint32_t> CpuProfiler::s_clients{ 0 };
+
+bool CpuProfiler::IsCompiledIn() {
+#if GAMEOVERLAY_CPU_PROFILER
+    return true;
+#else
+    return false;
+#endif
+}
+
+void CpuProfiler::SetEnabled(CpuProfilerClient client, bool enabled) {
+    if (enabled) {
+        s_clients.fetch_or(static_cast<uint32_t>(client), std::memory_order_relaxed);
+    }
+    else {
+        s_clients.fetch_and(~static_cast<uint32_t>(client), std::memory_order_relaxed);
+    }
+}
+
+void CpuProfiler::SetThreadName(const char* name) {
+    CpuProfileLane* lane = GetThreadLane();
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    lane->name = name;
+}
+
+CpuProfileLane* CpuProfiler::CreateLane(const char* name) {
+    return AddLane(name, 0);
+}
+
+void CpuProfiler::RecordZone(CpuProfileLane* lane, const char* name, int64_t beginTicks, int64_t endTicks, uint32_t depth) {
+    if (!lane || !IsEnabled()) return;
+    WriteSlot(lane, name, beginTicks, endTicks, depth, CpuProfileRecordType::Zone);
+}
+
+void CpuProfiler::RecordInstant(const char* name) {
+    CpuProfileLane* lane = GetThreadLane();
+    int64_t ticks = GetTicks();
+    WriteSlot(lane, name, ticks, ticks, lane->depth, CpuProfileRecordType::Instant);
+}
+
+void CpuProfiler::MarkFrame() {
+    if (!IsEnabled()) return;
+    uint64_t count = g_frameMarkCount.load(std::memory_order_relaxed);
+    g_frameMarks[count % FRAME_HISTORY].store(GetTicks(), std::memory_order_relaxed);
+    g_frameMarkCount.store(count + 1, std::memory_order_release);
+}
+
+int64_t CpuProfiler::GetTicks() {
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}
+
+double CpuProfiler::GetTicksPerMs() {
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return static_cast<double>(frequency.QuadPart) / 1000.0;
+}
+
+int64_t CpuProfiler::BeginZone() {
+    GetThreadLane()->depth++;
+    return GetTicks();
+}
+
+void CpuProfiler::EndZone(const char* name, int64_t beginTicks) {
+    int64_t endTicks = GetTicks();
+    CpuProfileLane* lane = t_lane; // Set by BeginZone
+    lane->depth--;
+    WriteSlot(lane, name, beginTicks, endTicks, lane->depth, CpuProfileRecordType::Zone);
+}
+
+bool CpuProfiler::CaptureLastFrame(CpuProfileFrame& frame) {
+    uint64_t markCount = g_frameMarkCount.load(std::memory_order_acquire);
+    if (markCount < 2) {
+        frame.threads.clear();
+        return false;
+    }
+    CaptureRange(g_frameMarks[(markCount - 2) % FRAME_HISTORY].load(std::memory_order_relaxed),
+        g_frameMarks[(markCount - 1) % FRAME_HISTORY].load(std::memory_order_relaxed), frame);
+    return true;
+}
+
+void CpuProfiler::CaptureRange(int64_t beginTicks, int64_t endTicks, CpuProfileFrame& frame) {
+    frame.threads.clear();
+    frame.beginTicks = beginTicks;
+    frame.endTicks = endTicks;
+    frame.ticksPerMs = GetTicksPerMs();
+
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    std::vector<uint64_t> indices;
+    for (const auto& lane : g_lanes) {
+        CpuProfileThread thread;
+        thread.name = lane->name;
+        thread.threadId = lane->threadId;
+        indices.clear();
+
+        // Slots are published in end-time order, so walk back from the newest until zones end
+        // before the range
+        uint64_t writeIndex = lane->writeIndex.load(std::memory_order_acquire);
+        uint64_t oldest = writeIndex > ZONES_PER_THREAD ? writeIndex - ZONES_PER_THREAD : 0;
+        for (uint64_t index = writeIndex; index > oldest; index--) {
+            const CpuProfileSlot& slot = lane->slots[(index - 1) & (ZONES_PER_THREAD - 1)];
+            CpuProfileZoneRecord zone;
+            zone.name = slot.name.load(std::memory_order_relaxed);
+            zone.beginTicks = slot.beginTicks.load(std::memory_order_relaxed);
+            zone.endTicks = slot.endTicks.load(std::memory_order_relaxed);
+            zone.depth = slot.depth.load(std::memory_order_relaxed);
+            zone.type = static_cast<CpuProfileRecordType>(slot.type.load(std::memory_order_relaxed));
+            if (zone.endTicks < beginTicks) break;
+            if (zone.beginTicks >= endTicks) continue;
+            thread.zones.push_back(zone);
+            indices.push_back(index - 1);
+        }
+
+        // Drop slots the owner wrapped around to while they were being read
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t writtenAfter = lane->writeIndex.load(std::memory_order_relaxed);
+        if (writtenAfter >= ZONES_PER_THREAD) {
+            uint64_t firstIntact = writtenAfter - ZONES_PER_THREAD + 1;
+            size_t keep = 0;
+            while (keep < indices.size() && indices[keep] >= firstIntact) keep++;
+            thread.zones.resize(keep); // Indices are descending
+        }
+        if (thread.zones.empty()) continue;
+
+        std::sort(thread.zones.begin(), thread.zones.end(),
+            [](const CpuProfileZoneRecord& a, const CpuProfileZoneRecord& b) {
+                return a.beginTicks < b.beginTicks || (a.beginTicks == b.beginTicks && a.depth < b.depth);
+            });
+        for (const CpuProfileZoneRecord& zone : thread.zones) {
+            thread.maxDepth = std::max(thread.maxDepth, zone.depth);
+        }
+        frame.threads.push_back(std::move(thread));
+    }
+}
@@ -0,0 +1,175 @@
+// GameOverlay - CpuProfiler.h
+// Hierarchical CPU zone profiler for the in-overlay timeline view
+
+#pragma once
+
+#include "AllocationTracker.h"
+#include <Windows.h>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+enum class CpuProfileRecordType : uint32_t {
+    Zone,
+    Instant // Point event (state change, paint); endTicks == beginTicks
+};
+
+// One completed zone, in QueryPerformanceCounter ticks
+struct CpuProfileZoneRecord {
+    const char* name = nullptr; // String literal from the zone macro
+    int64_t beginTicks = 0;
+    int64_t endTicks = 0;
+    uint32_t depth = 0;         // Nesting level on its thread (0 = outermost)
+    CpuProfileRecordType type = CpuProfileRecordType::Zone;
+};
+
+struct CpuProfileThread {
+    std::string name;
+    uint32_t threadId = 0;      // 0 for lanes that aren't a thread (GPU)
+    uint32_t maxDepth = 0;
+    std::vector<CpuProfileZoneRecord> zones; // Sorted by begin time
+};
+
+// The zones of every profiled thread that overlap a time range (usually one main-thread frame)
+struct CpuProfileFrame {
+    int64_t beginTicks = 0;
+    int64_t endTicks = 0;
+    double ticksPerMs = 0.0;
+    std::vector<CpuProfileThread> threads;
+};
+
+// What keeps zones recording; any one of them is enough
+enum class CpuProfilerClient : uint32_t {
+    Timeline = 1u << 0,     // Performance page's timeline is open
+    TraceCapture = 1u << 1, // Trace hotkey armed (needs the history before the key press)
+    HitchDetector = 1u << 2, // Zone capture armed: incident snapshots reach back before the slow frame
+    ComponentBudget = 1u << 3 // Optimizer samples component costs from their zones
+};
+
+// Writes to a lane come from one thread at a time (e.g. the GPU lane from the render thread)
+struct CpuProfileLane;
+
+// Zones write into a ring per thread that only that thread writes, so recording takes no lock:
+// a slot is filled and then published by bumping the ring's write index. Readers copy the ring and
+// drop whatever the writer may have overwritten meanwhile. Recording is off until a client asks
+// for it; with GAMEOVERLAY_CPU_PROFILER off the macros compile away.
+class CpuProfiler {
+public:
+    static constexpr uint32_t ZONES_PER_THREAD = 16384; // Power of two; ~10 s of main loop zones
+    static constexpr uint32_t FRAME_HISTORY = 8;
+
+    static bool IsCompiledIn();
+    static bool IsEnabled() { return s_clients.load(std::memory_order_relaxed) != 0; }
+    static void SetEnabled(CpuProfilerClient client, bool enabled);
+
+    // Label for the calling thread's lane
+    static void SetThreadName(const char* name);
+
+    // Lane not tied to a thread; lives until exit
+    static CpuProfileLane* CreateLane(const char* name);
+    static void RecordZone(CpuProfileLane* lane, const char* name, int64_t beginTicks, int64_t endTicks, uint32_t depth);
+
+    // Point event on the calling thread's lane
+    static void RecordInstant(const char* name);
+
+    // Main thread, once per frame (the boundary the timeline shows)
+    static void MarkFrame();
+
+    // Zones of the most recent complete frame; false before two frames are marked
+    static bool CaptureLastFrame(CpuProfileFrame& frame);
+    // Zones overlapping [beginTicks, endTicks), as far back as the rings reach
+    static void CaptureRange(int64_t beginTicks, int64_t endTicks, CpuProfileFrame& frame);
+
+    static int64_t GetTicks();
+    static double GetTicksPerMs();
+
+    // Used by CpuProfileZone
+    static int64_t BeginZone();
+    static void EndZone(const char* name, int64_t beginTicks);
+
+private:
+    static std::atomic<uint32_t> s_clients;
+};
+
+// Scoped zone: records [construction, destruction) on the calling thread, and with
+// GAMEOVERLAY_ALLOCATION_TRACKING charges the heap allocations made inside it to its name
+class CpuProfileZone {
+public:
+    explicit CpuProfileZone(const char* name) {
+        if (CpuProfiler::IsEnabled()) {
+            m_name = name;
+            m_beginTicks = CpuProfiler::BeginZone();
+        }
+#if GAMEOVERLAY_ALLOCATION_TRACKING
+        if (AllocationTracker::IsZoneAttributionEnabled()) {
+            m_allocationName = name;
+            AllocationTracker::BeginZone(m_allocationMark);
+        }
+#endif
+    }
+    ~CpuProfileZone() {
+        if (m_name) CpuProfiler::EndZone(m_name, m_beginTicks);
+#if GAMEOVERLAY_ALLOCATION_TRACKING
+        if (m_allocationName) AllocationTracker::EndZone(m_allocationName, m_allocationMark);
+#endif
+    }
+
+    // Disable copy and move
+    CpuProfileZone(const CpuProfileZone&) = delete;
+    CpuProfileZone& operator=(const CpuProfileZone&) = delete;
+    CpuProfileZone(CpuProfileZone&&) = delete;
+    CpuProfileZone& operator=(CpuProfileZone&&) = delete;
+
+private:
+    const char* m_name = nullptr;
+    int64_t m_beginTicks = 0;
+#if GAMEOVERLAY_ALLOCATION_TRACKING
+    const char* m_allocationName = nullptr;
+    AllocationZoneMark m_allocationMark;
+#endif
+};
+
+// Tracy build mode (GAMEOVERLAY_ENABLE_TRACY): the same macros also feed Tracy, and mutexes
+// declared with PROFILE_MUTEX (locked through ProfiledMutex) report contention. Tracy allows
+// one PROFILE_ZONE per scope.
+#if GAMEOVERLAY_ENABLE_TRACY
+#include <tracy/Tracy.hpp>
+#define GAMEOVERLAY_TRACY_ZONE(name) ZoneScopedN(name)
+#define GAMEOVERLAY_TRACY_EVENT(name) TracyMessageL(name)
+#define GAMEOVERLAY_TRACY_FRAME() FrameMark
+#define GAMEOVERLAY_TRACY_THREAD(name) tracy::SetThreadName(name)
+#define PROFILE_MUTEX(var, name) TracyLockableN(std::mutex, var, name)
+using ProfiledMutex = LockableBase(std::mutex);
+using ProfiledConditionVariable = std::condition_variable_any; // Waits on the Lockable wrapper
+#else
+#define GAMEOVERLAY_TRACY_ZONE(name)
+#define GAMEOVERLAY_TRACY_EVENT(name)
+#define GAMEOVERLAY_TRACY_FRAME()
+#define GAMEOVERLAY_TRACY_THREAD(name)
+#define PROFILE_MUTEX(var, name) std::mutex var
+using ProfiledMutex = std::mutex;
+using ProfiledConditionVariable = std::condition_variable;
+#endif
+
+#if GAMEOVERLAY_CPU_PROFILER
+#define GAMEOVERLAY_PROFILE_CONCAT_INNER(a, b) a##b
+#define GAMEOVERLAY_PROFILE_CONCAT(a, b) GAMEOVERLAY_PROFILE_CONCAT_INNER(a, b)
+#define GAMEOVERLAY_CPU_ZONE(name) CpuProfileZone GAMEOVERLAY_PROFILE_CONCAT(profileZone_, __LINE__)(name);
+#define GAMEOVERLAY_CPU_EVENT(name) if (CpuProfiler::IsEnabled()) CpuProfiler::RecordInstant(name);
+#define GAMEOVERLAY_CPU_FRAME() CpuProfiler::MarkFrame();
+#define GAMEOVERLAY_CPU_THREAD(name) CpuProfiler::SetThreadName(name);
+#else
+#define GAMEOVERLAY_CPU_ZONE(name)
+#define GAMEOVERLAY_CPU_EVENT(name)
+#define GAMEOVERLAY_CPU_FRAME()
+#define GAMEOVERLAY_CPU_THREAD(name)
+#endif
+
+// Names must be string literals (only the pointer is stored)
+#define PROFILE_ZONE(name) GAMEOVERLAY_CPU_ZONE(name) GAMEOVERLAY_TRACY_ZONE(name)
+#define PROFILE_EVENT(name) do { GAMEOVERLAY_CPU_EVENT(name) GAMEOVERLAY_TRACY_EVENT(name); } while (0)
+#define PROFILE_FRAME() do { GAMEOVERLAY_CPU_FRAME() GAMEOVERLAY_TRACY_FRAME(); } while (0)
+#define PROFILE_THREAD(name) do { GAMEOVERLAY_CPU_THREAD(name) GAMEOVERLAY_TRACY_THREAD(name); } while (0)
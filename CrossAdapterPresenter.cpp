@@ -0,0 +1,195 @@
+// GameOverlay - CrossAdapterPresenter.cpp
+// Explicit cross-adapter presentation: render on one GPU, present on the one driving the display
+
+#include "CrossAdapterPresenter.h"
+#include "Log.h"
+
+namespace {
+
+bool SupportsCrossAdapterRowMajorTextures(ID3D12Device* device) {
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+    return SUCCEEDED(device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options))) &&
+        options.CrossAdapterRowMajorTextureSupported;
+}
+
+} // namespace
+
+CrossAdapterPresenter::CrossAdapterPresenter(ID3D12Device* renderDevice, IDXGIAdapter1* displayAdapter)
+    : m_renderDevice(renderDevice) {
+    DXGI_ADAPTER_DESC1 adapterDesc = {};
+    if (SUCCEEDED(displayAdapter->GetDesc1(&adapterDesc))) {
+        m_displayAdapterName = adapterDesc.Description;
+    }
+
+    HRESULT hr = D3D12CreateDevice(displayAdapter, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&m_displayDevice));
+    if (FAILED(hr)) {
+        LOG_WARNING("Cross-adapter present: no D3D12 device on the display adapter");
+        return;
+    }
+    if (!SupportsCrossAdapterRowMajorTextures(m_renderDevice.Get()) ||
+        !SupportsCrossAdapterRowMajorTextures(m_displayDevice.Get())) {
+        LOG_INFO("Cross-adapter present: row-major cross-adapter textures unsupported, DXGI copies instead");
+        return;
+    }
+
+    // One fence per signalling queue, each owned by that queue's device
+    bool shared = CreateSharedFence(m_renderDevice.Get(), m_displayDevice.Get(), m_drawnFence, m_drawnFenceOnDisplay) &&
+        CreateSharedFence(m_displayDevice.Get(), m_renderDevice.Get(), m_copiedFence, m_copiedFenceOnRender);
+    m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!shared || !m_fenceEvent) {
+        LOG_WARNING("Cross-adapter present: failed to share the fences");
+        return;
+    }
+
+    hr = m_displayDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_copyAllocator));
+    if (FAILED(hr)) {
+        LOG_WARNING("Cross-adapter present: failed to create the copy allocator");
+        return;
+    }
+
+    // Swap chains take a direct queue; it only ever runs the copies
+    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+    queueDesc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_HIGH;
+    hr = m_displayDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_presentQueue));
+    if (FAILED(hr)) {
+        LOG_WARNING("Cross-adapter present: failed to create the present queue");
+        return;
+    }
+    m_presentQueue->SetName(L"Cross-Adapter Present Queue");
+}
+
+CrossAdapterPresenter::~CrossAdapterPresenter() {
+    ReleaseBuffers();
+    if (m_fenceEvent) {
+        CloseHandle(m_fenceEvent);
+        m_fenceEvent = nullptr;
+    }
+}
+
+bool CrossAdapterPresenter::CreateSharedFence(ID3D12Device* owner, ID3D12Device* other,
+    ComPtr<ID3D12Fence>& ownerFence, ComPtr<ID3D12Fence>& otherFence) {
+    HANDLE fenceHandle = nullptr;
+    HRESULT hr = owner->CreateFence(0, D3D12_FENCE_FLAG_SHARED | D3D12_FENCE_FLAG_SHARED_CROSS_ADAPTER,
+        IID_PPV_ARGS(&ownerFence));
+    if (SUCCEEDED(hr)) hr = owner->CreateSharedHandle(ownerFence.Get(), nullptr, GENERIC_ALL, nullptr, &fenceHandle);
+    if (SUCCEEDED(hr)) hr = other->OpenSharedHandle(fenceHandle, IID_PPV_ARGS(&otherFence));
+    if (fenceHandle) CloseHandle(fenceHandle);
+    return SUCCEEDED(hr);
+}
+
+// The last copy submitted is the last work on the display queue
+void CrossAdapterPresenter::WaitForDisplayQueue() {
+    if (!m_presentQueue || m_copiedFence->GetCompletedValue() >= m_copiedFenceValue) return;
+    if (SUCCEEDED(m_copiedFence->SetEventOnCompletion(m_copiedFenceValue, m_fenceEvent))) {
+        WaitForSingleObject(m_fenceEvent, INFINITE);
+    }
+}
+
+bool CrossAdapterPresenter::CreateBuffers(IDXGISwapChain3* swapChain, UINT bufferCount,
+    ComPtr<ID3D12Resource>* renderTargets) {
+    if (!IsAvailable() || bufferCount > MAX_BUFFERS) return false;
+    ReleaseBuffers();
+
+    DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
+    swapChain->GetDesc1(&swapChainDesc);
+
+    // Row-major: the layout both adapters agree on without knowing each other's tiling
+    D3D12_RESOURCE_DESC desc = {};
+    desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    desc.Width = swapChainDesc.Width;
+    desc.Height = swapChainDesc.Height;
+    desc.DepthOrArraySize = 1;
+    desc.MipLevels = 1;
+    desc.Format = swapChainDesc.Format;
+    desc.SampleDesc.Count = 1;
+    desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+    desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_CROSS_ADAPTER | D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+
+    for (UINT i = 0; i < bufferCount; i++) {
+        Buffer& buffer = m_buffers[i];
+        if (FAILED(swapChain->GetBuffer(i, IID_PPV_ARGS(&buffer.backBuffer))) || !CreateBuffer(buffer, desc)) {
+            LOG_WARNING("Cross-adapter present: failed to create buffer %u", i);
+            m_bufferCount = i + 1;
+            ReleaseBuffers();
+            return false;
+        }
+        renderTargets[i] = buffer.renderTexture;
+    }
+    m_bufferCount = bufferCount;
+    return true;
+}
+
+bool CrossAdapterPresenter::CreateBuffer(Buffer& buffer, const D3D12_RESOURCE_DESC& desc) {
+    D3D12_RESOURCE_ALLOCATION_INFO allocation = m_renderDevice->GetResourceAllocationInfo(0, 1, &desc);
+
+    D3D12_HEAP_DESC heapDesc = {};
+    heapDesc.SizeInBytes = allocation.SizeInBytes;
+    heapDesc.Alignment = allocation.Alignment;
+    heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+    heapDesc.Flags = D3D12_HEAP_FLAG_SHARED | D3D12_HEAP_FLAG_SHARED_CROSS_ADAPTER;
+
+    HANDLE heapHandle = nullptr;
+    HRESULT hr = m_renderDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(&buffer.renderHeap));
+    if (SUCCEEDED(hr)) hr = m_renderDevice->CreateSharedHandle(buffer.renderHeap.Get(), nullptr, GENERIC_ALL, nullptr, &heapHandle);
+    if (SUCCEEDED(hr)) hr = m_displayDevice->OpenSharedHandle(heapHandle, IID_PPV_ARGS(&buffer.displayHeap));
+    if (heapHandle) CloseHandle(heapHandle);
+    if (FAILED(hr)) return false;
+
+    // Each device keeps its own state for the texture: drawn into on one, only copied from on the other
+    hr = m_renderDevice->CreatePlacedResource(buffer.renderHeap.Get(), 0, &desc, D3D12_RESOURCE_STATE_COMMON,
+        nullptr, IID_PPV_ARGS(&buffer.renderTexture));
+    if (SUCCEEDED(hr)) {
+        hr = m_displayDevice->CreatePlacedResource(buffer.displayHeap.Get(), 0, &desc, D3D12_RESOURCE_STATE_COPY_SOURCE,
+            nullptr, IID_PPV_ARGS(&buffer.displayTexture));
+    }
+    if (FAILED(hr)) return false;
+    buffer.renderTexture->SetName(L"Cross-Adapter Render Target");
+
+    hr = m_displayDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_copyAllocator.Get(), nullptr,
+        IID_PPV_ARGS(&buffer.copyList));
+    if (FAILED(hr)) return false;
+
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Transition.pResource = buffer.backBuffer.Get();
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
+    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+    buffer.copyList->ResourceBarrier(1, &barrier);
+    buffer.copyList->CopyResource(buffer.backBuffer.Get(), buffer.displayTexture.Get());
+    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
+    buffer.copyList->ResourceBarrier(1, &barrier);
+    return SUCCEEDED(buffer.copyList->Close());
+}
+
+void CrossAdapterPresenter::ReleaseBuffers() {
+    WaitForDisplayQueue();
+    for (UINT i = 0; i < m_bufferCount; i++) {
+        m_buffers[i] = Buffer();
+    }
+    m_bufferCount = 0;
+    if (m_copyAllocator) m_copyAllocator->Reset(); // The lists recorded into it are gone
+}
+
+void CrossAdapterPresenter::WaitForBuffer(ID3D12CommandQueue* renderQueue, UINT bufferIndex) {
+    if (bufferIndex >= m_bufferCount) return;
+    const UINT64 copiedFenceValue = m_buffers[bufferIndex].copiedFenceValue;
+    if (copiedFenceValue > m_copiedFenceOnRender->GetCompletedValue()) {
+        renderQueue->Wait(m_copiedFenceOnRender.Get(), copiedFenceValue);
+    }
+}
+
+void CrossAdapterPresenter::SubmitCopy(ID3D12CommandQueue* renderQueue, UINT bufferIndex) {
+    if (bufferIndex >= m_bufferCount) return;
+    Buffer& buffer = m_buffers[bufferIndex];
+
+    // The frame is drawn, the display adapter copies it, then the buffer is free to draw again
+    renderQueue->Signal(m_drawnFence.Get(), ++m_drawnFenceValue);
+    m_presentQueue->Wait(m_drawnFenceOnDisplay.Get(), m_drawnFenceValue);
+    ID3D12CommandList* lists[] = { buffer.copyList.Get() };
+    m_presentQueue->ExecuteCommandLists(1, lists);
+    m_presentQueue->Signal(m_copiedFence.Get(), ++m_copiedFenceValue);
+    buffer.copiedFenceValue = m_copiedFenceValue;
+}
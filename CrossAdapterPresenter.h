@@ -0,0 +1,88 @@
+// GameOverlay - CrossAdapterPresenter.h
+// Explicit cross-adapter presentation: render on one GPU, present on the one driving the display
+
+#pragma once
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <dxgi1_6.h>
+#include <wrl/client.h>
+#include <string>
+
+using Microsoft::WRL::ComPtr;
+
+// The overlay prefers the low-power GPU, but the window may sit on a monitor wired to the other
+// one (a desktop iGPU rendering for a dGPU-connected display, a laptop with an external monitor on
+// the dGPU). Presenting from the wrong adapter makes DXGI copy every frame implicitly, with its own
+// synchronization on both GPUs. Here the swap chain lives on the display adapter instead: the
+// render device draws straight into row-major textures in cross-adapter heaps, and the display
+// adapter runs one copy per frame into its back buffer, ordered by a cross-adapter fence.
+//
+// The render queue signals the drawn fence after each frame and the display queue waits for it on
+// the GPU; the display queue signals the copied fence once its copy is done, and the render queue
+// waits for that before drawing into the same buffer again. Each fence has one signalling queue and
+// its own counter. Neither CPU waits outside of resize and shutdown.
+class CrossAdapterPresenter {
+public:
+    CrossAdapterPresenter(ID3D12Device* renderDevice, IDXGIAdapter1* displayAdapter);
+    ~CrossAdapterPresenter();
+
+    // Disable copy and move
+    CrossAdapterPresenter(const CrossAdapterPresenter&) = delete;
+    CrossAdapterPresenter& operator=(const CrossAdapterPresenter&) = delete;
+    CrossAdapterPresenter(CrossAdapterPresenter&&) = delete;
+    CrossAdapterPresenter& operator=(CrossAdapterPresenter&&) = delete;
+
+    // False when either device lacks cross-adapter row-major textures or setup failed
+    bool IsAvailable() const { return m_presentQueue != nullptr; }
+    ID3D12CommandQueue* GetPresentQueue() const { return m_presentQueue.Get(); } // For the swap chain
+    const std::wstring& GetDisplayAdapterName() const { return m_displayAdapterName; }
+
+    // After the swap chain's buffers are (re)created: fills renderTargets, one per back buffer, with
+    // the render device's side of the shared textures (COMMON, usable as render targets)
+    bool CreateBuffers(IDXGISwapChain3* swapChain, UINT bufferCount, ComPtr<ID3D12Resource>* renderTargets);
+    void ReleaseBuffers(); // Before ResizeBuffers; waits for the display queue
+
+    // The frame drawing into bufferIndex: WaitForBuffer before its lists execute, SubmitCopy after
+    // them and before Present
+    void WaitForBuffer(ID3D12CommandQueue* renderQueue, UINT bufferIndex);
+    void SubmitCopy(ID3D12CommandQueue* renderQueue, UINT bufferIndex);
+
+private:
+    static constexpr UINT MAX_BUFFERS = 4;
+
+    struct Buffer {
+        ComPtr<ID3D12Heap> renderHeap;
+        ComPtr<ID3D12Heap> displayHeap;
+        ComPtr<ID3D12Resource> renderTexture;  // Render device, drawn into
+        ComPtr<ID3D12Resource> displayTexture; // Display device, copied from
+        ComPtr<ID3D12Resource> backBuffer;
+        ComPtr<ID3D12GraphicsCommandList> copyList; // Recorded once per buffer, executed every frame
+        UINT64 copiedFenceValue = 0; // The display copy out of this buffer is done at this copied fence value
+    };
+
+    bool CreateBuffer(Buffer& buffer, const D3D12_RESOURCE_DESC& desc);
+    // Created on owner, opened on other: the owner's queue signals it, the other's waits
+    static bool CreateSharedFence(ID3D12Device* owner, ID3D12Device* other, ComPtr<ID3D12Fence>& ownerFence,
+        ComPtr<ID3D12Fence>& otherFence);
+    void WaitForDisplayQueue();
+
+    ComPtr<ID3D12Device> m_renderDevice;
+    ComPtr<ID3D12Device> m_displayDevice;
+    ComPtr<ID3D12CommandQueue> m_presentQueue;
+    ComPtr<ID3D12CommandAllocator> m_copyAllocator;
+    std::wstring m_displayAdapterName;
+
+    // Present complete: the render queue finished a frame (signalled on the render device)
+    ComPtr<ID3D12Fence> m_drawnFence;          // Render device
+    ComPtr<ID3D12Fence> m_drawnFenceOnDisplay; // Display device, waited on
+    UINT64 m_drawnFenceValue = 0;
+    // Copy complete: the display queue copied a frame out (signalled on the display device)
+    ComPtr<ID3D12Fence> m_copiedFence;         // Display device
+    ComPtr<ID3D12Fence> m_copiedFenceOnRender; // Render device, waited on
+    UINT64 m_copiedFenceValue = 0;
+    HANDLE m_fenceEvent = nullptr;
+
+    Buffer m_buffers[MAX_BUFFERS];
+    UINT m_bufferCount = 0;
+};
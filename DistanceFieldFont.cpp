@@ -0,0 +1,139 @@
+// GameOverlay - DistanceFieldFont.cpp
+// Signed distance field glyphs: one bake of a font serves ImGui fonts of every size
+
+#include "DistanceFieldFont.h"
+#include "imgui_internal.h" // ImFontAtlasCustomRect, IM_ROUND
+#include <cstdio>
+#include <cstring>
+
+// Our own copy of ImGui's stb_truetype (its copy is static to imgui_draw.cpp)
+#define STBTT_malloc(x,u)   ((void)(u), IM_ALLOC(x))
+#define STBTT_free(x,u)     ((void)(u), IM_FREE(x))
+#define STBTT_assert(x)     do { IM_ASSERT(x); } while(0)
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "imstb_truetype.h"
+
+namespace {
+
+constexpr unsigned char ON_EDGE_VALUE = 128;
+constexpr float DISTANCE_SCALE = static_cast<float>(ON_EDGE_VALUE) / DistanceFieldFont::PADDING; // 0 at PADDING texels outside
+
+} // namespace
+
+DistanceFieldFont::DistanceFieldFont() = default;
+DistanceFieldFont::~DistanceFieldFont() = default;
+
+bool DistanceFieldFont::Load(const char* path) {
+    m_info.reset();
+    m_fontData.clear();
+
+    FILE* file = nullptr;
+    if (fopen_s(&file, path, "rb") != 0 || !file) return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size > 0) {
+        m_fontData.resize(static_cast<size_t>(size));
+        if (fread(m_fontData.data(), 1, m_fontData.size(), file) != m_fontData.size()) m_fontData.clear();
+    }
+    fclose(file);
+    if (m_fontData.empty()) return false;
+
+    auto info = std::make_unique<stbtt_fontinfo>();
+    const int offset = stbtt_GetFontOffsetForIndex(m_fontData.data(), 0);
+    if (offset < 0 || !stbtt_InitFont(info.get(), m_fontData.data(), offset)) {
+        m_fontData.clear();
+        return false;
+    }
+    m_bakeScale = stbtt_ScaleForPixelHeight(info.get(), BAKE_SIZE); // As ImGui scales a font of that size
+    m_info = std::move(info);
+    return true;
+}
+
+void DistanceFieldFont::AddFonts(ImFontAtlas* atlas, const float* sizes, int sizeCount, const ImWchar* ranges) {
+    m_glyphs.clear();
+    m_fonts.clear();
+    if (!m_info) return;
+
+    // ImGui bakes the space, which gives each font its metrics, tab and whitespace as a bitmap font's
+    static const ImWchar spaceRange[] = { 0x0020, 0x0020, 0 };
+    for (int i = 0; i < sizeCount; i++) {
+        ImFontConfig config;
+        config.FontDataOwnedByAtlas = false;
+        m_fonts.push_back(atlas->AddFontFromMemoryTTF(m_fontData.data(), static_cast<int>(m_fontData.size()),
+            sizes[i], &config, spaceRange));
+    }
+
+    // One field per glyph for all of them; its size is known from the outline's box without baking it
+    for (const ImWchar* range = ranges; range && range[0]; range += 2) {
+        for (unsigned int codepoint = range[0]; codepoint <= range[1]; codepoint++) {
+            if (codepoint == 0x0020) continue;
+            const int glyphIndex = stbtt_FindGlyphIndex(m_info.get(), static_cast<int>(codepoint));
+            if (glyphIndex == 0) continue;
+
+            Glyph glyph;
+            glyph.codepoint = static_cast<ImWchar>(codepoint);
+            glyph.glyphIndex = glyphIndex;
+            int advance = 0, leftSideBearing = 0;
+            stbtt_GetGlyphHMetrics(m_info.get(), glyphIndex, &advance, &leftSideBearing);
+            glyph.advanceX = advance * m_bakeScale;
+
+            int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+            stbtt_GetGlyphBitmapBoxSubpixel(m_info.get(), glyphIndex, m_bakeScale, m_bakeScale, 0.0f, 0.0f, &x0, &y0, &x1, &y1);
+            if (x0 != x1 && y0 != y1) {
+                // The same box stbtt_GetGlyphSDF bakes into
+                glyph.width = x1 - x0 + PADDING * 2;
+                glyph.height = y1 - y0 + PADDING * 2;
+                glyph.offsetX = x0 - PADDING;
+                glyph.offsetY = y0 - PADDING;
+                glyph.rectId = atlas->AddCustomRectRegular(glyph.width, glyph.height);
+            }
+            m_glyphs.push_back(glyph);
+        }
+    }
+}
+
+void DistanceFieldFont::WriteGlyphs(ImFontAtlas* atlas) {
+    if (!m_info || m_fonts.empty() || !atlas->TexPixelsAlpha8) return;
+
+    for (const Glyph& glyph : m_glyphs) {
+        if (glyph.rectId < 0) continue;
+        const ImFontAtlasCustomRect* rect = atlas->GetCustomRectByIndex(glyph.rectId);
+        int width = 0, height = 0, offsetX = 0, offsetY = 0;
+        unsigned char* field = stbtt_GetGlyphSDF(m_info.get(), m_bakeScale, glyph.glyphIndex, PADDING, ON_EDGE_VALUE,
+            DISTANCE_SCALE, &width, &height, &offsetX, &offsetY);
+        if (!field) continue;
+        const int copyWidth = ImMin(width, static_cast<int>(rect->Width));
+        const int copyHeight = ImMin(height, static_cast<int>(rect->Height));
+        for (int y = 0; y < copyHeight; y++) {
+            memcpy(atlas->TexPixelsAlpha8 + (rect->Y + y) * atlas->TexWidth + rect->X, field + y * width, copyWidth);
+        }
+        stbtt_FreeSDF(field, nullptr);
+    }
+
+    for (ImFont* font : m_fonts) {
+        // Quads at the font's size; Y from the top of the line as ImGui places its own glyphs
+        const float scale = font->FontSize / BAKE_SIZE;
+        const float baseline = IM_ROUND(font->Ascent);
+        if (!font->Glyphs.empty() && font->Glyphs.back().Codepoint == '\t') {
+            font->Glyphs.pop_back(); // BuildLookupTable adds it back at the end
+        }
+        for (const Glyph& glyph : m_glyphs) {
+            ImVec2 uv0(0.0f, 0.0f), uv1(0.0f, 0.0f);
+            float x0 = 0.0f, y0 = 0.0f, x1 = 0.0f, y1 = 0.0f; // Empty: not visible, advance only
+            if (glyph.rectId >= 0) {
+                atlas->CalcCustomRectUV(atlas->GetCustomRectByIndex(glyph.rectId), &uv0, &uv1);
+                uv0.x += UV_OFFSET;
+                uv1.x += UV_OFFSET;
+                x0 = glyph.offsetX * scale;
+                y0 = glyph.offsetY * scale + baseline;
+                x1 = (glyph.offsetX + glyph.width) * scale;
+                y1 = (glyph.offsetY + glyph.height) * scale + baseline;
+            }
+            font->AddGlyph(nullptr, glyph.codepoint, x0, y0, x1, y1, uv0.x, uv0.y, uv1.x, uv1.y, glyph.advanceX * scale);
+        }
+        font->FallbackChar = static_cast<ImWchar>(IM_UNICODE_CODEPOINT_INVALID); // Chosen again from the new glyphs
+        font->BuildLookupTable();
+    }
+}
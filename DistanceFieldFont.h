@@ -0,0 +1,68 @@
+// GameOverlay - DistanceFieldFont.h
+// Signed distance field glyphs: one bake of a font serves ImGui fonts of every size
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "imgui.h"
+
+struct stbtt_fontinfo;
+
+// Bitmap fonts are rasterized once per size (and again per DPI scale), each size a full set of
+// glyphs in the atlas. Here the font's glyphs are baked once, at BAKE_SIZE, as distance fields:
+// every texel holds its distance to the outline, 0.5 on the edge. Fonts of any size share those
+// rects; their glyphs only differ in the quads' size, and the ImGui pixel shaders resolve the edge
+// at whatever scale it is drawn (fwidth of the distance is the antialiasing width).
+//
+// The atlas stays a single ImGui atlas: the glyphs' U coordinates are moved up by UV_OFFSET, which
+// tells the pixel shaders to resolve the field; everything else (the white pixel, baked lines,
+// bitmap fonts, images) samples as before. Single channel: corners round off slightly at large
+// sizes, which the UI's text sizes don't reach.
+class DistanceFieldFont {
+public:
+    static constexpr float BAKE_SIZE = 24.0f;  // Pixel height of the bake
+    static constexpr int PADDING = 3;          // Texels of field around each glyph, the resolvable distance
+    static constexpr float UV_OFFSET = 2.0f;   // Added to glyph U coordinates (see the ImGui pixel shaders)
+
+    struct Glyph {
+        ImWchar codepoint = 0;
+        int glyphIndex = 0;
+        int rectId = -1;    // Custom rect in the atlas; -1 for empty glyphs (spaces)
+        int width = 0;      // Field size in texels, padding included
+        int height = 0;
+        int offsetX = 0;    // Of the field's top left from the pen position on the baseline, at BAKE_SIZE
+        int offsetY = 0;
+        float advanceX = 0.0f;
+    };
+
+    DistanceFieldFont();
+    ~DistanceFieldFont();
+
+    // Disable copy and move
+    DistanceFieldFont(const DistanceFieldFont&) = delete;
+    DistanceFieldFont& operator=(const DistanceFieldFont&) = delete;
+    DistanceFieldFont(DistanceFieldFont&&) = delete;
+    DistanceFieldFont& operator=(DistanceFieldFont&&) = delete;
+
+    // False when the file can't be read or isn't a font
+    bool Load(const char* path);
+    bool IsLoaded() const { return m_info != nullptr; }
+
+    // Before the atlas builds: adds one font per size (ImGui itself only bakes their space glyph)
+    // and a custom rect for each glyph of ranges the font has. ranges must outlive the build.
+    void AddFonts(ImFontAtlas* atlas, const float* sizes, int sizeCount, const ImWchar* ranges);
+    // After the atlas built (not after restoring it from a cache, which has both already): writes
+    // the fields into its alpha texture and gives every added font the glyphs, scaled to its size
+    void WriteGlyphs(ImFontAtlas* atlas);
+
+    const std::vector<Glyph>& GetGlyphs() const { return m_glyphs; } // Of the last AddFonts
+
+private:
+    std::vector<unsigned char> m_fontData; // Also what the atlas reads; not owned by it
+    std::unique_ptr<stbtt_fontinfo> m_info;
+    float m_bakeScale = 0.0f;
+    std::vector<Glyph> m_glyphs;
+    std::vector<ImFont*> m_fonts;
+};
@@ -0,0 +1,45 @@
+// GameOverlay - FileUtil.cpp
+// File helpers shared by everything that persists to disk
+
+#include "FileUtil.h"
+#include <Windows.h>
+#include <fstream>
+
+std::string GetAppDataDirectory() {
+    char localAppData[MAX_PATH];
+    DWORD length = GetEnvironmentVariableA("LOCALAPPDATA", localAppData, MAX_PATH);
+    if (length == 0 || length >= MAX_PATH) {
+        return std::string();
+    }
+    std::string directory = std::string(localAppData) + "\\GameOverlay";
+    CreateDirectoryA(directory.c_str(), nullptr);
+    return directory;
+}
+
+bool WriteFileAtomic(const std::string& path, const void* data, size_t size) {
+    return WriteFileAtomic(path, [data, size](std::ostream& file) {
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        return true;
+    });
+}
+
+bool WriteFileAtomic(const std::string& path, const std::function<bool(std::ostream&)>& write) {
+    size_t separator = path.find_last_of('\\');
+    if (separator != std::string::npos) {
+        CreateDirectoryA(path.substr(0, separator).c_str(), nullptr);
+    }
+
+    std::string tempPath = path + ".tmp";
+    bool written = false;
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        written = file && write(file);
+        file.close();
+        written = written && !file.fail();
+    }
+    if (!written || !MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileA(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,18 @@
+// GameOverlay - FileUtil.h
+// File helpers shared by everything that persists to disk
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+
+// %LOCALAPPDATA%\GameOverlay, created when missing; empty without a profile directory
+std::string GetAppDataDirectory();
+
+// Writes path through path.tmp moved over the old file, so a crash leaves either the old or the new
+// contents. Creates path's directory; the temporary never outlives a failed write.
+bool WriteFileAtomic(const std::string& path, const void* data, size_t size);
+// write fills the open file; returning false (or any failed write) abandons it
+bool WriteFileAtomic(const std::string& path, const std::function<bool(std::ostream&)>& write);
@@ -0,0 +1,86 @@
+// GameOverlay - FrameArena.cpp
+// Per-frame linear allocator for transient UI strings and formatting
+
+#include "FrameArena.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+FrameArena::FrameArena(size_t blockSize)
+    : m_blockSize(std::max<size_t>(blockSize, 256)) {
+    AddBlock(m_blockSize);
+}
+
+FrameArena& FrameArena::ForThread() {
+    thread_local FrameArena arena;
+    return arena;
+}
+
+void FrameArena::AddBlock(size_t minimumSize) {
+    Block block;
+    block.size = std::max(minimumSize, m_blockSize);
+    block.data = std::make_unique<char[]>(block.size);
+    if (!m_blocks.empty()) m_retiredBytes += m_used;
+    m_blocks.push_back(std::move(block));
+    m_used = 0;
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment) {
+    Block& block = m_blocks.back();
+    size_t offset = (m_used + alignment - 1) & ~(alignment - 1);
+    if (offset + size > block.size) {
+        AddBlock(size + alignment);
+        return Allocate(size, alignment);
+    }
+    m_used = offset + size;
+    return block.data.get() + offset;
+}
+
+const char* FrameArena::Copy(std::string_view text) {
+    char* copy = static_cast<char*>(Allocate(text.size() + 1, 1));
+    memcpy(copy, text.data(), text.size());
+    copy[text.size()] = '\0';
+    return copy;
+}
+
+const char* FrameArena::Format(const char* format, ...) {
+    // Straight into the current block when it fits, which is nearly always
+    Block& block = m_blocks.back();
+    char* target = block.data.get() + m_used;
+    size_t available = block.size - m_used;
+
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(target, available, format, args);
+    va_end(args);
+    if (length < 0) return "";
+    if (static_cast<size_t>(length) < available) {
+        m_used += static_cast<size_t>(length) + 1;
+        return target;
+    }
+
+    char* copy = static_cast<char*>(Allocate(static_cast<size_t>(length) + 1, 1));
+    va_start(args, format);
+    vsnprintf(copy, static_cast<size_t>(length) + 1, format, args);
+    va_end(args);
+    return copy;
+}
+
+void FrameArena::Reset() {
+    if (m_blocks.size() > 1) {
+        // Everything last frame needed, in one block
+        size_t total = GetCapacity();
+        m_blocks.clear();
+        m_retiredBytes = 0;
+        AddBlock(total);
+    }
+    m_used = 0;
+    m_retiredBytes = 0;
+}
+
+size_t FrameArena::GetCapacity() const {
+    size_t capacity = 0;
+    for (const Block& block : m_blocks) capacity += block.size;
+    return capacity;
+}
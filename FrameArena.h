@@ -0,0 +1,52 @@
+// GameOverlay - FrameArena.h
+// Per-frame linear allocator for transient UI strings and formatting
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Bump allocation out of large blocks, all of it released at once by Reset at the start of the
+// next frame: labels, tooltips and formatted text built while the UI is recorded cost a pointer
+// bump instead of a heap allocation. A frame that outgrows the blocks adds one; Reset then merges
+// them into a single block of the combined size, so a steady UI settles on one block and stops
+// allocating. Pointers handed out are valid until the next Reset.
+// One arena per thread (ForThread); the UI thread resets its own in UISystem::Render.
+class FrameArena {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    explicit FrameArena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+    // Disable copy and move
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+    FrameArena(FrameArena&&) = delete;
+    FrameArena& operator=(FrameArena&&) = delete;
+
+    static FrameArena& ForThread();
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    // NUL-terminated copies and printf formatting, valid until Reset
+    const char* Copy(std::string_view text);
+    const char* Format(const char* format, ...);
+    void Reset();
+
+    size_t GetUsedBytes() const { return m_used + m_retiredBytes; }
+    size_t GetCapacity() const;
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+    };
+
+    void AddBlock(size_t minimumSize);
+
+    std::vector<Block> m_blocks; // The last one is current
+    size_t m_used = 0;           // In the current block
+    size_t m_retiredBytes = 0;   // Used in the earlier blocks this frame
+    size_t m_blockSize;
+};
@@ -0,0 +1,284 @@
+// GameOverlay - FrameReadback.cpp
+// Asynchronous readback of the composed overlay frame for screenshots
+
+#include "FrameReadback.h"
+#include "RenderSystem.h"
+#include "Log.h"
+#include "FileUtil.h"
+#include <wincodec.h>
+#include <DirectXPackedVector.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+FrameReadback::FrameReadback(RenderSystem* renderSystem)
+    : m_renderSystem(renderSystem), m_resourceManager(renderSystem->GetResourceManager()),
+    m_premultipliedAlpha(renderSystem->UsesComposition()) {
+}
+
+FrameReadback::~FrameReadback() {
+    m_encodeJobs.Wait(); // Jobs map the buffers
+    for (Slot& slot : m_slots) {
+        if (slot.buffer && m_resourceManager) m_resourceManager->RetireResource(std::move(slot.buffer));
+    }
+}
+
+FrameReadback::Slot* FrameReadback::FindFreeSlot() {
+    for (Slot& slot : m_slots) {
+        if (slot.state.load(std::memory_order_acquire) == SlotState::Free) return &slot;
+    }
+    return nullptr;
+}
+
+bool FrameReadback::IsCaptureDue() const {
+    if (!m_requested.load(std::memory_order_acquire)) return false;
+    for (const Slot& slot : m_slots) {
+        if (slot.state.load(std::memory_order_acquire) == SlotState::Free) return true;
+    }
+    return false;
+}
+
+void FrameReadback::RecordCopy(ID3D12GraphicsCommandList* commandList, ID3D12Resource* source, UINT64 fenceValue) {
+    Slot* slot = FindFreeSlot();
+    if (!slot || !m_requested.exchange(false, std::memory_order_acq_rel)) return;
+
+    D3D12_RESOURCE_DESC desc = source->GetDesc();
+    if (desc.Format != DXGI_FORMAT_B8G8R8A8_UNORM && desc.Format != DXGI_FORMAT_R8G8B8A8_UNORM &&
+        desc.Format != DXGI_FORMAT_R16G16B16A16_FLOAT) {
+        LOG_WARNING("Screenshot skipped: unsupported back buffer format %d", static_cast<int>(desc.Format));
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_failed++;
+        return;
+    }
+
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {};
+    UINT64 size = 0;
+    m_renderSystem->GetDevice()->GetCopyableFootprints(&desc, 0, 1, 0, &footprint, nullptr, nullptr, &size);
+
+    // A slot keeps its buffer while frames fit; a bigger window replaces it
+    if (slot->buffer && slot->size < size) {
+        m_resourceManager->RetireResource(std::move(slot->buffer));
+        slot->size = 0;
+    }
+    if (!slot->buffer) {
+        try {
+            slot->buffer = m_resourceManager->CreateReadbackBuffer(size);
+            if (!slot->buffer) throw std::runtime_error("CreateReadbackBuffer failed");
+            slot->buffer->SetName(L"Screenshot Readback");
+            slot->size = size;
+        }
+        catch (const std::exception& e) {
+            LOG_WARNING("Failed to create a screenshot readback buffer: %s", e.what());
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_failed++;
+            return;
+        }
+    }
+
+    D3D12_TEXTURE_COPY_LOCATION dst = {};
+    dst.pResource = slot->buffer.Get();
+    dst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    dst.PlacedFootprint = footprint;
+    D3D12_TEXTURE_COPY_LOCATION src = {};
+    src.pResource = source;
+    src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    src.SubresourceIndex = 0;
+    commandList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+    m_resourceManager->NotifyResourceUsed(slot->buffer.Get());
+
+    slot->footprint = footprint;
+    slot->outputScale = m_renderSystem->GetHdrOutputScale();
+    slot->fenceValue = fenceValue;
+    slot->state.store(SlotState::Copying, std::memory_order_release);
+}
+
+void FrameReadback::Poll(UINT64 completedFenceValue) {
+    for (Slot& slot : m_slots) {
+        if (slot.state.load(std::memory_order_acquire) != SlotState::Copying) continue;
+        if (slot.fenceValue > completedFenceValue) continue;
+
+        // Named when the frame was copied rather than when the file is written
+        std::string path = MakeScreenshotPath();
+        if (path.empty()) {
+            LOG_WARNING("No profile directory for screenshots");
+            slot.state.store(SlotState::Free, std::memory_order_release);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_failed++;
+            continue;
+        }
+
+        slot.state.store(SlotState::Encoding, std::memory_order_release);
+        JobDesc job;
+        job.name = "Encode Screenshot";
+        job.priority = JobPriority::Low;
+        job.jobClass = JobClass::Efficiency;
+        job.counter = &m_encodeJobs;
+        Slot* slotPtr = &slot;
+        JobSystem::Get().Submit(job, [this, slotPtr, path]() { Encode(*slotPtr, path); });
+    }
+}
+
+bool FrameReadback::HasPendingCopies() const {
+    if (m_requested.load(std::memory_order_relaxed)) return true;
+    for (const Slot& slot : m_slots) {
+        if (slot.state.load(std::memory_order_relaxed) == SlotState::Copying) return true;
+    }
+    return false;
+}
+
+std::string FrameReadback::GetLastPath() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastPath;
+}
+
+FrameReadback::Stats FrameReadback::GetStats() const {
+    Stats stats;
+    stats.pending = m_requested.load(std::memory_order_relaxed) ? 1 : 0;
+    for (const Slot& slot : m_slots) {
+        if (slot.state.load(std::memory_order_relaxed) != SlotState::Free) stats.pending++;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stats.saved = m_saved;
+    stats.failed = m_failed;
+    return stats;
+}
+
+// --- Encode Job ---
+
+namespace {
+
+// HDR output frames: linear premultiplied scRGB back to straight sRGB, SDR white at 255
+void ConvertScRgbRow(const uint16_t* src, uint8_t* dst, UINT width, float outputScale) {
+    using DirectX::PackedVector::XMConvertHalfToFloat;
+    const float inverseScale = outputScale > 0.0f ? 1.0f / outputScale : 1.0f;
+    for (UINT x = 0; x < width; x++, src += 4, dst += 4) {
+        float alpha = (std::min)((std::max)(XMConvertHalfToFloat(src[3]), 0.0f), 1.0f);
+        float channels[3] = { XMConvertHalfToFloat(src[2]), XMConvertHalfToFloat(src[1]), XMConvertHalfToFloat(src[0]) }; // BGR
+        for (int c = 0; c < 3; c++) {
+            float value = alpha > 0.0f ? channels[c] * inverseScale / alpha : 0.0f;
+            value = (std::min)((std::max)(value, 0.0f), 1.0f);
+            value = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+            dst[c] = static_cast<uint8_t>(value * 255.0f + 0.5f);
+        }
+        dst[3] = static_cast<uint8_t>(alpha * 255.0f + 0.5f);
+    }
+}
+
+} // namespace
+
+void FrameReadback::Encode(Slot& slot, const std::string& path) {
+    const D3D12_SUBRESOURCE_FOOTPRINT& footprint = slot.footprint.Footprint;
+    const UINT width = footprint.Width;
+    const UINT height = footprint.Height;
+    const bool swapRedBlue = footprint.Format == DXGI_FORMAT_R8G8B8A8_UNORM;
+    const bool scRgb = footprint.Format == DXGI_FORMAT_R16G16B16A16_FLOAT;
+
+    // Converted into tightly packed straight-alpha BGRA, so the buffer goes back to the ring
+    // before the (much slower) PNG compression
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+    void* mapped = nullptr;
+    D3D12_RANGE readRange = { 0, static_cast<SIZE_T>(slot.size) };
+    bool mappedOk = SUCCEEDED(slot.buffer->Map(0, &readRange, &mapped));
+    if (mappedOk) {
+        const uint8_t* base = static_cast<const uint8_t*>(mapped) + slot.footprint.Offset;
+        for (UINT y = 0; y < height; y++) {
+            const uint8_t* src = base + static_cast<size_t>(y) * footprint.RowPitch;
+            uint8_t* dst = pixels.data() + static_cast<size_t>(y) * width * 4;
+            if (scRgb) {
+                ConvertScRgbRow(reinterpret_cast<const uint16_t*>(src), dst, width, slot.outputScale);
+                continue;
+            }
+            for (UINT x = 0; x < width; x++, src += 4, dst += 4) {
+                uint8_t b = swapRedBlue ? src[2] : src[0];
+                uint8_t g = src[1];
+                uint8_t r = swapRedBlue ? src[0] : src[2];
+                uint8_t a = src[3];
+                if (!m_premultipliedAlpha) {
+                    a = 255;
+                }
+                else if (a != 0 && a != 255) {
+                    b = static_cast<uint8_t>((std::min)(255u, (b * 255u + a / 2) / a));
+                    g = static_cast<uint8_t>((std::min)(255u, (g * 255u + a / 2) / a));
+                    r = static_cast<uint8_t>((std::min)(255u, (r * 255u + a / 2) / a));
+                }
+                dst[0] = b;
+                dst[1] = g;
+                dst[2] = r;
+                dst[3] = a;
+            }
+        }
+        D3D12_RANGE writeRange = { 0, 0 };
+        slot.buffer->Unmap(0, &writeRange);
+    }
+    slot.state.store(SlotState::Free, std::memory_order_release);
+
+    bool written = mappedOk && WritePng(path, pixels, width, height);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (written) {
+        m_saved++;
+        m_lastPath = path;
+        LOG_INFO("Screenshot saved: %s", path.c_str());
+    }
+    else {
+        m_failed++;
+        LOG_WARNING("Failed to write screenshot: %s", path.c_str());
+    }
+}
+
+bool FrameReadback::WritePng(const std::string& path, const std::vector<uint8_t>& pixels, UINT width, UINT height) {
+    ComPtr<IWICImagingFactory> factory;
+    if (FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory)))) {
+        return false;
+    }
+
+    int length = MultiByteToWideChar(CP_ACP, 0, path.c_str(), -1, nullptr, 0);
+    if (length <= 0) return false;
+    std::wstring widePath(static_cast<size_t>(length), L'\0');
+    MultiByteToWideChar(CP_ACP, 0, path.c_str(), -1, widePath.data(), length);
+
+    ComPtr<IWICStream> stream;
+    ComPtr<IWICBitmapEncoder> encoder;
+    ComPtr<IWICBitmapFrameEncode> frame;
+    HRESULT hr = factory->CreateStream(&stream);
+    if (SUCCEEDED(hr)) hr = stream->InitializeFromFilename(widePath.c_str(), GENERIC_WRITE);
+    if (SUCCEEDED(hr)) hr = factory->CreateEncoder(GUID_ContainerFormatPng, nullptr, &encoder);
+    if (SUCCEEDED(hr)) hr = encoder->Initialize(stream.Get(), WICBitmapEncoderNoCache);
+    if (SUCCEEDED(hr)) hr = encoder->CreateNewFrame(&frame, nullptr);
+    if (SUCCEEDED(hr)) hr = frame->Initialize(nullptr);
+    if (SUCCEEDED(hr)) hr = frame->SetSize(width, height);
+
+    // PNG takes BGRA as is; anything else the encoder asks for isn't what the pixels are
+    WICPixelFormatGUID format = GUID_WICPixelFormat32bppBGRA;
+    if (SUCCEEDED(hr)) hr = frame->SetPixelFormat(&format);
+    if (SUCCEEDED(hr) && format != GUID_WICPixelFormat32bppBGRA) hr = E_FAIL;
+
+    if (SUCCEEDED(hr)) {
+        hr = frame->WritePixels(height, width * 4, static_cast<UINT>(pixels.size()),
+            const_cast<BYTE*>(pixels.data()));
+    }
+    if (SUCCEEDED(hr)) hr = frame->Commit();
+    if (SUCCEEDED(hr)) hr = encoder->Commit();
+    if (FAILED(hr)) {
+        stream.Reset();
+        DeleteFileW(widePath.c_str()); // No half-written files
+        return false;
+    }
+    return true;
+}
+
+std::string FrameReadback::MakeScreenshotPath() {
+    std::string directory = GetAppDataDirectory();
+    if (directory.empty()) {
+        return std::string();
+    }
+    directory += "\\Screenshots";
+    CreateDirectoryA(directory.c_str(), nullptr);
+
+    SYSTEMTIME time;
+    GetLocalTime(&time);
+    char name[64];
+    snprintf(name, sizeof(name), "\\screenshot-%04u%02u%02u-%02u%02u%02u-%03u.png", time.wYear, time.wMonth, time.wDay,
+        time.wHour, time.wMinute, time.wSecond, time.wMilliseconds);
+    return directory + name;
+}
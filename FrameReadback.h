@@ -0,0 +1,94 @@
+// GameOverlay - FrameReadback.h
+// Asynchronous readback of the composed overlay frame for screenshots
+
+#pragma once
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "JobSystem.h"
+
+// Forward declarations
+class RenderSystem;
+class ResourceManager;
+
+using Microsoft::WRL::ComPtr;
+
+// Screenshots without a WaitForGpu. A request marks the next rendered frame: the RenderSystem
+// copies its finished back buffer into a free buffer of a small readback ring on the frame's own
+// command list, Poll sees the frame's fence pass on a later frame (never waiting for it), and a
+// low priority job converts the pixels and encodes the PNG while the buffer goes back to the ring.
+// A request with every buffer still busy waits for the next frame that has one.
+// Files go to %LOCALAPPDATA%\GameOverlay\Screenshots.
+//
+// Only the overlay's own frame can be read: the game's image never passes through this process
+// (the Present hook draws the overlay into the game, not the other way round).
+class FrameReadback {
+public:
+    static constexpr UINT SLOT_COUNT = 3;
+
+    struct Stats {
+        UINT64 saved = 0;
+        UINT64 failed = 0;
+        UINT pending = 0; // Requested, copying or encoding
+    };
+
+    FrameReadback(RenderSystem* renderSystem);
+    ~FrameReadback();
+
+    // Disable copy and move
+    FrameReadback(const FrameReadback&) = delete;
+    FrameReadback& operator=(const FrameReadback&) = delete;
+    FrameReadback(FrameReadback&&) = delete;
+    FrameReadback& operator=(FrameReadback&&) = delete;
+
+    // Any thread; the caller makes sure a frame gets rendered
+    void RequestScreenshot() { m_requested.store(true, std::memory_order_release); }
+
+    // Render thread. IsCaptureDue while declaring the frame graph (a request and a free buffer);
+    // RecordCopy with the back buffer in COPY_SOURCE and the fence value the frame will signal
+    bool IsCaptureDue() const;
+    void RecordCopy(ID3D12GraphicsCommandList* commandList, ID3D12Resource* source, UINT64 fenceValue);
+    // Once per frame: hands copies the GPU has finished to the encode job
+    void Poll(UINT64 completedFenceValue);
+    // A request or a copy Poll hasn't handed on; only later frames move it along
+    bool HasPendingCopies() const;
+
+    std::string GetLastPath() const;
+    Stats GetStats() const;
+
+private:
+    enum class SlotState { Free, Copying, Encoding };
+    struct Slot {
+        ComPtr<ID3D12Resource> buffer;
+        UINT64 size = 0;
+        std::atomic<SlotState> state = SlotState::Free;
+        UINT64 fenceValue = 0;
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {}; // Of the copied frame
+        float outputScale = 1.0f; // scRGB value of SDR white, for HDR output frames
+    };
+
+    Slot* FindFreeSlot();
+    void Encode(Slot& slot, const std::string& path); // Job
+    static bool WritePng(const std::string& path, const std::vector<uint8_t>& pixels, UINT width, UINT height);
+    static std::string MakeScreenshotPath();
+
+    // Resource pointers (not owned)
+    RenderSystem* m_renderSystem = nullptr;
+    ResourceManager* m_resourceManager = nullptr;
+    bool m_premultipliedAlpha = false; // Composition swap chains; otherwise alpha is ignored
+
+    Slot m_slots[SLOT_COUNT];
+    std::atomic<bool> m_requested = false;
+
+    mutable std::mutex m_mutex; // Results, against the encode jobs
+    std::string m_lastPath;
+    UINT64 m_saved = 0;
+    UINT64 m_failed = 0;
+    JobCounter m_encodeJobs;
+};
@@ -0,0 +1,164 @@
+// GameOverlay - FrameTimeHistogram.cpp
+// Rolling log-bucketed frame time histogram with percentiles over fixed windows
+
+#include "FrameTimeHistogram.h"
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+
+const char* GetFrameTimeWindowName(FrameTimeWindow window) {
+    switch (window) {
+    case FrameTimeWindow::OneSecond: return "1 s";
+    case FrameTimeWindow::TenSeconds: return "10 s";
+    case FrameTimeWindow::SixtySeconds: return "60 s";
+    case FrameTimeWindow::Session: return "Session";
+    default: return "Unknown";
+    }
+}
+
+unsigned FrameTimeHistogram::GetBucket(float frameMs) {
+    if (!(frameMs > 0.0f)) return 0;
+    float position = (std::log2(frameMs) - MIN_OCTAVE) * BUCKETS_PER_OCTAVE;
+    if (position <= 0.0f) return 0;
+    return std::min(static_cast<unsigned>(position), BUCKET_COUNT - 1);
+}
+
+float FrameTimeHistogram::GetBucketUpperMs(unsigned bucket) {
+    return std::exp2(MIN_OCTAVE + static_cast<float>(bucket + 1) / BUCKETS_PER_OCTAVE);
+}
+
+void FrameTimeHistogram::AddFrame(float frameMs, std::chrono::steady_clock::time_point now) {
+    if (!m_started) {
+        m_started = true;
+        m_sliceStart = now;
+    }
+
+    // Idle gaps (render on demand) roll several slices at once; a minute clears every window
+    unsigned elapsedSeconds = 0;
+    while (now - m_sliceStart >= std::chrono::seconds(1) && elapsedSeconds < SLICE_COUNT) {
+        AdvanceSlice();
+        m_sliceStart += std::chrono::seconds(1);
+        elapsedSeconds++;
+    }
+    if (now - m_sliceStart >= std::chrono::seconds(1)) {
+        m_sliceStart = now;
+    }
+
+    unsigned bucket = GetBucket(frameMs);
+    Slice& slice = m_slices[m_currentSlice];
+    slice.counts[bucket]++;
+    slice.frames++;
+    slice.sumMs += frameMs;
+    slice.maxMs = std::max(slice.maxMs, frameMs);
+
+    for (Totals* totals : { &m_tenSeconds, &m_sixtySeconds, &m_session }) {
+        totals->counts[bucket]++;
+        totals->frames++;
+        totals->sumMs += frameMs;
+    }
+    m_sessionMaxMs = std::max(m_sessionMaxMs, frameMs);
+}
+
+void FrameTimeHistogram::AdvanceSlice() {
+    m_currentSlice = (m_currentSlice + 1) % SLICE_COUNT;
+    m_completedSlices = std::min(m_completedSlices + 1, SLICE_COUNT);
+
+    // The ten-second window now spans the new slice and the nine before it
+    const unsigned tenSecondSlices = 10;
+    if (m_completedSlices >= tenSecondSlices) {
+        Subtract(m_tenSeconds, m_slices[(m_currentSlice + SLICE_COUNT - tenSecondSlices) % SLICE_COUNT]);
+    }
+
+    // The slot being reused held the second that just left the sixty-second window
+    Slice& reused = m_slices[m_currentSlice];
+    Subtract(m_sixtySeconds, reused);
+    reused = Slice();
+}
+
+void FrameTimeHistogram::Subtract(Totals& totals, const Slice& slice) {
+    if (slice.frames == 0) return;
+    for (unsigned i = 0; i < BUCKET_COUNT; i++) {
+        totals.counts[i] -= slice.counts[i];
+    }
+    totals.frames -= slice.frames;
+    totals.sumMs = std::max(0.0, totals.sumMs - slice.sumMs);
+}
+
+void FrameTimeHistogram::Reset() {
+    *this = FrameTimeHistogram();
+}
+
+unsigned FrameTimeHistogram::GetWindowSlices(FrameTimeWindow window) const {
+    switch (window) {
+    case FrameTimeWindow::TenSeconds: return 10;
+    case FrameTimeWindow::SixtySeconds: return SLICE_COUNT;
+    default: return 1;
+    }
+}
+
+const FrameTimeHistogram::Totals& FrameTimeHistogram::GetTotals(FrameTimeWindow window, Totals& scratch) const {
+    switch (window) {
+    case FrameTimeWindow::TenSeconds: return m_tenSeconds;
+    case FrameTimeWindow::SixtySeconds: return m_sixtySeconds;
+    case FrameTimeWindow::Session: return m_session;
+    default: break;
+    }
+
+    // One second: the last complete slice (the current one until a second has passed)
+    const Slice& slice = m_completedSlices > 0 ?
+        m_slices[(m_currentSlice + SLICE_COUNT - 1) % SLICE_COUNT] : m_slices[m_currentSlice];
+    std::copy(slice.counts.begin(), slice.counts.end(), scratch.counts.begin());
+    scratch.frames = slice.frames;
+    scratch.sumMs = slice.sumMs;
+    return scratch;
+}
+
+FrameTimePercentiles FrameTimeHistogram::GetPercentiles(FrameTimeWindow window) const {
+    FrameTimePercentiles result;
+    Totals scratch;
+    const Totals& totals = GetTotals(window, scratch);
+    result.frames = totals.frames;
+    if (totals.frames == 0) return result;
+    result.meanMs = static_cast<float>(totals.sumMs / totals.frames);
+
+    // Each percentile is the upper edge of the bucket holding that rank (never optimistic)
+    const double quantiles[] = { 0.50, 0.95, 0.99, 0.999 };
+    float* outputs[] = { &result.p50Ms, &result.p95Ms, &result.p99Ms, &result.p999Ms };
+    uint64_t cumulative = 0;
+    size_t next = 0;
+    for (unsigned bucket = 0; bucket < BUCKET_COUNT && next < 4; bucket++) {
+        cumulative += totals.counts[bucket];
+        while (next < 4 && cumulative >= static_cast<uint64_t>(std::ceil(quantiles[next] * totals.frames))) {
+            *outputs[next++] = GetBucketUpperMs(bucket);
+        }
+    }
+
+    if (window == FrameTimeWindow::Session) {
+        result.maxMs = m_sessionMaxMs;
+    }
+    else if (window == FrameTimeWindow::OneSecond) {
+        result.maxMs = (m_completedSlices > 0 ?
+            m_slices[(m_currentSlice + SLICE_COUNT - 1) % SLICE_COUNT] : m_slices[m_currentSlice]).maxMs;
+    }
+    else {
+        unsigned slices = std::min(GetWindowSlices(window), m_completedSlices + 1);
+        for (unsigned i = 0; i < slices; i++) {
+            result.maxMs = std::max(result.maxMs, m_slices[(m_currentSlice + SLICE_COUNT - i) % SLICE_COUNT].maxMs);
+        }
+    }
+    // Bucket edges can overshoot the exact maximum
+    result.p50Ms = std::min(result.p50Ms, result.maxMs);
+    result.p95Ms = std::min(result.p95Ms, result.maxMs);
+    result.p99Ms = std::min(result.p99Ms, result.maxMs);
+    result.p999Ms = std::min(result.p999Ms, result.maxMs);
+    return result;
+}
+
+void FrameTimeHistogram::GetBucketCounts(FrameTimeWindow window, std::vector<float>& counts) const {
+    Totals scratch;
+    const Totals& totals = GetTotals(window, scratch);
+    counts.resize(BUCKET_COUNT);
+    for (unsigned i = 0; i < BUCKET_COUNT; i++) {
+        counts[i] = static_cast<float>(totals.counts[i]);
+    }
+}
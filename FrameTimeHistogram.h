@@ -0,0 +1,85 @@
+// GameOverlay - FrameTimeHistogram.h
+// Rolling log-bucketed frame time histogram with percentiles over fixed windows
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+// Windows the percentiles are reported over
+enum class FrameTimeWindow {
+    OneSecond,    // The last complete second
+    TenSeconds,
+    SixtySeconds,
+    Session,      // Since startup (or the last Reset)
+    Count
+};
+
+const char* GetFrameTimeWindowName(FrameTimeWindow window);
+
+struct FrameTimePercentiles {
+    uint64_t frames = 0;
+    float meanMs = 0.0f;
+    float p50Ms = 0.0f;
+    float p95Ms = 0.0f;
+    float p99Ms = 0.0f;
+    float p999Ms = 0.0f;
+    float maxMs = 0.0f; // Exact, not bucketed
+};
+
+// Frame times go into logarithmic buckets (eight per octave, 1/16 ms to 4 s, so each bucket is
+// within 9% of its neighbours). Adding a frame is O(1): the current one-second slice and the
+// running window totals are incremented. When a second passes, the slice leaving each window is
+// subtracted once, so queries never walk the frames, only the buckets.
+class FrameTimeHistogram {
+public:
+    static constexpr int MIN_OCTAVE = -4;               // 2^-4 ms
+    static constexpr unsigned OCTAVES = 16;             // Up to 2^12 ms
+    static constexpr unsigned BUCKETS_PER_OCTAVE = 8;
+    static constexpr unsigned BUCKET_COUNT = OCTAVES * BUCKETS_PER_OCTAVE;
+
+    FrameTimeHistogram() = default;
+
+    void AddFrame(float frameMs, std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+    void Reset();
+
+    FrameTimePercentiles GetPercentiles(FrameTimeWindow window) const;
+    // Per-bucket frame counts of a window, for plotting (BUCKET_COUNT entries)
+    void GetBucketCounts(FrameTimeWindow window, std::vector<float>& counts) const;
+    static float GetBucketUpperMs(unsigned bucket);
+    static unsigned GetBucket(float frameMs);
+
+private:
+    static constexpr unsigned SLICE_COUNT = 60; // One per second of the longest rolling window
+
+    struct Totals {
+        std::array<uint64_t, BUCKET_COUNT> counts = {};
+        uint64_t frames = 0;
+        double sumMs = 0.0;
+    };
+    struct Slice {
+        std::array<uint32_t, BUCKET_COUNT> counts = {};
+        uint32_t frames = 0;
+        double sumMs = 0.0;
+        float maxMs = 0.0f;
+    };
+
+    void AdvanceSlice();
+    void Subtract(Totals& totals, const Slice& slice);
+    const Totals& GetTotals(FrameTimeWindow window, Totals& scratch) const;
+    unsigned GetWindowSlices(FrameTimeWindow window) const; // Slices (newest first) a window covers
+
+    std::array<Slice, SLICE_COUNT> m_slices;
+    unsigned m_currentSlice = 0;
+    unsigned m_completedSlices = 0; // Capped at SLICE_COUNT
+    std::chrono::steady_clock::time_point m_sliceStart;
+    bool m_started = false;
+
+    // Running totals; each includes the current slice
+    Totals m_tenSeconds;
+    Totals m_sixtySeconds;
+    Totals m_session;
+    float m_sessionMaxMs = 0.0f;
+};
@@ -32,4 +32,5 @@
 #define GAMEOVERLAY_PHASE "DirectX 12 Migration"
 
 // Global variables
-extern HotkeyManager* g_hotkeyManager;
\ No newline at end of file
+extern HotkeyManager* g_hotkeyManager;
+extern RenderSystem* g_renderSystem;
\ No newline at end of file
@@ -0,0 +1,189 @@
+// GameOverlay - GameProfiles.cpp
+// Per-game performance profiles, keyed by the game's executable name
+
+#include "GameProfiles.h"
+#include "SettingsDatabase.h"
+#include "SettingsStore.h"
+#include <fstream>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+const char* GetOverlayPanelName(OverlayPanel panel) {
+    switch (panel) {
+    case OverlayPanel::Browser: return "Browser";
+    case OverlayPanel::PerformanceGraphs: return "Performance Graphs";
+    default: return "Unknown";
+    }
+}
+
+namespace {
+
+std::string ToLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+std::string Trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) return std::string();
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+// Keys of the per-state browser GPU policy, indexed by PerformanceState
+const char* const BROWSER_GPU_POLICY_KEYS[4] = {
+    "browserGpuPolicyActive", "browserGpuPolicyInactive", "browserGpuPolicyBackground", "browserGpuPolicyLowPower"
+};
+const char* const PANEL_KEYS[static_cast<size_t>(OverlayPanel::Count)] = {
+    "allowBrowser", "allowPerformanceGraphs"
+};
+
+const char* const PROFILE_PREFIX = "profiles."; // "profiles.<executable>.<field>"
+const char* const LEGACY_IMPORTED_KEY = "migration.gameProfilesIni";
+
+void ApplyValue(GameProfile& profile, const std::string& key, double value) {
+    float number = static_cast<float>(value);
+    int integer = static_cast<int>(value);
+    if (key == "maxActiveFrameRate") profile.maxActiveFrameRate = number;
+    else if (key == "maxInactiveFrameRate") profile.maxInactiveFrameRate = number;
+    else if (key == "maxBackgroundFrameRate") profile.maxBackgroundFrameRate = number;
+    else if (key == "maxRenderScale") profile.maxRenderScale = std::clamp(number, 0.25f, 1.0f);
+    else if (key == "overlayFrameBudgetMs") profile.overlayFrameBudgetMs = std::max(0.0f, number);
+    else if (key == "gpuYieldPolicy") profile.gpuYieldPolicy = std::clamp(integer, 0, 2);
+    else {
+        for (size_t i = 0; i < 4; i++) {
+            if (key == BROWSER_GPU_POLICY_KEYS[i]) {
+                int policy = std::clamp(integer, 0, static_cast<int>(BrowserGpuPolicy::Count) - 1);
+                profile.browserGpuPolicy[i] = static_cast<BrowserGpuPolicy>(policy);
+                return;
+            }
+        }
+        for (size_t i = 0; i < static_cast<size_t>(OverlayPanel::Count); i++) {
+            if (key == PANEL_KEYS[i]) {
+                profile.panelsAllowed[i] = integer != 0;
+                return;
+            }
+        }
+        // Unknown keys (from a newer version) are dropped
+    }
+}
+
+} // namespace
+
+void GameProfileStore::Load() {
+    m_profiles.clear();
+    SettingsDatabase& db = SettingsDatabase::Get();
+    if (!db.GetBool(LEGACY_IMPORTED_KEY, false)) {
+        ImportLegacyFile(GetLegacyPath());
+        return;
+    }
+
+    // Keys are sorted, so each profile's fields are adjacent
+    const size_t prefixLength = strlen(PROFILE_PREFIX);
+    for (const std::string& key : db.GetKeys(PROFILE_PREFIX)) {
+        size_t separator = key.find_last_of('.');
+        if (separator <= prefixLength) continue;
+        std::string executable = key.substr(prefixLength, separator - prefixLength);
+        if (m_profiles.empty() || m_profiles.back().executable != executable) {
+            m_profiles.emplace_back();
+            m_profiles.back().executable = executable;
+        }
+        ApplyValue(m_profiles.back(), key.substr(separator + 1), db.GetFloat(key, 0.0));
+    }
+}
+
+void GameProfileStore::Save() const {
+    SettingsDatabase& db = SettingsDatabase::Get();
+    db.RemovePrefix(PROFILE_PREFIX);
+    for (const GameProfile& profile : m_profiles) {
+        std::string prefix = PROFILE_PREFIX + profile.executable + '.';
+        db.SetFloat(prefix + "maxActiveFrameRate", profile.maxActiveFrameRate);
+        db.SetFloat(prefix + "maxInactiveFrameRate", profile.maxInactiveFrameRate);
+        db.SetFloat(prefix + "maxBackgroundFrameRate", profile.maxBackgroundFrameRate);
+        db.SetFloat(prefix + "maxRenderScale", profile.maxRenderScale);
+        db.SetFloat(prefix + "overlayFrameBudgetMs", profile.overlayFrameBudgetMs);
+        db.SetInt(prefix + "gpuYieldPolicy", profile.gpuYieldPolicy);
+        for (size_t i = 0; i < 4; i++) {
+            db.SetInt(prefix + BROWSER_GPU_POLICY_KEYS[i], static_cast<int>(profile.browserGpuPolicy[i]));
+        }
+        for (size_t i = 0; i < static_cast<size_t>(OverlayPanel::Count); i++) {
+            db.SetBool(prefix + PANEL_KEYS[i], profile.panelsAllowed[i]);
+        }
+    }
+    db.Save();
+}
+
+void GameProfileStore::ImportLegacyFile(const std::string& path) {
+    // The INI file of earlier versions, read once; the database is the only copy afterwards
+    std::ifstream file(path);
+    std::string line;
+    GameProfile* profile = nullptr;
+    while (file && std::getline(file, line)) {
+        line = Trim(line);
+        if (line.empty() || line[0] == ';' || line[0] == '#') continue;
+
+        if (line.front() == '[' && line.back() == ']') {
+            std::string executable = ToLower(Trim(line.substr(1, line.size() - 2)));
+            profile = nullptr;
+            if (executable.empty() || Find(executable)) continue; // Duplicates: the first one wins
+            m_profiles.emplace_back();
+            profile = &m_profiles.back();
+            profile->executable = executable;
+            continue;
+        }
+
+        size_t separator = line.find('=');
+        if (!profile || separator == std::string::npos) continue;
+        ApplyValue(*profile, Trim(line.substr(0, separator)), atof(Trim(line.substr(separator + 1)).c_str()));
+    }
+
+    SettingsDatabase::Get().SetBool(LEGACY_IMPORTED_KEY, true);
+    Save();
+}
+
+const GameProfile* GameProfileStore::Find(const std::string& executable) const {
+    for (const GameProfile& profile : m_profiles) {
+        if (profile.executable == executable) return &profile;
+    }
+    return nullptr;
+}
+
+void GameProfileStore::Set(const GameProfile& profile) {
+    GameProfile stored = profile;
+    stored.executable = ToLower(stored.executable);
+    for (GameProfile& existing : m_profiles) {
+        if (existing.executable == stored.executable) {
+            existing = stored;
+            return;
+        }
+    }
+    m_profiles.push_back(stored);
+}
+
+void GameProfileStore::Remove(const std::string& executable) {
+    m_profiles.erase(std::remove_if(m_profiles.begin(), m_profiles.end(),
+        [&executable](const GameProfile& profile) { return profile.executable == executable; }), m_profiles.end());
+}
+
+std::string GameProfileStore::GetLegacyPath() {
+    return SettingsStore::GetSettingsPath("GameProfiles.ini");
+}
+
+std::string GameProfileStore::GetExecutableName(DWORD processId) {
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+    if (!process) return std::string();
+
+    char path[MAX_PATH];
+    DWORD length = MAX_PATH;
+    BOOL queried = QueryFullProcessImageNameA(process, 0, path, &length);
+    CloseHandle(process);
+    if (!queried) return std::string();
+
+    std::string fullPath(path, length);
+    size_t separator = fullPath.find_last_of("\\/");
+    return ToLower(separator == std::string::npos ? fullPath : fullPath.substr(separator + 1));
+}
@@ -0,0 +1,68 @@
+// GameOverlay - GameProfiles.h
+// Per-game performance profiles, keyed by the game's executable name
+
+#pragma once
+
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include "PerformanceMonitor.h" // BrowserGpuPolicy
+
+// Parts of the overlay a profile can keep from running while the game has focus
+enum class OverlayPanel {
+    Browser,           // Browser keeps pumping and painting under the game
+    PerformanceGraphs,
+    Count
+};
+
+const char* GetOverlayPanelName(OverlayPanel panel);
+
+// The optimizer settings a profile replaces while its game has focus. GPU yield policy is a
+// GpuYieldPolicy value; the browser GPU policy only takes effect the next time CEF starts.
+struct GameProfile {
+    std::string executable; // Lowercase file name, e.g. "cs2.exe"
+
+    float maxActiveFrameRate = 60.0f;
+    float maxInactiveFrameRate = 30.0f;
+    float maxBackgroundFrameRate = 10.0f;
+    float maxRenderScale = 1.0f;       // Adaptive resolution ceiling
+    float overlayFrameBudgetMs = 6.0f; // Component budget, 0 = off
+    int gpuYieldPolicy = 1;
+    BrowserGpuPolicy browserGpuPolicy[4] = {
+        BrowserGpuPolicy::Full, BrowserGpuPolicy::SoftwareRaster,
+        BrowserGpuPolicy::SoftwareRaster, BrowserGpuPolicy::Software
+    };
+    bool panelsAllowed[static_cast<size_t>(OverlayPanel::Count)] = { true, true };
+};
+
+// Stored in SettingsDatabase as "profiles.<executable>.<field>"; the INI file of earlier versions
+// is imported on the first Load. Main thread only.
+class GameProfileStore {
+public:
+    GameProfileStore() = default;
+    ~GameProfileStore() = default;
+
+    // Disable copy and move
+    GameProfileStore(const GameProfileStore&) = delete;
+    GameProfileStore& operator=(const GameProfileStore&) = delete;
+    GameProfileStore(GameProfileStore&&) = delete;
+    GameProfileStore& operator=(GameProfileStore&&) = delete;
+
+    void Load();
+    void Save() const; // Replaces every stored profile
+
+    const GameProfile* Find(const std::string& executable) const;
+    void Set(const GameProfile& profile); // Replaces the executable's profile
+    void Remove(const std::string& executable);
+    const std::vector<GameProfile>& GetProfiles() const { return m_profiles; }
+
+    // %LOCALAPPDATA%\GameOverlay\GameProfiles.ini, as written by earlier versions
+    static std::string GetLegacyPath();
+    // Lowercase file name of the process's executable; empty when it can't be opened
+    static std::string GetExecutableName(DWORD processId);
+
+private:
+    void ImportLegacyFile(const std::string& path);
+
+    std::vector<GameProfile> m_profiles;
+};
@@ -0,0 +1,221 @@
+// GameOverlay - GpuUsageSampler.cpp
+// Background sampling of GPU engine utilization and GPU memory (PDH "GPU Engine" counters)
+
+#include "GpuUsageSampler.h"
+#include "ThreadPolicy.h"
+#include "ThreadCycles.h"
+#include <pdhmsg.h>
+#include <algorithm>
+#include <cwchar>
+
+const char* GetGpuEngineTypeName(GpuEngineType type) {
+    switch (type) {
+    case GpuEngineType::Graphics: return "3D";
+    case GpuEngineType::Copy: return "Copy";
+    case GpuEngineType::Video: return "Video";
+    default: return "Unknown";
+    }
+}
+
+namespace {
+    // Instance names look like pid_1234_luid_0x00000000_0x0000D1A1_phys_0_eng_3_engtype_Copy
+    DWORD ParseProcessId(const wchar_t* instance) {
+        const wchar_t* pid = wcsstr(instance, L"pid_");
+        return pid ? static_cast<DWORD>(wcstoul(pid + 4, nullptr, 10)) : 0;
+    }
+
+    GpuEngineType ParseEngineType(const wchar_t* instance) {
+        const wchar_t* type = wcsstr(instance, L"engtype_");
+        if (!type) return GpuEngineType::Count;
+        type += 8;
+        if (wcscmp(type, L"3D") == 0) return GpuEngineType::Graphics;
+        if (wcscmp(type, L"Copy") == 0) return GpuEngineType::Copy;
+        if (wcsncmp(type, L"Video", 5) == 0) return GpuEngineType::Video;
+        return GpuEngineType::Count; // Compute, security, vendor specific: not reported
+    }
+}
+
+GpuUsageSampler::GpuUsageSampler(std::chrono::milliseconds interval)
+    : m_interval(interval) {
+    m_trackedProcesses.push_back(GetCurrentProcessId());
+    m_worker = std::thread(&GpuUsageSampler::WorkerThread, this);
+}
+
+GpuUsageSampler::~GpuUsageSampler() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+
+void GpuUsageSampler::SetTrackedProcesses(std::vector<DWORD> processIds) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_trackedProcesses = std::move(processIds);
+}
+
+bool GpuUsageSampler::GetLatestSample(GpuUsageSample& sample) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    sample = m_latest;
+    return sample.valid;
+}
+
+bool GpuUsageSampler::IsAvailable() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_available;
+}
+
+bool GpuUsageSampler::OpenQuery() {
+    if (PdhOpenQueryW(nullptr, 0, &m_query) != ERROR_SUCCESS) {
+        m_query = nullptr;
+        return false;
+    }
+
+    // English names, so localized systems resolve the same counters
+    if (PdhAddEnglishCounterW(m_query, L"\\GPU Engine(*)\\Utilization Percentage", 0, &m_engineCounter) != ERROR_SUCCESS) {
+        OutputDebugStringA("Warning: GPU engine counters unavailable, GPU usage is estimated from timestamps.\n");
+        CloseQuery();
+        return false;
+    }
+
+    // Memory counters are optional
+    if (PdhAddEnglishCounterW(m_query, L"\\GPU Process Memory(*)\\Dedicated Usage", 0, &m_processDedicatedCounter) != ERROR_SUCCESS) {
+        m_processDedicatedCounter = nullptr;
+    }
+    if (PdhAddEnglishCounterW(m_query, L"\\GPU Process Memory(*)\\Shared Usage", 0, &m_processSharedCounter) != ERROR_SUCCESS) {
+        m_processSharedCounter = nullptr;
+    }
+    if (PdhAddEnglishCounterW(m_query, L"\\GPU Adapter Memory(*)\\Dedicated Usage", 0, &m_adapterDedicatedCounter) != ERROR_SUCCESS) {
+        m_adapterDedicatedCounter = nullptr;
+    }
+    if (PdhAddEnglishCounterW(m_query, L"\\GPU Adapter Memory(*)\\Shared Usage", 0, &m_adapterSharedCounter) != ERROR_SUCCESS) {
+        m_adapterSharedCounter = nullptr;
+    }
+
+    // First collection; rates need a second one
+    PdhCollectQueryData(m_query);
+    return true;
+}
+
+void GpuUsageSampler::CloseQuery() {
+    if (m_query) {
+        PdhCloseQuery(m_query); // Frees the counters too
+    }
+    m_query = nullptr;
+    m_engineCounter = nullptr;
+    m_processDedicatedCounter = nullptr;
+    m_processSharedCounter = nullptr;
+    m_adapterDedicatedCounter = nullptr;
+    m_adapterSharedCounter = nullptr;
+}
+
+void GpuUsageSampler::WorkerThread() {
+    // Counter enumeration is slow on the first call; it happens here, not on the render thread
+    ConfigureWorkerThread();
+    ThreadCycles::RegisterThread(ThreadSubsystem::Telemetry);
+    bool available = OpenQuery();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_available = available;
+    }
+    if (!available) return;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_condition.wait_for(lock, m_interval, [this] { return m_stopping; })) {
+        lock.unlock();
+        GpuUsageSample sample;
+        if (PdhCollectQueryData(m_query) == ERROR_SUCCESS) {
+            Collect(sample);
+        }
+        lock.lock();
+        if (sample.valid) {
+            m_latest = sample;
+        }
+    }
+    lock.unlock();
+
+    CloseQuery();
+}
+
+void GpuUsageSampler::Collect(GpuUsageSample& sample) {
+    // Returns the counter's instances in m_itemBuffer, nullptr when they can't be read
+    auto readItems = [this](PDH_HCOUNTER counter, DWORD format, DWORD& count) -> PDH_FMT_COUNTERVALUE_ITEM_W* {
+        count = 0;
+        if (!counter) return nullptr;
+        DWORD size = 0;
+        PDH_STATUS status = PdhGetFormattedCounterArrayW(counter, format, &size, &count, nullptr);
+        if (status != PDH_MORE_DATA) return nullptr;
+        m_itemBuffer.resize(size);
+        auto* items = reinterpret_cast<PDH_FMT_COUNTERVALUE_ITEM_W*>(m_itemBuffer.data());
+        status = PdhGetFormattedCounterArrayW(counter, format, &size, &count, items);
+        return status == ERROR_SUCCESS ? items : nullptr;
+    };
+
+    std::vector<DWORD> tracked;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        tracked = m_trackedProcesses;
+    }
+    auto isTracked = [&tracked](DWORD processId) {
+        return std::find(tracked.begin(), tracked.end(), processId) != tracked.end();
+    };
+
+    // Utilization: one instance per process per engine. Sum per engine, then report the busiest
+    // engine of each type
+    DWORD count = 0;
+    PDH_FMT_COUNTERVALUE_ITEM_W* items = readItems(m_engineCounter, PDH_FMT_DOUBLE | PDH_FMT_NOCAP100, count);
+    if (!items) return;
+
+    for (EngineUsage& engine : m_engines) {
+        engine.system = 0.0;
+        engine.process = 0.0;
+    }
+    for (DWORD i = 0; i < count; i++) {
+        if (items[i].FmtValue.CStatus != PDH_CSTATUS_VALID_DATA &&
+            items[i].FmtValue.CStatus != PDH_CSTATUS_NEW_DATA) continue;
+        const wchar_t* instance = items[i].szName;
+        GpuEngineType type = ParseEngineType(instance);
+        const wchar_t* luid = wcsstr(instance, L"luid_");
+        const wchar_t* typeSuffix = wcsstr(instance, L"_engtype_");
+        if (type == GpuEngineType::Count || !luid || !typeSuffix || typeSuffix < luid) continue;
+
+        std::wstring engineName(luid, typeSuffix);
+        auto it = std::find_if(m_engines.begin(), m_engines.end(),
+            [&engineName](const EngineUsage& engine) { return engine.engine == engineName; });
+        if (it == m_engines.end()) {
+            m_engines.push_back({ engineName, type, 0.0, 0.0 });
+            it = m_engines.end() - 1;
+        }
+        double value = items[i].FmtValue.doubleValue / 100.0;
+        it->system += value;
+        if (isTracked(ParseProcessId(instance))) {
+            it->process += value;
+        }
+    }
+    for (const EngineUsage& engine : m_engines) {
+        size_t type = static_cast<size_t>(engine.type);
+        sample.systemEngineUsage[type] = std::max(sample.systemEngineUsage[type], static_cast<float>(std::min(engine.system, 1.0)));
+        sample.processEngineUsage[type] = std::max(sample.processEngineUsage[type], static_cast<float>(std::min(engine.process, 1.0)));
+    }
+
+    // Memory: process instances carry a pid, adapter instances don't
+    auto sumBytes = [&](PDH_HCOUNTER counter, bool trackedOnly) {
+        UINT64 total = 0;
+        DWORD itemCount = 0;
+        PDH_FMT_COUNTERVALUE_ITEM_W* memoryItems = readItems(counter, PDH_FMT_LARGE, itemCount);
+        for (DWORD i = 0; memoryItems && i < itemCount; i++) {
+            if (memoryItems[i].FmtValue.CStatus != PDH_CSTATUS_VALID_DATA) continue;
+            if (trackedOnly && !isTracked(ParseProcessId(memoryItems[i].szName))) continue;
+            total += static_cast<UINT64>(std::max<LONGLONG>(memoryItems[i].FmtValue.largeValue, 0));
+        }
+        return total;
+    };
+    sample.processDedicatedBytes = sumBytes(m_processDedicatedCounter, true);
+    sample.processSharedBytes = sumBytes(m_processSharedCounter, true);
+    sample.systemDedicatedBytes = sumBytes(m_adapterDedicatedCounter, false);
+    sample.systemSharedBytes = sumBytes(m_adapterSharedCounter, false);
+    sample.valid = true;
+}
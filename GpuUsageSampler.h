@@ -0,0 +1,98 @@
+// GameOverlay - GpuUsageSampler.h
+// Background sampling of GPU engine utilization and GPU memory (PDH "GPU Engine" counters)
+
+#pragma once
+
+#include <Windows.h>
+#include <pdh.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+
+// Engine groups reported by the counters' engtype_ suffix
+enum class GpuEngineType {
+    Graphics, // 3D
+    Copy,
+    Video,    // VideoDecode, VideoEncode, VideoProcessing
+    Count
+};
+
+const char* GetGpuEngineTypeName(GpuEngineType type);
+
+// One sample; utilization is 0-1 of the busiest engine of each type (what Task Manager shows)
+struct GpuUsageSample {
+    bool valid = false;
+    float processEngineUsage[static_cast<size_t>(GpuEngineType::Count)] = {}; // Tracked processes
+    float systemEngineUsage[static_cast<size_t>(GpuEngineType::Count)] = {};  // Every process
+    UINT64 processDedicatedBytes = 0;
+    UINT64 processSharedBytes = 0;
+    UINT64 systemDedicatedBytes = 0; // All adapters
+    UINT64 systemSharedBytes = 0;
+
+    float GetProcessUsage(GpuEngineType type) const { return processEngineUsage[static_cast<size_t>(type)]; }
+    float GetSystemUsage(GpuEngineType type) const { return systemEngineUsage[static_cast<size_t>(type)]; }
+};
+
+// The counters are collected on a worker thread at a fixed interval, so the render loop only ever
+// copies the latest sample. Without the counters (before Windows 10 1709, or PDH disabled) no
+// sample becomes valid and callers keep their fallback.
+class GpuUsageSampler {
+public:
+    static constexpr std::chrono::milliseconds DEFAULT_INTERVAL{ 1000 };
+
+    GpuUsageSampler(std::chrono::milliseconds interval = DEFAULT_INTERVAL);
+    ~GpuUsageSampler();
+
+    // Disable copy and move
+    GpuUsageSampler(const GpuUsageSampler&) = delete;
+    GpuUsageSampler& operator=(const GpuUsageSampler&) = delete;
+    GpuUsageSampler(GpuUsageSampler&&) = delete;
+    GpuUsageSampler& operator=(GpuUsageSampler&&) = delete;
+
+    // Processes counted as ours (this process by default; e.g. add the browser's GPU process)
+    void SetTrackedProcesses(std::vector<DWORD> processIds);
+
+    // False until the second collection (utilization is a rate)
+    bool GetLatestSample(GpuUsageSample& sample) const;
+    bool IsAvailable() const; // Counters were found
+
+private:
+    void WorkerThread();
+    bool OpenQuery();
+    void CloseQuery();
+    void Collect(GpuUsageSample& sample);
+
+    std::chrono::milliseconds m_interval;
+
+    // PDH query (worker thread only)
+    PDH_HQUERY m_query = nullptr;
+    PDH_HCOUNTER m_engineCounter = nullptr;
+    PDH_HCOUNTER m_processDedicatedCounter = nullptr;
+    PDH_HCOUNTER m_processSharedCounter = nullptr;
+    PDH_HCOUNTER m_adapterDedicatedCounter = nullptr;
+    PDH_HCOUNTER m_adapterSharedCounter = nullptr;
+    std::vector<uint8_t> m_itemBuffer;
+
+    // Per engine accumulation, reused between samples
+    struct EngineUsage {
+        std::wstring engine; // luid_..._phys_N_eng_N
+        GpuEngineType type = GpuEngineType::Count;
+        double system = 0.0;
+        double process = 0.0;
+    };
+    std::vector<EngineUsage> m_engines;
+
+    // m_mutex guards the sample, the tracked processes and the stop flag
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    GpuUsageSample m_latest;
+    std::vector<DWORD> m_trackedProcesses;
+    bool m_available = false;
+    bool m_stopping = false;
+    std::thread m_worker;
+};
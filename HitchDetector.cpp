@@ -0,0 +1,63 @@
+// GameOverlay - HitchDetector.cpp
+// Flags frames far above the rolling median and keeps a snapshot of what led up to them
+
+#include "HitchDetector.h"
+#include <algorithm>
+
+HitchDetector::HitchDetector() {
+    SetEnabled(true);
+}
+
+HitchDetector::~HitchDetector() {
+    SetEnabled(false);
+}
+
+void HitchDetector::SetEnabled(bool enabled) {
+    m_enabled = enabled;
+    SetZoneCaptureArmed(enabled && m_zoneCaptureArmed);
+}
+
+void HitchDetector::SetZoneCaptureArmed(bool armed) {
+    m_zoneCaptureArmed = armed;
+    CpuProfiler::SetEnabled(CpuProfilerClient::HitchDetector, armed && CpuProfiler::IsCompiledIn());
+}
+
+bool HitchDetector::CheckFrame(float frameMs, const FrameTimeHistogram& histogram,
+                               std::chrono::steady_clock::time_point now) {
+    if (!m_enabled) return false;
+
+    // Walking the buckets every frame is cheap but pointless; the median moves slowly
+    if (now - m_medianTime >= std::chrono::milliseconds(250)) {
+        m_medianTime = now;
+        FrameTimePercentiles percentiles = histogram.GetPercentiles(FrameTimeWindow::TenSeconds);
+        m_medianMs = percentiles.frames >= MIN_MEDIAN_FRAMES ? percentiles.p50Ms : 0.0f;
+    }
+    if (m_medianMs <= 0.0f || frameMs < MIN_HITCH_MS || frameMs < m_medianMs * m_thresholdMultiple) {
+        return false;
+    }
+
+    m_totalHitches++;
+    if (!m_incidents.empty() && now - m_lastIncidentTime < std::chrono::milliseconds(COOLDOWN_MS)) {
+        HitchIncident& last = m_incidents.back();
+        last.repeats++;
+        last.frameMs = std::max(last.frameMs, frameMs);
+        return false;
+    }
+    m_lastIncidentTime = now;
+    return true;
+}
+
+void HitchDetector::AddIncident(HitchIncident incident) {
+    GetLocalTime(&incident.localTime);
+    incident.medianMs = m_medianMs;
+    if (CpuProfiler::IsEnabled()) {
+        int64_t endTicks = CpuProfiler::GetTicks();
+        int64_t beginTicks = endTicks - static_cast<int64_t>(SNAPSHOT_MS * CpuProfiler::GetTicksPerMs());
+        CpuProfiler::CaptureRange(beginTicks, endTicks, incident.profile);
+    }
+
+    if (m_incidents.size() >= MAX_INCIDENTS) {
+        m_incidents.pop_front();
+    }
+    m_incidents.push_back(std::move(incident));
+}
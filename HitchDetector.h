@@ -0,0 +1,85 @@
+// GameOverlay - HitchDetector.h
+// Flags frames far above the rolling median and keeps a snapshot of what led up to them
+
+#pragma once
+
+#include <Windows.h>
+#include <deque>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include "CpuProfiler.h"
+#include "FrameTimeHistogram.h"
+
+// One hitch, frozen when its frame ended
+struct HitchIncident {
+    uint64_t frameIndex = 0;
+    SYSTEMTIME localTime = {};
+    float frameMs = 0.0f;        // Worst of the folded frames' work time (waits excluded)
+    float medianMs = 0.0f;       // Rolling median the frame was compared against
+    UINT repeats = 0;            // Further hitches within the cooldown, folded into this one
+
+    // Metrics at the time (GPU timings lag the frame by the timestamp readback latency)
+    float gpuFrameMs = 0.0f;
+    std::vector<float> gpuPassMs; // Indexed by GpuPass
+    float cpuPercent = 0.0f;
+    float memoryMB = 0.0f;
+
+    // Every profiler lane over the SNAPSHOT_MS before the frame ended: CPU zones (CEF pump,
+    // resource creation, texture decode), GPU passes and events. Empty unless the profiler was
+    // recording (zone capture armed, the CPU timeline open or a trace capture armed).
+    CpuProfileFrame profile;
+};
+
+// The median is the ten-second p50 of the frame time histogram, refreshed a few times a second.
+// Detection only needs frame times; the profiler records for it only while zone capture is armed,
+// so the zones before a hitch are still in its rings.
+// Incidents close together are folded: the first one's snapshot already covers the rest.
+class HitchDetector {
+public:
+    static constexpr float DEFAULT_THRESHOLD_MULTIPLE = 2.5f;
+    static constexpr float MIN_HITCH_MS = 8.0f;           // Shorter frames never count, whatever the median
+    static constexpr float SNAPSHOT_MS = 500.0f;
+    static constexpr int64_t COOLDOWN_MS = 1000;
+    static constexpr size_t MAX_INCIDENTS = 16;
+    static constexpr uint64_t MIN_MEDIAN_FRAMES = 60;     // Warm-up before the median is trusted
+
+    HitchDetector();
+    ~HitchDetector();
+
+    // Disable copy and move
+    HitchDetector(const HitchDetector&) = delete;
+    HitchDetector& operator=(const HitchDetector&) = delete;
+    HitchDetector(HitchDetector&&) = delete;
+    HitchDetector& operator=(HitchDetector&&) = delete;
+
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const { return m_enabled; }
+    void SetZoneCaptureArmed(bool armed);
+    bool IsZoneCaptureArmed() const { return m_zoneCaptureArmed; }
+    void SetThresholdMultiple(float multiple) { m_thresholdMultiple = multiple; }
+    float GetThresholdMultiple() const { return m_thresholdMultiple; }
+    float GetMedianMs() const { return m_medianMs; }
+
+    // After the frame is added to the histogram; true when the caller should fill in an incident
+    // and hand it to AddIncident (a folded repeat returns false)
+    bool CheckFrame(float frameMs, const FrameTimeHistogram& histogram,
+                    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+    // Takes the profiler snapshot, then stores the incident (the oldest goes when full)
+    void AddIncident(HitchIncident incident);
+
+    // Newest last
+    const std::deque<HitchIncident>& GetIncidents() const { return m_incidents; }
+    uint64_t GetTotalHitches() const { return m_totalHitches; }
+    void ClearIncidents() { m_incidents.clear(); }
+
+private:
+    bool m_enabled = false;
+    bool m_zoneCaptureArmed = false;
+    float m_thresholdMultiple = DEFAULT_THRESHOLD_MULTIPLE;
+    float m_medianMs = 0.0f;
+    std::chrono::steady_clock::time_point m_medianTime;
+    std::chrono::steady_clock::time_point m_lastIncidentTime;
+    uint64_t m_totalHitches = 0;
+    std::deque<HitchIncident> m_incidents;
+};
@@ -4,6 +4,11 @@
 
 #include "HotkeyManager.h"
 #include "WindowManager.h"
+#include "SettingsDatabase.h"
+#include "ThreadPolicy.h"
+#include "ThreadCycles.h"
+#include "InputLatency.h"
+#include <cstring>
 #include <sstream>
 #include <algorithm>
 #include <cctype>
@@ -132,14 +137,24 @@ Hotkey Hotkey::FromString(const std::string& str) {
 }
 
 // Constructor
-HotkeyManager::HotkeyManager(WindowManager* windowManager)
+HotkeyManager::HotkeyManager(WindowManager* windowManager, bool useInputThread)
     : m_windowManager(windowManager) {
 
     // Store instance for static hook callback
     s_instance = this;
 
-    // Install the keyboard hook
-    InstallHook();
+    // Queued slots never allocate in the input thread's path
+    m_pendingActions.reserve(64);
+    m_dispatchingActions.reserve(64);
+
+    // Raw Input on the input thread; the keyboard hook only when that fails
+    if (!useInputThread) {
+        InstallHook();
+    }
+    else if (!StartInputThread()) {
+        OutputDebugStringA("Warning: Raw Input hotkeys unavailable; using the low-level keyboard hook.\n");
+        InstallHook();
+    }
 
     // Register default hotkeys
     RegisterDefaultHotkeys();
@@ -147,7 +162,8 @@ HotkeyManager::HotkeyManager(WindowManager* windowManager)
 
 // Destructor
 HotkeyManager::~HotkeyManager() {
-    // Remove hook
+    // Stop the input thread and remove the hook
+    StopInputThread();
     RemoveHook();
 
     // Clear the static instance
@@ -158,32 +174,30 @@ HotkeyManager::~HotkeyManager() {
 
 // Register a hotkey with an action
 bool HotkeyManager::RegisterHotkey(const std::string& actionName, const Hotkey& hotkey, HotkeyAction action) {
-    if (hotkey.IsEmpty()) return false;
+    if (hotkey.IsEmpty() || !IsBindable(hotkey)) return false;
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
 
-    // Check if this hotkey is already used
-    if (IsHotkeyRegistered(hotkey)) {
-        // Already registered to something else
-        for (const auto& [name, pair] : m_hotkeyMap) {
-            if (pair.first == hotkey && name != actionName) {
-                return false;
-            }
-        }
+    // Already registered to something else
+    if (IsBoundToOther(hotkey, actionName)) {
+        return false;
     }
 
     // Add or update the hotkey
     m_hotkeyMap[actionName] = std::make_pair(hotkey, action);
+    m_defaultHotkeys.emplace(actionName, hotkey);
+    PublishTable();
     return true;
 }
 
 // Unregister a hotkey by action name
 bool HotkeyManager::UnregisterHotkey(const std::string& actionName) {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
 
     auto it = m_hotkeyMap.find(actionName);
     if (it != m_hotkeyMap.end()) {
         m_hotkeyMap.erase(it);
+        PublishTable();
         return true;
     }
 
@@ -192,30 +206,31 @@ bool HotkeyManager::UnregisterHotkey(const std::string& actionName) {
 
 // Update an existing hotkey
 bool HotkeyManager::UpdateHotkey(const std::string& actionName, const Hotkey& hotkey) {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!IsBindable(hotkey)) return false;
+
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
 
     auto it = m_hotkeyMap.find(actionName);
     if (it == m_hotkeyMap.end()) {
         return false;
     }
 
-    // Check if this hotkey is already used
-    if (!hotkey.IsEmpty() && IsHotkeyRegistered(hotkey)) {
-        // Already registered to something else
-        for (const auto& [name, pair] : m_hotkeyMap) {
-            if (pair.first == hotkey && name != actionName) {
-                return false;
-            }
-        }
+    // Already registered to something else
+    if (!hotkey.IsEmpty() && IsBoundToOther(hotkey, actionName)) {
+        return false;
     }
 
     // Update the hotkey, keeping the same action
     it->second.first = hotkey;
+    PublishTable();
     return true;
 }
 
 // Process key events from the main window
 bool HotkeyManager::ProcessKeyEvent(WPARAM wParam, LPARAM lParam) {
+    // The input thread sees these keys too (Raw Input reaches it in the foreground as well)
+    if (IsRawInputActive()) return false;
+
     bool keyDown = !(lParam & (1 << 31)); // Check if key is down
     DWORD keyCode = static_cast<DWORD>(wParam);
 
@@ -230,9 +245,16 @@ bool HotkeyManager::ProcessKeyEvent(WPARAM wParam, LPARAM lParam) {
     return false;
 }
 
+// Set observer for triggered hotkeys
+void HotkeyManager::SetHotkeyTriggeredCallback(HotkeyAction callback) {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    m_hotkeyTriggeredCallback = callback;
+    PublishTable();
+}
+
 // Get all registered hotkeys
 std::map<std::string, Hotkey> HotkeyManager::GetHotkeys() const {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
 
     std::map<std::string, Hotkey> result;
     for (const auto& [name, pair] : m_hotkeyMap) {
@@ -244,17 +266,44 @@ std::map<std::string, Hotkey> HotkeyManager::GetHotkeys() const {
 
 // Check if a hotkey is already registered
 bool HotkeyManager::IsHotkeyRegistered(const Hotkey& hotkey) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    if (hotkey.IsEmpty() || !IsBindable(hotkey)) return false;
+    TableReadScope reading(*this);
+    const DispatchTable* table = m_table.load();
+    return table && table->slots[GetSlot(hotkey)] != 0;
+}
+
+int HotkeyManager::GetSlot(const Hotkey& hotkey) {
+    int modifiers = (hotkey.ctrl ? 1 : 0) | (hotkey.alt ? 2 : 0) | (hotkey.shift ? 4 : 0) | (hotkey.win ? 8 : 0);
+    return static_cast<int>(hotkey.key) * 16 + modifiers;
+}
 
-    if (hotkey.IsEmpty()) return false;
+bool HotkeyManager::IsBoundToOther(const Hotkey& hotkey, const std::string& actionName) const {
+    const DispatchTable* table = m_table.load(std::memory_order_relaxed); // Only published under m_mutex
+    uint16_t entry = table ? table->slots[GetSlot(hotkey)] : 0;
+    return entry != 0 && table->names[entry - 1] != actionName;
+}
 
+void HotkeyManager::PublishTable() {
+    // Tables are never changed once published, so a reader can keep using the one it loaded while
+    // a newer one replaces it; the old one is retired until no reader can still hold it
+    auto table = std::make_unique<DispatchTable>();
     for (const auto& [name, pair] : m_hotkeyMap) {
-        if (pair.first == hotkey) {
-            return true;
-        }
+        if (pair.first.IsEmpty()) continue;
+        table->names.push_back(name);
+        table->actions.push_back(pair.second);
+        table->slots[GetSlot(pair.first)] = static_cast<uint16_t>(table->names.size());
+    }
+    table->triggered = m_hotkeyTriggeredCallback;
+    m_table.store(table.get());
+    if (m_currentTable) m_retiredTables.push_back(std::move(m_currentTable));
+    m_currentTable = std::move(table);
+
+    // Readers enter their scope before loading the pointer, so with none inside, none holds a
+    // retired table. Readers in scope (an action rebinding from DispatchPendingActions) leave them
+    // to the next publish.
+    if (m_tableReaders.load() == 0) {
+        m_retiredTables.clear();
     }
-
-    return false;
 }
 
 // Install the keyboard hook
@@ -281,6 +330,120 @@ void HotkeyManager::RemoveHook() {
     }
 }
 
+bool HotkeyManager::StartInputThread() {
+    std::promise<bool> started;
+    std::future<bool> result = started.get_future();
+    m_inputThread = std::thread(&HotkeyManager::InputThread, this, &started);
+    if (result.get()) return true;
+    m_inputThread.join();
+    return false;
+}
+
+void HotkeyManager::StopInputThread() {
+    if (!m_inputThread.joinable()) return;
+    PostThreadMessage(m_inputThreadId, WM_QUIT, 0, 0);
+    m_inputThread.join();
+    m_inputThreadId = 0;
+}
+
+void HotkeyManager::InputThread(std::promise<bool>* started) {
+    // Keystrokes are handled as soon as they arrive, even while the process is throttled
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+    SetThreadEcoQoS(GetCurrentThread(), false);
+    ThreadCycles::RegisterThread(ThreadSubsystem::Input);
+
+    // A message-only window receives WM_INPUT for every keyboard, whichever window has focus
+    HWND window = CreateWindowExA(0, "Message", "GameOverlayHotkeys", 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr,
+        GetModuleHandle(nullptr), nullptr);
+    RAWINPUTDEVICE device = {};
+    device.usUsagePage = 0x01; // Generic desktop
+    device.usUsage = 0x06;     // Keyboard
+    device.dwFlags = RIDEV_INPUTSINK;
+    device.hwndTarget = window;
+    if (!window || !RegisterRawInputDevices(&device, 1, sizeof(device))) {
+        if (window) DestroyWindow(window);
+        started->set_value(false);
+        return;
+    }
+    m_inputThreadId = GetCurrentThreadId();
+    started->set_value(true); // Not touched after this; it lives on the starting thread's stack
+
+    bool modifiers[4] = {}; // Ctrl, Alt, Shift, Win as this thread has seen them
+    alignas(8) BYTE buffer[sizeof(RAWINPUT)];
+    MSG msg;
+    while (GetMessage(&msg, nullptr, 0, 0) > 0) {
+        if (msg.message != WM_INPUT) {
+            DispatchMessage(&msg);
+            continue;
+        }
+        LONGLONG inputQpc = QueryInputTime();
+        UINT size = sizeof(buffer);
+        if (GetRawInputData(reinterpret_cast<HRAWINPUT>(msg.lParam), RID_INPUT, buffer, &size, sizeof(RAWINPUTHEADER)) != static_cast<UINT>(-1)) {
+            const RAWINPUT* input = reinterpret_cast<const RAWINPUT*>(buffer);
+            if (input->header.dwType == RIM_TYPEKEYBOARD) {
+                OnRawKeyboard(input->data.keyboard, modifiers, inputQpc);
+            }
+        }
+        DefWindowProc(msg.hwnd, msg.message, msg.wParam, msg.lParam); // Releases the input
+    }
+
+    device.dwFlags = RIDEV_REMOVE;
+    device.hwndTarget = nullptr;
+    RegisterRawInputDevices(&device, 1, sizeof(device));
+    DestroyWindow(window);
+}
+
+void HotkeyManager::OnRawKeyboard(const RAWKEYBOARD& keyboard, bool modifiers[4], LONGLONG inputQpc) {
+    if (keyboard.VKey == 0xFF) return; // Fake key of an escape sequence
+    bool keyDown = (keyboard.Flags & RI_KEY_BREAK) == 0;
+    DWORD keyCode = keyboard.VKey;
+
+    switch (keyCode) {
+    case VK_CONTROL: case VK_LCONTROL: case VK_RCONTROL: modifiers[0] = keyDown; return;
+    case VK_MENU: case VK_LMENU: case VK_RMENU: modifiers[1] = keyDown; return;
+    case VK_SHIFT: case VK_LSHIFT: case VK_RSHIFT: modifiers[2] = keyDown; return;
+    case VK_LWIN: case VK_RWIN: modifiers[3] = keyDown; return;
+    }
+    if (!keyDown) return;
+
+    // Only the slot crosses to the main thread, which looks it up again in the table current then
+    Hotkey current(keyCode, modifiers[0], modifiers[1], modifiers[2], modifiers[3]);
+    {
+        TableReadScope reading(*this);
+        const DispatchTable* table = m_table.load();
+        if (!table || !IsBindable(current) || table->slots[GetSlot(current)] == 0) return;
+    }
+
+    bool wasEmpty;
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        wasEmpty = m_pendingActions.empty();
+        m_pendingActions.push_back({ static_cast<uint16_t>(GetSlot(current)), inputQpc });
+    }
+    // One message per batch: the main thread drains everything queued when it gets to it
+    if (wasEmpty && m_windowManager) {
+        PostMessage(m_windowManager->GetHWND(), WM_HOTKEY_ACTIONS, 0, 0);
+    }
+}
+
+void HotkeyManager::DispatchPendingActions() {
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        m_dispatchingActions.swap(m_pendingActions); // Both keep their capacity
+    }
+    for (const PendingAction& pending : m_dispatchingActions) {
+        // Actions may rebind keys, so each one looks at the newest table
+        TableReadScope reading(*this);
+        const DispatchTable* table = m_table.load();
+        uint16_t entry = table ? table->slots[pending.slot] : 0;
+        if (entry == 0) continue; // Unbound meanwhile
+        StampInput(pending.inputQpc); // The next frame is the first that can show the action
+        if (table->actions[entry - 1]) table->actions[entry - 1]();
+        if (table->triggered) table->triggered();
+    }
+    m_dispatchingActions.clear();
+}
+
 // Low-level keyboard hook procedure (static callback)
 LRESULT CALLBACK HotkeyManager::LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam) {
     if (nCode >= 0 && s_instance != nullptr) {
@@ -308,25 +471,26 @@ LRESULT CALLBACK HotkeyManager::LowLevelKeyboardProc(int nCode, WPARAM wParam, L
 
 // Check if the pressed key combination matches any registered hotkey
 bool HotkeyManager::CheckHotkeys(DWORD keyCode, bool isGlobal) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    // Create a hotkey with the current modifier state
-    Hotkey current(keyCode, m_ctrlDown, m_altDown, m_shiftDown, m_winDown);
-
-    // Check if this matches any registered hotkey
-    for (const auto& [name, pair] : m_hotkeyMap) {
-        const Hotkey& hotkey = pair.first;
+    return DispatchHotkey(Hotkey(keyCode, m_ctrlDown, m_altDown, m_shiftDown, m_winDown));
+}
 
-        if (current == hotkey) {
-            // Execute the action
-            if (pair.second) {
-                pair.second();
-            }
-            return true;
-        }
+bool HotkeyManager::DispatchHotkey(const Hotkey& current) {
+    // One read of the published table: no lock and no allocation on the hook path
+    TableReadScope reading(*this);
+    const DispatchTable* table = m_table.load();
+    if (!table || !IsBindable(current)) return false;
+    uint16_t entry = table->slots[GetSlot(current)];
+    if (entry == 0) return false;
+    StampInput(QueryInputTime());
+
+    // Execute the action
+    if (table->actions[entry - 1]) {
+        table->actions[entry - 1]();
     }
-
-    return false;
+    if (table->triggered) {
+        table->triggered();
+    }
+    return true;
 }
 
 // Update modifier key state
@@ -392,4 +556,31 @@ void HotkeyManager::RegisterDefaultHotkeys() {
             m_windowManager->SetVisible(!m_windowManager->IsVisible());
         }
         });
-}
\ No newline at end of file
+}
+void HotkeyManager::LoadBindings() {
+    // Unknown actions are ignored; a binding taken by another action keeps the default
+    const SettingsDatabase& db = SettingsDatabase::Get();
+    for (const std::string& key : db.GetKeys("hotkeys.")) {
+        UpdateHotkey(key.substr(strlen("hotkeys.")), Hotkey::FromString(std::string(db.GetString(key))));
+    }
+}
+
+void HotkeyManager::SaveBindings() const {
+    // A binding back at its default drops its stored override, so later default changes apply
+    std::map<std::string, Hotkey> defaults;
+    {
+        std::lock_guard<ProfiledMutex> lock(m_mutex);
+        defaults = m_defaultHotkeys;
+    }
+    SettingsDatabase& db = SettingsDatabase::Get();
+    for (const auto& [action, hotkey] : GetHotkeys()) {
+        auto it = defaults.find(action);
+        if (it != defaults.end() && it->second == hotkey) {
+            db.Remove("hotkeys." + action);
+        }
+        else {
+            db.SetString("hotkeys." + action, hotkey.ToString());
+        }
+    }
+    db.Save();
+}
@@ -10,6 +10,13 @@
 #include <vector>
 #include <functional>
 #include <mutex>
+#include <thread>
+#include <future>
+#include <atomic>
+#include <array>
+#include <memory>
+#include <cstdint>
+#include "CpuProfiler.h"
 
 // Forward declarations
 class WindowManager;
@@ -49,9 +56,20 @@ struct Hotkey {
 };
 
 // HotkeyManager class for global hotkey handling
+//
+// Keys are watched through Raw Input (RIDEV_INPUTSINK) on a thread of its own, which only matches
+// them against the bindings and posts WM_HOTKEY_ACTIONS to the overlay window: the actions run on
+// the main thread, and no keystroke ever waits for it, as it did with the low-level hook while the
+// main thread waited on the GPU or pumped CEF. Raw Input can't swallow keys, so the game also sees
+// the hotkey. The WH_KEYBOARD_LL hook remains the fallback when the input thread can't start, or
+// when it is turned off (to compare input latency with and without it).
 class HotkeyManager {
 public:
-    HotkeyManager(WindowManager* windowManager);
+    // Posted by the input thread when actions are queued; the window procedure calls
+    // DispatchPendingActions
+    static constexpr UINT WM_HOTKEY_ACTIONS = WM_APP + 0x48;
+
+    HotkeyManager(WindowManager* windowManager, bool useInputThread = true);
     ~HotkeyManager();
 
     // Disable copy and move
@@ -71,11 +89,26 @@ public:
     // Handle key events
     bool ProcessKeyEvent(WPARAM wParam, LPARAM lParam);
 
+    // Called after any hotkey action runs (e.g. to request a redraw)
+    void SetHotkeyTriggeredCallback(HotkeyAction callback);
+
     // Get registered hotkeys
     std::map<std::string, Hotkey> GetHotkeys() const;
 
     // Check if a key combination is already registered
     bool IsHotkeyRegistered(const Hotkey& hotkey) const;
+    // Runs the action bound to hotkey as a key press would (table lookup, action, triggered
+    // callback), on the calling thread; false when nothing is bound to it
+    bool DispatchHotkey(const Hotkey& hotkey);
+
+    // User bindings ("hotkeys.<action>" in SettingsDatabase): Load rebinds the actions registered
+    // so far, Save stores the bindings that differ from the hotkey each action was registered with
+    void LoadBindings();
+    void SaveBindings() const;
+
+    // Runs the actions the input thread matched since the last call (main thread)
+    void DispatchPendingActions();
+    bool IsRawInputActive() const { return m_inputThreadId != 0; }
 
     // Hook installation and removal
     bool InstallHook();
@@ -91,8 +124,60 @@ private:
     // Windows hook handle
     HHOOK m_keyboardHook = NULL;
 
+    // Raw Input thread; its modifier state is its own (the members below are the hook's and the
+    // window procedure's)
+    bool StartInputThread();
+    void StopInputThread();
+    void InputThread(std::promise<bool>* started);
+    void OnRawKeyboard(const RAWKEYBOARD& keyboard, bool modifiers[4], LONGLONG inputQpc);
+    std::thread m_inputThread;
+    DWORD m_inputThreadId = 0;
+    std::mutex m_pendingMutex;
+    struct PendingAction {
+        uint16_t slot;
+        LONGLONG inputQpc; // When the key arrived, for input-to-photon (0 unless measuring)
+    };
+    std::vector<PendingAction> m_pendingActions;     // Matched by the input thread, not yet dispatched
+    std::vector<PendingAction> m_dispatchingActions; // Main thread
+
+    // Dispatch table: every binding's slot (virtual key * 16 + modifier mask) holds its action's
+    // index + 1, so matching a key is one array read. Rebuilt under m_mutex on every change and
+    // published with an atomic pointer store; the hook and the input thread only load the pointer,
+    // inside a TableReadScope. A replaced table is retired and freed by a later PublishTable once no
+    // reader is inside a scope (one that entered since then loads the newer table).
+    struct DispatchTable {
+        static constexpr size_t SLOT_COUNT = 256 * 16;
+        std::array<uint16_t, SLOT_COUNT> slots = {};
+        std::vector<std::string> names;
+        std::vector<HotkeyAction> actions;
+        HotkeyAction triggered;
+    };
+    static bool IsBindable(const Hotkey& hotkey) { return hotkey.key < 256; }
+    static int GetSlot(const Hotkey& hotkey);
+    bool IsBoundToOther(const Hotkey& hotkey, const std::string& actionName) const; // m_mutex held
+    void PublishTable(); // m_mutex held
+    class TableReadScope {
+    public:
+        explicit TableReadScope(const HotkeyManager& manager) : m_readers(manager.m_tableReaders) { m_readers.fetch_add(1); }
+        ~TableReadScope() { m_readers.fetch_sub(1, std::memory_order_release); }
+
+        // Disable copy and move
+        TableReadScope(const TableReadScope&) = delete;
+        TableReadScope& operator=(const TableReadScope&) = delete;
+        TableReadScope(TableReadScope&&) = delete;
+        TableReadScope& operator=(TableReadScope&&) = delete;
+
+    private:
+        std::atomic<uint32_t>& m_readers;
+    };
+    std::atomic<const DispatchTable*> m_table{ nullptr }; // Loaded after entering a TableReadScope
+    mutable std::atomic<uint32_t> m_tableReaders{ 0 };
+    std::unique_ptr<DispatchTable> m_currentTable;                // m_mutex
+    std::vector<std::unique_ptr<DispatchTable>> m_retiredTables; // m_mutex; readers may still hold them
+
     // Map of action names to hotkeys and actions
     std::map<std::string, std::pair<Hotkey, HotkeyAction>> m_hotkeyMap;
+    std::map<std::string, Hotkey> m_defaultHotkeys; // First hotkey each action was registered with
 
     // Current state of modifier keys
     bool m_ctrlDown = false;
@@ -100,11 +185,14 @@ private:
     bool m_shiftDown = false;
     bool m_winDown = false;
 
+    // Observer notified after a hotkey action runs
+    HotkeyAction m_hotkeyTriggeredCallback;
+
     // Pointer to window manager (not owned)
     WindowManager* m_windowManager = nullptr;
 
     // Thread safety
-    mutable std::mutex m_mutex;
+    mutable PROFILE_MUTEX(m_mutex, "HotkeyManager");
 
     // Check if the key pressed matches any registered hotkey
     bool CheckHotkeys(DWORD keyCode, bool keyUp);
@@ -294,4 +294,5 @@ void HotkeySettingsPage::ApplyChanges() {
             m_hotkeyManager->UpdateHotkey(action, hotkey);
         }
     }
+    m_hotkeyManager->SaveBindings();
 }
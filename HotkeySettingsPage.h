@@ -16,6 +16,7 @@ public:
 
     // Render hotkey settings page content
     void Render() override;
+    float GetRefreshRate() const override { return 2.0f; } // Changes come from input
 
 private:
     // Render hotkey editing section
@@ -0,0 +1,502 @@
+// GameOverlay - HudLayer.cpp
+// Native HUD widgets (clock, timers, frame rate, system stats) drawn with the sprite batch
+
+#include "HudLayer.h"
+#include "RenderSystem.h"
+#include "SpriteBatch.h"
+#include "PerformanceMonitor.h"
+#include "BrowserView.h"
+#include "BrowserManager.h"
+#include "WebWidgetAtlas.h"
+#include "SettingsStore.h"
+#include "Log.h"
+#include "imgui.h"
+#include "imgui_internal.h" // ImTextCharFromUtf8
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+
+namespace {
+
+std::string ToLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+std::string Trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) return std::string();
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+const char* const DEFAULT_CLOCK_FORMAT = "%H:%M";
+
+const char* const EXAMPLE_LAYOUT =
+    "; GameOverlay HUD layout: one section per widget, drawn without the browser\n"
+    "; Widgets: clock, timer, fps, frametime, gamefps, cpu, gpu, memory, text, crosshair, web\n"
+    "; anchor: topleft, top, topright, left, center, right, bottomleft, bottom, bottomright\n"
+    "; x, y: pixels in from the anchor; scale: text size; refresh: seconds between updates\n"
+    "; color, background: #RRGGBB or #RRGGBBAA (background = none to leave it out)\n"
+    "; label: text before the value (the text of a text widget); clock: format = %H:%M:%S\n"
+    "; timer: countdown = minutes; crosshair: size, thickness, gap\n"
+    "; web: url, width, height (page pixels), fps (paints a second), budget (upload KB a frame)\n"
+    ";   [web]\n"
+    ";   url = https://example.com/chat\n"
+    ";   anchor = bottomleft\n"
+    ";   width = 320\n"
+    ";   height = 240\n"
+    ";   fps = 15\n"
+    "\n"
+    "[clock]\n"
+    "anchor = topright\n"
+    "x = 16\n"
+    "y = 16\n"
+    "format = %H:%M\n"
+    "\n"
+    "[gamefps]\n"
+    "anchor = topleft\n"
+    "x = 16\n"
+    "y = 16\n"
+    "\n"
+    "[cpu]\n"
+    "anchor = topleft\n"
+    "x = 16\n"
+    "y = 44\n"
+    "\n"
+    "[memory]\n"
+    "anchor = topleft\n"
+    "x = 16\n"
+    "y = 72\n";
+
+bool ParseType(const std::string& name, HudWidgetType& type) {
+    static const struct { const char* name; HudWidgetType type; } TYPES[] = {
+        { "clock", HudWidgetType::Clock }, { "timer", HudWidgetType::Timer },
+        { "fps", HudWidgetType::Fps }, { "frametime", HudWidgetType::FrameTime },
+        { "gamefps", HudWidgetType::GameFps }, { "cpu", HudWidgetType::Cpu },
+        { "gpu", HudWidgetType::Gpu }, { "memory", HudWidgetType::Memory },
+        { "text", HudWidgetType::Text }, { "crosshair", HudWidgetType::Crosshair },
+        { "web", HudWidgetType::Web },
+    };
+    for (const auto& entry : TYPES) {
+        if (name == entry.name) {
+            type = entry.type;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ParseAnchor(const std::string& name, HudAnchor& anchor) {
+    static const char* const ANCHORS[] = {
+        "topleft", "top", "topright", "left", "center", "right", "bottomleft", "bottom", "bottomright"
+    };
+    for (size_t i = 0; i < sizeof(ANCHORS) / sizeof(ANCHORS[0]); i++) {
+        if (name == ANCHORS[i]) {
+            anchor = static_cast<HudAnchor>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// #RRGGBB or #RRGGBBAA, into IM_COL32 order
+bool ParseColor(const std::string& text, uint32_t& color) {
+    if (text.empty() || text[0] != '#' || (text.size() != 7 && text.size() != 9)) return false;
+    char* end = nullptr;
+    unsigned long value = strtoul(text.c_str() + 1, &end, 16);
+    if (*end != '\0') return false;
+    if (text.size() == 7) value = (value << 8) | 0xFF;
+    const uint32_t r = (value >> 24) & 0xFF, g = (value >> 16) & 0xFF, b = (value >> 8) & 0xFF, a = value & 0xFF;
+    color = IM_COL32(r, g, b, a);
+    return true;
+}
+
+// strftime stops the process on specifiers it doesn't know, so only a safe set is accepted
+bool IsClockFormatValid(const std::string& format) {
+    for (size_t i = 0; i < format.size(); i++) {
+        if (format[i] != '%') continue;
+        if (++i >= format.size() || !strchr("aAbBdHIjmMpSyY%", format[i])) return false;
+    }
+    return true;
+}
+
+// What each type shows before its value until the layout says otherwise
+const char* DefaultLabel(HudWidgetType type) {
+    switch (type) {
+    case HudWidgetType::Fps: return "FPS";
+    case HudWidgetType::FrameTime: return "Frame";
+    case HudWidgetType::GameFps: return "Game FPS";
+    case HudWidgetType::Cpu: return "CPU";
+    case HudWidgetType::Gpu: return "GPU";
+    case HudWidgetType::Memory: return "RAM";
+    default: return "";
+    }
+}
+
+float DefaultRefreshSeconds(HudWidgetType type) {
+    switch (type) {
+    case HudWidgetType::Fps:
+    case HudWidgetType::FrameTime:
+    case HudWidgetType::GameFps: return 0.5f;
+    case HudWidgetType::Text:
+    case HudWidgetType::Crosshair:
+    case HudWidgetType::Web: return 0.0f; // Never changes, or redrawn with each upload
+    default: return 1.0f;
+    }
+}
+
+void ApplyValue(HudLayer::Widget& widget, const std::string& key, const std::string& value) {
+    const float number = static_cast<float>(atof(value.c_str()));
+    if (key == "anchor") {
+        if (!ParseAnchor(ToLower(value), widget.anchor)) LOG_WARNING("HUD layout: unknown anchor %s", value.c_str());
+    }
+    else if (key == "x") widget.x = number;
+    else if (key == "y") widget.y = number;
+    else if (key == "scale") widget.scale = std::clamp(number, 0.25f, 8.0f);
+    else if (key == "color") {
+        if (!ParseColor(value, widget.color)) LOG_WARNING("HUD layout: bad color %s", value.c_str());
+    }
+    else if (key == "background") {
+        if (ToLower(value) == "none") widget.background = 0;
+        else if (!ParseColor(value, widget.background)) LOG_WARNING("HUD layout: bad color %s", value.c_str());
+    }
+    else if (key == "label" || key == "text") widget.label = value;
+    else if (key == "format") {
+        if (IsClockFormatValid(value)) widget.format = value;
+        else LOG_WARNING("HUD layout: unsupported clock format %s", value.c_str());
+    }
+    else if (key == "refresh") widget.refreshSeconds = std::max(number, 0.1f);
+    else if (key == "countdown") widget.countdownSeconds = std::max(number, 0.0f) * 60.0f;
+    else if (key == "size") widget.size = std::max(number, 1.0f);
+    else if (key == "thickness") widget.thickness = std::max(number, 1.0f);
+    else if (key == "gap") widget.gap = std::max(number, 0.0f);
+    else if (key == "url") widget.url = value;
+    else if (key == "width") widget.width = std::clamp(atoi(value.c_str()), 16, 1024);
+    else if (key == "height") widget.height = std::clamp(atoi(value.c_str()), 16, 1024);
+    else if (key == "fps") widget.frameRate = std::clamp(atoi(value.c_str()), 1, 60);
+    else if (key == "budget") widget.uploadBudgetKB = static_cast<UINT>(std::max(atoi(value.c_str()), 0));
+}
+
+// Top-left corner of a width x height box at the anchor, offset inwards
+void Place(HudAnchor anchor, float offsetX, float offsetY, float width, float height,
+           int viewWidth, int viewHeight, float& x, float& y) {
+    const int column = static_cast<int>(anchor) % 3;
+    const int row = static_cast<int>(anchor) / 3;
+    x = column == 0 ? offsetX : column == 1 ? (viewWidth - width) * 0.5f + offsetX : viewWidth - width - offsetX;
+    y = row == 0 ? offsetY : row == 1 ? (viewHeight - height) * 0.5f + offsetY : viewHeight - height - offsetY;
+    x = std::floor(x);
+    y = std::floor(y);
+}
+
+RECT CombineRects(const RECT& a, const RECT& b) {
+    if (a.left >= a.right || a.top >= a.bottom) return b;
+    if (b.left >= b.right || b.top >= b.bottom) return a;
+    return { std::min(a.left, b.left), std::min(a.top, b.top), std::max(a.right, b.right), std::max(a.bottom, b.bottom) };
+}
+
+} // namespace
+
+HudLayer::~HudLayer() {
+    UnpinWebWidgets();
+}
+
+std::string HudLayer::GetLayoutPath() {
+    return SettingsStore::GetSettingsPath("Hud.ini");
+}
+
+bool HudLayer::Load(const std::string& path) {
+    // What was drawn before goes away with the next frame
+    for (const WidgetState& state : m_states) m_staleRects.push_back(state.bounds);
+    UnpinWebWidgets();
+    m_widgets.clear();
+    m_states.clear();
+    m_redrawAll = true;
+    m_loadTime = std::chrono::steady_clock::now();
+
+    std::string contents;
+    if (path.empty() || !SettingsStore::Get().Read(path, contents)) return false;
+
+    std::istringstream stream(contents);
+    std::string line;
+    Widget* widget = nullptr;
+    while (std::getline(stream, line)) {
+        line = Trim(line);
+        if (line.empty() || line[0] == ';' || line[0] == '#') continue;
+
+        if (line.front() == '[' && line.back() == ']') {
+            widget = nullptr;
+            const std::string name = ToLower(Trim(line.substr(1, line.size() - 2)));
+            HudWidgetType type;
+            if (!ParseType(name, type)) {
+                LOG_WARNING("HUD layout: unknown widget [%s]", name.c_str());
+                continue;
+            }
+            m_widgets.emplace_back();
+            widget = &m_widgets.back();
+            widget->type = type;
+            widget->label = DefaultLabel(type);
+            widget->format = DEFAULT_CLOCK_FORMAT;
+            widget->refreshSeconds = DefaultRefreshSeconds(type);
+            continue;
+        }
+
+        size_t separator = line.find('=');
+        if (!widget || separator == std::string::npos) continue;
+        ApplyValue(*widget, ToLower(Trim(line.substr(0, separator))), Trim(line.substr(separator + 1)));
+    }
+
+    m_states.resize(m_widgets.size());
+    LOG_INFO("HUD layout: %zu widget(s) from %s", m_widgets.size(), path.c_str());
+    return true;
+}
+
+bool HudLayer::WriteExampleLayout(const std::string& path) {
+    if (path.empty()) return false;
+    SettingsStore::Get().Write(path, EXAMPLE_LAYOUT);
+    return Load(path);
+}
+
+void HudLayer::SetEnabled(bool enabled) {
+    if (m_enabled == enabled) return;
+    m_enabled = enabled;
+    m_redrawAll = true;
+    if (!enabled) {
+        for (const WidgetState& state : m_states) m_staleRects.push_back(state.bounds);
+        UnpinWebWidgets();
+    }
+}
+
+void HudLayer::SetAvailable(bool available) {
+    if (m_available == available) return;
+    m_available = available;
+    m_redrawAll = true;
+    if (!available) {
+        for (const WidgetState& state : m_states) m_staleRects.push_back(state.bounds);
+        UnpinWebWidgets();
+    }
+}
+
+bool HudLayer::IsRefreshDue(std::chrono::steady_clock::time_point now) const {
+    if (!m_staleRects.empty()) return true;
+    return IsShown() && (m_redrawAll || now >= m_nextRefresh);
+}
+
+bool HudLayer::UpdateText(const Widget& widget, WidgetState& state, const PerformanceMonitor* performanceMonitor,
+                          std::chrono::steady_clock::time_point now) const {
+    char text[TEXT_CAPACITY];
+    const char* label = widget.label.c_str();
+    const char* space = widget.label.empty() ? "" : " ";
+    switch (widget.type) {
+    case HudWidgetType::Clock: {
+        char clock[TEXT_CAPACITY] = {};
+        const time_t seconds = time(nullptr);
+        tm local = {};
+        if (localtime_s(&local, &seconds) != 0 || strftime(clock, sizeof(clock), widget.format.c_str(), &local) == 0) {
+            clock[0] = '\0';
+        }
+        snprintf(text, sizeof(text), "%s%s%s", label, space, clock);
+        break;
+    }
+    case HudWidgetType::Timer: {
+        float elapsed = std::chrono::duration<float>(now - m_loadTime).count();
+        if (widget.countdownSeconds > 0.0f) elapsed = std::max(widget.countdownSeconds - elapsed, 0.0f);
+        const int total = static_cast<int>(elapsed);
+        if (total >= 3600) {
+            snprintf(text, sizeof(text), "%s%s%d:%02d:%02d", label, space, total / 3600, total / 60 % 60, total % 60);
+        }
+        else {
+            snprintf(text, sizeof(text), "%s%s%02d:%02d", label, space, total / 60, total % 60);
+        }
+        break;
+    }
+    case HudWidgetType::Fps:
+        snprintf(text, sizeof(text), "%s%s%.0f", label, space, performanceMonitor ? performanceMonitor->GetFramesPerSecond() : 0.0f);
+        break;
+    case HudWidgetType::FrameTime:
+        // The overlay's own CPU time per frame; the wall time is mostly throttle sleep
+        snprintf(text, sizeof(text), "%s%s%.1f ms", label, space,
+            performanceMonitor ? performanceMonitor->GetAverageFrameTimeBreakdown().workMs : 0.0f);
+        break;
+    case HudWidgetType::GameFps:
+        if (performanceMonitor && performanceMonitor->GetGamePresentSample().valid) {
+            snprintf(text, sizeof(text), "%s%s%.0f", label, space, performanceMonitor->GetGamePresentSample().framesPerSecond);
+        }
+        else {
+            snprintf(text, sizeof(text), "%s%s--", label, space);
+        }
+        break;
+    case HudWidgetType::Cpu:
+        snprintf(text, sizeof(text), "%s%s%.0f%%", label, space, performanceMonitor ? performanceMonitor->GetCpuUsagePercent() : 0.0f);
+        break;
+    case HudWidgetType::Gpu:
+        snprintf(text, sizeof(text), "%s%s%.0f%%", label, space, performanceMonitor ? performanceMonitor->GetGpuUsagePercent() : 0.0f);
+        break;
+    case HudWidgetType::Memory:
+        snprintf(text, sizeof(text), "%s%s%.0f MB", label, space, performanceMonitor ? performanceMonitor->GetTotalMemoryUsageMB() : 0.0f);
+        break;
+    case HudWidgetType::Text:
+        snprintf(text, sizeof(text), "%s", label);
+        break;
+    case HudWidgetType::Crosshair:
+    case HudWidgetType::Web:
+        text[0] = '\0';
+        break;
+    }
+
+    if (strcmp(text, state.text) == 0) return false;
+    memcpy(state.text, text, sizeof(text));
+    state.textWidth = MeasureText(state.text, widget.scale);
+    return true;
+}
+
+float HudLayer::MeasureText(const char* text, float scale) const {
+    ImFont* font = ImGui::GetIO().Fonts->Fonts.empty() ? nullptr : ImGui::GetIO().Fonts->Fonts[0];
+    if (!font) return 0.0f;
+    float width = 0.0f;
+    const char* end = text + strlen(text);
+    while (text < end) {
+        unsigned int c = 0;
+        text += ImTextCharFromUtf8(&c, text, end);
+        if (const ImFontGlyph* glyph = font->FindGlyph(static_cast<ImWchar>(c))) width += glyph->AdvanceX * scale;
+    }
+    return width;
+}
+
+void HudLayer::DrawLabel(RenderSystem* renderSystem, const char* text, float x, float y, float scale, uint32_t color) const {
+    ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    ImFont* font = atlas->Fonts.empty() ? nullptr : atlas->Fonts[0];
+    if (!font) return;
+    SpriteBatch* spriteBatch = renderSystem->GetSpriteBatch();
+    const D3D12_GPU_DESCRIPTOR_HANDLE texture = { static_cast<UINT64>(atlas->TexID) };
+    const char* end = text + strlen(text);
+    while (text < end) {
+        unsigned int c = 0;
+        text += ImTextCharFromUtf8(&c, text, end);
+        const ImFontGlyph* glyph = font->FindGlyph(static_cast<ImWchar>(c));
+        if (!glyph) continue;
+        if (glyph->Visible) {
+            const float texRect[4] = { glyph->U0, glyph->V0, glyph->U1, glyph->V1 };
+            spriteBatch->DrawSprite(texture, x + glyph->X0 * scale, y + glyph->Y0 * scale,
+                (glyph->X1 - glyph->X0) * scale, (glyph->Y1 - glyph->Y0) * scale, color, texRect);
+        }
+        x += glyph->AdvanceX * scale;
+    }
+}
+
+bool HudLayer::PinWebWidget(const Widget& widget, WidgetState& state) {
+    if (state.webWidgetId != 0) return true;
+    if (state.webFailed || !m_browserView || widget.url.empty()) return false;
+    if (!m_browserView->IsBrowserStarted()) {
+        m_browserView->RequestBrowserStart();
+        return false;
+    }
+    BrowserManager* browserManager = m_browserView->GetBrowserManager();
+    if (!browserManager) return false;
+
+    state.webWidgetId = browserManager->PinWidget(widget.url, widget.width, widget.height, widget.frameRate,
+        static_cast<UINT64>(widget.uploadBudgetKB) * 1024);
+    if (state.webWidgetId == 0) {
+        // Not retried every frame; reloading the layout tries again
+        state.webFailed = true;
+        LOG_WARNING("HUD layout: could not pin %s (%dx%d)", widget.url.c_str(), widget.width, widget.height);
+        return false;
+    }
+    return true;
+}
+
+void HudLayer::UnpinWebWidgets() {
+    BrowserManager* browserManager = m_browserView ? m_browserView->GetBrowserManager() : nullptr;
+    for (WidgetState& state : m_states) {
+        if (state.webWidgetId != 0 && browserManager) browserManager->UnpinWidget(state.webWidgetId);
+        state.webWidgetId = 0;
+        state.webVersion = 0;
+    }
+}
+
+void HudLayer::Draw(RenderSystem* renderSystem, const PerformanceMonitor* performanceMonitor) {
+    if (!renderSystem || !renderSystem->GetSpriteBatch()) return;
+    for (const RECT& rect : m_staleRects) renderSystem->AddDirtyRect(rect);
+    m_staleRects.clear();
+    if (!IsShown()) return;
+
+    const int viewWidth = renderSystem->GetWidth();
+    const int viewHeight = renderSystem->GetHeight();
+    if (viewWidth != m_lastWidth || viewHeight != m_lastHeight) {
+        m_lastWidth = viewWidth;
+        m_lastHeight = viewHeight;
+        m_redrawAll = true;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const ImFont* font = ImGui::GetIO().Fonts->Fonts.empty() ? nullptr : ImGui::GetIO().Fonts->Fonts[0];
+    const float fontSize = font ? font->FontSize : 13.0f;
+    SpriteBatch* spriteBatch = renderSystem->GetSpriteBatch();
+    m_nextRefresh = std::chrono::steady_clock::time_point::max();
+
+    for (size_t i = 0; i < m_widgets.size(); i++) {
+        const Widget& widget = m_widgets[i];
+        WidgetState& state = m_states[i];
+
+        bool changed = m_redrawAll;
+        if (m_redrawAll || (widget.refreshSeconds > 0.0f && now >= state.nextUpdate)) {
+            changed |= UpdateText(widget, state, performanceMonitor, now);
+            state.nextUpdate = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<float>(widget.refreshSeconds));
+        }
+        if (widget.refreshSeconds > 0.0f) m_nextRefresh = std::min(m_nextRefresh, state.nextUpdate);
+
+        float x = 0.0f, y = 0.0f;
+        RECT bounds = {};
+        if (widget.type == HudWidgetType::Crosshair) {
+            const float extent = widget.size * widget.scale + widget.thickness;
+            Place(widget.anchor, widget.x, widget.y, extent * 2.0f, extent * 2.0f, viewWidth, viewHeight, x, y);
+            spriteBatch->DrawCrosshair(x + extent, y + extent, widget.size * widget.scale, widget.thickness,
+                widget.gap * widget.scale, widget.color);
+            bounds = { static_cast<LONG>(x), static_cast<LONG>(y),
+                static_cast<LONG>(std::ceil(x + extent * 2.0f)), static_cast<LONG>(std::ceil(y + extent * 2.0f)) };
+        }
+        else if (widget.type == HudWidgetType::Web) {
+            // Nothing is drawn until the pinned page's first paint is in the atlas
+            WebWidgetAtlas* atlas = m_browserView ? m_browserView->GetWebWidgetAtlas() : nullptr;
+            D3D12_GPU_DESCRIPTOR_HANDLE texture = {};
+            float texRect[4] = {};
+            UINT64 version = 0;
+            if (!PinWebWidget(widget, state) || !atlas ||
+                !atlas->GetWidgetRegion(state.webWidgetId, texture, texRect, version)) continue;
+            const float boxWidth = widget.width * widget.scale;
+            const float boxHeight = widget.height * widget.scale;
+            Place(widget.anchor, widget.x, widget.y, boxWidth, boxHeight, viewWidth, viewHeight, x, y);
+            spriteBatch->DrawSprite(texture, x, y, boxWidth, boxHeight, 0xFFFFFFFF, texRect);
+            changed |= version != state.webVersion;
+            state.webVersion = version;
+            bounds = { static_cast<LONG>(x), static_cast<LONG>(y),
+                static_cast<LONG>(std::ceil(x + boxWidth)), static_cast<LONG>(std::ceil(y + boxHeight)) };
+        }
+        else {
+            if (state.text[0] == '\0') continue;
+            const float padding = PADDING * widget.scale;
+            const float boxWidth = state.textWidth + padding * 2.0f;
+            const float boxHeight = fontSize * widget.scale + padding * 2.0f;
+            Place(widget.anchor, widget.x, widget.y, boxWidth, boxHeight, viewWidth, viewHeight, x, y);
+            if (widget.background) spriteBatch->DrawRect(x, y, boxWidth, boxHeight, widget.background);
+            DrawLabel(renderSystem, state.text, x + padding, y + padding, widget.scale, widget.color);
+            bounds = { static_cast<LONG>(x), static_cast<LONG>(y),
+                static_cast<LONG>(std::ceil(x + boxWidth)), static_cast<LONG>(std::ceil(y + boxHeight)) };
+        }
+
+        // Text only grows or shrinks on the side away from its anchor; the old extent is dirty too
+        if (changed) renderSystem->AddDirtyRect(CombineRects(state.bounds, bounds));
+        state.bounds = bounds;
+    }
+    m_redrawAll = false;
+
+    // Drawn beneath the UI
+    spriteBatch->Flush(renderSystem->GetCommandList());
+}
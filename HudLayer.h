@@ -0,0 +1,133 @@
+// GameOverlay - HudLayer.h
+// Native HUD widgets (clock, timers, frame rate, system stats) drawn with the sprite batch
+
+#pragma once
+
+#include <windows.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class RenderSystem;
+class PerformanceMonitor;
+class BrowserView;
+
+enum class HudWidgetType {
+    Clock,     // Local time, strftime format
+    Timer,     // Elapsed since the layout loaded, or a countdown
+    Fps,       // The overlay's own frame rate
+    FrameTime,
+    GameFps,   // The foreground game's frame rate (ETW)
+    Cpu,
+    Gpu,
+    Memory,    // The overlay and its browser processes
+    Text,
+    Crosshair,
+    Web        // A pinned page (chat, alerts, a map); see BrowserManager::PinWidget
+};
+
+enum class HudAnchor {
+    TopLeft, Top, TopRight,
+    Left, Center, Right,
+    BottomLeft, Bottom, BottomRight
+};
+
+// Small always-on items that would otherwise each take a Chromium renderer. The layout is a file
+// (Hud.ini) of one [type] section per widget with key = value lines; see WriteExampleLayout.
+//
+// Draw runs every rendered frame on the render thread, beneath the UI. Each widget's text is only
+// reformatted at its refresh interval and marks its rect dirty only when it changed, so a HUD
+// alone presents a few small rects a second; the main loop asks IsRefreshDue to schedule that.
+class HudLayer {
+public:
+    struct Widget {
+        HudWidgetType type = HudWidgetType::Text;
+        HudAnchor anchor = HudAnchor::TopLeft;
+        float x = 16.0f;          // Pixels in from the anchor
+        float y = 16.0f;
+        float scale = 1.0f;       // Of the UI font; crosshair arm length in pixels is size * scale
+        uint32_t color = 0xFFFFFFFF;      // IM_COL32 order
+        uint32_t background = 0x80000000; // 0: none
+        std::string label;        // Text before the value; the whole text of a Text widget
+        std::string format;       // Clock only
+        float refreshSeconds = 1.0f;
+        float countdownSeconds = 0.0f; // Timer: counts down from this when set
+        float size = 10.0f;       // Crosshair
+        float thickness = 2.0f;
+        float gap = 4.0f;
+        std::string url;          // Web: drawn at width x height * scale
+        int width = 320;
+        int height = 240;
+        int frameRate = 30;
+        UINT uploadBudgetKB = 256; // Per frame; 0: no limit
+    };
+
+    HudLayer() = default;
+    ~HudLayer();
+
+    // Disable copy and move
+    HudLayer(const HudLayer&) = delete;
+    HudLayer& operator=(const HudLayer&) = delete;
+    HudLayer(HudLayer&&) = delete;
+    HudLayer& operator=(HudLayer&&) = delete;
+
+    // %LOCALAPPDATA%\GameOverlay\Hud.ini
+    static std::string GetLayoutPath();
+
+    // Replaces the widgets; false (and no widgets) when the file doesn't exist
+    bool Load(const std::string& path);
+    // A commented layout with a few widgets, then loaded
+    bool WriteExampleLayout(const std::string& path);
+    const std::vector<Widget>& GetWidgets() const { return m_widgets; }
+
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const { return m_enabled; }
+    // Enabled, available and with widgets: the overlay window stays up for it while hidden
+    bool IsShown() const { return m_enabled && m_available && !m_widgets.empty(); }
+    // A compact window doesn't cover the screen corners the widgets sit in
+    void SetAvailable(bool available);
+    // Web widgets pin their browsers through it (and start the browser if it isn't yet)
+    void SetBrowserView(BrowserView* browserView) { m_browserView = browserView; }
+
+    // Render thread, after the static layers and before ImGui records
+    void Draw(RenderSystem* renderSystem, const PerformanceMonitor* performanceMonitor);
+    bool IsRefreshDue(std::chrono::steady_clock::time_point now) const;
+
+private:
+    static constexpr size_t TEXT_CAPACITY = 64;
+    static constexpr float PADDING = 4.0f;
+
+    // Per widget state, parallel to m_widgets
+    struct WidgetState {
+        char text[TEXT_CAPACITY] = {};
+        float textWidth = 0.0f;
+        std::chrono::steady_clock::time_point nextUpdate;
+        RECT bounds = {}; // As last drawn, back buffer pixels
+        int webWidgetId = 0;   // Pinned browser, 0 until pinned
+        UINT64 webVersion = 0; // Of the atlas region as last drawn
+        bool webFailed = false;
+    };
+
+    // Formats the widget's text; true when it changed
+    bool UpdateText(const Widget& widget, WidgetState& state, const PerformanceMonitor* performanceMonitor,
+                    std::chrono::steady_clock::time_point now) const;
+    float MeasureText(const char* text, float scale) const;
+    void DrawLabel(RenderSystem* renderSystem, const char* text, float x, float y, float scale, uint32_t color) const;
+    // True once the widget's browser is pinned
+    bool PinWebWidget(const Widget& widget, WidgetState& state);
+    void UnpinWebWidgets();
+
+    BrowserView* m_browserView = nullptr;
+    std::vector<Widget> m_widgets;
+    std::vector<WidgetState> m_states;
+    std::vector<RECT> m_staleRects; // Drawn before, not any more: dirty on the next Draw
+    bool m_enabled = false;
+    bool m_available = true;
+    bool m_redrawAll = true; // Everything is dirty on the next Draw (load, enable, resize)
+    int m_lastWidth = 0;
+    int m_lastHeight = 0;
+    std::chrono::steady_clock::time_point m_loadTime = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point m_nextRefresh;
+};
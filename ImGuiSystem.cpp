@@ -6,31 +6,174 @@
 #include "imgui.h"
 #include "imgui_impl_win32.h"
 #include "imgui_impl_dx12.h"
+#include "imgui_internal.h" // ImTextCharFromUtf8
+#include "WidgetCache.h"
+#include "SettingsStore.h"
+#include "FileUtil.h"
+#include "JobSystem.h"
+#include "ThreadCycles.h"
+#include "Log.h"
+#include "PerformanceMonitor.h" // TextEmissionBenchmark
 #include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+
+#if !GAMEOVERLAY_RUNTIME_SHADERS
+// Generated by the build from shaders/*.hlsl
+#include "ImGuiBindlessVS.h"
+#include "ImGuiBindlessPS.h"
+#endif
 
 // Forward declare message handler from imgui_impl_win32.cpp
 extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
-ImGuiSystem::ImGuiSystem(HWND hwnd, RenderSystem* renderSystem)
-    : m_renderSystem(renderSystem), m_hwnd(hwnd) {
-    InitializeImGui(hwnd, renderSystem);
+ImGuiSystem::ImGuiSystem(HWND hwnd, float dpiScale)
+    : m_hwnd(hwnd) {
+    // The first atlas is baked at the monitor's scale, not rebuilt by the first frame
+    m_dpiScale = m_pendingDpiScale = dpiScale > 0.0f ? dpiScale : 1.0f;
+    InitializeImGui(hwnd);
 }
 
 ImGuiSystem::~ImGuiSystem() {
+    WaitForBuild();
+    m_recordCounter.Wait();
+    for (BuiltFrame& frame : m_frames) {
+        for (ImDrawList* list : frame.lists) {
+            IM_DELETE(list);
+        }
+        frame.lists.clear();
+    }
+    ReleaseUiLayerTarget();
+    if (m_loadedFontAtlas) IM_DELETE(m_loadedFontAtlas);
     ShutdownImGui();
 }
 
-void ImGuiSystem::InitializeImGui(HWND hwnd, RenderSystem* renderSystem) {
-    // Create descriptor heap for ImGui
-    D3D12_DESCRIPTOR_HEAP_DESC desc = {};
-    desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    desc.NumDescriptors = 1;
-    desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+namespace {
+    // Multiply-xor over 8-byte words: only has to tell one frame's draw data from the next
+    uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+        constexpr uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ull;
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), bytes += sizeof(uint64_t)) {
+            uint64_t word;
+            memcpy(&word, bytes, sizeof(word));
+            hash = (hash ^ word) * MULTIPLIER;
+            hash ^= hash >> 29;
+        }
+        if (size > 0) {
+            uint64_t word = static_cast<uint64_t>(size) << 56;
+            memcpy(&word, bytes, size);
+            hash = (hash ^ word) * MULTIPLIER;
+            hash ^= hash >> 29;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    uint64_t HashValue(uint64_t hash, T value) {
+        return HashBytes(hash, &value, sizeof(value));
+    }
+
+    // Font atlas cache layout: FontAtlasCacheHeader, the custom rects' packed positions (X, Y as
+    // uint16), one FontAtlasCacheFont per font followed by its ImFontGlyph array, then the Alpha8 pixels
+    struct FontAtlasCacheHeader {
+        static constexpr uint32_t MAGIC = 0x41464F47; // "GOFA"
+        static constexpr uint32_t VERSION = 2;
+        uint32_t magic = MAGIC;
+        uint32_t version = VERSION;
+        uint32_t imguiVersion = IMGUI_VERSION_NUM;
+        uint32_t glyphSize = sizeof(ImFontGlyph);
+        uint64_t inputHash = 0;
+        uint64_t loadedBlocks[4] = {}; // Glyph blocks the atlas was baked with
+        int32_t texWidth = 0;
+        int32_t texHeight = 0;
+        uint32_t fontCount = 0;
+        uint32_t customRectCount = 0;
+        ImVec2 texUvScale;
+        ImVec2 texUvWhitePixel;
+        ImVec4 texUvLines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+    };
+
+    struct FontAtlasCacheFont {
+        float fontSize = 0.0f;
+        float ascent = 0.0f;
+        float descent = 0.0f;
+        int32_t metricsTotalSurface = 0;
+        uint32_t glyphCount = 0;
+    };
+
+    std::string GetFontAtlasCachePath() {
+        std::string directory = GetAppDataDirectory();
+        if (directory.empty()) {
+            return std::string(); // No profile directory; the atlas is baked every launch
+        }
+        return directory + "\\FontAtlas.bin";
+    }
 
-    if (FAILED(renderSystem->GetDevice()->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&m_srvDescHeap)))) {
-        throw std::runtime_error("Failed to create descriptor heap for ImGui");
+    // Whole file, or empty when there is none
+    std::vector<uint8_t> ReadFontAtlasCache() {
+        std::vector<uint8_t> data;
+        std::string path = GetFontAtlasCachePath();
+        FILE* file = nullptr;
+        if (path.empty() || fopen_s(&file, path.c_str(), "rb") != 0 || !file) return data;
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        if (size > 0) {
+            data.resize(static_cast<size_t>(size));
+            if (fread(data.data(), 1, data.size(), file) != data.size()) data.clear();
+        }
+        fclose(file);
+        return data;
     }
+}
+
+// ImGui's SRVs (font atlas) come from the shared shader-visible heap
+static void AllocateImGuiDescriptor(ImGui_ImplDX12_InitInfo* info, D3D12_CPU_DESCRIPTOR_HANDLE* outCpuHandle,
+    D3D12_GPU_DESCRIPTOR_HANDLE* outGpuHandle) {
+    ResourceManager* resourceManager = static_cast<ResourceManager*>(info->UserData);
+    ResourceDescriptor descriptor = resourceManager->AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    *outCpuHandle = descriptor.cpuHandle;
+    *outGpuHandle = descriptor.gpuHandle;
+}
+
+static void FreeImGuiDescriptor(ImGui_ImplDX12_InitInfo* info, D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle,
+    D3D12_GPU_DESCRIPTOR_HANDLE) {
+    ResourceManager* resourceManager = static_cast<ResourceManager*>(info->UserData);
+    resourceManager->FreeDescriptor(
+        resourceManager->GetDescriptorFromCpuHandle(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, cpuHandle));
+}
+
+// ResourceDescriptorHeap: Shader Model 6.6 and resource binding tier 3
+static bool SupportsBindless(ID3D12Device* device) {
+    D3D12_FEATURE_DATA_SHADER_MODEL shaderModel = { D3D_SHADER_MODEL_6_6 };
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+    return SUCCEEDED(device->CheckFeatureSupport(D3D12_FEATURE_SHADER_MODEL, &shaderModel, sizeof(shaderModel))) &&
+        shaderModel.HighestShaderModel >= D3D_SHADER_MODEL_6_6 &&
+        SUCCEEDED(device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options))) &&
+        options.ResourceBindingTier >= D3D12_RESOURCE_BINDING_TIER_3;
+}
 
+// Vertex/index memory for one RenderDrawData call, from the upload ring
+static bool AllocateImGuiGeometry(ImGui_ImplDX12_InitInfo* info, UINT64 size, UINT64 alignment,
+    void** outCpuAddress, D3D12_GPU_VIRTUAL_ADDRESS* outGpuAddress) {
+    const ImGuiSystem* system = static_cast<const ImGuiSystem*>(ImGui::GetIO().UserData);
+    if (!system || !system->IsGeometryRingEnabled()) return false;
+
+    ResourceManager* resourceManager = static_cast<ResourceManager*>(info->UserData);
+    UploadAllocation allocation = resourceManager->AllocateUpload(size, alignment);
+    if (allocation.temporary) {
+        resourceManager->GrowUploadRing();
+    }
+    *outCpuAddress = allocation.cpuAddress;
+    *outGpuAddress = allocation.gpuAddress;
+    return true;
+}
+
+void ImGuiSystem::InitializeImGui(HWND hwnd) {
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
     m_imguiContext = ImGui::CreateContext();
@@ -38,6 +181,14 @@ void ImGuiSystem::InitializeImGui(HWND hwnd, RenderSystem* renderSystem) {
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;  // Enable Keyboard Controls
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;      // Enable Docking
 
+    // Window layout is saved through SettingsStore rather than by ImGui on the render thread
+    io.IniFilename = nullptr;
+    m_iniPath = SettingsStore::GetSettingsPath("imgui.ini");
+    std::string iniSettings;
+    if (SettingsStore::Get().Read(m_iniPath, iniSettings)) {
+        ImGui::LoadIniSettingsFromMemory(iniSettings.data(), iniSettings.size());
+    }
+
     // Setup Dear ImGui style
     ImGui::StyleColorsDark();
 
@@ -46,34 +197,67 @@ void ImGuiSystem::InitializeImGui(HWND hwnd, RenderSystem* renderSystem) {
     style.WindowRounding = 0.0f;
     style.Colors[ImGuiCol_WindowBg].w = 1.0f;
 
-    // Setup Platform/Renderer backends
+    // Setup Platform backend
     if (!ImGui_ImplWin32_Init(hwnd)) {
         throw std::runtime_error("Failed to initialize ImGui Win32 backend");
     }
+    io.UserData = this; // For RequestGlyphs and GetCurrentDpiScale
+
+    ImFontSetGlyphEmitKernel(-1);
+    LOG_INFO("ImGui vertex emission: %s", GetVertexEmissionKernelName());
+}
 
-    if (!ImGui_ImplDX12_Init(
-        renderSystem->GetDevice(),
-        3, // Num frames in flight
-        DXGI_FORMAT_R8G8B8A8_UNORM,
-        m_srvDescHeap.Get(),
-        m_srvDescHeap->GetCPUDescriptorHandleForHeapStart(),
-        m_srvDescHeap->GetGPUDescriptorHandleForHeapStart())) {
+void ImGuiSystem::InitializeRenderer(RenderSystem* renderSystem) {
+    InstallLoadedFontAtlas();
+    m_renderSystem = renderSystem;
+    ResourceManager* resourceManager = renderSystem->GetResourceManager();
+    ImGui_ImplDX12_InitInfo initInfo;
+    initInfo.Device = renderSystem->GetDevice();
+    initInfo.CommandQueue = renderSystem->GetCommandQueue();
+    // The backend rotates its buffers on its own counter, once per RenderDrawData call: sized for the
+    // most frames we ever run, with two calls a frame while the UI layer is updated (layer, then live part)
+    initInfo.NumFramesInFlight = RenderSystem::MAX_FRAMES_IN_FLIGHT * 2;
+    initInfo.RTVFormat = renderSystem->GetSceneFormat();
+    initInfo.DSVFormat = DXGI_FORMAT_UNKNOWN;
+    initInfo.UserData = resourceManager;
+    initInfo.SrvDescriptorHeap = resourceManager->GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    initInfo.SrvDescriptorAllocFn = AllocateImGuiDescriptor;
+    initInfo.SrvDescriptorFreeFn = FreeImGuiDescriptor;
+    initInfo.GeometryAllocFn = AllocateImGuiGeometry;
+#if !GAMEOVERLAY_RUNTIME_SHADERS
+    if (SupportsBindless(initInfo.Device)) {
+        initInfo.BindlessVertexShader = { g_ImGuiBindlessVS, sizeof(g_ImGuiBindlessVS) };
+        initInfo.BindlessPixelShader = { g_ImGuiBindlessPS, sizeof(g_ImGuiBindlessPS) };
+    }
+#endif
+    if (!ImGui_ImplDX12_Init(&initInfo)) {
         throw std::runtime_error("Failed to initialize ImGui DirectX 12 backend");
     }
+    m_rendererInitialized = true;
+}
 
-    // Load fonts
-    io.Fonts->AddFontDefault();
-
-    // Add additional fonts for UI system
-    ImFontConfig config;
-    config.MergeMode = false;
-
-    // Larger font for headers (size 18)
-    static const ImWchar ranges[] = { 0x0020, 0xFFFF, 0 };
-    io.Fonts->AddFontFromFileTTF("C:\\Windows\\Fonts\\segoeui.ttf", 18.0f, &config, ranges);
+bool ImGuiSystem::IsBindless() const {
+    return m_rendererInitialized && ImGui_ImplDX12_IsBindless();
+}
 
-    // Medium font for subheadings (size 16)
-    io.Fonts->AddFontFromFileTTF("C:\\Windows\\Fonts\\segoeui.ttf", 16.0f, &config, ranges);
+void ImGuiSystem::LoadFonts() {
+    PROFILE_ZONE("Load Fonts");
+    // Latin-1 and General Punctuation up front, plus whatever the last session needed (from the
+    // atlas cache), the rest as text needs it
+    m_loadedGlyphBlocks.set(0x00);
+    m_loadedGlyphBlocks.set(0x20);
+    std::vector<uint8_t> cache = ReadFontAtlasCache();
+    if (cache.size() >= sizeof(FontAtlasCacheHeader)) {
+        FontAtlasCacheHeader header;
+        memcpy(&header, cache.data(), sizeof(header));
+        if (header.magic == FontAtlasCacheHeader::MAGIC && header.version == FontAtlasCacheHeader::VERSION) {
+            for (size_t block = 0; block < GLYPH_BLOCK_COUNT; block++) {
+                if (header.loadedBlocks[block / 64] & (1ull << (block % 64))) m_loadedGlyphBlocks.set(block);
+            }
+        }
+    }
+    m_loadedFontAtlas = IM_NEW(ImFontAtlas)();
+    BuildFontAtlas(m_loadedFontAtlas, cache);
 
     // Icon font for UI elements
     static const ImWchar icons_ranges[] = { 0xF000, 0xF3FF, 0 };
@@ -87,14 +271,309 @@ void ImGuiSystem::InitializeImGui(HWND hwnd, RenderSystem* renderSystem) {
     // For demo purposes, we're just using the default font as a placeholder
 }
 
+void ImGuiSystem::InstallLoadedFontAtlas() {
+    if (!m_loadedFontAtlas) return;
+
+    // The context owns it from here on, as it did the empty atlas it was created with
+    ImGuiContext& context = *ImGui::GetCurrentContext();
+    if (context.FontAtlasOwnedByContext) IM_DELETE(context.IO.Fonts);
+    context.IO.Fonts = m_loadedFontAtlas;
+    context.FontAtlasOwnedByContext = true;
+    m_loadedFontAtlas = nullptr;
+}
+
+void ImGuiSystem::AddFonts(ImFontAtlas* atlas) {
+    ImFontConfig defaultConfig;
+    defaultConfig.SizePixels = 13.0f * m_dpiScale;
+    atlas->AddFontDefault(&defaultConfig);
+
+    // Consecutive loaded blocks become one range; the control characters below 0x20 are skipped
+    m_glyphRanges.clear();
+    for (size_t block = 0; block < GLYPH_BLOCK_COUNT; block++) {
+        if (!m_loadedGlyphBlocks.test(block)) continue;
+        ImWchar first = static_cast<ImWchar>(block == 0 ? 0x0020 : block << 8);
+        ImWchar last = static_cast<ImWchar>((block << 8) | 0xFF);
+        if (!m_glyphRanges.empty() && m_glyphRanges.back() + 1 == first) {
+            m_glyphRanges.back() = last;
+        }
+        else {
+            m_glyphRanges.push_back(first);
+            m_glyphRanges.push_back(last);
+        }
+    }
+    m_glyphRanges.push_back(0);
+
+    // Larger font for headers (size 18), medium font for subheadings (size 16): one distance field
+    // bake serves both at any DPI scale; bitmap bakes when the font can't be read that way
+    const char* segoeUiPath = "C:\\Windows\\Fonts\\segoeui.ttf";
+    const float headerSizes[] = { 18.0f * m_dpiScale, 16.0f * m_dpiScale };
+    if (m_distanceFieldFont.IsLoaded() || m_distanceFieldFont.Load(segoeUiPath)) {
+        m_distanceFieldFont.AddFonts(atlas, headerSizes, 2, m_glyphRanges.data());
+        return;
+    }
+    ImFontConfig config;
+    config.MergeMode = false;
+    for (float size : headerSizes) {
+        atlas->AddFontFromFileTTF(segoeUiPath, size, &config, m_glyphRanges.data());
+    }
+}
+
+void ImGuiSystem::RequestGlyphs(const char* text) {
+    if (!text || !ImGui::GetCurrentContext()) return;
+    ImGuiSystem* system = static_cast<ImGuiSystem*>(ImGui::GetIO().UserData);
+    if (!system) return;
+
+    while (*text) {
+        // ASCII is always loaded; only multi-byte sequences need decoding
+        if (static_cast<unsigned char>(*text) < 0x80) {
+            text++;
+            continue;
+        }
+        unsigned int codepoint = 0;
+        text += ImTextCharFromUtf8(&codepoint, text, nullptr);
+        system->RequestGlyph(codepoint);
+    }
+}
+
+void ImGuiSystem::RequestGlyph(unsigned int codepoint) {
+    if (codepoint > 0xFFFF) return;
+    size_t block = codepoint >> 8;
+    if (!m_loadedGlyphBlocks.test(block)) {
+        m_requestedGlyphBlocks.set(block);
+    }
+}
+
+float ImGuiSystem::GetCurrentDpiScale() {
+    if (!ImGui::GetCurrentContext()) return 1.0f;
+    const ImGuiSystem* system = static_cast<const ImGuiSystem*>(ImGui::GetIO().UserData);
+    return system ? system->m_dpiScale : 1.0f;
+}
+
+void ImGuiSystem::RebuildFontAtlas() {
+    PROFILE_ZONE("Glyph Atlas Rebuild");
+    m_loadedGlyphBlocks |= m_requestedGlyphBlocks;
+    m_requestedGlyphBlocks.reset();
+    WidgetCache::InvalidateAll(); // Cached vertices have the old atlas's UVs
+
+    // The backend's font texture is recreated from the new atlas by the next NewFrame
+    ReleaseDeviceObjects();
+    ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    atlas->Clear();
+    BuildFontAtlas(atlas, {});
+}
+
+void ImGuiSystem::BuildFontAtlas(ImFontAtlas* atlas, const std::vector<uint8_t>& cache) {
+    AddFonts(atlas);
+    m_fontAtlasFromCache = RestoreFontAtlas(atlas, cache);
+    if (!m_fontAtlasFromCache) {
+        // Baked now rather than by the backend's first NewFrame, so the result can be saved
+        PROFILE_ZONE("Font Atlas Bake");
+        atlas->Build();
+        m_distanceFieldFont.WriteGlyphs(atlas);
+        SaveFontAtlasCache(atlas);
+    }
+}
+
+uint64_t ImGuiSystem::HashFontAtlasInputs(const ImFontAtlas* atlas) const {
+    // Everything the rasterizer and packer read; the font data itself stands in for the file's identity
+    uint64_t hash = HashValue(0, atlas->Flags);
+    hash = HashValue(hash, atlas->TexDesiredWidth);
+    hash = HashValue(hash, atlas->TexGlyphPadding);
+    hash = HashValue(hash, atlas->Sources.Size);
+    for (const ImFontConfig& source : atlas->Sources) {
+        hash = HashBytes(hash, source.FontData, static_cast<size_t>(source.FontDataSize));
+        hash = HashValue(hash, source.FontNo);
+        hash = HashValue(hash, source.MergeMode);
+        hash = HashValue(hash, source.PixelSnapH);
+        hash = HashValue(hash, source.OversampleH);
+        hash = HashValue(hash, source.OversampleV);
+        hash = HashValue(hash, source.SizePixels);
+        hash = HashValue(hash, source.GlyphOffset.x);
+        hash = HashValue(hash, source.GlyphOffset.y);
+        hash = HashValue(hash, source.GlyphMinAdvanceX);
+        hash = HashValue(hash, source.GlyphMaxAdvanceX);
+        hash = HashValue(hash, source.GlyphExtraAdvanceX);
+        hash = HashValue(hash, source.FontBuilderFlags);
+        hash = HashValue(hash, source.RasterizerMultiply);
+        hash = HashValue(hash, source.RasterizerDensity);
+        hash = HashValue(hash, source.EllipsisChar);
+        const ImWchar* range = source.GlyphRanges;
+        for (; range && range[0]; range += 2) {
+            hash = HashValue(hash, range[0]);
+            hash = HashValue(hash, range[1]);
+        }
+        hash = HashValue(hash, ImWchar(0));
+    }
+
+    // Distance field glyphs are custom rects; the sources only have their fonts' space
+    hash = HashValue(hash, DistanceFieldFont::BAKE_SIZE);
+    hash = HashValue(hash, DistanceFieldFont::PADDING);
+    for (const DistanceFieldFont::Glyph& glyph : m_distanceFieldFont.GetGlyphs()) {
+        hash = HashValue(hash, glyph.codepoint);
+        hash = HashValue(hash, glyph.width);
+        hash = HashValue(hash, glyph.height);
+    }
+    return hash;
+}
+
+bool ImGuiSystem::RestoreFontAtlas(ImFontAtlas* atlas, const std::vector<uint8_t>& cache) {
+    if (cache.size() < sizeof(FontAtlasCacheHeader)) return false;
+    PROFILE_ZONE("Font Atlas Cache Load");
+
+    FontAtlasCacheHeader header;
+    memcpy(&header, cache.data(), sizeof(header));
+    if (header.magic != FontAtlasCacheHeader::MAGIC || header.version != FontAtlasCacheHeader::VERSION ||
+        header.imguiVersion != IMGUI_VERSION_NUM || header.glyphSize != sizeof(ImFontGlyph) ||
+        header.fontCount != static_cast<uint32_t>(atlas->Fonts.Size) ||
+        header.texWidth <= 0 || header.texHeight <= 0 || header.inputHash != HashFontAtlasInputs(atlas)) {
+        return false;
+    }
+
+    // The whole file is parsed before the atlas is touched, so a truncated one just falls back to baking
+    size_t offset = sizeof(header);
+    auto read = [&cache, &offset](void* out, size_t size) {
+        if (cache.size() - offset < size) return false;
+        memcpy(out, cache.data() + offset, size);
+        offset += size;
+        return true;
+    };
+    std::vector<uint16_t> rectPositions(static_cast<size_t>(header.customRectCount) * 2);
+    if (!read(rectPositions.data(), rectPositions.size() * sizeof(uint16_t))) return false;
+    std::vector<FontAtlasCacheFont> fonts(header.fontCount);
+    std::vector<std::vector<ImFontGlyph>> glyphs(header.fontCount);
+    for (uint32_t i = 0; i < header.fontCount; i++) {
+        if (!read(&fonts[i], sizeof(FontAtlasCacheFont))) return false;
+        if (fonts[i].glyphCount == 0 || fonts[i].glyphCount > 0x10000) return false;
+        glyphs[i].resize(fonts[i].glyphCount);
+        if (!read(glyphs[i].data(), glyphs[i].size() * sizeof(ImFontGlyph))) return false;
+    }
+    size_t pixelBytes = static_cast<size_t>(header.texWidth) * static_cast<size_t>(header.texHeight);
+    if (cache.size() - offset != pixelBytes) return false;
+
+    // The cursor and line rects are registered as a build would, then placed where the bake packed them
+    ImFontAtlasBuildInit(atlas);
+    if (atlas->CustomRects.Size != static_cast<int>(header.customRectCount)) return false;
+    for (int i = 0; i < atlas->CustomRects.Size; i++) {
+        atlas->CustomRects[i].X = rectPositions[static_cast<size_t>(i) * 2];
+        atlas->CustomRects[i].Y = rectPositions[static_cast<size_t>(i) * 2 + 1];
+    }
+
+    atlas->ClearTexData();
+    atlas->TexPixelsAlpha8 = static_cast<unsigned char*>(IM_ALLOC(pixelBytes));
+    memcpy(atlas->TexPixelsAlpha8, cache.data() + offset, pixelBytes);
+    atlas->TexWidth = header.texWidth;
+    atlas->TexHeight = header.texHeight;
+    atlas->TexUvScale = header.texUvScale;
+    atlas->TexUvWhitePixel = header.texUvWhitePixel;
+    memcpy(atlas->TexUvLines, header.texUvLines, sizeof(atlas->TexUvLines));
+
+    for (uint32_t i = 0; i < header.fontCount; i++) {
+        ImFont* font = atlas->Fonts[static_cast<int>(i)];
+        font->ClearOutputData();
+        font->ContainerAtlas = atlas;
+        font->FontSize = fonts[i].fontSize;
+        font->Ascent = fonts[i].ascent;
+        font->Descent = fonts[i].descent;
+        font->MetricsTotalSurface = fonts[i].metricsTotalSurface;
+        font->Glyphs.resize(static_cast<int>(glyphs[i].size()));
+        memcpy(font->Glyphs.Data, glyphs[i].data(), glyphs[i].size() * sizeof(ImFontGlyph));
+        font->BuildLookupTable();
+    }
+    atlas->TexReady = true;
+    return true;
+}
+
+void ImGuiSystem::SaveFontAtlasCache(const ImFontAtlas* atlas) const {
+    std::string path = GetFontAtlasCachePath();
+    if (path.empty() || !atlas->TexReady || !atlas->TexPixelsAlpha8) return;
+
+    FontAtlasCacheHeader header;
+    static_assert(sizeof(header.loadedBlocks) * 8 == GLYPH_BLOCK_COUNT, "One bit per glyph block");
+    header.inputHash = HashFontAtlasInputs(atlas);
+    for (size_t block = 0; block < GLYPH_BLOCK_COUNT; block++) {
+        if (m_loadedGlyphBlocks.test(block)) header.loadedBlocks[block / 64] |= 1ull << (block % 64);
+    }
+    header.texWidth = atlas->TexWidth;
+    header.texHeight = atlas->TexHeight;
+    header.fontCount = static_cast<uint32_t>(atlas->Fonts.Size);
+    header.customRectCount = static_cast<uint32_t>(atlas->CustomRects.Size);
+    header.texUvScale = atlas->TexUvScale;
+    header.texUvWhitePixel = atlas->TexUvWhitePixel;
+    memcpy(header.texUvLines, atlas->TexUvLines, sizeof(header.texUvLines));
+
+    bool written = WriteFileAtomic(path, [&header, atlas](std::ostream& file) {
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const ImFontAtlasCustomRect& rect : atlas->CustomRects) {
+            uint16_t position[2] = { rect.X, rect.Y };
+            file.write(reinterpret_cast<const char*>(position), sizeof(position));
+        }
+        for (const ImFont* font : atlas->Fonts) {
+            FontAtlasCacheFont entry;
+            entry.fontSize = font->FontSize;
+            entry.ascent = font->Ascent;
+            entry.descent = font->Descent;
+            entry.metricsTotalSurface = font->MetricsTotalSurface;
+            entry.glyphCount = static_cast<uint32_t>(font->Glyphs.Size);
+            file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+            file.write(reinterpret_cast<const char*>(font->Glyphs.Data),
+                static_cast<std::streamsize>(font->Glyphs.Size) * sizeof(ImFontGlyph));
+        }
+        size_t pixelBytes = static_cast<size_t>(atlas->TexWidth) * static_cast<size_t>(atlas->TexHeight);
+        file.write(reinterpret_cast<const char*>(atlas->TexPixelsAlpha8), static_cast<std::streamsize>(pixelBytes));
+        return true;
+    });
+    if (!written) {
+        OutputDebugStringA("Warning: Failed to write the font atlas cache.\n");
+    }
+}
+
+void ImGuiSystem::SaveIniSettings(bool force) {
+    ImGuiIO& io = ImGui::GetIO();
+    if (!io.WantSaveIniSettings && !force) return;
+    // ImGui already waits IniSavingRate after the last layout change; the store debounces again
+    size_t size = 0;
+    const char* settings = ImGui::SaveIniSettingsToMemory(&size);
+    SettingsStore::Get().Write(m_iniPath, std::string(settings, size));
+    io.WantSaveIniSettings = false;
+}
+
 void ImGuiSystem::ShutdownImGui() {
-    ImGui_ImplDX12_Shutdown();
+    SaveIniSettings(true); // ImGui only saves on shutdown itself when it owns the file
+    if (m_rendererInitialized) ImGui_ImplDX12_Shutdown();
     ImGui_ImplWin32_Shutdown();
+    ImGui::GetIO().UserData = nullptr;
     ImGui::DestroyContext(m_imguiContext);
     m_imguiContext = nullptr;
 }
 
+void ImGuiSystem::ReleaseDeviceObjects() {
+    // The backend releases immediately, so nothing in flight may still use them
+    m_renderSystem->WaitForGpu();
+    ImGui_ImplDX12_InvalidateDeviceObjects();
+    ReleaseUiLayerTarget();
+    m_frameReady = false; // A built frame draws with the font texture's old descriptor
+    WidgetCache::InvalidateAll(); // The font texture comes back under a new descriptor
+}
+
 void ImGuiSystem::BeginFrame() {
+    WidgetCache::BeginFrame();
+    // Typed and IME characters queued by the message handler since the last frame
+    for (ImWchar character : ImGui::GetIO().InputQueueCharacters) {
+        RequestGlyph(character);
+    }
+    // Between frames, while the atlas is unlocked. Not on the UI thread: the render thread may be
+    // recording with the current font texture, so the rebuild waits for StartFrameBuild.
+    if (!IsBuildThread()) {
+        if (m_pendingDpiScale != m_dpiScale) {
+            ImGui::GetStyle().ScaleAllSizes(m_pendingDpiScale / m_dpiScale);
+            m_dpiScale = m_pendingDpiScale;
+            RebuildFontAtlas();
+        }
+        else if (m_requestedGlyphBlocks.any()) {
+            RebuildFontAtlas();
+        }
+    }
+
     // Start the Dear ImGui frame
     ImGui_ImplDX12_NewFrame();
     ImGui_ImplWin32_NewFrame();
@@ -102,15 +581,16 @@ void ImGuiSystem::BeginFrame() {
 }
 
 void ImGuiSystem::EndFrame() {
-    // Render Dear ImGui
-    ImGui::Render();
-
-    // Set descriptor heaps
-    ID3D12DescriptorHeap* heaps[] = { m_srvDescHeap.Get() };
-    m_renderSystem->GetCommandList()->SetDescriptorHeaps(_countof(heaps), heaps);
-
-    // Render ImGui draw data
-    ImGui_ImplDX12_RenderDrawData(ImGui::GetDrawData(), m_renderSystem->GetCommandList());
+    BuildDrawData();
+    for (const RECT& rect : m_lastContentRects) {
+        m_renderSystem->AddDirtyRect(rect);
+    }
+    m_liveTextures.clear();
+    for (UINT64 texture : m_buildLiveTextures) {
+        if (texture != 0) m_liveTextures.push_back(texture);
+    }
+    m_buildLiveTextures.clear();
+    RecordDrawData(ImGui::GetDrawData());
 
     // Update and Render additional Platform Windows
     ImGuiIO& io = ImGui::GetIO();
@@ -120,6 +600,658 @@ void ImGuiSystem::EndFrame() {
     }
 }
 
+void ImGuiSystem::BuildDrawData() {
+    // Outline last frame's dirty rects (drawn before Render so it lands in this frame)
+    if (m_renderSystem->IsPresentRectDebugEnabled()) {
+        DrawPresentRectDebug();
+    }
+
+    // Render Dear ImGui
+    ImGui::Render();
+    SaveIniSettings();
+    PlaceDrawDataInWindow();
+    CollectHitRects();
+    CollectDirtyRects();
+}
+
+void ImGuiSystem::RecordDrawData(ImDrawData* drawData) {
+    ScaleDrawDataToRenderTarget(drawData);
+
+    // Sampled textures reach their final states (split barriers end here)
+    m_renderSystem->GetResourceManager()->EndSplitTransitions();
+    m_renderSystem->GetResourceManager()->FlushBarriers(m_renderSystem->GetCommandList());
+
+    // Platform windows render from the same context right after this, so the UI records in line then
+    if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
+        m_renderSystem->BeginGpuPass(GpuPass::ImGui);
+        RenderDrawData(drawData, m_renderSystem->GetCommandList());
+        m_renderSystem->EndGpuPass(GpuPass::ImGui);
+        return;
+    }
+
+    // Recorded on a worker into its own list while the render thread records the HUD, upscale and
+    // present work; the draw data and UI layer stay untouched until the frame is submitted
+    JobDesc job;
+    job.name = "ImGui Record";
+    job.priority = JobPriority::High;
+    job.jobClass = JobClass::Performance;
+    job.counter = &m_recordCounter;
+    JobSystem::Get().Submit(job, [this, drawData]() {
+        ID3D12GraphicsCommandList* commandList = m_renderSystem->BeginRecording();
+        m_renderSystem->BeginGpuPass(GpuPass::ImGui, commandList);
+        RenderDrawData(drawData, commandList);
+        m_renderSystem->EndGpuPass(GpuPass::ImGui, commandList);
+        m_renderSystem->EndRecording(commandList);
+    }, m_renderSystem->AddRecordingJob());
+}
+
+// --- Pipelined Frames ---
+
+namespace {
+    thread_local bool t_buildThread = false;
+}
+
+bool ImGuiSystem::IsBuildThread() {
+    return t_buildThread;
+}
+
+void ImGuiSystem::RunOnRenderThread(const char* name, std::function<void()> work) {
+    if (t_buildThread) {
+        JobSystem::Get().PostToRenderThread(name, std::move(work));
+    }
+    else {
+        work();
+    }
+}
+
+void ImGuiSystem::SetPipelinedBuild(bool enabled) {
+    if (enabled && (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable)) {
+        LOG_WARNING("Pipelined UI frames aren't supported with multi-viewports");
+        enabled = false;
+    }
+    if (enabled == m_pipelinedBuild) return;
+    if (!enabled) {
+        WaitForBuild();
+    }
+    m_frameReady = false;
+    m_pipelinedBuild = enabled;
+    LOG_INFO("Pipelined UI frames %s", enabled ? "on" : "off");
+}
+
+void ImGuiSystem::WaitForBuild() {
+    // Blocking only: the render thread is mid-frame, and what the build posted to it runs at the
+    // main loop's next continuation run
+    m_buildJobs.WaitBlocking();
+}
+
+void ImGuiSystem::RunBuild(std::function<void()> buildUi) {
+    ThreadCycleScope cycles(ThreadSubsystem::UI);
+    t_buildThread = true;
+    std::exception_ptr error;
+    try {
+        BuildFrame(m_frames[m_recordFrame ^ 1], buildUi);
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+    t_buildThread = false;
+
+    std::lock_guard<std::mutex> lock(m_buildMutex);
+    m_buildError = error;
+    m_buildRunning = false;
+}
+
+void ImGuiSystem::BuildFrame(BuiltFrame& frame, const std::function<void()>& buildUi) {
+    BeginFrame();
+    buildUi();
+    {
+        PROFILE_ZONE("ImGui EndFrame");
+        BuildDrawData();
+    }
+    CaptureBuiltFrame(frame);
+}
+
+void ImGuiSystem::CaptureBuiltFrame(BuiltFrame& frame) {
+    const ImDrawData* drawData = ImGui::GetDrawData();
+    frame.drawData.Clear();
+    frame.dirtyRects = m_lastContentRects;
+    frame.liveTextures.swap(m_buildLiveTextures);
+    m_buildLiveTextures.clear();
+    if (!drawData) {
+        frame.hash = 0;
+        return;
+    }
+
+    // The lists' buffers trade places with ImGui's, which the next NewFrame empties: no copies, and
+    // both sides keep their capacity
+    while (frame.lists.size() < static_cast<size_t>(drawData->CmdListsCount)) {
+        frame.lists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+    }
+    frame.drawData.Valid = drawData->Valid;
+    frame.drawData.DisplayPos = drawData->DisplayPos;
+    frame.drawData.DisplaySize = drawData->DisplaySize;
+    frame.drawData.FramebufferScale = drawData->FramebufferScale;
+    frame.drawData.OwnerViewport = drawData->OwnerViewport;
+    for (int i = 0; i < drawData->CmdListsCount; i++) {
+        ImDrawList* source = drawData->CmdLists[i];
+        ImDrawList* list = frame.lists[i];
+        list->CmdBuffer.swap(source->CmdBuffer);
+        list->IdxBuffer.swap(source->IdxBuffer);
+        list->VtxBuffer.swap(source->VtxBuffer);
+        frame.drawData.CmdLists.push_back(list);
+    }
+    frame.drawData.CmdListsCount = frame.drawData.CmdLists.Size;
+    frame.drawData.TotalIdxCount = drawData->TotalIdxCount;
+    frame.drawData.TotalVtxCount = drawData->TotalVtxCount;
+    frame.hash = HashCachedDrawData(&frame.drawData, frame.drawData.CmdListsCount, 0);
+}
+
+void ImGuiSystem::StartFrameBuild(std::function<void()> buildUi) {
+    // No build job runs until the one below is submitted
+    if (!m_frameReady || m_pendingDpiScale != m_dpiScale || m_requestedGlyphBlocks.any() ||
+        ImGui::GetIO().Fonts->TexID == 0) {
+        PROFILE_ZONE("UI Synchronous Build");
+        m_frameReady = false;
+        BuildFrame(m_frames[m_recordFrame], buildUi);
+        m_frameReady = true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_buildMutex);
+        m_buildRunning = true;
+    }
+    JobDesc job;
+    job.name = "UI Build";
+    job.priority = JobPriority::High;
+    job.jobClass = JobClass::Performance;
+    job.counter = &m_buildJobs;
+    JobSystem::Get().Submit(job, [this, buildUi = std::move(buildUi)]() mutable { RunBuild(std::move(buildUi)); });
+}
+
+void ImGuiSystem::RecordBuiltFrame(const D3D12_GPU_DESCRIPTOR_HANDLE* liveTextures, size_t count) {
+    BuiltFrame& frame = m_frames[m_recordFrame];
+
+    // Draws of a texture that has since moved (the browser's double-buffered display texture) take
+    // its current descriptor
+    m_liveTextures.clear();
+    for (size_t i = 0; i < frame.liveTextures.size() && i < count; i++) {
+        const UINT64 built = frame.liveTextures[i];
+        const UINT64 current = liveTextures[i].ptr;
+        if (built != 0 && current != 0 && built != current) {
+            for (ImDrawList* list : frame.lists) {
+                for (ImDrawCmd& cmd : list->CmdBuffer) {
+                    if (static_cast<UINT64>(cmd.TextureId) == built) cmd.TextureId = static_cast<ImTextureID>(current);
+                }
+            }
+        }
+        if (current != 0) m_liveTextures.push_back(current);
+    }
+
+    for (const RECT& rect : frame.dirtyRects) {
+        m_renderSystem->AddDirtyRect(rect);
+    }
+    RecordDrawData(&frame.drawData);
+}
+
+void ImGuiSystem::FinishFrameBuild() {
+    std::vector<DeferredMessage> messages;
+    std::exception_ptr error;
+    {
+        PROFILE_ZONE("UI Build Wait");
+        WaitForBuild();
+        std::lock_guard<std::mutex> lock(m_buildMutex);
+        error = m_buildError;
+        m_buildError = nullptr;
+        messages.swap(m_deferredMessages);
+    }
+
+    // What reached the window meanwhile goes to ImGui's input queue, for the next build
+    for (const DeferredMessage& message : messages) {
+        ImGui_ImplWin32_WndProcHandler(message.hwnd, message.msg, message.wParam, message.lParam);
+    }
+    if (error) {
+        m_frameReady = false;
+        std::rethrow_exception(error);
+    }
+
+    const int builtFrame = m_recordFrame ^ 1;
+    if (m_frames[builtFrame].hash != m_frames[m_recordFrame].hash) {
+        m_renderSystem->InvalidateFrame(); // Otherwise an idle overlay would never show it
+    }
+    m_recordFrame = builtFrame;
+}
+
+bool ImGuiSystem::DeferMessage(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    if (!m_pipelinedBuild) return false;
+    std::lock_guard<std::mutex> lock(m_buildMutex);
+    if (!m_buildRunning) return false;
+    m_deferredMessages.push_back({ hwnd, msg, wParam, lParam });
+    return true;
+}
+
+// --- Cached UI Layer ---
+
+void ImGuiSystem::AddLiveTexture(D3D12_GPU_DESCRIPTOR_HANDLE texture) {
+    m_buildLiveTextures.push_back(texture.ptr); // Zero too, so RecordBuiltFrame's positions line up
+}
+
+void ImGuiSystem::SetUiLayerCacheEnabled(bool enabled) {
+    m_uiLayerCacheEnabled = enabled;
+    if (!enabled) {
+        ReleaseUiLayerTarget();
+    }
+}
+
+bool ImGuiSystem::IsLiveTexture(UINT64 texture) const {
+    return std::find(m_liveTextures.begin(), m_liveTextures.end(), texture) != m_liveTextures.end();
+}
+
+void ImGuiSystem::RenderDrawData(ImDrawData* drawData, ID3D12GraphicsCommandList* commandList) {
+    if (!drawData || drawData->DisplaySize.x <= 0.0f || drawData->DisplaySize.y <= 0.0f) return;
+
+    // The cached part ends at the first live draw; a user callback before it can't be replayed from a layer
+    int splitList = drawData->CmdListsCount;
+    int splitCommand = 0;
+    bool cacheable = m_uiLayerCacheEnabled;
+    for (int i = 0; i < drawData->CmdListsCount && cacheable && splitList == drawData->CmdListsCount; i++) {
+        const ImDrawList* drawList = drawData->CmdLists[i];
+        for (int c = 0; c < drawList->CmdBuffer.Size; c++) {
+            const ImDrawCmd& cmd = drawList->CmdBuffer[c];
+            if (cmd.UserCallback && cmd.UserCallback != ImDrawCallback_ResetRenderState) {
+                cacheable = false;
+                break;
+            }
+            if (IsLiveTexture(static_cast<UINT64>(cmd.GetTexID()))) {
+                splitList = i;
+                splitCommand = c;
+                break;
+            }
+        }
+    }
+
+    PipelineStateManager* pipelineStateManager = m_renderSystem->GetPipelineStateManager();
+    ID3D12RootSignature* compositeRootSignature = nullptr;
+    ID3D12PipelineState* compositePipeline = nullptr;
+    if (cacheable && (splitList > 0 || splitCommand > 0) && pipelineStateManager) {
+        compositeRootSignature = pipelineStateManager->GetUpscaleRootSignature();
+        compositePipeline = pipelineStateManager->GetLayerCompositePipelineState(m_renderSystem->GetSceneFormat());
+    }
+    if (!compositeRootSignature || !compositePipeline) {
+        m_previousLayerHash = 0;
+        ImGui_ImplDX12_RenderDrawData(drawData, commandList);
+        m_uiLayerStats.directFrames++;
+        return;
+    }
+
+    // The layer matches the frame's target (at the scaled size below render scale 1.0)
+    const bool scaled = m_renderSystem->IsRenderingScaled();
+    const int width = scaled ? m_renderSystem->GetScaledWidth() : m_renderSystem->GetWidth();
+    const int height = scaled ? m_renderSystem->GetScaledHeight() : m_renderSystem->GetHeight();
+
+    uint64_t hash = HashCachedDrawData(drawData, splitList, splitCommand);
+    bool layerCurrent = m_uiLayerValid && hash == m_uiLayerHash && m_uiLayerWidth == width && m_uiLayerHeight == height &&
+        m_uiLayerFormat == m_renderSystem->GetSceneFormat();
+    if (!layerCurrent) {
+        // Changing every frame (an animation, a drag): the layer would only add a composite
+        if (hash != m_previousLayerHash || !EnsureUiLayerTarget(width, height)) {
+            m_previousLayerHash = hash;
+            ImGui_ImplDX12_RenderDrawData(drawData, commandList);
+            m_uiLayerStats.directFrames++;
+            return;
+        }
+
+        // Static since last frame: draw the cached part once into the layer
+        // Its own barriers, since the ResourceManager queue belongs to the frame's list; the target is
+        // back in its tracked state (PIXEL_SHADER_RESOURCE) by the end of the list
+        D3D12_RESOURCE_BARRIER barrier = {};
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barrier.Transition.pResource = m_uiLayerTarget.Get();
+        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
+        commandList->ResourceBarrier(1, &barrier);
+        const float clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        commandList->OMSetRenderTargets(1, &m_uiLayerRtv.cpuHandle, FALSE, nullptr);
+        commandList->ClearRenderTargetView(m_uiLayerRtv.cpuHandle, clearColor, 0, nullptr);
+        RenderDrawDataRange(drawData, 0, 0, splitList, splitCommand, commandList);
+        std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+        commandList->ResourceBarrier(1, &barrier);
+        m_renderSystem->BindFrameRenderTarget(commandList);
+
+        m_uiLayerHash = hash;
+        m_uiLayerValid = true;
+        m_uiLayerStats.layerUpdates++;
+    }
+    else {
+        m_uiLayerStats.cachedFrames++;
+    }
+    m_previousLayerHash = hash;
+
+    CompositeUiLayer(commandList, compositeRootSignature, compositePipeline);
+    RenderDrawDataRange(drawData, splitList, splitCommand, drawData->CmdListsCount, 0, commandList);
+}
+
+uint64_t ImGuiSystem::HashCachedDrawData(const ImDrawData* drawData, int splitList, int splitCommand) const {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    hash = HashValue(hash, drawData->DisplayPos.x);
+    hash = HashValue(hash, drawData->DisplayPos.y);
+    hash = HashValue(hash, drawData->DisplaySize.x);
+    hash = HashValue(hash, drawData->DisplaySize.y);
+
+    for (int i = 0; i <= splitList && i < drawData->CmdListsCount; i++) {
+        const ImDrawList* drawList = drawData->CmdLists[i];
+        int commandCount = i == splitList ? splitCommand : drawList->CmdBuffer.Size;
+        if (commandCount == 0) continue;
+
+        // Vertices in full (a list's commands may use them in any order), indices up to the split
+        const ImDrawCmd& lastCommand = drawList->CmdBuffer[commandCount - 1];
+        hash = HashBytes(hash, drawList->VtxBuffer.Data, static_cast<size_t>(drawList->VtxBuffer.Size) * sizeof(ImDrawVert));
+        hash = HashBytes(hash, drawList->IdxBuffer.Data,
+            static_cast<size_t>(lastCommand.IdxOffset + lastCommand.ElemCount) * sizeof(ImDrawIdx));
+        for (int c = 0; c < commandCount; c++) {
+            const ImDrawCmd& cmd = drawList->CmdBuffer[c];
+            hash = HashBytes(hash, &cmd.ClipRect, sizeof(cmd.ClipRect));
+            hash = HashValue(hash, static_cast<UINT64>(cmd.GetTexID()));
+            hash = HashValue(hash, cmd.VtxOffset);
+            hash = HashValue(hash, cmd.IdxOffset);
+            hash = HashValue(hash, cmd.ElemCount);
+        }
+    }
+    return hash;
+}
+
+void ImGuiSystem::RenderDrawDataRange(const ImDrawData* drawData, int beginList, int beginCommand,
+    int endList, int endCommand, ID3D12GraphicsCommandList* commandList) {
+    ImDrawData range;
+    range.Valid = true;
+    range.DisplayPos = drawData->DisplayPos;
+    range.DisplaySize = drawData->DisplaySize;
+    range.FramebufferScale = drawData->FramebufferScale;
+    range.OwnerViewport = drawData->OwnerViewport;
+
+    // Lists cut at either end get just their range of commands for the call; vertex and index
+    // buffers stay whole, since commands address them by offset
+    ImDrawList* partialLists[2] = {};
+    ImVector<ImDrawCmd> savedCommands[2];
+    int partialCount = 0;
+    for (int i = beginList; i <= endList && i < drawData->CmdListsCount; i++) {
+        ImDrawList* drawList = drawData->CmdLists[i];
+        int first = i == beginList ? beginCommand : 0;
+        int last = i == endList ? endCommand : drawList->CmdBuffer.Size;
+        if (first >= last) continue;
+
+        if (first > 0 || last < drawList->CmdBuffer.Size) {
+            ImVector<ImDrawCmd>& saved = savedCommands[partialCount];
+            saved.swap(drawList->CmdBuffer);
+            drawList->CmdBuffer.reserve(last - first);
+            for (int c = first; c < last; c++) {
+                drawList->CmdBuffer.push_back(saved[c]);
+            }
+            partialLists[partialCount++] = drawList;
+        }
+
+        range.CmdLists.push_back(drawList);
+        range.TotalVtxCount += drawList->VtxBuffer.Size;
+        range.TotalIdxCount += drawList->IdxBuffer.Size;
+    }
+    range.CmdListsCount = range.CmdLists.Size;
+
+    if (range.CmdListsCount > 0) {
+        ImGui_ImplDX12_RenderDrawData(&range, commandList);
+    }
+    for (int i = 0; i < partialCount; i++) {
+        partialLists[i]->CmdBuffer.swap(savedCommands[i]);
+    }
+}
+
+bool ImGuiSystem::EnsureUiLayerTarget(int width, int height) {
+    // The scene format follows HDR output; the layer is drawn with the frame's pipelines
+    DXGI_FORMAT format = m_renderSystem->GetSceneFormat();
+    if (m_uiLayerTarget && m_uiLayerWidth == width && m_uiLayerHeight == height && m_uiLayerFormat == format) return true;
+    ReleaseUiLayerTarget();
+    if (width <= 0 || height <= 0) return false;
+
+    ResourceManager* resourceManager = m_renderSystem->GetResourceManager();
+    D3D12_CLEAR_VALUE clearValue = {};
+    clearValue.Format = format;
+    m_uiLayerTarget = resourceManager->CreateTexture2D(static_cast<UINT>(width), static_cast<UINT>(height), format,
+        D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+        &clearValue);
+    if (!m_uiLayerTarget) {
+        OutputDebugStringA("Warning: Failed to create the UI layer target, drawing the UI every frame.\n");
+        return false;
+    }
+    m_uiLayerTarget->SetName(L"UI Layer");
+    resourceManager->PinResource(m_uiLayerTarget.Get(), true); // Sampled every visible frame; never evicted
+    m_uiLayerRtv = resourceManager->CreateRenderTargetView(m_uiLayerTarget.Get());
+    m_uiLayerSrv = resourceManager->CreateShaderResourceView(m_uiLayerTarget.Get());
+    m_uiLayerWidth = width;
+    m_uiLayerHeight = height;
+    m_uiLayerFormat = format;
+    return true;
+}
+
+void ImGuiSystem::ReleaseUiLayerTarget() {
+    m_uiLayerValid = false;
+    m_uiLayerWidth = 0;
+    m_uiLayerHeight = 0;
+    if (!m_uiLayerTarget) return;
+
+    // Frames in flight may still draw into or sample it; the views go with it
+    ResourceManager* resourceManager = m_renderSystem->GetResourceManager();
+    ResourceDescriptor rtv = m_uiLayerRtv;
+    ResourceDescriptor srv = m_uiLayerSrv;
+    resourceManager->ReleaseResource(m_uiLayerTarget.Get());
+    resourceManager->RetireResource(std::move(m_uiLayerTarget), [resourceManager, rtv, srv]() {
+        resourceManager->FreeDescriptor(rtv);
+        resourceManager->FreeDescriptor(srv);
+    });
+    m_uiLayerRtv = ResourceDescriptor();
+    m_uiLayerSrv = ResourceDescriptor();
+}
+
+void ImGuiSystem::CompositeUiLayer(ID3D12GraphicsCommandList* commandList, ID3D12RootSignature* rootSignature,
+    ID3D12PipelineState* pipelineState) {
+    // Same size as the target, so the bilinear fetch lands on texel centers
+    UpscaleConstants constants = {};
+    constants.sourceTexelSize[0] = 1.0f / static_cast<float>(m_uiLayerWidth);
+    constants.sourceTexelSize[1] = 1.0f / static_cast<float>(m_uiLayerHeight);
+
+    commandList->SetGraphicsRootSignature(rootSignature);
+    commandList->SetPipelineState(pipelineState);
+    commandList->SetGraphicsRootDescriptorTable(0, m_uiLayerSrv.gpuHandle);
+    commandList->SetGraphicsRoot32BitConstants(1, sizeof(UpscaleConstants) / sizeof(UINT), &constants, 0);
+    commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    commandList->DrawInstanced(3, 1, 0, 0);
+}
+
+void ImGuiSystem::SetCompactWindow(bool enabled, const RECT& displayArea) {
+    m_compactWindow = enabled;
+    m_displayArea = displayArea;
+    m_hasContent = false;
+    m_windowOffset = ImVec2(0.0f, 0.0f);
+    ImGui_ImplWin32_SetDisplayArea(enabled ? &m_displayArea : nullptr);
+    InvalidateUiLayer();
+    m_renderSystem->InvalidateFrame();
+}
+
+bool ImGuiSystem::GetContentBounds(RECT& bounds) const {
+    if (!m_compactWindow || !m_hasContent) return false;
+    bounds = m_contentBounds;
+    OffsetRect(&bounds, m_displayArea.left, m_displayArea.top);
+    return true;
+}
+
+void ImGuiSystem::PlaceDrawDataInWindow() {
+    if (!m_compactWindow) return;
+
+    ImDrawData* drawData = ImGui::GetDrawData();
+    if (!drawData) return;
+
+    // Same bounds as the dirty rects: each list's clip rects, except the debug foreground list
+    const ImDrawList* foreground = ImGui::GetForegroundDrawList();
+    ImVec2 minPos(FLT_MAX, FLT_MAX);
+    ImVec2 maxPos(-FLT_MAX, -FLT_MAX);
+    for (int i = 0; i < drawData->CmdListsCount; i++) {
+        const ImDrawList* drawList = drawData->CmdLists[i];
+        if (drawList == foreground) continue;
+        for (const ImDrawCmd& cmd : drawList->CmdBuffer) {
+            if (cmd.ElemCount == 0) continue;
+            minPos.x = std::min(minPos.x, cmd.ClipRect.x);
+            minPos.y = std::min(minPos.y, cmd.ClipRect.y);
+            maxPos.x = std::max(maxPos.x, cmd.ClipRect.z);
+            maxPos.y = std::max(maxPos.y, cmd.ClipRect.w);
+        }
+    }
+    m_hasContent = minPos.x < maxPos.x && minPos.y < maxPos.y;
+    if (m_hasContent) {
+        m_contentBounds = {
+            static_cast<LONG>(std::floor(minPos.x)), static_cast<LONG>(std::floor(minPos.y)),
+            static_cast<LONG>(std::ceil(maxPos.x)), static_cast<LONG>(std::ceil(maxPos.y))
+        };
+    }
+
+    // The back buffer shows the window's part of the display area
+    RECT client = {};
+    GetClientRect(m_hwnd, &client);
+    m_windowOffset = ImGui_ImplWin32_GetWindowOffset();
+    drawData->DisplayPos = m_windowOffset;
+    drawData->DisplaySize = ImVec2(static_cast<float>(client.right - client.left), static_cast<float>(client.bottom - client.top));
+}
+
+void ImGuiSystem::ScaleDrawDataToRenderTarget(ImDrawData* drawData) {
+    if (!m_renderSystem->IsRenderingScaled()) return;
+    if (!drawData || drawData->DisplaySize.x <= 0.0f || drawData->DisplaySize.y <= 0.0f) return;
+
+    // UI is laid out at window size; the scaled target is smaller
+    ImVec2 scale(
+        static_cast<float>(m_renderSystem->GetScaledWidth()) / drawData->DisplaySize.x,
+        static_cast<float>(m_renderSystem->GetScaledHeight()) / drawData->DisplaySize.y);
+
+    for (int i = 0; i < drawData->CmdListsCount; i++) {
+        ImDrawList* drawList = drawData->CmdLists[i];
+        for (ImDrawVert& vertex : drawList->VtxBuffer) {
+            vertex.pos.x *= scale.x;
+            vertex.pos.y *= scale.y;
+        }
+    }
+
+    drawData->ScaleClipRects(scale);
+    drawData->DisplayPos = ImVec2(drawData->DisplayPos.x * scale.x, drawData->DisplayPos.y * scale.y);
+    drawData->DisplaySize = ImVec2(drawData->DisplaySize.x * scale.x, drawData->DisplaySize.y * scale.y);
+}
+
+void ImGuiSystem::CollectDirtyRects() {
+    m_lastContentRects.clear();
+
+    ImDrawData* drawData = ImGui::GetDrawData();
+    if (!drawData) return;
+
+    // The foreground list spans the whole display and only holds the debug outlines
+    const ImDrawList* foreground = ImGui::GetForegroundDrawList();
+
+    for (int i = 0; i < drawData->CmdListsCount; i++) {
+        const ImDrawList* drawList = drawData->CmdLists[i];
+        if (drawList == foreground || drawList->CmdBuffer.Size == 0) continue;
+
+        // Each draw list is one window; its clip rects bound everything it draws
+        ImVec2 minPos(FLT_MAX, FLT_MAX);
+        ImVec2 maxPos(-FLT_MAX, -FLT_MAX);
+        for (const ImDrawCmd& cmd : drawList->CmdBuffer) {
+            if (cmd.ElemCount == 0) continue;
+            minPos.x = std::min(minPos.x, cmd.ClipRect.x);
+            minPos.y = std::min(minPos.y, cmd.ClipRect.y);
+            maxPos.x = std::max(maxPos.x, cmd.ClipRect.z);
+            maxPos.y = std::max(maxPos.y, cmd.ClipRect.w);
+        }
+        if (minPos.x >= maxPos.x || minPos.y >= maxPos.y) continue;
+
+        RECT rect = {
+            static_cast<LONG>(std::floor(minPos.x - drawData->DisplayPos.x)),
+            static_cast<LONG>(std::floor(minPos.y - drawData->DisplayPos.y)),
+            static_cast<LONG>(std::ceil(maxPos.x - drawData->DisplayPos.x)),
+            static_cast<LONG>(std::ceil(maxPos.y - drawData->DisplayPos.y))
+        };
+        m_lastContentRects.push_back(rect);
+    }
+}
+
+void ImGuiSystem::CollectHitRects() {
+    m_hitRects.clear();
+    const ImGuiContext& context = *ImGui::GetCurrentContext();
+    ImVec2 origin = ImGui::GetDrawData() ? ImGui::GetDrawData()->DisplayPos : ImVec2(0.0f, 0.0f);
+
+    // Shown top-level windows that take the mouse; tooltips and HUD-style windows are NoMouseInputs.
+    // A modal popup blocks everything behind it, so it takes the whole display.
+    for (const ImGuiWindow* window : context.Windows) {
+        if (!window->Active || window->Hidden || (window->Flags & (ImGuiWindowFlags_ChildWindow | ImGuiWindowFlags_NoMouseInputs))) {
+            continue;
+        }
+        ImRect rect = window->Rect();
+        if (window->Flags & ImGuiWindowFlags_Modal) {
+            rect = ImRect(origin, ImVec2(origin.x + ImGui::GetIO().DisplaySize.x, origin.y + ImGui::GetIO().DisplaySize.y));
+        }
+        m_hitRects.push_back({
+            static_cast<LONG>(std::floor(rect.Min.x - origin.x)), static_cast<LONG>(std::floor(rect.Min.y - origin.y)),
+            static_cast<LONG>(std::ceil(rect.Max.x - origin.x)), static_cast<LONG>(std::ceil(rect.Max.y - origin.y)) });
+    }
+}
+
+void ImGuiSystem::DrawPresentRectDebug() {
+    ImDrawList* drawList = ImGui::GetForegroundDrawList();
+    for (const RECT& rect : m_lastContentRects) {
+        // Back buffer coordinates; the window may be offset in the display area
+        drawList->AddRect(
+            ImVec2(static_cast<float>(rect.left) + m_windowOffset.x, static_cast<float>(rect.top) + m_windowOffset.y),
+            ImVec2(static_cast<float>(rect.right - 1) + m_windowOffset.x, static_cast<float>(rect.bottom - 1) + m_windowOffset.y),
+            IM_COL32(255, 0, 255, 200));
+    }
+}
+
+bool ImGuiSystem::WantsContinuousUpdate() const {
+    const ImGuiIO& io = ImGui::GetIO();
+    return io.WantTextInput || ImGui::IsAnyItemActive();
+}
+
+// --- Vertex Emission ---
+
+const char* ImGuiSystem::GetVertexEmissionKernelName() {
+    return ImFontGetGlyphEmitKernelName(ImFontGetGlyphEmitKernel());
+}
+
+TextEmissionBenchmark ImGuiSystem::RunTextEmissionBenchmark(const std::function<void()>& buildUi, int frames) {
+    PROFILE_ZONE("Text Emission Benchmark");
+    TextEmissionBenchmark result;
+    ImFontSetGlyphEmitKernel(-1);
+    const int batchedKernel = ImFontGetGlyphEmitKernel();
+    result.kernel = ImFontGetGlyphEmitKernelName(batchedKernel);
+    result.frames = std::max(frames, 1);
+
+    const bool widgetCacheEnabled = WidgetCache::IsEnabled();
+    WidgetCache::SetEnabled(false);
+    double totalMs[2] = {}; // Scalar, batched
+    for (int i = 0; i < result.frames * 2; i++) {
+        const int path = i & 1;
+        ImFontSetGlyphEmitKernel(path ? batchedKernel : ImGlyphEmitKernel_Scalar);
+        const auto start = std::chrono::steady_clock::now();
+        BeginFrame();
+        buildUi();
+        ImGui::Render();
+        totalMs[path] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (const ImDrawData* drawData = ImGui::GetDrawData()) {
+            result.vertices = drawData->TotalVtxCount;
+        }
+    }
+    ImFontSetGlyphEmitKernel(batchedKernel);
+    WidgetCache::SetEnabled(widgetCacheEnabled);
+    m_buildLiveTextures.clear(); // The builds' AddLiveTexture calls
+
+    result.scalarMs = static_cast<float>(totalMs[0] / result.frames);
+    result.batchedMs = static_cast<float>(totalMs[1] / result.frames);
+    LOG_INFO("Text emission benchmark: scalar %.3f ms, %s %.3f ms per UI build (%d vertices, %d builds each)",
+        result.scalarMs, result.kernel, result.batchedMs, result.vertices, result.frames);
+    return result;
+}
+
 void ImGuiSystem::RenderDemoWindow() {
     // Show ImGui demo window for testing
     ImGui::ShowDemoWindow(&m_showDemoWindow);
@@ -137,6 +1269,12 @@ void ImGuiSystem::RenderDemoWindow() {
 }
 
 LRESULT ImGuiSystem::ProcessMessage(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    // Messages sent to the window while the UI thread builds a frame wait for FinishFrameBuild;
+    // ImGui's input queue is the build's until then
+    ImGuiSystem* system = ImGui::GetCurrentContext() ? static_cast<ImGuiSystem*>(ImGui::GetIO().UserData) : nullptr;
+    if (system && system->DeferMessage(hwnd, msg, wParam, lParam))
+        return 0;
+
     // Forward to ImGui message handler
     if (ImGui_ImplWin32_WndProcHandler(hwnd, msg, wParam, lParam))
         return true;
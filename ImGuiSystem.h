@@ -7,14 +7,29 @@
 #include <Windows.h>
 #include <d3d12.h>
 #include <wrl/client.h>
+#include <vector>
+#include <bitset>
+#include <string>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <exception>
 #include "RenderSystem.h"
+#include "JobSystem.h"
+#include "DistanceFieldFont.h"
+#include "imgui.h"
 
-// Forward declarations
-struct ImGuiContext;
+struct TextEmissionBenchmark;
 
+// Set up in three steps so startup can overlap them with device creation (see main.cpp): the
+// constructor creates the context and the Win32 backend, LoadFonts bakes or restores the atlas,
+// InitializeRenderer starts the DirectX 12 backend once the device exists. Main thread, except
+// LoadFonts, which may run on any thread: it bakes into an atlas of its own without touching the
+// context (the window procedure feeds ImGui meanwhile), and InitializeRenderer swaps it in before
+// the first frame.
 class ImGuiSystem {
 public:
-    ImGuiSystem(HWND hwnd, RenderSystem* renderSystem);
+    ImGuiSystem(HWND hwnd, float dpiScale);
     ~ImGuiSystem();
 
     // Disable copy and move
@@ -23,27 +38,244 @@ public:
     ImGuiSystem(ImGuiSystem&&) = delete;
     ImGuiSystem& operator=(ImGuiSystem&&) = delete;
 
+    void LoadFonts();
+    void InitializeRenderer(RenderSystem* renderSystem);
+
     // Frame methods
     void BeginFrame();
     void EndFrame();
 
+    // --- Pipelined Frames ---
+    // Off by default (--pipelined-ui). The UI of frame N+1 (BeginFrame, the pages, ImGui::Render)
+    // is built by a JobSystem job (the "UI thread" below) while the render thread records and
+    // presents frame N from a snapshot of its draw data, so the UI is shown one frame after it was
+    // built. Per frame, on the render thread: StartFrameBuild, RecordBuiltFrame, present,
+    // FinishFrameBuild. Not with multi-viewports.
+    void SetPipelinedBuild(bool enabled);
+    bool IsPipelinedBuild() const { return m_pipelinedBuild; }
+    // buildUi runs between BeginFrame and EndFrame's build half, AddLiveTexture calls included. With
+    // no built frame to record, or an atlas rebuild pending (it waits for the GPU and replaces the
+    // font texture the last snapshot draws with), one is first built here, synchronously.
+    void StartFrameBuild(std::function<void()> buildUi);
+    // The last built frame. liveTextures are the current handles of the textures the build passed to
+    // AddLiveTexture, in the same order: they move between descriptors without the draw data changing.
+    void RecordBuiltFrame(const D3D12_GPU_DESCRIPTOR_HANDLE* liveTextures, size_t count);
+    // Waits for the build and makes it the next one recorded; invalidates the next frame when it
+    // differs from the one just recorded. Rethrows what the build threw.
+    void FinishFrameBuild();
+    // Render thread state changed from UI code (textures, static layers, the optimizer's state): run
+    // now, or from the UI thread at the render thread's next continuation run
+    static void RunOnRenderThread(const char* name, std::function<void()> work);
+    static bool IsBuildThread();
+
+    // --- Vertex Emission ---
+    // Text and rect quads are written by a SIMD kernel patched into imgui_draw.cpp, AVX2 or SSE2
+    // from CPUID (ImFontSetGlyphEmitKernel). The benchmark builds buildUi (the shown page) frames
+    // times with each path, alternating, widget caching off so every build lays out and emits its
+    // text. Render thread, between frames, with the UI thread idle.
+    static const char* GetVertexEmissionKernelName();
+    TextEmissionBenchmark RunTextEmissionBenchmark(const std::function<void()>& buildUi, int frames);
+
+    // True while ImGui needs frames without new input (text cursor blink, active drags)
+    bool WantsContinuousUpdate() const;
+
+    // Drops the backend's font texture, pipeline and vertex/index buffers (which only ever grow)
+    // and the cached UI layer; the next BeginFrame recreates them at their initial sizes. Waits for the GPU.
+    void ReleaseDeviceObjects();
+
+    // Vertex and index data is written straight into the ResourceManager's persistently mapped
+    // upload ring (no per-frame Map, no buffer recreation as the UI grows); a frame that overflows
+    // the ring grows it. Off, the backend's own per-frame buffers are used.
+    void SetGeometryRingEnabled(bool enabled) { m_geometryRingEnabled = enabled; }
+    bool IsGeometryRingEnabled() const { return m_geometryRingEnabled; }
+
+    // Bindless drawing (SM 6.6 and resource binding tier 3, DXC builds): texture ids are handles in
+    // the ResourceManager's shader-visible heap, turned into heap indices that travel with the
+    // vertices, so images need no descriptor table each and draws sharing a clip rect merge.
+    // Known once the first frame has created the pipeline.
+    bool IsBindless() const;
+
+    // --- Cached UI Layer ---
+    // ImGui output up to the first draw of a live texture is kept in its own render target. Once that
+    // part's draw data hashes the same two frames running, it is drawn into the target, and from
+    // then on composited as one fullscreen triangle instead of redrawn until the hash changes.
+    // Live draws and everything drawn after them are rendered every frame on top, so layering is kept.
+    // Live textures change without the draw data changing (the browser); register them every frame
+    // between BeginFrame and EndFrame.
+    void AddLiveTexture(D3D12_GPU_DESCRIPTOR_HANDLE texture);
+    // Redraw next frame: for changes the draw data doesn't show (a texture rewritten under the same
+    // descriptor, the window layout). Render thread, outside the recording job.
+    void InvalidateUiLayer() { m_uiLayerValid = false; }
+    void SetUiLayerCacheEnabled(bool enabled);
+    bool IsUiLayerCacheEnabled() const { return m_uiLayerCacheEnabled; }
+    struct UiLayerStats {
+        UINT64 cachedFrames = 0;   // Composited from the layer
+        UINT64 layerUpdates = 0;   // Drawn into the layer
+        UINT64 directFrames = 0;   // Drawn straight into the frame (UI changing, or nothing to cache)
+    };
+    const UiLayerStats& GetUiLayerStats() const { return m_uiLayerStats; }
+
+    // --- Compact Window ---
+    // ImGui is laid out over displayArea (screen coordinates), while the overlay window only covers
+    // the part with panels on it: the draw data is translated by the window's position in the area,
+    // so a small panel only costs a back buffer, clear and composition of its own size. The window
+    // is fitted to GetContentBounds by the caller (WindowManager::GetCompactBounds).
+    void SetCompactWindow(bool enabled, const RECT& displayArea);
+    bool IsCompactWindow() const { return m_compactWindow; }
+    // Client rectangles of the windows that take the mouse, from the last EndFrame (hit testing)
+    const std::vector<RECT>& GetHitRects() const { return m_hitRects; }
+    // Union of the windows drawn last frame in screen coordinates; false when nothing was drawn
+    bool GetContentBounds(RECT& bounds) const;
+
     // Demo window for testing
     void RenderDemoWindow();
 
     // Process Windows messages for ImGui
     static LRESULT ProcessMessage(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
+    // --- Glyph Atlas ---
+    // The text fonts start with Latin-1 and General Punctuation only. Text from outside (page titles,
+    // bookmarks, typed characters) is passed here; blocks of 256 code points it needs but the atlas
+    // lacks are rasterized at the next BeginFrame, which rebuilds the atlas (and waits for the GPU
+    // once) with every block loaded so far. Until then those characters draw as the fallback glyph.
+    // Code points above U+FFFF aren't supported by the 16-bit atlas.
+    static void RequestGlyphs(const char* text);
+    static void RequestGlyphs(const std::string& text) { RequestGlyphs(text.c_str()); }
+    size_t GetLoadedGlyphBlockCount() const { return m_loadedGlyphBlocks.count(); }
+    // The baked atlas (pixels and glyph tables) is kept in %LOCALAPPDATA%\GameOverlay\FontAtlas.bin,
+    // keyed by a hash of the font data, sizes, ranges and build settings. A launch whose inputs match
+    // uploads it as is instead of rasterizing, and starts with the blocks the last session had loaded.
+    bool IsFontAtlasFromCache() const { return m_fontAtlasFromCache; }
+    // The Segoe UI header sizes share one distance field bake (DistanceFieldFont) instead of a bitmap
+    // bake each; false when the font couldn't be read and they are bitmap fonts
+    bool HasDistanceFieldFonts() const { return !m_distanceFieldFont.GetGlyphs().empty(); }
+
+    // --- DPI ---
+    // Fonts are rasterized at their size times the scale of the overlay's monitor, and the style's
+    // sizes are scaled with them, so text stays sharp at the monitor's native resolution. A change
+    // is applied at the next BeginFrame (it rebuilds the atlas). GetCurrentDpiScale is for code
+    // that resets the style (UISystem::ApplyTheme).
+    void SetDpiScale(float scale) { m_pendingDpiScale = scale > 0.0f ? scale : 1.0f; }
+    float GetDpiScale() const { return m_dpiScale; }
+    static float GetCurrentDpiScale();
+
 private:
-    void InitializeImGui(HWND hwnd, RenderSystem* renderSystem);
+    void InitializeImGui(HWND hwnd);
     void ShutdownImGui();
 
+    // Glyph atlas
+    void AddFonts(ImFontAtlas* atlas); // The atlas's fonts with the loaded blocks' ranges
+    void RequestGlyph(unsigned int codepoint);
+    void RebuildFontAtlas();
+    // Adds the fonts, then restores the atlas from the cache file's contents or bakes and saves it
+    void BuildFontAtlas(ImFontAtlas* atlas, const std::vector<uint8_t>& cache);
+    uint64_t HashFontAtlasInputs(const ImFontAtlas* atlas) const;
+    bool RestoreFontAtlas(ImFontAtlas* atlas, const std::vector<uint8_t>& cache);
+    void SaveFontAtlasCache(const ImFontAtlas* atlas) const;
+    void InstallLoadedFontAtlas(); // LoadFonts's atlas replaces the context's, between frames
+
+    // Screen bounds of drawn ImGui windows, passed to the render system as dirty rects
+    void CollectDirtyRects(); // Into m_lastContentRects
+    void ScaleDrawDataToRenderTarget(ImDrawData* drawData);
+    void PlaceDrawDataInWindow(); // Compact window: records the content bounds, translates to the window
+    void CollectHitRects();
+    void DrawPresentRectDebug();
+    void SaveIniSettings(bool force = false); // Hands the window layout to SettingsStore when it changed
+
+    // Pipelined frames
+    struct BuiltFrame {
+        ImDrawData drawData;             // CmdLists point at lists
+        std::vector<ImDrawList*> lists;  // Owned; their buffers are swapped with ImGui's after Render
+        std::vector<UINT64> liveTextures; // As passed to AddLiveTexture, zero handles kept in place
+        std::vector<RECT> dirtyRects;
+        uint64_t hash = 0;
+    };
+    struct DeferredMessage {
+        HWND hwnd;
+        UINT msg;
+        WPARAM wParam;
+        LPARAM lParam;
+    };
+    void BuildDrawData();  // EndFrame's build half, ImGui::Render to the dirty rects
+    void RecordDrawData(ImDrawData* drawData); // And its render thread half, handed to a worker
+    void BuildFrame(BuiltFrame& frame, const std::function<void()>& buildUi);
+    void CaptureBuiltFrame(BuiltFrame& frame);
+    void RunBuild(std::function<void()> buildUi); // The build job
+    void WaitForBuild();
+    bool DeferMessage(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
+
+    // Cached UI layer
+    void RenderDrawData(ImDrawData* drawData, ID3D12GraphicsCommandList* commandList);
+    bool IsLiveTexture(UINT64 texture) const;
+    uint64_t HashCachedDrawData(const ImDrawData* drawData, int splitList, int splitCommand) const;
+    bool EnsureUiLayerTarget(int width, int height);
+    void ReleaseUiLayerTarget();
+    void CompositeUiLayer(ID3D12GraphicsCommandList* commandList, ID3D12RootSignature* rootSignature,
+                          ID3D12PipelineState* pipelineState);
+    // Draws the commands from (beginList, beginCommand) up to, not including, (endList, endCommand)
+    void RenderDrawDataRange(const ImDrawData* drawData, int beginList, int beginCommand, int endList,
+                             int endCommand, ID3D12GraphicsCommandList* commandList);
+
     ImGuiContext* m_imguiContext = nullptr;
     RenderSystem* m_renderSystem = nullptr;
     HWND m_hwnd = nullptr;
     bool m_showDemoWindow = true;
+    bool m_geometryRingEnabled = true;
+
+    std::string m_iniPath; // Window layout; empty without a profile directory
+
+    std::vector<RECT> m_hitRects;
 
-    // DirectX 12 specific resources
-    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_srvDescHeap;
-    UINT m_fontDescriptorIndex = 0;
+    // Window bounds submitted last frame (for the debug visualization)
+    std::vector<RECT> m_lastContentRects;
+
+    // Compact window
+    bool m_compactWindow = false;
+    RECT m_displayArea = {};
+    RECT m_contentBounds = {}; // Display coordinates
+    bool m_hasContent = false;
+    ImVec2 m_windowOffset = ImVec2(0.0f, 0.0f); // Last frame's window position in the display area
+
+    // DirectX 12 specific resources (SRVs live in the ResourceManager's shared heap)
     Microsoft::WRL::ComPtr<ID3D12Resource> m_fontTextureResource;
+
+    // Glyph atlas: one bit per 256 code point block of the BMP
+    static constexpr size_t GLYPH_BLOCK_COUNT = 0x10000 / 256;
+    std::bitset<GLYPH_BLOCK_COUNT> m_loadedGlyphBlocks;
+    std::bitset<GLYPH_BLOCK_COUNT> m_requestedGlyphBlocks;
+    std::vector<ImWchar> m_glyphRanges; // Must outlive the atlas build
+    DistanceFieldFont m_distanceFieldFont; // Its font data too
+    bool m_fontAtlasFromCache = false;
+    ImFontAtlas* m_loadedFontAtlas = nullptr; // LoadFonts's, until InitializeRenderer installs it
+    bool m_rendererInitialized = false;
+    float m_dpiScale = 1.0f;
+    float m_pendingDpiScale = 1.0f;
+
+    // Cached UI layer (render target at the frame's target size, back buffer format)
+    bool m_uiLayerCacheEnabled = true;
+    std::vector<UINT64> m_liveTextures; // The recorded frame's
+    std::vector<UINT64> m_buildLiveTextures; // AddLiveTexture's, for the frame being built
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_uiLayerTarget;
+    ResourceDescriptor m_uiLayerRtv;
+    ResourceDescriptor m_uiLayerSrv;
+    int m_uiLayerWidth = 0;
+    int m_uiLayerHeight = 0;
+    DXGI_FORMAT m_uiLayerFormat = DXGI_FORMAT_UNKNOWN;
+    bool m_uiLayerValid = false;       // The target holds m_uiLayerHash's output
+    uint64_t m_uiLayerHash = 0;
+    uint64_t m_previousLayerHash = 0;  // Last frame's, to tell a static UI from a changing one
+    UiLayerStats m_uiLayerStats;
+
+    // Pipelined frames: m_buildMutex guards the build's state and the deferred messages.
+    // m_frames[m_recordFrame] is recorded while the build job builds the other one.
+    bool m_pipelinedBuild = false;
+    std::mutex m_buildMutex;
+    JobCounter m_buildJobs;     // The frame's build job, waited for by FinishFrameBuild
+    JobCounter m_recordCounter; // The frame's recording job; its continuation submits the frame
+    bool m_buildRunning = false; // Queued or running
+    std::exception_ptr m_buildError;
+    std::vector<DeferredMessage> m_deferredMessages; // Sent to the window during a build
+    BuiltFrame m_frames[2];
+    int m_recordFrame = 0;
+    bool m_frameReady = false; // m_frames[m_recordFrame] holds a frame not yet invalidated by a device reset
 };
\ No newline at end of file
@@ -0,0 +1,40 @@
+// GameOverlay - InputLatency.cpp
+// Input-to-photon measurement mode: input stamps carried to the first present that shows them
+
+#include "InputLatency.h"
+#include <atomic>
+
+namespace {
+
+std::atomic<bool> g_measuring = false;
+std::atomic<LONGLONG> g_pendingInputQpc = 0; // 0 = none
+
+} // namespace
+
+void SetInputLatencyMeasurement(bool enabled) {
+    g_measuring.store(enabled, std::memory_order_relaxed);
+    if (!enabled) g_pendingInputQpc.store(0, std::memory_order_relaxed);
+}
+
+bool IsInputLatencyMeasurementEnabled() {
+    return g_measuring.load(std::memory_order_relaxed);
+}
+
+void StampInput(LONGLONG inputQpc) {
+    if (inputQpc == 0 || !g_measuring.load(std::memory_order_relaxed)) return;
+    LONGLONG pending = g_pendingInputQpc.load(std::memory_order_relaxed);
+    while ((pending == 0 || inputQpc < pending) &&
+        !g_pendingInputQpc.compare_exchange_weak(pending, inputQpc, std::memory_order_relaxed)) {
+    }
+}
+
+LONGLONG QueryInputTime() {
+    if (!g_measuring.load(std::memory_order_relaxed)) return 0;
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+LONGLONG TakeInputStamp() {
+    return g_pendingInputQpc.exchange(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,27 @@
+// GameOverlay - InputLatency.h
+// Input-to-photon measurement mode: input stamps carried to the first present that shows them
+
+#pragma once
+
+#include <Windows.h>
+
+// Off unless enabled (--measure-input-latency, or the performance settings page). Input is stamped
+// with its QPC time where the overlay first sees it: on the Raw Input thread for hotkeys (carried
+// with the queued action), in the keyboard hook when that is the fallback, and in the window
+// procedure for the window's own mouse and key messages. Dispatched hotkeys and window messages
+// hand their stamp on with StampInput; before building the UI the render loop takes the oldest one
+// waiting and tags its frame (RenderSystem::TagFrameInput), and the frame statistics resolve it to
+// the vblank of that frame's present like paint-to-photon. Mouse moves are not stamped: most of
+// them change nothing on screen, and a frame would still be tagged with them.
+//
+// The window path starts at the window procedure, so time spent in the message queue while the
+// main thread waited is not counted there; the Raw Input path counts it.
+void SetInputLatencyMeasurement(bool enabled);
+bool IsInputLatencyMeasurementEnabled();
+
+// Any thread; ignored unless measuring. The oldest stamp waiting wins.
+void StampInput(LONGLONG inputQpc);
+LONGLONG QueryInputTime(); // QPC now, or 0 unless measuring
+
+// Main thread, before the frame reads input state: the oldest stamp waiting, 0 when none
+LONGLONG TakeInputStamp();
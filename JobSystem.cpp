@@ -0,0 +1,287 @@
+// GameOverlay - JobSystem.cpp
+// Shared worker threads for background work: priorities, core classes, work stealing and render thread continuations
+
+#include "JobSystem.h"
+#include "ThreadPolicy.h"
+#include "ThreadCycles.h"
+#include "CpuProfiler.h"
+#include "Log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+
+namespace {
+
+thread_local JobClass t_workerClass = JobClass::Count; // Count: not a worker
+thread_local void* t_worker = nullptr;
+
+constexpr size_t PriorityIndex(JobPriority priority) { return static_cast<size_t>(priority); }
+
+} // namespace
+
+// --- JobCounter ---
+
+void JobCounter::Wait() {
+    while (!IsDone()) {
+        if (JobSystem::Get().RunPendingJob()) continue;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait_for(lock, std::chrono::milliseconds(1), [this]() { return IsDone(); });
+    }
+    // The last Done may still be notifying; once it lets go of the mutex the counter can go away
+    std::lock_guard<std::mutex> lock(m_mutex);
+}
+
+void JobCounter::WaitBlocking() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return IsDone(); });
+}
+
+void JobCounter::Done() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        m_done.notify_all();
+    }
+}
+
+// --- JobSystem ---
+
+JobSystem& JobSystem::Get() {
+    static JobSystem jobSystem;
+    return jobSystem;
+}
+
+JobSystem::JobSystem() {
+    m_renderThreadEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr); // Manual reset: set while jobs wait
+
+    // Efficiency workers fill the E-cores up to a few; the performance class stays small
+    const unsigned hardwareThreads = std::max(std::thread::hardware_concurrency(), 2u);
+    const size_t efficiencyCores = GetEfficiencyCpuSets().size();
+    const uint32_t efficiencyWorkers = efficiencyCores > 0 ?
+        static_cast<uint32_t>(std::clamp<size_t>(efficiencyCores, 2, 4)) : 2u;
+    const uint32_t performanceWorkers = hardwareThreads > 4 ? 2u : 1u;
+
+    auto addWorkers = [this](JobClass jobClass, uint32_t count) {
+        ClassState& state = m_classes[static_cast<size_t>(jobClass)];
+        for (uint32_t i = 0; i < count; i++) {
+            auto worker = std::make_unique<Worker>();
+            worker->jobClass = jobClass;
+            worker->index = i;
+            state.workers.push_back(worker.get());
+            m_workers.push_back(std::move(worker));
+        }
+    };
+    addWorkers(JobClass::Efficiency, efficiencyWorkers);
+    addWorkers(JobClass::Performance, performanceWorkers);
+
+    // Every worker is registered before any can start stealing
+    for (const std::unique_ptr<Worker>& worker : m_workers) {
+        worker->thread = std::thread(&JobSystem::WorkerThread, this, worker.get());
+    }
+}
+
+JobSystem::~JobSystem() {
+    for (ClassState& state : m_classes) {
+        std::lock_guard<std::mutex> lock(state.sleepMutex);
+        m_stopping = true;
+    }
+    for (ClassState& state : m_classes) {
+        state.wake.notify_all();
+    }
+    for (const std::unique_ptr<Worker>& worker : m_workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+
+    // Owners wait for their jobs before they go away; anything left is released unrun
+    for (const std::unique_ptr<Worker>& worker : m_workers) {
+        for (std::deque<Job>& queue : worker->queues) {
+            for (Job& job : queue) {
+                if (job.counter) job.counter->Done();
+            }
+        }
+    }
+    if (m_renderThreadEvent) CloseHandle(m_renderThreadEvent);
+}
+
+void JobSystem::Submit(const JobDesc& desc, std::function<void()> work) {
+    Submit(desc, std::move(work), nullptr);
+}
+
+void JobSystem::Submit(const JobDesc& desc, std::function<void()> work, std::function<void()> renderThreadContinuation) {
+    Job job;
+    job.work = std::move(work);
+    job.continuation = std::move(renderThreadContinuation);
+    job.name = desc.name;
+    job.counter = desc.counter;
+    if (job.counter) job.counter->Add();
+    Enqueue(desc, std::move(job));
+}
+
+void JobSystem::Enqueue(const JobDesc& desc, Job job) {
+    ClassState& state = m_classes[static_cast<size_t>(desc.jobClass)];
+
+    // A worker of the class keeps what it spawns; other threads hand out round robin
+    Worker* target = nullptr;
+    if (t_worker && t_workerClass == desc.jobClass) {
+        target = static_cast<Worker*>(t_worker);
+    }
+    else {
+        uint32_t next = state.nextWorker.fetch_add(1, std::memory_order_relaxed);
+        target = state.workers[next % state.workers.size()];
+    }
+    {
+        std::lock_guard<std::mutex> lock(target->mutex);
+        target->queues[PriorityIndex(desc.priority)].push_back(std::move(job));
+    }
+    {
+        std::lock_guard<std::mutex> lock(state.sleepMutex);
+        state.queuedJobs.fetch_add(1, std::memory_order_relaxed);
+    }
+    state.wake.notify_one();
+}
+
+bool JobSystem::TakeJob(JobClass jobClass, Worker* self, Job& job) {
+    ClassState& state = m_classes[static_cast<size_t>(jobClass)];
+    if (state.queuedJobs.load(std::memory_order_relaxed) == 0) return false;
+
+    const size_t workerCount = state.workers.size();
+    const size_t start = self ? self->index : 0;
+    for (size_t priority = 0; priority < PriorityIndex(JobPriority::Count); priority++) {
+        // Own queue: oldest first, so submissions run roughly in order
+        if (self) {
+            std::lock_guard<std::mutex> lock(self->mutex);
+            std::deque<Job>& queue = self->queues[priority];
+            if (!queue.empty()) {
+                job = std::move(queue.front());
+                queue.pop_front();
+                state.queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        // Steal from the busy end of the others
+        for (size_t i = 0; i < workerCount; i++) {
+            Worker* victim = state.workers[(start + i) % workerCount];
+            if (victim == self) continue;
+            std::lock_guard<std::mutex> lock(victim->mutex);
+            std::deque<Job>& queue = victim->queues[priority];
+            if (!queue.empty()) {
+                job = std::move(queue.back());
+                queue.pop_back();
+                state.queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+                if (self) m_stolenJobs.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool JobSystem::RunPendingJob() {
+    Job job;
+    if (t_worker) {
+        if (!TakeJob(t_workerClass, static_cast<Worker*>(t_worker), job)) return false;
+    }
+    else {
+        // Waiting on the render thread for a job with a continuation means running it here
+        if (GetCurrentThreadId() == m_renderThreadId.load(std::memory_order_relaxed) &&
+            WaitForSingleObject(m_renderThreadEvent, 0) == WAIT_OBJECT_0) {
+            RunRenderThreadContinuations();
+            return true;
+        }
+        if (!TakeJob(JobClass::Performance, nullptr, job) && !TakeJob(JobClass::Efficiency, nullptr, job)) {
+            return false;
+        }
+    }
+    Execute(job);
+    return true;
+}
+
+void JobSystem::Execute(Job& job) {
+    {
+#if GAMEOVERLAY_CPU_PROFILER
+        CpuProfileZone zone(job.name);
+#endif
+        try {
+            job.work();
+        }
+        catch (const std::exception& e) {
+            LOG_ERROR("Job %s failed: %s", job.name, e.what());
+        }
+    }
+    m_completedJobs.fetch_add(1, std::memory_order_relaxed);
+
+    if (job.continuation) {
+        // The counter stays raised until the continuation has run
+        Job continuation;
+        continuation.work = std::move(job.continuation);
+        continuation.name = job.name;
+        continuation.counter = job.counter;
+        std::lock_guard<std::mutex> lock(m_renderThreadMutex);
+        m_renderThreadJobs.push_back(std::move(continuation));
+        SetEvent(m_renderThreadEvent);
+    }
+    else if (job.counter) {
+        job.counter->Done();
+    }
+}
+
+void JobSystem::WorkerThread(Worker* worker) {
+    char name[32];
+    if (worker->jobClass == JobClass::Efficiency) {
+        ConfigureWorkerThread();
+        snprintf(name, sizeof(name), "Job Worker E%u", worker->index);
+    }
+    else {
+        SetThreadEcoQoS(GetCurrentThread(), false);
+        snprintf(name, sizeof(name), "Job Worker P%u", worker->index);
+    }
+    PROFILE_THREAD(name);
+    ThreadCycles::RegisterThread(ThreadSubsystem::Jobs);
+    t_worker = worker;
+    t_workerClass = worker->jobClass;
+
+    HRESULT coInit = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    ClassState& state = m_classes[static_cast<size_t>(worker->jobClass)];
+    while (true) {
+        Job job;
+        if (TakeJob(worker->jobClass, worker, job)) {
+            Execute(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(state.sleepMutex);
+        state.wake.wait(lock, [&]() { return m_stopping || state.queuedJobs.load(std::memory_order_relaxed) > 0; });
+        if (m_stopping) break;
+    }
+    if (SUCCEEDED(coInit)) CoUninitialize();
+}
+
+void JobSystem::PostToRenderThread(const char* name, std::function<void()> work, JobCounter* counter) {
+    Job job;
+    job.work = std::move(work);
+    job.name = name;
+    job.counter = counter;
+    if (counter) counter->Add();
+    std::lock_guard<std::mutex> lock(m_renderThreadMutex);
+    m_renderThreadJobs.push_back(std::move(job));
+    SetEvent(m_renderThreadEvent);
+}
+
+void JobSystem::RunRenderThreadContinuations() {
+    m_renderThreadId.store(GetCurrentThreadId(), std::memory_order_relaxed);
+    // Taken out first: a continuation may wait on a counter, which runs this again
+    std::vector<Job> jobs;
+    {
+        std::lock_guard<std::mutex> lock(m_renderThreadMutex);
+        if (m_renderThreadJobs.empty()) return;
+        jobs.swap(m_renderThreadJobs);
+        ResetEvent(m_renderThreadEvent);
+    }
+    PROFILE_ZONE("Job Continuations");
+    for (Job& job : jobs) {
+        Execute(job);
+    }
+}
+
+uint32_t JobSystem::GetWorkerCount(JobClass jobClass) const {
+    return static_cast<uint32_t>(m_classes[static_cast<size_t>(jobClass)].workers.size());
+}
@@ -0,0 +1,142 @@
+// GameOverlay - JobSystem.h
+// Shared worker threads for background work: priorities, core classes, work stealing and render thread continuations
+
+#pragma once
+
+#include <Windows.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum class JobPriority : uint8_t {
+    High,   // Something on screen is waiting for it (a pipeline the next frame needs)
+    Normal,
+    Low,    // Nobody waits (prewarming, cache writes)
+    Count
+};
+
+// Which workers may run a job
+enum class JobClass : uint8_t {
+    Efficiency,  // Below normal, EcoQoS, on the efficiency cores of hybrid CPUs: keeps off the game's cores
+    Performance, // Normal priority, never throttled: latency matters more than staying out of the way
+    Count
+};
+
+// Unfinished jobs of a group, so an owner can wait for its jobs before it goes away
+class JobCounter {
+public:
+    JobCounter() = default;
+
+    // Disable copy and move
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+    JobCounter(JobCounter&&) = delete;
+    JobCounter& operator=(JobCounter&&) = delete;
+
+    bool IsDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+    uint32_t GetPending() const { return m_pending.load(std::memory_order_acquire); }
+    // On a worker this runs other queued jobs meanwhile, so waiting for a job never starves it
+    void Wait();
+    // Only blocks: for the render thread in the middle of a frame, where no continuation may run
+    void WaitBlocking();
+
+private:
+    friend class JobSystem;
+    void Add() { m_pending.fetch_add(1, std::memory_order_relaxed); }
+    void Done();
+
+    std::atomic<uint32_t> m_pending{ 0 };
+    std::mutex m_mutex;
+    std::condition_variable m_done;
+};
+
+struct JobDesc {
+    const char* name = "Job"; // String literal; the job's zone in the CPU profiler
+    JobPriority priority = JobPriority::Normal;
+    JobClass jobClass = JobClass::Efficiency;
+    JobCounter* counter = nullptr; // Optional; counts the job (and its continuation) until it finishes
+};
+
+// One pool of worker threads for every subsystem, started on first use. Each worker has a queue
+// per priority and takes the most urgent job it can find: its own queues first, then (once they
+// are empty) the other workers of its class, oldest last. Jobs submitted from a worker go to that
+// worker's queues, so work a job spawns tends to stay on its core. Workers are in the
+// multithreaded COM apartment.
+// A continuation runs on the render thread (the main loop) after its job, in the next
+// RunRenderThreadContinuations; GetRenderThreadEvent is signaled while any are waiting.
+class JobSystem {
+public:
+    static JobSystem& Get();
+
+    // Disable copy and move
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    JobSystem(JobSystem&&) = delete;
+    JobSystem& operator=(JobSystem&&) = delete;
+
+    void Submit(const JobDesc& desc, std::function<void()> work);
+    void Submit(const JobDesc& desc, std::function<void()> work, std::function<void()> renderThreadContinuation);
+    void PostToRenderThread(const char* name, std::function<void()> work, JobCounter* counter = nullptr);
+
+    // --- Render Thread ---
+    // Also run by JobCounter::Wait on the render thread, so waiting there can't deadlock
+    void RunRenderThreadContinuations();
+    HANDLE GetRenderThreadEvent() const { return m_renderThreadEvent; }
+
+    // Runs one queued job of a class this thread may take; false when there was none
+    bool RunPendingJob();
+
+    uint32_t GetWorkerCount(JobClass jobClass) const;
+    uint64_t GetCompletedJobs() const { return m_completedJobs.load(std::memory_order_relaxed); }
+    uint64_t GetStolenJobs() const { return m_stolenJobs.load(std::memory_order_relaxed); }
+
+private:
+    struct Job {
+        std::function<void()> work;
+        std::function<void()> continuation; // Posted to the render thread afterwards
+        const char* name = nullptr;
+        JobCounter* counter = nullptr;
+    };
+
+    struct Worker {
+        JobClass jobClass = JobClass::Efficiency;
+        uint32_t index = 0; // Within its class
+        std::mutex mutex;
+        std::deque<Job> queues[static_cast<size_t>(JobPriority::Count)];
+        std::thread thread;
+    };
+
+    struct ClassState {
+        std::vector<Worker*> workers;
+        std::atomic<uint32_t> queuedJobs{ 0 };
+        std::atomic<uint32_t> nextWorker{ 0 }; // Round robin for submissions from other threads
+        std::mutex sleepMutex;
+        std::condition_variable wake;
+    };
+
+    JobSystem();
+    ~JobSystem();
+
+    void Enqueue(const JobDesc& desc, Job job);
+    bool TakeJob(JobClass jobClass, Worker* self, Job& job);
+    void Execute(Job& job);
+    void WorkerThread(Worker* worker);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    ClassState m_classes[static_cast<size_t>(JobClass::Count)];
+    bool m_stopping = false; // Guarded by each class's sleepMutex
+
+    std::mutex m_renderThreadMutex;
+    std::vector<Job> m_renderThreadJobs;
+    HANDLE m_renderThreadEvent = nullptr;
+    std::atomic<DWORD> m_renderThreadId{ 0 }; // The thread calling RunRenderThreadContinuations
+
+    std::atomic<uint64_t> m_completedJobs{ 0 };
+    std::atomic<uint64_t> m_stolenJobs{ 0 };
+};
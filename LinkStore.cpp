@@ -0,0 +1,225 @@
+// GameOverlay - LinkStore.cpp
+// Contiguous link storage with a category index and an incremental search index
+
+#include "LinkStore.h"
+#include <algorithm>
+#include <numeric>
+#include <cctype>
+
+namespace {
+
+std::string ToLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+bool IsWordStart(const std::string& key, size_t position) {
+    if (position == 0) return true;
+    char previous = key[position - 1];
+    return previous == ' ' || previous == '/' || previous == '.' || previous == '-' || previous == '_';
+}
+
+} // namespace
+
+size_t LinkStore::FindCategory(const std::string& name) const {
+    auto it = m_categoryIndex.find(name);
+    return it == m_categoryIndex.end() ? m_categories.size() : it->second;
+}
+
+bool LinkStore::AddCategory(const std::string& name) {
+    if (name.empty() || FindCategory(name) != m_categories.size()) return false;
+    auto position = std::lower_bound(m_categories.begin(), m_categories.end(), name,
+        [](const Category& category, const std::string& value) { return category.name < value; });
+    m_categories.insert(position, Category{ name, {} });
+    RebuildCategoryIndex();
+    return true;
+}
+
+bool LinkStore::RenameCategory(const std::string& oldName, const std::string& newName) {
+    size_t category = FindCategory(oldName);
+    if (oldName == newName || newName.empty() || category == m_categories.size() ||
+        FindCategory(newName) != m_categories.size()) {
+        return false;
+    }
+    Category renamed = std::move(m_categories[category]);
+    renamed.name = newName;
+    m_categories.erase(m_categories.begin() + category);
+    auto position = std::lower_bound(m_categories.begin(), m_categories.end(), newName,
+        [](const Category& existing, const std::string& value) { return existing.name < value; });
+    m_categories.insert(position, std::move(renamed));
+    RebuildCategoryIndex();
+    return true;
+}
+
+void LinkStore::DeleteCategory(const std::string& name) {
+    size_t category = FindCategory(name);
+    if (category == m_categories.size()) return;
+
+    // Compact the links that stay, then renumber every category's list
+    std::vector<uint32_t> remap(m_links.size(), UINT32_MAX);
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < m_links.size(); i++) {
+        if (m_links[i].category == category) continue;
+        remap[i] = kept;
+        if (kept != i) m_links[kept] = std::move(m_links[i]);
+        kept++;
+    }
+    m_links.resize(kept);
+    m_categories.erase(m_categories.begin() + category);
+    for (Category& remaining : m_categories) {
+        for (uint32_t& link : remaining.links) link = remap[link];
+    }
+    RebuildCategoryIndex();
+    InvalidateSearch();
+}
+
+const std::string& LinkStore::GetLinkCategory(uint32_t link) const {
+    return m_categories[m_links[link].category].name;
+}
+
+bool LinkStore::AddLink(const std::string& category, const Link& link) {
+    size_t index = FindCategory(category);
+    if (index == m_categories.size() || link.name.empty() || link.url.empty()) return false;
+
+    Entry entry;
+    entry.link = link;
+    entry.category = static_cast<uint32_t>(index);
+    entry.searchKey = ToLower(link.name + " " + link.url);
+    entry.charMask = CharMask(entry.searchKey);
+    uint32_t linkIndex = static_cast<uint32_t>(m_links.size());
+    m_links.push_back(std::move(entry));
+    m_categories[index].links.push_back(linkIndex);
+
+    // Indexed incrementally: the new link joins the current results if it matches
+    if (m_searchValid && !m_lastQuery.empty()) {
+        const Entry& added = m_links.back();
+        uint64_t queryMask = CharMask(m_lastQuery);
+        int score = (added.charMask & queryMask) == queryMask ? MatchScore(added.searchKey, m_lastQuery) : -1;
+        if (score >= 0) {
+            size_t position = 0;
+            while (position < m_resultScores.size() && m_resultScores[position] >= score) position++;
+            m_results.insert(m_results.begin() + position, linkIndex);
+            m_resultScores.insert(m_resultScores.begin() + position, score);
+        }
+    }
+    return true;
+}
+
+size_t LinkStore::AddLinks(const std::string& category, std::vector<Link>&& links) {
+    size_t index = FindCategory(category);
+    if (index == m_categories.size()) return 0;
+
+    std::vector<uint32_t>& categoryLinks = m_categories[index].links;
+    m_links.reserve(m_links.size() + links.size());
+    categoryLinks.reserve(categoryLinks.size() + links.size());
+    size_t added = 0;
+    for (Link& link : links) {
+        if (link.name.empty() || link.url.empty()) continue;
+        Entry entry;
+        entry.searchKey = ToLower(link.name + " " + link.url);
+        entry.charMask = CharMask(entry.searchKey);
+        entry.link = std::move(link);
+        entry.category = static_cast<uint32_t>(index);
+        categoryLinks.push_back(static_cast<uint32_t>(m_links.size()));
+        m_links.push_back(std::move(entry));
+        added++;
+    }
+    if (added > 0) InvalidateSearch();
+    return added;
+}
+
+void LinkStore::DeleteLink(uint32_t link) {
+    if (link >= m_links.size()) return;
+    std::vector<uint32_t>& categoryLinks = m_categories[m_links[link].category].links;
+    categoryLinks.erase(std::remove(categoryLinks.begin(), categoryLinks.end(), link), categoryLinks.end());
+    m_links.erase(m_links.begin() + link);
+    for (Category& category : m_categories) {
+        for (uint32_t& index : category.links) {
+            if (index > link) index--;
+        }
+    }
+    InvalidateSearch();
+}
+
+const std::vector<uint32_t>& LinkStore::Search(const std::string& query) {
+    std::string lowered = ToLower(query);
+    if (m_searchValid && lowered == m_lastQuery) return m_results;
+
+    // Narrow the previous results when the query only grew; otherwise scan everything
+    std::vector<uint32_t> candidates;
+    if (m_searchValid && !m_lastQuery.empty() && lowered.compare(0, m_lastQuery.size(), m_lastQuery) == 0) {
+        candidates.swap(m_results);
+    }
+    else {
+        candidates.resize(m_links.size());
+        std::iota(candidates.begin(), candidates.end(), 0u);
+    }
+
+    m_results.clear();
+    m_resultScores.clear();
+    if (!lowered.empty()) {
+        uint64_t queryMask = CharMask(lowered);
+        std::vector<std::pair<int, uint32_t>> scored;
+        for (uint32_t link : candidates) {
+            const Entry& entry = m_links[link];
+            if ((entry.charMask & queryMask) != queryMask) continue;
+            int score = MatchScore(entry.searchKey, lowered);
+            if (score >= 0) scored.emplace_back(score, link);
+        }
+        std::stable_sort(scored.begin(), scored.end(),
+            [](const auto& a, const auto& b) { return a.first > b.first || (a.first == b.first && a.second < b.second); });
+        m_results.reserve(scored.size());
+        m_resultScores.reserve(scored.size());
+        for (const auto& [score, link] : scored) {
+            m_results.push_back(link);
+            m_resultScores.push_back(score);
+        }
+    }
+    m_lastQuery = lowered;
+    m_searchValid = true;
+    return m_results;
+}
+
+void LinkStore::ReleaseSearch() {
+    InvalidateSearch();
+    std::vector<uint32_t>().swap(m_results);
+    std::vector<int>().swap(m_resultScores);
+}
+
+uint64_t LinkStore::CharMask(const std::string& text) {
+    // One bit per byte value modulo 64: collisions only let a few extra links through to MatchScore
+    uint64_t mask = 0;
+    for (unsigned char c : text) {
+        if (c != ' ') mask |= 1ull << (c & 63);
+    }
+    return mask;
+}
+
+int LinkStore::MatchScore(const std::string& key, const std::string& query) {
+    int score = 0;
+    size_t position = 0;
+    size_t previous = std::string::npos;
+    for (char c : query) {
+        if (c == ' ') continue; // Spaces separate words in the query but needn't match
+        size_t found = key.find(c, position);
+        if (found == std::string::npos) return -1;
+        score += 1;
+        if (previous != std::string::npos && found == previous + 1) score += 3;
+        if (IsWordStart(key, found)) score += 2;
+        previous = found;
+        position = found + 1;
+    }
+    // Shorter keys first among equal matches
+    return std::max(0, score * 16 - static_cast<int>(std::min<size_t>(key.size(), 15)));
+}
+
+void LinkStore::RebuildCategoryIndex() {
+    m_categoryIndex.clear();
+    for (size_t i = 0; i < m_categories.size(); i++) {
+        m_categoryIndex[m_categories[i].name] = i;
+        for (uint32_t link : m_categories[i].links) {
+            m_links[link].category = static_cast<uint32_t>(i);
+        }
+    }
+}
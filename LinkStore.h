@@ -0,0 +1,87 @@
+// GameOverlay - LinkStore.h
+// Contiguous link storage with a category index and an incremental search index
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+struct Link {
+    std::string name;
+    std::string url;
+    std::string icon;
+    std::string image; // Image file shown instead of the icon once loaded
+};
+
+// Links live in one vector; each category keeps the indices of its links in insertion order, and
+// categories are kept sorted by name. Every link also has a lowercase search key (name and URL)
+// and a mask of the characters in it, so a search rejects most links with one AND before looking
+// at the text. Main thread only.
+class LinkStore {
+public:
+    LinkStore() = default;
+    ~LinkStore() = default;
+
+    // Disable copy and move
+    LinkStore(const LinkStore&) = delete;
+    LinkStore& operator=(const LinkStore&) = delete;
+    LinkStore(LinkStore&&) = delete;
+    LinkStore& operator=(LinkStore&&) = delete;
+
+    // --- Categories ---
+    size_t GetCategoryCount() const { return m_categories.size(); }
+    const std::string& GetCategoryName(size_t category) const { return m_categories[category].name; }
+    const std::vector<uint32_t>& GetCategoryLinks(size_t category) const { return m_categories[category].links; }
+    // Index of the category, or GetCategoryCount() when there is none
+    size_t FindCategory(const std::string& name) const;
+    bool AddCategory(const std::string& name);
+    bool RenameCategory(const std::string& oldName, const std::string& newName);
+    void DeleteCategory(const std::string& name); // With its links
+
+    // --- Links ---
+    size_t GetLinkCount() const { return m_links.size(); }
+    const Link& GetLink(uint32_t link) const { return m_links[link].link; }
+    const std::string& GetLinkCategory(uint32_t link) const;
+    bool AddLink(const std::string& category, const Link& link);
+    // Appends a batch to one category (imports); the search starts over once instead of
+    // merging each link. Returns how many were added, links without a name or URL are skipped.
+    size_t AddLinks(const std::string& category, std::vector<Link>&& links);
+    void DeleteLink(uint32_t link);
+
+    // --- Search ---
+    // Links whose name or URL contains the query's characters in order (case-insensitive), best
+    // first: contiguous matches, then matches at word starts, then shorter names. A query that
+    // extends the previous one only rescans the previous results. Valid until the store changes.
+    const std::vector<uint32_t>& Search(const std::string& query);
+    // Frees the last results; the next Search scans everything again
+    void ReleaseSearch();
+
+private:
+    struct Entry {
+        Link link;
+        uint32_t category = 0;
+        std::string searchKey; // Lowercase "name url"
+        uint64_t charMask = 0;
+    };
+    struct Category {
+        std::string name;
+        std::vector<uint32_t> links;
+    };
+
+    static uint64_t CharMask(const std::string& text);
+    static int MatchScore(const std::string& key, const std::string& query); // < 0: no match
+    void RebuildCategoryIndex(); // After categories were inserted or removed
+    void InvalidateSearch() { m_lastQuery.clear(); m_searchValid = false; }
+
+    std::vector<Entry> m_links;
+    std::vector<Category> m_categories; // Sorted by name
+    std::unordered_map<std::string, size_t> m_categoryIndex;
+
+    // Last search, for narrowing
+    std::string m_lastQuery;
+    bool m_searchValid = false;
+    std::vector<uint32_t> m_results;
+    std::vector<int> m_resultScores; // Parallel to m_results
+};
@@ -4,40 +4,134 @@
 
 #include "LinksPage.h"
 #include "imgui.h"
+#include "ImGuiSystem.h"
+#include "SettingsDatabase.h"
 #include <algorithm>
+#include <cstdio>
+
+namespace {
+
+// Indices are zero-padded so the sorted keys come back in order
+std::string MakeLinkKey(const char* kind, size_t index, const char* field = nullptr) {
+    char key[64];
+    snprintf(key, sizeof(key), field ? "links.%s.%05zu.%s" : "links.%s.%05zu", kind, index, field);
+    return key;
+}
+
+} // namespace
+
+LinksPage::LinksPage(BrowserView* browserView, TextureLoader* textureLoader)
+    : PageBase("Links"), m_browserView(browserView), m_textureLoader(textureLoader) {
+    if (LoadLinks()) return;
 
-LinksPage::LinksPage() : PageBase("Links") {
     // Initialize with some example categories and links
-    m_categories["Gaming"] = {
-        { "Steam", "https://store.steampowered.com", "🎮" },
-        { "Epic Games", "https://www.epicgames.com", "🎮" },
-        { "Twitch", "https://www.twitch.tv", "📺" },
-        { "Discord", "https://discord.com", "💬" }
+    const struct {
+        const char* category;
+        std::vector<Link> links;
+    } examples[] = {
+        { "Gaming", {
+            { "Steam", "https://store.steampowered.com", "🎮" },
+            { "Epic Games", "https://www.epicgames.com", "🎮" },
+            { "Twitch", "https://www.twitch.tv", "📺" },
+            { "Discord", "https://discord.com", "💬" } } },
+        { "Social", {
+            { "Reddit", "https://www.reddit.com", "🌐" },
+            { "Twitter", "https://twitter.com", "🐦" },
+            { "YouTube", "https://www.youtube.com", "📺" },
+            { "Facebook", "https://www.facebook.com", "👥" } } },
+        { "News", {
+            { "CNN", "https://www.cnn.com", "📰" },
+            { "BBC", "https://www.bbc.com", "📰" },
+            { "The Guardian", "https://www.theguardian.com", "📰" },
+            { "Reuters", "https://www.reuters.com", "📰" } } },
+        { "Development", {
+            { "GitHub", "https://github.com", "💻" },
+            { "Stack Overflow", "https://stackoverflow.com", "❓" },
+            { "MDN Web Docs", "https://developer.mozilla.org", "📚" },
+            { "W3Schools", "https://www.w3schools.com", "🎓" } } }
     };
+    for (const auto& example : examples) {
+        m_store.AddCategory(example.category);
+        for (const Link& link : example.links) {
+            m_store.AddLink(example.category, link);
+        }
+    }
+}
 
-    m_categories["Social"] = {
-        { "Reddit", "https://www.reddit.com", "🌐" },
-        { "Twitter", "https://twitter.com", "🐦" },
-        { "YouTube", "https://www.youtube.com", "📺" },
-        { "Facebook", "https://www.facebook.com", "👥" }
-    };
+bool LinksPage::LoadLinks() {
+    const SettingsDatabase& db = SettingsDatabase::Get();
+    if (!db.GetBool("links.saved", false)) return false;
 
-    m_categories["News"] = {
-        { "CNN", "https://www.cnn.com", "📰" },
-        { "BBC", "https://www.bbc.com", "📰" },
-        { "The Guardian", "https://www.theguardian.com", "📰" },
-        { "Reuters", "https://www.reuters.com", "📰" }
-    };
+    for (const std::string& key : db.GetKeys("links.category.")) {
+        m_store.AddCategory(std::string(db.GetString(key)));
+    }
+    for (size_t i = 0; ; i++) {
+        std::string category(db.GetString(MakeLinkKey("link", i, "category")));
+        if (category.empty()) break;
+        Link link;
+        link.name = db.GetString(MakeLinkKey("link", i, "name"));
+        link.url = db.GetString(MakeLinkKey("link", i, "url"));
+        link.icon = db.GetString(MakeLinkKey("link", i, "icon"));
+        link.image = db.GetString(MakeLinkKey("link", i, "image"));
+        m_store.AddLink(category, link);
+        m_savedLinks = i + 1;
+    }
+    m_savedCategories = db.GetKeys("links.category.").size();
+    m_linksSaved = true;
+    return true;
+}
 
-    m_categories["Development"] = {
-        { "GitHub", "https://github.com", "💻" },
-        { "Stack Overflow", "https://stackoverflow.com", "❓" },
-        { "MDN Web Docs", "https://developer.mozilla.org", "📚" },
-        { "W3Schools", "https://www.w3schools.com", "🎓" }
-    };
+void LinksPage::SaveLinks() {
+    SettingsDatabase& db = SettingsDatabase::Get();
+    db.RemovePrefix("links.");
+    db.SetBool("links.saved", true); // An empty list stays empty instead of bringing back the examples
+    for (size_t i = 0; i < m_store.GetCategoryCount(); i++) {
+        db.SetString(MakeLinkKey("category", i), m_store.GetCategoryName(i));
+    }
+    for (uint32_t i = 0; i < m_store.GetLinkCount(); i++) {
+        const Link& link = m_store.GetLink(i);
+        db.SetString(MakeLinkKey("link", i, "category"), m_store.GetLinkCategory(i));
+        db.SetString(MakeLinkKey("link", i, "name"), link.name);
+        db.SetString(MakeLinkKey("link", i, "url"), link.url);
+        db.SetString(MakeLinkKey("link", i, "icon"), link.icon);
+        if (!link.image.empty()) db.SetString(MakeLinkKey("link", i, "image"), link.image);
+    }
+    db.Save();
+    m_savedLinks = m_store.GetLinkCount();
+    m_savedCategories = m_store.GetCategoryCount();
+    m_linksSaved = true;
+}
+
+void LinksPage::SaveNewLinks(const std::vector<std::string>& newCategories) {
+    // The examples were never saved, so there is nothing to add to
+    if (!m_linksSaved || m_savedLinks > m_store.GetLinkCount()) {
+        SaveLinks();
+        return;
+    }
+
+    // Loading takes the category keys in any order, so new ones just go after the saved ones
+    SettingsDatabase& db = SettingsDatabase::Get();
+    for (const std::string& category : newCategories) {
+        db.SetString(MakeLinkKey("category", m_savedCategories++), category);
+    }
+    for (uint32_t i = static_cast<uint32_t>(m_savedLinks); i < m_store.GetLinkCount(); i++) {
+        const Link& link = m_store.GetLink(i);
+        db.SetString(MakeLinkKey("link", i, "category"), m_store.GetLinkCategory(i));
+        db.SetString(MakeLinkKey("link", i, "name"), link.name);
+        db.SetString(MakeLinkKey("link", i, "url"), link.url);
+        db.SetString(MakeLinkKey("link", i, "icon"), link.icon);
+        if (!link.image.empty()) db.SetString(MakeLinkKey("link", i, "image"), link.image);
+    }
+    m_savedLinks = m_store.GetLinkCount();
+}
+
+void LinksPage::OnHidden() {
+    m_store.ReleaseSearch();
 }
 
 void LinksPage::Render() {
+    MergeImportedBookmarks();
+
     ImGui::BeginChild("LinksPageScroll", ImVec2(0, 0), false, ImGuiWindowFlags_AlwaysVerticalScrollbar);
 
     // Render category management section at the top
@@ -47,8 +141,16 @@ void LinksPage::Render() {
     ImGui::Separator();
     ImGui::Spacing();
 
-    // Render links organized by category
-    RenderCategoryLinks();
+    // Search across all categories, or the links organized by category
+    ImGui::SetNextItemWidth(300.0f);
+    ImGui::InputTextWithHint("##LinkSearch", "Search links", m_searchBuffer, sizeof(m_searchBuffer));
+    ImGui::Spacing();
+    if (m_searchBuffer[0] != '\0') {
+        RenderSearchResults();
+    }
+    else {
+        RenderCategoryLinks();
+    }
 
     ImGui::EndChild();
 
@@ -91,6 +193,9 @@ void LinksPage::Render() {
             ImGui::EndCombo();
         }
 
+        // Optional image (PNG, JPEG, ICO...) drawn in place of the icon
+        ImGui::InputText("Image", m_linkImageBuffer, sizeof(m_linkImageBuffer));
+
         ImGui::Spacing();
 
         if (ImGui::Button("Add", ImVec2(120, 0))) {
@@ -102,12 +207,14 @@ void LinksPage::Render() {
                 }
 
                 // Add link to the category
-                AddLink(m_currentCategory, m_linkNameBuffer, url, strlen(m_linkIconBuffer) > 0 ? m_linkIconBuffer : "🌐");
+                AddLink(m_currentCategory, m_linkNameBuffer, url, strlen(m_linkIconBuffer) > 0 ? m_linkIconBuffer : "🌐",
+                    m_linkImageBuffer);
 
                 // Clear buffers
                 m_linkNameBuffer[0] = '\0';
                 m_linkUrlBuffer[0] = '\0';
                 m_linkIconBuffer[0] = '\0';
+                m_linkImageBuffer[0] = '\0';
 
                 ImGui::CloseCurrentPopup();
             }
@@ -146,44 +253,46 @@ void LinksPage::RenderCategoryManagement() {
         ImGui::TableSetupColumn("Actions", ImGuiTableColumnFlags_WidthFixed, 120.0f);
         ImGui::TableHeadersRow();
 
-        for (auto& category : m_categories) {
+        for (size_t category = 0; category < m_store.GetCategoryCount(); category++) {
+            const std::string& name = m_store.GetCategoryName(category);
+            size_t linkCount = m_store.GetCategoryLinks(category).size();
             ImGui::TableNextRow();
 
             // Category name
             ImGui::TableNextColumn();
-            ImGui::Text("%s (%zu links)", category.first.c_str(), category.second.size());
+            ImGui::Text("%s (%zu links)", name.c_str(), linkCount);
 
             // Category actions
             ImGui::TableNextColumn();
-            ImGui::PushID(category.first.c_str());
+            ImGui::PushID(name.c_str());
 
             if (ImGui::Button("Add Link")) {
-                m_currentCategory = category.first;
+                m_currentCategory = name;
                 m_linkNameBuffer[0] = '\0';
                 m_linkUrlBuffer[0] = '\0';
                 m_linkIconBuffer[0] = '\0';
+                m_linkImageBuffer[0] = '\0';
                 m_showAddLinkDialog = true;
             }
 
             ImGui::SameLine();
 
             if (ImGui::Button("Delete")) {
-                // Store for deletion after loop
-                std::string categoryToDelete = category.first;
                 ImGui::OpenPopup("DeleteCategoryConfirm");
             }
 
             // Confirmation popup
             if (ImGui::BeginPopup("DeleteCategoryConfirm")) {
-                ImGui::Text("Delete category '%s'?", category.first.c_str());
-                ImGui::Text("This will delete all %zu links in this category.", category.second.size());
+                ImGui::Text("Delete category '%s'?", name.c_str());
+                ImGui::Text("This will delete all %zu links in this category.", linkCount);
                 ImGui::Separator();
 
                 if (ImGui::Button("Yes", ImVec2(60, 0))) {
-                    DeleteCategory(category.first);
+                    DeleteCategory(std::string(name)); // Copied: the name goes with the category
                     ImGui::CloseCurrentPopup();
+                    ImGui::EndPopup();
                     ImGui::PopID();
-                    break; // Break out of the loop since we're modifying the map
+                    break; // Break out of the loop since we're modifying the categories
                 }
 
                 ImGui::SameLine();
@@ -200,105 +309,233 @@ void LinksPage::RenderCategoryManagement() {
 
         ImGui::EndTable();
     }
+
+    ImGui::Spacing();
+    RenderImport();
+}
+
+void LinksPage::RenderImport() {
+    BookmarkImporter::Progress progress = m_importer.GetProgress();
+
+    ImGui::SetNextItemWidth(300.0f);
+    ImGui::InputTextWithHint("##BookmarkFile", "Bookmarks file (Chrome/Edge JSON or HTML export)",
+        m_importPathBuffer, sizeof(m_importPathBuffer));
+    ImGui::SameLine();
+    if (progress.active) {
+        if (ImGui::Button("Cancel Import")) m_importer.Cancel();
+        float fraction = progress.fileSize > 0 ?
+            static_cast<float>(static_cast<double>(progress.bytesRead) / static_cast<double>(progress.fileSize)) : 0.0f;
+        char overlay[64];
+        snprintf(overlay, sizeof(overlay), "%zu of %zu bookmarks", m_importedLinks, progress.bookmarks);
+        ImGui::ProgressBar(std::min(fraction, 1.0f), ImVec2(300.0f, 0.0f), overlay);
+        return;
+    }
+
+    if (ImGui::Button("Import Bookmarks") && m_importPathBuffer[0] != '\0') {
+        m_importedLinks = 0;
+        m_importOpenFailed = !m_importer.Start(m_importPathBuffer);
+    }
+    if (m_importOpenFailed) {
+        RenderErrorText("Can't open the bookmarks file");
+    }
+    else if (progress.failed) {
+        RenderErrorText("Not a bookmarks file; the bookmarks read before the error were kept");
+    }
+    else if (m_importedLinks > 0) {
+        ImGui::TextDisabled("%zu bookmarks imported", m_importedLinks);
+    }
+}
+
+void LinksPage::MergeImportedBookmarks() {
+    if (m_importer.TakeBatch(m_importBatch, IMPORT_BATCH) == 0) {
+        // The batches are already in the database; the file is written once at the end (on
+        // SettingsStore's thread)
+        if (m_importUnsaved && !m_importer.GetProgress().active) {
+            m_importUnsaved = false;
+            SettingsDatabase::Get().Save();
+        }
+        return;
+    }
+
+    // Bookmarks come out folder by folder, so the batch is added in runs of one category
+    std::vector<Link> run;
+    std::vector<std::string> newCategories;
+    std::string category;
+    for (size_t i = 0; i <= m_importBatch.size(); i++) {
+        std::string next;
+        if (i < m_importBatch.size()) {
+            const std::string& folder = m_importBatch[i].folder;
+            next = folder.empty() ? "Imported" : "Imported - " + folder;
+        }
+        if ((next != category || i == m_importBatch.size()) && !run.empty()) {
+            if (m_store.AddCategory(category)) newCategories.push_back(category);
+            m_importedLinks += m_store.AddLinks(category, std::move(run));
+            run.clear();
+        }
+        if (i == m_importBatch.size()) break;
+        category = std::move(next);
+        BookmarkImporter::Bookmark& bookmark = m_importBatch[i];
+        run.push_back(Link{ std::move(bookmark.name), std::move(bookmark.url), "🌐" });
+    }
+    SaveNewLinks(newCategories);
+    m_importUnsaved = true;
 }
 
 void LinksPage::RenderCategoryLinks() {
     ImGui::BeginTabBar("CategoriesTabBar");
 
-    for (auto& category : m_categories) {
-        if (ImGui::BeginTabItem(category.first.c_str())) {
-            RenderSectionHeader(category.first);
+    uint32_t linkToDelete = UINT32_MAX;
+    for (size_t category = 0; category < m_store.GetCategoryCount(); category++) {
+        const std::string& name = m_store.GetCategoryName(category);
+        if (ImGui::BeginTabItem(name.c_str())) {
+            RenderSectionHeader(name);
+
+            const std::vector<uint32_t>& links = m_store.GetCategoryLinks(category);
+            linkToDelete = RenderLinkGrid(links, false);
+
+            // If no links in this category, show a message
+            if (links.empty()) {
+                ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "No links in this category.");
+                ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "Click 'Add Link' button above to add links.");
+            }
+
+            ImGui::EndTabItem();
+        }
+    }
+
+    ImGui::EndTabBar();
+
+    // Deleted after the loop since it renumbers the links
+    if (linkToDelete != UINT32_MAX) {
+        m_store.DeleteLink(linkToDelete);
+        SaveLinks();
+    }
+}
+
+void LinksPage::RenderSearchResults() {
+    const std::vector<uint32_t>& results = m_store.Search(m_searchBuffer);
+    ImGui::TextDisabled("%zu of %zu links", results.size(), m_store.GetLinkCount());
+    if (results.empty()) {
+        ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "No links match.");
+        return;
+    }
+
+    uint32_t linkToDelete = RenderLinkGrid(results, true);
+    if (linkToDelete != UINT32_MAX) {
+        m_store.DeleteLink(linkToDelete);
+        SaveLinks();
+    }
+}
 
-            // Create a grid of link buttons
-            float buttonWidth = 160.0f;
-            float buttonHeight = 70.0f;
-            float windowWidth = ImGui::GetContentRegionAvail().x;
-            int buttonsPerRow = std::max(1, static_cast<int>(windowWidth / buttonWidth));
+uint32_t LinksPage::RenderLinkGrid(const std::vector<uint32_t>& links, bool showCategory) {
+    // Create a grid of link buttons
+    float buttonWidth = 160.0f;
+    float buttonHeight = 70.0f;
+    float windowWidth = ImGui::GetContentRegionAvail().x;
+    int buttonsPerRow = std::max(1, static_cast<int>(windowWidth / buttonWidth));
+    int rowCount = (static_cast<int>(links.size()) + buttonsPerRow - 1) / buttonsPerRow;
+
+    // Rows are all the same height, so the clipper measures the first and skips the ones out of view
+    uint32_t linkToDelete = UINT32_MAX;
+    ImGuiListClipper clipper;
+    clipper.Begin(rowCount);
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+            size_t rowEnd = std::min(links.size(), static_cast<size_t>(row + 1) * buttonsPerRow);
+            for (size_t i = static_cast<size_t>(row) * buttonsPerRow; i < rowEnd; i++) {
+                const Link& link = m_store.GetLink(links[i]);
 
-            int linkIndex = 0;
-            for (auto& link : category.second) {
                 // Start new row when needed
-                if (linkIndex % buttonsPerRow != 0) {
+                if (i % buttonsPerRow != 0) {
                     ImGui::SameLine();
                 }
 
                 // Link button
-                ImGui::PushID(linkIndex);
+                ImGui::PushID(static_cast<int>(links[i]));
                 ImGui::BeginGroup();
 
-                // Link button with icon
-                std::string buttonLabel = link.icon + " " + link.name;
-                if (ImGui::Button(buttonLabel.c_str(), ImVec2(buttonWidth - 10, buttonHeight - 20))) {
-                    // In a real implementation, this would navigate to the URL
-                    // For now, just show a tooltip with the URL
+                // Link button with its image, the placeholder while it loads (never waits for it); the
+                // icon when there is none or it failed to decode
+                D3D12_GPU_DESCRIPTOR_HANDLE image = {};
+                if (m_textureLoader && !link.image.empty()) {
+                    image = m_textureLoader->GetImage(link.image);
+                    if (m_textureLoader->IsImageFailed(link.image)) image = {};
+                }
+
+                bool clicked = false;
+                ImGuiSystem::RequestGlyphs(link.name);
+                if (image.ptr != 0) {
+                    float imageSize = buttonHeight - 20 - ImGui::GetStyle().FramePadding.y * 2;
+                    clicked = ImGui::ImageButton("##image", reinterpret_cast<ImTextureID>(image.ptr),
+                        ImVec2(imageSize, imageSize));
+                    ImGui::SameLine();
+                    clicked |= ImGui::Button(link.name.c_str(),
+                        ImVec2(buttonWidth - 10 - ImGui::GetItemRectSize().x - ImGui::GetStyle().ItemSpacing.x,
+                            buttonHeight - 20));
+                }
+                else {
+                    std::string buttonLabel = link.icon + " " + link.name;
+                    clicked = ImGui::Button(buttonLabel.c_str(), ImVec2(buttonWidth - 10, buttonHeight - 20));
+                }
+                if (clicked) {
+                    if (m_browserView) {
+                        m_browserView->Navigate(link.url);
+                    }
                 }
 
                 if (ImGui::IsItemHovered()) {
-                    ImGui::SetTooltip("%s", link.url.c_str());
+                    if (showCategory) {
+                        ImGui::SetTooltip("%s\n%s", link.url.c_str(), m_store.GetLinkCategory(links[i]).c_str());
+                    }
+                    else {
+                        ImGui::SetTooltip("%s", link.url.c_str());
+                    }
+                    // Connect (or prerender) while the pointer is on the link
+                    if (m_browserView) {
+                        m_browserView->SpeculateNavigation(link.url);
+                    }
                 }
 
                 // Delete button below the link
                 if (ImGui::Button("Delete", ImVec2(buttonWidth - 10, 20))) {
-                    DeleteLink(category.first, linkIndex);
-                    ImGui::PopID();
-                    ImGui::EndGroup();
-                    break; // Break out of the loop since we're modifying the vector
+                    linkToDelete = links[i];
                 }
 
                 ImGui::EndGroup();
                 ImGui::PopID();
-
-                linkIndex++;
-            }
-
-            // If no links in this category, show a message
-            if (category.second.empty()) {
-                ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "No links in this category.");
-                ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "Click 'Add Link' button above to add links.");
             }
-
-            ImGui::EndTabItem();
         }
     }
-
-    ImGui::EndTabBar();
+    clipper.End();
+    return linkToDelete;
 }
 
 void LinksPage::AddCategory(const std::string& name) {
-    if (!name.empty() && m_categories.find(name) == m_categories.end()) {
-        m_categories[name] = std::vector<Link>();
-    }
+    if (m_store.AddCategory(name)) SaveLinks();
 }
 
 void LinksPage::RenameCategory(const std::string& oldName, const std::string& newName) {
-    if (oldName != newName && !newName.empty() &&
-        m_categories.find(oldName) != m_categories.end() &&
-        m_categories.find(newName) == m_categories.end()) {
-
-        // Copy links from old category to new
-        m_categories[newName] = m_categories[oldName];
-
-        // Delete old category
-        m_categories.erase(oldName);
-    }
+    if (m_store.RenameCategory(oldName, newName)) SaveLinks();
 }
 
 void LinksPage::DeleteCategory(const std::string& name) {
-    m_categories.erase(name);
+    m_store.DeleteCategory(name);
+    SaveLinks();
 }
 
-void LinksPage::AddLink(const std::string& category, const std::string& name, const std::string& url, const std::string& icon) {
-    if (!category.empty() && !name.empty() && !url.empty() &&
-        m_categories.find(category) != m_categories.end()) {
-
-        m_categories[category].push_back({ name, url, icon });
+void LinksPage::AddLink(const std::string& category, const std::string& name, const std::string& url, const std::string& icon,
+    const std::string& image) {
+    if (!category.empty() && m_store.AddLink(category, { name, url, icon, image })) {
+        SaveLinks();
     }
 }
 
 void LinksPage::DeleteLink(const std::string& category, int linkIndex) {
-    if (m_categories.find(category) != m_categories.end() &&
-        linkIndex >= 0 && linkIndex < m_categories[category].size()) {
-
-        m_categories[category].erase(m_categories[category].begin() + linkIndex);
+    size_t index = m_store.FindCategory(category);
+    if (index == m_store.GetCategoryCount()) return;
+    const std::vector<uint32_t>& links = m_store.GetCategoryLinks(index);
+    if (linkIndex >= 0 && linkIndex < static_cast<int>(links.size())) {
+        m_store.DeleteLink(links[linkIndex]);
+        SaveLinks();
     }
-}
\ No newline at end of file
+}
@@ -5,47 +5,81 @@
 #pragma once
 
 #include "PageBase.h"
+#include "BrowserView.h"
+#include "TextureLoader.h"
+#include "LinkStore.h"
+#include "BookmarkImporter.h"
 #include <string>
 #include <vector>
-#include <map>
 
 class LinksPage : public PageBase {
 public:
-    LinksPage();
+    LinksPage(BrowserView* browserView = nullptr, TextureLoader* textureLoader = nullptr);
     ~LinksPage() = default;
 
     // Render links page content
     void Render() override;
+    // Changes come from input, or from an import while it runs
+    float GetRefreshRate() const override { return m_importer.GetProgress().active ? 0.0f : 2.0f; }
+    void OnHidden() override; // Drops the search results; the query is kept
 
 private:
     // Render category management section
     void RenderCategoryManagement();
 
-    // Render links for each category
+    // Render links for each category, or the search results while there is a query
     void RenderCategoryLinks();
+    void RenderSearchResults();
+    // Grid of link buttons; only the rows in view are submitted (ImGuiListClipper).
+    // Returns the link whose Delete button was pressed, or UINT32_MAX.
+    uint32_t RenderLinkGrid(const std::vector<uint32_t>& links, bool showCategory);
+    // Bookmark file import: path, progress, cancel
+    void RenderImport();
+    // Moves up to IMPORT_BATCH parsed bookmarks into the store; saves once the import is done
+    void MergeImportedBookmarks();
 
     // Add/edit/delete functionality
     void AddCategory(const std::string& name);
     void RenameCategory(const std::string& oldName, const std::string& newName);
     void DeleteCategory(const std::string& name);
-    void AddLink(const std::string& category, const std::string& name, const std::string& url, const std::string& icon);
-    void DeleteLink(const std::string& category, int linkIndex);
+    void AddLink(const std::string& category, const std::string& name, const std::string& url, const std::string& icon,
+                 const std::string& image = "");
+    void DeleteLink(const std::string& category, int linkIndex); // Index within the category
 
-    // Link data structure
-    struct Link {
-        std::string name;
-        std::string url;
-        std::string icon;
-    };
+    // Saved as "links.*" in SettingsDatabase after every change; the examples until then
+    bool LoadLinks();
+    void SaveLinks();
+    // An import only adds: each batch writes just its own links and categories, and the file is
+    // written once at the end, instead of rewriting every link when the import is done
+    void SaveNewLinks(const std::vector<std::string>& newCategories);
 
-    // Map of category name to array of links
-    std::map<std::string, std::vector<Link>> m_categories;
+    // Browser view (not owned)
+    BrowserView* m_browserView = nullptr;
+    TextureLoader* m_textureLoader = nullptr;
+
+    // Links and categories (categories sorted by name)
+    LinkStore m_store;
+
+    // Bookmarks go in "Imported - <folder>" categories, a batch per frame
+    static constexpr size_t IMPORT_BATCH = 512;
+    BookmarkImporter m_importer;
+    std::vector<BookmarkImporter::Bookmark> m_importBatch;
+    size_t m_importedLinks = 0;
+    bool m_importUnsaved = false;
+    // What the database holds, for SaveNewLinks
+    size_t m_savedLinks = 0;
+    size_t m_savedCategories = 0;
+    bool m_linksSaved = false;
+    bool m_importOpenFailed = false;
 
     // UI state
+    char m_searchBuffer[256] = {};
     char m_categoryBuffer[256] = {};
     char m_linkNameBuffer[256] = {};
     char m_linkUrlBuffer[1024] = {};
     char m_linkIconBuffer[64] = {};
+    char m_linkImageBuffer[MAX_PATH] = {};
+    char m_importPathBuffer[MAX_PATH] = {};
     std::string m_currentCategory;
     bool m_showAddLinkDialog = false;
 };
\ No newline at end of file
@@ -0,0 +1,359 @@
+// GameOverlay - Log.cpp
+// Diagnostics log: per-thread lock-free rings of unformatted records, written out by a background thread
+
+#include "Log.h"
+#include "CpuProfiler.h"
+#include "ThreadPolicy.h"
+#include "ThreadCycles.h"
+#include <Windows.h>
+#include <TraceLoggingProvider.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+std::atomic<LogLevel> Log::s_minimumLevel{ LogLevel::Info };
+
+// {5B0D3B2E-7A64-4F1C-9C3E-2D8F1A6B4E07}
+TRACELOGGING_DEFINE_PROVIDER(g_logProvider, "GameOverlay",
+    (0x5b0d3b2e, 0x7a64, 0x4f1c, 0x9c, 0x3e, 0x2d, 0x8f, 0x1a, 0x6b, 0x4e, 0x07));
+
+namespace {
+
+constexpr uint32_t RING_MASK = Log::RECORDS_PER_THREAD - 1;
+constexpr DWORD DRAIN_INTERVAL_MS = 20; // Records arriving together are drained together
+
+// Written by its thread only; the writer thread reads up to writeIndex and then releases the
+// slots by advancing readIndex
+struct LogRing {
+    LogRecord records[Log::RECORDS_PER_THREAD];
+    std::atomic<uint32_t> writeIndex{ 0 };
+    std::atomic<uint32_t> readIndex{ 0 };
+    std::atomic<uint32_t> dropped{ 0 };
+    std::atomic<bool> retired{ false }; // Thread exited; freed by the writer once empty
+    uint32_t threadId = 0;
+};
+
+// Rings outlive their threads until drained, so registration hands ownership to the registry
+struct LogRingOwner {
+    LogRing* ring = nullptr;
+    ~LogRingOwner() {
+        if (ring) ring->retired.store(true, std::memory_order_release);
+    }
+};
+
+std::mutex g_ringsMutex;
+std::vector<LogRing*> g_rings;
+thread_local LogRingOwner t_ring;
+
+// The writer sleeps without a timeout while every ring is empty: it sets g_writerParked, checks the
+// rings once more and waits; the first record after that signals the wake event
+std::atomic<bool> g_writerParked{ false };
+
+HANDLE GetWriterWakeEvent() {
+    static HANDLE event = CreateEventW(nullptr, FALSE, FALSE, nullptr); // Lives as long as the process
+    return event;
+}
+
+LogRing* GetThreadRing() {
+    if (!t_ring.ring) {
+        LogRing* ring = new LogRing();
+        ring->threadId = GetCurrentThreadId();
+        std::lock_guard<std::mutex> lock(g_ringsMutex);
+        g_rings.push_back(ring);
+        t_ring.ring = ring;
+    }
+    return t_ring.ring;
+}
+
+// Mapped view of the current file; a crash leaves everything appended so far in it (the pages
+// belong to the file, not the process)
+class MappedLogFile {
+public:
+    ~MappedLogFile() { Close(); }
+
+    bool Open(const std::string& path) {
+        m_file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE,
+            nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) {
+            m_file = nullptr;
+            return false;
+        }
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(Log::FILE_BYTES), nullptr);
+        if (m_mapping) {
+            m_view = static_cast<char*>(MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, Log::FILE_BYTES));
+        }
+        if (!m_view) {
+            Close();
+            return false;
+        }
+        m_written = 0;
+        return true;
+    }
+
+    bool Fits(size_t length) const { return m_view && m_written + length <= Log::FILE_BYTES; }
+
+    void Append(const char* text, size_t length) {
+        memcpy(m_view + m_written, text, length);
+        m_written += length;
+    }
+
+    // Truncated to what was written; the mapping made it FILE_BYTES long
+    void Close() {
+        if (m_view) UnmapViewOfFile(m_view);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file) {
+            LARGE_INTEGER end;
+            end.QuadPart = static_cast<LONGLONG>(m_written);
+            SetFilePointerEx(m_file, end, nullptr, FILE_BEGIN);
+            SetEndOfFile(m_file);
+            CloseHandle(m_file);
+        }
+        m_view = nullptr;
+        m_mapping = nullptr;
+        m_file = nullptr;
+    }
+
+    bool IsOpen() const { return m_view != nullptr; }
+
+private:
+    HANDLE m_file = nullptr;
+    HANDLE m_mapping = nullptr;
+    char* m_view = nullptr;
+    size_t m_written = 0;
+};
+
+class LogWriter {
+public:
+    explicit LogWriter(const std::string& directory) {
+        if (!directory.empty()) {
+            CreateDirectoryA(directory.c_str(), nullptr);
+            m_basePath = directory + "\\GameOverlay";
+        }
+        QueryPerformanceFrequency(&m_frequency);
+        QueryPerformanceCounter(&m_origin);
+        TraceLoggingRegister(g_logProvider);
+        RotateFiles();
+        m_stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        m_thread = std::thread(&LogWriter::Run, this);
+    }
+
+    ~LogWriter() {
+        SetEvent(m_stopEvent);
+        m_thread.join();
+        CloseHandle(m_stopEvent);
+        Drain(); // Whatever was written while the thread stopped
+        m_file.Close();
+        TraceLoggingUnregister(g_logProvider);
+    }
+
+    // Disable copy and move
+    LogWriter(const LogWriter&) = delete;
+    LogWriter& operator=(const LogWriter&) = delete;
+    LogWriter(LogWriter&&) = delete;
+    LogWriter& operator=(LogWriter&&) = delete;
+
+private:
+    struct Pending {
+        int64_t ticks;
+        const LogRecord* record;
+    };
+
+    void Run() {
+        ConfigureWorkerThread();
+        PROFILE_THREAD("Log Writer");
+        ThreadCycles::RegisterThread(ThreadSubsystem::Logging);
+        const HANDLE events[] = { m_stopEvent, GetWriterWakeEvent() };
+        while (true) {
+            Drain();
+
+            // Parked before the last look at the rings, so a record written after it wakes us
+            g_writerParked.store(true);
+            if (HasRecords()) {
+                g_writerParked.store(false);
+            }
+            else if (WaitForMultipleObjects(2, events, FALSE, INFINITE) == WAIT_OBJECT_0) {
+                break;
+            }
+            g_writerParked.store(false);
+
+            // What arrives over the next interval is drained with the record that woke us
+            if (WaitForSingleObject(m_stopEvent, DRAIN_INTERVAL_MS) == WAIT_OBJECT_0) break;
+        }
+    }
+
+    bool HasRecords() {
+        std::lock_guard<std::mutex> lock(g_ringsMutex);
+        for (LogRing* ring : g_rings) {
+            if (ring->readIndex.load(std::memory_order_relaxed) != ring->writeIndex.load() ||
+                ring->dropped.load(std::memory_order_relaxed) != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Drain() {
+        PROFILE_ZONE("Log Drain");
+        // Ring pointers stay valid: only this thread frees them
+        {
+            std::lock_guard<std::mutex> lock(g_ringsMutex);
+            m_rings = g_rings;
+        }
+
+        m_pending.clear();
+        m_readUpTo.clear();
+        for (LogRing* ring : m_rings) {
+            uint32_t read = ring->readIndex.load(std::memory_order_relaxed);
+            uint32_t write = ring->writeIndex.load(std::memory_order_acquire);
+            for (uint32_t i = read; i != write; i++) {
+                const LogRecord& record = ring->records[i & RING_MASK];
+                m_pending.push_back({ record.ticks, &record });
+            }
+            m_readUpTo.push_back(write);
+
+            uint32_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+            if (dropped > 0) {
+                char line[96];
+                int length = snprintf(line, sizeof(line), "%u log records dropped on thread %u (ring full)", dropped, ring->threadId);
+                Emit(LogLevel::Warning, ring->threadId, 0, line, static_cast<size_t>(length));
+            }
+        }
+
+        // Threads interleave by time
+        std::sort(m_pending.begin(), m_pending.end(), [](const Pending& a, const Pending& b) { return a.ticks < b.ticks; });
+        char message[1024];
+        for (const Pending& pending : m_pending) {
+            const LogRecord& record = *pending.record;
+            int length = record.formatFn(message, sizeof(message), record.format, record.payload);
+            if (length < 0) continue;
+            Emit(record.level, record.threadId, record.ticks, message, std::min(static_cast<size_t>(length), sizeof(message) - 1));
+        }
+
+        for (size_t i = 0; i < m_rings.size(); i++) {
+            LogRing* ring = m_rings[i];
+            ring->readIndex.store(m_readUpTo[i], std::memory_order_release);
+        }
+        ReleaseRetiredRings();
+    }
+
+    void Emit(LogLevel level, uint32_t threadId, int64_t ticks, const char* message, size_t length) {
+        static const char LEVEL_NAMES[] = { 'D', 'I', 'W', 'E' };
+        const double seconds = ticks > 0 ? static_cast<double>(ticks - m_origin.QuadPart) / m_frequency.QuadPart : 0.0;
+        char line[1200];
+        int lineLength = snprintf(line, sizeof(line), "[%10.3f] %c %5u %.*s\n", seconds,
+            LEVEL_NAMES[static_cast<size_t>(level)], threadId, static_cast<int>(length), message);
+        if (lineLength <= 0) return;
+        size_t lineBytes = std::min(static_cast<size_t>(lineLength), sizeof(line) - 1);
+
+        if (m_file.IsOpen() && !m_file.Fits(lineBytes)) {
+            m_file.Close();
+            RotateFiles();
+        }
+        if (m_file.IsOpen()) m_file.Append(line, lineBytes);
+
+        if (IsDebuggerPresent()) OutputDebugStringA(line);
+
+        if (TraceLoggingProviderEnabled(g_logProvider, 0, 0)) {
+            // The level is part of each event's static metadata
+            switch (level) {
+            case LogLevel::Debug:
+                TraceLoggingWrite(g_logProvider, "Log", TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                    TraceLoggingUInt32(threadId, "ThreadId"), TraceLoggingString(message, "Message"));
+                break;
+            case LogLevel::Info:
+                TraceLoggingWrite(g_logProvider, "Log", TraceLoggingLevel(WINEVENT_LEVEL_INFO),
+                    TraceLoggingUInt32(threadId, "ThreadId"), TraceLoggingString(message, "Message"));
+                break;
+            case LogLevel::Warning:
+                TraceLoggingWrite(g_logProvider, "Log", TraceLoggingLevel(WINEVENT_LEVEL_WARNING),
+                    TraceLoggingUInt32(threadId, "ThreadId"), TraceLoggingString(message, "Message"));
+                break;
+            case LogLevel::Error:
+                TraceLoggingWrite(g_logProvider, "Log", TraceLoggingLevel(WINEVENT_LEVEL_ERROR),
+                    TraceLoggingUInt32(threadId, "ThreadId"), TraceLoggingString(message, "Message"));
+                break;
+            }
+        }
+    }
+
+    // GameOverlay.log is always the newest; older ones move up to GameOverlay.<n>.log
+    void RotateFiles() {
+        if (m_basePath.empty()) return;
+        for (int i = Log::KEPT_FILES - 1; i >= 1; i--) {
+            std::string from = i == 1 ? m_basePath + ".log" : m_basePath + "." + std::to_string(i - 1) + ".log";
+            std::string to = m_basePath + "." + std::to_string(i) + ".log";
+            MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING);
+        }
+        if (!m_file.Open(m_basePath + ".log")) {
+            // Debugger and ETW output still work
+            OutputDebugStringA("Warning: Failed to open the log file.\n");
+        }
+    }
+
+    void ReleaseRetiredRings() {
+        std::lock_guard<std::mutex> lock(g_ringsMutex);
+        for (auto it = g_rings.begin(); it != g_rings.end();) {
+            LogRing* ring = *it;
+            if (ring->retired.load(std::memory_order_acquire) &&
+                ring->readIndex.load(std::memory_order_relaxed) == ring->writeIndex.load(std::memory_order_acquire)) {
+                delete ring;
+                it = g_rings.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    std::string m_basePath; // Without the extension
+    MappedLogFile m_file;
+    LARGE_INTEGER m_frequency = {};
+    LARGE_INTEGER m_origin = {};
+    std::vector<LogRing*> m_rings;
+    std::vector<Pending> m_pending;
+    std::vector<uint32_t> m_readUpTo;
+    HANDLE m_stopEvent = nullptr;
+    std::thread m_thread;
+};
+
+std::mutex g_writerMutex;
+std::unique_ptr<LogWriter> g_writer;
+
+} // namespace
+
+void Log::Start(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(g_writerMutex);
+    if (!g_writer) g_writer = std::make_unique<LogWriter>(directory);
+}
+
+void Log::Stop() {
+    std::lock_guard<std::mutex> lock(g_writerMutex);
+    g_writer.reset();
+}
+
+LogRecord* Log::BeginRecord(LogLevel level, const char* format) {
+    LogRing* ring = GetThreadRing();
+    uint32_t write = ring->writeIndex.load(std::memory_order_relaxed);
+    if (write - ring->readIndex.load(std::memory_order_acquire) >= RECORDS_PER_THREAD) {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    LogRecord* record = &ring->records[write & RING_MASK];
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    record->ticks = now.QuadPart;
+    record->format = format;
+    record->threadId = ring->threadId;
+    record->level = level;
+    return record;
+}
+
+void Log::EndRecord() {
+    LogRing* ring = t_ring.ring;
+    ring->writeIndex.store(ring->writeIndex.load(std::memory_order_relaxed) + 1);
+    // Ordered after the store above, against the writer's park-then-check
+    if (g_writerParked.load() && g_writerParked.exchange(false)) {
+        SetEvent(GetWriterWakeEvent());
+    }
+}
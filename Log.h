@@ -0,0 +1,170 @@
+// GameOverlay - Log.h
+// Diagnostics log: per-thread lock-free rings of unformatted records, written out by a background thread
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+enum class LogLevel : uint8_t {
+    Debug,
+    Info,
+    Warning,
+    Error
+};
+
+// Formats a record's payload with its format string; instantiated per argument list
+using LogFormatFn = int (*)(char* out, size_t size, const char* format, const uint8_t* payload);
+
+struct LogRecord {
+    static constexpr size_t PAYLOAD_BYTES = 224;
+
+    int64_t ticks = 0;            // QueryPerformanceCounter
+    const char* format = nullptr; // String literal from the LOG_ macro
+    LogFormatFn formatFn = nullptr;
+    uint32_t threadId = 0;
+    LogLevel level = LogLevel::Info;
+    alignas(8) uint8_t payload[PAYLOAD_BYTES];
+};
+
+namespace LogDetail {
+
+// Trivially copyable arguments (numbers, pointers for %p) are stored as they are
+template<typename T>
+struct ValueCodec {
+    static_assert(std::is_arithmetic_v<T> || std::is_pointer_v<T>,
+        "Log arguments are numbers, pointers or strings (cast enums to their underlying type)");
+    static_assert(!std::is_pointer_v<T> || !std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, wchar_t>,
+        "Wide strings must be converted before logging");
+    using Decoded = T;
+    static constexpr size_t FIXED_BYTES = sizeof(T);
+    static constexpr bool IS_STRING = false;
+
+    static void Encode(uint8_t*& out, const T& value, size_t) {
+        memcpy(out, &value, sizeof(T));
+        out += sizeof(T);
+    }
+    static T Decode(const uint8_t*& in) {
+        T value;
+        memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return value;
+    }
+};
+
+// Strings are copied in (the caller's may be gone by the time the record is formatted):
+// a 16-bit length, the characters and a NUL, cut to the record's share for strings
+struct StringCodec {
+    using Decoded = const char*;
+    static constexpr size_t FIXED_BYTES = sizeof(uint16_t) + 1;
+    static constexpr bool IS_STRING = true;
+
+    static void Encode(uint8_t*& out, std::string_view text, size_t quota) {
+        uint16_t length = static_cast<uint16_t>(std::min(text.size(), quota));
+        memcpy(out, &length, sizeof(length));
+        memcpy(out + sizeof(length), text.data(), length);
+        out[sizeof(length) + length] = 0;
+        out += sizeof(length) + length + 1;
+    }
+    static void Encode(uint8_t*& out, const char* text, size_t quota) {
+        Encode(out, std::string_view(text ? text : "(null)"), quota);
+    }
+    static const char* Decode(const uint8_t*& in) {
+        uint16_t length;
+        memcpy(&length, in, sizeof(length));
+        const char* text = reinterpret_cast<const char*>(in + sizeof(length));
+        in += sizeof(length) + length + 1;
+        return text;
+    }
+};
+
+template<typename T> struct CodecFor { using Type = ValueCodec<T>; };
+template<> struct CodecFor<const char*> { using Type = StringCodec; };
+template<> struct CodecFor<char*> { using Type = StringCodec; };
+template<> struct CodecFor<std::string> { using Type = StringCodec; };
+template<> struct CodecFor<std::string_view> { using Type = StringCodec; };
+
+template<typename T>
+using Codec = typename CodecFor<std::decay_t<T>>::Type;
+
+template<typename... Codecs>
+int Format(char* out, size_t size, const char* format, const uint8_t* payload) {
+    const uint8_t* in = payload;
+    (void)in;
+    // Braced initialization decodes left to right
+    std::tuple<typename Codecs::Decoded...> values{ Codecs::Decode(in)... };
+    return std::apply([&](auto... value) { return snprintf(out, size, format, value...); }, values);
+}
+
+} // namespace LogDetail
+
+// Writing a record claims a slot in the calling thread's ring, stamps it and copies the arguments
+// in raw; nothing is formatted, locked or written on the calling thread. The writer thread
+// (Start) drains every ring in time order, formats the records and appends them to a memory-mapped
+// log file (a new one per run, the last few kept, rotated when full), to the debugger output
+// while one is attached, and to the TraceLogging provider "GameOverlay" while an ETW session
+// listens. A full ring drops the record and counts it; the writer reports the drops. While the
+// rings are empty the writer sleeps until the next record signals it.
+// Format strings must be string literals (only the pointer is stored).
+class Log {
+public:
+    static constexpr uint32_t RECORDS_PER_THREAD = 512; // Power of two
+    static constexpr size_t FILE_BYTES = 4 * 1024 * 1024;
+    static constexpr int KEPT_FILES = 3;
+
+    // Records written before Start wait in their rings
+    static void Start(const std::string& directory);
+    static void Stop(); // Drains what is left and closes the file
+
+    static void SetMinimumLevel(LogLevel level) { s_minimumLevel.store(level, std::memory_order_relaxed); }
+    static bool IsEnabled(LogLevel level) { return level >= s_minimumLevel.load(std::memory_order_relaxed); }
+
+    template<typename... Args>
+    static void Write(LogLevel level, const char* format, const Args&... args) {
+        if (!IsEnabled(level)) return;
+        LogRecord* record = BeginRecord(level, format);
+        if (!record) return;
+
+        constexpr size_t fixedBytes = (size_t(0) + ... + LogDetail::Codec<Args>::FIXED_BYTES);
+        constexpr size_t stringCount = (size_t(0) + ... + (LogDetail::Codec<Args>::IS_STRING ? 1 : 0));
+        static_assert(fixedBytes <= LogRecord::PAYLOAD_BYTES, "Too many log arguments for one record");
+        constexpr size_t stringQuota = stringCount > 0 ? (LogRecord::PAYLOAD_BYTES - fixedBytes) / stringCount : 0;
+
+        uint8_t* out = record->payload;
+        (LogDetail::Codec<Args>::Encode(out, args, stringQuota), ...);
+        (void)out;
+        record->formatFn = &LogDetail::Format<LogDetail::Codec<Args>...>;
+        EndRecord();
+    }
+
+private:
+    static LogRecord* BeginRecord(LogLevel level, const char* format); // Null when the ring is full
+    static void EndRecord();
+
+    static std::atomic<LogLevel> s_minimumLevel;
+};
+
+// Stops the log when it goes out of scope (WinMain's exits, including the fatal error paths)
+class LogSession {
+public:
+    explicit LogSession(const std::string& directory) { Log::Start(directory); }
+    ~LogSession() { Log::Stop(); }
+
+    // Disable copy and move
+    LogSession(const LogSession&) = delete;
+    LogSession& operator=(const LogSession&) = delete;
+    LogSession(LogSession&&) = delete;
+    LogSession& operator=(LogSession&&) = delete;
+};
+
+#define LOG_DEBUG(...) Log::Write(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) Log::Write(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARNING(...) Log::Write(LogLevel::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) Log::Write(LogLevel::Error, __VA_ARGS__)
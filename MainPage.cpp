@@ -4,10 +4,25 @@
 
 #include "MainPage.h"
 #include "imgui.h"
+#include "ImGuiSystem.h"
 #include "GameOverlay.h"
 #include <algorithm>
 
-MainPage::MainPage() : PageBase("Main") {
+namespace {
+    // "https://www.example.com/path" -> "example.com"
+    std::string GetSiteHost(const std::string& url) {
+        size_t start = url.find("://");
+        start = start == std::string::npos ? 0 : start + 3;
+        size_t end = url.find_first_of("/?#:", start);
+        std::string host = url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        if (host.compare(0, 4, "www.") == 0) host.erase(0, 4);
+        return host;
+    }
+}
+
+MainPage::MainPage(BrowserView* browserView, TextureLoader* textureLoader, PerformanceMonitor* performanceMonitor)
+    : PageBase("Main"), m_browserView(browserView), m_textureLoader(textureLoader),
+      m_performanceMonitor(performanceMonitor) {
     // Initialize recent items for demo
     m_recentItems = {
         { "Google", "https://www.google.com", "🔍" },
@@ -16,11 +31,32 @@ MainPage::MainPage() : PageBase("Main") {
         { "GitHub", "https://www.github.com", "💻" },
         { "Twitter", "https://www.twitter.com", "🐦" }
     };
+}
 
-    // Initialize performance history
-    for (int i = 0; i < PERFORMANCE_HISTORY; i++) {
-        m_fpsHistory[i] = 0;
-        m_memoryHistory[i] = 0;
+void MainPage::UpdateRecentItemImages() {
+    std::vector<BrowserManager::TabInfo> tabs;
+    if (m_browserView && m_browserView->IsBrowserStarted() && m_browserView->GetBrowserManager()) {
+        tabs = m_browserView->GetBrowserManager()->GetTabs();
+    }
+    const D3D12_GPU_DESCRIPTOR_HANDLE placeholder = m_textureLoader ? m_textureLoader->GetPlaceholder() :
+        D3D12_GPU_DESCRIPTOR_HANDLE{};
+
+    for (RecentItem& item : m_recentItems) {
+        item.image = placeholder;
+        item.imageWidth = 1;
+        item.imageHeight = 1;
+        const std::string host = GetSiteHost(item.url);
+        for (const BrowserManager::TabInfo& tab : tabs) {
+            D3D12_GPU_DESCRIPTOR_HANDLE thumbnail = {};
+            UINT width = 0, height = 0;
+            if (tab.page && GetSiteHost(tab.page->url) == host &&
+                m_browserView->GetTabThumbnail(tab.id, thumbnail, width, height) && width > 0 && height > 0) {
+                item.image = thumbnail;
+                item.imageWidth = width;
+                item.imageHeight = height;
+                break;
+            }
+        }
     }
 }
 
@@ -40,11 +76,6 @@ void MainPage::Render() {
     RenderPerformanceSection();
 
     ImGui::EndChild();
-
-    // Update performance history
-    m_fpsHistory[m_performanceHistoryIndex] = ImGui::GetIO().Framerate;
-    m_memoryHistory[m_performanceHistoryIndex] = 100.0f; // Placeholder, will be replaced with actual memory usage
-    m_performanceHistoryIndex = (m_performanceHistoryIndex + 1) % PERFORMANCE_HISTORY;
 }
 
 void MainPage::RenderWelcomeSection() {
@@ -99,6 +130,7 @@ void MainPage::RenderQuickAccessSection() {
     float windowWidth = ImGui::GetContentRegionAvail().x;
     int itemsPerRow = std::max(1, static_cast<int>(windowWidth / itemWidth));
 
+    UpdateRecentItemImages();
     for (int i = 0; i < m_recentItems.size(); i++) {
         const auto& item = m_recentItems[i];
 
@@ -106,12 +138,29 @@ void MainPage::RenderQuickAccessSection() {
             ImGui::SameLine();
 
         ImGui::BeginGroup();
-        ImGui::Button(item.icon.c_str(), ImVec2(40, 40));
-        if (ImGui::IsItemClicked()) {
-            // Open URL in browser tab - would be implemented in actual integration
+        ImGui::PushID(i);
+        if (item.image.ptr != 0) {
+            // Square, cropped from the middle of the thumbnail
+            float imageSize = 40 - ImGui::GetStyle().FramePadding.y * 2;
+            const float aspect = static_cast<float>(item.imageWidth) / item.imageHeight;
+            const float cropU = aspect > 1.0f ? (1.0f - 1.0f / aspect) * 0.5f : 0.0f;
+            const float cropV = aspect < 1.0f ? (1.0f - aspect) * 0.5f : 0.0f;
+            ImGui::ImageButton("##image", reinterpret_cast<ImTextureID>(item.image.ptr), ImVec2(imageSize, imageSize),
+                ImVec2(cropU, cropV), ImVec2(1.0f - cropU, 1.0f - cropV));
+        }
+        else {
+            ImGui::Button(item.icon.c_str(), ImVec2(40, 40));
+        }
+        ImGui::PopID();
+        if (ImGui::IsItemClicked() && m_browserView) {
+            m_browserView->Navigate(item.url);
+        }
+        if (ImGui::IsItemHovered() && m_browserView) {
+            m_browserView->SpeculateNavigation(item.url);
         }
 
         // Center text under icon
+        ImGuiSystem::RequestGlyphs(item.name);
         float textWidth = ImGui::CalcTextSize(item.name.c_str()).x;
         ImGui::SetCursorPosX(ImGui::GetCursorPosX() + (40 - textWidth) * 0.5f);
         ImGui::TextWrapped("%s", item.name.c_str());
@@ -133,18 +182,22 @@ void MainPage::RenderQuickAccessSection() {
 void MainPage::RenderPerformanceSection() {
     RenderSectionHeader("Performance Monitor");
 
-    // FPS graph
-    ImGui::Text("Framerate");
-    ImGui::PlotLines("##fps", m_fpsHistory, PERFORMANCE_HISTORY, m_performanceHistoryIndex,
-        nullptr, 0.0f, 120.0f, ImVec2(0, 80));
-    ImGui::Text("Current: %.1f FPS", ImGui::GetIO().Framerate);
-    ImGui::Spacing();
-
-    // Memory usage graph
-    ImGui::Text("Memory Usage");
-    ImGui::PlotLines("##memory", m_memoryHistory, PERFORMANCE_HISTORY, m_performanceHistoryIndex,
-        nullptr, 0.0f, 200.0f, ImVec2(0, 80));
-    ImGui::Text("Current: %.1f MB", m_memoryHistory[m_performanceHistoryIndex == 0 ? PERFORMANCE_HISTORY - 1 : m_performanceHistoryIndex - 1]);
+    // The last 90 seconds, from the monitor's shared history
+    if (m_performanceMonitor) {
+        const MetricSeries& fps = m_performanceMonitor->GetMetricSeries(Metric::FramesPerSecond);
+        ImGui::Text("Framerate");
+        RenderMetricGraph("##fps", fps, 90.0, 0.0f, 120.0f, 80.0f);
+        ImGui::Text("Current: %.1f FPS", fps.GetLast());
+        ImGui::Spacing();
+
+        const MetricSeries& memory = m_performanceMonitor->GetMetricSeries(Metric::MemoryMB);
+        ImGui::Text("Memory Usage");
+        RenderMetricGraph("##memory", memory, 90.0, 0.0f, 4096.0f, 80.0f);
+        ImGui::Text("Current: %.1f MB", memory.GetLast());
+    }
+    else {
+        ImGui::Text("Current: %.1f FPS", ImGui::GetIO().Framerate);
+    }
 
     ImGui::Spacing();
 
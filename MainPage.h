@@ -5,16 +5,21 @@
 #pragma once
 
 #include "PageBase.h"
+#include "BrowserView.h"
+#include "TextureLoader.h"
+#include "PerformanceMonitor.h"
 #include <string>
 #include <vector>
 
 class MainPage : public PageBase {
 public:
-    MainPage();
+    MainPage(BrowserView* browserView = nullptr, TextureLoader* textureLoader = nullptr,
+             PerformanceMonitor* performanceMonitor = nullptr);
     ~MainPage() = default;
 
     // Render main page content
     void Render() override;
+    float GetRefreshRate() const override { return 10.0f; } // Graphs
 
 private:
     // Render welcome section
@@ -31,13 +36,19 @@ private:
         std::string name;
         std::string url;
         std::string icon;
+        // A tab's captured thumbnail when one shows the item's site (TabThumbnailCache), else the
+        // loader's placeholder; the icon without either
+        D3D12_GPU_DESCRIPTOR_HANDLE image = {};
+        UINT imageWidth = 0;
+        UINT imageHeight = 0;
     };
+    // Each render: thumbnails come and go with tabs
+    void UpdateRecentItemImages();
 
     std::vector<RecentItem> m_recentItems;
 
-    // Performance data for graph
-    static constexpr int PERFORMANCE_HISTORY = 90;
-    float m_fpsHistory[PERFORMANCE_HISTORY] = {};
-    float m_memoryHistory[PERFORMANCE_HISTORY] = {};
-    int m_performanceHistoryIndex = 0;
+    // Browser view (not owned)
+    BrowserView* m_browserView = nullptr;
+    TextureLoader* m_textureLoader = nullptr;
+    PerformanceMonitor* m_performanceMonitor = nullptr; // Graph history
 };
\ No newline at end of file
@@ -0,0 +1,76 @@
+// GameOverlay - MetricSeries.cpp
+// Multi-resolution min/max history of one metric, shared by every graph that shows it
+
+#include "MetricSeries.h"
+#include <algorithm>
+#include <cmath>
+
+double MetricSeries::GetBucketSeconds(size_t level) {
+    double seconds = BASE_BUCKET_SECONDS;
+    for (size_t i = 0; i < level; i++) seconds *= LEVEL_RATIO;
+    return seconds;
+}
+
+void MetricSeries::Add(double time, float value) {
+    if (m_samples > 0) time = std::max(time, m_lastTime);
+
+    for (size_t level = 0; level < LEVEL_COUNT; level++) {
+        Level& state = m_levels[level];
+        uint64_t number = static_cast<uint64_t>(std::max(0.0, time) / GetBucketSeconds(level));
+        if (m_samples == 0) {
+            state.current = number;
+            state.oldest = number;
+        }
+        else if (number > state.current) {
+            // Buckets passed without a sample are emptied; a long gap empties the whole ring
+            uint64_t clearFrom = std::max(state.current + 1, number >= BUCKETS_PER_LEVEL ? number - BUCKETS_PER_LEVEL + 1 : 0);
+            for (uint64_t n = clearFrom; n <= number; n++) state.buckets[n % BUCKETS_PER_LEVEL] = Bucket{};
+            state.current = number;
+        }
+
+        Bucket& bucket = state.buckets[state.current % BUCKETS_PER_LEVEL];
+        if (bucket.count == 0) {
+            bucket.min = value;
+            bucket.max = value;
+        }
+        else {
+            bucket.min = std::min(bucket.min, value);
+            bucket.max = std::max(bucket.max, value);
+        }
+        bucket.sum += value;
+        bucket.count++;
+    }
+
+    m_samples++;
+    m_lastTime = time;
+    m_last = value;
+}
+
+void MetricSeries::Clear() {
+    m_levels = {};
+    m_samples = 0;
+    m_lastTime = 0.0;
+    m_last = 0.0f;
+}
+
+MetricSeries::View MetricSeries::GetView(double spanSeconds, size_t maxBuckets) const {
+    spanSeconds = std::clamp(spanSeconds, BASE_BUCKET_SECONDS, GetMaxSpanSeconds());
+    maxBuckets = std::max<size_t>(maxBuckets, 1);
+
+    size_t level = 0;
+    while (level + 1 < LEVEL_COUNT &&
+        (spanSeconds / GetBucketSeconds(level) > static_cast<double>(std::min(maxBuckets, BUCKETS_PER_LEVEL)))) {
+        level++;
+    }
+
+    const Level& state = m_levels[level];
+    View view;
+    view.ring = state.buckets.data();
+    view.bucketSeconds = GetBucketSeconds(level);
+    view.window = std::clamp<size_t>(static_cast<size_t>(std::ceil(spanSeconds / view.bucketSeconds)), 1, BUCKETS_PER_LEVEL);
+    if (m_samples > 0) {
+        view.count = static_cast<size_t>(std::min<uint64_t>(view.window, state.current - state.oldest + 1));
+        view.first = state.current + 1 - view.count;
+    }
+    return view;
+}
@@ -0,0 +1,69 @@
+// GameOverlay - MetricSeries.h
+// Multi-resolution min/max history of one metric, shared by every graph that shows it
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// Samples are folded into fixed-length time buckets at LEVEL_COUNT resolutions at once: level 0
+// buckets are BASE_BUCKET_SECONDS long and each level's are LEVEL_RATIO times longer, so the
+// coarsest level covers over two hours. Each level is a ring of BUCKETS_PER_LEVEL buckets keeping
+// min, max, sum and count, so adding a sample is O(LEVEL_COUNT) and memory is fixed.
+//
+// A graph asks for a span and its width in pixels and gets a view of the finest level with no
+// more buckets than pixels, straight out of the ring: between width / LEVEL_RATIO and width
+// buckets to draw whether the span is a second or an hour. Main thread only.
+class MetricSeries {
+public:
+    static constexpr size_t LEVEL_COUNT = 6;
+    static constexpr size_t BUCKETS_PER_LEVEL = 512;
+    static constexpr size_t LEVEL_RATIO = 4;
+    static constexpr double BASE_BUCKET_SECONDS = 1.0 / 64.0;
+
+    struct Bucket {
+        float min = 0.0f;
+        float max = 0.0f;
+        float sum = 0.0f;
+        uint32_t count = 0; // 0: nothing was sampled in this bucket
+        float GetMean() const { return count ? sum / count : 0.0f; }
+    };
+
+    // The last buckets of one level, oldest first, ending with the one being filled
+    struct View {
+        const Bucket* ring = nullptr;
+        uint64_t first = 0;       // Bucket number of view[0]
+        size_t count = 0;         // Buckets with history, at most window
+        size_t window = 0;        // Buckets the requested span covers
+        double bucketSeconds = 0.0;
+        const Bucket& operator[](size_t i) const { return ring[(first + i) % BUCKETS_PER_LEVEL]; }
+    };
+
+    MetricSeries() = default;
+
+    // Times are seconds on one monotonic clock; a time before the last one counts as the last
+    void Add(double time, float value);
+    void Clear();
+
+    bool IsEmpty() const { return m_samples == 0; }
+    float GetLast() const { return m_last; }
+
+    // Finest level with at most maxBuckets buckets over the span (clamped to GetMaxSpanSeconds)
+    View GetView(double spanSeconds, size_t maxBuckets) const;
+
+    static double GetBucketSeconds(size_t level);
+    static double GetMaxSpanSeconds() { return GetBucketSeconds(LEVEL_COUNT - 1) * BUCKETS_PER_LEVEL; }
+
+private:
+    struct Level {
+        std::array<Bucket, BUCKETS_PER_LEVEL> buckets = {};
+        uint64_t current = 0; // Bucket number being filled
+        uint64_t oldest = 0;  // First bucket number since the first sample
+    };
+
+    std::array<Level, LEVEL_COUNT> m_levels = {};
+    uint64_t m_samples = 0;
+    double m_lastTime = 0.0;
+    float m_last = 0.0f;
+};
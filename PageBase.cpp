@@ -3,7 +3,9 @@
 // Base class for UI pages
 
 #include "PageBase.h"
+#include "MetricSeries.h"
 #include "imgui.h"
+#include <algorithm>
 
 void PageBase::RenderSectionHeader(const char* label) {
     ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]); // Assuming font 1 is a slightly larger font
@@ -38,3 +40,56 @@ void PageBase::RenderErrorText(const char* text) {
     ImGui::PopStyleColor();
     ImGui::Spacing();
 }
+
+void PageBase::RenderMetricGraph(const char* id, const MetricSeries& series, double spanSeconds,
+                                 float scaleMin, float scaleMax, float height) {
+    const ImVec2 size(std::max(ImGui::GetContentRegionAvail().x, 1.0f), height);
+    const ImVec2 min = ImGui::GetCursorScreenPos();
+    const ImVec2 max(min.x + size.x, min.y + size.y);
+    ImGui::PushID(id);
+    ImGui::Dummy(size);
+    ImGui::PopID();
+    if (!ImGui::IsItemVisible()) return;
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(min, max, ImGui::GetColorU32(ImGuiCol_FrameBg), ImGui::GetStyle().FrameRounding);
+
+    const MetricSeries::View view = series.GetView(spanSeconds, static_cast<size_t>(size.x));
+    if (view.count == 0) return;
+    const float columnWidth = size.x / static_cast<float>(view.window);
+    const float range = scaleMax > scaleMin ? scaleMax - scaleMin : 1.0f;
+    auto toY = [&](float value) {
+        return max.y - std::clamp((value - scaleMin) / range, 0.0f, 1.0f) * size.y;
+    };
+
+    // The newest bucket is at the right edge; empty buckets are bridged by the mean line
+    const ImU32 envelopeColor = ImGui::GetColorU32(ImGuiCol_PlotLines, 0.35f);
+    const ImU32 lineColor = ImGui::GetColorU32(ImGuiCol_PlotLines);
+    drawList->PushClipRect(min, max, true);
+    bool havePrevious = false;
+    ImVec2 previous;
+    for (size_t i = 0; i < view.count; i++) {
+        const MetricSeries::Bucket& bucket = view[i];
+        if (bucket.count == 0) continue;
+        const float x0 = max.x - static_cast<float>(view.count - i) * columnWidth;
+        drawList->AddRectFilled(ImVec2(x0, toY(bucket.max)), ImVec2(std::max(x0 + columnWidth, x0 + 1.0f), toY(bucket.min) + 1.0f),
+            envelopeColor);
+        const ImVec2 point(x0 + columnWidth * 0.5f, toY(bucket.GetMean()));
+        if (havePrevious) drawList->AddLine(previous, point, lineColor);
+        previous = point;
+        havePrevious = true;
+    }
+    drawList->PopClipRect();
+
+    if (ImGui::IsItemHovered()) {
+        const float fromRight = (max.x - ImGui::GetIO().MousePos.x) / columnWidth;
+        const size_t back = static_cast<size_t>(std::max(fromRight, 0.0f));
+        if (back < view.count) {
+            const MetricSeries::Bucket& bucket = view[view.count - 1 - back];
+            if (bucket.count > 0) {
+                ImGui::SetTooltip("%.1f s ago\nmin %.2f | mean %.2f | max %.2f",
+                    static_cast<double>(back) * view.bucketSeconds, bucket.min, bucket.GetMean(), bucket.max);
+            }
+        }
+    }
+}
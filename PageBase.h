@@ -6,6 +6,8 @@
 
 #include <string>
 
+class MetricSeries;
+
 // Base class for all UI pages
 class PageBase {
 public:
@@ -15,6 +17,16 @@ public:
     // Render page content
     virtual void Render() = 0;
 
+    // Called when the page's tab becomes the selected one, and when another tab (or nothing) is
+    // shown instead. Pages are only rendered while visible; OnHidden is where they drop what they
+    // can rebuild (graph histories, search results) so hidden pages cost neither time nor memory.
+    virtual void OnVisible() {}
+    virtual void OnHidden() {}
+
+    // How often the page's content must be laid out again without input, in Hz (0: every frame).
+    // In between, UISystem replays the last draw output (see WidgetCache).
+    virtual float GetRefreshRate() const { return 0.0f; }
+
     // Get page name
     const std::string& GetName() const { return m_name; }
 
@@ -27,4 +39,8 @@ protected:
     void RenderInfoText(const char* text);
     void RenderWarningText(const char* text);
     void RenderErrorText(const char* text);
+    // Last spanSeconds of a series at the full content width: min/max envelope and mean line,
+    // one bucket per column at most; hovering shows the bucket. GetItemRect* give the graph.
+    void RenderMetricGraph(const char* id, const MetricSeries& series, double spanSeconds,
+                           float scaleMin, float scaleMax, float height);
 };
\ No newline at end of file
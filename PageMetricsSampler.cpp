@@ -0,0 +1,113 @@
+// GameOverlay - PageMetricsSampler.cpp
+// Renderer-side page metrics through the DevTools protocol (Performance.getMetrics)
+
+#include "PageMetricsSampler.h"
+#include "cef_parser.h"
+#include <algorithm>
+
+namespace {
+    // Weight of the newest sample in the smoothed busy percentage
+    constexpr float BUSY_SMOOTHING = 0.3f;
+
+    float SharePercent(double busySeconds, double wallSeconds) {
+        if (wallSeconds <= 0.0) return 0.0f;
+        return static_cast<float>(std::clamp(busySeconds / wallSeconds * 100.0, 0.0, 100.0));
+    }
+}
+
+void PageMetricsSampler::Poll(CefRefPtr<CefBrowser> browser, int tabId, bool active) {
+    CefRefPtr<CefBrowserHost> host = browser ? browser->GetHost() : nullptr;
+    if (!host) return;
+
+    BrowserState& state = m_browsers[browser->GetIdentifier()];
+    state.metrics.tabId = tabId;
+    state.metrics.active = active;
+    if (!state.registration) {
+        state.registration = host->AddDevToolsMessageObserver(this);
+        host->ExecuteDevToolsMethod(0, "Performance.enable", nullptr);
+    }
+    // A page too busy to answer isn't asked again until it does
+    if (state.pendingMessageId != 0) return;
+    state.pendingMessageId = host->ExecuteDevToolsMethod(0, "Performance.getMetrics", nullptr);
+}
+
+void PageMetricsSampler::Forget(CefRefPtr<CefBrowser> browser) {
+    if (!browser || m_browsers.erase(browser->GetIdentifier()) == 0) return;
+    Publish();
+}
+
+void PageMetricsSampler::Clear() {
+    m_browsers.clear();
+    Publish();
+}
+
+void PageMetricsSampler::OnDevToolsMethodResult(CefRefPtr<CefBrowser> browser, int message_id, bool success,
+    const void* result, size_t result_size) {
+    auto it = m_browsers.find(browser->GetIdentifier());
+    if (it == m_browsers.end() || it->second.pendingMessageId != message_id) return; // Someone else's call
+    BrowserState& state = it->second;
+    state.pendingMessageId = 0;
+    if (!success) return;
+
+    CefRefPtr<CefValue> value = CefParseJSON(result, result_size, JSON_PARSER_RFC);
+    CefRefPtr<CefDictionaryValue> dictionary = value ? value->GetDictionary() : nullptr;
+    CefRefPtr<CefListValue> list = dictionary ? dictionary->GetList("metrics") : nullptr;
+    if (!list) return;
+
+    // [{ "name": "JSHeapUsedSize", "value": 1234 }, ...]; durations are in seconds
+    double timestamp = 0.0, taskSeconds = 0.0, scriptSeconds = 0.0, layoutSeconds = 0.0, recalcStyleSeconds = 0.0;
+    PageMetrics& metrics = state.metrics;
+    for (size_t i = 0; i < list->GetSize(); i++) {
+        CefRefPtr<CefDictionaryValue> entry = list->GetDictionary(i);
+        if (!entry) continue;
+        const std::string name = entry->GetString("name").ToString();
+        const double number = entry->GetDouble("value");
+        if (name == "Timestamp") timestamp = number;
+        else if (name == "TaskDuration") taskSeconds = number;
+        else if (name == "ScriptDuration") scriptSeconds = number;
+        else if (name == "LayoutDuration") layoutSeconds = number;
+        else if (name == "RecalcStyleDuration") recalcStyleSeconds = number;
+        else if (name == "LayoutCount") metrics.layoutCount = static_cast<UINT64>(number);
+        else if (name == "RecalcStyleCount") metrics.recalcStyleCount = static_cast<UINT64>(number);
+        else if (name == "Nodes") metrics.nodes = static_cast<UINT>(number);
+        else if (name == "Documents") metrics.documents = static_cast<UINT>(number);
+        else if (name == "JSEventListeners") metrics.jsEventListeners = static_cast<UINT>(number);
+        else if (name == "JSHeapUsedSize") metrics.jsHeapUsedMB = number / (1024.0 * 1024.0);
+        else if (name == "JSHeapTotalSize") metrics.jsHeapTotalMB = number / (1024.0 * 1024.0);
+    }
+    metrics.taskMs = taskSeconds * 1000.0;
+    metrics.scriptMs = scriptSeconds * 1000.0;
+    metrics.layoutMs = layoutSeconds * 1000.0;
+    metrics.recalcStyleMs = recalcStyleSeconds * 1000.0;
+
+    // A navigation restarts the totals; that interval is skipped
+    const double layoutTotal = layoutSeconds + recalcStyleSeconds;
+    if (state.hasPrevious && timestamp > state.previousTimestamp && taskSeconds >= state.previousTaskSeconds) {
+        const double wallSeconds = timestamp - state.previousTimestamp;
+        metrics.mainThreadPercent = SharePercent(taskSeconds - state.previousTaskSeconds, wallSeconds);
+        metrics.scriptPercent = SharePercent(scriptSeconds - state.previousScriptSeconds, wallSeconds);
+        metrics.layoutPercent = SharePercent(layoutTotal - state.previousLayoutSeconds, wallSeconds);
+        metrics.averageMainThreadPercent += (metrics.mainThreadPercent - metrics.averageMainThreadPercent) * BUSY_SMOOTHING;
+    }
+    state.hasPrevious = true;
+    state.previousTimestamp = timestamp;
+    state.previousTaskSeconds = taskSeconds;
+    state.previousScriptSeconds = scriptSeconds;
+    state.previousLayoutSeconds = layoutTotal;
+
+    CefRefPtr<CefFrame> frame = browser->GetMainFrame();
+    metrics.url = frame ? frame->GetURL().ToString() : std::string();
+    metrics.sampleTime = std::chrono::steady_clock::now();
+    Publish();
+}
+
+void PageMetricsSampler::Publish() {
+    auto published = std::make_shared<std::vector<PageMetrics>>();
+    published->reserve(m_browsers.size());
+    for (const auto& entry : m_browsers) {
+        if (entry.second.hasPrevious) published->push_back(entry.second.metrics);
+    }
+    std::sort(published->begin(), published->end(),
+        [](const PageMetrics& a, const PageMetrics& b) { return a.tabId < b.tabId; });
+    std::atomic_store(&m_published, std::shared_ptr<const std::vector<PageMetrics>>(std::move(published)));
+}
@@ -0,0 +1,62 @@
+// GameOverlay - PageMetricsSampler.h
+// Renderer-side page metrics through the DevTools protocol (Performance.getMetrics)
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "cef_browser.h"
+#include "cef_devtools_message_observer.h"
+#include "cef_registration.h"
+#include "PerformanceMonitor.h" // PageMetrics
+
+// Asks each live browser for Performance.getMetrics when BrowserManager polls (a couple of
+// seconds apart), through an observer registered on the browser's DevTools agent; no DevTools
+// window is opened. Busy percentages come from the difference between two results.
+//
+// Poll, Forget and the results run on CEF's UI thread. The published metrics are an immutable
+// snapshot, replaced whole after each result, like BrowserHandler's page state.
+class PageMetricsSampler : public CefDevToolsMessageObserver {
+public:
+    PageMetricsSampler() = default;
+
+    // Disable copy and move
+    PageMetricsSampler(const PageMetricsSampler&) = delete;
+    PageMetricsSampler& operator=(const PageMetricsSampler&) = delete;
+    PageMetricsSampler(PageMetricsSampler&&) = delete;
+    PageMetricsSampler& operator=(PageMetricsSampler&&) = delete;
+
+    // UI thread
+    void Poll(CefRefPtr<CefBrowser> browser, int tabId, bool active);
+    void Forget(CefRefPtr<CefBrowser> browser); // Closed or discarded; its metrics go too
+    void Clear();                                // Before CefShutdown
+
+    // Any thread; never null
+    std::shared_ptr<const std::vector<PageMetrics>> GetMetrics() const { return std::atomic_load(&m_published); }
+
+    // CefDevToolsMessageObserver
+    void OnDevToolsMethodResult(CefRefPtr<CefBrowser> browser, int message_id, bool success,
+        const void* result, size_t result_size) override;
+
+private:
+    struct BrowserState {
+        CefRefPtr<CefRegistration> registration;
+        int pendingMessageId = 0; // The getMetrics call waiting for its result
+        bool hasPrevious = false;
+        double previousTimestamp = 0.0; // Seconds, the page's monotonic clock
+        double previousTaskSeconds = 0.0;
+        double previousScriptSeconds = 0.0;
+        double previousLayoutSeconds = 0.0;
+        PageMetrics metrics;
+    };
+
+    void Publish();
+
+    std::unordered_map<int, BrowserState> m_browsers; // By browser identifier
+    std::shared_ptr<const std::vector<PageMetrics>> m_published = std::make_shared<const std::vector<PageMetrics>>();
+
+    IMPLEMENT_REFCOUNTING(PageMetricsSampler);
+};
@@ -0,0 +1,343 @@
+// GameOverlay - PaintTrace.cpp
+// Recording of CEF software paints to a file, and replay into BrowserView without CEF
+
+#include "PaintTrace.h"
+#include "BrowserView.h"
+#include "FileUtil.h"
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+// Control byte c < 128: c + 1 literal pixels follow. c >= 128: the next pixel repeats c - 126 times.
+constexpr size_t MAX_LITERAL_RUN = 128;
+constexpr size_t MAX_REPEAT_RUN = 129;
+
+void PackPixels(const uint32_t* pixels, size_t count, std::vector<uint8_t>& out) {
+    out.clear();
+    out.reserve(count); // Typical page content packs well below a byte per pixel
+    size_t i = 0;
+    while (i < count) {
+        size_t run = 1;
+        while (i + run < count && run < MAX_REPEAT_RUN && pixels[i + run] == pixels[i]) run++;
+        if (run >= 2) {
+            out.push_back(static_cast<uint8_t>(run + 126));
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&pixels[i]);
+            out.insert(out.end(), bytes, bytes + 4);
+            i += run;
+            continue;
+        }
+
+        // Literals up to the next repeat
+        size_t end = i + 1;
+        while (end < count && end - i < MAX_LITERAL_RUN && !(end + 1 < count && pixels[end] == pixels[end + 1])) end++;
+        out.push_back(static_cast<uint8_t>(end - i - 1));
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&pixels[i]);
+        out.insert(out.end(), bytes, bytes + (end - i) * 4);
+        i = end;
+    }
+}
+
+bool UnpackPixels(const uint8_t* packed, size_t packedBytes, uint32_t* pixels, size_t count) {
+    size_t in = 0;
+    size_t out = 0;
+    while (in < packedBytes && out < count) {
+        uint8_t control = packed[in++];
+        if (control < 128) {
+            size_t run = static_cast<size_t>(control) + 1;
+            if (out + run > count || in + run * 4 > packedBytes) return false;
+            memcpy(&pixels[out], &packed[in], run * 4);
+            in += run * 4;
+            out += run;
+        }
+        else {
+            size_t run = static_cast<size_t>(control) - 126;
+            if (out + run > count || in + 4 > packedBytes) return false;
+            uint32_t pixel;
+            memcpy(&pixel, &packed[in], 4);
+            in += 4;
+            std::fill(pixels + out, pixels + out + run, pixel);
+            out += run;
+        }
+    }
+    return out == count;
+}
+
+} // namespace
+
+// --- PaintTraceRecorder ---
+
+PaintTraceRecorder::PaintTraceRecorder() = default;
+
+PaintTraceRecorder::~PaintTraceRecorder() {
+    Stop();
+}
+
+bool PaintTraceRecorder::Start(const std::string& path) {
+    if (m_recording || path.empty()) return false;
+    if (fopen_s(&m_file, path.c_str(), "wb") != 0 || !m_file) {
+        OutputDebugStringA(("Warning: Failed to create paint recording: " + path + "\n").c_str());
+        m_file = nullptr;
+        return false;
+    }
+    PaintTraceHeader header;
+    fwrite(&header, sizeof(header), 1, m_file);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.clear();
+        m_queuedBytes = 0;
+        m_stopping = false;
+        m_writeQueued = false;
+    }
+    m_startTime = std::chrono::steady_clock::now();
+    m_recordFullFrame = true; // The replay canvas starts out empty
+    m_recordedPaints = 0;
+    m_droppedPaints = 0;
+    m_recording = true;
+    return true;
+}
+
+void PaintTraceRecorder::Stop() {
+    if (!m_recording.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_writeJobs.Wait(); // The job drains what is queued before it finishes
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+void PaintTraceRecorder::RecordPaint(const void* buffer, int width, int height, const std::vector<RECT>& dirtyRects) {
+    if (!IsRecording() || !buffer || width <= 0 || height <= 0) return;
+
+    auto paint = std::make_unique<PendingPaint>();
+    RECT bounds = { 0, 0, width, height };
+    if (m_recordFullFrame.exchange(false)) {
+        paint->rects.push_back(bounds);
+    }
+    else {
+        for (const RECT& rect : dirtyRects) {
+            RECT clipped;
+            if (IntersectRect(&clipped, &rect, &bounds)) paint->rects.push_back(clipped);
+        }
+    }
+
+    size_t pixelBytes = 0;
+    for (const RECT& rect : paint->rects) {
+        pixelBytes += static_cast<size_t>(rect.right - rect.left) * (rect.bottom - rect.top) * 4;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping || m_queuedBytes + pixelBytes > MAX_QUEUED_BYTES) {
+            m_droppedPaints++;
+            m_recordFullFrame = true;
+            return;
+        }
+        m_queuedBytes += pixelBytes; // Reserved before the copy so the limit holds
+    }
+
+    paint->pixels.resize(pixelBytes);
+    uint8_t* out = paint->pixels.data();
+    const size_t srcRowPitch = static_cast<size_t>(width) * 4;
+    for (const RECT& rect : paint->rects) {
+        const size_t rowBytes = static_cast<size_t>(rect.right - rect.left) * 4;
+        const uint8_t* src = static_cast<const uint8_t*>(buffer) + rect.top * srcRowPitch + rect.left * 4;
+        for (LONG y = rect.top; y < rect.bottom; y++) {
+            memcpy(out, src, rowBytes);
+            out += rowBytes;
+            src += srcRowPitch;
+        }
+    }
+
+    paint->header.timestampUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - m_startTime).count();
+    paint->header.width = width;
+    paint->header.height = height;
+    paint->header.rectCount = static_cast<uint32_t>(paint->rects.size());
+    paint->header.pixelBytes = static_cast<uint32_t>(pixelBytes);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopping) { // Stop ran during the copy; its write job may be done already
+        m_queuedBytes -= pixelBytes;
+        m_droppedPaints++;
+        return;
+    }
+    m_pending.push_back(std::move(paint));
+    if (!m_writeQueued) SubmitWrite();
+}
+
+void PaintTraceRecorder::SubmitWrite() {
+    // One job at a time keeps the records in order; it runs until the queue is empty
+    m_writeQueued = true;
+    JobDesc job;
+    job.name = "Write Paint Trace";
+    job.priority = JobPriority::Low;
+    job.jobClass = JobClass::Efficiency;
+    job.counter = &m_writeJobs;
+    JobSystem::Get().Submit(job, [this]() { WritePending(); });
+}
+
+void PaintTraceRecorder::WritePending() {
+    while (true) {
+        std::unique_ptr<PendingPaint> paint;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_pending.empty()) {
+                m_writeQueued = false;
+                return;
+            }
+            paint = std::move(m_pending.front());
+            m_pending.pop_front();
+        }
+
+        WritePaint(*paint);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queuedBytes -= paint->pixels.size();
+    }
+}
+
+void PaintTraceRecorder::WritePaint(const PendingPaint& paint) {
+    PackPixels(reinterpret_cast<const uint32_t*>(paint.pixels.data()), paint.pixels.size() / 4, m_packed);
+
+    PaintTraceRecordHeader header = paint.header;
+    header.packedBytes = static_cast<uint32_t>(m_packed.size());
+    fwrite(&header, sizeof(header), 1, m_file);
+    for (const RECT& rect : paint.rects) {
+        int32_t coords[4] = { rect.left, rect.top, rect.right, rect.bottom };
+        fwrite(coords, sizeof(coords), 1, m_file);
+    }
+    fwrite(m_packed.data(), 1, m_packed.size(), m_file);
+    m_recordedPaints++;
+}
+
+std::string PaintTraceRecorder::MakeRecordingPath() {
+    std::string directory = GetAppDataDirectory();
+    if (directory.empty()) {
+        return std::string();
+    }
+    directory += "\\Paints";
+    CreateDirectoryA(directory.c_str(), nullptr);
+
+    SYSTEMTIME time;
+    GetLocalTime(&time);
+    char name[64];
+    snprintf(name, sizeof(name), "\\paints-%04u%02u%02u-%02u%02u%02u.gopt", time.wYear, time.wMonth, time.wDay,
+        time.wHour, time.wMinute, time.wSecond);
+    return directory + name;
+}
+
+// --- PaintTraceReplay ---
+
+bool PaintTraceReplay::Open(const std::string& path) {
+    FILE* file = nullptr;
+    if (fopen_s(&file, path.c_str(), "rb") != 0 || !file) {
+        OutputDebugStringA(("Warning: Failed to open paint recording: " + path + "\n").c_str());
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    m_data.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    size_t read = m_data.empty() ? 0 : fread(m_data.data(), 1, m_data.size(), file);
+    fclose(file);
+
+    PaintTraceHeader header;
+    if (read != m_data.size() || m_data.size() < sizeof(header)) return false;
+    memcpy(&header, m_data.data(), sizeof(header));
+    if (header.magic != PaintTraceHeader::MAGIC || header.version != PaintTraceHeader::VERSION) {
+        OutputDebugStringA("Warning: Not a paint recording, or from another version.\n");
+        return false;
+    }
+
+    // Index the records; a recording cut short (crash, full disk) keeps its complete paints
+    m_records.clear();
+    size_t offset = sizeof(header);
+    while (offset + sizeof(PaintTraceRecordHeader) <= m_data.size()) {
+        Record record;
+        memcpy(&record.header, &m_data[offset], sizeof(record.header));
+        record.rectOffset = offset + sizeof(record.header);
+        record.packedOffset = record.rectOffset + static_cast<size_t>(record.header.rectCount) * 16;
+        size_t end = record.packedOffset + record.header.packedBytes;
+        if (end > m_data.size() || record.header.width <= 0 || record.header.height <= 0) break;
+        m_records.push_back(record);
+        offset = end;
+    }
+    m_nextRecord = 0;
+    m_started = false;
+    return !m_records.empty();
+}
+
+void PaintTraceReplay::Update(BrowserView& view) {
+    if (m_records.empty()) return;
+    auto now = std::chrono::steady_clock::now();
+    if (!m_started || m_nextRecord >= m_records.size()) {
+        m_loopStart = now;
+        m_nextRecord = 0;
+        m_started = true;
+    }
+
+    const int64_t elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(now - m_loopStart).count();
+    while (m_nextRecord < m_records.size() && m_records[m_nextRecord].header.timestampUs <= elapsedUs) {
+        const Record& record = m_records[m_nextRecord++];
+        if (!UnpackInto(record)) continue;
+        LARGE_INTEGER paintTime;
+        QueryPerformanceCounter(&paintTime);
+        view.SignalTextureUpdateFromHandler(m_canvas.data(), m_canvasWidth, m_canvasHeight, m_rects, paintTime.QuadPart);
+    }
+}
+
+DWORD PaintTraceReplay::GetNextPaintTimeoutMs() const {
+    if (m_records.empty()) return INFINITE;
+    if (!m_started || m_nextRecord >= m_records.size()) return 0;
+    const int64_t elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - m_loopStart).count();
+    int64_t remainingUs = m_records[m_nextRecord].header.timestampUs - elapsedUs;
+    return remainingUs > 0 ? static_cast<DWORD>(remainingUs / 1000) : 0;
+}
+
+bool PaintTraceReplay::UnpackInto(const Record& record) {
+    const PaintTraceRecordHeader& header = record.header;
+    if (header.width != m_canvasWidth || header.height != m_canvasHeight) {
+        m_canvasWidth = header.width;
+        m_canvasHeight = header.height;
+        m_canvas.assign(static_cast<size_t>(m_canvasWidth) * m_canvasHeight * 4, 0);
+    }
+
+    m_rects.clear();
+    size_t pixelBytes = 0;
+    RECT bounds = { 0, 0, m_canvasWidth, m_canvasHeight };
+    for (uint32_t i = 0; i < header.rectCount; i++) {
+        int32_t coords[4];
+        memcpy(coords, &m_data[record.rectOffset + i * sizeof(coords)], sizeof(coords));
+        RECT rect = { coords[0], coords[1], coords[2], coords[3] };
+        RECT clipped;
+        if (!IntersectRect(&clipped, &rect, &bounds) || !EqualRect(&clipped, &rect)) return false;
+        m_rects.push_back(rect);
+        pixelBytes += static_cast<size_t>(rect.right - rect.left) * (rect.bottom - rect.top) * 4;
+    }
+    if (pixelBytes != header.pixelBytes) return false;
+
+    m_unpacked.resize(pixelBytes);
+    if (!UnpackPixels(&m_data[record.packedOffset], header.packedBytes,
+            reinterpret_cast<uint32_t*>(m_unpacked.data()), pixelBytes / 4)) {
+        return false;
+    }
+
+    const uint8_t* src = m_unpacked.data();
+    const size_t dstRowPitch = static_cast<size_t>(m_canvasWidth) * 4;
+    for (const RECT& rect : m_rects) {
+        const size_t rowBytes = static_cast<size_t>(rect.right - rect.left) * 4;
+        uint8_t* dst = m_canvas.data() + rect.top * dstRowPitch + rect.left * 4;
+        for (LONG y = rect.top; y < rect.bottom; y++) {
+            memcpy(dst, src, rowBytes);
+            src += rowBytes;
+            dst += dstRowPitch;
+        }
+    }
+    return true;
+}
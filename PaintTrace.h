@@ -0,0 +1,137 @@
+// GameOverlay - PaintTrace.h
+// Recording of CEF software paints to a file, and replay into BrowserView without CEF
+
+#pragma once
+
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include "JobSystem.h"
+
+class BrowserView;
+
+// File layout: PaintTraceHeader, then one PaintTraceRecordHeader per paint followed by its rects
+// (left, top, right, bottom as int32) and the packed pixels. Unpacked, the pixels are each rect's
+// BGRA rows in turn, tightly packed. Packing is a run-length code over whole pixels (flat page
+// backgrounds and text on solid color shrink well; photos and video do not).
+struct PaintTraceHeader {
+    static constexpr uint32_t MAGIC = 0x54504F47; // "GOPT"
+    static constexpr uint32_t VERSION = 1;
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+};
+
+struct PaintTraceRecordHeader {
+    int64_t timestampUs = 0; // Since the recording started
+    int32_t width = 0;
+    int32_t height = 0;
+    uint32_t rectCount = 0;
+    uint32_t pixelBytes = 0; // Unpacked
+    uint32_t packedBytes = 0;
+};
+
+// RecordPaint runs on CEF's UI thread during OnPaint: it only copies the dirty rects out, and a
+// background job packs and writes them. When the writer falls behind, paints are dropped and the next one
+// is recorded as a full frame, so a replay never shows regions that were never painted.
+class PaintTraceRecorder {
+public:
+    static constexpr size_t MAX_QUEUED_BYTES = 128 * 1024 * 1024;
+
+    PaintTraceRecorder();
+    ~PaintTraceRecorder();
+
+    // Disable copy and move
+    PaintTraceRecorder(const PaintTraceRecorder&) = delete;
+    PaintTraceRecorder& operator=(const PaintTraceRecorder&) = delete;
+    PaintTraceRecorder(PaintTraceRecorder&&) = delete;
+    PaintTraceRecorder& operator=(PaintTraceRecorder&&) = delete;
+
+    bool Start(const std::string& path);
+    void Stop(); // Writes out what is queued, then closes the file
+    bool IsRecording() const { return m_recording.load(std::memory_order_relaxed); }
+
+    void RecordPaint(const void* buffer, int width, int height, const std::vector<RECT>& dirtyRects);
+
+    uint64_t GetRecordedPaints() const { return m_recordedPaints.load(std::memory_order_relaxed); }
+    uint64_t GetDroppedPaints() const { return m_droppedPaints.load(std::memory_order_relaxed); }
+
+    // Recordings go to %LOCALAPPDATA%\GameOverlay\Paints; empty without a profile directory
+    static std::string MakeRecordingPath();
+
+private:
+    struct PendingPaint {
+        PaintTraceRecordHeader header;
+        std::vector<RECT> rects;
+        std::vector<uint8_t> pixels;
+    };
+
+    void SubmitWrite(); // m_mutex held
+    void WritePending();
+    void WritePaint(const PendingPaint& paint);
+
+    FILE* m_file = nullptr; // Write job only while recording
+    std::chrono::steady_clock::time_point m_startTime;
+    std::atomic<bool> m_recording = false;
+    std::atomic<bool> m_recordFullFrame = true;
+    std::atomic<uint64_t> m_recordedPaints = 0;
+    std::atomic<uint64_t> m_droppedPaints = 0;
+
+    std::mutex m_mutex;
+    std::deque<std::unique_ptr<PendingPaint>> m_pending;
+    size_t m_queuedBytes = 0;
+    bool m_stopping = false;
+    bool m_writeQueued = false; // A write job is draining m_pending
+    std::vector<uint8_t> m_packed; // The write job's
+    JobCounter m_writeJobs;
+};
+
+// Loads a whole recording and feeds its paints to BrowserView::SignalTextureUpdateFromHandler on
+// the recorded schedule, from a canvas kept like CEF's view buffer. Loops at the end. Paints are
+// replayed at their recorded size; the overlay should be the size it was when recording.
+class PaintTraceReplay {
+public:
+    PaintTraceReplay() = default;
+    ~PaintTraceReplay() = default;
+
+    // Disable copy and move
+    PaintTraceReplay(const PaintTraceReplay&) = delete;
+    PaintTraceReplay& operator=(const PaintTraceReplay&) = delete;
+    PaintTraceReplay(PaintTraceReplay&&) = delete;
+    PaintTraceReplay& operator=(PaintTraceReplay&&) = delete;
+
+    bool Open(const std::string& path);
+    size_t GetPaintCount() const { return m_records.size(); }
+
+    // Delivers every paint that is due
+    void Update(BrowserView& view);
+    // Until the next paint is due (for the main loop's wait)
+    DWORD GetNextPaintTimeoutMs() const;
+
+private:
+    struct Record {
+        PaintTraceRecordHeader header;
+        size_t rectOffset = 0;   // Into m_data
+        size_t packedOffset = 0;
+    };
+
+    bool UnpackInto(const Record& record);
+
+    std::vector<uint8_t> m_data;
+    std::vector<Record> m_records;
+    size_t m_nextRecord = 0;
+    std::chrono::steady_clock::time_point m_loopStart;
+    bool m_started = false;
+
+    std::vector<uint8_t> m_canvas;
+    int m_canvasWidth = 0;
+    int m_canvasHeight = 0;
+    std::vector<uint8_t> m_unpacked;
+    std::vector<RECT> m_rects;
+};
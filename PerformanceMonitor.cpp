@@ -6,6 +6,83 @@
 #include <psapi.h>
 #include <algorithm>
 #include <numeric>
+#include <fstream>
+#include <cstdio>
+#include <cctype>
+
+const char* GetGpuPassName(GpuPass pass) {
+    switch (pass) {
+    case GpuPass::Clear: return "Clear";
+    case GpuPass::BrowserCopy: return "Browser Copy";
+    case GpuPass::ImGui: return "ImGui";
+    case GpuPass::Upscale: return "Upscale";
+    default: return "Unknown";
+    }
+}
+
+const char* GetPresentationModeName(PresentationMode mode) {
+    switch (mode) {
+    case PresentationMode::Composed: return "Composed";
+    case PresentationMode::Overlay: return "Hardware Overlay";
+    case PresentationMode::IndependentFlip: return "Independent Flip";
+    case PresentationMode::CompositionFailure: return "Composition Failure";
+    default: return "Unknown";
+    }
+}
+
+const char* GetBrowserGpuPolicyName(BrowserGpuPolicy policy) {
+    switch (policy) {
+    case BrowserGpuPolicy::Full: return "GPU Raster + Compositing";
+    case BrowserGpuPolicy::SoftwareRaster: return "GPU Compositing, Software Raster";
+    case BrowserGpuPolicy::Software: return "Software";
+    default: return "Unknown";
+    }
+}
+
+const char* GetBrowserUploadPathName(BrowserUploadPath path) {
+    switch (path) {
+    case BrowserUploadPath::SharedTexture: return "Shared Texture";
+    case BrowserUploadPath::UploadRing: return "Upload Ring";
+    case BrowserUploadPath::GpuUploadBuffer: return "GPU Upload Heap (Conversion Input)";
+    case BrowserUploadPath::GpuUploadTexture: return "GPU Upload Heap (Direct)";
+    default: return "Unknown";
+    }
+}
+
+const float DomainLoadStats::BUCKET_LIMITS_MS[DomainLoadStats::BUCKET_COUNT - 1] = { 500.0f, 1000.0f, 2000.0f, 4000.0f, 8000.0f };
+
+namespace {
+    // "https://user@www.Example.com:8080/path" -> "example.com"; empty without a host
+    std::string GetUrlDomain(const std::string& url) {
+        size_t begin = url.find("://");
+        if (begin == std::string::npos) return std::string();
+        begin += 3;
+        size_t end = url.find_first_of("/?#", begin);
+        if (end == std::string::npos) end = url.size();
+        size_t at = url.rfind('@', end);
+        if (at != std::string::npos && at >= begin) begin = at + 1;
+        size_t port = url.find(':', begin);
+        if (port != std::string::npos && port < end) end = port;
+
+        std::string domain = url.substr(begin, end - begin);
+        for (char& c : domain) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        if (domain.compare(0, 4, "www.") == 0) domain.erase(0, 4);
+        return domain;
+    }
+}
+
+const char* GetMetricName(Metric metric) {
+    switch (metric) {
+    case Metric::FrameTimeMs: return "Frame Time (ms)";
+    case Metric::FramesPerSecond: return "Frame Rate (FPS)";
+    case Metric::CpuPercent: return "CPU Usage (%)";
+    case Metric::GpuPercent: return "GPU Usage (%)";
+    case Metric::MemoryMB: return "Memory Usage (MB)";
+    case Metric::FrameLatencyWaitMs: return "Frame Latency Wait (ms)";
+    case Metric::FrameWorkMs: return "Frame Work Time (ms)";
+    default: return "Unknown";
+    }
+}
 
 PerformanceMonitor::PerformanceMonitor() {
     // Initialize process handle for performance monitoring
@@ -26,11 +103,21 @@ PerformanceMonitor::PerformanceMonitor() {
 
     // Initialize frame time buffer
     std::fill(m_frameTimeBuffer.begin(), m_frameTimeBuffer.end(), 0.0f);
+
+    // Before the browser starts, so the CEF subprocesses inherit the job
+    m_processTree = std::make_unique<ProcessTreeMonitor>();
+    m_processTree->Update();
+    m_lastProcessTreeUpdate = std::chrono::steady_clock::now();
+    m_gpuSampler = std::make_unique<GpuUsageSampler>();
+    m_powerSampler = std::make_unique<PowerSampler>();
+    m_presentSampler = std::make_unique<PresentEventSampler>();
+    m_sharedTelemetry = std::make_unique<SharedTelemetry>();
 }
 
 void PerformanceMonitor::BeginFrame() {
     // Record frame start time
     m_frameStart = std::chrono::high_resolution_clock::now();
+    m_frameWaitMs.fill(0.0f);
 }
 
 void PerformanceMonitor::EndFrame() {
@@ -39,28 +126,242 @@ void PerformanceMonitor::EndFrame() {
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(frameEnd - m_frameStart);
     m_lastFrameTime = duration.count() / 1000000.0f; // Convert to seconds
 
-    // Add to the circular buffer
-    m_frameTimeBuffer[m_frameTimeBufferIndex] = m_lastFrameTime;
-    m_frameTimeBufferIndex = (m_frameTimeBufferIndex + 1) % FRAME_TIME_BUFFER_SIZE;
+    // Add to the circular buffer, keeping the running sum in step
+    float& slot = m_frameTimeBuffer[m_frameTimeBufferIndex];
+    if (slot > 0.0f) {
+        m_frameTimeSum -= slot;
+        m_frameTimeCount--;
+    }
+    slot = m_lastFrameTime;
+    if (slot > 0.0f) {
+        m_frameTimeSum += slot;
+        m_frameTimeCount++;
+    }
+    m_frameTimeHistogram.AddFrame(m_lastFrameTime * 1000.0f);
 
-    // Calculate average FPS over the buffer period
-    float totalFrameTime = std::accumulate(m_frameTimeBuffer.begin(), m_frameTimeBuffer.end(), 0.0f);
-    if (totalFrameTime > 0.0f) {
-        // Count valid (non-zero) frame times
-        int validFrames = std::count_if(m_frameTimeBuffer.begin(), m_frameTimeBuffer.end(),
-            [](float t) { return t > 0.0f; });
+    // Work is the wall time the waits don't account for; a throttled 60 FPS frame is mostly sleep
+    FrameTimeBreakdown& breakdown = m_frameTimeBreakdown;
+    breakdown.wallMs = m_lastFrameTime * 1000.0f;
+    breakdown.throttleMs = m_frameWaitMs[static_cast<size_t>(FrameWait::Throttle)];
+    breakdown.gpuWaitMs = m_frameWaitMs[static_cast<size_t>(FrameWait::GpuWait)];
+    breakdown.presentMs = m_frameWaitMs[static_cast<size_t>(FrameWait::PresentBlock)];
+    breakdown.workMs = std::max(breakdown.wallMs - breakdown.throttleMs - breakdown.gpuWaitMs - breakdown.presentMs, 0.0f);
 
-        if (validFrames > 0) {
-            m_framesPerSecond = static_cast<float>(validFrames) / totalFrameTime;
-        }
+    FrameTimeBreakdown& average = m_averageFrameTimeBreakdown;
+    const float smoothing = m_frameIndex == 0 ? 1.0f : 0.05f;
+    average.wallMs += (breakdown.wallMs - average.wallMs) * smoothing;
+    average.workMs += (breakdown.workMs - average.workMs) * smoothing;
+    average.throttleMs += (breakdown.throttleMs - average.throttleMs) * smoothing;
+    average.gpuWaitMs += (breakdown.gpuWaitMs - average.gpuWaitMs) * smoothing;
+    average.presentMs += (breakdown.presentMs - average.presentMs) * smoothing;
+
+    // Hitches are frames that worked long, not ones that slept long (render on demand, throttling)
+    m_workTimeHistogram.AddFrame(breakdown.workMs);
+    if (m_hitchDetector.CheckFrame(breakdown.workMs, m_workTimeHistogram)) {
+        RecordHitch();
     }
 
     // Update system metrics periodically (every 10 frames)
     static int frameCounter = 0;
     if (++frameCounter >= 10) {
         UpdateSystemMetrics();
+        UpdateGpuMetrics();
+        SampleThreadCycles();
+
+        float memoryMB = GetTotalMemoryUsageMB();
+        AddMetric(Metric::CpuPercent, GetCpuUsagePercent());
+        AddMetric(Metric::GpuPercent, GetGpuUsagePercent());
+        AddMetric(Metric::MemoryMB, memoryMB);
+
+        m_session.cpuSamples++;
+        m_session.cpuSum += m_cpuUsage;
+        m_session.peakMemoryMB = std::max(m_session.peakMemoryMB, memoryMB);
+
+        if (m_browserGpuPolicyKnown) {
+            PolicyCost& cost = m_browserGpuPolicyCosts[static_cast<size_t>(m_browserGpuPolicy)];
+            cost.samples++;
+            cost.cpuSum += m_cpuUsage;
+            cost.gpuMsSum += m_gpuFrameTimeMs;
+        }
+        if (m_gameGpuBound && m_gameSample.valid) {
+            GameFrameCost& cost = m_gpuBoundGameFrameCosts[m_gpuPriorityYielded ? 1 : 0];
+            cost.samples++;
+            cost.frameMsSum += m_gameSample.averageFrameMs;
+        }
+
         frameCounter = 0;
     }
+
+    // Update buffer index
+    m_frameTimeBufferIndex = (m_frameTimeBufferIndex + 1) % FRAME_TIME_BUFFER_SIZE;
+
+    // Average FPS over the buffer period
+    if (m_frameTimeCount > 0 && m_frameTimeSum > 0.0f) {
+        m_framesPerSecond = static_cast<float>(m_frameTimeCount / m_frameTimeSum);
+    }
+    AddMetric(Metric::FrameTimeMs, m_lastFrameTime * 1000.0f);
+    AddMetric(Metric::FramesPerSecond, m_framesPerSecond);
+    AddMetric(Metric::FrameWorkMs, breakdown.workMs);
+
+    m_frameIndex++;
+    PublishTelemetry();
+}
+
+void PerformanceMonitor::RecordHitch() {
+    HitchIncident incident;
+    incident.frameIndex = m_frameIndex;
+    incident.frameMs = m_frameTimeBreakdown.workMs;
+    incident.gpuFrameMs = m_gpuFrameTimeMs;
+    incident.gpuPassMs.assign(m_gpuPassTimesMs.begin(), m_gpuPassTimesMs.end());
+    incident.cpuPercent = GetCpuUsagePercent();
+    incident.memoryMB = GetTotalMemoryUsageMB();
+    m_hitchDetector.AddIncident(std::move(incident));
+}
+
+void PerformanceMonitor::PublishTelemetry() {
+    OverlayTelemetryBlock* block = m_sharedTelemetry ? m_sharedTelemetry->BeginWrite() : nullptr;
+    if (!block) return;
+
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    block->frameIndex = m_frameIndex;
+    block->qpcTimestamp = counter.QuadPart;
+    block->qpcFrequency = frequency.QuadPart;
+
+    FrameTimePercentiles percentiles = m_frameTimeHistogram.GetPercentiles(FrameTimeWindow::TenSeconds);
+    block->frameTimeMs = m_lastFrameTime * 1000.0f;
+    block->framesPerSecond = m_framesPerSecond;
+    block->displayedFramesPerSecond = GetDisplayedFramesPerSecond();
+    block->p50FrameMs = percentiles.p50Ms;
+    block->p95FrameMs = percentiles.p95Ms;
+    block->p99FrameMs = percentiles.p99Ms;
+    block->p999FrameMs = percentiles.p999Ms;
+    block->maxFrameMs = percentiles.maxMs;
+
+    block->gpuFrameMs = m_gpuFrameTimeMs;
+    block->gpuPassCount = static_cast<uint32_t>(std::min<size_t>(m_gpuPassTimesMs.size(), OverlayTelemetryBlock::MAX_GPU_PASSES));
+    for (uint32_t i = 0; i < block->gpuPassCount; i++) {
+        block->gpuPassMs[i] = m_gpuPassTimesMs[i];
+    }
+
+    block->cpuPercent = GetCpuUsagePercent();
+    block->gpuPercent = GetGpuUsagePercent();
+    block->memoryMB = GetTotalMemoryUsageMB();
+    block->performanceState = m_performanceState;
+    block->renderScale = m_renderScale;
+
+    m_sharedTelemetry->EndWrite();
+}
+
+void PerformanceMonitor::RecordFrameLatencyWait(float waitMs) {
+    m_frameLatencyWaitMs = waitMs;
+    AddMetric(Metric::FrameLatencyWaitMs, waitMs);
+}
+
+void PerformanceMonitor::AddMetric(Metric metric, float value) {
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_metricEpoch).count();
+    m_metrics[static_cast<size_t>(metric)].Add(time, value);
+}
+
+void PerformanceMonitor::RecordPresentedArea(UINT64 presentedPixels, UINT64 totalPixels) {
+    m_presentedPixels = presentedPixels;
+    m_presentedAreaPercent = totalPixels > 0 ?
+        100.0f * static_cast<float>(presentedPixels) / static_cast<float>(totalPixels) : 0.0f;
+}
+
+void PerformanceMonitor::RecordBrowserPaintStats(const BrowserPaintStats& stats) {
+    m_browserPaintStats = stats;
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_paintWindowStartTime < PAINT_STATS_WINDOW) return;
+
+    UINT64 paints = stats.paints - m_paintWindowStart.paints;
+    UINT64 overwritten = stats.overwritten - m_paintWindowStart.overwritten;
+    m_overwrittenPaintPercent = paints > 0 ? 100.0f * static_cast<float>(overwritten) / static_cast<float>(paints) : 0.0f;
+    m_paintWindowStart = stats;
+    m_paintWindowStartTime = now;
+}
+
+void PerformanceMonitor::RecordCefPumpFrame(const CefPumpFrame& frame) {
+    CefPumpStats& stats = m_cefPumpStats;
+    const float smoothing = stats.frames == 0 ? 1.0f : 0.05f;
+    stats.frames++;
+    if (frame.deferred) stats.deferredFrames++;
+    stats.slices += frame.slices;
+    stats.overruns += frame.overruns;
+    stats.totalMs += frame.ms;
+    stats.averageFrameMs += (frame.ms - stats.averageFrameMs) * smoothing;
+    stats.maxFrameMs = std::max(stats.maxFrameMs, frame.ms);
+    stats.maxSliceMs = std::max(stats.maxSliceMs, frame.maxSliceMs);
+}
+
+void PerformanceMonitor::RecordDisplayStatistics(const DisplayStatistics& stats) {
+    // At most one input sample resolves per present
+    if (stats.inputSamples != m_displayStatistics.inputSamples) {
+        if (m_currentInputLatencyResults == SIZE_MAX) {
+            auto results = std::make_unique<InputLatencyResults>();
+            results->configuration = m_inputLatencyConfiguration;
+            m_currentInputLatencyResults = m_inputLatencyResults.size();
+            m_inputLatencyResults.push_back(std::move(results));
+        }
+        m_inputLatencyResults[m_currentInputLatencyResults]->histogram.AddFrame(stats.lastInputToPhotonMs);
+    }
+    m_displayStatistics = stats;
+}
+
+void PerformanceMonitor::SetInputLatencyConfiguration(const InputLatencyConfiguration& configuration) {
+    if (configuration == m_inputLatencyConfiguration) return;
+    m_inputLatencyConfiguration = configuration;
+    m_currentInputLatencyResults = SIZE_MAX;
+    for (size_t i = 0; i < m_inputLatencyResults.size(); i++) {
+        if (m_inputLatencyResults[i]->configuration == configuration) {
+            m_currentInputLatencyResults = i;
+            break;
+        }
+    }
+}
+
+const InputLatencyResults* PerformanceMonitor::GetCurrentInputLatencyResults() const {
+    return m_currentInputLatencyResults < m_inputLatencyResults.size() ?
+        m_inputLatencyResults[m_currentInputLatencyResults].get() : nullptr;
+}
+
+void PerformanceMonitor::RecordPresentationMode(PresentationMode mode, bool overlaySupported) {
+    m_presentationMode = mode;
+    m_overlayPlaneSupported = overlaySupported;
+}
+
+void PerformanceMonitor::SampleThreadCycles() {
+    // A query per thread; over a second the rates are also steadier
+    constexpr auto SAMPLE_INTERVAL = std::chrono::seconds(1);
+    auto now = std::chrono::steady_clock::now();
+    const bool first = m_lastThreadCycleSample == std::chrono::steady_clock::time_point();
+    if (!first && now - m_lastThreadCycleSample < SAMPLE_INTERVAL) return;
+
+    ThreadCycles::Totals totals;
+    std::array<UINT, static_cast<size_t>(ThreadSubsystem::Count)> threads;
+    ThreadCycles::GetTotals(totals, threads);
+
+    const double seconds = std::chrono::duration<double>(now - m_lastThreadCycleSample).count();
+    m_lastThreadCycleSample = now;
+    if (first) {
+        m_lastThreadCycles = totals;
+        return;
+    }
+
+    uint64_t processCycles = 0;
+    for (size_t i = 0; i < totals.size(); i++) {
+        processCycles += totals[i] - std::min(m_lastThreadCycles[i], totals[i]);
+    }
+    for (size_t i = 0; i < totals.size(); i++) {
+        const uint64_t cycles = totals[i] - std::min(m_lastThreadCycles[i], totals[i]);
+        SubsystemCpu& cpu = m_subsystemCpu[i];
+        cpu.megacyclesPerSecond = static_cast<float>(cycles / seconds / 1e6);
+        cpu.sharePercent = processCycles > 0 ? static_cast<float>(100.0 * cycles / processCycles) : 0.0f;
+        cpu.cpuPercent = GetCpuUsagePercent() * cpu.sharePercent / 100.0f;
+        cpu.threads = threads[i];
+    }
+    m_lastThreadCycles = totals;
 }
 
 void PerformanceMonitor::UpdateSystemMetrics() {
@@ -117,4 +418,405 @@ void PerformanceMonitor::UpdateSystemMetrics() {
     if (GetProcessMemoryInfo(m_processHandle, reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&pmc), sizeof(pmc))) {
         m_memoryUsage = pmc.WorkingSetSize;
     }
+
+    if (m_powerSampler) {
+        m_powerSampler->Poll();
+    }
+
+    // Subprocesses come and go with browsers; GPU memory counters follow the same list
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_lastProcessTreeUpdate >= std::chrono::seconds(1)) {
+        m_lastProcessTreeUpdate = now;
+        if (!m_processTreeInBackground) {
+            m_processTree->Update();
+        }
+        std::vector<DWORD> processIds = m_processTree->GetProcessIds();
+        if (m_gpuSampler && processIds != m_gpuTrackedProcesses) {
+            m_gpuTrackedProcesses = std::move(processIds);
+            m_gpuSampler->SetTrackedProcesses(m_gpuTrackedProcesses);
+        }
+        SampleRendererCpu();
+        SamplePower();
+    }
+
+    if (m_presentSampler) {
+        m_presentSampler->GetLatestSample(m_gameSample);
+    }
+}
+
+void PerformanceMonitor::SamplePower() {
+    const ProcessTreeMemory tree = m_processTree->GetMemory();
+    const double seconds = std::chrono::duration<double>(tree.sampleTime - m_lastPowerCpuSample).count();
+    const bool first = m_lastPowerCpuSample == std::chrono::steady_clock::time_point();
+    if (seconds <= 0.0) return;
+    const UINT64 cpuTime = tree.total.cpuTime - std::min(m_lastPowerCpuTime, tree.total.cpuTime);
+    m_lastPowerCpuTime = tree.total.cpuTime;
+    m_lastPowerCpuSample = tree.sampleTime;
+
+    PowerSample sample;
+    if (first || !m_powerSampler || !m_powerSampler->GetLatestSample(sample)) return;
+
+    OverlayPower& power = m_overlayPower;
+    power.valid = true;
+    power.system = sample;
+
+    // Package: the tree's busy cores over everyone's (the samplers' intervals roughly line up)
+    const float overlayCores = static_cast<float>(cpuTime / 1e7 / seconds);
+    const float cpuShare = sample.systemBusyCores > 0.0f ? std::min(overlayCores / sample.systemBusyCores, 1.0f) : 0.0f;
+    // The integrated GPU's part of the package (RAPL PP1) goes with the GPUs instead
+    float integratedGpuWatts = sample.integratedGpuWatts;
+    if (sample.packageMeasured) integratedGpuWatts = std::min(integratedGpuWatts, sample.packageWatts);
+    power.packageWatts = (sample.packageWatts - (sample.packageMeasured ? integratedGpuWatts : 0.0f)) * cpuShare;
+
+    // GPUs: every adapter's 3D engines, so the share is of all of them together
+    float gpuShare = 0.0f;
+    if (m_gpuSample.valid && m_gpuSample.GetSystemUsage(GpuEngineType::Graphics) > 0.0f) {
+        gpuShare = std::min(m_gpuSample.GetProcessUsage(GpuEngineType::Graphics) /
+            m_gpuSample.GetSystemUsage(GpuEngineType::Graphics), 1.0f);
+    }
+    power.gpuWatts = (sample.discreteGpuWatts + integratedGpuWatts) * gpuShare;
+
+    auto addCost = [&power](PowerCost& cost) {
+        cost.samples++;
+        cost.packageWattsSum += power.packageWatts;
+        cost.gpuWattsSum += power.gpuWatts;
+    };
+    if (m_performanceState < POWER_COST_SLOTS) addCost(m_statePowerCosts[m_performanceState]);
+    if (m_powerPreset >= 0 && static_cast<size_t>(m_powerPreset) < POWER_COST_SLOTS) addCost(m_presetPowerCosts[m_powerPreset]);
+}
+
+bool PerformanceMonitor::GetStatePowerCost(uint32_t performanceState, float& packageWatts, float& gpuWatts) const {
+    if (performanceState >= POWER_COST_SLOTS) return false;
+    const PowerCost& cost = m_statePowerCosts[performanceState];
+    if (cost.samples == 0) return false;
+    packageWatts = static_cast<float>(cost.packageWattsSum / cost.samples);
+    gpuWatts = static_cast<float>(cost.gpuWattsSum / cost.samples);
+    return true;
+}
+
+bool PerformanceMonitor::GetPresetPowerCost(int preset, float& packageWatts, float& gpuWatts) const {
+    if (preset < 0 || static_cast<size_t>(preset) >= POWER_COST_SLOTS) return false;
+    const PowerCost& cost = m_presetPowerCosts[preset];
+    if (cost.samples == 0) return false;
+    packageWatts = static_cast<float>(cost.packageWattsSum / cost.samples);
+    gpuWatts = static_cast<float>(cost.gpuWattsSum / cost.samples);
+    return true;
+}
+
+void PerformanceMonitor::SampleRendererCpu() {
+    ProcessTreeMemory tree = m_processTree->GetMemory();
+    if (!m_rendererCpuSamples.empty() && tree.sampleTime <= m_rendererCpuSamples.back().time) return;
+    m_rendererCpuSamples.push_back({ tree.sampleTime, tree.Get(OverlayProcessType::Renderer).cpuTime });
+    if (m_rendererCpuSamples.size() > MAX_RENDERER_CPU_SAMPLES) m_rendererCpuSamples.pop_front();
+
+    // Oldest first, so each one only needs the samples around it
+    while (!m_pendingNavigations.empty() && m_pendingNavigations.front().end <= tree.sampleTime) {
+        const NavigationTiming& timing = m_pendingNavigations.front();
+        const CpuSample* before = &m_rendererCpuSamples.front(); // Clipped when older than the samples
+        const CpuSample* after = &m_rendererCpuSamples.back();
+        for (const CpuSample& sample : m_rendererCpuSamples) {
+            if (sample.time <= timing.start) before = &sample;
+            if (sample.time >= timing.end) {
+                after = &sample;
+                break;
+            }
+        }
+        float rendererCpuMs = static_cast<float>((after->cpuTime - std::min(after->cpuTime, before->cpuTime)) / 10000.0);
+        AddNavigation(timing, rendererCpuMs);
+        m_pendingNavigations.pop_front();
+    }
+}
+
+void PerformanceMonitor::RecordNavigation(const NavigationTiming& timing) {
+    if (m_pendingNavigations.size() >= MAX_PENDING_NAVIGATIONS) {
+        m_pendingNavigations.pop_front();
+    }
+    m_pendingNavigations.push_back(timing);
+}
+
+void PerformanceMonitor::AddNavigation(const NavigationTiming& timing, float rendererCpuMs) {
+    std::string domain = GetUrlDomain(timing.url);
+    if (domain.empty()) return;
+    m_navigationCount++;
+
+    auto it = std::find_if(m_domainLoadStats.begin(), m_domainLoadStats.end(),
+        [&domain](const DomainLoadStats& stats) { return stats.domain == domain; });
+    if (it == m_domainLoadStats.end()) {
+        if (m_domainLoadStats.size() >= MAX_TRACKED_DOMAINS) {
+            m_domainLoadStats.erase(std::min_element(m_domainLoadStats.begin(), m_domainLoadStats.end(),
+                [](const DomainLoadStats& a, const DomainLoadStats& b) { return a.loads < b.loads; }));
+        }
+        m_domainLoadStats.emplace_back();
+        it = std::prev(m_domainLoadStats.end());
+        it->domain = std::move(domain);
+    }
+
+    DomainLoadStats& stats = *it;
+    stats.loads++;
+    if (timing.httpStatus == 0 || timing.httpStatus >= 400) stats.failures++;
+    if (timing.firstPaintMs >= 0.0f) {
+        stats.paintedLoads++;
+        stats.firstPaintMsSum += timing.firstPaintMs;
+    }
+    stats.loadMsSum += timing.loadMs;
+    stats.maxLoadMs = std::max(stats.maxLoadMs, timing.loadMs);
+    stats.bytes += timing.bytes;
+    stats.rendererCpuMsSum += rendererCpuMs;
+    size_t bucket = 0;
+    while (bucket < DomainLoadStats::BUCKET_COUNT - 1 && timing.loadMs >= DomainLoadStats::BUCKET_LIMITS_MS[bucket]) {
+        bucket++;
+    }
+    stats.loadMsBuckets[bucket]++;
+    stats.last = timing;
+    stats.lastRendererCpuMs = rendererCpuMs;
+
+    std::sort(m_domainLoadStats.begin(), m_domainLoadStats.end(), [](const DomainLoadStats& a, const DomainLoadStats& b) {
+        return a.loadMsSum / a.loads > b.loadMsSum / b.loads;
+    });
+}
+
+const PageMetrics* PerformanceMonitor::FindPageMetrics(int tabId) const {
+    for (const PageMetrics& metrics : *m_pageMetrics) {
+        if (metrics.tabId == tabId) return &metrics;
+    }
+    return nullptr;
+}
+
+void PerformanceMonitor::UpdateGpuMetrics() {
+    // Measured: the busiest engine our processes use (a copy-bound upload counts as much as 3D)
+    if (m_gpuSampler && m_gpuSampler->GetLatestSample(m_gpuSample)) {
+        float usage = 0.0f;
+        for (float engineUsage : m_gpuSample.processEngineUsage) {
+            usage = std::max(usage, engineUsage);
+        }
+        m_gpuUsage = usage;
+        return;
+    }
+
+    // Estimated: the share of the frame interval the GPU spent on our work
+    float frameMs = m_lastFrameTime * 1000.0f;
+    if (frameMs > 0.0f) {
+        m_gpuUsage = std::min(m_gpuFrameTimeMs / frameMs, 1.0f);
+    }
+}
+
+void PerformanceMonitor::RecordGpuFrameTime(float gpuFrameMs) {
+    m_gpuFrameTimeMs = gpuFrameMs;
+    if (gpuFrameMs > 0.0f) {
+        m_session.gpuFrameSamples++;
+        m_session.gpuFrameMsSum += gpuFrameMs;
+    }
+}
+
+void PerformanceMonitor::RecordGpuPassTime(GpuPass pass, float gpuMs) {
+    if (pass >= GpuPass::Count) return;
+    m_gpuPassTimesMs[static_cast<size_t>(pass)] = gpuMs;
+    if (m_gpuFrameTimeMs > 0.0f) {
+        m_session.gpuPassMsSums[static_cast<size_t>(pass)] += gpuMs; // Same samples as the frame time
+    }
+}
+
+bool PerformanceMonitor::GetBrowserGpuPolicyCost(BrowserGpuPolicy policy, float& avgCpuPercent, float& avgGpuFrameMs) const {
+    if (policy >= BrowserGpuPolicy::Count) return false;
+    const PolicyCost& cost = m_browserGpuPolicyCosts[static_cast<size_t>(policy)];
+    if (cost.samples == 0) return false;
+    avgCpuPercent = static_cast<float>(cost.cpuSum / cost.samples * 100.0);
+    avgGpuFrameMs = static_cast<float>(cost.gpuMsSum / cost.samples);
+    return true;
+}
+
+bool PerformanceMonitor::GetGpuBoundGameFrameMs(bool yielded, float& avgFrameMs) const {
+    const GameFrameCost& cost = m_gpuBoundGameFrameCosts[yielded ? 1 : 0];
+    if (cost.samples == 0) return false;
+    avgFrameMs = static_cast<float>(cost.frameMsSum / cost.samples);
+    return true;
+}
+
+bool PerformanceMonitor::IsCpuThresholdExceeded(float thresholdPercent) const {
+    return (m_cpuUsage * 100.0f) > thresholdPercent;
+}
+
+bool PerformanceMonitor::IsGameFrameTimeDegraded(float percent) const {
+    return m_gameSample.valid && m_gameSample.baselineFrameMs > 0.0f &&
+        m_gameSample.averageFrameMs > m_gameSample.baselineFrameMs * (1.0f + percent / 100.0f);
+}
+
+bool PerformanceMonitor::IsGameGpuBound(float percent) const {
+    if (!m_gameSample.valid || !m_gpuSample.valid) return false;
+    // Busiest 3D engine across the system, less our share of it (close enough for one GPU)
+    float othersUsage = m_gpuSample.GetSystemUsage(GpuEngineType::Graphics) -
+        m_gpuSample.GetProcessUsage(GpuEngineType::Graphics);
+    return othersUsage * 100.0f >= percent;
+}
+
+float PerformanceMonitor::GetTotalMemoryUsageMB() const {
+    ProcessTreeMemory tree = m_processTree->GetMemory();
+    if (!tree.valid) {
+        return GetMemoryUsageMB();
+    }
+    UINT64 bytes = tree.total.privateBytes + (m_gpuSample.valid ? m_gpuSample.processDedicatedBytes : 0);
+    return static_cast<float>(bytes) / (1024.0f * 1024.0f);
+}
+
+bool PerformanceMonitor::IsMemoryThresholdExceeded(float thresholdMB) const {
+    return GetTotalMemoryUsageMB() > thresholdMB;
+}
+
+bool PerformanceMonitor::IsGpuThresholdExceeded(float thresholdPercent) const {
+    return (m_gpuUsage * 100.0f) > thresholdPercent;
+}
+
+bool PerformanceMonitor::WritePerformanceReport(const std::string& path) const {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) return false;
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_session.start).count();
+    char line[512];
+    file << "{\n";
+    snprintf(line, sizeof(line), "  \"durationSeconds\": %.3f,\n", seconds);
+    file << line;
+
+    // Frame times (present to present), per histogram window
+    file << "  \"frameTime\": {";
+    for (size_t i = 0; i < static_cast<size_t>(FrameTimeWindow::Count); i++) {
+        FrameTimeWindow window = static_cast<FrameTimeWindow>(i);
+        FrameTimePercentiles p = m_frameTimeHistogram.GetPercentiles(window);
+        snprintf(line, sizeof(line),
+            "%s\n    \"%s\": { \"frames\": %llu, \"meanMs\": %.3f, \"p50Ms\": %.3f, \"p95Ms\": %.3f, \"p99Ms\": %.3f, \"p999Ms\": %.3f, \"maxMs\": %.3f }",
+            i > 0 ? "," : "", GetFrameTimeWindowName(window), static_cast<unsigned long long>(p.frames),
+            p.meanMs, p.p50Ms, p.p95Ms, p.p99Ms, p.p999Ms, p.maxMs);
+        file << line;
+    }
+    file << "\n  },\n";
+
+    // GPU means over the frames with timestamps
+    const double gpuSamples = static_cast<double>(std::max<UINT64>(m_session.gpuFrameSamples, 1));
+    snprintf(line, sizeof(line), "  \"gpu\": {\n    \"frameMeanMs\": %.4f,\n    \"passMeanMs\": {", m_session.gpuFrameMsSum / gpuSamples);
+    file << line;
+    for (size_t i = 0; i < static_cast<size_t>(GpuPass::Count); i++) {
+        snprintf(line, sizeof(line), "%s \"%s\": %.4f", i > 0 ? "," : "", GetGpuPassName(static_cast<GpuPass>(i)),
+            m_session.gpuPassMsSums[i] / gpuSamples);
+        file << line;
+    }
+    file << " }\n  },\n";
+
+    snprintf(line, sizeof(line), "  \"cpuMeanPercent\": %.2f,\n  \"peakMemoryMB\": %.1f,\n",
+        m_session.cpuSamples > 0 ? m_session.cpuSum / m_session.cpuSamples * 100.0 : 0.0, m_session.peakMemoryMB);
+    file << line;
+    const BrowserTileStats& tiles = m_browserTileStats;
+    snprintf(line, sizeof(line),
+        "  \"browserUpload\": { \"totalMB\": %.1f, \"meanMBPerSecond\": %.2f, \"dirtyMB\": %.1f, \"unchangedTilePercent\": %.1f, "
+        "\"scrollPaints\": %llu, \"scrollMovedMB\": %.1f },\n",
+        m_browserUploadedBytes / (1024.0 * 1024.0), seconds > 0.0 ? m_browserUploadedBytes / (1024.0 * 1024.0) / seconds : 0.0,
+        tiles.dirtyBytes / (1024.0 * 1024.0),
+        tiles.hashedTiles > 0 ? 100.0 * tiles.unchangedTiles / tiles.hashedTiles : 0.0,
+        static_cast<unsigned long long>(tiles.scrollPaints), tiles.scrollMovedBytes / (1024.0 * 1024.0));
+    file << line;
+    snprintf(line, sizeof(line), "  \"display\": { \"displayedFrames\": %llu, \"missedVsyncs\": %llu },\n",
+        static_cast<unsigned long long>(m_displayStatistics.displayedFrames),
+        static_cast<unsigned long long>(m_displayStatistics.missedVsyncs));
+    file << line;
+    const BrowserPaintStats& paints = m_browserPaintStats;
+    snprintf(line, sizeof(line),
+        "  \"browserPaints\": { \"paints\": %llu, \"overwrittenPercent\": %.1f, \"meanPaintToPhotonMs\": %.2f },\n",
+        static_cast<unsigned long long>(paints.paints),
+        paints.paints > 0 ? 100.0 * paints.overwritten / paints.paints : 0.0,
+        m_displayStatistics.displayedPaints > 0 ? m_displayStatistics.paintToPhotonSumMs / m_displayStatistics.displayedPaints : 0.0);
+    file << line;
+    file << "  \"inputToPhoton\": [";
+    for (size_t i = 0; i < m_inputLatencyResults.size(); i++) {
+        const InputLatencyResults& results = *m_inputLatencyResults[i];
+        FrameTimePercentiles p = results.histogram.GetPercentiles(FrameTimeWindow::Session);
+        snprintf(line, sizeof(line), "%s\n    { \"frameLatencyWait\": %s, \"framesInFlight\": %u, \"rawInputThread\": %s, "
+            "\"samples\": %llu, \"meanMs\": %.2f, \"p50Ms\": %.2f, \"p95Ms\": %.2f, \"p99Ms\": %.2f, \"maxMs\": %.2f }",
+            i > 0 ? "," : "", results.configuration.frameLatencyWait ? "true" : "false", results.configuration.framesInFlight,
+            results.configuration.rawInputThread ? "true" : "false", static_cast<unsigned long long>(p.frames),
+            p.meanMs, p.p50Ms, p.p95Ms, p.p99Ms, p.maxMs);
+        file << line;
+    }
+    file << "\n  ],\n";
+    // Overlay watts per PerformanceState (Active, Inactive, Background, LowPower) and per preset
+    // (the settings page's order: Maximum, Balanced, Efficiency, Minimal); null where never sampled
+    static const char* POWER_STATE_NAMES[POWER_COST_SLOTS] = { "active", "inactive", "background", "lowPower" };
+    static const char* POWER_PRESET_NAMES[POWER_COST_SLOTS] = { "maximum", "balanced", "efficiency", "minimal" };
+    auto writePowerCosts = [&](const char* name, const char* const* names, auto getCost) {
+        file << "    \"" << name << "\": {";
+        for (size_t i = 0; i < POWER_COST_SLOTS; i++) {
+            float packageWatts = 0.0f;
+            float gpuWatts = 0.0f;
+            if (getCost(i, packageWatts, gpuWatts)) {
+                snprintf(line, sizeof(line), "%s \"%s\": { \"packageWatts\": %.2f, \"gpuWatts\": %.2f }",
+                    i > 0 ? "," : "", names[i], packageWatts, gpuWatts);
+            }
+            else {
+                snprintf(line, sizeof(line), "%s \"%s\": null", i > 0 ? "," : "", names[i]);
+            }
+            file << line;
+        }
+        file << " }";
+    };
+    file << "  \"power\": {\n";
+    snprintf(line, sizeof(line), "    \"measured\": %s,\n", IsPowerMeasured() ? "true" : "false");
+    file << line;
+    writePowerCosts("byState", POWER_STATE_NAMES, [this](size_t i, float& package, float& gpu) {
+        return GetStatePowerCost(static_cast<uint32_t>(i), package, gpu);
+    });
+    file << ",\n";
+    writePowerCosts("byPreset", POWER_PRESET_NAMES, [this](size_t i, float& package, float& gpu) {
+        return GetPresetPowerCost(static_cast<int>(i), package, gpu);
+    });
+    file << "\n  },\n";
+    snprintf(line, sizeof(line), "  \"hitches\": %llu,\n", static_cast<unsigned long long>(m_hitchDetector.GetTotalHitches()));
+    file << line;
+    file << "  \"startupPhases\": [";
+    for (size_t i = 0; i < m_startupPhases.size(); i++) {
+        const StartupPhase& phase = m_startupPhases[i];
+        snprintf(line, sizeof(line), "%s\n    { \"name\": \"%s\", \"startMs\": %.1f, \"durationMs\": %.1f }",
+            i > 0 ? "," : "", phase.name.c_str(), phase.startMs, phase.durationMs);
+        file << line;
+    }
+    file << "\n  ],\n";
+    file << "  \"navigationDomains\": [";
+    for (size_t i = 0; i < m_domainLoadStats.size(); i++) {
+        const DomainLoadStats& stats = m_domainLoadStats[i];
+        snprintf(line, sizeof(line), "%s\n    { \"domain\": \"%s\", \"loads\": %u, \"failures\": %u, \"meanFirstPaintMs\": %.1f, "
+            "\"meanLoadMs\": %.1f, \"maxLoadMs\": %.1f, \"meanKB\": %.1f, \"meanRendererCpuMs\": %.1f, \"loadMsBuckets\": [",
+            i > 0 ? "," : "", stats.domain.c_str(), stats.loads, stats.failures,
+            stats.paintedLoads > 0 ? stats.firstPaintMsSum / stats.paintedLoads : -1.0,
+            stats.loadMsSum / stats.loads, stats.maxLoadMs, stats.bytes / 1024.0 / stats.loads,
+            stats.rendererCpuMsSum / stats.loads);
+        file << line;
+        for (size_t bucket = 0; bucket < DomainLoadStats::BUCKET_COUNT; bucket++) {
+            file << (bucket > 0 ? ", " : "") << stats.loadMsBuckets[bucket];
+        }
+        file << "] }";
+    }
+    file << "\n  ],\n";
+    snprintf(line, sizeof(line), "  \"residentWake\": { \"wakes\": %llu, \"lastMs\": %.1f, \"maxMs\": %.1f },\n",
+        static_cast<unsigned long long>(m_wakeCount), m_lastWakeLatencyMs, m_maxWakeLatencyMs);
+    file << line;
+    snprintf(line, sizeof(line), "  \"allocations\": { \"tracked\": %s, \"maxPerFrame\": %llu, \"steadyStateFrames\": %llu, "
+        "\"steadyStateAllocatingFrames\": %llu, \"worstSteadyStateFrame\": { \"allocations\": %llu, \"bytes\": %llu, \"zone\": \"%s\" } },\n",
+        AllocationTracker::IsCompiledIn() ? "true" : "false", static_cast<unsigned long long>(m_maxFrameAllocations),
+        static_cast<unsigned long long>(m_steadyStateFrames), static_cast<unsigned long long>(m_steadyStateAllocatingFrames),
+        static_cast<unsigned long long>(m_worstSteadyStateAllocations.allocations),
+        static_cast<unsigned long long>(m_worstSteadyStateAllocations.bytes), m_worstSteadyStateZone.c_str());
+    file << line;
+    const CefPumpStats& pump = m_cefPumpStats;
+    snprintf(line, sizeof(line), "  \"cefPump\": { \"meanMsPerFrame\": %.3f, \"maxMsPerFrame\": %.2f, \"maxSliceMs\": %.2f, "
+        "\"slices\": %llu, \"overruns\": %llu, \"deferredPercent\": %.1f },\n",
+        pump.frames > 0 ? pump.totalMs / pump.frames : 0.0, pump.maxFrameMs, pump.maxSliceMs,
+        static_cast<unsigned long long>(pump.slices), static_cast<unsigned long long>(pump.overruns),
+        pump.frames > 0 ? 100.0 * pump.deferredFrames / pump.frames : 0.0);
+    file << line;
+    if (m_textEmissionBenchmark.frames > 0) {
+        const TextEmissionBenchmark& bench = m_textEmissionBenchmark;
+        snprintf(line, sizeof(line), "  \"textEmission\": { \"kernel\": \"%s\", \"frames\": %d, \"scalarMs\": %.4f, "
+            "\"batchedMs\": %.4f, \"vertices\": %d },\n", bench.kernel, bench.frames, bench.scalarMs, bench.batchedMs, bench.vertices);
+        file << line;
+    }
+    snprintf(line, sizeof(line), "  \"timeToFirstFrameMs\": %.1f,\n  \"timeToFirstBrowserPaintMs\": %.1f\n",
+        m_timeToFirstFrameMs, m_timeToFirstBrowserPaintMs);
+    file << line << "}\n";
+    return static_cast<bool>(file);
 }
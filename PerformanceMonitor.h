@@ -9,11 +9,258 @@
 #include <string>
 #include <vector>
 #include <array>
+#include <algorithm>
+#include <memory>
+#include <atomic>
+#include <deque>
+#include "GpuUsageSampler.h"
+#include "FrameTimeHistogram.h"
+#include "SharedTelemetry.h"
+#include "PresentEventSampler.h"
+#include "ProcessTreeMonitor.h"
+#include "HitchDetector.h"
+#include "MetricSeries.h"
+#include "AllocationTracker.h"
+#include "ThreadCycles.h"
+#include "PowerSampler.h"
+
+// GPU passes bracketed with timestamp queries by RenderSystem
+enum class GpuPass {
+    Clear,          // Render target clear
+    BrowserCopy,    // Browser texture upload copy
+    ImGui,          // ImGui draw data
+    Upscale,        // Reserved for render-scale upscaling
+    Count
+};
+
+const char* GetGpuPassName(GpuPass pass);
+
+// How DWM is showing the overlay swap chain (DXGI_FRAME_PRESENTATION_MODE)
+enum class PresentationMode {
+    Unknown,            // Not reported yet, or the swap chain cannot report it
+    Composed,           // Composited by DWM every frame
+    Overlay,            // Scanned out on a hardware overlay plane (MPO)
+    IndependentFlip,    // Flipped directly to the output
+    CompositionFailure  // Overlay plane assignment failed, composed instead
+};
+
+const char* GetPresentationModeName(PresentationMode mode);
+
+// When frames actually reached the screen (IDXGISwapChain::GetFrameStatistics after each present)
+struct DisplayStatistics {
+    bool valid = false;                    // False while the swap chain reports none (occluded, mode changes)
+    float displayedFramesPerSecond = 0.0f; // New frames shown, over the last window
+    float refreshRateHz = 0.0f;            // Vblanks per second, over the last window
+    UINT presentQueueDepth = 0;            // Presents issued but not displayed yet
+    UINT64 displayedFrames = 0;            // Totals since startup
+    UINT64 missedVsyncs = 0;               // Vblanks a queued frame should have been shown on but wasn't
+    bool variableRefresh = false;          // Presented for a variable refresh display (no vsync pacing)
+    float frameIntervalMs = 0.0f;          // Mean time between displayed frames, over the last window
+    float frameIntervalJitterMs = 0.0f;    // Standard deviation of the same
+    float paintToPhotonMs = 0.0f;          // Browser paint to the vblank that showed it, mean over the last window
+    float paintToPhotonMaxMs = 0.0f;       // Worst of the same
+    UINT64 displayedPaints = 0;            // Totals: paints whose frame the statistics named, and their latency
+    double paintToPhotonSumMs = 0.0;
+    UINT64 inputSamples = 0;               // Input-to-photon samples resolved (see InputLatency.h)
+    float lastInputToPhotonMs = 0.0f;      // The newest of them
+};
+
+// How Chromium uses the GPU (fixed when CEF starts; see BrowserManager::SetGpuPolicy)
+enum class BrowserGpuPolicy {
+    Full,           // GPU raster and compositing
+    SoftwareRaster, // GPU compositing, CPU raster
+    Software,       // No GPU process work at all (disable-gpu, disable-gpu-compositing)
+    Count
+};
+
+const char* GetBrowserGpuPolicyName(BrowserGpuPolicy policy);
+
+// How browser paints reach the texture the UI samples (see BrowserView::CreateBrowserTextureResources)
+enum class BrowserUploadPath {
+    SharedTexture,    // Accelerated paint: GPU copy out of CEF's shared texture
+    UploadRing,       // CPU paint into system memory buffers, then a GPU copy (or conversion)
+    GpuUploadBuffer,  // CPU paint into VRAM buffers (Resizable BAR) the conversion reads
+    GpuUploadTexture, // CPU paint straight into the sampled textures (Resizable BAR), no copy
+    Count
+};
+
+const char* GetBrowserUploadPathName(BrowserUploadPath path);
+
+// Software paints split into tiles, cumulative (see BrowserView::GetTileStats). A hashed tile whose
+// hash didn't change is not uploaded, even though CEF reported it dirty.
+struct BrowserTileStats {
+    UINT64 hashedTiles = 0;
+    UINT64 unchangedTiles = 0;
+    UINT64 dirtyBytes = 0; // What CEF reported dirty; compare with the uploaded bytes
+    UINT64 scrollPaints = 0;     // Uploaded as a GPU move and the exposed rows
+    UINT64 scrollMovedBytes = 0; // Not uploaded thanks to them
+};
+
+// Browser paints of the view since startup (BrowserView::GetPaintStats)
+struct BrowserPaintStats {
+    UINT64 paints = 0;      // With content to show
+    UINT64 overwritten = 0; // Replaced by a newer paint, or dropped, before any frame showed them
+};
+
+// CEF message loop work on the render thread between two presents (BrowserManager's budgeted pump)
+struct CefPumpFrame {
+    float ms = 0.0f;          // In CefDoMessageLoopWork
+    float maxSliceMs = 0.0f;
+    UINT slices = 0;
+    UINT overruns = 0;        // Slices that ended past their deadline
+    bool deferred = false;    // Due work was left for later, out of budget
+};
+
+// The above over the session, with a smoothed per-frame time for display
+struct CefPumpStats {
+    UINT64 frames = 0;
+    UINT64 deferredFrames = 0;
+    UINT64 slices = 0;
+    UINT64 overruns = 0;
+    double totalMs = 0.0;
+    float averageFrameMs = 0.0f;
+    float maxFrameMs = 0.0f;
+    float maxSliceMs = 0.0f;
+};
+
+// UI builds of the shown page with ImGui's scalar text and rect vertex emission against the batched
+// SIMD kernel (ImGuiSystem::RunTextEmissionBenchmark); frames == 0 until one has run
+struct TextEmissionBenchmark {
+    const char* kernel = "";  // The batched one
+    int frames = 0;           // Per path, alternating
+    float scalarMs = 0.0f;    // Mean build, BeginFrame to ImGui::Render
+    float batchedMs = 0.0f;
+    int vertices = 0;         // One build's, the same on both paths
+};
+
+// What input-to-photon latency depends on in the overlay; samples are kept per configuration so
+// one session can compare them
+struct InputLatencyConfiguration {
+    bool frameLatencyWait = true; // The loop waits on the swap chain's waitable object
+    UINT framesInFlight = 0;
+    bool rawInputThread = true;   // Hotkeys on the Raw Input thread, not the keyboard hook
+
+    bool operator==(const InputLatencyConfiguration& other) const {
+        return frameLatencyWait == other.frameLatencyWait && framesInFlight == other.framesInFlight &&
+            rawInputThread == other.rawInputThread;
+    }
+};
+
+struct InputLatencyResults {
+    InputLatencyConfiguration configuration;
+    FrameTimeHistogram histogram; // Input to photon, ms
+};
+
+// One main frame load of an http(s) page, OnLoadStart to OnLoadEnd or OnLoadError (see
+// BrowserHandler). Times are from the start.
+struct NavigationTiming {
+    std::string url;
+    int httpStatus = 0;          // 0 when the load failed
+    int errorCode = 0;           // cef_errorcode_t when it failed
+    float firstPaintMs = -1.0f;  // First view paint; -1 when none came before the load ended
+    float loadMs = 0.0f;
+    UINT64 bytes = 0;            // Received by the page's requests while it loaded
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point end;
+};
+
+// Load times per domain (the URL's host, without a leading "www."), since startup
+struct DomainLoadStats {
+    static constexpr size_t BUCKET_COUNT = 6;
+    static const float BUCKET_LIMITS_MS[BUCKET_COUNT - 1]; // Upper bounds; the last bucket is open
+
+    std::string domain;
+    UINT loads = 0;
+    UINT failures = 0;
+    UINT paintedLoads = 0;             // Loads that painted before they ended
+    double firstPaintMsSum = 0.0;
+    double loadMsSum = 0.0;
+    float maxLoadMs = 0.0f;
+    UINT64 bytes = 0;
+    double rendererCpuMsSum = 0.0;
+    std::array<UINT, BUCKET_COUNT> loadMsBuckets = {};
+    NavigationTiming last;
+    float lastRendererCpuMs = 0.0f;
+};
+
+// One live browser's renderer-side metrics, from Chromium's Performance.getMetrics (see
+// PageMetricsSampler). Durations are the renderer main thread's, summed since the page loaded.
+struct PageMetrics {
+    int tabId = 0;
+    bool active = false; // The visible tab when it was polled
+    std::string url;
+    double jsHeapUsedMB = 0.0;
+    double jsHeapTotalMB = 0.0;
+    UINT nodes = 0;
+    UINT documents = 0;
+    UINT jsEventListeners = 0;
+    UINT64 layoutCount = 0;
+    UINT64 recalcStyleCount = 0;
+    double layoutMs = 0.0;
+    double recalcStyleMs = 0.0;
+    double scriptMs = 0.0;
+    double taskMs = 0.0;
+    // Share of wall time between the last two samples
+    float mainThreadPercent = 0.0f;
+    float scriptPercent = 0.0f;
+    float layoutPercent = 0.0f;         // Layout and style recalculation
+    float averageMainThreadPercent = 0.0f; // Smoothed over the last few samples
+    std::chrono::steady_clock::time_point sampleTime;
+};
+
+// The overlay process's CPU cycles spent by one ThreadSubsystem, over the last sample period
+struct SubsystemCpu {
+    float megacyclesPerSecond = 0.0f;
+    float sharePercent = 0.0f; // Of the process's cycles
+    float cpuPercent = 0.0f;   // That share of GetCpuUsagePercent
+    UINT threads = 0;          // Registered and running (scopes on other threads don't count)
+};
+
+// The overlay's share of the machine's power (PowerSampler): the CPU package by the process
+// tree's share of busy CPU time, the GPUs by its share of 3D engine time. Estimates: idle and
+// uncore power belong to nobody and get split the same way.
+struct OverlayPower {
+    bool valid = false;
+    PowerSample system;
+    float packageWatts = 0.0f; // The package without its integrated GPU
+    float gpuWatts = 0.0f;     // Integrated and discrete
+};
+
+// Metrics kept as history for the graphs (see MetricSeries)
+enum class Metric {
+    FrameTimeMs,        // Every frame
+    FramesPerSecond,    // Every frame, averaged over the last 60
+    CpuPercent,         // Every 10 frames
+    GpuPercent,         // Same
+    MemoryMB,           // Same, GetTotalMemoryUsageMB
+    FrameLatencyWaitMs, // Every frame that waited on the swap chain
+    FrameWorkMs,        // Every frame, waits excluded (FrameTimeBreakdown::workMs)
+    Count
+};
+
+// Where the render thread blocked between two presents (reported by the render loop)
+enum class FrameWait {
+    Throttle,     // Frame timer, spin and idle waits: the overlay chose not to draw yet
+    GpuWait,      // A frame slot the GPU hadn't released
+    PresentBlock, // Inside Present and on the swap chain waitable object
+    Count
+};
+
+// One present-to-present interval split by FrameWait; work is whatever wasn't a wait
+struct FrameTimeBreakdown {
+    float wallMs = 0.0f;
+    float workMs = 0.0f;
+    float throttleMs = 0.0f;
+    float gpuWaitMs = 0.0f;
+    float presentMs = 0.0f;
+};
+
+const char* GetMetricName(Metric metric);
 
 class PerformanceMonitor {
 public:
     PerformanceMonitor();
-    ~PerformanceMonitor() = default;
+    ~PerformanceMonitor() = default; // Stops the GPU sampler
 
     // Disable copy and move
     PerformanceMonitor(const PerformanceMonitor&) = delete;
@@ -26,48 +273,300 @@ public:
     void EndFrame();
 
     // Get performance metrics
-    float GetFrameTime() const { return m_lastFrameTime; }
-    float GetFramesPerSecond() const { return m_framesPerSecond; }
+    float GetFrameTime() const { return m_lastFrameTime; } // Seconds, present to present
+    float GetFramesPerSecond() const { return m_framesPerSecond; } // Presents per second, idle included
+    // Blocked time between BeginFrame and EndFrame, any number of calls per frame
+    void AddFrameWaitTime(FrameWait wait, float ms) { m_frameWaitMs[static_cast<size_t>(wait)] += ms; }
+    const FrameTimeBreakdown& GetFrameTimeBreakdown() const { return m_frameTimeBreakdown; }
+    const FrameTimeBreakdown& GetAverageFrameTimeBreakdown() const { return m_averageFrameTimeBreakdown; }
+    // Frame time distribution (every frame since startup; p50-p99.9 and max per window)
+    const FrameTimeHistogram& GetFrameTimeHistogram() const { return m_frameTimeHistogram; }
+    FrameTimePercentiles GetFrameTimePercentiles(FrameTimeWindow window) const { return m_frameTimeHistogram.GetPercentiles(window); }
+    // CPU work per frame, so throttled and idle frames don't read as slow ones
+    const FrameTimeHistogram& GetWorkTimeHistogram() const { return m_workTimeHistogram; }
+    // Work times over a multiple of the rolling median work time, with a snapshot of the moments before each
+    HitchDetector& GetHitchDetector() { return m_hitchDetector; }
 
     // System resource usage
     float GetCpuUsage() const { return m_cpuUsage; }
     size_t GetMemoryUsage() const { return m_memoryUsage; }
     float GetCpuUsagePercent() const { return m_cpuUsage * 100.0f; }
+    // Split of the above by subsystem, updated about once a second
+    const std::array<SubsystemCpu, static_cast<size_t>(ThreadSubsystem::Count)>& GetSubsystemCpu() const { return m_subsystemCpu; }
     float GetMemoryUsageMB() const { return static_cast<float>(m_memoryUsage) / (1024.0f * 1024.0f); }
+    // This process and its CEF subprocesses, per process type (refreshed once a second)
+    ProcessTreeMemory GetProcessTreeMemory() const { return m_processTree->GetMemory(); }
+    const ProcessTreeMonitor& GetProcessTree() const { return *m_processTree; }
+    ProcessTreeMonitor& GetProcessTree() { return *m_processTree; }
+    // The process tree is refreshed once a second with the system metrics, unless a worker
+    // thread takes it over; it then calls UpdateProcessTree on its own schedule
+    void SetProcessTreeUpdatedInBackground(bool background) { m_processTreeInBackground = background; }
+    void UpdateProcessTree() { m_processTree->Update(); } // Any thread
+    // What the memory threshold is checked against: private bytes of the whole process tree plus
+    // the tree's dedicated GPU memory; this process's working set while the tree is unavailable
+    float GetTotalMemoryUsageMB() const;
+    // This process's busiest GPU engine (PDH counters, sampled in the background); estimated from
+    // the overlay's GPU frame time while the counters are unavailable
     float GetGpuUsage() const { return m_gpuUsage; }
     float GetGpuUsagePercent() const { return m_gpuUsage * 100.0f; }
+    bool IsGpuUsageMeasured() const { return m_gpuSample.valid; }
+    const GpuUsageSample& GetGpuUsageSample() const { return m_gpuSample; } // Per engine type, memory
+    GpuUsageSampler* GetGpuUsageSampler() const { return m_gpuSampler.get(); }
+
+    // The foreground game's own frame rate (ETW present events; invalid without permission or
+    // while no game presents)
+    const GamePresentSample& GetGamePresentSample() const { return m_gameSample; }
+    // Any thread; false without ETW or while the game isn't presenting
+    bool GetGamePresentPhase(GamePresentPhase& phase) const {
+        return m_presentSampler && m_presentSampler->GetPresentPhase(phase);
+    }
+    bool IsGameFrameRateAvailable() const { return m_presentSampler && m_presentSampler->IsAvailable(); }
+    // Game frame time above its recent baseline by more than percent
+    bool IsGameFrameTimeDegraded(float percent) const;
+    // A game presents while other processes keep the 3D engine at least percent busy
+    bool IsGameGpuBound(float percent) const;
+
+    // Game frame time while it is GPU-bound, split by whether the overlay had yielded its GPU
+    // priority (both reported by the optimizer) - the difference is what yielding saves the game
+    void RecordGpuPriorityYield(bool gameGpuBound, bool yielded) {
+        m_gameGpuBound = gameGpuBound;
+        m_gpuPriorityYielded = yielded;
+    }
+    bool GetGpuBoundGameFrameMs(bool yielded, float& avgFrameMs) const;
+
+    // GPU timings measured with timestamp queries (resolved a few frames late)
+    void RecordGpuFrameTime(float gpuFrameMs);
+    void RecordGpuPassTime(GpuPass pass, float gpuMs);
+    float GetGpuFrameTimeMs() const { return m_gpuFrameTimeMs; }
+    float GetGpuPassTimeMs(GpuPass pass) const { return m_gpuPassTimesMs[static_cast<size_t>(pass)]; }
+
+    // Swap chain frame latency wait (reported by the render loop)
+    void RecordFrameLatencyWait(float waitMs);
+    float GetFrameLatencyWaitMs() const { return m_frameLatencyWaitMs; }
+
+    // Area handed to DWM by the last Present1 (dirty rects)
+    void RecordPresentedArea(UINT64 presentedPixels, UINT64 totalPixels);
+    UINT64 GetPresentedPixels() const { return m_presentedPixels; }
+    float GetPresentedAreaPercent() const { return m_presentedAreaPercent; }
+
+    // Display side of presentation (reported by the render loop after each present)
+    void RecordDisplayStatistics(const DisplayStatistics& stats);
+    const DisplayStatistics& GetDisplayStatistics() const { return m_displayStatistics; }
+    // Falls back to the loop rate when the swap chain reports no statistics
+    float GetDisplayedFramesPerSecond() const {
+        return m_displayStatistics.valid ? m_displayStatistics.displayedFramesPerSecond : m_framesPerSecond;
+    }
+
+    // Input-to-photon samples in the display statistics go to the results of the configuration
+    // current when they arrive; results are in the order the configurations were first used
+    void SetInputLatencyConfiguration(const InputLatencyConfiguration& configuration);
+    const std::vector<std::unique_ptr<InputLatencyResults>>& GetInputLatencyResults() const { return m_inputLatencyResults; }
+    const InputLatencyResults* GetCurrentInputLatencyResults() const;
+
+    // Swap chain presentation path (reported by the render loop)
+    void RecordPresentationMode(PresentationMode mode, bool overlaySupported);
+    PresentationMode GetPresentationMode() const { return m_presentationMode; }
+    bool IsOverlayPlaneSupported() const { return m_overlayPlaneSupported; }
+
+    // Overlay cost under each browser GPU policy, sampled with the system metrics while the
+    // browser runs. CPU is this process only; Chromium's GPU process is not included.
+    void RecordBrowserGpuPolicy(BrowserGpuPolicy policy) { m_browserGpuPolicy = policy; m_browserGpuPolicyKnown = true; }
+    void RecordBrowserUploadPath(BrowserUploadPath path) { m_browserUploadPath = path; m_browserUploadPathKnown = true; }
+    bool GetBrowserUploadPath(BrowserUploadPath& path) const { path = m_browserUploadPath; return m_browserUploadPathKnown; }
+    bool GetBrowserGpuPolicy(BrowserGpuPolicy& policy) const { policy = m_browserGpuPolicy; return m_browserGpuPolicyKnown; }
+    bool GetBrowserGpuPolicyCost(BrowserGpuPolicy policy, float& avgCpuPercent, float& avgGpuFrameMs) const;
+
+    // Overlay watts, refreshed about once a second; false without Energy Meter counters or NVML
+    bool IsPowerMeasured() const { return m_powerSampler && m_powerSampler->IsAvailable(); }
+    const OverlayPower& GetOverlayPower() const { return m_overlayPower; }
+    // Mean overlay watts while in each PerformanceState, and under each preset the settings page
+    // applied (its own index; -1 once the settings were edited by hand)
+    static constexpr size_t POWER_COST_SLOTS = 4;
+    void RecordPowerPreset(int preset) { m_powerPreset = preset; }
+    bool GetStatePowerCost(uint32_t performanceState, float& packageWatts, float& gpuWatts) const;
+    bool GetPresetPowerCost(int preset, float& packageWatts, float& gpuWatts) const;
+
+    // Optimizer side, for the shared telemetry block (state is a PerformanceState)
+    void RecordOptimizerState(uint32_t performanceState, float renderScale) {
+        m_performanceState = performanceState;
+        m_renderScale = renderScale;
+    }
+    bool IsTelemetryPublished() const { return m_sharedTelemetry && m_sharedTelemetry->IsAvailable(); }
+
+    // Cumulative software paint bytes (BrowserView::GetUploadedBytes), for the report's MB/s
+    void RecordBrowserUploadedBytes(UINT64 totalBytes) { m_browserUploadedBytes = totalBytes; }
+    void RecordBrowserTileStats(const BrowserTileStats& stats) { m_browserTileStats = stats; }
+    UINT64 GetBrowserUploadedBytes() const { return m_browserUploadedBytes; }
+    const BrowserTileStats& GetBrowserTileStats() const { return m_browserTileStats; }
+    // Paint counters; the overwritten share is over windows of PAINT_STATS_WINDOW. With the
+    // paint-to-photon latency (DisplayStatistics) it shows how well CEF's paint cadence matches ours.
+    void RecordBrowserPaintStats(const BrowserPaintStats& stats);
+    const BrowserPaintStats& GetBrowserPaintStats() const { return m_browserPaintStats; }
+    float GetOverwrittenPaintPercent() const { return m_overwrittenPaintPercent; }
+    // Time given to CEF, once per frame (BrowserManager::TakePumpFrame)
+    void RecordCefPumpFrame(const CefPumpFrame& frame);
+    const CefPumpStats& GetCefPumpStats() const { return m_cefPumpStats; }
+
+    // Navigations finished by the browser (BrowserManager::TakeNavigationTimings). Each is added to
+    // its domain's stats once the process tree has been sampled after it ended, with the renderer
+    // CPU time between the samples around it: that covers every renderer, so loads in other tabs
+    // at the same time are counted too.
+    void RecordNavigation(const NavigationTiming& timing);
+    const std::vector<DomainLoadStats>& GetDomainLoadStats() const { return m_domainLoadStats; } // Slowest mean load first
+    UINT64 GetNavigationCount() const { return m_navigationCount; }
+
+    // Renderer-side metrics of every live browser (BrowserManager::GetPageMetrics), so a heavy page
+    // can be told apart from a heavy overlay; a snapshot, replaced whenever a browser reports
+    void RecordPageMetrics(std::shared_ptr<const std::vector<PageMetrics>> metrics) {
+        if (metrics) m_pageMetrics = std::move(metrics);
+    }
+    const std::vector<PageMetrics>& GetPageMetrics() const { return *m_pageMetrics; }
+    const PageMetrics* FindPageMetrics(int tabId) const;
+
+    // Session summary as JSON (frame time percentiles, GPU pass means, CPU, memory, upload rate,
+    // hitches), for comparing builds on the same scripted run; see --perf-report in main.cpp
+    bool WritePerformanceReport(const std::string& path) const;
+
+    // Startup milestones in ms since WinMain (0 = not reached yet)
+    void RecordTimeToFirstFrame(float ms) { m_timeToFirstFrameMs = ms; }
+    void RecordTimeToFirstBrowserPaint(float ms) { m_timeToFirstBrowserPaintMs = ms; }
+    float GetTimeToFirstFrameMs() const { return m_timeToFirstFrameMs; }
+    float GetTimeToFirstBrowserPaintMs() const { return m_timeToFirstBrowserPaintMs; }
+    // Asked for by the performance page or --bench-text-emission, run by the main loop between frames
+    void RequestTextEmissionBenchmark() { m_textEmissionBenchmarkRequested = true; }
+    bool TakeTextEmissionBenchmarkRequest() { return m_textEmissionBenchmarkRequested.exchange(false); }
+    void RecordTextEmissionBenchmark(const TextEmissionBenchmark& result) { m_textEmissionBenchmark = result; }
+    const TextEmissionBenchmark& GetTextEmissionBenchmark() const { return m_textEmissionBenchmark; }
+    // Startup phases (StartupGraph in main.cpp), in the report's "startupPhases"
+    struct StartupPhase {
+        std::string name;
+        float startMs = 0.0f;
+        float durationMs = 0.0f;
+    };
+    void RecordStartupPhase(const std::string& name, float startMs, float durationMs) {
+        m_startupPhases.push_back({ name, startMs, durationMs });
+    }
+    const std::vector<StartupPhase>& GetStartupPhases() const { return m_startupPhases; }
+    // Show from resident to the first presented frame (PerformanceOptimizer::TakeWakeLatencyMs)
+    void RecordWakeLatency(float ms) {
+        m_lastWakeLatencyMs = ms;
+        m_maxWakeLatencyMs = std::max(m_maxWakeLatencyMs, ms);
+        m_wakeCount++;
+    }
+    float GetLastWakeLatencyMs() const { return m_lastWakeLatencyMs; }
+    float GetMaxWakeLatencyMs() const { return m_maxWakeLatencyMs; }
+    UINT64 GetWakeCount() const { return m_wakeCount; }
+    // Main loop heap allocations (AllocationTracker::EndFrame); zero unless tracking is built in
+    void RecordFrameAllocations(const AllocationCounters& frame) {
+        m_lastFrameAllocations = frame;
+        m_maxFrameAllocations = std::max(m_maxFrameAllocations, frame.allocations);
+    }
+    // A frame that should not have allocated (idle or browser repaint, past warm-up) did;
+    // zone is the one that allocated most, or null without zone attribution
+    void RecordSteadyStateAllocation(const AllocationCounters& frame, const char* zone) {
+        m_steadyStateAllocatingFrames++;
+        if (frame.allocations > m_worstSteadyStateAllocations.allocations) {
+            m_worstSteadyStateAllocations = frame;
+            m_worstSteadyStateZone = zone ? zone : "";
+        }
+    }
+    void RecordSteadyStateFrame() { m_steadyStateFrames++; }
+    const AllocationCounters& GetLastFrameAllocations() const { return m_lastFrameAllocations; }
+    uint64_t GetMaxFrameAllocations() const { return m_maxFrameAllocations; }
+    UINT64 GetSteadyStateFrames() const { return m_steadyStateFrames; }
+    UINT64 GetSteadyStateAllocatingFrames() const { return m_steadyStateAllocatingFrames; }
 
     // Performance thresholds check
     bool IsCpuThresholdExceeded(float thresholdPercent) const;
     bool IsMemoryThresholdExceeded(float thresholdMB) const;
     bool IsGpuThresholdExceeded(float thresholdPercent) const;
 
-    // Performance history
-    const float* GetFrameTimeHistory() const { return m_frameTimeBuffer.data(); }
-    const float* GetCpuUsageHistory() const { return m_cpuUsageBuffer.data(); }
-    const float* GetMemoryUsageHistory() const { return m_memoryUsageBuffer.data(); }
-    size_t GetHistoryBufferSize() const { return FRAME_TIME_BUFFER_SIZE; }
+    // Performance history, the one copy every graph reads
+    const MetricSeries& GetMetricSeries(Metric metric) const { return m_metrics[static_cast<size_t>(metric)]; }
 
 private:
     void UpdateSystemMetrics();
+    void SampleThreadCycles();
+    void SamplePower();
     void UpdateGpuMetrics();
+    void PublishTelemetry();
+    void RecordHitch();
+    void AddMetric(Metric metric, float value);
+    void SampleRendererCpu();
+    void AddNavigation(const NavigationTiming& timing, float rendererCpuMs);
 
     // Frame timing
     std::chrono::high_resolution_clock::time_point m_frameStart;
     float m_lastFrameTime = 0.0f;
     float m_framesPerSecond = 0.0f;
+    float m_frameLatencyWaitMs = 0.0f; // Time blocked on the swap chain waitable object
+    std::array<float, static_cast<size_t>(FrameWait::Count)> m_frameWaitMs = {}; // Since BeginFrame
+    FrameTimeBreakdown m_frameTimeBreakdown;
+    FrameTimeBreakdown m_averageFrameTimeBreakdown; // Exponentially smoothed, for display
+    UINT64 m_presentedPixels = 0;
+    float m_presentedAreaPercent = 100.0f;
+    PresentationMode m_presentationMode = PresentationMode::Unknown;
+    bool m_overlayPlaneSupported = false;
+    DisplayStatistics m_displayStatistics;
+    InputLatencyConfiguration m_inputLatencyConfiguration;
+    std::vector<std::unique_ptr<InputLatencyResults>> m_inputLatencyResults; // A histogram is ~30 KB
+    size_t m_currentInputLatencyResults = SIZE_MAX; // Index into the above; none until a sample arrives
+    float m_timeToFirstFrameMs = 0.0f;
+    std::atomic<bool> m_textEmissionBenchmarkRequested{ false }; // Set from the UI thread with a pipelined UI
+    TextEmissionBenchmark m_textEmissionBenchmark;
+    float m_timeToFirstBrowserPaintMs = 0.0f;
+    std::vector<StartupPhase> m_startupPhases;
+    float m_lastWakeLatencyMs = 0.0f;
+    float m_maxWakeLatencyMs = 0.0f;
+    UINT64 m_wakeCount = 0;
+    AllocationCounters m_lastFrameAllocations;
+    uint64_t m_maxFrameAllocations = 0;
+    UINT64 m_steadyStateFrames = 0;
+    UINT64 m_steadyStateAllocatingFrames = 0;
+    AllocationCounters m_worstSteadyStateAllocations;
+    std::string m_worstSteadyStateZone;
 
     // FPS calculation
     static constexpr size_t FRAME_TIME_BUFFER_SIZE = 60;
     std::array<float, FRAME_TIME_BUFFER_SIZE> m_frameTimeBuffer = {};
-    std::array<float, FRAME_TIME_BUFFER_SIZE> m_cpuUsageBuffer = {};
-    std::array<float, FRAME_TIME_BUFFER_SIZE> m_memoryUsageBuffer = {};
     size_t m_frameTimeBufferIndex = 0;
+    double m_frameTimeSum = 0.0; // Running sum and count of the non-zero entries of m_frameTimeBuffer
+    int m_frameTimeCount = 0;
+    FrameTimeHistogram m_frameTimeHistogram;
+    FrameTimeHistogram m_workTimeHistogram;
+    HitchDetector m_hitchDetector;
+    std::array<MetricSeries, static_cast<size_t>(Metric::Count)> m_metrics;
+    std::chrono::steady_clock::time_point m_metricEpoch = std::chrono::steady_clock::now();
 
     // System resources
     float m_cpuUsage = 0.0f;
+    std::array<SubsystemCpu, static_cast<size_t>(ThreadSubsystem::Count)> m_subsystemCpu = {};
+    ThreadCycles::Totals m_lastThreadCycles = {};
+    std::chrono::steady_clock::time_point m_lastThreadCycleSample;
     size_t m_memoryUsage = 0;
     float m_gpuUsage = 0.0f; // GPU usage (0.0-1.0)
+    std::unique_ptr<GpuUsageSampler> m_gpuSampler;
+    GpuUsageSample m_gpuSample; // Latest copy, refreshed with the system metrics
+    std::unique_ptr<PresentEventSampler> m_presentSampler;
+    GamePresentSample m_gameSample; // Same
+    std::unique_ptr<ProcessTreeMonitor> m_processTree;
+    std::chrono::steady_clock::time_point m_lastProcessTreeUpdate;
+    std::atomic<bool> m_processTreeInBackground = false;
+    std::vector<DWORD> m_gpuTrackedProcesses; // Last list handed to the GPU sampler
+
+    // Navigation timing
+    struct CpuSample {
+        std::chrono::steady_clock::time_point time;
+        UINT64 cpuTime = 0; // 100 ns units
+    };
+    static constexpr size_t MAX_RENDERER_CPU_SAMPLES = 120; // A couple of minutes at one a second
+    static constexpr size_t MAX_PENDING_NAVIGATIONS = 32;
+    static constexpr size_t MAX_TRACKED_DOMAINS = 64;       // The least loaded one makes room
+    std::deque<CpuSample> m_rendererCpuSamples;
+    std::deque<NavigationTiming> m_pendingNavigations;      // Waiting for a sample after their end
+    std::vector<DomainLoadStats> m_domainLoadStats;
+    UINT64 m_navigationCount = 0;
+    std::shared_ptr<const std::vector<PageMetrics>> m_pageMetrics = std::make_shared<const std::vector<PageMetrics>>();
 
     // Windows performance counters
     HANDLE m_processHandle = nullptr;
@@ -76,7 +575,68 @@ private:
     ULARGE_INTEGER m_lastUserCPU = {};
     int m_numProcessors = 0;
 
-    // GPU metrics tracking (simplified)
-    uint64_t m_gpuQueryLastTime = 0;
-    uint64_t m_gpuQueryFrequency = 0;
+    // GPU timestamp results
+    float m_gpuFrameTimeMs = 0.0f;
+    std::array<float, static_cast<size_t>(GpuPass::Count)> m_gpuPassTimesMs = {};
+
+    // Per browser GPU policy cost accumulators
+    struct PolicyCost {
+        UINT64 samples = 0;
+        double cpuSum = 0.0;   // Fraction of all cores
+        double gpuMsSum = 0.0; // Overlay GPU frame time
+    };
+    std::array<PolicyCost, static_cast<size_t>(BrowserGpuPolicy::Count)> m_browserGpuPolicyCosts = {};
+    BrowserGpuPolicy m_browserGpuPolicy = BrowserGpuPolicy::Full;
+    bool m_browserGpuPolicyKnown = false;
+    BrowserUploadPath m_browserUploadPath = BrowserUploadPath::UploadRing;
+    bool m_browserUploadPathKnown = false;
+
+    // Overlay power, per PerformanceState and per settings preset
+    struct PowerCost {
+        UINT64 samples = 0;
+        double packageWattsSum = 0.0;
+        double gpuWattsSum = 0.0;
+    };
+    std::unique_ptr<PowerSampler> m_powerSampler;
+    OverlayPower m_overlayPower;
+    UINT64 m_lastPowerCpuTime = 0; // Process tree, 100 ns units
+    std::chrono::steady_clock::time_point m_lastPowerCpuSample;
+    std::array<PowerCost, POWER_COST_SLOTS> m_statePowerCosts = {};
+    std::array<PowerCost, POWER_COST_SLOTS> m_presetPowerCosts = {};
+    int m_powerPreset = -1;
+
+    // Game frame time while GPU-bound, [0] at normal priority, [1] yielded
+    struct GameFrameCost {
+        UINT64 samples = 0;
+        double frameMsSum = 0.0;
+    };
+    std::array<GameFrameCost, 2> m_gpuBoundGameFrameCosts = {};
+    bool m_gameGpuBound = false;
+    bool m_gpuPriorityYielded = false;
+
+    // Session totals for the report
+    struct SessionTotals {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        UINT64 gpuFrameSamples = 0;
+        double gpuFrameMsSum = 0.0;
+        std::array<double, static_cast<size_t>(GpuPass::Count)> gpuPassMsSums = {};
+        UINT64 cpuSamples = 0;
+        double cpuSum = 0.0;
+        float peakMemoryMB = 0.0f;
+    };
+    SessionTotals m_session;
+    UINT64 m_browserUploadedBytes = 0;
+    static constexpr auto PAINT_STATS_WINDOW = std::chrono::seconds(1);
+    BrowserPaintStats m_browserPaintStats;
+    CefPumpStats m_cefPumpStats;
+    BrowserPaintStats m_paintWindowStart;
+    std::chrono::steady_clock::time_point m_paintWindowStartTime;
+    float m_overwrittenPaintPercent = 0.0f;
+    BrowserTileStats m_browserTileStats;
+
+    // Shared memory export, rewritten every frame
+    std::unique_ptr<SharedTelemetry> m_sharedTelemetry;
+    uint64_t m_frameIndex = 0;
+    uint32_t m_performanceState = 0;
+    float m_renderScale = 1.0f;
 };
\ No newline at end of file
@@ -1,165 +1,1361 @@
-void PerformanceMonitor::UpdateGpuMetrics() {
-    // This is a simplified placeholder implementation for GPU metrics
-    // In a real implementation, you would use platform-specific APIs to get GPU usage
-    // such as NVIDIA NVAPI, AMD ADL, or general purpose APIs like DirectX's IDXGIAdapter3
+// GameOverlay - PerformanceOptimizer.cpp
+// Phase 5: Performance Optimization
+// Centralized performance optimization management
 
-    // Simulated GPU usage that trends towards CPU usage (since we don't have actual GPU metrics)
-    static float targetGpuUsage = 0.0f;
-    static float gpuChangeRate = 0.1f;
+#include "PerformanceOptimizer.h"
+#include "WindowManager.h"
+#include "RenderSystem.h"
+#include "ResourceManager.h"
+#include "BrowserView.h"
+#include "TextureLoader.h"
+#include "ThreadPolicy.h"
+#include "ThreadCycles.h"
+#include "PerformanceMonitor.h"
+#include "PolicyTrace.h"
+#include "CpuProfiler.h"
+#include "Log.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <climits>
+#include <iterator>
+#include <dwmapi.h>
+
+#pragma comment(lib, "dwmapi.lib")
 
-    // Update target occasionally to simulate fluctuations
-    if (rand() % 10 == 0) {
-        // Random target between 0.1 and CPU usage + 0.2
-        targetGpuUsage = 0.1f + (static_cast<float>(rand()) / RAND_MAX) * (m_cpuUsage + 0.2f);
-        targetGpuUsage = std::min(targetGpuUsage, 1.0f); // Cap at 100%
+PerformanceOptimizer* PerformanceOptimizer::s_foregroundInstance = nullptr;
+
+PerformanceOptimizer::PerformanceOptimizer(WindowManager* windowManager,
+    RenderSystem* renderSystem,
+    BrowserView* browserView,
+    PerformanceMonitor* performanceMonitor)
+    : m_windowManager(windowManager),
+    m_renderSystem(renderSystem),
+    m_browserView(browserView),
+    m_performanceMonitor(performanceMonitor) {
+
+    m_softwareRendering = renderSystem && renderSystem->IsUsingWarpAdapter();
+    if (m_softwareRendering) {
+        LOG_WARNING("Rendering on WARP (no usable GPU): software rendering profile active");
     }
 
-    // Gradually move towards target
-    if (m_gpuUsage < targetGpuUsage) {
-        m_gpuUsage += gpuChangeRate;
-        if (m_gpuUsage > targetGpuUsage) m_gpuUsage = targetGpuUsage;
+    auto now = std::chrono::steady_clock::now();
+    m_lastFrameTime = now;
+    m_frameDeadline = now;
+    m_limiterWindowStart = now;
+    m_lastActivityTime = now;
+    m_lastMemoryCleanupTime = now;
+    m_nextIdleCheck = now;
+    m_nextThresholdCheck = now;
+    m_pendingStateSince = now;
+
+    // Synchronization timer, fires once per arm. High resolution timers (Windows 10 1803+) wake
+    // within a fraction of a millisecond without raising the system timer resolution.
+    m_frameTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    m_highResolutionTimer = m_frameTimer != nullptr;
+    if (!m_frameTimer) {
+        m_frameTimer = CreateWaitableTimerW(nullptr, FALSE, nullptr);
+        m_spinMargin = LEGACY_TIMER_SPIN_MARGIN;
     }
-    else if (m_gpuUsage > targetGpuUsage) {
-        m_gpuUsage -= gpuChangeRate;
-        if (m_gpuUsage < targetGpuUsage) m_gpuUsage = targetGpuUsage;
+    if (!m_frameTimer) {
+        OutputDebugStringA("Warning: Failed to create frame limiter timer, falling back to sleeps.\n");
     }
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    m_qpcFrequency = frequency.QuadPart;
 }
 
-bool PerformanceMonitor::IsCpuThresholdExceeded(float thresholdPercent) const {
-    return (m_cpuUsage * 100.0f) > thresholdPercent;
+PerformanceOptimizer::~PerformanceOptimizer() {
+    StopBackgroundTasks();
+
+    if (m_foregroundHook) {
+        UnhookWinEvent(m_foregroundHook);
+        m_foregroundHook = nullptr;
+    }
+    if (s_foregroundInstance == this) s_foregroundInstance = nullptr;
+    for (HPOWERNOTIFY notification : m_powerNotifications) {
+        UnregisterPowerSettingNotification(notification);
+    }
+    m_powerNotifications.clear();
+    if (m_windowManager) m_windowManager->SetStateChangedCallback(nullptr);
+    CpuProfiler::SetEnabled(CpuProfilerClient::ComponentBudget, false);
+
+    if (m_frameTimer) {
+        CloseHandle(m_frameTimer);
+        m_frameTimer = nullptr;
+    }
 }
 
-bool PerformanceMonitor::IsMemoryThresholdExceeded(float thresholdMB) const {
-    return GetMemoryUsageMB() > thresholdMB;
+void PerformanceOptimizer::Initialize() {
+    SetTargetFrameRate(m_config.maxActiveFrameRate);
+
+    // State inputs that arrive as events
+    if (m_windowManager) {
+        m_windowManager->SetStateChangedCallback([this]() { NotifyWindowStateChanged(); });
+    }
+    DWORD foregroundProcessId = 0;
+    if (HWND foreground = GetForegroundWindow()) {
+        GetWindowThreadProcessId(foreground, &foregroundProcessId);
+        m_overlayForeground = foregroundProcessId == GetCurrentProcessId();
+    }
+
+    // Profiles apply on the first UpdateState, like every later foreground change
+    m_gameProfiles.Load();
+    if (foregroundProcessId != 0 && !m_overlayForeground) {
+        m_foregroundGame = GameProfileStore::GetExecutableName(foregroundProcessId);
+        m_foregroundGameChanged = !m_foregroundGame.empty();
+    }
+    s_foregroundInstance = this;
+    m_foregroundHook = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, nullptr,
+        &PerformanceOptimizer::ForegroundEventProc, 0, 0, WINEVENT_OUTOFCONTEXT);
+    if (!m_foregroundHook) {
+        OutputDebugStringA("Warning: Failed to hook foreground changes, relying on WM_ACTIVATEAPP.\n");
+    }
+
+    // Power source; each registration also delivers the current value
+    SYSTEM_POWER_STATUS powerStatus = {};
+    if (GetSystemPowerStatus(&powerStatus)) {
+        m_onBattery = powerStatus.ACLineStatus == 0;
+        m_batterySaver = powerStatus.SystemStatusFlag != 0;
+    }
+    if (HWND hwnd = m_windowManager ? m_windowManager->GetHWND() : nullptr) {
+        for (const GUID* setting : { &GUID_ACDC_POWER_SOURCE, &GUID_POWER_SAVING_STATUS, &GUID_POWERSCHEME_PERSONALITY }) {
+            if (HPOWERNOTIFY notification = RegisterPowerSettingNotification(hwnd, setting, DEVICE_NOTIFY_WINDOW_HANDLE)) {
+                m_powerNotifications.push_back(notification);
+            }
+        }
+    }
+    m_stateInputsChanged = true;
+
+    RegisterDefaultComponents();
+
+    // Apply initial optimizations for the current state
+    ApplyOptimizations();
+
+    // Start background task thread
+    ScheduleBackgroundTasks();
 }
 
-bool PerformanceMonitor::IsGpuThresholdExceeded(float thresholdPercent) const {
-    return (m_gpuUsage * 100.0f) > thresholdPercent;
-}// GameOverlay - PerformanceMonitor.cpp
-// Phase 1: Foundation Framework
-// Performance monitoring and metrics collection
+void PerformanceOptimizer::UpdateState() {
+    if (m_suspended) return;
 
-#include "PerformanceMonitor.h"
-#include <psapi.h>
-#include <algorithm>
-#include <numeric>
+    auto now = std::chrono::steady_clock::now();
+
+    bool evaluate = m_stateInputsChanged.exchange(false);
+    if (m_foregroundGameChanged) {
+        m_foregroundGameChanged = false;
+        ApplyGameProfile(m_gameProfiles.Find(m_foregroundGame));
+    }
+    if (now >= m_nextIdleCheck) {
+        bool wasIdle = m_isIdle;
+        UpdateIdle(now);
+        evaluate |= m_isIdle != wasIdle;
+    }
+    // CPU, memory and game frame time have no events; sample them on an interval
+    if (now >= m_nextThresholdCheck) {
+        m_nextThresholdCheck = now + THRESHOLD_CHECK_INTERVAL;
+        evaluate = true;
+        UpdateGpuYield(now);
+        UpdateComponentBudget(now);
+        UnloadHeavyPages();
+        ApplySubprocessPolicy(m_currentState); // Config may have changed
+    }
+    auto demotionDelay = std::chrono::milliseconds(m_config.stateDemotionDelayMs);
+    if (m_pendingState != m_currentState && now - m_pendingStateSince >= demotionDelay) {
+        evaluate = true;
+    }
+
+    bool stateChanged = false;
+    if (evaluate) {
+        PerformanceState current = m_currentState;
+        StateInputs inputs = GatherStateInputs();
+        PerformanceState desired = SelectState(inputs, m_config, now, m_gameBackOffUntil);
+        if (desired != m_pendingState) {
+            m_pendingState = desired;
+            m_pendingStateSince = now;
+        }
+
+        if (desired != current && (IsImmediateTransition(current, desired) || now - m_pendingStateSince >= demotionDelay)) {
+            SetState(desired);
+            stateChanged = true;
+        }
+        if (m_policyRecorder) {
+            RecordPolicySample(inputs);
+        }
+        // Hidden while already Background (minimized first) leaves the state as it is
+        if (!stateChanged && !m_resident && m_windowManager && !m_windowManager->IsVisible()) {
+            EnterResident();
+        }
+    }
+    if (!stateChanged) {
+        // Config may have changed (e.g. settings page)
+        CalculateFrameDelay();
+        ApplyPresentationSettings();
+        if (m_config.adaptiveResolution != m_adaptiveResolutionApplied) {
+            OptimizeRenderSystem(m_currentState);
+            ApplyAdaptiveResolution();
+        }
+    }
+    UpdateAdaptiveResolution(now);
+
+    // Periodic memory cleanup (main thread, resource manager waits on the GPU)
+    if (m_config.aggressiveMemoryCleanup) {
+        auto sinceCleanup = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastMemoryCleanupTime);
+        if (sinceCleanup.count() >= static_cast<long long>(m_config.memoryCleanupIntervalMs)) {
+            OptimizeMemoryUsage(m_currentState);
+            m_lastMemoryCleanupTime = now;
+        }
+    }
+}
+
+void PerformanceOptimizer::NotifyApplicationActive(bool active) {
+    m_applicationActive = active;
+    if (active) m_overlayForeground = true;
+    m_stateInputsChanged = true;
+}
+
+void PerformanceOptimizer::NotifyWindowStateChanged() {
+    m_stateInputsChanged = true;
+    if (m_resident && m_windowManager && m_windowManager->IsVisible()) {
+        m_resident = false;
+        m_waking = true;
+        m_wakeStart = std::chrono::steady_clock::now();
+    }
+}
+
+void PerformanceOptimizer::EnterResident() {
+    m_resident = true;
+    m_waking = false;
+    PROFILE_EVENT("Resident");
+    TrimFootprint(m_currentState);
+}
+
+float PerformanceOptimizer::TakeWakeLatencyMs() {
+    if (!m_waking) return -1.0f;
+    m_waking = false;
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_wakeStart).count();
+}
+
+void PerformanceOptimizer::NotifyPowerSettingChange(const POWERBROADCAST_SETTING* setting) {
+    if (!setting) return;
+
+    if (IsEqualGUID(setting->PowerSetting, GUID_ACDC_POWER_SOURCE) && setting->DataLength >= sizeof(DWORD)) {
+        DWORD source = *reinterpret_cast<const DWORD*>(setting->Data); // PoAc, PoDc, PoHot (UPS)
+        m_onBattery = source != 0;
+    }
+    else if (IsEqualGUID(setting->PowerSetting, GUID_POWER_SAVING_STATUS) && setting->DataLength >= sizeof(DWORD)) {
+        m_batterySaver = *reinterpret_cast<const DWORD*>(setting->Data) != 0;
+    }
+    else if (IsEqualGUID(setting->PowerSetting, GUID_POWERSCHEME_PERSONALITY) && setting->DataLength >= sizeof(GUID)) {
+        m_powerSaverScheme = IsEqualGUID(*reinterpret_cast<const GUID*>(setting->Data), GUID_MAX_POWER_SAVINGS) != FALSE;
+    }
+    else {
+        return;
+    }
+    m_stateInputsChanged = true;
+}
+
+void CALLBACK PerformanceOptimizer::ForegroundEventProc(HWINEVENTHOOK, DWORD, HWND hwnd,
+    LONG idObject, LONG, DWORD, DWORD) {
+    // Out of context: delivered to the installing (main) thread while it pumps messages
+    PerformanceOptimizer* self = s_foregroundInstance;
+    if (!self || idObject != OBJID_WINDOW || !hwnd) return;
+
+    DWORD processId = 0;
+    GetWindowThreadProcessId(hwnd, &processId);
+    bool overlayForeground = processId == GetCurrentProcessId();
+    if (overlayForeground != self->m_overlayForeground) {
+        self->m_overlayForeground = overlayForeground;
+        self->m_stateInputsChanged = true;
+    }
+
+    // Focus moving to the overlay keeps the game underneath (and its profile)
+    if (!overlayForeground) {
+        self->m_foregroundWindow = hwnd;
+        std::string executable = GameProfileStore::GetExecutableName(processId);
+        if (!executable.empty() && executable != self->m_foregroundGame) {
+            self->m_foregroundGame = std::move(executable);
+            self->m_foregroundGameChanged = true;
+        }
+    }
+}
+
+HWND PerformanceOptimizer::GetDetectedGameWindow() const {
+    HWND window = m_foregroundWindow;
+    if (!window || !IsWindow(window)) return nullptr;
+    if (m_gameProfiles.Find(m_foregroundGame)) return window;
+
+    DWORD processId = 0;
+    GetWindowThreadProcessId(window, &processId);
+    const GamePresentSample* game = m_performanceMonitor ? &m_performanceMonitor->GetGamePresentSample() : nullptr;
+    if (!game || !game->valid || game->processId != processId) return nullptr;
+
+    RECT bounds = {};
+    MONITORINFO monitor = { sizeof(monitor) };
+    if (!GetWindowRect(window, &bounds) ||
+        !GetMonitorInfoW(MonitorFromWindow(window, MONITOR_DEFAULTTONEAREST), &monitor)) {
+        return nullptr;
+    }
+    const RECT& screen = monitor.rcMonitor;
+    bool coversMonitor = bounds.left <= screen.left && bounds.top <= screen.top &&
+        bounds.right >= screen.right && bounds.bottom >= screen.bottom;
+    return coversMonitor ? window : nullptr;
+}
+
+GameProfile PerformanceOptimizer::CaptureGameProfile(const std::string& executable) const {
+    GameProfile profile;
+    profile.executable = executable;
+    profile.maxActiveFrameRate = m_config.maxActiveFrameRate;
+    profile.maxInactiveFrameRate = m_config.maxInactiveFrameRate;
+    profile.maxBackgroundFrameRate = m_config.maxBackgroundFrameRate;
+    profile.maxRenderScale = m_config.adaptiveResolutionMaxScale;
+    profile.overlayFrameBudgetMs = m_config.overlayFrameBudgetMs;
+    profile.gpuYieldPolicy = static_cast<int>(m_config.gpuYieldPolicy);
+    std::copy(std::begin(m_config.browserGpuPolicy), std::end(m_config.browserGpuPolicy), profile.browserGpuPolicy);
+    if (m_gameProfileActive) {
+        std::copy(std::begin(m_activeGameProfile.panelsAllowed), std::end(m_activeGameProfile.panelsAllowed),
+            profile.panelsAllowed);
+    }
+    return profile;
+}
+
+void PerformanceOptimizer::ReapplyGameProfile() {
+    ApplyGameProfile(m_gameProfiles.Find(m_foregroundGame));
+}
+
+bool PerformanceOptimizer::IsPanelAllowed(OverlayPanel panel) const {
+    if (!m_gameProfileActive || m_currentState == PerformanceState::Active) return true;
+    return m_activeGameProfile.panelsAllowed[static_cast<size_t>(panel)];
+}
 
-PerformanceMonitor::PerformanceMonitor() {
-    // Initialize process handle for performance monitoring
-    m_processHandle = GetCurrentProcess();
+void PerformanceOptimizer::ApplyGameProfile(const GameProfile* profile) {
+    if (!profile && !m_gameProfileActive) return;
 
-    // Get system timing info for CPU usage calculation
-    FILETIME createTime, exitTime, kernelTime, userTime;
-    if (GetProcessTimes(m_processHandle, &createTime, &exitTime, &kernelTime, &userTime)) {
-        m_lastCPU.LowPart = kernelTime.dwLowDateTime;
-        m_lastCPU.HighPart = kernelTime.dwHighDateTime;
-        m_lastUserCPU.LowPart = userTime.dwLowDateTime;
-        m_lastUserCPU.HighPart = userTime.dwHighDateTime;
+    // Fields always come from the config before the first profile, so going from one profiled
+    // game to another never leaves the first one's values behind
+    if (!m_gameProfileActive) {
+        m_configBeforeProfile = m_config;
     }
+    const Config& base = m_configBeforeProfile;
+    if (profile) {
+        m_config.maxActiveFrameRate = profile->maxActiveFrameRate;
+        m_config.maxInactiveFrameRate = profile->maxInactiveFrameRate;
+        m_config.maxBackgroundFrameRate = profile->maxBackgroundFrameRate;
+        m_config.adaptiveResolutionMaxScale = profile->maxRenderScale;
+        m_config.overlayFrameBudgetMs = profile->overlayFrameBudgetMs;
+        m_config.gpuYieldPolicy = static_cast<GpuYieldPolicy>(profile->gpuYieldPolicy);
+        std::copy(std::begin(profile->browserGpuPolicy), std::end(profile->browserGpuPolicy), m_config.browserGpuPolicy);
+        m_activeGameProfile = *profile;
+        PROFILE_EVENT("Game Profile Applied");
+    }
+    else {
+        m_config.maxActiveFrameRate = base.maxActiveFrameRate;
+        m_config.maxInactiveFrameRate = base.maxInactiveFrameRate;
+        m_config.maxBackgroundFrameRate = base.maxBackgroundFrameRate;
+        m_config.adaptiveResolutionMaxScale = base.adaptiveResolutionMaxScale;
+        m_config.overlayFrameBudgetMs = base.overlayFrameBudgetMs;
+        m_config.gpuYieldPolicy = base.gpuYieldPolicy;
+        std::copy(std::begin(base.browserGpuPolicy), std::end(base.browserGpuPolicy), m_config.browserGpuPolicy);
+        PROFILE_EVENT("Game Profile Cleared");
+    }
+    m_gameProfileActive = profile != nullptr;
+    m_configGeneration++;
+
+    SetTargetFrameRate(m_config.maxActiveFrameRate);
+    ApplyOptimizations();
+}
+
+void PerformanceOptimizer::UpdateIdle(std::chrono::steady_clock::time_point now) {
+    LASTINPUTINFO lastInput = {};
+    lastInput.cbSize = sizeof(LASTINPUTINFO);
+    if (!GetLastInputInfo(&lastInput)) {
+        m_isIdle = false;
+        m_nextIdleCheck = now + IDLE_POLL_INTERVAL;
+        return;
+    }
+
+    // While active, nothing can make the user idle before the timeout since the last input;
+    // while idle, any input ends it, so poll
+    DWORD idleMs = GetTickCount() - lastInput.dwTime;
+    m_isIdle = idleMs > m_config.idleTimeoutMs;
+    if (m_isIdle) {
+        m_nextIdleCheck = now + IDLE_POLL_INTERVAL;
+    }
+    else {
+        m_lastActivityTime = now - std::chrono::milliseconds(idleMs);
+        m_nextIdleCheck = now + std::chrono::milliseconds(m_config.idleTimeoutMs - idleMs + 1);
+    }
+}
+
+PerformanceOptimizer::StateInputs PerformanceOptimizer::GatherStateInputs() const {
+    StateInputs inputs;
+    if (m_windowManager) {
+        inputs.hasWindow = true;
+        inputs.visible = m_windowManager->IsVisible() && !m_windowManager->IsMinimized();
+        inputs.focused = m_windowManager->IsActive() && m_applicationActive && m_overlayForeground;
+    }
+    inputs.idle = m_isIdle;
+    if (m_performanceMonitor) {
+        inputs.hasMonitor = true;
+        inputs.cpuPercent = m_performanceMonitor->GetCpuUsagePercent();
+        inputs.memoryMB = m_performanceMonitor->GetTotalMemoryUsageMB();
+        const GamePresentSample& game = m_performanceMonitor->GetGamePresentSample();
+        inputs.gameValid = game.valid;
+        inputs.gameFrameMs = game.averageFrameMs;
+        inputs.gameBaselineFrameMs = game.baselineFrameMs;
+    }
+    inputs.onBattery = m_onBattery;
+    inputs.powerSaving = IsPowerSaving();
+    return inputs;
+}
+
+PerformanceState PerformanceOptimizer::SelectState(const StateInputs& inputs, const Config& config,
+    std::chrono::steady_clock::time_point now, std::chrono::steady_clock::time_point& gameBackOffUntil) {
+    // Determine state from window state
+    PerformanceState newState = PerformanceState::Active;
+    if (inputs.hasWindow) {
+        if (!inputs.visible) {
+            newState = PerformanceState::Background;
+        }
+        else if (!inputs.focused || inputs.idle) {
+            newState = PerformanceState::Inactive;
+        }
+    }
+
+    // Drop to low power when resource thresholds are exceeded in non-active states
+    if (inputs.hasMonitor && newState != PerformanceState::Active) {
+        // Same test as PerformanceMonitor::IsGameFrameTimeDegraded
+        bool gameDegraded = inputs.gameValid && inputs.gameBaselineFrameMs > 0.0f &&
+            inputs.gameFrameMs > inputs.gameBaselineFrameMs * (1.0f + config.gameFrameTimeDegradationPercent / 100.0f);
+        if (config.backOffWhenGameSlows && gameDegraded) {
+            gameBackOffUntil = now + std::chrono::milliseconds(config.gameBackOffHoldMs);
+        }
+        if (inputs.cpuPercent > config.cpuThresholdPercent || inputs.memoryMB > config.memoryThresholdMB ||
+            now < gameBackOffUntil) {
+            newState = PerformanceState::LowPower;
+        }
+    }
+
+    // Power source
+    bool powerSaving = config.lowPowerWhenPowerSaving && inputs.powerSaving;
+    bool onBattery = config.lowPowerOnBattery && inputs.onBattery && newState != PerformanceState::Active;
+    if (powerSaving || onBattery) {
+        newState = PerformanceState::LowPower;
+    }
+    return newState;
+}
+
+bool PerformanceOptimizer::IsImmediateTransition(PerformanceState current, PerformanceState desired) {
+    return desired == PerformanceState::Active ||
+        desired == PerformanceState::Background || current == PerformanceState::Background;
+}
+
+float PerformanceOptimizer::GetStateFrameRateCap(PerformanceState state, const Config& config) {
+    switch (state) {
+    case PerformanceState::Active:
+        return config.maxActiveFrameRate;
+    case PerformanceState::Inactive:
+        return config.reduceInactiveQuality ? config.maxInactiveFrameRate : config.maxActiveFrameRate;
+    case PerformanceState::Background:
+    case PerformanceState::LowPower:
+        return config.enableBackgroundThrottling ? config.maxBackgroundFrameRate : config.maxInactiveFrameRate;
+    }
+    return config.maxActiveFrameRate;
+}
+
+void PerformanceOptimizer::StartPolicyRecording(const std::string& path) {
+    auto recorder = std::make_unique<PolicyTraceRecorder>();
+    if (!recorder->Start(path, m_config)) {
+        LOG_WARNING("Failed to start policy recording: %s", path);
+        return;
+    }
+    LOG_INFO("Recording optimizer inputs to %s", path);
+    m_policyRecorder = std::move(recorder);
+}
+
+void PerformanceOptimizer::RecordPolicySample(const StateInputs& inputs) {
+    PolicyTraceSample sample;
+    sample.inputs = inputs;
+    sample.state = m_currentState;
+    DWORD idleMs = 0;
+    LASTINPUTINFO lastInput = {};
+    lastInput.cbSize = sizeof(LASTINPUTINFO);
+    if (GetLastInputInfo(&lastInput)) {
+        idleMs = GetTickCount() - lastInput.dwTime;
+    }
+    sample.idleMs = idleMs;
+    if (m_performanceMonitor) {
+        FrameTimePercentiles frameTimes = m_performanceMonitor->GetFrameTimePercentiles(FrameTimeWindow::OneSecond);
+        sample.overlayFramesPerSecond = m_performanceMonitor->GetFramesPerSecond();
+        sample.frameP50Ms = frameTimes.p50Ms;
+        sample.frameP99Ms = frameTimes.p99Ms;
+        sample.workMs = m_performanceMonitor->GetAverageFrameTimeBreakdown().workMs;
+        sample.gpuFrameMs = m_performanceMonitor->GetGpuFrameTimeMs();
+        for (size_t i = 0; i < static_cast<size_t>(GpuPass::Count); i++) {
+            sample.gpuPassMs[i] = m_performanceMonitor->GetGpuPassTimeMs(static_cast<GpuPass>(i));
+        }
+    }
+    sample.componentCostMs = m_componentCostMs;
+    m_policyRecorder->Record(sample);
+}
+
+void PerformanceOptimizer::SetState(PerformanceState state) {
+    PerformanceState previous = m_currentState;
+    m_currentState = state;
+    switch (state) {
+    case PerformanceState::Active: PROFILE_EVENT("State: Active"); break;
+    case PerformanceState::Inactive: PROFILE_EVENT("State: Inactive"); break;
+    case PerformanceState::Background: PROFILE_EVENT("State: Background"); break;
+    case PerformanceState::LowPower: PROFILE_EVENT("State: Low Power"); break;
+    }
+    ApplyOptimizations();
+
+    // After the browser was told it is hidden and suspended, so its texture can go too
+    bool unused = state == PerformanceState::Background || state == PerformanceState::LowPower;
+    if (!m_resident && m_windowManager && !m_windowManager->IsVisible()) {
+        EnterResident();
+    }
+    else if (m_config.aggressiveMemoryCleanup && unused && state != previous) {
+        TrimFootprint(state);
+    }
+}
+
+void PerformanceOptimizer::ApplyPowerThrottling(PerformanceState state) {
+    bool eco = m_config.ecoQoSWhenNotActive && state != PerformanceState::Active;
+    if (eco == m_processEcoQoS) return;
+
+    // The render thread follows the process explicitly, so its setting never lingers from an
+    // earlier state; worker threads stay EcoQoS throughout (ConfigureWorkerThread)
+    if (SetProcessEcoQoS(eco)) {
+        SetThreadEcoQoS(GetCurrentThread(), eco);
+        m_processEcoQoS = eco;
+    }
+}
+
+void PerformanceOptimizer::ApplySubprocessPolicy(PerformanceState state) {
+    if (!m_performanceMonitor) return;
+
+    switch (state) {
+    case PerformanceState::Active:
+        m_performanceMonitor->GetProcessTree().SetSubprocessPolicy(m_config.activeSubprocessPolicy);
+        break;
+    case PerformanceState::Inactive:
+        m_performanceMonitor->GetProcessTree().SetSubprocessPolicy(m_config.inactiveSubprocessPolicy);
+        break;
+    case PerformanceState::Background:
+    case PerformanceState::LowPower:
+        m_performanceMonitor->GetProcessTree().SetSubprocessPolicy(m_config.backgroundSubprocessPolicy);
+        break;
+    }
+}
+
+void PerformanceOptimizer::Suspend() {
+    m_suspended = true;
+    ApplyGpuYield(false);
+    StopBackgroundTasks();
+}
+
+void PerformanceOptimizer::Resume() {
+    m_suspended = false;
+
+    // Reset timing so the first frame isn't throttled against a stale timestamp
+    m_lastFrameTime = std::chrono::steady_clock::now();
+    m_stateInputsChanged = true; // Events may have been missed while suspended
+
+    OptimizeMemoryUsage(m_currentState);
+    ApplyOptimizations();
+    ScheduleBackgroundTasks();
+}
+
+void PerformanceOptimizer::ThrottleFrame() {
+    while (!IsFrameDue() && !SpinUntilFrameDue()) {
+        if (HANDLE timer = ArmFrameTimer()) {
+            WaitForSingleObject(timer, INFINITE);
+        }
+        else {
+            std::this_thread::sleep_for(std::max(std::chrono::duration_cast<std::chrono::microseconds>(
+                m_frameDeadline - MAX_SPIN_MARGIN - std::chrono::steady_clock::now()), std::chrono::microseconds(0)));
+        }
+    }
+
+    MarkFrameStart();
+}
+
+bool PerformanceOptimizer::IsFrameDue() const {
+    return std::chrono::steady_clock::now() >= m_frameDeadline;
+}
+
+bool PerformanceOptimizer::SpinUntilFrameDue() {
+    auto now = std::chrono::steady_clock::now();
+    m_limiterWaited = true;
+
+    // How late the timer woke, as a moving average; the spin covers it next time
+    if (m_timerArmed) {
+        m_timerArmed = false;
+        double lateUs = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(now - m_timerTarget).count());
+        m_timerLatenessUs += (std::max(lateUs, 0.0) - m_timerLatenessUs) * 0.1;
+        if (m_highResolutionTimer) {
+            auto margin = std::chrono::microseconds(static_cast<long long>(m_timerLatenessUs * 1.5) + 100);
+            m_spinMargin = std::clamp(margin, MIN_SPIN_MARGIN, MAX_SPIN_MARGIN);
+        }
+    }
+
+    if (m_frameDeadline - now > std::min(m_spinMargin, MAX_SPIN_MARGIN)) return false;
+
+    // Yielding keeps the core available to other threads at the same priority
+    while (std::chrono::steady_clock::now() < m_frameDeadline) {
+        YieldProcessor();
+        SwitchToThread();
+    }
+    return true;
+}
+
+HANDLE PerformanceOptimizer::ArmFrameTimer() {
+    if (!m_frameTimer) return nullptr;
+    m_limiterWaited = true;
+
+    // Early by the spin margin; SpinUntilFrameDue finishes the wait
+    m_timerTarget = m_frameDeadline - m_spinMargin;
+    auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(m_timerTarget - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0) return nullptr; // Between the timer's margin and the spin
+
+    // Negative due time is relative, in 100 ns units
+    LARGE_INTEGER dueTime = {};
+    dueTime.QuadPart = -remaining.count() * 10;
+    if (!SetWaitableTimer(m_frameTimer, &dueTime, 0, nullptr, nullptr, FALSE)) {
+        return nullptr;
+    }
+
+    m_timerArmed = true;
+    return m_frameTimer;
+}
 
-    SYSTEM_INFO sysInfo;
-    GetSystemInfo(&sysInfo);
-    m_numProcessors = sysInfo.dwNumberOfProcessors;
+void PerformanceOptimizer::MarkFrameStart() {
+    auto now = std::chrono::steady_clock::now();
 
-    // Initialize frame time buffer
-    std::fill(m_frameTimeBuffer.begin(), m_frameTimeBuffer.end(), 0.0f);
+    // Accuracy of frames the limiter held back (others started late for reasons of their own)
+    if (m_limiterWaited) {
+        float errorMs = std::chrono::duration<float, std::milli>(now - m_frameDeadline).count();
+        float intervalMs = std::chrono::duration<float, std::milli>(now - m_lastFrameTime).count();
+        float targetMs = std::chrono::duration<float, std::milli>(m_targetFrameTime).count();
+        m_limiterWindow.frames++;
+        m_limiterWindow.errorSumMs += std::abs(errorMs);
+        m_limiterWindow.maxOvershootMs = std::max(m_limiterWindow.maxOvershootMs, errorMs);
+        m_limiterWindow.maxUndershootMs = std::max(m_limiterWindow.maxUndershootMs, targetMs - intervalMs);
+        if (std::abs(errorMs) <= FRAME_LIMITER_TOLERANCE_MS) {
+            m_limiterWindow.withinTolerance++;
+        }
+        // Phase as it happened: the start against the latest game present (or vblank) known now
+        int64_t anchorQpc = 0;
+        double anchorIntervalMs = 0.0;
+        bool fromGame = false;
+        if (m_deadlinePhaseLocked && GetPhaseAnchor(anchorQpc, anchorIntervalMs, fromGame)) {
+            LARGE_INTEGER qpcNow;
+            QueryPerformanceCounter(&qpcNow);
+            double phaseMs = std::fmod(static_cast<double>(qpcNow.QuadPart - anchorQpc) * 1000.0 / m_qpcFrequency,
+                anchorIntervalMs);
+            if (phaseMs < 0.0) phaseMs += anchorIntervalMs;
+            m_limiterWindow.phaseLockedFrames++;
+            m_limiterWindow.phaseSumMs += phaseMs;
+        }
+        m_limiterWaited = false;
+    }
+    if (now - m_limiterWindowStart >= std::chrono::seconds(1)) {
+        FrameLimiterStats stats;
+        stats.valid = m_limiterWindow.frames > 0;
+        stats.frames = m_limiterWindow.frames;
+        if (stats.valid) {
+            stats.meanErrorMs = static_cast<float>(m_limiterWindow.errorSumMs / m_limiterWindow.frames);
+            stats.maxOvershootMs = std::max(m_limiterWindow.maxOvershootMs, 0.0f);
+            stats.maxUndershootMs = std::max(m_limiterWindow.maxUndershootMs, 0.0f);
+            stats.withinToleranceRatio = static_cast<float>(m_limiterWindow.withinTolerance) / m_limiterWindow.frames;
+        }
+        stats.spinMarginMs = std::chrono::duration<float, std::milli>(m_spinMargin).count();
+        stats.highResolutionTimer = m_highResolutionTimer;
+        stats.phaseLockedFrames = m_limiterWindow.phaseLockedFrames;
+        stats.phaseFromGamePresents = m_limiterWindow.phaseFromGamePresents;
+        if (stats.phaseLockedFrames > 0) {
+            stats.meanPhaseMs = static_cast<float>(m_limiterWindow.phaseSumMs / stats.phaseLockedFrames);
+        }
+        m_limiterStats = stats;
+        m_limiterWindow = LimiterWindow();
+        m_limiterWindowStart = now;
+    }
+
+    // Deadlines advance by the interval, so a slightly late frame doesn't delay the rest;
+    // after a stall (more than a whole interval behind) the schedule restarts from now
+    m_frameDeadline += m_targetFrameTime;
+    if (m_frameDeadline <= now) {
+        m_frameDeadline = now + m_targetFrameTime;
+    }
+    m_deadlinePhaseLocked = false;
+    if (m_config.phaseLockToGame) {
+        AlignFrameDeadlineToGame(now);
+    }
+    m_lastFrameTime = now;
 }
 
-void PerformanceMonitor::BeginFrame() {
-    // Record frame start time
-    m_frameStart = std::chrono::high_resolution_clock::now();
+bool PerformanceOptimizer::GetPhaseAnchor(int64_t& anchorQpc, double& intervalMs, bool& fromGame) const {
+    // The game's cadence: its own presents when ETW sees them, else the compositor's vblank
+    GamePresentPhase phase;
+    fromGame = false;
+    if (m_performanceMonitor && m_performanceMonitor->GetGamePresentPhase(phase)) {
+        anchorQpc = phase.lastPresentQpc;
+        intervalMs = phase.intervalMs;
+        fromGame = true;
+    }
+    else {
+        DWM_TIMING_INFO timing = {};
+        timing.cbSize = sizeof(timing);
+        if (FAILED(DwmGetCompositionTimingInfo(nullptr, &timing)) || timing.qpcRefreshPeriod == 0) return false;
+        anchorQpc = static_cast<int64_t>(timing.qpcVBlank);
+        intervalMs = static_cast<double>(timing.qpcRefreshPeriod) * 1000.0 / m_qpcFrequency;
+    }
+    return intervalMs >= MIN_PHASE_INTERVAL_MS && intervalMs <= MAX_PHASE_INTERVAL_MS;
 }
 
-void PerformanceMonitor::EndFrame() {
-    // Calculate frame time
-    auto frameEnd = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(frameEnd - m_frameStart);
-    m_lastFrameTime = duration.count() / 1000000.0f; // Convert to seconds
+void PerformanceOptimizer::AlignFrameDeadlineToGame(std::chrono::steady_clock::time_point now) {
+    int64_t anchorQpc = 0;
+    double intervalMs = 0.0;
+    bool fromGame = false;
+    if (!GetPhaseAnchor(anchorQpc, intervalMs, fromGame)) return;
 
-    // Add to the circular buffer
-    m_frameTimeBuffer[m_frameTimeBufferIndex] = m_lastFrameTime;
+    // steady_clock and QPC tick together; the anchor in steady_clock terms, relative to now
+    LARGE_INTEGER qpcNow;
+    QueryPerformanceCounter(&qpcNow);
+    double anchorMs = static_cast<double>(anchorQpc - qpcNow.QuadPart) * 1000.0 / m_qpcFrequency;
+    double deadlineMs = std::chrono::duration<double, std::milli>(m_frameDeadline - now).count();
 
-    // Update system metrics periodically (every 10 frames)
-    static int frameCounter = 0;
-    if (++frameCounter >= 10) {
-        UpdateSystemMetrics();
-        UpdateGpuMetrics();
+    // The game slot nearest the limiter's deadline keeps the average rate; never one already past
+    double offsetMs = m_config.phaseLockOffsetMs;
+    double slot = std::round((deadlineMs - anchorMs - offsetMs) / intervalMs);
+    double slotMs = anchorMs + offsetMs + slot * intervalMs;
+    while (slotMs <= 0.0) {
+        slotMs += intervalMs;
+    }
+
+    m_frameDeadline = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(slotMs));
+    m_deadlinePhaseLocked = true;
+    m_limiterWindow.phaseFromGamePresents = fromGame;
+}
+
+void PerformanceOptimizer::SetTargetFrameRate(float fps) {
+    fps = std::max(1.0f, std::min(fps, 1000.0f));
+    m_targetFrameRate = fps;
+    CalculateFrameDelay();
+}
 
-        // Store in circular buffers
-        m_cpuUsageBuffer[m_frameTimeBufferIndex] = m_cpuUsage;
-        m_memoryUsageBuffer[m_frameTimeBufferIndex] = GetMemoryUsageMB();
+float PerformanceOptimizer::GetTargetFrameRate() const {
+    return m_targetFrameRate;
+}
 
-        frameCounter = 0;
+void PerformanceOptimizer::SetResourceUsageLevel(ResourceUsageLevel level) {
+    if (m_resourceUsageLevel != level) {
+        m_resourceUsageLevel = level;
+        ApplyOptimizations();
     }
+}
 
-    // Update buffer index
-    m_frameTimeBufferIndex = (m_frameTimeBufferIndex + 1) % FRAME_TIME_BUFFER_SIZE;
+ResourceUsageLevel PerformanceOptimizer::GetResourceUsageLevel() const {
+    return m_resourceUsageLevel;
+}
 
-    // Calculate average FPS over the buffer period
-    float totalFrameTime = std::accumulate(m_frameTimeBuffer.begin(), m_frameTimeBuffer.end(), 0.0f);
-    if (totalFrameTime > 0.0f) {
-        // Count valid (non-zero) frame times
-        int validFrames = std::count_if(m_frameTimeBuffer.begin(), m_frameTimeBuffer.end(),
-            [](float t) { return t > 0.0f; });
+PerformanceState PerformanceOptimizer::GetPerformanceState() const {
+    return m_currentState;
+}
 
-        if (validFrames > 0) {
-            m_framesPerSecond = static_cast<float>(validFrames) / totalFrameTime;
+BrowserGpuPolicy PerformanceOptimizer::GetBrowserGpuPolicy() const {
+    if (m_softwareRendering) return BrowserGpuPolicy::Software; // Chromium's GPU would be SwiftShader
+    return m_config.browserGpuPolicy[static_cast<size_t>(m_currentState.load())];
+}
+
+void PerformanceOptimizer::RegisterComponent(const std::string& name, ComponentDesc desc) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Component component;
+    component.desc = std::move(desc);
+    m_registeredComponents[name] = std::move(component);
+}
+
+void PerformanceOptimizer::RegisterComponent(const std::string& name, OptimizationCallback callback) {
+    ComponentDesc desc;
+    desc.priority = INT_MAX; // Never degraded anyway
+    desc.onStateChanged = std::move(callback);
+    RegisterComponent(name, std::move(desc));
+}
+
+void PerformanceOptimizer::UnregisterComponent(const std::string& name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_registeredComponents.erase(name);
+}
+
+std::vector<PerformanceOptimizer::ComponentStatus> PerformanceOptimizer::GetComponentStatus() const {
+    std::vector<ComponentStatus> status;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& [name, component] : m_registeredComponents) {
+            ComponentStatus entry;
+            entry.name = name;
+            entry.priority = component.desc.priority;
+            entry.cpuMs = component.cpuMs;
+            entry.gpuMs = component.gpuMs;
+            entry.budgetMs = component.desc.budgetMs;
+            entry.degradeLevel = component.degradeLevel;
+            entry.maxDegradeLevel = component.desc.maxDegradeLevel;
+            status.push_back(std::move(entry));
         }
     }
+    std::stable_sort(status.begin(), status.end(),
+        [](const ComponentStatus& a, const ComponentStatus& b) { return a.priority < b.priority; });
+    return status;
 }
 
-void PerformanceMonitor::UpdateSystemMetrics() {
-    // Update CPU usage
-    FILETIME createTime, exitTime, kernelTime, userTime;
-    if (GetProcessTimes(m_processHandle, &createTime, &exitTime, &kernelTime, &userTime)) {
-        ULARGE_INTEGER now;
-        ULARGE_INTEGER nowUser;
+void PerformanceOptimizer::RegisterDefaultComponents() {
+    // Perf graphs (priority 0) register from the performance page
+    if (m_browserView) {
+        ComponentDesc browser;
+        browser.priority = 10;
+        browser.cpuZones = { "Browser Update", "CEF Paint" };
+        browser.gpuPasses = 1u << static_cast<uint32_t>(GpuPass::BrowserCopy);
+        browser.maxDegradeLevel = static_cast<int>(std::size(BUDGET_PAINT_RATES));
+        browser.onDegradeLevelChanged = [this](int level) {
+            m_browserView->SetPaintFrameRateLimit(level > 0 ? BUDGET_PAINT_RATES[level - 1] : 0);
+        };
+        RegisterComponent("Browser", std::move(browser));
+    }
+
+    // Render scale only changes GPU time
+    if (m_renderSystem) {
+        ComponentDesc render;
+        render.priority = 20;
+        render.gpuPasses = (1u << static_cast<uint32_t>(GpuPass::Clear)) |
+            (1u << static_cast<uint32_t>(GpuPass::ImGui)) | (1u << static_cast<uint32_t>(GpuPass::Upscale));
+        render.maxDegradeLevel = static_cast<int>(std::size(BUDGET_RENDER_SCALES));
+        render.onDegradeLevelChanged = [this](int level) {
+            m_budgetRenderScaleLimit = level > 0 ? BUDGET_RENDER_SCALES[level - 1] : 1.0f;
+            ApplyRenderScale(m_config.adaptiveResolution ? m_resolutionController.GetScale() : 1.0f);
+        };
+        RegisterComponent("Render Scale", std::move(render));
+    }
+}
 
-        now.LowPart = kernelTime.dwLowDateTime;
-        now.HighPart = kernelTime.dwHighDateTime;
+void PerformanceOptimizer::MeasureComponentCosts(bool profilerRecorded) {
+    // Caller holds m_mutex. Zones are clipped to the last complete main-thread frame; zones on
+    // other threads (CEF paints) count where they overlap it. A zone inside another of the same
+    // component is already counted by its parent. Without a recorded frame CPU costs keep their
+    // last sample.
+    bool profiled = profilerRecorded && CpuProfiler::CaptureLastFrame(m_componentProfile);
+    const CpuProfileFrame& frame = m_componentProfile;
 
-        nowUser.LowPart = userTime.dwLowDateTime;
-        nowUser.HighPart = userTime.dwHighDateTime;
+    float totalMs = 0.0f;
+    for (auto& [name, component] : m_registeredComponents) {
+        int64_t cpuTicks = 0;
+        if (profiled && !component.desc.cpuZones.empty()) {
+            for (const CpuProfileThread& thread : frame.threads) {
+                int64_t coveredUntil = INT64_MIN;
+                for (const CpuProfileZoneRecord& zone : thread.zones) {
+                    if (zone.type != CpuProfileRecordType::Zone || !zone.name || zone.beginTicks < coveredUntil) continue;
+                    bool matches = std::any_of(component.desc.cpuZones.begin(), component.desc.cpuZones.end(),
+                        [&zone](const char* cpuZone) { return strcmp(zone.name, cpuZone) == 0; });
+                    if (!matches) continue;
+                    int64_t begin = std::max(zone.beginTicks, frame.beginTicks);
+                    int64_t end = std::min(zone.endTicks, frame.endTicks);
+                    if (end > begin) cpuTicks += end - begin;
+                    coveredUntil = zone.endTicks;
+                }
+            }
+        }
+        if (profiled && frame.ticksPerMs > 0.0) {
+            float cpuMs = static_cast<float>(cpuTicks / frame.ticksPerMs);
+            component.cpuMs += (cpuMs - component.cpuMs) * COMPONENT_COST_SMOOTHING;
+        }
 
-        // Calculate CPU usage
-        ULARGE_INTEGER sys, user;
-        sys.QuadPart = now.QuadPart - m_lastCPU.QuadPart;
-        user.QuadPart = nowUser.QuadPart - m_lastUserCPU.QuadPart;
+        float gpuMs = 0.0f;
+        if (m_renderSystem) {
+            for (uint32_t pass = 0; pass < static_cast<uint32_t>(GpuPass::Count); pass++) {
+                if (component.desc.gpuPasses & (1u << pass)) {
+                    gpuMs += m_renderSystem->GetGpuPassTimeMs(static_cast<GpuPass>(pass));
+                }
+            }
+        }
 
-        // Calculate CPU usage as a fraction of available CPU time
-        FILETIME idleTime, kernelTime2, userTime2;
-        if (GetSystemTimes(&idleTime, &kernelTime2, &userTime2)) {
-            ULARGE_INTEGER kT, uT;
-            kT.LowPart = kernelTime2.dwLowDateTime;
-            kT.HighPart = kernelTime2.dwHighDateTime;
-            uT.LowPart = userTime2.dwLowDateTime;
-            uT.HighPart = userTime2.dwHighDateTime;
+        component.gpuMs += (gpuMs - component.gpuMs) * COMPONENT_COST_SMOOTHING;
+        totalMs += component.cpuMs + component.gpuMs;
+    }
+    m_componentCostMs = totalMs;
+}
 
-            // Total process CPU time
-            double processCpuTime = static_cast<double>(sys.QuadPart + user.QuadPart);
+void PerformanceOptimizer::UpdateComponentBudget(std::chrono::steady_clock::time_point now) {
+    const float budgetMs = m_config.overlayFrameBudgetMs;
+    const bool enabled = budgetMs > 0.0f;
 
-            // Total system CPU time (all processors)
-            double systemCpuTime = static_cast<double>(kT.QuadPart + uT.QuadPart);
+    // The profiler records only for a sample every COMPONENT_SAMPLE_INTERVAL, one check long, unless
+    // the timeline or a capture has it on anyway
+    const bool profilerRecorded = CpuProfiler::IsEnabled();
+    if (m_componentSampling) {
+        m_componentSampling = false;
+        m_nextComponentSample = now + COMPONENT_SAMPLE_INTERVAL;
+        CpuProfiler::SetEnabled(CpuProfilerClient::ComponentBudget, false);
+    }
+    else if (enabled && CpuProfiler::IsCompiledIn() && !profilerRecorded && now >= m_nextComponentSample) {
+        m_componentSampling = true;
+        CpuProfiler::SetEnabled(CpuProfilerClient::ComponentBudget, true);
+    }
 
-            // Calculate usage (accounting for multiple processors)
-            if (systemCpuTime > 0) {
-                m_cpuUsage = static_cast<float>(processCpuTime / systemCpuTime);
+    // Callbacks run after the lock is released (they may resize the browser or the render target)
+    std::vector<std::pair<std::function<void(int)>, int>> changes;
+    auto setLevel = [&changes](Component& component, int level) {
+        component.degradeLevel = level;
+        if (component.desc.onDegradeLevelChanged) {
+            changes.emplace_back(component.desc.onDegradeLevelChanged, level);
+        }
+    };
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!enabled) {
+            for (auto& [name, component] : m_registeredComponents) {
+                component.costBeforeStep.clear();
+                if (component.degradeLevel != 0) setLevel(component, 0);
             }
+            m_componentCostMs = 0.0f;
         }
         else {
-            // Fallback calculation if GetSystemTimes fails
-            m_cpuUsage = static_cast<float>((sys.QuadPart + user.QuadPart) /
-                (100.0 * m_numProcessors)); // Scale appropriately
+            MeasureComponentCosts(profilerRecorded);
+        }
+
+        const float totalMs = m_componentCostMs;
+        if (enabled && now - m_lastDegradeStep >= DEGRADE_STEP_INTERVAL) {
+            // A component over its own budget first, then the lowest priority one while over the
+            // total; components costing next to nothing have nothing to give
+            Component* degrade = nullptr;
+            bool degradeOverOwn = false;
+            for (auto& [name, component] : m_registeredComponents) {
+                float costMs = component.cpuMs + component.gpuMs;
+                if (component.degradeLevel >= component.desc.maxDegradeLevel || costMs < MIN_DEGRADE_COST_MS) continue;
+                bool overOwn = component.desc.budgetMs > 0.0f && costMs > component.desc.budgetMs;
+                if (!overOwn && totalMs <= budgetMs) continue;
+                if (!degrade || (overOwn && !degradeOverOwn) ||
+                    (overOwn == degradeOverOwn && component.desc.priority < degrade->desc.priority)) {
+                    degrade = &component;
+                    degradeOverOwn = overOwn;
+                }
+            }
+
+            if (degrade) {
+                degrade->costBeforeStep.push_back(degrade->cpuMs + degrade->gpuMs);
+                setLevel(*degrade, degrade->degradeLevel + 1);
+                m_lastDegradeStep = now;
+                m_underBudget = false;
+            }
+            else if (totalMs < budgetMs * RECOVER_BUDGET_FRACTION) {
+                if (!m_underBudget) {
+                    m_underBudget = true;
+                    m_underBudgetSince = now;
+                }
+                else if (now - m_underBudgetSince >= RECOVER_HOLD) {
+                    // Highest priority first, if the step's cost still fits once it is back
+                    Component* recover = nullptr;
+                    for (auto& [name, component] : m_registeredComponents) {
+                        if (component.degradeLevel == 0 || component.costBeforeStep.empty()) continue;
+                        float restoredMs = component.costBeforeStep.back();
+                        float projectedMs = totalMs - (component.cpuMs + component.gpuMs) + restoredMs;
+                        bool fitsOwn = component.desc.budgetMs <= 0.0f || restoredMs <= component.desc.budgetMs;
+                        if (projectedMs >= budgetMs * RECOVER_BUDGET_FRACTION || !fitsOwn) continue;
+                        if (!recover || component.desc.priority > recover->desc.priority) {
+                            recover = &component;
+                        }
+                    }
+                    if (recover) {
+                        recover->costBeforeStep.pop_back();
+                        setLevel(*recover, recover->degradeLevel - 1);
+                        m_lastDegradeStep = now;
+                        m_underBudgetSince = now; // One step per hold
+                    }
+                }
+            }
+            else {
+                m_underBudget = false;
+            }
+        }
+    }
+
+    for (const auto& [callback, level] : changes) {
+        callback(level);
+    }
+}
+
+void PerformanceOptimizer::OptimizeRenderSystem(PerformanceState state) {
+    if (!m_renderSystem) return;
+
+    m_renderSystem->AdaptToPerformanceState(state, m_resourceUsageLevel);
+    m_stateRenderScale = m_renderSystem->GetRenderScale();
+    m_adaptiveResolutionApplied = m_config.adaptiveResolution;
+
+    // The state's scale, clamped to the configured adaptive range, is the ceiling the controller
+    // works under; it restarts from there or from its current scale, whichever is lower
+    if (m_config.adaptiveResolution) {
+        float ceiling = std::max(m_config.adaptiveResolutionMinScale,
+            std::min(m_stateRenderScale, m_config.adaptiveResolutionMaxScale));
+        float scale = std::min(ceiling, m_resolutionController.GetContinuousScale());
+        m_resolutionController.Configure(m_config.adaptiveResolutionGpuBudgetMs,
+            m_config.adaptiveResolutionMinScale, ceiling);
+        m_resolutionController.Reset(scale);
+        ApplyRenderScale(m_resolutionController.GetScale());
+    }
+    else {
+        ApplyRenderScale(1.0f);
+    }
+
+    ApplyPresentationSettings();
+}
+
+void PerformanceOptimizer::ApplyRenderScale(float scale) {
+    if (!m_renderSystem) return;
+    m_renderSystem->SetRenderScale(std::min(scale, m_budgetRenderScaleLimit));
+    m_currentRenderScale = m_renderSystem->GetRenderScale();
+}
+
+void PerformanceOptimizer::ApplyPresentationSettings() {
+    if (!m_renderSystem) return;
+
+    m_renderSystem->SetFrameLatencyWaitEnabled(m_config.waitForFrameLatency);
+    m_renderSystem->SetMaximumFrameLatency(m_config.maxFrameLatency);
+    m_renderSystem->SetFramesInFlight(m_config.framesInFlight);
+    m_renderSystem->SetPartialPresentationEnabled(m_config.partialPresentation || m_softwareRendering);
+    m_renderSystem->SetVariableRefreshEnabled(m_config.variableRefresh);
+    m_renderSystem->SetPresentRectDebugEnabled(m_config.showPresentRects);
+    m_renderSystem->SetUpscaleFilter(m_config.upscaleSharpening ? UpscaleFilter::Sharpen : UpscaleFilter::Bilinear);
+    m_renderSystem->SetUpscaleSharpness(m_config.upscaleSharpness);
+    m_renderSystem->SetUpscaleMode(m_config.swapChainScaling ? UpscaleMode::SwapChain : UpscaleMode::Shader);
+}
+
+void PerformanceOptimizer::UpdateAdaptiveResolution(std::chrono::steady_clock::time_point now) {
+    if (!m_config.adaptiveResolution || !m_renderSystem) return;
+
+    // One controller step per GPU timing readback (none arrive while render-on-demand idles)
+    UINT64 samples = m_renderSystem->GetGpuTimingSampleCount();
+    if (samples == m_gpuTimingSamplesSeen) return;
+    m_gpuTimingSamplesSeen = samples;
+
+    float ceiling = std::max(m_config.adaptiveResolutionMinScale,
+        std::min(m_stateRenderScale, m_config.adaptiveResolutionMaxScale));
+    m_resolutionController.Configure(m_config.adaptiveResolutionGpuBudgetMs,
+        m_config.adaptiveResolutionMinScale, ceiling);
+    if (m_resolutionController.AddSample(m_renderSystem->GetGpuFrameTimeMs(), now)) {
+        ApplyAdaptiveResolution();
+    }
+}
+
+void PerformanceOptimizer::ApplyAdaptiveResolution() {
+    bool adaptive = m_config.adaptiveResolution;
+    if (adaptive) {
+        ApplyRenderScale(m_resolutionController.GetScale());
+    }
+    if (m_browserView) {
+        m_browserView->SetRenderQualityLimit(adaptive ? m_resolutionController.GetBrowserQuality() : 1.0f);
+    }
+}
+
+void PerformanceOptimizer::UpdateGpuYield(std::chrono::steady_clock::time_point now) {
+    bool gameGpuBound = m_performanceMonitor && m_performanceMonitor->IsGameGpuBound(m_config.gameGpuBoundPercent);
+    if (gameGpuBound) {
+        m_gpuYieldUntil = now + std::chrono::milliseconds(m_config.gameBackOffHoldMs);
+    }
+
+    bool yield = false;
+    switch (m_config.gpuYieldPolicy) {
+    case GpuYieldPolicy::Never: yield = false; break;
+    case GpuYieldPolicy::WhenGameGpuBound: yield = now < m_gpuYieldUntil; break;
+    case GpuYieldPolicy::Always: yield = true; break;
+    }
+    ApplyGpuYield(yield);
+
+    if (m_performanceMonitor) {
+        m_performanceMonitor->RecordGpuPriorityYield(gameGpuBound, m_gpuYielded);
+    }
+}
+
+void PerformanceOptimizer::UnloadHeavyPages() {
+    if (!m_performanceMonitor || !m_browserView || m_config.heavyPageCpuPercent <= 0.0f) return;
+    BrowserManager* browserManager = m_browserView->GetBrowserManager();
+    if (!browserManager) return;
+
+    // The visible page is what the user opened the overlay for; only hidden tabs go
+    for (const PageMetrics& page : m_performanceMonitor->GetPageMetrics()) {
+        if (!page.active && page.averageMainThreadPercent >= m_config.heavyPageCpuPercent &&
+            browserManager->DiscardTab(page.tabId)) {
+            LOG_INFO("Unloaded background tab %s: renderer main thread %.0f%% busy", page.url.c_str(),
+                page.averageMainThreadPercent);
         }
+    }
+}
+
+void PerformanceOptimizer::ApplyGpuYield(bool yield) {
+    auto setProcessYield = [](DWORD processId, bool processYield) {
+        HANDLE process = OpenProcess(PROCESS_SET_INFORMATION | PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+        if (!process) return;
+        RenderSystem::SetProcessGpuPriorityYield(process, processYield);
+        CloseHandle(process);
+    };
 
-        // Store for next time
-        m_lastCPU = now;
-        m_lastUserCPU = nowUser;
+    if (yield != m_gpuYielded) {
+        m_gpuYielded = yield;
+        if (yield) PROFILE_EVENT("GPU Priority: Yield");
+        else PROFILE_EVENT("GPU Priority: Normal");
+        if (m_renderSystem) {
+            m_renderSystem->SetGpuPriorityYield(yield);
+            if (TextureLoader* textureLoader = m_renderSystem->GetTextureLoader()) {
+                textureLoader->SetUploadBytesPerFrame(yield ?
+                    TextureLoader::UPLOAD_BYTES_PER_FRAME / 4 : TextureLoader::UPLOAD_BYTES_PER_FRAME);
+            }
+        }
+        if (!yield) {
+            for (DWORD processId : m_gpuYieldedProcesses) {
+                setProcessYield(processId, false);
+            }
+            m_gpuYieldedProcesses.clear();
+        }
     }
 
-    // Update memory usage
-    PROCESS_MEMORY_COUNTERS_EX pmc;
-    if (GetProcessMemoryInfo(m_processHandle, reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&pmc), sizeof(pmc))) {
-        m_memoryUsage = pmc.WorkingSetSize;
+    // Chromium's GPU process does the browser's GPU work; it comes back with a new id after a crash
+    if (yield && m_performanceMonitor) {
+        for (DWORD processId : m_performanceMonitor->GetProcessTree().GetProcessIds(OverlayProcessType::Gpu)) {
+            if (std::find(m_gpuYieldedProcesses.begin(), m_gpuYieldedProcesses.end(), processId) == m_gpuYieldedProcesses.end()) {
+                setProcessYield(processId, true);
+                m_gpuYieldedProcesses.push_back(processId);
+            }
+        }
+    }
+}
+
+void PerformanceOptimizer::OptimizeBrowserView(PerformanceState state) {
+    if (!m_browserView) return;
+
+    // Limit first, so a state change resizes the browser once
+    float qualityLimit = m_config.adaptiveResolution ? m_resolutionController.GetBrowserQuality() : 1.0f;
+    if (m_softwareRendering) {
+        qualityLimit = std::min(qualityLimit, SOFTWARE_BROWSER_QUALITY);
+    }
+    m_browserView->SetRenderQualityLimit(qualityLimit);
+    m_browserView->AdaptToPerformanceState(state, m_resourceUsageLevel);
+    const float uploadBudgetMB = std::max(m_config.browserUploadBudgetMB[static_cast<int>(state)], 0.0f);
+    m_browserView->SetUploadBudget(static_cast<UINT64>(uploadBudgetMB * 1024.0f * 1024.0f));
+
+    // Optionally stop pumping the browser entirely
+    bool suspend = !IsPanelAllowed(OverlayPanel::Browser);
+    if (state == PerformanceState::Background || state == PerformanceState::LowPower) {
+        suspend |= m_config.throttleBackgroundBrowser && m_config.suspendInactiveProcessing;
+    }
+    m_browserView->SuspendProcessing(suspend);
+
+    // Tab budget: background tabs past the limit, or all of them under pressure, are discarded
+    if (BrowserManager* browserManager = m_browserView->GetBrowserManager()) {
+        browserManager->SetMaxLiveTabs(m_config.maxLiveBrowserTabs);
+
+        // Speculative loading: never in low power; prerendering only within the memory budget
+        BrowserManager::SpeculativeLoadMode speculation = BrowserManager::SpeculativeLoadMode::Off;
+        if (state != PerformanceState::LowPower && (m_config.preconnectOnHover || m_config.prerenderOnHover)) {
+            speculation = BrowserManager::SpeculativeLoadMode::Preconnect;
+            bool withinBudget = !m_performanceMonitor ||
+                m_performanceMonitor->GetTotalMemoryUsageMB() < m_config.prerenderMemoryBudgetMB;
+            if (m_config.prerenderOnHover && withinBudget && state == PerformanceState::Active) {
+                speculation = BrowserManager::SpeculativeLoadMode::Prerender;
+            }
+        }
+        browserManager->SetMaxPrerenderTabs(m_config.maxPrerenderTabs);
+        browserManager->SetSpeculativeLoadMode(speculation);
+        if (m_config.unloadInactiveBrowser &&
+            (state == PerformanceState::Background || state == PerformanceState::LowPower)) {
+            browserManager->DiscardBackgroundTabs();
+        }
+    }
+}
+
+void PerformanceOptimizer::OptimizeMemoryUsage(PerformanceState state) {
+    if (!m_renderSystem || !m_renderSystem->GetResourceManager()) return;
+
+    // Release more aggressively when not in use
+    std::chrono::seconds maxAge = (state == PerformanceState::Active) ?
+        std::chrono::seconds(60) : std::chrono::seconds(10);
+    m_renderSystem->GetResourceManager()->ReleaseUnusedResources(maxAge);
+
+    // The CPU side runs on the background worker
+    PostBackgroundTask(&PerformanceOptimizer::CompactHeaps);
+}
+
+void PerformanceOptimizer::TrimFootprint(PerformanceState state) {
+    if (!m_renderSystem || !m_renderSystem->GetResourceManager()) return;
+    PROFILE_ZONE("Trim Footprint");
+    ResourceManager* resourceManager = m_renderSystem->GetResourceManager();
+
+    // GPU side only while nothing is drawn (LowPower can be visible). All of it comes back lazily:
+    // the browser texture on the first Update after resume, ImGui's objects on its next frame,
+    // evicted resources on first use.
+    bool hidden = state == PerformanceState::Background ||
+        (m_windowManager && (!m_windowManager->IsVisible() || m_windowManager->IsMinimized()));
+    if (hidden) {
+        if (m_browserView) {
+            m_browserView->ReleaseSuspendedResources();
+        }
+        if (m_memoryTrimCallback) {
+            m_memoryTrimCallback();
+        }
+        resourceManager->TrimMemory();
+
+        // No frames run while hidden, so retired objects are released here rather than on resume
+        m_renderSystem->WaitForGpu();
+        resourceManager->ProcessRetiredResources(m_renderSystem->GetCompletedFenceValue());
+    }
+    else {
+        resourceManager->ReleaseUnusedResources(std::chrono::seconds(10));
+    }
+
+    PostBackgroundTask([]() {
+        CompactHeaps(); // First, so the trim also takes the pages compaction freed
+        TrimWorkingSet();
+    });
+}
+
+void PerformanceOptimizer::ScheduleBackgroundTasks() {
+    if (m_backgroundThreadRunning) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_backgroundMutex);
+        m_backgroundStopping = false;
+    }
+    if (m_performanceMonitor) {
+        m_performanceMonitor->SetProcessTreeUpdatedInBackground(true);
+    }
+    m_backgroundThreadRunning = true;
+    m_backgroundThread = std::make_unique<std::thread>(&PerformanceOptimizer::BackgroundThreadProc, this);
+}
+
+void PerformanceOptimizer::StopBackgroundTasks() {
+    {
+        std::lock_guard<std::mutex> lock(m_backgroundMutex);
+        m_backgroundStopping = true;
+    }
+    m_backgroundCondition.notify_all();
+    if (m_backgroundThread && m_backgroundThread->joinable()) {
+        m_backgroundThread->join();
+    }
+    m_backgroundThread.reset();
+    m_backgroundThreadRunning = false;
+    if (m_performanceMonitor) {
+        m_performanceMonitor->SetProcessTreeUpdatedInBackground(false);
+    }
+}
+
+void PerformanceOptimizer::PostBackgroundTask(std::function<void()> task) {
+    if (!task) return;
+    {
+        std::lock_guard<std::mutex> lock(m_backgroundMutex);
+        if (m_backgroundThreadRunning && !m_backgroundStopping) {
+            m_backgroundTasks.push_back(std::move(task));
+            task = nullptr;
+        }
+    }
+    if (task) {
+        task();
+        return;
+    }
+    m_backgroundCondition.notify_one();
+}
+
+void PerformanceOptimizer::CalculateFrameDelay() {
+    float fps = std::min<float>(m_targetFrameRate, GetStateFrameRateCap(m_currentState, m_config));
+    if (m_softwareRendering) {
+        fps = std::min(fps, SOFTWARE_MAX_FRAME_RATE);
+    }
+    // Without vsync pacing, the limiter is all that stops the overlay outrunning the display
+    float variableRefreshCap = m_renderSystem ? m_renderSystem->GetVariableRefreshFrameRateCap() : 0.0f;
+    if (variableRefreshCap > 0.0f) {
+        fps = std::min(fps, variableRefreshCap);
+    }
+
+    fps = std::max(fps, 1.0f);
+    auto frameTime = std::chrono::microseconds(static_cast<long long>(1000000.0f / fps));
+    if (frameTime != m_targetFrameTime) {
+        // A new rate applies from the last frame, not from the old deadline
+        m_targetFrameTime = frameTime;
+        m_frameDeadline = m_lastFrameTime + frameTime;
+    }
+}
+
+void PerformanceOptimizer::ApplyOptimizations() {
+    PerformanceState state = m_currentState;
+
+    CalculateFrameDelay();
+    OptimizeRenderSystem(state);
+    OptimizeBrowserView(state);
+    ApplyPowerThrottling(state);
+    ApplySubprocessPolicy(state);
+
+    // Notify registered components
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& [name, component] : m_registeredComponents) {
+        if (component.desc.onStateChanged) {
+            component.desc.onStateChanged(state, m_resourceUsageLevel);
+        }
+    }
+}
+
+void PerformanceOptimizer::BackgroundThreadProc() {
+    PROFILE_THREAD("Optimizer Worker");
+    ConfigureWorkerThread();
+    ThreadCycles::RegisterThread(ThreadSubsystem::Optimizer);
+
+    // Lightweight housekeeping only; GPU-facing work stays on the main thread
+    auto nextProcessTreeUpdate = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(m_backgroundMutex);
+    while (true) {
+        m_backgroundCondition.wait_until(lock, nextProcessTreeUpdate, [this]() {
+            return m_backgroundStopping || !m_backgroundTasks.empty();
+        });
+
+        while (!m_backgroundTasks.empty()) {
+            std::function<void()> task = std::move(m_backgroundTasks.front());
+            m_backgroundTasks.pop_front();
+            lock.unlock();
+            {
+                PROFILE_ZONE("Background Task");
+                task();
+            }
+            lock.lock();
+        }
+        if (m_backgroundStopping) break;
+
+        // Opening and querying each CEF process takes longer than a frame can spare
+        auto now = std::chrono::steady_clock::now();
+        if (now >= nextProcessTreeUpdate && m_performanceMonitor) {
+            lock.unlock();
+            {
+                PROFILE_ZONE("Process Tree Update");
+                m_performanceMonitor->UpdateProcessTree();
+            }
+            lock.lock();
+            nextProcessTreeUpdate = now + PROCESS_TREE_INTERVAL;
+        }
+        else if (!m_performanceMonitor) {
+            nextProcessTreeUpdate = now + std::chrono::hours(1);
+        }
+    }
+}
+
+void PerformanceOptimizer::CompactHeaps() {
+    // Coalesces free blocks and decommits what it can in every heap of the process (CRT, CEF's)
+    DWORD heapCount = GetProcessHeaps(0, nullptr);
+    std::vector<HANDLE> heaps(heapCount);
+    heapCount = GetProcessHeaps(static_cast<DWORD>(heaps.size()), heaps.data());
+    for (DWORD i = 0; i < std::min<DWORD>(heapCount, static_cast<DWORD>(heaps.size())); i++) {
+        HeapCompact(heaps[i], 0);
+    }
+}
+
+void PerformanceOptimizer::TrimWorkingSet() {
+    // Pages move to the standby list; the ones touched again come back as soft faults
+    if (!SetProcessWorkingSetSizeEx(GetCurrentProcess(), static_cast<SIZE_T>(-1), static_cast<SIZE_T>(-1), 0)) {
+        OutputDebugStringA("Warning: Failed to trim the working set.\n");
     }
 }
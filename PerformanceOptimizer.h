@@ -13,12 +13,20 @@
 #include <thread>
 #include <functional>
 #include <map>
+#include <deque>
+#include <string>
+#include <condition_variable>
+#include "PerformanceMonitor.h" // BrowserGpuPolicy
+#include "AdaptiveResolution.h"
+#include "CpuProfiler.h"
+#include "GameProfiles.h"
 
 // Forward declarations
 class RenderSystem;
 class WindowManager;
 class BrowserView;
 class PerformanceMonitor;
+class PolicyTraceRecorder;
 
 // Performance state of the application
 enum class PerformanceState {
@@ -37,6 +45,28 @@ enum class ResourceUsageLevel {
     Maximum         // Maximum resource usage, no constraints
 };
 
+// When the overlay gives up GPU scheduling priority to the game
+enum class GpuYieldPolicy {
+    Never,
+    WhenGameGpuBound, // While other processes keep the 3D engine busy (held like the game back-off)
+    Always
+};
+
+// How closely frames the limiter held back started on their deadline (one-second window)
+struct FrameLimiterStats {
+    bool valid = false;
+    UINT frames = 0;
+    float meanErrorMs = 0.0f;           // Mean distance from the deadline
+    float maxOvershootMs = 0.0f;        // Latest start after a deadline
+    float maxUndershootMs = 0.0f;       // Interval shortest below the target (catching up after a late frame)
+    float withinToleranceRatio = 0.0f;  // Starts within 0.2 ms of the deadline
+    float spinMarginMs = 0.0f;
+    bool highResolutionTimer = false;
+    UINT phaseLockedFrames = 0;       // Frames scheduled off the game's presents (or vblank)
+    bool phaseFromGamePresents = false; // Otherwise the compositor's vblank
+    float meanPhaseMs = 0.0f;         // Measured: frame start after the latest game present (or vblank) known then
+};
+
 // Performance optimizer class
 class PerformanceOptimizer {
 public:
@@ -55,16 +85,68 @@ public:
     // Initialize the optimizer
     void Initialize();
 
-    // Update performance state based on current conditions
+    // Update performance state based on current conditions. Called every frame, but only
+    // re-evaluates when an input changed: activation, the foreground window, window state, the
+    // idle deadline, or the periodic resource threshold check.
     void UpdateState();
 
+    // Event inputs (main thread)
+    void NotifyApplicationActive(bool active); // WM_ACTIVATEAPP
+    void NotifyWindowStateChanged();           // Shown, hidden, click-through, minimized
+    void NotifyPowerSettingChange(const POWERBROADCAST_SETTING* setting); // WM_POWERBROADCAST
+
+    // Part of the footprint trim on entering Background or LowPower while hidden, for what the
+    // optimizer can't reach (ImGui's device objects). Main thread, outside a frame.
+    void SetMemoryTrimCallback(std::function<void()> callback) { m_memoryTrimCallback = std::move(callback); }
+
+    // Power source as last notified
+    bool IsOnBattery() const { return m_onBattery; }
+    bool IsPowerSaving() const { return m_batterySaver || m_powerSaverScheme; } // Battery saver or power saver scheme
+    bool IsEcoQoSActive() const { return m_processEcoQoS; }
+
+    // --- Software Rendering ---
+    // On WARP (no usable GPU: VMs, broken drivers) every pixel is rasterized on the CPU the game
+    // needs, so whatever the config says the frame rate is capped, frames are only drawn on demand
+    // and presented as dirty rects, the browser renders at its lowest resolution and without GPU.
+    static constexpr float SOFTWARE_MAX_FRAME_RATE = 20.0f;
+    static constexpr float SOFTWARE_BROWSER_QUALITY = 0.5f;
+    bool IsSoftwareRenderingProfileActive() const { return m_softwareRendering; }
+    bool IsRenderOnDemand() const { return m_config.renderOnDemand || m_softwareRendering; }
+
+    // --- Resident Mode ---
+    // Hidden (not minimized), the overlay stays resident: device, pipelines and the browser are
+    // kept, the browser hidden and its processing suspended, while its textures, ImGui's device
+    // objects and the resource pools go through the footprint trim and the working set is emptied,
+    // whatever aggressiveMemoryCleanup says. Showing it again is timed from the show to the end of
+    // the first presented frame; TakeWakeLatencyMs returns that once (negative when there is none).
+    static constexpr float RESIDENT_WAKE_TARGET_MS = 50.0f;
+    bool IsResident() const { return m_resident; }
+    float TakeWakeLatencyMs();
+
     // Suspend/resume performance-intensive operations
     void Suspend();
     void Resume();
 
-    // Apply frame throttling
+    // Apply frame throttling (blocks until the next frame is due)
     void ThrottleFrame();
 
+    // Non-blocking frame limiter for event-driven loops. The timer is armed a spin margin before
+    // the deadline (sized from how late it has been waking); SpinUntilFrameDue then yields in a
+    // loop for the last fraction of a millisecond, never longer than MAX_SPIN_MARGIN, since the
+    // loop pumps no messages meanwhile. Call it before arming: true once the frame is due, false
+    // while the deadline is still further off. Once past the timer's target (a low resolution
+    // timer's margin is longer than the spin), ArmFrameTimer returns nullptr and the caller polls
+    // on its message wait instead.
+    bool IsFrameDue() const;
+    bool SpinUntilFrameDue();
+    HANDLE ArmFrameTimer(); // Waitable timer signalled shortly before the next frame is due
+    void MarkFrameStart();
+    std::chrono::steady_clock::time_point GetFrameDeadline() const { return m_frameDeadline; }
+    // Limiter accuracy over the last second
+    const FrameLimiterStats& GetFrameLimiterStats() const { return m_limiterStats; }
+    // Current frame interval, after per-state limits
+    std::chrono::microseconds GetTargetFrameTime() const { return m_targetFrameTime; }
+
     // Refresh rate management
     void SetTargetFrameRate(float fps);
     float GetTargetFrameRate() const;
@@ -76,9 +158,68 @@ public:
     // Get current performance state
     PerformanceState GetPerformanceState() const;
 
-    // Register a component for performance monitoring and optimization
+    // Adaptive resolution loop (scale, browser quality, filtered GPU time)
+    const AdaptiveResolutionController& GetResolutionController() const { return m_resolutionController; }
+
+    // GPU scheduling priority currently given up to the game
+    bool IsGpuPriorityYielded() const { return m_gpuYielded; }
+
+    // Browser GPU policy configured for the current state
+    BrowserGpuPolicy GetBrowserGpuPolicy() const;
+
+    // Runs a task on the background worker (low priority, efficiency cores), in order. Tasks still
+    // queued when the worker stops run before it exits; without a worker the task runs inline.
+    void PostBackgroundTask(std::function<void()> task);
+
+    // --- Game Profiles ---
+    // The foreground game is the last other process to take the foreground. When it has a
+    // profile, the profile's values replace the matching Config fields in one step; a game without
+    // one gets the values from before the first profile back. Edits to those fields while a
+    // profile is active last until it ends, unless saved into it.
+    GameProfileStore& GetGameProfiles() { return m_gameProfiles; }
+    const std::string& GetForegroundGame() const { return m_foregroundGame; } // Empty until another process was in front
+    HWND GetForegroundGameWindow() const { return m_foregroundWindow; }       // Its window (the overlay follows its monitor)
+    // That window once it is positively a game: it has a profile, or its process presents through
+    // DXGI (ETW) into a window covering its monitor. Null otherwise (a browser, a launcher, the desktop)
+    HWND GetDetectedGameWindow() const;
+    const GameProfile* GetActiveGameProfile() const { return m_gameProfileActive ? &m_activeGameProfile : nullptr; }
+    GameProfile CaptureGameProfile(const std::string& executable) const; // The current config's values
+    void ReapplyGameProfile(); // After the store changed
+    // False for a panel the active profile keeps from running while the game has focus
+    bool IsPanelAllowed(OverlayPanel panel) const;
+    UINT GetConfigGeneration() const { return m_configGeneration; } // Bumped when a profile rewrites the config
+
+    // --- Component Registry ---
+    // Components share the overlay's frame budget. Each one's cost is measured from its profiler
+    // zones (CPU, any thread; sampled, since the profiler only records briefly for it) and GPU
+    // passes. While the components together are over budget, the optimizer takes one degrade step
+    // at a time from the lowest priority component that has one left (a component over its own
+    // budget steps first); once well under it, steps are given back highest priority first. By
+    // default: perf graphs, then browser paint rate, then render scale.
     using OptimizationCallback = std::function<void(PerformanceState, ResourceUsageLevel)>;
-    void RegisterComponent(const std::string& name, OptimizationCallback callback);
+    struct ComponentDesc {
+        int priority = 0;                    // Lower degrades first
+        std::vector<const char*> cpuZones;   // PROFILE_ZONE names (the same literals)
+        uint32_t gpuPasses = 0;              // Bit per GpuPass
+        float budgetMs = 0.0f;               // Own CPU + GPU budget per frame, 0 = total budget only
+        int maxDegradeLevel = 0;             // Steps it can take; 0 = never degraded
+        std::function<void(int)> onDegradeLevelChanged; // New level, 0 = full quality
+        OptimizationCallback onStateChanged;  // State broadcast (optional)
+    };
+    struct ComponentStatus {
+        std::string name;
+        int priority = 0;
+        float cpuMs = 0.0f; // Smoothed, per frame
+        float gpuMs = 0.0f;
+        float budgetMs = 0.0f;
+        int degradeLevel = 0;
+        int maxDegradeLevel = 0;
+    };
+    void RegisterComponent(const std::string& name, ComponentDesc desc);
+    void RegisterComponent(const std::string& name, OptimizationCallback callback); // State broadcast only
+    void UnregisterComponent(const std::string& name);
+    std::vector<ComponentStatus> GetComponentStatus() const; // Lowest priority first
+    float GetComponentCostMs() const { return m_componentCostMs; } // All components, per frame
 
     // Static configuration options
     struct Config {
@@ -90,11 +231,46 @@ public:
         // Resource usage thresholds
         float cpuThresholdPercent = 80.0f;
         float gpuThresholdPercent = 80.0f;
-        float memoryThresholdMB = 512.0f;
+        float memoryThresholdMB = 2048.0f; // CEF subprocesses and GPU memory included
 
         // Idle detection
         unsigned int idleTimeoutMs = 5000;
 
+        // Hysteresis: a move to a lower state other than Background must hold this long before it
+        // applies (returning to Active and hiding/showing apply at once). Stops quality and
+        // browser resolution from flipping back and forth when focus bounces or a threshold wavers.
+        unsigned int stateDemotionDelayMs = 1000;
+
+        // Power source: low power on battery while the overlay is not in use, and at all times
+        // under battery saver or the power saver scheme
+        bool lowPowerOnBattery = true;
+        bool lowPowerWhenPowerSaving = true;
+        // EcoQoS for the process outside the Active state (efficient cores, lower clocks)
+        bool ecoQoSWhenNotActive = true;
+
+        // CEF subprocesses (renderer, GPU, utility) per state, so page scripts can't take the
+        // game's performance cores; LowPower uses the background policy
+        SubprocessPolicy activeSubprocessPolicy = { BELOW_NORMAL_PRIORITY_CLASS, 0.0f, true };
+        SubprocessPolicy inactiveSubprocessPolicy = { BELOW_NORMAL_PRIORITY_CLASS, 25.0f, true };
+        SubprocessPolicy backgroundSubprocessPolicy = { IDLE_PRIORITY_CLASS, 10.0f, true };
+
+        // Game frame rate (ETW presents): drop to low power while the game runs slower than its
+        // recent baseline, held long enough for the game to recover before re-checking
+        bool backOffWhenGameSlows = true;
+        float gameFrameTimeDegradationPercent = 15.0f;
+        unsigned int gameBackOffHoldMs = 5000;
+
+        // GPU priority: this process and Chromium's GPU process drop to below-normal GPU
+        // scheduling and image uploads are throttled, so the game's frames are scheduled first
+        GpuYieldPolicy gpuYieldPolicy = GpuYieldPolicy::WhenGameGpuBound;
+        float gameGpuBoundPercent = 90.0f; // 3D engine use by other processes that counts as GPU-bound
+
+        // Phase lock: frame deadlines snap to just after the game's presents (ETW), or to the
+        // compositor's vblank without ETW, so the overlay's GPU work lands in the game's idle
+        // window instead of the middle of its frame. The average frame rate is unchanged.
+        bool phaseLockToGame = false;
+        float phaseLockOffsetMs = 0.5f;
+
         // Background throttling
         bool enableBackgroundThrottling = true;
 
@@ -104,15 +280,62 @@ public:
 
         // Browser optimizations
         bool throttleBackgroundBrowser = true;
-        bool unloadInactiveBrowser = false;
+        bool unloadInactiveBrowser = false;  // Discard background tabs when hidden or in low power
+        unsigned int maxLiveBrowserTabs = 4; // Older background tabs are discarded and reloaded on demand
+        bool deferBrowserUntilOpened = false; // Start CEF on first visit to the browser page, not after the first frame
+        bool preconnectOnHover = true;         // Warm connections for hovered links
+        bool prerenderOnHover = false;         // Load lingered-on links in a hidden tab
+        unsigned int maxPrerenderTabs = 1;
+        float prerenderMemoryBudgetMB = 1536.0f; // No prerendering while the overlay uses more
+        // A hidden tab whose renderer main thread stays this busy (PageMetrics, smoothed) is
+        // unloaded, so one heavy page doesn't cost the game CPU (0 = never). Off by default: hidden
+        // tabs are already throttled by Chromium (WasHidden), and unloading loses their state
+        float heavyPageCpuPercent = 0.0f;
+        // Chromium GPU policy per PerformanceState, picked when CEF starts (its switches are
+        // process-wide). Starting while the game has focus keeps Chromium off the GPU's raster work.
+        BrowserGpuPolicy browserGpuPolicy[4] = {
+            BrowserGpuPolicy::Full,           // Active
+            BrowserGpuPolicy::SoftwareRaster, // Inactive
+            BrowserGpuPolicy::SoftwareRaster, // Background
+            BrowserGpuPolicy::Software        // LowPower
+        };
+
+        // Software paint bytes copied to the GPU per frame, per PerformanceState (0 = no limit).
+        // Larger paints are spread over frames and shown once complete (BrowserView::SetUploadBudget).
+        float browserUploadBudgetMB[4] = { 8.0f, 4.0f, 2.0f, 2.0f };
 
         // Render optimizations
         bool adaptiveResolution = true;
         float adaptiveResolutionMinScale = 0.5f;
-        float adaptiveResolutionMaxScale = 1.0f;
+        float adaptiveResolutionMaxScale = 1.0f;   // The performance state's scale caps it further
+        float adaptiveResolutionGpuBudgetMs = 3.0f; // Overlay GPU time per frame the scale is steered to
+        bool upscaleSharpening = true;       // Sharpen when upscaling below 1.0 (bilinear otherwise)
+        float upscaleSharpness = 0.5f;       // 0 = none, 1 = maximum
+        bool swapChainScaling = false;       // Let DXGI stretch reduced scales (UpscaleMode::SwapChain); no sharpening
+
+        // Component budget (see RegisterComponent)
+        float overlayFrameBudgetMs = 6.0f;   // CPU + GPU per frame of every component, 0 = off
+
+        // Render-on-demand (skip frames when nothing changed)
+        bool renderOnDemand = true;
+        unsigned int idleRedrawIntervalMs = 500; // Periodic redraw so perf graphs keep ticking (0 = off)
+
+        // Variable refresh: with tearing support, presents are no longer vsync-paced but capped by the
+        // frame limiter just under the output's maximum refresh (RenderSystem::SetVariableRefreshEnabled).
+        // Off by default: it trades vsync for the limiter, which only pays off on a VRR display
+        bool variableRefresh = false;
+
+        // Partial presentation (Present1 dirty rects)
+        bool partialPresentation = true;
+        bool showPresentRects = false;       // Debug outlines of the submitted rects
+
+        // Frame latency (waitable swap chain)
+        bool waitForFrameLatency = true;     // Block before input/UI until the swap chain is ready
+        unsigned int maxFrameLatency = 1;    // Frames the CPU may queue ahead of the display
+        unsigned int framesInFlight = 3;     // Frame contexts, 1-3; fewer also drops back buffers
 
         // Memory management
-        bool aggressiveMemoryCleanup = true;
+        bool aggressiveMemoryCleanup = true; // Periodic release, plus a full trim on entering Background/LowPower
         unsigned int memoryCleanupIntervalMs = 60000; // 1 minute
     };
 
@@ -120,15 +343,64 @@ public:
     Config& GetConfig() { return m_config; }
     const Config& GetConfig() const { return m_config; }
 
+    // --- State Policy ---
+    // What a state evaluation decides from. SelectState is the whole decision, so a recorded
+    // session can be replayed against other configs offline (PolicySimulator); only the game
+    // back-off hold carries over between evaluations.
+    struct StateInputs {
+        bool hasWindow = false;
+        bool visible = true;    // Shown and not minimized
+        bool focused = true;    // Window active, application active, overlay in the foreground
+        bool idle = false;      // No input for idleTimeoutMs
+        bool hasMonitor = false;
+        float cpuPercent = 0.0f;
+        float memoryMB = 0.0f;  // GetTotalMemoryUsageMB
+        bool gameValid = false;
+        float gameFrameMs = 0.0f;
+        float gameBaselineFrameMs = 0.0f;
+        bool onBattery = false;
+        bool powerSaving = false;
+    };
+    static PerformanceState SelectState(const StateInputs& inputs, const Config& config,
+        std::chrono::steady_clock::time_point now, std::chrono::steady_clock::time_point& gameBackOffUntil);
+    // Otherwise a demotion has to hold for stateDemotionDelayMs
+    static bool IsImmediateTransition(PerformanceState current, PerformanceState desired);
+    static float GetStateFrameRateCap(PerformanceState state, const Config& config); // Before software and VRR caps
+
+    // --record-policy: the inputs and outcome of every state evaluation go to a file for
+    // --simulate-policy (see PolicyTrace.h)
+    void StartPolicyRecording(const std::string& path);
+
 private:
     // Helper methods for specific optimizations
     void OptimizeRenderSystem(PerformanceState state);
     void OptimizeBrowserView(PerformanceState state);
     void OptimizeMemoryUsage(PerformanceState state);
+    void TrimFootprint(PerformanceState state); // On entering Background or LowPower
+    void EnterResident(); // Hidden: always trims
     void ScheduleBackgroundTasks();
+    void StopBackgroundTasks();
+    void ApplyPresentationSettings(); // Config values the render system reads every frame
+    void UpdateAdaptiveResolution(std::chrono::steady_clock::time_point now);
+    void ApplyAdaptiveResolution();   // Controller output to the render scale and browser quality limit
+    void UpdateGpuYield(std::chrono::steady_clock::time_point now);
+    void ApplyGpuYield(bool yield);
+    void UnloadHeavyPages();
+
+    // State detection
+    StateInputs GatherStateInputs() const;
+    void RecordPolicySample(const StateInputs& inputs);
+    void UpdateIdle(std::chrono::steady_clock::time_point now);
+    void SetState(PerformanceState state);
+    void ApplyPowerThrottling(PerformanceState state);
+    void ApplySubprocessPolicy(PerformanceState state);
+    static void CALLBACK ForegroundEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd,
+        LONG idObject, LONG idChild, DWORD eventThread, DWORD eventTime);
 
     // Frame timing management
     void CalculateFrameDelay();
+    void AlignFrameDeadlineToGame(std::chrono::steady_clock::time_point now);
+    bool GetPhaseAnchor(int64_t& anchorQpc, double& intervalMs, bool& fromGame) const; // A recent present and the interval
     void ApplyOptimizations();
 
     // Resource pointers (not owned)
@@ -142,33 +414,151 @@ private:
     std::atomic<ResourceUsageLevel> m_resourceUsageLevel = ResourceUsageLevel::Balanced;
     std::atomic<float> m_targetFrameRate = 60.0f;
     std::atomic<bool> m_suspended = false;
+    bool m_softwareRendering = false; // WARP adapter
 
     // Frame timing
     std::chrono::steady_clock::time_point m_lastFrameTime;
     std::chrono::microseconds m_targetFrameTime = std::chrono::microseconds(16666); // 60 FPS default
     std::chrono::microseconds m_accumulatedTime = std::chrono::microseconds(0);
-
-    // Idle tracking
+    HANDLE m_frameTimer = nullptr;
+    bool m_highResolutionTimer = false;
+
+    // Frame limiter
+    static constexpr std::chrono::microseconds MIN_SPIN_MARGIN{ 100 };
+    static constexpr std::chrono::microseconds MAX_SPIN_MARGIN{ 500 }; // Longest spin, whatever the timer
+    static constexpr std::chrono::microseconds LEGACY_TIMER_SPIN_MARGIN{ 2000 }; // Ticks at the system timer resolution
+    static constexpr float FRAME_LIMITER_TOLERANCE_MS = 0.2f;
+    std::chrono::steady_clock::time_point m_frameDeadline;
+    std::chrono::steady_clock::time_point m_timerTarget;
+    std::chrono::microseconds m_spinMargin{ 500 };
+    double m_timerLatenessUs = 0.0;
+    bool m_timerArmed = false;
+    bool m_limiterWaited = false; // This frame was held back by the limiter
+    struct LimiterWindow {
+        UINT frames = 0;
+        UINT withinTolerance = 0;
+        double errorSumMs = 0.0;
+        float maxOvershootMs = 0.0f;
+        float maxUndershootMs = 0.0f;
+        UINT phaseLockedFrames = 0;
+        double phaseSumMs = 0.0;
+        bool phaseFromGamePresents = false;
+    };
+    LimiterWindow m_limiterWindow;
+    static constexpr double MIN_PHASE_INTERVAL_MS = 2.0;   // Above 500 FPS there is no idle window to aim for
+    static constexpr double MAX_PHASE_INTERVAL_MS = 100.0; // Below 10 FPS the game is stalling, not pacing
+    int64_t m_qpcFrequency = 1;
+    bool m_deadlinePhaseLocked = false; // The pending deadline came from the game's schedule
+    std::chrono::steady_clock::time_point m_limiterWindowStart;
+    FrameLimiterStats m_limiterStats;
+
+    // Idle tracking (GetLastInputInfo is read when the idle deadline comes up, and while idle)
+    static constexpr std::chrono::milliseconds IDLE_POLL_INTERVAL{ 250 };
     std::chrono::steady_clock::time_point m_lastActivityTime;
+    std::chrono::steady_clock::time_point m_nextIdleCheck;
     bool m_isIdle = false;
 
+    // Event-driven state detection
+    static constexpr std::chrono::milliseconds THRESHOLD_CHECK_INTERVAL{ 500 };
+    static PerformanceOptimizer* s_foregroundInstance; // Target of the WinEvent callback
+    HWINEVENTHOOK m_foregroundHook = nullptr;
+    bool m_applicationActive = true;
+    bool m_overlayForeground = true; // A window of this process has the foreground
+    std::atomic<bool> m_stateInputsChanged = true;
+    bool m_resident = false;
+    bool m_waking = false; // Shown from resident, first frame not presented yet
+    std::chrono::steady_clock::time_point m_wakeStart;
+    std::chrono::steady_clock::time_point m_nextThresholdCheck;
+    PerformanceState m_pendingState = PerformanceState::Active; // Demotion waiting out the hold
+    std::chrono::steady_clock::time_point m_pendingStateSince;
+
+    // Game profiles (main thread; the foreground hook runs on it too)
+    GameProfileStore m_gameProfiles;
+    std::string m_foregroundGame;
+    HWND m_foregroundWindow = nullptr;
+    bool m_foregroundGameChanged = false;
+    bool m_gameProfileActive = false;
+    GameProfile m_activeGameProfile;
+    Config m_configBeforeProfile; // Whole config as it was when the first profile applied
+    std::atomic<UINT> m_configGeneration = 0;
+    void ApplyGameProfile(const GameProfile* profile);
+
+    // Power source (power setting notifications, main thread)
+    std::vector<HPOWERNOTIFY> m_powerNotifications;
+    bool m_onBattery = false;
+    bool m_batterySaver = false;
+    bool m_powerSaverScheme = false;
+    bool m_processEcoQoS = false;
+
+    // Game frame time back-off
+    std::chrono::steady_clock::time_point m_gameBackOffUntil;
+
+    // GPU priority yield
+    bool m_gpuYielded = false;
+    std::chrono::steady_clock::time_point m_gpuYieldUntil;
+    std::vector<DWORD> m_gpuYieldedProcesses; // Chromium GPU processes lowered so far
+
     // Memory cleanup tracking
     std::chrono::steady_clock::time_point m_lastMemoryCleanupTime;
 
     // Thread safety
     mutable std::mutex m_mutex;
 
-    // Registered components and their callbacks
-    std::map<std::string, OptimizationCallback> m_registeredComponents;
+    // Registered components (m_mutex)
+    static constexpr std::chrono::milliseconds DEGRADE_STEP_INTERVAL{ 1000 }; // Costs settle between steps
+    static constexpr std::chrono::milliseconds RECOVER_HOLD{ 3000 };
+    static constexpr float RECOVER_BUDGET_FRACTION = 0.75f; // Room needed, with the step's cost back
+    static constexpr float COMPONENT_COST_SMOOTHING = 0.3f;
+    static constexpr float MIN_DEGRADE_COST_MS = 0.05f;
+    static constexpr std::chrono::milliseconds COMPONENT_SAMPLE_INTERVAL{ 2000 }; // Profiler off in between
+    struct Component {
+        ComponentDesc desc;
+        float cpuMs = 0.0f;
+        float gpuMs = 0.0f;
+        int degradeLevel = 0;
+        std::vector<float> costBeforeStep; // Cost when each step was taken, for recovery estimates
+    };
+    std::map<std::string, Component> m_registeredComponents;
+    std::atomic<float> m_componentCostMs = 0.0f;
+    std::chrono::steady_clock::time_point m_lastDegradeStep;
+    std::chrono::steady_clock::time_point m_underBudgetSince;
+    bool m_underBudget = false;
+    bool m_componentSampling = false; // Profiler enabled for the next check's measurement
+    std::chrono::steady_clock::time_point m_nextComponentSample;
+    CpuProfileFrame m_componentProfile; // Reused capture
+    void UpdateComponentBudget(std::chrono::steady_clock::time_point now);
+    void MeasureComponentCosts(bool profilerRecorded);
+    void RegisterDefaultComponents();
+
+    // Budget degradation of the built-in components, one entry per step
+    static constexpr int BUDGET_PAINT_RATES[] = { 30, 20, 10 };
+    static constexpr float BUDGET_RENDER_SCALES[] = { 0.85f, 0.7f, 0.5f };
+    float m_budgetRenderScaleLimit = 1.0f;
+    void ApplyRenderScale(float scale); // Under the budget's limit
 
     // Configuration
     Config m_config;
 
     // Render scaling
     float m_currentRenderScale = 1.0f;
-
-    // Background task thread
+    float m_stateRenderScale = 1.0f; // From the performance state, before the controller
+    AdaptiveResolutionController m_resolutionController;
+    UINT64 m_gpuTimingSamplesSeen = 0;
+    bool m_adaptiveResolutionApplied = false; // Config value the last optimization pass used
+
+    // Background task thread: posted tasks, plus the process tree refresh (telemetry) and heap
+    // compaction (CPU side of the memory cleanup) on its own schedule
+    static constexpr std::chrono::milliseconds PROCESS_TREE_INTERVAL{ 1000 };
     std::unique_ptr<std::thread> m_backgroundThread;
     std::atomic<bool> m_backgroundThreadRunning = false;
+    std::mutex m_backgroundMutex;
+    std::condition_variable m_backgroundCondition;
+    std::deque<std::function<void()>> m_backgroundTasks;
+    bool m_backgroundStopping = false;
     void BackgroundThreadProc();
+    static void CompactHeaps();
+    static void TrimWorkingSet();
+
+    std::function<void()> m_memoryTrimCallback;
+    std::unique_ptr<PolicyTraceRecorder> m_policyRecorder;
 };
\ No newline at end of file
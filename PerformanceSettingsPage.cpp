@@ -3,52 +3,116 @@
 // Settings page for performance configuration
 
 #include "PerformanceSettingsPage.h"
+#include "RenderSystem.h"
+#include "TraceCapture.h"
+#include "InputLatency.h"
+#include "ImGuiSystem.h"
 #include "imgui.h"
 #include <algorithm>
-
-PerformanceSettingsPage::PerformanceSettingsPage(PerformanceOptimizer* optimizer, PerformanceMonitor* monitor)
-    : PageBase("Performance"), m_optimizer(optimizer), m_monitor(monitor) {
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cfloat>
+#include <cmath>
+#include <iterator>
+
+PerformanceSettingsPage::PerformanceSettingsPage(PerformanceOptimizer* optimizer, PerformanceMonitor* monitor,
+    ResourceManager* resourceManager, RenderSystem* renderSystem)
+    : PageBase("Performance"), m_optimizer(optimizer), m_monitor(monitor), m_resourceManager(resourceManager),
+      m_renderSystem(renderSystem) {
 
     // Initialize settings from optimizer if available
-    if (m_optimizer) {
-        const auto& config = m_optimizer->GetConfig();
+    LoadSettingsFromConfig();
 
-        m_settings.maxActiveFrameRate = config.maxActiveFrameRate;
-        m_settings.maxInactiveFrameRate = config.maxInactiveFrameRate;
-        m_settings.maxBackgroundFrameRate = config.maxBackgroundFrameRate;
+}
+
+PerformanceSettingsPage::~PerformanceSettingsPage() {
+    OnHidden();
+}
 
-        m_settings.cpuThresholdPercent = config.cpuThresholdPercent;
-        m_settings.gpuThresholdPercent = config.gpuThresholdPercent;
-        m_settings.memoryThresholdMB = config.memoryThresholdMB;
+void PerformanceSettingsPage::OnVisible() {
+    // The first thing given up when the overlay is over its budget
+    if (m_optimizer && !m_graphsRegistered) {
+        PerformanceOptimizer::ComponentDesc graphs;
+        graphs.priority = 0;
+        graphs.cpuZones = { "Performance Graphs" };
+        graphs.maxDegradeLevel = 1;
+        graphs.onDegradeLevelChanged = [this](int level) { m_graphsDegraded = level > 0; };
+        m_optimizer->RegisterComponent("Performance Graphs", std::move(graphs));
+        m_graphsRegistered = true;
+    }
+}
 
-        m_settings.adaptiveResolution = config.adaptiveResolution;
-        m_settings.throttleInactive = config.reduceInactiveQuality;
-        m_settings.suspendBackground = config.suspendInactiveProcessing;
-        m_settings.aggressiveMemoryCleanup = config.aggressiveMemoryCleanup;
+void PerformanceSettingsPage::OnHidden() {
+    if (m_optimizer && m_graphsRegistered) {
+        m_optimizer->UnregisterComponent("Performance Graphs");
+        m_graphsRegistered = false;
     }
+    m_graphsDegraded = false;
+    std::vector<float>().swap(m_frameTimeBuckets);
+}
 
-    // Initialize history arrays
-    std::fill(m_cpuHistory.begin(), m_cpuHistory.end(), 0.0f);
-    std::fill(m_gpuHistory.begin(), m_gpuHistory.end(), 0.0f);
-    std::fill(m_memoryHistory.begin(), m_memoryHistory.end(), 0.0f);
-    std::fill(m_frameTimeHistory.begin(), m_frameTimeHistory.end(), 0.0f);
+void PerformanceSettingsPage::LoadSettingsFromConfig() {
+    if (!m_optimizer) return;
+    const auto& config = m_optimizer->GetConfig();
+
+    m_settings.maxActiveFrameRate = config.maxActiveFrameRate;
+    m_settings.maxInactiveFrameRate = config.maxInactiveFrameRate;
+    m_settings.maxBackgroundFrameRate = config.maxBackgroundFrameRate;
+
+    m_settings.cpuThresholdPercent = config.cpuThresholdPercent;
+    m_settings.gpuThresholdPercent = config.gpuThresholdPercent;
+    m_settings.memoryThresholdMB = config.memoryThresholdMB;
+
+    m_settings.adaptiveResolution = config.adaptiveResolution;
+    m_settings.adaptiveGpuBudgetMs = config.adaptiveResolutionGpuBudgetMs;
+    m_settings.overlayFrameBudgetMs = config.overlayFrameBudgetMs;
+    m_settings.throttleInactive = config.reduceInactiveQuality;
+    m_settings.suspendBackground = config.suspendInactiveProcessing;
+    m_settings.aggressiveMemoryCleanup = config.aggressiveMemoryCleanup;
+    m_settings.partialPresentation = config.partialPresentation;
+    m_settings.swapChainScaling = config.swapChainScaling;
+    m_settings.variableRefresh = config.variableRefresh;
+    m_settings.showPresentRects = config.showPresentRects;
+    m_settings.framesInFlight = static_cast<int>(config.framesInFlight);
+    m_settings.gpuYieldPolicy = static_cast<int>(config.gpuYieldPolicy);
+    m_settings.lowPowerOnBattery = config.lowPowerOnBattery;
+    m_settings.phaseLockToGame = config.phaseLockToGame;
+    m_settings.phaseLockOffsetMs = config.phaseLockOffsetMs;
+    m_settings.lowPowerWhenPowerSaving = config.lowPowerWhenPowerSaving;
+    m_settings.ecoQoSWhenNotActive = config.ecoQoSWhenNotActive;
+    m_settings.gameGpuBoundPercent = config.gameGpuBoundPercent;
+    m_settings.discardBackgroundTabs = config.unloadInactiveBrowser;
+    m_settings.heavyPageCpuPercent = config.heavyPageCpuPercent;
+    m_settings.maxLiveBrowserTabs = static_cast<int>(config.maxLiveBrowserTabs);
+    m_settings.deferBrowserStartup = config.deferBrowserUntilOpened;
+    for (int i = 0; i < 4; i++) {
+        m_settings.browserGpuPolicy[i] = static_cast<int>(config.browserGpuPolicy[i]);
+        m_settings.browserUploadBudgetMB[i] = config.browserUploadBudgetMB[i];
+    }
+    m_settings.preconnectOnHover = config.preconnectOnHover;
+    m_settings.prerenderOnHover = config.prerenderOnHover;
+    m_settings.renderScale = config.adaptiveResolutionMaxScale;
+    m_configGeneration = m_optimizer->GetConfigGeneration();
 }
 
 void PerformanceSettingsPage::Render() {
     ImGui::BeginChild("PerformanceSettingsScroll", ImVec2(0, 0), false, ImGuiWindowFlags_AlwaysVerticalScrollbar);
 
-    // Update history data from monitor
-    if (m_monitor) {
-        m_cpuHistory[m_historyIndex] = m_monitor->GetCpuUsagePercent();
-        m_gpuHistory[m_historyIndex] = m_monitor->GetGpuUsagePercent();
-        m_memoryHistory[m_historyIndex] = m_monitor->GetMemoryUsageMB();
-        m_frameTimeHistory[m_historyIndex] = 1000.0f / m_monitor->GetFramesPerSecond(); // ms per frame
-
-        m_historyIndex = (m_historyIndex + 1) % HISTORY_POINTS;
+    // A game profile rewrote the config; unapplied edits are kept
+    if (m_optimizer && m_optimizer->GetConfigGeneration() != m_configGeneration && !m_settingsChanged) {
+        LoadSettingsFromConfig();
     }
 
     // Performance Overview Graphs
     RenderResourceUsageGraphs();
+    RenderGpuMemoryReport();
+    RenderCpuTimeline();
+    RenderHitchIncidents();
+    RenderSubsystemCpu();
+    RenderAllocations();
+    RenderNavigationTimings();
+    RenderPageMetrics();
 
     ImGui::Spacing();
     ImGui::Separator();
@@ -82,6 +146,13 @@ void PerformanceSettingsPage::Render() {
     ImGui::Separator();
     ImGui::Spacing();
 
+    // Per-game profiles
+    RenderGameProfiles();
+
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
     // Memory Settings
     RenderMemorySettings();
 
@@ -107,19 +178,42 @@ void PerformanceSettingsPage::Render() {
     ImGui::EndChild();
 }
 
+namespace {
+
+// Graph time spans; the series keep min/max per bucket, so an hour draws as cheaply as a second
+const double GRAPH_SPANS[] = { 1.0, 10.0, 60.0, 600.0, 3600.0 };
+const char* const GRAPH_SPAN_NAMES[] = { "1 s", "10 s", "1 min", "10 min", "1 hour" };
+
+} // namespace
+
 void PerformanceSettingsPage::RenderResourceUsageGraphs() {
+    PROFILE_ZONE("Performance Graphs");
     RenderSectionHeader("Performance Overview");
+    bool graphsAllowed = !m_optimizer || m_optimizer->IsPanelAllowed(OverlayPanel::PerformanceGraphs);
+    if (m_graphsDegraded) {
+        ImGui::TextDisabled("Graphs paused to keep the overlay within its frame budget");
+    }
+    else if (!graphsAllowed) {
+        ImGui::TextDisabled("Graphs paused while the game has focus (game profile)");
+    }
+    const bool showGraphs = m_monitor && !m_graphsDegraded && graphsAllowed;
 
     const float graphHeight = 80.0f;
+    if (showGraphs) {
+        ImGui::SetNextItemWidth(100.0f);
+        ImGui::Combo("Time Span##GraphSpan", &m_graphSpan, GRAPH_SPAN_NAMES, static_cast<int>(std::size(GRAPH_SPAN_NAMES)));
+    }
+    const double span = GRAPH_SPANS[std::clamp(m_graphSpan, 0, static_cast<int>(std::size(GRAPH_SPANS)) - 1)];
 
     // CPU Usage Graph
     {
         ImGui::Text("CPU Usage: %.1f%%", m_monitor ? m_monitor->GetCpuUsagePercent() : 0.0f);
-        ImGui::PlotLines("##CPUUsage", m_cpuHistory.data(), HISTORY_POINTS, m_historyIndex,
-            nullptr, 0.0f, 100.0f, ImVec2(ImGui::GetContentRegionAvail().x, graphHeight));
+        if (showGraphs) {
+            RenderMetricGraph("##CPUUsage", m_monitor->GetMetricSeries(Metric::CpuPercent), span, 0.0f, 100.0f, graphHeight);
+        }
 
         // CPU threshold line
-        if (m_settings.cpuThresholdPercent > 0 && m_settings.cpuThresholdPercent < 100) {
+        if (showGraphs && m_settings.cpuThresholdPercent > 0 && m_settings.cpuThresholdPercent < 100) {
             ImDrawList* drawList = ImGui::GetWindowDrawList();
             const ImVec2 p1 = ImGui::GetItemRectMin() + ImVec2(0, graphHeight * (1.0f - m_settings.cpuThresholdPercent / 100.0f));
             const ImVec2 p2 = ImVec2(ImGui::GetItemRectMax().x, p1.y);
@@ -132,33 +226,79 @@ void PerformanceSettingsPage::RenderResourceUsageGraphs() {
     // GPU Usage Graph
     {
         ImGui::Text("GPU Usage: %.1f%%", m_monitor ? m_monitor->GetGpuUsagePercent() : 0.0f);
-        ImGui::PlotLines("##GPUUsage", m_gpuHistory.data(), HISTORY_POINTS, m_historyIndex,
-            nullptr, 0.0f, 100.0f, ImVec2(ImGui::GetContentRegionAvail().x, graphHeight));
+        if (showGraphs) {
+            RenderMetricGraph("##GPUUsage", m_monitor->GetMetricSeries(Metric::GpuPercent), span, 0.0f, 100.0f, graphHeight);
+        }
 
         // GPU threshold line
-        if (m_settings.gpuThresholdPercent > 0 && m_settings.gpuThresholdPercent < 100) {
+        if (showGraphs && m_settings.gpuThresholdPercent > 0 && m_settings.gpuThresholdPercent < 100) {
             ImDrawList* drawList = ImGui::GetWindowDrawList();
             const ImVec2 p1 = ImGui::GetItemRectMin() + ImVec2(0, graphHeight * (1.0f - m_settings.gpuThresholdPercent / 100.0f));
             const ImVec2 p2 = ImVec2(ImGui::GetItemRectMax().x, p1.y);
             drawList->AddLine(p1, p2, IM_COL32(255, 0, 0, 128), 1.0f);
         }
+
+        // Engine utilization and GPU memory from the system counters
+        if (m_monitor && m_monitor->IsGpuUsageMeasured()) {
+            const GpuUsageSample& sample = m_monitor->GetGpuUsageSample();
+            for (size_t i = 0; i < static_cast<size_t>(GpuEngineType::Count); i++) {
+                GpuEngineType type = static_cast<GpuEngineType>(i);
+                if (i > 0) ImGui::SameLine();
+                ImGui::TextDisabled("%s %.0f%% (system %.0f%%)", GetGpuEngineTypeName(type),
+                    sample.GetProcessUsage(type) * 100.0f, sample.GetSystemUsage(type) * 100.0f);
+            }
+            ImGui::TextDisabled("GPU Memory: %.1f MB dedicated, %.1f MB shared (system %.0f / %.0f MB)",
+                sample.processDedicatedBytes / (1024.0f * 1024.0f), sample.processSharedBytes / (1024.0f * 1024.0f),
+                sample.systemDedicatedBytes / (1024.0f * 1024.0f), sample.systemSharedBytes / (1024.0f * 1024.0f));
+        }
+        else if (m_monitor) {
+            ImGui::TextDisabled("Estimated from GPU frame time (engine counters unavailable)");
+        }
+
+        // Per-pass GPU timings
+        if (m_monitor) {
+            ImGui::Text("GPU Frame: %.3f ms", m_monitor->GetGpuFrameTimeMs());
+            for (size_t i = 0; i < static_cast<size_t>(GpuPass::Count); i++) {
+                GpuPass pass = static_cast<GpuPass>(i);
+                ImGui::SameLine();
+                ImGui::TextDisabled("| %s: %.3f ms", GetGpuPassName(pass), m_monitor->GetGpuPassTimeMs(pass));
+            }
+        }
     }
 
     ImGui::Spacing();
 
     // Memory Usage Graph
     {
-        ImGui::Text("Memory Usage: %.1f MB", m_monitor ? m_monitor->GetMemoryUsageMB() : 0.0f);
-        ImGui::PlotLines("##MemoryUsage", m_memoryHistory.data(), HISTORY_POINTS, m_historyIndex,
-            nullptr, 0.0f, 1024.0f, ImVec2(ImGui::GetContentRegionAvail().x, graphHeight));
+        ImGui::Text("Memory Usage: %.1f MB", m_monitor ? m_monitor->GetTotalMemoryUsageMB() : 0.0f);
+        if (showGraphs) {
+            RenderMetricGraph("##MemoryUsage", m_monitor->GetMetricSeries(Metric::MemoryMB), span, 0.0f,
+                MEMORY_GRAPH_MAX_MB, graphHeight);
+        }
 
         // Memory threshold line
-        if (m_settings.memoryThresholdMB > 0 && m_settings.memoryThresholdMB < 1024) {
+        if (showGraphs && m_settings.memoryThresholdMB > 0 && m_settings.memoryThresholdMB < MEMORY_GRAPH_MAX_MB) {
             ImDrawList* drawList = ImGui::GetWindowDrawList();
-            const ImVec2 p1 = ImGui::GetItemRectMin() + ImVec2(0, graphHeight * (1.0f - m_settings.memoryThresholdMB / 1024.0f));
+            const ImVec2 p1 = ImGui::GetItemRectMin() + ImVec2(0, graphHeight * (1.0f - m_settings.memoryThresholdMB / MEMORY_GRAPH_MAX_MB));
             const ImVec2 p2 = ImVec2(ImGui::GetItemRectMax().x, p1.y);
             drawList->AddLine(p1, p2, IM_COL32(255, 0, 0, 128), 1.0f);
         }
+
+        // Per process type: private bytes (commit), working set, private working set
+        if (m_monitor) {
+            const ProcessTreeMemory& tree = m_monitor->GetProcessTreeMemory();
+            for (size_t i = 0; i < static_cast<size_t>(OverlayProcessType::Count); i++) {
+                const ProcessMemoryUsage& usage = tree.byType[i];
+                if (usage.processCount == 0) continue;
+                ImGui::TextDisabled("%s (%u): %.1f MB private | %.1f MB working set | %.1f MB private WS",
+                    GetOverlayProcessTypeName(static_cast<OverlayProcessType>(i)), usage.processCount,
+                    usage.privateBytes / (1024.0f * 1024.0f), usage.workingSetBytes / (1024.0f * 1024.0f),
+                    usage.privateWorkingSetBytes / (1024.0f * 1024.0f));
+            }
+            if (!tree.valid) {
+                ImGui::TextDisabled("Subprocesses not counted (job object unavailable)");
+            }
+        }
     }
 
     ImGui::Spacing();
@@ -167,8 +307,612 @@ void PerformanceSettingsPage::RenderResourceUsageGraphs() {
     {
         float currentFrameTime = m_monitor ? 1000.0f / m_monitor->GetFramesPerSecond() : 0.0f;
         ImGui::Text("Frame Time: %.2f ms (%.1f FPS)", currentFrameTime, m_monitor ? m_monitor->GetFramesPerSecond() : 0.0f);
-        ImGui::PlotLines("##FrameTime", m_frameTimeHistory.data(), HISTORY_POINTS, m_historyIndex,
-            nullptr, 0.0f, 33.3f, ImVec2(ImGui::GetContentRegionAvail().x, graphHeight));
+        if (m_monitor) {
+            // Frame time is present to present; only the work part is the overlay's cost
+            const FrameTimeBreakdown& breakdown = m_monitor->GetAverageFrameTimeBreakdown();
+            ImGui::TextDisabled("Work %.2f | Throttle %.2f | GPU wait %.2f | Present %.2f ms",
+                breakdown.workMs, breakdown.throttleMs, breakdown.gpuWaitMs, breakdown.presentMs);
+        }
+        if (showGraphs) {
+            RenderMetricGraph("##FrameTime", m_monitor->GetMetricSeries(Metric::FrameTimeMs), span, 0.0f, 33.3f, graphHeight);
+            RenderMetricGraph("##FrameWork", m_monitor->GetMetricSeries(Metric::FrameWorkMs), span, 0.0f, 16.7f, graphHeight);
+        }
+
+        // Distribution: averages hide the hitches
+        if (m_monitor) {
+            const FrameTimeHistogram& histogram = m_monitor->GetFrameTimeHistogram();
+            ImGui::SetNextItemWidth(100.0f);
+            if (ImGui::BeginCombo("Window##FrameTimeWindow", GetFrameTimeWindowName(static_cast<FrameTimeWindow>(m_frameTimeWindow)))) {
+                for (int i = 0; i < static_cast<int>(FrameTimeWindow::Count); i++) {
+                    if (ImGui::Selectable(GetFrameTimeWindowName(static_cast<FrameTimeWindow>(i)), m_frameTimeWindow == i)) {
+                        m_frameTimeWindow = i;
+                    }
+                }
+                ImGui::EndCombo();
+            }
+            FrameTimeWindow window = static_cast<FrameTimeWindow>(m_frameTimeWindow);
+            FrameTimePercentiles percentiles = histogram.GetPercentiles(window);
+            ImGui::SameLine();
+            ImGui::TextDisabled("p50 %.2f | p95 %.2f | p99 %.2f | p99.9 %.2f | max %.2f ms (%llu frames)",
+                percentiles.p50Ms, percentiles.p95Ms, percentiles.p99Ms, percentiles.p999Ms, percentiles.maxMs,
+                static_cast<unsigned long long>(percentiles.frames));
+
+            // Buckets from 0.5 ms to 128 ms; the tails beyond are folded into the edges
+            histogram.GetBucketCounts(window, m_frameTimeBuckets);
+            const unsigned first = FrameTimeHistogram::GetBucket(0.5f);
+            const unsigned last = FrameTimeHistogram::GetBucket(128.0f);
+            for (unsigned i = 0; i < first; i++) m_frameTimeBuckets[first] += m_frameTimeBuckets[i];
+            for (unsigned i = last + 1; i < FrameTimeHistogram::BUCKET_COUNT; i++) m_frameTimeBuckets[last] += m_frameTimeBuckets[i];
+            ImGui::PlotHistogram("##FrameTimeHistogram", m_frameTimeBuckets.data() + first, static_cast<int>(last - first + 1),
+                0, "0.5 ms - 128 ms (log)", 0.0f, FLT_MAX, ImVec2(ImGui::GetContentRegionAvail().x, graphHeight));
+        }
+
+        // What reached the screen, from the swap chain's statistics
+        if (m_monitor && m_monitor->GetDisplayStatistics().valid) {
+            const DisplayStatistics& display = m_monitor->GetDisplayStatistics();
+            ImGui::TextDisabled("Displayed: %.1f FPS at %.1f Hz | Queued: %u | Missed vsyncs: %llu",
+                display.displayedFramesPerSecond, display.refreshRateHz, display.presentQueueDepth,
+                static_cast<unsigned long long>(display.missedVsyncs));
+            if (display.frameIntervalMs > 0.0f) {
+                ImGui::TextDisabled("Cadence: %.2f ms +/- %.2f ms%s", display.frameIntervalMs,
+                    display.frameIntervalJitterMs, display.variableRefresh ? " (variable refresh)" : "");
+            }
+            if (display.displayedPaints > 0) {
+                ImGui::TextDisabled("Browser paint to photon: %.1f ms (max %.1f ms) | Overwritten paints: %.0f%%",
+                    display.paintToPhotonMs, display.paintToPhotonMaxMs, m_monitor->GetOverwrittenPaintPercent());
+            }
+        }
+
+        // Render thread time given to CEF's message loop, within each frame's budget
+        if (m_monitor && m_monitor->GetCefPumpStats().frames > 0) {
+            const CefPumpStats& pump = m_monitor->GetCefPumpStats();
+            ImGui::TextDisabled("CEF pump: %.2f ms/frame (max %.1f ms, slice %.1f ms) | Deferred: %.0f%% of frames",
+                pump.averageFrameMs, pump.maxFrameMs, pump.maxSliceMs, 100.0 * pump.deferredFrames / pump.frames);
+        }
+
+        // Input to photon, one line per configuration tried this session
+        if (m_monitor) {
+            bool measureInput = IsInputLatencyMeasurementEnabled();
+            if (ImGui::Checkbox("Measure Input Latency", &measureInput)) {
+                SetInputLatencyMeasurement(measureInput);
+            }
+            for (const auto& results : m_monitor->GetInputLatencyResults()) {
+                const InputLatencyConfiguration& configuration = results->configuration;
+                FrameTimePercentiles p = results->histogram.GetPercentiles(FrameTimeWindow::Session);
+                ImGui::TextDisabled("%s%s, %u in flight, %s: p50 %.1f | p95 %.1f | p99 %.1f | max %.1f ms (%llu)",
+                    results.get() == m_monitor->GetCurrentInputLatencyResults() ? "> " : "  ",
+                    configuration.frameLatencyWait ? "Waitable" : "No wait", configuration.framesInFlight,
+                    configuration.rawInputThread ? "input thread" : "hook", p.p50Ms, p.p95Ms, p.p99Ms, p.maxMs,
+                    static_cast<unsigned long long>(p.frames));
+            }
+            if (const InputLatencyResults* current = m_monitor->GetCurrentInputLatencyResults()) {
+                // 2 ms to 256 ms; the tails are folded into the edges
+                current->histogram.GetBucketCounts(FrameTimeWindow::Session, m_inputLatencyBuckets);
+                const unsigned first = FrameTimeHistogram::GetBucket(2.0f);
+                const unsigned last = FrameTimeHistogram::GetBucket(256.0f);
+                for (unsigned i = 0; i < first; i++) m_inputLatencyBuckets[first] += m_inputLatencyBuckets[i];
+                for (unsigned i = last + 1; i < FrameTimeHistogram::BUCKET_COUNT; i++) m_inputLatencyBuckets[last] += m_inputLatencyBuckets[i];
+                ImGui::PlotHistogram("##InputLatencyHistogram", m_inputLatencyBuckets.data() + first, static_cast<int>(last - first + 1),
+                    0, "Input to photon, 2 ms - 256 ms (log)", 0.0f, FLT_MAX, ImVec2(ImGui::GetContentRegionAvail().x, graphHeight));
+            }
+        }
+    }
+}
+
+static float ToMB(UINT64 bytes) {
+    return static_cast<float>(bytes) / (1024.0f * 1024.0f);
+}
+
+static const char* GetDescriptorHeapName(D3D12_DESCRIPTOR_HEAP_TYPE type) {
+    switch (type) {
+    case D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV: return "CBV/SRV/UAV";
+    case D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER: return "Sampler";
+    case D3D12_DESCRIPTOR_HEAP_TYPE_RTV: return "RTV";
+    case D3D12_DESCRIPTOR_HEAP_TYPE_DSV: return "DSV";
+    default: return "Unknown";
+    }
+}
+
+void PerformanceSettingsPage::RenderGpuMemoryReport() {
+    if (!m_resourceManager) return;
+
+    ImGui::Spacing();
+    if (!ImGui::CollapsingHeader("GPU Memory")) return;
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_memoryReportTime >= std::chrono::milliseconds(MEMORY_REPORT_INTERVAL_MS)) {
+        m_memoryReport = m_resourceManager->GetMemoryReport();
+        if (m_renderSystem) {
+            m_allocatorStats = m_renderSystem->GetCommandAllocatorStats();
+        }
+        m_memoryReportTime = now;
+    }
+    const ResourceManager::MemoryReport& report = m_memoryReport;
+
+    // Budget (local video memory; shrinks when the game needs more)
+    const auto& budget = report.budget;
+    if (budget.budgetBytes > 0) {
+        float fraction = static_cast<float>(budget.usageBytes) / static_cast<float>(budget.budgetBytes);
+        char overlay[64];
+        snprintf(overlay, sizeof(overlay), "%.1f / %.1f MB", ToMB(budget.usageBytes), ToMB(budget.budgetBytes));
+        if (budget.overBudget) ImGui::PushStyleColor(ImGuiCol_PlotHistogram, IM_COL32(220, 60, 60, 255));
+        ImGui::Text("Video memory budget");
+        ImGui::ProgressBar(std::min(fraction, 1.0f), ImVec2(-1, 0), overlay);
+        if (budget.overBudget) ImGui::PopStyleColor();
+        ImGui::TextDisabled("Shared memory: %.1f / %.1f MB | Evicted resources: %u",
+            ToMB(report.nonLocalUsageBytes), ToMB(report.nonLocalBudgetBytes), budget.evictedCount);
+    }
+    ImGui::Text("Tracked: %.1f MB | Committed to video memory: %.1f MB",
+        ToMB(report.trackedBytes), ToMB(report.committedBytes));
+
+    // Where it goes, sortable by any column
+    struct Row {
+        const char* name;
+        UINT count;
+        UINT64 bytes;
+    };
+    std::vector<Row> rows;
+    for (int i = 0; i < static_cast<int>(ResourceType::Count); i++) {
+        if (report.countByType[i] == 0) continue;
+        rows.push_back({ ResourceManager::GetResourceTypeName(static_cast<ResourceType>(i)),
+            report.countByType[i], report.bytesByType[i] });
+    }
+    rows.push_back({ "Texture pool (cached)", report.texturePoolCount, report.texturePoolBytes });
+    rows.push_back({ "Placed heap free blocks", report.placedHeaps.freeBlockCount,
+        report.placedHeaps.heapBytes - report.placedHeaps.usedBytes });
+    rows.push_back({ "Upload ring", 1, report.uploadRingSize });
+
+    const ImGuiTableFlags tableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Sortable |
+        ImGuiTableFlags_SizingStretchProp;
+    if (ImGui::BeginTable("GpuMemoryTable", 4, tableFlags)) {
+        ImGui::TableSetupColumn("Category", ImGuiTableColumnFlags_DefaultSort);
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("MB", ImGuiTableColumnFlags_PreferSortDescending);
+        ImGui::TableSetupColumn("% of committed", ImGuiTableColumnFlags_PreferSortDescending);
+        ImGui::TableHeadersRow();
+
+        if (ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs()) {
+            if (sortSpecs->SpecsCount > 0) {
+                const ImGuiTableColumnSortSpecs& spec = sortSpecs->Specs[0];
+                bool ascending = spec.SortDirection == ImGuiSortDirection_Ascending;
+                std::sort(rows.begin(), rows.end(), [&](const Row& a, const Row& b) {
+                    int order = 0;
+                    switch (spec.ColumnIndex) {
+                    case 0: order = strcmp(a.name, b.name); break;
+                    case 1: order = (a.count > b.count) - (a.count < b.count); break;
+                    default: order = (a.bytes > b.bytes) - (a.bytes < b.bytes); break;
+                    }
+                    return ascending ? order < 0 : order > 0;
+                });
+            }
+        }
+
+        for (const Row& row : rows) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(row.name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", row.count);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", ToMB(row.bytes));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f%%", report.committedBytes > 0 ?
+                100.0f * static_cast<float>(row.bytes) / static_cast<float>(report.committedBytes) : 0.0f);
+        }
+        ImGui::EndTable();
+    }
+
+    // Placed heaps: free space split into small blocks can't hold a large texture
+    const auto& heaps = report.placedHeaps;
+    UINT64 freeBytes = heaps.heapBytes - heaps.usedBytes;
+    float fragmentation = freeBytes > 0 ?
+        1.0f - static_cast<float>(heaps.largestFreeBlock) / static_cast<float>(freeBytes) : 0.0f;
+    ImGui::Text("Placed heaps: %u pages, %.1f / %.1f MB used by %u resources, %.0f%% fragmented",
+        heaps.heapCount, ToMB(heaps.usedBytes), ToMB(heaps.heapBytes), heaps.allocationCount,
+        std::max(fragmentation, 0.0f) * 100.0f);
+
+    // Descriptor heaps
+    for (const auto& fill : report.descriptorHeaps) {
+        char overlay[64];
+        snprintf(overlay, sizeof(overlay), "%u / %u", fill.used, fill.capacity);
+        ImGui::Text("%s descriptors", GetDescriptorHeapName(fill.type));
+        ImGui::SameLine(160.0f);
+        ImGui::ProgressBar(fill.capacity > 0 ? static_cast<float>(fill.used) / fill.capacity : 0.0f,
+            ImVec2(-1, 0), overlay);
+        if (fill.transientCapacity > 0) {
+            ImGui::TextDisabled("  Transient ring: %u / %u", fill.transientUsed, fill.transientCapacity);
+        }
+    }
+
+    // Pools and queues
+    UINT64 acquires = report.texturePoolHits + report.texturePoolMisses;
+    ImGui::Text("Texture pool: %.1f / %.1f MB, hit rate %.0f%% (%llu acquires)",
+        ToMB(report.texturePoolBytes), ToMB(report.texturePoolLimit),
+        acquires > 0 ? 100.0 * report.texturePoolHits / acquires : 0.0, acquires);
+    ImGui::Text("Upload ring: %.1f / %.1f MB in flight, %llu overflows",
+        ToMB(report.uploadRingUsed), ToMB(report.uploadRingSize), report.uploadRingOverflows);
+    ImGui::Text("Retire queue: %zu objects waiting for the GPU", report.retiredCount);
+    if (m_renderSystem) {
+        const CommandAllocatorPool::Stats& allocators = m_allocatorStats;
+        ImGui::Text("Command allocators: %u (%u in flight, %u free), %.0f%% recycled, %llu created / %llu freed",
+            allocators.totalAllocators, allocators.inFlightAllocators, allocators.freeAllocators,
+            allocators.acquires > 0 ? 100.0 * allocators.recycled / allocators.acquires : 0.0,
+            allocators.created, allocators.destroyed);
+
+        // Transients that don't overlap in the frame share memory
+        const RenderGraph::Stats graph = m_renderSystem->GetRenderGraphStats();
+        ImGui::Text("Render graph: %u transients, %.1f MB heap for %.1f MB, %u barriers in %u batches, %llu placements",
+            graph.transientCount, ToMB(graph.heapBytes), ToMB(graph.transientBytes), graph.barriers,
+            graph.barrierBatches, graph.placements);
+    }
+}
+
+void PerformanceSettingsPage::RenderCpuTimeline() {
+    ImGui::Spacing();
+    bool open = ImGui::CollapsingHeader("CPU Timeline");
+    CpuProfiler::SetEnabled(CpuProfilerClient::Timeline, open && CpuProfiler::IsCompiledIn());
+    if (!open) return;
+
+    if (!CpuProfiler::IsCompiledIn()) {
+        ImGui::TextDisabled("Built without GAMEOVERLAY_CPU_PROFILER");
+        return;
+    }
+
+    ImGui::Checkbox("Pause##CpuTimeline", &m_profilePaused);
+    if (!m_profilePaused) {
+        CpuProfiler::CaptureLastFrame(m_profileFrame);
+    }
+    const CpuProfileFrame& frame = m_profileFrame;
+    if (frame.endTicks <= frame.beginTicks || frame.ticksPerMs <= 0.0) {
+        ImGui::TextDisabled("Waiting for a frame...");
+        return;
+    }
+
+    const double frameTicks = static_cast<double>(frame.endTicks - frame.beginTicks);
+    ImGui::SameLine();
+    ImGui::TextDisabled("Last frame: %.2f ms", frameTicks / frame.ticksPerMs);
+    ImGui::PushID("CpuTimeline");
+    RenderProfileLanes(frame);
+    ImGui::PopID();
+}
+
+void PerformanceSettingsPage::RenderSubsystemCpu() {
+    ImGui::Spacing();
+    if (!m_monitor || !ImGui::CollapsingHeader("CPU by Subsystem")) return;
+
+    // Cycles of this process only; CEF's renderer and GPU processes are separate processes
+    const auto& subsystems = m_monitor->GetSubsystemCpu();
+    const ImGuiTableFlags tableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingStretchProp;
+    if (ImGui::BeginTable("SubsystemCpu", 5, tableFlags)) {
+        ImGui::TableSetupColumn("Subsystem");
+        ImGui::TableSetupColumn("Threads");
+        ImGui::TableSetupColumn("Mcycles/s");
+        ImGui::TableSetupColumn("Share");
+        ImGui::TableSetupColumn("CPU");
+        ImGui::TableHeadersRow();
+        for (size_t i = 0; i < subsystems.size(); i++) {
+            const SubsystemCpu& cpu = subsystems[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(GetThreadSubsystemName(static_cast<ThreadSubsystem>(i)));
+            ImGui::TableNextColumn();
+            if (static_cast<ThreadSubsystem>(i) == ThreadSubsystem::Other) ImGui::TextDisabled("-");
+            else ImGui::Text("%u", cpu.threads);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", cpu.megacyclesPerSecond);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f%%", cpu.sharePercent);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f%%", cpu.cpuPercent);
+        }
+        ImGui::EndTable();
+    }
+}
+
+void PerformanceSettingsPage::RenderAllocations() {
+    ImGui::Spacing();
+    if (!m_monitor || !ImGui::CollapsingHeader("Allocations")) return;
+
+    if (!AllocationTracker::IsCompiledIn()) {
+        ImGui::TextDisabled("Built without GAMEOVERLAY_ALLOCATION_TRACKING");
+        return;
+    }
+
+    const AllocationCounters& frame = m_monitor->GetLastFrameAllocations();
+    ImGui::Text("Last frame: %llu allocations, %.1f KB (max %llu per frame)",
+        static_cast<unsigned long long>(frame.allocations), frame.bytes / 1024.0,
+        static_cast<unsigned long long>(m_monitor->GetMaxFrameAllocations()));
+    if (m_monitor->GetSteadyStateFrames() > 0) {
+        ImGui::Text("Steady-state frames allocating: %llu of %llu",
+            static_cast<unsigned long long>(m_monitor->GetSteadyStateAllocatingFrames()),
+            static_cast<unsigned long long>(m_monitor->GetSteadyStateFrames()));
+    }
+
+    bool perZone = AllocationTracker::IsZoneAttributionEnabled();
+    if (ImGui::Checkbox("Attribute to zones", &perZone)) {
+        AllocationTracker::SetZoneAttributionEnabled(perZone);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Charge each allocation to the innermost PROFILE_ZONE it was made in");
+    }
+    if (!perZone) return;
+
+    ZoneAllocations zones[8];
+    size_t zoneCount = AllocationTracker::GetLastFrameZones(zones, std::size(zones));
+    if (zoneCount == 0) {
+        ImGui::TextDisabled("No allocations in zones last frame");
+        return;
+    }
+    const ImGuiTableFlags tableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingStretchProp;
+    if (ImGui::BeginTable("AllocationZones", 3, tableFlags)) {
+        ImGui::TableSetupColumn("Zone");
+        ImGui::TableSetupColumn("Allocations");
+        ImGui::TableSetupColumn("KB");
+        ImGui::TableHeadersRow();
+        for (size_t i = 0; i < zoneCount; i++) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(zones[i].name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(zones[i].counters.allocations));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", zones[i].counters.bytes / 1024.0);
+        }
+        ImGui::EndTable();
+    }
+}
+
+void PerformanceSettingsPage::RenderNavigationTimings() {
+    ImGui::Spacing();
+    if (!m_monitor || !ImGui::CollapsingHeader("Page Loads")) return;
+
+    const std::vector<DomainLoadStats>& domains = m_monitor->GetDomainLoadStats();
+    if (domains.empty()) {
+        ImGui::TextDisabled("No page loads measured yet");
+        return;
+    }
+    ImGui::TextDisabled("%llu loads since startup, slowest sites first. Renderer CPU covers every tab.",
+        static_cast<unsigned long long>(m_monitor->GetNavigationCount()));
+
+    const ImGuiTableFlags tableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingStretchProp;
+    if (ImGui::BeginTable("PageLoads", 7, tableFlags)) {
+        ImGui::TableSetupColumn("Domain");
+        ImGui::TableSetupColumn("Loads");
+        ImGui::TableSetupColumn("First paint ms");
+        ImGui::TableSetupColumn("Load ms");
+        ImGui::TableSetupColumn("Max ms");
+        ImGui::TableSetupColumn("KB");
+        ImGui::TableSetupColumn("Renderer CPU ms");
+        ImGui::TableHeadersRow();
+        for (const DomainLoadStats& stats : domains) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(stats.domain.c_str());
+            if (ImGui::IsItemHovered()) {
+                // Load time histogram
+                ImGui::BeginTooltip();
+                float lowerMs = 0.0f;
+                for (size_t bucket = 0; bucket < DomainLoadStats::BUCKET_COUNT; bucket++) {
+                    if (bucket < DomainLoadStats::BUCKET_COUNT - 1) {
+                        float upperMs = DomainLoadStats::BUCKET_LIMITS_MS[bucket];
+                        ImGui::Text("%.1f-%.1f s: %u", lowerMs / 1000.0f, upperMs / 1000.0f, stats.loadMsBuckets[bucket]);
+                        lowerMs = upperMs;
+                    }
+                    else {
+                        ImGui::Text("%.1f s and up: %u", lowerMs / 1000.0f, stats.loadMsBuckets[bucket]);
+                    }
+                }
+                ImGui::TextDisabled("Last: %s (%.0f ms)", stats.last.url.c_str(), stats.last.loadMs);
+                ImGui::EndTooltip();
+            }
+            ImGui::TableNextColumn();
+            if (stats.failures > 0) {
+                ImGui::Text("%u (%u failed)", stats.loads, stats.failures);
+            }
+            else {
+                ImGui::Text("%u", stats.loads);
+            }
+            ImGui::TableNextColumn();
+            if (stats.paintedLoads > 0) {
+                ImGui::Text("%.0f", stats.firstPaintMsSum / stats.paintedLoads);
+            }
+            else {
+                ImGui::TextDisabled("-");
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f", stats.loadMsSum / stats.loads);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f", stats.maxLoadMs);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f", stats.bytes / 1024.0 / stats.loads);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f", stats.rendererCpuMsSum / stats.loads);
+        }
+        ImGui::EndTable();
+    }
+}
+
+void PerformanceSettingsPage::RenderPageMetrics() {
+    ImGui::Spacing();
+    if (!m_monitor || !ImGui::CollapsingHeader("Page Activity")) return;
+
+    const std::vector<PageMetrics>& pages = m_monitor->GetPageMetrics();
+    if (pages.empty()) {
+        ImGui::TextDisabled("No live browser tabs reported yet");
+        return;
+    }
+    ImGui::TextDisabled("Renderer main thread of each live tab (* visible), from DevTools every few seconds");
+
+    const ImGuiTableFlags tableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingStretchProp;
+    if (ImGui::BeginTable("PageActivity", 6, tableFlags)) {
+        ImGui::TableSetupColumn("Page");
+        ImGui::TableSetupColumn("Busy %");
+        ImGui::TableSetupColumn("Script %");
+        ImGui::TableSetupColumn("Layout %");
+        ImGui::TableSetupColumn("JS heap MB");
+        ImGui::TableSetupColumn("Nodes");
+        ImGui::TableHeadersRow();
+        for (const PageMetrics& page : pages) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s%s", page.active ? "* " : "", page.url.c_str());
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Layouts: %llu (%.0f ms) | Style recalcs: %llu (%.0f ms)\nScript: %.0f ms | Tasks: %.0f ms | Listeners: %u | Documents: %u",
+                    static_cast<unsigned long long>(page.layoutCount), page.layoutMs,
+                    static_cast<unsigned long long>(page.recalcStyleCount), page.recalcStyleMs,
+                    page.scriptMs, page.taskMs, page.jsEventListeners, page.documents);
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f (avg %.0f)", page.mainThreadPercent, page.averageMainThreadPercent);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f", page.scriptPercent);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f", page.layoutPercent);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f / %.1f", page.jsHeapUsedMB, page.jsHeapTotalMB);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", page.nodes);
+        }
+        ImGui::EndTable();
+    }
+}
+
+void PerformanceSettingsPage::RenderHitchIncidents() {
+    ImGui::Spacing();
+    if (!m_monitor || !ImGui::CollapsingHeader("Hitches")) return;
+
+    HitchDetector& detector = m_monitor->GetHitchDetector();
+    bool enabled = detector.IsEnabled();
+    if (ImGui::Checkbox("Detect hitches", &enabled)) {
+        detector.SetEnabled(enabled);
+    }
+    if (enabled && CpuProfiler::IsCompiledIn()) {
+        ImGui::SameLine();
+        bool armed = detector.IsZoneCaptureArmed();
+        if (ImGui::Checkbox("Capture profiler zones", &armed)) {
+            detector.SetZoneCaptureArmed(armed);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Keeps the profiler recording so incidents include the zones before them");
+        }
+    }
+    float multiple = detector.GetThresholdMultiple();
+    if (ImGui::SliderFloat("Threshold", &multiple, 1.5f, 10.0f, "%.1fx median")) {
+        detector.SetThresholdMultiple(multiple);
+    }
+    ImGui::TextDisabled("Median: %.2f ms | Hitches since startup: %llu", detector.GetMedianMs(),
+        static_cast<unsigned long long>(detector.GetTotalHitches()));
+
+    const std::deque<HitchIncident>& incidents = detector.GetIncidents();
+    if (incidents.empty()) {
+        ImGui::TextDisabled("No incidents recorded");
+        return;
+    }
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Clear##Hitches")) {
+        detector.ClearIncidents();
+        return;
+    }
+
+    // Newest first; selection follows the frame index, since the ring shifts as incidents arrive
+    const HitchIncident* selected = nullptr;
+    for (auto it = incidents.rbegin(); it != incidents.rend(); ++it) {
+        const HitchIncident& incident = *it;
+        char repeats[24] = "";
+        if (incident.repeats > 0) snprintf(repeats, sizeof(repeats), "  +%u", incident.repeats);
+        char label[160];
+        snprintf(label, sizeof(label), "%02u:%02u:%02u.%03u  frame %llu  %.1f ms (%.1fx median)%s##%llu",
+            incident.localTime.wHour, incident.localTime.wMinute, incident.localTime.wSecond,
+            incident.localTime.wMilliseconds, static_cast<unsigned long long>(incident.frameIndex), incident.frameMs,
+            incident.medianMs > 0.0f ? incident.frameMs / incident.medianMs : 0.0f,
+            repeats, static_cast<unsigned long long>(incident.frameIndex));
+        bool isSelected = incident.frameIndex == m_selectedHitchFrame;
+        if (ImGui::Selectable(label, isSelected)) {
+            m_selectedHitchFrame = incident.frameIndex;
+            m_hitchExportPath.clear();
+            isSelected = true;
+        }
+        if (isSelected) selected = &incident;
+    }
+    if (!selected) return;
+
+    ImGui::Spacing();
+    if (selected->repeats > 0) {
+        ImGui::TextDisabled("%u more hitches within %lld ms", selected->repeats,
+            static_cast<long long>(HitchDetector::COOLDOWN_MS));
+    }
+    ImGui::TextDisabled("GPU frame: %.3f ms | CPU: %.1f%% | Memory: %.1f MB", selected->gpuFrameMs,
+        selected->cpuPercent, selected->memoryMB);
+    for (size_t i = 0; i < selected->gpuPassMs.size() && i < static_cast<size_t>(GpuPass::Count); i++) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("| %s: %.3f ms", GetGpuPassName(static_cast<GpuPass>(i)), selected->gpuPassMs[i]);
+    }
+
+    const CpuProfileFrame& profile = selected->profile;
+    if (profile.endTicks <= profile.beginTicks || profile.ticksPerMs <= 0.0) {
+        ImGui::TextDisabled(CpuProfiler::IsCompiledIn() ? "No profiler snapshot (the profiler wasn't recording)" :
+            "No profiler snapshot (built without GAMEOVERLAY_CPU_PROFILER)");
+        return;
+    }
+    if (ImGui::Button("Export Trace##Hitch")) {
+        std::string path = TraceCapture::MakeTracePath("hitch");
+        m_hitchExportPath = !path.empty() && TraceCapture::WriteChromeTrace(profile, path) ? path : "Export failed";
+    }
+    if (!m_hitchExportPath.empty()) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("%s", m_hitchExportPath.c_str());
+    }
+    ImGui::TextDisabled("Last %.0f ms before the frame ended", HitchDetector::SNAPSHOT_MS);
+    ImGui::PushID("HitchSnapshot");
+    RenderProfileLanes(profile);
+    ImGui::PopID();
+}
+
+void PerformanceSettingsPage::RenderProfileLanes(const CpuProfileFrame& frame) {
+    // One lane per thread, one row per nesting level, the range spanning the full width
+    const double frameTicks = static_cast<double>(frame.endTicks - frame.beginTicks);
+    const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    for (const CpuProfileThread& thread : frame.threads) {
+        ImGui::TextUnformatted(thread.name.c_str());
+
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        const float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+        const float height = rowHeight * static_cast<float>(thread.maxDepth + 1);
+        ImGui::InvisibleButton(thread.name.c_str(), ImVec2(width, height));
+        const bool laneHovered = ImGui::IsItemHovered();
+        const ImVec2 mouse = ImGui::GetIO().MousePos;
+        drawList->AddRectFilled(origin, ImVec2(origin.x + width, origin.y + height), IM_COL32(30, 30, 30, 160));
+
+        for (const CpuProfileZoneRecord& zone : thread.zones) {
+            double begin = static_cast<double>(std::max(zone.beginTicks, frame.beginTicks) - frame.beginTicks);
+            double end = static_cast<double>(std::min(zone.endTicks, frame.endTicks) - frame.beginTicks);
+            ImVec2 p0(origin.x + static_cast<float>(begin / frameTicks) * width, origin.y + rowHeight * zone.depth);
+            ImVec2 p1(std::max(origin.x + static_cast<float>(end / frameTicks) * width, p0.x + 1.0f),
+                origin.y + rowHeight * (zone.depth + 1) - 1.0f);
+
+            if (zone.type == CpuProfileRecordType::Instant) {
+                drawList->AddLine(ImVec2(p0.x, origin.y), ImVec2(p0.x, origin.y + height), IM_COL32(255, 220, 80, 255));
+                if (laneHovered && std::abs(mouse.x - p0.x) < 3.0f) {
+                    ImGui::SetTooltip("%s", zone.name);
+                }
+                continue;
+            }
+
+            // Stable color per zone name (FNV-1a)
+            uint32_t hash = 2166136261u;
+            for (const char* c = zone.name; *c; c++) hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+            ImU32 color = IM_COL32(80 + (hash & 0x7F), 80 + ((hash >> 8) & 0x7F), 80 + ((hash >> 16) & 0x7F), 255);
+            drawList->AddRectFilled(p0, p1, color);
+
+            if (p1.x - p0.x > ImGui::CalcTextSize(zone.name).x + 4.0f) {
+                drawList->AddText(ImVec2(p0.x + 2.0f, p0.y + 2.0f), IM_COL32(0, 0, 0, 255), zone.name);
+            }
+            if (laneHovered && mouse.x >= p0.x && mouse.x < p1.x && mouse.y >= p0.y && mouse.y < p1.y) {
+                ImGui::SetTooltip("%s: %.3f ms", zone.name,
+                    static_cast<double>(zone.endTicks - zone.beginTicks) / frame.ticksPerMs);
+            }
+        }
     }
 }
 
@@ -208,6 +952,8 @@ void PerformanceSettingsPage::RenderPerformancePresets() {
         m_settingsChanged = true;
     }
 
+    ImGui::Spacing();
+    RenderPowerCosts();
     ImGui::Spacing();
 
     // Current state information
@@ -273,6 +1019,41 @@ void PerformanceSettingsPage::RenderFrameRateSettings() {
         ImGui::SetTooltip("Maximum FPS when the overlay is not visible");
     }
 
+    // Limiter accuracy (frames it held back, last second)
+    if (m_optimizer) {
+        const FrameLimiterStats& limiter = m_optimizer->GetFrameLimiterStats();
+        if (limiter.valid) {
+            ImGui::TextDisabled("Limiter: %.0f%% within 0.2 ms | mean %.3f ms | overshoot %.3f ms | undershoot %.3f ms | spin %.2f ms%s",
+                limiter.withinToleranceRatio * 100.0f, limiter.meanErrorMs, limiter.maxOvershootMs,
+                limiter.maxUndershootMs, limiter.spinMarginMs, limiter.highResolutionTimer ? "" : " (legacy timer)");
+            if (limiter.phaseLockedFrames > 0) {
+                ImGui::TextDisabled("Phase lock: %u of %u frames, %.2f ms after each %s", limiter.phaseLockedFrames,
+                    limiter.frames, limiter.meanPhaseMs, limiter.phaseFromGamePresents ? "game present" : "vblank");
+            }
+        }
+    }
+
+    // Phase lock to the game's presents
+    changed |= ImGui::Checkbox("Phase-Lock to Game Presents", &m_settings.phaseLockToGame);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Start overlay frames just after the game presents, so overlay GPU work lands in the\n"
+            "game's idle time instead of the middle of its frame. Uses the compositor's vblank when\n"
+            "game presents aren't visible (ETW needs administrator rights).");
+    }
+    if (m_settings.phaseLockToGame) {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(150);
+        changed |= ImGui::SliderFloat("##PhaseOffset", &m_settings.phaseLockOffsetMs, 0.0f, 5.0f, "%.1f ms after");
+    }
+    if (m_monitor) {
+        const GamePresentSample& game = m_monitor->GetGamePresentSample();
+        if (game.valid) {
+            // Compare with the lock on and off: the game's judder is what it should lower
+            ImGui::TextDisabled("Game frame time: %.2f ms avg, %.2f ms std dev, %.2f ms max",
+                game.averageFrameMs, game.frameTimeStdDevMs, game.maxFrameMs);
+        }
+    }
+
     ImGui::Spacing();
 
     // VSync option
@@ -281,8 +1062,37 @@ void PerformanceSettingsPage::RenderFrameRateSettings() {
         ImGui::SetTooltip("Synchronize rendering with monitor refresh rate to reduce tearing");
     }
 
+    changed |= ImGui::Checkbox("Variable Refresh Rate", &m_settings.variableRefresh);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("On G-Sync / FreeSync displays, present as soon as frames are ready, capped just under the maximum refresh rate");
+    }
+    if (m_renderSystem && m_renderSystem->IsVariableRefreshActive()) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(capped at %.0f FPS)", m_renderSystem->GetVariableRefreshFrameRateCap());
+    }
+
+    // Power source
+    ImGui::Spacing();
+    changed |= ImGui::Checkbox("Low Power on Battery", &m_settings.lowPowerOnBattery);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Switch to low power mode on battery whenever the overlay is not in use");
+    }
+    changed |= ImGui::Checkbox("Low Power When Saving Energy", &m_settings.lowPowerWhenPowerSaving);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Stay in low power mode while battery saver or the power saver plan is on");
+    }
+    changed |= ImGui::Checkbox("Efficiency Mode When Not Active", &m_settings.ecoQoSWhenNotActive);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Let Windows run the overlay on efficient cores at lower clocks (EcoQoS) while it is not in use");
+    }
+    if (m_optimizer) {
+        ImGui::TextDisabled("Power: %s%s | Efficiency mode %s", m_optimizer->IsOnBattery() ? "battery" : "AC",
+            m_optimizer->IsPowerSaving() ? ", saving energy" : "", m_optimizer->IsEcoQoSActive() ? "on" : "off");
+    }
+
     if (changed) {
         m_settingsChanged = true;
+        m_pendingPreset = -1; // Hand edits: no longer the preset's numbers
     }
 }
 
@@ -302,6 +1112,16 @@ void PerformanceSettingsPage::RenderRenderQualitySettings() {
         ImGui::SetTooltip("Scale factor for rendering resolution (lower values improve performance)");
     }
 
+    changed |= ImGui::Checkbox("Scale in the Swap Chain", &m_settings.swapChainScaling);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Below scale 1.0, let the compositor or display stretch the frame instead of an upscale pass.\n"
+            "Saves the pass's GPU time (Upscale under GPU Usage), but no sharpening");
+    }
+    if (m_renderSystem && m_renderSystem->IsSwapChainScaling()) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(active)");
+    }
+
     ImGui::Spacing();
 
     // Adaptive resolution option
@@ -310,6 +1130,121 @@ void PerformanceSettingsPage::RenderRenderQualitySettings() {
         ImGui::SetTooltip("Automatically adjust resolution based on performance");
     }
 
+    if (m_settings.adaptiveResolution) {
+        changed |= ImGui::SliderFloat("Overlay GPU Budget", &m_settings.adaptiveGpuBudgetMs, 0.5f, 16.0f, "%.1f ms");
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("GPU time per frame the overlay may use; resolution is steered to stay within it");
+        }
+        if (m_optimizer) {
+            const AdaptiveResolutionController& controller = m_optimizer->GetResolutionController();
+            ImGui::Text("GPU %.2f ms, scale %.2f (target %.3f), browser quality %.3f",
+                controller.GetFilteredGpuMs(), controller.GetScale(),
+                controller.GetContinuousScale(), controller.GetBrowserQuality());
+        }
+    }
+
+    ImGui::Spacing();
+
+    // Component budget: lowest priority degrades first
+    changed |= ImGui::SliderFloat("Overlay Frame Budget", &m_settings.overlayFrameBudgetMs, 0.0f, 16.0f,
+        m_settings.overlayFrameBudgetMs > 0.0f ? "%.1f ms" : "Off");
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("CPU + GPU time per frame for the overlay's components. Over it, the graphs go first,\n"
+            "then the browser paint rate, then the render scale, one step at a time");
+    }
+    if (m_optimizer && m_settings.overlayFrameBudgetMs > 0.0f) {
+        ImGui::Text("Components: %.2f ms", m_optimizer->GetComponentCostMs());
+        for (const PerformanceOptimizer::ComponentStatus& component : m_optimizer->GetComponentStatus()) {
+            if (component.maxDegradeLevel == 0) continue;
+            ImGui::TextDisabled("%s: %.2f ms CPU, %.2f ms GPU, step %d / %d", component.name.c_str(),
+                component.cpuMs, component.gpuMs, component.degradeLevel, component.maxDegradeLevel);
+        }
+    }
+
+    ImGui::Spacing();
+
+    // Partial presentation options
+    changed |= ImGui::Checkbox("Partial Presentation", &m_settings.partialPresentation);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Only hand the areas covered by UI to the compositor each frame");
+    }
+
+    changed |= ImGui::Checkbox("Show Presented Regions", &m_settings.showPresentRects);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Outline the dirty rectangles submitted with each present");
+    }
+
+    changed |= ImGui::SliderInt("Frames in Flight", &m_settings.framesInFlight, 1, 3);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Frames recorded ahead of the GPU: 1 has the lowest latency, fewer also use less memory");
+    }
+
+    // GPU priority relative to the game
+    static const char* yieldPolicyNames[] = { "Never", "When Game Is GPU-Bound", "Always" };
+    changed |= ImGui::Combo("Yield GPU to Game", &m_settings.gpuYieldPolicy, yieldPolicyNames, IM_ARRAYSIZE(yieldPolicyNames));
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Lower the overlay's and the browser's GPU scheduling priority and slow image uploads,\n"
+            "so the game's frames are scheduled first");
+    }
+    if (m_settings.gpuYieldPolicy == static_cast<int>(GpuYieldPolicy::WhenGameGpuBound)) {
+        changed |= ImGui::SliderFloat("GPU-Bound Above", &m_settings.gameGpuBoundPercent, 50.0f, 100.0f, "%.0f%% 3D use");
+    }
+    if (m_optimizer) {
+        ImGui::Text("GPU Priority: %s", m_optimizer->IsGpuPriorityYielded() ? "Yielded" : "Normal");
+    }
+    if (m_monitor) {
+        // Game frame time while GPU-bound, with and without the overlay yielding
+        float normalMs = 0.0f, yieldedMs = 0.0f;
+        bool haveNormal = m_monitor->GetGpuBoundGameFrameMs(false, normalMs);
+        bool haveYielded = m_monitor->GetGpuBoundGameFrameMs(true, yieldedMs);
+        if (haveNormal && haveYielded) {
+            ImGui::Text("GPU-bound game: %.2f ms normal, %.2f ms yielded (%.2f ms saved)",
+                normalMs, yieldedMs, normalMs - yieldedMs);
+        }
+        else if (haveNormal || haveYielded) {
+            ImGui::TextDisabled("GPU-bound game: %.2f ms %s (no comparison yet)",
+                haveNormal ? normalMs : yieldedMs, haveNormal ? "normal" : "yielded");
+        }
+    }
+
+    if (m_monitor) {
+        ImGui::Text("Presented Area: %.1f%%", m_monitor->GetPresentedAreaPercent());
+        ImGui::Text("Presentation: %s", GetPresentationModeName(m_monitor->GetPresentationMode()));
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Hardware Overlay means DWM scans the overlay out on its own plane instead of composing it");
+        }
+        ImGui::Text("Overlay Plane Support: %s", m_monitor->IsOverlayPlaneSupported() ? "Yes" : "No");
+        ImGui::Text("Time to First Frame: %.0f ms", m_monitor->GetTimeToFirstFrameMs());
+        if (m_monitor->GetTimeToFirstBrowserPaintMs() > 0.0f) {
+            ImGui::Text("Time to First Browser Paint: %.0f ms", m_monitor->GetTimeToFirstBrowserPaintMs());
+        }
+        else {
+            ImGui::Text("Time to First Browser Paint: -");
+        }
+        const TextEmissionBenchmark& textEmission = m_monitor->GetTextEmissionBenchmark();
+        if (textEmission.frames > 0) {
+            ImGui::Text("Text Emission: scalar %.3f ms, %s %.3f ms (%d vertices)", textEmission.scalarMs,
+                textEmission.kernel, textEmission.batchedMs, textEmission.vertices);
+        }
+        else {
+            ImGui::Text("Text Emission: %s", ImGuiSystem::GetVertexEmissionKernelName());
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Benchmark")) {
+            m_monitor->RequestTextEmissionBenchmark(); // Runs before the next frame's UI build
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Times the UI build with scalar and SIMD vertex emission, alternating");
+        }
+        if (m_monitor->GetWakeCount() > 0) {
+            ImGui::Text("Wake From Resident: %.1f ms (max %.1f ms, %llu wakes)", m_monitor->GetLastWakeLatencyMs(),
+                m_monitor->GetMaxWakeLatencyMs(), static_cast<unsigned long long>(m_monitor->GetWakeCount()));
+        }
+        else {
+            ImGui::Text("Wake From Resident: -");
+        }
+    }
+
     ImGui::Spacing();
 
     // Resource usage thresholds
@@ -317,10 +1252,11 @@ void PerformanceSettingsPage::RenderRenderQualitySettings() {
 
     changed |= ImGui::SliderFloat("CPU Threshold", &m_settings.cpuThresholdPercent, 40.0f, 95.0f, "%.0f%%");
     changed |= ImGui::SliderFloat("GPU Threshold", &m_settings.gpuThresholdPercent, 40.0f, 95.0f, "%.0f%%");
-    changed |= ImGui::SliderFloat("Memory Threshold", &m_settings.memoryThresholdMB, 128.0f, 1024.0f, "%.0f MB");
+    changed |= ImGui::SliderFloat("Memory Threshold", &m_settings.memoryThresholdMB, 256.0f, 4096.0f, "%.0f MB");
 
     if (changed) {
         m_settingsChanged = true;
+        m_pendingPreset = -1;
     }
 }
 
@@ -353,11 +1289,173 @@ void PerformanceSettingsPage::RenderBrowserSettings() {
         ImGui::SetTooltip("Completely suspend browser processing when overlay is not visible");
     }
 
+    ImGui::Spacing();
+
+    // Tab budget
+    ImGui::Text("Max Live Browser Tabs:");
+    changed |= ImGui::SliderInt("##MaxLiveTabs", &m_settings.maxLiveBrowserTabs, 1, 16);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Least recently used tabs beyond this count are unloaded and reloaded when selected");
+    }
+
+    changed |= ImGui::Checkbox("Unload Background Tabs When Hidden", &m_settings.discardBackgroundTabs);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Unload every tab except the current one while the overlay is hidden or in low power mode");
+    }
+
+    ImGui::Text("Unload Busy Background Tabs:");
+    changed |= ImGui::SliderFloat("##HeavyPageCpu", &m_settings.heavyPageCpuPercent, 0.0f, 100.0f,
+        m_settings.heavyPageCpuPercent > 0.0f ? "above %.0f%% busy" : "never");
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("A background tab whose page keeps its renderer's main thread this busy is unloaded, and reloaded when selected. 0 = never.");
+    }
+
+    changed |= ImGui::Checkbox("Start Browser When First Opened", &m_settings.deferBrowserStartup);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Don't start the browser engine until the Browser page is opened");
+    }
+
+    changed |= ImGui::Checkbox("Preconnect Hovered Links", &m_settings.preconnectOnHover);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Resolve and connect to a link's site while the pointer is on it (off in low power mode)");
+    }
+    changed |= ImGui::Checkbox("Prerender Hovered Links", &m_settings.prerenderOnHover);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Load a link in a hidden tab when the pointer rests on it, so clicking shows it at once.\n"
+            "Only while the overlay is active and within the memory budget.");
+    }
+
+    // GPU policy, chosen from the state the overlay is in when the browser starts
+    ImGui::Spacing();
+    ImGui::Text("Browser GPU Mode:");
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Software modes keep the browser off the GPU the game is using; static pages barely notice.\n"
+            "The mode for the current state is applied when the browser starts.");
+    }
+    static const char* stateNames[] = { "Active", "Inactive", "Background", "Low Power" };
+    const char* policyNames[static_cast<int>(BrowserGpuPolicy::Count)];
+    for (int i = 0; i < static_cast<int>(BrowserGpuPolicy::Count); i++) {
+        policyNames[i] = GetBrowserGpuPolicyName(static_cast<BrowserGpuPolicy>(i));
+    }
+    for (int i = 0; i < 4; i++) {
+        ImGui::PushID(i);
+        ImGui::SetNextItemWidth(260.0f);
+        changed |= ImGui::Combo(stateNames[i], &m_settings.browserGpuPolicy[i], policyNames, IM_ARRAYSIZE(policyNames));
+        ImGui::PopID();
+    }
+
+    ImGui::Spacing();
+    ImGui::Text("Paint Upload Budget per Frame:");
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Larger software paints are copied over several frames and shown once complete,\n"
+            "so a full repaint doesn't spike one frame. 0 = no limit.");
+    }
+    for (int i = 0; i < 4; i++) {
+        ImGui::PushID(i + 4);
+        ImGui::SetNextItemWidth(260.0f);
+        changed |= ImGui::SliderFloat(stateNames[i], &m_settings.browserUploadBudgetMB[i], 0.0f, 64.0f, "%.0f MB");
+        ImGui::PopID();
+    }
+
+    // Measured cost of each mode this session
+    if (m_monitor) {
+        BrowserGpuPolicy runningPolicy;
+        if (m_monitor->GetBrowserGpuPolicy(runningPolicy)) {
+            ImGui::Text("Running: %s", GetBrowserGpuPolicyName(runningPolicy));
+        }
+        BrowserUploadPath uploadPath;
+        if (m_monitor->GetBrowserUploadPath(uploadPath)) {
+            ImGui::Text("Paint upload: %s", GetBrowserUploadPathName(uploadPath));
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("GPU upload heaps need Resizable BAR; software paints then skip the copy into VRAM.");
+            }
+        }
+        const BrowserTileStats& tiles = m_monitor->GetBrowserTileStats();
+        if (tiles.hashedTiles > 0) {
+            ImGui::Text("Unchanged tiles: %.1f%% (%.1f MB uploaded of %.1f MB dirty)",
+                100.0 * tiles.unchangedTiles / tiles.hashedTiles,
+                m_monitor->GetBrowserUploadedBytes() / (1024.0 * 1024.0), tiles.dirtyBytes / (1024.0 * 1024.0));
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Dirty regions are split into 64x64 tiles; tiles whose pixels hash the same as last time are not uploaded.");
+            }
+        }
+        if (tiles.scrollPaints > 0) {
+            ImGui::Text("Scrolls moved on the GPU: %llu (%.1f MB not uploaded)",
+                static_cast<unsigned long long>(tiles.scrollPaints), tiles.scrollMovedBytes / (1024.0 * 1024.0));
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Scrolled paints shift the shown texture on the GPU and upload only the rows that came into view.");
+            }
+        }
+        for (int i = 0; i < static_cast<int>(BrowserGpuPolicy::Count); i++) {
+            float cpuPercent = 0.0f, gpuMs = 0.0f;
+            if (m_monitor->GetBrowserGpuPolicyCost(static_cast<BrowserGpuPolicy>(i), cpuPercent, gpuMs)) {
+                ImGui::Text("  %s: CPU %.1f%%, GPU %.2f ms/frame", policyNames[i], cpuPercent, gpuMs);
+            }
+        }
+    }
+
     if (changed) {
         m_settingsChanged = true;
+        m_pendingPreset = -1;
     }
 }
 
+void PerformanceSettingsPage::RenderGameProfiles() {
+    RenderSectionHeader("Game Profiles");
+    if (!m_optimizer) return;
+
+    const std::string& game = m_optimizer->GetForegroundGame();
+    if (game.empty()) {
+        ImGui::TextDisabled("No game detected yet; profiles apply when a game takes the foreground");
+        return;
+    }
+
+    GameProfileStore& profiles = m_optimizer->GetGameProfiles();
+    const GameProfile* active = m_optimizer->GetActiveGameProfile();
+    ImGui::Text("Game: %s (%s)", game.c_str(), active ? "profile active" : "no profile");
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("The profile's frame caps, render scale, budget and GPU policies replace the settings\n"
+            "above while this game has focus. Browser GPU policy changes apply when the browser next starts.");
+    }
+
+    // Panels that keep running while the game has focus, saved with the profile
+    GameProfile profile = m_optimizer->CaptureGameProfile(game);
+    if (!active) {
+        std::copy(std::begin(m_profilePanels), std::end(m_profilePanels), profile.panelsAllowed);
+    }
+    for (size_t i = 0; i < static_cast<size_t>(OverlayPanel::Count); i++) {
+        std::string label = std::string("Run ") + GetOverlayPanelName(static_cast<OverlayPanel>(i)) + " In Game";
+        if (ImGui::Checkbox(label.c_str(), &profile.panelsAllowed[i]) && active) {
+            profiles.Set(profile);
+            profiles.Save();
+            ReapplyGameProfile();
+        }
+        m_profilePanels[i] = profile.panelsAllowed[i];
+    }
+
+    // Saves the applied settings; unapplied edits go in first
+    if (ImGui::Button(active ? "Update Profile" : "Save Profile For This Game", ImVec2(200, 0))) {
+        if (m_settingsChanged) {
+            ApplySettings();
+            m_settingsChanged = false;
+        }
+        profile = m_optimizer->CaptureGameProfile(game);
+        std::copy(std::begin(m_profilePanels), std::end(m_profilePanels), profile.panelsAllowed);
+        profiles.Set(profile);
+        profiles.Save(); // On failure the profile still lasts for this session
+        ReapplyGameProfile();
+    }
+    if (active) {
+        ImGui::SameLine();
+        if (ImGui::Button("Remove Profile", ImVec2(150, 0))) {
+            profiles.Remove(game);
+            profiles.Save();
+            ReapplyGameProfile();
+        }
+    }
+    ImGui::TextDisabled("%zu saved profile(s)", profiles.GetProfiles().size());
+}
+
 void PerformanceSettingsPage::RenderMemorySettings() {
     RenderSectionHeader("Memory Management");
 
@@ -375,6 +1473,7 @@ void PerformanceSettingsPage::RenderMemorySettings() {
 
     if (changed) {
         m_settingsChanged = true;
+        m_pendingPreset = -1;
     }
 
     ImGui::Spacing();
@@ -383,15 +1482,19 @@ void PerformanceSettingsPage::RenderMemorySettings() {
     if (ImGui::Button("Release Unused Resources Now", ImVec2(250, 0))) {
         if (m_optimizer) {
             // Force a memory cleanup
-            m_optimizer->SetResourceUsageLevel(ResourceUsageLevel::Minimum);
-            m_optimizer->Suspend();
-            m_optimizer->Resume();
+            PerformanceOptimizer* optimizer = m_optimizer;
+            ImGuiSystem::RunOnRenderThread("Release Resources", [optimizer]() {
+                optimizer->SetResourceUsageLevel(ResourceUsageLevel::Minimum);
+                optimizer->Suspend();
+                optimizer->Resume();
+            });
         }
     }
 }
 
 void PerformanceSettingsPage::ApplySettings() {
     if (!m_optimizer) return;
+    if (m_monitor) m_monitor->RecordPowerPreset(m_pendingPreset);
 
     // Get config reference for modification
     auto& config = m_optimizer->GetConfig();
@@ -406,18 +1509,86 @@ void PerformanceSettingsPage::ApplySettings() {
     config.memoryThresholdMB = m_settings.memoryThresholdMB;
 
     config.adaptiveResolution = m_settings.adaptiveResolution;
+    config.adaptiveResolutionGpuBudgetMs = m_settings.adaptiveGpuBudgetMs;
+    config.adaptiveResolutionMaxScale = m_settings.renderScale;
+    config.overlayFrameBudgetMs = m_settings.overlayFrameBudgetMs;
     config.reduceInactiveQuality = m_settings.throttleInactive;
     config.suspendInactiveProcessing = m_settings.suspendBackground;
     config.aggressiveMemoryCleanup = m_settings.aggressiveMemoryCleanup;
+    config.partialPresentation = m_settings.partialPresentation;
+    config.swapChainScaling = m_settings.swapChainScaling;
+    config.variableRefresh = m_settings.variableRefresh;
+    config.showPresentRects = m_settings.showPresentRects;
+    config.framesInFlight = static_cast<unsigned int>(std::max(1, std::min(m_settings.framesInFlight, 3)));
+    config.gpuYieldPolicy = static_cast<GpuYieldPolicy>(std::clamp(m_settings.gpuYieldPolicy, 0, 2));
+    config.lowPowerOnBattery = m_settings.lowPowerOnBattery;
+    config.phaseLockToGame = m_settings.phaseLockToGame;
+    config.phaseLockOffsetMs = std::clamp(m_settings.phaseLockOffsetMs, 0.0f, 5.0f);
+    config.lowPowerWhenPowerSaving = m_settings.lowPowerWhenPowerSaving;
+    config.ecoQoSWhenNotActive = m_settings.ecoQoSWhenNotActive;
+    config.gameGpuBoundPercent = m_settings.gameGpuBoundPercent;
+    config.unloadInactiveBrowser = m_settings.discardBackgroundTabs;
+    config.heavyPageCpuPercent = std::clamp(m_settings.heavyPageCpuPercent, 0.0f, 100.0f);
+    config.maxLiveBrowserTabs = static_cast<unsigned int>(std::max(m_settings.maxLiveBrowserTabs, 1));
+    config.deferBrowserUntilOpened = m_settings.deferBrowserStartup;
+    config.preconnectOnHover = m_settings.preconnectOnHover;
+    config.prerenderOnHover = m_settings.prerenderOnHover;
+    for (int i = 0; i < 4; i++) {
+        config.browserGpuPolicy[i] = static_cast<BrowserGpuPolicy>(
+            std::clamp(m_settings.browserGpuPolicy[i], 0, static_cast<int>(BrowserGpuPolicy::Count) - 1));
+        config.browserUploadBudgetMB[i] = std::clamp(m_settings.browserUploadBudgetMB[i], 0.0f, 64.0f);
+    }
 
     // Apply vsync setting to render system
     if (m_optimizer) {
         // Force update to apply changes
-        m_optimizer->UpdateState();
+        PerformanceOptimizer* optimizer = m_optimizer;
+        ImGuiSystem::RunOnRenderThread("Apply Performance Settings", [optimizer]() { optimizer->UpdateState(); });
+    }
+}
+
+void PerformanceSettingsPage::ReapplyGameProfile() {
+    // Applies render settings, so on the render thread
+    PerformanceOptimizer* optimizer = m_optimizer;
+    ImGuiSystem::RunOnRenderThread("Reapply Game Profile", [optimizer]() { optimizer->ReapplyGameProfile(); });
+}
+
+void PerformanceSettingsPage::RenderPowerCosts() {
+    if (!m_monitor) return;
+    if (!m_monitor->IsPowerMeasured()) {
+        ImGui::TextDisabled("Power: not measured (no Energy Meter counters or NVML)");
+        return;
+    }
+
+    const OverlayPower& power = m_monitor->GetOverlayPower();
+    if (power.valid) {
+        ImGui::Text("Overlay power: %.2f W package, %.2f W GPU", power.packageWatts, power.gpuWatts);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Share of the system's %.1f W package and %.1f W GPU by the overlay's CPU and 3D engine time.\n"
+                "An estimate: idle and uncore power is split the same way",
+                power.system.packageWatts, power.system.integratedGpuWatts + power.system.discreteGpuWatts);
+        }
+    }
+
+    // Means per preset (since Apply) and per optimizer state, in the same terms
+    static const char* presetNames[] = { "Maximum Quality", "Balanced", "Efficiency", "Minimal Impact" };
+    static const char* stateNames[] = { "Active", "Inactive", "Background", "Low Power" };
+    for (int i = 0; i < static_cast<int>(std::size(presetNames)); i++) {
+        float packageWatts = 0.0f, gpuWatts = 0.0f;
+        if (m_monitor->GetPresetPowerCost(i, packageWatts, gpuWatts)) {
+            ImGui::TextDisabled("  %s preset: %.2f W package, %.2f W GPU", presetNames[i], packageWatts, gpuWatts);
+        }
+    }
+    for (uint32_t i = 0; i < std::size(stateNames); i++) {
+        float packageWatts = 0.0f, gpuWatts = 0.0f;
+        if (m_monitor->GetStatePowerCost(i, packageWatts, gpuWatts)) {
+            ImGui::TextDisabled("  %s state: %.2f W package, %.2f W GPU", stateNames[i], packageWatts, gpuWatts);
+        }
     }
 }
 
 void PerformanceSettingsPage::ApplyPreset(PerformancePreset preset) {
+    m_pendingPreset = static_cast<int>(preset);
     switch (preset) {
     case PerformancePreset::Maximum:
         // Maximum quality, high resource usage
@@ -427,7 +1598,7 @@ void PerformanceSettingsPage::ApplyPreset(PerformancePreset preset) {
 
         m_settings.cpuThresholdPercent = 90.0f;
         m_settings.gpuThresholdPercent = 90.0f;
-        m_settings.memoryThresholdMB = 1024.0f;
+        m_settings.memoryThresholdMB = 4096.0f;
 
         m_settings.renderScale = 1.0f;
         m_settings.browserQuality = 1.0f;
@@ -447,7 +1618,7 @@ void PerformanceSettingsPage::ApplyPreset(PerformancePreset preset) {
 
         m_settings.cpuThresholdPercent = 80.0f;
         m_settings.gpuThresholdPercent = 80.0f;
-        m_settings.memoryThresholdMB = 512.0f;
+        m_settings.memoryThresholdMB = 2048.0f;
 
         m_settings.renderScale = 1.0f;
         m_settings.browserQuality = 1.0f;
@@ -467,7 +1638,7 @@ void PerformanceSettingsPage::ApplyPreset(PerformancePreset preset) {
 
         m_settings.cpuThresholdPercent = 60.0f;
         m_settings.gpuThresholdPercent = 60.0f;
-        m_settings.memoryThresholdMB = 256.0f;
+        m_settings.memoryThresholdMB = 1024.0f;
 
         m_settings.renderScale = 0.75f;
         m_settings.browserQuality = 0.75f;
@@ -487,7 +1658,7 @@ void PerformanceSettingsPage::ApplyPreset(PerformancePreset preset) {
 
         m_settings.cpuThresholdPercent = 40.0f;
         m_settings.gpuThresholdPercent = 40.0f;
-        m_settings.memoryThresholdMB = 128.0f;
+        m_settings.memoryThresholdMB = 512.0f;
 
         m_settings.renderScale = 0.5f;
         m_settings.browserQuality = 0.5f;
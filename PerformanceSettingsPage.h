@@ -7,32 +7,73 @@
 #include "PageBase.h"
 #include "PerformanceOptimizer.h"
 #include "PerformanceMonitor.h"
+#include "ResourceManager.h"
+#include "CommandAllocatorPool.h"
+#include "CpuProfiler.h"
 #include <string>
 #include <array>
+#include <chrono>
+
+// Forward declarations
+class RenderSystem;
 
 class PerformanceSettingsPage : public PageBase {
 public:
-    PerformanceSettingsPage(PerformanceOptimizer* optimizer, PerformanceMonitor* monitor);
-    ~PerformanceSettingsPage() = default;
+    PerformanceSettingsPage(PerformanceOptimizer* optimizer, PerformanceMonitor* monitor,
+                            ResourceManager* resourceManager = nullptr, RenderSystem* renderSystem = nullptr);
+    ~PerformanceSettingsPage();
 
     // Render performance settings page content
     void Render() override;
+    float GetRefreshRate() const override { return 10.0f; } // Graphs and counters
+    // The graphs component is only registered with the optimizer while the page is shown
+    void OnVisible() override;
+    void OnHidden() override;
 
 private:
     // Render different sections
     void RenderResourceUsageGraphs();
+    void RenderGpuMemoryReport();
+    void RenderCpuTimeline();
+    void RenderProfileLanes(const CpuProfileFrame& frame);
+    void RenderHitchIncidents();
+    void RenderAllocations();
+    void RenderSubsystemCpu();
+    void RenderNavigationTimings();
+    void RenderPageMetrics();
     void RenderPerformancePresets();
+    void RenderPowerCosts();
     void RenderFrameRateSettings();
     void RenderRenderQualitySettings();
     void RenderBrowserSettings();
     void RenderMemorySettings();
+    void RenderGameProfiles();
 
     // Apply settings changes
     void ApplySettings();
+    void ReapplyGameProfile(); // PerformanceOptimizer::ReapplyGameProfile, on the render thread
+    void LoadSettingsFromConfig(); // Page values from the optimizer's config
+    UINT m_configGeneration = 0;   // Config generation the page values came from
 
     // Resource pointers (not owned)
     PerformanceOptimizer* m_optimizer = nullptr;
     PerformanceMonitor* m_monitor = nullptr;
+    ResourceManager* m_resourceManager = nullptr;
+    RenderSystem* m_renderSystem = nullptr;
+
+    // GPU memory report, refreshed a few times a second (the snapshot takes the manager's lock)
+    static constexpr int MEMORY_REPORT_INTERVAL_MS = 500;
+    ResourceManager::MemoryReport m_memoryReport;
+    CommandAllocatorPool::Stats m_allocatorStats;
+    std::chrono::steady_clock::time_point m_memoryReportTime;
+
+    // CPU timeline (keeps zones recording while its header is open)
+    CpuProfileFrame m_profileFrame;
+    bool m_profilePaused = false;
+
+    // Hitch incident browser
+    uint64_t m_selectedHitchFrame = UINT64_MAX;
+    std::string m_hitchExportPath;
 
     // UI state for editing
     struct PerformanceSettings {
@@ -44,7 +85,7 @@ private:
         // Resource thresholds
         float cpuThresholdPercent = 80.0f;
         float gpuThresholdPercent = 80.0f;
-        float memoryThresholdMB = 512.0f;
+        float memoryThresholdMB = 2048.0f;
 
         // Quality settings
         float renderScale = 1.0f;
@@ -53,13 +94,41 @@ private:
         // Optimization options
         bool enableVSync = true;
         bool adaptiveResolution = true;
+        float adaptiveGpuBudgetMs = 3.0f;
+        float overlayFrameBudgetMs = 6.0f;
         bool throttleInactive = true;
         bool suspendBackground = true;
         bool aggressiveMemoryCleanup = true;
+        bool partialPresentation = true;
+        bool swapChainScaling = false;
+        bool variableRefresh = false;
+        bool showPresentRects = false;
+        int framesInFlight = 3;
+        int gpuYieldPolicy = 1; // GpuYieldPolicy
+        bool lowPowerOnBattery = true;
+        bool phaseLockToGame = false;
+        float phaseLockOffsetMs = 0.5f;
+        bool lowPowerWhenPowerSaving = true;
+        bool ecoQoSWhenNotActive = true;
+        float gameGpuBoundPercent = 90.0f;
+        bool discardBackgroundTabs = false;
+        float heavyPageCpuPercent = 0.0f;
+        int maxLiveBrowserTabs = 4;
+        bool deferBrowserStartup = false;
+        int browserGpuPolicy[4] = { 0, 1, 1, 2 }; // BrowserGpuPolicy per PerformanceState
+        float browserUploadBudgetMB[4] = { 8.0f, 4.0f, 2.0f, 2.0f }; // Per PerformanceState
+        bool preconnectOnHover = true;
+        bool prerenderOnHover = false;
     };
 
     PerformanceSettings m_settings;
     bool m_settingsChanged = false;
+    int m_pendingPreset = -1; // PerformancePreset the unapplied settings came from, -1 after hand edits
+
+    // Frame time histogram view
+    int m_frameTimeWindow = static_cast<int>(FrameTimeWindow::TenSeconds);
+    std::vector<float> m_frameTimeBuckets;
+    std::vector<float> m_inputLatencyBuckets;
 
     // Performance presets
     enum class PerformancePreset {
@@ -69,13 +138,12 @@ private:
         Minimal     // Minimum resource usage
     };
 
-    // CPU/GPU usage history visualization
-    static constexpr int HISTORY_POINTS = 60;
-    std::array<float, HISTORY_POINTS> m_cpuHistory = {};
-    std::array<float, HISTORY_POINTS> m_gpuHistory = {};
-    std::array<float, HISTORY_POINTS> m_memoryHistory = {};
-    std::array<float, HISTORY_POINTS> m_frameTimeHistory = {};
-    int m_historyIndex = 0;
+    // CPU/GPU usage history visualization, read from the monitor's metric series
+    static constexpr float MEMORY_GRAPH_MAX_MB = 4096.0f;
+    int m_graphSpan = 1; // Index into GRAPH_SPANS
+    bool m_graphsDegraded = false; // Over the component budget: text only
+    bool m_graphsRegistered = false;
+    bool m_profilePanels[static_cast<size_t>(OverlayPanel::Count)] = { true, true }; // For a new profile
 
     // Apply a preset configuration
     void ApplyPreset(PerformancePreset preset);
@@ -4,113 +4,295 @@
 
 #include "PipelineStateManager.h"
 #include "RenderSystem.h"
-#include <d3dcompiler.h>
+#include "FileUtil.h"
 #include <stdexcept>
-
+#include <algorithm>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <chrono>
+
+#if GAMEOVERLAY_RUNTIME_SHADERS
+#include <d3dcompiler.h>
 #pragma comment(lib, "d3dcompiler.lib")
-
-// Vertex shader for basic rendering
-const char* g_BasicVertexShader = R"(
-struct VSInput
-{
-    float3 position : POSITION;
-    float2 texCoord : TEXCOORD;
-    float4 color : COLOR;
-};
-
-struct VSOutput
-{
-    float4 position : SV_POSITION;
-    float2 texCoord : TEXCOORD;
-    float4 color : COLOR;
+#else
+// Generated by the build from shaders/*.hlsl
+#include "BasicVS.h"
+#include "BasicPS.h"
+#include "TexturePS.h"
+#include "UpscaleVS.h"
+#include "UpscaleBilinearPS.h"
+#include "UpscaleSharpenPS.h"
+#include "SpriteVS.h"
+#include "TextureConvertCS.h"
+#include "ThumbnailEncodeCS.h"
+#endif
+
+// Shaders live in shaders/*.hlsl. The build compiles them to SM 6.0 DXIL with DXC and embeds
+// the bytecode; GAMEOVERLAY_RUNTIME_SHADERS compiles them from GAMEOVERLAY_SHADER_DIR instead
+// (SM 5.1 through d3dcompiler), for editing shaders without rebuilding.
+struct ShaderInfo {
+    const char* name;    // File name without .hlsl
+    const char* profile; // Run-time compile target
+    const void* bytecode;
+    size_t size;
 };
 
-VSOutput main(VSInput input)
-{
-    VSOutput output;
-    output.position = float4(input.position, 1.0f);
-    output.texCoord = input.texCoord;
-    output.color = input.color;
-    return output;
-}
-)";
-
-// Pixel shader for basic rendering
-const char* g_BasicPixelShader = R"(
-struct PSInput
-{
-    float4 position : SV_POSITION;
-    float2 texCoord : TEXCOORD;
-    float4 color : COLOR;
+#if GAMEOVERLAY_RUNTIME_SHADERS
+#define SHADER_INFO(name, profile) { #name, profile, nullptr, 0 }
+#else
+#define SHADER_INFO(name, profile) { #name, profile, g_##name, sizeof(g_##name) }
+#endif
+
+// In PipelineStateManager::Shader order
+static const ShaderInfo g_shaderInfo[] = {
+    SHADER_INFO(BasicVS, "vs_5_1"),
+    SHADER_INFO(BasicPS, "ps_5_1"),
+    SHADER_INFO(TexturePS, "ps_5_1"),
+    SHADER_INFO(UpscaleVS, "vs_5_1"),
+    SHADER_INFO(UpscaleBilinearPS, "ps_5_1"),
+    SHADER_INFO(UpscaleSharpenPS, "ps_5_1"),
+    SHADER_INFO(SpriteVS, "vs_5_1"),
+    SHADER_INFO(TextureConvertCS, "cs_5_1"),
+    SHADER_INFO(ThumbnailEncodeCS, "cs_5_1"),
 };
 
-Texture2D g_texture : register(t0);
-SamplerState g_sampler : register(s0);
+#undef SHADER_INFO
 
-float4 main(PSInput input) : SV_TARGET
-{
-    return input.color;
-}
-)";
-
-// Pixel shader for textured rendering
-const char* g_TexturePixelShader = R"(
-struct PSInput
-{
-    float4 position : SV_POSITION;
-    float2 texCoord : TEXCOORD;
-    float4 color : COLOR;
-};
+// Pipeline cache file format
+static constexpr uint32_t PIPELINE_CACHE_MAGIC = 0x4C50474F; // "OGPL"
+static constexpr uint32_t PIPELINE_CACHE_VERSION = 1;
 
-Texture2D g_texture : register(t0);
-SamplerState g_sampler : register(s0);
-
-float4 main(PSInput input) : SV_TARGET
-{
-    return g_texture.Sample(g_sampler, input.texCoord) * input.color;
+// FNV-1a, continued from hash
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+    }
+    return hash;
 }
-)";
 
 PipelineStateManager::PipelineStateManager(RenderSystem* renderSystem)
     : m_renderSystem(renderSystem) {
 }
 
 PipelineStateManager::~PipelineStateManager() {
+    {
+        std::lock_guard<ProfiledMutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_compileJobs.Wait();
+
+    SavePipelineLibrary();
     ClearCache();
 }
 
 void PipelineStateManager::Initialize() {
+#if !GAMEOVERLAY_RUNTIME_SHADERS
+    // The embedded DXIL needs SM 6.0 (every current DX12 driver)
+    D3D12_FEATURE_DATA_SHADER_MODEL shaderModel = { D3D_SHADER_MODEL_6_0 };
+    if (m_renderSystem && m_renderSystem->GetDevice() &&
+        (FAILED(m_renderSystem->GetDevice()->CheckFeatureSupport(D3D12_FEATURE_SHADER_MODEL, &shaderModel, sizeof(shaderModel))) ||
+            shaderModel.HighestShaderModel < D3D_SHADER_MODEL_6_0)) {
+        OutputDebugStringA("Warning: Shader model 6.0 unsupported, overlay pipelines will fail to create.\n");
+    }
+#endif
+
+    // Before any pipeline is created, so they come from the library
+    OpenPipelineLibrary();
+
     // Create default root signatures
     m_defaultRootSignature = CreateDefaultRootSignature();
     m_textureRootSignature = CreateTextureRootSignature();
 
     // Pre-create some common pipeline states
     PipelineStateKey defaultKey;
-    GetPipelineState(defaultKey);
+    Prewarm({ defaultKey });
 }
 
 ID3D12PipelineState* PipelineStateManager::GetPipelineState(const PipelineStateKey& key) {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ID3D12PipelineState* pipelineState = FindPublishedPipeline(key.Pack())) {
+        return pipelineState;
+    }
 
-    // Check if pipeline state already exists
+    std::unique_lock<ProfiledMutex> lock(m_mutex);
+
+    PipelineEntry& entry = QueuePipelineLocked(key);
+    if (entry.pending && entry.queued) {
+        // Nobody has started it: compile here instead of waiting for a worker (the job then finds
+        // it taken)
+        entry.queued = false;
+        lock.unlock();
+        CompilePipeline(key);
+        lock.lock();
+    }
+
+    // Entries are never erased while pending (ClearCache skips them), so this lookup is stable
+    m_pipelineReadyCondition.wait(lock, [&]() {
+        auto it = m_pipelineStates.find(key);
+        return it == m_pipelineStates.end() || !it->second.pending;
+    });
     auto it = m_pipelineStates.find(key);
-    if (it != m_pipelineStates.end()) {
-        return it->second.Get();
+    return it != m_pipelineStates.end() ? it->second.pipelineState.Get() : nullptr;
+}
+
+// --- Background Compilation ---
+
+PipelineStateManager::PipelineEntry& PipelineStateManager::QueuePipelineLocked(const PipelineStateKey& key) {
+    auto result = m_pipelineStates.try_emplace(key);
+    PipelineEntry& entry = result.first->second;
+    if (result.second) {
+        // Background compilation on the efficiency workers, so it yields to the render and UI
+        // threads and stays off the game's cores
+        entry.queued = true;
+        JobDesc job;
+        job.name = "Compile Pipeline";
+        job.jobClass = JobClass::Efficiency;
+        job.counter = &m_compileJobs;
+        JobSystem::Get().Submit(job, [this, key]() { CompileJob(key); });
     }
+    return entry;
+}
+
+void PipelineStateManager::Prewarm(const std::vector<PipelineStateKey>& keys) {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    for (const PipelineStateKey& key : keys) {
+        QueuePipelineLocked(key);
+    }
+}
+
+ID3D12PipelineState* PipelineStateManager::TryGetPipelineState(const PipelineStateKey& key,
+    ID3D12PipelineState* fallback) {
+    if (ID3D12PipelineState* pipelineState = FindPublishedPipeline(key.Pack())) {
+        return pipelineState;
+    }
+
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    PipelineEntry& entry = QueuePipelineLocked(key);
+    if (entry.pending || !entry.pipelineState) {
+        return fallback;
+    }
+    return entry.pipelineState.Get();
+}
+
+void PipelineStateManager::WhenPipelineReady(const PipelineStateKey& key, PipelineReadyCallback callback) {
+    if (!callback) return;
+
+    std::unique_lock<ProfiledMutex> lock(m_mutex);
+    PipelineEntry& entry = QueuePipelineLocked(key);
+    if (entry.pending) {
+        entry.callbacks.push_back(std::move(callback));
+        return;
+    }
+    ID3D12PipelineState* pipelineState = entry.pipelineState.Get();
+    lock.unlock();
+    callback(pipelineState);
+}
+
+void PipelineStateManager::CompileJob(const PipelineStateKey& key) {
+    {
+        std::lock_guard<ProfiledMutex> lock(m_mutex);
+        PipelineEntry& entry = m_pipelineStates[key];
+        if (m_stopping || !entry.queued) return; // Compiled by a waiting thread instead
+        entry.queued = false;
+    }
+    CompilePipeline(key);
+}
+
+void PipelineStateManager::CompilePipeline(const PipelineStateKey& key) {
+    auto start = std::chrono::steady_clock::now();
+    bool fromLibrary = false;
+    ComPtr<ID3D12PipelineState> pipelineState = CreatePipelineState(key, &fromLibrary);
+    float createTimeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<PipelineReadyCallback> callbacks;
+    {
+        std::lock_guard<ProfiledMutex> lock(m_mutex);
+        PipelineEntry& entry = m_pipelineStates[key];
+        entry.pipelineState = pipelineState;
+        entry.pending = false;
+        entry.failed = !pipelineState;
+        entry.fromLibrary = fromLibrary;
+        entry.createTimeMs = createTimeMs;
+        callbacks = std::move(entry.callbacks);
+        entry.callbacks.clear();
+        if (pipelineState) {
+            PublishPipelinesLocked();
+        }
+    }
+    m_pipelineReadyCondition.notify_all();
 
-    // Create new pipeline state
-    ComPtr<ID3D12PipelineState> pipelineState = CreatePipelineState(key);
     if (!pipelineState) {
-        return nullptr;
+        OutputDebugStringA("Error: Failed to create pipeline state.\n");
+    }
+    for (PipelineReadyCallback& callback : callbacks) {
+        callback(pipelineState.Get());
     }
+}
 
-    // Cache and return
-    m_pipelineStates[key] = pipelineState;
-    return pipelineState.Get();
+ID3D12PipelineState* PipelineStateManager::FindPublishedPipeline(uint64_t packedKey) const {
+    const PipelineTable* table = m_publishedTable.load(std::memory_order_acquire);
+    if (!table) return nullptr;
+
+    // At most half full, so probing always reaches an empty slot
+    size_t mask = table->slots.size() - 1;
+    for (size_t index = PipelineStateKey::Hash::Mix(packedKey) & mask;; index = (index + 1) & mask) {
+        const PublishedPipeline& slot = table->slots[index];
+        if (slot.packedKey == packedKey) return slot.pipelineState;
+        if (slot.packedKey == UINT64_MAX) return nullptr;
+    }
+}
+
+void PipelineStateManager::PublishPipelinesLocked() {
+    size_t readyCount = std::count_if(m_pipelineStates.begin(), m_pipelineStates.end(),
+        [](const auto& pair) { return !pair.second.pending && pair.second.pipelineState; });
+
+    size_t capacity = 16;
+    while (capacity < readyCount * 2) capacity *= 2;
+
+    auto table = std::make_unique<PipelineTable>();
+    table->slots.resize(capacity);
+    size_t mask = capacity - 1;
+    for (const auto& pair : m_pipelineStates) {
+        if (pair.second.pending || !pair.second.pipelineState) continue;
+        uint64_t packedKey = pair.first.Pack();
+        size_t index = PipelineStateKey::Hash::Mix(packedKey) & mask;
+        while (table->slots[index].packedKey != UINT64_MAX) {
+            index = (index + 1) & mask;
+        }
+        table->slots[index] = { packedKey, pair.second.pipelineState.Get() };
+    }
+
+    // Fully built before it is visible
+    m_publishedTable.store(table.get(), std::memory_order_release);
+    m_pipelineTables.push_back(std::move(table));
+}
+
+std::vector<PipelineStateManager::PipelineStats> PipelineStateManager::GetPipelineStats() const {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    std::vector<PipelineStats> stats;
+    stats.reserve(m_pipelineStates.size());
+    for (const auto& pair : m_pipelineStates) {
+        PipelineStats entryStats;
+        entryStats.key = pair.first;
+        entryStats.ready = !pair.second.pending && pair.second.pipelineState;
+        entryStats.failed = pair.second.failed;
+        entryStats.fromLibrary = pair.second.fromLibrary;
+        entryStats.createTimeMs = pair.second.createTimeMs;
+        stats.push_back(entryStats);
+    }
+    return stats;
+}
+
+size_t PipelineStateManager::GetPendingPipelineCount() const {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    return std::count_if(m_pipelineStates.begin(), m_pipelineStates.end(),
+        [](const auto& pair) { return pair.second.pending; });
 }
 
 ID3D12RootSignature* PipelineStateManager::GetDefaultRootSignature() {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
 
     if (!m_defaultRootSignature) {
         m_defaultRootSignature = CreateDefaultRootSignature();
@@ -120,7 +302,7 @@ ID3D12RootSignature* PipelineStateManager::GetDefaultRootSignature() {
 }
 
 ID3D12RootSignature* PipelineStateManager::GetTextureRootSignature() {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
 
     if (!m_textureRootSignature) {
         m_textureRootSignature = CreateTextureRootSignature();
@@ -129,57 +311,546 @@ ID3D12RootSignature* PipelineStateManager::GetTextureRootSignature() {
     return m_textureRootSignature.Get();
 }
 
+ID3D12PipelineState* PipelineStateManager::GetUpscalePipelineState(UpscaleFilter filter, DXGI_FORMAT renderTargetFormat) {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+
+    // Format changes (e.g. swap chain recreation) invalidate both filters; frames in flight may
+    // still use the old ones
+    if (m_upscaleFormat != renderTargetFormat) {
+        RetirePipelineObject(std::move(m_upscalePipelineStates[0]));
+        RetirePipelineObject(std::move(m_upscalePipelineStates[1]));
+        m_upscaleFormat = renderTargetFormat;
+    }
+
+    ComPtr<ID3D12PipelineState>& pipelineState = m_upscalePipelineStates[static_cast<int>(filter)];
+    if (!pipelineState) {
+        pipelineState = CreateUpscalePipelineState(filter, renderTargetFormat);
+    }
+
+    return pipelineState.Get();
+}
+
+ID3D12PipelineState* PipelineStateManager::GetLayerCompositePipelineState(DXGI_FORMAT renderTargetFormat) {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+
+    if (m_layerCompositeFormat != renderTargetFormat) {
+        RetirePipelineObject(std::move(m_layerCompositePipelineState));
+        m_layerCompositeFormat = renderTargetFormat;
+    }
+    if (!m_layerCompositePipelineState) {
+        m_layerCompositePipelineState = CreateUpscalePipelineState(UpscaleFilter::Bilinear, renderTargetFormat,
+            PipelineStateKey::PremultipliedBlend);
+    }
+
+    return m_layerCompositePipelineState.Get();
+}
+
+ID3D12RootSignature* PipelineStateManager::GetUpscaleRootSignature() {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+
+    if (!m_upscaleRootSignature) {
+        m_upscaleRootSignature = CreateUpscaleRootSignature();
+    }
+
+    return m_upscaleRootSignature.Get();
+}
+
+ID3D12PipelineState* PipelineStateManager::GetSpritePipelineState(DXGI_FORMAT renderTargetFormat) {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+
+    if (m_spriteFormat != renderTargetFormat) {
+        RetirePipelineObject(std::move(m_spritePipelineState));
+        m_spriteFormat = renderTargetFormat;
+    }
+    if (!m_spritePipelineState) {
+        m_spritePipelineState = CreateSpritePipelineState(renderTargetFormat);
+    }
+
+    return m_spritePipelineState.Get();
+}
+
+ID3D12RootSignature* PipelineStateManager::GetSpriteRootSignature() {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+
+    if (!m_spriteRootSignature) {
+        m_spriteRootSignature = CreateSpriteRootSignature();
+    }
+
+    return m_spriteRootSignature.Get();
+}
+
+ID3D12PipelineState* PipelineStateManager::GetTextureConvertPipelineState() {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+
+    if (!m_textureConvertPipelineState) {
+        m_textureConvertPipelineState = CreateTextureConvertPipelineState();
+    }
+
+    return m_textureConvertPipelineState.Get();
+}
+
+ID3D12RootSignature* PipelineStateManager::GetTextureConvertRootSignature() {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+
+    if (!m_textureConvertRootSignature) {
+        m_textureConvertRootSignature = CreateTextureConvertRootSignature();
+    }
+
+    return m_textureConvertRootSignature.Get();
+}
+
+ID3D12PipelineState* PipelineStateManager::GetThumbnailEncodePipelineState() {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+
+    if (!m_thumbnailEncodePipelineState) {
+        m_thumbnailEncodePipelineState = CreateThumbnailEncodePipelineState();
+    }
+
+    return m_thumbnailEncodePipelineState.Get();
+}
+
+ID3D12RootSignature* PipelineStateManager::GetThumbnailEncodeRootSignature() {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+
+    if (!m_thumbnailEncodeRootSignature) {
+        m_thumbnailEncodeRootSignature = CreateThumbnailEncodeRootSignature();
+    }
+
+    return m_thumbnailEncodeRootSignature.Get();
+}
+
 void PipelineStateManager::ClearCache() {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+
+    // Pending entries stay: their compile publishes into them and waiters look them up
+    for (auto it = m_pipelineStates.begin(); it != m_pipelineStates.end();) {
+        if (it->second.pending) {
+            ++it;
+            continue;
+        }
+        RetirePipelineObject(std::move(it->second.pipelineState));
+        it = m_pipelineStates.erase(it);
+    }
+    PublishPipelinesLocked();
+    RetirePipelineObject(std::move(m_defaultRootSignature));
+    RetirePipelineObject(std::move(m_textureRootSignature));
+    RetirePipelineObject(std::move(m_upscaleRootSignature));
+    RetirePipelineObject(std::move(m_upscalePipelineStates[0]));
+    RetirePipelineObject(std::move(m_upscalePipelineStates[1]));
+    m_upscaleFormat = DXGI_FORMAT_UNKNOWN;
+    RetirePipelineObject(std::move(m_layerCompositePipelineState));
+    m_layerCompositeFormat = DXGI_FORMAT_UNKNOWN;
+    RetirePipelineObject(std::move(m_spriteRootSignature));
+    RetirePipelineObject(std::move(m_spritePipelineState));
+    m_spriteFormat = DXGI_FORMAT_UNKNOWN;
+    RetirePipelineObject(std::move(m_textureConvertRootSignature));
+    RetirePipelineObject(std::move(m_textureConvertPipelineState));
+    RetirePipelineObject(std::move(m_thumbnailEncodeRootSignature));
+    RetirePipelineObject(std::move(m_thumbnailEncodePipelineState));
+}
+
+void PipelineStateManager::RetirePipelineObject(ComPtr<IUnknown> object) {
+    if (!object) return;
+    ResourceManager* resourceManager = m_renderSystem ? m_renderSystem->GetResourceManager() : nullptr;
+    if (resourceManager) {
+        resourceManager->RetireResource(std::move(object));
+    }
+    // Without a manager there is nothing in flight; the object is released here
+}
+
+ComPtr<ID3D12PipelineState> PipelineStateManager::CreateUpscalePipelineState(UpscaleFilter filter, DXGI_FORMAT renderTargetFormat,
+    PipelineStateKey::BlendMode blendMode) {
+    if (!m_renderSystem || !m_renderSystem->GetDevice()) {
+        return nullptr;
+    }
+
+    // Called with m_mutex held, so create the root signature directly
+    if (!m_upscaleRootSignature) {
+        m_upscaleRootSignature = CreateUpscaleRootSignature();
+        if (!m_upscaleRootSignature) {
+            return nullptr;
+        }
+    }
+
+    D3D12_SHADER_BYTECODE vertexShader = GetShaderBytecode(Shader::UpscaleVS);
+    D3D12_SHADER_BYTECODE pixelShader = GetShaderBytecode(filter == UpscaleFilter::Sharpen ?
+        Shader::UpscaleSharpenPS : Shader::UpscaleBilinearPS);
+    if (!vertexShader.pShaderBytecode || !pixelShader.pShaderBytecode) {
+        return nullptr;
+    }
+
+    // The upscale overwrites the whole back buffer, so it doesn't blend; layer composites do
+    D3D12_RASTERIZER_DESC rasterizerDesc = CreateRasterizerDesc(PipelineStateKey::Solid);
+    rasterizerDesc.CullMode = D3D12_CULL_MODE_NONE;
+
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
+    psoDesc.InputLayout = { nullptr, 0 };
+    psoDesc.pRootSignature = m_upscaleRootSignature.Get();
+    psoDesc.VS = vertexShader;
+    psoDesc.PS = pixelShader;
+    psoDesc.RasterizerState = rasterizerDesc;
+    psoDesc.BlendState = CreateBlendDesc(blendMode);
+    psoDesc.DepthStencilState = CreateDepthStencilDesc(PipelineStateKey::NoDepth);
+    psoDesc.SampleMask = UINT_MAX;
+    psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    psoDesc.NumRenderTargets = 1;
+    psoDesc.RTVFormats[0] = renderTargetFormat;
+    psoDesc.DSVFormat = DXGI_FORMAT_UNKNOWN;
+    psoDesc.SampleDesc.Count = 1;
+
+    wchar_t name[64];
+    swprintf_s(name, L"Upscale f%d rt%d b%d", static_cast<int>(filter), static_cast<int>(renderTargetFormat),
+        static_cast<int>(blendMode));
+    ComPtr<ID3D12PipelineState> pipelineState = CreateGraphicsPipeline(name, psoDesc);
+    if (!pipelineState) {
+        OutputDebugStringA("Error: Failed to create upscale pipeline state.\n");
+    }
+
+    return pipelineState;
+}
+
+ComPtr<ID3D12PipelineState> PipelineStateManager::CreateSpritePipelineState(DXGI_FORMAT renderTargetFormat) {
+    if (!m_renderSystem || !m_renderSystem->GetDevice()) {
+        return nullptr;
+    }
+
+    // Called with m_mutex held, so create the root signature directly
+    if (!m_spriteRootSignature) {
+        m_spriteRootSignature = CreateSpriteRootSignature();
+        if (!m_spriteRootSignature) {
+            return nullptr;
+        }
+    }
+
+    D3D12_SHADER_BYTECODE vertexShader = GetShaderBytecode(Shader::SpriteVS);
+    D3D12_SHADER_BYTECODE pixelShader = GetShaderBytecode(Shader::TexturePS);
+    if (!vertexShader.pShaderBytecode || !pixelShader.pShaderBytecode) {
+        return nullptr;
+    }
+
+    // One SpriteInstance per quad; the corners come from SV_VertexID
+    D3D12_INPUT_ELEMENT_DESC inputElementDescs[] =
+    {
+        { "ORIGIN", 0, DXGI_FORMAT_R32G32_FLOAT, 0, offsetof(SpriteInstance, origin), D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+        { "AXIS", 0, DXGI_FORMAT_R32G32_FLOAT, 0, offsetof(SpriteInstance, axisX), D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+        { "AXIS", 1, DXGI_FORMAT_R32G32_FLOAT, 0, offsetof(SpriteInstance, axisY), D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+        { "TEXRECT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, offsetof(SpriteInstance, texRect), D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+        { "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, offsetof(SpriteInstance, color), D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 }
+    };
+
+    // Lines and rotated quads may face either way
+    D3D12_RASTERIZER_DESC rasterizerDesc = CreateRasterizerDesc(PipelineStateKey::Solid);
+    rasterizerDesc.CullMode = D3D12_CULL_MODE_NONE;
+
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
+    psoDesc.InputLayout = { inputElementDescs, _countof(inputElementDescs) };
+    psoDesc.pRootSignature = m_spriteRootSignature.Get();
+    psoDesc.VS = vertexShader;
+    psoDesc.PS = pixelShader;
+    psoDesc.RasterizerState = rasterizerDesc;
+    psoDesc.BlendState = CreateBlendDesc(PipelineStateKey::AlphaBlend);
+    psoDesc.DepthStencilState = CreateDepthStencilDesc(PipelineStateKey::NoDepth);
+    psoDesc.SampleMask = UINT_MAX;
+    psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    psoDesc.NumRenderTargets = 1;
+    psoDesc.RTVFormats[0] = renderTargetFormat;
+    psoDesc.DSVFormat = DXGI_FORMAT_UNKNOWN;
+    psoDesc.SampleDesc.Count = 1;
 
-    m_pipelineStates.clear();
-    m_defaultRootSignature.Reset();
-    m_textureRootSignature.Reset();
+    wchar_t name[64];
+    swprintf_s(name, L"Sprite rt%d", static_cast<int>(renderTargetFormat));
+    ComPtr<ID3D12PipelineState> pipelineState = CreateGraphicsPipeline(name, psoDesc);
+    if (!pipelineState) {
+        OutputDebugStringA("Error: Failed to create sprite pipeline state.\n");
+    }
+
+    return pipelineState;
 }
 
-ComPtr<ID3D12PipelineState> PipelineStateManager::CreatePipelineState(const PipelineStateKey& key) {
+ComPtr<ID3D12PipelineState> PipelineStateManager::CreateTextureConvertPipelineState() {
     if (!m_renderSystem || !m_renderSystem->GetDevice()) {
         return nullptr;
     }
 
-    // Compile shaders
-    ComPtr<ID3DBlob> vertexShaderBlob;
-    ComPtr<ID3DBlob> pixelShaderBlob;
-    ComPtr<ID3DBlob> errorBlob;
+    // Called with m_mutex held, so create the root signature directly
+    if (!m_textureConvertRootSignature) {
+        m_textureConvertRootSignature = CreateTextureConvertRootSignature();
+        if (!m_textureConvertRootSignature) {
+            return nullptr;
+        }
+    }
+
+    D3D12_SHADER_BYTECODE computeShader = GetShaderBytecode(Shader::TextureConvertCS);
+    if (!computeShader.pShaderBytecode) {
+        return nullptr;
+    }
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
+    psoDesc.pRootSignature = m_textureConvertRootSignature.Get();
+    psoDesc.CS = computeShader;
 
-    UINT compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-    HRESULT hr;
+    ComPtr<ID3D12PipelineState> pipelineState = CreateComputePipeline(L"TextureConvert", psoDesc);
+    if (!pipelineState) {
+        OutputDebugStringA("Error: Failed to create texture convert pipeline state.\n");
+    }
 
-    // Vertex shader
-    hr = D3DCompile(
-        g_BasicVertexShader, strlen(g_BasicVertexShader),
-        nullptr, nullptr, nullptr, "main",
-        ("vs_" + key.shaderModel).c_str(),
-        compileFlags, 0, &vertexShaderBlob, &errorBlob
-    );
+    return pipelineState;
+}
+
+ComPtr<ID3D12PipelineState> PipelineStateManager::CreateThumbnailEncodePipelineState() {
+    if (!m_renderSystem || !m_renderSystem->GetDevice()) {
+        return nullptr;
+    }
+
+    // Called with m_mutex held, so create the root signature directly
+    if (!m_thumbnailEncodeRootSignature) {
+        m_thumbnailEncodeRootSignature = CreateThumbnailEncodeRootSignature();
+        if (!m_thumbnailEncodeRootSignature) {
+            return nullptr;
+        }
+    }
+
+    D3D12_SHADER_BYTECODE computeShader = GetShaderBytecode(Shader::ThumbnailEncodeCS);
+    if (!computeShader.pShaderBytecode) {
+        return nullptr;
+    }
 
+    D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
+    psoDesc.pRootSignature = m_thumbnailEncodeRootSignature.Get();
+    psoDesc.CS = computeShader;
+
+    ComPtr<ID3D12PipelineState> pipelineState = CreateComputePipeline(L"ThumbnailEncode", psoDesc);
+    if (!pipelineState) {
+        OutputDebugStringA("Error: Failed to create thumbnail encode pipeline state.\n");
+    }
+
+    return pipelineState;
+}
+
+// --- Shaders ---
+
+D3D12_SHADER_BYTECODE PipelineStateManager::GetShaderBytecode(Shader shader) {
+    static_assert(_countof(g_shaderInfo) == static_cast<size_t>(Shader::Count), "g_shaderInfo must list every shader");
+    const ShaderInfo& info = g_shaderInfo[static_cast<int>(shader)];
+#if GAMEOVERLAY_RUNTIME_SHADERS
+    ComPtr<ID3DBlob>& blob = m_shaderBlobs[static_cast<int>(shader)];
+    if (!blob) {
+        std::string path = std::string(GAMEOVERLAY_SHADER_DIR) + "/" + info.name + ".hlsl";
+        std::wstring widePath(path.begin(), path.end());
+
+        ComPtr<ID3DBlob> errorBlob;
+        HRESULT hr = D3DCompileFromFile(widePath.c_str(), nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, "main",
+            info.profile, D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &blob, &errorBlob);
+        if (FAILED(hr)) {
+            if (errorBlob) {
+                OutputDebugStringA(static_cast<const char*>(errorBlob->GetBufferPointer()));
+            }
+            blob.Reset();
+            return {};
+        }
+    }
+    return { blob->GetBufferPointer(), blob->GetBufferSize() };
+#else
+    return { info.bytecode, info.size };
+#endif
+}
+
+// --- Pipeline Library ---
+
+std::string PipelineStateManager::GetPipelineCachePath() {
+    std::string directory = GetAppDataDirectory();
+    if (directory.empty()) {
+        return std::string(); // No profile directory; pipelines are compiled every launch
+    }
+    return directory + "\\PipelineCache.bin";
+}
+
+PipelineStateManager::PipelineCacheHeader PipelineStateManager::GetPipelineCacheIdentity() {
+    PipelineCacheHeader identity;
+    identity.magic = PIPELINE_CACHE_MAGIC;
+    identity.version = PIPELINE_CACHE_VERSION;
+
+    ID3D12Device* device = m_renderSystem->GetDevice();
+    identity.adapterLuid = device->GetAdapterLuid();
+
+    // User-mode driver version; a driver update rejects the old library anyway, but checking
+    // first avoids handing the driver a blob it has to parse and refuse
+    IDXGIAdapter3* adapter = m_renderSystem->GetAdapter();
+    LARGE_INTEGER umdVersion = {};
+    if (adapter && SUCCEEDED(adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &umdVersion))) {
+        identity.driverVersion = static_cast<uint64_t>(umdVersion.QuadPart);
+    }
+
+    // Every shader's bytecode; changing one invalidates the file
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (int i = 0; i < static_cast<int>(Shader::Count); i++) {
+        D3D12_SHADER_BYTECODE bytecode = GetShaderBytecode(static_cast<Shader>(i));
+        hash = HashBytes(hash, bytecode.pShaderBytecode, bytecode.BytecodeLength);
+    }
+    identity.shaderHash = hash;
+    return identity;
+}
+
+void PipelineStateManager::OpenPipelineLibrary() {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    if (m_pipelineLibrary || !m_renderSystem || !m_renderSystem->GetDevice()) return;
+
+    ComPtr<ID3D12Device1> device1;
+    if (FAILED(m_renderSystem->GetDevice()->QueryInterface(IID_PPV_ARGS(&device1)))) {
+        return; // Pipelines are created directly
+    }
+
+    // Reuse the saved library when it was built for this adapter, driver and shader set
+    PipelineCacheHeader identity = GetPipelineCacheIdentity();
+    std::string path = GetPipelineCachePath();
+    if (!path.empty()) {
+        std::ifstream file(path, std::ios::binary);
+        PipelineCacheHeader header;
+        if (file && file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+            header.magic == identity.magic && header.version == identity.version &&
+            memcmp(&header.adapterLuid, &identity.adapterLuid, sizeof(LUID)) == 0 &&
+            header.driverVersion == identity.driverVersion && header.shaderHash == identity.shaderHash &&
+            header.dataSize > 0) {
+            m_pipelineLibraryData.resize(static_cast<size_t>(header.dataSize));
+            if (!file.read(reinterpret_cast<char*>(m_pipelineLibraryData.data()), m_pipelineLibraryData.size())) {
+                m_pipelineLibraryData.clear();
+            }
+        }
+    }
+
+    HRESULT hr = E_FAIL;
+    if (!m_pipelineLibraryData.empty()) {
+        hr = device1->CreatePipelineLibrary(m_pipelineLibraryData.data(), m_pipelineLibraryData.size(),
+            IID_PPV_ARGS(&m_pipelineLibrary));
+        if (FAILED(hr)) {
+            // Corrupt file, or a driver that refuses it despite the matching version
+            OutputDebugStringA("Warning: Discarding the saved pipeline library.\n");
+            m_pipelineLibraryData.clear();
+        }
+    }
     if (FAILED(hr)) {
-        if (errorBlob) {
-            OutputDebugStringA(static_cast<const char*>(errorBlob->GetBufferPointer()));
+        hr = device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&m_pipelineLibrary));
+        if (FAILED(hr)) {
+            // E.g. DXGI_ERROR_UNSUPPORTED from drivers without library support
+            OutputDebugStringA("Warning: Pipeline libraries unsupported, pipelines are compiled every launch.\n");
+            m_pipelineLibrary.Reset();
+            return;
         }
+        m_pipelineLibraryDirty = true; // Rewrite the file even if nothing new gets stored
+    }
+}
+
+ComPtr<ID3D12PipelineState> PipelineStateManager::CreateGraphicsPipeline(const std::wstring& name,
+    const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, bool* fromLibrary) {
+    ComPtr<ID3D12PipelineState> pipelineState;
+    if (fromLibrary) *fromLibrary = false;
+    if (m_pipelineLibrary) {
+        // Fails with E_INVALIDARG when the name is missing or its description changed
+        std::lock_guard<ProfiledMutex> libraryLock(m_libraryMutex);
+        if (SUCCEEDED(m_pipelineLibrary->LoadGraphicsPipeline(name.c_str(), &desc, IID_PPV_ARGS(&pipelineState)))) {
+            m_pipelineLibraryHits++;
+            if (fromLibrary) *fromLibrary = true;
+            return pipelineState;
+        }
+        m_pipelineLibraryMisses++;
+    }
+
+    // The driver compile, outside both locks
+    HRESULT hr = m_renderSystem->GetDevice()->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pipelineState));
+    if (FAILED(hr)) {
         return nullptr;
     }
 
-    // Pixel shader - choose based on blending mode
-    const char* pixelShaderSource = (key.blendMode == PipelineStateKey::NoBlend) ?
-        g_BasicPixelShader : g_TexturePixelShader;
+    if (m_pipelineLibrary) {
+        std::lock_guard<ProfiledMutex> libraryLock(m_libraryMutex);
+        if (SUCCEEDED(m_pipelineLibrary->StorePipeline(name.c_str(), pipelineState.Get()))) {
+            m_pipelineLibraryDirty = true;
+        }
+        else {
+            // Same name with a different description; reloading the library with new shaders fixes it
+            OutputDebugStringA("Warning: Failed to store a pipeline in the pipeline library.\n");
+        }
+    }
+    return pipelineState;
+}
 
-    hr = D3DCompile(
-        pixelShaderSource, strlen(pixelShaderSource),
-        nullptr, nullptr, nullptr, "main",
-        ("ps_" + key.shaderModel).c_str(),
-        compileFlags, 0, &pixelShaderBlob, &errorBlob
-    );
+ComPtr<ID3D12PipelineState> PipelineStateManager::CreateComputePipeline(const std::wstring& name,
+    const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, bool* fromLibrary) {
+    ComPtr<ID3D12PipelineState> pipelineState;
+    if (fromLibrary) *fromLibrary = false;
+    if (m_pipelineLibrary) {
+        std::lock_guard<ProfiledMutex> libraryLock(m_libraryMutex);
+        if (SUCCEEDED(m_pipelineLibrary->LoadComputePipeline(name.c_str(), &desc, IID_PPV_ARGS(&pipelineState)))) {
+            m_pipelineLibraryHits++;
+            if (fromLibrary) *fromLibrary = true;
+            return pipelineState;
+        }
+        m_pipelineLibraryMisses++;
+    }
 
+    HRESULT hr = m_renderSystem->GetDevice()->CreateComputePipelineState(&desc, IID_PPV_ARGS(&pipelineState));
     if (FAILED(hr)) {
-        if (errorBlob) {
-            OutputDebugStringA(static_cast<const char*>(errorBlob->GetBufferPointer()));
+        return nullptr;
+    }
+
+    if (m_pipelineLibrary) {
+        std::lock_guard<ProfiledMutex> libraryLock(m_libraryMutex);
+        if (SUCCEEDED(m_pipelineLibrary->StorePipeline(name.c_str(), pipelineState.Get()))) {
+            m_pipelineLibraryDirty = true;
+        }
+        else {
+            OutputDebugStringA("Warning: Failed to store a pipeline in the pipeline library.\n");
         }
+    }
+    return pipelineState;
+}
+
+void PipelineStateManager::SavePipelineLibrary() {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> libraryLock(m_libraryMutex);
+    if (!m_pipelineLibrary || !m_pipelineLibraryDirty) return;
+
+    std::string path = GetPipelineCachePath();
+    if (path.empty()) return;
+
+    PipelineCacheHeader header = GetPipelineCacheIdentity();
+    std::vector<uint8_t> data(m_pipelineLibrary->GetSerializedSize());
+    if (data.empty() || FAILED(m_pipelineLibrary->Serialize(data.data(), data.size()))) {
+        OutputDebugStringA("Warning: Failed to serialize the pipeline library.\n");
+        return;
+    }
+    header.dataSize = data.size();
+
+    bool written = WriteFileAtomic(path, [&header, &data](std::ostream& file) {
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        return true;
+    });
+    if (!written) {
+        OutputDebugStringA("Warning: Failed to write the pipeline library.\n");
+        return;
+    }
+    m_pipelineLibraryDirty = false;
+
+    char message[128];
+    snprintf(message, sizeof(message), "Pipeline library saved: %zu bytes, %u loaded, %u compiled.\n",
+        data.size(), m_pipelineLibraryHits, m_pipelineLibraryMisses);
+    OutputDebugStringA(message);
+}
+
+ComPtr<ID3D12PipelineState> PipelineStateManager::CreatePipelineState(const PipelineStateKey& key, bool* fromLibrary) {
+    if (!m_renderSystem || !m_renderSystem->GetDevice()) {
+        return nullptr;
+    }
+
+    // Shaders and root signature are shared; the pipeline itself is created unlocked
+    std::unique_lock<ProfiledMutex> lock(m_mutex);
+
+    // Shaders - pixel shader chosen by blending mode
+    D3D12_SHADER_BYTECODE vertexShader = GetShaderBytecode(Shader::BasicVS);
+    D3D12_SHADER_BYTECODE pixelShader = GetShaderBytecode(key.blendMode == PipelineStateKey::NoBlend ?
+        Shader::BasicPS : Shader::TexturePS);
+    if (!vertexShader.pShaderBytecode || !pixelShader.pShaderBytecode) {
         return nullptr;
     }
 
@@ -191,9 +862,13 @@ ComPtr<ID3D12PipelineState> PipelineStateManager::CreatePipelineState(const Pipe
         { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 20, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
     };
 
-    // Create the root signature to use
-    ID3D12RootSignature* rootSignature = (key.blendMode == PipelineStateKey::NoBlend) ?
-        GetDefaultRootSignature() : GetTextureRootSignature();
+    ComPtr<ID3D12RootSignature>& rootSignatureRef = (key.blendMode == PipelineStateKey::NoBlend) ?
+        m_defaultRootSignature : m_textureRootSignature;
+    if (!rootSignatureRef) {
+        rootSignatureRef = (key.blendMode == PipelineStateKey::NoBlend) ?
+            CreateDefaultRootSignature() : CreateTextureRootSignature();
+    }
+    ComPtr<ID3D12RootSignature> rootSignature = rootSignatureRef; // Kept alive across a ClearCache
 
     if (!rootSignature) {
         return nullptr;
@@ -202,9 +877,9 @@ ComPtr<ID3D12PipelineState> PipelineStateManager::CreatePipelineState(const Pipe
     // Create pipeline state
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
     psoDesc.InputLayout = { inputElementDescs, _countof(inputElementDescs) };
-    psoDesc.pRootSignature = rootSignature;
-    psoDesc.VS = CD3DX12_SHADER_BYTECODE(vertexShaderBlob.Get());
-    psoDesc.PS = CD3DX12_SHADER_BYTECODE(pixelShaderBlob.Get());
+    psoDesc.pRootSignature = rootSignature.Get();
+    psoDesc.VS = vertexShader;
+    psoDesc.PS = pixelShader;
     psoDesc.RasterizerState = CreateRasterizerDesc(key.rasterizerMode);
     psoDesc.BlendState = CreateBlendDesc(key.blendMode);
     psoDesc.DepthStencilState = CreateDepthStencilDesc(key.depthMode);
@@ -215,13 +890,12 @@ ComPtr<ID3D12PipelineState> PipelineStateManager::CreatePipelineState(const Pipe
     psoDesc.DSVFormat = key.depthStencilFormat;
     psoDesc.SampleDesc.Count = 1;
 
-    ComPtr<ID3D12PipelineState> pipelineState;
-    hr = m_renderSystem->GetDevice()->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pipelineState));
-    if (FAILED(hr)) {
-        return nullptr;
-    }
-
-    return pipelineState;
+    wchar_t name[64];
+    swprintf_s(name, L"Pipeline b%d r%d d%d rt%d ds%d", static_cast<int>(key.blendMode),
+        static_cast<int>(key.rasterizerMode), static_cast<int>(key.depthMode), static_cast<int>(key.renderTargetFormat),
+        static_cast<int>(key.depthStencilFormat));
+    lock.unlock();
+    return CreateGraphicsPipeline(name, psoDesc, fromLibrary);
 }
 
 ComPtr<ID3D12RootSignature> PipelineStateManager::CreateDefaultRootSignature() {
@@ -302,6 +976,252 @@ ComPtr<ID3D12RootSignature> PipelineStateManager::CreateTextureRootSignature() {
     return rootSignature;
 }
 
+ComPtr<ID3D12RootSignature> PipelineStateManager::CreateSpriteRootSignature() {
+    if (!m_renderSystem || !m_renderSystem->GetDevice()) {
+        return nullptr;
+    }
+
+    // Texture SRV table
+    D3D12_DESCRIPTOR_RANGE srvRange = {};
+    srvRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+    srvRange.NumDescriptors = 1;
+    srvRange.BaseShaderRegister = 0;
+    srvRange.RegisterSpace = 0;
+    srvRange.OffsetInDescriptorsFromTableStart = 0;
+
+    D3D12_ROOT_PARAMETER rootParameters[2] = {};
+    rootParameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    rootParameters[0].DescriptorTable.NumDescriptorRanges = 1;
+    rootParameters[0].DescriptorTable.pDescriptorRanges = &srvRange;
+    rootParameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+    rootParameters[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+    rootParameters[1].Constants.ShaderRegister = 0;
+    rootParameters[1].Constants.RegisterSpace = 0;
+    rootParameters[1].Constants.Num32BitValues = sizeof(SpriteConstants) / sizeof(UINT);
+    rootParameters[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+
+    // Static bilinear clamp sampler, so no sampler heap is needed
+    D3D12_STATIC_SAMPLER_DESC sampler = {};
+    sampler.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+    sampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.MaxLOD = D3D12_FLOAT32_MAX;
+    sampler.ShaderRegister = 0;
+    sampler.RegisterSpace = 0;
+    sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+    D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc = {};
+    rootSignatureDesc.NumParameters = _countof(rootParameters);
+    rootSignatureDesc.pParameters = rootParameters;
+    rootSignatureDesc.NumStaticSamplers = 1;
+    rootSignatureDesc.pStaticSamplers = &sampler;
+    rootSignatureDesc.Flags = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
+
+    // Serialize the root signature
+    ComPtr<ID3DBlob> signature;
+    ComPtr<ID3DBlob> error;
+    HRESULT hr = D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &error);
+    if (FAILED(hr)) {
+        if (error) {
+            OutputDebugStringA(static_cast<const char*>(error->GetBufferPointer()));
+        }
+        return nullptr;
+    }
+
+    ComPtr<ID3D12RootSignature> rootSignature;
+    hr = m_renderSystem->GetDevice()->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&rootSignature));
+    if (FAILED(hr)) {
+        return nullptr;
+    }
+
+    return rootSignature;
+}
+
+ComPtr<ID3D12RootSignature> PipelineStateManager::CreateTextureConvertRootSignature() {
+    if (!m_renderSystem || !m_renderSystem->GetDevice()) {
+        return nullptr;
+    }
+
+    // t0-t1 sources, u0-u4 destination levels, in one table
+    D3D12_DESCRIPTOR_RANGE ranges[2] = {};
+    ranges[0].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+    ranges[0].NumDescriptors = 2;
+    ranges[0].BaseShaderRegister = 0;
+    ranges[0].OffsetInDescriptorsFromTableStart = 0;
+    ranges[1].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+    ranges[1].NumDescriptors = 5;
+    ranges[1].BaseShaderRegister = 0;
+    ranges[1].OffsetInDescriptorsFromTableStart = 2;
+
+    D3D12_ROOT_PARAMETER rootParameters[2] = {};
+    rootParameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    rootParameters[0].DescriptorTable.NumDescriptorRanges = _countof(ranges);
+    rootParameters[0].DescriptorTable.pDescriptorRanges = ranges;
+    rootParameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+    rootParameters[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+    rootParameters[1].Constants.ShaderRegister = 0;
+    rootParameters[1].Constants.RegisterSpace = 0;
+    rootParameters[1].Constants.Num32BitValues = sizeof(TextureConvertConstants) / sizeof(UINT);
+    rootParameters[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+    D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc = {};
+    rootSignatureDesc.NumParameters = _countof(rootParameters);
+    rootSignatureDesc.pParameters = rootParameters;
+    rootSignatureDesc.NumStaticSamplers = 0;
+    rootSignatureDesc.pStaticSamplers = nullptr;
+    rootSignatureDesc.Flags = D3D12_ROOT_SIGNATURE_FLAG_NONE;
+
+    // Serialize the root signature
+    ComPtr<ID3DBlob> signature;
+    ComPtr<ID3DBlob> error;
+    HRESULT hr = D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &error);
+    if (FAILED(hr)) {
+        if (error) {
+            OutputDebugStringA(static_cast<const char*>(error->GetBufferPointer()));
+        }
+        return nullptr;
+    }
+
+    ComPtr<ID3D12RootSignature> rootSignature;
+    hr = m_renderSystem->GetDevice()->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&rootSignature));
+    if (FAILED(hr)) {
+        return nullptr;
+    }
+
+    return rootSignature;
+}
+
+ComPtr<ID3D12RootSignature> PipelineStateManager::CreateThumbnailEncodeRootSignature() {
+    if (!m_renderSystem || !m_renderSystem->GetDevice()) {
+        return nullptr;
+    }
+
+    // t0 source, u0 block buffer, in one table
+    D3D12_DESCRIPTOR_RANGE ranges[2] = {};
+    ranges[0].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+    ranges[0].NumDescriptors = 1;
+    ranges[0].BaseShaderRegister = 0;
+    ranges[0].OffsetInDescriptorsFromTableStart = 0;
+    ranges[1].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+    ranges[1].NumDescriptors = 1;
+    ranges[1].BaseShaderRegister = 0;
+    ranges[1].OffsetInDescriptorsFromTableStart = 1;
+
+    D3D12_ROOT_PARAMETER rootParameters[2] = {};
+    rootParameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    rootParameters[0].DescriptorTable.NumDescriptorRanges = _countof(ranges);
+    rootParameters[0].DescriptorTable.pDescriptorRanges = ranges;
+    rootParameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+    rootParameters[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+    rootParameters[1].Constants.ShaderRegister = 0;
+    rootParameters[1].Constants.RegisterSpace = 0;
+    rootParameters[1].Constants.Num32BitValues = sizeof(ThumbnailEncodeConstants) / sizeof(UINT);
+    rootParameters[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+    D3D12_STATIC_SAMPLER_DESC sampler = {};
+    sampler.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+    sampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.MaxLOD = D3D12_FLOAT32_MAX;
+    sampler.ShaderRegister = 0;
+    sampler.RegisterSpace = 0;
+    sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+    D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc = {};
+    rootSignatureDesc.NumParameters = _countof(rootParameters);
+    rootSignatureDesc.pParameters = rootParameters;
+    rootSignatureDesc.NumStaticSamplers = 1;
+    rootSignatureDesc.pStaticSamplers = &sampler;
+    rootSignatureDesc.Flags = D3D12_ROOT_SIGNATURE_FLAG_NONE;
+
+    ComPtr<ID3DBlob> signature;
+    ComPtr<ID3DBlob> error;
+    HRESULT hr = D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &error);
+    if (FAILED(hr)) {
+        if (error) {
+            OutputDebugStringA(static_cast<const char*>(error->GetBufferPointer()));
+        }
+        return nullptr;
+    }
+
+    ComPtr<ID3D12RootSignature> rootSignature;
+    hr = m_renderSystem->GetDevice()->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&rootSignature));
+    if (FAILED(hr)) {
+        return nullptr;
+    }
+
+    return rootSignature;
+}
+
+ComPtr<ID3D12RootSignature> PipelineStateManager::CreateUpscaleRootSignature() {
+    if (!m_renderSystem || !m_renderSystem->GetDevice()) {
+        return nullptr;
+    }
+
+    // Source texture SRV table
+    D3D12_DESCRIPTOR_RANGE srvRange = {};
+    srvRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+    srvRange.NumDescriptors = 1;
+    srvRange.BaseShaderRegister = 0;
+    srvRange.RegisterSpace = 0;
+    srvRange.OffsetInDescriptorsFromTableStart = 0;
+
+    D3D12_ROOT_PARAMETER rootParameters[2] = {};
+    rootParameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    rootParameters[0].DescriptorTable.NumDescriptorRanges = 1;
+    rootParameters[0].DescriptorTable.pDescriptorRanges = &srvRange;
+    rootParameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+    rootParameters[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+    rootParameters[1].Constants.ShaderRegister = 0;
+    rootParameters[1].Constants.RegisterSpace = 0;
+    rootParameters[1].Constants.Num32BitValues = sizeof(UpscaleConstants) / sizeof(UINT);
+    rootParameters[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+    // Static bilinear clamp sampler, so no sampler heap is needed
+    D3D12_STATIC_SAMPLER_DESC sampler = {};
+    sampler.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+    sampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.MaxLOD = D3D12_FLOAT32_MAX;
+    sampler.ShaderRegister = 0;
+    sampler.RegisterSpace = 0;
+    sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+    D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc = {};
+    rootSignatureDesc.NumParameters = _countof(rootParameters);
+    rootSignatureDesc.pParameters = rootParameters;
+    rootSignatureDesc.NumStaticSamplers = 1;
+    rootSignatureDesc.pStaticSamplers = &sampler;
+    rootSignatureDesc.Flags = D3D12_ROOT_SIGNATURE_FLAG_NONE;
+
+    // Serialize the root signature
+    ComPtr<ID3DBlob> signature;
+    ComPtr<ID3DBlob> error;
+    HRESULT hr = D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &error);
+    if (FAILED(hr)) {
+        if (error) {
+            OutputDebugStringA(static_cast<const char*>(error->GetBufferPointer()));
+        }
+        return nullptr;
+    }
+
+    // Create the root signature
+    ComPtr<ID3D12RootSignature> rootSignature;
+    hr = m_renderSystem->GetDevice()->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&rootSignature));
+    if (FAILED(hr)) {
+        return nullptr;
+    }
+
+    return rootSignature;
+}
+
 D3D12_BLEND_DESC PipelineStateManager::CreateBlendDesc(PipelineStateKey::BlendMode blendMode) {
     D3D12_BLEND_DESC blendDesc = {};
     blendDesc.AlphaToCoverageEnable = FALSE;
@@ -344,6 +1264,18 @@ D3D12_BLEND_DESC PipelineStateManager::CreateBlendDesc(PipelineStateKey::BlendMo
         blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
         break;
 
+    case PipelineStateKey::PremultipliedBlend:
+        blendDesc.RenderTarget[0].BlendEnable = TRUE;
+        blendDesc.RenderTarget[0].LogicOpEnable = FALSE;
+        blendDesc.RenderTarget[0].SrcBlend = D3D12_BLEND_ONE;
+        blendDesc.RenderTarget[0].DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+        blendDesc.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
+        blendDesc.RenderTarget[0].SrcBlendAlpha = D3D12_BLEND_ONE;
+        blendDesc.RenderTarget[0].DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA;
+        blendDesc.RenderTarget[0].BlendOpAlpha = D3D12_BLEND_OP_ADD;
+        blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+        break;
+
     case PipelineStateKey::SubtractBlend:
         blendDesc.RenderTarget[0].BlendEnable = TRUE;
         blendDesc.RenderTarget[0].LogicOpEnable = FALSE;
@@ -11,6 +11,12 @@
 #include <string>
 #include <memory>
 #include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+#include "CpuProfiler.h"
+#include "JobSystem.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -21,6 +27,7 @@ struct PipelineStateKey {
         AlphaBlend,
         AddBlend,
         SubtractBlend,
+        PremultipliedBlend, // Source color already multiplied by its alpha (offscreen layers)
         // Add more as needed
     };
 
@@ -42,33 +49,92 @@ struct PipelineStateKey {
     DepthMode depthMode = NoDepth;
     DXGI_FORMAT renderTargetFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
     DXGI_FORMAT depthStencilFormat = DXGI_FORMAT_UNKNOWN;
-    std::string shaderModel = "5_1";
 
-    // Helper struct for hashing
+    // Every field in one 64-bit value: modes in 4 bits each, formats in 16 bits each
+    // (bits 48-63 are free for future fields). Never equal to UINT64_MAX.
+    uint64_t Pack() const {
+        return static_cast<uint64_t>(blendMode & 0xF) |
+            (static_cast<uint64_t>(rasterizerMode & 0xF) << 4) |
+            (static_cast<uint64_t>(depthMode & 0xF) << 8) |
+            (static_cast<uint64_t>(renderTargetFormat & 0xFFFF) << 16) |
+            (static_cast<uint64_t>(depthStencilFormat & 0xFFFF) << 32);
+    }
+
+    // Helper struct for hashing: mixes the packed key so neighbouring modes and formats spread
+    // across buckets (splitmix64 finalizer)
     struct Hash {
+        static uint64_t Mix(uint64_t value) {
+            value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+            value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+            return value ^ (value >> 31);
+        }
         size_t operator()(const PipelineStateKey& key) const {
-            size_t h1 = std::hash<int>()(static_cast<int>(key.blendMode));
-            size_t h2 = std::hash<int>()(static_cast<int>(key.rasterizerMode));
-            size_t h3 = std::hash<int>()(static_cast<int>(key.depthMode));
-            size_t h4 = std::hash<int>()(key.renderTargetFormat);
-            size_t h5 = std::hash<int>()(key.depthStencilFormat);
-            size_t h6 = std::hash<std::string>()(key.shaderModel);
-
-            return h1 ^ (h2 << 1) ^ (h3 << 2) ^ (h4 << 3) ^ (h5 << 4) ^ (h6 << 5);
+            return static_cast<size_t>(Mix(key.Pack()));
         }
     };
 
     // Equality operator for hash map
     bool operator==(const PipelineStateKey& other) const {
-        return blendMode == other.blendMode &&
-            rasterizerMode == other.rasterizerMode &&
-            depthMode == other.depthMode &&
-            renderTargetFormat == other.renderTargetFormat &&
-            depthStencilFormat == other.depthStencilFormat &&
-            shaderModel == other.shaderModel;
+        return Pack() == other.Pack();
     }
 };
 
+// Filters for the render-scale upscale pass
+enum class UpscaleFilter {
+    Bilinear,   // Plain bilinear resample
+    Sharpen     // Bilinear plus contrast-adaptive sharpening (FSR1 RCAS-style)
+};
+
+// Root constants consumed by the upscale shaders (b0)
+struct UpscaleConstants {
+    float sourceTexelSize[2];   // 1 / source dimensions
+    float sharpness;            // 0 = none, 1 = maximum
+    float outputScale;          // 0 = SDR as is; else scRGB with SDR white at this value
+};
+
+// One quad drawn by SpriteBatch: corners are origin + {0,1} * axisX + {0,1} * axisY, in pixels,
+// so lines and rotated icons are quads too. Matches the SpriteVS instance stream.
+struct SpriteInstance {
+    float origin[2];
+    float axisX[2];
+    float axisY[2];
+    float texRect[4];   // u0, v0, u1, v1
+    uint32_t color;     // RGBA8, R in the low byte (IM_COL32 order)
+};
+
+// Root constants consumed by the sprite vertex shader (b0)
+struct SpriteConstants {
+    float pixelToClip[2];   // 2 / target size in pixels
+    float padding[2];
+};
+
+// TextureConvertConstants::flags (match TextureConvertCS.hlsl)
+enum TextureConvertFlags : UINT {
+    TextureConvertBufferSource = 1, // Raw BGRA buffer at t0, otherwise a texture at t1
+    TextureConvertWriteFirst = 2,   // Write the source level to u0 (off when downsampling a mip)
+    TextureConvertPremultiply = 4,
+    TextureConvertLinearMips = 8    // sRGB content: mips are averaged in linear light
+};
+
+// Root constants consumed by the texture convert compute shader (b0)
+struct TextureConvertConstants {
+    UINT origin[2];       // First texel of the region in the source level, a multiple of 16
+    UINT sourceSize[2];   // Source level size in texels
+    UINT rowPitch;        // Buffer source: bytes per row
+    UINT mipCount;        // Levels written after the source level (u1-u4), 0-4
+    UINT flags;           // TextureConvertFlags
+    UINT padding;
+};
+
+// Root constants consumed by the thumbnail encode compute shader (b0)
+struct ThumbnailEncodeConstants {
+    float texelToUv[2];   // Source UV per thumbnail texel
+    float uvMax[2];       // Painted part of the source
+    UINT blockCount[2];
+    UINT rowPitch;        // Output bytes per row of 4x4 blocks
+    float sourceLod;
+};
+
 // Forward declaration
 class RenderSystem;
 
@@ -87,23 +153,139 @@ public:
     // Initialize the manager
     void Initialize();
 
-    // Get or create a pipeline state for the given configuration
+    // Get or create a pipeline state for the given configuration. Blocks until it is created
+    // (waiting for a background compile of the same key rather than compiling it twice).
     ID3D12PipelineState* GetPipelineState(const PipelineStateKey& key);
 
+    // --- Background Compilation ---
+    // Pipelines are compiled on worker threads without holding the lookup lock, so a new blend
+    // or raster mode never stalls the render thread or other lookups.
+    using PipelineReadyCallback = std::function<void(ID3D12PipelineState*)>; // nullptr if creation failed
+
+    // Queues every key that isn't created or queued yet
+    void Prewarm(const std::vector<PipelineStateKey>& keys);
+    // Never blocks: the pipeline if it is ready, otherwise queues it and returns fallback
+    ID3D12PipelineState* TryGetPipelineState(const PipelineStateKey& key, ID3D12PipelineState* fallback = nullptr);
+    // Runs callback once the pipeline is ready: right away if it is, otherwise on the compiling thread
+    void WhenPipelineReady(const PipelineStateKey& key, PipelineReadyCallback callback);
+
+    struct PipelineStats {
+        PipelineStateKey key;
+        bool ready = false;
+        bool failed = false;
+        bool fromLibrary = false;  // Loaded from the pipeline library instead of compiled by the driver
+        float createTimeMs = 0.0f; // Shader and driver work for this pipeline
+    };
+    std::vector<PipelineStats> GetPipelineStats() const;
+    size_t GetPendingPipelineCount() const;
+
     // Get or create root signatures
     ID3D12RootSignature* GetDefaultRootSignature();
     ID3D12RootSignature* GetTextureRootSignature();
 
+    // Fullscreen upscale pass (SRV table at slot 0, UpscaleConstants at slot 1, static linear sampler)
+    ID3D12PipelineState* GetUpscalePipelineState(UpscaleFilter filter, DXGI_FORMAT renderTargetFormat);
+    ID3D12RootSignature* GetUpscaleRootSignature();
+    // Same root signature and bilinear shader, blended over the target as premultiplied alpha: draws
+    // a same-size offscreen layer (the cached UI) back into the frame
+    ID3D12PipelineState* GetLayerCompositePipelineState(DXGI_FORMAT renderTargetFormat);
+
+    // Instanced quads (SpriteInstance stream in slot 0, SRV table at slot 0, SpriteConstants at
+    // slot 1, static linear sampler), alpha blended
+    ID3D12PipelineState* GetSpritePipelineState(DXGI_FORMAT renderTargetFormat);
+    ID3D12RootSignature* GetSpriteRootSignature();
+
+    // Compute: BGRA frame to RGBA texture plus four mips per dispatch (TextureConverter). One table at
+    // slot 0 (t0 raw buffer, t1 texture, u0-u4 levels), TextureConvertConstants at slot 1.
+    ID3D12PipelineState* GetTextureConvertPipelineState();
+    ID3D12RootSignature* GetTextureConvertRootSignature();
+
+    // Compute: browser texture to BC1 blocks in a raw buffer (TabThumbnailCache). One table at slot 0
+    // (t0 source, u0 blocks), ThumbnailEncodeConstants at slot 1, static linear clamp sampler.
+    ID3D12PipelineState* GetThumbnailEncodePipelineState();
+    ID3D12RootSignature* GetThumbnailEncodeRootSignature();
+
     // Clear all cached pipeline states and root signatures
     void ClearCache();
 
+    // Pipeline states are kept in an ID3D12PipelineLibrary saved under %LOCALAPPDATA%\GameOverlay,
+    // so warm starts load them instead of compiling them in the driver. The file is discarded when
+    // the adapter, driver version or shaders change. Saved on destruction; call earlier to keep
+    // pipelines across a crash.
+    void SavePipelineLibrary();
+    bool IsPipelineLibraryAvailable() const { return m_pipelineLibrary != nullptr; }
+
 private:
-    // Create a pipeline state for the given configuration
-    ComPtr<ID3D12PipelineState> CreatePipelineState(const PipelineStateKey& key);
+    // Released once frames in flight are done with it (caller holds m_mutex)
+    void RetirePipelineObject(ComPtr<IUnknown> object);
+
+    // Shaders from shaders/*.hlsl, in g_shaderInfo order
+    enum class Shader {
+        BasicVS,
+        BasicPS,
+        TexturePS,
+        UpscaleVS,
+        UpscaleBilinearPS,
+        UpscaleSharpenPS,
+        SpriteVS,
+        TextureConvertCS,
+        ThumbnailEncodeCS,
+        Count
+    };
+    // Embedded bytecode, or compiled on first use with GAMEOVERLAY_RUNTIME_SHADERS (caller holds m_mutex).
+    // Empty if compilation failed.
+    D3D12_SHADER_BYTECODE GetShaderBytecode(Shader shader);
+
+    // Identifies what the pipeline library was built for; any difference invalidates the file
+    struct PipelineCacheHeader {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        LUID adapterLuid = {};
+        uint64_t driverVersion = 0;
+        uint64_t shaderHash = 0;
+        uint64_t dataSize = 0; // Serialized library bytes that follow
+    };
+
+    // --- Pipeline Library ---
+    void OpenPipelineLibrary();
+    PipelineCacheHeader GetPipelineCacheIdentity();
+    static std::string GetPipelineCachePath();
+    // Loads the pipeline from the library, or creates and stores it; takes m_libraryMutex only
+    // around library calls, so it may run with or without m_mutex held
+    ComPtr<ID3D12PipelineState> CreateGraphicsPipeline(const std::wstring& name,
+                                                       const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc,
+                                                       bool* fromLibrary = nullptr);
+    ComPtr<ID3D12PipelineState> CreateComputePipeline(const std::wstring& name,
+                                                      const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc,
+                                                      bool* fromLibrary = nullptr);
+
+    // Create a pipeline state for the given configuration (takes m_mutex only around shared state)
+    ComPtr<ID3D12PipelineState> CreatePipelineState(const PipelineStateKey& key, bool* fromLibrary = nullptr);
+
+    // Lock-free lookup in the published table; nullptr if the pipeline isn't ready
+    ID3D12PipelineState* FindPublishedPipeline(uint64_t packedKey) const;
+    // Publishes a new table with every ready pipeline (caller holds m_mutex)
+    void PublishPipelinesLocked();
+
+    // Compiles key's pipeline and publishes it to its entry (caller must not hold m_mutex)
+    void CompilePipeline(const PipelineStateKey& key);
+    // Queues key if it has no entry yet; returns the entry (caller holds m_mutex)
+    struct PipelineEntry;
+    PipelineEntry& QueuePipelineLocked(const PipelineStateKey& key);
+    void CompileJob(const PipelineStateKey& key);
 
     // Create root signatures
     ComPtr<ID3D12RootSignature> CreateDefaultRootSignature();
     ComPtr<ID3D12RootSignature> CreateTextureRootSignature();
+    ComPtr<ID3D12RootSignature> CreateUpscaleRootSignature();
+    ComPtr<ID3D12PipelineState> CreateUpscalePipelineState(UpscaleFilter filter, DXGI_FORMAT renderTargetFormat,
+                                                           PipelineStateKey::BlendMode blendMode = PipelineStateKey::NoBlend);
+    ComPtr<ID3D12RootSignature> CreateSpriteRootSignature();
+    ComPtr<ID3D12PipelineState> CreateSpritePipelineState(DXGI_FORMAT renderTargetFormat);
+    ComPtr<ID3D12RootSignature> CreateTextureConvertRootSignature();
+    ComPtr<ID3D12PipelineState> CreateTextureConvertPipelineState();
+    ComPtr<ID3D12RootSignature> CreateThumbnailEncodeRootSignature();
+    ComPtr<ID3D12PipelineState> CreateThumbnailEncodePipelineState();
 
     // Helper to create blend description based on blend mode
     D3D12_BLEND_DESC CreateBlendDesc(PipelineStateKey::BlendMode blendMode);
@@ -117,13 +299,74 @@ private:
     // Resource pointer (not owned)
     RenderSystem* m_renderSystem = nullptr;
 
-    // Cache of pipeline states
-    std::unordered_map<PipelineStateKey, ComPtr<ID3D12PipelineState>, PipelineStateKey::Hash> m_pipelineStates;
+    // Cache of pipeline states; an entry exists from the moment a key is requested
+    struct PipelineEntry {
+        ComPtr<ID3D12PipelineState> pipelineState;
+        bool pending = true;  // Queued or compiling
+        bool queued = false;  // Compile job not started yet
+        bool failed = false;
+        bool fromLibrary = false;
+        float createTimeMs = 0.0f;
+        std::vector<PipelineReadyCallback> callbacks;
+    };
+    std::unordered_map<PipelineStateKey, PipelineEntry, PipelineStateKey::Hash> m_pipelineStates;
+
+    // Read-only snapshot of the ready pipelines for lock-free lookups: a flat open-addressing table
+    // (linear probing, at most half full) rebuilt and republished whenever a pipeline becomes ready.
+    // Replaced tables are kept until destruction, since a reader may still be probing one; pipelines
+    // are created a handful of times per run, so they stay small.
+    struct PublishedPipeline {
+        uint64_t packedKey = UINT64_MAX; // UINT64_MAX marks an empty slot
+        ID3D12PipelineState* pipelineState = nullptr; // Owned by m_pipelineStates
+    };
+    struct PipelineTable {
+        std::vector<PublishedPipeline> slots; // Power-of-two size
+    };
+    std::atomic<const PipelineTable*> m_publishedTable{ nullptr };
+    std::vector<std::unique_ptr<PipelineTable>> m_pipelineTables; // Current and replaced
+
+    // Compile jobs
+    JobCounter m_compileJobs;
+    ProfiledConditionVariable m_pipelineReadyCondition;
+    bool m_stopping = false;
+
+    // Shaders compiled at run time (GAMEOVERLAY_RUNTIME_SHADERS only)
+    ComPtr<ID3DBlob> m_shaderBlobs[static_cast<int>(Shader::Count)];
 
     // Root signatures
     ComPtr<ID3D12RootSignature> m_defaultRootSignature;
     ComPtr<ID3D12RootSignature> m_textureRootSignature;
+    ComPtr<ID3D12RootSignature> m_upscaleRootSignature;
+
+    // Upscale pipelines (one per filter; render target format is fixed per swap chain)
+    ComPtr<ID3D12PipelineState> m_upscalePipelineStates[2];
+    DXGI_FORMAT m_upscaleFormat = DXGI_FORMAT_UNKNOWN;
+    ComPtr<ID3D12PipelineState> m_layerCompositePipelineState;
+    DXGI_FORMAT m_layerCompositeFormat = DXGI_FORMAT_UNKNOWN;
+
+    // Sprite batch pipeline
+    ComPtr<ID3D12RootSignature> m_spriteRootSignature;
+    ComPtr<ID3D12PipelineState> m_spritePipelineState;
+    DXGI_FORMAT m_spriteFormat = DXGI_FORMAT_UNKNOWN;
+
+    // Texture convert compute pipeline
+    ComPtr<ID3D12RootSignature> m_textureConvertRootSignature;
+    ComPtr<ID3D12PipelineState> m_textureConvertPipelineState;
+
+    // Thumbnail encode compute pipeline
+    ComPtr<ID3D12RootSignature> m_thumbnailEncodeRootSignature;
+    ComPtr<ID3D12PipelineState> m_thumbnailEncodePipelineState;
+
+    // Disk-backed pipeline library (null when the device doesn't support one); the serialized
+    // data it was created from must outlive it, so it is declared first
+    std::vector<uint8_t> m_pipelineLibraryData;
+    ComPtr<ID3D12PipelineLibrary> m_pipelineLibrary;
+    bool m_pipelineLibraryDirty = false;        // Pipelines stored since the last save
+    UINT m_pipelineLibraryHits = 0;
+    UINT m_pipelineLibraryMisses = 0;
 
-    // Thread safety
-    std::mutex m_mutex;
+    // Thread safety: m_mutex guards the caches, root signatures and shaders; m_libraryMutex the
+    // pipeline library and its counters. Lock order is m_mutex, then m_libraryMutex.
+    mutable PROFILE_MUTEX(m_mutex, "PipelineStateManager");
+    PROFILE_MUTEX(m_libraryMutex, "PipelineStateManager library");
 };
\ No newline at end of file
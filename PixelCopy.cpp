@@ -0,0 +1,271 @@
+// GameOverlay - PixelCopy.cpp
+// Row copy and hash kernels for writing BGRA pixels into upload memory
+
+#include "PixelCopy.h"
+#include <intrin.h>
+#include <immintrin.h>
+#include <cstring>
+
+using RowCopyFunc = void (*)(uint8_t* dst, const uint8_t* src, size_t rowBytes, bool premultiplyAlpha);
+using RowsHashFunc = uint64_t (*)(const uint8_t* src, size_t srcPitch, size_t rowBytes, size_t rowCount);
+
+// x * a / 255, rounded; exact for all 8-bit inputs
+static inline uint8_t MulDiv255(uint32_t x, uint32_t a) {
+    uint32_t t = x * a + 128;
+    return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+}
+
+static void CopyRowScalar(uint8_t* dst, const uint8_t* src, size_t rowBytes, bool premultiplyAlpha) {
+    if (!premultiplyAlpha) {
+        memcpy(dst, src, rowBytes);
+        return;
+    }
+
+    for (size_t i = 0; i + 4 <= rowBytes; i += 4) {
+        uint32_t a = src[i + 3];
+        dst[i + 0] = MulDiv255(src[i + 0], a);
+        dst[i + 1] = MulDiv255(src[i + 1], a);
+        dst[i + 2] = MulDiv255(src[i + 2], a);
+        dst[i + 3] = static_cast<uint8_t>(a);
+    }
+}
+
+// Two pixels widened to 16 bits per channel (B, G, R, A, B, G, R, A)
+static inline __m128i PremultiplyWords(__m128i pixels) {
+    const __m128i alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    // Alpha itself is multiplied by 255, i.e. kept
+    alpha = _mm_or_si128(_mm_andnot_si128(alphaLanes, alpha), _mm_and_si128(alphaLanes, _mm_set1_epi16(255)));
+
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(pixels, alpha), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+static inline __m128i Premultiply(__m128i pixels) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = PremultiplyWords(_mm_unpacklo_epi8(pixels, zero));
+    __m128i hi = PremultiplyWords(_mm_unpackhi_epi8(pixels, zero));
+    return _mm_packus_epi16(lo, hi);
+}
+
+static inline __m256i PremultiplyWords(__m256i pixels) {
+    const __m256i alphaLanes = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+    __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    alpha = _mm256_or_si256(_mm256_andnot_si256(alphaLanes, alpha), _mm256_and_si256(alphaLanes, _mm256_set1_epi16(255)));
+
+    __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(pixels, alpha), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+static inline __m256i Premultiply(__m256i pixels) {
+    // Unpack and pack both work per 128-bit lane, so pixel order is preserved
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i lo = PremultiplyWords(_mm256_unpacklo_epi8(pixels, zero));
+    __m256i hi = PremultiplyWords(_mm256_unpackhi_epi8(pixels, zero));
+    return _mm256_packus_epi16(lo, hi);
+}
+
+// Bytes until dst reaches the streaming alignment, whole pixels only
+static inline size_t HeadBytes(const uint8_t* dst, size_t alignment, size_t rowBytes) {
+    size_t misalignment = reinterpret_cast<uintptr_t>(dst) & (alignment - 1);
+    size_t head = misalignment ? alignment - misalignment : 0;
+    return head < rowBytes ? head : rowBytes;
+}
+
+static void CopyRowSse2(uint8_t* dst, const uint8_t* src, size_t rowBytes, bool premultiplyAlpha) {
+    size_t head = HeadBytes(dst, 16, rowBytes);
+    CopyRowScalar(dst, src, head, premultiplyAlpha);
+
+    size_t i = head;
+    for (; i + 16 <= rowBytes; i += 16) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        if (premultiplyAlpha) {
+            pixels = Premultiply(pixels);
+        }
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), pixels);
+    }
+
+    CopyRowScalar(dst + i, src + i, rowBytes - i, premultiplyAlpha);
+}
+
+static void CopyRowAvx2(uint8_t* dst, const uint8_t* src, size_t rowBytes, bool premultiplyAlpha) {
+    size_t head = HeadBytes(dst, 32, rowBytes);
+    CopyRowScalar(dst, src, head, premultiplyAlpha);
+
+    size_t i = head;
+    for (; i + 32 <= rowBytes; i += 32) {
+        __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        if (premultiplyAlpha) {
+            pixels = Premultiply(pixels);
+        }
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i), pixels);
+    }
+
+    CopyRowScalar(dst + i, src + i, rowBytes - i, premultiplyAlpha);
+}
+
+// --- Hashing ---
+// XXH3's stripe accumulation: four 64-bit lanes, each input word mixed with a secret and
+// multiplied with itself, scrambled after every row. Rows are short (a 64 pixel tile is 256
+// bytes), so the secret simply repeats every 64 bytes.
+
+static constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+static constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr uint32_t PRIME32_1 = 0x9E3779B1U;
+
+alignas(32) static const uint64_t HASH_SECRET[8] = {
+    0xBE4BA423396CFEB8ULL, 0x1CAD21F72C81017CULL, 0xDB979083E96DD4DEULL, 0x1F67B3B7A4A44072ULL,
+    0x78E5C0CC4EE679CBULL, 0x2172FFCC7DD05A82ULL, 0x8E2443F7744608B8ULL, 0x4C263A81E69035E0ULL,
+};
+
+static inline uint64_t Avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= 0x165667919E3779F9ULL;
+    return h ^ (h >> 32);
+}
+
+static inline uint64_t MixTail(uint64_t tail, uint32_t word) {
+    tail ^= word * PRIME64_1;
+    return ((tail << 31) | (tail >> 33)) * PRIME64_2;
+}
+
+// Lanes, sub-16-byte tails and length folded into the result
+static uint64_t MergeLanes(const uint64_t lanes[4], uint64_t tail, size_t length) {
+    uint64_t h = length * PRIME64_1 ^ tail;
+    for (int i = 0; i < 4; i++) {
+        h = (h ^ Avalanche(lanes[i] ^ HASH_SECRET[i])) * PRIME64_2 + PRIME64_4;
+    }
+    return Avalanche(h);
+}
+
+static inline uint64_t HashRowTail(uint64_t tail, const uint8_t* src, size_t bytes) {
+    for (size_t i = 0; i + 4 <= bytes; i += 4) {
+        uint32_t word;
+        memcpy(&word, src + i, sizeof(word));
+        tail = MixTail(tail, word);
+    }
+    return tail;
+}
+
+static inline __m128i Accumulate(__m128i acc, __m128i data, __m128i key) {
+    __m128i mixed = _mm_xor_si128(data, key);
+    __m128i product = _mm_mul_epu32(mixed, _mm_shuffle_epi32(mixed, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_add_epi64(_mm_add_epi64(acc, _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2))), product);
+}
+
+static inline __m128i Scramble(__m128i acc, __m128i key) {
+    acc = _mm_xor_si128(_mm_xor_si128(acc, _mm_srli_epi64(acc, 47)), key);
+    const __m128i prime = _mm_set1_epi32(static_cast<int>(PRIME32_1));
+    __m128i lo = _mm_mul_epu32(acc, prime);
+    __m128i hi = _mm_mul_epu32(_mm_srli_epi64(acc, 32), prime);
+    return _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+}
+
+static inline __m256i Accumulate(__m256i acc, __m256i data, __m256i key) {
+    __m256i mixed = _mm256_xor_si256(data, key);
+    __m256i product = _mm256_mul_epu32(mixed, _mm256_shuffle_epi32(mixed, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm256_add_epi64(_mm256_add_epi64(acc, _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2))), product);
+}
+
+static inline __m256i Scramble(__m256i acc, __m256i key) {
+    acc = _mm256_xor_si256(_mm256_xor_si256(acc, _mm256_srli_epi64(acc, 47)), key);
+    const __m256i prime = _mm256_set1_epi32(static_cast<int>(PRIME32_1));
+    __m256i lo = _mm256_mul_epu32(acc, prime);
+    __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(acc, 32), prime);
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+}
+
+static uint64_t HashRowsSse2(const uint8_t* src, size_t srcPitch, size_t rowBytes, size_t rowCount) {
+    const __m128i* secret = reinterpret_cast<const __m128i*>(HASH_SECRET);
+    __m128i acc0 = _mm_set_epi64x(PRIME64_2, PRIME64_1);
+    __m128i acc1 = _mm_set_epi64x(PRIME64_4, PRIME64_3);
+    uint64_t tail = 0;
+
+    for (size_t y = 0; y < rowCount; ++y) {
+        const uint8_t* row = src + y * srcPitch;
+        size_t i = 0;
+        for (; i + 32 <= rowBytes; i += 32) {
+            const size_t key = (i / 32) % 2 * 2;
+            acc0 = Accumulate(acc0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i)), _mm_load_si128(secret + key));
+            acc1 = Accumulate(acc1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i + 16)), _mm_load_si128(secret + key + 1));
+        }
+        tail = HashRowTail(tail, row + i, rowBytes - i);
+        acc0 = Scramble(acc0, _mm_load_si128(secret + 2));
+        acc1 = Scramble(acc1, _mm_load_si128(secret + 3));
+    }
+
+    alignas(16) uint64_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc0);
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes + 2), acc1);
+    return MergeLanes(lanes, tail, rowBytes * rowCount);
+}
+
+static uint64_t HashRowsAvx2(const uint8_t* src, size_t srcPitch, size_t rowBytes, size_t rowCount) {
+    const __m256i* secret = reinterpret_cast<const __m256i*>(HASH_SECRET);
+    __m256i acc = _mm256_set_epi64x(PRIME64_4, PRIME64_3, PRIME64_2, PRIME64_1);
+    uint64_t tail = 0;
+
+    for (size_t y = 0; y < rowCount; ++y) {
+        const uint8_t* row = src + y * srcPitch;
+        size_t i = 0;
+        for (; i + 32 <= rowBytes; i += 32) {
+            acc = Accumulate(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i)),
+                _mm256_load_si256(secret + (i / 32) % 2));
+        }
+        tail = HashRowTail(tail, row + i, rowBytes - i);
+        acc = Scramble(acc, _mm256_load_si256(secret + 1));
+    }
+
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return MergeLanes(lanes, tail, rowBytes * rowCount);
+}
+
+static bool IsAvx2Supported() {
+    int info[4] = {};
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+
+    // The OS must save YMM state (OSXSAVE + XCR0 bits 1 and 2)
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+}
+
+struct PixelCopyKernel {
+    RowCopyFunc copyRow;
+    RowsHashFunc hashRows;
+    const char* name;
+};
+
+static const PixelCopyKernel& GetKernel() {
+    // SSE2 is baseline on x64
+    static const PixelCopyKernel kernel = IsAvx2Supported() ?
+        PixelCopyKernel{ CopyRowAvx2, HashRowsAvx2, "AVX2" } : PixelCopyKernel{ CopyRowSse2, HashRowsSse2, "SSE2" };
+    return kernel;
+}
+
+void CopyPixelRows(uint8_t* dst, size_t dstPitch, const uint8_t* src, size_t srcPitch,
+    size_t rowBytes, size_t rowCount, bool premultiplyAlpha) {
+    RowCopyFunc copyRow = GetKernel().copyRow;
+    for (size_t y = 0; y < rowCount; ++y) {
+        copyRow(dst + y * dstPitch, src + y * srcPitch, rowBytes, premultiplyAlpha);
+    }
+
+    // Non-temporal stores must be globally visible before the GPU copy is submitted
+    _mm_sfence();
+}
+
+uint64_t HashPixelRows(const uint8_t* src, size_t srcPitch, size_t rowBytes, size_t rowCount) {
+    return GetKernel().hashRows(src, srcPitch, rowBytes, rowCount);
+}
+
+const char* GetPixelCopyKernelName() {
+    return GetKernel().name;
+}
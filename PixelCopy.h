@@ -0,0 +1,20 @@
+// GameOverlay - PixelCopy.h
+// Row copy and hash kernels for writing BGRA pixels into upload memory
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Copies rowCount rows of rowBytes between buffers with different pitches in one pass.
+// Upload heaps are write-combined, so the SIMD kernels stream with non-temporal stores.
+// premultiplyAlpha scales B, G and R by A on the way (for straight-alpha sources).
+void CopyPixelRows(uint8_t* dst, size_t dstPitch, const uint8_t* src, size_t srcPitch,
+    size_t rowBytes, size_t rowCount, bool premultiplyAlpha = false);
+
+// 64-bit hash of a block of rows (xxh3-style multiply-accumulate), for finding unchanged tiles.
+// Only comparable within a process: the kernel, and with it the value, depends on the CPU.
+uint64_t HashPixelRows(const uint8_t* src, size_t srcPitch, size_t rowBytes, size_t rowCount);
+
+// Kernel selected from CPUID on first use ("AVX2", "SSE2")
+const char* GetPixelCopyKernelName();
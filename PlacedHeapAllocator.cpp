@@ -0,0 +1,299 @@
+// GameOverlay - PlacedHeapAllocator.cpp
+// Buddy sub-allocator placing resources in large ID3D12Heap pages
+
+#include "PlacedHeapAllocator.h"
+#include <string>
+#include <algorithm>
+
+// Private data slot holding a placed resource's AllocationToken
+// {6B9E1F5A-3C2D-4E8B-9A47-1D5C8F2E7B30}
+static const GUID PLACED_ALLOCATION_GUID =
+    { 0x6b9e1f5a, 0x3c2d, 0x4e8b, { 0x9a, 0x47, 0x1d, 0x5c, 0x8f, 0x2e, 0x7b, 0x30 } };
+
+// Order of the smallest power-of-two block (in MIN_BLOCK_SIZE units) holding size bytes
+static int GetBlockOrder(UINT64 size) {
+    int order = 0;
+    while ((PlacedHeapAllocator::MIN_BLOCK_SIZE << order) < size) {
+        order++;
+    }
+    return order;
+}
+
+// Attached to each placed resource; D3D12 releases private data when the resource is destroyed
+class PlacedHeapAllocator::AllocationToken : public IUnknown {
+public:
+    AllocationToken(std::shared_ptr<Pool> pool, int pageIndex, UINT64 offset, int order, UINT64 size)
+        : m_pool(std::move(pool)), m_pageIndex(pageIndex), m_offset(offset), m_order(order), m_size(size) {}
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override {
+        if (!object) return E_POINTER;
+        if (riid == __uuidof(IUnknown)) {
+            *object = static_cast<IUnknown*>(this);
+            AddRef();
+            return S_OK;
+        }
+        *object = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    ULONG STDMETHODCALLTYPE AddRef() override {
+        return ++m_refCount;
+    }
+
+    ULONG STDMETHODCALLTYPE Release() override {
+        ULONG refCount = --m_refCount;
+        if (refCount == 0) {
+            m_pool->Free(m_pageIndex, m_offset, m_order, m_size);
+            delete this;
+        }
+        return refCount;
+    }
+
+private:
+    std::atomic<ULONG> m_refCount = 1;
+    std::shared_ptr<Pool> m_pool;
+    int m_pageIndex = 0;
+    UINT64 m_offset = 0;
+    int m_order = 0;
+    UINT64 m_size = 0;
+};
+
+PlacedHeapAllocator::PlacedHeapAllocator(ID3D12Device* device, UINT64 pageSize)
+    : m_device(device), m_pageSize(pageSize) {
+    static const D3D12_HEAP_TYPE heapTypes[HEAP_TYPE_COUNT] = {
+        D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_TYPE_UPLOAD, D3D12_HEAP_TYPE_READBACK
+    };
+    static const D3D12_HEAP_FLAGS classFlags[static_cast<int>(ResourceClass::Count)] = {
+        D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS,
+        D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES,
+        D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES
+    };
+
+    for (int t = 0; t < HEAP_TYPE_COUNT; t++) {
+        for (int c = 0; c < static_cast<int>(ResourceClass::Count); c++) {
+            auto pool = std::make_shared<Pool>();
+            pool->device = device;
+            pool->heapType = heapTypes[t];
+            pool->heapFlags = classFlags[c];
+            pool->pageSize = m_pageSize;
+            pool->maxOrder = GetBlockOrder(m_pageSize);
+            m_pools[t][c] = std::move(pool);
+        }
+    }
+}
+
+PlacedHeapAllocator::~PlacedHeapAllocator() {
+    // Pools stay alive through the tokens of any resources still placed in them
+}
+
+int PlacedHeapAllocator::GetHeapTypeIndex(D3D12_HEAP_TYPE heapType) {
+    switch (heapType) {
+    case D3D12_HEAP_TYPE_DEFAULT: return 0;
+    case D3D12_HEAP_TYPE_UPLOAD: return 1;
+    case D3D12_HEAP_TYPE_READBACK: return 2;
+    default: return -1;
+    }
+}
+
+PlacedHeapAllocator::ResourceClass PlacedHeapAllocator::GetResourceClass(const D3D12_RESOURCE_DESC& desc) {
+    if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER) return ResourceClass::Buffer;
+    if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) {
+        return ResourceClass::RenderTargetTexture;
+    }
+    return ResourceClass::Texture;
+}
+
+ComPtr<ID3D12Resource> PlacedHeapAllocator::CreateResource(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc,
+    D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* optimizedClearValue, UINT64* allocationSize) {
+    int heapTypeIndex = GetHeapTypeIndex(heapType);
+    ResourceClass resourceClass = GetResourceClass(desc);
+    if (heapTypeIndex < 0) return nullptr;
+    // CPU-visible heaps only hold buffers here
+    if (heapType != D3D12_HEAP_TYPE_DEFAULT && resourceClass != ResourceClass::Buffer) return nullptr;
+
+    // Small textures can be placed at 4 KB instead of 64 KB if the device agrees
+    D3D12_RESOURCE_DESC placedDesc = desc;
+    D3D12_RESOURCE_ALLOCATION_INFO allocInfo = {};
+    if (resourceClass == ResourceClass::Texture && desc.SampleDesc.Count <= 1) {
+        placedDesc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+        allocInfo = m_device->GetResourceAllocationInfo(0, 1, &placedDesc);
+        if (allocInfo.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT) {
+            placedDesc.Alignment = 0;
+            allocInfo = m_device->GetResourceAllocationInfo(0, 1, &placedDesc);
+        }
+    }
+    else {
+        placedDesc.Alignment = 0;
+        allocInfo = m_device->GetResourceAllocationInfo(0, 1, &placedDesc);
+    }
+    if (allocInfo.SizeInBytes == UINT64_MAX) return nullptr; // Invalid description
+
+    // Large resources (full-screen targets, browser textures) stay committed
+    UINT64 blockSize = (std::max)(allocInfo.SizeInBytes, allocInfo.Alignment);
+    if (blockSize > m_pageSize / 2) return nullptr;
+
+    std::shared_ptr<Pool>& pool = m_pools[heapTypeIndex][static_cast<int>(resourceClass)];
+    int pageIndex = 0;
+    UINT64 offset = 0;
+    int order = 0;
+    if (!pool->Allocate(blockSize, pageIndex, offset, order)) return nullptr;
+
+    ComPtr<ID3D12Resource> resource;
+    HRESULT hr;
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        hr = m_device->CreatePlacedResource(pool->pages[pageIndex]->heap.Get(), offset, &placedDesc,
+            initialState, optimizedClearValue, IID_PPV_ARGS(&resource));
+    }
+    if (FAILED(hr)) {
+        OutputDebugStringA(("Warning: CreatePlacedResource failed, HRESULT: " + std::to_string(hr) + "\n").c_str());
+        pool->Free(pageIndex, offset, order, 0);
+        return nullptr;
+    }
+
+    // The resource owns the token from here on
+    pool->usedBytes += allocInfo.SizeInBytes;
+    AllocationToken* token = new AllocationToken(pool, pageIndex, offset, order, allocInfo.SizeInBytes);
+    hr = resource->SetPrivateDataInterface(PLACED_ALLOCATION_GUID, token);
+    token->Release();
+    if (FAILED(hr)) {
+        // The token is gone and took the block with it; don't leave a resource in freed memory
+        return nullptr;
+    }
+    if (allocationSize) *allocationSize = allocInfo.SizeInBytes;
+    return resource;
+}
+
+PlacedHeapAllocator::Stats PlacedHeapAllocator::GetStats() const {
+    Stats stats;
+    for (int t = 0; t < HEAP_TYPE_COUNT; t++) {
+        for (int c = 0; c < static_cast<int>(ResourceClass::Count); c++) {
+            Pool& pool = *m_pools[t][c];
+            stats.heapBytes += pool.heapBytes;
+            stats.usedBytes += pool.usedBytes;
+            stats.allocationCount += pool.allocationCount;
+            stats.heapCount += static_cast<UINT>(pool.heapBytes / pool.pageSize);
+
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            for (const auto& page : pool.pages) {
+                if (!page->heap) continue; // Released page slot
+                for (int order = 0; order <= pool.maxOrder; order++) {
+                    if (page->freeBlocks[order].empty()) continue;
+                    stats.freeBlockCount += static_cast<UINT>(page->freeBlocks[order].size());
+                    stats.largestFreeBlock = std::max(stats.largestFreeBlock, MIN_BLOCK_SIZE << order);
+                }
+            }
+        }
+    }
+    return stats;
+}
+
+// --- Pool ---
+
+bool PlacedHeapAllocator::Pool::Allocate(UINT64 size, int& pageIndex, UINT64& offset, int& order) {
+    int needOrder = GetBlockOrder(size);
+    if (needOrder > maxOrder) return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Smallest free block that fits, in any live page
+    int foundPage = -1;
+    int foundOrder = -1;
+    for (size_t p = 0; p < pages.size() && foundOrder != needOrder; p++) {
+        if (!pages[p]->heap) continue;
+        for (int o = needOrder; o <= maxOrder; o++) {
+            if (pages[p]->freeBlocks[o].empty()) continue;
+            if (foundOrder < 0 || o < foundOrder) {
+                foundPage = static_cast<int>(p);
+                foundOrder = o;
+            }
+            break;
+        }
+    }
+
+    // No room: add a page (reusing a released slot so token page indices stay valid)
+    if (foundPage < 0) {
+        D3D12_HEAP_DESC heapDesc = {};
+        heapDesc.SizeInBytes = pageSize;
+        heapDesc.Properties.Type = heapType;
+        heapDesc.Properties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+        heapDesc.Properties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+        heapDesc.Properties.CreationNodeMask = 1;
+        heapDesc.Properties.VisibleNodeMask = 1;
+        heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        heapDesc.Flags = heapFlags;
+
+        ComPtr<ID3D12Heap> heap;
+        if (FAILED(device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap)))) {
+            OutputDebugStringA("Warning: Failed to create placed resource heap page.\n");
+            return false;
+        }
+        heap->SetName(L"ResourceManager Placed Heap Page");
+
+        for (size_t p = 0; p < pages.size(); p++) {
+            if (!pages[p]->heap) {
+                foundPage = static_cast<int>(p);
+                break;
+            }
+        }
+        if (foundPage < 0) {
+            foundPage = static_cast<int>(pages.size());
+            pages.push_back(std::make_unique<Page>());
+        }
+        Page& page = *pages[foundPage];
+        page.heap = std::move(heap);
+        page.freeBlocks.assign(maxOrder + 1, {});
+        page.freeBlocks[maxOrder].insert(0);
+        page.allocationCount = 0;
+        foundOrder = maxOrder;
+        heapBytes += pageSize;
+    }
+
+    // Split down to the requested order, freeing the upper halves
+    Page& page = *pages[foundPage];
+    auto blockIt = page.freeBlocks[foundOrder].begin();
+    UINT64 blockOffset = *blockIt;
+    page.freeBlocks[foundOrder].erase(blockIt);
+    for (int o = foundOrder; o > needOrder; o--) {
+        page.freeBlocks[o - 1].insert(blockOffset + (MIN_BLOCK_SIZE << (o - 1)));
+    }
+    page.allocationCount++;
+    allocationCount++;
+
+    pageIndex = foundPage;
+    offset = blockOffset;
+    order = needOrder;
+    return true;
+}
+
+void PlacedHeapAllocator::Pool::Free(int pageIndex, UINT64 offset, int order, UINT64 size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Page& page = *pages[pageIndex];
+
+    // Merge with free buddies as far up as possible
+    while (order < maxOrder) {
+        UINT64 buddy = offset ^ (MIN_BLOCK_SIZE << order);
+        auto buddyIt = page.freeBlocks[order].find(buddy);
+        if (buddyIt == page.freeBlocks[order].end()) break;
+        page.freeBlocks[order].erase(buddyIt);
+        offset = (std::min)(offset, buddy);
+        order++;
+    }
+    page.freeBlocks[order].insert(offset);
+    page.allocationCount--;
+    allocationCount--;
+    usedBytes -= size;
+
+    // Give empty pages back, keeping one so create/release cycles don't thrash heaps
+    if (page.allocationCount == 0) {
+        UINT livePages = 0;
+        for (const auto& other : pages) {
+            if (other->heap) livePages++;
+        }
+        if (livePages > 1) {
+            page.heap.Reset();
+            page.freeBlocks.clear();
+            heapBytes -= pageSize;
+        }
+    }
+}
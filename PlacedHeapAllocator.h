@@ -0,0 +1,98 @@
+// GameOverlay - PlacedHeapAllocator.h
+// Buddy sub-allocator placing resources in large ID3D12Heap pages
+
+#pragma once
+
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <unordered_set>
+
+using Microsoft::WRL::ComPtr;
+
+// Replaces one CreateCommittedResource per allocation (own implicit heap, kernel round trip,
+// 64 KB granularity) with placed resources inside shared heap pages. Each heap type (default,
+// upload, readback) and resource class (buffers, textures, render target/depth textures) gets its
+// own pages, so the allocator works on resource heap tier 1. Small textures use 4 KB placement
+// alignment where the device allows it.
+//
+// A placed resource returns its block by itself when its last reference is released, so callers
+// keep treating the result like a committed resource (including RetireResource).
+class PlacedHeapAllocator {
+public:
+    static constexpr UINT64 DEFAULT_PAGE_SIZE = 16ull * 1024 * 1024;
+    static constexpr UINT64 MIN_BLOCK_SIZE = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT; // 4 KB
+
+    enum class ResourceClass {
+        Buffer,
+        Texture,
+        RenderTargetTexture, // Render target or depth stencil
+        Count
+    };
+
+    struct Stats {
+        UINT64 heapBytes = 0;   // Committed as heap pages
+        UINT64 usedBytes = 0;   // Allocation sizes of live placed resources
+        UINT heapCount = 0;
+        UINT allocationCount = 0;
+        UINT64 largestFreeBlock = 0; // Largest placement that fits without a new page
+        UINT freeBlockCount = 0;     // Many small blocks and a small largest one: fragmented
+    };
+
+    PlacedHeapAllocator(ID3D12Device* device, UINT64 pageSize = DEFAULT_PAGE_SIZE);
+    ~PlacedHeapAllocator();
+
+    // Disable copy and move
+    PlacedHeapAllocator(const PlacedHeapAllocator&) = delete;
+    PlacedHeapAllocator& operator=(const PlacedHeapAllocator&) = delete;
+    PlacedHeapAllocator(PlacedHeapAllocator&&) = delete;
+    PlacedHeapAllocator& operator=(PlacedHeapAllocator&&) = delete;
+
+    // Returns nullptr when the resource should be committed instead (larger than half a page,
+    // unsupported heap type, allocation failure). allocationSize receives the placed size.
+    ComPtr<ID3D12Resource> CreateResource(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc,
+                                          D3D12_RESOURCE_STATES initialState,
+                                          const D3D12_CLEAR_VALUE* optimizedClearValue,
+                                          UINT64* allocationSize = nullptr);
+
+    Stats GetStats() const;
+
+private:
+    static constexpr int HEAP_TYPE_COUNT = 3; // Default, upload, readback
+
+    // One page: an ID3D12Heap split into power-of-two blocks
+    struct Page {
+        ComPtr<ID3D12Heap> heap;
+        std::vector<std::unordered_set<UINT64>> freeBlocks; // Free block offsets per order
+        UINT allocationCount = 0;
+    };
+
+    // Pages of one heap type and resource class; outlives the allocator while resources live
+    struct Pool {
+        ComPtr<ID3D12Device> device;
+        D3D12_HEAP_TYPE heapType = D3D12_HEAP_TYPE_DEFAULT;
+        D3D12_HEAP_FLAGS heapFlags = D3D12_HEAP_FLAG_NONE;
+        UINT64 pageSize = 0;
+        int maxOrder = 0;
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Page>> pages;
+        std::atomic<UINT64> heapBytes = 0;
+        std::atomic<UINT64> usedBytes = 0;
+        std::atomic<UINT> allocationCount = 0;
+
+        bool Allocate(UINT64 size, int& pageIndex, UINT64& offset, int& order);
+        void Free(int pageIndex, UINT64 offset, int order, UINT64 size);
+    };
+    class AllocationToken; // Frees the block when the resource is destroyed
+
+    static int GetHeapTypeIndex(D3D12_HEAP_TYPE heapType);
+    static ResourceClass GetResourceClass(const D3D12_RESOURCE_DESC& desc);
+
+    ComPtr<ID3D12Device> m_device;
+    UINT64 m_pageSize = DEFAULT_PAGE_SIZE;
+    std::shared_ptr<Pool> m_pools[HEAP_TYPE_COUNT][static_cast<int>(ResourceClass::Count)];
+};
@@ -0,0 +1,514 @@
+// GameOverlay - PolicyTrace.cpp
+// Recording of the optimizer's state evaluations, and offline replay of them under other configs
+
+#include "PolicyTrace.h"
+#include "Log.h"
+#include "FileUtil.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace {
+
+using Config = PerformanceOptimizer::Config;
+
+// The config fields the state policy and the cost model read
+template <typename T>
+struct ConfigField {
+    const char* name;
+    T Config::* member;
+};
+
+const ConfigField<float> FLOAT_FIELDS[] = {
+    { "maxActiveFrameRate", &Config::maxActiveFrameRate },
+    { "maxInactiveFrameRate", &Config::maxInactiveFrameRate },
+    { "maxBackgroundFrameRate", &Config::maxBackgroundFrameRate },
+    { "cpuThresholdPercent", &Config::cpuThresholdPercent },
+    { "memoryThresholdMB", &Config::memoryThresholdMB },
+    { "gameFrameTimeDegradationPercent", &Config::gameFrameTimeDegradationPercent },
+};
+const ConfigField<unsigned int> UINT_FIELDS[] = {
+    { "idleTimeoutMs", &Config::idleTimeoutMs },
+    { "stateDemotionDelayMs", &Config::stateDemotionDelayMs },
+    { "gameBackOffHoldMs", &Config::gameBackOffHoldMs },
+};
+const ConfigField<bool> BOOL_FIELDS[] = {
+    { "lowPowerOnBattery", &Config::lowPowerOnBattery },
+    { "lowPowerWhenPowerSaving", &Config::lowPowerWhenPowerSaving },
+    { "backOffWhenGameSlows", &Config::backOffWhenGameSlows },
+    { "reduceInactiveQuality", &Config::reduceInactiveQuality },
+    { "enableBackgroundThrottling", &Config::enableBackgroundThrottling },
+};
+
+bool SetConfigField(Config& config, const std::string& name, const std::string& value) {
+    for (const auto& field : FLOAT_FIELDS) {
+        if (name == field.name) {
+            config.*field.member = static_cast<float>(atof(value.c_str()));
+            return true;
+        }
+    }
+    for (const auto& field : UINT_FIELDS) {
+        if (name == field.name) {
+            config.*field.member = static_cast<unsigned int>(strtoul(value.c_str(), nullptr, 10));
+            return true;
+        }
+    }
+    for (const auto& field : BOOL_FIELDS) {
+        if (name == field.name) {
+            config.*field.member = value == "1" || value == "true";
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string FormatConfig(const Config& config) {
+    std::string line = "# config";
+    char value[64];
+    for (const auto& field : FLOAT_FIELDS) {
+        snprintf(value, sizeof(value), " %s=%g", field.name, config.*field.member);
+        line += value;
+    }
+    for (const auto& field : UINT_FIELDS) {
+        snprintf(value, sizeof(value), " %s=%u", field.name, config.*field.member);
+        line += value;
+    }
+    for (const auto& field : BOOL_FIELDS) {
+        snprintf(value, sizeof(value), " %s=%d", field.name, config.*field.member ? 1 : 0);
+        line += value;
+    }
+    return line + "\n";
+}
+
+// Columns in file order; every value goes through a double
+struct SampleColumn {
+    const char* name;
+    double (*get)(const PolicyTraceSample&);
+    void (*set)(PolicyTraceSample&, double);
+};
+
+const SampleColumn COLUMNS[] = {
+    { "timeMs", [](const PolicyTraceSample& s) { return s.timeMs; }, [](PolicyTraceSample& s, double v) { s.timeMs = v; } },
+    { "state", [](const PolicyTraceSample& s) { return static_cast<double>(s.state); },
+        [](PolicyTraceSample& s, double v) { s.state = static_cast<PerformanceState>(std::clamp(static_cast<int>(v), 0, 3)); } },
+    { "hasWindow", [](const PolicyTraceSample& s) { return s.inputs.hasWindow ? 1.0 : 0.0; },
+        [](PolicyTraceSample& s, double v) { s.inputs.hasWindow = v != 0.0; } },
+    { "visible", [](const PolicyTraceSample& s) { return s.inputs.visible ? 1.0 : 0.0; },
+        [](PolicyTraceSample& s, double v) { s.inputs.visible = v != 0.0; } },
+    { "focused", [](const PolicyTraceSample& s) { return s.inputs.focused ? 1.0 : 0.0; },
+        [](PolicyTraceSample& s, double v) { s.inputs.focused = v != 0.0; } },
+    { "idleMs", [](const PolicyTraceSample& s) { return static_cast<double>(s.idleMs); },
+        [](PolicyTraceSample& s, double v) { s.idleMs = static_cast<DWORD>(v); } },
+    { "hasMonitor", [](const PolicyTraceSample& s) { return s.inputs.hasMonitor ? 1.0 : 0.0; },
+        [](PolicyTraceSample& s, double v) { s.inputs.hasMonitor = v != 0.0; } },
+    { "cpuPercent", [](const PolicyTraceSample& s) { return static_cast<double>(s.inputs.cpuPercent); },
+        [](PolicyTraceSample& s, double v) { s.inputs.cpuPercent = static_cast<float>(v); } },
+    { "memoryMB", [](const PolicyTraceSample& s) { return static_cast<double>(s.inputs.memoryMB); },
+        [](PolicyTraceSample& s, double v) { s.inputs.memoryMB = static_cast<float>(v); } },
+    { "gameValid", [](const PolicyTraceSample& s) { return s.inputs.gameValid ? 1.0 : 0.0; },
+        [](PolicyTraceSample& s, double v) { s.inputs.gameValid = v != 0.0; } },
+    { "gameFrameMs", [](const PolicyTraceSample& s) { return static_cast<double>(s.inputs.gameFrameMs); },
+        [](PolicyTraceSample& s, double v) { s.inputs.gameFrameMs = static_cast<float>(v); } },
+    { "gameBaselineFrameMs", [](const PolicyTraceSample& s) { return static_cast<double>(s.inputs.gameBaselineFrameMs); },
+        [](PolicyTraceSample& s, double v) { s.inputs.gameBaselineFrameMs = static_cast<float>(v); } },
+    { "onBattery", [](const PolicyTraceSample& s) { return s.inputs.onBattery ? 1.0 : 0.0; },
+        [](PolicyTraceSample& s, double v) { s.inputs.onBattery = v != 0.0; } },
+    { "powerSaving", [](const PolicyTraceSample& s) { return s.inputs.powerSaving ? 1.0 : 0.0; },
+        [](PolicyTraceSample& s, double v) { s.inputs.powerSaving = v != 0.0; } },
+    { "framesPerSecond", [](const PolicyTraceSample& s) { return static_cast<double>(s.overlayFramesPerSecond); },
+        [](PolicyTraceSample& s, double v) { s.overlayFramesPerSecond = static_cast<float>(v); } },
+    { "frameP50Ms", [](const PolicyTraceSample& s) { return static_cast<double>(s.frameP50Ms); },
+        [](PolicyTraceSample& s, double v) { s.frameP50Ms = static_cast<float>(v); } },
+    { "frameP99Ms", [](const PolicyTraceSample& s) { return static_cast<double>(s.frameP99Ms); },
+        [](PolicyTraceSample& s, double v) { s.frameP99Ms = static_cast<float>(v); } },
+    { "workMs", [](const PolicyTraceSample& s) { return static_cast<double>(s.workMs); },
+        [](PolicyTraceSample& s, double v) { s.workMs = static_cast<float>(v); } },
+    { "gpuFrameMs", [](const PolicyTraceSample& s) { return static_cast<double>(s.gpuFrameMs); },
+        [](PolicyTraceSample& s, double v) { s.gpuFrameMs = static_cast<float>(v); } },
+    { "componentCostMs", [](const PolicyTraceSample& s) { return static_cast<double>(s.componentCostMs); },
+        [](PolicyTraceSample& s, double v) { s.componentCostMs = static_cast<float>(v); } },
+};
+
+// GPU passes follow the fixed columns as gpu.<pass>Ms
+std::string GetGpuPassColumnName(size_t pass) {
+    return std::string("gpu.") + GetGpuPassName(static_cast<GpuPass>(pass)) + "Ms";
+}
+
+const char* const STATE_NAMES[4] = { "active", "inactive", "background", "lowPower" };
+
+std::string EscapeJson(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+} // namespace
+
+// --- PolicyTraceRecorder ---
+
+PolicyTraceRecorder::~PolicyTraceRecorder() {
+    Stop();
+}
+
+bool PolicyTraceRecorder::Start(const std::string& path, const PerformanceOptimizer::Config& config) {
+    if (m_file || path.empty()) return false;
+    m_file = fopen(path.c_str(), "wb");
+    if (!m_file) return false;
+    m_startTime = std::chrono::steady_clock::now();
+
+    m_buffer = FormatConfig(config);
+    for (size_t i = 0; i < std::size(COLUMNS); i++) {
+        if (i > 0) m_buffer += ',';
+        m_buffer += COLUMNS[i].name;
+    }
+    for (size_t pass = 0; pass < static_cast<size_t>(GpuPass::Count); pass++) {
+        m_buffer += ',' + GetGpuPassColumnName(pass);
+    }
+    m_buffer += '\n';
+    return true;
+}
+
+void PolicyTraceRecorder::Stop() {
+    if (!m_file) return;
+    m_writeJobs.Wait();
+    fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+    fclose(m_file);
+    m_file = nullptr;
+    m_buffer.clear();
+    m_writing.clear();
+}
+
+void PolicyTraceRecorder::Record(const PolicyTraceSample& sample) {
+    if (!m_file) return;
+    const double timeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count();
+
+    PolicyTraceSample stamped = sample;
+    stamped.timeMs = timeMs;
+    char value[32];
+    for (size_t i = 0; i < std::size(COLUMNS); i++) {
+        snprintf(value, sizeof(value), i > 0 ? ",%g" : "%.1f", COLUMNS[i].get(stamped));
+        m_buffer += value;
+    }
+    for (float passMs : sample.gpuPassMs) {
+        snprintf(value, sizeof(value), ",%g", passMs);
+        m_buffer += value;
+    }
+    m_buffer += '\n';
+
+    // A write still running leaves the rows buffered for the next one
+    if (m_buffer.size() >= WRITE_CHUNK_BYTES && m_writeJobs.IsDone()) {
+        SubmitWrite();
+    }
+}
+
+void PolicyTraceRecorder::SubmitWrite() {
+    m_writing.swap(m_buffer);
+    m_buffer.clear();
+
+    JobDesc job;
+    job.name = "Write Policy Trace";
+    job.priority = JobPriority::Low;
+    job.jobClass = JobClass::Efficiency;
+    job.counter = &m_writeJobs;
+    JobSystem::Get().Submit(job, [this]() {
+        fwrite(m_writing.data(), 1, m_writing.size(), m_file);
+        fflush(m_file);
+    });
+}
+
+std::string PolicyTraceRecorder::MakeRecordingPath() {
+    std::string directory = GetAppDataDirectory();
+    if (directory.empty()) {
+        return std::string();
+    }
+    directory += "\\Telemetry";
+    CreateDirectoryA(directory.c_str(), nullptr);
+
+    SYSTEMTIME time;
+    GetLocalTime(&time);
+    char name[64];
+    snprintf(name, sizeof(name), "\\policy-%04u%02u%02u-%02u%02u%02u.csv", time.wYear, time.wMonth, time.wDay,
+        time.wHour, time.wMinute, time.wSecond);
+    return directory + name;
+}
+
+// --- PolicySimulator ---
+
+bool PolicySimulator::Load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) return false;
+    m_path = path;
+    m_samples.clear();
+    m_recordedConfig = PerformanceOptimizer::Config();
+
+    // Column index in the file -> setter (null for columns this build doesn't know)
+    std::vector<void (*)(PolicyTraceSample&, double)> setters;
+    std::vector<int> gpuPasses; // Per file column, the pass it holds or -1
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        if (line.compare(0, 9, "# config ") == 0) {
+            std::istringstream fields(line.substr(9));
+            std::string field;
+            while (fields >> field) {
+                size_t equals = field.find('=');
+                if (equals != std::string::npos) {
+                    SetConfigField(m_recordedConfig, field.substr(0, equals), field.substr(equals + 1));
+                }
+            }
+            continue;
+        }
+        if (line[0] == '#') continue;
+
+        std::istringstream cells(line);
+        std::string cell;
+        if (setters.empty()) {
+            while (std::getline(cells, cell, ',')) {
+                auto column = std::find_if(std::begin(COLUMNS), std::end(COLUMNS),
+                    [&cell](const SampleColumn& c) { return cell == c.name; });
+                setters.push_back(column != std::end(COLUMNS) ? column->set : nullptr);
+                int pass = -1;
+                for (size_t i = 0; i < static_cast<size_t>(GpuPass::Count); i++) {
+                    if (cell == GetGpuPassColumnName(i)) pass = static_cast<int>(i);
+                }
+                gpuPasses.push_back(pass);
+            }
+            continue;
+        }
+
+        PolicyTraceSample sample;
+        for (size_t column = 0; column < setters.size() && std::getline(cells, cell, ','); column++) {
+            const double value = atof(cell.c_str());
+            if (setters[column]) setters[column](sample, value);
+            else if (gpuPasses[column] >= 0) sample.gpuPassMs[gpuPasses[column]] = static_cast<float>(value);
+        }
+        m_samples.push_back(sample);
+    }
+    if (m_samples.empty()) return false;
+
+    MeasureStateCosts();
+    return true;
+}
+
+double PolicySimulator::GetSampleSeconds(size_t index) const {
+    if (index + 1 >= m_samples.size()) return 0.0;
+    return std::max(m_samples[index + 1].timeMs - m_samples[index].timeMs, 0.0) / 1000.0;
+}
+
+void PolicySimulator::MeasureStateCosts() {
+    // Time-weighted sums per recorded state, then divided out
+    struct Sums {
+        double seconds = 0.0, fps = 0.0, work = 0.0, gpu = 0.0, gameSeconds = 0.0, slowdown = 0.0;
+    };
+    Sums sums[4];
+    Sums overall;
+    for (size_t i = 0; i < m_samples.size(); i++) {
+        const PolicyTraceSample& sample = m_samples[i];
+        const double seconds = GetSampleSeconds(i);
+        for (Sums* s : { &sums[static_cast<size_t>(sample.state)], &overall }) {
+            s->seconds += seconds;
+            s->fps += sample.overlayFramesPerSecond * seconds;
+            s->work += sample.workMs * seconds;
+            s->gpu += sample.gpuFrameMs * seconds;
+            if (sample.inputs.gameValid && sample.inputs.gameBaselineFrameMs > 0.0f) {
+                s->gameSeconds += seconds;
+                s->slowdown += (sample.inputs.gameFrameMs / sample.inputs.gameBaselineFrameMs - 1.0) * 100.0 * seconds;
+            }
+        }
+    }
+
+    auto finish = [](const Sums& s, StateCost& cost) {
+        cost = StateCost();
+        cost.seconds = s.seconds;
+        cost.gameSeconds = s.gameSeconds;
+        if (s.seconds > 0.0) {
+            cost.framesPerSecond = static_cast<float>(s.fps / s.seconds);
+            cost.workMs = static_cast<float>(s.work / s.seconds);
+            cost.gpuMs = static_cast<float>(s.gpu / s.seconds);
+        }
+        if (s.gameSeconds > 0.0) cost.gameSlowdownPercent = static_cast<float>(s.slowdown / s.gameSeconds);
+    };
+    finish(overall, m_overallCost);
+    for (size_t state = 0; state < 4; state++) {
+        finish(sums[state], m_stateCosts[state]);
+        if (m_stateCosts[state].seconds <= 0.0) {
+            m_stateCosts[state] = m_overallCost; // Never reached: whole-recording means
+            m_stateCosts[state].seconds = 0.0;
+        }
+        if (m_stateCosts[state].gameSeconds <= 0.0) {
+            m_stateCosts[state].gameSlowdownPercent = m_overallCost.gameSlowdownPercent;
+        }
+    }
+}
+
+PolicySimulator::Result PolicySimulator::Simulate(const PerformanceOptimizer::Config& config, const std::string& name) const {
+    Result result;
+    result.name = name;
+
+    // The optimizer starts Active with nothing pending, like UpdateState's first evaluation
+    const auto origin = std::chrono::steady_clock::time_point();
+    const auto demotionDelay = std::chrono::milliseconds(config.stateDemotionDelayMs);
+    PerformanceState current = PerformanceState::Active;
+    PerformanceState pending = PerformanceState::Active;
+    std::chrono::steady_clock::time_point pendingSince = origin;
+    std::chrono::steady_clock::time_point gameBackOffUntil = origin;
+
+    double totalSeconds = 0.0, agreeingSeconds = 0.0;
+    double frames = 0.0, workMs = 0.0, gpuMs = 0.0, slowdown = 0.0;
+    for (size_t i = 0; i < m_samples.size(); i++) {
+        const PolicyTraceSample& sample = m_samples[i];
+        const auto now = origin + std::chrono::microseconds(static_cast<long long>(sample.timeMs * 1000.0));
+
+        PerformanceOptimizer::StateInputs inputs = sample.inputs;
+        inputs.idle = sample.idleMs > config.idleTimeoutMs;
+        PerformanceState desired = PerformanceOptimizer::SelectState(inputs, config, now, gameBackOffUntil);
+        if (desired != pending) {
+            pending = desired;
+            pendingSince = now;
+        }
+        if (desired != current &&
+            (PerformanceOptimizer::IsImmediateTransition(current, desired) || now - pendingSince >= demotionDelay)) {
+            if (result.transitions.size() < MAX_REPORTED_TRANSITIONS) {
+                result.transitions.push_back({ sample.timeMs, current, desired });
+            }
+            result.transitionCount++;
+            current = desired;
+        }
+
+        // The interval until the next evaluation is spent in the state just decided
+        const double seconds = GetSampleSeconds(i);
+        const StateCost& cost = m_stateCosts[static_cast<size_t>(current)];
+        const float fps = std::min(cost.framesPerSecond, PerformanceOptimizer::GetStateFrameRateCap(current, config));
+        result.stateSeconds[static_cast<size_t>(current)] += seconds;
+        totalSeconds += seconds;
+        if (current == sample.state) agreeingSeconds += seconds;
+        frames += fps * seconds;
+        workMs += fps * cost.workMs * seconds;
+        gpuMs += fps * cost.gpuMs * seconds;
+
+        if (inputs.gameValid && inputs.gameBaselineFrameMs > 0.0f) {
+            result.gameSeconds += seconds;
+            slowdown += cost.gameSlowdownPercent * seconds;
+            if (inputs.gameFrameMs > inputs.gameBaselineFrameMs * (1.0f + config.gameFrameTimeDegradationPercent / 100.0f)) {
+                result.gameDegradedSeconds += seconds;
+                if (current == PerformanceState::Active || current == PerformanceState::Inactive) {
+                    result.gameContendedSeconds += seconds;
+                }
+            }
+        }
+    }
+
+    if (totalSeconds > 0.0) {
+        result.agreementPercent = static_cast<float>(agreeingSeconds / totalSeconds * 100.0);
+        result.framesPerSecond = static_cast<float>(frames / totalSeconds);
+        result.cpuWorkMsPerSecond = static_cast<float>(workMs / totalSeconds);
+        result.gpuMsPerSecond = static_cast<float>(gpuMs / totalSeconds);
+    }
+    if (result.gameSeconds > 0.0) {
+        result.gameSlowdownPercent = static_cast<float>(slowdown / result.gameSeconds);
+    }
+    return result;
+}
+
+bool PolicySimulator::ApplyOverrides(PerformanceOptimizer::Config& config, const std::string& overrides) {
+    std::istringstream fields(overrides);
+    std::string field;
+    while (std::getline(fields, field, ',')) {
+        if (field.empty()) continue;
+        size_t equals = field.find('=');
+        if (equals == std::string::npos || !SetConfigField(config, field.substr(0, equals), field.substr(equals + 1))) {
+            LOG_WARNING("Unknown policy setting: %s", field);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PolicySimulator::WriteReport(const std::string& path, const std::vector<Result>& results) const {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) return false;
+
+    char line[512];
+    const double durationSeconds = m_samples.empty() ? 0.0 : (m_samples.back().timeMs - m_samples.front().timeMs) / 1000.0;
+    snprintf(line, sizeof(line), "{\n  \"recording\": {\n    \"path\": \"%s\",\n    \"samples\": %zu,\n    \"durationSeconds\": %.1f,\n",
+        EscapeJson(m_path).c_str(), m_samples.size(), durationSeconds);
+    file << line;
+
+    // What each state cost while recording: the model every simulation is priced with
+    file << "    \"stateCosts\": {";
+    for (size_t state = 0; state < 4; state++) {
+        const StateCost& cost = m_stateCosts[state];
+        snprintf(line, sizeof(line), "%s\n      \"%s\": { \"seconds\": %.1f, \"framesPerSecond\": %.2f, \"workMs\": %.3f, "
+            "\"gpuMs\": %.3f, \"gameSeconds\": %.1f, \"gameSlowdownPercent\": %.2f }",
+            state > 0 ? "," : "", STATE_NAMES[state], cost.seconds, cost.framesPerSecond, cost.workMs, cost.gpuMs,
+            cost.gameSeconds, cost.gameSlowdownPercent);
+        file << line;
+    }
+    file << "\n    }\n  },\n";
+
+    file << "  \"simulations\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& result = results[i];
+        snprintf(line, sizeof(line), "%s\n    {\n      \"name\": \"%s\",\n      \"transitions\": %zu,\n      \"agreementPercent\": %.1f,\n",
+            i > 0 ? "," : "", EscapeJson(result.name).c_str(), result.transitionCount, result.agreementPercent);
+        file << line;
+        file << "      \"stateSeconds\": {";
+        for (size_t state = 0; state < 4; state++) {
+            snprintf(line, sizeof(line), "%s \"%s\": %.1f", state > 0 ? "," : "", STATE_NAMES[state], result.stateSeconds[state]);
+            file << line;
+        }
+        file << " },\n";
+        snprintf(line, sizeof(line), "      \"overlay\": { \"framesPerSecond\": %.2f, \"cpuWorkMsPerSecond\": %.2f, \"gpuMsPerSecond\": %.2f },\n",
+            result.framesPerSecond, result.cpuWorkMsPerSecond, result.gpuMsPerSecond);
+        file << line;
+        snprintf(line, sizeof(line), "      \"game\": { \"seconds\": %.1f, \"degradedSeconds\": %.1f, \"contendedSeconds\": %.1f, "
+            "\"slowdownPercent\": %.2f },\n",
+            result.gameSeconds, result.gameDegradedSeconds, result.gameContendedSeconds, result.gameSlowdownPercent);
+        file << line;
+        file << "      \"transitionLog\": [";
+        for (size_t t = 0; t < result.transitions.size(); t++) {
+            const Transition& transition = result.transitions[t];
+            snprintf(line, sizeof(line), "%s\n        { \"timeMs\": %.0f, \"from\": \"%s\", \"to\": \"%s\" }",
+                t > 0 ? "," : "", transition.timeMs, STATE_NAMES[static_cast<size_t>(transition.from)],
+                STATE_NAMES[static_cast<size_t>(transition.to)]);
+            file << line;
+        }
+        file << "\n      ]\n    }";
+    }
+    file << "\n  ]\n}\n";
+    return static_cast<bool>(file);
+}
+
+int PolicySimulator::Run(const std::string& recordingPath, const std::string& variants, const std::string& reportPath) {
+    PolicySimulator simulator;
+    if (!simulator.Load(recordingPath)) {
+        LOG_ERROR("No policy samples in %s", recordingPath);
+        return 1;
+    }
+
+    std::vector<Result> results;
+    results.push_back(simulator.Simulate(simulator.GetRecordedConfig(), "recorded"));
+    std::istringstream sets(variants);
+    std::string overrides;
+    while (std::getline(sets, overrides, ';')) {
+        if (overrides.empty()) continue;
+        PerformanceOptimizer::Config config = simulator.GetRecordedConfig();
+        if (!ApplyOverrides(config, overrides)) return 1;
+        results.push_back(simulator.Simulate(config, overrides));
+    }
+
+    const std::string path = reportPath.empty() ? recordingPath + ".report.json" : reportPath;
+    if (!simulator.WriteReport(path, results)) {
+        LOG_ERROR("Failed to write policy report: %s", path);
+        return 1;
+    }
+    LOG_INFO("Simulated %zu policies over %zu samples into %s", results.size(), simulator.GetSampleCount(), path);
+    return 0;
+}
@@ -0,0 +1,135 @@
+// GameOverlay - PolicyTrace.h
+// Recording of the optimizer's state evaluations, and offline replay of them under other configs
+
+#pragma once
+
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include "PerformanceOptimizer.h"
+#include "PerformanceMonitor.h"
+#include "JobSystem.h"
+
+// One state evaluation: what PerformanceOptimizer::SelectState decided from, the state in effect
+// afterwards, and what the overlay and the game cost at that moment
+struct PolicyTraceSample {
+    double timeMs = 0.0; // Since the recording started
+    PerformanceState state = PerformanceState::Active;
+    PerformanceOptimizer::StateInputs inputs;
+    DWORD idleMs = 0;    // Since the last input, so other idle timeouts can be replayed
+    float overlayFramesPerSecond = 0.0f;
+    float frameP50Ms = 0.0f; // Last second, present to present
+    float frameP99Ms = 0.0f;
+    float workMs = 0.0f;     // CPU work per frame, waits excluded
+    float gpuFrameMs = 0.0f;
+    float gpuPassMs[static_cast<size_t>(GpuPass::Count)] = {};
+    float componentCostMs = 0.0f;
+};
+
+// File layout: text. A "# config" line with the recorded policy fields as name=value, a header
+// line naming the columns, then one comma-separated row per sample. Readers look columns up by
+// name, so recordings stay readable when columns are added.
+//
+// Record runs on the main thread at each evaluation (a few a second): rows are formatted into a
+// buffer that a low priority job appends to the file once it has grown, so the main thread never
+// waits on the disk outside Stop.
+class PolicyTraceRecorder {
+public:
+    static constexpr size_t WRITE_CHUNK_BYTES = 16 * 1024;
+
+    PolicyTraceRecorder() = default;
+    ~PolicyTraceRecorder();
+
+    // Disable copy and move
+    PolicyTraceRecorder(const PolicyTraceRecorder&) = delete;
+    PolicyTraceRecorder& operator=(const PolicyTraceRecorder&) = delete;
+    PolicyTraceRecorder(PolicyTraceRecorder&&) = delete;
+    PolicyTraceRecorder& operator=(PolicyTraceRecorder&&) = delete;
+
+    bool Start(const std::string& path, const PerformanceOptimizer::Config& config);
+    void Stop(); // Writes out what is buffered, then closes the file
+    void Record(const PolicyTraceSample& sample); // timeMs is filled in here
+
+    // Recordings go to %LOCALAPPDATA%\GameOverlay\Telemetry; empty without a profile directory
+    static std::string MakeRecordingPath();
+
+private:
+    void SubmitWrite();
+
+    FILE* m_file = nullptr;
+    std::chrono::steady_clock::time_point m_startTime;
+    std::string m_buffer;  // Main thread
+    std::string m_writing; // The write job's, until m_writeJobs is done
+    JobCounter m_writeJobs;
+};
+
+// Replays a recording through SelectState and the demotion hold under any number of configs. The
+// window, input, power and threshold inputs are the recorded ones; the idle flag is recomputed
+// from idleMs. What a state costs is measured from the recording itself: the overlay's frame rate
+// and per-frame CPU and GPU time, and the game's frame time above its baseline, averaged over the
+// samples that were recorded in that state. A simulated timeline is then priced with those, the
+// frame rate capped by the simulated config. States the recording never reached fall back to the
+// means over the whole recording.
+//
+// Samples are only as fine as the evaluations (at least every THRESHOLD_CHECK_INTERVAL), so idle
+// timeouts and demotion holds resolve to that granularity.
+class PolicySimulator {
+public:
+    static constexpr size_t MAX_REPORTED_TRANSITIONS = 64;
+
+    struct Transition {
+        double timeMs = 0.0;
+        PerformanceState from = PerformanceState::Active;
+        PerformanceState to = PerformanceState::Active;
+    };
+    struct Result {
+        std::string name; // "recorded", or the overrides applied to the recorded config
+        size_t transitionCount = 0;
+        std::vector<Transition> transitions; // The first MAX_REPORTED_TRANSITIONS
+        double stateSeconds[4] = {};
+        float agreementPercent = 0.0f; // Of the time, simulated state equal to the recorded one
+        // Overlay cost over the recording, per second
+        float framesPerSecond = 0.0f;
+        float cpuWorkMsPerSecond = 0.0f;
+        float gpuMsPerSecond = 0.0f;
+        // Game impact (time with a game presenting only)
+        double gameSeconds = 0.0;
+        double gameDegradedSeconds = 0.0;   // Above its baseline by gameFrameTimeDegradationPercent
+        double gameContendedSeconds = 0.0;  // Of those, with the overlay Active or Inactive
+        float gameSlowdownPercent = 0.0f;   // Predicted mean frame time above the baseline
+    };
+
+    bool Load(const std::string& path);
+    size_t GetSampleCount() const { return m_samples.size(); }
+    const PerformanceOptimizer::Config& GetRecordedConfig() const { return m_recordedConfig; }
+
+    Result Simulate(const PerformanceOptimizer::Config& config, const std::string& name) const;
+    bool WriteReport(const std::string& path, const std::vector<Result>& results) const;
+
+    // "name=value,name=value" over the recorded policy fields; false on an unknown name
+    static bool ApplyOverrides(PerformanceOptimizer::Config& config, const std::string& overrides);
+
+    // --simulate-policy: the recorded config, then each ';'-separated override set, into a JSON
+    // report. Returns the process exit code.
+    static int Run(const std::string& recordingPath, const std::string& variants, const std::string& reportPath);
+
+private:
+    struct StateCost {
+        double seconds = 0.0;
+        float framesPerSecond = 0.0f;
+        float workMs = 0.0f;
+        float gpuMs = 0.0f;
+        double gameSeconds = 0.0;
+        float gameSlowdownPercent = 0.0f;
+    };
+    void MeasureStateCosts();
+    double GetSampleSeconds(size_t index) const; // Until the next sample
+
+    std::string m_path;
+    std::vector<PolicyTraceSample> m_samples;
+    PerformanceOptimizer::Config m_recordedConfig;
+    StateCost m_stateCosts[4];
+    StateCost m_overallCost;
+};
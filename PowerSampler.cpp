@@ -0,0 +1,207 @@
+// GameOverlay - PowerSampler.cpp
+// Background sampling of CPU package and GPU power (Energy Meter counters, NVML)
+
+#include "PowerSampler.h"
+#include <pdhmsg.h>
+#include <cwchar>
+
+namespace {
+    // Instances are named after the EMI channel, e.g. RAPL_Package0_PKG, RAPL_Package0_PP1
+    bool EndsWith(const wchar_t* name, const wchar_t* suffix) {
+        const size_t nameLength = wcslen(name);
+        const size_t suffixLength = wcslen(suffix);
+        return nameLength >= suffixLength && _wcsicmp(name + nameLength - suffixLength, suffix) == 0;
+    }
+
+    ULARGE_INTEGER ToLargeInteger(const FILETIME& time) {
+        ULARGE_INTEGER value;
+        value.LowPart = time.dwLowDateTime;
+        value.HighPart = time.dwHighDateTime;
+        return value;
+    }
+}
+
+PowerSampler::PowerSampler(std::chrono::milliseconds interval)
+    : m_interval(interval) {
+    Poll(); // Opens the counters
+}
+
+PowerSampler::~PowerSampler() {
+    m_jobs.Wait();
+    Close();
+}
+
+void PowerSampler::Poll() {
+    const auto now = std::chrono::steady_clock::now();
+    if (now < m_nextCollection || !m_jobs.IsDone()) return;
+    m_nextCollection = now + m_interval;
+
+    JobDesc job;
+    job.name = "Power Sample";
+    job.priority = JobPriority::Low;
+    job.jobClass = JobClass::Efficiency;
+    job.counter = &m_jobs;
+    JobSystem::Get().Submit(job, [this]() { CollectJob(); });
+}
+
+bool PowerSampler::GetLatestSample(PowerSample& sample) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    sample = m_latest;
+    return sample.valid;
+}
+
+uint64_t PowerSampler::GetSampleCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_sampleCount;
+}
+
+bool PowerSampler::IsAvailable() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_available;
+}
+
+bool PowerSampler::OpenEnergyMeter() {
+    if (PdhOpenQueryW(nullptr, 0, &m_query) != ERROR_SUCCESS) {
+        m_query = nullptr;
+        return false;
+    }
+    // English names, so localized systems resolve the same counters
+    if (PdhAddEnglishCounterW(m_query, L"\\Energy Meter(*)\\Power", 0, &m_powerCounter) != ERROR_SUCCESS) {
+        PdhCloseQuery(m_query);
+        m_query = nullptr;
+        m_powerCounter = nullptr;
+        return false;
+    }
+    PdhCollectQueryData(m_query); // Power is a rate; the first collection only starts it
+    return true;
+}
+
+bool PowerSampler::OpenNvml() {
+    // Only from System32, where the driver puts it: never a copy next to some other executable
+    m_nvml = LoadLibraryExW(L"nvml.dll", nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32);
+    if (!m_nvml) return false;
+
+    auto init = reinterpret_cast<NvmlInit>(GetProcAddress(m_nvml, "nvmlInit_v2"));
+    auto getCount = reinterpret_cast<NvmlDeviceGetCount>(GetProcAddress(m_nvml, "nvmlDeviceGetCount_v2"));
+    auto getHandle = reinterpret_cast<NvmlDeviceGetHandleByIndex>(GetProcAddress(m_nvml, "nvmlDeviceGetHandleByIndex_v2"));
+    m_nvmlShutdown = reinterpret_cast<NvmlShutdown>(GetProcAddress(m_nvml, "nvmlShutdown"));
+    m_nvmlGetPowerUsage = reinterpret_cast<NvmlDeviceGetPowerUsage>(GetProcAddress(m_nvml, "nvmlDeviceGetPowerUsage"));
+    if (!init || !getCount || !getHandle || !m_nvmlShutdown || !m_nvmlGetPowerUsage || init() != 0) {
+        FreeLibrary(m_nvml);
+        m_nvml = nullptr;
+        return false;
+    }
+
+    unsigned int count = 0;
+    getCount(&count);
+    for (unsigned int i = 0; i < count; i++) {
+        NvmlDevice* device = nullptr;
+        unsigned int milliwatts = 0;
+        // Boards without a power sensor fail here and stay out
+        if (getHandle(i, &device) == 0 && m_nvmlGetPowerUsage(device, &milliwatts) == 0) {
+            m_nvmlDevices.push_back(device);
+        }
+    }
+    return !m_nvmlDevices.empty();
+}
+
+void PowerSampler::Close() {
+    if (m_query) {
+        PdhCloseQuery(m_query); // Frees the counter too
+    }
+    m_query = nullptr;
+    m_powerCounter = nullptr;
+    if (m_nvml) {
+        m_nvmlShutdown();
+        FreeLibrary(m_nvml);
+    }
+    m_nvml = nullptr;
+    m_nvmlDevices.clear();
+}
+
+void PowerSampler::CollectJob() {
+    if (!m_opened) {
+        m_opened = true;
+        const bool energyMeter = OpenEnergyMeter();
+        const bool nvml = OpenNvml();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_available = energyMeter || nvml;
+        }
+        if (!energyMeter && !nvml) {
+            OutputDebugStringA("Warning: no Energy Meter counters or NVML, power is not measured.\n");
+            return;
+        }
+
+        FILETIME idleTime, kernelTime, userTime;
+        if (GetSystemTimes(&idleTime, &kernelTime, &userTime)) {
+            m_lastIdleTime = ToLargeInteger(idleTime);
+            m_lastSystemTime.QuadPart = ToLargeInteger(kernelTime).QuadPart + ToLargeInteger(userTime).QuadPart;
+        }
+        m_lastSystemSample = std::chrono::steady_clock::now();
+        return;
+    }
+    if (!m_query && m_nvmlDevices.empty()) return; // Nothing to read
+
+    PowerSample sample;
+    Collect(sample);
+    if (sample.valid) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_latest = sample;
+        m_sampleCount++;
+    }
+}
+
+void PowerSampler::Collect(PowerSample& sample) {
+    if (m_query && PdhCollectQueryData(m_query) == ERROR_SUCCESS) {
+        DWORD size = 0;
+        DWORD count = 0;
+        if (PdhGetFormattedCounterArrayW(m_powerCounter, PDH_FMT_DOUBLE, &size, &count, nullptr) == PDH_MORE_DATA) {
+            m_itemBuffer.resize(size);
+            auto* items = reinterpret_cast<PDH_FMT_COUNTERVALUE_ITEM_W*>(m_itemBuffer.data());
+            if (PdhGetFormattedCounterArrayW(m_powerCounter, PDH_FMT_DOUBLE, &size, &count, items) == ERROR_SUCCESS) {
+                for (DWORD i = 0; i < count; i++) {
+                    if (items[i].FmtValue.CStatus != PDH_CSTATUS_VALID_DATA &&
+                        items[i].FmtValue.CStatus != PDH_CSTATUS_NEW_DATA) continue;
+                    const float watts = static_cast<float>(items[i].FmtValue.doubleValue / 1000.0); // Milliwatts
+                    if (EndsWith(items[i].szName, L"_PKG")) {
+                        sample.packageWatts += watts;
+                        sample.packageMeasured = true;
+                    }
+                    else if (EndsWith(items[i].szName, L"_PP1")) {
+                        sample.integratedGpuWatts += watts;
+                        sample.integratedGpuMeasured = true;
+                    }
+                }
+            }
+        }
+    }
+
+    for (NvmlDevice* device : m_nvmlDevices) {
+        unsigned int milliwatts = 0;
+        if (m_nvmlGetPowerUsage(device, &milliwatts) == 0) {
+            sample.discreteGpuWatts += milliwatts / 1000.0f;
+            sample.discreteGpuMeasured = true;
+        }
+    }
+
+    // Busy cores over the same interval, to attribute the package by CPU time
+    FILETIME idleTime, kernelTime, userTime;
+    if (GetSystemTimes(&idleTime, &kernelTime, &userTime)) {
+        const ULARGE_INTEGER idle = ToLargeInteger(idleTime);
+        ULARGE_INTEGER system;
+        system.QuadPart = ToLargeInteger(kernelTime).QuadPart + ToLargeInteger(userTime).QuadPart;
+        const UINT64 total = system.QuadPart - m_lastSystemTime.QuadPart;
+        const UINT64 idled = idle.QuadPart - m_lastIdleTime.QuadPart;
+        const auto now = std::chrono::steady_clock::now();
+        const double seconds = std::chrono::duration<double>(now - m_lastSystemSample).count();
+        if (seconds > 0.0) {
+            sample.systemBusyCores = static_cast<float>((total > idled ? total - idled : 0) / 1e7 / seconds);
+        }
+        m_lastIdleTime = idle;
+        m_lastSystemTime = system;
+        m_lastSystemSample = now;
+    }
+
+    sample.valid = sample.packageMeasured || sample.integratedGpuMeasured || sample.discreteGpuMeasured;
+}
@@ -0,0 +1,90 @@
+// GameOverlay - PowerSampler.h
+// Background sampling of CPU package and GPU power (Energy Meter counters, NVML)
+
+#pragma once
+
+#include <Windows.h>
+#include <pdh.h>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include "JobSystem.h"
+
+// Whole-machine power, not the overlay's: PerformanceMonitor attributes a share of it
+struct PowerSample {
+    bool valid = false;
+    bool packageMeasured = false;       // Energy Meter RAPL package domains
+    bool integratedGpuMeasured = false; // RAPL PP1, the graphics part of the package (Intel)
+    bool discreteGpuMeasured = false;   // NVML board power
+    float packageWatts = 0.0f;          // Every CPU package, integrated graphics included
+    float integratedGpuWatts = 0.0f;
+    float discreteGpuWatts = 0.0f;      // Every NVIDIA GPU
+    float systemBusyCores = 0.0f;       // Cores' worth of CPU time every process used (GetSystemTimes)
+};
+
+// "Energy Meter" is the Windows 10+ counter set over the platform's EMI devices (RAPL on Intel
+// and AMD CPUs; few desktops expose more than the package). NVIDIA's board power comes from
+// nvml.dll, which the driver installs; other vendors' GPUs only show through RAPL PP1 when
+// integrated. Both are read by a JobSystem job (Efficiency class) that Poll submits once per
+// interval, so nothing is sampled while nobody polls; the first one opens the counters.
+class PowerSampler {
+public:
+    static constexpr std::chrono::milliseconds DEFAULT_INTERVAL{ 1000 };
+
+    PowerSampler(std::chrono::milliseconds interval = DEFAULT_INTERVAL);
+    ~PowerSampler();
+
+    // Disable copy and move
+    PowerSampler(const PowerSampler&) = delete;
+    PowerSampler& operator=(const PowerSampler&) = delete;
+    PowerSampler(PowerSampler&&) = delete;
+    PowerSampler& operator=(PowerSampler&&) = delete;
+
+    // Owner's thread, regularly (each frame will do): submits the next collection once it is due
+    // and the last one has finished
+    void Poll();
+
+    // False until the second collection, or with no power source at all
+    bool GetLatestSample(PowerSample& sample) const;
+    uint64_t GetSampleCount() const; // Valid samples so far; a new one replaced GetLatestSample's
+    bool IsAvailable() const;
+
+private:
+    // nvml.h, the few entry points used (all return nvmlReturn_t, 0 on success)
+    struct NvmlDevice;
+    using NvmlInit = int(__cdecl*)();
+    using NvmlShutdown = int(__cdecl*)();
+    using NvmlDeviceGetCount = int(__cdecl*)(unsigned int*);
+    using NvmlDeviceGetHandleByIndex = int(__cdecl*)(unsigned int, NvmlDevice**);
+    using NvmlDeviceGetPowerUsage = int(__cdecl*)(NvmlDevice*, unsigned int*); // Milliwatts
+
+    void CollectJob();
+    bool OpenEnergyMeter();
+    bool OpenNvml();
+    void Close();
+    void Collect(PowerSample& sample);
+
+    std::chrono::milliseconds m_interval;
+    std::chrono::steady_clock::time_point m_nextCollection; // Owner's thread
+    JobCounter m_jobs; // At most one collection in flight
+
+    // Collection job only, one at a time (then the destructor)
+    bool m_opened = false;
+    PDH_HQUERY m_query = nullptr;
+    PDH_HCOUNTER m_powerCounter = nullptr;
+    std::vector<uint8_t> m_itemBuffer;
+    HMODULE m_nvml = nullptr;
+    NvmlShutdown m_nvmlShutdown = nullptr;
+    NvmlDeviceGetPowerUsage m_nvmlGetPowerUsage = nullptr;
+    std::vector<NvmlDevice*> m_nvmlDevices;
+    ULARGE_INTEGER m_lastIdleTime = {};
+    ULARGE_INTEGER m_lastSystemTime = {}; // Kernel (idle included) plus user, all cores
+    std::chrono::steady_clock::time_point m_lastSystemSample;
+
+    // m_mutex guards the sample
+    mutable std::mutex m_mutex;
+    PowerSample m_latest;
+    uint64_t m_sampleCount = 0;
+    bool m_available = false;
+};
@@ -0,0 +1,240 @@
+// GameOverlay - PresentEventSampler.cpp
+// Frame rate of the foreground game from DXGI present events (ETW), without hooking the game
+
+#include "PresentEventSampler.h"
+#include "ThreadPolicy.h"
+#include "ThreadCycles.h"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+#pragma comment(lib, "advapi32.lib")
+
+namespace {
+    const wchar_t SESSION_NAME[] = L"GameOverlayPresentEvents";
+
+    // Microsoft-Windows-DXGI
+    const GUID DXGI_PROVIDER = { 0xCA11C036, 0x0102, 0x4A2D, { 0xA6, 0xAD, 0xF0, 0x3C, 0xFE, 0xD5, 0xD3, 0xC9 } };
+    constexpr USHORT DXGI_PRESENT_START = 42;
+
+    constexpr int64_t FOREGROUND_CHECK_MS = 250;
+    constexpr float MAX_FRAME_MS = 1000.0f; // Longer gaps are pauses (loading, alt-tab), not frames
+}
+
+PresentEventSampler::PresentEventSampler() {
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    m_qpcFrequency = frequency.QuadPart;
+    m_ownProcessId = GetCurrentProcessId();
+    m_baselineSeconds.reserve(BASELINE_SECONDS);
+
+    if (!StartSession()) return;
+    m_available = true;
+    m_worker = std::thread(&PresentEventSampler::WorkerThread, this);
+}
+
+PresentEventSampler::~PresentEventSampler() {
+    StopSession(); // ProcessTrace returns once the session is gone
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+    if (m_traceHandle != INVALID_PROCESSTRACE_HANDLE) {
+        CloseTrace(m_traceHandle);
+    }
+}
+
+bool PresentEventSampler::GetLatestSample(GamePresentSample& sample) const {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    sample = m_latest;
+    if (sample.valid && (now.QuadPart - m_latestTime) * 1000 / m_qpcFrequency > STALE_AFTER_MS) {
+        sample.valid = false; // Game stopped presenting or lost focus to something that doesn't
+    }
+    return sample.valid;
+}
+
+bool PresentEventSampler::GetPresentPhase(GamePresentPhase& phase) const {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    phase.lastPresentQpc = m_phasePresentQpc.load(std::memory_order_acquire);
+    phase.intervalMs = m_phaseIntervalMs.load(std::memory_order_relaxed);
+    phase.valid = phase.lastPresentQpc != 0 && phase.intervalMs > 0.0 &&
+        (now.QuadPart - phase.lastPresentQpc) * 1000 / m_qpcFrequency <= STALE_AFTER_MS;
+    return phase.valid;
+}
+
+bool PresentEventSampler::StartSession() {
+    m_properties.assign(sizeof(EVENT_TRACE_PROPERTIES) + sizeof(SESSION_NAME), 0);
+    auto* properties = reinterpret_cast<EVENT_TRACE_PROPERTIES*>(m_properties.data());
+    auto resetProperties = [&]() {
+        std::fill(m_properties.begin(), m_properties.end(), static_cast<uint8_t>(0));
+        properties->Wnode.BufferSize = static_cast<ULONG>(m_properties.size());
+        properties->Wnode.Flags = WNODE_FLAG_TRACED_GUID;
+        properties->Wnode.ClientContext = 1; // QPC timestamps
+        properties->LogFileMode = EVENT_TRACE_REAL_TIME_MODE;
+        properties->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+    };
+
+    resetProperties();
+    ULONG status = StartTraceW(&m_sessionHandle, SESSION_NAME, properties);
+    if (status == ERROR_ALREADY_EXISTS) {
+        // Left behind by an instance that didn't shut down; sessions outlive their process
+        ControlTraceW(0, SESSION_NAME, properties, EVENT_TRACE_CONTROL_STOP);
+        resetProperties();
+        status = StartTraceW(&m_sessionHandle, SESSION_NAME, properties);
+    }
+    if (status != ERROR_SUCCESS) {
+        OutputDebugStringA(status == ERROR_ACCESS_DENIED ?
+            "Warning: No permission for an ETW session, game frame rate unavailable.\n" :
+            "Warning: Failed to start the present event session.\n");
+        m_sessionHandle = 0;
+        return false;
+    }
+
+    status = EnableTraceEx2(m_sessionHandle, &DXGI_PROVIDER, EVENT_CONTROL_CODE_ENABLE_PROVIDER,
+        TRACE_LEVEL_INFORMATION, 0, 0, 0, nullptr);
+    if (status != ERROR_SUCCESS) {
+        OutputDebugStringA("Warning: Failed to enable the DXGI event provider.\n");
+        StopSession();
+        return false;
+    }
+
+    EVENT_TRACE_LOGFILEW logFile = {};
+    logFile.LoggerName = const_cast<LPWSTR>(SESSION_NAME);
+    logFile.ProcessTraceMode = PROCESS_TRACE_MODE_REAL_TIME | PROCESS_TRACE_MODE_EVENT_RECORD | PROCESS_TRACE_MODE_RAW_TIMESTAMP;
+    logFile.EventRecordCallback = &PresentEventSampler::OnEventRecord;
+    logFile.Context = this;
+    m_traceHandle = OpenTraceW(&logFile);
+    if (m_traceHandle == INVALID_PROCESSTRACE_HANDLE) {
+        OutputDebugStringA("Warning: Failed to open the present event session.\n");
+        StopSession();
+        return false;
+    }
+    return true;
+}
+
+void PresentEventSampler::StopSession() {
+    if (!m_sessionHandle) return;
+    auto* properties = reinterpret_cast<EVENT_TRACE_PROPERTIES*>(m_properties.data());
+    EnableTraceEx2(m_sessionHandle, &DXGI_PROVIDER, EVENT_CONTROL_CODE_DISABLE_PROVIDER, 0, 0, 0, 0, nullptr);
+    ControlTraceW(m_sessionHandle, nullptr, properties, EVENT_TRACE_CONTROL_STOP);
+    m_sessionHandle = 0;
+}
+
+void PresentEventSampler::WorkerThread() {
+    // Event delivery is buffered by ETW; nothing here is latency sensitive
+    ConfigureWorkerThread();
+    ThreadCycles::RegisterThread(ThreadSubsystem::Telemetry);
+    ULONG status = ProcessTrace(&m_traceHandle, 1, nullptr, nullptr);
+    if (status != ERROR_SUCCESS && status != ERROR_CANCELLED) {
+        OutputDebugStringA("Warning: Present event processing stopped.\n");
+    }
+    m_available = false;
+}
+
+void WINAPI PresentEventSampler::OnEventRecord(PEVENT_RECORD record) {
+    const EVENT_HEADER& header = record->EventHeader;
+    if (header.EventDescriptor.Id != DXGI_PRESENT_START || !IsEqualGUID(header.ProviderId, DXGI_PROVIDER)) return;
+    auto* sampler = static_cast<PresentEventSampler*>(record->UserContext);
+    sampler->OnPresent(header.ProcessId, header.TimeStamp.QuadPart);
+}
+
+void PresentEventSampler::OnPresent(DWORD processId, int64_t timestamp) {
+    if (timestamp - m_foregroundCheckTime > FOREGROUND_CHECK_MS * m_qpcFrequency / 1000) {
+        UpdateForegroundProcess(timestamp);
+    }
+    if (processId != m_foregroundProcessId || processId == 0) return;
+
+    if (m_secondStart == 0) {
+        m_secondStart = timestamp;
+    }
+    if (m_lastPresentTime != 0) {
+        float frameMs = static_cast<float>(static_cast<double>(timestamp - m_lastPresentTime) * 1000.0 / m_qpcFrequency);
+        if (frameMs > 0.0f && frameMs < MAX_FRAME_MS) {
+            m_secondFrames++;
+            m_secondFrameMsSum += frameMs;
+            m_secondFrameMsSquaredSum += static_cast<double>(frameMs) * frameMs;
+            m_secondMaxFrameMs = std::max(m_secondMaxFrameMs, frameMs);
+
+            // Slow enough that one late frame doesn't shift the schedule, fast enough to follow a new cap
+            double interval = m_phaseIntervalMs.load(std::memory_order_relaxed);
+            m_phaseIntervalMs.store(interval > 0.0 ? interval + (frameMs - interval) * 0.05 : frameMs,
+                std::memory_order_relaxed);
+        }
+    }
+    m_lastPresentTime = timestamp;
+    m_phasePresentQpc.store(timestamp, std::memory_order_release);
+
+    if (timestamp - m_secondStart >= m_qpcFrequency) {
+        FinishSecond(timestamp);
+    }
+}
+
+void PresentEventSampler::UpdateForegroundProcess(int64_t timestamp) {
+    m_foregroundCheckTime = timestamp;
+    DWORD processId = 0;
+    if (HWND foreground = GetForegroundWindow()) {
+        GetWindowThreadProcessId(foreground, &processId);
+    }
+
+    // While the overlay has focus, keep timing the game behind it
+    if (processId == 0 || processId == m_ownProcessId || processId == m_foregroundProcessId) return;
+
+    m_foregroundProcessId = processId;
+    m_lastPresentTime = 0;
+    m_secondStart = 0;
+    m_secondFrames = 0;
+    m_secondFrameMsSum = 0.0;
+    m_secondFrameMsSquaredSum = 0.0;
+    m_secondMaxFrameMs = 0.0f;
+    m_baselineSeconds.clear();
+    m_baselineIndex = 0;
+    m_phasePresentQpc.store(0, std::memory_order_release);
+    m_phaseIntervalMs.store(0.0, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_latest = GamePresentSample();
+}
+
+void PresentEventSampler::FinishSecond(int64_t timestamp) {
+    GamePresentSample sample;
+    sample.processId = m_foregroundProcessId;
+    if (m_secondFrames > 0) {
+        double elapsedSeconds = static_cast<double>(timestamp - m_secondStart) / m_qpcFrequency;
+        sample.valid = true;
+        sample.framesPerSecond = static_cast<float>(m_secondFrames / elapsedSeconds);
+        sample.averageFrameMs = static_cast<float>(m_secondFrameMsSum / m_secondFrames);
+        sample.maxFrameMs = m_secondMaxFrameMs;
+        double variance = m_secondFrameMsSquaredSum / m_secondFrames -
+            static_cast<double>(sample.averageFrameMs) * sample.averageFrameMs;
+        sample.frameTimeStdDevMs = static_cast<float>(std::sqrt(std::max(variance, 0.0)));
+
+        if (m_baselineSeconds.size() < BASELINE_SECONDS) {
+            m_baselineSeconds.push_back(sample.averageFrameMs);
+        }
+        else {
+            m_baselineSeconds[m_baselineIndex] = sample.averageFrameMs;
+        }
+        m_baselineIndex = (m_baselineIndex + 1) % BASELINE_SECONDS;
+
+        // Median: a few slow seconds don't move it, a sustained change does
+        if (m_baselineSeconds.size() >= BASELINE_SECONDS / 3) {
+            std::vector<float> sorted = m_baselineSeconds;
+            std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+            sample.baselineFrameMs = sorted[sorted.size() / 2];
+        }
+    }
+
+    m_secondStart = timestamp;
+    m_secondFrames = 0;
+    m_secondFrameMsSum = 0.0;
+    m_secondFrameMsSquaredSum = 0.0;
+    m_secondMaxFrameMs = 0.0f;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_latest = sample;
+    m_latestTime = timestamp;
+}
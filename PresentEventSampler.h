@@ -0,0 +1,96 @@
+// GameOverlay - PresentEventSampler.h
+// Frame rate of the foreground game from DXGI present events (ETW), without hooking the game
+
+#pragma once
+
+#include <Windows.h>
+#include <evntrace.h>
+#include <evntcons.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+// One second of the foreground process's presents
+struct GamePresentSample {
+    bool valid = false;        // Presents seen in the last couple of seconds
+    DWORD processId = 0;
+    float framesPerSecond = 0.0f;
+    float averageFrameMs = 0.0f;
+    float maxFrameMs = 0.0f;
+    float frameTimeStdDevMs = 0.0f; // Judder: spread of the frame times around the average
+    float baselineFrameMs = 0.0f; // Median of the recent one-second averages (0 until known)
+};
+
+// When the foreground game presents, for scheduling around it. Timestamps are QPC ticks.
+struct GamePresentPhase {
+    bool valid = false;
+    int64_t lastPresentQpc = 0;
+    double intervalMs = 0.0; // Smoothed present interval
+};
+
+// A private real-time ETW session with the Microsoft-Windows-DXGI provider, consumed on a worker
+// thread (ProcessTrace blocks until the session stops). Present_Start events of the foreground
+// process, other than ours, are timed a second at a time, like PresentMon does. ETW sessions need
+// administrator rights or the Performance Log Users group; without them IsAvailable stays false.
+class PresentEventSampler {
+public:
+    static constexpr UINT BASELINE_SECONDS = 30;
+    static constexpr int64_t STALE_AFTER_MS = 2000;
+
+    PresentEventSampler();
+    ~PresentEventSampler();
+
+    // Disable copy and move
+    PresentEventSampler(const PresentEventSampler&) = delete;
+    PresentEventSampler& operator=(const PresentEventSampler&) = delete;
+    PresentEventSampler(PresentEventSampler&&) = delete;
+    PresentEventSampler& operator=(PresentEventSampler&&) = delete;
+
+    bool IsAvailable() const { return m_available.load(); }
+
+    // False while no foreground game presents
+    bool GetLatestSample(GamePresentSample& sample) const;
+    // Latest present and the cadence, updated on every present (lock-free); false while stale
+    bool GetPresentPhase(GamePresentPhase& phase) const;
+
+private:
+    bool StartSession();
+    void StopSession();
+    void WorkerThread();
+    static void WINAPI OnEventRecord(PEVENT_RECORD record);
+    void OnPresent(DWORD processId, int64_t timestamp);
+    void UpdateForegroundProcess(int64_t timestamp);
+    void FinishSecond(int64_t timestamp);
+
+    // Session (owner thread)
+    TRACEHANDLE m_sessionHandle = 0;
+    TRACEHANDLE m_traceHandle = INVALID_PROCESSTRACE_HANDLE;
+    std::vector<uint8_t> m_properties; // EVENT_TRACE_PROPERTIES followed by the session name
+    std::atomic<bool> m_available = false;
+    std::thread m_worker;
+
+    // Present timing (worker thread only)
+    int64_t m_qpcFrequency = 0;
+    DWORD m_ownProcessId = 0;
+    DWORD m_foregroundProcessId = 0;
+    int64_t m_foregroundCheckTime = 0;
+    int64_t m_lastPresentTime = 0;
+    int64_t m_secondStart = 0;
+    UINT m_secondFrames = 0;
+    double m_secondFrameMsSum = 0.0;
+    double m_secondFrameMsSquaredSum = 0.0;
+    float m_secondMaxFrameMs = 0.0f;
+    std::vector<float> m_baselineSeconds; // Ring of one-second averages
+    size_t m_baselineIndex = 0;
+
+    // Published phase (written by the worker, read from any thread)
+    std::atomic<int64_t> m_phasePresentQpc = 0;
+    std::atomic<double> m_phaseIntervalMs = 0.0;
+
+    // m_mutex guards the published sample
+    mutable std::mutex m_mutex;
+    GamePresentSample m_latest;
+    int64_t m_latestTime = 0;
+};
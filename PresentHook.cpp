@@ -0,0 +1,912 @@
+// GameOverlay - PresentHook.cpp
+// GameOverlayHook.dll: draws the overlay's shared layer into the game's back buffer from DXGI Present
+
+#include <Windows.h>
+#include <d3d11_4.h>
+#include <d3d12.h>
+#include <dxgi1_4.h>
+#include <d3dcompiler.h>
+#include <wrl/client.h>
+#include <algorithm>
+#include <mutex>
+#include <memory>
+#include "SharedLayer.h"
+
+#pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "d3d12.lib")
+#pragma comment(lib, "dxgi.lib")
+#pragma comment(lib, "d3dcompiler.lib")
+
+using Microsoft::WRL::ComPtr;
+
+// Loaded into the game by the overlay's WH_GETMESSAGE hook (PresentHookInjector). A thread started
+// from DllMain creates a throwaway D3D11 and D3D12 swap chain, patches Present, Present1,
+// ResizeBuffers and ResizeBuffers1 in their vtables (shared by every swap chain of the class, so the
+// game's too) and pins the DLL. Only the swap chain presenting to the window the overlay targets
+// (SharedLayerBlock::targetWindow) is drawn into, not a launcher's or a browser's in the same process;
+// each of its Presents then draws the latest shared layer frame over the back buffer
+// with one premultiplied-alpha triangle, on the game's own device: the layer texture and fence are
+// duplicated out of the overlay process and opened on it. The GPU waits for the overlay's fence,
+// the game's CPU never does. D3D12 swap chains report the queue they present on through GetDevice,
+// so no queue hook is needed.
+
+namespace {
+
+constexpr size_t PRESENT_SLOT = 8;         // IDXGISwapChain::Present
+constexpr size_t RESIZE_BUFFERS_SLOT = 13; // IDXGISwapChain::ResizeBuffers
+constexpr size_t PRESENT1_SLOT = 22;       // IDXGISwapChain1::Present1
+constexpr size_t RESIZE_BUFFERS1_SLOT = 39; // IDXGISwapChain3::ResizeBuffers1
+constexpr DWORD REOPEN_INTERVAL_MS = 1000; // Between attempts to open the layer mapping
+
+using PresentFn = HRESULT(STDMETHODCALLTYPE*)(IDXGISwapChain*, UINT, UINT);
+using Present1Fn = HRESULT(STDMETHODCALLTYPE*)(IDXGISwapChain1*, UINT, UINT, const DXGI_PRESENT_PARAMETERS*);
+using ResizeBuffersFn = HRESULT(STDMETHODCALLTYPE*)(IDXGISwapChain*, UINT, UINT, UINT, DXGI_FORMAT, UINT);
+using ResizeBuffers1Fn = HRESULT(STDMETHODCALLTYPE*)(IDXGISwapChain3*, UINT, UINT, UINT, DXGI_FORMAT, UINT,
+    const UINT*, IUnknown* const*);
+
+// The D3D11 and D3D12 swap chain classes may or may not share a vtable
+struct SwapChainVtable {
+    void** vtable = nullptr;
+    PresentFn present = nullptr;
+    Present1Fn present1 = nullptr;
+    ResizeBuffersFn resizeBuffers = nullptr;
+    ResizeBuffers1Fn resizeBuffers1 = nullptr; // Only if the class is an IDXGISwapChain3
+};
+SwapChainVtable g_vtables[2];
+
+const char* const LAYER_SHADER = R"(
+Texture2D layerTexture : register(t0);
+SamplerState layerSampler : register(s0);
+struct Vertex { float4 position : SV_Position; float2 uv : TEXCOORD0; };
+Vertex VSMain(uint id : SV_VertexID) {
+    Vertex output;
+    output.uv = float2((id << 1) & 2, id & 2);
+    output.position = float4(output.uv * float2(2.0, -2.0) + float2(-1.0, 1.0), 0.0, 1.0);
+    return output;
+}
+float4 PSMain(Vertex input) : SV_Target { return layerTexture.Sample(layerSampler, input.uv); }
+)";
+
+struct LayerFrame {
+    DWORD processId = 0;
+    uint64_t textureHandles[SharedLayerBlock::SLOT_COUNT] = {};
+    uint64_t fenceHandle = 0;
+    uint32_t generation = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int32_t screenX = 0;
+    int32_t screenY = 0;
+    bool visible = false;
+    uint32_t slot = SharedLayerBlock::NO_SLOT; // Latest, claimed through readingSlot
+    uint64_t fenceValue = 0;
+};
+
+// Layer reads submitted to the game's GPU, each with the value of the renderer's own fence
+// signalled after it; published as the consumer's submitted and completed fence values, so the
+// overlay doesn't rewrite a slot the GPU may still sample
+class PendingReads {
+public:
+    void Add(uint64_t ownFenceValue, uint64_t layerFenceValue) {
+        m_reads[m_next] = { ownFenceValue, layerFenceValue };
+        m_next = (m_next + 1) % CAPACITY; // Overwriting the oldest only delays completion
+        m_submitted = std::max(m_submitted, layerFenceValue);
+    }
+
+    // Queues finish in order: the newest read the GPU is past covers every older one
+    uint64_t GetCompleted(uint64_t ownCompletedValue) {
+        bool pending = false;
+        for (Read& read : m_reads) {
+            if (read.ownFenceValue == 0) continue;
+            if (read.ownFenceValue > ownCompletedValue) {
+                pending = true;
+                continue;
+            }
+            m_completed = std::max(m_completed, read.layerFenceValue);
+            read = Read();
+        }
+        if (!pending) m_completed = m_submitted;
+        return m_completed;
+    }
+    uint64_t GetSubmitted() const { return m_submitted; }
+
+    void Reset() { *this = PendingReads(); } // Another producer: its fence values start over
+
+private:
+    static constexpr size_t CAPACITY = 8;
+    struct Read {
+        uint64_t ownFenceValue = 0;
+        uint64_t layerFenceValue = 0;
+    };
+    Read m_reads[CAPACITY];
+    size_t m_next = 0;
+    uint64_t m_submitted = 0;
+    uint64_t m_completed = 0;
+};
+
+// --- Shared layer block ---
+
+HANDLE g_mapping = nullptr;
+SharedLayerBlock* g_block = nullptr;
+SharedLayerBlock::Consumer* g_consumer = nullptr; // Our entry
+ULONGLONG g_lastOpenAttempt = 0;
+HANDLE g_producer = nullptr; // PROCESS_DUP_HANDLE on the overlay
+DWORD g_producerId = 0;
+
+void ReleaseConsumer() {
+    if (g_consumer) {
+        g_consumer->readingSlot = SharedLayerBlock::NO_SLOT;
+        g_consumer->processId = 0; // Free for the next consumer
+        g_consumer = nullptr;
+    }
+}
+
+void CloseLayer() {
+    ReleaseConsumer();
+    if (g_block) UnmapViewOfFile(g_block);
+    if (g_mapping) CloseHandle(g_mapping);
+    g_block = nullptr;
+    g_mapping = nullptr;
+}
+
+bool OpenLayer() {
+    if (g_block) return true;
+    ULONGLONG now = GetTickCount64();
+    if (now - g_lastOpenAttempt < REOPEN_INTERVAL_MS) return false;
+    g_lastOpenAttempt = now;
+
+    g_mapping = OpenFileMappingA(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, SharedLayer::LAYER_MAPPING_NAME);
+    if (!g_mapping) return false;
+    g_block = static_cast<SharedLayerBlock*>(MapViewOfFile(g_mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, sizeof(SharedLayerBlock)));
+    if (!g_block) {
+        CloseLayer();
+        return false;
+    }
+    return true;
+}
+
+int64_t Now() {
+    LARGE_INTEGER now = {};
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+// A free entry, or one whose owner stopped reading
+bool ClaimConsumer() {
+    if (g_consumer) return true;
+    const DWORD self = GetCurrentProcessId();
+    const int64_t timeout = g_block->qpcFrequency * SharedLayer::CONSUMER_TIMEOUT_MS / 1000;
+    for (SharedLayerBlock::Consumer& consumer : g_block->consumers) {
+        uint32_t owner = consumer.processId.load();
+        bool stale = owner != 0 && Now() - consumer.qpc.load() > timeout;
+        if ((owner == 0 || stale) && consumer.processId.compare_exchange_strong(owner, self)) {
+            consumer.readingSlot = SharedLayerBlock::NO_SLOT;
+            consumer.submittedFenceValue = 0;
+            consumer.completedFenceValue = 0;
+            consumer.flags = SharedLayerBlock::CONSUMER_DRAWS_OVERLAY;
+            consumer.qpc = Now();
+            g_consumer = &consumer;
+            return true;
+        }
+    }
+    return false; // Every entry is in use
+}
+
+bool ReadFrameFields(LayerFrame& frame, uint64_t& sequence) {
+    sequence = g_block->sequence.load(std::memory_order_acquire);
+    if (sequence & 1) return false;
+    frame.processId = g_block->processId;
+    frame.fenceHandle = g_block->fenceHandle;
+    for (uint32_t slot = 0; slot < SharedLayerBlock::SLOT_COUNT; slot++) {
+        frame.textureHandles[slot] = g_block->textureHandles[slot];
+    }
+    frame.generation = g_block->generation;
+    frame.width = g_block->width;
+    frame.height = g_block->height;
+    frame.screenX = g_block->screenX;
+    frame.screenY = g_block->screenY;
+    frame.visible = g_block->visible != 0;
+    frame.slot = g_block->latestSlot;
+    frame.fenceValue = g_block->latestFenceValue;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return g_block->sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+// This process is the detected game and the swap chain presents to its window (or a child of it)
+bool IsTargetSwapChain(IDXGISwapChain* swapChain) {
+    if (g_block->targetProcessId.load() != GetCurrentProcessId()) return false;
+    HWND target = reinterpret_cast<HWND>(g_block->targetWindow.load());
+    DXGI_SWAP_CHAIN_DESC desc = {};
+    if (!target || FAILED(swapChain->GetDesc(&desc)) || !desc.OutputWindow) return false;
+    return desc.OutputWindow == target || GetAncestor(desc.OutputWindow, GA_ROOT) == target;
+}
+
+// The latest frame, with its slot claimed: the claim is stored before the block is read again,
+// so a producer that hasn't seen it yet can't have chosen that slot (it never writes the latest)
+bool ReadLayer(IDXGISwapChain* swapChain, LayerFrame& frame) {
+    if (!OpenLayer()) return false;
+    if (g_block->magic != SharedLayerBlock::MAGIC || g_block->version != SharedLayerBlock::VERSION) {
+        CloseLayer(); // The overlay exited; a new instance creates a new mapping
+        return false;
+    }
+    if (!IsTargetSwapChain(swapChain)) {
+        ReleaseConsumer(); // Not the game any more, or a swap chain of its other windows
+        return false;
+    }
+    if (!ClaimConsumer()) return false;
+    g_consumer->qpc.store(Now(), std::memory_order_relaxed);
+
+    for (int attempt = 0; attempt < 4; attempt++) {
+        uint64_t sequence = 0;
+        if (!ReadFrameFields(frame, sequence)) continue;
+        g_consumer->readingSlot.store(frame.slot);
+        if (g_block->sequence.load() != sequence) continue;
+        return frame.slot < SharedLayerBlock::SLOT_COUNT && frame.width > 0 && frame.height > 0;
+    }
+    return false; // Being written; the previous frame stays on screen
+}
+
+// A handle of the overlay process, duplicated into this one (closed by the caller)
+HANDLE DuplicateFromProducer(DWORD processId, uint64_t value) {
+    if (processId != g_producerId) {
+        if (g_producer) CloseHandle(g_producer);
+        g_producer = OpenProcess(PROCESS_DUP_HANDLE, FALSE, processId);
+        g_producerId = g_producer ? processId : 0;
+    }
+    HANDLE handle = nullptr;
+    if (!g_producer || !DuplicateHandle(g_producer, reinterpret_cast<HANDLE>(value), GetCurrentProcess(), &handle,
+        0, FALSE, DUPLICATE_SAME_ACCESS)) {
+        return nullptr;
+    }
+    return handle;
+}
+
+// Where the layer lands in back buffer pixels: the overlay's screen position relative to the
+// game's client area, scaled when the back buffer isn't the client size
+bool GetLayerRect(IDXGISwapChain* swapChain, const LayerFrame& frame, UINT bufferWidth, UINT bufferHeight,
+    float& x, float& y, float& width, float& height) {
+    DXGI_SWAP_CHAIN_DESC desc = {};
+    if (FAILED(swapChain->GetDesc(&desc))) return false;
+    POINT origin = { 0, 0 };
+    RECT client = {};
+    if (!ClientToScreen(desc.OutputWindow, &origin) || !GetClientRect(desc.OutputWindow, &client) ||
+        client.right <= 0 || client.bottom <= 0) {
+        return false;
+    }
+    const float scaleX = static_cast<float>(bufferWidth) / client.right;
+    const float scaleY = static_cast<float>(bufferHeight) / client.bottom;
+    x = (frame.screenX - origin.x) * scaleX;
+    y = (frame.screenY - origin.y) * scaleY;
+    width = frame.width * scaleX;
+    height = frame.height * scaleY;
+    return x < bufferWidth && y < bufferHeight && x + width > 0.0f && y + height > 0.0f;
+}
+
+bool CompileLayerShaders(ComPtr<ID3DBlob>& vertexShader, ComPtr<ID3DBlob>& pixelShader) {
+    const size_t length = strlen(LAYER_SHADER);
+    return SUCCEEDED(D3DCompile(LAYER_SHADER, length, "GameOverlayLayer", nullptr, nullptr, "VSMain", "vs_5_0",
+               D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &vertexShader, nullptr)) &&
+           SUCCEEDED(D3DCompile(LAYER_SHADER, length, "GameOverlayLayer", nullptr, nullptr, "PSMain", "ps_5_0",
+               D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &pixelShader, nullptr));
+}
+
+// --- D3D11 ---
+// Draws inside a device context state of its own (SwapDeviceContextState), so none of the game's
+// bindings are touched
+class Renderer11 {
+public:
+    bool Initialize(ID3D11Device* device) {
+        if (FAILED(device->QueryInterface(IID_PPV_ARGS(&m_device))) ||
+            FAILED(device->QueryInterface(IID_PPV_ARGS(&m_device5)))) {
+            return false; // The shared fence needs D3D11.4
+        }
+        if (FAILED(m_device5->CreateFence(0, D3D11_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_ownFence)))) return false;
+        ComPtr<ID3D11DeviceContext> context;
+        device->GetImmediateContext(&context);
+        if (FAILED(context.As(&m_context)) || FAILED(context.As(&m_context4))) return false;
+
+        D3D_FEATURE_LEVEL featureLevel = device->GetFeatureLevel();
+        if (FAILED(m_device->CreateDeviceContextState(0, &featureLevel, 1, D3D11_SDK_VERSION,
+            __uuidof(ID3D11Device1), nullptr, &m_state))) {
+            return false;
+        }
+
+        ComPtr<ID3DBlob> vertexShader;
+        ComPtr<ID3DBlob> pixelShader;
+        if (!CompileLayerShaders(vertexShader, pixelShader) ||
+            FAILED(device->CreateVertexShader(vertexShader->GetBufferPointer(), vertexShader->GetBufferSize(), nullptr, &m_vertexShader)) ||
+            FAILED(device->CreatePixelShader(pixelShader->GetBufferPointer(), pixelShader->GetBufferSize(), nullptr, &m_pixelShader))) {
+            return false;
+        }
+
+        D3D11_BLEND_DESC blend = {};
+        blend.RenderTarget[0].BlendEnable = TRUE;
+        blend.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
+        blend.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+        blend.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+        blend.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+        blend.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA;
+        blend.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+        blend.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+        D3D11_RASTERIZER_DESC raster = {};
+        raster.FillMode = D3D11_FILL_SOLID;
+        raster.CullMode = D3D11_CULL_NONE;
+        raster.DepthClipEnable = TRUE;
+        D3D11_SAMPLER_DESC sampler = {};
+        sampler.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+        sampler.AddressU = sampler.AddressV = sampler.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+        sampler.MaxLOD = D3D11_FLOAT32_MAX;
+        return SUCCEEDED(device->CreateBlendState(&blend, &m_blendState)) &&
+               SUCCEEDED(device->CreateRasterizerState(&raster, &m_rasterizerState)) &&
+               SUCCEEDED(device->CreateSamplerState(&sampler, &m_samplerState));
+    }
+
+    bool UsesDevice(ID3D11Device* device) const { return m_device.Get() == device; }
+    void ReleaseTarget() { m_targetView.Reset(); } // Before ResizeBuffers
+
+    void Draw(IDXGISwapChain* swapChain, const LayerFrame& frame) {
+        if (!OpenFrame(frame)) return;
+        if (!m_targetView) {
+            ComPtr<ID3D11Texture2D> backBuffer;
+            if (FAILED(swapChain->GetBuffer(0, IID_PPV_ARGS(&backBuffer))) ||
+                FAILED(m_device->CreateRenderTargetView(backBuffer.Get(), nullptr, &m_targetView))) {
+                return;
+            }
+            D3D11_TEXTURE2D_DESC desc = {};
+            backBuffer->GetDesc(&desc);
+            m_targetWidth = desc.Width;
+            m_targetHeight = desc.Height;
+        }
+        D3D11_VIEWPORT viewport = {};
+        if (!GetLayerRect(swapChain, frame, m_targetWidth, m_targetHeight, viewport.TopLeftX, viewport.TopLeftY,
+            viewport.Width, viewport.Height)) {
+            return;
+        }
+        viewport.MaxDepth = 1.0f;
+
+        // The GPU waits for the overlay's copy; there is no CPU wait
+        m_context4->Wait(m_fence.Get(), frame.fenceValue);
+
+        ComPtr<ID3DDeviceContextState> gameState;
+        m_context->SwapDeviceContextState(m_state.Get(), &gameState);
+        ID3D11RenderTargetView* targets[] = { m_targetView.Get() };
+        ID3D11ShaderResourceView* views[] = { m_layerViews[frame.slot].Get() };
+        ID3D11SamplerState* samplers[] = { m_samplerState.Get() };
+        m_context->OMSetRenderTargets(1, targets, nullptr);
+        m_context->OMSetBlendState(m_blendState.Get(), nullptr, 0xFFFFFFFF);
+        m_context->RSSetState(m_rasterizerState.Get());
+        m_context->RSSetViewports(1, &viewport);
+        m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        m_context->IASetInputLayout(nullptr);
+        m_context->VSSetShader(m_vertexShader.Get(), nullptr, 0);
+        m_context->PSSetShader(m_pixelShader.Get(), nullptr, 0);
+        m_context->PSSetShaderResources(0, 1, views);
+        m_context->PSSetSamplers(0, 1, samplers);
+        m_context->Draw(3, 0);
+
+        // Nothing stays bound in our state: ResizeBuffers needs the back buffer unreferenced
+        ID3D11ShaderResourceView* noViews[] = { nullptr };
+        m_context->PSSetShaderResources(0, 1, noViews);
+        m_context->OMSetRenderTargets(0, nullptr, nullptr);
+        m_context->SwapDeviceContextState(gameState.Get(), nullptr);
+
+        m_context4->Signal(m_ownFence.Get(), ++m_ownFenceValue);
+        m_reads.Add(m_ownFenceValue, frame.fenceValue);
+    }
+
+    uint64_t GetSubmittedReads() const { return m_reads.GetSubmitted(); }
+    uint64_t GetCompletedReads() { return m_reads.GetCompleted(m_ownFence->GetCompletedValue()); }
+
+private:
+    bool OpenFrame(const LayerFrame& frame) {
+        if (m_layerViews[0] && frame.generation == m_generation && frame.processId == m_processId) return true;
+        for (auto& view : m_layerViews) view.Reset();
+        if (frame.processId != m_processId) {
+            m_fence.Reset();
+            m_reads.Reset();
+        }
+
+        if (!m_fence) {
+            HANDLE fenceHandle = DuplicateFromProducer(frame.processId, frame.fenceHandle);
+            if (!fenceHandle) return false;
+            HRESULT hr = m_device5->OpenSharedFence(fenceHandle, IID_PPV_ARGS(&m_fence));
+            CloseHandle(fenceHandle);
+            if (FAILED(hr)) return false;
+        }
+        for (uint32_t slot = 0; slot < SharedLayerBlock::SLOT_COUNT; slot++) {
+            HANDLE textureHandle = DuplicateFromProducer(frame.processId, frame.textureHandles[slot]);
+            if (!textureHandle) return false;
+            ComPtr<ID3D11Texture2D> texture;
+            HRESULT hr = m_device->OpenSharedResource1(textureHandle, IID_PPV_ARGS(&texture));
+            CloseHandle(textureHandle);
+            if (FAILED(hr) || FAILED(m_device->CreateShaderResourceView(texture.Get(), nullptr, &m_layerViews[slot]))) {
+                for (auto& view : m_layerViews) view.Reset();
+                return false;
+            }
+        }
+        m_generation = frame.generation;
+        m_processId = frame.processId;
+        return true;
+    }
+
+    ComPtr<ID3D11Device1> m_device;
+    ComPtr<ID3D11Device5> m_device5;
+    ComPtr<ID3D11DeviceContext1> m_context;
+    ComPtr<ID3D11DeviceContext4> m_context4;
+    ComPtr<ID3DDeviceContextState> m_state;
+    ComPtr<ID3D11VertexShader> m_vertexShader;
+    ComPtr<ID3D11PixelShader> m_pixelShader;
+    ComPtr<ID3D11BlendState> m_blendState;
+    ComPtr<ID3D11RasterizerState> m_rasterizerState;
+    ComPtr<ID3D11SamplerState> m_samplerState;
+    ComPtr<ID3D11RenderTargetView> m_targetView;
+    UINT m_targetWidth = 0;
+    UINT m_targetHeight = 0;
+    ComPtr<ID3D11Fence> m_ownFence; // Signalled after each draw
+    UINT64 m_ownFenceValue = 0;
+    PendingReads m_reads;
+
+    // Shared layer
+    ComPtr<ID3D11Fence> m_fence;
+    ComPtr<ID3D11ShaderResourceView> m_layerViews[SharedLayerBlock::SLOT_COUNT];
+    uint32_t m_generation = 0;
+    DWORD m_processId = 0;
+};
+
+// --- D3D12 ---
+// One allocator per back buffer, reused once the hook's own fence shows the GPU is past it
+class Renderer12 {
+public:
+    static constexpr UINT MAX_BUFFERS = DXGI_MAX_SWAP_CHAIN_BUFFERS;
+
+    ~Renderer12() {
+        if (m_event) CloseHandle(m_event);
+    }
+
+    bool Initialize(ID3D12Device* device) {
+        m_device = device;
+        m_event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+        if (!m_event || FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_ownFence)))) return false;
+
+        D3D12_DESCRIPTOR_RANGE range = {};
+        range.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+        range.NumDescriptors = 1;
+        D3D12_ROOT_PARAMETER parameter = {};
+        parameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+        parameter.DescriptorTable.NumDescriptorRanges = 1;
+        parameter.DescriptorTable.pDescriptorRanges = &range;
+        parameter.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+        D3D12_STATIC_SAMPLER_DESC sampler = {};
+        sampler.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+        sampler.AddressU = sampler.AddressV = sampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+        sampler.MaxLOD = D3D12_FLOAT32_MAX;
+        sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+        D3D12_ROOT_SIGNATURE_DESC rootDesc = {};
+        rootDesc.NumParameters = 1;
+        rootDesc.pParameters = &parameter;
+        rootDesc.NumStaticSamplers = 1;
+        rootDesc.pStaticSamplers = &sampler;
+        ComPtr<ID3DBlob> serialized;
+        if (FAILED(D3D12SerializeRootSignature(&rootDesc, D3D_ROOT_SIGNATURE_VERSION_1, &serialized, nullptr)) ||
+            FAILED(device->CreateRootSignature(0, serialized->GetBufferPointer(), serialized->GetBufferSize(),
+                IID_PPV_ARGS(&m_rootSignature))) ||
+            !CompileLayerShaders(m_vertexShader, m_pixelShader)) {
+            return false;
+        }
+
+        D3D12_DESCRIPTOR_HEAP_DESC srvHeap = { D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, SharedLayerBlock::SLOT_COUNT,
+            D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE, 0 };
+        D3D12_DESCRIPTOR_HEAP_DESC rtvHeap = { D3D12_DESCRIPTOR_HEAP_TYPE_RTV, MAX_BUFFERS, D3D12_DESCRIPTOR_HEAP_FLAG_NONE, 0 };
+        m_rtvSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+        m_srvSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        return SUCCEEDED(device->CreateDescriptorHeap(&srvHeap, IID_PPV_ARGS(&m_srvHeap))) &&
+               SUCCEEDED(device->CreateDescriptorHeap(&rtvHeap, IID_PPV_ARGS(&m_rtvHeap)));
+    }
+
+    bool UsesDevice(ID3D12Device* device) const { return m_device.Get() == device; }
+
+    // Before ResizeBuffers: the swap chain's buffers must have no references left
+    void ReleaseTargets() {
+        WaitForIdle();
+        for (auto& buffer : m_buffers) buffer.Reset();
+        m_bufferCount = 0;
+    }
+
+    void Draw(IDXGISwapChain3* swapChain, ID3D12CommandQueue* queue, const LayerFrame& frame) {
+        if (!OpenFrame(frame)) return;
+        DXGI_SWAP_CHAIN_DESC desc = {};
+        if (FAILED(swapChain->GetDesc(&desc)) || desc.BufferCount > MAX_BUFFERS || !EnsureTargets(swapChain, desc)) return;
+
+        const UINT index = swapChain->GetCurrentBackBufferIndex();
+        D3D12_VIEWPORT viewport = {};
+        if (index >= m_bufferCount || !GetLayerRect(swapChain, frame, desc.BufferDesc.Width, desc.BufferDesc.Height,
+            viewport.TopLeftX, viewport.TopLeftY, viewport.Width, viewport.Height)) {
+            return;
+        }
+        viewport.MaxDepth = 1.0f;
+        D3D12_RECT scissor = {
+            std::max<LONG>(static_cast<LONG>(viewport.TopLeftX), 0), std::max<LONG>(static_cast<LONG>(viewport.TopLeftY), 0),
+            std::min<LONG>(static_cast<LONG>(viewport.TopLeftX + viewport.Width), static_cast<LONG>(desc.BufferDesc.Width)),
+            std::min<LONG>(static_cast<LONG>(viewport.TopLeftY + viewport.Height), static_cast<LONG>(desc.BufferDesc.Height))
+        };
+
+        // The allocator's previous use must be finished
+        if (m_ownFence->GetCompletedValue() < m_allocatorFenceValues[index]) {
+            m_ownFence->SetEventOnCompletion(m_allocatorFenceValues[index], m_event);
+            WaitForSingleObject(m_event, INFINITE);
+        }
+        ID3D12CommandAllocator* allocator = m_allocators[index].Get();
+        allocator->Reset();
+        m_commandList->Reset(allocator, m_pipelineState.Get());
+
+        D3D12_RESOURCE_BARRIER barrier = {};
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barrier.Transition.pResource = m_buffers[index].Get();
+        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
+        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
+        m_commandList->ResourceBarrier(1, &barrier);
+
+        D3D12_CPU_DESCRIPTOR_HANDLE rtv = m_rtvHeap->GetCPUDescriptorHandleForHeapStart();
+        rtv.ptr += static_cast<SIZE_T>(index) * m_rtvSize;
+        ID3D12DescriptorHeap* heaps[] = { m_srvHeap.Get() };
+        m_commandList->SetGraphicsRootSignature(m_rootSignature.Get());
+        m_commandList->SetDescriptorHeaps(1, heaps);
+        D3D12_GPU_DESCRIPTOR_HANDLE srv = m_srvHeap->GetGPUDescriptorHandleForHeapStart();
+        srv.ptr += static_cast<UINT64>(frame.slot) * m_srvSize;
+        m_commandList->SetGraphicsRootDescriptorTable(0, srv);
+        m_commandList->OMSetRenderTargets(1, &rtv, FALSE, nullptr);
+        m_commandList->RSSetViewports(1, &viewport);
+        m_commandList->RSSetScissorRects(1, &scissor);
+        m_commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        m_commandList->DrawInstanced(3, 1, 0, 0);
+
+        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
+        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
+        m_commandList->ResourceBarrier(1, &barrier);
+        if (FAILED(m_commandList->Close())) return;
+
+        // The GPU waits for the overlay's copy; there is no CPU wait
+        queue->Wait(m_fence.Get(), frame.fenceValue);
+        ID3D12CommandList* lists[] = { m_commandList.Get() };
+        queue->ExecuteCommandLists(1, lists);
+        queue->Signal(m_ownFence.Get(), ++m_ownFenceValue);
+        m_allocatorFenceValues[index] = m_ownFenceValue;
+        m_queue = queue;
+        m_reads.Add(m_ownFenceValue, frame.fenceValue);
+    }
+
+    uint64_t GetSubmittedReads() const { return m_reads.GetSubmitted(); }
+    uint64_t GetCompletedReads() { return m_reads.GetCompleted(m_ownFence->GetCompletedValue()); }
+
+private:
+    void WaitForIdle() {
+        if (!m_queue || m_ownFence->GetCompletedValue() >= m_ownFenceValue) return;
+        m_ownFence->SetEventOnCompletion(m_ownFenceValue, m_event);
+        WaitForSingleObject(m_event, INFINITE);
+    }
+
+    bool EnsureTargets(IDXGISwapChain3* swapChain, const DXGI_SWAP_CHAIN_DESC& desc) {
+        if (m_bufferCount == desc.BufferCount && m_buffers[0]) return EnsurePipeline(desc.BufferDesc.Format);
+        ReleaseTargets();
+        D3D12_CPU_DESCRIPTOR_HANDLE rtv = m_rtvHeap->GetCPUDescriptorHandleForHeapStart();
+        for (UINT i = 0; i < desc.BufferCount; i++) {
+            if (FAILED(swapChain->GetBuffer(i, IID_PPV_ARGS(&m_buffers[i])))) return false;
+            m_device->CreateRenderTargetView(m_buffers[i].Get(), nullptr, rtv);
+            rtv.ptr += m_rtvSize;
+            if (!m_allocators[i] && FAILED(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
+                IID_PPV_ARGS(&m_allocators[i])))) {
+                return false;
+            }
+        }
+        if (!m_commandList) {
+            if (FAILED(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_allocators[0].Get(), nullptr,
+                IID_PPV_ARGS(&m_commandList)))) {
+                return false;
+            }
+            m_commandList->Close();
+        }
+        m_bufferCount = desc.BufferCount;
+        return EnsurePipeline(desc.BufferDesc.Format);
+    }
+
+    bool EnsurePipeline(DXGI_FORMAT format) {
+        if (m_pipelineState && format == m_pipelineFormat) return true;
+        D3D12_GRAPHICS_PIPELINE_STATE_DESC desc = {};
+        desc.pRootSignature = m_rootSignature.Get();
+        desc.VS = { m_vertexShader->GetBufferPointer(), m_vertexShader->GetBufferSize() };
+        desc.PS = { m_pixelShader->GetBufferPointer(), m_pixelShader->GetBufferSize() };
+        D3D12_RENDER_TARGET_BLEND_DESC& blend = desc.BlendState.RenderTarget[0];
+        blend.BlendEnable = TRUE;
+        blend.SrcBlend = D3D12_BLEND_ONE;
+        blend.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+        blend.BlendOp = D3D12_BLEND_OP_ADD;
+        blend.SrcBlendAlpha = D3D12_BLEND_ONE;
+        blend.DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA;
+        blend.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+        blend.LogicOp = D3D12_LOGIC_OP_NOOP;
+        blend.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+        desc.SampleMask = UINT_MAX;
+        desc.RasterizerState.FillMode = D3D12_FILL_MODE_SOLID;
+        desc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+        desc.RasterizerState.DepthClipEnable = TRUE;
+        desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+        desc.NumRenderTargets = 1;
+        desc.RTVFormats[0] = format;
+        desc.SampleDesc.Count = 1;
+        m_pipelineState.Reset();
+        if (FAILED(m_device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&m_pipelineState)))) return false;
+        m_pipelineFormat = format;
+        return true;
+    }
+
+    bool OpenFrame(const LayerFrame& frame) {
+        if (m_layers[0] && frame.generation == m_generation && frame.processId == m_processId) return true;
+        WaitForIdle(); // The descriptors are rewritten below
+        for (auto& layer : m_layers) layer.Reset();
+        if (frame.processId != m_processId) {
+            m_fence.Reset();
+            m_reads.Reset();
+        }
+
+        if (!m_fence) {
+            HANDLE fenceHandle = DuplicateFromProducer(frame.processId, frame.fenceHandle);
+            if (!fenceHandle) return false;
+            HRESULT hr = m_device->OpenSharedHandle(fenceHandle, IID_PPV_ARGS(&m_fence));
+            CloseHandle(fenceHandle);
+            if (FAILED(hr)) return false;
+        }
+        D3D12_CPU_DESCRIPTOR_HANDLE srv = m_srvHeap->GetCPUDescriptorHandleForHeapStart();
+        for (uint32_t slot = 0; slot < SharedLayerBlock::SLOT_COUNT; slot++) {
+            HANDLE textureHandle = DuplicateFromProducer(frame.processId, frame.textureHandles[slot]);
+            if (!textureHandle) return false;
+            HRESULT hr = m_device->OpenSharedHandle(textureHandle, IID_PPV_ARGS(&m_layers[slot]));
+            CloseHandle(textureHandle);
+            if (FAILED(hr)) {
+                for (auto& layer : m_layers) layer.Reset();
+                return false;
+            }
+
+            // Simultaneous access: read from COMMON without a barrier
+            m_device->CreateShaderResourceView(m_layers[slot].Get(), nullptr, srv);
+            srv.ptr += m_srvSize;
+        }
+        m_generation = frame.generation;
+        m_processId = frame.processId;
+        return true;
+    }
+
+    ComPtr<ID3D12Device> m_device;
+    ComPtr<ID3D12RootSignature> m_rootSignature;
+    ComPtr<ID3DBlob> m_vertexShader;
+    ComPtr<ID3DBlob> m_pixelShader;
+    ComPtr<ID3D12PipelineState> m_pipelineState;
+    DXGI_FORMAT m_pipelineFormat = DXGI_FORMAT_UNKNOWN;
+    ComPtr<ID3D12DescriptorHeap> m_srvHeap;
+    ComPtr<ID3D12DescriptorHeap> m_rtvHeap;
+    UINT m_rtvSize = 0;
+    UINT m_srvSize = 0;
+    ComPtr<ID3D12Resource> m_buffers[MAX_BUFFERS];
+    ComPtr<ID3D12CommandAllocator> m_allocators[MAX_BUFFERS];
+    UINT64 m_allocatorFenceValues[MAX_BUFFERS] = {};
+    UINT m_bufferCount = 0;
+    ComPtr<ID3D12GraphicsCommandList> m_commandList;
+    ComPtr<ID3D12Fence> m_ownFence;
+    UINT64 m_ownFenceValue = 0;
+    HANDLE m_event = nullptr;
+    ID3D12CommandQueue* m_queue = nullptr; // Last queue submitted to
+    PendingReads m_reads;
+
+    // Shared layer
+    ComPtr<ID3D12Fence> m_fence;
+    ComPtr<ID3D12Resource> m_layers[SharedLayerBlock::SLOT_COUNT];
+    uint32_t m_generation = 0;
+    DWORD m_processId = 0;
+};
+
+// --- Hooks ---
+
+std::mutex g_mutex; // Present and ResizeBuffers(1) may come from different game threads
+std::unique_ptr<Renderer11> g_renderer11;
+std::unique_ptr<Renderer12> g_renderer12;
+
+const SwapChainVtable* FindVtable(IUnknown* object) {
+    void** vtable = *reinterpret_cast<void***>(object);
+    for (const SwapChainVtable& entry : g_vtables) {
+        if (entry.vtable == vtable) return &entry;
+    }
+    return nullptr;
+}
+
+// Submitted is the newest of either renderer's reads, completed the oldest still outstanding
+void PublishReads() {
+    uint64_t submitted = 0;
+    uint64_t completed = UINT64_MAX;
+    if (g_renderer11) {
+        submitted = std::max(submitted, g_renderer11->GetSubmittedReads());
+        completed = std::min(completed, g_renderer11->GetCompletedReads());
+    }
+    if (g_renderer12) {
+        submitted = std::max(submitted, g_renderer12->GetSubmittedReads());
+        completed = std::min(completed, g_renderer12->GetCompletedReads());
+    }
+    if (completed == UINT64_MAX) completed = submitted;
+    g_consumer->completedFenceValue.store(completed);
+    g_consumer->submittedFenceValue.store(submitted);
+}
+
+void DrawFrame(IDXGISwapChain* swapChain, const LayerFrame& frame) {
+    // A D3D12 swap chain's "device" is the queue it presents on
+    ComPtr<ID3D12CommandQueue> queue;
+    if (SUCCEEDED(swapChain->GetDevice(IID_PPV_ARGS(&queue)))) {
+        ComPtr<ID3D12Device> device;
+        ComPtr<IDXGISwapChain3> swapChain3;
+        if (FAILED(queue->GetDevice(IID_PPV_ARGS(&device))) || FAILED(swapChain->QueryInterface(IID_PPV_ARGS(&swapChain3)))) return;
+        if (!g_renderer12 || !g_renderer12->UsesDevice(device.Get())) {
+            g_renderer12 = std::make_unique<Renderer12>();
+            if (!g_renderer12->Initialize(device.Get())) {
+                g_renderer12.reset();
+                return;
+            }
+        }
+        g_renderer12->Draw(swapChain3.Get(), queue.Get(), frame);
+        return;
+    }
+
+    ComPtr<ID3D11Device> device;
+    if (FAILED(swapChain->GetDevice(IID_PPV_ARGS(&device)))) return;
+    if (!g_renderer11 || !g_renderer11->UsesDevice(device.Get())) {
+        g_renderer11 = std::make_unique<Renderer11>();
+        if (!g_renderer11->Initialize(device.Get())) {
+            g_renderer11.reset();
+            return;
+        }
+    }
+    g_renderer11->Draw(swapChain, frame);
+}
+
+void DrawLayer(IDXGISwapChain* swapChain) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    LayerFrame frame;
+    if (!ReadLayer(swapChain, frame)) return;
+    if (frame.visible) DrawFrame(swapChain, frame);
+    PublishReads(); // Also while hidden, so earlier reads stop holding their slots
+}
+
+HRESULT STDMETHODCALLTYPE HookedPresent(IDXGISwapChain* swapChain, UINT syncInterval, UINT flags) {
+    const SwapChainVtable* vtable = FindVtable(swapChain);
+    if (!(flags & DXGI_PRESENT_TEST)) DrawLayer(swapChain);
+    return vtable->present(swapChain, syncInterval, flags);
+}
+
+HRESULT STDMETHODCALLTYPE HookedPresent1(IDXGISwapChain1* swapChain, UINT syncInterval, UINT flags,
+    const DXGI_PRESENT_PARAMETERS* parameters) {
+    const SwapChainVtable* vtable = FindVtable(swapChain);
+    if (!(flags & DXGI_PRESENT_TEST)) DrawLayer(swapChain);
+    return vtable->present1(swapChain, syncInterval, flags, parameters);
+}
+
+// The swap chain's buffers can't be resized while the renderers hold references to them
+void ReleaseRendererTargets() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (g_renderer11) g_renderer11->ReleaseTarget();
+    if (g_renderer12) g_renderer12->ReleaseTargets();
+}
+
+HRESULT STDMETHODCALLTYPE HookedResizeBuffers(IDXGISwapChain* swapChain, UINT bufferCount, UINT width, UINT height,
+    DXGI_FORMAT format, UINT flags) {
+    const SwapChainVtable* vtable = FindVtable(swapChain);
+    ReleaseRendererTargets();
+    return vtable->resizeBuffers(swapChain, bufferCount, width, height, format, flags);
+}
+
+// D3D12 games with per-buffer node masks resize through this one instead
+HRESULT STDMETHODCALLTYPE HookedResizeBuffers1(IDXGISwapChain3* swapChain, UINT bufferCount, UINT width, UINT height,
+    DXGI_FORMAT format, UINT flags, const UINT* nodeMasks, IUnknown* const* presentQueues) {
+    const SwapChainVtable* vtable = FindVtable(swapChain);
+    ReleaseRendererTargets();
+    return vtable->resizeBuffers1(swapChain, bufferCount, width, height, format, flags, nodeMasks, presentQueues);
+}
+
+// The original is stored before the slot is switched: a game thread may call through it at once
+template <typename Fn>
+void PatchSlot(void** vtable, size_t slot, void* hook, Fn& original) {
+    if (vtable[slot] == hook) return;
+    DWORD protection = 0;
+    if (!VirtualProtect(&vtable[slot], sizeof(void*), PAGE_READWRITE, &protection)) return;
+    original = reinterpret_cast<Fn>(vtable[slot]);
+    InterlockedExchangePointer(&vtable[slot], hook);
+    VirtualProtect(&vtable[slot], sizeof(void*), protection, &protection);
+}
+
+void HookSwapChain(IDXGISwapChain* swapChain) {
+    void** vtable = *reinterpret_cast<void***>(swapChain);
+    for (SwapChainVtable& entry : g_vtables) {
+        if (entry.vtable == vtable) return;
+        if (entry.vtable) continue;
+        entry.vtable = vtable; // Before the patches, for FindVtable
+        PatchSlot(vtable, PRESENT_SLOT, reinterpret_cast<void*>(&HookedPresent), entry.present);
+        PatchSlot(vtable, PRESENT1_SLOT, reinterpret_cast<void*>(&HookedPresent1), entry.present1);
+        PatchSlot(vtable, RESIZE_BUFFERS_SLOT, reinterpret_cast<void*>(&HookedResizeBuffers), entry.resizeBuffers);
+        ComPtr<IDXGISwapChain3> swapChain3;
+        if (SUCCEEDED(swapChain->QueryInterface(IID_PPV_ARGS(&swapChain3)))) {
+            PatchSlot(vtable, RESIZE_BUFFERS1_SLOT, reinterpret_cast<void*>(&HookedResizeBuffers1), entry.resizeBuffers1);
+        }
+        return;
+    }
+}
+
+DWORD WINAPI InstallHooks(LPVOID) {
+    // The overlay loads the DLL too, only for the hook procedure
+    if (GetEnvironmentVariableW(SharedLayer::PRODUCER_VARIABLE, nullptr, 0) != 0) return 0;
+
+    // Patched vtables point into this DLL for the rest of the process's life
+    HMODULE module = nullptr;
+    GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_PIN,
+        reinterpret_cast<LPCWSTR>(&InstallHooks), &module);
+
+    HWND window = CreateWindowExW(0, L"STATIC", L"GameOverlayHook", WS_OVERLAPPED, 0, 0, 8, 8,
+        nullptr, nullptr, nullptr, nullptr);
+    if (!window) return 0;
+
+    // D3D11 swap chain
+    DXGI_SWAP_CHAIN_DESC desc = {};
+    desc.BufferCount = 2;
+    desc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+    desc.OutputWindow = window;
+    desc.SampleDesc.Count = 1;
+    desc.Windowed = TRUE;
+    desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+    {
+        ComPtr<IDXGISwapChain> swapChain;
+        ComPtr<ID3D11Device> device;
+        if (SUCCEEDED(D3D11CreateDeviceAndSwapChain(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, 0, nullptr, 0,
+            D3D11_SDK_VERSION, &desc, &swapChain, &device, nullptr, nullptr))) {
+            HookSwapChain(swapChain.Get());
+        }
+    }
+
+    // D3D12 swap chain
+    {
+        ComPtr<ID3D12Device> device;
+        ComPtr<ID3D12CommandQueue> queue;
+        ComPtr<IDXGIFactory2> factory;
+        D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+        queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+        DXGI_SWAP_CHAIN_DESC1 desc1 = {};
+        desc1.Width = 8;
+        desc1.Height = 8;
+        desc1.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc1.SampleDesc.Count = 1;
+        desc1.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+        desc1.BufferCount = 2;
+        desc1.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+        ComPtr<IDXGISwapChain1> swapChain;
+        if (SUCCEEDED(D3D12CreateDevice(nullptr, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&device))) &&
+            SUCCEEDED(device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&queue))) &&
+            SUCCEEDED(CreateDXGIFactory1(IID_PPV_ARGS(&factory))) &&
+            SUCCEEDED(factory->CreateSwapChainForHwnd(queue.Get(), window, &desc1, nullptr, nullptr, &swapChain))) {
+            HookSwapChain(swapChain.Get());
+        }
+    }
+
+    DestroyWindow(window);
+    return 0;
+}
+
+} // namespace
+
+// Installed on the game's window thread by PresentHookInjector; loading the DLL is all it is for
+extern "C" __declspec(dllexport) LRESULT CALLBACK GameOverlayHookProc(int code, WPARAM wParam, LPARAM lParam) {
+    return CallNextHookEx(nullptr, code, wParam, lParam);
+}
+
+BOOL APIENTRY DllMain(HMODULE module, DWORD reason, LPVOID) {
+    if (reason == DLL_PROCESS_ATTACH) {
+        DisableThreadLibraryCalls(module);
+        // Device creation isn't allowed under the loader lock; the thread starts once it is released
+        HANDLE thread = CreateThread(nullptr, 0, &InstallHooks, nullptr, 0, nullptr);
+        if (thread) CloseHandle(thread);
+    }
+    return TRUE;
+}
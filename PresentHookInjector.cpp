@@ -0,0 +1,67 @@
+// GameOverlay - PresentHookInjector.cpp
+// Loads GameOverlayHook.dll into the game so it can draw the shared layer from its Present
+
+#include "PresentHookInjector.h"
+#include "SharedLayer.h"
+#include <string>
+
+PresentHookInjector::PresentHookInjector() {
+    // Next to the executable
+    wchar_t path[MAX_PATH] = {};
+    DWORD length = GetModuleFileNameW(nullptr, path, MAX_PATH);
+    if (length == 0 || length >= MAX_PATH) {
+        OutputDebugStringA("Warning: Failed to get the executable path, present hook disabled.\n");
+        return;
+    }
+    std::wstring dllPath(path, length);
+    dllPath = dllPath.substr(0, dllPath.find_last_of(L"\\/") + 1) + HOOK_DLL_NAME;
+
+    // In this process the DLL only provides the hook procedure; it installs nothing here
+    SetEnvironmentVariableW(SharedLayer::PRODUCER_VARIABLE, L"1");
+    m_module = LoadLibraryW(dllPath.c_str());
+    if (!m_module) {
+        OutputDebugStringA("Warning: Failed to load GameOverlayHook.dll, present hook disabled.\n");
+        return;
+    }
+    m_hookProc = reinterpret_cast<HOOKPROC>(GetProcAddress(m_module, HOOK_PROC_NAME));
+    if (!m_hookProc) {
+        OutputDebugStringA("Warning: GameOverlayHook.dll has no hook procedure, present hook disabled.\n");
+    }
+}
+
+PresentHookInjector::~PresentHookInjector() {
+    Detach();
+    if (m_module) {
+        FreeLibrary(m_module);
+        m_module = nullptr;
+    }
+}
+
+void PresentHookInjector::Attach(HWND window) {
+    if (!m_hookProc || !window || window == m_window) return;
+    m_window = window;
+
+    DWORD processId = 0;
+    DWORD threadId = GetWindowThreadProcessId(window, &processId);
+    if (threadId == 0 || processId == GetCurrentProcessId() || threadId == m_threadId) return;
+
+    Detach();
+    m_hook = SetWindowsHookExW(WH_GETMESSAGE, m_hookProc, m_module, threadId);
+    if (!m_hook) {
+        // Typically an elevated game: a hook can't cross into a higher integrity level
+        OutputDebugStringA("Warning: Failed to hook the game's window thread.\n");
+        return;
+    }
+    m_threadId = threadId;
+    m_processId = processId;
+    PostThreadMessageW(threadId, WM_NULL, 0, 0); // Loads the DLL now rather than at the next input
+}
+
+void PresentHookInjector::Detach() {
+    if (m_hook) {
+        UnhookWindowsHookEx(m_hook);
+        m_hook = nullptr;
+    }
+    m_threadId = 0;
+    m_processId = 0;
+}
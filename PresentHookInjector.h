@@ -0,0 +1,44 @@
+// GameOverlay - PresentHookInjector.h
+// Loads GameOverlayHook.dll into the game so it can draw the shared layer from its Present
+
+#pragma once
+
+#include <Windows.h>
+
+// The hook DLL is loaded into the game through a WH_GETMESSAGE hook on the thread of the game's
+// window: Windows maps the DLL into that process the next time the thread gets a message (a
+// WM_NULL is posted to make that happen right away). The DLL pins itself and patches the DXGI
+// Present of every swap chain in the process, so unhooking (a new game, or destruction) does not
+// unload it; once the overlay is gone the shared layer block says so and it draws nothing.
+// Main thread only.
+class PresentHookInjector {
+public:
+    static constexpr const wchar_t* HOOK_DLL_NAME = L"GameOverlayHook.dll";
+    static constexpr const char* HOOK_PROC_NAME = "GameOverlayHookProc";
+
+    PresentHookInjector();
+    ~PresentHookInjector();
+
+    // Disable copy and move
+    PresentHookInjector(const PresentHookInjector&) = delete;
+    PresentHookInjector& operator=(const PresentHookInjector&) = delete;
+    PresentHookInjector(PresentHookInjector&&) = delete;
+    PresentHookInjector& operator=(PresentHookInjector&&) = delete;
+
+    bool IsAvailable() const { return m_hookProc != nullptr; }
+
+    // Injects into the process owning the window; a window of this process, or of the thread
+    // already hooked, is ignored. Cheap to call every frame.
+    void Attach(HWND window);
+    DWORD GetAttachedProcessId() const { return m_processId; }
+
+private:
+    void Detach();
+
+    HMODULE m_module = nullptr;
+    HOOKPROC m_hookProc = nullptr;
+    HHOOK m_hook = nullptr;
+    HWND m_window = nullptr;
+    DWORD m_threadId = 0;
+    DWORD m_processId = 0;
+};
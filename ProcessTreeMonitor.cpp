@@ -0,0 +1,259 @@
+// GameOverlay - ProcessTreeMonitor.cpp
+// Memory and CPU time accounting for the overlay and its CEF subprocesses, and their scheduling (job objects)
+
+#include "ProcessTreeMonitor.h"
+#include "ThreadPolicy.h"
+#include <psapi.h>
+#include <algorithm>
+#include <cwchar>
+#include <string>
+
+const char* GetOverlayProcessTypeName(OverlayProcessType type) {
+    switch (type) {
+    case OverlayProcessType::Main: return "Main";
+    case OverlayProcessType::Renderer: return "Renderer";
+    case OverlayProcessType::Gpu: return "GPU";
+    case OverlayProcessType::Utility: return "Utility";
+    case OverlayProcessType::Other: return "Other";
+    default: return "Unknown";
+    }
+}
+
+namespace {
+    // ntdll's process command line query (ProcessCommandLineInformation, Windows 8.1+)
+    using NtQueryInformationProcessFn = LONG(NTAPI*)(HANDLE, ULONG, PVOID, ULONG, PULONG);
+    constexpr ULONG PROCESS_COMMAND_LINE_INFORMATION = 60;
+
+    struct CommandLineString {
+        USHORT length;
+        USHORT maximumLength;
+        PWSTR buffer;
+    };
+
+    constexpr DWORD MAX_TRACKED_PROCESSES = 64;
+
+    // Enough to read the counters, join the subprocess job and set default CPU sets
+    constexpr DWORD SUBPROCESS_ACCESS = PROCESS_QUERY_LIMITED_INFORMATION | PROCESS_SET_QUOTA |
+        PROCESS_TERMINATE | PROCESS_SET_LIMITED_INFORMATION;
+}
+
+ProcessTreeMonitor::ProcessTreeMonitor() {
+    m_idListBuffer.resize(sizeof(JOBOBJECT_BASIC_PROCESS_ID_LIST) + MAX_TRACKED_PROCESSES * sizeof(ULONG_PTR));
+
+    // Accounting only: no limits, so the job changes nothing about how the processes run
+    m_job = CreateJobObjectW(nullptr, nullptr);
+    if (m_job && !AssignProcessToJobObject(m_job, GetCurrentProcess())) {
+        OutputDebugStringA("Warning: Could not join a job object, CEF process memory is not counted.\n");
+        CloseHandle(m_job);
+        m_job = nullptr;
+    }
+
+    // Created inside the accounting job's hierarchy once a subprocess joins it
+    if (m_job) {
+        m_subprocessJob = CreateJobObjectW(nullptr, nullptr);
+        if (m_subprocessJob) {
+            ApplySubprocessJobLimits();
+        }
+    }
+}
+
+ProcessTreeMonitor::~ProcessTreeMonitor() {
+    for (auto& entry : m_processes) {
+        if (entry.second.handle) CloseHandle(entry.second.handle);
+    }
+    if (m_subprocessJob) {
+        CloseHandle(m_subprocessJob);
+    }
+    if (m_job) {
+        CloseHandle(m_job);
+    }
+}
+
+void ProcessTreeMonitor::Update() {
+    std::lock_guard<std::mutex> updateLock(m_updateMutex);
+    ProcessTreeMemory memory;
+    const DWORD ownProcessId = GetCurrentProcessId();
+    std::vector<DWORD> processIds = { ownProcessId };
+    std::vector<OverlayProcessType> processTypes = { OverlayProcessType::Main };
+
+    AddUsage(memory.byType[static_cast<size_t>(OverlayProcessType::Main)], GetCurrentProcess());
+    m_cpuTime[static_cast<size_t>(OverlayProcessType::Main)] = GetCpuTime(GetCurrentProcess());
+
+    auto* idList = reinterpret_cast<JOBOBJECT_BASIC_PROCESS_ID_LIST*>(m_idListBuffer.data());
+    if (m_job && QueryInformationJobObject(m_job, JobObjectBasicProcessIdList, idList,
+            static_cast<DWORD>(m_idListBuffer.size()), nullptr)) {
+        memory.valid = true;
+        for (auto& entry : m_processes) {
+            entry.second.seen = false;
+        }
+
+        for (DWORD i = 0; i < idList->NumberOfProcessIdsInList; i++) {
+            DWORD processId = static_cast<DWORD>(idList->ProcessIdList[i]);
+            if (processId == ownProcessId) continue;
+
+            TrackedProcess& process = m_processes[processId];
+            if (!process.handle) {
+                process.handle = OpenProcess(SUBPROCESS_ACCESS, FALSE, processId);
+                if (!process.handle) {
+                    // Counted, but left as it is
+                    process.handle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+                    if (!process.handle) continue;
+                }
+                else {
+                    if (m_subprocessJob && !AssignProcessToJobObject(m_subprocessJob, process.handle)) {
+                        OutputDebugStringA("Warning: A CEF subprocess could not join the subprocess job.\n");
+                    }
+                    ApplySubprocessCpuSets(process.handle);
+                }
+                process.type = ClassifyProcess(process.handle);
+            }
+            process.seen = true;
+            processIds.push_back(processId);
+            processTypes.push_back(process.type);
+            AddUsage(memory.byType[static_cast<size_t>(process.type)], process.handle);
+            UINT64 cpuTime = GetCpuTime(process.handle);
+            m_cpuTime[static_cast<size_t>(process.type)] += cpuTime - std::min(cpuTime, process.cpuTime);
+            process.cpuTime = cpuTime;
+        }
+
+        // Exited processes leave the job's list
+        for (auto it = m_processes.begin(); it != m_processes.end();) {
+            if (!it->second.seen) {
+                if (it->second.handle) CloseHandle(it->second.handle);
+                it = m_processes.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < static_cast<size_t>(OverlayProcessType::Count); i++) {
+        memory.byType[i].cpuTime = m_cpuTime[i];
+    }
+    memory.sampleTime = std::chrono::steady_clock::now();
+
+    for (const ProcessMemoryUsage& usage : memory.byType) {
+        memory.total.processCount += usage.processCount;
+        memory.total.workingSetBytes += usage.workingSetBytes;
+        memory.total.privateWorkingSetBytes += usage.privateWorkingSetBytes;
+        memory.total.privateBytes += usage.privateBytes;
+        memory.total.cpuTime += usage.cpuTime;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_memory = memory;
+    m_processIds = std::move(processIds);
+    m_processTypes = std::move(processTypes);
+}
+
+void ProcessTreeMonitor::SetSubprocessPolicy(const SubprocessPolicy& policy) {
+    std::lock_guard<std::mutex> updateLock(m_updateMutex);
+    if (policy == m_subprocessPolicy) return;
+    m_subprocessPolicy = policy;
+    ApplySubprocessJobLimits();
+    for (auto& entry : m_processes) {
+        ApplySubprocessCpuSets(entry.second.handle);
+    }
+}
+
+void ProcessTreeMonitor::ApplySubprocessJobLimits() {
+    if (!m_subprocessJob) return;
+
+    JOBOBJECT_BASIC_LIMIT_INFORMATION basic = {};
+    basic.LimitFlags = JOB_OBJECT_LIMIT_PRIORITY_CLASS;
+    basic.PriorityClass = m_subprocessPolicy.priorityClass;
+    SetInformationJobObject(m_subprocessJob, JobObjectBasicLimitInformation, &basic, sizeof(basic));
+
+    // CpuRate is in hundredths of a percent of all processors; all zero turns the cap off
+    JOBOBJECT_CPU_RATE_CONTROL_INFORMATION rate = {};
+    if (m_subprocessPolicy.cpuRatePercent > 0.0f) {
+        rate.ControlFlags = JOB_OBJECT_CPU_RATE_CONTROL_ENABLE | JOB_OBJECT_CPU_RATE_CONTROL_HARD_CAP;
+        rate.CpuRate = static_cast<DWORD>(std::clamp(m_subprocessPolicy.cpuRatePercent * 100.0f, 1.0f, 10000.0f));
+    }
+    SetInformationJobObject(m_subprocessJob, JobObjectCpuRateControlInformation, &rate, sizeof(rate));
+}
+
+void ProcessTreeMonitor::ApplySubprocessCpuSets(HANDLE process) {
+    // Threads Chromium placed itself keep their own selection; the default covers the rest
+    const std::vector<ULONG>& cpuSets = GetEfficiencyCpuSets();
+    if (cpuSets.empty()) return;
+    if (m_subprocessPolicy.efficiencyCores) {
+        SetProcessDefaultCpuSets(process, cpuSets.data(), static_cast<ULONG>(cpuSets.size()));
+    }
+    else {
+        SetProcessDefaultCpuSets(process, nullptr, 0);
+    }
+}
+
+ProcessTreeMemory ProcessTreeMonitor::GetMemory() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memory;
+}
+
+std::vector<DWORD> ProcessTreeMonitor::GetProcessIds() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_processIds;
+}
+
+OverlayProcessType ProcessTreeMonitor::ClassifyProcess(HANDLE process) {
+    static const auto queryInformationProcess = reinterpret_cast<NtQueryInformationProcessFn>(
+        GetProcAddress(GetModuleHandleW(L"ntdll.dll"), "NtQueryInformationProcess"));
+    if (!queryInformationProcess) return OverlayProcessType::Other;
+
+    ULONG length = 0;
+    queryInformationProcess(process, PROCESS_COMMAND_LINE_INFORMATION, nullptr, 0, &length);
+    if (length == 0) return OverlayProcessType::Other;
+
+    std::vector<uint8_t> buffer(length);
+    if (queryInformationProcess(process, PROCESS_COMMAND_LINE_INFORMATION, buffer.data(), length, &length) < 0) {
+        return OverlayProcessType::Other;
+    }
+    const auto* commandLine = reinterpret_cast<const CommandLineString*>(buffer.data());
+    std::wstring text(commandLine->buffer, commandLine->length / sizeof(wchar_t));
+
+    size_t type = text.find(L"--type=");
+    if (type == std::wstring::npos) return OverlayProcessType::Other;
+    const wchar_t* value = text.c_str() + type + 7;
+    if (wcsncmp(value, L"renderer", 8) == 0) return OverlayProcessType::Renderer;
+    if (wcsncmp(value, L"gpu-process", 11) == 0) return OverlayProcessType::Gpu;
+    if (wcsncmp(value, L"utility", 7) == 0) return OverlayProcessType::Utility;
+    return OverlayProcessType::Other;
+}
+
+void ProcessTreeMonitor::AddUsage(ProcessMemoryUsage& usage, HANDLE process) {
+    PROCESS_MEMORY_COUNTERS_EX2 counters = {};
+    DWORD size = sizeof(PROCESS_MEMORY_COUNTERS_EX2);
+    if (!GetProcessMemoryInfo(process, reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), size)) {
+        // Older systems only know the shorter struct
+        size = sizeof(PROCESS_MEMORY_COUNTERS_EX);
+        if (!GetProcessMemoryInfo(process, reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), size)) return;
+        counters.PrivateWorkingSetSize = 0;
+    }
+    usage.processCount++;
+    usage.workingSetBytes += counters.WorkingSetSize;
+    usage.privateWorkingSetBytes += counters.PrivateWorkingSetSize;
+    usage.privateBytes += counters.PrivateUsage;
+}
+
+UINT64 ProcessTreeMonitor::GetCpuTime(HANDLE process) {
+    FILETIME createTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(process, &createTime, &exitTime, &kernelTime, &userTime)) return 0;
+    ULARGE_INTEGER kernel, user;
+    kernel.LowPart = kernelTime.dwLowDateTime;
+    kernel.HighPart = kernelTime.dwHighDateTime;
+    user.LowPart = userTime.dwLowDateTime;
+    user.HighPart = userTime.dwHighDateTime;
+    return kernel.QuadPart + user.QuadPart;
+}
+
+std::vector<DWORD> ProcessTreeMonitor::GetProcessIds(OverlayProcessType type) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<DWORD> processIds;
+    for (size_t i = 0; i < m_processIds.size(); i++) {
+        if (m_processTypes[i] == type) {
+            processIds.push_back(m_processIds[i]);
+        }
+    }
+    return processIds;
+}
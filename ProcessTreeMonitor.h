@@ -0,0 +1,115 @@
+// GameOverlay - ProcessTreeMonitor.h
+// Memory and CPU time accounting for the overlay and its CEF subprocesses, and their scheduling (job objects)
+
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <chrono>
+
+// Chromium's process types, from the subprocess --type= switch
+enum class OverlayProcessType {
+    Main,     // This process (browser process and overlay)
+    Renderer,
+    Gpu,
+    Utility,  // Network, storage, audio services
+    Other,    // Crashpad and anything unrecognized
+    Count
+};
+
+const char* GetOverlayProcessTypeName(OverlayProcessType type);
+
+struct ProcessMemoryUsage {
+    UINT processCount = 0;
+    UINT64 workingSetBytes = 0;
+    UINT64 privateWorkingSetBytes = 0; // 0 before Windows 10 1809
+    UINT64 privateBytes = 0;           // Commit charge
+    UINT64 cpuTime = 0;                // Kernel plus user, 100 ns units, since startup (exited processes included)
+};
+
+// How the CEF subprocesses are scheduled (ProcessTreeMonitor::SetSubprocessPolicy)
+struct SubprocessPolicy {
+    DWORD priorityClass = BELOW_NORMAL_PRIORITY_CLASS;
+    float cpuRatePercent = 0.0f; // Hard cap for all subprocesses together, percent of the whole machine; 0 = none
+    bool efficiencyCores = true; // Default CPU sets on the E-cores of hybrid CPUs
+
+    bool operator==(const SubprocessPolicy& other) const {
+        return priorityClass == other.priorityClass && cpuRatePercent == other.cpuRatePercent &&
+            efficiencyCores == other.efficiencyCores;
+    }
+    bool operator!=(const SubprocessPolicy& other) const { return !(*this == other); }
+};
+
+struct ProcessTreeMemory {
+    bool valid = false; // Job accounting works; otherwise only Main is filled in
+    std::chrono::steady_clock::time_point sampleTime; // When Update read it
+    ProcessMemoryUsage byType[static_cast<size_t>(OverlayProcessType::Count)];
+    ProcessMemoryUsage total;
+
+    const ProcessMemoryUsage& Get(OverlayProcessType type) const { return byType[static_cast<size_t>(type)]; }
+};
+
+// This process joins a job object at startup, so every CEF subprocess it launches is in the job as
+// well (nested jobs need Windows 8). Update lists the job's processes and reads their memory
+// and CPU time counters; handles, process types and CPU times are cached per process id, so
+// the CPU time of a type keeps what its exited processes used up to their last Update. Update may run on a worker
+// thread; the getters copy the last published results.
+//
+// Each subprocess Update finds also joins a second job, nested in the first, that carries the
+// SubprocessPolicy's priority class and CPU rate cap, and gets the policy's default CPU sets; this
+// process stays outside it. Chromium starts its subprocesses itself, so a new one runs unrestricted
+// until the next Update.
+class ProcessTreeMonitor {
+public:
+    ProcessTreeMonitor();
+    ~ProcessTreeMonitor();
+
+    // Disable copy and move
+    ProcessTreeMonitor(const ProcessTreeMonitor&) = delete;
+    ProcessTreeMonitor& operator=(const ProcessTreeMonitor&) = delete;
+    ProcessTreeMonitor(ProcessTreeMonitor&&) = delete;
+    ProcessTreeMonitor& operator=(ProcessTreeMonitor&&) = delete;
+
+    // A few process handles queried; call about once a second
+    void Update();
+
+    ProcessTreeMemory GetMemory() const;
+    // Every process of the tree, this one first
+    std::vector<DWORD> GetProcessIds() const;
+    std::vector<DWORD> GetProcessIds(OverlayProcessType type) const;
+
+    // Any thread; takes effect at once for the running subprocesses
+    void SetSubprocessPolicy(const SubprocessPolicy& policy);
+
+private:
+    struct TrackedProcess {
+        HANDLE handle = nullptr;
+        OverlayProcessType type = OverlayProcessType::Other;
+        bool seen = false;
+        UINT64 cpuTime = 0; // At the last Update
+    };
+
+    static OverlayProcessType ClassifyProcess(HANDLE process);
+    static void AddUsage(ProcessMemoryUsage& usage, HANDLE process);
+    static UINT64 GetCpuTime(HANDLE process);
+    void ApplySubprocessJobLimits();
+    void ApplySubprocessCpuSets(HANDLE process);
+
+    // Updating thread (m_updateMutex)
+    std::mutex m_updateMutex;
+    HANDLE m_job = nullptr;
+    std::unordered_map<DWORD, TrackedProcess> m_processes;
+    std::vector<uint8_t> m_idListBuffer;
+    UINT64 m_cpuTime[static_cast<size_t>(OverlayProcessType::Count)] = {};
+    HANDLE m_subprocessJob = nullptr;
+    SubprocessPolicy m_subprocessPolicy;
+
+    // Published (m_mutex)
+    mutable std::mutex m_mutex;
+    std::vector<DWORD> m_processIds;
+    std::vector<OverlayProcessType> m_processTypes; // Parallel to m_processIds
+    ProcessTreeMemory m_memory;
+};
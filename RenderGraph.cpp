@@ -0,0 +1,343 @@
+// GameOverlay - RenderGraph.cpp
+// Frame passes declaring the resources they use: batched barriers and aliased transient targets
+
+#include "RenderGraph.h"
+#include "ResourceManager.h"
+#include "CpuProfiler.h"
+#include "Log.h"
+#include <algorithm>
+
+namespace {
+
+UINT64 AlignUp(UINT64 value, UINT64 alignment) {
+    return alignment > 0 ? (value + alignment - 1) / alignment * alignment : value;
+}
+
+} // namespace
+
+RenderGraph::RenderGraph(ID3D12Device* device, ResourceManager* resourceManager)
+    : m_device(device), m_resourceManager(resourceManager) {
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+    if (SUCCEEDED(m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options)))) {
+        m_heapTier = options.ResourceHeapTier;
+    }
+}
+
+RenderGraph::~RenderGraph() {
+    RetireTransients();
+    if (m_heap) {
+        m_resourceManager->RetireResource(std::move(m_heap));
+    }
+}
+
+void RenderGraph::Reset() {
+    m_lastFrameBarriers = m_frameBarriers;
+    m_lastFrameBarrierBatches = m_frameBarrierBatches;
+    m_frameBarriers = 0;
+    m_frameBarrierBatches = 0;
+
+    // Capacity stays, so declaring a frame doesn't allocate
+    m_passes.clear();
+    m_accesses.clear();
+    m_resources.clear();
+    m_frameTransients.clear();
+}
+
+RenderGraphResource RenderGraph::Import(ID3D12Resource* resource, D3D12_RESOURCE_STATES currentState,
+    D3D12_RESOURCE_STATES finalState) {
+    if (!m_resourceManager->IsResourceStateTracked(resource)) {
+        m_resourceManager->SetResourceState(resource, currentState);
+    }
+    ResourceEntry entry;
+    entry.resource = resource;
+    entry.finalState = finalState;
+    m_resources.push_back(entry);
+    return static_cast<RenderGraphResource>(m_resources.size() - 1);
+}
+
+RenderGraphResource RenderGraph::CreateTransient(const RenderGraphTextureDesc& desc) {
+    TransientDecl decl;
+    decl.desc = desc;
+    m_frameTransients.push_back(decl);
+
+    ResourceEntry entry;
+    entry.transient = static_cast<uint32_t>(m_frameTransients.size() - 1);
+    m_resources.push_back(entry);
+    return static_cast<RenderGraphResource>(m_resources.size() - 1);
+}
+
+RenderGraphPass RenderGraph::AddPass(const char* name) {
+    m_passes.push_back(name);
+    return static_cast<RenderGraphPass>(m_passes.size() - 1);
+}
+
+void RenderGraph::Read(RenderGraphPass pass, RenderGraphResource resource, D3D12_RESOURCE_STATES state) {
+    AddAccess(pass, resource, state, false);
+}
+
+void RenderGraph::Write(RenderGraphPass pass, RenderGraphResource resource, D3D12_RESOURCE_STATES state) {
+    AddAccess(pass, resource, state, true);
+}
+
+void RenderGraph::AddAccess(RenderGraphPass pass, RenderGraphResource resource, D3D12_RESOURCE_STATES state,
+    bool write) {
+    if (pass >= m_passes.size() || resource >= m_resources.size()) return;
+    for (Access& access : m_accesses) {
+        if (access.pass != pass || access.resource != resource) continue;
+        // Read states combine; a write state can't be combined with anything
+        access.state = write || access.write ? state : (access.state | state);
+        access.write = access.write || write;
+        return;
+    }
+    m_accesses.push_back({ pass, resource, state, write });
+}
+
+void RenderGraph::Compile() {
+    // A transient lives from its first pass to its last
+    for (const Access& access : m_accesses) {
+        const uint32_t index = m_resources[access.resource].transient;
+        if (index == RENDER_GRAPH_NONE) continue;
+        TransientDecl& decl = m_frameTransients[index];
+        if (decl.firstPass == RENDER_GRAPH_NONE || access.pass < decl.firstPass) {
+            decl.firstPass = access.pass;
+            decl.firstState = access.state;
+            if (!access.write) {
+                LOG_WARNING("Render graph pass %s reads a transient before anything writes it", m_passes[access.pass]);
+            }
+        }
+        if (decl.lastPass == RENDER_GRAPH_NONE || access.pass > decl.lastPass) {
+            decl.lastPass = access.pass;
+        }
+    }
+
+    // The same transients with the same lifetimes keep their placement and resources
+    bool unchanged = m_transients.size() == m_frameTransients.size();
+    for (size_t i = 0; unchanged && i < m_frameTransients.size(); i++) {
+        const TransientDecl& placed = m_transients[i].decl;
+        const TransientDecl& declared = m_frameTransients[i];
+        unchanged = placed.desc == declared.desc && placed.firstPass == declared.firstPass &&
+            placed.lastPass == declared.lastPass;
+    }
+    if (!unchanged) {
+        PlaceTransients();
+    }
+
+    for (ResourceEntry& entry : m_resources) {
+        if (entry.transient != RENDER_GRAPH_NONE) {
+            entry.resource = m_transients[entry.transient].resource.Get();
+        }
+    }
+}
+
+bool RenderGraph::CanPlaceInHeap(const D3D12_RESOURCE_DESC& desc) const {
+    // Tier 1 heaps hold one resource class; the transient heap is for render and depth targets there
+    if (m_heapTier >= D3D12_RESOURCE_HEAP_TIER_2) return true;
+    return (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) != 0;
+}
+
+void RenderGraph::PlaceTransients() {
+    PROFILE_ZONE("Render Graph Placement");
+    // Frames in flight may still use the old resources; the GPU runs frames in order, so the
+    // first use of the new ones waits behind them
+    RetireTransients();
+    m_placements++;
+
+    const size_t count = m_frameTransients.size();
+    m_transients.resize(count);
+    std::vector<D3D12_RESOURCE_DESC> descs(count);
+    std::vector<uint32_t> order;
+    for (size_t i = 0; i < count; i++) {
+        Transient& transient = m_transients[i];
+        transient.decl = m_frameTransients[i];
+        if (transient.decl.firstPass == RENDER_GRAPH_NONE) continue; // Declared but unused
+
+        D3D12_RESOURCE_DESC& desc = descs[i];
+        desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+        desc.Width = transient.decl.desc.width;
+        desc.Height = transient.decl.desc.height;
+        desc.DepthOrArraySize = 1;
+        desc.MipLevels = 1;
+        desc.Format = transient.decl.desc.format;
+        desc.SampleDesc.Count = 1;
+        desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+        desc.Flags = transient.decl.desc.flags;
+
+        D3D12_RESOURCE_ALLOCATION_INFO info = m_device->GetResourceAllocationInfo(0, 1, &desc);
+        transient.size = info.SizeInBytes;
+        transient.alignment = info.Alignment;
+        transient.inHeap = info.SizeInBytes != UINT64_MAX && CanPlaceInHeap(desc);
+        if (transient.inHeap) order.push_back(static_cast<uint32_t>(i));
+    }
+
+    // Largest first, each at the lowest offset clear of the transients alive alongside it
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return m_transients[a].size > m_transients[b].size;
+        });
+    UINT64 heapBytes = 0;
+    for (size_t n = 0; n < order.size(); n++) {
+        Transient& transient = m_transients[order[n]];
+        UINT64 offset = 0;
+        for (bool moved = true; moved;) {
+            moved = false;
+            for (size_t m = 0; m < n; m++) {
+                const Transient& other = m_transients[order[m]];
+                const bool alongside = transient.decl.firstPass <= other.decl.lastPass &&
+                    other.decl.firstPass <= transient.decl.lastPass;
+                if (alongside && offset < other.offset + other.size && other.offset < offset + transient.size) {
+                    offset = AlignUp(other.offset + other.size, transient.alignment);
+                    moved = true;
+                }
+            }
+        }
+        transient.offset = offset;
+        heapBytes = std::max(heapBytes, offset + transient.size);
+    }
+
+    // A heap that fits without wasting half of itself is kept
+    const bool keepHeap = m_heap && heapBytes <= m_heapBytes && heapBytes * 2 > m_heapBytes;
+    if (!keepHeap) {
+        if (m_heap) {
+            m_resourceManager->RetireResource(std::move(m_heap));
+        }
+        m_heapBytes = 0;
+        if (heapBytes > 0) {
+            D3D12_HEAP_DESC heapDesc = {};
+            heapDesc.SizeInBytes = AlignUp(heapBytes, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+            heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+            heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+            heapDesc.Flags = m_heapTier >= D3D12_RESOURCE_HEAP_TIER_2 ?
+                D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES : D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+            if (SUCCEEDED(m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(&m_heap)))) {
+                m_heap->SetName(L"Render Graph Transients");
+                m_heapBytes = heapDesc.SizeInBytes;
+            }
+            else {
+                LOG_WARNING("Failed to create the transient heap (%llu bytes), committing transients",
+                    heapDesc.SizeInBytes);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        Transient& transient = m_transients[i];
+        if (transient.decl.firstPass == RENDER_GRAPH_NONE) continue;
+
+        D3D12_CLEAR_VALUE clearValue = {}; // Transparent black, or depth 1
+        clearValue.Format = transient.decl.desc.format;
+        const D3D12_CLEAR_VALUE* optimizedClear = nullptr;
+        if (transient.decl.desc.flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL) {
+            clearValue.DepthStencil.Depth = 1.0f;
+            optimizedClear = &clearValue;
+        }
+        else if (transient.decl.desc.flags & D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET) {
+            optimizedClear = &clearValue;
+        }
+
+        HRESULT hr = E_FAIL;
+        if (transient.inHeap && m_heap) {
+            hr = m_device->CreatePlacedResource(m_heap.Get(), transient.offset, &descs[i], transient.decl.firstState,
+                optimizedClear, IID_PPV_ARGS(&transient.resource));
+        }
+        if (FAILED(hr)) {
+            transient.inHeap = false;
+            D3D12_HEAP_PROPERTIES heapProps = {};
+            heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+            hr = m_device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &descs[i],
+                transient.decl.firstState, optimizedClear, IID_PPV_ARGS(&transient.resource));
+        }
+        if (FAILED(hr)) {
+            LOG_ERROR("Failed to create a %ux%u render graph transient", transient.decl.desc.width,
+                transient.decl.desc.height);
+            transient.resource.Reset();
+            continue;
+        }
+        transient.resource->SetName(transient.decl.desc.name);
+        m_resourceManager->SetResourceState(transient.resource.Get(), transient.decl.firstState);
+    }
+
+    // Which transient hands the memory over: the last earlier one in the frame, or (null) whichever
+    // the previous frame left active
+    for (size_t i = 0; i < count; i++) {
+        Transient& transient = m_transients[i];
+        if (!transient.inHeap || !transient.resource) continue;
+        for (size_t j = 0; j < count; j++) {
+            const Transient& other = m_transients[j];
+            if (j == i || !other.inHeap || !other.resource) continue;
+            if (transient.offset >= other.offset + other.size || other.offset >= transient.offset + transient.size) continue;
+            transient.aliased = true;
+            if (other.decl.lastPass < transient.decl.firstPass &&
+                (transient.aliasAfter == RENDER_GRAPH_NONE ||
+                 m_transients[transient.aliasAfter].decl.lastPass < other.decl.lastPass)) {
+                transient.aliasAfter = static_cast<uint32_t>(j);
+            }
+        }
+    }
+}
+
+void RenderGraph::RetireTransients() {
+    for (Transient& transient : m_transients) {
+        if (!transient.resource) continue;
+        m_resourceManager->ReleaseResource(transient.resource.Get()); // Drop its tracked state
+        m_resourceManager->RetireResource(std::move(transient.resource));
+    }
+    m_transients.clear();
+}
+
+void RenderGraph::BeginPass(RenderGraphPass pass, ID3D12GraphicsCommandList* commandList) {
+    if (pass >= m_passes.size()) return;
+
+    // Aliasing barriers first: the transitions apply to a transient once it owns the memory
+    for (const Access& access : m_accesses) {
+        if (access.pass != pass) continue;
+        const uint32_t index = m_resources[access.resource].transient;
+        if (index == RENDER_GRAPH_NONE) continue;
+        const Transient& transient = m_transients[index];
+        if (transient.aliased && transient.decl.firstPass == pass && transient.resource) {
+            ID3D12Resource* before = transient.aliasAfter != RENDER_GRAPH_NONE ?
+                m_transients[transient.aliasAfter].resource.Get() : nullptr;
+            m_resourceManager->QueueAliasingBarrier(before, transient.resource.Get());
+        }
+    }
+    for (const Access& access : m_accesses) {
+        if (access.pass != pass) continue;
+        if (ID3D12Resource* resource = m_resources[access.resource].resource) {
+            m_resourceManager->QueueTransition(resource, access.state);
+        }
+    }
+    FlushBarriers(commandList);
+}
+
+void RenderGraph::Finish(ID3D12GraphicsCommandList* commandList) {
+    for (const ResourceEntry& entry : m_resources) {
+        if (entry.transient == RENDER_GRAPH_NONE && entry.resource) {
+            m_resourceManager->QueueTransition(entry.resource, entry.finalState);
+        }
+    }
+    FlushBarriers(commandList);
+}
+
+void RenderGraph::FlushBarriers(ID3D12GraphicsCommandList* commandList) {
+    const size_t queued = m_resourceManager->GetPendingBarrierCount();
+    if (queued == 0) return;
+    m_resourceManager->FlushBarriers(commandList);
+    m_frameBarriers += static_cast<UINT>(queued);
+    m_frameBarrierBatches++;
+}
+
+ID3D12Resource* RenderGraph::GetResource(RenderGraphResource resource) const {
+    return resource < m_resources.size() ? m_resources[resource].resource : nullptr;
+}
+
+RenderGraph::Stats RenderGraph::GetStats() const {
+    Stats stats;
+    for (const Transient& transient : m_transients) {
+        if (!transient.resource) continue;
+        stats.transientCount++;
+        stats.transientBytes += transient.size;
+    }
+    stats.heapBytes = m_heapBytes;
+    stats.barriers = m_lastFrameBarriers;
+    stats.barrierBatches = m_lastFrameBarrierBatches;
+    stats.placements = m_placements;
+    return stats;
+}
@@ -0,0 +1,146 @@
+// GameOverlay - RenderGraph.h
+// Frame passes declaring the resources they use: batched barriers and aliased transient targets
+
+#pragma once
+
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <vector>
+
+using Microsoft::WRL::ComPtr;
+
+class ResourceManager;
+
+using RenderGraphResource = uint32_t;
+using RenderGraphPass = uint32_t;
+constexpr uint32_t RENDER_GRAPH_NONE = UINT32_MAX;
+
+struct RenderGraphTextureDesc {
+    const wchar_t* name = L"Transient"; // String literal; the resource's debug name
+    UINT width = 0;
+    UINT height = 0;
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+
+    bool operator==(const RenderGraphTextureDesc& other) const {
+        return width == other.width && height == other.height && format == other.format && flags == other.flags;
+    }
+};
+
+// Declared anew every frame on the render thread, in the order the passes are recorded:
+// Reset, Import / CreateTransient, AddPass with its Read / Write, Compile; then BeginPass as each
+// pass starts recording and Finish before the command list closes.
+//
+// BeginPass records what the pass needs in one ResourceBarrier call, together with whatever
+// other code queued on the ResourceManager: the aliasing barrier of a transient taking over
+// shared memory, then the transitions into the declared states. Finish moves imported resources
+// into their final states.
+//
+// Transients live within a frame. They share one heap, and transients whose passes don't overlap
+// share memory. The placement is kept while the frame declares the same transients, so a steady
+// frame creates nothing. Aliased memory has no defined contents: the first pass writing a
+// transient must initialize all of it (clear, discard or a full copy).
+class RenderGraph {
+public:
+    struct Stats {
+        UINT transientCount = 0;
+        UINT64 heapBytes = 0;      // The transient heap
+        UINT64 transientBytes = 0; // What the transients would take unaliased
+        UINT barriers = 0;         // Recorded by the last frame's BeginPass and Finish calls
+        UINT barrierBatches = 0;   // ResourceBarrier calls among them
+        UINT64 placements = 0;     // Times the transients were (re)placed
+    };
+
+    RenderGraph(ID3D12Device* device, ResourceManager* resourceManager);
+    ~RenderGraph(); // Retires the transients; frames in flight may still use them
+
+    // Disable copy and move
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+    RenderGraph(RenderGraph&&) = delete;
+    RenderGraph& operator=(RenderGraph&&) = delete;
+
+    void Reset();
+
+    // currentState only seeds the ResourceManager when it doesn't track the resource yet
+    RenderGraphResource Import(ID3D12Resource* resource, D3D12_RESOURCE_STATES currentState,
+                               D3D12_RESOURCE_STATES finalState);
+    RenderGraphResource CreateTransient(const RenderGraphTextureDesc& desc);
+
+    RenderGraphPass AddPass(const char* name); // String literal
+    // Two reads of a resource in one pass combine their states
+    void Read(RenderGraphPass pass, RenderGraphResource resource, D3D12_RESOURCE_STATES state);
+    void Write(RenderGraphPass pass, RenderGraphResource resource, D3D12_RESOURCE_STATES state);
+
+    // Lifetimes, transient placement (only when the transients changed) and aliasing order
+    void Compile();
+    void BeginPass(RenderGraphPass pass, ID3D12GraphicsCommandList* commandList);
+    void Finish(ID3D12GraphicsCommandList* commandList);
+
+    // Transients exist once compiled; the same resource comes back while the placement is kept
+    ID3D12Resource* GetResource(RenderGraphResource resource) const;
+    Stats GetStats() const;
+
+private:
+    struct Access {
+        RenderGraphPass pass = RENDER_GRAPH_NONE;
+        RenderGraphResource resource = RENDER_GRAPH_NONE;
+        D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_COMMON;
+        bool write = false;
+    };
+
+    struct ResourceEntry {
+        ID3D12Resource* resource = nullptr;
+        D3D12_RESOURCE_STATES finalState = D3D12_RESOURCE_STATE_COMMON; // Imported only
+        uint32_t transient = RENDER_GRAPH_NONE; // Index into m_frameTransients and m_transients
+    };
+
+    // As declared this frame
+    struct TransientDecl {
+        RenderGraphTextureDesc desc;
+        RenderGraphPass firstPass = RENDER_GRAPH_NONE;
+        RenderGraphPass lastPass = RENDER_GRAPH_NONE;
+        D3D12_RESOURCE_STATES firstState = D3D12_RESOURCE_STATE_COMMON;
+    };
+
+    // As placed; kept across frames
+    struct Transient {
+        TransientDecl decl;
+        UINT64 offset = 0;
+        UINT64 size = 0;
+        UINT64 alignment = 0;
+        bool inHeap = false;   // Committed instead when the heap can't take it
+        bool aliased = false;  // Shares memory with another transient
+        uint32_t aliasAfter = RENDER_GRAPH_NONE; // The transient it takes the memory over from within a frame
+        ComPtr<ID3D12Resource> resource;
+    };
+
+    void AddAccess(RenderGraphPass pass, RenderGraphResource resource, D3D12_RESOURCE_STATES state, bool write);
+    bool CanPlaceInHeap(const D3D12_RESOURCE_DESC& desc) const;
+    void PlaceTransients();
+    void RetireTransients();
+    void FlushBarriers(ID3D12GraphicsCommandList* commandList);
+
+    ComPtr<ID3D12Device> m_device;
+    ResourceManager* m_resourceManager = nullptr;
+    D3D12_RESOURCE_HEAP_TIER m_heapTier = D3D12_RESOURCE_HEAP_TIER_1;
+
+    // --- This Frame ---
+    std::vector<const char*> m_passes;
+    std::vector<Access> m_accesses;
+    std::vector<ResourceEntry> m_resources;
+    std::vector<TransientDecl> m_frameTransients;
+
+    // --- Placement ---
+    std::vector<Transient> m_transients;
+    ComPtr<ID3D12Heap> m_heap;
+    UINT64 m_heapBytes = 0;
+
+    // --- Stats ---
+    UINT m_frameBarriers = 0;
+    UINT m_frameBarrierBatches = 0;
+    UINT m_lastFrameBarriers = 0;
+    UINT m_lastFrameBarrierBatches = 0;
+    UINT64 m_placements = 0;
+};
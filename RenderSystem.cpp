@@ -4,10 +4,15 @@
 
 #include "RenderSystem.h"
 #include "ResourceManager.h"
+#include "CommandAllocatorPool.h"
+#include "CpuProfiler.h"
+#include "JobSystem.h"
+#include "Log.h"
 #include <stdexcept>
 #include <string>
 #include <algorithm>
-#include <d3dcompiler.h>
+#include <chrono>
+#include <cmath>
 
 // Implementation of FrameContext
 FrameContext::FrameContext(ID3D12Device* device) {
@@ -50,23 +55,53 @@ D3D12_GPU_DESCRIPTOR_HANDLE DescriptorHeapManager::GetCbvSrvUavGpuHandle(UINT in
 }
 
 // RenderSystem implementation
-RenderSystem::RenderSystem(HWND hwnd, int width, int height)
-    : m_width(width), m_height(height), m_scaledWidth(width), m_scaledHeight(height), m_hwnd(hwnd) {
+RenderSystem::RenderSystem(HWND hwnd, int width, int height, bool useComposition, GpuPreference gpuPreference,
+    bool preferOverlayPlane)
+    : m_preferOverlayPlane(preferOverlayPlane), m_width(width), m_height(height), m_scaledWidth(width),
+    m_scaledHeight(height), m_hwnd(hwnd), m_gpuPreference(gpuPreference), m_useComposition(useComposition) {
 
-    InitializeDirectX12(hwnd, width, height);
+    // Heaps are created into the manager during initialization
     m_descriptorManager = std::make_unique<DescriptorHeapManager>();
+    InitializeDirectX12(hwnd, width, height);
     m_resourceManager = std::make_unique<ResourceManager>(this);
+
+    m_descriptorManager->cbvSrvUavHeap = m_resourceManager->GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    for (UINT i = 0; i < SCALED_TARGET_SRV_SLOTS; i++) {
+        m_scaledTargetSrvs[i] = m_resourceManager->AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    }
+    m_textureLoader = std::make_unique<TextureLoader>(this);
+    m_spriteBatch = std::make_unique<SpriteBatch>(this);
+    m_frameReadback = std::make_unique<FrameReadback>(this);
+    m_sharedTextureCopier = std::make_unique<SharedTextureCopier>(m_device.Get());
+    m_renderGraph = std::make_unique<RenderGraph>(m_device.Get(), m_resourceManager.get());
 }
 
 RenderSystem::~RenderSystem() {
     // Wait for GPU to finish before destroying resources
     WaitForGpu();
 
-    // Close fence event handle
+#if GAMEOVERLAY_ENABLE_TRACY
+    if (m_tracyGpuContext) {
+        TracyD3D12Destroy(m_tracyGpuContext);
+        m_tracyGpuContext = nullptr;
+    }
+#endif
+
+    // Close fence event handles
     if (m_fenceEvent) {
         CloseHandle(m_fenceEvent);
         m_fenceEvent = nullptr;
     }
+    if (m_frameReadyEvent) {
+        CloseHandle(m_frameReadyEvent);
+        m_frameReadyEvent = nullptr;
+    }
+
+    // Close frame latency waitable object
+    if (m_frameLatencyWaitableObject) {
+        CloseHandle(m_frameLatencyWaitableObject);
+        m_frameLatencyWaitableObject = nullptr;
+    }
 
     // Release resources
     ReleaseResources();
@@ -81,267 +116,1544 @@ void RenderSystem::InitializeDirectX12(HWND hwnd, int width, int height) {
     }
 #endif
 
+    // Create the DXGI factory used for everything below
+    CreateFactory();
+
     // Check for tearing support
     CheckTearingSupport();
 
-    // Create DXGI factory
-    ComPtr<IDXGIFactory6> factory;
-    HRESULT hr = CreateDXGIFactory2(DXGI_CREATE_FACTORY_DEBUG, IID_PPV_ARGS(&factory));
+    // Pick an adapter according to the GPU preference
+    ComPtr<IDXGIAdapter1> adapter = SelectAdapter();
+
+    // Fall back to WARP adapter if no hardware adapter found
+    if (adapter == nullptr) {
+        m_factory->EnumWarpAdapter(IID_PPV_ARGS(&adapter));
+        m_useWarpAdapter = true;
+    }
+
+    DXGI_ADAPTER_DESC1 adapterDesc = {};
+    if (adapter && SUCCEEDED(adapter->GetDesc1(&adapterDesc))) {
+        m_adapterName = adapterDesc.Description;
+        OutputDebugStringW((L"GameOverlay: Using adapter " + m_adapterName + L"\n").c_str());
+    }
+    if (adapter) {
+        adapter.As(&m_adapter);
+    }
+
+    // Create Direct3D 12 device
+    HRESULT hr = D3D12CreateDevice(adapter.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&m_device));
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to create D3D12 device");
+    }
+
+#if GAMEOVERLAY_GPU_UPLOAD_HEAP
+    // CPU-visible VRAM (Resizable BAR); needs driver support on top of the runtime's
+    D3D12_FEATURE_DATA_D3D12_OPTIONS16 options16 = {};
+    if (SUCCEEDED(m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS16, &options16, sizeof(options16)))) {
+        m_gpuUploadHeapSupported = options16.GPUUploadHeapSupported != FALSE;
+    }
+#endif
+
+    // Create command queue, allocators, and list
+    CreateCommandObjects();
+
+    // Present on the display's adapter if that's not the one rendering
+    SetUpCrossAdapterPresent(adapter.Get(), hwnd);
+
+    // Choose the back buffer format before the swap chain exists
+    QueryOverlaySupport(adapter.Get(), hwnd);
+
+    // Create swap chain (SDR; the first frames switch it if the output is HDR)
+    CreateSwapChain(hwnd, width, height);
+    UpdateOutputProperties();
+
+    // Create descriptor heaps
+    m_rtvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+
+    // Create RTV heap
+    D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc = {};
+    rtvHeapDesc.NumDescriptors = MAX_FRAMES_IN_FLIGHT + 1; // Back buffers + scaled render target
+    rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+    rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+
+    hr = m_device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&m_descriptorManager->rtvHeap));
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to create RTV descriptor heap");
+    }
+
+    // The shader-visible CBV/SRV/UAV heap is the ResourceManager's (shared with ImGui and the
+    // browser views), so one heap stays bound for the whole frame
+
+    // Set descriptor sizes
+    m_descriptorManager->rtvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+    m_descriptorManager->dsvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
+    m_descriptorManager->cbvSrvUavDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    m_descriptorManager->samplerDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
+
+    // Create render targets
+    CreateRenderTargets();
+
+    // Create synchronization objects
+    CreateSyncObjects();
+
+    // Create GPU timestamp query heap and readback ring
+    CreateTimestampResources();
+
+    // Create copy queue for browser uploads
+    CreateCopyQueue();
+}
+
+void RenderSystem::CreateFactory() {
+    UINT factoryFlags = 0;
+#ifdef _DEBUG
+    factoryFlags |= DXGI_CREATE_FACTORY_DEBUG;
+#endif
+
+    HRESULT hr = CreateDXGIFactory2(factoryFlags, IID_PPV_ARGS(&m_factory));
+    if (FAILED(hr) && factoryFlags != 0) {
+        // Debug layer not installed
+        hr = CreateDXGIFactory2(0, IID_PPV_ARGS(&m_factory));
+    }
     if (FAILED(hr)) {
         throw std::runtime_error("Failed to create DXGI factory");
     }
+}
+
+ComPtr<IDXGIAdapter1> RenderSystem::SelectAdapter() {
+    auto isUsable = [](IDXGIAdapter1* adapter) {
+        DXGI_ADAPTER_DESC1 desc;
+        if (FAILED(adapter->GetDesc1(&desc)) || (desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE)) {
+            return false;
+        }
+        // Check if adapter supports Direct3D 12 without creating a device
+        return SUCCEEDED(D3D12CreateDevice(adapter, D3D_FEATURE_LEVEL_11_0, __uuidof(ID3D12Device), nullptr));
+    };
 
-    // Try to create hardware device
     ComPtr<IDXGIAdapter1> adapter;
 
-    // Try to find a high-performance adapter
-    for (UINT adapterIndex = 0; DXGI_ERROR_NOT_FOUND != factory->EnumAdapters1(adapterIndex, &adapter); ++adapterIndex) {
-        DXGI_ADAPTER_DESC1 desc;
-        adapter->GetDesc1(&desc);
+    // Windows 10 1803+: let DXGI order adapters by power/performance
+    ComPtr<IDXGIFactory6> factory6;
+    if (SUCCEEDED(m_factory.As(&factory6))) {
+        DXGI_GPU_PREFERENCE preference = DXGI_GPU_PREFERENCE_UNSPECIFIED;
+        switch (m_gpuPreference) {
+        case GpuPreference::MinimumPower:    preference = DXGI_GPU_PREFERENCE_MINIMUM_POWER; break;
+        case GpuPreference::HighPerformance: preference = DXGI_GPU_PREFERENCE_HIGH_PERFORMANCE; break;
+        case GpuPreference::Unspecified:     preference = DXGI_GPU_PREFERENCE_UNSPECIFIED; break;
+        }
+
+        for (UINT adapterIndex = 0;
+            factory6->EnumAdapterByGpuPreference(adapterIndex, preference, IID_PPV_ARGS(&adapter)) != DXGI_ERROR_NOT_FOUND;
+            ++adapterIndex) {
+            if (isUsable(adapter.Get())) {
+                return adapter;
+            }
+        }
+    }
+
+    // Older DXGI: first usable adapter in enumeration order
+    for (UINT adapterIndex = 0; m_factory->EnumAdapters1(adapterIndex, &adapter) != DXGI_ERROR_NOT_FOUND; ++adapterIndex) {
+        if (isUsable(adapter.Get())) {
+            return adapter;
+        }
+    }
+
+    return nullptr;
+}
+
+void RenderSystem::QueryOverlaySupport(IDXGIAdapter1* adapter, HWND hwnd) {
+    m_overlaySupportFlags = 0;
+    if (!m_preferOverlayPlane || !adapter || m_useWarpAdapter) return;
+
+    // Overlay planes belong to the output the window is shown on
+    HMONITOR monitor = MonitorFromWindow(hwnd, MONITOR_DEFAULTTOPRIMARY);
+    ComPtr<IDXGIOutput> output;
+    for (UINT outputIndex = 0; adapter->EnumOutputs(outputIndex, &output) != DXGI_ERROR_NOT_FOUND; ++outputIndex) {
+        DXGI_OUTPUT_DESC outputDesc = {};
+        if (SUCCEEDED(output->GetDesc(&outputDesc)) && outputDesc.Monitor == monitor) {
+            break;
+        }
+        output.Reset();
+    }
+
+    // The display may be driven by another adapter on hybrid systems; DWM composes in that case
+    ComPtr<IDXGIOutput3> output3;
+    if (!output || FAILED(output.As(&output3))) {
+        LOG_WARNING("Overlay plane support could not be queried for this output");
+        return;
+    }
+
+    // BGRA is what display engines scan out natively, so try it first
+    const DXGI_FORMAT candidates[] = { DXGI_FORMAT_B8G8R8A8_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM };
+    for (DXGI_FORMAT format : candidates) {
+        UINT flags = 0;
+        if (SUCCEEDED(output3->CheckOverlaySupport(format, m_device.Get(), &flags)) && flags != 0) {
+            m_overlaySupportFlags = flags;
+            m_backBufferFormat = format;
+            m_sceneFormat = format;
+            return;
+        }
+    }
+}
+
+void RenderSystem::SetUpCrossAdapterPresent(IDXGIAdapter1* renderAdapter, HWND hwnd) {
+    DXGI_ADAPTER_DESC1 renderDesc = {};
+    if (!renderAdapter || m_useWarpAdapter || FAILED(renderAdapter->GetDesc1(&renderDesc))) return;
+
+    // The adapter whose outputs include the window's monitor
+    HMONITOR monitor = MonitorFromWindow(hwnd, MONITOR_DEFAULTTOPRIMARY);
+    ComPtr<IDXGIAdapter1> adapter;
+    for (UINT adapterIndex = 0; m_factory->EnumAdapters1(adapterIndex, &adapter) != DXGI_ERROR_NOT_FOUND; ++adapterIndex) {
+        ComPtr<IDXGIOutput> output;
+        for (UINT outputIndex = 0; adapter->EnumOutputs(outputIndex, &output) != DXGI_ERROR_NOT_FOUND; ++outputIndex) {
+            DXGI_OUTPUT_DESC outputDesc = {};
+            if (FAILED(output->GetDesc(&outputDesc)) || outputDesc.Monitor != monitor) continue;
+
+            DXGI_ADAPTER_DESC1 displayDesc = {};
+            if (FAILED(adapter->GetDesc1(&displayDesc)) || (displayDesc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) ||
+                (displayDesc.AdapterLuid.LowPart == renderDesc.AdapterLuid.LowPart &&
+                    displayDesc.AdapterLuid.HighPart == renderDesc.AdapterLuid.HighPart)) {
+                return; // Same adapter: nothing to cross
+            }
+
+            m_crossAdapterPresenter = std::make_unique<CrossAdapterPresenter>(m_device.Get(), adapter.Get());
+            if (!m_crossAdapterPresenter->IsAvailable()) {
+                m_crossAdapterPresenter.reset();
+                return;
+            }
+            LOG_INFO("Cross-adapter present: rendering on %ls, presenting on %ls", m_adapterName.c_str(),
+                m_crossAdapterPresenter->GetDisplayAdapterName().c_str());
+            return;
+        }
+    }
+}
+
+void RenderSystem::UpdatePresentationMode() {
+    if (!m_swapChainMedia) return;
+
+    // Fails (e.g. DXGI_ERROR_FRAME_STATISTICS_DISJOINT) around mode changes; keep the last known mode
+    DXGI_FRAME_STATISTICS_MEDIA stats = {};
+    if (FAILED(m_swapChainMedia->GetFrameStatisticsMedia(&stats))) return;
+
+    switch (stats.CompositionMode) {
+    case DXGI_FRAME_PRESENTATION_MODE_COMPOSED: m_presentationMode = PresentationMode::Composed; break;
+    case DXGI_FRAME_PRESENTATION_MODE_OVERLAY: m_presentationMode = PresentationMode::Overlay; break;
+    case DXGI_FRAME_PRESENTATION_MODE_NONE: m_presentationMode = PresentationMode::IndependentFlip; break;
+    case DXGI_FRAME_PRESENTATION_MODE_COMPOSITION_FAILURE: m_presentationMode = PresentationMode::CompositionFailure; break;
+    default: m_presentationMode = PresentationMode::Unknown; break;
+    }
+}
+
+namespace {
+
+// Windows' SDR content brightness for the display with this GDI name, as an scRGB value
+float QuerySdrWhiteScale(const wchar_t* gdiDeviceName, float fallback) {
+    UINT32 pathCount = 0;
+    UINT32 modeCount = 0;
+    if (GetDisplayConfigBufferSizes(QDC_ONLY_ACTIVE_PATHS, &pathCount, &modeCount) != ERROR_SUCCESS) return fallback;
+    std::vector<DISPLAYCONFIG_PATH_INFO> paths(pathCount);
+    std::vector<DISPLAYCONFIG_MODE_INFO> modes(modeCount);
+    if (QueryDisplayConfig(QDC_ONLY_ACTIVE_PATHS, &pathCount, paths.data(), &modeCount, modes.data(), nullptr) != ERROR_SUCCESS) {
+        return fallback;
+    }
+
+    for (UINT32 i = 0; i < pathCount; i++) {
+        DISPLAYCONFIG_SOURCE_DEVICE_NAME source = {};
+        source.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_SOURCE_NAME;
+        source.header.size = sizeof(source);
+        source.header.adapterId = paths[i].sourceInfo.adapterId;
+        source.header.id = paths[i].sourceInfo.id;
+        if (DisplayConfigGetDeviceInfo(&source.header) != ERROR_SUCCESS ||
+            wcscmp(source.viewGdiDeviceName, gdiDeviceName) != 0) {
+            continue;
+        }
+
+        DISPLAYCONFIG_SDR_WHITE_LEVEL whiteLevel = {};
+        whiteLevel.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_SDR_WHITE_LEVEL;
+        whiteLevel.header.size = sizeof(whiteLevel);
+        whiteLevel.header.adapterId = paths[i].targetInfo.adapterId;
+        whiteLevel.header.id = paths[i].targetInfo.id;
+        if (DisplayConfigGetDeviceInfo(&whiteLevel.header) == ERROR_SUCCESS && whiteLevel.SDRWhiteLevel > 0) {
+            return whiteLevel.SDRWhiteLevel / 1000.0f; // 1000 = 80 nits = scRGB 1.0
+        }
+        break;
+    }
+    return fallback;
+}
+
+} // namespace
+
+void RenderSystem::UpdateOutputProperties() {
+    if (!m_outputFactory || !m_outputFactory->IsCurrent()) {
+        m_outputFactory.Reset();
+        if (FAILED(CreateDXGIFactory1(IID_PPV_ARGS(&m_outputFactory)))) return;
+    }
+
+    // The window's monitor, on whichever adapter drives it (hybrid systems render on one, scan out on another)
+    HMONITOR monitor = MonitorFromWindow(m_hwnd, MONITOR_DEFAULTTOPRIMARY);
+    ComPtr<IDXGIAdapter1> adapter;
+    for (UINT adapterIndex = 0; m_outputFactory->EnumAdapters1(adapterIndex, &adapter) != DXGI_ERROR_NOT_FOUND; ++adapterIndex) {
+        ComPtr<IDXGIOutput> output;
+        for (UINT outputIndex = 0; adapter->EnumOutputs(outputIndex, &output) != DXGI_ERROR_NOT_FOUND; ++outputIndex) {
+            ComPtr<IDXGIOutput6> output6;
+            DXGI_OUTPUT_DESC1 desc = {};
+            if (FAILED(output.As(&output6)) || FAILED(output6->GetDesc1(&desc)) || desc.Monitor != monitor) continue;
+
+            bool hdr = desc.ColorSpace == DXGI_COLOR_SPACE_RGB_FULL_G2084_NONE_P2020;
+            float sdrWhiteScale = hdr ? QuerySdrWhiteScale(desc.DeviceName, DEFAULT_SDR_WHITE_SCALE) : 1.0f;
+            if (hdr != m_hdrOutputDetected || sdrWhiteScale != m_sdrWhiteScale) {
+                m_hdrOutputDetected = hdr;
+                m_sdrWhiteScale = sdrWhiteScale;
+                InvalidateFrame();
+            }
+
+            // The current mode's rate is the most a variable refresh display will go to
+            DEVMODEW mode = {};
+            mode.dmSize = sizeof(mode);
+            float maxRefreshRateHz = 0.0f;
+            if (EnumDisplaySettingsW(desc.DeviceName, ENUM_CURRENT_SETTINGS, &mode) && mode.dmDisplayFrequency > 1) {
+                maxRefreshRateHz = static_cast<float>(mode.dmDisplayFrequency);
+            }
+            if (maxRefreshRateHz != m_maxRefreshRateHz) {
+                m_maxRefreshRateHz = maxRefreshRateHz;
+                if (IsVariableRefreshActive()) {
+                    LOG_INFO("Variable refresh: tearing allowed, capped at %.0f FPS", GetVariableRefreshFrameRateCap());
+                }
+            }
+            return;
+        }
+    }
+}
+
+void RenderSystem::ApplyOutputColorSpace() {
+    // The scene pipelines draw in the scene format, so scRGB needs the upscale pass to be available.
+    // Cross-adapter textures are only guaranteed in the SDR formats.
+    bool hdr = m_hdrOutputDetected && !m_hdrOutputUnsupported && !m_sharedLayer && !m_crossAdapterPresenter &&
+        m_pipelineStateManager;
+    if (hdr == m_hdrOutput) return;
+
+    // ResizeBuffers (which changes the format) needs the back buffers idle
+    WaitForSubmittedFrames();
+
+    const DXGI_COLOR_SPACE_TYPE colorSpace = hdr ? DXGI_COLOR_SPACE_RGB_FULL_G10_NONE_P709 : DXGI_COLOR_SPACE_RGB_FULL_G22_NONE_P709;
+    m_backBufferFormat = hdr ? DXGI_FORMAT_R16G16B16A16_FLOAT : m_sceneFormat;
+    ResizeSwapChainBuffers();
+
+    UINT support = 0;
+    bool supported = SUCCEEDED(m_swapChain->CheckColorSpaceSupport(colorSpace, &support)) &&
+        (support & DXGI_SWAP_CHAIN_COLOR_SPACE_SUPPORT_FLAG_PRESENT) != 0 &&
+        SUCCEEDED(m_swapChain->SetColorSpace1(colorSpace));
+    if (!supported && hdr) {
+        LOG_WARNING("Swap chain can't present scRGB, HDR output off");
+        m_hdrOutputUnsupported = true;
+        m_backBufferFormat = m_sceneFormat;
+        ResizeSwapChainBuffers();
+        m_swapChain->SetColorSpace1(DXGI_COLOR_SPACE_RGB_FULL_G22_NONE_P709);
+        return;
+    }
+
+    m_hdrOutput = hdr;
+    if (hdr) {
+        LOG_INFO("HDR output: scRGB, SDR white at %.0f nits", m_sdrWhiteScale * 80.0f);
+    }
+    else {
+        LOG_INFO("SDR output");
+    }
+}
+
+void RenderSystem::UpdateDisplayStatistics() {
+    // Both calls only read state DXGI keeps anyway; neither waits for the display
+    UINT lastPresentCount = 0;
+    DXGI_FRAME_STATISTICS stats = {};
+    if (m_occluded || FAILED(m_swapChain->GetLastPresentCount(&lastPresentCount)) ||
+        FAILED(m_swapChain->GetFrameStatistics(&stats))) {
+        // Nothing displayed yet, or DXGI_ERROR_FRAME_STATISTICS_DISJOINT around mode changes
+        m_displayStatistics.valid = false;
+        m_frameStatisticsBaseline = false;
+        return;
+    }
+    if (m_qpcFrequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&m_qpcFrequency);
+    }
+
+    UINT queueDepth = lastPresentCount > stats.PresentCount ? lastPresentCount - stats.PresentCount : 0;
+    m_displayStatistics.presentQueueDepth = queueDepth;
+    m_displayStatistics.valid = true;
+
+    // The present just issued is the last one counted
+    if (m_frameBrowserPaintQpc != 0 || m_frameInputQpc != 0) {
+        m_presentTags[m_nextPresentTag++ % MAX_PRESENT_TAGS] = { lastPresentCount, m_frameBrowserPaintQpc, m_frameInputQpc };
+    }
+
+    if (!m_frameStatisticsBaseline) {
+        m_lastFrameStatistics = stats;
+        m_windowFrameStatistics = stats;
+        m_lastPresentQueueDepth = queueDepth;
+        m_frameStatisticsBaseline = true;
+        return;
+    }
+
+    // Presents displayed since the previous sample. Those already queued back then were ready for
+    // consecutive vblanks (sync interval apart); any extra vblank between them is a miss. Frames
+    // presented after an idle gap are not counted, so render-on-demand pauses don't count as misses.
+    UINT displayed = stats.PresentCount - m_lastFrameStatistics.PresentCount;
+    if (displayed > 0) {
+        m_displayStatistics.displayedFrames += displayed;
+        UINT refreshes = stats.PresentRefreshCount - m_lastFrameStatistics.PresentRefreshCount;
+        if (m_lastSyncInterval > 0 && m_lastPresentQueueDepth >= displayed &&
+            refreshes > displayed * m_lastSyncInterval) {
+            m_displayStatistics.missedVsyncs += refreshes - displayed * m_lastSyncInterval;
+        }
+        // Each present displayed since the last sample is taken to have been shown an equal share apart
+        if (m_qpcFrequency.QuadPart > 0) {
+            double intervalMs = 1000.0 * (stats.SyncQPCTime.QuadPart - m_lastFrameStatistics.SyncQPCTime.QuadPart) /
+                (static_cast<double>(m_qpcFrequency.QuadPart) * displayed);
+            if (intervalMs > 0.0 && intervalMs <= CADENCE_MAX_INTERVAL_MS) {
+                m_intervalSumMs += intervalMs * displayed;
+                m_intervalSquareSumMs += intervalMs * intervalMs * displayed;
+                m_intervalCount += displayed;
+            }
+        }
+        // Only the last displayed present has a known vblank; earlier ones are dropped unmeasured
+        for (PresentTag& tag : m_presentTags) {
+            if ((tag.paintQpc == 0 && tag.inputQpc == 0) || tag.presentId > stats.PresentCount) continue;
+            const bool shown = tag.presentId == stats.PresentCount && m_qpcFrequency.QuadPart > 0;
+            if (shown && tag.paintQpc != 0 && stats.SyncQPCTime.QuadPart >= tag.paintQpc) {
+                double latencyMs = 1000.0 * (stats.SyncQPCTime.QuadPart - tag.paintQpc) /
+                    static_cast<double>(m_qpcFrequency.QuadPart);
+                m_paintLatencySumMs += latencyMs;
+                m_paintLatencyMaxMs = std::max(m_paintLatencyMaxMs, latencyMs);
+                m_paintLatencyCount++;
+                m_displayStatistics.displayedPaints++;
+                m_displayStatistics.paintToPhotonSumMs += latencyMs;
+            }
+            if (shown && tag.inputQpc != 0 && stats.SyncQPCTime.QuadPart >= tag.inputQpc) {
+                m_displayStatistics.lastInputToPhotonMs = static_cast<float>(1000.0 *
+                    (stats.SyncQPCTime.QuadPart - tag.inputQpc) / static_cast<double>(m_qpcFrequency.QuadPart));
+                m_displayStatistics.inputSamples++;
+            }
+            tag.paintQpc = 0;
+            tag.inputQpc = 0;
+        }
+        m_lastFrameStatistics = stats;
+        m_lastPresentQueueDepth = queueDepth;
+    }
+    else {
+        m_lastPresentQueueDepth = std::max(m_lastPresentQueueDepth, queueDepth);
+    }
+
+    // Rates from the vblank clock, not ours
+    LONGLONG elapsedQpc = stats.SyncQPCTime.QuadPart - m_windowFrameStatistics.SyncQPCTime.QuadPart;
+    if (m_qpcFrequency.QuadPart > 0 && elapsedQpc * 1000 >= DISPLAY_STATS_WINDOW_MS * m_qpcFrequency.QuadPart) {
+        double seconds = static_cast<double>(elapsedQpc) / static_cast<double>(m_qpcFrequency.QuadPart);
+        m_displayStatistics.displayedFramesPerSecond = static_cast<float>(
+            (stats.PresentCount - m_windowFrameStatistics.PresentCount) / seconds);
+        m_displayStatistics.refreshRateHz = static_cast<float>(
+            (stats.SyncRefreshCount - m_windowFrameStatistics.SyncRefreshCount) / seconds);
+        m_windowFrameStatistics = stats;
+
+        double meanMs = m_intervalCount > 0 ? m_intervalSumMs / m_intervalCount : 0.0;
+        double variance = m_intervalCount > 0 ? m_intervalSquareSumMs / m_intervalCount - meanMs * meanMs : 0.0;
+        m_displayStatistics.frameIntervalMs = static_cast<float>(meanMs);
+        m_displayStatistics.frameIntervalJitterMs = static_cast<float>(std::sqrt(std::max(variance, 0.0)));
+        m_intervalSumMs = 0.0;
+        m_intervalSquareSumMs = 0.0;
+        m_intervalCount = 0;
+
+        // Kept from the last window with paints, so an idle page doesn't blank it
+        if (m_paintLatencyCount > 0) {
+            m_displayStatistics.paintToPhotonMs = static_cast<float>(m_paintLatencySumMs / m_paintLatencyCount);
+            m_displayStatistics.paintToPhotonMaxMs = static_cast<float>(m_paintLatencyMaxMs);
+            m_paintLatencySumMs = 0.0;
+            m_paintLatencyMaxMs = 0.0;
+            m_paintLatencyCount = 0;
+        }
+    }
+}
+
+void RenderSystem::CreateCommandObjects() {
+    // Create command queue
+    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    // Never high: that would pre-empt the game. Yielding below it is per process (SetGpuPriorityYield).
+    queueDesc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
+
+    HRESULT hr = m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_commandQueue));
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to create command queue");
+    }
+#if GAMEOVERLAY_ENABLE_TRACY
+    m_tracyGpuContext = TracyD3D12Context(m_device.Get(), m_commandQueue.Get());
+    TracyD3D12ContextName(m_tracyGpuContext, "Direct queue", 12);
+#endif
+
+    // Create the frame contexts (each owns its command allocator)
+    for (UINT i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        m_frameContexts[i] = std::make_unique<FrameContext>(m_device.Get());
+    }
+    ID3D12CommandAllocator* initialAllocator = m_frameContexts[0]->commandAllocator.Get();
+
+    // Create command list
+    hr = m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, initialAllocator, nullptr, IID_PPV_ARGS(&m_commandList));
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to create command list");
+    }
+
+    // Close the command list as it's initially opened
+    m_commandList->Close();
+
+    hr = m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, initialAllocator, nullptr,
+        IID_PPV_ARGS(&m_frameHeadCommandList));
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to create command list");
+    }
+    m_frameHeadCommandList->Close();
+}
+
+void RenderSystem::CreateSwapChain(HWND hwnd, int width, int height) {
+    HRESULT hr = S_OK;
+
+    // Create swap chain description
+    DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
+    swapChainDesc.Width = width;
+    swapChainDesc.Height = height;
+    swapChainDesc.Format = m_backBufferFormat;
+    swapChainDesc.SampleDesc.Count = 1;
+    swapChainDesc.SampleDesc.Quality = 0;
+    swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+    swapChainDesc.BufferCount = m_backBufferCount;
+    // Sequential flip keeps dirty rects meaningful for partial presentation
+    swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
+    // Always create with the waitable flag; it cannot be added later without recreating the swap chain
+    m_swapChainFlags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+    if (m_tearingSupported) {
+        m_swapChainFlags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+    }
+    swapChainDesc.Flags = m_swapChainFlags;
+    swapChainDesc.Scaling = DXGI_SCALING_STRETCH; // SetSourceSize stretches to the window (UpscaleMode::SwapChain)
+
+    // Cross-adapter: the display adapter's queue presents, after copying each frame over
+    ID3D12CommandQueue* presentQueue = m_crossAdapterPresenter ?
+        m_crossAdapterPresenter->GetPresentQueue() : m_commandQueue.Get();
+
+    ComPtr<IDXGISwapChain1> swapChain1;
+    if (m_useComposition) {
+        // Composition swap chains carry per-pixel alpha straight to DWM (no color key, no redirection copy)
+        // Premultiplied alpha at the visual's 1:1 size is also what keeps them eligible for an overlay plane
+        swapChainDesc.AlphaMode = DXGI_ALPHA_MODE_PREMULTIPLIED;
+        swapChainDesc.Scaling = DXGI_SCALING_STRETCH;
+
+        hr = m_factory->CreateSwapChainForComposition(
+            presentQueue,
+            &swapChainDesc,
+            nullptr,
+            &swapChain1
+        );
+    }
+    else {
+        hr = m_factory->CreateSwapChainForHwnd(
+            presentQueue,
+            hwnd,
+            &swapChainDesc,
+            nullptr,
+            nullptr,
+            &swapChain1
+        );
+    }
+
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to create swap chain");
+    }
+
+    // Convert to IDXGISwapChain3
+    hr = swapChain1.As(&m_swapChain);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to query IDXGISwapChain3 interface");
+    }
+
+    if (FAILED(m_swapChain.As(&m_swapChainMedia))) {
+        LOG_WARNING("Swap chain presentation statistics unavailable");
+    }
+
+    // Bind the swap chain to the window through a composition visual
+    if (m_useComposition) {
+        CreateCompositionTarget(hwnd);
+    }
+
+    // Limit queued frames and fetch the latency waitable object
+    hr = m_swapChain->SetMaximumFrameLatency(m_maxFrameLatency);
+    if (FAILED(hr)) {
+        LOG_WARNING("Failed to set maximum frame latency");
+    }
+
+    m_frameLatencyWaitableObject = m_swapChain->GetFrameLatencyWaitableObject();
+    if (m_frameLatencyWaitableObject == nullptr) {
+        LOG_WARNING("Swap chain frame latency waitable object unavailable");
+    }
+
+    // Get initial back buffer index
+    m_backBufferIndex = m_swapChain->GetCurrentBackBufferIndex();
+}
+
+void RenderSystem::CreateCompositionTarget(HWND hwnd) {
+    HRESULT hr = DCompositionCreateDevice(nullptr, IID_PPV_ARGS(&m_dcompDevice));
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to create DirectComposition device");
+    }
+
+    // Topmost target so the visual sits above any other window content
+    hr = m_dcompDevice->CreateTargetForHwnd(hwnd, TRUE, &m_dcompTarget);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to create DirectComposition target");
+    }
+
+    hr = m_dcompDevice->CreateVisual(&m_dcompVisual);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to create DirectComposition visual");
+    }
+
+    hr = m_dcompVisual->SetContent(m_swapChain.Get());
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to set DirectComposition visual content");
+    }
+
+    hr = m_dcompTarget->SetRoot(m_dcompVisual.Get());
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to set DirectComposition root visual");
+    }
+
+    hr = m_dcompDevice->Commit();
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to commit DirectComposition device");
+    }
+}
+
+void RenderSystem::CreateRenderTargets() {
+    // Cross-adapter: the frame is drawn into the shared textures the display adapter copies from
+    if (m_crossAdapterPresenter &&
+        !m_crossAdapterPresenter->CreateBuffers(m_swapChain.Get(), m_backBufferCount, m_renderTargets)) {
+        throw std::runtime_error("Failed to create cross-adapter render targets");
+    }
+
+    for (UINT i = 0; i < m_backBufferCount; i++) {
+        // Get buffer from swap chain
+        if (!m_crossAdapterPresenter) {
+            HRESULT hr = m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_renderTargets[i]));
+            if (FAILED(hr)) {
+                throw std::runtime_error("Failed to get swap chain buffer");
+            }
+        }
+
+        // Create RTV
+        D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = m_descriptorManager->GetRtvHandle(i);
+        m_device->CreateRenderTargetView(m_renderTargets[i].Get(), nullptr, rtvHandle);
+    }
+}
+
+void RenderSystem::CreateSyncObjects() {
+    // Create fence
+    HRESULT hr = m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence));
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to create fence");
+    }
+
+    // Create fence events
+    m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    m_frameReadyEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (m_fenceEvent == nullptr || m_frameReadyEvent == nullptr) {
+        throw std::runtime_error("Failed to create fence event");
+    }
+}
+
+bool RenderSystem::SetProcessGpuPriorityYield(HANDLE process, bool yield) {
+    // gdi32 export; its header (d3dkmthk.h) comes with the WDK. Below normal needs no privilege.
+    using SetSchedulingPriorityClassFn = LONG(APIENTRY*)(HANDLE, INT);
+    static const auto setSchedulingPriorityClass = reinterpret_cast<SetSchedulingPriorityClassFn>(
+        GetProcAddress(GetModuleHandleW(L"gdi32.dll"), "D3DKMTSetProcessSchedulingPriorityClass"));
+    if (!setSchedulingPriorityClass || !process) return false;
+
+    constexpr INT SCHEDULING_PRIORITY_BELOW_NORMAL = 1; // D3DKMT_SCHEDULINGPRIORITYCLASS
+    constexpr INT SCHEDULING_PRIORITY_NORMAL = 2;
+    LONG status = setSchedulingPriorityClass(process,
+        yield ? SCHEDULING_PRIORITY_BELOW_NORMAL : SCHEDULING_PRIORITY_NORMAL);
+    return status == 0; // STATUS_SUCCESS
+}
+
+bool RenderSystem::SetGpuPriorityYield(bool yield) {
+    if (yield == m_gpuPriorityYielded) return true;
+    if (!SetProcessGpuPriorityYield(GetCurrentProcess(), yield)) {
+        LOG_WARNING("Failed to change the GPU scheduling priority");
+        return false;
+    }
+    m_gpuPriorityYielded = yield;
+    return true;
+}
+
+void RenderSystem::CreateCopyQueue() {
+    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+
+    ComPtr<ID3D12CommandQueue> copyQueue;
+    ComPtr<ID3D12Fence> copyFence;
+    HRESULT hr = m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&copyQueue));
+    if (SUCCEEDED(hr)) {
+        hr = m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&copyFence));
+    }
+    if (FAILED(hr)) {
+        LOG_WARNING("Copy queue unavailable, uploads use the direct queue");
+        return;
+    }
+
+    m_copyAllocatorPool = std::make_unique<CommandAllocatorPool>(m_device.Get(), D3D12_COMMAND_LIST_TYPE_COPY,
+        copyFence.Get());
+    ID3D12CommandAllocator* allocator = m_copyAllocatorPool->GetCommandAllocator();
+
+    hr = m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, allocator, nullptr, IID_PPV_ARGS(&m_copyCommandList));
+    if (FAILED(hr)) {
+        LOG_WARNING("Copy command list unavailable, uploads use the direct queue");
+        m_copyAllocatorPool.reset();
+        return;
+    }
+    m_copyCommandList->Close();
+    m_copyAllocatorPool->ReleaseCommandAllocator(0, allocator);
+
+    m_copyQueue = copyQueue;
+    m_copyFence = copyFence;
+}
+
+ID3D12GraphicsCommandList* RenderSystem::BeginCopyCommands() {
+    if (!m_copyQueue) return nullptr;
+
+    // No wait for the previous copy: upload buffers are fenced per slot by their owners and
+    // allocators are handed out by copy fence value
+    m_copyAllocator = m_copyAllocatorPool->GetCommandAllocator();
+    HRESULT hr = m_copyCommandList->Reset(m_copyAllocator, nullptr);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to reset copy command list");
+    }
+
+    return m_copyCommandList.Get();
+}
+
+void RenderSystem::SubmitCopyCommands(bool directQueueWaits) {
+    if (!m_copyQueue || !m_copyAllocator) return;
+
+    HRESULT hr = m_copyCommandList->Close();
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to close copy command list");
+    }
+
+    // Destination textures may still be sampled by frames in flight
+    m_copyQueue->Wait(m_fence.Get(), m_lastSignaledFenceValue);
+
+    ID3D12CommandList* ppCommandLists[] = { m_copyCommandList.Get() };
+    m_copyQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+
+    m_copyFenceValue++;
+    hr = m_copyQueue->Signal(m_copyFence.Get(), m_copyFenceValue);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to signal copy fence");
+    }
+
+    if (directQueueWaits) m_copyFenceValueRequired = m_copyFenceValue;
+    m_copyAllocatorPool->ReleaseCommandAllocator(m_copyFenceValue, m_copyAllocator);
+    m_copyAllocator = nullptr;
+}
+
+void RenderSystem::WaitForCopyQueue() {
+    if (!m_copyFence || m_copyFence->GetCompletedValue() >= m_copyFenceValue) return;
+
+    HRESULT hr = m_copyFence->SetEventOnCompletion(m_copyFenceValue, m_fenceEvent);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to set copy fence event");
+    }
+
+    WaitForSingleObject(m_fenceEvent, INFINITE);
+}
+
+void RenderSystem::CreateTimestampResources() {
+    HRESULT hr = m_commandQueue->GetTimestampFrequency(&m_timestampFrequency);
+    if (FAILED(hr) || m_timestampFrequency == 0) {
+        LOG_WARNING("GPU timestamps not supported on this queue");
+        return;
+    }
+
+    D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+    queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    queryHeapDesc.Count = QUERIES_PER_FRAME * MAX_FRAMES_IN_FLIGHT;
+
+    hr = m_device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_timestampQueryHeap));
+    if (FAILED(hr)) {
+        LOG_WARNING("Failed to create timestamp query heap");
+        return;
+    }
+
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    heapProps.Type = D3D12_HEAP_TYPE_READBACK;
+
+    D3D12_RESOURCE_DESC bufferDesc = {};
+    bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    bufferDesc.Width = QUERIES_PER_FRAME * sizeof(UINT64);
+    bufferDesc.Height = 1;
+    bufferDesc.DepthOrArraySize = 1;
+    bufferDesc.MipLevels = 1;
+    bufferDesc.SampleDesc.Count = 1;
+    bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+    for (UINT i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        hr = m_device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+            D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&m_frameContexts[i]->timestampReadback));
+        if (FAILED(hr)) {
+            LOG_WARNING("Failed to create timestamp readback buffer");
+            m_timestampQueryHeap.Reset();
+            return;
+        }
+    }
+
+    m_timestampsSupported = true;
+    m_gpuProfileLane = CpuProfiler::CreateLane("GPU (direct queue)");
+}
+
+bool RenderSystem::ShouldUpscale() const {
+    return m_pipelineStateManager && (m_scaledWidth < m_width || m_scaledHeight < m_height);
+}
+
+void RenderSystem::BuildFrameGraph() {
+    m_renderGraph->Reset();
+    m_frameGraph = FrameGraph();
+    m_frameGraph.backBuffer = m_renderGraph->Import(GetCurrentRenderTarget(),
+        D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_PRESENT);
+    m_frameGraph.sceneTarget = m_frameGraph.backBuffer;
+    if (m_upscalingThisFrame) {
+        RenderGraphTextureDesc desc;
+        desc.name = L"Upscale Source";
+        desc.width = static_cast<UINT>(m_scaledWidth);
+        desc.height = static_cast<UINT>(m_scaledHeight);
+        desc.format = m_sceneFormat;
+        m_frameGraph.sceneTarget = m_renderGraph->CreateTransient(desc);
+    }
+
+    // The scene pass clears its target, which initializes a transient taking over aliased memory
+    m_frameGraph.scenePass = m_renderGraph->AddPass("Scene");
+    m_renderGraph->Write(m_frameGraph.scenePass, m_frameGraph.sceneTarget, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    if (m_upscalingThisFrame) {
+        m_frameGraph.upscalePass = m_renderGraph->AddPass("Upscale");
+        m_renderGraph->Read(m_frameGraph.upscalePass, m_frameGraph.sceneTarget, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        m_renderGraph->Write(m_frameGraph.upscalePass, m_frameGraph.backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    }
+    if (m_sharedLayer) {
+        m_frameGraph.sharedLayerPass = m_renderGraph->AddPass("Shared Layer Copy");
+        m_renderGraph->Read(m_frameGraph.sharedLayerPass, m_frameGraph.backBuffer, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    }
+    if (m_frameReadback && m_frameReadback->IsCaptureDue()) {
+        m_frameGraph.readbackPass = m_renderGraph->AddPass("Screenshot Readback");
+        m_renderGraph->Read(m_frameGraph.readbackPass, m_frameGraph.backBuffer, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    }
+    m_renderGraph->Compile();
+
+    if (!m_upscalingThisFrame) {
+        m_scaledRenderTarget = nullptr; // Retired by the placement that dropped it
+    }
+    else {
+        ID3D12Resource* target = m_renderGraph->GetResource(m_frameGraph.sceneTarget);
+        if (!target) {
+            // Draw at full size rather than into nothing; the graph is declared again without the upscale
+            m_upscalingThisFrame = false;
+            BuildFrameGraph();
+            return;
+        }
+        if (target != m_scaledRenderTarget) {
+            UpdateScaledTargetViews(target);
+        }
+    }
+}
+
+void RenderSystem::UpdateScaledTargetViews(ID3D12Resource* target) {
+    // Frames in flight may still sample through the old SRV
+    m_scaledTargetSrvSlot = (m_scaledTargetSrvSlot + 1) % SCALED_TARGET_SRV_SLOTS;
+    m_scaledRenderTarget = target;
+
+    m_device->CreateRenderTargetView(target, nullptr, m_descriptorManager->GetRtvHandle(SCALED_TARGET_RTV_INDEX));
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = m_sceneFormat;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Texture2D.MipLevels = 1;
+    m_device->CreateShaderResourceView(target, &srvDesc, m_scaledTargetSrvs[m_scaledTargetSrvSlot].cpuHandle);
+
+    D3D12_RESOURCE_DESC desc = target->GetDesc();
+    m_scaledTargetWidth = static_cast<int>(desc.Width);
+    m_scaledTargetHeight = static_cast<int>(desc.Height);
+}
+
+void RenderSystem::RecordUpscalePass() {
+    BeginGpuPass(GpuPass::Upscale);
+
+    m_renderGraph->BeginPass(m_frameGraph.upscalePass, m_commandList.Get());
+
+    D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = GetCurrentRenderTargetView();
+    m_commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+
+    D3D12_VIEWPORT viewport = { 0.0f, 0.0f, static_cast<float>(m_width), static_cast<float>(m_height), 0.0f, 1.0f };
+    D3D12_RECT scissorRect = { 0, 0, m_width, m_height };
+    m_commandList->RSSetViewports(1, &viewport);
+    m_commandList->RSSetScissorRects(1, &scissorRect);
+
+    ID3D12RootSignature* rootSignature = m_pipelineStateManager->GetUpscaleRootSignature();
+    ID3D12PipelineState* pipelineState = m_pipelineStateManager->GetUpscalePipelineState(m_upscaleFilter, m_backBufferFormat);
+
+    if (rootSignature && pipelineState) {
+        UpscaleConstants constants = {};
+        constants.sourceTexelSize[0] = 1.0f / static_cast<float>(m_scaledTargetWidth);
+        constants.sourceTexelSize[1] = 1.0f / static_cast<float>(m_scaledTargetHeight);
+        constants.sharpness = m_upscaleSharpness;
+        constants.outputScale = m_hdrOutput ? m_sdrWhiteScale : 0.0f;
+
+        m_commandList->SetGraphicsRootSignature(rootSignature);
+        m_commandList->SetPipelineState(pipelineState);
+        m_commandList->SetGraphicsRootDescriptorTable(0, m_scaledTargetSrvs[m_scaledTargetSrvSlot].gpuHandle);
+        m_commandList->SetGraphicsRoot32BitConstants(1, sizeof(UpscaleConstants) / sizeof(UINT), &constants, 0);
+        m_commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        m_commandList->DrawInstanced(3, 1, 0, 0);
+    }
+    else {
+        // Never present an uninitialized back buffer
+        LOG_ERROR("Upscale pipeline unavailable, presenting empty frame");
+        const float clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        m_commandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
+    }
+
+    EndGpuPass(GpuPass::Upscale);
+}
+
+void RenderSystem::BeginGpuPass(GpuPass pass) {
+    BeginGpuPass(pass, m_commandList.Get());
+}
+
+void RenderSystem::EndGpuPass(GpuPass pass) {
+    EndGpuPass(pass, m_commandList.Get());
+}
+
+void RenderSystem::BeginGpuPass(GpuPass pass, ID3D12GraphicsCommandList* commandList) {
+    if (!m_timestampsSupported || pass >= GpuPass::Count) return;
+
+    UINT passIndex = static_cast<UINT>(pass);
+    commandList->EndQuery(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP,
+        m_frameIndex * QUERIES_PER_FRAME + 2 + passIndex * 2);
+
+#if GAMEOVERLAY_ENABLE_TRACY
+    static const tracy::SourceLocationData tracyLocations[PASS_COUNT] = {
+        { "Clear", __FUNCTION__, __FILE__, __LINE__, 0 },
+        { "Browser Copy", __FUNCTION__, __FILE__, __LINE__, 0 },
+        { "ImGui", __FUNCTION__, __FILE__, __LINE__, 0 },
+        { "Upscale", __FUNCTION__, __FILE__, __LINE__, 0 },
+    };
+    m_tracyGpuZones[passIndex] = std::make_unique<tracy::D3D12ZoneScope>(
+        m_tracyGpuContext, commandList, &tracyLocations[passIndex], true);
+#endif
+}
+
+void RenderSystem::EndGpuPass(GpuPass pass, ID3D12GraphicsCommandList* commandList) {
+    if (!m_timestampsSupported || pass >= GpuPass::Count) return;
+
+    UINT passIndex = static_cast<UINT>(pass);
+    commandList->EndQuery(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP,
+        m_frameIndex * QUERIES_PER_FRAME + 3 + passIndex * 2);
+#if GAMEOVERLAY_ENABLE_TRACY
+    m_tracyGpuZones[passIndex].reset(); // Ends the Tracy zone on the same list
+#endif
+    m_frameContexts[m_frameIndex]->timestampPassMask |= (1u << passIndex);
+}
+
+void RenderSystem::ResolveGpuTimestamps(UINT frameIndex) {
+    UINT base = frameIndex * QUERIES_PER_FRAME;
+    FrameContext& frameContext = *m_frameContexts[frameIndex];
+    m_commandList->EndQuery(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, base + 1);
+
+    // Resolve only queries written this frame; unwritten slots are invalid to resolve
+    m_commandList->ResolveQueryData(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP,
+        base, 2, frameContext.timestampReadback.Get(), 0);
+
+    for (UINT pass = 0; pass < PASS_COUNT; pass++) {
+        if (frameContext.timestampPassMask & (1u << pass)) {
+            m_commandList->ResolveQueryData(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP,
+                base + 2 + pass * 2, 2, frameContext.timestampReadback.Get(), (2 + pass * 2) * sizeof(UINT64));
+        }
+    }
+}
+
+void RenderSystem::ReadGpuTimestamps(UINT frameIndex) {
+    // The fence for this frame slot has completed, so its readback data is ready
+    FrameContext& frameContext = *m_frameContexts[frameIndex];
+    UINT passMask = frameContext.timestampPassMask;
+    frameContext.timestampPassMask = 0;
+    if (passMask == 0) return; // Slot not used yet
+
+    D3D12_RANGE readRange = { 0, QUERIES_PER_FRAME * sizeof(UINT64) };
+    UINT64* timestamps = nullptr;
+    HRESULT hr = frameContext.timestampReadback->Map(0, &readRange, reinterpret_cast<void**>(&timestamps));
+    if (FAILED(hr)) return;
+
+    const double ticksToMs = 1000.0 / static_cast<double>(m_timestampFrequency);
+    auto elapsedMs = [&](UINT beginIndex) {
+        UINT64 begin = timestamps[beginIndex];
+        UINT64 end = timestamps[beginIndex + 1];
+        return end > begin ? static_cast<float>((end - begin) * ticksToMs) : 0.0f;
+    };
+
+    m_gpuFrameTimeMs = elapsedMs(0);
+    m_gpuTimingSamples++;
+    for (UINT pass = 0; pass < PASS_COUNT; pass++) {
+        m_gpuPassTimesMs[pass] = (passMask & (1u << pass)) ? elapsedMs(2 + pass * 2) : 0.0f;
+    }
+    if (CpuProfiler::IsEnabled()) {
+        RecordGpuProfileZones(timestamps, passMask);
+    }
+
+    D3D12_RANGE writeRange = { 0, 0 }; // Nothing written
+    frameContext.timestampReadback->Unmap(0, &writeRange);
+}
+
+void RenderSystem::RecordGpuProfileZones(const UINT64* timestamps, UINT passMask) {
+    // Recalibrated once a second; the two clocks drift apart only slowly
+    LARGE_INTEGER qpcFrequency;
+    QueryPerformanceFrequency(&qpcFrequency);
+    UINT64 nowTicks = static_cast<UINT64>(CpuProfiler::GetTicks());
+    if (m_calibrationCpuTicks == 0 || nowTicks - m_calibrationCpuTicks > static_cast<UINT64>(qpcFrequency.QuadPart)) {
+        if (FAILED(m_commandQueue->GetClockCalibration(&m_calibrationGpuTimestamp, &m_calibrationCpuTicks))) {
+            m_calibrationCpuTicks = 0;
+            return;
+        }
+    }
+
+    const double gpuToCpu = static_cast<double>(qpcFrequency.QuadPart) / static_cast<double>(m_timestampFrequency);
+    auto toCpuTicks = [&](UINT64 timestamp) {
+        double delta = (static_cast<double>(timestamp) - static_cast<double>(m_calibrationGpuTimestamp)) * gpuToCpu;
+        return static_cast<int64_t>(m_calibrationCpuTicks) + static_cast<int64_t>(delta);
+    };
+
+    // Passes before the frame: the lane is read back in end-time order
+    for (UINT pass = 0; pass < PASS_COUNT; pass++) {
+        UINT beginIndex = 2 + pass * 2;
+        if (!(passMask & (1u << pass)) || timestamps[beginIndex + 1] <= timestamps[beginIndex]) continue;
+        CpuProfiler::RecordZone(m_gpuProfileLane, GetGpuPassName(static_cast<GpuPass>(pass)),
+            toCpuTicks(timestamps[beginIndex]), toCpuTicks(timestamps[beginIndex + 1]), 1);
+    }
+    if (timestamps[1] > timestamps[0]) {
+        CpuProfiler::RecordZone(m_gpuProfileLane, "GPU Frame", toCpuTicks(timestamps[0]), toCpuTicks(timestamps[1]), 0);
+    }
+}
+
+void RenderSystem::CheckTearingSupport() {
+    ComPtr<IDXGIFactory5> factory5;
+    HRESULT hr = m_factory.As(&factory5);
+
+    if (SUCCEEDED(hr)) {
+        BOOL allowTearing = FALSE;
+        hr = factory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing));
+
+        if (SUCCEEDED(hr)) {
+            m_tearingSupported = (allowTearing == TRUE);
+        }
+    }
+}
+
+void RenderSystem::WaitForFrameLatency() {
+    if (m_frameLatencyWaited) return;
+    m_frameLatencyWaited = true;
+    m_lastFrameLatencyWaitMs = 0.0f;
+
+    if (!m_frameLatencyWaitEnabled || !m_frameLatencyWaitableObject) return;
+
+    // Block until DXGI is ready for a new frame (bounded to avoid hanging on a lost device)
+    auto waitStart = std::chrono::high_resolution_clock::now();
+    DWORD result = WaitForSingleObjectEx(m_frameLatencyWaitableObject, 1000, TRUE);
+    auto waitEnd = std::chrono::high_resolution_clock::now();
+
+    if (result == WAIT_TIMEOUT) {
+        LOG_WARNING("Timed out waiting for swap chain frame latency object");
+    }
+
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(waitEnd - waitStart);
+    m_lastFrameLatencyWaitMs = duration.count() / 1000.0f;
+    m_beginFrameLatencyWaitMs = m_lastFrameLatencyWaitMs;
+}
+
+HANDLE RenderSystem::GetFrameLatencyWaitableObject() const {
+    if (m_frameLatencyWaited || !m_frameLatencyWaitEnabled) return nullptr;
+    return m_frameLatencyWaitableObject;
+}
+
+void RenderSystem::CompleteFrameLatencyWait(bool signaled, float waitedMs) {
+    if (!signaled) {
+        LOG_WARNING("Timed out waiting for swap chain frame latency object");
+    }
+
+    m_frameLatencyWaited = true;
+    m_lastFrameLatencyWaitMs = waitedMs;
+}
+
+bool RenderSystem::IsFrameLatencyReady() {
+    if (m_frameLatencyWaited) return true;
+
+    if (!m_frameLatencyWaitEnabled || !m_frameLatencyWaitableObject ||
+        WaitForSingleObject(m_frameLatencyWaitableObject, 0) == WAIT_OBJECT_0) {
+        m_frameLatencyWaited = true;
+        m_lastFrameLatencyWaitMs = 0.0f;
+        return true;
+    }
+
+    return false;
+}
+
+HANDLE RenderSystem::GetFrameReadyEvent() {
+    if (IsFrameSlotReady()) return nullptr;
+
+    HRESULT hr = m_fence->SetEventOnCompletion(m_frameReadyFenceValue, m_frameReadyEvent);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to set fence event");
+    }
+
+    return m_frameReadyEvent;
+}
+
+void RenderSystem::AddDirtyRect(const RECT& rect) {
+    // Filtering during upscale spreads content by a couple of source texels
+    LONG pad = 0;
+    if (m_upscalingThisFrame && m_renderScale > 0.0f) {
+        pad = static_cast<LONG>(std::ceil(2.0f / m_renderScale));
+    }
+
+    // Clamp to the back buffer; Present1 rejects rects outside it
+    RECT clamped = {
+        std::max(rect.left - pad, 0L),
+        std::max(rect.top - pad, 0L),
+        std::min(rect.right + pad, static_cast<LONG>(m_width)),
+        std::min(rect.bottom + pad, static_cast<LONG>(m_height))
+    };
+
+    if (clamped.right > clamped.left && clamped.bottom > clamped.top) {
+        m_dirtyRects.push_back(clamped);
+    }
+}
+
+bool RenderSystem::TestOcclusion() {
+    HRESULT hr = m_swapChain->Present(0, DXGI_PRESENT_TEST);
+    bool occluded = (hr == DXGI_STATUS_OCCLUDED);
+
+    if (m_occluded && !occluded) {
+        // Back buffers may be stale after a long halt, redraw everything
+        m_forceFullPresent = true;
+        InvalidateFrame();
+    }
+    m_occluded = occluded;
+
+    return m_occluded;
+}
+
+void RenderSystem::InvalidateFrame() {
+    m_pendingRedrawFrames = REDRAW_FRAMES_PER_INVALIDATION;
+}
+
+bool RenderSystem::ConsumeFrameInvalidation() {
+    UINT pending = m_pendingRedrawFrames.load();
+    while (pending > 0 && !m_pendingRedrawFrames.compare_exchange_weak(pending, pending - 1)) {
+    }
+    return pending > 0;
+}
 
-        // Skip software adapter
-        if (desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) {
-            continue;
-        }
+void RenderSystem::SetMaximumFrameLatency(UINT maxLatency) {
+    // Never queue more frames than we have back buffers
+    maxLatency = std::max(1u, std::min(maxLatency, MAX_FRAMES_IN_FLIGHT));
+    if (m_maxFrameLatency == maxLatency) return;
 
-        // Check if adapter supports Direct3D 12
-        if (SUCCEEDED(D3D12CreateDevice(adapter.Get(), D3D_FEATURE_LEVEL_11_0, _uuidof(ID3D12Device), nullptr))) {
-            break;
+    m_maxFrameLatency = maxLatency;
+    if (m_swapChain) {
+        HRESULT hr = m_swapChain->SetMaximumFrameLatency(m_maxFrameLatency);
+        if (FAILED(hr)) {
+            LOG_WARNING("Failed to set maximum frame latency");
         }
     }
+}
 
-    // Fall back to WARP adapter if no hardware adapter found
-    if (adapter == nullptr) {
-        factory->EnumWarpAdapter(IID_PPV_ARGS(&adapter));
-        m_useWarpAdapter = true;
+void RenderSystem::BeginFrame() {
+    // Wait for the swap chain first if the main loop didn't already (before input is sampled)
+    m_beginFrameLatencyWaitMs = 0.0f;
+    WaitForFrameLatency();
+
+    // Apply a debounced resize once the size has settled
+    ApplyPendingResize();
+    ApplyPendingFrameCount();
+    ApplyOutputColorSpace();
+
+    // HDR output always takes the upscale pass: that's where the SDR scene becomes scRGB. The shared
+    // layer and screenshots copy the whole back buffer, so they need it full size too.
+    const bool scaled = ShouldUpscale();
+    m_swapChainScalingThisFrame = scaled && m_upscaleMode == UpscaleMode::SwapChain && !m_hdrOutput &&
+        !m_sharedLayer && !(m_frameReadback && m_frameReadback->IsCaptureDue());
+    m_upscalingThisFrame = (scaled && !m_swapChainScalingThisFrame) || m_hdrOutput;
+    ApplySourceSize();
+
+    // Wait for the GPU to release this frame slot (no-op if the main loop already waited)
+    auto slotWaitStart = std::chrono::high_resolution_clock::now();
+    WaitForFrame(m_frameIndex);
+    m_lastFrameSlotWaitMs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - slotWaitStart).count() / 1000.0f;
+
+    // Release anything retired by frames the GPU has finished, then stay within the memory budget
+    m_resourceManager->ProcessRetiredResources(m_fence->GetCompletedValue());
+    m_resourceManager->UpdateVideoMemoryBudget();
+    if (m_frameReadback) {
+        m_frameReadback->Poll(m_fence->GetCompletedValue()); // Screenshots copied by earlier frames
     }
 
-    // Create Direct3D 12 device
-    hr = D3D12CreateDevice(adapter.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&m_device));
+    // Reset command list and allocator
+    FrameContext& frameContext = *m_frameContexts[m_frameIndex];
+    frameContext.Reset();
+
+    HRESULT hr = m_commandList->Reset(frameContext.commandAllocator.Get(), nullptr);
     if (FAILED(hr)) {
-        throw std::runtime_error("Failed to create D3D12 device");
+        throw std::runtime_error("Failed to reset command list");
     }
 
-    // Create command queue, allocators, and list
-    CreateCommandObjects();
-
-    // Create swap chain
-    CreateSwapChain(hwnd, width, height);
+    // One shader-visible heap for the whole frame (no heap switches between passes)
+    ID3D12DescriptorHeap* heaps[] = { m_descriptorManager->cbvSrvUavHeap.Get() };
+    m_commandList->SetDescriptorHeaps(_countof(heaps), heaps);
 
-    // Create descriptor heaps
-    m_rtvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+    // Placed targets created since the last frame get their metadata before any pass draws to them
+    m_resourceManager->DiscardPlacedTargets(m_commandList.Get());
 
-    // Create RTV heap
-    D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc = {};
-    rtvHeapDesc.NumDescriptors = 3; // Triple buffering
-    rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
-    rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    // Decoded UI images, a few per frame; the copy queue work is waited for before this frame draws
+    m_textureLoader->ProcessUploads(m_commandList.Get());
 
-    hr = m_device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&m_descriptorManager->rtvHeap));
-    if (FAILED(hr)) {
-        throw std::runtime_error("Failed to create RTV descriptor heap");
+    // Collect timings from the last frame that used this slot, then start this frame's
+    if (m_timestampsSupported) {
+        ReadGpuTimestamps(m_frameIndex);
+        frameContext.timestampPassMask = 1u << PASS_COUNT; // Mark frame queries as written
+        m_commandList->EndQuery(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP,
+            m_frameIndex * QUERIES_PER_FRAME);
     }
 
-    // Create CBV/SRV/UAV heap for ImGui and other resources
-    D3D12_DESCRIPTOR_HEAP_DESC cbvSrvUavHeapDesc = {};
-    cbvSrvUavHeapDesc.NumDescriptors = 1000; // Plenty of descriptors
-    cbvSrvUavHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    cbvSrvUavHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    // The frame's passes and targets; the scene's barriers go out in one call with the uploads'.
+    // A (re)placed scaled target is a new resource with its own views, the old one is retired
+    BuildFrameGraph();
+    m_renderGraph->BeginPass(m_frameGraph.scenePass, m_commandList.Get());
 
-    hr = m_device->CreateDescriptorHeap(&cbvSrvUavHeapDesc, IID_PPV_ARGS(&m_descriptorManager->cbvSrvUavHeap));
-    if (FAILED(hr)) {
-        throw std::runtime_error("Failed to create CBV/SRV/UAV descriptor heap");
+    // Draw into the scaled target when upscaling; the upscale pass overwrites the whole back buffer
+    D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = GetCurrentRenderTargetView();
+    int targetWidth = m_width;
+    int targetHeight = m_height;
+    if (m_upscalingThisFrame) {
+        rtvHandle = m_descriptorManager->GetRtvHandle(SCALED_TARGET_RTV_INDEX);
+        targetWidth = m_scaledTargetWidth;
+        targetHeight = m_scaledTargetHeight;
+    }
+    else if (m_swapChainScalingThisFrame) {
+        targetWidth = m_scaledWidth; // The part SetSourceSize shows
+        targetHeight = m_scaledHeight;
     }
 
-    // Set descriptor sizes
-    m_descriptorManager->rtvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
-    m_descriptorManager->dsvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
-    m_descriptorManager->cbvSrvUavDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-    m_descriptorManager->samplerDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
+    // Set render target
+    m_commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
 
-    // Create render targets
-    CreateRenderTargets();
+    // Clear render target
+    const float clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f }; // Fully transparent black
+    BeginGpuPass(GpuPass::Clear);
+    m_commandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
+    EndGpuPass(GpuPass::Clear);
 
-    // Create synchronization objects
-    CreateSyncObjects();
+    // Set viewport and scissor rect to the active target
+    D3D12_VIEWPORT viewport = {};
+    viewport.Width = static_cast<float>(targetWidth);
+    viewport.Height = static_cast<float>(targetHeight);
+    viewport.MinDepth = 0.0f;
+    viewport.MaxDepth = 1.0f;
+    viewport.TopLeftX = 0.0f;
+    viewport.TopLeftY = 0.0f;
 
-    // Initialize per-frame contexts
-    for (int i = 0; i < 3; i++) {
-        m_frameContexts[i] = std::make_unique<FrameContext>(m_device.Get());
-    }
+    D3D12_RECT scissorRect = {};
+    scissorRect.left = 0;
+    scissorRect.top = 0;
+    scissorRect.right = targetWidth;
+    scissorRect.bottom = targetHeight;
+
+    m_commandList->RSSetViewports(1, &viewport);
+    m_commandList->RSSetScissorRects(1, &scissorRect);
+
+    m_frameRtvHandle = rtvHandle;
+    m_frameViewport = viewport;
+    m_frameScissorRect = scissorRect;
 }
 
-void RenderSystem::CreateCommandObjects() {
-    // Create command queue
-    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
-    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
-    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+// --- Parallel Recording ---
+
+ID3D12GraphicsCommandList* RenderSystem::BeginRecording() {
+    RecordingContext* context = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_recordingMutex);
+        std::unique_ptr<RecordingContext>& slot = m_recordingContexts[std::this_thread::get_id()];
+        if (!slot) {
+            slot = std::make_unique<RecordingContext>();
+            slot->allocatorPool = std::make_unique<CommandAllocatorPool>(m_device.Get(), D3D12_COMMAND_LIST_TYPE_DIRECT,
+                m_fence.Get());
+        }
+        context = slot.get();
+    }
 
-    HRESULT hr = m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_commandQueue));
-    if (FAILED(hr)) {
-        throw std::runtime_error("Failed to create command queue");
+    // Only this thread touches its context until EndFrame
+    if (context->recording) {
+        throw std::runtime_error("BeginRecording called twice without EndRecording");
+    }
+    if (!context->allocator) {
+        context->allocator = context->allocatorPool->GetCommandAllocator();
     }
 
-    // Create command allocators
-    for (int i = 0; i < 3; i++) {
-        hr = m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_commandAllocators[i]));
+    if (context->usedCommandLists == context->commandLists.size()) {
+        ComPtr<ID3D12GraphicsCommandList> commandList;
+        HRESULT hr = m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, context->allocator, nullptr,
+            IID_PPV_ARGS(&commandList));
         if (FAILED(hr)) {
-            throw std::runtime_error("Failed to create command allocator");
+            throw std::runtime_error("Failed to create command list");
         }
+        commandList->Close();
+        context->commandLists.push_back(commandList);
     }
 
-    // Create command list
-    hr = m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_commandAllocators[0].Get(), nullptr, IID_PPV_ARGS(&m_commandList));
+    ID3D12GraphicsCommandList* commandList = context->commandLists[context->usedCommandLists++].Get();
+    HRESULT hr = commandList->Reset(context->allocator, nullptr);
     if (FAILED(hr)) {
-        throw std::runtime_error("Failed to create command list");
+        throw std::runtime_error("Failed to reset command list");
     }
 
-    // Close the command list as it's initially opened
-    m_commandList->Close();
+    ID3D12DescriptorHeap* heaps[] = { m_descriptorManager->cbvSrvUavHeap.Get() };
+    commandList->SetDescriptorHeaps(_countof(heaps), heaps);
+    BindFrameRenderTarget(commandList);
+
+    context->recording = commandList;
+    return commandList;
 }
 
-void RenderSystem::CreateSwapChain(HWND hwnd, int width, int height) {
-    // Create DXGI factory
-    ComPtr<IDXGIFactory4> factory;
-    HRESULT hr = CreateDXGIFactory2(0, IID_PPV_ARGS(&factory));
-    if (FAILED(hr)) {
-        throw std::runtime_error("Failed to create DXGI factory");
+void RenderSystem::BindFrameRenderTarget(ID3D12GraphicsCommandList* commandList) const {
+    commandList->OMSetRenderTargets(1, &m_frameRtvHandle, FALSE, nullptr);
+    commandList->RSSetViewports(1, &m_frameViewport);
+    commandList->RSSetScissorRects(1, &m_frameScissorRect);
+}
+
+CommandAllocatorPool::Stats RenderSystem::GetCommandAllocatorStats() {
+    CommandAllocatorPool::Stats total;
+    auto add = [&total](const CommandAllocatorPool::Stats& stats) {
+        total.totalAllocators += stats.totalAllocators;
+        total.outstandingAllocators += stats.outstandingAllocators;
+        total.inFlightAllocators += stats.inFlightAllocators;
+        total.freeAllocators += stats.freeAllocators;
+        total.peakAllocators += stats.peakAllocators;
+        total.acquires += stats.acquires;
+        total.recycled += stats.recycled;
+        total.created += stats.created;
+        total.destroyed += stats.destroyed;
+    };
+    if (m_copyAllocatorPool) {
+        add(m_copyAllocatorPool->GetStats());
     }
+    std::lock_guard<std::mutex> lock(m_recordingMutex);
+    for (const auto& pair : m_recordingContexts) {
+        add(pair.second->allocatorPool->GetStats());
+    }
+    return total;
+}
 
-    // Create swap chain description
-    DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
-    swapChainDesc.Width = width;
-    swapChainDesc.Height = height;
-    swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    swapChainDesc.SampleDesc.Count = 1;
-    swapChainDesc.SampleDesc.Quality = 0;
-    swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-    swapChainDesc.BufferCount = 3; // Triple buffering
-    swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
-    swapChainDesc.Flags = m_tearingSupported ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0;
+UINT RenderSystem::AddStaticLayer(StaticLayerRecorder recorder) {
+    StaticLayer layer;
+    layer.id = m_nextStaticLayerId++;
+    layer.recorder = std::move(recorder);
+    m_staticLayers.push_back(std::move(layer));
+    InvalidateFrame();
+    return m_staticLayers.back().id;
+}
 
-    ComPtr<IDXGISwapChain1> swapChain1;
-    hr = factory->CreateSwapChainForHwnd(
-        m_commandQueue.Get(),
-        hwnd,
-        &swapChainDesc,
-        nullptr,
-        nullptr,
-        &swapChain1
-    );
+void RenderSystem::RemoveStaticLayer(UINT id) {
+    auto it = std::find_if(m_staticLayers.begin(), m_staticLayers.end(),
+        [id](const StaticLayer& layer) { return layer.id == id; });
+    if (it == m_staticLayers.end()) return;
 
-    if (FAILED(hr)) {
-        throw std::runtime_error("Failed to create swap chain");
-    }
+    // Frames in flight may still replay the bundle
+    m_resourceManager->RetireResource(std::move(it->bundle));
+    m_resourceManager->RetireResource(std::move(it->allocator));
+    m_staticLayers.erase(it);
+    InvalidateFrame();
+}
 
-    // Convert to IDXGISwapChain3
-    hr = swapChain1.As(&m_swapChain);
-    if (FAILED(hr)) {
-        throw std::runtime_error("Failed to query IDXGISwapChain3 interface");
+void RenderSystem::InvalidateStaticLayers() {
+    for (StaticLayer& layer : m_staticLayers) {
+        if (layer.bundle) {
+            m_resourceManager->RetireResource(std::move(layer.bundle));
+            m_resourceManager->RetireResource(std::move(layer.allocator));
+        }
     }
-
-    // Get initial frame index
-    m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
+    InvalidateFrame();
 }
 
-void RenderSystem::CreateRenderTargets() {
-    for (UINT i = 0; i < 3; i++) {
-        // Get buffer from swap chain
-        HRESULT hr = m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_renderTargets[i]));
+bool RenderSystem::RecordStaticLayer(StaticLayer& layer) {
+    if (!layer.allocator) {
+        HRESULT hr = m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_BUNDLE, IID_PPV_ARGS(&layer.allocator));
         if (FAILED(hr)) {
-            throw std::runtime_error("Failed to get swap chain buffer");
+            throw std::runtime_error("Failed to create bundle allocator");
         }
-
-        // Create RTV
-        D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = m_descriptorManager->GetRtvHandle(i);
-        m_device->CreateRenderTargetView(m_renderTargets[i].Get(), nullptr, rtvHandle);
     }
-}
+    else {
+        layer.allocator->Reset(); // Only a failed recording left it in use, never a submitted bundle
+    }
 
-void RenderSystem::CreateSyncObjects() {
-    // Create fence
-    HRESULT hr = m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence));
+    ComPtr<ID3D12GraphicsCommandList> bundle;
+    HRESULT hr = m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_BUNDLE, layer.allocator.Get(), nullptr,
+        IID_PPV_ARGS(&bundle));
     if (FAILED(hr)) {
-        throw std::runtime_error("Failed to create fence");
+        throw std::runtime_error("Failed to create bundle");
     }
 
-    // Create fence event
-    m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-    if (m_fenceEvent == nullptr) {
-        throw std::runtime_error("Failed to create fence event");
+    bool recorded = layer.recorder(bundle.Get(), m_width, m_height);
+    hr = bundle->Close();
+    if (FAILED(hr)) {
+        LOG_WARNING("Failed to close static layer bundle");
+        return false;
+    }
+    if (recorded) {
+        layer.bundle = std::move(bundle);
     }
+    return recorded;
 }
 
-void RenderSystem::CheckTearingSupport() {
-    ComPtr<IDXGIFactory4> factory;
-    HRESULT hr = CreateDXGIFactory1(IID_PPV_ARGS(&factory));
+void RenderSystem::DrawStaticLayers() {
+    for (StaticLayer& layer : m_staticLayers) {
+        if (!layer.bundle && !RecordStaticLayer(layer)) {
+            InvalidateFrame(); // Try again next frame
+            continue;
+        }
+        m_commandList->ExecuteBundle(layer.bundle.Get());
+    }
+}
 
-    if (SUCCEEDED(hr)) {
-        ComPtr<IDXGIFactory5> factory5;
-        hr = factory.As(&factory5);
+bool RenderSystem::CopyToSceneTarget(ID3D12Resource* source) {
+    if (!source || IsRenderingScaled()) return false;
+    const D3D12_RESOURCE_DESC desc = source->GetDesc();
+    if (desc.Format != m_sceneFormat || desc.Width < static_cast<UINT64>(m_width) || desc.Height < static_cast<UINT>(m_height)) {
+        return false;
+    }
 
-        if (SUCCEEDED(hr)) {
-            BOOL allowTearing = FALSE;
-            hr = factory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing));
+    // The back buffer is the scene pass's render target; it goes back to that state for the UI
+    ID3D12Resource* target = GetCurrentRenderTarget();
+    m_resourceManager->QueueTransition(source, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    m_resourceManager->FlushBarriers(m_commandList.Get());
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Transition.pResource = target;
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
+    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+    m_commandList->ResourceBarrier(1, &barrier);
 
-            if (SUCCEEDED(hr)) {
-                m_tearingSupported = (allowTearing == TRUE);
-            }
-        }
-    }
+    D3D12_TEXTURE_COPY_LOCATION dst = {};
+    dst.pResource = target;
+    dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    D3D12_TEXTURE_COPY_LOCATION src = {};
+    src.pResource = source;
+    src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX; // Mip 0 of a converted texture
+    D3D12_BOX box = { 0, 0, 0, static_cast<UINT>(m_width), static_cast<UINT>(m_height), 1 };
+    m_commandList->CopyTextureRegion(&dst, 0, 0, 0, &src, &box);
+    // Nothing else marks the copy; with partial presentation it would never reach the screen
+    AddDirtyRect(RECT{ 0, 0, static_cast<LONG>(m_width), static_cast<LONG>(m_height) });
+
+    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
+    m_commandList->ResourceBarrier(1, &barrier);
+    m_resourceManager->BeginSplitTransition(source, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    return true;
 }
 
-void RenderSystem::BeginFrame() {
-    // Wait for the previous frame to finish
-    auto& frameContext = m_frameContexts[m_frameIndex];
-    frameContext->Reset();
+void RenderSystem::EndRecording(ID3D12GraphicsCommandList* commandList, int order) {
+    if (!commandList) return;
 
-    // Reset command list and allocator
-    HRESULT hr = m_commandAllocators[m_frameIndex]->Reset();
+    HRESULT hr = commandList->Close();
     if (FAILED(hr)) {
-        throw std::runtime_error("Failed to reset command allocator");
+        throw std::runtime_error("Failed to close recorded command list");
     }
 
-    hr = m_commandList->Reset(m_commandAllocators[m_frameIndex].Get(), nullptr);
-    if (FAILED(hr)) {
-        throw std::runtime_error("Failed to reset command list");
+    std::lock_guard<std::mutex> lock(m_recordingMutex);
+    auto it = m_recordingContexts.find(std::this_thread::get_id());
+    if (it != m_recordingContexts.end() && it->second->recording == commandList) {
+        it->second->recording = nullptr;
     }
+    m_recordedLists.push_back({ order, static_cast<UINT>(m_recordedLists.size()), commandList });
+}
 
-    // Transition render target to render target state
-    ID3D12Resource* currentRenderTarget = GetCurrentRenderTarget();
-    TransitionResource(currentRenderTarget, D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
+std::function<void()> RenderSystem::AddRecordingJob() {
+    m_outstandingRecordingJobs++;
+    return [this]() {
+        if (--m_outstandingRecordingJobs == 0 && m_submissionPending) {
+            m_submissionPending = false;
+            SubmitFrame(m_pendingSplitFrameList);
+        }
+    };
+}
 
-    // Set render target
-    D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = GetCurrentRenderTargetView();
-    m_commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+void RenderSystem::FlushPendingSubmission() {
+    // The render thread event stays set while continuations wait; the last one submits
+    while (m_submissionPending) {
+        WaitForSingleObject(JobSystem::Get().GetRenderThreadEvent(), INFINITE);
+        JobSystem::Get().RunRenderThreadContinuations();
+    }
+}
 
-    // Clear render target
-    const float clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f }; // Fully transparent black
-    m_commandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
+void RenderSystem::EndFrame() {
+    // Recorded lists run after everything recorded on the frame's list so far, so that part moves
+    // to its own list and the frame's list restarts for the upscale and present work
+    std::unique_lock<std::mutex> recordingLock(m_recordingMutex);
+    const bool splitFrameList = !m_recordedLists.empty() || m_outstandingRecordingJobs > 0;
+    if (splitFrameList) {
+        m_resourceManager->FlushBarriers(m_commandList.Get());
+        HRESULT hr = m_commandList->Close();
+        if (FAILED(hr)) {
+            throw std::runtime_error("Failed to close command list");
+        }
+        std::swap(m_commandList, m_frameHeadCommandList);
 
-    // Set viewport and scissor rect based on render scale
-    D3D12_VIEWPORT viewport = {};
-    viewport.Width = static_cast<float>(m_scaledWidth);
-    viewport.Height = static_cast<float>(m_scaledHeight);
-    viewport.MinDepth = 0.0f;
-    viewport.MaxDepth = 1.0f;
-    viewport.TopLeftX = 0.0f;
-    viewport.TopLeftY = 0.0f;
+        hr = m_commandList->Reset(m_frameContexts[m_frameIndex]->commandAllocator.Get(), nullptr);
+        if (FAILED(hr)) {
+            throw std::runtime_error("Failed to reset command list");
+        }
+        ID3D12DescriptorHeap* heaps[] = { m_descriptorManager->cbvSrvUavHeap.Get() };
+        m_commandList->SetDescriptorHeaps(_countof(heaps), heaps);
+        BindFrameRenderTarget(m_commandList.Get());
+    }
+    recordingLock.unlock();
 
-    D3D12_RECT scissorRect = {};
-    scissorRect.left = 0;
-    scissorRect.top = 0;
-    scissorRect.right = m_scaledWidth;
-    scissorRect.bottom = m_scaledHeight;
+    // Sprites still queued draw over the UI, recorded lists included
+    m_spriteBatch->Flush(m_commandList.Get());
 
-    m_commandList->RSSetViewports(1, &viewport);
-    m_commandList->RSSetScissorRects(1, &scissorRect);
-}
+    // Upscale the scaled target into the back buffer
+    if (m_upscalingThisFrame) {
+        RecordUpscalePass();
+    }
 
-void RenderSystem::EndFrame() {
-    // Transition render target to present state
-    ID3D12Resource* currentRenderTarget = GetCurrentRenderTarget();
-    TransitionResource(currentRenderTarget, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
+    // Copy into the shared layer and the screenshot readback, then the back buffer goes to present
+    if (m_frameGraph.sharedLayerPass != RENDER_GRAPH_NONE) {
+        m_renderGraph->BeginPass(m_frameGraph.sharedLayerPass, m_commandList.Get());
+        m_sharedLayer->RecordCopy(m_commandList.Get(), GetCurrentRenderTarget());
+    }
+    if (m_frameGraph.readbackPass != RENDER_GRAPH_NONE) {
+        m_renderGraph->BeginPass(m_frameGraph.readbackPass, m_commandList.Get());
+        m_frameReadback->RecordCopy(m_commandList.Get(), GetCurrentRenderTarget(),
+            m_frameContexts[m_frameIndex]->fenceValue);
+    }
+    m_resourceManager->EndSplitTransitions(); // None may stay open past Close
+    m_renderGraph->Finish(m_commandList.Get());
+
+    // Resolve this frame's timestamps into its readback slot
+    if (m_timestampsSupported) {
+        ResolveGpuTimestamps(m_frameIndex);
+    }
 
     // Close command list
     HRESULT hr = m_commandList->Close();
@@ -349,70 +1661,204 @@ void RenderSystem::EndFrame() {
         throw std::runtime_error("Failed to close command list");
     }
 
-    // Execute command list
-    ID3D12CommandList* ppCommandLists[] = { m_commandList.Get() };
-    m_commandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+    // Only frames that sample a fresh upload wait for the copy queue
+    if (m_copyFenceValueRequired > m_copyFenceValueWaited) {
+        m_commandQueue->Wait(m_copyFence.Get(), m_copyFenceValueRequired);
+        m_copyFenceValueWaited = m_copyFenceValueRequired;
+    }
+
+    // Recording jobs had until now. One still queued or running submits from its continuation, so
+    // the render thread isn't stalled behind background work on the same workers.
+    if (m_outstandingRecordingJobs > 0) {
+        m_submissionPending = true;
+        m_pendingSplitFrameList = splitFrameList;
+        return;
+    }
+    SubmitFrame(splitFrameList);
+}
+
+void RenderSystem::SubmitFrame(bool splitFrameList) {
+    // Execute the frame's lists in one submission
+    std::unique_lock<std::mutex> recordingLock(m_recordingMutex);
+    m_submitLists.clear();
+    if (splitFrameList) {
+        std::sort(m_recordedLists.begin(), m_recordedLists.end(), [](const RecordedList& a, const RecordedList& b) {
+            return a.order != b.order ? a.order < b.order : a.sequence < b.sequence;
+        });
+        m_submitLists.push_back(m_frameHeadCommandList.Get());
+        for (const RecordedList& recorded : m_recordedLists) {
+            m_submitLists.push_back(recorded.commandList);
+        }
+    }
+    m_submitLists.push_back(m_commandList.Get());
+    if (m_crossAdapterPresenter) {
+        m_crossAdapterPresenter->WaitForBuffer(m_commandQueue.Get(), m_backBufferIndex);
+    }
+    m_commandQueue->ExecuteCommandLists(static_cast<UINT>(m_submitLists.size()), m_submitLists.data());
+    if (m_crossAdapterPresenter) {
+        m_crossAdapterPresenter->SubmitCopy(m_commandQueue.Get(), m_backBufferIndex);
+    }
+    if (m_sharedLayer) {
+        m_sharedLayer->Publish(m_commandQueue.Get());
+
+        // The hook draws the frame into the game; showing it in our window too would draw it twice
+        bool showContent = !m_sharedLayer->IsConsumerAttached();
+        if (showContent != m_windowContentShown && m_dcompVisual) {
+            m_dcompVisual->SetContent(showContent ? m_swapChain.Get() : nullptr);
+            m_dcompDevice->Commit();
+            m_windowContentShown = showContent;
+        }
+    }
+#if GAMEOVERLAY_ENABLE_TRACY
+    TracyD3D12NewFrame(m_tracyGpuContext);
+    TracyD3D12Collect(m_tracyGpuContext);
+#endif
+
+    // Recording allocators go back to their pools, reusable once this frame's fence passes
+    m_recordedLists.clear();
+    for (auto& pair : m_recordingContexts) {
+        RecordingContext& context = *pair.second;
+        if (context.recording) {
+            LOG_WARNING("Command list still recording at EndFrame, discarded");
+            context.recording->Close();
+            context.recording = nullptr;
+        }
+        if (context.allocator) {
+            context.allocatorPool->ReleaseCommandAllocator(m_frameContexts[m_frameIndex]->fenceValue, context.allocator);
+            context.allocator = nullptr;
+        }
+        context.usedCommandLists = 0;
+    }
+    recordingLock.unlock();
+
+    // Present the frame; on a variable refresh display the frame limiter paces presents, not vblanks
+    const bool variableRefresh = IsVariableRefreshActive();
+    UINT syncInterval = (m_vsyncEnabled && !variableRefresh) ? 1 : 0;
+    UINT presentFlags = (m_tearingSupported && syncInterval == 0) ? DXGI_PRESENT_ALLOW_TEARING : 0;
+    m_displayStatistics.variableRefresh = variableRefresh;
+
+    // Only the union of this and the previous frame's content changed (everything else stays cleared)
+    m_presentRects.clear();
+    // Dirty rects are in window pixels, which a stretched source doesn't have
+    bool partial = m_partialPresentation && !m_forceFullPresent && !m_swapChainScalingThisFrame && !m_dirtyRects.empty();
+    if (partial) {
+        m_presentRects.insert(m_presentRects.end(), m_dirtyRects.begin(), m_dirtyRects.end());
+        m_presentRects.insert(m_presentRects.end(), m_previousDirtyRects.begin(), m_previousDirtyRects.end());
+    }
+
+    m_lastPresentedPixels = 0;
+    for (const RECT& rect : m_presentRects) {
+        m_lastPresentedPixels += static_cast<UINT64>(rect.right - rect.left) * (rect.bottom - rect.top);
+    }
+
+    // Overlapping rects can count twice; past full screen just present everything
+    if (m_lastPresentedPixels >= GetBackBufferPixels()) {
+        m_presentRects.clear();
+    }
+    if (m_presentRects.empty()) {
+        m_lastPresentedPixels = GetBackBufferPixels();
+    }
+
+    DXGI_PRESENT_PARAMETERS presentParams = {};
+    presentParams.DirtyRectsCount = static_cast<UINT>(m_presentRects.size());
+    presentParams.pDirtyRects = m_presentRects.empty() ? nullptr : m_presentRects.data();
 
-    // Present the frame
-    UINT syncInterval = m_vsyncEnabled ? 1 : 0;
-    UINT presentFlags = (m_tearingSupported && !m_vsyncEnabled) ? DXGI_PRESENT_ALLOW_TEARING : 0;
+    auto presentStart = std::chrono::high_resolution_clock::now();
+    HRESULT hr;
+    {
+        PROFILE_ZONE("Present");
+        hr = m_swapChain->Present1(syncInterval, presentFlags, &presentParams);
+    }
+    m_lastPresentMs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - presentStart).count() / 1000.0f;
+
+    m_previousDirtyRects.swap(m_dirtyRects);
+    m_dirtyRects.clear();
+    m_forceFullPresent = false;
 
-    hr = m_swapChain->Present(syncInterval, presentFlags);
     if (FAILED(hr)) {
         throw std::runtime_error("Failed to present swap chain");
     }
+    m_occluded = (hr == DXGI_STATUS_OCCLUDED);
+
+    // DWM only reassigns planes occasionally, so the mode is polled rather than read every present
+    if (++m_presentCount % PRESENTATION_MODE_POLL_INTERVAL == 1) {
+        UpdatePresentationMode();
+    }
+    if (m_presentCount % OUTPUT_POLL_INTERVAL == 1) {
+        UpdateOutputProperties();
+    }
+    m_lastSyncInterval = syncInterval;
+    UpdateDisplayStatistics();
+    m_frameBrowserPaintQpc = 0;
+    m_frameInputQpc = 0;
 
     // Signal and advance frame
-    const UINT64 currentFenceValue = m_fenceValues[m_frameIndex];
+    const UINT64 currentFenceValue = m_frameContexts[m_frameIndex]->fenceValue;
     hr = m_commandQueue->Signal(m_fence.Get(), currentFenceValue);
     if (FAILED(hr)) {
         throw std::runtime_error("Failed to signal fence");
     }
+    m_lastSignaledFenceValue = currentFenceValue;
 
     // Move to next frame
     MoveToNextFrame();
+    m_frameLatencyWaited = false;
 }
 
 void RenderSystem::MoveToNextFrame() {
-    // Update the frame index
-    const UINT64 currentFenceValue = m_fenceValues[m_frameIndex];
-    m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
+    // Advance the frame context ring; the back buffer follows the swap chain, which has at least
+    // as many buffers as there are contexts
+    const UINT64 currentFenceValue = m_frameContexts[m_frameIndex]->fenceValue;
+    m_frameIndex = (m_frameIndex + 1) % m_frameCount;
+    m_backBufferIndex = m_swapChain->GetCurrentBackBufferIndex();
+
+    // The next frame may only start once the GPU is done with this slot; BeginFrame (or the
+    // main loop, via GetFrameReadyEvent) waits for it instead of blocking here. With one frame in
+    // flight that is the frame just submitted.
+    FrameContext& nextContext = *m_frameContexts[m_frameIndex];
+    m_frameReadyFenceValue = nextContext.fenceValue;
 
-    // If the next frame is not ready to be rendered yet, wait until it is
-    if (m_fence->GetCompletedValue() < m_fenceValues[m_frameIndex]) {
-        HRESULT hr = m_fence->SetEventOnCompletion(m_fenceValues[m_frameIndex], m_fenceEvent);
-        if (FAILED(hr)) {
-            throw std::runtime_error("Failed to set fence event");
-        }
+    // Set the fence value for the next frame
+    nextContext.fenceValue = currentFenceValue + 1;
+}
 
-        WaitForSingleObject(m_fenceEvent, INFINITE);
+void RenderSystem::EnableSharedLayer() {
+    if (m_sharedLayer) return;
+    m_sharedLayer = std::make_unique<SharedLayer>(m_device.Get());
+    if (!m_sharedLayer->IsAvailable()) {
+        m_sharedLayer.reset();
     }
-
-    // Set the fence value for the next frame
-    m_fenceValues[m_frameIndex] = currentFenceValue + 1;
 }
 
 ID3D12Resource* RenderSystem::GetCurrentRenderTarget() const {
-    return m_renderTargets[m_frameIndex].Get();
+    return m_renderTargets[m_backBufferIndex].Get();
 }
 
 D3D12_CPU_DESCRIPTOR_HANDLE RenderSystem::GetCurrentRenderTargetView() const {
-    return m_descriptorManager->GetRtvHandle(m_frameIndex);
+    return m_descriptorManager->GetRtvHandle(m_backBufferIndex);
 }
 
 UINT RenderSystem::GetCurrentBackBufferIndex() const {
-    return m_frameIndex;
+    return m_backBufferIndex;
 }
 
 void RenderSystem::WaitForGpu() {
+    FlushPendingSubmission();
+
+    // Pending uploads first, so nothing on the copy queue outlives a resize or shutdown
+    WaitForCopyQueue();
+
     // Schedule a signal command
-    HRESULT hr = m_commandQueue->Signal(m_fence.Get(), m_fenceValues[m_frameIndex]);
+    FrameContext& frameContext = *m_frameContexts[m_frameIndex];
+    HRESULT hr = m_commandQueue->Signal(m_fence.Get(), frameContext.fenceValue);
     if (FAILED(hr)) {
         throw std::runtime_error("Failed to signal fence");
     }
+    m_lastSignaledFenceValue = frameContext.fenceValue;
 
     // Wait until the GPU has completed the command
-    hr = m_fence->SetEventOnCompletion(m_fenceValues[m_frameIndex], m_fenceEvent);
+    hr = m_fence->SetEventOnCompletion(frameContext.fenceValue, m_fenceEvent);
     if (FAILED(hr)) {
         throw std::runtime_error("Failed to set fence event");
     }
@@ -420,12 +1866,14 @@ void RenderSystem::WaitForGpu() {
     WaitForSingleObject(m_fenceEvent, INFINITE);
 
     // Increment the fence value for the current frame
-    m_fenceValues[m_frameIndex]++;
+    frameContext.fenceValue++;
 }
 
 void RenderSystem::WaitForFrame(UINT frameIndex) {
-    if (m_fence->GetCompletedValue() < m_fenceValues[frameIndex]) {
-        HRESULT hr = m_fence->SetEventOnCompletion(m_fenceValues[frameIndex], m_fenceEvent);
+    // The current slot waits for its previous submission, which MoveToNextFrame recorded
+    UINT64 fenceValue = (frameIndex == m_frameIndex) ? m_frameReadyFenceValue : m_frameContexts[frameIndex]->fenceValue;
+    if (m_fence->GetCompletedValue() < fenceValue) {
+        HRESULT hr = m_fence->SetEventOnCompletion(fenceValue, m_fenceEvent);
         if (FAILED(hr)) {
             throw std::runtime_error("Failed to set fence event");
         }
@@ -434,23 +1882,50 @@ void RenderSystem::WaitForFrame(UINT frameIndex) {
     }
 }
 
-void RenderSystem::TransitionResource(ID3D12Resource* resource, D3D12_RESOURCE_STATES beforeState, D3D12_RESOURCE_STATES afterState) {
-    D3D12_RESOURCE_BARRIER barrier = {};
-    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-    barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-    barrier.Transition.pResource = resource;
-    barrier.Transition.StateBefore = beforeState;
-    barrier.Transition.StateAfter = afterState;
-    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+void RenderSystem::RequestResize(int width, int height) {
+    if (width <= 0 || height <= 0) return;
+    if (!m_resizePending && width == m_width && height == m_height) return;
 
-    m_commandList->ResourceBarrier(1, &barrier);
+    m_resizePending = true;
+    m_pendingWidth = width;
+    m_pendingHeight = height;
+    m_lastResizeRequest = std::chrono::steady_clock::now();
+    InvalidateFrame();
+}
+
+void RenderSystem::ApplyPendingResize() {
+    if (!m_resizePending) return;
+
+    // Until the size settles, the old buffers are stretched to the window
+    auto sinceRequest = std::chrono::steady_clock::now() - m_lastResizeRequest;
+    if (sinceRequest < std::chrono::milliseconds(RESIZE_DEBOUNCE_MS)) {
+        InvalidateFrame(); // Come back next frame
+        return;
+    }
+
+    m_resizePending = false;
+    if (m_pendingWidth != m_width || m_pendingHeight != m_height) {
+        Resize(m_pendingWidth, m_pendingHeight);
+    }
+}
+
+void RenderSystem::WaitForSubmittedFrames() {
+    if (m_fence->GetCompletedValue() >= m_lastSignaledFenceValue) return;
+
+    HRESULT hr = m_fence->SetEventOnCompletion(m_lastSignaledFenceValue, m_fenceEvent);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to set fence event");
+    }
+
+    WaitForSingleObject(m_fenceEvent, INFINITE);
 }
 
 void RenderSystem::Resize(int width, int height) {
     if (width <= 0 || height <= 0 || !m_device) return;
 
-    // Wait for GPU to finish all work
-    WaitForGpu();
+    // ResizeBuffers requires the back buffers to be idle; only submitted frames can use them,
+    // so no new signal (or copy queue drain) is needed
+    WaitForSubmittedFrames();
 
     // Update dimensions
     m_width = width;
@@ -462,32 +1937,67 @@ void RenderSystem::Resize(int width, int height) {
     m_scaledWidth = std::max(m_scaledWidth, 1);
     m_scaledHeight = std::max(m_scaledHeight, 1);
 
-    // Release old resources
-    for (int i = 0; i < 3; i++) {
+    ResizeSwapChainBuffers();
+    InvalidateStaticLayers();
+}
+
+void RenderSystem::SetFramesInFlight(UINT frames) {
+    frames = std::max(1u, std::min(frames, MAX_FRAMES_IN_FLIGHT));
+    m_pendingFrameCount = (frames == m_frameCount) ? 0 : frames;
+}
+
+void RenderSystem::ApplyPendingFrameCount() {
+    if (m_pendingFrameCount == 0) return;
+
+    UINT frameCount = m_pendingFrameCount;
+    m_pendingFrameCount = 0;
+
+    // Every context may be in flight and ResizeBuffers needs the back buffers idle
+    WaitForSubmittedFrames();
+
+    m_frameCount = frameCount;
+    m_backBufferCount = std::max(frameCount, MIN_BACK_BUFFERS);
+    m_frameIndex = 0; // A larger latency setting is harmless: the context wait bounds the queue
+    ResizeSwapChainBuffers();
+}
+
+void RenderSystem::ResizeSwapChainBuffers() {
+    // Release old resources (and their tracked states; new buffers may reuse the addresses)
+    for (UINT i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        m_resourceManager->ReleaseResource(m_renderTargets[i].Get());
         m_renderTargets[i].Reset();
     }
+    if (m_crossAdapterPresenter) {
+        m_crossAdapterPresenter->ReleaseBuffers(); // Its references to the back buffers too
+    }
 
-    // Resize swap chain buffers
-    DXGI_SWAP_CHAIN_DESC swapChainDesc = {};
-    m_swapChain->GetDesc(&swapChainDesc);
-
+    // Resize swap chain buffers (the format changes with HDR output)
     HRESULT hr = m_swapChain->ResizeBuffers(
-        3, // Triple buffering
+        m_backBufferCount,
         m_width,
         m_height,
-        swapChainDesc.BufferDesc.Format,
-        m_tearingSupported ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0
+        m_backBufferFormat,
+        m_swapChainFlags
     );
 
     if (FAILED(hr)) {
         throw std::runtime_error("Failed to resize swap chain buffers");
     }
 
-    // Update frame index
-    m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
+    // Update back buffer index; the current frame context continues the fence sequence
+    m_backBufferIndex = m_swapChain->GetCurrentBackBufferIndex();
+    m_frameContexts[m_frameIndex]->fenceValue = m_lastSignaledFenceValue + 1;
+    m_frameReadyFenceValue = m_lastSignaledFenceValue;
 
     // Recreate render targets
     CreateRenderTargets();
+    m_sourceWidth = 0; // ResizeBuffers resets the source size to the whole buffer
+    m_sourceHeight = 0;
+
+    // New buffers have no content yet
+    m_forceFullPresent = true;
+    m_previousDirtyRects.clear();
+    InvalidateFrame();
 }
 
 void RenderSystem::SetRenderScale(float scale) {
@@ -504,13 +2014,47 @@ void RenderSystem::SetRenderScale(float scale) {
         // Ensure minimum size
         m_scaledWidth = std::max(m_scaledWidth, 1);
         m_scaledHeight = std::max(m_scaledHeight, 1);
+
+        m_forceFullPresent = true;
+        InvalidateFrame();
+    }
+}
+
+void RenderSystem::SetUpscaleMode(UpscaleMode mode) {
+    if (m_upscaleMode == mode) return;
+    m_upscaleMode = mode;
+    m_forceFullPresent = true;
+    InvalidateFrame();
+}
+
+void RenderSystem::ApplySourceSize() {
+    const int width = m_swapChainScalingThisFrame ? m_scaledWidth : 0;
+    const int height = m_swapChainScalingThisFrame ? m_scaledHeight : 0;
+    if (width == m_sourceWidth && height == m_sourceHeight) return;
+
+    HRESULT hr = m_swapChain->SetSourceSize(width > 0 ? width : m_width, height > 0 ? height : m_height);
+    if (FAILED(hr)) {
+        // Stays on the shader pass from here on
+        LOG_WARNING("SetSourceSize failed (0x%08X), upscaling with the shader pass", static_cast<unsigned>(hr));
+        m_upscaleMode = UpscaleMode::Shader;
+        m_swapChainScalingThisFrame = false;
+        m_upscalingThisFrame = ShouldUpscale() || m_hdrOutput;
+        return;
     }
+    m_sourceWidth = width;
+    m_sourceHeight = height;
+    m_forceFullPresent = true;
 }
 
 void RenderSystem::SetVSync(bool enabled) {
     m_vsyncEnabled = enabled;
 }
 
+float RenderSystem::GetVariableRefreshFrameRateCap() const {
+    if (!IsVariableRefreshActive()) return 0.0f;
+    return std::max(m_maxRefreshRateHz - VARIABLE_REFRESH_CAP_MARGIN_HZ, 1.0f);
+}
+
 void RenderSystem::AdaptToPerformanceState(PerformanceState state, ResourceUsageLevel level) {
     // Adjust rendering parameters based on performance state
     switch (state) {
@@ -574,13 +2118,37 @@ void RenderSystem::AdaptToPerformanceState(PerformanceState state, ResourceUsage
 }
 
 void RenderSystem::ReleaseResources() {
+    // Stops the decode workers and retires the image textures
+    m_textureLoader.reset();
+    m_spriteBatch.reset();
+    m_sharedLayer.reset();
+    m_frameReadback.reset(); // Waits for its encode jobs
+
     // Release render targets
-    for (int i = 0; i < 3; i++) {
+    for (UINT i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
         m_renderTargets[i].Reset();
     }
+    m_crossAdapterPresenter.reset(); // Waits for its last copy
+    m_renderGraph.reset(); // Retires the transients
+    m_scaledRenderTarget = nullptr;
+
+    // Release composition tree before the swap chain it references
+    m_dcompVisual.Reset();
+    m_dcompTarget.Reset();
+    m_dcompDevice.Reset();
+    m_swapChainMedia.Reset();
+
+    m_staticLayers.clear();
+
+    // Release copy queue objects
+    m_copyCommandList.Reset();
+    m_copyAllocatorPool.reset();
+    m_copyQueue.Reset();
+    m_copyFence.Reset();
 
-    // Let ResourceManager clean up its resources
+    // Let ResourceManager clean up its resources (GPU is idle by now)
     if (m_resourceManager) {
+        m_resourceManager->FlushRetiredResources();
         m_resourceManager->ClearCache();
     }
 }
\ No newline at end of file
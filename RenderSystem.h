@@ -6,6 +6,7 @@
 
 #include <d3d12.h>
 #include <dxgi1_6.h>
+#include <dcomp.h>
 #include <DirectXMath.h>
 #include <wrl/client.h>
 #include <string>
@@ -13,23 +14,71 @@
 #include <vector>
 #include <queue>
 #include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+#include <functional>
 #include <Windows.h>
 #include "PerformanceOptimizer.h"
+#include "PerformanceMonitor.h"
+#include "PipelineStateManager.h"
+#include "ResourceManager.h"
+#include "TextureLoader.h"
+#include "SpriteBatch.h"
+#include "CommandAllocatorPool.h"
+#include "CpuProfiler.h"
+#include "SharedLayer.h"
+#include "FrameReadback.h"
+#include "SharedTextureCopier.h"
+#include "CrossAdapterPresenter.h"
+#include "RenderGraph.h"
+#if GAMEOVERLAY_ENABLE_TRACY
+#include <tracy/TracyD3D12.hpp>
+#endif
 
 #pragma comment(lib, "d3d12.lib")
 #pragma comment(lib, "dxgi.lib")
+#pragma comment(lib, "dcomp.lib")
 
 using Microsoft::WRL::ComPtr;
 
-class ResourceManager;
 
 // Forward declarations for DirectX 12 helper structures
-struct FrameContext;
 struct DescriptorHeapManager;
+struct CpuProfileLane;
+
+// Per-frame context: what one frame in flight owns until the GPU passes its fence value
+struct FrameContext {
+    ComPtr<ID3D12CommandAllocator> commandAllocator;
+    UINT64 fenceValue = 0;
+    ComPtr<ID3D12Resource> timestampReadback; // Resolved timestamps, read when the slot comes round again
+    std::atomic<UINT> timestampPassMask{ 0 }; // Passes written in the frame (recording jobs too)
+
+    FrameContext(ID3D12Device* device);
+    void Reset();
+};
+
+// Adapter selection policy (maps to DXGI_GPU_PREFERENCE)
+enum class GpuPreference {
+    MinimumPower,    // Integrated GPU on hybrid systems, leaves the discrete GPU to the game
+    HighPerformance,
+    Unspecified      // DXGI enumeration order
+};
+
+// Where a render scale below 1.0 is brought back up to the window's size
+enum class UpscaleMode {
+    Shader,   // Upscale pass from an offscreen target into the back buffer (filtered, sharpened)
+    SwapChain // Drawn at the scaled size into the back buffer's corner; DXGI stretches it (SetSourceSize)
+};
 
 class RenderSystem {
 public:
-    RenderSystem(HWND hwnd, int width, int height);
+    // useComposition: create a premultiplied-alpha composition swap chain bound via DirectComposition
+    // preferOverlayPlane: pick a back buffer format the output can scan out on a hardware overlay plane
+    RenderSystem(HWND hwnd, int width, int height, bool useComposition = false,
+        GpuPreference gpuPreference = GpuPreference::MinimumPower, bool preferOverlayPlane = true);
     ~RenderSystem();
 
     // Disable copy and move
@@ -43,24 +92,235 @@ public:
     void EndFrame();
 
     // Resize handling
+    // RequestResize debounces (e.g. while dragging a window edge) and lets BeginFrame apply the
+    // final size; Resize applies it immediately
+    void RequestResize(int width, int height);
     void Resize(int width, int height);
 
+    // Render-on-demand damage tracking (thread-safe)
+    // Marks the overlay dirty; the next few frames are rendered so ImGui can settle after input
+    void InvalidateFrame();
+    // Returns true if a frame should be rendered, consuming one pending redraw
+    bool ConsumeFrameInvalidation();
+    bool IsFrameInvalidated() const { return m_pendingRedrawFrames.load() > 0; }
+
+    // Occlusion: set when Present reports nothing of the window is visible
+    // While occluded the caller stops submitting and polls TestOcclusion at a low rate
+    bool IsOccluded() const { return m_occluded; }
+    bool TestOcclusion(); // DXGI_PRESENT_TEST; returns true while still occluded
+
+    // Partial presentation (Present1 dirty rects, in back buffer pixels)
+    // Rects added during a frame are merged with the previous frame's rects at EndFrame
+    void AddDirtyRect(const RECT& rect);
+    void SetPartialPresentationEnabled(bool enabled) { m_partialPresentation = enabled; }
+    bool IsPartialPresentationEnabled() const { return m_partialPresentation; }
+    void SetPresentRectDebugEnabled(bool enabled) { m_showPresentRects = enabled; }
+    bool IsPresentRectDebugEnabled() const { return m_showPresentRects; }
+    UINT64 GetLastPresentedPixels() const { return m_lastPresentedPixels; }
+    UINT64 GetBackBufferPixels() const { return static_cast<UINT64>(m_width) * m_height; }
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+
     // Performance optimization methods
     void SetRenderScale(float scale);
     float GetRenderScale() const { return m_renderScale; }
     void SetVSync(bool enabled);
     bool IsVSyncEnabled() const { return m_vsyncEnabled; }
+
+    // Variable refresh (G-Sync / FreeSync): with tearing support the display can follow our presents,
+    // so they go out with sync interval 0 and tearing allowed whatever the vsync setting, and the
+    // frame limiter keeps them just under the output's maximum refresh (GetVariableRefreshFrameRateCap)
+    // instead. DXGI can't tell whether the monitor has VRR switched on; without it this is plain
+    // tearing at a capped rate, which for a mostly static overlay is hard to spot.
+    void SetVariableRefreshEnabled(bool enabled) { m_variableRefreshEnabled = enabled; }
+    bool IsVariableRefreshActive() const { return m_variableRefreshEnabled && m_tearingSupported && m_maxRefreshRateHz > 0.0f; }
+    float GetMaxRefreshRateHz() const { return m_maxRefreshRateHz; } // Current mode of the window's output
+    float GetVariableRefreshFrameRateCap() const; // 0 while not active
     void AdaptToPerformanceState(PerformanceState state, ResourceUsageLevel level);
 
+    // Render-scale upscaling: below scale 1.0 the frame is drawn into an offscreen
+    // target at the scaled size and upscaled into the back buffer at EndFrame
+    void SetPipelineStateManager(PipelineStateManager* pipelineStateManager) { m_pipelineStateManager = pipelineStateManager; }
+    void SetUpscaleFilter(UpscaleFilter filter) { m_upscaleFilter = filter; }
+    UpscaleFilter GetUpscaleFilter() const { return m_upscaleFilter; }
+    void SetUpscaleSharpness(float sharpness) { m_upscaleSharpness = std::max(0.0f, std::min(sharpness, 1.0f)); }
+    float GetUpscaleSharpness() const { return m_upscaleSharpness; }
+    bool IsUpscaling() const { return m_upscalingThisFrame; }
+    // The swap chain scales instead: no pass, no target, no ResizeBuffers when the scale moves, and
+    // the composition engine (or the display's scaler) pays for the stretch. Bilinear only. Frames
+    // with HDR output, a shared layer or a screenshot still take the shader pass.
+    void SetUpscaleMode(UpscaleMode mode);
+    UpscaleMode GetUpscaleMode() const { return m_upscaleMode; }
+    bool IsSwapChainScaling() const { return m_swapChainScalingThisFrame; }
+    // Drawing at GetScaledWidth/Height this frame, by either mode
+    bool IsRenderingScaled() const { return m_upscalingThisFrame || m_swapChainScalingThisFrame; }
+    int GetScaledWidth() const { return m_scaledWidth; }
+    int GetScaledHeight() const { return m_scaledHeight; }
+
+    // Frame latency control (waitable swap chain)
+    // Blocks until the swap chain can accept a new frame; called by BeginFrame if not done earlier
+    void WaitForFrameLatency();
+    void SetMaximumFrameLatency(UINT maxLatency);
+    UINT GetMaximumFrameLatency() const { return m_maxFrameLatency; }
+    // Frames in flight (1-3): frame contexts the CPU may record ahead of the GPU. One keeps the least
+    // queued; below three the swap chain also drops a back buffer (flip model keeps at least two).
+    // Applied by the next BeginFrame, which waits for submitted frames once.
+    static constexpr UINT MAX_FRAMES_IN_FLIGHT = 3;
+    void SetFramesInFlight(UINT frames);
+    UINT GetFramesInFlight() const { return m_frameCount; }
+    UINT GetBackBufferCount() const { return m_backBufferCount; }
+    void SetFrameLatencyWaitEnabled(bool enabled) { m_frameLatencyWaitEnabled = enabled; }
+    bool IsFrameLatencyWaitEnabled() const { return m_frameLatencyWaitEnabled; }
+    float GetLastFrameLatencyWaitMs() const { return m_lastFrameLatencyWaitMs; }
+    // Blocked inside the last BeginFrame/EndFrame: on the GPU releasing the frame slot, and in
+    // Present plus the latency wait BeginFrame did itself (the main loop times its own waits)
+    float GetLastFrameSlotWaitMs() const { return m_lastFrameSlotWaitMs; }
+    float GetLastPresentBlockMs() const { return m_lastPresentMs + m_beginFrameLatencyWaitMs; }
+
+    // Non-blocking frame readiness for event-driven loops
+    // Handles are nullptr when there is nothing to wait for. Waiting on the latency object consumes
+    // its count, so report the result through CompleteFrameLatencyWait.
+    HANDLE GetFrameLatencyWaitableObject() const;
+    void CompleteFrameLatencyWait(bool signaled, float waitedMs);
+    bool IsFrameLatencyReady(); // Polls (and acquires) the latency object
+    HANDLE GetFrameReadyEvent(); // Armed for the GPU releasing the next frame's resources
+    bool IsFrameSlotReady() const { return !m_submissionPending && m_fence->GetCompletedValue() >= m_frameReadyFenceValue; }
+
+    // GPU timestamp profiling (results lag a few frames so reading never stalls)
+    void BeginGpuPass(GpuPass pass);
+    void EndGpuPass(GpuPass pass);
+    // For a pass recorded into a BeginRecording list
+    void BeginGpuPass(GpuPass pass, ID3D12GraphicsCommandList* commandList);
+    void EndGpuPass(GpuPass pass, ID3D12GraphicsCommandList* commandList);
+    bool AreGpuTimestampsSupported() const { return m_timestampsSupported; }
+    float GetGpuFrameTimeMs() const { return m_gpuFrameTimeMs; }
+    UINT64 GetGpuTimingSampleCount() const { return m_gpuTimingSamples; } // Frames read back so far
+    float GetGpuPassTimeMs(GpuPass pass) const { return m_gpuPassTimesMs[static_cast<size_t>(pass)]; }
+
+    // Dedicated copy queue for uploads that overlap rendering
+    // BeginCopyCommands returns an open COPY list (nullptr without a copy queue); textures written on it
+    // must be in the COMMON state. SubmitCopyCommands executes it and the next frame's direct
+    // submission waits for it on the GPU; detached (directQueueWaits false) nothing waits, and the
+    // owner polls GetCompletedCopyFenceValue against GetLastCopyFenceValue before using the result.
+    bool HasCopyQueue() const { return m_copyQueue != nullptr; }
+    // D3D12_HEAP_TYPE_GPU_UPLOAD: CPU-written resources in VRAM the GPU reads without a copy.
+    // False when built against headers without it (GAMEOVERLAY_GPU_UPLOAD_HEAP)
+    bool SupportsGpuUploadHeap() const { return m_gpuUploadHeapSupported; }
+    ID3D12GraphicsCommandList* BeginCopyCommands();
+    void SubmitCopyCommands(bool directQueueWaits = true);
+    UINT64 GetLastCopyFenceValue() const { return m_copyFenceValue; }
+    UINT64 GetCompletedCopyFenceValue() const { return m_copyFence ? m_copyFence->GetCompletedValue() : m_copyFenceValue; }
+
+    // GPU scheduling priority of a whole process against the others (the game). D3D12 queues have
+    // no priority below normal, and SetGPUThreadPriority needs a DXGI device D3D12 doesn't expose,
+    // so yielding drops the process's scheduling class (D3DKMT) to below normal instead.
+    static bool SetProcessGpuPriorityYield(HANDLE process, bool yield);
+    bool SetGpuPriorityYield(bool yield); // This process
+    bool IsGpuPriorityYielded() const { return m_gpuPriorityYielded; }
+
+    // --- Parallel Recording ---
+    // Any thread may record frame work into its own command list between BeginFrame and EndFrame;
+    // each thread has its own allocators (a per-thread CommandAllocatorPool). BeginRecording returns
+    // an open list with the descriptor heap, frame render target, viewport and scissor set;
+    // EndRecording closes it. EndFrame executes everything in one ExecuteCommandLists: the frame's
+    // own list first, then recorded lists by ascending order (then by EndRecording call), then the
+    // upscale and present work. Recorded lists transition resources with their own barriers, since
+    // the ResourceManager barrier queue belongs to the frame's list; every recording must be ended
+    // before EndFrame. Sprites still queued at EndFrame draw after the recorded lists.
+    // A job that records (ImGui's) takes AddRecordingJob's result as its render thread continuation;
+    // EndFrame records its own passes meanwhile. If one is still running then, EndFrame returns and
+    // the last continuation submits and presents, so the render thread pumps messages instead of
+    // blocking on it; IsFrameSlotReady stays false until then. FlushPendingSubmission waits for it.
+    ID3D12GraphicsCommandList* BeginRecording();
+    std::function<void()> AddRecordingJob();
+    bool IsSubmissionPending() const { return m_submissionPending; }
+    void FlushPendingSubmission();
+    // Sets this frame's render target, viewport and scissor on commandList (e.g. after drawing offscreen)
+    void BindFrameRenderTarget(ID3D12GraphicsCommandList* commandList) const;
+    void EndRecording(ID3D12GraphicsCommandList* commandList, int order = 0);
+    // Copy queue and recording pools combined (the frame allocators are fixed, one per frame)
+    CommandAllocatorPool::Stats GetCommandAllocatorStats();
+    RenderGraph::Stats GetRenderGraphStats() const { return m_renderGraph ? m_renderGraph->GetStats() : RenderGraph::Stats(); }
+
+    // --- Static Layers ---
+    // Draws whose geometry only changes on resize or theme change (overlay chrome, HUD backgrounds)
+    // are recorded once into a bundle and replayed every frame. The recorder gets the open bundle and
+    // the window size; it sets its own root signature, pipeline and (if it binds tables) the frame's
+    // descriptor heap, and inherits the render target, viewport and scissor. It returns false when it
+    // can't record yet (e.g. its pipeline is still compiling) and is asked again next frame.
+    // Layers are recorded again after InvalidateStaticLayers, which Resize calls.
+    using StaticLayerRecorder = std::function<bool(ID3D12GraphicsCommandList* bundle, int width, int height)>;
+    UINT AddStaticLayer(StaticLayerRecorder recorder); // Returns an id for RemoveStaticLayer
+    void RemoveStaticLayer(UINT id);
+    void InvalidateStaticLayers();
+    // Replays the layers, in the order added, on the frame's command list (call before the UI draws)
+    void DrawStaticLayers();
+    // Copies the top left of source 1:1 over the whole scene target, for a frame the source covers
+    // entirely (a maximized browser page). False, with nothing recorded, when the target is upscaled
+    // or the format or size doesn't allow a plain copy; draw the source instead then. The copied
+    // region is added as a dirty rect
+    bool CopyToSceneTarget(ID3D12Resource* source);
+
+    // --- Present Hook ---
+    // With the shared layer enabled every finished frame is also copied into a texture shared with
+    // GameOverlayHook.dll, which draws it into the game's own back buffer from its Present hook.
+    // While the hook is drawing, the composition visual is detached: the window stays for input,
+    // but DWM has nothing of ours to compose (composition mode only).
+    void EnableSharedLayer();
+    SharedLayer* GetSharedLayer() const { return m_sharedLayer.get(); }
+    FrameReadback* GetFrameReadback() const { return m_frameReadback.get(); }
+    SharedTextureCopier* GetSharedTextureCopier() const { return m_sharedTextureCopier.get(); } // CEF paints
+    bool IsShowingWindowContent() const { return m_windowContentShown; }
+
     // Resource management
     ResourceManager* GetResourceManager() const { return m_resourceManager.get(); }
+    PipelineStateManager* GetPipelineStateManager() const { return m_pipelineStateManager; }
+    TextureLoader* GetTextureLoader() const { return m_textureLoader.get(); } // UI images
+    SpriteBatch* GetSpriteBatch() const { return m_spriteBatch.get(); }       // HUD markers
 
     // Getters for DirectX 12 resources (for ImGui integration and other components)
     ID3D12Device* GetDevice() const { return m_device.Get(); }
     ID3D12GraphicsCommandList* GetCommandList() const { return m_commandList.Get(); }
     ID3D12CommandQueue* GetCommandQueue() const { return m_commandQueue.Get(); }
     DescriptorHeapManager* GetDescriptorHeapManager() const { return m_descriptorManager.get(); }
-    UINT GetCurrentFrameIndex() const { return m_frameIndex; }
+    UINT GetCurrentFrameIndex() const { return m_frameIndex; } // Frame context, not the back buffer
+    // Fence value the frame being recorded (or the next one) will signal; tags deferred releases
+    UINT64 GetCurrentFenceValue() const { return m_frameContexts[m_frameIndex]->fenceValue; }
+    UINT64 GetCompletedFenceValue() const { return m_fence->GetCompletedValue(); }
+    bool UsesComposition() const { return m_useComposition; }
+    IDXGIFactory4* GetFactory() const { return m_factory.Get(); }
+    const std::wstring& GetAdapterName() const { return m_adapterName; }
+    IDXGIAdapter3* GetAdapter() const { return m_adapter.Get(); } // Null if the adapter lacks IDXGIAdapter3
+    bool IsUsingWarpAdapter() const { return m_useWarpAdapter; }
+    // Rendering on the adapter above, presenting on the one driving the window's display
+    bool IsCrossAdapterPresenting() const { return m_crossAdapterPresenter != nullptr; }
+    DXGI_FORMAT GetBackBufferFormat() const { return m_backBufferFormat; } // The swap chain's
+    DXGI_FORMAT GetSceneFormat() const { return m_sceneFormat; } // What the UI, browser and sprites draw into
+
+    // --- HDR Output ---
+    // On an HDR output the swap chain switches to FP16 scRGB, which DWM composes as is instead of
+    // converting an SDR surface every frame (and washing it out). The scene still draws in the SDR
+    // scene format; the upscale pass, which always runs then, linearizes it with SDR white at the
+    // SDR content brightness set in Windows. Not while the shared layer is enabled: its consumers
+    // draw it into surfaces of their own and expect the SDR frame.
+    bool IsHdrOutputActive() const { return m_hdrOutput; }
+    float GetHdrOutputScale() const { return m_sdrWhiteScale; } // scRGB value of SDR white (1 = 80 nits)
+
+    // Multiplane overlay (MPO): DWM can scan the swap chain out on a hardware plane instead of
+    // composing it. Support flags are DXGI_OVERLAY_SUPPORT_FLAG_* for the window's output.
+    bool IsOverlayPlaneSupported() const { return m_overlaySupportFlags != 0; }
+    UINT GetOverlaySupportFlags() const { return m_overlaySupportFlags; }
+    PresentationMode GetPresentationMode() const { return m_presentationMode; }
+    const DisplayStatistics& GetDisplayStatistics() const { return m_displayStatistics; }
+    // Paint-to-photon: before EndFrame, the QPC time of the newest browser paint this frame shows.
+    // Once the frame statistics name the frame's present, the time to its vblank is added to the
+    // display statistics; frames displayed between two samples are not measured.
+    void TagFrameBrowserPaint(LONGLONG paintQpc) { m_frameBrowserPaintQpc = std::max(m_frameBrowserPaintQpc, paintQpc); }
+    // Input-to-photon, the same way: the QPC time of the oldest input the frame is the first to
+    // reflect (TakeInputStamp). Each resolved sample bumps DisplayStatistics::inputSamples.
+    void TagFrameInput(LONGLONG inputQpc) {
+        if (inputQpc != 0 && (m_frameInputQpc == 0 || inputQpc < m_frameInputQpc)) m_frameInputQpc = inputQpc;
+    }
 
     // DirectX 12 specific functionality
     ID3D12Resource* GetCurrentRenderTarget() const;
@@ -70,36 +330,265 @@ public:
 
 private:
     void InitializeDirectX12(HWND hwnd, int width, int height);
+    void CreateFactory();
+    ComPtr<IDXGIAdapter1> SelectAdapter();
+    void QueryOverlaySupport(IDXGIAdapter1* adapter, HWND hwnd);
+    void SetUpCrossAdapterPresent(IDXGIAdapter1* renderAdapter, HWND hwnd);
+    void UpdatePresentationMode();
+    void UpdateOutputProperties(); // Polls the window's output for HDR, its SDR white level and refresh rate
+    void ApplyOutputColorSpace();  // Switches the swap chain to what UpdateOutputProperties found
+    void UpdateDisplayStatistics();
     void CreateCommandObjects();
     void CreateSwapChain(HWND hwnd, int width, int height);
+    void CreateCompositionTarget(HWND hwnd);
     void CreateRenderTargets();
     void CreateSyncObjects();
+    void CreateTimestampResources();
+    void CreateCopyQueue();
+    void WaitForCopyQueue();
+    void BuildFrameGraph();
+    void UpdateScaledTargetViews(ID3D12Resource* target);
+    void RecordUpscalePass();
+    bool ShouldUpscale() const;
+    void ReadGpuTimestamps(UINT frameIndex);
+    void ResolveGpuTimestamps(UINT frameIndex);
+    void SubmitFrame(bool splitFrameList); // Executes, presents and advances the frame EndFrame closed
     void MoveToNextFrame();
     void WaitForFrame(UINT frameIndex);
+    void WaitForSubmittedFrames(); // Waits for submitted frames only, unlike WaitForGpu
+    void ApplyPendingResize();
+    void ApplyPendingFrameCount();
+    void ResizeSwapChainBuffers(); // Recreates the back buffers at the current size and count
     void ReleaseResources();
 
     // DirectX 12 objects
+    ComPtr<IDXGIFactory4> m_factory; // Created once, shared by adapter selection and swap chain creation
     ComPtr<ID3D12Device> m_device;
     ComPtr<ID3D12CommandQueue> m_commandQueue;
-    ComPtr<ID3D12CommandAllocator> m_commandAllocators[3]; // Triple buffering
     ComPtr<ID3D12GraphicsCommandList> m_commandList;
+    // Holds the frame's commands recorded before EndFrame when recorded lists are spliced in after them
+    ComPtr<ID3D12GraphicsCommandList> m_frameHeadCommandList;
     ComPtr<IDXGISwapChain3> m_swapChain;
-    ComPtr<ID3D12Resource> m_renderTargets[3]; // Triple buffering
+    ComPtr<IDXGISwapChainMedia> m_swapChainMedia; // Presentation mode statistics, optional
+    // Set when the window's display hangs off another adapter; the swap chain is then its
+    std::unique_ptr<CrossAdapterPresenter> m_crossAdapterPresenter;
+
+    // DirectComposition objects (composition mode only)
+    ComPtr<IDCompositionDevice> m_dcompDevice;
+    ComPtr<IDCompositionTarget> m_dcompTarget;
+    ComPtr<IDCompositionVisual> m_dcompVisual;
+    static constexpr UINT MIN_BACK_BUFFERS = 2; // Flip model
+    ComPtr<ID3D12Resource> m_renderTargets[MAX_FRAMES_IN_FLIGHT]; // One per back buffer
+    UINT m_backBufferCount = MAX_FRAMES_IN_FLIGHT;
+    UINT m_backBufferIndex = 0;
+    DXGI_FORMAT m_backBufferFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+    DXGI_FORMAT m_sceneFormat = DXGI_FORMAT_R8G8B8A8_UNORM; // The back buffer's too unless HDR output
     std::unique_ptr<DescriptorHeapManager> m_descriptorManager;
 
     // Synchronization objects
     ComPtr<ID3D12Fence> m_fence;
-    UINT64 m_fenceValues[3] = { 0, 0, 0 }; // Values for each frame
+    UINT64 m_lastSignaledFenceValue = 0;   // Most recent value signalled on the direct queue
+    UINT64 m_frameReadyFenceValue = 0;     // GPU must pass this before the current frame slot is reused
     HANDLE m_fenceEvent = nullptr;
+    HANDLE m_frameReadyEvent = nullptr;    // Waited on by the main loop, never blocks internally
+
+    // Copy queue (browser uploads)
+    ComPtr<ID3D12CommandQueue> m_copyQueue;
+    ComPtr<ID3D12GraphicsCommandList> m_copyCommandList;
+    std::unique_ptr<CommandAllocatorPool> m_copyAllocatorPool;
+    ID3D12CommandAllocator* m_copyAllocator = nullptr; // Open between Begin/SubmitCopyCommands
+    ComPtr<ID3D12Fence> m_copyFence;
+    UINT64 m_copyFenceValue = 0;       // Last value signalled on the copy queue
+    UINT64 m_copyFenceValueRequired = 0; // Last value a frame samples the result of (not detached)
+    UINT64 m_copyFenceValueWaited = 0;   // Last value the direct queue waited for
 
     // Frame management
+    // Frame contexts are used as a ring of m_frameCount; all are created so the count can change
     UINT m_frameIndex = 0;
-    std::unique_ptr<FrameContext> m_frameContexts[3]; // Triple buffering
+    UINT m_frameCount = MAX_FRAMES_IN_FLIGHT;
+    UINT m_pendingFrameCount = 0; // Applied by BeginFrame, 0 = no change
+    std::unique_ptr<FrameContext> m_frameContexts[MAX_FRAMES_IN_FLIGHT];
 
     // Performance optimization
     float m_renderScale = 1.0f;
     bool m_vsyncEnabled = true;
     std::unique_ptr<ResourceManager> m_resourceManager;
+    std::unique_ptr<TextureLoader> m_textureLoader; // Uses m_resourceManager
+    std::unique_ptr<SpriteBatch> m_spriteBatch;     // Uses m_resourceManager
+    std::unique_ptr<SharedLayer> m_sharedLayer;
+    std::unique_ptr<FrameReadback> m_frameReadback; // Uses m_resourceManager
+    std::unique_ptr<SharedTextureCopier> m_sharedTextureCopier;
+    std::unique_ptr<RenderGraph> m_renderGraph;     // Uses m_resourceManager
+
+    // This frame's graph: the scene (clear, browser, UI) into the scaled target or the back
+    // buffer, then the upscale, the shared layer copy and the screenshot readback when they run
+    struct FrameGraph {
+        RenderGraphResource backBuffer = RENDER_GRAPH_NONE;
+        RenderGraphResource sceneTarget = RENDER_GRAPH_NONE;
+        RenderGraphPass scenePass = RENDER_GRAPH_NONE;
+        RenderGraphPass upscalePass = RENDER_GRAPH_NONE;
+        RenderGraphPass sharedLayerPass = RENDER_GRAPH_NONE;
+        RenderGraphPass readbackPass = RENDER_GRAPH_NONE;
+    };
+    FrameGraph m_frameGraph;
+    bool m_windowContentShown = true;
+
+    // Render-scale upscaling (offscreen target uses the RTV slot after the back buffers and one
+    // shader-visible SRV per frame in flight). The target is a render graph transient; each new
+    // one takes the next SRV slot, so frames in flight keep a valid descriptor
+    static constexpr UINT SCALED_TARGET_RTV_INDEX = MAX_FRAMES_IN_FLIGHT;
+    static constexpr UINT SCALED_TARGET_SRV_SLOTS = MAX_FRAMES_IN_FLIGHT;
+    ResourceDescriptor m_scaledTargetSrvs[SCALED_TARGET_SRV_SLOTS];
+    UINT m_scaledTargetSrvSlot = 0;
+    ID3D12Resource* m_scaledRenderTarget = nullptr; // Owned by m_renderGraph
+    int m_scaledTargetWidth = 0;
+    int m_scaledTargetHeight = 0;
+    bool m_upscalingThisFrame = false;
+    UpscaleMode m_upscaleMode = UpscaleMode::Shader;
+    bool m_swapChainScalingThisFrame = false;
+    int m_sourceWidth = 0;  // Last SetSourceSize; 0 while the whole buffer is shown
+    int m_sourceHeight = 0;
+    void ApplySourceSize();
+
+    // Frame target state, replayed into recorded lists
+    D3D12_CPU_DESCRIPTOR_HANDLE m_frameRtvHandle = {};
+    D3D12_VIEWPORT m_frameViewport = {};
+    D3D12_RECT m_frameScissorRect = {};
+
+    // Per-thread recording contexts (BeginRecording/EndRecording)
+    struct RecordingContext {
+        std::unique_ptr<CommandAllocatorPool> allocatorPool;
+        ID3D12CommandAllocator* allocator = nullptr; // This frame's, acquired by the first BeginRecording
+        std::vector<ComPtr<ID3D12GraphicsCommandList>> commandLists; // Reused every frame
+        size_t usedCommandLists = 0;
+        ID3D12GraphicsCommandList* recording = nullptr; // Open list, one at a time per thread
+    };
+    struct RecordedList {
+        int order = 0;
+        UINT sequence = 0;
+        ID3D12GraphicsCommandList* commandList = nullptr;
+    };
+    std::mutex m_recordingMutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<RecordingContext>> m_recordingContexts;
+    std::vector<RecordedList> m_recordedLists;
+    UINT m_outstandingRecordingJobs = 0; // Render thread only: counted down by the continuations
+    bool m_submissionPending = false; // EndFrame left SubmitFrame to the last continuation
+    bool m_pendingSplitFrameList = false;
+    std::vector<ID3D12CommandList*> m_submitLists; // Reused by EndFrame
+
+    // Static layer bundles; each has its own allocator, since a bundle the GPU may still replay
+    // can't be reset (rerecording retires both and starts fresh)
+    struct StaticLayer {
+        UINT id = 0;
+        StaticLayerRecorder recorder;
+        ComPtr<ID3D12CommandAllocator> allocator;
+        ComPtr<ID3D12GraphicsCommandList> bundle; // Null until recorded
+    };
+    bool RecordStaticLayer(StaticLayer& layer);
+    std::vector<StaticLayer> m_staticLayers;
+    UINT m_nextStaticLayerId = 1;
+    UpscaleFilter m_upscaleFilter = UpscaleFilter::Sharpen;
+    float m_upscaleSharpness = 0.5f;
+
+    // Resource pointers (not owned)
+    PipelineStateManager* m_pipelineStateManager = nullptr;
+
+    // GPU timestamp queries: frame begin/end, then a begin/end pair per pass
+    static constexpr UINT PASS_COUNT = static_cast<UINT>(GpuPass::Count);
+    static constexpr UINT QUERIES_PER_FRAME = 2 + PASS_COUNT * 2;
+    ComPtr<ID3D12QueryHeap> m_timestampQueryHeap;
+    UINT64 m_timestampFrequency = 0;
+    bool m_timestampsSupported = false;
+    bool m_gpuUploadHeapSupported = false;
+    float m_gpuFrameTimeMs = 0.0f;
+    UINT64 m_gpuTimingSamples = 0;
+    float m_gpuPassTimesMs[PASS_COUNT] = {};
+
+    // GPU lane of the CPU profiler; timestamps are mapped to QPC through the queue's calibration
+    CpuProfileLane* m_gpuProfileLane = nullptr;
+    UINT64 m_calibrationGpuTimestamp = 0;
+    UINT64 m_calibrationCpuTicks = 0;
+    void RecordGpuProfileZones(const UINT64* timestamps, UINT passMask);
+
+#if GAMEOVERLAY_ENABLE_TRACY
+    // Tracy's own GPU context on the direct queue; one open zone per pass
+    tracy::D3D12QueueCtx* m_tracyGpuContext = nullptr;
+    std::unique_ptr<tracy::D3D12ZoneScope> m_tracyGpuZones[PASS_COUNT];
+#endif
+
+    // Damage tracking
+    static constexpr UINT REDRAW_FRAMES_PER_INVALIDATION = 2;
+    std::atomic<UINT> m_pendingRedrawFrames = REDRAW_FRAMES_PER_INVALIDATION; // Render the first frames
+
+    // Partial presentation
+    bool m_partialPresentation = true;
+    bool m_showPresentRects = false;
+    bool m_forceFullPresent = true; // Back buffers have no valid content yet
+    std::vector<RECT> m_dirtyRects;
+    std::vector<RECT> m_previousDirtyRects;
+    std::vector<RECT> m_presentRects;
+    UINT64 m_lastPresentedPixels = 0;
+    bool m_occluded = false;
+
+    // Overlay plane eligibility and the mode DWM last reported
+    static constexpr UINT PRESENTATION_MODE_POLL_INTERVAL = 30; // Presents between queries
+    bool m_preferOverlayPlane = true;
+    UINT m_overlaySupportFlags = 0;
+    PresentationMode m_presentationMode = PresentationMode::Unknown;
+
+    // HDR output; a factory of its own, since a factory keeps reporting the color spaces outputs had
+    // when it was created
+    static constexpr UINT OUTPUT_POLL_INTERVAL = 120;             // Presents between queries
+    static constexpr float DEFAULT_SDR_WHITE_SCALE = 2.5f;       // 200 nits, when Windows can't say
+    ComPtr<IDXGIFactory1> m_outputFactory;
+    bool m_hdrOutputDetected = false;
+    bool m_hdrOutputUnsupported = false; // The swap chain refused scRGB; not tried again
+    bool m_hdrOutput = false;
+    float m_sdrWhiteScale = 1.0f;
+    UINT64 m_presentCount = 0;
+
+    // Variable refresh: the cap sits a few frames under the maximum, so frames never wait for a
+    // refresh (which is where vsync behaviour, and its latency, would come back)
+    static constexpr float VARIABLE_REFRESH_CAP_MARGIN_HZ = 3.0f;
+    bool m_variableRefreshEnabled = false;
+    float m_maxRefreshRateHz = 0.0f;
+
+    // Display statistics: rates are measured over windows of at least DISPLAY_STATS_WINDOW_MS
+    static constexpr LONGLONG DISPLAY_STATS_WINDOW_MS = 500;
+    DisplayStatistics m_displayStatistics;
+    DXGI_FRAME_STATISTICS m_lastFrameStatistics = {}; // Previous sample
+    DXGI_FRAME_STATISTICS m_windowFrameStatistics = {}; // Start of the rate window
+    bool m_frameStatisticsBaseline = false;
+    UINT m_lastPresentQueueDepth = 0;
+    UINT m_lastSyncInterval = 1;
+    LARGE_INTEGER m_qpcFrequency = {};
+    // Cadence: intervals between displayed frames over the rate window; gaps longer than
+    // CADENCE_MAX_INTERVAL_MS are render-on-demand idling, not cadence
+    static constexpr double CADENCE_MAX_INTERVAL_MS = 100.0;
+    double m_intervalSumMs = 0.0;
+    double m_intervalSquareSumMs = 0.0;
+    UINT m_intervalCount = 0;
+    // Paint- and input-to-photon tags of presents not displayed yet; the oldest is overwritten when full
+    struct PresentTag {
+        UINT presentId = 0;
+        LONGLONG paintQpc = 0; // 0 = none
+        LONGLONG inputQpc = 0; // Same
+    };
+    static constexpr UINT MAX_PRESENT_TAGS = 8;
+    PresentTag m_presentTags[MAX_PRESENT_TAGS];
+    UINT m_nextPresentTag = 0;
+    LONGLONG m_frameBrowserPaintQpc = 0;
+    LONGLONG m_frameInputQpc = 0;
+    double m_paintLatencySumMs = 0.0;
+    double m_paintLatencyMaxMs = 0.0;
+    UINT m_paintLatencyCount = 0;
+
+    // Debounced resize
+    static constexpr int RESIZE_DEBOUNCE_MS = 100;
+    bool m_resizePending = false;
+    int m_pendingWidth = 0;
+    int m_pendingHeight = 0;
+    std::chrono::steady_clock::time_point m_lastResizeRequest;
 
     // Window dimensions
     int m_width;
@@ -109,14 +598,29 @@ private:
     HWND m_hwnd;
 
     // Additional state for DirectX 12
+    GpuPreference m_gpuPreference = GpuPreference::MinimumPower;
+    std::wstring m_adapterName;
+    ComPtr<IDXGIAdapter3> m_adapter; // For video memory budget queries
     bool m_useWarpAdapter = false;
+    bool m_gpuPriorityYielded = false;
+    bool m_useComposition = false;
     UINT m_rtvDescriptorSize = 0;
     bool m_tearingSupported = false;
     bool m_allowTearing = false;
+    UINT m_swapChainFlags = 0; // Must match between creation and ResizeBuffers
+
+    // Frame latency waitable object
+    HANDLE m_frameLatencyWaitableObject = nullptr;
+    UINT m_maxFrameLatency = 1;
+    bool m_frameLatencyWaitEnabled = true;
+    bool m_frameLatencyWaited = false; // Already waited for the current frame
+    float m_lastFrameLatencyWaitMs = 0.0f;
+    float m_beginFrameLatencyWaitMs = 0.0f; // Share of the above waited in BeginFrame
+    float m_lastFrameSlotWaitMs = 0.0f;
+    float m_lastPresentMs = 0.0f;
 
     // Helper methods for DirectX 12
     void PopulateCommandList();
-    void TransitionResource(ID3D12Resource* resource, D3D12_RESOURCE_STATES beforeState, D3D12_RESOURCE_STATES afterState);
     void CheckTearingSupport();
     void UpdateRenderTargetViews();
 };
@@ -138,12 +642,3 @@ struct DescriptorHeapManager {
     D3D12_CPU_DESCRIPTOR_HANDLE GetCbvSrvUavCpuHandle(UINT index) const;
     D3D12_GPU_DESCRIPTOR_HANDLE GetCbvSrvUavGpuHandle(UINT index) const;
 };
-
-// Per-frame context data
-struct FrameContext {
-    ComPtr<ID3D12CommandAllocator> commandAllocator;
-    UINT64 fenceValue = 0;
-
-    FrameContext(ID3D12Device* device);
-    void Reset();
-};
\ No newline at end of file
@@ -3,15 +3,38 @@
 
 #include "ResourceManager.h"
 #include "RenderSystem.h" // Assuming RenderSystem provides GetDevice()
+#include "CpuProfiler.h"
+#include "Log.h"
 #include <algorithm>
-#include <sstream>
 #include <stdexcept>
+#include <cstdio>
+#include <intrin.h>
 
 // Helper to generate a somewhat unique ID string based on pointer
 std::string PtrToID(const void* ptr) {
-    std::stringstream ss;
-    ss << ptr;
-    return ss.str();
+    char buffer[2 + sizeof(void*) * 2 + 1];
+    snprintf(buffer, sizeof(buffer), "%p", ptr);
+    return buffer;
+}
+
+// Private data slot holding a tracked resource's ResourceHandle
+// {6E1630D2-3220-4DCB-B2E5-363827559F39}
+static const GUID RESOURCE_HANDLE_GUID =
+    { 0x6e1630d2, 0x3220, 0x4dcb, { 0xb2, 0xe5, 0x36, 0x38, 0x27, 0x55, 0x9f, 0x39 } };
+
+static int64_t ToTicks(std::chrono::steady_clock::time_point time) {
+    return time.time_since_epoch().count();
+}
+
+static std::chrono::steady_clock::time_point FromTicks(int64_t ticks) {
+    return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(ticks));
+}
+
+// Index of the lowest set bit; bits must be non-zero
+static UINT LowestSetBit(uint64_t bits) {
+    unsigned long index = 0;
+    _BitScanForward64(&index, bits);
+    return static_cast<UINT>(index);
 }
 
 
@@ -20,11 +43,24 @@ ResourceManager::ResourceManager(RenderSystem* renderSystem)
     if (!m_renderSystem || !m_renderSystem->GetDevice()) {
         throw std::runtime_error("ResourceManager requires a valid RenderSystem and D3D12Device.");
     }
+    m_frameTime = ToTicks(std::chrono::steady_clock::now());
+    m_placedAllocator = std::make_unique<PlacedHeapAllocator>(m_renderSystem->GetDevice());
+
+    // Budget changes are signaled by the OS; without notifications the budget is only polled
+    m_adapter = m_renderSystem->GetAdapter();
+    if (m_adapter) {
+        m_budgetChangedEvent = CreateEvent(nullptr, FALSE, TRUE, nullptr); // Signaled: query on the first frame
+        if (m_budgetChangedEvent && FAILED(m_adapter->RegisterVideoMemoryBudgetChangeNotificationEvent(
+                m_budgetChangedEvent, &m_budgetNotificationCookie))) {
+            LOG_WARNING("Video memory budget notifications unavailable");
+            m_budgetNotificationCookie = 0;
+        }
+    }
 
     // Initialize descriptor pools
     InitializeDescriptorPool(D3D12_DESCRIPTOR_HEAP_TYPE_RTV, 128, false);         // Render Target Views
     InitializeDescriptorPool(D3D12_DESCRIPTOR_HEAP_TYPE_DSV, 64, false);          // Depth Stencil Views
-    InitializeDescriptorPool(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 2048, true); // Shader Resources (needs to be large)
+    InitializeDescriptorPool(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 2048, true, 256); // Shader Resources (+ per-frame ring)
     InitializeDescriptorPool(D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, 128, true);      // Samplers
 }
 
@@ -33,21 +69,35 @@ ResourceManager::~ResourceManager() {
     // that ComPtrs holding the actual resources are released elsewhere.
     // ClearCache just clears tracking maps.
     ClearCache();
+
+    if (m_adapter && m_budgetNotificationCookie) {
+        m_adapter->UnregisterVideoMemoryBudgetChangeNotification(m_budgetNotificationCookie);
+    }
+    if (m_budgetChangedEvent) {
+        CloseHandle(m_budgetChangedEvent);
+        m_budgetChangedEvent = nullptr;
+    }
+
+    for (auto& chunk : m_slotChunks) {
+        delete[] chunk.load();
+    }
 }
 
-void ResourceManager::InitializeDescriptorPool(D3D12_DESCRIPTOR_HEAP_TYPE type, UINT capacity, bool shaderVisible) {
+void ResourceManager::InitializeDescriptorPool(D3D12_DESCRIPTOR_HEAP_TYPE type, UINT capacity, bool shaderVisible,
+                                               UINT transientCapacity) {
     if (!m_renderSystem || !m_renderSystem->GetDevice()) return;
     ID3D12Device* device = m_renderSystem->GetDevice();
 
     DescriptorPool pool;
     pool.capacity = capacity;
-    pool.allocated.resize(capacity, false);
-    pool.size = 0;
+    pool.transientCapacity = transientCapacity;
+    pool.shaderVisible = shaderVisible;
     pool.type = type;
     pool.descriptorSize = device->GetDescriptorHandleIncrementSize(type);
+    ResetDescriptorPool(pool);
 
     D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
-    heapDesc.NumDescriptors = capacity;
+    heapDesc.NumDescriptors = capacity + transientCapacity;
     heapDesc.Type = type;
     heapDesc.Flags = shaderVisible ? D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE : D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
     heapDesc.NodeMask = 0; // Single adapter
@@ -69,21 +119,104 @@ void ResourceManager::InitializeDescriptorPool(D3D12_DESCRIPTOR_HEAP_TYPE type,
     m_descriptorPools[type] = std::move(pool); // Move pool into map
 }
 
+void ResourceManager::ResetDescriptorPool(DescriptorPool& pool) {
+    // Mark every persistent slot free; bits past capacity stay clear so they are never found
+    UINT wordCount = (pool.capacity + 63) / 64;
+    pool.freeBits.assign(wordCount, ~0ull);
+    if (pool.capacity % 64 != 0) {
+        pool.freeBits.back() = (1ull << (pool.capacity % 64)) - 1;
+    }
+    pool.summaryBits.assign((wordCount + 63) / 64, ~0ull);
+    if (wordCount % 64 != 0) {
+        pool.summaryBits.back() = (1ull << (wordCount % 64)) - 1;
+    }
+    pool.size = 0;
+
+    pool.transientHead = 0;
+    pool.transientUsed = 0;
+    pool.transientSpans.clear();
+}
+
+void ResourceManager::ReclaimTransientDescriptors(DescriptorPool& pool, UINT64 completedFenceValue) {
+    while (!pool.transientSpans.empty() && pool.transientSpans.front().fenceValue <= completedFenceValue) {
+        pool.transientUsed -= pool.transientSpans.front().count;
+        pool.transientSpans.pop_front();
+    }
+}
+
+ResourceDescriptor ResourceManager::MakeDescriptor(const DescriptorPool& pool, UINT index) {
+    ResourceDescriptor desc;
+    desc.heapIndex = index;
+    desc.type = pool.type;
+    desc.cpuHandle = pool.cpuStart;
+    desc.cpuHandle.ptr += static_cast<SIZE_T>(index) * pool.descriptorSize;
+    if (pool.shaderVisible) {
+        desc.gpuHandle = pool.gpuStart;
+        desc.gpuHandle.ptr += static_cast<UINT64>(index) * pool.descriptorSize;
+    }
+    else {
+        desc.gpuHandle = {}; // Invalid GPU handle
+    }
+    return desc;
+}
+
 
 // --- Texture Resource Management ---
 
+ComPtr<ID3D12Resource> ResourceManager::CreateResourceInternal(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc,
+    D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* optimizedClearValue,
+    size_t& allocationSize, bool& isPlaced) {
+    PROFILE_ZONE("Create Resource");
+    ID3D12Device* device = m_renderSystem->GetDevice();
+
+    UINT64 placedSize = 0;
+    ComPtr<ID3D12Resource> resource = m_placedAllocator->CreateResource(heapType, desc, initialState,
+        optimizedClearValue, &placedSize);
+    if (resource) {
+        allocationSize = static_cast<size_t>(placedSize);
+        isPlaced = true;
+        return resource;
+    }
+
+    // Too large for a page (or placement failed): own heap
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    heapProps.Type = heapType;
+    heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+    heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+    heapProps.CreationNodeMask = 1; // Single GPU
+    heapProps.VisibleNodeMask = 1; // Single GPU
+
+    HRESULT hr = device->CreateCommittedResource(
+        &heapProps,
+        D3D12_HEAP_FLAG_NONE,
+        &desc,
+        initialState,
+        optimizedClearValue,
+        IID_PPV_ARGS(&resource)
+    );
+    if (FAILED(hr)) {
+        LOG_ERROR("Failed to create committed resource. HRESULT: 0x%08lX", static_cast<unsigned long>(hr));
+        return nullptr;
+    }
+
+    D3D12_RESOURCE_ALLOCATION_INFO allocInfo = device->GetResourceAllocationInfo(0, 1, &desc);
+    allocationSize = static_cast<size_t>(allocInfo.SizeInBytes);
+    isPlaced = false;
+    return resource;
+}
+
 ComPtr<ID3D12Resource> ResourceManager::CreateTexture2D(
     UINT width, UINT height,
     DXGI_FORMAT format,
     D3D12_RESOURCE_FLAGS flags,
     D3D12_HEAP_TYPE heapType,
     D3D12_RESOURCE_STATES initialState,
-    const D3D12_CLEAR_VALUE* optimizedClearValue) {
+    const D3D12_CLEAR_VALUE* optimizedClearValue,
+    UINT16 mipLevels) {
 
     if (!m_renderSystem || !m_renderSystem->GetDevice()) {
         return nullptr;
     }
-    ID3D12Device* device = m_renderSystem->GetDevice();
 
     // Create texture description
     D3D12_RESOURCE_DESC textureDesc = {};
@@ -91,54 +224,191 @@ ComPtr<ID3D12Resource> ResourceManager::CreateTexture2D(
     textureDesc.Width = width;
     textureDesc.Height = height;
     textureDesc.DepthOrArraySize = 1;
-    textureDesc.MipLevels = 1; // Simplify: Only 1 mip level for now
+    textureDesc.MipLevels = std::max<UINT16>(mipLevels, 1);
     textureDesc.Format = format;
     textureDesc.SampleDesc.Count = 1;
     textureDesc.SampleDesc.Quality = 0;
     textureDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
     textureDesc.Flags = flags;
 
-    // Create heap properties
-    D3D12_HEAP_PROPERTIES heapProps = {};
-    heapProps.Type = heapType;
-    heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-    heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-    heapProps.CreationNodeMask = 1; // Single GPU
-    heapProps.VisibleNodeMask = 1; // Single GPU
-
-    ComPtr<ID3D12Resource> texture;
-    HRESULT hr = device->CreateCommittedResource(
-        &heapProps,
-        D3D12_HEAP_FLAG_NONE,
-        &textureDesc,
-        initialState,
-        optimizedClearValue, // Pass clear value
-        IID_PPV_ARGS(&texture)
-    );
-
-    if (FAILED(hr)) {
-        // Log error HRESULT hr
-        OutputDebugStringA(("Failed to create Texture2D. HRESULT: " + std::to_string(hr) + "\n").c_str());
+    size_t resourceSize = 0;
+    bool isPlaced = false;
+    ComPtr<ID3D12Resource> texture = CreateResourceInternal(heapType, textureDesc, initialState,
+        optimizedClearValue, resourceSize, isPlaced);
+    if (!texture) {
+        LOG_ERROR("Failed to create Texture2D");
         return nullptr;
     }
 
-    // Calculate approximate size for tracking
-    // This is complex; use GetResourceAllocationInfo for accuracy if needed
-    D3D12_RESOURCE_ALLOCATION_INFO allocInfo = device->GetResourceAllocationInfo(0, 1, &textureDesc);
-    size_t resourceSize = allocInfo.SizeInBytes;
-
     // Track the internally created resource
     ResourceType resType = ResourceType::Texture;
     if (flags & D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET) resType = ResourceType::RenderTarget;
     if (flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL) resType = ResourceType::DepthStencil;
 
-    TrackResourceInternal(texture.Get(), resType, resourceSize, initialState);
+    TrackResourceInternal(texture.Get(), resType, resourceSize, initialState, isPlaced);
     texture->SetName((L"Texture2D_" + std::to_wstring(width) + L"x" + std::to_wstring(height)).c_str());
 
 
     return texture;
 }
 
+// --- Texture Pool ---
+
+size_t ResourceManager::TexturePoolKeyHash::operator()(const TexturePoolKey& key) const {
+    size_t hash = std::hash<UINT64>()(key.width);
+    hash = hash * 31 + std::hash<UINT>()(key.height);
+    hash = hash * 31 + static_cast<size_t>(key.format);
+    hash = hash * 31 + static_cast<size_t>(key.flags);
+    hash = hash * 31 + static_cast<size_t>(key.heapType);
+    hash = hash * 31 + static_cast<size_t>(key.mipLevels);
+    return hash;
+}
+
+ComPtr<ID3D12Resource> ResourceManager::AcquireTexture2D(
+    UINT width, UINT height,
+    DXGI_FORMAT format,
+    D3D12_RESOURCE_FLAGS flags,
+    D3D12_HEAP_TYPE heapType,
+    D3D12_RESOURCE_STATES initialState,
+    const D3D12_CLEAR_VALUE* optimizedClearValue,
+    UINT16 mipLevels) {
+
+    TexturePoolKey key = { width, height, format, flags, heapType, std::max<UINT16>(mipLevels, 1) };
+    PooledTexture pooled;
+    {
+        std::lock_guard<ProfiledMutex> lock(m_mutex);
+        auto poolIt = m_texturePool.find(key);
+        if (poolIt != m_texturePool.end()) {
+            auto& entries = poolIt->second;
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (entries[i].state == initialState && entries[i].fenceValue <= m_completedFenceValue) {
+                    pooled = std::move(entries[i]);
+                    entries[i] = std::move(entries.back());
+                    entries.pop_back();
+                    m_texturePoolBytes -= pooled.size;
+                    break;
+                }
+            }
+        }
+        if (pooled.texture) m_texturePoolHits++;
+        else m_texturePoolMisses++;
+    }
+
+    // Nothing reusable yet (or a new size): allocate
+    if (!pooled.texture) {
+        return CreateTexture2D(width, height, format, flags, heapType, initialState, optimizedClearValue, mipLevels);
+    }
+
+    ResourceType resType = ResourceType::Texture;
+    if (flags & D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET) resType = ResourceType::RenderTarget;
+    if (flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL) resType = ResourceType::DepthStencil;
+    TrackResourceInternal(pooled.texture.Get(), resType, pooled.size, initialState, pooled.isPlaced);
+    return std::move(pooled.texture);
+}
+
+void ResourceManager::RecycleTexture(ComPtr<ID3D12Resource> texture, D3D12_RESOURCE_STATES state) {
+    if (!texture) return;
+
+    D3D12_RESOURCE_DESC desc = texture->GetDesc();
+    if (desc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D || desc.DepthOrArraySize != 1) {
+        RetireResource(std::move(texture)); // Not something AcquireTexture2D hands out
+        return;
+    }
+
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    D3D12_HEAP_FLAGS heapFlags = D3D12_HEAP_FLAG_NONE;
+    if (FAILED(texture->GetHeapProperties(&heapProps, &heapFlags))) {
+        heapProps.Type = D3D12_HEAP_TYPE_DEFAULT; // Placed resources report their heap's properties
+    }
+
+    PooledTexture pooled;
+    pooled.state = state;
+    pooled.fenceValue = m_renderSystem->GetCurrentFenceValue();
+    pooled.recycledTime = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<ProfiledMutex> lock(m_mutex);
+        TrackedResource* slot = FindSlot(texture.Get());
+        if (slot && slot->hasUsage) {
+            pooled.size = slot->size;
+            pooled.isPlaced = slot->isPlaced;
+        }
+    }
+    if (pooled.size == 0) {
+        pooled.size = static_cast<size_t>(
+            m_renderSystem->GetDevice()->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes);
+    }
+    ReleaseResource(texture.Get());
+
+    TexturePoolKey key = { desc.Width, desc.Height, desc.Format, desc.Flags, heapProps.Type, desc.MipLevels };
+    pooled.texture = std::move(texture);
+
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    m_texturePoolBytes += pooled.size;
+    m_texturePool[key].push_back(std::move(pooled));
+    TrimTexturePool(m_videoMemoryBudget.overBudget ? 0 : m_texturePoolLimit); // No caching over budget
+}
+
+void ResourceManager::SetTexturePoolLimit(size_t maxBytes) {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    m_texturePoolLimit = maxBytes;
+    TrimTexturePool(m_texturePoolLimit);
+}
+
+size_t ResourceManager::GetTexturePoolMemoryUsage() const {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    return m_texturePoolBytes;
+}
+
+void ResourceManager::TrimTexturePool(size_t limitBytes, std::chrono::seconds maxAge) {
+    auto now = std::chrono::steady_clock::now();
+    auto retire = [this](PooledTexture& pooled) {
+        // The GPU may still be using it for the frame it was recycled in
+        RetiredResource retired;
+        retired.object = std::move(pooled.texture);
+        retired.fenceValue = pooled.fenceValue;
+        m_retiredResources.push_back(std::move(retired));
+        m_texturePoolBytes -= pooled.size;
+    };
+
+    if (maxAge > std::chrono::seconds::zero()) {
+        for (auto& pair : m_texturePool) {
+            auto& entries = pair.second;
+            for (size_t i = 0; i < entries.size(); ) {
+                if (now - entries[i].recycledTime > maxAge) {
+                    retire(entries[i]);
+                    entries[i] = std::move(entries.back());
+                    entries.pop_back();
+                }
+                else {
+                    ++i;
+                }
+            }
+        }
+    }
+
+    // Oldest first until under the limit
+    while (m_texturePoolBytes > limitBytes) {
+        std::vector<PooledTexture>* oldestEntries = nullptr;
+        size_t oldestIndex = 0;
+        for (auto& pair : m_texturePool) {
+            for (size_t i = 0; i < pair.second.size(); ++i) {
+                if (!oldestEntries || pair.second[i].recycledTime < (*oldestEntries)[oldestIndex].recycledTime) {
+                    oldestEntries = &pair.second;
+                    oldestIndex = i;
+                }
+            }
+        }
+        if (!oldestEntries) break;
+        retire((*oldestEntries)[oldestIndex]);
+        (*oldestEntries)[oldestIndex] = std::move(oldestEntries->back());
+        oldestEntries->pop_back();
+    }
+
+    for (auto it = m_texturePool.begin(); it != m_texturePool.end(); ) {
+        it = it->second.empty() ? m_texturePool.erase(it) : std::next(it);
+    }
+}
+
 // --- Buffer Resource Management ---
 
 ComPtr<ID3D12Resource> ResourceManager::CreateBuffer(
@@ -151,22 +421,13 @@ ComPtr<ID3D12Resource> ResourceManager::CreateBuffer(
     if (!m_renderSystem || !m_renderSystem->GetDevice()) {
         return nullptr;
     }
-    ID3D12Device* device = m_renderSystem->GetDevice();
 
     // Data can only be provided directly if target heap is UPLOAD
     if (initialData && heapType != D3D12_HEAP_TYPE_UPLOAD) {
-        OutputDebugStringA("Warning: Initial data provided for non-UPLOAD heap buffer. Data will NOT be uploaded by CreateBuffer. Use UpdateBuffer.\n");
+        LOG_WARNING("Initial data provided for non-UPLOAD heap buffer. Data will NOT be uploaded by CreateBuffer. Use UpdateBuffer");
         initialData = nullptr; // Ignore data for non-upload heaps in this function
     }
 
-    // Create heap properties
-    D3D12_HEAP_PROPERTIES heapProps = {};
-    heapProps.Type = heapType;
-    heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-    heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-    heapProps.CreationNodeMask = 1; // Single GPU
-    heapProps.VisibleNodeMask = 1; // Single GPU
-
     // Create resource description
     D3D12_RESOURCE_DESC resourceDesc = {};
     resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
@@ -180,18 +441,12 @@ ComPtr<ID3D12Resource> ResourceManager::CreateBuffer(
     resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
     resourceDesc.Flags = flags;
 
-    ComPtr<ID3D12Resource> buffer;
-    HRESULT hr = device->CreateCommittedResource(
-        &heapProps,
-        D3D12_HEAP_FLAG_NONE,
-        &resourceDesc,
-        initialState, // Initial state for the target heap
-        nullptr,
-        IID_PPV_ARGS(&buffer)
-    );
-
-    if (FAILED(hr)) {
-        OutputDebugStringA(("Failed to create Buffer. HRESULT: " + std::to_string(hr) + "\n").c_str());
+    size_t resourceSize = 0;
+    bool isPlaced = false;
+    ComPtr<ID3D12Resource> buffer = CreateResourceInternal(heapType, resourceDesc, initialState, nullptr,
+        resourceSize, isPlaced);
+    if (!buffer) {
+        LOG_ERROR("Failed to create Buffer");
         return nullptr;
     }
     buffer->SetName((L"Buffer_" + std::to_wstring(sizeInBytes)).c_str());
@@ -201,20 +456,22 @@ ComPtr<ID3D12Resource> ResourceManager::CreateBuffer(
     if (initialData && heapType == D3D12_HEAP_TYPE_UPLOAD) {
         void* mappedData = nullptr;
         D3D12_RANGE readRange = { 0, 0 }; // We are writing, not reading
-        hr = buffer->Map(0, &readRange, &mappedData);
+        HRESULT hr = buffer->Map(0, &readRange, &mappedData);
         if (SUCCEEDED(hr)) {
             memcpy(mappedData, initialData, sizeInBytes);
             // No need to specify write range when unmapping UPLOAD heap
             buffer->Unmap(0, nullptr);
         }
         else {
-            OutputDebugStringA(("Warning: Failed to map UPLOAD buffer for initial data copy. HRESULT: " + std::to_string(hr) + "\n").c_str());
+            LOG_WARNING("Failed to map UPLOAD buffer for initial data copy. HRESULT: 0x%08lX", static_cast<unsigned long>(hr));
         }
     }
 
     // Track the resource
-    ResourceType resType = (heapType == D3D12_HEAP_TYPE_UPLOAD) ? ResourceType::UploadBuffer : ResourceType::Buffer;
-    TrackResourceInternal(buffer.Get(), resType, sizeInBytes, initialState);
+    ResourceType resType = ResourceType::Buffer;
+    if (heapType == D3D12_HEAP_TYPE_UPLOAD) resType = ResourceType::UploadBuffer;
+    if (heapType == D3D12_HEAP_TYPE_READBACK) resType = ResourceType::ReadbackBuffer;
+    TrackResourceInternal(buffer.Get(), resType, resourceSize, initialState, isPlaced);
 
     return buffer;
 }
@@ -280,10 +537,234 @@ void ResourceManager::UpdateBuffer(
 }
 
 
+// --- Upload Ring ---
+
+bool ResourceManager::CreateUploadRing(UINT64 sizeInBytes) {
+    if (m_uploadRing) {
+        RetiredResource retired; // Frames in flight may still read it
+        retired.object = std::move(m_uploadRing);
+        retired.fenceValue = m_renderSystem->GetCurrentFenceValue();
+        m_retiredResources.push_back(std::move(retired));
+        m_uploadRingCpu = nullptr;
+        m_uploadRingSize = 0;
+    }
+
+    D3D12_RESOURCE_DESC desc = {};
+    desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    desc.Width = sizeInBytes;
+    desc.Height = 1;
+    desc.DepthOrArraySize = 1;
+    desc.MipLevels = 1;
+    desc.Format = DXGI_FORMAT_UNKNOWN;
+    desc.SampleDesc.Count = 1;
+    desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+    // Not tracked per resource (tracking takes m_mutex); only counted as committed memory
+    size_t allocationSize = 0;
+    bool isPlaced = false;
+    ComPtr<ID3D12Resource> ring = CreateResourceInternal(D3D12_HEAP_TYPE_UPLOAD, desc,
+        D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, allocationSize, isPlaced);
+    void* mapped = nullptr;
+    D3D12_RANGE readRange = { 0, 0 }; // Never read back
+    if (!ring || FAILED(ring->Map(0, &readRange, &mapped))) {
+        LOG_WARNING("Failed to create the upload ring");
+        return false;
+    }
+    ring->SetName(L"ResourceManager Upload Ring");
+
+    m_uploadRing = std::move(ring);
+    m_uploadRingCpu = static_cast<uint8_t*>(mapped);
+    m_uploadRingSize = sizeInBytes;
+    m_uploadRingHead = 0;
+    m_uploadRingUsed = 0;
+    m_uploadSpans.clear();
+    return true;
+}
+
+UploadAllocation ResourceManager::AllocateUpload(UINT64 size, UINT64 alignment) {
+    UploadAllocation allocation;
+    if (size == 0) return allocation;
+    if (alignment == 0) alignment = 1;
+    UINT64 fenceValue = m_renderSystem->GetCurrentFenceValue();
+
+    {
+        std::lock_guard<ProfiledMutex> lock(m_mutex);
+
+        // (Re)create when missing or resized, once nothing in the old ring is in flight
+        if ((!m_uploadRing || m_uploadRingSize != m_uploadRingRequestedSize) && m_uploadRingUsed == 0) {
+            CreateUploadRing(m_uploadRingRequestedSize);
+        }
+
+        if (m_uploadRing && size <= m_uploadRingSize) {
+            UINT64 start = (m_uploadRingHead + alignment - 1) / alignment * alignment;
+            UINT64 consumed = start - m_uploadRingHead;
+            if (start + size > m_uploadRingSize) {
+                // Skip the tail end; offset 0 satisfies any power-of-two alignment
+                consumed = m_uploadRingSize - m_uploadRingHead;
+                start = 0;
+            }
+            consumed += size;
+
+            if (m_uploadRingUsed + consumed <= m_uploadRingSize) {
+                m_uploadRingHead = (start + size) % m_uploadRingSize;
+                m_uploadRingUsed += consumed;
+                if (!m_uploadSpans.empty() && m_uploadSpans.back().fenceValue == fenceValue) {
+                    m_uploadSpans.back().size += consumed;
+                }
+                else {
+                    m_uploadSpans.push_back({ fenceValue, consumed });
+                }
+
+                allocation.cpuAddress = m_uploadRingCpu + start;
+                allocation.gpuAddress = m_uploadRing->GetGPUVirtualAddress() + start;
+                allocation.buffer = m_uploadRing.Get();
+                allocation.offset = start;
+                allocation.size = size;
+                return allocation;
+            }
+        }
+    }
+
+    // Ring full (or request larger than it): one-off buffer, released with this frame
+    ComPtr<ID3D12Resource> overflow = CreateUploadBuffer(size);
+    void* mapped = nullptr;
+    D3D12_RANGE readRange = { 0, 0 };
+    if (!overflow || FAILED(overflow->Map(0, &readRange, &mapped))) {
+        throw std::runtime_error("Failed to allocate " + std::to_string(size) + " bytes of upload memory.");
+    }
+    LOG_WARNING("Upload ring full, using a temporary upload buffer");
+    m_uploadRingOverflows++;
+    allocation.cpuAddress = mapped;
+    allocation.gpuAddress = overflow->GetGPUVirtualAddress();
+    allocation.buffer = overflow.Get();
+    allocation.offset = 0;
+    allocation.size = size;
+    allocation.temporary = true;
+    RetireResource(std::move(overflow)); // Stays mapped; releasing unmaps
+    return allocation;
+}
+
+void ResourceManager::SetUploadRingSize(UINT64 sizeInBytes) {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    m_uploadRingRequestedSize = (std::max)(sizeInBytes, static_cast<UINT64>(64 * 1024));
+}
+
+void ResourceManager::GrowUploadRing() {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    // Overflows before a pending resize lands don't double it again
+    if (m_uploadRingSize == 0 || m_uploadRingRequestedSize > m_uploadRingSize) return;
+    m_uploadRingRequestedSize = (std::min)(m_uploadRingSize * 2, MAX_UPLOAD_RING_SIZE);
+}
+
+void ResourceManager::UpdateBuffer(
+    ID3D12GraphicsCommandList* commandList,
+    ID3D12Resource* destinationBuffer,
+    const void* data,
+    UINT64 dataSize,
+    UINT64 destinationOffset,
+    D3D12_RESOURCE_STATES stateAfterCopy) {
+
+    if (!commandList || !destinationBuffer || !data || dataSize == 0) {
+        throw std::invalid_argument("Invalid argument for UpdateBuffer.");
+    }
+
+    UploadAllocation upload = AllocateUpload(dataSize, 4);
+    memcpy(upload.cpuAddress, data, dataSize);
+
+    if (GetResourceState(destinationBuffer) != D3D12_RESOURCE_STATE_COPY_DEST) {
+        TransitionResource(commandList, destinationBuffer, D3D12_RESOURCE_STATE_COPY_DEST);
+    }
+    commandList->CopyBufferRegion(destinationBuffer, destinationOffset, upload.buffer, upload.offset, dataSize);
+    if (stateAfterCopy != D3D12_RESOURCE_STATE_COPY_DEST) {
+        TransitionResource(commandList, destinationBuffer, stateAfterCopy);
+    }
+}
+
+UINT ResourceManager::GetBytesPerPixel(DXGI_FORMAT format) {
+    switch (format) {
+    case DXGI_FORMAT_R8_UNORM:
+    case DXGI_FORMAT_A8_UNORM:
+        return 1;
+    case DXGI_FORMAT_R8G8_UNORM:
+    case DXGI_FORMAT_R16_FLOAT:
+        return 2;
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DXGI_FORMAT_R10G10B10A2_UNORM:
+    case DXGI_FORMAT_R32_FLOAT:
+        return 4;
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        return 8;
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+        return 16;
+    default:
+        return 0; // Block-compressed or uncommon: not supported by UpdateTexture
+    }
+}
+
+void ResourceManager::UpdateTexture(
+    ID3D12GraphicsCommandList* commandList,
+    ID3D12Resource* destinationTexture,
+    const void* data,
+    UINT64 srcRowPitch,
+    UINT width, UINT height,
+    UINT destX, UINT destY,
+    D3D12_RESOURCE_STATES stateAfterCopy) {
+
+    if (!commandList || !destinationTexture || !data || width == 0 || height == 0) {
+        throw std::invalid_argument("Invalid argument for UpdateTexture.");
+    }
+    D3D12_RESOURCE_DESC desc = destinationTexture->GetDesc();
+    UINT bytesPerPixel = GetBytesPerPixel(desc.Format);
+    if (bytesPerPixel == 0) {
+        throw std::invalid_argument("Unsupported texture format for UpdateTexture.");
+    }
+
+    // Copy rows into the ring at the pitch the copy engine wants
+    UINT64 rowBytes = static_cast<UINT64>(width) * bytesPerPixel;
+    UINT64 uploadPitch = (rowBytes + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) & ~static_cast<UINT64>(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1);
+    UploadAllocation upload = AllocateUpload(uploadPitch * height, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    uint8_t* dst = static_cast<uint8_t*>(upload.cpuAddress);
+    for (UINT row = 0; row < height; ++row) {
+        memcpy(dst + row * uploadPitch, src + row * srcRowPitch, rowBytes);
+    }
+
+    D3D12_TEXTURE_COPY_LOCATION srcLocation = {};
+    srcLocation.pResource = upload.buffer;
+    srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    srcLocation.PlacedFootprint.Offset = upload.offset;
+    srcLocation.PlacedFootprint.Footprint.Format = desc.Format;
+    srcLocation.PlacedFootprint.Footprint.Width = width;
+    srcLocation.PlacedFootprint.Footprint.Height = height;
+    srcLocation.PlacedFootprint.Footprint.Depth = 1;
+    srcLocation.PlacedFootprint.Footprint.RowPitch = static_cast<UINT>(uploadPitch);
+
+    D3D12_TEXTURE_COPY_LOCATION dstLocation = {};
+    dstLocation.pResource = destinationTexture;
+    dstLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    dstLocation.SubresourceIndex = 0;
+
+    if (GetResourceState(destinationTexture) != D3D12_RESOURCE_STATE_COPY_DEST) {
+        TransitionResource(commandList, destinationTexture, D3D12_RESOURCE_STATE_COPY_DEST);
+    }
+    commandList->CopyTextureRegion(&dstLocation, destX, destY, 0, &srcLocation, nullptr);
+    if (stateAfterCopy != D3D12_RESOURCE_STATE_COPY_DEST) {
+        TransitionResource(commandList, destinationTexture, stateAfterCopy);
+    }
+}
+
 ComPtr<ID3D12Resource> ResourceManager::CreateUploadBuffer(UINT64 size) {
     return CreateBuffer(size, D3D12_RESOURCE_FLAG_NONE, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ);
 }
 
+ComPtr<ID3D12Resource> ResourceManager::CreateReadbackBuffer(UINT64 size) {
+    // Readback heap resources stay in COPY_DEST for their whole life
+    return CreateBuffer(size, D3D12_RESOURCE_FLAG_NONE, D3D12_HEAP_TYPE_READBACK, D3D12_RESOURCE_STATE_COPY_DEST);
+}
+
 ComPtr<ID3D12Resource> ResourceManager::CreateConstantBuffer(UINT size) {
     // Constant buffers must be 256-byte aligned.
     UINT64 alignedSize = (size + D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT - 1) & ~(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT - 1);
@@ -502,29 +983,116 @@ ResourceDescriptor ResourceManager::CreateUnorderedAccessView(
 // --- Resource Tracking & Cleanup ---
 
 void ResourceManager::TrackResourceInternal(ID3D12Resource* resource, ResourceType type, size_t size,
-    D3D12_RESOURCE_STATES initialState) {
+    D3D12_RESOURCE_STATES initialState, bool isPlaced) {
     if (!resource) return;
 
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    // Add/Update usage info
-    ResourceUsage usage;
-    usage.lastUsed = std::chrono::steady_clock::now();
-    usage.size = size;
-    usage.isPinned = false; // Default to not pinned
-    usage.type = type;
-    m_resourceUsage[resource] = usage;
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    TrackedResource* slot = FindOrAddSlot(resource);
+    if (!slot) return;
 
-    // Add/Update state tracking
-    ResourceState state;
-    state.currentState = initialState;
-    m_resourceStates[resource] = state;
+    // Retracking replaces the previous entry
+    if (slot->hasUsage) {
+        m_memoryUsageByType[static_cast<int>(slot->type)] -= slot->size;
+        if (!slot->isPlaced) m_committedResourceBytes -= slot->size;
+    }
+    slot->lastUsed = ToTicks(std::chrono::steady_clock::now());
+    slot->size = size;
+    slot->type = type;
+    slot->hasUsage = true;
+    slot->isPinned = false;
+    slot->isPlaced = isPlaced;
+    slot->state = ResourceState();
+    slot->state.currentState = initialState;
+    if (isPlaced && (type == ResourceType::RenderTarget || type == ResourceType::DepthStencil)) {
+        m_undiscardedTargets.push_back(resource); // Tracked from here, so DiscardPlacedTargets keeps it
+    }
 
     // Update memory statistics
-    m_memoryUsageByType[type] += size;
+    m_memoryUsageByType[static_cast<int>(type)] += size;
+    if (!isPlaced) m_committedResourceBytes += size;
+}
 
-    // Check cache pressure - simplified, real cleanup needs more thought
-    // TrimCacheIfNeeded();
+ResourceManager::TrackedResource* ResourceManager::GetSlot(uint32_t index) const {
+    if (index >= SLOT_CHUNK_SIZE * MAX_SLOT_CHUNKS) return nullptr;
+    TrackedResource* chunk = m_slotChunks[index / SLOT_CHUNK_SIZE].load(std::memory_order_acquire);
+    return chunk ? &chunk[index % SLOT_CHUNK_SIZE] : nullptr;
+}
+
+ResourceManager::TrackedResource* ResourceManager::FindSlot(ID3D12Resource* resource) const {
+    ResourceHandle handle;
+    UINT dataSize = sizeof(handle);
+    if (FAILED(resource->GetPrivateData(RESOURCE_HANDLE_GUID, &dataSize, &handle)) || dataSize != sizeof(handle)) {
+        return nullptr;
+    }
+    TrackedResource* slot = GetSlot(handle.index);
+    if (!slot || slot->generation.load(std::memory_order_acquire) != handle.generation) {
+        return nullptr; // Released since
+    }
+    return slot;
+}
+
+ResourceManager::TrackedResource* ResourceManager::FindOrAddSlot(ID3D12Resource* resource) {
+    TrackedResource* slot = FindSlot(resource);
+    if (slot) return slot;
+
+    uint32_t index = 0;
+    if (!m_freeSlots.empty()) {
+        index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else {
+        if (m_slotCount >= SLOT_CHUNK_SIZE * MAX_SLOT_CHUNKS) {
+            LOG_WARNING("Resource tracking slots exhausted");
+            return nullptr;
+        }
+        index = m_slotCount++;
+        auto& chunk = m_slotChunks[index / SLOT_CHUNK_SIZE];
+        if (!chunk.load(std::memory_order_relaxed)) {
+            chunk.store(new TrackedResource[SLOT_CHUNK_SIZE], std::memory_order_release);
+        }
+    }
+
+    slot = GetSlot(index);
+    ResourceHandle handle;
+    handle.index = index;
+    handle.generation = slot->generation.load(std::memory_order_relaxed);
+    if (FAILED(resource->SetPrivateData(RESOURCE_HANDLE_GUID, sizeof(handle), &handle))) {
+        m_freeSlots.push_back(index);
+        return nullptr;
+    }
+    slot->index = index;
+    slot->resource = resource;
+    slot->lastUsed = m_frameTime.load(std::memory_order_relaxed);
+    slot->isEvicted = false;
+    return slot;
+}
+
+void ResourceManager::ReleaseSlot(TrackedResource& slot) {
+    if (slot.hasUsage) {
+        m_memoryUsageByType[static_cast<int>(slot.type)] -= slot.size;
+        if (!slot.isPlaced) m_committedResourceBytes -= slot.size;
+    }
+    if (slot.isEvicted) m_videoMemoryBudget.evictedCount--;
+    if (slot.state.splitPending) {
+        m_openSplitBarriers.erase(std::remove(m_openSplitBarriers.begin(), m_openSplitBarriers.end(), slot.resource),
+            m_openSplitBarriers.end());
+    }
+    if (!slot.name.empty()) {
+        m_namedResources.erase(slot.name);
+    }
+
+    // The handle left on the resource goes stale; the resource may already be gone, so it isn't touched
+    slot.generation.fetch_add(1, std::memory_order_release);
+    slot.resource = nullptr;
+    slot.size = 0;
+    slot.type = ResourceType::Other;
+    slot.hasUsage = false;
+    slot.isPinned = false;
+    slot.isPlaced = false;
+    slot.isEvicted = false;
+    slot.state = ResourceState();
+    slot.name.clear();
+    m_freeSlots.push_back(slot.index);
 }
 
 void ResourceManager::TrackExplicitResource(const std::string& id, ID3D12Resource* resource, ResourceType type, size_t size,
@@ -534,104 +1102,156 @@ void ResourceManager::TrackExplicitResource(const std::string& id, ID3D12Resourc
     TrackResourceInternal(resource, type, size, initialState);
 
     // Add to named resources map
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    TrackedResource* slot = FindSlot(resource);
+    if (!slot) return;
+    if (!slot->name.empty()) m_namedResources.erase(slot->name);
+    auto namedIt = m_namedResources.find(id);
+    if (namedIt != m_namedResources.end()) {
+        TrackedResource* previous = FindSlot(namedIt->second);
+        if (previous) previous->name.clear(); // The id moves to this resource
+    }
+    slot->name = id;
     m_namedResources[id] = resource;
 }
 
 
 void ResourceManager::ReleaseResource(const std::string& id) {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
 
     auto namedIt = m_namedResources.find(id);
     if (namedIt != m_namedResources.end()) {
-        ID3D12Resource* resource = namedIt->second;
+        TrackedResource* slot = FindSlot(namedIt->second);
         m_namedResources.erase(namedIt); // Remove from named map
-
-        // Remove from usage and state maps using the pointer
-        auto usageIt = m_resourceUsage.find(resource);
-        if (usageIt != m_resourceUsage.end()) {
-            m_memoryUsageByType[usageIt->second.type] -= usageIt->second.size;
-            m_resourceUsage.erase(usageIt);
+        if (slot) {
+            ReleaseSlot(*slot);
         }
-        m_resourceStates.erase(resource);
     }
     // Note: This only removes tracking. The ComPtr holding the resource needs to be released elsewhere.
 }
 
 void ResourceManager::ReleaseResource(ID3D12Resource* resource) {
     if (!resource) return;
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
 
-    // Remove from usage and state maps
-    auto usageIt = m_resourceUsage.find(resource);
-    if (usageIt != m_resourceUsage.end()) {
-        m_memoryUsageByType[usageIt->second.type] -= usageIt->second.size;
-        m_resourceUsage.erase(usageIt);
+    // Usage, state and name go together
+    TrackedResource* slot = FindSlot(resource);
+    if (slot) {
+        ReleaseSlot(*slot);
     }
-    m_resourceStates.erase(resource);
+}
 
-    // Remove from named map if it exists there
-    for (auto it = m_namedResources.begin(); it != m_namedResources.end(); ) {
-        if (it->second == resource) {
-            it = m_namedResources.erase(it);
-        }
-        else {
-            ++it;
+
+void ResourceManager::ReleaseUnusedResources(std::chrono::seconds maxAge) {
+    if (!m_renderSystem) return;
+
+    // Only tracking is dropped here, so no GPU wait is needed
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    // Pooled textures idle this long are unlikely to be asked for again
+    TrimTexturePool(m_texturePoolLimit, maxAge);
+
+    for (UINT i = 0; i < m_slotCount; i++) {
+        TrackedResource* slot = GetSlot(i);
+        if (!slot->resource || !slot->hasUsage || slot->isPinned) continue;
+        auto age = std::chrono::duration_cast<std::chrono::seconds>(now - FromTicks(slot->lastUsed));
+        if (age > maxAge) {
+            LOG_DEBUG("Releasing unused resource: %p", static_cast<const void*>(slot->resource));
+            // This removes tracking. The actual resource release happens
+            // when the last ComPtr pointing to it goes out of scope.
+            ReleaseSlot(*slot);
         }
     }
 }
 
 
-void ResourceManager::ReleaseUnusedResources(std::chrono::seconds maxAge) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    if (!m_renderSystem) return;
+// --- Resource State Management ---
 
-    // Wait for GPU idle before releasing potentially used resources
-    // This is a coarse approach; finer-grained fence management per resource is better
-    m_renderSystem->WaitForGpu();
+void ResourceManager::RetireResource(ComPtr<IUnknown> object, std::function<void()> onRelease) {
+    if (!object && !onRelease) return;
 
-    auto now = std::chrono::steady_clock::now();
-    std::vector<ID3D12Resource*> toRemove;
+    // Stop tracking now; the object itself stays alive in the queue
+    ComPtr<ID3D12Resource> resource;
+    if (object && SUCCEEDED(object.As(&resource))) {
+        ReleaseResource(resource.Get());
+    }
 
-    for (auto const& [resource, usage] : m_resourceUsage) {
-        if (!usage.isPinned) {
-            auto age = std::chrono::duration_cast<std::chrono::seconds>(now - usage.lastUsed);
-            if (age > maxAge) {
-                toRemove.push_back(resource);
-            }
+    RetiredResource retired;
+    retired.object = std::move(object);
+    retired.onRelease = std::move(onRelease);
+    retired.fenceValue = m_renderSystem->GetCurrentFenceValue();
+
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    m_retiredResources.push_back(std::move(retired));
+}
+
+void ResourceManager::ProcessRetiredResources(UINT64 completedFenceValue) {
+    // The frame's stamp for NotifyResourceUsed (one clock read per frame instead of per call)
+    m_frameTime.store(ToTicks(std::chrono::steady_clock::now()), std::memory_order_relaxed);
+
+    std::vector<RetiredResource> ready;
+    {
+        std::lock_guard<ProfiledMutex> lock(m_mutex);
+        if (completedFenceValue != UINT64_MAX) { // Not a flush; later recycles still need the real value
+            m_completedFenceValue = (std::max)(m_completedFenceValue, completedFenceValue);
+        }
+        for (auto& pair : m_descriptorPools) {
+            ReclaimTransientDescriptors(pair.second, completedFenceValue);
+        }
+        while (!m_uploadSpans.empty() && m_uploadSpans.front().fenceValue <= completedFenceValue) {
+            m_uploadRingUsed -= m_uploadSpans.front().size;
+            m_uploadSpans.pop_front();
+        }
+        while (!m_retiredResources.empty() && m_retiredResources.front().fenceValue <= completedFenceValue) {
+            ready.push_back(std::move(m_retiredResources.front()));
+            m_retiredResources.pop_front();
         }
     }
 
-    for (ID3D12Resource* resource : toRemove) {
-        OutputDebugStringA(("Releasing unused resource: " + PtrToID(resource) + "\n").c_str());
-        // This removes tracking. The actual resource release happens
-        // when the last ComPtr pointing to it goes out of scope.
-        // If this manager *owned* the ComPtrs, we would release them here.
-        ReleaseResource(resource);
+    // Callbacks may call back into the manager (e.g. FreeDescriptor)
+    for (RetiredResource& retired : ready) {
+        retired.object.Reset();
+        if (retired.onRelease) {
+            retired.onRelease();
+        }
     }
 }
 
+void ResourceManager::FlushRetiredResources() {
+    ProcessRetiredResources(UINT64_MAX);
+}
 
-// --- Resource State Management ---
+size_t ResourceManager::GetRetiredResourceCount() const {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    return m_retiredResources.size();
+}
 
 D3D12_RESOURCE_STATES ResourceManager::GetResourceState(ID3D12Resource* resource) const {
     if (!resource) return D3D12_RESOURCE_STATE_COMMON; // Or throw
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = m_resourceStates.find(resource);
-    if (it != m_resourceStates.end()) {
-        return it->second.currentState;
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    TrackedResource* slot = FindSlot(resource);
+    if (slot) {
+        // Diverged subresources report the first one
+        return slot->state.subresourceStates.empty() ? slot->state.currentState : slot->state.subresourceStates[0];
     }
     // If not tracked, assume common state. This might be dangerous.
     // Consider throwing or logging a warning if a resource state is queried but not tracked.
-    OutputDebugStringA(("Warning: Queried state of untracked resource: " + PtrToID(resource) + "\n").c_str());
+    LOG_WARNING("Queried state of untracked resource: %p", static_cast<const void*>(resource));
     return D3D12_RESOURCE_STATE_COMMON;
 }
 
 // Set state directly - Use primarily internally or when absolutely sure.
 void ResourceManager::SetResourceState(ID3D12Resource* resource, D3D12_RESOURCE_STATES state) {
     if (!resource) return;
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_resourceStates[resource].currentState = state;
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    TrackedResource* slot = FindOrAddSlot(resource); // State-only slot if untracked
+    if (!slot) return;
+    slot->state.currentState = state;
+    slot->state.subresourceStates.clear();
+}
+
+bool ResourceManager::IsResourceStateTracked(ID3D12Resource* resource) const {
+    return resource && FindSlot(resource) != nullptr;
 }
 
 D3D12_RESOURCE_BARRIER ResourceManager::TransitionBarrier(ID3D12Resource* resource,
@@ -650,28 +1270,242 @@ void ResourceManager::TransitionResource(ID3D12GraphicsCommandList* commandList,
     D3D12_RESOURCE_STATES newState) {
     if (!commandList || !resource) return;
 
-    D3D12_RESOURCE_STATES currentState = GetResourceState(resource);
-
-    if (currentState != newState) {
-        D3D12_RESOURCE_BARRIER barrier = TransitionBarrier(resource, currentState, newState);
-        commandList->ResourceBarrier(1, &barrier);
-        SetResourceState(resource, newState); // Update tracked state
-    }
+    QueueTransition(resource, newState);
+    FlushBarriers(commandList);
 }
 
 void ResourceManager::TransitionResources(ID3D12GraphicsCommandList* commandList,
     const std::vector<D3D12_RESOURCE_BARRIER>& barriers) {
     if (!commandList || barriers.empty()) return;
 
-    commandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+    // Recorded with whatever is queued, which has to go first
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    m_pendingBarriers.insert(m_pendingBarriers.end(), barriers.begin(), barriers.end());
+    commandList->ResourceBarrier(static_cast<UINT>(m_pendingBarriers.size()), m_pendingBarriers.data());
+    m_pendingBarriers.clear();
 
     // Update tracked state for each transitioned resource
-    std::lock_guard<std::mutex> lock(m_mutex);
     for (const auto& barrier : barriers) {
-        if (barrier.Type == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION) {
-            m_resourceStates[barrier.Transition.pResource].currentState = barrier.Transition.StateAfter;
+        TrackedResource* slot = barrier.Type == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION ?
+            FindOrAddSlot(barrier.Transition.pResource) : nullptr;
+        if (slot) {
+            ResourceState& tracked = slot->state;
+            if (barrier.Transition.Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES) {
+                tracked.currentState = barrier.Transition.StateAfter;
+                tracked.subresourceStates.clear();
+            }
+            else if (barrier.Transition.Subresource < tracked.subresourceStates.size()) {
+                tracked.subresourceStates[barrier.Transition.Subresource] = barrier.Transition.StateAfter;
+            }
+        }
+    }
+}
+
+// --- Barrier Batching ---
+
+static UINT GetSubresourceCount(ID3D12Resource* resource) {
+    D3D12_RESOURCE_DESC desc = resource->GetDesc();
+    if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER) return 1;
+    UINT arraySize = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1 : desc.DepthOrArraySize;
+    return std::max<UINT>(desc.MipLevels, 1) * arraySize; // Planar formats aren't used here
+}
+
+void ResourceManager::DiscardPlacedTargets(ID3D12GraphicsCommandList* commandList) {
+    std::vector<ComPtr<ID3D12Resource>> targets;
+    {
+        std::lock_guard<ProfiledMutex> lock(m_mutex);
+        targets.swap(m_undiscardedTargets);
+    }
+    if (targets.empty()) return;
+
+    // Released since (nothing tracks their state any more) are just dropped. DiscardResource needs
+    // RENDER_TARGET or DEPTH_WRITE; the barriers are flushed on each side, or the round trip would
+    // cancel out in the batch.
+    std::vector<D3D12_RESOURCE_STATES> states(targets.size());
+    for (size_t i = 0; i < targets.size(); i++) {
+        ID3D12Resource* target = targets[i].Get();
+        if (!IsResourceStateTracked(target)) {
+            targets[i].Reset();
+            continue;
+        }
+        states[i] = GetResourceState(target);
+        const bool depth = (target->GetDesc().Flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL) != 0;
+        QueueTransition(target, depth ? D3D12_RESOURCE_STATE_DEPTH_WRITE : D3D12_RESOURCE_STATE_RENDER_TARGET);
+    }
+    FlushBarriers(commandList);
+    for (size_t i = 0; i < targets.size(); i++) {
+        if (!targets[i]) continue;
+        commandList->DiscardResource(targets[i].Get(), nullptr);
+        QueueTransition(targets[i].Get(), states[i]);
+    }
+    FlushBarriers(commandList);
+}
+
+void ResourceManager::QueueTransition(ID3D12Resource* resource, D3D12_RESOURCE_STATES newState, UINT subresource) {
+    if (!resource) return;
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    TrackedResource* slot = FindOrAddSlot(resource);
+    if (slot) {
+        QueueTransitionLocked(resource, slot->state, newState, subresource);
+    }
+}
+
+void ResourceManager::QueueTransitionLocked(ID3D12Resource* resource, ResourceState& state,
+    D3D12_RESOURCE_STATES newState, UINT subresource) {
+    if (state.splitPending) {
+        EndSplitTransitionLocked(resource, state);
+    }
+
+    if (subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES) {
+        if (state.subresourceStates.empty()) {
+            QueueBarrierLocked(resource, subresource, state.currentState, newState);
         }
+        else {
+            for (UINT i = 0; i < state.subresourceStates.size(); i++) {
+                QueueBarrierLocked(resource, i, state.subresourceStates[i], newState);
+            }
+            state.subresourceStates.clear();
+        }
+        state.currentState = newState;
+        return;
     }
+
+    if (state.subresourceStates.empty()) {
+        if (state.currentState == newState) return;
+        state.subresourceStates.assign(GetSubresourceCount(resource), state.currentState);
+
+        // A queued whole-resource barrier becomes one per subresource so they can merge individually
+        for (size_t i = 0; i < m_pendingBarriers.size(); i++) {
+            D3D12_RESOURCE_BARRIER barrier = m_pendingBarriers[i];
+            if (barrier.Type != D3D12_RESOURCE_BARRIER_TYPE_TRANSITION || barrier.Transition.pResource != resource ||
+                barrier.Transition.Subresource != D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES ||
+                barrier.Flags != D3D12_RESOURCE_BARRIER_FLAG_NONE) {
+                continue;
+            }
+            m_pendingBarriers.erase(m_pendingBarriers.begin() + i);
+            for (UINT sub = 0; sub < state.subresourceStates.size(); sub++) {
+                m_pendingBarriers.push_back(TransitionBarrier(resource, barrier.Transition.StateBefore,
+                    barrier.Transition.StateAfter, sub));
+            }
+            break;
+        }
+    }
+    if (subresource >= state.subresourceStates.size()) return;
+
+    QueueBarrierLocked(resource, subresource, state.subresourceStates[subresource], newState);
+    state.subresourceStates[subresource] = newState;
+}
+
+void ResourceManager::QueueBarrierLocked(ID3D12Resource* resource, UINT subresource,
+    D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after) {
+    if (before == after) return;
+
+    // Merge with a queued transition of the same subresource; nothing used it in between
+    for (auto it = m_pendingBarriers.begin(); it != m_pendingBarriers.end(); ++it) {
+        if (it->Type != D3D12_RESOURCE_BARRIER_TYPE_TRANSITION || it->Flags != D3D12_RESOURCE_BARRIER_FLAG_NONE ||
+            it->Transition.pResource != resource || it->Transition.Subresource != subresource) {
+            continue;
+        }
+        if (it->Transition.StateBefore == after) {
+            m_pendingBarriers.erase(it); // Ping-pong
+        }
+        else {
+            it->Transition.StateAfter = after;
+        }
+        return;
+    }
+    m_pendingBarriers.push_back(TransitionBarrier(resource, before, after, subresource));
+}
+
+void ResourceManager::FlushBarriers(ID3D12GraphicsCommandList* commandList) {
+    if (!commandList) return;
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    if (m_pendingBarriers.empty()) return;
+
+    commandList->ResourceBarrier(static_cast<UINT>(m_pendingBarriers.size()), m_pendingBarriers.data());
+
+    // Subresources that ended up in the same state are tracked as a whole again
+    for (const auto& barrier : m_pendingBarriers) {
+        if (barrier.Type != D3D12_RESOURCE_BARRIER_TYPE_TRANSITION) continue;
+        TrackedResource* slot = FindSlot(barrier.Transition.pResource);
+        if (!slot || slot->state.subresourceStates.empty()) continue;
+        auto& states = slot->state.subresourceStates;
+        if (std::all_of(states.begin(), states.end(), [&](D3D12_RESOURCE_STATES s) { return s == states[0]; })) {
+            slot->state.currentState = states[0];
+            states.clear();
+        }
+    }
+    m_pendingBarriers.clear();
+}
+
+void ResourceManager::BeginSplitTransition(ID3D12Resource* resource, D3D12_RESOURCE_STATES newState) {
+    if (!resource) return;
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    TrackedResource* slot = FindOrAddSlot(resource);
+    if (!slot) return;
+    ResourceState& state = slot->state;
+    if (state.splitPending) {
+        EndSplitTransitionLocked(resource, state);
+    }
+
+    // Only whole, uniformly tracked resources are split; a transition still queued for it merges instead
+    bool queued = std::any_of(m_pendingBarriers.begin(), m_pendingBarriers.end(),
+        [resource](const D3D12_RESOURCE_BARRIER& barrier) {
+            return barrier.Type == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION && barrier.Transition.pResource == resource;
+        });
+    if (queued || !state.subresourceStates.empty()) {
+        QueueTransitionLocked(resource, state, newState, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+        return;
+    }
+    if (state.currentState == newState) return;
+
+    D3D12_RESOURCE_BARRIER barrier = TransitionBarrier(resource, state.currentState, newState);
+    barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+    m_pendingBarriers.push_back(barrier);
+
+    state.splitPending = true;
+    state.splitBeforeState = state.currentState;
+    state.currentState = newState;
+    m_openSplitBarriers.push_back(resource);
+}
+
+void ResourceManager::EndSplitTransitions() {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    while (!m_openSplitBarriers.empty()) {
+        ID3D12Resource* resource = m_openSplitBarriers.back();
+        TrackedResource* slot = FindSlot(resource);
+        if (slot && slot->state.splitPending) {
+            EndSplitTransitionLocked(resource, slot->state);
+        }
+        else {
+            m_openSplitBarriers.pop_back();
+        }
+    }
+}
+
+void ResourceManager::EndSplitTransitionLocked(ID3D12Resource* resource, ResourceState& state) {
+    D3D12_RESOURCE_BARRIER barrier = TransitionBarrier(resource, state.splitBeforeState, state.currentState);
+    barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+    m_pendingBarriers.push_back(barrier);
+
+    state.splitPending = false;
+    m_openSplitBarriers.erase(std::remove(m_openSplitBarriers.begin(), m_openSplitBarriers.end(), resource),
+        m_openSplitBarriers.end());
+}
+
+void ResourceManager::QueueAliasingBarrier(ID3D12Resource* before, ID3D12Resource* after) {
+    if (!after) return;
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+    barrier.Aliasing.pResourceBefore = before;
+    barrier.Aliasing.pResourceAfter = after;
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    m_pendingBarriers.push_back(barrier);
+}
+
+size_t ResourceManager::GetPendingBarrierCount() const {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    return m_pendingBarriers.size();
 }
 
 
@@ -679,31 +1513,144 @@ void ResourceManager::TransitionResources(ID3D12GraphicsCommandList* commandList
 
 void ResourceManager::NotifyResourceUsed(ID3D12Resource* resource) {
     if (!resource) return;
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = m_resourceUsage.find(resource);
-    if (it != m_resourceUsage.end()) {
-        it->second.lastUsed = std::chrono::steady_clock::now();
+    TrackedResource* slot = FindSlot(resource);
+    if (!slot) return;
+
+    // Hot path: called for every sampled resource every frame, from any thread.
+    // Stamp, then check (both sequentially consistent): RelieveBudgetPressure flags, then rechecks the
+    // stamp, so either it sees this use or this call sees the flag and waits on the lock below.
+    slot->lastUsed.store(m_frameTime.load(std::memory_order_relaxed));
+    if (!slot->isEvicted.load()) return;
+
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    slot = FindSlot(resource); // Recheck under the lock
+    if (slot && slot->isEvicted) {
+        // Blocks until paged back in; evicted resources were idle, so this is rare
+        PROFILE_ZONE("Make Resident");
+        ID3D12Pageable* pageable = resource;
+        if (SUCCEEDED(m_renderSystem->GetDevice()->MakeResident(1, &pageable))) {
+            slot->isEvicted = false;
+            m_videoMemoryBudget.evictedCount--;
+        }
+        else {
+            LOG_WARNING("MakeResident failed for an evicted resource");
+        }
+    }
+}
+
+// --- Video Memory Budget ---
+
+void ResourceManager::UpdateVideoMemoryBudget() {
+    if (!m_adapter) return;
+
+    auto now = std::chrono::steady_clock::now();
+    bool budgetChanged = m_budgetChangedEvent && WaitForSingleObject(m_budgetChangedEvent, 0) == WAIT_OBJECT_0;
+    if (!budgetChanged && now - m_lastBudgetQuery < std::chrono::milliseconds(BUDGET_POLL_MS)) return;
+    m_lastBudgetQuery = now;
+
+    DXGI_QUERY_VIDEO_MEMORY_INFO info = {};
+    if (FAILED(m_adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info))) return;
+
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    bool wasOverBudget = m_videoMemoryBudget.overBudget;
+    m_videoMemoryBudget.budgetBytes = info.Budget;
+    m_videoMemoryBudget.usageBytes = info.CurrentUsage;
+    m_videoMemoryBudget.overBudget = info.Budget > 0 && info.CurrentUsage > info.Budget;
+
+    if (m_videoMemoryBudget.overBudget) {
+        if (!wasOverBudget) {
+            LOG_WARNING("Over video memory budget (%llu / %llu MB), trimming",
+                static_cast<unsigned long long>(info.CurrentUsage >> 20), static_cast<unsigned long long>(info.Budget >> 20));
+        }
+        RelieveBudgetPressure(info.CurrentUsage - info.Budget);
     }
 }
 
+ResourceManager::VideoMemoryBudget ResourceManager::GetVideoMemoryBudget() const {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    return m_videoMemoryBudget;
+}
+
+void ResourceManager::RelieveBudgetPressure(UINT64 excessBytes) {
+    // Aim a little under the budget so usage doesn't hover at the edge
+    UINT64 target = excessBytes + m_videoMemoryBudget.budgetBytes / 20;
+
+    // 1. Pooled textures are pure cache (released once their frame is done)
+    UINT64 freed = m_texturePoolBytes;
+    TrimTexturePool(0);
+    if (freed >= target) return;
+
+    // 2. Evict committed resources idle the longest
+    EvictIdleResources(target - freed, std::chrono::seconds(EVICT_IDLE_SECONDS));
+}
+
+void ResourceManager::EvictIdleResources(UINT64 targetBytes, std::chrono::seconds minIdle) {
+    // Placed resources share their heap's residency, so only committed ones are candidates
+    auto now = std::chrono::steady_clock::now();
+    std::vector<std::pair<int64_t, TrackedResource*>> candidates;
+    for (UINT i = 0; i < m_slotCount; i++) {
+        TrackedResource* slot = GetSlot(i);
+        if (!slot->resource || !slot->hasUsage || slot->isPinned || slot->isPlaced || slot->isEvicted) continue;
+        int64_t lastUsed = slot->lastUsed;
+        if (now - FromTicks(lastUsed) < minIdle) continue;
+        candidates.emplace_back(lastUsed, slot);
+    }
+    std::sort(candidates.begin(), candidates.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    UINT64 freed = 0;
+    std::vector<TrackedResource*> evicted;
+    std::vector<ID3D12Pageable*> toEvict;
+    for (const auto& [lastUsed, slot] : candidates) {
+        if (freed >= targetBytes) break;
+        slot->isEvicted = true;
+        if (slot->lastUsed != lastUsed) {
+            slot->isEvicted = false; // Used meanwhile (NotifyResourceUsed from another thread)
+            continue;
+        }
+        freed += slot->size;
+        evicted.push_back(slot);
+        toEvict.push_back(slot->resource);
+    }
+    if (toEvict.empty()) return;
+
+    if (SUCCEEDED(m_renderSystem->GetDevice()->Evict(static_cast<UINT>(toEvict.size()), toEvict.data()))) {
+        PROFILE_EVENT("Evict Resources");
+        m_videoMemoryBudget.evictedCount += static_cast<UINT>(toEvict.size());
+    }
+    else {
+        for (TrackedResource* slot : evicted) {
+            slot->isEvicted = false;
+        }
+    }
+}
+
+void ResourceManager::TrimMemory() {
+    if (!m_renderSystem) return;
+
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    TrimTexturePool(0);
+    EvictIdleResources(UINT64_MAX, std::chrono::seconds(TRIM_IDLE_SECONDS));
+}
+
 void ResourceManager::PinResource(ID3D12Resource* resource, bool pin) {
     if (!resource) return;
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = m_resourceUsage.find(resource);
-    if (it != m_resourceUsage.end()) {
-        it->second.isPinned = pin;
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    TrackedResource* slot = FindSlot(resource);
+    if (slot && slot->hasUsage) {
+        slot->isPinned = pin;
     }
     else {
-        OutputDebugStringA(("Warning: Tried to pin untracked resource: " + PtrToID(resource) + "\n").c_str());
+        LOG_WARNING("Tried to pin untracked resource: %p", static_cast<const void*>(resource));
     }
 }
 
 bool ResourceManager::IsPinned(ID3D12Resource* resource) const {
     if (!resource) return false;
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = m_resourceUsage.find(resource);
-    if (it != m_resourceUsage.end()) {
-        return it->second.isPinned;
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    TrackedResource* slot = FindSlot(resource);
+    if (slot) {
+        return slot->isPinned;
     }
     return false; // Untracked resources are not pinned
 }
@@ -712,7 +1659,7 @@ bool ResourceManager::IsPinned(ID3D12Resource* resource) const {
 // --- Descriptor Management ---
 
 ResourceDescriptor ResourceManager::AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE type) {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
 
     auto poolIt = m_descriptorPools.find(type);
     if (poolIt == m_descriptorPools.end()) {
@@ -720,60 +1667,119 @@ ResourceDescriptor ResourceManager::AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYP
     }
     auto& pool = poolIt->second;
 
-    // Simple linear search for a free slot
-    for (UINT i = 0; i < pool.capacity; ++i) {
-        if (!pool.allocated[i]) {
-            pool.allocated[i] = true;
-            pool.size++;
-
-            ResourceDescriptor desc;
-            desc.heapIndex = i;
-            desc.type = type;
-            desc.cpuHandle = pool.cpuStart;
-            desc.cpuHandle.ptr += static_cast<SIZE_T>(i) * pool.descriptorSize; // Correct offset calculation
-
-            if (pool.heap->GetDesc().Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE) {
-                desc.gpuHandle = pool.gpuStart;
-                desc.gpuHandle.ptr += static_cast<SIZE_T>(i) * pool.descriptorSize; // Correct offset calculation
-            }
-            else {
-                desc.gpuHandle = {}; // Invalid GPU handle
-            }
+    // Summary word -> bitmap word -> slot; one summary word covers 4096 slots
+    for (size_t s = 0; s < pool.summaryBits.size(); ++s) {
+        if (pool.summaryBits[s] == 0) continue;
 
-            return desc;
+        UINT word = static_cast<UINT>(s) * 64 + LowestSetBit(pool.summaryBits[s]);
+        UINT bit = LowestSetBit(pool.freeBits[word]);
+        pool.freeBits[word] &= ~(1ull << bit);
+        if (pool.freeBits[word] == 0) {
+            pool.summaryBits[s] &= ~(1ull << (word % 64));
         }
+        pool.size++;
+        return MakeDescriptor(pool, word * 64 + bit);
     }
 
     // Out of descriptors - resize or throw
     throw std::runtime_error("Out of descriptors in pool type " + std::to_string(type));
-    // return { UINT_MAX, {}, {}, type }; // Indicate failure
+}
+
+ResourceDescriptor ResourceManager::AllocateTransientDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE type, UINT count) {
+    UINT64 fenceValue = m_renderSystem->GetCurrentFenceValue();
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+
+    auto poolIt = m_descriptorPools.find(type);
+    if (poolIt == m_descriptorPools.end() || poolIt->second.transientCapacity == 0) {
+        throw std::runtime_error("No transient descriptor range for pool type " + std::to_string(type));
+    }
+    auto& pool = poolIt->second;
+    if (count == 0 || count > pool.transientCapacity) {
+        throw std::runtime_error("Invalid transient descriptor count " + std::to_string(count));
+    }
+
+    // Keep the range contiguous: skip the ring's tail end if it doesn't fit
+    UINT skipped = (pool.transientHead + count > pool.transientCapacity) ?
+        pool.transientCapacity - pool.transientHead : 0;
+    if (pool.transientUsed + skipped + count > pool.transientCapacity) {
+        throw std::runtime_error("Out of transient descriptors in pool type " + std::to_string(type));
+    }
+    if (skipped > 0) {
+        pool.transientHead = 0;
+    }
+
+    UINT start = pool.transientHead;
+    pool.transientHead = (start + count) % pool.transientCapacity;
+    pool.transientUsed += skipped + count;
+
+    // One span per frame: all of this frame's slots come back together
+    if (!pool.transientSpans.empty() && pool.transientSpans.back().fenceValue == fenceValue) {
+        pool.transientSpans.back().count += skipped + count;
+    }
+    else {
+        pool.transientSpans.push_back({ fenceValue, skipped + count });
+    }
+
+    return MakeDescriptor(pool, pool.capacity + start);
+}
+
+ID3D12DescriptorHeap* ResourceManager::GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE type) const {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    auto poolIt = m_descriptorPools.find(type);
+    return poolIt != m_descriptorPools.end() ? poolIt->second.heap.Get() : nullptr;
+}
+
+ResourceDescriptor ResourceManager::GetDescriptorFromCpuHandle(D3D12_DESCRIPTOR_HEAP_TYPE type,
+                                                               D3D12_CPU_DESCRIPTOR_HANDLE handle) const {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    auto poolIt = m_descriptorPools.find(type);
+    if (poolIt == m_descriptorPools.end()) return {};
+
+    const auto& pool = poolIt->second;
+    if (handle.ptr < pool.cpuStart.ptr) return {};
+    SIZE_T index = (handle.ptr - pool.cpuStart.ptr) / pool.descriptorSize;
+    if (index >= pool.capacity + pool.transientCapacity) return {};
+    return MakeDescriptor(pool, static_cast<UINT>(index));
+}
+
+UINT ResourceManager::GetAllocatedDescriptorCount(D3D12_DESCRIPTOR_HEAP_TYPE type) const {
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    auto poolIt = m_descriptorPools.find(type);
+    return poolIt != m_descriptorPools.end() ? poolIt->second.size : 0;
 }
 
 void ResourceManager::FreeDescriptor(const ResourceDescriptor& descriptor) {
     if (descriptor.heapIndex == UINT_MAX) return; // Invalid descriptor
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
 
     auto poolIt = m_descriptorPools.find(descriptor.type);
     if (poolIt == m_descriptorPools.end()) {
-        OutputDebugStringA(("Warning: Trying to free descriptor from non-existent pool type " + std::to_string(descriptor.type) + "\n").c_str());
+        LOG_WARNING("Trying to free descriptor from non-existent pool type %d", static_cast<int>(descriptor.type));
         return;
     }
     auto& pool = poolIt->second;
 
-    if (descriptor.heapIndex < pool.capacity && pool.allocated[descriptor.heapIndex]) {
-        pool.allocated[descriptor.heapIndex] = false;
+    UINT word = descriptor.heapIndex / 64;
+    uint64_t mask = 1ull << (descriptor.heapIndex % 64);
+    if (descriptor.heapIndex < pool.capacity && (pool.freeBits[word] & mask) == 0) {
+        pool.freeBits[word] |= mask;
+        pool.summaryBits[word / 64] |= 1ull << (word % 64);
         pool.size--;
     }
+    else if (descriptor.heapIndex < pool.capacity + pool.transientCapacity && descriptor.heapIndex >= pool.capacity) {
+        LOG_WARNING("Transient descriptors are reclaimed per frame and must not be freed");
+    }
     else {
-        OutputDebugStringA(("Warning: Trying to free invalid or already freed descriptor index " + std::to_string(descriptor.heapIndex) + " in pool type " + std::to_string(descriptor.type) + "\n").c_str());
+        LOG_WARNING("Trying to free invalid or already freed descriptor index %u in pool type %d", descriptor.heapIndex,
+            static_cast<int>(descriptor.type));
     }
 }
 
 D3D12_CPU_DESCRIPTOR_HANDLE ResourceManager::GetCpuDescriptorHandle(const ResourceDescriptor& descriptor) const {
     if (descriptor.heapIndex == UINT_MAX) return {};
     // Recalculate based on stored start and index - safer than storing potentially stale handle directly
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
     const auto& pool = m_descriptorPools.at(descriptor.type);
     D3D12_CPU_DESCRIPTOR_HANDLE handle = pool.cpuStart;
     handle.ptr += static_cast<SIZE_T>(descriptor.heapIndex) * pool.descriptorSize;
@@ -782,9 +1788,9 @@ D3D12_CPU_DESCRIPTOR_HANDLE ResourceManager::GetCpuDescriptorHandle(const Resour
 
 D3D12_GPU_DESCRIPTOR_HANDLE ResourceManager::GetGpuDescriptorHandle(const ResourceDescriptor& descriptor) const {
     if (descriptor.heapIndex == UINT_MAX) return {};
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
     const auto& pool = m_descriptorPools.at(descriptor.type);
-    if (!(pool.heap->GetDesc().Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE)) return {}; // Not shader visible
+    if (!pool.shaderVisible) return {}; // Not shader visible
 
     D3D12_GPU_DESCRIPTOR_HANDLE handle = pool.gpuStart;
     handle.ptr += static_cast<SIZE_T>(descriptor.heapIndex) * pool.descriptorSize;
@@ -792,7 +1798,7 @@ D3D12_GPU_DESCRIPTOR_HANDLE ResourceManager::GetGpuDescriptorHandle(const Resour
 }
 
 UINT ResourceManager::GetDescriptorSize(D3D12_DESCRIPTOR_HEAP_TYPE type) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
     auto poolIt = m_descriptorPools.find(type);
     if (poolIt != m_descriptorPools.end()) {
         return poolIt->second.descriptorSize;
@@ -804,45 +1810,112 @@ UINT ResourceManager::GetDescriptorSize(D3D12_DESCRIPTOR_HEAP_TYPE type) const {
 
 // --- Memory Statistics ---
 
-size_t ResourceManager::GetTotalMemoryUsage() const {
-    std::lock_guard<std::mutex> lock(m_mutex);
+size_t ResourceManager::GetTotalMemoryUsage(size_t* committedBytes) const {
     size_t total = 0;
-    for (const auto& pair : m_memoryUsageByType) {
-        total += pair.second;
+    for (const auto& bytes : m_memoryUsageByType) {
+        total += bytes.load(std::memory_order_relaxed);
+    }
+    if (committedBytes) {
+        *committedBytes = m_committedResourceBytes + static_cast<size_t>(m_placedAllocator->GetStats().heapBytes);
     }
     return total;
 }
 
 size_t ResourceManager::GetMemoryUsageByType(ResourceType type) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = m_memoryUsageByType.find(type);
-    if (it != m_memoryUsageByType.end()) {
-        return it->second;
+    if (type >= ResourceType::Count) return 0;
+    return m_memoryUsageByType[static_cast<int>(type)].load(std::memory_order_relaxed);
+}
+
+const char* ResourceManager::GetResourceTypeName(ResourceType type) {
+    switch (type) {
+    case ResourceType::Texture: return "Textures";
+    case ResourceType::Buffer: return "Buffers";
+    case ResourceType::UploadBuffer: return "Upload buffers";
+    case ResourceType::ReadbackBuffer: return "Readback buffers";
+    case ResourceType::RenderTarget: return "Render targets";
+    case ResourceType::DepthStencil: return "Depth stencils";
+    case ResourceType::Shader: return "Shaders";
+    default: return "Other";
     }
-    return 0;
+}
+
+// --- Memory Report ---
+
+ResourceManager::MemoryReport ResourceManager::GetMemoryReport() const {
+    MemoryReport report;
+    report.trackedBytes = GetTotalMemoryUsage(&report.committedBytes);
+    report.placedHeaps = m_placedAllocator->GetStats();
+
+    {
+        std::lock_guard<ProfiledMutex> lock(m_mutex);
+        for (UINT i = 0; i < m_slotCount; i++) {
+            const TrackedResource* slot = GetSlot(i);
+            if (!slot->resource || !slot->hasUsage) continue;
+            report.bytesByType[static_cast<int>(slot->type)] += slot->size;
+            report.countByType[static_cast<int>(slot->type)]++;
+        }
+
+        for (const auto& [type, pool] : m_descriptorPools) {
+            MemoryReport::DescriptorHeapFill fill;
+            fill.type = type;
+            fill.used = pool.size;
+            fill.capacity = pool.capacity;
+            fill.transientUsed = pool.transientUsed;
+            fill.transientCapacity = pool.transientCapacity;
+            report.descriptorHeaps.push_back(fill);
+        }
+
+        report.texturePoolBytes = m_texturePoolBytes;
+        report.texturePoolLimit = m_texturePoolLimit;
+        for (const auto& entry : m_texturePool) {
+            report.texturePoolCount += static_cast<UINT>(entry.second.size());
+        }
+        report.texturePoolHits = m_texturePoolHits;
+        report.texturePoolMisses = m_texturePoolMisses;
+
+        report.uploadRingSize = m_uploadRingSize;
+        report.uploadRingUsed = m_uploadRingUsed;
+        report.retiredCount = m_retiredResources.size();
+        report.budget = m_videoMemoryBudget;
+    }
+    report.uploadRingOverflows = m_uploadRingOverflows;
+
+    DXGI_QUERY_VIDEO_MEMORY_INFO info = {};
+    if (m_adapter && SUCCEEDED(m_adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL, &info))) {
+        report.nonLocalBudgetBytes = info.Budget;
+        report.nonLocalUsageBytes = info.CurrentUsage;
+    }
+    return report;
 }
 
 // --- Cache Management ---
 
 void ResourceManager::ClearCache() {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
     // Clear tracking maps - does NOT release the actual ID3D12Resource objects
-    m_resourceUsage.clear();
-    m_resourceStates.clear();
+    for (UINT i = 0; i < m_slotCount; i++) {
+        TrackedResource* slot = GetSlot(i);
+        if (slot->resource) {
+            ReleaseSlot(*slot);
+        }
+    }
+    m_pendingBarriers.clear();
+    m_openSplitBarriers.clear();
     m_namedResources.clear();
-    m_memoryUsageByType.clear();
+    for (auto& bytes : m_memoryUsageByType) {
+        bytes = 0;
+    }
+    m_committedResourceBytes = 0;
 
     // Reset descriptor pools allocation status (doesn't delete heaps)
     for (auto& pair : m_descriptorPools) {
-        auto& pool = pair.second;
-        std::fill(pool.allocated.begin(), pool.allocated.end(), false);
-        pool.size = 0;
+        ResetDescriptorPool(pair.second);
     }
-    OutputDebugStringA("ResourceManager cache cleared.\n");
+    LOG_INFO("ResourceManager cache cleared");
 }
 
 void ResourceManager::SetCacheLimit(size_t maxMemorySizeBytes) {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
     m_maxCacheSize = maxMemorySizeBytes;
     // Optional: Immediately trigger ReleaseUnusedResources if over limit
     // ReleaseUnusedResources(...)
@@ -852,11 +1925,10 @@ void ResourceManager::SetCacheLimit(size_t maxMemorySizeBytes) {
 
 std::string ResourceManager::GetResourceID(ID3D12Resource* resource) const {
     if (!resource) return "";
-    std::lock_guard<std::mutex> lock(m_mutex);
-    for (const auto& pair : m_namedResources) {
-        if (pair.second == resource) {
-            return pair.first;
-        }
+    std::lock_guard<ProfiledMutex> lock(m_mutex);
+    TrackedResource* slot = FindSlot(resource);
+    if (slot && !slot->name.empty()) {
+        return slot->name;
     }
     // Fallback to pointer string if not found by name
     return PtrToID(resource);
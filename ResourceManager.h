@@ -5,6 +5,7 @@
 
 #include <Windows.h>
 #include <d3d12.h>
+#include <dxgi1_4.h>
 #include <wrl/client.h>
 #include <map>
 #include <vector>
@@ -14,6 +15,11 @@
 #include <functional>
 #include <chrono>
 #include <unordered_map>
+#include <deque>
+#include <atomic>
+#include <cstdint>
+#include "PlacedHeapAllocator.h"
+#include "CpuProfiler.h"
 
 // Forward declarations
 class RenderSystem;
@@ -29,22 +35,23 @@ enum class ResourceType {
     RenderTarget,
     DepthStencil,
     Shader,         // Consider if needed, or manage via PipelineStateManager
-    Other
+    Other,
+    Count
 };
 
 // Resource state tracking for DirectX 12
 struct ResourceState {
-    D3D12_RESOURCE_STATES currentState = D3D12_RESOURCE_STATE_COMMON;
-    // Removed isTransitioning, less reliable than external sync
+    D3D12_RESOURCE_STATES currentState = D3D12_RESOURCE_STATE_COMMON; // All subresources while uniform
+    std::vector<D3D12_RESOURCE_STATES> subresourceStates; // Per subresource once they diverge
+    // BEGIN_ONLY recorded, END_ONLY still to come (from splitBeforeState to currentState)
+    bool splitPending = false;
+    D3D12_RESOURCE_STATES splitBeforeState = D3D12_RESOURCE_STATE_COMMON;
 };
 
-// Resource usage tracking
-struct ResourceUsage {
-    std::chrono::steady_clock::time_point lastUsed;
-    size_t size = 0;
-    bool isPinned = false;
-    ResourceType type = ResourceType::Other; // Store type for stats
-    // State is now tracked separately by pointer
+// Tracking slot of a resource, stored on the resource itself as private data
+struct ResourceHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0; // Stale once the slot is released (and possibly reused)
 };
 
 // DirectX 12 resource descriptor handle info
@@ -55,6 +62,16 @@ struct ResourceDescriptor {
     D3D12_DESCRIPTOR_HEAP_TYPE type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV; // Default assumption
 };
 
+// Sub-allocation of the per-frame upload ring (ResourceManager::AllocateUpload)
+struct UploadAllocation {
+    void* cpuAddress = nullptr;                // Write-combined; write only
+    D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = 0;  // e.g. for root CBVs
+    ID3D12Resource* buffer = nullptr;          // Source for CopyBufferRegion / CopyTextureRegion
+    UINT64 offset = 0;                         // Into buffer
+    UINT64 size = 0;
+    bool temporary = false;                    // One-off buffer: the ring was full
+};
+
 // Resource manager for efficient resource pooling and reuse
 class ResourceManager {
 public:
@@ -68,13 +85,35 @@ public:
     ResourceManager& operator=(ResourceManager&&) = delete;
 
     // --- Texture Resource Management ---
+    // Textures and buffers up to half a heap page are placed in shared heaps (PlacedHeapAllocator);
+    // larger ones are committed. Placed render targets and depth buffers start out with undefined
+    // metadata: DiscardPlacedTargets initializes them, and RenderSystem::BeginFrame runs it before
+    // any pass, so first use is a frame after creation unless the creator runs it itself.
     ComPtr<ID3D12Resource> CreateTexture2D(
         UINT width, UINT height,
         DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM,
         D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE,
         D3D12_HEAP_TYPE heapType = D3D12_HEAP_TYPE_DEFAULT,
         D3D12_RESOURCE_STATES initialState = D3D12_RESOURCE_STATE_COMMON,
-        const D3D12_CLEAR_VALUE* optimizedClearValue = nullptr); // Add clear value option
+        const D3D12_CLEAR_VALUE* optimizedClearValue = nullptr, // Add clear value option
+        UINT16 mipLevels = 1);
+
+    // --- Texture Pool ---
+    // Like CreateTexture2D, but returns a recycled texture of the same size, format, flags, heap type
+    // and state once the GPU has finished the frame it was recycled in. Contents are undefined.
+    ComPtr<ID3D12Resource> AcquireTexture2D(
+        UINT width, UINT height,
+        DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM,
+        D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE,
+        D3D12_HEAP_TYPE heapType = D3D12_HEAP_TYPE_DEFAULT,
+        D3D12_RESOURCE_STATES initialState = D3D12_RESOURCE_STATE_COMMON,
+        const D3D12_CLEAR_VALUE* optimizedClearValue = nullptr,
+        UINT16 mipLevels = 1);
+    // Instead of RetireResource for pooled sizes; state is the state the texture is left in.
+    // Views on it must be freed separately (RetireResource(nullptr, onRelease)).
+    void RecycleTexture(ComPtr<ID3D12Resource> texture, D3D12_RESOURCE_STATES state);
+    void SetTexturePoolLimit(size_t maxBytes); // Oldest pooled textures are released beyond this
+    size_t GetTexturePoolMemoryUsage() const;
 
     // --- Buffer Resource Management ---
 
@@ -89,6 +128,7 @@ public:
 
     // Helper to update a buffer (typically Default/Custom heap) using an intermediate upload buffer.
     // Returns the required upload buffer (caller should manage its lifetime or use a temp one).
+    // Per-frame updates should use the upload ring overload below instead.
     void UpdateBuffer(
         ID3D12GraphicsCommandList* commandList,
         ID3D12Resource* destinationBuffer,
@@ -98,9 +138,39 @@ public:
         UINT64 destinationOffset = 0,
         D3D12_RESOURCE_STATES stateAfterCopy = D3D12_RESOURCE_STATE_COMMON); // State after copy is done
 
+    // --- Upload Ring ---
+    // Persistently mapped upload memory for per-frame data (constants, buffer and texture updates):
+    // bumped from a ring sized for the frames in flight and reclaimed by frame fence, so dynamic
+    // data needs no allocation or Map. Valid until the end of the current frame's GPU work.
+    // Requests that don't fit get a one-off buffer retired with the frame.
+    UploadAllocation AllocateUpload(UINT64 size, UINT64 alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+    // Copies data through the ring and records the copy on commandList
+    void UpdateBuffer(
+        ID3D12GraphicsCommandList* commandList,
+        ID3D12Resource* destinationBuffer,
+        const void* data,
+        UINT64 dataSize,
+        UINT64 destinationOffset = 0,
+        D3D12_RESOURCE_STATES stateAfterCopy = D3D12_RESOURCE_STATE_COMMON);
+    // Uploads width x height pixels (rows srcRowPitch bytes apart) to (destX, destY) of mip 0
+    void UpdateTexture(
+        ID3D12GraphicsCommandList* commandList,
+        ID3D12Resource* destinationTexture,
+        const void* data,
+        UINT64 srcRowPitch,
+        UINT width, UINT height,
+        UINT destX = 0, UINT destY = 0,
+        D3D12_RESOURCE_STATES stateAfterCopy = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    void SetUploadRingSize(UINT64 sizeInBytes); // Takes effect once the current ring drains
+    // Doubles the ring (up to MAX_UPLOAD_RING_SIZE) for callers whose requests overflowed it; the
+    // ring only grows this way, so a burst (a big panel opening) doesn't reallocate it again later
+    void GrowUploadRing();
+    static constexpr UINT64 MAX_UPLOAD_RING_SIZE = 256 * 1024 * 1024;
+
     // Specialized buffer creation
     ComPtr<ID3D12Resource> CreateUploadBuffer(UINT64 size);
-    ComPtr<ID3D12Resource> CreateConstantBuffer(UINT size); // Uses Upload heap internally
+    ComPtr<ID3D12Resource> CreateReadbackBuffer(UINT64 size); // GPU to CPU copies, mapped once the fence passes
+    ComPtr<ID3D12Resource> CreateConstantBuffer(UINT size); // Uses Upload heap internally; per-frame constants: AllocateUpload
 
     // --- View Creation ---
     ResourceDescriptor CreateShaderResourceView(
@@ -130,11 +200,28 @@ public:
                                 D3D12_RESOURCE_STATES initialState = D3D12_RESOURCE_STATE_COMMON);
     void ReleaseResource(const std::string& id); // Releases tracking, caller manages actual release
     void ReleaseResource(ID3D12Resource* resource); // Finds and releases tracking
-    void ReleaseUnusedResources(std::chrono::seconds maxAge = std::chrono::seconds(60));
+    void ReleaseUnusedResources(std::chrono::seconds maxAge = std::chrono::seconds(60)); // Also trims the texture pool
+    // For a hidden overlay: empties the texture pool and evicts every committed, unpinned resource idle
+    // for TRIM_IDLE_SECONDS. Nothing is destroyed; NotifyResourceUsed pages resources back in on first
+    // use, so anything not pinned must report every use, however rare.
+    void TrimMemory();
+
+    // --- Deferred Destruction ---
+    // Keeps the object alive until the GPU passes the current frame's fence, then releases it and
+    // runs onRelease (e.g. to free its descriptors). Replaces WaitForGpu-before-release.
+    // Any COM object recorded into a command list qualifies: resources, heaps, pipeline states,
+    // root signatures, query heaps. Copy-queue work is covered too, since the graphics queue waits
+    // for it before the frame's fence is signaled.
+    void RetireResource(ComPtr<IUnknown> object, std::function<void()> onRelease = nullptr);
+    void ProcessRetiredResources(UINT64 completedFenceValue); // Called once per frame
+    void FlushRetiredResources(); // Caller guarantees the GPU is idle
+    size_t GetRetiredResourceCount() const; // Objects still waiting for their fence
 
     // --- Resource State Management ---
     D3D12_RESOURCE_STATES GetResourceState(ID3D12Resource* resource) const;
     void SetResourceState(ID3D12Resource* resource, D3D12_RESOURCE_STATES state); // Use with caution
+    bool IsResourceStateTracked(ID3D12Resource* resource) const;
+    // Queues and flushes at once, for one-off transitions
     void TransitionResource(ID3D12GraphicsCommandList* commandList, ID3D12Resource* resource,
                             D3D12_RESOURCE_STATES newState);
     void TransitionResources(ID3D12GraphicsCommandList* commandList,
@@ -146,22 +233,102 @@ public:
                                                     UINT subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
 
 
+    // --- Barrier Batching (graphics command list, render thread) ---
+    // Transitions are queued per subresource and merged until FlushBarriers records them in one
+    // ResourceBarrier call: no-ops are dropped, A->B then B->C becomes A->C and A->B->A cancels out.
+    // Flush before the copy, clear or draw that needs the new states.
+    void QueueTransition(ID3D12Resource* resource, D3D12_RESOURCE_STATES newState,
+                         UINT subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+    void FlushBarriers(ID3D12GraphicsCommandList* commandList);
+    // Split barrier: begin right after the last write, end before the first read, so the GPU can
+    // do the transition while other work runs. A later QueueTransition of the resource ends it too.
+    void BeginSplitTransition(ID3D12Resource* resource, D3D12_RESOURCE_STATES newState);
+    void EndSplitTransitions(); // Queues the END_ONLY half of every open split barrier
+    // Placed resources sharing heap memory: after becomes the active one (before may be null: any).
+    // Queue it ahead of after's transitions; they are recorded in the order queued.
+    void QueueAliasingBarrier(ID3D12Resource* before, ID3D12Resource* after);
+    size_t GetPendingBarrierCount() const;
+    // DiscardResource on every render target and depth buffer placed since the last call, each
+    // transitioned to its writable state and back around it (graphics command list, render thread)
+    void DiscardPlacedTargets(ID3D12GraphicsCommandList* commandList);
+
+    // --- Video Memory Budget ---
+    // The OS gives each process a local video memory budget that shrinks when the game needs more.
+    // Once the overlay is over it, pooled textures are dropped and committed resources idle for
+    // EVICT_IDLE_SECONDS are evicted, so the game's textures aren't demoted to system memory.
+    struct VideoMemoryBudget {
+        UINT64 budgetBytes = 0;
+        UINT64 usageBytes = 0; // This process
+        bool overBudget = false;
+        UINT evictedCount = 0;
+    };
+    void UpdateVideoMemoryBudget(); // Once per frame; queries on budget change notifications
+    VideoMemoryBudget GetVideoMemoryBudget() const;
+
     // --- Resource Usage & Pooling ---
+    // Marks the resource as in use this frame; makes it resident again if it was evicted.
+    // Call before recording commands that use a resource which may have been idle.
+    // Lock-free (a frame stamp store) unless the resource has to be made resident.
     void NotifyResourceUsed(ID3D12Resource* resource);
     void PinResource(ID3D12Resource* resource, bool pin);
     bool IsPinned(ID3D12Resource* resource) const;
 
     // --- Descriptor Management ---
-    // Consider a more robust DescriptorHeap class if complexity grows
+    // Persistent descriptors come from a two-level free bitmap: allocation and free are O(1)
+    // bit scans however full the heap is.
     ResourceDescriptor AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE type);
     void FreeDescriptor(const ResourceDescriptor& descriptor);
+    // Transient descriptors live for one frame: count contiguous slots bumped from a ring at the
+    // end of the heap, reclaimed once the GPU passes the frame's fence (ProcessRetiredResources).
+    // Never freed individually. Returns the first slot; the rest follow at GetDescriptorSize steps.
+    ResourceDescriptor AllocateTransientDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE type, UINT count = 1);
+    UINT GetAllocatedDescriptorCount(D3D12_DESCRIPTOR_HEAP_TYPE type) const;
+    // The CBV/SRV/UAV and sampler pools are the only shader-visible heaps (RenderSystem binds
+    // them once per frame); everything sampled by shaders, ImGui included, allocates from them.
+    ID3D12DescriptorHeap* GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE type) const;
+    ResourceDescriptor GetDescriptorFromCpuHandle(D3D12_DESCRIPTOR_HEAP_TYPE type, D3D12_CPU_DESCRIPTOR_HANDLE handle) const;
     D3D12_CPU_DESCRIPTOR_HANDLE GetCpuDescriptorHandle(const ResourceDescriptor& descriptor) const;
     D3D12_GPU_DESCRIPTOR_HANDLE GetGpuDescriptorHandle(const ResourceDescriptor& descriptor) const;
     UINT GetDescriptorSize(D3D12_DESCRIPTOR_HEAP_TYPE type) const;
 
     // --- Memory Statistics ---
-    size_t GetTotalMemoryUsage() const;
+    // Lock-free. Bytes used by tracked resources; committedBytes also receives what that costs in video memory
+    // (placed heap pages, which include free blocks, plus committed resources)
+    size_t GetTotalMemoryUsage(size_t* committedBytes = nullptr) const;
+    PlacedHeapAllocator::Stats GetPlacedHeapStats() const { return m_placedAllocator->GetStats(); }
     size_t GetMemoryUsageByType(ResourceType type) const;
+    static const char* GetResourceTypeName(ResourceType type);
+
+    // --- Memory Report ---
+    // Snapshot of where the overlay's video memory goes, for the performance page
+    struct MemoryReport {
+        size_t bytesByType[static_cast<int>(ResourceType::Count)] = {};
+        UINT countByType[static_cast<int>(ResourceType::Count)] = {};
+        size_t trackedBytes = 0;
+        size_t committedBytes = 0; // Committed resources plus placed heap pages (free blocks included)
+        PlacedHeapAllocator::Stats placedHeaps;
+        struct DescriptorHeapFill {
+            D3D12_DESCRIPTOR_HEAP_TYPE type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+            UINT used = 0;
+            UINT capacity = 0;
+            UINT transientUsed = 0;
+            UINT transientCapacity = 0;
+        };
+        std::vector<DescriptorHeapFill> descriptorHeaps;
+        size_t texturePoolBytes = 0;
+        size_t texturePoolLimit = 0;
+        UINT texturePoolCount = 0;
+        UINT64 texturePoolHits = 0;   // AcquireTexture2D served from the pool
+        UINT64 texturePoolMisses = 0; // ... or allocated
+        UINT64 uploadRingSize = 0;
+        UINT64 uploadRingUsed = 0;
+        UINT64 uploadRingOverflows = 0; // Requests served by a one-off buffer
+        size_t retiredCount = 0;
+        VideoMemoryBudget budget;  // Local segment, as of the last UpdateVideoMemoryBudget
+        UINT64 nonLocalBudgetBytes = 0; // System memory the GPU can use; queried for the report
+        UINT64 nonLocalUsageBytes = 0;
+    };
+    MemoryReport GetMemoryReport() const;
 
     // --- Cache Management ---
     void ClearCache(); // Clears internal tracking, doesn't release resources directly
@@ -170,23 +337,69 @@ public:
 private:
     // Internal tracking for resources created by the manager
     void TrackResourceInternal(ID3D12Resource* resource, ResourceType type, size_t size,
-                              D3D12_RESOURCE_STATES initialState);
-
-    // Resource usage tracking map (using pointer as key is faster for lookups)
-    std::unordered_map<ID3D12Resource*, ResourceUsage> m_resourceUsage;
-    // Resource state tracking map
-    std::unordered_map<ID3D12Resource*, ResourceState> m_resourceStates;
-    // Optional: Map string ID to resource pointer if needed for external access
-    std::unordered_map<std::string, ID3D12Resource*> m_namedResources;
+                              D3D12_RESOURCE_STATES initialState, bool isPlaced = false);
+    // Placed if it fits a heap page, committed otherwise; allocationSize receives the tracked size
+    ComPtr<ID3D12Resource> CreateResourceInternal(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc,
+                                                  D3D12_RESOURCE_STATES initialState,
+                                                  const D3D12_CLEAR_VALUE* optimizedClearValue,
+                                                  size_t& allocationSize, bool& isPlaced);
+
+    // Tracking slot map: usage, state and name of every tracked resource in fixed-size chunks that
+    // never move. A resource finds its slot through its ResourceHandle private data instead of a
+    // pointer-keyed map, so a recycled address can't alias a released resource. Slots are written
+    // under m_mutex except lastUsed/isEvicted, which NotifyResourceUsed reads and stamps without it.
+    struct TrackedResource {
+        std::atomic<uint32_t> generation{ 0 }; // Bumped on release
+        std::atomic<int64_t> lastUsed{ 0 };    // steady_clock ticks of the frame it was last used in
+        std::atomic<bool> isEvicted{ false };  // Made non-resident under budget pressure
+        ID3D12Resource* resource = nullptr;    // nullptr: free slot
+        uint32_t index = 0;
+        size_t size = 0;
+        ResourceType type = ResourceType::Other;
+        bool hasUsage = false; // False when only the state is tracked (RenderSystem's back buffers)
+        bool isPinned = false;
+        bool isPlaced = false; // Sub-allocated from a PlacedHeapAllocator page (counted in its heap bytes)
+        ResourceState state;
+        std::string name; // TrackExplicitResource id
+    };
+    static constexpr UINT SLOT_CHUNK_SIZE = 256;
+    static constexpr UINT MAX_SLOT_CHUNKS = 256; // 65536 tracked resources
+    std::atomic<TrackedResource*> m_slotChunks[MAX_SLOT_CHUNKS] = {};
+    UINT m_slotCount = 0; // High-water mark of slot indices
+    std::vector<UINT> m_freeSlots;
+    std::unordered_map<std::string, ID3D12Resource*> m_namedResources; // For ReleaseResource(id)
+    std::atomic<int64_t> m_frameTime{ 0 }; // Stamp NotifyResourceUsed writes, set once per frame
+
+    TrackedResource* GetSlot(uint32_t index) const;
+    TrackedResource* FindSlot(ID3D12Resource* resource) const; // nullptr if untracked; lock-free
+    TrackedResource* FindOrAddSlot(ID3D12Resource* resource); // Caller holds m_mutex
+    void ReleaseSlot(TrackedResource& slot); // Caller holds m_mutex; doesn't touch the resource
 
     // Total memory usage by type
-    std::map<ResourceType, size_t> m_memoryUsageByType;
+    std::atomic<size_t> m_memoryUsageByType[static_cast<int>(ResourceType::Count)] = {};
+    std::atomic<size_t> m_committedResourceBytes{ 0 }; // Tracked resources that are not placed
 
-    // Descriptor management (Simplified - consider dedicated class)
+    std::unique_ptr<PlacedHeapAllocator> m_placedAllocator;
+    std::vector<ComPtr<ID3D12Resource>> m_undiscardedTargets; // m_mutex; placed RT/DS awaiting DiscardPlacedTargets
+
+    // Descriptor management
     struct DescriptorPool {
-        std::vector<bool> allocated; // Simple allocation tracking
+        // Persistent slots [0, capacity): bit set = free; summary bit w set = freeBits[w] has a free slot
+        std::vector<uint64_t> freeBits;
+        std::vector<uint64_t> summaryBits;
         UINT capacity = 0;
         UINT size = 0; // Number currently allocated
+        // Transient ring [capacity, capacity + transientCapacity); live slots are the transientUsed
+        // offsets before transientHead, one span per frame fence (oldest first)
+        struct TransientSpan {
+            UINT64 fenceValue = 0;
+            UINT count = 0; // Including slots skipped to keep a range contiguous
+        };
+        UINT transientCapacity = 0;
+        UINT transientHead = 0; // Next ring offset to hand out
+        UINT transientUsed = 0;
+        std::deque<TransientSpan> transientSpans;
+        bool shaderVisible = false;
         D3D12_DESCRIPTOR_HEAP_TYPE type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
         UINT descriptorSize = 0;
         ComPtr<ID3D12DescriptorHeap> heap; // Store heap pointer
@@ -194,14 +407,98 @@ private:
         D3D12_GPU_DESCRIPTOR_HANDLE gpuStart = {};
     };
     std::map<D3D12_DESCRIPTOR_HEAP_TYPE, DescriptorPool> m_descriptorPools;
-    void InitializeDescriptorPool(D3D12_DESCRIPTOR_HEAP_TYPE type, UINT capacity, bool shaderVisible);
+    void InitializeDescriptorPool(D3D12_DESCRIPTOR_HEAP_TYPE type, UINT capacity, bool shaderVisible,
+                                  UINT transientCapacity = 0);
+    static void ResetDescriptorPool(DescriptorPool& pool);
+    static void ReclaimTransientDescriptors(DescriptorPool& pool, UINT64 completedFenceValue);
+    static ResourceDescriptor MakeDescriptor(const DescriptorPool& pool, UINT index);
+
 
+    // Upload ring, live bytes are the ringUsed bytes before ringHead (one span per frame fence)
+    struct UploadSpan {
+        UINT64 fenceValue = 0;
+        UINT64 size = 0; // Including alignment padding and skipped tail
+    };
+    ComPtr<ID3D12Resource> m_uploadRing;
+    uint8_t* m_uploadRingCpu = nullptr;
+    UINT64 m_uploadRingSize = 0;
+    UINT64 m_uploadRingRequestedSize = 8 * 1024 * 1024;
+    UINT64 m_uploadRingHead = 0;
+    UINT64 m_uploadRingUsed = 0;
+    std::deque<UploadSpan> m_uploadSpans;
+    std::atomic<UINT64> m_uploadRingOverflows{ 0 };
+    bool CreateUploadRing(UINT64 sizeInBytes); // Caller holds m_mutex
+    static UINT GetBytesPerPixel(DXGI_FORMAT format);
+
+    // Recycled textures (AcquireTexture2D / RecycleTexture)
+    struct TexturePoolKey {
+        UINT64 width = 0;
+        UINT height = 0;
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+        D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE;
+        D3D12_HEAP_TYPE heapType = D3D12_HEAP_TYPE_DEFAULT;
+        UINT16 mipLevels = 1;
+        bool operator==(const TexturePoolKey& other) const {
+            return width == other.width && height == other.height && format == other.format &&
+                flags == other.flags && heapType == other.heapType && mipLevels == other.mipLevels;
+        }
+    };
+    struct TexturePoolKeyHash {
+        size_t operator()(const TexturePoolKey& key) const;
+    };
+    struct PooledTexture {
+        ComPtr<ID3D12Resource> texture;
+        D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_COMMON;
+        UINT64 fenceValue = 0; // Reusable once the GPU completes this
+        std::chrono::steady_clock::time_point recycledTime;
+        size_t size = 0;
+        bool isPlaced = false;
+    };
+    std::unordered_map<TexturePoolKey, std::vector<PooledTexture>, TexturePoolKeyHash> m_texturePool;
+    size_t m_texturePoolBytes = 0;
+    size_t m_texturePoolLimit = 128 * 1024 * 1024;
+    UINT64 m_texturePoolHits = 0;
+    UINT64 m_texturePoolMisses = 0;
+    UINT64 m_completedFenceValue = 0; // As of the last ProcessRetiredResources
+    // Caller holds m_mutex; moves pooled textures to the retire queue, oldest first, until under
+    // limitBytes, plus every texture idle longer than a non-zero maxAge
+    void TrimTexturePool(size_t limitBytes, std::chrono::seconds maxAge = std::chrono::seconds::zero());
+
+    // Video memory budget (adapter from RenderSystem; notifications need IDXGIAdapter3)
+    static constexpr int EVICT_IDLE_SECONDS = 2;
+    static constexpr int TRIM_IDLE_SECONDS = 1;
+    static constexpr int BUDGET_POLL_MS = 1000; // Own allocations don't raise notifications
+    ComPtr<IDXGIAdapter3> m_adapter;
+    HANDLE m_budgetChangedEvent = nullptr;
+    DWORD m_budgetNotificationCookie = 0;
+    std::chrono::steady_clock::time_point m_lastBudgetQuery;
+    VideoMemoryBudget m_videoMemoryBudget;
+
+    // Barrier batching (caller holds m_mutex)
+    void QueueTransitionLocked(ID3D12Resource* resource, ResourceState& state,
+                               D3D12_RESOURCE_STATES newState, UINT subresource);
+    void QueueBarrierLocked(ID3D12Resource* resource, UINT subresource,
+                            D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after);
+    void EndSplitTransitionLocked(ID3D12Resource* resource, ResourceState& state);
+    std::vector<D3D12_RESOURCE_BARRIER> m_pendingBarriers;
+    std::vector<ID3D12Resource*> m_openSplitBarriers;
+    void RelieveBudgetPressure(UINT64 excessBytes); // Caller holds m_mutex
+    // Caller holds m_mutex; longest idle first until targetBytes are evicted
+    void EvictIdleResources(UINT64 targetBytes, std::chrono::seconds minIdle);
+
+    // Objects waiting for the GPU to pass their fence value (in fence order)
+    struct RetiredResource {
+        ComPtr<IUnknown> object;
+        std::function<void()> onRelease;
+        UINT64 fenceValue = 0;
+    };
+    std::deque<RetiredResource> m_retiredResources;
 
     // Configuration
     size_t m_maxCacheSize = 256 * 1024 * 1024; // 256 MB default limit for auto-release
 
     // Thread safety
-    mutable std::mutex m_mutex;
+    mutable PROFILE_MUTEX(m_mutex, "ResourceManager");
 
     // Resource pointer (not owned)
     RenderSystem* m_renderSystem = nullptr;
@@ -0,0 +1,330 @@
+// GameOverlay - SettingsDatabase.cpp
+// Versioned binary settings and profile database, memory-mapped at startup and read in place
+
+#include "SettingsDatabase.h"
+#include "SettingsStore.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+SettingsDatabase& SettingsDatabase::Get() {
+    static SettingsDatabase database;
+    return database;
+}
+
+SettingsDatabase::SettingsDatabase() {
+    SettingsStore::Get(); // Constructed first, so it is destroyed after the final Save below
+    Open(GetDefaultPath());
+}
+
+SettingsDatabase::~SettingsDatabase() {
+    Save();
+    Unmap();
+}
+
+std::string SettingsDatabase::GetDefaultPath() {
+    return SettingsStore::GetSettingsPath("Settings.bin");
+}
+
+bool SettingsDatabase::Open(const std::string& path) {
+    m_path = path;
+    if (path.empty()) return false;
+
+    // Shared for reading only: the writer replaces the file only after Detach unmapped it
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) return true; // Nothing saved yet
+
+    LARGE_INTEGER size = {};
+    if (!GetFileSizeEx(m_file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(FileHeader)) ||
+        size.QuadPart > 64ll * 1024 * 1024) {
+        Unmap();
+        return false;
+    }
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    m_view = m_mapping ? static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+    if (!m_view) {
+        Unmap();
+        return false;
+    }
+
+    // Validate the whole layout once so lookups never check bounds
+    const FileHeader* header = reinterpret_cast<const FileHeader*>(m_view);
+    uint64_t tableBytes = static_cast<uint64_t>(header->entryCount) * sizeof(FileEntry);
+    bool valid = header->magic == FILE_MAGIC && header->version == FILE_VERSION &&
+        sizeof(FileHeader) + tableBytes + header->dataBytes == static_cast<uint64_t>(size.QuadPart) &&
+        header->checksum == Checksum(m_view + sizeof(FileHeader), static_cast<size_t>(size.QuadPart) - sizeof(FileHeader));
+    if (valid) {
+        m_entries = reinterpret_cast<const FileEntry*>(m_view + sizeof(FileHeader));
+        m_entryCount = header->entryCount;
+        m_data = reinterpret_cast<const char*>(m_entries + m_entryCount);
+        for (uint32_t i = 0; i < m_entryCount && valid; i++) {
+            const FileEntry& entry = m_entries[i];
+            valid = entry.type <= static_cast<uint8_t>(Type::String) &&
+                static_cast<uint64_t>(entry.keyOffset) + entry.keyLength <= header->dataBytes &&
+                (entry.type != static_cast<uint8_t>(Type::String) ||
+                    static_cast<uint64_t>(entry.text.offset) + entry.text.length <= header->dataBytes) &&
+                (i == 0 || EntryKey(m_entries[i - 1]) < EntryKey(entry));
+        }
+    }
+    if (!valid) {
+        OutputDebugStringA("Warning: Ignoring settings file of another version or damaged; defaults apply.\n");
+        Unmap();
+        return false;
+    }
+    return true;
+}
+
+void SettingsDatabase::Unmap() {
+    if (m_view) UnmapViewOfFile(m_view);
+    if (m_mapping) CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+    m_view = nullptr;
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+    m_entries = nullptr;
+    m_entryCount = 0;
+    m_data = nullptr;
+}
+
+void SettingsDatabase::Detach() {
+    if (m_detached) return;
+    for (uint32_t i = 0; i < m_entryCount; i++) {
+        const FileEntry& entry = m_entries[i];
+        Value value;
+        value.type = static_cast<Type>(entry.type);
+        switch (value.type) {
+        case Type::Bool:
+        case Type::Int: value.integer = entry.integer; break;
+        case Type::Float: value.number = entry.number; break;
+        case Type::String: value.text.assign(m_data + entry.text.offset, entry.text.length); break;
+        }
+        m_values.emplace_hint(m_values.end(), std::string(EntryKey(entry)), std::move(value));
+    }
+    Unmap();
+    m_detached = true;
+}
+
+std::string_view SettingsDatabase::EntryKey(const FileEntry& entry) const {
+    return std::string_view(m_data + entry.keyOffset, entry.keyLength);
+}
+
+const SettingsDatabase::FileEntry* SettingsDatabase::FindEntry(std::string_view key) const {
+    const FileEntry* end = m_entries + m_entryCount;
+    const FileEntry* found = std::lower_bound(m_entries, end, key,
+        [this](const FileEntry& entry, std::string_view value) { return EntryKey(entry) < value; });
+    return found != end && EntryKey(*found) == key ? found : nullptr;
+}
+
+bool SettingsDatabase::Find(std::string_view key, Value& value) const {
+    if (m_detached) {
+        auto it = m_values.find(key);
+        if (it == m_values.end()) return false;
+        value.type = it->second.type;
+        value.integer = it->second.integer;
+        value.number = it->second.number;
+        return true;
+    }
+    const FileEntry* entry = m_entries ? FindEntry(key) : nullptr;
+    if (!entry) return false;
+    value.type = static_cast<Type>(entry->type);
+    value.integer = value.type == Type::Float ? 0 : entry->integer;
+    value.number = value.type == Type::Float ? entry->number : 0.0;
+    return true;
+}
+
+bool SettingsDatabase::Contains(std::string_view key) const {
+    Value value;
+    return Find(key, value);
+}
+
+bool SettingsDatabase::GetBool(std::string_view key, bool fallback) const {
+    Value value;
+    if (!Find(key, value) || value.type == Type::String) return fallback;
+    return value.type == Type::Float ? value.number != 0.0 : value.integer != 0;
+}
+
+int64_t SettingsDatabase::GetInt(std::string_view key, int64_t fallback) const {
+    Value value;
+    if (!Find(key, value) || value.type == Type::String) return fallback;
+    return value.type == Type::Float ? static_cast<int64_t>(value.number) : value.integer;
+}
+
+double SettingsDatabase::GetFloat(std::string_view key, double fallback) const {
+    Value value;
+    if (!Find(key, value) || value.type == Type::String) return fallback;
+    return value.type == Type::Float ? value.number : static_cast<double>(value.integer);
+}
+
+std::string_view SettingsDatabase::GetString(std::string_view key, std::string_view fallback) const {
+    if (m_detached) {
+        auto it = m_values.find(key);
+        return it != m_values.end() && it->second.type == Type::String ? std::string_view(it->second.text) : fallback;
+    }
+    const FileEntry* entry = m_entries ? FindEntry(key) : nullptr;
+    if (!entry || entry->type != static_cast<uint8_t>(Type::String)) return fallback;
+    return std::string_view(m_data + entry->text.offset, entry->text.length);
+}
+
+std::vector<std::string> SettingsDatabase::GetKeys(std::string_view prefix) const {
+    std::vector<std::string> keys;
+    if (m_detached) {
+        for (auto it = m_values.lower_bound(prefix); it != m_values.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+            keys.push_back(it->first);
+        }
+        return keys;
+    }
+    const FileEntry* end = m_entries + m_entryCount;
+    const FileEntry* entry = std::lower_bound(m_entries, end, prefix,
+        [this](const FileEntry& candidate, std::string_view value) { return EntryKey(candidate) < value; });
+    for (; entry != end && EntryKey(*entry).substr(0, prefix.size()) == prefix; ++entry) {
+        keys.emplace_back(EntryKey(*entry));
+    }
+    return keys;
+}
+
+void SettingsDatabase::Set(std::string_view key, Value value) {
+    if (key.empty() || key.size() > UINT16_MAX) return;
+    Detach();
+    auto it = m_values.find(key);
+    if (it != m_values.end()) {
+        const Value& old = it->second;
+        if (old.type == value.type && old.integer == value.integer && old.number == value.number && old.text == value.text) {
+            return; // Unchanged: no write
+        }
+        it->second = std::move(value);
+    }
+    else {
+        m_values.emplace(std::string(key), std::move(value));
+    }
+    m_dirty = true;
+}
+
+void SettingsDatabase::SetBool(std::string_view key, bool value) {
+    Value stored;
+    stored.type = Type::Bool;
+    stored.integer = value ? 1 : 0;
+    Set(key, std::move(stored));
+}
+
+void SettingsDatabase::SetInt(std::string_view key, int64_t value) {
+    Value stored;
+    stored.type = Type::Int;
+    stored.integer = value;
+    Set(key, std::move(stored));
+}
+
+void SettingsDatabase::SetFloat(std::string_view key, double value) {
+    Value stored;
+    stored.type = Type::Float;
+    stored.number = value;
+    Set(key, std::move(stored));
+}
+
+void SettingsDatabase::SetString(std::string_view key, std::string_view value) {
+    Value stored;
+    stored.type = Type::String;
+    stored.text.assign(value);
+    Set(key, std::move(stored));
+}
+
+void SettingsDatabase::Remove(std::string_view key) {
+    if (!Contains(key)) return;
+    Detach();
+    m_values.erase(m_values.find(key));
+    m_dirty = true;
+}
+
+void SettingsDatabase::RemovePrefix(std::string_view prefix) {
+    if (GetKeys(prefix).empty()) return;
+    Detach();
+    auto first = m_values.lower_bound(prefix);
+    auto last = first;
+    while (last != m_values.end() && last->first.compare(0, prefix.size(), prefix) == 0) ++last;
+    m_values.erase(first, last);
+    m_dirty = true;
+}
+
+void SettingsDatabase::Save() {
+    if (!m_dirty) return;
+    SettingsStore::Get().Write(m_path, Serialize());
+    m_dirty = false;
+}
+
+std::string SettingsDatabase::Serialize() const {
+    // Keys first, then string values, so the data block reads like the table
+    std::vector<FileEntry> entries;
+    entries.reserve(m_values.size());
+    std::string data;
+    for (const auto& [key, value] : m_values) {
+        FileEntry entry = {};
+        entry.keyOffset = static_cast<uint32_t>(data.size());
+        entry.keyLength = static_cast<uint16_t>(key.size());
+        entry.type = static_cast<uint8_t>(value.type);
+        if (value.type == Type::Float) entry.number = value.number;
+        else if (value.type != Type::String) entry.integer = value.integer;
+        data += key;
+        entries.push_back(entry);
+    }
+    size_t index = 0;
+    for (const auto& [key, value] : m_values) {
+        if (value.type == Type::String) {
+            entries[index].text.offset = static_cast<uint32_t>(data.size());
+            entries[index].text.length = static_cast<uint32_t>(value.text.size());
+            data += value.text;
+        }
+        index++;
+    }
+
+    FileHeader header = {};
+    header.magic = FILE_MAGIC;
+    header.version = FILE_VERSION;
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    header.dataBytes = static_cast<uint32_t>(data.size());
+
+    std::string file(sizeof(FileHeader) + entries.size() * sizeof(FileEntry) + data.size(), '\0');
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(file.data());
+    if (!entries.empty()) memcpy(bytes + sizeof(FileHeader), entries.data(), entries.size() * sizeof(FileEntry));
+    memcpy(bytes + sizeof(FileHeader) + entries.size() * sizeof(FileEntry), data.data(), data.size());
+    header.checksum = Checksum(bytes + sizeof(FileHeader), file.size() - sizeof(FileHeader));
+    memcpy(bytes, &header, sizeof(header));
+    return file;
+}
+
+std::string SettingsDatabase::ExportText() const {
+    std::string text = "; GameOverlay settings (exported from Settings.bin; not read back)\n";
+    char number[64];
+    for (const std::string& key : GetKeys(std::string_view())) {
+        text += key;
+        text += " = ";
+        Value value;
+        Find(key, value);
+        switch (value.type) {
+        case Type::Bool: text += value.integer ? "true" : "false"; break;
+        case Type::Int: text += std::to_string(value.integer); break;
+        case Type::Float:
+            snprintf(number, sizeof(number), "%g", value.number);
+            text += number;
+            break;
+        case Type::String:
+            text += '"';
+            for (char c : GetString(key)) {
+                if (c == '\n') text += "\\n";
+                else if (c == '"' || c == '\\') { text += '\\'; text += c; }
+                else text += c;
+            }
+            text += '"';
+            break;
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+uint32_t SettingsDatabase::Checksum(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
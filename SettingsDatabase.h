@@ -0,0 +1,133 @@
+// GameOverlay - SettingsDatabase.h
+// Versioned binary settings and profile database, memory-mapped at startup and read in place
+
+#pragma once
+
+#include <Windows.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+// Every persisted setting of the overlay lives in Settings.bin as one typed value under a dotted
+// key ("browser.homePage", "hotkeys.show_main", "profiles.game.exe.maxRenderScale"). The file is
+// a header, a table of entries sorted by key and a block of key and string bytes; Open maps it
+// and each Get is a binary search over the mapped table, so startup reads values in place without
+// parsing anything. A file of another version or with a bad checksum is ignored (the defaults
+// apply) rather than half-read.
+//
+// The first change decodes the file into memory and unmaps it: from then on reads and writes use
+// the decoded values, and Save serializes them and hands the bytes to SettingsStore, which needs
+// the file unmapped to move the new one over it. ExportText writes the same values as text for
+// people to read. Main thread only.
+class SettingsDatabase {
+public:
+    static constexpr uint32_t FILE_MAGIC = 0x54534F47; // "GOST"
+    static constexpr uint16_t FILE_VERSION = 1;
+
+    enum class Type : uint8_t { Bool, Int, Float, String };
+
+    // The database of this process, opened from GetDefaultPath on first use
+    static SettingsDatabase& Get();
+
+    // Disable copy and move
+    SettingsDatabase(const SettingsDatabase&) = delete;
+    SettingsDatabase& operator=(const SettingsDatabase&) = delete;
+    SettingsDatabase(SettingsDatabase&&) = delete;
+    SettingsDatabase& operator=(SettingsDatabase&&) = delete;
+
+    // --- Typed views ---
+    // The fallback when the key is missing or holds another type (Int and Float convert)
+    bool Contains(std::string_view key) const;
+    bool GetBool(std::string_view key, bool fallback) const;
+    int64_t GetInt(std::string_view key, int64_t fallback) const;
+    int GetInt(std::string_view key, int fallback) const { return static_cast<int>(GetInt(key, static_cast<int64_t>(fallback))); }
+    double GetFloat(std::string_view key, double fallback) const;
+    float GetFloat(std::string_view key, float fallback) const { return static_cast<float>(GetFloat(key, static_cast<double>(fallback))); }
+    // Valid until the next change
+    std::string_view GetString(std::string_view key, std::string_view fallback = std::string_view()) const;
+    // Keys starting with the prefix, sorted
+    std::vector<std::string> GetKeys(std::string_view prefix) const;
+
+    // --- Changes ---
+    void SetBool(std::string_view key, bool value);
+    void SetInt(std::string_view key, int64_t value);
+    void SetFloat(std::string_view key, double value);
+    void SetString(std::string_view key, std::string_view value);
+    void Remove(std::string_view key);
+    void RemovePrefix(std::string_view prefix);
+
+    // Queues a background write when anything changed (SettingsStore)
+    void Save();
+    // Every value as "key = value", one per line, sorted by key
+    std::string ExportText() const;
+
+    // %LOCALAPPDATA%\GameOverlay\Settings.bin; empty without a profile directory
+    static std::string GetDefaultPath();
+    const std::string& GetPath() const { return m_path; }
+    bool IsMapped() const { return m_view != nullptr; }
+
+private:
+#pragma pack(push, 1)
+    struct TextRange {
+        uint32_t offset; // Into the data block
+        uint32_t length;
+    };
+    struct FileHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t reserved;
+        uint32_t entryCount;
+        uint32_t dataBytes; // Key and string bytes after the entry table
+        uint32_t checksum;  // FNV-1a of everything after the header
+    };
+    struct FileEntry {
+        uint32_t keyOffset; // Into the data block
+        uint16_t keyLength;
+        uint8_t type;       // Type
+        uint8_t reserved;
+        union {
+            int64_t integer; // Bool and Int
+            double number;   // Float
+            TextRange text;  // String
+        };
+    };
+#pragma pack(pop)
+    static_assert(sizeof(FileEntry) == 16, "FileEntry is part of the file format");
+
+    struct Value {
+        Type type = Type::Int;
+        int64_t integer = 0;
+        double number = 0.0;
+        std::string text;
+    };
+
+    SettingsDatabase();
+    ~SettingsDatabase();
+
+    bool Open(const std::string& path);
+    void Unmap();
+    void Detach(); // Mapped entries into m_values; the file is unmapped
+    const FileEntry* FindEntry(std::string_view key) const;
+    std::string_view EntryKey(const FileEntry& entry) const;
+    bool Find(std::string_view key, Value& value) const; // Copy; strings only through GetString
+    void Set(std::string_view key, Value value);
+    std::string Serialize() const;
+    static uint32_t Checksum(const uint8_t* data, size_t size);
+
+    std::string m_path;
+
+    // Mapped file (until the first change)
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+    const uint8_t* m_view = nullptr;
+    const FileEntry* m_entries = nullptr;
+    uint32_t m_entryCount = 0;
+    const char* m_data = nullptr;
+
+    // Decoded values (after the first change)
+    bool m_detached = false;
+    std::map<std::string, Value, std::less<>> m_values;
+    bool m_dirty = false;
+};
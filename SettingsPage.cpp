@@ -4,16 +4,18 @@
 
 #include "SettingsPage.h"
 #include "UISystem.h"
+#include "ImGuiSystem.h"
 #include "GameOverlay.h"
+#include "SettingsDatabase.h"
+#include "SettingsStore.h"
 #include "imgui.h"
 #include <cstring>
+#include <cstdio>
+#include <algorithm>
 
 SettingsPage::SettingsPage(UISystem* uiSystem)
     : PageBase("Settings"), m_uiSystem(uiSystem) {
 
-    // Set home page buffer from default settings
-    strcpy_s(m_homePageBuffer, m_browserSettings.homePage.c_str());
-
     // Initialize custom colors with defaults
     m_appearanceSettings.customColors[0][0] = 0.2f; // Main R
     m_appearanceSettings.customColors[0][1] = 0.2f; // Main G
@@ -34,6 +36,29 @@ SettingsPage::SettingsPage(UISystem* uiSystem)
     m_appearanceSettings.customColors[3][1] = 0.1f; // Background G
     m_appearanceSettings.customColors[3][2] = 0.15f; // Background B
     m_appearanceSettings.customColors[3][3] = 0.95f; // Background A
+
+    // Saved settings replace the defaults
+    LoadSettings();
+
+    // Set home page buffer from default settings
+    strcpy_s(m_homePageBuffer, m_browserSettings.homePage.c_str());
+
+    // Cache and process settings come from the browser manager (what CEF actually started with)
+    BrowserManager* browserManager = (m_uiSystem && m_uiSystem->GetBrowserView()) ?
+        m_uiSystem->GetBrowserView()->GetBrowserManager() : nullptr;
+    std::string cachePath = browserManager ? browserManager->GetCachePath() : BrowserManager::GetDefaultCachePath();
+    if (browserManager) {
+        m_browserSettings.persistentCache = !cachePath.empty();
+        m_browserSettings.cacheSizeMB = static_cast<int>(browserManager->GetCacheSizeLimitMB());
+        m_browserSettings.clearCacheOnExit = browserManager->GetClearCacheOnExit();
+        m_browserSettings.throttleBackgroundTimers = browserManager->GetProcessModel().throttleBackgroundTimers;
+        BrowserManager::ProcessModelPreset processModel;
+        if (BrowserManager::FindProcessModelPreset(browserManager->GetProcessModel(), processModel)) {
+            m_browserSettings.processModelPreset = static_cast<int>(processModel);
+        }
+        m_browserSettings.blockAdsAndTrackers = browserManager->GetContentBlocker().IsEnabled();
+    }
+    strcpy_s(m_cachePathBuffer, cachePath.empty() ? BrowserManager::GetDefaultCachePath().c_str() : cachePath.c_str());
 }
 
 void SettingsPage::Render() {
@@ -83,6 +108,7 @@ void SettingsPage::Render() {
             case 2: ApplyAppearanceSettings(); break;
             case 3: ApplyHotkeySettings(); break;
             }
+            SaveSettings();
 
             m_settingsChanged = false;
         }
@@ -99,6 +125,7 @@ void SettingsPage::Render() {
             case 1:
                 m_browserSettings = BrowserSettings();
                 strcpy_s(m_homePageBuffer, m_browserSettings.homePage.c_str());
+                strcpy_s(m_cachePathBuffer, BrowserManager::GetDefaultCachePath().c_str());
                 break;
             case 2:
                 m_appearanceSettings = AppearanceSettings();
@@ -156,6 +183,57 @@ void SettingsPage::RenderBrowserSettings() {
     changed |= ImGui::Checkbox("Enable Cookies", &m_browserSettings.enableCookies);
     changed |= ImGui::Checkbox("Clear Cache on Exit", &m_browserSettings.clearCacheOnExit);
     changed |= ImGui::Checkbox("Clear History on Exit", &m_browserSettings.clearHistoryOnExit);
+    changed |= ImGui::Checkbox("Block Ads and Trackers", &m_browserSettings.blockAdsAndTrackers);
+    ImGui::SameLine(); ImGui::TextDisabled("(?)");
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Cancel requests to ad and tracker hosts. Add rules in filters.txt next to GameOverlay.exe.");
+    }
+    BrowserManager* browserManager = (m_uiSystem && m_uiSystem->GetBrowserView()) ?
+        m_uiSystem->GetBrowserView()->GetBrowserManager() : nullptr;
+    if (browserManager && browserManager->GetContentBlocker().GetRuleCount() > 0) {
+        const ContentBlocker& blocker = browserManager->GetContentBlocker();
+        ImGui::TextDisabled("%zu rules, %llu of %llu requests blocked (%.2f us per check)",
+            blocker.GetRuleCount(),
+            static_cast<unsigned long long>(blocker.GetBlockedCount()),
+            static_cast<unsigned long long>(blocker.GetCheckedCount()),
+            blocker.GetAverageCheckMicroseconds());
+    }
+
+    ImGui::Spacing();
+
+    // Disk cache
+    changed |= ImGui::Checkbox("Persistent Disk Cache", &m_browserSettings.persistentCache);
+    ImGui::SameLine(); ImGui::TextDisabled("(?)");
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Keep loaded pages on disk so repeat visits skip the network; off keeps everything in memory.\n"
+            "Applies the next time the browser starts.");
+    }
+    ImGui::BeginDisabled(!m_browserSettings.persistentCache);
+    ImGui::Text("Cache Folder");
+    ImGui::SetNextItemWidth(-1);
+    if (ImGui::InputText("##CachePath", m_cachePathBuffer, sizeof(m_cachePathBuffer))) {
+        changed = true;
+    }
+    ImGui::Text("Cache Size Limit (MB)");
+    ImGui::SetNextItemWidth(-1);
+    changed |= ImGui::SliderInt("##CacheSize", &m_browserSettings.cacheSizeMB, 32, 2048);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Least recently used entries are evicted once the cache reaches this size");
+    }
+    ImGui::EndDisabled();
+
+    ImGui::Spacing();
+
+    // Renderer processes
+    static const char* processModels[] = { "Default (process per site instance)", "Balanced (4 renderers)", "Minimal (1 renderer)" };
+    ImGui::Text("Process Model");
+    ImGui::SetNextItemWidth(-1);
+    changed |= ImGui::Combo("##ProcessModel", &m_browserSettings.processModelPreset, processModels, IM_ARRAYSIZE(processModels));
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Fewer renderer processes and smaller script heaps use less memory while a game runs.\n"
+            "With Minimal, one misbehaving page affects every tab. Applies the next time the browser starts.");
+    }
+    changed |= ImGui::Checkbox("Throttle Background Tab Timers", &m_browserSettings.throttleBackgroundTimers);
 
     ImGui::Spacing();
 
@@ -245,6 +323,33 @@ void SettingsPage::RenderAppearanceSettings() {
         }
     }
 
+    ImGui::Spacing();
+    ImGui::Separator();
+
+    // HUD widgets: clock, timers and stats drawn natively, so they don't need the browser
+    if (ImGui::Checkbox("Show HUD Widgets", &m_appearanceSettings.showHud)) {
+        changed = true;
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Clock, timers, frame rate and system stats drawn without a browser page");
+    }
+    if (m_uiSystem) {
+        HudLayer& hud = m_uiSystem->GetHudLayer();
+        const std::string path = HudLayer::GetLayoutPath();
+        ImGui::TextDisabled("Layout: %s (%zu widgets)", path.c_str(), hud.GetWidgets().size());
+        if (ImGui::Button("Reload Layout")) {
+            // A missing file leaves no widgets
+            ImGuiSystem::RunOnRenderThread("HUD Reload", [&hud, path]() { hud.Load(path); });
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Write Example Layout")) {
+            hud.WriteExampleLayout(path);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Replaces Hud.ini with a commented layout listing every widget and key");
+        }
+    }
+
     if (changed) {
         m_settingsChanged = true;
     }
@@ -376,6 +481,15 @@ void SettingsPage::RenderAboutSection() {
         ImGui::OpenPopup("LicensePopup");
     }
 
+    // Settings.bin is read in place at startup; a text copy for people to read or diff
+    ImGui::SameLine();
+    if (ImGui::Button("Export Settings As Text")) {
+        SettingsStore::Get().Write(SettingsStore::GetSettingsPath("Settings.txt"), SettingsDatabase::Get().ExportText());
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Writes every saved setting to Settings.txt next to Settings.bin.\nThe text copy is not read back.");
+    }
+
     // Update popup
     if (ImGui::BeginPopupModal("UpdatePopup", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
         ImGui::Text("Checking for updates...");
@@ -434,8 +548,7 @@ void SettingsPage::RenderAboutSection() {
 }
 
 void SettingsPage::ApplyGeneralSettings() {
-    // In a real implementation, this would save settings to config file
-    // and apply changes to the application
+    // In a real implementation, this would apply changes to the application
 
     // For now, just mark as applied
     m_settingsChanged = false;
@@ -445,6 +558,21 @@ void SettingsPage::ApplyBrowserSettings() {
     // Update home page from buffer
     m_browserSettings.homePage = m_homePageBuffer;
 
+    // Cache settings are read when CEF starts
+    BrowserManager* browserManager = (m_uiSystem && m_uiSystem->GetBrowserView()) ?
+        m_uiSystem->GetBrowserView()->GetBrowserManager() : nullptr;
+    if (browserManager) {
+        browserManager->SetCachePath(m_browserSettings.persistentCache ? std::string(m_cachePathBuffer) : std::string());
+        browserManager->SetCacheSizeLimitMB(static_cast<unsigned int>(std::max(m_browserSettings.cacheSizeMB, 0)));
+        browserManager->SetClearCacheOnExit(m_browserSettings.clearCacheOnExit);
+        browserManager->GetContentBlocker().SetEnabled(m_browserSettings.blockAdsAndTrackers);
+
+        BrowserManager::ProcessModelConfig processModel = BrowserManager::GetProcessModelPreset(
+            static_cast<BrowserManager::ProcessModelPreset>(std::clamp(m_browserSettings.processModelPreset, 0, 2)));
+        processModel.throttleBackgroundTimers = m_browserSettings.throttleBackgroundTimers;
+        browserManager->SetProcessModel(processModel);
+    }
+
     // In a real implementation, this would apply changes to the browser
 
     // For now, just mark as applied
@@ -463,6 +591,16 @@ void SettingsPage::ApplyAppearanceSettings() {
         }
 
         m_uiSystem->SetTheme(theme);
+
+        // The HUD is drawn by the render thread
+        HudLayer& hud = m_uiSystem->GetHudLayer();
+        const bool showHud = m_appearanceSettings.showHud;
+        ImGuiSystem::RunOnRenderThread("HUD Settings", [&hud, showHud]() {
+            hud.SetEnabled(showHud);
+            if (showHud && hud.GetWidgets().empty()) {
+                hud.Load(HudLayer::GetLayoutPath());
+            }
+        });
     }
 
     // In a real implementation, this would apply font size and custom colors
@@ -477,3 +615,100 @@ void SettingsPage::ApplyHotkeySettings() {
     // For now, just mark as applied
     m_settingsChanged = false;
 }
+
+void SettingsPage::LoadSettings() {
+    const SettingsDatabase& db = SettingsDatabase::Get();
+
+    m_generalSettings.startWithWindows = db.GetBool("general.startWithWindows", m_generalSettings.startWithWindows);
+    m_generalSettings.startMinimized = db.GetBool("general.startMinimized", m_generalSettings.startMinimized);
+    m_generalSettings.checkForUpdates = db.GetBool("general.checkForUpdates", m_generalSettings.checkForUpdates);
+    m_generalSettings.inactiveOpacity = std::clamp(db.GetInt("general.inactiveOpacity", m_generalSettings.inactiveOpacity), 0, 100);
+    m_generalSettings.autoHide = db.GetBool("general.autoHide", m_generalSettings.autoHide);
+    m_generalSettings.autoHideDelay = std::max(db.GetInt("general.autoHideDelay", m_generalSettings.autoHideDelay), 0);
+
+    BrowserSettings& browser = m_browserSettings;
+    browser.enableJavaScript = db.GetBool("browser.enableJavaScript", browser.enableJavaScript);
+    browser.enablePlugins = db.GetBool("browser.enablePlugins", browser.enablePlugins);
+    browser.enableCookies = db.GetBool("browser.enableCookies", browser.enableCookies);
+    browser.clearCacheOnExit = db.GetBool("browser.clearCacheOnExit", browser.clearCacheOnExit);
+    browser.clearHistoryOnExit = db.GetBool("browser.clearHistoryOnExit", browser.clearHistoryOnExit);
+    browser.persistentCache = db.GetBool("browser.persistentCache", browser.persistentCache);
+    browser.cacheSizeMB = std::max(db.GetInt("browser.cacheSizeMB", browser.cacheSizeMB), 0);
+    browser.processModelPreset = std::clamp(db.GetInt("browser.processModelPreset", browser.processModelPreset), 0, 2);
+    browser.throttleBackgroundTimers = db.GetBool("browser.throttleBackgroundTimers", browser.throttleBackgroundTimers);
+    browser.blockAdsAndTrackers = db.GetBool("browser.blockAdsAndTrackers", browser.blockAdsAndTrackers);
+    browser.homePage = std::string(db.GetString("browser.homePage", browser.homePage).substr(0, sizeof(m_homePageBuffer) - 1));
+    std::string searchEngine(db.GetString("browser.searchEngine", browser.searchEngine));
+    if (m_searchEngines.count(searchEngine)) browser.searchEngine = searchEngine;
+
+    AppearanceSettings& appearance = m_appearanceSettings;
+    appearance.theme = std::clamp(db.GetInt("appearance.theme", appearance.theme), 0, 2);
+    appearance.fontSize = std::clamp(db.GetFloat("appearance.fontSize", appearance.fontSize), 0.7f, 1.5f);
+    appearance.windowWidth = std::max(db.GetInt("appearance.windowWidth", appearance.windowWidth), 1);
+    appearance.windowHeight = std::max(db.GetInt("appearance.windowHeight", appearance.windowHeight), 1);
+    appearance.useCustomColors = db.GetBool("appearance.useCustomColors", appearance.useCustomColors);
+    appearance.showHud = db.GetBool("appearance.showHud", appearance.showHud);
+    char key[64];
+    for (int i = 0; i < 4; i++) {
+        for (int channel = 0; channel < 4; channel++) {
+            snprintf(key, sizeof(key), "appearance.customColor%d.%c", i, "rgba"[channel]);
+            appearance.customColors[i][channel] = std::clamp(db.GetFloat(key, appearance.customColors[i][channel]), 0.0f, 1.0f);
+        }
+    }
+
+    HotkeySettings& hotkeys = m_hotkeySettings;
+    hotkeys.toggleOverlay = std::string(db.GetString("hotkeyNames.toggleOverlay", hotkeys.toggleOverlay));
+    hotkeys.captureInput = std::string(db.GetString("hotkeyNames.captureInput", hotkeys.captureInput));
+    hotkeys.showBrowser = std::string(db.GetString("hotkeyNames.showBrowser", hotkeys.showBrowser));
+    hotkeys.showLinks = std::string(db.GetString("hotkeyNames.showLinks", hotkeys.showLinks));
+    hotkeys.showSettings = std::string(db.GetString("hotkeyNames.showSettings", hotkeys.showSettings));
+}
+
+void SettingsPage::SaveSettings() const {
+    SettingsDatabase& db = SettingsDatabase::Get();
+
+    db.SetBool("general.startWithWindows", m_generalSettings.startWithWindows);
+    db.SetBool("general.startMinimized", m_generalSettings.startMinimized);
+    db.SetBool("general.checkForUpdates", m_generalSettings.checkForUpdates);
+    db.SetInt("general.inactiveOpacity", m_generalSettings.inactiveOpacity);
+    db.SetBool("general.autoHide", m_generalSettings.autoHide);
+    db.SetInt("general.autoHideDelay", m_generalSettings.autoHideDelay);
+
+    const BrowserSettings& browser = m_browserSettings;
+    db.SetBool("browser.enableJavaScript", browser.enableJavaScript);
+    db.SetBool("browser.enablePlugins", browser.enablePlugins);
+    db.SetBool("browser.enableCookies", browser.enableCookies);
+    db.SetBool("browser.clearCacheOnExit", browser.clearCacheOnExit);
+    db.SetBool("browser.clearHistoryOnExit", browser.clearHistoryOnExit);
+    db.SetBool("browser.persistentCache", browser.persistentCache);
+    db.SetInt("browser.cacheSizeMB", browser.cacheSizeMB);
+    db.SetInt("browser.processModelPreset", browser.processModelPreset);
+    db.SetBool("browser.throttleBackgroundTimers", browser.throttleBackgroundTimers);
+    db.SetBool("browser.blockAdsAndTrackers", browser.blockAdsAndTrackers);
+    db.SetString("browser.homePage", browser.homePage);
+    db.SetString("browser.searchEngine", browser.searchEngine);
+
+    const AppearanceSettings& appearance = m_appearanceSettings;
+    db.SetInt("appearance.theme", appearance.theme);
+    db.SetFloat("appearance.fontSize", appearance.fontSize);
+    db.SetInt("appearance.windowWidth", appearance.windowWidth);
+    db.SetInt("appearance.windowHeight", appearance.windowHeight);
+    db.SetBool("appearance.useCustomColors", appearance.useCustomColors);
+    db.SetBool("appearance.showHud", appearance.showHud);
+    char key[64];
+    for (int i = 0; i < 4; i++) {
+        for (int channel = 0; channel < 4; channel++) {
+            snprintf(key, sizeof(key), "appearance.customColor%d.%c", i, "rgba"[channel]);
+            db.SetFloat(key, appearance.customColors[i][channel]);
+        }
+    }
+
+    const HotkeySettings& hotkeys = m_hotkeySettings;
+    db.SetString("hotkeyNames.toggleOverlay", hotkeys.toggleOverlay);
+    db.SetString("hotkeyNames.captureInput", hotkeys.captureInput);
+    db.SetString("hotkeyNames.showBrowser", hotkeys.showBrowser);
+    db.SetString("hotkeyNames.showLinks", hotkeys.showLinks);
+    db.SetString("hotkeyNames.showSettings", hotkeys.showSettings);
+
+    db.Save();
+}
@@ -19,6 +19,7 @@ public:
 
     // Render settings page content
     void Render() override;
+    float GetRefreshRate() const override { return 2.0f; } // Changes come from input
 
 private:
     // Render different settings sections
@@ -34,6 +35,10 @@ private:
     void ApplyAppearanceSettings();
     void ApplyHotkeySettings();
 
+    // All sections in the settings database (SettingsDatabase), saved after every apply
+    void LoadSettings();
+    void SaveSettings() const;
+
     // Settings data
     struct GeneralSettings {
         bool startWithWindows = false;
@@ -50,6 +55,11 @@ private:
         bool enableCookies = true;
         bool clearCacheOnExit = false;
         bool clearHistoryOnExit = false;
+        bool persistentCache = true;
+        int cacheSizeMB = 256;
+        int processModelPreset = 1; // BrowserManager::ProcessModelPreset; the active one once constructed
+        bool throttleBackgroundTimers = true;
+        bool blockAdsAndTrackers = true;
         std::string homePage = "https://www.google.com";
         std::string searchEngine = "Google";
     } m_browserSettings;
@@ -61,6 +71,7 @@ private:
         int windowHeight = 720;
         bool useCustomColors = false;
         float customColors[4][4] = {}; // Main, Accent, Text, Background
+        bool showHud = false;          // Native widgets from Hud.ini
     } m_appearanceSettings;
 
     struct HotkeySettings {
@@ -85,5 +96,6 @@ private:
     // UI state
     int m_currentSection = 0;
     char m_homePageBuffer[1024] = {};
+    char m_cachePathBuffer[260] = {}; // MAX_PATH
     bool m_settingsChanged = false;
 };
\ No newline at end of file
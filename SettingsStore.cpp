@@ -0,0 +1,144 @@
+// GameOverlay - SettingsStore.cpp
+// Debounced settings persistence: snapshots are written by a background thread, atomically
+
+#include "SettingsStore.h"
+#include "ThreadPolicy.h"
+#include "ThreadCycles.h"
+#include "FileUtil.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+SettingsStore& SettingsStore::Get() {
+    static SettingsStore store;
+    return store;
+}
+
+SettingsStore::SettingsStore() {
+    m_worker = std::thread(&SettingsStore::WorkerThread, this);
+}
+
+SettingsStore::~SettingsStore() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    if (m_worker.joinable()) {
+        m_worker.join(); // Writes everything still pending first
+    }
+}
+
+void SettingsStore::Write(const std::string& path, std::string contents) {
+    if (path.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Clock::time_point now = Clock::now();
+        auto [it, inserted] = m_pending.try_emplace(path);
+        if (inserted) {
+            it->second.firstChange = now;
+        }
+        else {
+            m_coalescedCount++;
+        }
+        it->second.contents = std::move(contents);
+        it->second.lastChange = now;
+    }
+    m_condition.notify_one();
+}
+
+bool SettingsStore::Read(const std::string& path, std::string& contents) {
+    if (path.empty()) return false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto pending = m_pending.find(path);
+        if (pending != m_pending.end()) {
+            contents = pending->second.contents;
+            return true;
+        }
+        auto writing = m_writing.find(path);
+        if (writing != m_writing.end()) {
+            contents = writing->second;
+            return true;
+        }
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+void SettingsStore::Flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_pending.empty() && m_writing.empty()) return;
+    m_flushRequested = true;
+    m_condition.notify_one();
+    m_idleCondition.wait(lock, [this]() { return m_pending.empty() && m_writing.empty(); });
+}
+
+std::string SettingsStore::GetSettingsPath(const char* fileName) {
+    std::string directory = GetAppDataDirectory();
+    if (directory.empty()) {
+        return std::string(); // No profile directory; settings last for the session only
+    }
+    return directory + "\\" + fileName;
+}
+
+void SettingsStore::WorkerThread() {
+    ConfigureWorkerThread();
+    ThreadCycles::RegisterThread(ThreadSubsystem::Storage);
+    // Background mode also lowers the thread's I/O priority, so writes queue behind the game's
+    SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        if (m_pending.empty()) {
+            m_flushRequested = false;
+            m_idleCondition.notify_all();
+            if (m_stopping) break;
+            m_condition.wait(lock, [this]() { return m_stopping || !m_pending.empty(); });
+            continue;
+        }
+
+        // Take every file that is due (all of them when flushing); sleep until the next otherwise
+        bool writeAll = m_stopping || m_flushRequested;
+        Clock::time_point now = Clock::now();
+        Clock::time_point nextDue = Clock::time_point::max();
+        for (auto it = m_pending.begin(); it != m_pending.end();) {
+            Clock::time_point due = std::min(it->second.lastChange + DEBOUNCE, it->second.firstChange + MAX_DELAY);
+            if (writeAll || due <= now) {
+                m_writing[it->first] = std::move(it->second.contents);
+                it = m_pending.erase(it);
+            }
+            else {
+                nextDue = std::min(nextDue, due);
+                ++it;
+            }
+        }
+        if (m_writing.empty()) {
+            // A Write wakes this early; the due times are simply recomputed
+            m_condition.wait_until(lock, nextDue);
+            continue;
+        }
+
+        // Only this thread changes m_writing, so it can be walked unlocked; Read sees it meanwhile
+        lock.unlock();
+        for (const auto& [path, contents] : m_writing) {
+            if (CommitFile(path, contents)) {
+                m_writeCount++;
+            }
+            else {
+                OutputDebugStringA(("Warning: Failed to write settings file: " + path + "\n").c_str());
+            }
+        }
+        lock.lock();
+        m_writing.clear();
+    }
+}
+
+bool SettingsStore::CommitFile(const std::string& path, const std::string& contents) {
+    return WriteFileAtomic(path, contents.data(), contents.size());
+}
@@ -0,0 +1,78 @@
+// GameOverlay - SettingsStore.h
+// Debounced settings persistence: snapshots are written by a background thread, atomically
+
+#pragma once
+
+#include <Windows.h>
+#include <string>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+
+// Settings owners (the settings pages, hotkeys, game profiles, ImGui's window layout) serialize
+// into a string and hand it to Write, which only swaps it into a per-file slot: the render thread
+// never touches the disk. A file is written DEBOUNCE after its last change, so dragging a slider
+// or moving a window costs one write at the end, and at most MAX_DELAY after its first unwritten
+// change so a steady stream of changes still lands. Each write goes to a temporary file moved
+// over the old one, so a crash leaves either the old or the new contents. Destruction (or Flush)
+// writes whatever is still pending.
+//
+// One store for the process (Get); Write and Read may be called from any thread.
+class SettingsStore {
+public:
+    static constexpr std::chrono::milliseconds DEBOUNCE{ 500 };
+    static constexpr std::chrono::milliseconds MAX_DELAY{ 2000 };
+
+    static SettingsStore& Get();
+
+    // Disable copy and move
+    SettingsStore(const SettingsStore&) = delete;
+    SettingsStore& operator=(const SettingsStore&) = delete;
+    SettingsStore(SettingsStore&&) = delete;
+    SettingsStore& operator=(SettingsStore&&) = delete;
+
+    // Replaces any snapshot of the same file still waiting; ignored for an empty path
+    void Write(const std::string& path, std::string contents);
+    // The newest contents: the pending snapshot, otherwise the file (synchronous; for startup loads).
+    // False when neither exists.
+    bool Read(const std::string& path, std::string& contents);
+    // Writes everything pending now and waits for it
+    void Flush();
+
+    // %LOCALAPPDATA%\GameOverlay\<fileName>; empty without a profile directory
+    static std::string GetSettingsPath(const char* fileName);
+
+    // --- Statistics ---
+    uint64_t GetWriteCount() const { return m_writeCount; }         // Files written
+    uint64_t GetCoalescedCount() const { return m_coalescedCount; } // Snapshots replaced before their write
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Pending {
+        std::string contents;
+        Clock::time_point firstChange;
+        Clock::time_point lastChange;
+    };
+
+    SettingsStore();
+    ~SettingsStore();
+
+    void WorkerThread();
+    static bool CommitFile(const std::string& path, const std::string& contents);
+
+    std::thread m_worker;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;     // Wakes the worker
+    std::condition_variable m_idleCondition; // Wakes Flush
+    std::unordered_map<std::string, Pending> m_pending;
+    std::unordered_map<std::string, std::string> m_writing; // Taken by the worker, not yet on disk
+    bool m_flushRequested = false;
+    bool m_stopping = false;
+
+    std::atomic<uint64_t> m_writeCount{ 0 };
+    std::atomic<uint64_t> m_coalescedCount{ 0 };
+};
@@ -0,0 +1,242 @@
+// GameOverlay - SharedLayer.cpp
+// The composed overlay frame shared with other processes (the in-game Present hook, capture tools)
+
+#include "SharedLayer.h"
+#include <new>
+
+SharedLayer::SharedLayer(ID3D12Device* device)
+    : m_device(device) {
+    LARGE_INTEGER frequency = {};
+    QueryPerformanceFrequency(&frequency);
+    m_qpcFrequency = frequency.QuadPart > 0 ? frequency.QuadPart : 1;
+
+    HRESULT hr = m_device->CreateFence(0, D3D12_FENCE_FLAG_SHARED, IID_PPV_ARGS(&m_fence));
+    if (FAILED(hr) || FAILED(m_device->CreateSharedHandle(m_fence.Get(), nullptr, GENERIC_ALL, nullptr, &m_fenceHandle))) {
+        OutputDebugStringA("Warning: Failed to create the shared layer fence.\n");
+        m_fence.Reset();
+        return;
+    }
+
+    m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+        sizeof(SharedLayerBlock), LAYER_MAPPING_NAME);
+    if (!m_mapping) {
+        OutputDebugStringA("Warning: Failed to create the shared layer mapping.\n");
+        return;
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        OutputDebugStringA("Warning: Shared layer mapping already exists, not publishing.\n");
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+        return;
+    }
+
+    void* view = MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, sizeof(SharedLayerBlock));
+    if (!view) {
+        OutputDebugStringA("Warning: Failed to map the shared layer block.\n");
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+        return;
+    }
+
+    // Magic goes in last, so a reader that sees it also sees the rest of the header
+    m_block = new (view) SharedLayerBlock();
+    m_block->size = sizeof(SharedLayerBlock);
+    m_block->processId = GetCurrentProcessId();
+    m_block->qpcFrequency = m_qpcFrequency;
+    m_block->fenceHandle = reinterpret_cast<uint64_t>(m_fenceHandle);
+    m_block->latestSlot = SharedLayerBlock::NO_SLOT;
+    for (SharedLayerBlock::Consumer& consumer : m_block->consumers) {
+        consumer.readingSlot = SharedLayerBlock::NO_SLOT;
+    }
+    m_block->version = SharedLayerBlock::VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    m_block->magic = SharedLayerBlock::MAGIC;
+}
+
+SharedLayer::~SharedLayer() {
+    if (m_block) {
+        m_block->magic = 0; // Consumers stop reading
+        UnmapViewOfFile(m_block);
+        m_block = nullptr;
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    ReleaseTextures();
+    if (m_fenceHandle) {
+        CloseHandle(m_fenceHandle);
+        m_fenceHandle = nullptr;
+    }
+}
+
+bool SharedLayer::EnsureTextures(const D3D12_RESOURCE_DESC& sourceDesc) {
+    if (m_textures[0]) {
+        D3D12_RESOURCE_DESC desc = m_textures[0]->GetDesc();
+        if (desc.Width == sourceDesc.Width && desc.Height == sourceDesc.Height && desc.Format == sourceDesc.Format) {
+            return true;
+        }
+    }
+    ReleaseTextures();
+
+    // Simultaneous access: consumer queues read without barriers of their own, and copies promote
+    // the textures from COMMON implicitly
+    D3D12_HEAP_PROPERTIES heapProperties = {};
+    heapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
+    D3D12_RESOURCE_DESC desc = {};
+    desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    desc.Width = sourceDesc.Width;
+    desc.Height = sourceDesc.Height;
+    desc.DepthOrArraySize = 1;
+    desc.MipLevels = 1;
+    desc.Format = sourceDesc.Format;
+    desc.SampleDesc.Count = 1;
+    desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_SIMULTANEOUS_ACCESS;
+    for (uint32_t slot = 0; slot < SharedLayerBlock::SLOT_COUNT; slot++) {
+        HRESULT hr = m_device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_SHARED, &desc,
+            D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&m_textures[slot]));
+        if (FAILED(hr) || FAILED(m_device->CreateSharedHandle(m_textures[slot].Get(), nullptr, GENERIC_ALL, nullptr,
+            &m_textureHandles[slot]))) {
+            OutputDebugStringA("Warning: Failed to create the shared layer textures.\n");
+            ReleaseTextures();
+            return false;
+        }
+    }
+    m_generation++;
+
+    // Nothing of the old generation may be shown any more
+    m_latestSlot = SharedLayerBlock::NO_SLOT;
+    for (uint64_t& frame : m_slotFrames) frame = 0;
+    for (UINT64& fenceValue : m_slotFenceValues) fenceValue = 0; // Reads of the old textures don't matter
+    return true;
+}
+
+void SharedLayer::ReleaseTextures() {
+    for (uint32_t slot = 0; slot < SharedLayerBlock::SLOT_COUNT; slot++) {
+        m_textures[slot].Reset();
+        if (m_textureHandles[slot]) {
+            CloseHandle(m_textureHandles[slot]);
+            m_textureHandles[slot] = nullptr;
+        }
+    }
+}
+
+bool SharedLayer::IsConsumerLive(const SharedLayerBlock::Consumer& consumer, int64_t now) const {
+    if (consumer.processId.load(std::memory_order_acquire) == 0) return false;
+    int64_t read = consumer.qpc.load(std::memory_order_relaxed);
+    return read != 0 && (now - read) * 1000 / m_qpcFrequency < CONSUMER_TIMEOUT_MS;
+}
+
+uint32_t SharedLayer::SelectWriteSlot() const {
+    LARGE_INTEGER now = {};
+    QueryPerformanceCounter(&now);
+    bool taken[SharedLayerBlock::SLOT_COUNT] = {};
+    if (m_latestSlot != SharedLayerBlock::NO_SLOT) taken[m_latestSlot] = true;
+    for (const SharedLayerBlock::Consumer& consumer : m_block->consumers) {
+        if (!IsConsumerLive(consumer, now.QuadPart)) continue;
+        uint32_t reading = consumer.readingSlot.load(std::memory_order_acquire);
+        if (reading < SharedLayerBlock::SLOT_COUNT) taken[reading] = true;
+
+        // Its GPU may still sample a slot it read before, until completedFenceValue passes it
+        const uint64_t submitted = consumer.submittedFenceValue.load(std::memory_order_acquire);
+        const uint64_t completed = consumer.completedFenceValue.load(std::memory_order_acquire);
+        for (uint32_t slot = 0; slot < SharedLayerBlock::SLOT_COUNT; slot++) {
+            const UINT64 written = m_slotFenceValues[slot];
+            if (written != 0 && submitted >= written && completed < written) taken[slot] = true;
+        }
+    }
+
+    // The oldest free slot
+    uint32_t selected = SharedLayerBlock::NO_SLOT;
+    for (uint32_t slot = 0; slot < SharedLayerBlock::SLOT_COUNT; slot++) {
+        if (!taken[slot] && (selected == SharedLayerBlock::NO_SLOT || m_slotFrames[slot] < m_slotFrames[selected])) {
+            selected = slot;
+        }
+    }
+    return selected;
+}
+
+void SharedLayer::RecordCopy(ID3D12GraphicsCommandList* commandList, ID3D12Resource* source) {
+    if (!m_block || !m_fence || !source) return;
+    if (!EnsureTextures(source->GetDesc())) return;
+
+    uint32_t slot = SelectWriteSlot();
+    if (slot == SharedLayerBlock::NO_SLOT) {
+        m_droppedFrames++; // Consumers keep the latest frame; nothing waits
+        return;
+    }
+    commandList->CopyResource(m_textures[slot].Get(), source);
+    m_pendingSlot = slot;
+}
+
+void SharedLayer::Publish(ID3D12CommandQueue* queue) {
+    if (!m_block || m_pendingSlot == SharedLayerBlock::NO_SLOT) return;
+    const uint32_t slot = m_pendingSlot;
+    m_pendingSlot = SharedLayerBlock::NO_SLOT;
+    if (FAILED(queue->Signal(m_fence.Get(), ++m_fenceValue))) return;
+
+    m_slotFrames[slot] = ++m_frameIndex;
+    m_slotFenceValues[slot] = m_fenceValue;
+    m_latestSlot = slot;
+    WriteBlock();
+}
+
+void SharedLayer::SetVisible(bool visible) {
+    if (visible == m_visible) return;
+    m_visible = visible;
+    if (m_block) WriteBlock();
+}
+
+void SharedLayer::SetTarget(DWORD processId, HWND window) {
+    if (!m_block) return;
+    // Window first: a hook that sees its process also sees its window
+    m_block->targetWindow.store(reinterpret_cast<uint64_t>(window));
+    m_block->targetProcessId.store(processId);
+}
+
+void SharedLayer::WriteBlock() {
+    m_block->sequence.fetch_add(1, std::memory_order_relaxed); // Odd: write in progress
+    std::atomic_thread_fence(std::memory_order_release);
+    if (m_textures[0]) {
+        const D3D12_RESOURCE_DESC desc = m_textures[0]->GetDesc();
+        for (uint32_t slot = 0; slot < SharedLayerBlock::SLOT_COUNT; slot++) {
+            m_block->textureHandles[slot] = reinterpret_cast<uint64_t>(m_textureHandles[slot]);
+        }
+        m_block->generation = m_generation;
+        m_block->width = static_cast<uint32_t>(desc.Width);
+        m_block->height = desc.Height;
+        m_block->format = desc.Format;
+    }
+    m_block->screenX = m_originX;
+    m_block->screenY = m_originY;
+    m_block->visible = m_visible ? 1 : 0;
+    m_block->latestSlot = m_latestSlot;
+    m_block->latestFenceValue = m_fenceValue;
+    m_block->frameIndex = m_frameIndex;
+    m_block->sequence.fetch_add(1, std::memory_order_release); // Even: consistent
+}
+
+bool SharedLayer::IsConsumerAttached() const {
+    if (!m_block) return false;
+    LARGE_INTEGER now = {};
+    QueryPerformanceCounter(&now);
+    for (const SharedLayerBlock::Consumer& consumer : m_block->consumers) {
+        if ((consumer.flags.load(std::memory_order_relaxed) & SharedLayerBlock::CONSUMER_DRAWS_OVERLAY) &&
+            IsConsumerLive(consumer, now.QuadPart)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t SharedLayer::GetConsumerCount() const {
+    if (!m_block) return 0;
+    LARGE_INTEGER now = {};
+    QueryPerformanceCounter(&now);
+    uint32_t count = 0;
+    for (const SharedLayerBlock::Consumer& consumer : m_block->consumers) {
+        if (IsConsumerLive(consumer, now.QuadPart)) count++;
+    }
+    return count;
+}
@@ -0,0 +1,144 @@
+// GameOverlay - SharedLayer.h
+// The composed overlay frame shared with other processes (the in-game Present hook, capture tools)
+
+#pragma once
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <atomic>
+#include <cstdint>
+
+// Layout of the named mapping, the whole IPC channel: consumers find the frames here and register
+// here. The textures and the fence are shared NT handles of the overlay process; a consumer
+// duplicates them out of processId (DuplicateHandle) and opens them on its own device, D3D11 or
+// D3D12. Like the telemetry block, readers copy the frame fields between two equal even reads of
+// sequence; generation changes whenever the textures are recreated (size or format).
+//
+// Frames rotate through SLOT_COUNT textures. latestSlot holds the newest whole frame once the
+// fence reaches latestFenceValue; a consumer waits for that on its GPU, never on the CPU. To read,
+// a consumer claims a Consumer entry (compare-exchange processId from 0, or take over one whose
+// qpc is older than CONSUMER_TIMEOUT_MS), stores the slot it reads in readingSlot and refreshes
+// qpc on every read. Reads finish on the consumer's GPU later: it stores the latestFenceValue of
+// the newest frame it submitted a read of in submittedFenceValue, and of the newest one its GPU is
+// done with in completedFenceValue. The producer never writes the latest slot, one a live consumer
+// reads, or one holding a frame whose read may still be in flight (submitted at or past the slot's
+// fence value, completed short of it): it writes the oldest other slot, and drops the frame (the
+// previous one stays latest) when every slot is taken. So nobody waits for anybody.
+//
+// A consumer drawing into a game (the hook) draws only when it is targetProcessId, and only into
+// the swap chain presenting to targetWindow (or a child of it); any other does nothing.
+struct SharedLayerBlock {
+    static constexpr uint32_t MAGIC = 0x594C474F; // "OGLY"
+    static constexpr uint32_t VERSION = 4;
+    static constexpr uint32_t SLOT_COUNT = 3;
+    static constexpr uint32_t MAX_CONSUMERS = 4;
+    static constexpr uint32_t NO_SLOT = 0xFFFFFFFF;
+
+    // Consumer::flags
+    static constexpr uint32_t CONSUMER_DRAWS_OVERLAY = 1; // Shows the layer in place of the overlay window (the hook)
+
+    struct Consumer {
+        std::atomic<uint32_t> processId;
+        std::atomic<uint32_t> flags;
+        std::atomic<uint32_t> readingSlot; // NO_SLOT when not reading
+        std::atomic<int64_t> qpc;          // QueryPerformanceCounter of the last read
+        std::atomic<uint64_t> submittedFenceValue; // Newest frame read on the consumer's GPU
+        std::atomic<uint64_t> completedFenceValue; // Newest frame whose read the GPU finished
+    };
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;                 // sizeof(SharedLayerBlock) of the writer
+    uint32_t processId;            // Owner of the handles
+    int64_t qpcFrequency;
+    uint64_t fenceHandle;          // ID3D12Fence
+
+    // Frame fields (seqlock)
+    std::atomic<uint64_t> sequence;
+    uint64_t textureHandles[SLOT_COUNT]; // ID3D12Resource, premultiplied alpha
+    uint32_t generation;
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;               // DXGI_FORMAT
+    int32_t screenX;               // Where a texture's top-left pixel goes on screen
+    int32_t screenY;
+    uint32_t visible;              // 0: draw nothing
+    uint32_t latestSlot;           // NO_SLOT before the first frame
+    uint64_t latestFenceValue;
+    uint64_t frameIndex;           // Frames published so far
+
+    // The game drawn into (SetTarget), outside the seqlock; 0 for none
+    std::atomic<uint32_t> targetProcessId;
+    std::atomic<uint64_t> targetWindow; // HWND of the game's top-level window
+
+    Consumer consumers[MAX_CONSUMERS];
+};
+
+// Producer side, owned by the RenderSystem. RecordCopy copies the finished back buffer into a free
+// slot on the frame's command list (recreating the textures when the size or format changed; the
+// GPU is idle then, a swap chain resize waited for it), and Publish signals the shared fence after
+// the frame's submission and makes the slot the latest.
+class SharedLayer {
+public:
+    static constexpr const char* LAYER_MAPPING_NAME = "Local\\GameOverlayLayer";
+    static constexpr int64_t CONSUMER_TIMEOUT_MS = 250;
+    // Set in the overlay's own environment, so the hook DLL loaded there leaves it alone
+    static constexpr const wchar_t* PRODUCER_VARIABLE = L"GAMEOVERLAY_LAYER_PRODUCER";
+
+    explicit SharedLayer(ID3D12Device* device);
+    ~SharedLayer();
+
+    // Disable copy and move
+    SharedLayer(const SharedLayer&) = delete;
+    SharedLayer& operator=(const SharedLayer&) = delete;
+    SharedLayer(SharedLayer&&) = delete;
+    SharedLayer& operator=(SharedLayer&&) = delete;
+
+    bool IsAvailable() const { return m_block != nullptr; }
+
+    // Screen position of the overlay window (the back buffer's top-left pixel)
+    void SetOrigin(int x, int y) { m_originX = x; m_originY = y; }
+    // Published at once: a hidden overlay renders no frames to carry it
+    void SetVisible(bool visible);
+    // The detected game's process and window; 0 and null draw into no game
+    void SetTarget(DWORD processId, HWND window);
+
+    // source is in D3D12_RESOURCE_STATE_COPY_SOURCE
+    void RecordCopy(ID3D12GraphicsCommandList* commandList, ID3D12Resource* source);
+    void Publish(ID3D12CommandQueue* queue);
+
+    // A live consumer with CONSUMER_DRAWS_OVERLAY (the overlay then hides its own window contents)
+    bool IsConsumerAttached() const;
+    uint32_t GetConsumerCount() const; // Live consumers of any kind
+    uint64_t GetDroppedFrames() const { return m_droppedFrames; } // Every slot was taken
+
+private:
+    bool EnsureTextures(const D3D12_RESOURCE_DESC& sourceDesc);
+    void ReleaseTextures();
+    uint32_t SelectWriteSlot() const; // NO_SLOT when none is free
+    bool IsConsumerLive(const SharedLayerBlock::Consumer& consumer, int64_t now) const;
+    void WriteBlock(); // Seqlock-protected frame fields
+
+    ID3D12Device* m_device = nullptr;
+    HANDLE m_mapping = nullptr;
+    SharedLayerBlock* m_block = nullptr;
+
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_textures[SharedLayerBlock::SLOT_COUNT];
+    HANDLE m_textureHandles[SharedLayerBlock::SLOT_COUNT] = {};
+    uint64_t m_slotFrames[SharedLayerBlock::SLOT_COUNT] = {}; // Frame index last written
+    UINT64 m_slotFenceValues[SharedLayerBlock::SLOT_COUNT] = {}; // Fence value it was published at
+    Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
+    HANDLE m_fenceHandle = nullptr;
+    UINT64 m_fenceValue = 0;
+    uint32_t m_generation = 0;
+    uint32_t m_latestSlot = SharedLayerBlock::NO_SLOT;
+    uint32_t m_pendingSlot = SharedLayerBlock::NO_SLOT; // Copied by RecordCopy, published by Publish
+    uint64_t m_frameIndex = 0;
+    uint64_t m_droppedFrames = 0;
+
+    int m_originX = 0;
+    int m_originY = 0;
+    bool m_visible = true;
+    int64_t m_qpcFrequency = 1;
+};
@@ -0,0 +1,61 @@
+// GameOverlay - SharedTelemetry.cpp
+// Overlay cost published in shared memory for external monitoring tools
+
+#include "SharedTelemetry.h"
+#include <new>
+
+SharedTelemetry::SharedTelemetry() {
+    m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+        sizeof(OverlayTelemetryBlock), TELEMETRY_MAPPING_NAME);
+    if (!m_mapping) {
+        OutputDebugStringA("Warning: Failed to create the telemetry mapping.\n");
+        return;
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        // Another overlay instance publishes already; two writers would break the seqlock
+        OutputDebugStringA("Warning: Telemetry mapping already exists, not publishing.\n");
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+        return;
+    }
+
+    void* view = MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, sizeof(OverlayTelemetryBlock));
+    if (!view) {
+        OutputDebugStringA("Warning: Failed to map the telemetry block.\n");
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+        return;
+    }
+
+    // Magic goes in last, so a reader that sees it also sees the rest of the header
+    m_block = new (view) OverlayTelemetryBlock();
+    m_block->size = sizeof(OverlayTelemetryBlock);
+    m_block->processId = GetCurrentProcessId();
+    m_block->version = OverlayTelemetryBlock::VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    m_block->magic = OverlayTelemetryBlock::MAGIC;
+}
+
+SharedTelemetry::~SharedTelemetry() {
+    if (m_block) {
+        m_block->magic = 0; // Readers holding the mapping open see the writer is gone
+        UnmapViewOfFile(m_block);
+        m_block = nullptr;
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+}
+
+OverlayTelemetryBlock* SharedTelemetry::BeginWrite() {
+    if (!m_block) return nullptr;
+    m_block->sequence.fetch_add(1, std::memory_order_relaxed); // Odd: write in progress
+    std::atomic_thread_fence(std::memory_order_release);
+    return m_block;
+}
+
+void SharedTelemetry::EndWrite() {
+    if (!m_block) return;
+    m_block->sequence.fetch_add(1, std::memory_order_release); // Even: consistent
+}
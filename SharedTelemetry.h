@@ -0,0 +1,77 @@
+// GameOverlay - SharedTelemetry.h
+// Overlay cost published in shared memory for external monitoring tools
+
+#pragma once
+
+#include <Windows.h>
+#include <atomic>
+#include <cstdint>
+
+// Layout of the named mapping. Readers open TELEMETRY_MAPPING_NAME read-only, check magic and
+// version, then copy the block between two equal even reads of sequence (odd = write in
+// progress). Fields are only ever appended; size grows with them.
+struct OverlayTelemetryBlock {
+    static constexpr uint32_t MAGIC = 0x4D54474F; // "OGTM"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t MAX_GPU_PASSES = 8;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;                 // sizeof(OverlayTelemetryBlock) of the writer
+    uint32_t processId;
+    std::atomic<uint64_t> sequence;
+
+    uint64_t frameIndex;
+    int64_t qpcTimestamp;          // QueryPerformanceCounter at publish
+    int64_t qpcFrequency;
+
+    // Frame timing (percentiles over the last 10 s)
+    float frameTimeMs;
+    float framesPerSecond;
+    float displayedFramesPerSecond;
+    float p50FrameMs;
+    float p95FrameMs;
+    float p99FrameMs;
+    float p999FrameMs;
+    float maxFrameMs;
+
+    // GPU timestamps (a few frames late); pass order follows GpuPass
+    float gpuFrameMs;
+    uint32_t gpuPassCount;
+    float gpuPassMs[MAX_GPU_PASSES];
+
+    // Process resources
+    float cpuPercent;              // Of all cores
+    float gpuPercent;              // Busiest engine
+    float memoryMB;                // Process tree private bytes plus dedicated GPU memory
+
+    // Optimizer
+    uint32_t performanceState;     // PerformanceState
+    float renderScale;
+};
+
+// Writer side. Publish is a few hundred bytes of stores and two atomic increments, so it runs
+// on the render thread once per frame; readers never block it.
+class SharedTelemetry {
+public:
+    static constexpr const char* TELEMETRY_MAPPING_NAME = "Local\\GameOverlayTelemetry";
+
+    SharedTelemetry();
+    ~SharedTelemetry();
+
+    // Disable copy and move
+    SharedTelemetry(const SharedTelemetry&) = delete;
+    SharedTelemetry& operator=(const SharedTelemetry&) = delete;
+    SharedTelemetry(SharedTelemetry&&) = delete;
+    SharedTelemetry& operator=(SharedTelemetry&&) = delete;
+
+    bool IsAvailable() const { return m_block != nullptr; }
+
+    // Fill the block between BeginWrite and EndWrite; null when unavailable
+    OverlayTelemetryBlock* BeginWrite();
+    void EndWrite();
+
+private:
+    HANDLE m_mapping = nullptr;
+    OverlayTelemetryBlock* m_block = nullptr;
+};
@@ -0,0 +1,136 @@
+// GameOverlay - SharedTextureCopier.cpp
+// Copies CEF's accelerated paint textures while their paint callback runs
+
+#include "SharedTextureCopier.h"
+#include "Log.h"
+#include <algorithm>
+
+SharedTextureCopier::SharedTextureCopier(ID3D12Device* device) : m_device(device) {
+    if (!m_device) return;
+
+    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+    HRESULT hr = m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_queue));
+    if (SUCCEEDED(hr)) {
+        hr = m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&m_allocator));
+    }
+    if (SUCCEEDED(hr)) {
+        hr = m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, m_allocator.Get(), nullptr,
+            IID_PPV_ARGS(&m_commandList));
+    }
+    if (SUCCEEDED(hr)) {
+        hr = m_commandList->Close();
+    }
+    if (SUCCEEDED(hr)) {
+        hr = m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence));
+    }
+    if (SUCCEEDED(hr)) {
+        m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        if (!m_fenceEvent) hr = HRESULT_FROM_WIN32(GetLastError());
+    }
+    if (FAILED(hr)) {
+        LOG_WARNING("Shared texture copy queue unavailable (0x%08X)", static_cast<unsigned>(hr));
+        m_queue.Reset();
+        m_allocator.Reset();
+        m_commandList.Reset();
+        m_fence.Reset();
+    }
+    else {
+        m_queue->SetName(L"CEF Paint Copy Queue");
+    }
+}
+
+SharedTextureCopier::~SharedTextureCopier() {
+    // Every Copy waited for its own work, so the queue is idle
+    if (m_fenceEvent) {
+        CloseHandle(m_fenceEvent);
+    }
+}
+
+ComPtr<ID3D12Resource> SharedTextureCopier::CreateTarget(UINT width, UINT height, DXGI_FORMAT format,
+    const wchar_t* name) const {
+    if (!m_device || width == 0 || height == 0) return nullptr;
+
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+    D3D12_RESOURCE_DESC desc = {};
+    desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    desc.Width = width;
+    desc.Height = height;
+    desc.DepthOrArraySize = 1;
+    desc.MipLevels = 1;
+    desc.Format = format;
+    desc.SampleDesc.Count = 1;
+    desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+
+    ComPtr<ID3D12Resource> texture;
+    if (FAILED(m_device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+        D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&texture)))) {
+        return nullptr;
+    }
+    if (name) texture->SetName(name);
+    return texture;
+}
+
+bool SharedTextureCopier::Copy(HANDLE sharedHandle, ID3D12Resource* destination, UINT& width, UINT& height) {
+    width = 0;
+    height = 0;
+    if (!sharedHandle || !destination || !IsAvailable()) return false;
+
+    ComPtr<ID3D12Resource> sharedTexture;
+    if (FAILED(m_device->OpenSharedHandle(sharedHandle, IID_PPV_ARGS(&sharedTexture)))) {
+        return false;
+    }
+    return Copy(sharedTexture.Get(), destination, width, height);
+}
+
+bool SharedTextureCopier::Copy(ID3D12Resource* source, ID3D12Resource* destination, UINT& width, UINT& height) {
+    width = 0;
+    height = 0;
+    if (!source || !destination || !IsAvailable()) return false;
+
+    // CEF's texture follows the browser size, which can lag a resize by a frame
+    const D3D12_RESOURCE_DESC srcDesc = source->GetDesc();
+    const D3D12_RESOURCE_DESC dstDesc = destination->GetDesc();
+    D3D12_BOX srcBox = {};
+    srcBox.right = static_cast<UINT>(std::min(srcDesc.Width, dstDesc.Width));
+    srcBox.bottom = std::min(srcDesc.Height, dstDesc.Height);
+    srcBox.back = 1;
+
+    D3D12_TEXTURE_COPY_LOCATION srcLocation = {};
+    srcLocation.pResource = source;
+    srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    srcLocation.SubresourceIndex = 0;
+
+    D3D12_TEXTURE_COPY_LOCATION dstLocation = {};
+    dstLocation.pResource = destination;
+    dstLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    dstLocation.SubresourceIndex = 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // The previous copy was waited for, so the allocator is free
+    if (FAILED(m_allocator->Reset()) || FAILED(m_commandList->Reset(m_allocator.Get(), nullptr))) {
+        return false;
+    }
+    m_commandList->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, &srcBox);
+    if (FAILED(m_commandList->Close())) {
+        return false;
+    }
+    ID3D12CommandList* lists[] = { m_commandList.Get() };
+    m_queue->ExecuteCommandLists(1, lists);
+
+    // Done before the callback returns and CEF takes its texture back
+    const UINT64 fenceValue = ++m_fenceValue;
+    if (FAILED(m_queue->Signal(m_fence.Get(), fenceValue))) {
+        return false;
+    }
+    if (m_fence->GetCompletedValue() < fenceValue) {
+        m_fence->SetEventOnCompletion(fenceValue, m_fenceEvent);
+        WaitForSingleObject(m_fenceEvent, INFINITE);
+    }
+
+    width = srcBox.right;
+    height = srcBox.bottom;
+    return width > 0 && height > 0;
+}
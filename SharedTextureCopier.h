@@ -0,0 +1,53 @@
+// GameOverlay - SharedTextureCopier.h
+// Copies CEF's accelerated paint textures while their paint callback runs
+
+#pragma once
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <mutex>
+#include <cstdint>
+
+using Microsoft::WRL::ComPtr;
+
+// CEF's shared texture handle is only valid during OnAcceleratedPaint: once the callback returns,
+// Chromium reuses the texture for a later frame. So the paint is copied out before returning,
+// into a texture the overlay owns, on a copy queue of its own that the callback waits on (the
+// copy is a single small GPU job, well under the cost of the software paint it replaces).
+// The render thread then uses the copy like any other texture, without a cross-queue wait: the
+// copy finished before the paint was handed over.
+class SharedTextureCopier {
+public:
+    SharedTextureCopier(ID3D12Device* device);
+    ~SharedTextureCopier();
+
+    // Disable copy and move
+    SharedTextureCopier(const SharedTextureCopier&) = delete;
+    SharedTextureCopier& operator=(const SharedTextureCopier&) = delete;
+    SharedTextureCopier(SharedTextureCopier&&) = delete;
+    SharedTextureCopier& operator=(SharedTextureCopier&&) = delete;
+
+    bool IsAvailable() const { return m_queue != nullptr; }
+
+    // A texture for Copy to write: COMMON state, owned by the caller
+    ComPtr<ID3D12Resource> CreateTarget(UINT width, UINT height, DXGI_FORMAT format, const wchar_t* name) const;
+
+    // CEF thread (any thread; copies are serialized). Copies the top left of the shared texture, up
+    // to the destination's size, into destination (COMMON, not in use on another queue) and waits
+    // for the copy. The copied size goes to width and height; false when nothing was copied.
+    bool Copy(HANDLE sharedHandle, ID3D12Resource* destination, UINT& width, UINT& height);
+    // The same, for a shared texture the caller already opened on this device
+    bool Copy(ID3D12Resource* source, ID3D12Resource* destination, UINT& width, UINT& height);
+
+private:
+    ComPtr<ID3D12Device> m_device;
+
+    std::mutex m_mutex; // One copy at a time on the list below
+    ComPtr<ID3D12CommandQueue> m_queue;
+    ComPtr<ID3D12CommandAllocator> m_allocator;
+    ComPtr<ID3D12GraphicsCommandList> m_commandList;
+    ComPtr<ID3D12Fence> m_fence;
+    UINT64 m_fenceValue = 0;
+    HANDLE m_fenceEvent = nullptr;
+};
@@ -0,0 +1,217 @@
+// GameOverlay - SpriteBatch.cpp
+// Instanced quad, line and icon renderer for HUD markers
+
+#include "SpriteBatch.h"
+#include "RenderSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+static const float FULL_TEX_RECT[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+
+SpriteBatch::SpriteBatch(RenderSystem* renderSystem)
+    : m_renderSystem(renderSystem), m_resourceManager(renderSystem->GetResourceManager()) {
+}
+
+SpriteBatch::~SpriteBatch() {
+    // Frames in flight may still sample it
+    if (m_whiteTexture) {
+        ResourceDescriptor srv = m_whiteSrv;
+        ResourceManager* resourceManager = m_resourceManager;
+        m_resourceManager->RetireResource(std::move(m_whiteTexture),
+            [resourceManager, srv]() { resourceManager->FreeDescriptor(srv); });
+    }
+}
+
+SpriteInstance* SpriteBatch::AddInstance(UINT64 texture) {
+    if (m_lastBatch >= m_usedBatches || m_batches[m_lastBatch].texture != texture) {
+        m_lastBatch = m_usedBatches;
+        for (size_t i = 0; i < m_usedBatches; i++) {
+            if (m_batches[i].texture == texture) {
+                m_lastBatch = i;
+                break;
+            }
+        }
+        if (m_lastBatch == m_usedBatches) {
+            if (m_usedBatches == m_batches.size()) {
+                m_batches.emplace_back();
+            }
+            m_batches[m_usedBatches].texture = texture;
+            m_usedBatches++;
+        }
+    }
+
+    std::vector<SpriteInstance>& instances = m_batches[m_lastBatch].instances;
+    instances.emplace_back();
+    m_queuedInstances++;
+    return &instances.back();
+}
+
+void SpriteBatch::DrawRect(float x, float y, float width, float height, uint32_t color) {
+    SpriteInstance* instance = AddInstance(0);
+    instance->origin[0] = x;
+    instance->origin[1] = y;
+    instance->axisX[0] = width;
+    instance->axisX[1] = 0.0f;
+    instance->axisY[0] = 0.0f;
+    instance->axisY[1] = height;
+    memcpy(instance->texRect, FULL_TEX_RECT, sizeof(FULL_TEX_RECT));
+    instance->color = color;
+}
+
+void SpriteBatch::DrawRectOutline(float x, float y, float width, float height, float thickness, uint32_t color) {
+    DrawRect(x, y, width, thickness, color);
+    DrawRect(x, y + height - thickness, width, thickness, color);
+    DrawRect(x, y + thickness, thickness, height - 2.0f * thickness, color);
+    DrawRect(x + width - thickness, y + thickness, thickness, height - 2.0f * thickness, color);
+}
+
+void SpriteBatch::DrawLine(float x0, float y0, float x1, float y1, float thickness, uint32_t color) {
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    float length = std::sqrt(dx * dx + dy * dy);
+    if (length <= 0.0f) return;
+
+    // Quad along the line, thickness wide and centered on it
+    float nx = -dy / length * thickness;
+    float ny = dx / length * thickness;
+    SpriteInstance* instance = AddInstance(0);
+    instance->origin[0] = x0 - nx * 0.5f;
+    instance->origin[1] = y0 - ny * 0.5f;
+    instance->axisX[0] = dx;
+    instance->axisX[1] = dy;
+    instance->axisY[0] = nx;
+    instance->axisY[1] = ny;
+    memcpy(instance->texRect, FULL_TEX_RECT, sizeof(FULL_TEX_RECT));
+    instance->color = color;
+}
+
+void SpriteBatch::DrawSprite(D3D12_GPU_DESCRIPTOR_HANDLE texture, float x, float y, float width, float height,
+    uint32_t color, const float* texRect) {
+    SpriteInstance* instance = AddInstance(texture.ptr);
+    instance->origin[0] = x;
+    instance->origin[1] = y;
+    instance->axisX[0] = width;
+    instance->axisX[1] = 0.0f;
+    instance->axisY[0] = 0.0f;
+    instance->axisY[1] = height;
+    memcpy(instance->texRect, texRect ? texRect : FULL_TEX_RECT, sizeof(FULL_TEX_RECT));
+    instance->color = color;
+}
+
+void SpriteBatch::DrawRotatedSprite(D3D12_GPU_DESCRIPTOR_HANDLE texture, float centerX, float centerY, float width,
+    float height, float radians, uint32_t color) {
+    float c = std::cos(radians);
+    float s = std::sin(radians);
+    SpriteInstance* instance = AddInstance(texture.ptr);
+    instance->axisX[0] = c * width;
+    instance->axisX[1] = s * width;
+    instance->axisY[0] = -s * height;
+    instance->axisY[1] = c * height;
+    instance->origin[0] = centerX - 0.5f * (instance->axisX[0] + instance->axisY[0]);
+    instance->origin[1] = centerY - 0.5f * (instance->axisX[1] + instance->axisY[1]);
+    memcpy(instance->texRect, FULL_TEX_RECT, sizeof(FULL_TEX_RECT));
+    instance->color = color;
+}
+
+void SpriteBatch::DrawCrosshair(float centerX, float centerY, float size, float thickness, float gap, uint32_t color) {
+    float half = thickness * 0.5f;
+    DrawRect(centerX - gap - size, centerY - half, size, thickness, color); // Left
+    DrawRect(centerX + gap, centerY - half, size, thickness, color);        // Right
+    DrawRect(centerX - half, centerY - gap - size, thickness, size, color); // Top
+    DrawRect(centerX - half, centerY + gap, thickness, size, color);        // Bottom
+    if (gap <= 0.0f) {
+        DrawRect(centerX - half, centerY - half, thickness, thickness, color);
+    }
+}
+
+void SpriteBatch::DrawInstances(D3D12_GPU_DESCRIPTOR_HANDLE texture, const SpriteInstance* instances, size_t count) {
+    if (!instances || count == 0) return;
+    AddInstance(texture.ptr);
+    std::vector<SpriteInstance>& batch = m_batches[m_lastBatch].instances;
+    batch.pop_back();
+    batch.insert(batch.end(), instances, instances + count);
+    m_queuedInstances += count - 1;
+}
+
+void SpriteBatch::Flush(ID3D12GraphicsCommandList* commandList) {
+    if (m_queuedInstances == 0 || !commandList) return;
+
+    // Items are dropped, not kept, when the pipeline isn't available
+    PipelineStateManager* pipelineStateManager = m_renderSystem->GetPipelineStateManager();
+    ID3D12RootSignature* rootSignature = pipelineStateManager ? pipelineStateManager->GetSpriteRootSignature() : nullptr;
+    ID3D12PipelineState* pipelineState = pipelineStateManager ?
+        pipelineStateManager->GetSpritePipelineState(m_renderSystem->GetSceneFormat()) : nullptr;
+    bool hasSolid = false;
+    for (size_t i = 0; i < m_usedBatches; i++) {
+        hasSolid |= m_batches[i].texture == 0;
+    }
+    bool ready = rootSignature && pipelineState && (!hasSolid || m_whiteTexture || CreateWhiteTexture(commandList));
+
+    if (ready) {
+        // Every instance in one ring allocation; each batch draws a range of it
+        UINT64 bytes = static_cast<UINT64>(m_queuedInstances) * sizeof(SpriteInstance);
+        UploadAllocation upload = m_resourceManager->AllocateUpload(bytes, 16);
+        uint8_t* destination = static_cast<uint8_t*>(upload.cpuAddress);
+        for (size_t i = 0; i < m_usedBatches; i++) {
+            const std::vector<SpriteInstance>& instances = m_batches[i].instances;
+            memcpy(destination, instances.data(), instances.size() * sizeof(SpriteInstance));
+            destination += instances.size() * sizeof(SpriteInstance);
+        }
+
+        D3D12_VERTEX_BUFFER_VIEW instanceBufferView = {};
+        instanceBufferView.BufferLocation = upload.gpuAddress;
+        instanceBufferView.SizeInBytes = static_cast<UINT>(bytes);
+        instanceBufferView.StrideInBytes = sizeof(SpriteInstance);
+
+        SpriteConstants constants = {};
+        constants.pixelToClip[0] = 2.0f / static_cast<float>(std::max(m_renderSystem->GetWidth(), 1));
+        constants.pixelToClip[1] = 2.0f / static_cast<float>(std::max(m_renderSystem->GetHeight(), 1));
+
+        m_resourceManager->FlushBarriers(commandList);
+        commandList->SetGraphicsRootSignature(rootSignature);
+        commandList->SetPipelineState(pipelineState);
+        commandList->SetGraphicsRoot32BitConstants(1, sizeof(SpriteConstants) / sizeof(UINT), &constants, 0);
+        commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        commandList->IASetVertexBuffers(0, 1, &instanceBufferView);
+
+        UINT firstInstance = 0;
+        for (size_t i = 0; i < m_usedBatches; i++) {
+            UINT count = static_cast<UINT>(m_batches[i].instances.size());
+            D3D12_GPU_DESCRIPTOR_HANDLE texture = { m_batches[i].texture ? m_batches[i].texture : m_whiteSrv.gpuHandle.ptr };
+            commandList->SetGraphicsRootDescriptorTable(0, texture);
+            commandList->DrawInstanced(4, count, 0, firstInstance);
+            firstInstance += count;
+        }
+
+        m_lastFlushStats.instances = static_cast<UINT>(m_queuedInstances);
+        m_lastFlushStats.drawCalls = static_cast<UINT>(m_usedBatches);
+    }
+
+    for (size_t i = 0; i < m_usedBatches; i++) {
+        m_batches[i].instances.clear();
+    }
+    m_usedBatches = 0;
+    m_lastBatch = 0;
+    m_queuedInstances = 0;
+}
+
+bool SpriteBatch::CreateWhiteTexture(ID3D12GraphicsCommandList* commandList) {
+    try {
+        m_whiteTexture = m_resourceManager->CreateTexture2D(1, 1, DXGI_FORMAT_R8G8B8A8_UNORM);
+        if (!m_whiteTexture) return false;
+        m_whiteTexture->SetName(L"SpriteBatch White");
+        m_whiteSrv = m_resourceManager->CreateShaderResourceView(m_whiteTexture.Get());
+        m_resourceManager->PinResource(m_whiteTexture.Get(), true);
+
+        const uint32_t white = WHITE;
+        m_resourceManager->UpdateTexture(commandList, m_whiteTexture.Get(), &white, sizeof(white), 1, 1);
+    }
+    catch (const std::exception& e) {
+        OutputDebugStringA(("Warning: Failed to create sprite batch texture: " + std::string(e.what()) + "\n").c_str());
+        m_whiteTexture.Reset();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,87 @@
+// GameOverlay - SpriteBatch.h
+// Instanced quad, line and icon renderer for HUD markers
+
+#pragma once
+
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <vector>
+#include <cstdint>
+#include "PipelineStateManager.h"
+#include "ResourceManager.h"
+
+// Forward declarations
+class RenderSystem;
+
+using Microsoft::WRL::ComPtr;
+
+// Native drawing for large numbers of simple items (map pins, timers, crosshairs) that would cost
+// milliseconds of CPU as ImGui draw lists. Every item is one SpriteInstance; Flush copies them into
+// the upload ring in one go and draws each texture's items with a single instanced draw call.
+// Coordinates are window pixels (ImGui's space), colors RGBA8 in IM_COL32 order. A null texture
+// draws solid color. Items keep their order within a texture; textures are drawn in order of first
+// use, so items that must layer across textures need a Flush in between.
+class SpriteBatch {
+public:
+    static constexpr uint32_t WHITE = 0xFFFFFFFF;
+
+    SpriteBatch(RenderSystem* renderSystem);
+    ~SpriteBatch();
+
+    // Disable copy and move
+    SpriteBatch(const SpriteBatch&) = delete;
+    SpriteBatch& operator=(const SpriteBatch&) = delete;
+    SpriteBatch(SpriteBatch&&) = delete;
+    SpriteBatch& operator=(SpriteBatch&&) = delete;
+
+    // --- Items (render thread) ---
+    void DrawRect(float x, float y, float width, float height, uint32_t color);
+    void DrawRectOutline(float x, float y, float width, float height, float thickness, uint32_t color);
+    void DrawLine(float x0, float y0, float x1, float y1, float thickness, uint32_t color);
+    // texRect is u0, v0, u1, v1 (nullptr for the whole texture)
+    void DrawSprite(D3D12_GPU_DESCRIPTOR_HANDLE texture, float x, float y, float width, float height,
+                    uint32_t color = WHITE, const float* texRect = nullptr);
+    // Centered on (centerX, centerY), turned clockwise by radians
+    void DrawRotatedSprite(D3D12_GPU_DESCRIPTOR_HANDLE texture, float centerX, float centerY, float width,
+                           float height, float radians, uint32_t color = WHITE);
+    // Four arms of length size around a gap in the middle, plus a center dot when gap is 0
+    void DrawCrosshair(float centerX, float centerY, float size, float thickness, float gap, uint32_t color);
+    // Prebuilt instances, e.g. kept from a previous frame
+    void DrawInstances(D3D12_GPU_DESCRIPTOR_HANDLE texture, const SpriteInstance* instances, size_t count);
+
+    // Records everything queued since the last Flush on commandList (frame render target, viewport and
+    // descriptor heap set) and empties the batch. RenderSystem flushes leftovers at EndFrame, on top
+    // of the UI.
+    void Flush(ID3D12GraphicsCommandList* commandList);
+
+    size_t GetQueuedInstanceCount() const { return m_queuedInstances; }
+
+    struct Stats {
+        UINT instances = 0;  // Drawn by the last Flush that drew anything
+        UINT drawCalls = 0;
+    };
+    Stats GetLastFlushStats() const { return m_lastFlushStats; }
+
+private:
+    // Items for one texture; kept across frames so their storage is reused
+    struct Batch {
+        UINT64 texture = 0; // GPU descriptor handle, 0 for solid color
+        std::vector<SpriteInstance> instances;
+    };
+    SpriteInstance* AddInstance(UINT64 texture);
+    bool CreateWhiteTexture(ID3D12GraphicsCommandList* commandList);
+
+    // Resource pointers (not owned)
+    RenderSystem* m_renderSystem = nullptr;
+    ResourceManager* m_resourceManager = nullptr;
+
+    std::vector<Batch> m_batches;
+    size_t m_usedBatches = 0;   // Batches with items this frame, in order of first use
+    size_t m_lastBatch = 0;     // Most recent lookup; consecutive items usually share a texture
+    size_t m_queuedInstances = 0;
+    Stats m_lastFlushStats;
+
+    // 1x1 white texture sampled by solid items
+    ComPtr<ID3D12Resource> m_whiteTexture;
+    ResourceDescriptor m_whiteSrv;
+};
@@ -0,0 +1,128 @@
+// GameOverlay - StartupGraph.cpp
+// Startup phases as a small dependency graph, overlapped across the main thread and workers
+
+#include "StartupGraph.h"
+#include <Windows.h>
+#include <cstdio>
+#include <stdexcept>
+
+StartupGraph::StartupGraph(std::chrono::steady_clock::time_point origin)
+    : m_origin(origin) {
+}
+
+StartupGraph::~StartupGraph() {
+    WaitForWorkers();
+}
+
+StartupGraph::PhaseId StartupGraph::Add(const char* name, Affinity affinity, std::vector<PhaseId> dependencies,
+    std::function<void()> work) {
+    for (PhaseId dependency : dependencies) {
+        if (dependency >= m_phases.size()) {
+            throw std::invalid_argument("Startup phase depends on a phase added after it");
+        }
+    }
+    Phase phase;
+    phase.name = name;
+    phase.affinity = affinity;
+    phase.dependencies = std::move(dependencies);
+    phase.work = std::move(work);
+    m_phases.push_back(std::move(phase));
+    return m_phases.size() - 1;
+}
+
+bool StartupGraph::IsReadyLocked(const Phase& phase) const {
+    if (phase.state != State::Waiting) return false;
+    for (PhaseId dependency : phase.dependencies) {
+        if (m_phases[dependency].state != State::Done) return false;
+    }
+    return true;
+}
+
+void StartupGraph::Run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_donePhases < m_phases.size()) {
+        // Workers first, so they are already going while the main thread is busy
+        PhaseId mainPhase = m_phases.size();
+        if (!m_failure) {
+            for (PhaseId id = 0; id < m_phases.size(); id++) {
+                Phase& phase = m_phases[id];
+                if (!IsReadyLocked(phase)) continue;
+                if (phase.affinity == Affinity::Worker) {
+                    phase.state = State::Running;
+                    JobDesc job;
+                    job.name = "Startup Phase";
+                    job.priority = JobPriority::High;
+                    job.jobClass = JobClass::Performance;
+                    job.counter = &m_workerJobs;
+                    JobSystem::Get().Submit(job, [this, id]() { Execute(id); });
+                }
+                else if (mainPhase == m_phases.size()) {
+                    mainPhase = id;
+                }
+            }
+        }
+
+        if (mainPhase < m_phases.size()) {
+            m_phases[mainPhase].state = State::Running;
+            lock.unlock();
+            Execute(mainPhase);
+            lock.lock();
+            continue;
+        }
+
+        // Nothing for this thread until a worker finishes; after a failure, only the running ones count
+        size_t running = 0;
+        for (const Phase& phase : m_phases) {
+            if (phase.state == State::Running) running++;
+        }
+        if (running == 0) break; // Failed: the rest never starts
+        const size_t done = m_donePhases;
+        m_phaseDone.wait(lock, [this, done]() { return m_donePhases != done; });
+    }
+    lock.unlock();
+
+    WaitForWorkers();
+    if (m_failure) std::rethrow_exception(m_failure);
+}
+
+void StartupGraph::Execute(PhaseId id) {
+    Phase& phase = m_phases[id];
+    const auto start = std::chrono::steady_clock::now();
+    std::exception_ptr failure;
+    try {
+        phase.work();
+    }
+    catch (...) {
+        failure = std::current_exception();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    PhaseTiming timing;
+    timing.name = phase.name;
+    timing.mainThread = phase.affinity == Affinity::MainThread;
+    timing.startMs = std::chrono::duration<double, std::milli>(start - m_origin).count();
+    timing.durationMs = std::chrono::duration<double, std::milli>(end - start).count();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (failure && !m_failure) m_failure = failure;
+        phase.state = State::Done;
+        phase.work = nullptr; // Releases what the work captured
+        m_timings.push_back(std::move(timing));
+        m_donePhases++;
+    }
+    m_phaseDone.notify_all();
+}
+
+void StartupGraph::WaitForWorkers() {
+    // Blocking only: continuations submitted during startup wait for the main loop
+    m_workerJobs.WaitBlocking();
+}
+
+void StartupGraph::LogTimings() const {
+    char line[160];
+    for (const PhaseTiming& timing : m_timings) {
+        snprintf(line, sizeof(line), "Startup: %-16s %8.1f ms (at %8.1f ms, %s)\n", timing.name.c_str(),
+            timing.durationMs, timing.startMs, timing.mainThread ? "main thread" : "worker");
+        OutputDebugStringA(line);
+    }
+}
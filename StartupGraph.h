@@ -0,0 +1,74 @@
+// GameOverlay - StartupGraph.h
+// Startup phases as a small dependency graph, overlapped across the main thread and workers
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "JobSystem.h"
+
+// Each phase names the phases it needs and where it may run: main-thread phases (window, swap
+// chain, ImGui's Win32 backend, anything CEF) run in the order they were added on the thread
+// calling Run, each once its dependencies are done; worker phases are submitted to JobSystem (high
+// priority, performance workers) as soon as theirs are. So a worker phase overlaps whatever the
+// main thread does next.
+// A phase that throws stops new phases from starting; Run waits for the running ones and
+// rethrows the first exception. Phase times are in ms since the origin (the start of WinMain).
+class StartupGraph {
+public:
+    enum class Affinity { MainThread, Worker };
+    using PhaseId = size_t;
+
+    struct PhaseTiming {
+        std::string name;
+        bool mainThread = true;
+        double startMs = 0.0;
+        double durationMs = 0.0;
+    };
+
+    explicit StartupGraph(std::chrono::steady_clock::time_point origin);
+    ~StartupGraph();
+
+    // Disable copy and move
+    StartupGraph(const StartupGraph&) = delete;
+    StartupGraph& operator=(const StartupGraph&) = delete;
+    StartupGraph(StartupGraph&&) = delete;
+    StartupGraph& operator=(StartupGraph&&) = delete;
+
+    // Dependencies must have been added before
+    PhaseId Add(const char* name, Affinity affinity, std::vector<PhaseId> dependencies, std::function<void()> work);
+    void Run();
+
+    // In the order the phases finished; complete after Run
+    const std::vector<PhaseTiming>& GetTimings() const { return m_timings; }
+    void LogTimings() const; // To the debugger output, one line per phase
+
+private:
+    enum class State { Waiting, Running, Done };
+
+    struct Phase {
+        std::string name;
+        Affinity affinity = Affinity::MainThread;
+        std::vector<PhaseId> dependencies;
+        std::function<void()> work;
+        State state = State::Waiting;
+    };
+
+    bool IsReadyLocked(const Phase& phase) const;
+    void Execute(PhaseId id); // Runs the work and records its timing, on either kind of thread
+    void WaitForWorkers();
+
+    std::chrono::steady_clock::time_point m_origin;
+    std::vector<Phase> m_phases;
+    JobCounter m_workerJobs;
+    std::vector<PhaseTiming> m_timings;
+    std::exception_ptr m_failure;
+    size_t m_donePhases = 0;
+    std::mutex m_mutex;
+    std::condition_variable m_phaseDone;
+};
@@ -0,0 +1,223 @@
+// GameOverlay - TabThumbnailCache.cpp
+// BC1-compressed last frames of the tabs that gave up the browser texture
+
+#include "TabThumbnailCache.h"
+#include "RenderSystem.h"
+#include "PipelineStateManager.h"
+#include "Log.h"
+#include "WidgetCache.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+TabThumbnailCache::TabThumbnailCache(RenderSystem* renderSystem)
+    : m_renderSystem(renderSystem), m_resourceManager(renderSystem->GetResourceManager()) {
+}
+
+TabThumbnailCache::~TabThumbnailCache() {
+    Clear();
+    if (m_blockBuffer && m_resourceManager) m_resourceManager->RetireResource(std::move(m_blockBuffer));
+}
+
+bool TabThumbnailCache::EnsureBlockBuffer() {
+    if (m_blockBuffer) return true;
+    try {
+        m_blockBuffer = m_resourceManager->CreateBuffer(static_cast<UINT64>(BLOCK_ROW_PITCH) * (MAX_HEIGHT / 4),
+            D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+        if (!m_blockBuffer) throw std::runtime_error("CreateBuffer failed");
+        m_blockBuffer->SetName(L"Tab Thumbnail Blocks");
+    }
+    catch (const std::exception& e) {
+        LOG_WARNING("Failed to create the tab thumbnail encoder buffer: %s", e.what());
+        m_encoderFailed = true;
+        return false;
+    }
+    return true;
+}
+
+void TabThumbnailCache::RecordCapture(ID3D12GraphicsCommandList* commandList, ID3D12Resource* source,
+    float contentU, float contentV) {
+    const int tabId = m_pendingTabId;
+    m_pendingTabId = 0;
+    if (tabId == 0 || !commandList || !source || !m_resourceManager || m_encoderFailed) return;
+
+    PipelineStateManager* pipelineStateManager = m_renderSystem->GetPipelineStateManager();
+    if (!pipelineStateManager) return;
+    ID3D12RootSignature* rootSignature = pipelineStateManager->GetThumbnailEncodeRootSignature();
+    ID3D12PipelineState* pipelineState = pipelineStateManager->GetThumbnailEncodePipelineState();
+    if (!rootSignature || !pipelineState) {
+        m_encoderFailed = true;
+        return;
+    }
+    if (!EnsureBlockBuffer()) return;
+
+    // The painted part, scaled down to fit and rounded to whole 4x4 blocks (the aspect moves by a
+    // pixel at most, and the texture has no padding to leave out when sampled)
+    const D3D12_RESOURCE_DESC sourceDesc = source->GetDesc();
+    const float contentWidth = static_cast<float>(sourceDesc.Width) * contentU;
+    const float contentHeight = static_cast<float>(sourceDesc.Height) * contentV;
+    if (contentWidth < 4.0f || contentHeight < 4.0f) return;
+    const float scale = std::min({ MAX_WIDTH / contentWidth, MAX_HEIGHT / contentHeight, 1.0f });
+    const UINT width = std::clamp(static_cast<UINT>(contentWidth * scale + 2.0f) & ~3u, 4u, MAX_WIDTH);
+    const UINT height = std::clamp(static_cast<UINT>(contentHeight * scale + 2.0f) & ~3u, 4u, MAX_HEIGHT);
+    const UINT blocksX = width / 4;
+    const UINT blocksY = height / 4;
+
+    // The tab's previous thumbnail is reused when the size matches; otherwise it, or the oldest
+    // one when the cache is full, makes room
+    auto it = std::find_if(m_thumbnails.begin(), m_thumbnails.end(),
+        [tabId](const Thumbnail& thumbnail) { return thumbnail.tabId == tabId; });
+    if (it != m_thumbnails.end() && it->width == width && it->height == height) {
+        m_resourceManager->QueueTransition(it->texture.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+    }
+    else {
+        if (it != m_thumbnails.end()) {
+            Release(*it);
+            m_thumbnails.erase(it);
+        }
+        else if (m_thumbnails.size() >= MAX_THUMBNAILS) {
+            auto oldest = std::min_element(m_thumbnails.begin(), m_thumbnails.end(),
+                [](const Thumbnail& a, const Thumbnail& b) { return a.captureTime < b.captureTime; });
+            Release(*oldest);
+            m_thumbnails.erase(oldest);
+        }
+
+        Thumbnail thumbnail;
+        thumbnail.tabId = tabId;
+        try {
+            thumbnail.texture = m_resourceManager->CreateTexture2D(blocksX * 4, blocksY * 4, DXGI_FORMAT_BC1_UNORM,
+                D3D12_RESOURCE_FLAG_NONE, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COPY_DEST);
+            if (!thumbnail.texture) throw std::runtime_error("CreateTexture2D failed");
+            thumbnail.texture->SetName(L"Tab Thumbnail");
+            thumbnail.srv = m_resourceManager->CreateShaderResourceView(thumbnail.texture.Get());
+        }
+        catch (const std::exception& e) {
+            LOG_WARNING("Failed to create a tab thumbnail: %s", e.what());
+            if (thumbnail.texture) m_resourceManager->RetireResource(std::move(thumbnail.texture));
+            return;
+        }
+        thumbnail.bytes = static_cast<UINT64>(blocksX) * blocksY * 8;
+        m_thumbnails.push_back(std::move(thumbnail));
+        it = m_thumbnails.end() - 1;
+    }
+    it->width = width;
+    it->height = height;
+    it->captureTime = std::chrono::steady_clock::now();
+
+    // Idle between captures, so a hidden overlay's trim may have evicted it
+    m_resourceManager->NotifyResourceUsed(m_blockBuffer.Get());
+
+    // Copy-queue uploads need the browser texture back in COMMON, so it returns to where it was
+    const D3D12_RESOURCE_STATES sourceState = m_resourceManager->GetResourceState(source);
+    m_resourceManager->QueueTransition(source,
+        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+    m_resourceManager->QueueTransition(m_blockBuffer.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    m_resourceManager->FlushBarriers(commandList);
+
+    // t0 source with its whole mip chain, u0 the block buffer
+    ID3D12Device* device = m_renderSystem->GetDevice();
+    const UINT descriptorSize = m_resourceManager->GetDescriptorSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    ResourceDescriptor table = m_resourceManager->AllocateTransientDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 2);
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC sourceView = {};
+    sourceView.Format = sourceDesc.Format;
+    sourceView.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    sourceView.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    sourceView.Texture2D.MipLevels = sourceDesc.MipLevels;
+    device->CreateShaderResourceView(source, &sourceView, table.cpuHandle);
+
+    D3D12_UNORDERED_ACCESS_VIEW_DESC blockView = {};
+    blockView.Format = DXGI_FORMAT_R32_TYPELESS;
+    blockView.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+    blockView.Buffer.NumElements = static_cast<UINT>(m_blockBuffer->GetDesc().Width / 4);
+    blockView.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+    D3D12_CPU_DESCRIPTOR_HANDLE blockHandle = table.cpuHandle;
+    blockHandle.ptr += descriptorSize;
+    device->CreateUnorderedAccessView(m_blockBuffer.Get(), nullptr, &blockView, blockHandle);
+
+    // Taps are half a thumbnail texel apart; the mip whose texels match that spacing is read
+    const float sourceTexelsPerTexel = contentWidth / static_cast<float>(width);
+    ThumbnailEncodeConstants constants = {};
+    constants.texelToUv[0] = contentU / static_cast<float>(width);
+    constants.texelToUv[1] = contentV / static_cast<float>(height);
+    constants.uvMax[0] = contentU - 0.5f / static_cast<float>(sourceDesc.Width);
+    constants.uvMax[1] = contentV - 0.5f / static_cast<float>(sourceDesc.Height);
+    constants.blockCount[0] = blocksX;
+    constants.blockCount[1] = blocksY;
+    constants.rowPitch = BLOCK_ROW_PITCH;
+    constants.sourceLod = std::max(std::log2(sourceTexelsPerTexel * 0.5f), 0.0f);
+
+    commandList->SetComputeRootSignature(rootSignature);
+    commandList->SetPipelineState(pipelineState);
+    commandList->SetComputeRootDescriptorTable(0, table.gpuHandle);
+    commandList->SetComputeRoot32BitConstants(1, sizeof(ThumbnailEncodeConstants) / sizeof(UINT), &constants, 0);
+    commandList->Dispatch((blocksX + 7) / 8, (blocksY + 7) / 8, 1);
+
+    m_resourceManager->QueueTransition(m_blockBuffer.Get(), D3D12_RESOURCE_STATE_COPY_SOURCE);
+    m_resourceManager->FlushBarriers(commandList);
+
+    D3D12_TEXTURE_COPY_LOCATION destination = {};
+    destination.pResource = it->texture.Get();
+    destination.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    destination.SubresourceIndex = 0;
+    D3D12_TEXTURE_COPY_LOCATION blocks = {};
+    blocks.pResource = m_blockBuffer.Get();
+    blocks.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    blocks.PlacedFootprint.Offset = 0;
+    blocks.PlacedFootprint.Footprint.Format = DXGI_FORMAT_BC1_UNORM;
+    blocks.PlacedFootprint.Footprint.Width = blocksX * 4;
+    blocks.PlacedFootprint.Footprint.Height = blocksY * 4;
+    blocks.PlacedFootprint.Footprint.Depth = 1;
+    blocks.PlacedFootprint.Footprint.RowPitch = BLOCK_ROW_PITCH;
+    commandList->CopyTextureRegion(&destination, 0, 0, 0, &blocks, nullptr);
+
+    // Flushed before ImGui samples them
+    m_resourceManager->QueueTransition(it->texture.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    m_resourceManager->QueueTransition(source, sourceState);
+    m_captures++;
+}
+
+bool TabThumbnailCache::GetThumbnail(int tabId, D3D12_GPU_DESCRIPTOR_HANDLE& texture, UINT& width, UINT& height) const {
+    for (const Thumbnail& thumbnail : m_thumbnails) {
+        if (thumbnail.tabId != tabId) continue;
+        m_resourceManager->NotifyResourceUsed(thumbnail.texture.Get());
+        texture = thumbnail.srv.gpuHandle;
+        width = thumbnail.width;
+        height = thumbnail.height;
+        return true;
+    }
+    return false;
+}
+
+void TabThumbnailCache::Forget(int tabId) {
+    if (m_pendingTabId == tabId) m_pendingTabId = 0;
+    auto it = std::find_if(m_thumbnails.begin(), m_thumbnails.end(),
+        [tabId](const Thumbnail& thumbnail) { return thumbnail.tabId == tabId; });
+    if (it == m_thumbnails.end()) return;
+    Release(*it);
+    m_thumbnails.erase(it);
+}
+
+void TabThumbnailCache::Clear() {
+    m_pendingTabId = 0;
+    for (Thumbnail& thumbnail : m_thumbnails) Release(thumbnail);
+    m_thumbnails.clear();
+}
+
+void TabThumbnailCache::Release(Thumbnail& thumbnail) {
+    if (!thumbnail.texture || !m_resourceManager) return;
+    // Frames in flight may still sample it
+    ResourceDescriptor srv = thumbnail.srv;
+    ResourceManager* resourceManager = m_resourceManager;
+    WidgetCache::ReleaseTexture(static_cast<ImTextureID>(srv.gpuHandle.ptr)); // Cached panels may still draw it
+    m_resourceManager->RetireResource(std::move(thumbnail.texture),
+        [resourceManager, srv]() { resourceManager->FreeDescriptor(srv); });
+}
+
+TabThumbnailCache::Stats TabThumbnailCache::GetStats() const {
+    Stats stats;
+    stats.thumbnails = static_cast<UINT>(m_thumbnails.size());
+    for (const Thumbnail& thumbnail : m_thumbnails) stats.bytes += thumbnail.bytes;
+    stats.captures = m_captures;
+    return stats;
+}
@@ -0,0 +1,87 @@
+// GameOverlay - TabThumbnailCache.h
+// BC1-compressed last frames of the tabs that gave up the browser texture
+
+#pragma once
+
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "ResourceManager.h" // ResourceDescriptor
+
+// Forward declarations
+class RenderSystem;
+
+using Microsoft::WRL::ComPtr;
+
+// Only the active tab has a browser texture; a hidden or discarded tab keeps nothing to show. When
+// a tab hands over the texture its last frame is downsampled to at most MAX_WIDTH x MAX_HEIGHT and
+// encoded into BC1 blocks on the GPU (4 bits a texel, an eighth of RGBA), so the tab bar can show
+// it and the view has something of the tab to show while its browser repaints or is recreated.
+//
+// Everything runs on the main thread: RequestCapture when the active tab changes, RecordCapture on
+// the next frame's direct command list before the browser paint copies, which would overwrite it.
+class TabThumbnailCache {
+public:
+    static constexpr UINT MAX_WIDTH = 512;
+    static constexpr UINT MAX_HEIGHT = 512;
+    static constexpr size_t MAX_THUMBNAILS = 16; // The least recently captured goes first
+
+    struct Stats {
+        UINT thumbnails = 0;
+        UINT64 bytes = 0;        // BC1 texture memory
+        UINT64 captures = 0;     // Since startup
+    };
+
+    TabThumbnailCache(RenderSystem* renderSystem);
+    ~TabThumbnailCache();
+
+    // Disable copy and move
+    TabThumbnailCache(const TabThumbnailCache&) = delete;
+    TabThumbnailCache& operator=(const TabThumbnailCache&) = delete;
+    TabThumbnailCache(TabThumbnailCache&&) = delete;
+    TabThumbnailCache& operator=(TabThumbnailCache&&) = delete;
+
+    // The browser texture holds tabId's frame until the next RecordCapture
+    void RequestCapture(int tabId) { m_pendingTabId = tabId; }
+    bool HasPendingCapture() const { return m_pendingTabId != 0; }
+    // source is the browser texture (tracked); contentU/V is its painted part. Its transition back to
+    // the state it was in is queued. A request that can't be met is dropped.
+    void RecordCapture(ID3D12GraphicsCommandList* commandList, ID3D12Resource* source, float contentU, float contentV);
+
+    // False when the tab has none; width and height are the thumbnail's, for its aspect
+    bool GetThumbnail(int tabId, D3D12_GPU_DESCRIPTOR_HANDLE& texture, UINT& width, UINT& height) const;
+    void Forget(int tabId); // Tab closed
+    void Clear();
+
+    Stats GetStats() const;
+
+private:
+    struct Thumbnail {
+        int tabId = 0;
+        ComPtr<ID3D12Resource> texture;
+        ResourceDescriptor srv;
+        UINT width = 0;  // Multiples of 4 (whole blocks)
+        UINT height = 0;
+        UINT64 bytes = 0;
+        std::chrono::steady_clock::time_point captureTime;
+    };
+
+    bool EnsureBlockBuffer();
+    void Release(Thumbnail& thumbnail);
+
+    // Resource pointers (not owned)
+    RenderSystem* m_renderSystem = nullptr;
+    ResourceManager* m_resourceManager = nullptr;
+
+    int m_pendingTabId = 0;
+    std::vector<Thumbnail> m_thumbnails;
+
+    // Encoder output, copied into each thumbnail's BC1 texture; sized for the largest thumbnail
+    static constexpr UINT BLOCK_ROW_PITCH = (MAX_WIDTH / 4) * 8; // A multiple of the 256-byte copy pitch
+    ComPtr<ID3D12Resource> m_blockBuffer;
+    bool m_encoderFailed = false;
+
+    UINT64 m_captures = 0;
+};
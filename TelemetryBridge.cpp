@@ -0,0 +1,112 @@
+// GameOverlay - TelemetryBridge.cpp
+// Batched native-to-page telemetry for web widgets
+
+#include "TelemetryBridge.h"
+#include "cef_shared_process_message_builder.h"
+#include "cef_values.h"
+#include <cstring>
+
+int TelemetryBridge::RegisterKey(const std::string& key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_keyIndices.find(key);
+    if (it != m_keyIndices.end()) return it->second;
+
+    int index = static_cast<int>(m_keys.size());
+    m_keyIndices.emplace(key, index);
+    m_keys.push_back(key);
+    m_values.push_back(0.0);
+    m_keyGeneration++;
+    return index;
+}
+
+void TelemetryBridge::SetValue(const std::string& key, double value) {
+    SetValue(RegisterKey(key), value);
+}
+
+void TelemetryBridge::SetValue(int index, double value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (index < 0 || index >= static_cast<int>(m_values.size())) return;
+    if (m_values[index] != value) {
+        m_values[index] = value;
+        m_valuesDirty = true;
+    }
+}
+
+bool TelemetryBridge::Flush(CefRefPtr<CefBrowser> browser) {
+    if (!browser) return false;
+    CefRefPtr<CefFrame> frame = browser->GetMainFrame();
+    if (!frame || !frame->IsValid()) return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_values.empty()) return false;
+
+    // A new target (tab switch, recreated browser) or new keys: names first, then every value
+    if (m_keysSentBrowserId != browser->GetIdentifier() || m_keysSentGeneration != m_keyGeneration) {
+        SendKeys(frame);
+        m_keysSentBrowserId = browser->GetIdentifier();
+        m_keysSentGeneration = m_keyGeneration;
+        m_valuesDirty = true;
+    }
+    if (!m_valuesDirty) return false;
+
+    // One shared-memory message for all values; the renderer maps it instead of parsing it
+    size_t valuesSize = m_values.size() * sizeof(double);
+    CefRefPtr<CefSharedProcessMessageBuilder> builder =
+        CefSharedProcessMessageBuilder::Create(VALUES_MESSAGE, sizeof(ValuesHeader) + valuesSize);
+    if (!builder || !builder->IsValid()) {
+        OutputDebugStringA("Warning: Failed to create telemetry shared memory.\n");
+        return false;
+    }
+
+    uint8_t* memory = static_cast<uint8_t*>(builder->Memory());
+    ValuesHeader header;
+    header.count = static_cast<uint32_t>(m_values.size());
+    header.keyGeneration = m_keyGeneration;
+    header.sequence = ++m_sequence;
+    memcpy(memory, &header, sizeof(header));
+    memcpy(memory + sizeof(header), m_values.data(), valuesSize);
+
+    frame->SendProcessMessage(PID_RENDERER, builder->Build());
+    m_valuesDirty = false;
+    return true;
+}
+
+void TelemetryBridge::SendKeys(CefRefPtr<CefFrame> frame) {
+    CefRefPtr<CefProcessMessage> message = CefProcessMessage::Create(KEYS_MESSAGE);
+    CefRefPtr<CefListValue> args = message->GetArgumentList();
+    args->SetInt(0, static_cast<int>(m_keyGeneration));
+    CefRefPtr<CefListValue> keys = CefListValue::Create();
+    keys->SetSize(m_keys.size());
+    for (size_t i = 0; i < m_keys.size(); i++) {
+        keys->SetString(i, m_keys[i]);
+    }
+    args->SetList(1, keys);
+    frame->SendProcessMessage(PID_RENDERER, message);
+}
+
+void TelemetryBridge::SetMessageCallback(MessageCallback callback) {
+    std::lock_guard<std::mutex> lock(m_callbackMutex);
+    m_messageCallback = std::move(callback);
+}
+
+bool TelemetryBridge::HandleProcessMessage(CefRefPtr<CefProcessMessage> message) {
+    if (!message) return false;
+
+    if (message->GetName() == KEYS_REQUEST_MESSAGE) {
+        // The next Flush resends the names and every value
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_keysSentBrowserId = -1;
+        return true;
+    }
+    if (message->GetName() != SEND_MESSAGE) return false;
+
+    CefRefPtr<CefListValue> args = message->GetArgumentList();
+    std::string name = args->GetString(0).ToString();
+    std::string text = args->GetString(1).ToString();
+
+    std::lock_guard<std::mutex> lock(m_callbackMutex);
+    if (m_messageCallback) {
+        m_messageCallback(name, text);
+    }
+    return true;
+}
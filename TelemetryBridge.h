@@ -0,0 +1,78 @@
+// GameOverlay - TelemetryBridge.h
+// Batched native-to-page telemetry for web widgets
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+#include "cef_browser.h"
+#include "cef_process_message.h"
+
+// Values (game stats, overlay FPS, timers) are set by key from any thread and sent to the page
+// at most once per Flush as one shared-memory process message holding a flat array of doubles,
+// instead of a JSON string per value. Key names only travel when the key set changes or another
+// browser becomes the target.
+//
+// Page side (see BrowserApp): gameoverlay.ontelemetry = function(values, keys) { ... } receives a
+// Float64Array and the matching key names; gameoverlay.sendMessage(name, message) goes the other
+// way and arrives through the message callback.
+class TelemetryBridge {
+public:
+    // Process message names shared with the renderer side
+    static constexpr const char* KEYS_MESSAGE = "gameoverlay.telemetryKeys";
+    static constexpr const char* VALUES_MESSAGE = "gameoverlay.telemetry";
+    static constexpr const char* KEYS_REQUEST_MESSAGE = "gameoverlay.telemetryKeysRequest"; // New page context
+    static constexpr const char* SEND_MESSAGE = "gameoverlay.sendMessage";
+
+    // Start of the shared memory region; count doubles follow
+    struct ValuesHeader {
+        uint32_t count = 0;
+        uint32_t keyGeneration = 0; // Values match the key list of this generation
+        uint64_t sequence = 0;
+    };
+
+    TelemetryBridge() = default;
+    ~TelemetryBridge() = default;
+
+    // Disable copy and move
+    TelemetryBridge(const TelemetryBridge&) = delete;
+    TelemetryBridge& operator=(const TelemetryBridge&) = delete;
+    TelemetryBridge(TelemetryBridge&&) = delete;
+    TelemetryBridge& operator=(TelemetryBridge&&) = delete;
+
+    // --- Values (thread-safe) ---
+    int RegisterKey(const std::string& key); // Index for SetValue(int), stable for the session
+    void SetValue(const std::string& key, double value);
+    void SetValue(int index, double value);
+
+    // Sends pending values to the browser's main frame; false if nothing was sent
+    bool Flush(CefRefPtr<CefBrowser> browser);
+
+    // --- Page messages ---
+    using MessageCallback = std::function<void(const std::string& name, const std::string& message)>;
+    void SetMessageCallback(MessageCallback callback);
+    // Browser process: handles messages from the renderer side, true if consumed
+    bool HandleProcessMessage(CefRefPtr<CefProcessMessage> message);
+
+private:
+    void SendKeys(CefRefPtr<CefFrame> frame); // Caller holds m_mutex
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, int> m_keyIndices;
+    std::vector<std::string> m_keys;
+    std::vector<double> m_values;
+    bool m_valuesDirty = false;
+    uint32_t m_keyGeneration = 0;
+
+    // What the current target has already received
+    int m_keysSentBrowserId = -1;
+    uint32_t m_keysSentGeneration = 0;
+    uint64_t m_sequence = 0;
+
+    std::mutex m_callbackMutex;
+    MessageCallback m_messageCallback;
+};
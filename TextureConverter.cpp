@@ -0,0 +1,177 @@
+// GameOverlay - TextureConverter.cpp
+// Compute conversion of BGRA frames into mipmapped RGBA textures
+
+#include "TextureConverter.h"
+#include "RenderSystem.h"
+#include <algorithm>
+
+UINT16 TextureConverter::GetMipCount(UINT width, UINT height) {
+    UINT size = std::max(width, height);
+    UINT16 levels = 1;
+    while (size > 1) {
+        size >>= 1;
+        levels++;
+    }
+    return levels;
+}
+
+TextureConverter::TextureConverter(RenderSystem* renderSystem)
+    : m_renderSystem(renderSystem), m_resourceManager(renderSystem->GetResourceManager()) {
+}
+
+bool TextureConverter::IsAvailable() {
+    PipelineStateManager* pipelineStateManager = m_renderSystem->GetPipelineStateManager();
+    return pipelineStateManager && pipelineStateManager->GetTextureConvertRootSignature() &&
+        pipelineStateManager->GetTextureConvertPipelineState();
+}
+
+bool TextureConverter::ConvertBuffer(ID3D12GraphicsCommandList* commandList, ID3D12Resource* source, UINT rowPitch,
+    const RECT& region, ID3D12Resource* target, UINT flags) {
+    if (!source) return false;
+    return Convert(commandList, source, rowPitch, nullptr, &region, 1, target, flags);
+}
+
+bool TextureConverter::ConvertBuffer(ID3D12GraphicsCommandList* commandList, ID3D12Resource* source, UINT rowPitch,
+    const std::vector<RECT>& regions, ID3D12Resource* target, UINT flags) {
+    if (!source) return false;
+    return Convert(commandList, source, rowPitch, nullptr, regions.data(), regions.size(), target, flags);
+}
+
+bool TextureConverter::ConvertTexture(ID3D12GraphicsCommandList* commandList, ID3D12Resource* source,
+    const RECT& region, ID3D12Resource* target, UINT flags) {
+    if (!source) return false;
+    return Convert(commandList, nullptr, 0, source, &region, 1, target, flags);
+}
+
+bool TextureConverter::Convert(ID3D12GraphicsCommandList* commandList, ID3D12Resource* sourceBuffer, UINT rowPitch,
+    ID3D12Resource* sourceTexture, const RECT* regions, size_t regionCount, ID3D12Resource* target, UINT flags) {
+    PipelineStateManager* pipelineStateManager = m_renderSystem->GetPipelineStateManager();
+    if (!commandList || !target || !pipelineStateManager) return false;
+    ID3D12RootSignature* rootSignature = pipelineStateManager->GetTextureConvertRootSignature();
+    ID3D12PipelineState* pipelineState = pipelineStateManager->GetTextureConvertPipelineState();
+    if (!rootSignature || !pipelineState) return false;
+
+    D3D12_RESOURCE_DESC targetDesc = target->GetDesc();
+    const UINT width = static_cast<UINT>(targetDesc.Width);
+    const UINT height = targetDesc.Height;
+    const UINT mipLevels = targetDesc.MipLevels;
+
+    // Changed texels in mip 0, per region
+    UINT sourceWidth = width;
+    UINT sourceHeight = height;
+    if (sourceTexture) {
+        // CEF's texture follows the browser size, which can lag a resize by a frame
+        D3D12_RESOURCE_DESC sourceDesc = sourceTexture->GetDesc();
+        sourceWidth = std::min(width, static_cast<UINT>(sourceDesc.Width));
+        sourceHeight = std::min(height, sourceDesc.Height);
+    }
+    struct Region {
+        UINT left, top, right, bottom;
+    };
+    std::vector<Region> clipped;
+    clipped.reserve(regionCount);
+    for (size_t i = 0; i < regionCount; i++) {
+        const RECT& region = regions[i];
+        Region texels = {
+            static_cast<UINT>(std::max<LONG>(region.left, 0)),
+            static_cast<UINT>(std::max<LONG>(region.top, 0)),
+            std::min(static_cast<UINT>(std::max<LONG>(region.right, 0)), sourceWidth),
+            std::min(static_cast<UINT>(std::max<LONG>(region.bottom, 0)), sourceHeight)
+        };
+        if (texels.left < texels.right && texels.top < texels.bottom) clipped.push_back(texels);
+    }
+    if (clipped.empty()) return true;
+
+    ID3D12Device* device = m_renderSystem->GetDevice();
+    const UINT descriptorSize = m_resourceManager->GetDescriptorSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    m_resourceManager->QueueTransition(target, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    m_resourceManager->FlushBarriers(commandList);
+    if (sourceTexture) {
+        D3D12_RESOURCE_BARRIER barrier = ResourceManager::TransitionBarrier(sourceTexture,
+            D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+        commandList->ResourceBarrier(1, &barrier);
+    }
+
+    commandList->SetComputeRootSignature(rootSignature);
+    commandList->SetPipelineState(pipelineState);
+
+    // Pass 0 reads the frame and writes levels 0-4; each later pass reads the last level written
+    for (UINT sourceLevel = 0; sourceLevel < mipLevels; sourceLevel += LEVELS_PER_PASS) {
+        const bool firstPass = sourceLevel == 0;
+        const UINT levelsAfter = std::min(LEVELS_PER_PASS, mipLevels - 1 - sourceLevel);
+        if (!firstPass) {
+            if (levelsAfter == 0) break;
+            m_resourceManager->QueueTransition(target, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, sourceLevel);
+            m_resourceManager->FlushBarriers(commandList);
+        }
+
+        // t0 buffer, t1 texture, u0-u4 levels; unused slots get null views
+        ResourceDescriptor table = m_resourceManager->AllocateTransientDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 7);
+        auto slot = [&table, descriptorSize](UINT index) {
+            D3D12_CPU_DESCRIPTOR_HANDLE handle = table.cpuHandle;
+            handle.ptr += static_cast<SIZE_T>(index) * descriptorSize;
+            return handle;
+        };
+
+        ID3D12Resource* bufferView = firstPass ? sourceBuffer : nullptr;
+        D3D12_SHADER_RESOURCE_VIEW_DESC bufferDesc = {};
+        bufferDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+        bufferDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+        bufferDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        bufferDesc.Buffer.NumElements = bufferView ? static_cast<UINT>(bufferView->GetDesc().Width / 4) : 1;
+        bufferDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_RAW;
+        device->CreateShaderResourceView(bufferView, &bufferDesc, slot(0));
+
+        ID3D12Resource* textureView = firstPass ? sourceTexture : target;
+        D3D12_SHADER_RESOURCE_VIEW_DESC textureDesc = {};
+        textureDesc.Format = firstPass && sourceTexture ? sourceTexture->GetDesc().Format : TARGET_FORMAT;
+        textureDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+        textureDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        textureDesc.Texture2D.MostDetailedMip = sourceLevel;
+        textureDesc.Texture2D.MipLevels = 1;
+        device->CreateShaderResourceView(textureView, &textureDesc, slot(1));
+
+        for (UINT i = 0; i <= LEVELS_PER_PASS; i++) {
+            bool written = i == 0 ? firstPass : i <= levelsAfter;
+            D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+            uavDesc.Format = TARGET_FORMAT;
+            uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+            uavDesc.Texture2D.MipSlice = written ? sourceLevel + i : 0;
+            device->CreateUnorderedAccessView(written ? target : nullptr, nullptr, &uavDesc, slot(2 + i));
+        }
+
+        TextureConvertConstants constants = {};
+        constants.sourceSize[0] = std::max(width >> sourceLevel, 1u);
+        constants.sourceSize[1] = std::max(height >> sourceLevel, 1u);
+        constants.rowPitch = rowPitch;
+        constants.mipCount = levelsAfter;
+        constants.flags = firstPass ?
+            flags | TextureConvertWriteFirst | (sourceBuffer ? TextureConvertBufferSource : 0) :
+            flags & TextureConvertLinearMips; // Already premultiplied
+        commandList->SetComputeRootDescriptorTable(0, table.gpuHandle);
+
+        // Each changed region in this pass's source level, widened to whole tiles. Tiles shared by two
+        // regions are written twice with the same texels, so the dispatches need no barrier between them
+        for (const Region& region : clipped) {
+            UINT levelLeft = (region.left >> sourceLevel) & ~(TILE_SIZE - 1);
+            UINT levelTop = (region.top >> sourceLevel) & ~(TILE_SIZE - 1);
+            UINT levelRight = ((region.right - 1) >> sourceLevel) + 1;
+            UINT levelBottom = ((region.bottom - 1) >> sourceLevel) + 1;
+            constants.origin[0] = levelLeft;
+            constants.origin[1] = levelTop;
+            commandList->SetComputeRoot32BitConstants(1, sizeof(TextureConvertConstants) / sizeof(UINT), &constants, 0);
+            commandList->Dispatch((levelRight - levelLeft + TILE_SIZE - 1) / TILE_SIZE,
+                (levelBottom - levelTop + TILE_SIZE - 1) / TILE_SIZE, 1);
+        }
+    }
+
+    if (sourceTexture) {
+        D3D12_RESOURCE_BARRIER barrier = ResourceManager::TransitionBarrier(sourceTexture,
+            D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COMMON);
+        commandList->ResourceBarrier(1, &barrier);
+    }
+    // Flushed before ImGui samples it
+    m_resourceManager->QueueTransition(target, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    return true;
+}
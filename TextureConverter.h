@@ -0,0 +1,65 @@
+// GameOverlay - TextureConverter.h
+// Compute conversion of BGRA frames into mipmapped RGBA textures
+
+#pragma once
+
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <vector>
+#include "PipelineStateManager.h"
+#include "ResourceManager.h"
+
+// Forward declarations
+class RenderSystem;
+
+using Microsoft::WRL::ComPtr;
+
+// Writes a BGRA frame (a raw upload buffer or a texture) into mip 0 of an RGBA texture and rebuilds
+// the mips over the changed region, optionally premultiplying alpha and averaging in linear light.
+// Each dispatch converts 16x16 texel tiles and writes four mip levels from group shared memory;
+// textures with more levels get one small dispatch per further four, reading the last level written.
+// A view shown smaller than the texture then samples a filtered level instead of aliasing.
+class TextureConverter {
+public:
+    // Targets must be created with these (and any number of mips, see GetMipCount)
+    static constexpr DXGI_FORMAT TARGET_FORMAT = DXGI_FORMAT_R8G8B8A8_UNORM;
+    static constexpr D3D12_RESOURCE_FLAGS TARGET_FLAGS = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+    static UINT16 GetMipCount(UINT width, UINT height); // Full chain down to 1x1
+
+    TextureConverter(RenderSystem* renderSystem);
+    ~TextureConverter() = default;
+
+    // Disable copy and move
+    TextureConverter(const TextureConverter&) = delete;
+    TextureConverter& operator=(const TextureConverter&) = delete;
+    TextureConverter(TextureConverter&&) = delete;
+    TextureConverter& operator=(TextureConverter&&) = delete;
+
+    // False until the pipeline manager is set, or when the pipeline failed to build
+    bool IsAvailable();
+
+    // Record on the frame's direct command list. region is in source pixels (clipped to the target);
+    // flags are TextureConvertPremultiply and TextureConvertLinearMips. The target must be tracked by
+    // the ResourceManager; it is queued back to PIXEL_SHADER_RESOURCE.
+    // Source is an upload-heap buffer with rows rowPitch bytes apart
+    bool ConvertBuffer(ID3D12GraphicsCommandList* commandList, ID3D12Resource* source, UINT rowPitch,
+                       const RECT& region, ID3D12Resource* target, UINT flags);
+    // One dispatch per region and pass, so the space between disjoint regions isn't converted
+    bool ConvertBuffer(ID3D12GraphicsCommandList* commandList, ID3D12Resource* source, UINT rowPitch,
+                       const std::vector<RECT>& regions, ID3D12Resource* target, UINT flags);
+    // Source is a BGRA texture in the COMMON state (e.g. a shared texture), left in COMMON
+    bool ConvertTexture(ID3D12GraphicsCommandList* commandList, ID3D12Resource* source,
+                        const RECT& region, ID3D12Resource* target, UINT flags);
+
+private:
+    static constexpr UINT TILE_SIZE = 16;       // Texels per group side (numthreads)
+    static constexpr UINT LEVELS_PER_PASS = 4;  // Mips written by one dispatch after its source level
+
+    bool Convert(ID3D12GraphicsCommandList* commandList, ID3D12Resource* sourceBuffer, UINT rowPitch,
+                 ID3D12Resource* sourceTexture, const RECT* regions, size_t regionCount, ID3D12Resource* target,
+                 UINT flags);
+
+    // Resource pointers (not owned)
+    RenderSystem* m_renderSystem = nullptr;
+    ResourceManager* m_resourceManager = nullptr;
+};
@@ -0,0 +1,380 @@
+// GameOverlay - TextureLoader.cpp
+// Asynchronous image decode and GPU texture cache for UI images
+
+#include "TextureLoader.h"
+#include "JobSystem.h"
+#include "Log.h"
+#include "RenderSystem.h"
+#include "CpuProfiler.h"
+#include "WidgetCache.h"
+#include <algorithm>
+#include <cstring>
+
+#pragma comment(lib, "windowscodecs.lib")
+
+TextureLoader::TextureLoader(RenderSystem* renderSystem)
+    : m_renderSystem(renderSystem) {
+    if (!m_renderSystem || !m_renderSystem->GetResourceManager()) {
+        throw std::runtime_error("TextureLoader requires a valid RenderSystem.");
+    }
+    m_resourceManager = m_renderSystem->GetResourceManager();
+}
+
+TextureLoader::~TextureLoader() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true; // Queued decodes return without decoding
+    }
+    m_decodeJobs.Wait();
+
+    // Frames in flight may still sample them
+    for (auto& entry : m_images) {
+        ReleaseImageTexture(*entry.second);
+    }
+    if (m_placeholderTexture) {
+        ResourceDescriptor srv = m_placeholderSrv;
+        ResourceManager* resourceManager = m_resourceManager;
+        WidgetCache::ReleaseTexture(static_cast<ImTextureID>(srv.gpuHandle.ptr));
+        m_resourceManager->RetireResource(std::move(m_placeholderTexture),
+            [resourceManager, srv]() { resourceManager->FreeDescriptor(srv); });
+    }
+}
+
+// --- Images ---
+
+D3D12_GPU_DESCRIPTOR_HANDLE TextureLoader::GetImage(const std::string& path, UINT maxSize) {
+    return RequestImage(path, {}, maxSize);
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE TextureLoader::GetImage(const std::string& key, std::vector<uint8_t> encodedData,
+    UINT maxSize) {
+    return RequestImage(key, std::move(encodedData), maxSize);
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE TextureLoader::RequestImage(const std::string& key, std::vector<uint8_t> encodedData,
+    UINT maxSize) {
+    D3D12_GPU_DESCRIPTOR_HANDLE placeholder = { m_placeholderHandle.load(std::memory_order_acquire) };
+    if (key.empty()) return placeholder;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto it = m_images.find(key);
+    if (it != m_images.end()) {
+        Image& image = *it->second;
+        if (image.state != ImageState::Ready) return placeholder;
+
+        // Drawn this frame: most recently used
+        image.lastUsedFrame = m_frame;
+        m_lru.splice(m_lru.begin(), m_lru, image.lruPosition);
+        m_resourceManager->NotifyResourceUsed(image.texture.Get()); // Paged back in if evicted
+        return image.srv.gpuHandle;
+    }
+
+    auto image = std::make_unique<Image>();
+    image->key = key;
+    image->encodedData = std::move(encodedData);
+    image->maxSize = maxSize;
+    Image* queued = image.get();
+    m_images.emplace(key, std::move(image));
+    lock.unlock();
+
+    // Decoding is background work; the UI and render threads come first
+    JobDesc job;
+    job.name = "Decode Image";
+    job.jobClass = JobClass::Efficiency;
+    job.counter = &m_decodeJobs;
+    JobSystem::Get().Submit(job, [this, queued]() { DecodeJob(queued); });
+    return placeholder;
+}
+
+bool TextureLoader::IsImageReady(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_images.find(key);
+    return it != m_images.end() && it->second->state == ImageState::Ready;
+}
+
+bool TextureLoader::IsImageFailed(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_images.find(key);
+    return it != m_images.end() && it->second->state == ImageState::Failed;
+}
+
+// --- Decode Jobs ---
+
+void TextureLoader::DecodeJob(Image* image) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping) return;
+        image->state = ImageState::Decoding;
+    }
+
+    // WIC's factory is free threaded: one for every job, created by the first
+    std::call_once(m_factoryOnce, [this]() {
+        if (FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&m_factory)))) {
+            LOG_WARNING("WIC imaging factory unavailable, images won't load");
+        }
+    });
+    bool decoded = m_factory && DecodeImage(m_factory.Get(), *image);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    image->encodedData.clear();
+    image->encodedData.shrink_to_fit();
+    if (decoded) {
+        image->state = ImageState::Decoded;
+        m_uploadQueue.push_back(image);
+    }
+    else {
+        image->state = ImageState::Failed;
+        LOG_WARNING("Failed to decode image: %s", image->key);
+    }
+}
+
+bool TextureLoader::DecodeImage(IWICImagingFactory* factory, Image& image) {
+    ComPtr<IWICBitmapDecoder> decoder;
+    HRESULT hr = E_FAIL;
+    if (!image.encodedData.empty()) {
+        ComPtr<IWICStream> stream;
+        hr = factory->CreateStream(&stream);
+        if (SUCCEEDED(hr)) {
+            hr = stream->InitializeFromMemory(image.encodedData.data(), static_cast<DWORD>(image.encodedData.size()));
+        }
+        if (SUCCEEDED(hr)) {
+            hr = factory->CreateDecoderFromStream(stream.Get(), nullptr, WICDecodeMetadataCacheOnDemand, &decoder);
+        }
+    }
+    else {
+        int length = MultiByteToWideChar(CP_UTF8, 0, image.key.c_str(), -1, nullptr, 0);
+        if (length <= 0) return false;
+        std::wstring path(static_cast<size_t>(length), L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, image.key.c_str(), -1, path.data(), length);
+        hr = factory->CreateDecoderFromFilename(path.c_str(), nullptr, GENERIC_READ,
+            WICDecodeMetadataCacheOnDemand, &decoder);
+    }
+    if (FAILED(hr)) return false;
+
+    ComPtr<IWICBitmapFrameDecode> frame;
+    if (FAILED(decoder->GetFrame(0, &frame))) return false;
+
+    UINT width = 0;
+    UINT height = 0;
+    if (FAILED(frame->GetSize(&width, &height)) || width == 0 || height == 0) return false;
+
+    // Scale down before converting so the conversion touches fewer pixels
+    ComPtr<IWICBitmapSource> source = frame;
+    if (image.maxSize > 0 && std::max(width, height) > image.maxSize) {
+        float scale = static_cast<float>(image.maxSize) / static_cast<float>(std::max(width, height));
+        UINT scaledWidth = std::max(1u, static_cast<UINT>(width * scale));
+        UINT scaledHeight = std::max(1u, static_cast<UINT>(height * scale));
+
+        ComPtr<IWICBitmapScaler> scaler;
+        if (SUCCEEDED(factory->CreateBitmapScaler(&scaler)) &&
+            SUCCEEDED(scaler->Initialize(source.Get(), scaledWidth, scaledHeight, WICBitmapInterpolationModeFant))) {
+            source = scaler;
+            width = scaledWidth;
+            height = scaledHeight;
+        }
+    }
+
+    // Straight-alpha BGRA, as ImGui blends
+    ComPtr<IWICFormatConverter> converter;
+    if (FAILED(factory->CreateFormatConverter(&converter)) ||
+        FAILED(converter->Initialize(source.Get(), GUID_WICPixelFormat32bppBGRA, WICBitmapDitherTypeNone,
+            nullptr, 0.0, WICBitmapPaletteTypeCustom))) {
+        return false;
+    }
+
+    UINT stride = width * 4;
+    image.pixels.resize(static_cast<size_t>(stride) * height);
+    if (FAILED(converter->CopyPixels(nullptr, stride, static_cast<UINT>(image.pixels.size()), image.pixels.data()))) {
+        image.pixels.clear();
+        return false;
+    }
+    image.width = width;
+    image.height = height;
+    return true;
+}
+
+// --- Uploads ---
+
+// Copies tightly packed BGRA pixels into mip 0 of texture through the upload ring
+static void RecordTextureUpload(ResourceManager* resourceManager, ID3D12GraphicsCommandList* commandList,
+    ID3D12Resource* texture, const uint8_t* pixels, UINT width, UINT height) {
+    UINT64 srcPitch = static_cast<UINT64>(width) * 4;
+    UINT64 rowPitch = (srcPitch + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) & ~static_cast<UINT64>(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1);
+    UploadAllocation upload = resourceManager->AllocateUpload(rowPitch * height, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+    uint8_t* dst = static_cast<uint8_t*>(upload.cpuAddress);
+    for (UINT y = 0; y < height; y++) {
+        memcpy(dst + y * rowPitch, pixels + y * srcPitch, static_cast<size_t>(srcPitch));
+    }
+
+    D3D12_TEXTURE_COPY_LOCATION srcLocation = {};
+    srcLocation.pResource = upload.buffer;
+    srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    srcLocation.PlacedFootprint.Offset = upload.offset;
+    srcLocation.PlacedFootprint.Footprint.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    srcLocation.PlacedFootprint.Footprint.Width = width;
+    srcLocation.PlacedFootprint.Footprint.Height = height;
+    srcLocation.PlacedFootprint.Footprint.Depth = 1;
+    srcLocation.PlacedFootprint.Footprint.RowPitch = static_cast<UINT>(rowPitch);
+
+    D3D12_TEXTURE_COPY_LOCATION dstLocation = {};
+    dstLocation.pResource = texture;
+    dstLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    dstLocation.SubresourceIndex = 0;
+
+    commandList->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, nullptr);
+}
+
+void TextureLoader::ProcessUploads(ID3D12GraphicsCommandList* commandList) {
+    if (!commandList) return;
+
+    std::vector<Image*> uploads;
+    bool needPlaceholder = !m_placeholderTexture;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_frame++;
+
+        // Within the frame's budget, but always at least one so large images still get through
+        UINT64 budget = 0;
+        const UINT64 budgetLimit = m_uploadBytesPerFrame;
+        while (!m_uploadQueue.empty() && (uploads.empty() || budget < budgetLimit)) {
+            Image* image = m_uploadQueue.front();
+            m_uploadQueue.pop_front();
+            budget += image->pixels.size();
+            uploads.push_back(image);
+        }
+    }
+    if (uploads.empty() && !needPlaceholder) return;
+
+    // On the copy queue the COMMON textures are promoted implicitly and decay back afterwards
+    ID3D12GraphicsCommandList* copyList = m_renderSystem->BeginCopyCommands();
+    const bool onCopyQueue = copyList != nullptr;
+    if (!onCopyQueue) {
+        copyList = commandList;
+    }
+
+    if (needPlaceholder) {
+        CreatePlaceholder(copyList, onCopyQueue);
+    }
+
+    std::vector<bool> uploaded(uploads.size());
+    for (size_t i = 0; i < uploads.size(); i++) {
+        uploaded[i] = UploadImage(copyList, onCopyQueue, *uploads[i]);
+    }
+
+    if (onCopyQueue) {
+        m_renderSystem->SubmitCopyCommands();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < uploads.size(); i++) {
+        Image& image = *uploads[i];
+        image.pixels.clear();
+        image.pixels.shrink_to_fit();
+        if (!uploaded[i]) {
+            image.state = ImageState::Failed;
+            continue;
+        }
+        image.state = ImageState::Ready;
+        image.lastUsedFrame = m_frame;
+        m_lru.push_front(&image);
+        image.lruPosition = m_lru.begin();
+        m_cacheBytes += image.gpuBytes;
+    }
+    EvictImages();
+}
+
+bool TextureLoader::UploadImage(ID3D12GraphicsCommandList* copyList, bool onCopyQueue, Image& image) {
+    try {
+        image.texture = m_resourceManager->CreateTexture2D(image.width, image.height, DXGI_FORMAT_B8G8R8A8_UNORM);
+        if (!image.texture) return false;
+        image.texture->SetName(L"TextureLoader Image");
+        image.srv = m_resourceManager->CreateShaderResourceView(image.texture.Get());
+    }
+    catch (const std::exception& e) {
+        LOG_WARNING("Failed to create image texture: %s", e.what());
+        image.texture.Reset();
+        return false;
+    }
+    image.gpuBytes = image.pixels.size();
+
+    if (!onCopyQueue) {
+        m_resourceManager->TransitionResource(copyList, image.texture.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+    }
+    RecordTextureUpload(m_resourceManager, copyList, image.texture.Get(), image.pixels.data(), image.width, image.height);
+    if (!onCopyQueue) {
+        // Flushed before ImGui draws
+        m_resourceManager->QueueTransition(image.texture.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    }
+    return true;
+}
+
+bool TextureLoader::CreatePlaceholder(ID3D12GraphicsCommandList* copyList, bool onCopyQueue) {
+    // Faint grey square, drawn until the image arrives
+    constexpr UINT SIZE = 4;
+    uint8_t pixels[SIZE * SIZE * 4];
+    for (UINT i = 0; i < SIZE * SIZE; i++) {
+        pixels[i * 4 + 0] = 128;
+        pixels[i * 4 + 1] = 128;
+        pixels[i * 4 + 2] = 128;
+        pixels[i * 4 + 3] = 96;
+    }
+
+    try {
+        m_placeholderTexture = m_resourceManager->CreateTexture2D(SIZE, SIZE, DXGI_FORMAT_B8G8R8A8_UNORM);
+        if (!m_placeholderTexture) return false;
+        m_placeholderTexture->SetName(L"TextureLoader Placeholder");
+        m_placeholderSrv = m_resourceManager->CreateShaderResourceView(m_placeholderTexture.Get());
+        m_resourceManager->PinResource(m_placeholderTexture.Get(), true);
+    }
+    catch (const std::exception& e) {
+        LOG_WARNING("Failed to create image placeholder: %s", e.what());
+        m_placeholderTexture.Reset();
+        return false;
+    }
+
+    if (!onCopyQueue) {
+        m_resourceManager->TransitionResource(copyList, m_placeholderTexture.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+    }
+    RecordTextureUpload(m_resourceManager, copyList, m_placeholderTexture.Get(), pixels, SIZE, SIZE);
+    if (!onCopyQueue) {
+        m_resourceManager->QueueTransition(m_placeholderTexture.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    }
+    m_placeholderHandle.store(m_placeholderSrv.gpuHandle.ptr, std::memory_order_release);
+    return true;
+}
+
+// --- Cache ---
+
+void TextureLoader::EvictImages() {
+    // Least recently drawn first; nothing drawn this frame is evicted
+    while (m_cacheBytes > m_cacheLimit && !m_lru.empty()) {
+        Image* image = m_lru.back();
+        if (image->lastUsedFrame >= m_frame) break;
+        m_lru.pop_back();
+        m_cacheBytes -= image->gpuBytes;
+        ReleaseImageTexture(*image);
+        m_images.erase(image->key); // Requested again later, it simply reloads
+    }
+}
+
+void TextureLoader::ReleaseImageTexture(Image& image) {
+    if (!image.texture) return;
+    ResourceDescriptor srv = image.srv;
+    ResourceManager* resourceManager = m_resourceManager;
+    WidgetCache::ReleaseTexture(static_cast<ImTextureID>(srv.gpuHandle.ptr)); // Cached panels may still draw it
+    m_resourceManager->RetireResource(std::move(image.texture),
+        [resourceManager, srv]() { resourceManager->FreeDescriptor(srv); });
+    image.srv = {};
+}
+
+void TextureLoader::SetCacheLimit(size_t maxBytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cacheLimit = maxBytes;
+    EvictImages();
+}
+
+size_t TextureLoader::GetCacheMemoryUsage() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cacheBytes;
+}
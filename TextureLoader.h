@@ -0,0 +1,130 @@
+// GameOverlay - TextureLoader.h
+// Asynchronous image decode and GPU texture cache for UI images
+
+#pragma once
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <wincodec.h>
+#include <wrl/client.h>
+#include <string>
+#include <vector>
+#include <list>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
+#include "ResourceManager.h"
+#include "JobSystem.h"
+
+// Forward declarations
+class RenderSystem;
+
+using Microsoft::WRL::ComPtr;
+
+// Icons, favicons and thumbnails for the UI pages. GetImage never blocks: it returns the
+// placeholder right away and queues the image's decode (WIC) as a job on the efficiency workers.
+// ProcessUploads copies decoded images into textures on the copy queue (through the upload ring)
+// a few per frame, so a page full of images fills in over several frames instead of stalling one.
+// Textures stay cached until the cache limit evicts the least recently drawn ones.
+class TextureLoader {
+public:
+    static constexpr UINT DEFAULT_MAX_SIZE = 256;           // Longest side UI images are scaled to
+    static constexpr UINT64 UPLOAD_BYTES_PER_FRAME = 4ull * 1024 * 1024;
+    static constexpr size_t DEFAULT_CACHE_LIMIT = 64 * 1024 * 1024;
+
+    explicit TextureLoader(RenderSystem* renderSystem);
+    ~TextureLoader();
+
+    // Disable copy and move
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+    TextureLoader(TextureLoader&&) = delete;
+    TextureLoader& operator=(TextureLoader&&) = delete;
+
+    // --- Images (UI thread) ---
+    // Shader-visible SRV for the image file at path (anything WIC decodes: PNG, JPEG, ICO, BMP, GIF),
+    // the placeholder until it is uploaded, or a null handle before the placeholder exists.
+    // Images larger than maxSize are scaled down; 0 keeps the decoded size.
+    D3D12_GPU_DESCRIPTOR_HANDLE GetImage(const std::string& path, UINT maxSize = DEFAULT_MAX_SIZE);
+    // Same for encoded bytes already in memory (e.g. a favicon from the browser), cached under key
+    D3D12_GPU_DESCRIPTOR_HANDLE GetImage(const std::string& key, std::vector<uint8_t> encodedData,
+                                         UINT maxSize = DEFAULT_MAX_SIZE);
+    bool IsImageReady(const std::string& key) const;
+    bool IsImageFailed(const std::string& key) const; // Decode failed; the placeholder stays
+    // For images that come from elsewhere (tab thumbnails) while they don't exist; null before it does
+    D3D12_GPU_DESCRIPTOR_HANDLE GetPlaceholder() const { return { m_placeholderHandle.load(std::memory_order_acquire) }; }
+
+    // --- Uploads (render thread, once per frame) ---
+    // Records pending uploads on the copy queue, or on commandList without one
+    void ProcessUploads(ID3D12GraphicsCommandList* commandList);
+    // Bytes uploaded per frame (at least one image either way); lowered while yielding the GPU
+    void SetUploadBytesPerFrame(UINT64 bytes) { m_uploadBytesPerFrame = bytes; }
+
+    // --- Cache ---
+    void SetCacheLimit(size_t maxBytes);
+    size_t GetCacheMemoryUsage() const;
+
+private:
+    enum class ImageState {
+        Queued,   // Decode job waiting for a worker
+        Decoding,
+        Decoded,  // Pixels waiting for upload
+        Ready,
+        Failed
+    };
+
+    struct Image {
+        std::string key;
+        ImageState state = ImageState::Queued;
+        std::vector<uint8_t> encodedData; // In-memory source; empty when key is a file path
+        UINT maxSize = 0;
+
+        // Decoded BGRA pixels, tightly packed (freed after upload)
+        std::vector<uint8_t> pixels;
+        UINT width = 0;
+        UINT height = 0;
+
+        ComPtr<ID3D12Resource> texture;
+        ResourceDescriptor srv;
+        size_t gpuBytes = 0;
+        UINT64 lastUsedFrame = 0;
+        std::list<Image*>::iterator lruPosition; // Ready images only; front is most recent
+    };
+
+    D3D12_GPU_DESCRIPTOR_HANDLE RequestImage(const std::string& key, std::vector<uint8_t> encodedData, UINT maxSize);
+    void DecodeJob(Image* image);
+    static bool DecodeImage(IWICImagingFactory* factory, Image& image);
+    bool UploadImage(ID3D12GraphicsCommandList* copyList, bool onCopyQueue, Image& image);
+    bool CreatePlaceholder(ID3D12GraphicsCommandList* copyList, bool onCopyQueue);
+    void EvictImages(); // Caller holds m_mutex
+    void ReleaseImageTexture(Image& image);
+
+    // Resource pointers (not owned)
+    RenderSystem* m_renderSystem = nullptr;
+    ResourceManager* m_resourceManager = nullptr;
+
+    // Images by key; m_mutex guards the map, the upload queue and image state (decode jobs only
+    // touch the pixels of an image they hold in the Decoding state)
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::unique_ptr<Image>> m_images;
+    std::list<Image*> m_lru;
+    std::deque<Image*> m_uploadQueue;
+    size_t m_cacheBytes = 0;
+    size_t m_cacheLimit = DEFAULT_CACHE_LIMIT;
+    std::atomic<UINT64> m_uploadBytesPerFrame = UPLOAD_BYTES_PER_FRAME;
+    UINT64 m_frame = 0;
+
+    // Placeholder shown until an image is ready (uploaded with the first ProcessUploads)
+    ComPtr<ID3D12Resource> m_placeholderTexture;
+    ResourceDescriptor m_placeholderSrv;
+    std::atomic<UINT64> m_placeholderHandle{ 0 };
+
+    // Decode jobs
+    JobCounter m_decodeJobs;
+    std::once_flag m_factoryOnce;
+    ComPtr<IWICImagingFactory> m_factory;
+    bool m_stopping = false;
+};
@@ -0,0 +1,133 @@
+// GameOverlay - ThreadCycles.cpp
+// Per-thread CPU cycle accounting, grouped by the subsystem each overlay thread works for
+
+#include "ThreadCycles.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+constexpr size_t SUBSYSTEM_COUNT = static_cast<size_t>(ThreadSubsystem::Count);
+
+struct ThreadEntry {
+    HANDLE thread = nullptr;
+    ThreadSubsystem subsystem = ThreadSubsystem::Other;
+    // Cycles scopes charged elsewhere; written only by the thread itself
+    std::array<std::atomic<uint64_t>, SUBSYSTEM_COUNT> charged = {};
+};
+
+std::mutex g_mutex;
+std::vector<std::unique_ptr<ThreadEntry>> g_threads;
+ThreadCycles::Totals g_exitedTotals = {}; // Of threads found exited
+
+thread_local ThreadEntry* t_entry = nullptr;
+thread_local ThreadCycleScope* t_scope = nullptr;
+
+uint64_t GetCurrentThreadCycles() {
+    ULONG64 cycles = 0;
+    QueryThreadCycleTime(GetCurrentThread(), &cycles);
+    return cycles;
+}
+
+// One thread's cycles split by subsystem, added to totals
+void AddThreadCycles(ThreadEntry& entry, uint64_t cycles, ThreadCycles::Totals& totals) {
+    uint64_t charged = 0;
+    for (size_t i = 0; i < SUBSYSTEM_COUNT; i++) {
+        const uint64_t value = entry.charged[i].load(std::memory_order_relaxed);
+        totals[i] += value;
+        charged += value;
+    }
+    totals[static_cast<size_t>(entry.subsystem)] += cycles > charged ? cycles - charged : 0;
+}
+
+} // namespace
+
+const char* GetThreadSubsystemName(ThreadSubsystem subsystem) {
+    switch (subsystem) {
+    case ThreadSubsystem::Render: return "Render";
+    case ThreadSubsystem::UI: return "UI";
+    case ThreadSubsystem::Browser: return "Browser";
+    case ThreadSubsystem::Input: return "Input";
+    case ThreadSubsystem::Jobs: return "Jobs";
+    case ThreadSubsystem::Optimizer: return "Optimizer";
+    case ThreadSubsystem::Telemetry: return "Telemetry";
+    case ThreadSubsystem::Logging: return "Logging";
+    case ThreadSubsystem::Storage: return "Storage";
+    case ThreadSubsystem::Other: return "Other";
+    default: return "Unknown";
+    }
+}
+
+void ThreadCycles::RegisterThread(ThreadSubsystem subsystem) {
+    if (t_entry) return;
+
+    auto entry = std::make_unique<ThreadEntry>();
+    entry->subsystem = subsystem;
+    if (!DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &entry->thread,
+            THREAD_QUERY_LIMITED_INFORMATION | SYNCHRONIZE, FALSE, 0)) {
+        return;
+    }
+
+    t_entry = entry.get();
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_threads.push_back(std::move(entry));
+}
+
+void ThreadCycles::GetTotals(Totals& totals, std::array<UINT, SUBSYSTEM_COUNT>& threads) {
+    threads.fill(0);
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    totals = g_exitedTotals;
+    for (size_t i = 0; i < g_threads.size();) {
+        ThreadEntry& entry = *g_threads[i];
+        ULONG64 cycles = 0;
+        QueryThreadCycleTime(entry.thread, &cycles);
+
+        // An exited thread's count is final: fold it in once and let the handle go
+        if (WaitForSingleObject(entry.thread, 0) == WAIT_OBJECT_0) {
+            AddThreadCycles(entry, cycles, g_exitedTotals);
+            AddThreadCycles(entry, cycles, totals);
+            CloseHandle(entry.thread);
+            g_threads[i] = std::move(g_threads.back());
+            g_threads.pop_back();
+            continue;
+        }
+
+        AddThreadCycles(entry, cycles, totals);
+        threads[static_cast<size_t>(entry.subsystem)]++;
+        i++;
+    }
+
+    // The rest of the process: CEF's browser process threads, the driver's, the thread pool
+    ULONG64 processCycles = 0;
+    if (QueryProcessCycleTime(GetCurrentProcess(), &processCycles)) {
+        uint64_t registered = 0;
+        for (uint64_t value : totals) registered += value;
+        uint64_t& other = totals[static_cast<size_t>(ThreadSubsystem::Other)];
+        other += processCycles > registered ? processCycles - registered : 0;
+    }
+}
+
+ThreadCycleScope::ThreadCycleScope(ThreadSubsystem subsystem)
+    : m_subsystem(subsystem) {
+    if (!t_entry) return;
+    m_active = true;
+    m_parent = t_scope;
+    t_scope = this;
+    m_beginCycles = GetCurrentThreadCycles();
+}
+
+ThreadCycleScope::~ThreadCycleScope() {
+    if (!m_active) return;
+    const uint64_t elapsed = GetCurrentThreadCycles() - m_beginCycles;
+    const uint64_t own = elapsed > m_nestedCycles ? elapsed - m_nestedCycles : 0;
+
+    // The thread's own subsystem keeps whatever no scope claimed
+    if (m_subsystem != t_entry->subsystem) {
+        t_entry->charged[static_cast<size_t>(m_subsystem)].fetch_add(own, std::memory_order_relaxed);
+    }
+    if (m_parent) m_parent->m_nestedCycles += elapsed;
+    t_scope = m_parent;
+}
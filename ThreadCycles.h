@@ -0,0 +1,62 @@
+// GameOverlay - ThreadCycles.h
+// Per-thread CPU cycle accounting, grouped by the subsystem each overlay thread works for
+
+#pragma once
+
+#include <Windows.h>
+#include <array>
+#include <cstdint>
+
+// Who the cycles went to. A thread is registered under one subsystem; a ThreadCycleScope charges
+// a stretch of it to another (the main loop pumps the browser, runs the UI and renders).
+enum class ThreadSubsystem {
+    Render,    // Main loop: frame preparation, recording, present
+    UI,        // ImGui pages and draw lists
+    Browser,   // CEF pump, paint copies, browser callbacks on overlay threads
+    Input,     // Window messages and the raw input thread
+    Jobs,      // Job system and startup workers
+    Optimizer, // Performance optimizer worker
+    Telemetry, // Counter sampling threads, page telemetry
+    Logging,   // Log and trace writers
+    Storage,   // Settings writer
+    Other,     // Threads the overlay didn't register (CEF's own, the graphics driver's)
+    Count
+};
+
+const char* GetThreadSubsystemName(ThreadSubsystem subsystem);
+
+// QueryThreadCycleTime per registered thread; reading the totals is a syscall per thread, so
+// PerformanceMonitor samples them about once a second. Cycles count while a thread runs on a
+// core (at the reference rate, not the boosted clock) and not while it waits.
+class ThreadCycles {
+public:
+    using Totals = std::array<uint64_t, static_cast<size_t>(ThreadSubsystem::Count)>;
+
+    // The calling thread, once, near its start; it stays counted after it exits
+    static void RegisterThread(ThreadSubsystem subsystem);
+
+    // Cycles of every registered thread since it registered, by subsystem, with Other the rest
+    // of the process (QueryProcessCycleTime). Threads found exited are folded into the totals.
+    static void GetTotals(Totals& totals, std::array<UINT, static_cast<size_t>(ThreadSubsystem::Count)>& threads);
+};
+
+// Charges the calling registered thread's cycles over its lifetime to a subsystem; nested
+// scopes take their share from the enclosing one. Costs two QueryThreadCycleTime calls.
+class ThreadCycleScope {
+public:
+    explicit ThreadCycleScope(ThreadSubsystem subsystem);
+    ~ThreadCycleScope();
+
+    // Disable copy and move
+    ThreadCycleScope(const ThreadCycleScope&) = delete;
+    ThreadCycleScope& operator=(const ThreadCycleScope&) = delete;
+    ThreadCycleScope(ThreadCycleScope&&) = delete;
+    ThreadCycleScope& operator=(ThreadCycleScope&&) = delete;
+
+private:
+    ThreadSubsystem m_subsystem;
+    ThreadCycleScope* m_parent = nullptr;
+    uint64_t m_beginCycles = 0;
+    uint64_t m_nestedCycles = 0; // Charged by scopes inside this one
+    bool m_active = false;
+};
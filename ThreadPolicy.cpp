@@ -0,0 +1,77 @@
+// GameOverlay - ThreadPolicy.cpp
+// Scheduling policy for the overlay's own threads and process: priority, placement and power throttling
+
+#include "ThreadPolicy.h"
+#include <algorithm>
+#include <cstdint>
+
+void ConfigureWorkerThread() {
+    ConfigureWorkerThread(GetCurrentThread());
+}
+
+void ConfigureWorkerThread(HANDLE thread) {
+    SetThreadPriority(thread, THREAD_PRIORITY_BELOW_NORMAL);
+    SetThreadEcoQoS(thread, true);
+    PlaceThreadOnEfficiencyCores(thread);
+}
+
+static std::vector<ULONG> EnumerateEfficiencyCpuSets() {
+    ULONG length = 0;
+    GetSystemCpuSetInformation(nullptr, 0, &length, GetCurrentProcess(), 0);
+    if (length == 0) return {};
+    std::vector<uint8_t> buffer(length);
+    auto* first = reinterpret_cast<PSYSTEM_CPU_SET_INFORMATION>(buffer.data());
+    if (!GetSystemCpuSetInformation(first, length, &length, GetCurrentProcess(), 0)) return {};
+
+    // Entries are variable length; EfficiencyClass is 0 for the most efficient cores
+    struct CpuSet { ULONG id; BYTE efficiencyClass; };
+    std::vector<CpuSet> cpuSets;
+    for (ULONG offset = 0; offset < length;) {
+        auto* info = reinterpret_cast<PSYSTEM_CPU_SET_INFORMATION>(buffer.data() + offset);
+        if (info->Size == 0) break;
+        if (info->Type == CpuSetInformation) {
+            cpuSets.push_back({ info->CpuSet.Id, info->CpuSet.EfficiencyClass });
+        }
+        offset += info->Size;
+    }
+    if (cpuSets.empty()) return {};
+
+    auto [minIt, maxIt] = std::minmax_element(cpuSets.begin(), cpuSets.end(),
+        [](const CpuSet& a, const CpuSet& b) { return a.efficiencyClass < b.efficiencyClass; });
+    if (minIt->efficiencyClass == maxIt->efficiencyClass) return {}; // Not hybrid
+
+    std::vector<ULONG> efficiencyIds;
+    for (const CpuSet& cpuSet : cpuSets) {
+        if (cpuSet.efficiencyClass == minIt->efficiencyClass) {
+            efficiencyIds.push_back(cpuSet.id);
+        }
+    }
+    return efficiencyIds;
+}
+
+const std::vector<ULONG>& GetEfficiencyCpuSets() {
+    static const std::vector<ULONG> cpuSets = EnumerateEfficiencyCpuSets();
+    return cpuSets;
+}
+
+bool PlaceThreadOnEfficiencyCores(HANDLE thread) {
+    const std::vector<ULONG>& cpuSets = GetEfficiencyCpuSets();
+    if (cpuSets.empty()) return false;
+    return SetThreadSelectedCpuSets(thread, cpuSets.data(), static_cast<ULONG>(cpuSets.size())) != FALSE;
+}
+
+bool SetThreadEcoQoS(HANDLE thread, bool eco) {
+    THREAD_POWER_THROTTLING_STATE state = {};
+    state.Version = THREAD_POWER_THROTTLING_CURRENT_VERSION;
+    state.ControlMask = THREAD_POWER_THROTTLING_EXECUTION_SPEED;
+    state.StateMask = eco ? THREAD_POWER_THROTTLING_EXECUTION_SPEED : 0;
+    return SetThreadInformation(thread, ThreadPowerThrottling, &state, sizeof(state)) != FALSE;
+}
+
+bool SetProcessEcoQoS(bool eco) {
+    PROCESS_POWER_THROTTLING_STATE state = {};
+    state.Version = PROCESS_POWER_THROTTLING_CURRENT_VERSION;
+    state.ControlMask = PROCESS_POWER_THROTTLING_EXECUTION_SPEED;
+    state.StateMask = eco ? PROCESS_POWER_THROTTLING_EXECUTION_SPEED : 0;
+    return SetProcessInformation(GetCurrentProcess(), ProcessPowerThrottling, &state, sizeof(state)) != FALSE;
+}
@@ -0,0 +1,25 @@
+// GameOverlay - ThreadPolicy.h
+// Scheduling policy for the overlay's own threads and process: priority, placement and power throttling
+
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+
+// Background workers (image decode, counter sampling, file writing): below normal priority,
+// EcoQoS, and on hybrid CPUs the efficiency cores, so the game keeps the performance cores.
+// The first overload is called on the thread itself.
+void ConfigureWorkerThread();
+void ConfigureWorkerThread(HANDLE thread);
+
+// CPU set ids of the lowest efficiency class on hybrid CPUs (E-cores on Intel 12th gen and
+// later); empty when every core is of one class, and then threads are left where they are.
+// Enumerated once, on first use.
+const std::vector<ULONG>& GetEfficiencyCpuSets();
+bool PlaceThreadOnEfficiencyCores(HANDLE thread);
+
+// EcoQoS (execution speed throttling) on or explicitly off; off keeps a thread at full speed
+// even while its process is throttled. False where the OS has no power throttling (before
+// Windows 10 1709); callers carry on unthrottled.
+bool SetThreadEcoQoS(HANDLE thread, bool eco);
+bool SetProcessEcoQoS(bool eco);
@@ -0,0 +1,157 @@
+// GameOverlay - TraceCapture.cpp
+// Writes the recent profiler history to a Chrome trace file for stutter triage
+
+#include "TraceCapture.h"
+#include "Log.h"
+#include "FileUtil.h"
+#include <fstream>
+#include <cstdio>
+
+namespace {
+
+void WriteJsonString(std::ofstream& file, const char* text) {
+    file.put('"');
+    for (const char* c = text ? text : ""; *c; c++) {
+        switch (*c) {
+        case '"': file << "\\\""; break;
+        case '\\': file << "\\\\"; break;
+        case '\n': file << "\\n"; break;
+        default:
+            if (static_cast<unsigned char>(*c) < 0x20) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(*c));
+                file << escaped;
+            }
+            else {
+                file.put(*c);
+            }
+        }
+    }
+    file.put('"');
+}
+
+} // namespace
+
+TraceCapture::TraceCapture() {
+    if (!IsAvailable()) return;
+    CpuProfiler::SetEnabled(CpuProfilerClient::TraceCapture, true);
+}
+
+TraceCapture::~TraceCapture() {
+    CpuProfiler::SetEnabled(CpuProfilerClient::TraceCapture, false);
+    m_writeJobs.Wait(); // A capture in progress is finished
+}
+
+bool TraceCapture::RequestCapture(float seconds) {
+    if (!IsAvailable()) return false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_pendingCaptures >= MAX_PENDING_CAPTURES) return false;
+    }
+
+    // Copied now (a few milliseconds at most); formatting and disk I/O happen in the job
+    auto capture = std::make_shared<PendingCapture>();
+    int64_t endTicks = CpuProfiler::GetTicks();
+    int64_t beginTicks = endTicks - static_cast<int64_t>(seconds * 1000.0 * CpuProfiler::GetTicksPerMs());
+    CpuProfiler::CaptureRange(beginTicks, endTicks, capture->profile);
+    capture->path = MakeTracePath();
+    if (capture->path.empty()) {
+        LOG_WARNING("No profile directory for trace capture");
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingCaptures++;
+    }
+    JobDesc job;
+    job.name = "Write Trace";
+    job.priority = JobPriority::Low;
+    job.jobClass = JobClass::Efficiency;
+    job.counter = &m_writeJobs;
+    JobSystem::Get().Submit(job, [this, capture]() { WriteCapture(*capture); });
+    return true;
+}
+
+std::string TraceCapture::GetLastTracePath() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastTracePath;
+}
+
+bool TraceCapture::IsWriting() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pendingCaptures > 0;
+}
+
+void TraceCapture::WriteCapture(const PendingCapture& capture) {
+    bool written = WriteChromeTrace(capture.profile, capture.path);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pendingCaptures--;
+    if (written) {
+        m_lastTracePath = capture.path;
+        LOG_INFO("Trace written: %s", capture.path);
+    }
+    else {
+        LOG_WARNING("Failed to write trace file");
+    }
+}
+
+bool TraceCapture::WriteChromeTrace(const CpuProfileFrame& profile, const std::string& path) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) return false;
+
+    // Timestamps in microseconds from the start of the capture; lanes without a thread (GPU)
+    // get ids past any real thread id
+    const double ticksPerUs = profile.ticksPerMs / 1000.0;
+    auto toUs = [&](int64_t ticks) { return static_cast<double>(ticks - profile.beginTicks) / ticksPerUs; };
+    const DWORD processId = GetCurrentProcessId();
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    uint32_t virtualThreadId = 0xFFFF0000u;
+    for (const CpuProfileThread& thread : profile.threads) {
+        uint32_t threadId = thread.threadId ? thread.threadId : virtualThreadId++;
+
+        file << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << processId
+             << ",\"tid\":" << threadId << ",\"args\":{\"name\":";
+        WriteJsonString(file, thread.name.c_str());
+        file << "}}";
+        first = false;
+
+        char number[64];
+        for (const CpuProfileZoneRecord& zone : thread.zones) {
+            file << ",\n{\"name\":";
+            WriteJsonString(file, zone.name);
+            if (zone.type == CpuProfileRecordType::Instant) {
+                snprintf(number, sizeof(number), "%.3f", toUs(zone.beginTicks));
+                file << ",\"cat\":\"event\",\"ph\":\"i\",\"s\":\"t\",\"ts\":" << number;
+            }
+            else {
+                snprintf(number, sizeof(number), "%.3f", toUs(zone.beginTicks));
+                file << ",\"cat\":\"" << (thread.threadId ? "cpu" : "gpu") << "\",\"ph\":\"X\",\"ts\":" << number;
+                snprintf(number, sizeof(number), "%.3f", static_cast<double>(zone.endTicks - zone.beginTicks) / ticksPerUs);
+                file << ",\"dur\":" << number;
+            }
+            file << ",\"pid\":" << processId << ",\"tid\":" << threadId << "}";
+        }
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
+
+std::string TraceCapture::MakeTracePath(const char* prefix) {
+    std::string directory = GetAppDataDirectory();
+    if (directory.empty()) {
+        return std::string();
+    }
+    directory += "\\Traces";
+    CreateDirectoryA(directory.c_str(), nullptr);
+
+    SYSTEMTIME time;
+    GetLocalTime(&time);
+    char name[64];
+    snprintf(name, sizeof(name), "\\%s-%04u%02u%02u-%02u%02u%02u-%03u.json", prefix, time.wYear, time.wMonth, time.wDay,
+        time.wHour, time.wMinute, time.wSecond, time.wMilliseconds);
+    return directory + name;
+}
@@ -0,0 +1,55 @@
+// GameOverlay - TraceCapture.h
+// Writes the recent profiler history to a Chrome trace file for stutter triage
+
+#pragma once
+
+#include <Windows.h>
+#include <string>
+#include <memory>
+#include <mutex>
+#include "CpuProfiler.h"
+#include "JobSystem.h"
+
+// Keeps the profiler recording so a capture can reach back before the key press. RequestCapture
+// copies the last seconds of every lane (CPU zones, GPU passes, paint, state and resource events)
+// and a low priority job writes them as Chrome Trace Event JSON, which chrome://tracing and
+// ui.perfetto.dev both open. Files go to %LOCALAPPDATA%\GameOverlay\Traces.
+class TraceCapture {
+public:
+    static constexpr float DEFAULT_SECONDS = 10.0f;
+    static constexpr size_t MAX_PENDING_CAPTURES = 2;
+
+    TraceCapture();
+    ~TraceCapture();
+
+    // Disable copy and move
+    TraceCapture(const TraceCapture&) = delete;
+    TraceCapture& operator=(const TraceCapture&) = delete;
+    TraceCapture(TraceCapture&&) = delete;
+    TraceCapture& operator=(TraceCapture&&) = delete;
+
+    bool IsAvailable() const { return CpuProfiler::IsCompiledIn(); }
+
+    // Any thread; false when compiled out or too many captures are still being written
+    bool RequestCapture(float seconds = DEFAULT_SECONDS);
+
+    std::string GetLastTracePath() const;
+    bool IsWriting() const;
+
+    // Also used to export hitch snapshots; the path is empty without %LOCALAPPDATA%
+    static bool WriteChromeTrace(const CpuProfileFrame& profile, const std::string& path);
+    static std::string MakeTracePath(const char* prefix = "trace");
+
+private:
+    struct PendingCapture {
+        CpuProfileFrame profile;
+        std::string path;
+    };
+
+    void WriteCapture(const PendingCapture& capture);
+
+    mutable std::mutex m_mutex;
+    size_t m_pendingCaptures = 0; // Copied and not yet written
+    std::string m_lastTracePath;
+    JobCounter m_writeJobs;
+};
@@ -0,0 +1,104 @@
+// GameOverlay - TrayIcon.cpp
+// Notification area icon for the resident overlay: show/hide and exit while it is dismissed
+
+#include "TrayIcon.h"
+#include "Resource.h"
+#include <shellapi.h>
+
+#pragma comment(lib, "shell32.lib")
+
+namespace {
+    constexpr UINT TRAY_ICON_ID = 1;
+    constexpr UINT MENU_TOGGLE = 1;
+    constexpr UINT MENU_EXIT = 2;
+}
+
+TrayIcon::TrayIcon(HWND hwnd, HINSTANCE hInstance)
+    : m_hwnd(hwnd) {
+    m_icon = LoadIcon(hInstance, MAKEINTRESOURCE(IDI_SMALL));
+    m_taskbarCreatedMessage = RegisterWindowMessageW(L"TaskbarCreated");
+    if (!Add()) {
+        // No notification area (a shell replacement); hiding the overlay still works by hotkey
+        OutputDebugStringA("Warning: Failed to add the tray icon.\n");
+    }
+}
+
+TrayIcon::~TrayIcon() {
+    if (m_added) {
+        NOTIFYICONDATAW data = {};
+        data.cbSize = sizeof(data);
+        data.hWnd = m_hwnd;
+        data.uID = TRAY_ICON_ID;
+        Shell_NotifyIconW(NIM_DELETE, &data);
+    }
+}
+
+bool TrayIcon::Add() {
+    NOTIFYICONDATAW data = {};
+    data.cbSize = sizeof(data);
+    data.hWnd = m_hwnd;
+    data.uID = TRAY_ICON_ID;
+    data.uFlags = NIF_MESSAGE | NIF_ICON | NIF_TIP;
+    data.uCallbackMessage = WM_TRAY_ICON;
+    data.hIcon = m_icon;
+    wcscpy_s(data.szTip, m_overlayVisible ? L"GameOverlay" : L"GameOverlay (resident)");
+    m_added = Shell_NotifyIconW(NIM_ADD, &data) != FALSE;
+    if (m_added) {
+        // Menu key and keyboard selection messages
+        data.uVersion = NOTIFYICON_VERSION_4;
+        Shell_NotifyIconW(NIM_SETVERSION, &data);
+    }
+    return m_added;
+}
+
+void TrayIcon::SetOverlayVisible(bool visible) {
+    if (visible == m_overlayVisible) return;
+    m_overlayVisible = visible;
+    if (!m_added) return;
+
+    NOTIFYICONDATAW data = {};
+    data.cbSize = sizeof(data);
+    data.hWnd = m_hwnd;
+    data.uID = TRAY_ICON_ID;
+    data.uFlags = NIF_TIP;
+    wcscpy_s(data.szTip, visible ? L"GameOverlay" : L"GameOverlay (resident)");
+    Shell_NotifyIconW(NIM_MODIFY, &data);
+}
+
+bool TrayIcon::HandleMessage(UINT msg, WPARAM, LPARAM lParam) {
+    if (msg == m_taskbarCreatedMessage && m_taskbarCreatedMessage != 0) {
+        Add();
+        return true;
+    }
+    if (msg != WM_TRAY_ICON) return false;
+
+    // Version 4: the event is in the low word
+    switch (LOWORD(lParam)) {
+    case NIN_SELECT:
+    case NIN_KEYSELECT:
+        if (m_toggleCallback) m_toggleCallback();
+        break;
+    case WM_CONTEXTMENU:
+        ShowMenu();
+        break;
+    }
+    return true;
+}
+
+void TrayIcon::ShowMenu() {
+    HMENU menu = CreatePopupMenu();
+    if (!menu) return;
+    AppendMenuW(menu, MF_STRING, MENU_TOGGLE, m_overlayVisible ? L"Hide Overlay" : L"Show Overlay");
+    AppendMenuW(menu, MF_SEPARATOR, 0, nullptr);
+    AppendMenuW(menu, MF_STRING, MENU_EXIT, L"Exit");
+
+    // Foreground first, or the menu doesn't close when clicking elsewhere
+    POINT cursor = {};
+    GetCursorPos(&cursor);
+    SetForegroundWindow(m_hwnd);
+    UINT command = TrackPopupMenu(menu, TPM_RETURNCMD | TPM_RIGHTBUTTON | TPM_NONOTIFY, cursor.x, cursor.y, 0, m_hwnd, nullptr);
+    DestroyMenu(menu);
+
+    if (command == MENU_TOGGLE && m_toggleCallback) m_toggleCallback();
+    else if (command == MENU_EXIT && m_exitCallback) m_exitCallback();
+}
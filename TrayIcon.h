@@ -0,0 +1,46 @@
+// GameOverlay - TrayIcon.h
+// Notification area icon for the resident overlay: show/hide and exit while it is dismissed
+
+#pragma once
+
+#include <Windows.h>
+#include <functional>
+
+// Added for the overlay window (its callback messages arrive in the WindowProc, see
+// HandleMessage) and removed on destruction. Explorer restarting drops every icon; the
+// TaskbarCreated broadcast puts it back. Main thread only.
+class TrayIcon {
+public:
+    static constexpr UINT WM_TRAY_ICON = WM_APP + 0x49;
+
+    TrayIcon(HWND hwnd, HINSTANCE hInstance);
+    ~TrayIcon();
+
+    // Disable copy and move
+    TrayIcon(const TrayIcon&) = delete;
+    TrayIcon& operator=(const TrayIcon&) = delete;
+    TrayIcon(TrayIcon&&) = delete;
+    TrayIcon& operator=(TrayIcon&&) = delete;
+
+    bool IsAvailable() const { return m_added; }
+
+    // Left click and the menu's first item; the menu names it after the overlay's visibility
+    void SetToggleCallback(std::function<void()> callback) { m_toggleCallback = std::move(callback); }
+    void SetExitCallback(std::function<void()> callback) { m_exitCallback = std::move(callback); }
+    void SetOverlayVisible(bool visible); // Tooltip and menu text
+
+    // True when the message was the icon's (then it is handled)
+    bool HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam);
+
+private:
+    bool Add();
+    void ShowMenu();
+
+    HWND m_hwnd = nullptr;
+    HICON m_icon = nullptr;
+    UINT m_taskbarCreatedMessage = 0;
+    bool m_added = false;
+    bool m_overlayVisible = true;
+    std::function<void()> m_toggleCallback;
+    std::function<void()> m_exitCallback;
+};
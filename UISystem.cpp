@@ -16,6 +16,9 @@ void UISystem::AdaptToPerformanceState(PerformanceState state, ResourceUsageLeve
 #include "SettingsPage.h"
 #include "HotkeySettingsPage.h"
 #include "PerformanceSettingsPage.h"
+#include "ImGuiSystem.h" // GetCurrentDpiScale
+#include "FrameArena.h"
+#include "SettingsDatabase.h"
 #include <string>
 
 UISystem::UISystem(RenderSystem* renderSystem, BrowserView* browserView, HotkeyManager* hotkeyManager,
@@ -23,21 +26,21 @@ UISystem::UISystem(RenderSystem* renderSystem, BrowserView* browserView, HotkeyM
     : m_renderSystem(renderSystem), m_browserView(browserView), m_hotkeyManager(hotkeyManager),
     m_performanceOptimizer(performanceOptimizer), m_performanceMonitor(performanceMonitor) {
 
-    // Create pages
-    m_mainPage = std::make_unique<MainPage>();
-    m_browserPage = std::make_unique<BrowserPage>(m_browserView);
-    m_linksPage = std::make_unique<LinksPage>();
-    m_settingsPage = std::make_unique<SettingsPage>(this);
-    m_hotkeySettingsPage = std::make_unique<HotkeySettingsPage>(m_hotkeyManager);
-
-    // Create performance settings page if optimizer and monitor are available
-    if (m_performanceOptimizer && m_performanceMonitor) {
-        m_performanceSettingsPage = std::make_unique<PerformanceSettingsPage>(m_performanceOptimizer, m_performanceMonitor);
-    }
+    // Pages are created when their tab is first shown (GetPage)
 
     // Set initial theme
     ApplyTheme(m_currentTheme);
 
+    // Status bar background is drawn from a bundle
+    SetStaticChromeEnabled(true);
+
+    // The layout is only read for users who turned the HUD on
+    m_hudLayer.SetBrowserView(m_browserView);
+    if (SettingsDatabase::Get().GetBool("appearance.showHud", false)) {
+        m_hudLayer.SetEnabled(true);
+        m_hudLayer.Load(HudLayer::GetLayoutPath());
+    }
+
     // Register tab switching hotkeys
     if (m_hotkeyManager) {
         // Update the show_main action to switch tab
@@ -66,7 +69,7 @@ UISystem::UISystem(RenderSystem* renderSystem, BrowserView* browserView, HotkeyM
             });
 
         // Add hotkey for performance settings tab if available
-        if (m_performanceSettingsPage) {
+        if (HasPerformancePage()) {
             m_hotkeyManager->RegisterHotkey("show_performance", Hotkey('6', false, true), [this]() {
                 SetCurrentTab(5); // Switch to Performance tab
                 });
@@ -75,10 +78,27 @@ UISystem::UISystem(RenderSystem* renderSystem, BrowserView* browserView, HotkeyM
 }
 
 UISystem::~UISystem() {
+    if (m_chromeLayerId) {
+        m_renderSystem->RemoveStaticLayer(m_chromeLayerId);
+    }
+    if (m_chromeVertexBuffer) {
+        m_renderSystem->GetResourceManager()->ReleaseResource(m_chromeVertexBuffer.Get());
+        m_renderSystem->GetResourceManager()->RetireResource(std::move(m_chromeVertexBuffer));
+    }
+
     // Pages are automatically cleaned up by unique_ptr
 }
 
 void UISystem::Render() {
+    // Last frame's transient strings are done with (ImGui copied what it keeps)
+    FrameArena::ForThread().Reset();
+
+    // A maximized browser page is the whole frame, without the main window or the status bar
+    if (IsBrowserMaximized()) {
+        m_browserPage->RenderMaximized();
+        return;
+    }
+
     // Render main layout with tabbed interface
     RenderMainLayout();
 
@@ -86,14 +106,41 @@ void UISystem::Render() {
     RenderStatusBar();
 }
 
+void UISystem::RenderHud() {
+    // HUD widgets go straight to the command list, beneath everything ImGui records
+    m_hudLayer.Draw(m_renderSystem, m_performanceMonitor);
+}
+
 void UISystem::SetTheme(Theme theme) {
     if (m_currentTheme != theme) {
         m_currentTheme = theme;
         ApplyTheme(theme);
+        if (m_chromeLayerId) {
+            // Chrome colors come from the theme
+            RenderSystem* renderSystem = m_renderSystem;
+            ImGuiSystem::RunOnRenderThread("Chrome Theme", [renderSystem]() { renderSystem->InvalidateStaticLayers(); });
+        }
+    }
+}
+
+void UISystem::SetStaticChromeEnabled(bool enabled) {
+    if (!enabled && m_chromeLayerId) {
+        m_renderSystem->RemoveStaticLayer(m_chromeLayerId);
+        m_chromeLayerId = 0;
+    }
+    else if (enabled && !m_chromeLayerId && m_renderSystem && m_renderSystem->GetDevice()) {
+        m_chromeLayerId = m_renderSystem->AddStaticLayer(
+            [this](ID3D12GraphicsCommandList* bundle, int width, int height) {
+                return RecordChrome(bundle, width, height);
+            });
     }
 }
 
-std::string UISystem::GetCurrentPageName() const {
+bool UISystem::IsBrowserMaximized() const {
+    return m_currentTab == 1 && m_visibleTab == 1 && m_browserPage && m_browserPage->IsMaximized();
+}
+
+const char* UISystem::GetCurrentPageName() const {
     switch (m_currentTab) {
     case 0: return "Main";
     case 1: return "Browser";
@@ -107,14 +154,59 @@ std::string UISystem::GetCurrentPageName() const {
 
 void UISystem::SetCurrentTab(int tab) {
     // Validate tab index
-    int maxTab = m_performanceSettingsPage ? 5 : 4;
+    int maxTab = HasPerformancePage() ? 5 : 4;
     if (tab >= 0 && tab <= maxTab) {
         m_currentTab = tab;
+        m_mainWindowCache.Invalidate();
+        m_statusBarCache.Invalidate();
+    }
+}
+
+PageBase* UISystem::GetPage(int tab) {
+    TextureLoader* textureLoader = m_renderSystem ? m_renderSystem->GetTextureLoader() : nullptr;
+    switch (tab) {
+    case 0:
+        if (!m_mainPage) m_mainPage = std::make_unique<MainPage>(m_browserView, textureLoader, m_performanceMonitor);
+        return m_mainPage.get();
+    case 1:
+        if (!m_browserPage) m_browserPage = std::make_unique<BrowserPage>(m_browserView);
+        return m_browserPage.get();
+    case 2:
+        if (!m_linksPage) m_linksPage = std::make_unique<LinksPage>(m_browserView, textureLoader);
+        return m_linksPage.get();
+    case 3:
+        if (!m_settingsPage) m_settingsPage = std::make_unique<SettingsPage>(this);
+        return m_settingsPage.get();
+    case 4:
+        if (!m_hotkeySettingsPage) m_hotkeySettingsPage = std::make_unique<HotkeySettingsPage>(m_hotkeyManager);
+        return m_hotkeySettingsPage.get();
+    case 5:
+        if (!HasPerformancePage()) return nullptr;
+        if (!m_performanceSettingsPage) {
+            m_performanceSettingsPage = std::make_unique<PerformanceSettingsPage>(m_performanceOptimizer,
+                m_performanceMonitor, m_renderSystem ? m_renderSystem->GetResourceManager() : nullptr, m_renderSystem);
+        }
+        return m_performanceSettingsPage.get();
+    default:
+        return nullptr;
     }
 }
 
+void UISystem::RenderPage(int tab) {
+    m_currentTab = tab;
+    PageBase* page = GetPage(tab);
+    if (tab != m_visibleTab) {
+        PageBase* previous = m_visibleTab >= 0 ? GetPage(m_visibleTab) : nullptr;
+        if (previous) previous->OnHidden();
+        m_visibleTab = tab;
+        if (page) page->OnVisible();
+    }
+    if (page) page->Render();
+}
+
 void UISystem::ApplyTheme(Theme theme) {
     ImGuiStyle& style = ImGui::GetStyle();
+    WidgetCache::InvalidateAll(); // Cached output has the old colors
 
     // Reset to default values
     style = ImGuiStyle();
@@ -171,6 +263,9 @@ void UISystem::ApplyTheme(Theme theme) {
         break;
     }
     }
+
+    // The sizes above are at 96 DPI
+    style.ScaleAllSizes(ImGuiSystem::GetCurrentDpiScale());
 }
 
 void UISystem::RenderMainLayout() {
@@ -187,57 +282,46 @@ void UISystem::RenderMainLayout() {
     ImGui::SetNextWindowSize(ImVec2(viewport->WorkSize.x - 100, viewport->WorkSize.y - 100));
 
     // Begin main window
+    int renderedTab = -1;
     if (ImGui::Begin("GameOverlay", nullptr, windowFlags)) {
-        // Create tabs
-        if (ImGui::BeginTabBar("MainTabBar", ImGuiTabBarFlags_None)) {
-            if (ImGui::BeginTabItem("Main")) {
-                m_currentTab = 0;
-                m_mainPage->Render();
-                ImGui::EndTabItem();
-            }
-
-            if (ImGui::BeginTabItem("Browser")) {
-                m_currentTab = 1;
-                m_browserPage->Render();
-                ImGui::EndTabItem();
-            }
-
-            if (ImGui::BeginTabItem("Links")) {
-                m_currentTab = 2;
-                m_linksPage->Render();
-                ImGui::EndTabItem();
-            }
-
-            if (ImGui::BeginTabItem("Settings")) {
-                m_currentTab = 3;
-                m_settingsPage->Render();
-                ImGui::EndTabItem();
-            }
-
-            if (ImGui::BeginTabItem("Hotkeys")) {
-                m_currentTab = 4;
-                m_hotkeySettingsPage->Render();
-                ImGui::EndTabItem();
-            }
-
-            if (m_performanceSettingsPage && ImGui::BeginTabItem("Performance")) {
-                m_currentTab = 5;
-                m_performanceSettingsPage->Render();
-                ImGui::EndTabItem();
+        // At the visible page's refresh rate
+        PageBase* visiblePage = m_visibleTab >= 0 ? GetPage(m_visibleTab) : nullptr;
+        if (!m_mainWindowCache.BeginContent(visiblePage ? visiblePage->GetRefreshRate() : 0.0f)) {
+            renderedTab = m_visibleTab; // Replayed: the same page is still showing
+        }
+        else {
+            // Create tabs
+            if (ImGui::BeginTabBar("MainTabBar", ImGuiTabBarFlags_None)) {
+                const char* const tabNames[PAGE_COUNT] = { "Main", "Browser", "Links", "Settings", "Hotkeys", "Performance" };
+                for (int tab = 0; tab < PAGE_COUNT; tab++) {
+                    if (tab == 5 && !HasPerformancePage()) continue;
+                    if (ImGui::BeginTabItem(tabNames[tab])) {
+                        renderedTab = tab;
+                        RenderPage(tab);
+                        ImGui::EndTabItem();
+                    }
+                }
+
+                ImGui::EndTabBar();
             }
-
-            ImGui::EndTabBar();
+            m_mainWindowCache.EndContent();
         }
     }
     ImGui::End();
+
+    // Window collapsed or clipped away: the last visible page is hidden now
+    if (renderedTab < 0 && m_visibleTab >= 0) {
+        if (PageBase* page = GetPage(m_visibleTab)) page->OnHidden();
+        m_visibleTab = -1;
+    }
 }
 
 void UISystem::RenderStatusBar() {
     // Status bar at the bottom of the screen
     ImGuiViewport* viewport = ImGui::GetMainViewport();
-    ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x, viewport->WorkPos.y + viewport->WorkSize.y - 30));
-    ImGui::SetNextWindowSize(ImVec2(viewport->WorkSize.x, 30));
-    ImGui::SetNextWindowBgAlpha(0.6f);
+    ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x, viewport->WorkPos.y + viewport->WorkSize.y - STATUS_BAR_HEIGHT));
+    ImGui::SetNextWindowSize(ImVec2(viewport->WorkSize.x, STATUS_BAR_HEIGHT));
+    ImGui::SetNextWindowBgAlpha(m_chromeLayerId ? 0.0f : STATUS_BAR_ALPHA); // The chrome layer draws it
 
     ImGuiWindowFlags statusFlags =
         ImGuiWindowFlags_NoNav |
@@ -248,14 +332,82 @@ void UISystem::RenderStatusBar() {
         ImGuiWindowFlags_NoSavedSettings |
         ImGuiWindowFlags_NoBringToFrontOnFocus;
 
-    if (ImGui::Begin("StatusBar", nullptr, statusFlags)) {
+    if (ImGui::Begin("StatusBar", nullptr, statusFlags) && m_statusBarCache.BeginContent(STATUS_BAR_REFRESH_HZ)) {
         // Current page indicator
-        ImGui::Text("Current Page: %s", GetCurrentPageName().c_str());
+        ImGui::Text("Current Page: %s", GetCurrentPageName());
+
+        // WARP: the optimizer's software rendering profile caps what the overlay does
+        if (m_renderSystem && m_renderSystem->IsUsingWarpAdapter()) {
+            ImGui::SameLine(0.0f, 24.0f);
+            ImGui::TextColored(ImVec4(1.0f, 0.75f, 0.2f, 1.0f), "No usable GPU: software rendering, frame rate and browser quality reduced");
+        }
+
+        // Game frame rate (ETW presents) next to ours, when known
+        if (m_performanceMonitor && m_performanceMonitor->GetGamePresentSample().valid) {
+            const GamePresentSample& game = m_performanceMonitor->GetGamePresentSample();
+            ImGui::SameLine(ImGui::GetWindowWidth() - 320);
+            ImGui::Text("Game: %.0f FPS (%.1f ms, sd %.2f)", game.framesPerSecond, game.averageFrameMs, game.frameTimeStdDevMs);
+        }
 
         // FPS counter on the right
         float fps = ImGui::GetIO().Framerate;
         ImGui::SameLine(ImGui::GetWindowWidth() - 150);
         ImGui::Text("%.1f FPS (%.3f ms)", fps, 1000.0f / fps);
+        m_statusBarCache.EndContent();
     }
     ImGui::End();
 }
+
+bool UISystem::RecordChrome(ID3D12GraphicsCommandList* bundle, int width, int height) {
+    PipelineStateManager* pipelineStateManager = m_renderSystem->GetPipelineStateManager();
+    if (!pipelineStateManager || width <= 0 || height <= 0) return false;
+
+    // The layer is drawn first, over the cleared target, so writing premultiplied color needs no blending
+    PipelineStateKey key;
+    key.blendMode = PipelineStateKey::NoBlend;
+    key.renderTargetFormat = m_renderSystem->GetSceneFormat();
+    ID3D12PipelineState* pipelineState = pipelineStateManager->TryGetPipelineState(key);
+    ID3D12RootSignature* rootSignature = pipelineStateManager->GetDefaultRootSignature();
+    if (!pipelineState || !rootSignature) return false;
+
+    struct ChromeVertex {
+        float position[3];
+        float texCoord[2];
+        float color[4];
+    };
+    const ImVec4& background = ImGui::GetStyle().Colors[ImGuiCol_WindowBg];
+    float alpha = background.w * STATUS_BAR_ALPHA;
+    float r = background.x * alpha, g = background.y * alpha, b = background.z * alpha;
+    float top = 1.0f - 2.0f * (static_cast<float>(height) - STATUS_BAR_HEIGHT) / static_cast<float>(height);
+    const ChromeVertex vertices[] = {
+        { { -1.0f, top, 0.0f }, { 0.0f, 0.0f }, { r, g, b, alpha } },
+        { { 1.0f, top, 0.0f }, { 1.0f, 0.0f }, { r, g, b, alpha } },
+        { { 1.0f, -1.0f, 0.0f }, { 1.0f, 1.0f }, { r, g, b, alpha } },
+        { { -1.0f, top, 0.0f }, { 0.0f, 0.0f }, { r, g, b, alpha } },
+        { { 1.0f, -1.0f, 0.0f }, { 1.0f, 1.0f }, { r, g, b, alpha } },
+        { { -1.0f, -1.0f, 0.0f }, { 0.0f, 1.0f }, { r, g, b, alpha } },
+    };
+
+    // The previous bundle may still be replayed by frames in flight
+    ResourceManager* resourceManager = m_renderSystem->GetResourceManager();
+    if (m_chromeVertexBuffer) {
+        resourceManager->ReleaseResource(m_chromeVertexBuffer.Get());
+        resourceManager->RetireResource(std::move(m_chromeVertexBuffer));
+    }
+    m_chromeVertexBuffer = resourceManager->CreateBuffer(sizeof(vertices), D3D12_RESOURCE_FLAG_NONE,
+        D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, vertices);
+    if (!m_chromeVertexBuffer) return false;
+    resourceManager->PinResource(m_chromeVertexBuffer.Get(), true); // Replayed every frame; never evicted
+
+    D3D12_VERTEX_BUFFER_VIEW vertexBufferView = {};
+    vertexBufferView.BufferLocation = m_chromeVertexBuffer->GetGPUVirtualAddress();
+    vertexBufferView.SizeInBytes = sizeof(vertices);
+    vertexBufferView.StrideInBytes = sizeof(ChromeVertex);
+
+    bundle->SetGraphicsRootSignature(rootSignature);
+    bundle->SetPipelineState(pipelineState);
+    bundle->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    bundle->IASetVertexBuffers(0, 1, &vertexBufferView);
+    bundle->DrawInstanced(_countof(vertices), 1, 0, 0);
+    return true;
+}
@@ -13,8 +13,11 @@
 #include "HotkeyManager.h"
 #include "PerformanceOptimizer.h"
 #include "PerformanceMonitor.h"
+#include "WidgetCache.h"
+#include "HudLayer.h"
 
 // Forward declarations
+class PageBase;
 class MainPage;
 class BrowserPage;
 class LinksPage;
@@ -34,8 +37,10 @@ public:
     UISystem(UISystem&&) = delete;
     UISystem& operator=(UISystem&&) = delete;
 
-    // Main render method
+    // Main render method, on the thread building the ImGui frame (ImGuiSystem::StartFrameBuild)
     void Render();
+    // The HUD, on the render thread before the ImGui frame is recorded
+    void RenderHud();
 
     // Theme management
     enum class Theme {
@@ -48,7 +53,19 @@ public:
     Theme GetTheme() const { return m_currentTheme; }
 
     // Get the current page to show in statusbar
-    std::string GetCurrentPageName() const;
+    const char* GetCurrentPageName() const;
+
+    BrowserView* GetBrowserView() const { return m_browserView; }
+
+    // The status bar background bundle is drawn in back buffer coordinates; a compact window (one
+    // that doesn't cover the screen) draws it with ImGui instead
+    void SetStaticChromeEnabled(bool enabled);
+
+    // The browser page covers the viewport by itself (BrowserPage::RenderMaximized)
+    bool IsBrowserMaximized() const;
+
+    // Native HUD widgets, drawn beneath the panels without the browser
+    HudLayer& GetHudLayer() { return m_hudLayer; }
 
 private:
     // Helper method to setup UI styling
@@ -60,7 +77,27 @@ private:
     // Render overlay statusbar
     void RenderStatusBar();
 
-    // Tab pages
+    // Static chrome (the status bar background), recorded into a RenderSystem static layer bundle
+    // and rerecorded on theme change or resize
+    bool RecordChrome(ID3D12GraphicsCommandList* bundle, int width, int height);
+    static constexpr float STATUS_BAR_HEIGHT = 30.0f;
+    static constexpr float STATUS_BAR_ALPHA = 0.6f;
+    UINT m_chromeLayerId = 0;
+    ComPtr<ID3D12Resource> m_chromeVertexBuffer;
+
+    // Tab pages, created the first time their tab is shown
+    static constexpr int PAGE_COUNT = 6;
+    PageBase* GetPage(int tab);
+    // Renders the tab's page, with OnVisible/OnHidden when the visible page changes
+    void RenderPage(int tab);
+    bool HasPerformancePage() const { return m_performanceOptimizer && m_performanceMonitor; }
+    int m_visibleTab = -1; // Tab whose page was rendered last frame
+
+    // Each panel's content is only laid out at its own rate or on input (see WidgetCache)
+    static constexpr float STATUS_BAR_REFRESH_HZ = 1.0f;
+    WidgetCache m_mainWindowCache;
+    WidgetCache m_statusBarCache;
+    HudLayer m_hudLayer;
     std::unique_ptr<MainPage> m_mainPage;
     std::unique_ptr<BrowserPage> m_browserPage;
     std::unique_ptr<LinksPage> m_linksPage;
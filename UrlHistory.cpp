@@ -0,0 +1,372 @@
+// GameOverlay - UrlHistory.cpp
+// Persistent browsing history with frecency-ranked prefix suggestions for the URL box
+
+#include "UrlHistory.h"
+#include "FileUtil.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+
+namespace {
+
+constexpr int64_t FRECENCY_EPOCH = 1700000000;          // Unix seconds; keeps the exponents small
+constexpr double FRECENCY_HALF_LIFE = 14.0 * 24 * 3600; // A visit counts half as much after two weeks
+constexpr double BOOKMARK_BONUS = 3.0;                  // log2: as much as eight visits right now
+
+double VisitWeight(int64_t time) {
+    return static_cast<double>(time - FRECENCY_EPOCH) / FRECENCY_HALF_LIFE;
+}
+
+// log2(2^a + 2^b)
+double AddLog2(double a, double b) {
+    if (std::isinf(a) && a < 0) return b;
+    double high = std::max(a, b);
+    return high + std::log2(1.0 + std::exp2(-std::fabs(a - b)));
+}
+
+// Tabs and line breaks would split the line; titles are for display only
+std::string SanitizeField(std::string text) {
+    std::replace_if(text.begin(), text.end(), [](char c) { return c == '\t' || c == '\r' || c == '\n'; }, ' ');
+    return text;
+}
+
+bool IsSuggestible(const UrlHistory::Entry& entry) {
+    return entry.visits > 0 || entry.bookmarked;
+}
+
+} // namespace
+
+UrlHistory::~UrlHistory() {
+    if (m_file) fclose(m_file);
+}
+
+std::string UrlHistory::MakeKey(const std::string& url) {
+    std::string key = url;
+    std::transform(key.begin(), key.end(), key.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    size_t scheme = key.find("://");
+    if (scheme != std::string::npos && scheme <= 10) key.erase(0, scheme + 3);
+    if (key.compare(0, 4, "www.") == 0) key.erase(0, 4);
+    while (!key.empty() && key.back() == '/') key.pop_back();
+    return key;
+}
+
+bool UrlHistory::Load(const std::string& path) {
+    m_path = path;
+    if (path.empty()) return false;
+
+    FILE* file = nullptr;
+    m_fileLines = 0;
+    if (fopen_s(&file, path.c_str(), "rb") == 0 && file) {
+        // score \t visits \t lastVisit \t url \t title
+        std::string line;
+        char chunk[4096];
+        while (fgets(chunk, sizeof(chunk), file)) {
+            line += chunk;
+            if (line.back() != '\n' && !feof(file)) continue; // Longer than a chunk
+            while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line.pop_back();
+
+            size_t fields[4];
+            size_t position = 0;
+            bool valid = true;
+            for (size_t& field : fields) {
+                field = line.find('\t', position);
+                if (field == std::string::npos) { valid = false; break; }
+                position = field + 1;
+            }
+            if (valid) {
+                std::string url = line.substr(fields[2] + 1, fields[3] - fields[2] - 1);
+                uint32_t index = FindOrAddEntry(url);
+                if (index != UINT32_MAX) {
+                    Entry& entry = m_entries[index];
+                    entry.url = url;
+                    entry.score = strtod(line.c_str(), nullptr);
+                    entry.visits = static_cast<uint32_t>(strtoul(line.c_str() + fields[0] + 1, nullptr, 10));
+                    entry.lastVisit = _strtoi64(line.c_str() + fields[1] + 1, nullptr, 10);
+                    entry.title = line.substr(fields[3] + 1);
+                }
+            }
+            m_fileLines++;
+            line.clear();
+        }
+        fclose(file);
+    }
+    RebuildTopLists();
+
+    // Compact when most lines are superseded: one line per entry, written aside and moved over
+    if (m_fileLines > m_entries.size() * 2 + 64) {
+        size_t lines = 0;
+        bool written = WriteFileAtomic(path, [this, &lines](std::ostream& file) {
+            for (const Entry& entry : m_entries) {
+                if (entry.visits == 0) continue; // Bookmark-only entries come back with the bookmarks
+                file << FormatLine(entry);
+                lines++;
+            }
+            return true;
+        });
+        if (written) m_fileLines = lines;
+    }
+
+    CreateDirectoryA(path.substr(0, path.find_last_of('\\')).c_str(), nullptr);
+    if (fopen_s(&m_file, path.c_str(), "ab") != 0 || !m_file) {
+        OutputDebugStringA("Warning: Failed to open the browsing history; it lasts for this session only.\n");
+        m_file = nullptr;
+    }
+    InvalidateSuggestions();
+    return true;
+}
+
+void UrlHistory::RecordVisit(const std::string& url, const std::string& title) {
+    uint32_t index = FindOrAddEntry(url);
+    if (index == UINT32_MAX) return;
+
+    Entry& entry = m_entries[index];
+    int64_t now = static_cast<int64_t>(std::time(nullptr));
+    entry.url = url;
+    if (!title.empty()) entry.title = title;
+    entry.score = entry.visits == 0 && !entry.bookmarked ? VisitWeight(now) : AddLog2(entry.score, VisitWeight(now));
+    entry.visits++;
+    entry.lastVisit = now;
+    Promote(index);
+    AppendLine(entry);
+    InvalidateSuggestions();
+}
+
+void UrlHistory::SetTitle(const std::string& url, const std::string& title) {
+    auto it = m_entryByKey.find(MakeKey(url));
+    if (it == m_entryByKey.end() || title.empty() || m_entries[it->second].title == title) return;
+    m_entries[it->second].title = title;
+    AppendLine(m_entries[it->second]);
+}
+
+void UrlHistory::SetBookmarked(const std::string& url, const std::string& title, bool bookmarked) {
+    uint32_t index = bookmarked ? FindOrAddEntry(url) : UINT32_MAX;
+    if (!bookmarked) {
+        auto it = m_entryByKey.find(MakeKey(url));
+        if (it != m_entryByKey.end()) index = it->second;
+    }
+    if (index == UINT32_MAX || m_entries[index].bookmarked == bookmarked) return;
+
+    Entry& entry = m_entries[index];
+    entry.bookmarked = bookmarked;
+    if (entry.title.empty()) entry.title = title;
+    if (bookmarked) {
+        // Never visited: ranked as if visited once, now
+        if (entry.visits == 0) entry.score = VisitWeight(static_cast<int64_t>(std::time(nullptr)));
+        if (entry.url.empty()) entry.url = url;
+        Promote(index);
+    }
+    else {
+        RebuildTopLists();
+    }
+    InvalidateSuggestions();
+}
+
+void UrlHistory::Clear() {
+    m_entries.clear();
+    m_entryByKey.clear();
+    m_nodes.assign(1, Node());
+    InvalidateSuggestions();
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+        if (fopen_s(&m_file, m_path.c_str(), "wb") != 0) m_file = nullptr;
+    }
+    m_fileLines = 0;
+}
+
+const std::vector<uint32_t>& UrlHistory::Suggest(const std::string& typed) {
+    std::string query = MakeKey(typed);
+    if (m_suggestionsValid && query == m_cursorQuery) return m_suggestions;
+
+    // Resume below the last node boundary the previous text shares with this one
+    uint32_t node = 0;
+    size_t position = 0;
+    if (m_suggestionsValid && query.size() >= m_cursorDepth && query.compare(0, m_cursorDepth, m_cursorQuery, 0, m_cursorDepth) == 0) {
+        node = m_cursorNode;
+        position = m_cursorDepth;
+    }
+
+    int32_t match = static_cast<int32_t>(node);
+    while (position < query.size()) {
+        int32_t child = FindChild(m_nodes[node], query[position]);
+        if (child < 0) { match = -1; break; }
+        const std::string& label = m_nodes[child].label;
+        size_t compared = std::min(label.size(), query.size() - position);
+        if (label.compare(0, compared, query, position, compared) != 0) { match = -1; break; }
+        match = child;
+        if (compared < label.size()) break; // The text ends inside this edge: its subtree matches
+        node = static_cast<uint32_t>(child);
+        position += label.size();
+    }
+    m_cursorQuery = query;
+    m_cursorNode = node;
+    m_cursorDepth = position;
+    m_suggestionsValid = true;
+
+    m_suggestions.clear();
+    if (!query.empty() && match >= 0) {
+        const Node& found = m_nodes[match];
+        m_suggestions.assign(found.top.begin(), found.top.begin() + found.topCount);
+    }
+    return m_suggestions;
+}
+
+std::string UrlHistory::GetDefaultPath() {
+    std::string directory = GetAppDataDirectory();
+    if (directory.empty()) {
+        return std::string(); // No profile directory; history lasts for the session only
+    }
+    return directory + "\\History.txt";
+}
+
+double UrlHistory::RankScore(uint32_t entry) const {
+    const Entry& e = m_entries[entry];
+    return e.score + (e.bookmarked ? BOOKMARK_BONUS : 0.0);
+}
+
+uint32_t UrlHistory::FindOrAddEntry(const std::string& url) {
+    std::string key = MakeKey(url);
+    if (key.empty() || url.compare(0, 6, "about:") == 0 || url.compare(0, 5, "data:") == 0) return UINT32_MAX;
+    auto it = m_entryByKey.find(key);
+    if (it != m_entryByKey.end()) return it->second;
+
+    uint32_t index = static_cast<uint32_t>(m_entries.size());
+    Entry entry;
+    entry.url = url;
+    entry.key = key;
+    entry.score = -INFINITY;
+    m_entries.push_back(std::move(entry));
+    m_entryByKey.emplace(key, index);
+    InsertKey(key, index);
+    return index;
+}
+
+uint32_t UrlHistory::InsertKey(const std::string& key, uint32_t entry) {
+    uint32_t node = 0;
+    size_t position = 0;
+    while (position < key.size()) {
+        int32_t child = FindChild(m_nodes[node], key[position]);
+        if (child < 0) {
+            // New leaf for the rest of the key
+            Node leaf;
+            leaf.label = key.substr(position);
+            leaf.entry = static_cast<int32_t>(entry);
+            uint32_t leafIndex = static_cast<uint32_t>(m_nodes.size());
+            m_nodes.push_back(std::move(leaf));
+            std::vector<uint32_t>& children = m_nodes[node].children;
+            auto at = std::lower_bound(children.begin(), children.end(), key[position],
+                [this](uint32_t existing, char first) { return m_nodes[existing].label[0] < first; });
+            children.insert(at, leafIndex);
+            return leafIndex;
+        }
+
+        std::string label = m_nodes[child].label;
+        size_t common = 0;
+        while (common < label.size() && position + common < key.size() && label[common] == key[position + common]) {
+            common++;
+        }
+        if (common < label.size()) {
+            // Split the edge; the new branch node covers the same subtree, so it inherits the list
+            Node branch;
+            branch.label = label.substr(0, common);
+            branch.children.push_back(static_cast<uint32_t>(child));
+            branch.top = m_nodes[child].top;
+            branch.topCount = m_nodes[child].topCount;
+            m_nodes[child].label = label.substr(common);
+            uint32_t branchIndex = static_cast<uint32_t>(m_nodes.size());
+            m_nodes.push_back(std::move(branch));
+            std::replace(m_nodes[node].children.begin(), m_nodes[node].children.end(),
+                static_cast<uint32_t>(child), branchIndex);
+            child = static_cast<int32_t>(branchIndex);
+        }
+        node = static_cast<uint32_t>(child);
+        position += common;
+    }
+    m_nodes[node].entry = static_cast<int32_t>(entry);
+    return node;
+}
+
+void UrlHistory::Promote(uint32_t entry) {
+    const std::string& key = m_entries[entry].key;
+    uint32_t node = 0;
+    size_t position = 0;
+    AddToTop(m_nodes[0], entry);
+    while (position < key.size()) {
+        int32_t child = FindChild(m_nodes[node], key[position]);
+        if (child < 0) return; // Not reached: every key is in the trie
+        node = static_cast<uint32_t>(child);
+        position += m_nodes[node].label.size();
+        AddToTop(m_nodes[node], entry);
+    }
+}
+
+void UrlHistory::AddToTop(Node& node, uint32_t entry) const {
+    uint8_t count = node.topCount;
+    auto end = node.top.begin() + count;
+    auto existing = std::find(node.top.begin(), end, entry);
+    if (existing != end) {
+        std::copy(existing + 1, end, existing);
+        count--;
+    }
+    double score = RankScore(entry);
+    size_t position = 0;
+    while (position < count && RankScore(node.top[position]) >= score) position++;
+    if (position >= SUGGESTION_COUNT) {
+        node.topCount = count;
+        return;
+    }
+    size_t last = std::min<size_t>(count, SUGGESTION_COUNT - 1);
+    for (size_t i = last; i > position; i--) node.top[i] = node.top[i - 1];
+    node.top[position] = entry;
+    node.topCount = static_cast<uint8_t>(std::min<size_t>(count + 1, SUGGESTION_COUNT));
+}
+
+void UrlHistory::RebuildTopLists() {
+    // Parents come before their children in this order, so walking it backwards merges bottom-up
+    std::vector<uint32_t> order;
+    order.reserve(m_nodes.size());
+    order.push_back(0);
+    for (size_t i = 0; i < order.size(); i++) {
+        for (uint32_t child : m_nodes[order[i]].children) order.push_back(child);
+    }
+
+    std::vector<uint32_t> candidates;
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        Node& node = m_nodes[*it];
+        candidates.clear();
+        if (node.entry >= 0 && IsSuggestible(m_entries[node.entry])) candidates.push_back(static_cast<uint32_t>(node.entry));
+        for (uint32_t child : node.children) {
+            const Node& childNode = m_nodes[child];
+            candidates.insert(candidates.end(), childNode.top.begin(), childNode.top.begin() + childNode.topCount);
+        }
+        size_t kept = std::min(candidates.size(), SUGGESTION_COUNT);
+        std::partial_sort(candidates.begin(), candidates.begin() + kept, candidates.end(),
+            [this](uint32_t a, uint32_t b) { return RankScore(a) > RankScore(b); });
+        std::copy(candidates.begin(), candidates.begin() + kept, node.top.begin());
+        node.topCount = static_cast<uint8_t>(kept);
+    }
+}
+
+int32_t UrlHistory::FindChild(const Node& node, char first) const {
+    auto it = std::lower_bound(node.children.begin(), node.children.end(), first,
+        [this](uint32_t child, char value) { return m_nodes[child].label[0] < value; });
+    if (it == node.children.end() || m_nodes[*it].label[0] != first) return -1;
+    return static_cast<int32_t>(*it);
+}
+
+void UrlHistory::AppendLine(const Entry& entry) {
+    if (!m_file || entry.visits == 0) return; // Bookmark-only entries come back with the bookmarks
+    fputs(FormatLine(entry).c_str(), m_file);
+    fflush(m_file);
+    m_fileLines++;
+}
+
+std::string UrlHistory::FormatLine(const Entry& entry) {
+    char numbers[96];
+    snprintf(numbers, sizeof(numbers), "%.17g\t%u\t%lld\t", entry.score, entry.visits,
+        static_cast<long long>(entry.lastVisit));
+    return numbers + SanitizeField(entry.url) + "\t" + SanitizeField(entry.title) + "\n";
+}
@@ -0,0 +1,103 @@
+// GameOverlay - UrlHistory.h
+// Persistent browsing history with frecency-ranked prefix suggestions for the URL box
+
+#pragma once
+
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <cstdint>
+#include <cstdio>
+
+// Every visited URL is one entry, keyed by its URL without the scheme and a leading "www."
+// (lowercase), so "git" finds https://github.com. Keys live in a compressed prefix trie (one node
+// per branch point; edges carry strings) whose nodes each keep the top SUGGESTION_COUNT entries
+// of their subtree. A suggestion lookup is a walk down the typed text and a copy of that node's
+// list, independent of how many entries there are; the walk resumes from the last node when the
+// text only grew.
+//
+// Frecency: each visit adds 2^((time - epoch) / half-life), kept as a logarithm. Every score
+// decays at the same rate, so rankings never change as time passes and the cached lists stay
+// valid; a visit only ever raises one entry's score. Bookmarks get a fixed bonus.
+//
+// The file is append-only: a visit or title change appends the entry's line, the last line for a
+// URL wins, and Load rewrites the file when most lines are stale. Main thread only.
+class UrlHistory {
+public:
+    static constexpr size_t SUGGESTION_COUNT = 8;
+
+    UrlHistory() = default;
+    ~UrlHistory();
+
+    // Disable copy and move
+    UrlHistory(const UrlHistory&) = delete;
+    UrlHistory& operator=(const UrlHistory&) = delete;
+    UrlHistory(UrlHistory&&) = delete;
+    UrlHistory& operator=(UrlHistory&&) = delete;
+
+    // A missing file is an empty history; later changes are appended to the same path
+    bool Load(const std::string& path);
+
+    void RecordVisit(const std::string& url, const std::string& title = std::string());
+    void SetTitle(const std::string& url, const std::string& title);
+    void SetBookmarked(const std::string& url, const std::string& title, bool bookmarked);
+    void Clear(); // Also empties the file
+
+    struct Entry {
+        std::string url;
+        std::string title;
+        std::string key;      // Trie key
+        double score = 0.0;   // log2 of the summed visit weights
+        uint32_t visits = 0;
+        int64_t lastVisit = 0; // Unix seconds
+        bool bookmarked = false;
+    };
+    size_t GetEntryCount() const { return m_entries.size(); }
+    const Entry& GetEntry(uint32_t entry) const { return m_entries[entry]; }
+
+    // Best entries whose key starts with the typed text (normalized like the keys), best first;
+    // empty for empty text. Valid until the history changes or the next call.
+    const std::vector<uint32_t>& Suggest(const std::string& typed);
+
+    // %LOCALAPPDATA%\GameOverlay\History.txt; empty without a profile directory
+    static std::string GetDefaultPath();
+    static std::string MakeKey(const std::string& url);
+
+private:
+    struct Node {
+        std::string label;              // Edge from the parent
+        std::vector<uint32_t> children; // Sorted by the first character of their labels
+        int32_t entry = -1;             // Entry whose key ends here
+        std::array<uint32_t, SUGGESTION_COUNT> top = {}; // Best of the subtree, best first
+        uint8_t topCount = 0;
+    };
+
+    double RankScore(uint32_t entry) const;
+    uint32_t FindOrAddEntry(const std::string& url);
+    uint32_t InsertKey(const std::string& key, uint32_t entry); // Returns the key's node
+    void Promote(uint32_t entry);  // Entry's score rose: refresh the lists along its key's path
+    void RebuildTopLists();        // Score lowered (bookmark removed): recompute from the leaves
+    void AddToTop(Node& node, uint32_t entry) const;
+    int32_t FindChild(const Node& node, char first) const;
+    void AppendLine(const Entry& entry);
+    static std::string FormatLine(const Entry& entry);
+    void InvalidateSuggestions() { m_cursorQuery.clear(); m_cursorNode = 0; m_cursorDepth = 0; m_suggestionsValid = false; }
+
+    std::string m_path;
+    FILE* m_file = nullptr; // Open for appending after Load
+    size_t m_fileLines = 0;
+
+    std::vector<Entry> m_entries;
+    std::unordered_map<std::string, uint32_t> m_entryByKey;
+    std::vector<Node> m_nodes = std::vector<Node>(1); // [0] is the root
+
+    // Incremental lookup: m_cursorNode is where the walk for m_cursorQuery's first m_cursorDepth
+    // characters ended (a node boundary)
+    std::string m_cursorQuery;
+    uint32_t m_cursorNode = 0;
+    size_t m_cursorDepth = 0;
+    bool m_suggestionsValid = false;
+    std::vector<uint32_t> m_suggestions;
+};
@@ -0,0 +1,348 @@
+// GameOverlay - WebWidgetAtlas.cpp
+// One texture shared by the pinned web widgets, each uploaded within its own budget
+
+#include "WebWidgetAtlas.h"
+#include "RenderSystem.h"
+#include "PixelCopy.h"
+#include "SharedTextureCopier.h"
+#include "Log.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+bool IsEmptyRect(const RECT& rect) { return rect.right <= rect.left || rect.bottom <= rect.top; }
+
+RECT CombineRects(const RECT& a, const RECT& b) {
+    if (IsEmptyRect(a)) return b;
+    if (IsEmptyRect(b)) return a;
+    return { std::min(a.left, b.left), std::min(a.top, b.top), std::max(a.right, b.right), std::max(a.bottom, b.bottom) };
+}
+
+} // namespace
+
+WebWidgetAtlas::WebWidgetAtlas(RenderSystem* renderSystem)
+    : m_renderSystem(renderSystem), m_resourceManager(renderSystem ? renderSystem->GetResourceManager() : nullptr) {
+}
+
+WebWidgetAtlas::~WebWidgetAtlas() {
+    if (!m_resourceManager) return;
+    for (Widget& widget : m_widgets) {
+        RetirePaintCopies(widget);
+    }
+    // Frames in flight may still sample it
+    if (m_texture) {
+        ResourceDescriptor srv = m_srv;
+        ResourceManager* resourceManager = m_resourceManager;
+        m_resourceManager->RetireResource(std::move(m_texture),
+            [resourceManager, srv]() { resourceManager->FreeDescriptor(srv); });
+    }
+}
+
+WebWidgetAtlas::Widget* WebWidgetAtlas::FindWidget(int widgetId) {
+    auto it = std::find_if(m_widgets.begin(), m_widgets.end(), [widgetId](const Widget& widget) { return widget.id == widgetId; });
+    return it != m_widgets.end() ? &*it : nullptr;
+}
+
+bool WebWidgetAtlas::AddWidget(int widgetId, int width, int height, UINT64 uploadBudgetBytes) {
+    if (widgetId == 0 || width <= 0 || height <= 0) return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (FindWidget(widgetId)) return false;
+    RECT region;
+    if (!AllocateRegion(width, height, region)) {
+        LOG_WARNING("No room for a %dx%d web widget in the widget atlas", width, height);
+        return false;
+    }
+
+    Widget widget;
+    widget.id = widgetId;
+    widget.region = region;
+    widget.uploadBudgetBytes = uploadBudgetBytes;
+    widget.pixels.resize(static_cast<size_t>(width) * height * 4);
+    m_widgets.push_back(std::move(widget));
+    return true;
+}
+
+void WebWidgetAtlas::RemoveWidget(int widgetId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = std::find_if(m_widgets.begin(), m_widgets.end(), [widgetId](const Widget& widget) { return widget.id == widgetId; });
+    if (it == m_widgets.end()) return;
+
+    RetirePaintCopies(*it);
+    m_freeRegions.push_back(it->region);
+    m_widgets.erase(it);
+    UpdatePendingFlag();
+}
+
+void WebWidgetAtlas::RetirePaintCopies(Widget& widget) {
+    // Frames in flight may still copy from them; one being written is kept alive by its writer
+    for (PaintCopy& copy : widget.paintCopies) {
+        if (copy.texture && m_resourceManager) m_resourceManager->RetireResource(std::move(copy.texture));
+    }
+    widget.paintCopies.clear();
+    widget.pendingCopy = -1;
+}
+
+bool WebWidgetAtlas::AllocateRegion(int width, int height, RECT& region) {
+    const int size = static_cast<int>(ATLAS_SIZE);
+    if (width > size || height > size) return false;
+
+    // The smallest freed region it fits in
+    auto best = m_freeRegions.end();
+    for (auto it = m_freeRegions.begin(); it != m_freeRegions.end(); ++it) {
+        const int freeWidth = it->right - it->left, freeHeight = it->bottom - it->top;
+        if (freeWidth < width || freeHeight < height) continue;
+        if (best == m_freeRegions.end() || freeWidth * freeHeight < (best->right - best->left) * (best->bottom - best->top)) {
+            best = it;
+        }
+    }
+    if (best != m_freeRegions.end()) {
+        region = { best->left, best->top, best->left + width, best->top + height };
+        m_freeRegions.erase(best);
+        return true;
+    }
+
+    // The lowest shelf tall enough, then a new shelf under the last one
+    Shelf* shelf = nullptr;
+    for (Shelf& candidate : m_shelves) {
+        if (candidate.height >= height && candidate.usedWidth + width <= size &&
+            (!shelf || candidate.height < shelf->height)) {
+            shelf = &candidate;
+        }
+    }
+    if (!shelf) {
+        const int y = m_shelves.empty() ? 0 : m_shelves.back().y + m_shelves.back().height + REGION_GAP;
+        if (y + height > size) return false;
+        m_shelves.push_back({ y, height, 0 });
+        shelf = &m_shelves.back();
+    }
+    region = { shelf->usedWidth, shelf->y, shelf->usedWidth + width, shelf->y + height };
+    shelf->usedWidth += width + REGION_GAP;
+    return true;
+}
+
+void WebWidgetAtlas::OnPaint(int widgetId, const void* buffer, int width, int height, const std::vector<RECT>& dirtyRects) {
+    if (!buffer || width <= 0 || height <= 0) return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Widget* widget = FindWidget(widgetId);
+    if (!widget) return;
+
+    // CEF's paint follows the widget size, which can lag a change by a frame
+    const int regionWidth = widget->region.right - widget->region.left;
+    const int regionHeight = widget->region.bottom - widget->region.top;
+    const size_t srcPitch = static_cast<size_t>(width) * 4;
+    const size_t dstPitch = static_cast<size_t>(regionWidth) * 4;
+    const uint8_t* src = static_cast<const uint8_t*>(buffer);
+    for (const RECT& dirty : dirtyRects) {
+        RECT rect = { std::max(dirty.left, 0L), std::max(dirty.top, 0L),
+            std::min<LONG>(dirty.right, std::min(width, regionWidth)), std::min<LONG>(dirty.bottom, std::min(height, regionHeight)) };
+        if (IsEmptyRect(rect)) continue;
+        CopyPixelRows(widget->pixels.data() + rect.top * dstPitch + rect.left * 4, dstPitch,
+            src + rect.top * srcPitch + rect.left * 4, srcPitch,
+            static_cast<size_t>(rect.right - rect.left) * 4, static_cast<size_t>(rect.bottom - rect.top));
+        widget->pendingRect = CombineRects(widget->pendingRect, rect);
+    }
+    UpdatePendingFlag();
+}
+
+void WebWidgetAtlas::OnAcceleratedPaint(int widgetId, HANDLE sharedHandle) {
+    SharedTextureCopier* copier = m_renderSystem ? m_renderSystem->GetSharedTextureCopier() : nullptr;
+    if (!sharedHandle || !copier || !copier->IsAvailable()) return;
+
+    // A paint copy no frame still reads: the pending one (never uploaded, so simply replaced),
+    // one whose last upload the GPU finished, or a new one
+    ComPtr<ID3D12Resource> target;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Widget* widget = FindWidget(widgetId);
+        if (!widget) return;
+        const UINT64 completedFenceValue = m_renderSystem->GetCompletedFenceValue();
+        PaintCopy* copy = nullptr;
+        if (widget->pendingCopy >= 0) {
+            copy = &widget->paintCopies[widget->pendingCopy];
+            widget->pendingCopy = -1;
+        }
+        for (size_t i = 0; !copy && i < widget->paintCopies.size(); i++) {
+            PaintCopy& candidate = widget->paintCopies[i];
+            if (!candidate.writing && candidate.fenceValue <= completedFenceValue) copy = &candidate;
+        }
+        if (!copy) {
+            const RECT& region = widget->region;
+            PaintCopy created;
+            created.texture = copier->CreateTarget(static_cast<UINT>(region.right - region.left),
+                static_cast<UINT>(region.bottom - region.top), DXGI_FORMAT_B8G8R8A8_UNORM, L"Web Widget Paint");
+            if (!created.texture) {
+                LOG_WARNING("Failed to create a web widget paint copy");
+                UpdatePendingFlag();
+                return;
+            }
+            widget->paintCopies.push_back(std::move(created));
+            copy = &widget->paintCopies.back();
+        }
+        copy->writing = true;
+        target = copy->texture;
+        UpdatePendingFlag();
+    }
+
+    // Outside the lock: the render thread's uploads don't wait on this GPU copy
+    UINT width = 0, height = 0;
+    const bool copied = copier->Copy(sharedHandle, target.Get(), width, height);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Widget* widget = FindWidget(widgetId);
+    if (!widget) return; // Removed meanwhile; its paint copies are retired
+    for (size_t i = 0; i < widget->paintCopies.size(); i++) {
+        PaintCopy& copy = widget->paintCopies[i];
+        if (copy.texture.Get() != target.Get()) continue;
+        copy.writing = false;
+        if (copied) {
+            widget->pendingCopy = static_cast<int>(i);
+            widget->pendingCopyWidth = width;
+            widget->pendingCopyHeight = height;
+        }
+        else {
+            LOG_WARNING("Failed to copy a CEF web widget shared texture");
+        }
+        break;
+    }
+    UpdatePendingFlag();
+}
+
+void WebWidgetAtlas::UpdatePendingFlag() {
+    const bool pending = std::any_of(m_widgets.begin(), m_widgets.end(),
+        [](const Widget& widget) { return widget.pendingCopy >= 0 || !IsEmptyRect(widget.pendingRect); });
+    m_pendingUploads.store(pending, std::memory_order_relaxed);
+}
+
+bool WebWidgetAtlas::EnsureTexture() {
+    if (m_texture) return true;
+    if (m_textureFailed || !m_resourceManager) return false;
+
+    try {
+        m_texture = m_resourceManager->CreateTexture2D(ATLAS_SIZE, ATLAS_SIZE, DXGI_FORMAT_B8G8R8A8_UNORM);
+        if (!m_texture) throw std::runtime_error("CreateTexture2D failed");
+        m_texture->SetName(L"Web Widget Atlas");
+        m_srv = m_resourceManager->CreateShaderResourceView(m_texture.Get());
+        m_resourceManager->PinResource(m_texture.Get(), true); // Sampled by the HUD every frame; never evicted
+    }
+    catch (const std::exception& e) {
+        LOG_WARNING("Failed to create the web widget atlas: %s", e.what());
+        if (m_texture) m_resourceManager->RetireResource(std::move(m_texture));
+        m_textureFailed = true;
+        return false;
+    }
+    return true;
+}
+
+bool WebWidgetAtlas::RecordUploads(ID3D12GraphicsCommandList* commandList) {
+    if (!commandList || !HasPendingUploads()) return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!EnsureTexture()) return false;
+    m_resourceManager->NotifyResourceUsed(m_texture.Get());
+
+    bool copying = false;
+    bool changed = false;
+    for (Widget& widget : m_widgets) {
+        if (widget.pendingCopy < 0 && IsEmptyRect(widget.pendingRect)) continue;
+
+        const UINT regionWidth = static_cast<UINT>(widget.region.right - widget.region.left);
+        const UINT regionHeight = static_cast<UINT>(widget.region.bottom - widget.region.top);
+        const RECT& rect = widget.pendingRect;
+        const UINT64 bytes = widget.pendingCopy >= 0 ? static_cast<UINT64>(regionWidth) * regionHeight * 4 :
+            static_cast<UINT64>(rect.right - rect.left) * (rect.bottom - rect.top) * 4;
+
+        // Budget accrues up to one whole widget, so any paint gets through eventually
+        if (widget.uploadBudgetBytes > 0) {
+            const UINT64 creditLimit = std::max<UINT64>(static_cast<UINT64>(regionWidth) * regionHeight * 4, widget.uploadBudgetBytes);
+            widget.credit = std::min(widget.credit + widget.uploadBudgetBytes, creditLimit);
+            if (widget.credit < bytes) {
+                m_deferredUploads++;
+                continue;
+            }
+            widget.credit -= bytes;
+        }
+
+        // One transition each way for all the widgets copied this frame
+        if (!copying) {
+            m_resourceManager->TransitionResource(commandList, m_texture.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+            copying = true;
+        }
+
+        if (widget.pendingCopy >= 0) {
+            // The paint copy was finished before it was handed over; it decays back to COMMON
+            PaintCopy& copy = widget.paintCopies[widget.pendingCopy];
+            D3D12_BOX srcBox = {};
+            srcBox.right = std::min(widget.pendingCopyWidth, regionWidth);
+            srcBox.bottom = std::min(widget.pendingCopyHeight, regionHeight);
+            srcBox.back = 1;
+
+            D3D12_TEXTURE_COPY_LOCATION srcLocation = {};
+            srcLocation.pResource = copy.texture.Get();
+            srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+            srcLocation.SubresourceIndex = 0;
+
+            D3D12_TEXTURE_COPY_LOCATION dstLocation = {};
+            dstLocation.pResource = m_texture.Get();
+            dstLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+            dstLocation.SubresourceIndex = 0;
+
+            commandList->CopyTextureRegion(&dstLocation, widget.region.left, widget.region.top, 0, &srcLocation, &srcBox);
+            copy.fenceValue = m_renderSystem->GetCurrentFenceValue(); // Not written again before that
+            widget.pendingCopy = -1;
+        }
+        else {
+            const size_t pitch = static_cast<size_t>(regionWidth) * 4;
+            m_resourceManager->UpdateTexture(commandList, m_texture.Get(),
+                widget.pixels.data() + rect.top * pitch + rect.left * 4, pitch,
+                static_cast<UINT>(rect.right - rect.left), static_cast<UINT>(rect.bottom - rect.top),
+                static_cast<UINT>(widget.region.left + rect.left), static_cast<UINT>(widget.region.top + rect.top),
+                D3D12_RESOURCE_STATE_COPY_DEST);
+            widget.pendingRect = {};
+        }
+
+        widget.hasContent = true;
+        widget.version++;
+        m_uploadedBytes += bytes;
+        m_uploads++;
+        changed = true;
+    }
+
+    if (copying) {
+        m_resourceManager->TransitionResource(commandList, m_texture.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    }
+    UpdatePendingFlag();
+    return changed;
+}
+
+bool WebWidgetAtlas::GetWidgetRegion(int widgetId, D3D12_GPU_DESCRIPTOR_HANDLE& texture, float texRect[4], UINT64& version) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_texture) return false;
+    for (const Widget& widget : m_widgets) {
+        if (widget.id != widgetId) continue;
+        if (!widget.hasContent) return false;
+
+        m_resourceManager->NotifyResourceUsed(m_texture.Get());
+        texture = m_srv.gpuHandle;
+        const float scale = 1.0f / static_cast<float>(ATLAS_SIZE);
+        texRect[0] = widget.region.left * scale;
+        texRect[1] = widget.region.top * scale;
+        texRect[2] = widget.region.right * scale;
+        texRect[3] = widget.region.bottom * scale;
+        version = widget.version;
+        return true;
+    }
+    return false;
+}
+
+WebWidgetAtlas::Stats WebWidgetAtlas::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.widgets = static_cast<UINT>(m_widgets.size());
+    stats.uploadedBytes = m_uploadedBytes;
+    stats.uploads = m_uploads;
+    stats.deferredUploads = m_deferredUploads;
+    return stats;
+}
@@ -0,0 +1,123 @@
+// GameOverlay - WebWidgetAtlas.h
+// One texture shared by the pinned web widgets, each uploaded within its own budget
+
+#pragma once
+
+#include <windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "ResourceManager.h" // ResourceDescriptor
+
+// Forward declarations
+class RenderSystem;
+
+using Microsoft::WRL::ComPtr;
+
+// Pinned web widgets (chat, alerts, a map) are small browsers that stay visible; see
+// BrowserManager::PinWidget. Each gets a region of one ATLAS_SIZE texture with a single SRV, so
+// drawing all of them is one texture for the sprite batch and no per-widget texture or descriptor.
+//
+// Paints arrive on CEF's thread: software paints copy their dirty rows into the widget's staging
+// pixels, accelerated ones are copied out of CEF's shared texture into one of the widget's paint
+// copies before the callback returns (SharedTextureCopier). RecordUploads copies what's pending
+// into the atlas on the render thread. Every widget has a byte budget per frame that accrues while it
+// waits (up to one whole widget), so a busy page is shown less often rather than taking the
+// uploads of the others or arriving half done.
+class WebWidgetAtlas {
+public:
+    static constexpr UINT ATLAS_SIZE = 2048;
+    static constexpr int REGION_GAP = 2; // Pixels between regions, so filtering never bleeds
+
+    struct Stats {
+        UINT widgets = 0;
+        UINT64 uploadedBytes = 0;   // Since startup
+        UINT64 uploads = 0;
+        UINT64 deferredUploads = 0; // Frames a pending paint waited for its budget
+    };
+
+    WebWidgetAtlas(RenderSystem* renderSystem);
+    ~WebWidgetAtlas();
+
+    // Disable copy and move
+    WebWidgetAtlas(const WebWidgetAtlas&) = delete;
+    WebWidgetAtlas& operator=(const WebWidgetAtlas&) = delete;
+    WebWidgetAtlas(WebWidgetAtlas&&) = delete;
+    WebWidgetAtlas& operator=(WebWidgetAtlas&&) = delete;
+
+    // Main thread; false when the region doesn't fit. uploadBudgetBytes 0 = no limit
+    bool AddWidget(int widgetId, int width, int height, UINT64 uploadBudgetBytes);
+    void RemoveWidget(int widgetId);
+
+    // CEF thread; paints of ids without a region are ignored
+    void OnPaint(int widgetId, const void* buffer, int width, int height, const std::vector<RECT>& dirtyRects);
+    void OnAcceleratedPaint(int widgetId, HANDLE sharedHandle);
+
+    // Render thread
+    bool HasPendingUploads() const { return m_pendingUploads.load(std::memory_order_relaxed); }
+    bool RecordUploads(ID3D12GraphicsCommandList* commandList); // True when a widget's content changed
+    // The atlas and the widget's UVs (u0, v0, u1, v1); version changes with each upload. False until
+    // the widget has content.
+    bool GetWidgetRegion(int widgetId, D3D12_GPU_DESCRIPTOR_HANDLE& texture, float texRect[4], UINT64& version) const;
+
+    Stats GetStats() const;
+
+private:
+    struct PaintCopy {
+        ComPtr<ID3D12Resource> texture;
+        UINT64 fenceValue = 0; // Of the last frame that copied from it
+        bool writing = false;  // CEF's thread is copying into it
+    };
+
+    struct Widget {
+        int id = 0;
+        RECT region = {};              // Atlas pixels
+        UINT64 uploadBudgetBytes = 0;
+        UINT64 credit = 0;             // Budget accrued while a paint waits (render thread)
+        std::vector<uint8_t> pixels;   // Software paints, tightly packed BGRA at the region size
+        RECT pendingRect = {};         // Region-local; empty when nothing is pending
+        // Accelerated paints, at the region size. One is written by CEF's thread while the render
+        // thread's frames may still copy from others; more are made as they are needed.
+        std::vector<PaintCopy> paintCopies;
+        int pendingCopy = -1;           // Paint copy to upload; -1 when none
+        UINT pendingCopyWidth = 0;
+        UINT pendingCopyHeight = 0;
+        bool hasContent = false;
+        UINT64 version = 0;
+    };
+
+    Widget* FindWidget(int widgetId); // Caller holds m_mutex
+    bool AllocateRegion(int width, int height, RECT& region);
+    void RetirePaintCopies(Widget& widget); // Caller holds m_mutex
+    bool EnsureTexture();
+    void UpdatePendingFlag(); // Caller holds m_mutex
+
+    // Resource pointers (not owned)
+    RenderSystem* m_renderSystem = nullptr;
+    ResourceManager* m_resourceManager = nullptr;
+
+    mutable std::mutex m_mutex; // Widgets, against the CEF thread
+    std::vector<Widget> m_widgets;
+    std::atomic<bool> m_pendingUploads = false;
+
+    // Shelf packing; removed widgets leave regions that later widgets of a fitting size reuse
+    struct Shelf {
+        int y = 0;
+        int height = 0;
+        int usedWidth = 0;
+    };
+    std::vector<Shelf> m_shelves;
+    std::vector<RECT> m_freeRegions;
+
+    // Created with the first upload (render thread)
+    ComPtr<ID3D12Resource> m_texture;
+    ResourceDescriptor m_srv;
+    bool m_textureFailed = false;
+
+    UINT64 m_uploadedBytes = 0;
+    UINT64 m_uploads = 0;
+    UINT64 m_deferredUploads = 0;
+};
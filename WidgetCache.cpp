@@ -0,0 +1,168 @@
+// GameOverlay - WidgetCache.cpp
+// Replays a window's last draw output between refreshes at the widget's own update rate
+
+#include "WidgetCache.h"
+#include "imgui_internal.h" // ImGuiWindow: draw list, child windows, content extent
+#include <algorithm>
+#include <cstring>
+
+std::atomic<uint32_t> WidgetCache::s_generation{ 0 };
+bool WidgetCache::s_enabled = true;
+std::mutex WidgetCache::s_releaseMutex;
+std::vector<WidgetCache::ReleasedTexture> WidgetCache::s_releasedTextures;
+std::vector<WidgetCache::ReleasedTexture> WidgetCache::s_previousReleasedTextures;
+std::atomic<bool> WidgetCache::s_hasReleasedTextures{ false };
+
+void WidgetCache::ReleaseTexture(ImTextureID texture) {
+    if (!texture) return;
+    {
+        std::lock_guard<std::mutex> lock(s_releaseMutex);
+        s_releasedTextures.push_back({ texture, ++s_generation });
+        s_hasReleasedTextures.store(true, std::memory_order_release);
+    }
+}
+
+void WidgetCache::BeginFrame() {
+    if (!s_hasReleasedTextures.load(std::memory_order_acquire)) return;
+    std::lock_guard<std::mutex> lock(s_releaseMutex);
+    s_previousReleasedTextures.swap(s_releasedTextures);
+    s_releasedTextures.clear();
+    s_hasReleasedTextures.store(!s_previousReleasedTextures.empty(), std::memory_order_release);
+}
+
+bool WidgetCache::HasInput() const {
+    if (ImGui::IsAnyItemActive() || ImGui::IsPopupOpen("", ImGuiPopupFlags_AnyPopupId | ImGuiPopupFlags_AnyPopupLevel)) {
+        return true;
+    }
+    // Hovered at all: tooltips and hover highlights belong to the content
+    if (ImGui::IsWindowHovered(ImGuiHoveredFlags_RootAndChildWindows | ImGuiHoveredFlags_AllowWhenBlockedByActiveItem)) {
+        return true;
+    }
+    if (ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows)) {
+        const ImGuiIO& io = ImGui::GetIO();
+        if (io.InputQueueCharacters.Size > 0) return true;
+        for (int key = ImGuiKey_NamedKey_BEGIN; key < ImGuiKey_NamedKey_END; key++) {
+            if (ImGui::IsKeyDown(static_cast<ImGuiKey>(key)) || ImGui::IsKeyReleased(static_cast<ImGuiKey>(key))) return true;
+        }
+    }
+    return false;
+}
+
+bool WidgetCache::BeginContent(float refreshHz) {
+    ImGuiWindow* window = ImGui::GetCurrentWindow();
+    const double now = ImGui::GetTime();
+    m_capturing = false;
+
+    bool refresh = !s_enabled || refreshHz <= 0.0f || !m_valid || m_generation != s_generation ||
+        now >= m_nextRefresh || window->Pos.x != m_windowPos.x || window->Pos.y != m_windowPos.y ||
+        window->Size.x != m_windowSize.x || window->Size.y != m_windowSize.y || HasInput();
+    if (!refresh) {
+        Replay();
+        window->DC.CursorMaxPos = ImVec2(window->Pos.x + m_cursorMaxPos.x, window->Pos.y + m_cursorMaxPos.y);
+        window->DC.IdealMaxPos = ImVec2(window->Pos.x + m_idealMaxPos.x, window->Pos.y + m_idealMaxPos.y);
+        return false;
+    }
+
+    m_valid = false;
+    if (s_enabled && refreshHz > 0.0f) {
+        m_capturing = true;
+        m_captureIndexStart = window->DrawList->IdxBuffer.Size;
+        m_nextRefresh = now + 1.0 / refreshHz;
+    }
+    return true;
+}
+
+void WidgetCache::EndContent() {
+    if (!m_capturing) return;
+    m_capturing = false;
+
+    ImGuiWindow* window = ImGui::GetCurrentWindow();
+    m_commands.clear();
+    m_vertices.clear();
+    m_indices.clear();
+    m_captureFailed = false;
+
+    // The order ImGui::Render uses: the window's list, then each visible child, depth first
+    CaptureList(window->DrawList, m_captureIndexStart);
+    std::vector<ImGuiWindow*> pending(window->DC.ChildWindows.begin(), window->DC.ChildWindows.end());
+    std::reverse(pending.begin(), pending.end());
+    while (!pending.empty()) {
+        ImGuiWindow* child = pending.back();
+        pending.pop_back();
+        if (!child->Active || child->Hidden) continue;
+        CaptureList(child->DrawList, 0);
+        for (int i = child->DC.ChildWindows.Size - 1; i >= 0; i--) pending.push_back(child->DC.ChildWindows[i]);
+    }
+    if (m_captureFailed) return;
+
+    m_windowPos = window->Pos;
+    m_windowSize = window->Size;
+    m_cursorMaxPos = ImVec2(window->DC.CursorMaxPos.x - window->Pos.x, window->DC.CursorMaxPos.y - window->Pos.y);
+    m_idealMaxPos = ImVec2(window->DC.IdealMaxPos.x - window->Pos.x, window->DC.IdealMaxPos.y - window->Pos.y);
+    m_generation = s_generation;
+    m_valid = true;
+}
+
+void WidgetCache::CaptureList(const ImDrawList* drawList, int firstIndex) {
+    for (const ImDrawCmd& cmd : drawList->CmdBuffer) {
+        const int begin = std::max(static_cast<int>(cmd.IdxOffset), firstIndex);
+        const int end = static_cast<int>(cmd.IdxOffset + cmd.ElemCount);
+        if (begin >= end) continue;
+        if (cmd.UserCallback) {
+            m_captureFailed = true; // Can't be replayed; this refresh isn't cached
+            return;
+        }
+
+        // Only the vertices this command uses, so indices can be rebased
+        unsigned minIndex = UINT32_MAX;
+        unsigned maxIndex = 0;
+        for (int i = begin; i < end; i++) {
+            minIndex = std::min<unsigned>(minIndex, drawList->IdxBuffer[i]);
+            maxIndex = std::max<unsigned>(maxIndex, drawList->IdxBuffer[i]);
+        }
+
+        Command command;
+        command.clipRect = cmd.ClipRect;
+        command.texture = cmd.GetTexID();
+        command.firstVertex = static_cast<uint32_t>(m_vertices.size());
+        command.vertexCount = maxIndex - minIndex + 1;
+        command.firstIndex = static_cast<uint32_t>(m_indices.size());
+        command.indexCount = static_cast<uint32_t>(end - begin);
+        const ImDrawVert* vertices = drawList->VtxBuffer.Data + cmd.VtxOffset + minIndex;
+        m_vertices.insert(m_vertices.end(), vertices, vertices + command.vertexCount);
+        for (int i = begin; i < end; i++) {
+            m_indices.push_back(static_cast<ImDrawIdx>(drawList->IdxBuffer[i] - minIndex));
+        }
+        m_commands.push_back(command);
+    }
+}
+
+void WidgetCache::Replay() {
+    // A release between the refresh check and here; the next BeginContent refreshes anyway
+    std::unique_lock<std::mutex> releaseLock(s_releaseMutex, std::defer_lock);
+    if (s_hasReleasedTextures.load(std::memory_order_acquire)) releaseLock.lock();
+    auto isReleased = [this](ImTextureID texture) {
+        auto released = [&](const ReleasedTexture& entry) {
+            return entry.texture == texture && static_cast<int32_t>(m_generation - entry.generation) < 0;
+        };
+        return std::any_of(s_releasedTextures.begin(), s_releasedTextures.end(), released) ||
+            std::any_of(s_previousReleasedTextures.begin(), s_previousReleasedTextures.end(), released);
+    };
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    for (const Command& command : m_commands) {
+        if (releaseLock.owns_lock() && isReleased(command.texture)) continue;
+        drawList->PushClipRect(ImVec2(command.clipRect.x, command.clipRect.y), ImVec2(command.clipRect.z, command.clipRect.w));
+        drawList->PushTextureID(command.texture);
+        drawList->PrimReserve(static_cast<int>(command.indexCount), static_cast<int>(command.vertexCount));
+        memcpy(drawList->_VtxWritePtr, m_vertices.data() + command.firstVertex, command.vertexCount * sizeof(ImDrawVert));
+        const ImDrawIdx base = static_cast<ImDrawIdx>(drawList->_VtxCurrentIdx);
+        const ImDrawIdx* indices = m_indices.data() + command.firstIndex;
+        for (uint32_t i = 0; i < command.indexCount; i++) drawList->_IdxWritePtr[i] = static_cast<ImDrawIdx>(indices[i] + base);
+        drawList->_VtxWritePtr += command.vertexCount;
+        drawList->_IdxWritePtr += command.indexCount;
+        drawList->_VtxCurrentIdx += command.vertexCount;
+        drawList->PopTextureID();
+        drawList->PopClipRect();
+    }
+}
@@ -0,0 +1,83 @@
+// GameOverlay - WidgetCache.h
+// Replays a window's last draw output between refreshes at the widget's own update rate
+
+#pragma once
+
+#include "imgui.h"
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+// One per ImGui window (panel). Between Begin and End, BeginContent decides whether the content
+// is submitted this frame: when the refresh interval has passed, when the window has input
+// (hovered, focused while keys are down, an active item, an open popup), or when it was
+// invalidated. Otherwise the vertices and commands captured at the last refresh (the window's
+// own content and its child windows, flattened in draw order) are appended to the window's draw
+// list and the content's layout, formatting and child windows are skipped.
+//
+// The capture goes stale when the window moves or resizes (checked), when the font atlas is
+// rebuilt or colors change (InvalidateAll), and when a texture it may draw is released
+// (ReleaseTexture). Content with draw callbacks is never cached.
+class WidgetCache {
+public:
+    WidgetCache() = default;
+
+    // Right after ImGui::Begin. refreshHz <= 0 refreshes every frame. True: submit the content,
+    // then call EndContent before ImGui::End. False: the last content was replayed.
+    bool BeginContent(float refreshHz);
+    void EndContent();
+
+    void Invalidate() { m_valid = false; }
+    static void InvalidateAll() { s_generation++; }
+
+    // Any thread, before the texture's descriptor is freed: every cache refreshes, and a replay
+    // already past its refresh check drops the texture's commands. Releases are forgotten at the
+    // second BeginFrame after them, once every build has seen the new generation.
+    static void ReleaseTexture(ImTextureID texture);
+    static void BeginFrame(); // Before the frame's first window (ImGuiSystem::BeginFrame)
+
+    static void SetEnabled(bool enabled) { s_enabled = enabled; InvalidateAll(); }
+    static bool IsEnabled() { return s_enabled; }
+
+private:
+    struct Command {
+        ImVec4 clipRect;
+        ImTextureID texture;
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+        uint32_t firstIndex; // Indices are relative to firstVertex
+        uint32_t indexCount;
+    };
+
+    bool HasInput() const;
+    void CaptureList(const ImDrawList* drawList, int firstIndex);
+    void Replay();
+
+    std::vector<Command> m_commands;
+    std::vector<ImDrawVert> m_vertices;
+    std::vector<ImDrawIdx> m_indices;
+
+    bool m_valid = false;
+    bool m_capturing = false;
+    bool m_captureFailed = false;
+    uint32_t m_generation = 0;
+    int m_captureIndexStart = 0; // The window's index count at BeginContent
+    double m_nextRefresh = 0.0;
+    ImVec2 m_windowPos;
+    ImVec2 m_windowSize;
+    ImVec2 m_cursorMaxPos;       // Content extent, so scrolling and auto-sizing see the same content
+    ImVec2 m_idealMaxPos;
+
+    static std::atomic<uint32_t> s_generation;
+    static bool s_enabled;
+
+    static std::mutex s_releaseMutex;
+    struct ReleasedTexture {
+        ImTextureID texture;
+        uint32_t generation; // Captures from earlier generations may draw it
+    };
+    static std::vector<ReleasedTexture> s_releasedTextures;         // Since this frame began
+    static std::vector<ReleasedTexture> s_previousReleasedTextures; // During the frame before
+    static std::atomic<bool> s_hasReleasedTextures;
+};
@@ -3,9 +3,15 @@
 // Manages the transparent overlay window
 
 #include "WindowManager.h"
+#include <windowsx.h> // GET_X_LPARAM
+#include <ShellScalingApi.h> // GetDpiForMonitor
 #include <stdexcept>
+#include <algorithm>
 
-WindowManager::WindowManager(HINSTANCE hInstance, WNDPROC windowProc) {
+#pragma comment(lib, "shcore.lib")
+
+WindowManager::WindowManager(HINSTANCE hInstance, WNDPROC windowProc, bool useComposition)
+    : m_useComposition(useComposition) {
     RegisterWindowClass(hInstance, windowProc);
     CreateOverlayWindow(hInstance);
 }
@@ -41,16 +47,24 @@ void WindowManager::RegisterWindowClass(HINSTANCE hInstance, WNDPROC windowProc)
 }
 
 void WindowManager::CreateOverlayWindow(HINSTANCE hInstance) {
-    // Get screen dimensions for fullscreen overlay
-    int screenWidth = GetSystemMetrics(SM_CXSCREEN);
-    int screenHeight = GetSystemMetrics(SM_CYSCREEN);
-
-    // Update member variables
-    m_width = screenWidth;
-    m_height = screenHeight;
+    // Fullscreen on the monitor of whatever is in front (the game, when started from it)
+    HWND foreground = GetForegroundWindow();
+    if (!ReadMonitor(MonitorFromWindow(foreground, MONITOR_DEFAULTTOPRIMARY))) {
+        m_screenRect = { 0, 0, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN) };
+    }
+    m_x = m_screenRect.left;
+    m_y = m_screenRect.top;
+    m_width = m_screenRect.right - m_screenRect.left;
+    m_height = m_screenRect.bottom - m_screenRect.top;
 
     // Create a layered window for transparency
+    // WS_EX_LAYERED is kept in composition mode so WS_EX_TRANSPARENT click-through still works.
+    // Click-through until the first hit mask shows a panel under the cursor (UpdateClickThrough).
     DWORD exStyle = WS_EX_LAYERED | WS_EX_TOPMOST | WS_EX_TRANSPARENT;
+    if (m_useComposition) {
+        // No redirection surface; content comes from the DirectComposition visual
+        exStyle |= WS_EX_NOREDIRECTIONBITMAP;
+    }
     DWORD style = WS_POPUP | WS_VISIBLE;
 
     // Create the window
@@ -59,7 +73,7 @@ void WindowManager::CreateOverlayWindow(HINSTANCE hInstance) {
         m_windowClassName.c_str(),
         m_windowTitle.c_str(),
         style,
-        0, 0,
+        m_x, m_y,
         m_width, m_height,
         nullptr,
         nullptr,
@@ -72,8 +86,14 @@ void WindowManager::CreateOverlayWindow(HINSTANCE hInstance) {
     }
 
     // Set the layered window attributes for transparency
-    // Using LWA_COLORKEY for color-based transparency
-    SetLayeredWindowAttributes(m_hwnd, RGB(0, 0, 0), 0, LWA_COLORKEY);
+    if (m_useComposition) {
+        // Opaque layer; per-pixel alpha comes from the premultiplied swap chain
+        SetLayeredWindowAttributes(m_hwnd, 0, 255, LWA_ALPHA);
+    }
+    else {
+        // Using LWA_COLORKEY for color-based transparency
+        SetLayeredWindowAttributes(m_hwnd, RGB(0, 0, 0), 0, LWA_COLORKEY);
+    }
 
     // Show the window
     ShowWindow(m_hwnd, SW_SHOW);
@@ -96,23 +116,157 @@ void WindowManager::HandleResize(int width, int height) {
     );
 }
 
+RECT WindowManager::GetCompactBounds(const RECT& content) const {
+    // Padded, snapped out to the grid and kept on screen
+    RECT needed = { m_x, m_y, m_x + COMPACT_GRID, m_y + COMPACT_GRID };
+    if (content.right > content.left && content.bottom > content.top) {
+        needed.left = (content.left - COMPACT_PADDING) / COMPACT_GRID * COMPACT_GRID;
+        needed.top = (content.top - COMPACT_PADDING) / COMPACT_GRID * COMPACT_GRID;
+        needed.right = (content.right + COMPACT_PADDING + COMPACT_GRID - 1) / COMPACT_GRID * COMPACT_GRID;
+        needed.bottom = (content.bottom + COMPACT_PADDING + COMPACT_GRID - 1) / COMPACT_GRID * COMPACT_GRID;
+    }
+    IntersectRect(&needed, &needed, &m_screenRect);
+    const int neededWidth = std::max<int>(needed.right - needed.left, 1);
+    const int neededHeight = std::max<int>(needed.bottom - needed.top, 1);
+
+    int width = m_width;
+    int height = m_height;
+    if (width < neededWidth || height < neededHeight ||
+        static_cast<long long>(width) * height > 2LL * neededWidth * neededHeight) {
+        width = neededWidth;
+        height = neededHeight;
+    }
+
+    // The current position when the content fits, else shifted just enough
+    const int x = std::clamp(std::clamp(m_x, static_cast<int>(needed.right) - width, static_cast<int>(needed.left)),
+        static_cast<int>(m_screenRect.left), std::max(static_cast<int>(m_screenRect.right) - width, static_cast<int>(m_screenRect.left)));
+    const int y = std::clamp(std::clamp(m_y, static_cast<int>(needed.bottom) - height, static_cast<int>(needed.top)),
+        static_cast<int>(m_screenRect.top), std::max(static_cast<int>(m_screenRect.bottom) - height, static_cast<int>(m_screenRect.top)));
+    return { x, y, x + width, y + height };
+}
+
+void WindowManager::SetBounds(const RECT& bounds) {
+    const int width = bounds.right - bounds.left;
+    const int height = bounds.bottom - bounds.top;
+    if (width <= 0 || height <= 0) return;
+    if (bounds.left == m_x && bounds.top == m_y && width == m_width && height == m_height) return;
+
+    m_x = bounds.left;
+    m_y = bounds.top;
+    m_width = width;
+    m_height = height;
+    SetWindowPos(m_hwnd, nullptr, m_x, m_y, m_width, m_height, SWP_NOZORDER | SWP_NOACTIVATE);
+}
+
+bool WindowManager::ReadMonitor(HMONITOR monitor) {
+    MONITORINFO info = {};
+    info.cbSize = sizeof(info);
+    if (!monitor || !GetMonitorInfo(monitor, &info)) return false;
+
+    UINT dpiX = USER_DEFAULT_SCREEN_DPI;
+    UINT dpiY = USER_DEFAULT_SCREEN_DPI;
+    if (FAILED(GetDpiForMonitor(monitor, MDT_EFFECTIVE_DPI, &dpiX, &dpiY))) {
+        dpiX = USER_DEFAULT_SCREEN_DPI;
+    }
+
+    const bool changed = !EqualRect(&info.rcMonitor, &m_screenRect) || dpiX != m_dpi;
+    m_monitor = monitor;
+    m_screenRect = info.rcMonitor;
+    m_dpi = dpiX;
+    return changed;
+}
+
+bool WindowManager::FollowMonitor(HWND window, bool coverMonitor) {
+    // Until another window was in front (or while it is minimized) the overlay stays where it is
+    if (!window || !IsWindow(window) || IsIconic(window)) window = m_hwnd;
+    HMONITOR monitor = MonitorFromWindow(window, MONITOR_DEFAULTTONEAREST);
+    if (monitor == m_monitor || !ReadMonitor(monitor)) return false;
+
+    if (coverMonitor) {
+        SetBounds(m_screenRect);
+    }
+    return true;
+}
+
 void WindowManager::SetActive(bool active) {
+    // Inactive: HitTest fails everywhere, so the whole window becomes click-through
     m_isActive = active;
+    UpdateClickThrough();
+
+    if (m_stateChangedCallback) m_stateChangedCallback();
+}
 
-    // When active: Allow input to pass through to the window
-    // When inactive: Make window click-through (transparent to mouse input)
-    LONG exStyle = GetWindowLong(m_hwnd, GWL_EXSTYLE);
+void WindowManager::SetHitRects(const std::vector<RECT>& rects) {
+    int columns = (m_width + HIT_CELL - 1) / HIT_CELL;
+    int rows = (m_height + HIT_CELL - 1) / HIT_CELL;
+    int stride = (columns + 63) / 64;
+    if (columns != m_hitColumns || rows != m_hitRows) {
+        m_hitColumns = columns;
+        m_hitRows = rows;
+        m_hitStride = stride;
+    }
+    m_hitMask.assign(static_cast<size_t>(stride) * rows, 0);
 
-    if (active) {
-        // Remove WS_EX_TRANSPARENT flag to receive mouse input
-        exStyle &= ~WS_EX_TRANSPARENT;
+    // Cells a rect touches at all are hits: a panel's edge never lets a click through
+    for (const RECT& rect : rects) {
+        int left = std::max<int>(rect.left, 0) / HIT_CELL;
+        int top = std::max<int>(rect.top, 0) / HIT_CELL;
+        int right = std::min<int>((rect.right + HIT_CELL - 1) / HIT_CELL, columns);
+        int bottom = std::min<int>((rect.bottom + HIT_CELL - 1) / HIT_CELL, rows);
+        for (int row = top; row < bottom; row++) {
+            uint64_t* words = m_hitMask.data() + static_cast<size_t>(row) * stride;
+            for (int column = left; column < right; column++) {
+                words[column / 64] |= 1ull << (column % 64);
+            }
+        }
     }
-    else {
-        // Add WS_EX_TRANSPARENT flag to pass mouse input through
-        exStyle |= WS_EX_TRANSPARENT;
+    UpdateClickThrough();
+}
+
+bool WindowManager::HitTest(POINT screenPoint) const {
+    return HitTestNear(screenPoint, 0);
+}
+
+bool WindowManager::HitTestNear(POINT screenPoint, int cells) const {
+    if (!m_isActive || !m_isVisible || m_hitMask.empty()) return false;
+    if (screenPoint.x < m_x - cells * HIT_CELL || screenPoint.y < m_y - cells * HIT_CELL) return false;
+    int column = (screenPoint.x - m_x + cells * HIT_CELL) / HIT_CELL - cells;
+    int row = (screenPoint.y - m_y + cells * HIT_CELL) / HIT_CELL - cells;
+    for (int y = std::max(row - cells, 0); y <= std::min(row + cells, m_hitRows - 1); y++) {
+        const uint64_t* words = m_hitMask.data() + static_cast<size_t>(y) * m_hitStride;
+        for (int x = std::max(column - cells, 0); x <= std::min(column + cells, m_hitColumns - 1); x++) {
+            if ((words[x / 64] >> (x % 64)) & 1) return true;
+        }
+    }
+    return false;
+}
+
+LRESULT WindowManager::OnNcHitTest(LPARAM lParam) const {
+    POINT point = { GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam) };
+    return HitTest(point) ? HTCLIENT : HTTRANSPARENT;
+}
+
+void WindowManager::UpdateClickThrough() {
+    if (!m_hwnd) return;
+    POINT cursor = {};
+    GetCursorPos(&cursor);
+    bool clickThrough = m_clickThrough ? !HitTest(cursor) : !HitTestNear(cursor, HIT_HYSTERESIS_CELLS);
+
+    // Only when the cursor crossed a panel edge (or the overlay was activated or deactivated)
+    if (clickThrough != m_clickThrough) {
+        LONG exStyle = GetWindowLong(m_hwnd, GWL_EXSTYLE);
+        exStyle = clickThrough ? (exStyle | WS_EX_TRANSPARENT) : (exStyle & ~WS_EX_TRANSPARENT);
+        SetWindowLong(m_hwnd, GWL_EXSTYLE, exStyle);
+        m_clickThrough = clickThrough;
     }
 
-    SetWindowLong(m_hwnd, GWL_EXSTYLE, exStyle);
+    // A click-through window sees no mouse moves; poll for the cursor coming back over a panel
+    bool needTimer = m_isActive && m_clickThrough && m_isVisible;
+    if (needTimer != m_hitTimerRunning) {
+        if (needTimer) SetTimer(m_hwnd, HIT_TEST_TIMER_ID, HIT_TEST_TIMER_MS, nullptr);
+        else KillTimer(m_hwnd, HIT_TEST_TIMER_ID);
+        m_hitTimerRunning = needTimer;
+    }
 }
 
 void WindowManager::SetVisible(bool visible) {
@@ -124,5 +278,21 @@ void WindowManager::SetVisible(bool visible) {
     }
     else {
         ShowWindow(m_hwnd, SW_HIDE);
+        if (m_shownWhileHidden) {
+            // Hidden first, so activation passes to the window beneath (the game)
+            ShowWindow(m_hwnd, SW_SHOWNA);
+        }
+    }
+    UpdateClickThrough(); // Stops the cursor poll while hidden
+
+    if (m_stateChangedCallback) m_stateChangedCallback();
+}
+
+void WindowManager::SetShownWhileHidden(bool shown) {
+    if (shown == m_shownWhileHidden) return;
+    m_shownWhileHidden = shown;
+    if (!m_isVisible) {
+        ShowWindow(m_hwnd, shown ? SW_SHOWNA : SW_HIDE);
+        if (m_stateChangedCallback) m_stateChangedCallback();
     }
 }
@@ -6,11 +6,14 @@
 
 #include <Windows.h>
 #include <string>
+#include <vector>
 #include <functional>
+#include <cstdint>
 
 class WindowManager {
 public:
-    WindowManager(HINSTANCE hInstance, WNDPROC windowProc);
+    // useComposition: present through DirectComposition (per-pixel alpha) instead of a color-keyed layered window
+    WindowManager(HINSTANCE hInstance, WNDPROC windowProc, bool useComposition = true);
     ~WindowManager();
 
     // Disable copy and move
@@ -23,6 +26,7 @@ public:
     HWND GetHWND() const { return m_hwnd; }
     int GetWidth() const { return m_width; }
     int GetHeight() const { return m_height; }
+    bool UsesComposition() const { return m_useComposition; }
 
     // Handle window resize
     void HandleResize(int width, int height);
@@ -31,19 +35,88 @@ public:
     void SetActive(bool active);
     bool IsActive() const { return m_isActive; }
 
-    // Visibility management
+    // Visibility management. Hidden hides the panels; with SetShownWhileHidden (the HUD) the
+    // window itself stays up, click-through everywhere and without activation.
     void SetVisible(bool visible);
     bool IsVisible() const { return m_isVisible; }
+    void SetShownWhileHidden(bool shown);
+    bool IsWindowShown() const { return m_isVisible || m_shownWhileHidden; }
+    bool IsMinimized() const { return m_hwnd && IsIconic(m_hwnd); }
+
+    // --- Hit Testing ---
+    // Panels take the mouse, everything else goes to the game. SetHitRects (once per frame, from
+    // the ImGui window rectangles) rasterizes them into a mask of HIT_CELL-pixel cells, and
+    // WM_NCHITTEST answers from it. Windows only passes HTTRANSPARENT on to windows of the same
+    // thread, so for the game to get a click the window also needs WS_EX_TRANSPARENT while the
+    // cursor is outside every panel: UpdateClickThrough switches it only when the cursor crosses
+    // a panel edge. Leaving takes HIT_HYSTERESIS_CELLS of clearance around the cursor, so a cursor
+    // resting on an edge doesn't restyle the window (DWM re-evaluates it each time) back and forth.
+    // That check runs each frame, and on a timer while click-through, because a transparent window
+    // gets no mouse messages.
+    static constexpr int HIT_CELL = 16;
+    static constexpr int HIT_HYSTERESIS_CELLS = 1;
+    static constexpr UINT_PTR HIT_TEST_TIMER_ID = 0x4854;
+    static constexpr UINT HIT_TEST_TIMER_MS = 33;
+    void SetHitRects(const std::vector<RECT>& rects); // Client coordinates
+    bool HitTest(POINT screenPoint) const;            // Over a panel of the active overlay
+    bool HitTestNear(POINT screenPoint, int cells) const; // Within cells of one
+    LRESULT OnNcHitTest(LPARAM lParam) const;
+    void UpdateClickThrough();
+
+    // Called after SetActive or SetVisible changes the window state
+    void SetStateChangedCallback(std::function<void()> callback) { m_stateChangedCallback = std::move(callback); }
+
+    // --- Compact Mode ---
+    // The window covers only the visible panels instead of the whole screen (see
+    // ImGuiSystem::SetCompactWindow). GetCompactBounds pads the content and rounds it out to
+    // COMPACT_GRID, and keeps the current size while the content fits in it and fills at least half
+    // of it, so a panel being dragged moves the window rather than resizing the swap chain.
+    static constexpr int COMPACT_PADDING = 16;
+    static constexpr int COMPACT_GRID = 64;
+    const RECT& GetScreenRect() const { return m_screenRect; } // The full-screen bounds
+    RECT GetBounds() const { return { m_x, m_y, m_x + m_width, m_y + m_height }; }
+    RECT GetCompactBounds(const RECT& content) const; // An empty content rect gives a minimal window
+    void SetBounds(const RECT& bounds);
+
+    // --- Monitor ---
+    // The process is per-monitor DPI aware (v2), so the screen rect is the monitor's native
+    // resolution and DWM never stretches the swap chain. The overlay starts on the foreground
+    // window's monitor; FollowMonitor moves it to the monitor showing the given window (the game)
+    // and returns true when the screen rect or DPI changed, so the caller resizes the swap chain
+    // and rescales the UI. With coverMonitor the window is resized to the whole monitor, otherwise
+    // (compact window) only the screen rect changes. Once a frame; InvalidateMonitor re-reads the
+    // monitor on the next call (display or DPI settings changed).
+    bool FollowMonitor(HWND window, bool coverMonitor);
+    void InvalidateMonitor() { m_monitor = nullptr; }
+    UINT GetDpi() const { return m_dpi; }
+    float GetDpiScale() const { return static_cast<float>(m_dpi) / USER_DEFAULT_SCREEN_DPI; }
 
 private:
     void RegisterWindowClass(HINSTANCE hInstance, WNDPROC windowProc);
     void CreateOverlayWindow(HINSTANCE hInstance);
+    bool ReadMonitor(HMONITOR monitor); // Screen rect and DPI; true when either changed
 
     HWND m_hwnd = nullptr;
+    RECT m_screenRect = {};
+    HMONITOR m_monitor = nullptr;
+    UINT m_dpi = USER_DEFAULT_SCREEN_DPI;
+    int m_x = 0;
+    int m_y = 0;
     int m_width = 1280;
     int m_height = 720;
     std::wstring m_windowClassName = L"GameOverlayWindowClass";
     std::wstring m_windowTitle = L"GameOverlay";
     bool m_isActive = true;
     bool m_isVisible = true;
+    bool m_shownWhileHidden = false;
+    bool m_useComposition = true;
+    std::function<void()> m_stateChangedCallback;
+
+    // Hit mask: one bit per cell, rows of m_hitStride words
+    std::vector<uint64_t> m_hitMask;
+    int m_hitColumns = 0;
+    int m_hitRows = 0;
+    int m_hitStride = 0;
+    bool m_clickThrough = true; // WS_EX_TRANSPARENT is set
+    bool m_hitTimerRunning = false;
 };
\ No newline at end of file
@@ -89,6 +89,12 @@ struct ImGui_ImplDX12_Data
     ImGui_ImplDX12_Texture      FontTexture;
     bool                        LegacySingleDescriptorUsed;
 
+    // Bindless: texture ids are turned into indices into pd3dSrvDescHeap
+    bool                        Bindless;
+    UINT64                      SrvHeapGpuStart;
+    UINT                        SrvDescriptorSize;
+    ImVector<UINT>              BindlessTexScratch; // Per vertex of the list being written
+
     ImGui_ImplDX12_Data()       { memset((void*)this, 0, sizeof(*this)); frameIndex = UINT_MAX; }
 };
 
@@ -106,6 +112,10 @@ struct ImGui_ImplDX12_RenderBuffers
     ID3D12Resource*     VertexBuffer;
     int                 IndexBufferSize;
     int                 VertexBufferSize;
+
+    // Bound by SetupRenderState: the buffers above, or this call's GeometryAllocFn memory
+    D3D12_VERTEX_BUFFER_VIEW VertexBufferView;
+    D3D12_INDEX_BUFFER_VIEW  IndexBufferView;
 };
 
 struct VERTEX_CONSTANT_BUFFER_DX12
@@ -113,6 +123,76 @@ struct VERTEX_CONSTANT_BUFFER_DX12
     float   mvp[4][4];
 };
 
+// Vertex of the bindless pipeline: ImDrawVert plus the heap index of the texture it samples
+struct ImGui_ImplDX12_BindlessVert
+{
+    ImVec2  pos;
+    ImVec2  uv;
+    ImU32   col;
+    UINT    tex;
+};
+
+// Draws merged by the bindless path, not issued yet
+struct ImGui_ImplDX12_MergedDraw
+{
+    D3D12_RECT  Scissor;
+    UINT        IdxStart;
+    UINT        IdxCount;
+    INT         VtxStart;
+};
+
+static UINT ImGui_ImplDX12_GetHeapIndex(ImGui_ImplDX12_Data* bd, ImTextureID tex_id)
+{
+    UINT64 ptr = (UINT64)tex_id;
+    IM_ASSERT(ptr >= bd->SrvHeapGpuStart && "Bindless texture ids must be GPU handles in SrvDescriptorHeap");
+    return ptr >= bd->SrvHeapGpuStart ? (UINT)((ptr - bd->SrvHeapGpuStart) / bd->SrvDescriptorSize) : 0;
+}
+
+// Copies one list's vertices; returns the bytes written. Bindless vertices get the heap index of the command
+// that indexes them (a list's commands don't share vertices).
+static UINT64 ImGui_ImplDX12_WriteVertices(ImGui_ImplDX12_Data* bd, const ImDrawList* draw_list, void* dst)
+{
+    const int vtx_count = draw_list->VtxBuffer.Size;
+    if (!bd->Bindless)
+    {
+        memcpy(dst, draw_list->VtxBuffer.Data, vtx_count * sizeof(ImDrawVert));
+        return (UINT64)vtx_count * sizeof(ImDrawVert);
+    }
+
+    ImVector<UINT>& tex = bd->BindlessTexScratch;
+    tex.resize(vtx_count);
+    if (vtx_count > 0)
+        memset(tex.Data, 0, (size_t)vtx_count * sizeof(UINT));
+    for (const ImDrawCmd& cmd : draw_list->CmdBuffer)
+    {
+        if (cmd.UserCallback != nullptr)
+            continue;
+        const UINT index = ImGui_ImplDX12_GetHeapIndex(bd, cmd.GetTexID());
+        const ImDrawIdx* idx = draw_list->IdxBuffer.Data + cmd.IdxOffset;
+        for (unsigned int i = 0; i < cmd.ElemCount; i++)
+            tex.Data[cmd.VtxOffset + idx[i]] = index;
+    }
+
+    // Whole vertices in order: dst is usually write-combined upload memory
+    const ImDrawVert* src = draw_list->VtxBuffer.Data;
+    ImGui_ImplDX12_BindlessVert* vtx_dst = (ImGui_ImplDX12_BindlessVert*)dst;
+    for (int i = 0; i < vtx_count; i++)
+    {
+        const ImGui_ImplDX12_BindlessVert v = { src[i].pos, src[i].uv, src[i].col, tex.Data[i] };
+        vtx_dst[i] = v;
+    }
+    return (UINT64)vtx_count * sizeof(ImGui_ImplDX12_BindlessVert);
+}
+
+static void ImGui_ImplDX12_FlushMergedDraw(ID3D12GraphicsCommandList* command_list, ImGui_ImplDX12_MergedDraw* draw)
+{
+    if (draw->IdxCount == 0)
+        return;
+    command_list->RSSetScissorRects(1, &draw->Scissor);
+    command_list->DrawIndexedInstanced(draw->IdxCount, 1, draw->IdxStart, draw->VtxStart, 0);
+    draw->IdxCount = 0;
+}
+
 // Functions
 static void ImGui_ImplDX12_SetupRenderState(ImDrawData* draw_data, ID3D12GraphicsCommandList* command_list, ImGui_ImplDX12_RenderBuffers* fr)
 {
@@ -146,18 +226,8 @@ static void ImGui_ImplDX12_SetupRenderState(ImDrawData* draw_data, ID3D12Graphic
     command_list->RSSetViewports(1, &vp);
 
     // Bind shader and vertex buffers
-    unsigned int stride = sizeof(ImDrawVert);
-    unsigned int offset = 0;
-    D3D12_VERTEX_BUFFER_VIEW vbv = {};
-    vbv.BufferLocation = fr->VertexBuffer->GetGPUVirtualAddress() + offset;
-    vbv.SizeInBytes = fr->VertexBufferSize * stride;
-    vbv.StrideInBytes = stride;
-    command_list->IASetVertexBuffers(0, 1, &vbv);
-    D3D12_INDEX_BUFFER_VIEW ibv = {};
-    ibv.BufferLocation = fr->IndexBuffer->GetGPUVirtualAddress();
-    ibv.SizeInBytes = fr->IndexBufferSize * sizeof(ImDrawIdx);
-    ibv.Format = sizeof(ImDrawIdx) == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
-    command_list->IASetIndexBuffer(&ibv);
+    command_list->IASetVertexBuffers(0, 1, &fr->VertexBufferView);
+    command_list->IASetIndexBuffer(&fr->IndexBufferView);
     command_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
     command_list->SetPipelineState(bd->pPipelineState);
     command_list->SetGraphicsRootSignature(bd->pRootSignature);
@@ -188,77 +258,112 @@ void ImGui_ImplDX12_RenderDrawData(ImDrawData* draw_data, ID3D12GraphicsCommandL
     bd->frameIndex = bd->frameIndex + 1;
     ImGui_ImplDX12_RenderBuffers* fr = &bd->pFrameResources[bd->frameIndex % bd->numFramesInFlight];
 
-    // Create and grow vertex/index buffers if needed
-    if (fr->VertexBuffer == nullptr || fr->VertexBufferSize < draw_data->TotalVtxCount)
+    // Application-provided geometry memory: already mapped, so the data is written in place (indices after vertices)
+    const UINT vtx_stride = bd->Bindless ? (UINT)sizeof(ImGui_ImplDX12_BindlessVert) : (UINT)sizeof(ImDrawVert);
+    const UINT64 vtx_bytes = (UINT64)draw_data->TotalVtxCount * vtx_stride;
+    const UINT64 idx_bytes = (UINT64)draw_data->TotalIdxCount * sizeof(ImDrawIdx);
+    const UINT64 idx_offset = (vtx_bytes + 15) & ~(UINT64)15;
+    void* geometry_cpu = nullptr;
+    D3D12_GPU_VIRTUAL_ADDRESS geometry_gpu = 0;
+    if (bd->InitInfo.GeometryAllocFn != nullptr && vtx_bytes > 0 && idx_bytes > 0 &&
+        bd->InitInfo.GeometryAllocFn(&bd->InitInfo, idx_offset + idx_bytes, 16, &geometry_cpu, &geometry_gpu))
     {
-        SafeRelease(fr->VertexBuffer);
-        fr->VertexBufferSize = draw_data->TotalVtxCount + 5000;
-        D3D12_HEAP_PROPERTIES props = {};
-        props.Type = D3D12_HEAP_TYPE_UPLOAD;
-        props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-        props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-        D3D12_RESOURCE_DESC desc = {};
-        desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-        desc.Width = fr->VertexBufferSize * sizeof(ImDrawVert);
-        desc.Height = 1;
-        desc.DepthOrArraySize = 1;
-        desc.MipLevels = 1;
-        desc.Format = DXGI_FORMAT_UNKNOWN;
-        desc.SampleDesc.Count = 1;
-        desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-        desc.Flags = D3D12_RESOURCE_FLAG_NONE;
-        if (bd->pd3dDevice->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&fr->VertexBuffer)) < 0)
-            return;
+        unsigned char* vtx_dst = (unsigned char*)geometry_cpu;
+        ImDrawIdx* idx_dst = (ImDrawIdx*)((unsigned char*)geometry_cpu + idx_offset);
+        for (int n = 0; n < draw_data->CmdListsCount; n++)
+        {
+            const ImDrawList* draw_list = draw_data->CmdLists[n];
+            vtx_dst += ImGui_ImplDX12_WriteVertices(bd, draw_list, vtx_dst);
+            memcpy(idx_dst, draw_list->IdxBuffer.Data, draw_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+            idx_dst += draw_list->IdxBuffer.Size;
+        }
+        fr->VertexBufferView.BufferLocation = geometry_gpu;
+        fr->VertexBufferView.SizeInBytes = (UINT)vtx_bytes;
+        fr->VertexBufferView.StrideInBytes = vtx_stride;
+        fr->IndexBufferView.BufferLocation = geometry_gpu + idx_offset;
+        fr->IndexBufferView.SizeInBytes = (UINT)idx_bytes;
+        fr->IndexBufferView.Format = sizeof(ImDrawIdx) == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
     }
-    if (fr->IndexBuffer == nullptr || fr->IndexBufferSize < draw_data->TotalIdxCount)
+    else
     {
-        SafeRelease(fr->IndexBuffer);
-        fr->IndexBufferSize = draw_data->TotalIdxCount + 10000;
-        D3D12_HEAP_PROPERTIES props = {};
-        props.Type = D3D12_HEAP_TYPE_UPLOAD;
-        props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-        props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-        D3D12_RESOURCE_DESC desc = {};
-        desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-        desc.Width = fr->IndexBufferSize * sizeof(ImDrawIdx);
-        desc.Height = 1;
-        desc.DepthOrArraySize = 1;
-        desc.MipLevels = 1;
-        desc.Format = DXGI_FORMAT_UNKNOWN;
-        desc.SampleDesc.Count = 1;
-        desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-        desc.Flags = D3D12_RESOURCE_FLAG_NONE;
-        if (bd->pd3dDevice->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&fr->IndexBuffer)) < 0)
+        // Create and grow vertex/index buffers if needed
+        if (fr->VertexBuffer == nullptr || fr->VertexBufferSize < draw_data->TotalVtxCount)
+        {
+            SafeRelease(fr->VertexBuffer);
+            fr->VertexBufferSize = draw_data->TotalVtxCount + 5000;
+            D3D12_HEAP_PROPERTIES props = {};
+            props.Type = D3D12_HEAP_TYPE_UPLOAD;
+            props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+            props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+            D3D12_RESOURCE_DESC desc = {};
+            desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+            desc.Width = (UINT64)fr->VertexBufferSize * vtx_stride;
+            desc.Height = 1;
+            desc.DepthOrArraySize = 1;
+            desc.MipLevels = 1;
+            desc.Format = DXGI_FORMAT_UNKNOWN;
+            desc.SampleDesc.Count = 1;
+            desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+            desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+            if (bd->pd3dDevice->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&fr->VertexBuffer)) < 0)
+                return;
+        }
+        if (fr->IndexBuffer == nullptr || fr->IndexBufferSize < draw_data->TotalIdxCount)
+        {
+            SafeRelease(fr->IndexBuffer);
+            fr->IndexBufferSize = draw_data->TotalIdxCount + 10000;
+            D3D12_HEAP_PROPERTIES props = {};
+            props.Type = D3D12_HEAP_TYPE_UPLOAD;
+            props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+            props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+            D3D12_RESOURCE_DESC desc = {};
+            desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+            desc.Width = fr->IndexBufferSize * sizeof(ImDrawIdx);
+            desc.Height = 1;
+            desc.DepthOrArraySize = 1;
+            desc.MipLevels = 1;
+            desc.Format = DXGI_FORMAT_UNKNOWN;
+            desc.SampleDesc.Count = 1;
+            desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+            desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+            if (bd->pd3dDevice->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&fr->IndexBuffer)) < 0)
+                return;
+        }
+
+        // Upload vertex/index data into a single contiguous GPU buffer
+        // During Map() we specify a null read range (as per DX12 API, this is informational and for tooling only)
+        void* vtx_resource, *idx_resource;
+        D3D12_RANGE range = { 0, 0 };
+        if (fr->VertexBuffer->Map(0, &range, &vtx_resource) != S_OK)
             return;
-    }
+        if (fr->IndexBuffer->Map(0, &range, &idx_resource) != S_OK)
+            return;
+        unsigned char* vtx_dst = (unsigned char*)vtx_resource;
+        ImDrawIdx* idx_dst = (ImDrawIdx*)idx_resource;
+        for (int n = 0; n < draw_data->CmdListsCount; n++)
+        {
+            const ImDrawList* draw_list = draw_data->CmdLists[n];
+            vtx_dst += ImGui_ImplDX12_WriteVertices(bd, draw_list, vtx_dst);
+            memcpy(idx_dst, draw_list->IdxBuffer.Data, draw_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+            idx_dst += draw_list->IdxBuffer.Size;
+        }
 
-    // Upload vertex/index data into a single contiguous GPU buffer
-    // During Map() we specify a null read range (as per DX12 API, this is informational and for tooling only)
-    void* vtx_resource, *idx_resource;
-    D3D12_RANGE range = { 0, 0 };
-    if (fr->VertexBuffer->Map(0, &range, &vtx_resource) != S_OK)
-        return;
-    if (fr->IndexBuffer->Map(0, &range, &idx_resource) != S_OK)
-        return;
-    ImDrawVert* vtx_dst = (ImDrawVert*)vtx_resource;
-    ImDrawIdx* idx_dst = (ImDrawIdx*)idx_resource;
-    for (int n = 0; n < draw_data->CmdListsCount; n++)
-    {
-        const ImDrawList* draw_list = draw_data->CmdLists[n];
-        memcpy(vtx_dst, draw_list->VtxBuffer.Data, draw_list->VtxBuffer.Size * sizeof(ImDrawVert));
-        memcpy(idx_dst, draw_list->IdxBuffer.Data, draw_list->IdxBuffer.Size * sizeof(ImDrawIdx));
-        vtx_dst += draw_list->VtxBuffer.Size;
-        idx_dst += draw_list->IdxBuffer.Size;
+        // During Unmap() we specify the written range (as per DX12 API, this is informational and for tooling only)
+        range.End = (SIZE_T)((intptr_t)vtx_dst - (intptr_t)vtx_resource);
+        IM_ASSERT(range.End == vtx_bytes);
+        fr->VertexBuffer->Unmap(0, &range);
+        range.End = (SIZE_T)((intptr_t)idx_dst - (intptr_t)idx_resource);
+        IM_ASSERT(range.End == draw_data->TotalIdxCount * sizeof(ImDrawIdx));
+        fr->IndexBuffer->Unmap(0, &range);
+
+        fr->VertexBufferView.BufferLocation = fr->VertexBuffer->GetGPUVirtualAddress();
+        fr->VertexBufferView.SizeInBytes = fr->VertexBufferSize * vtx_stride;
+        fr->VertexBufferView.StrideInBytes = vtx_stride;
+        fr->IndexBufferView.BufferLocation = fr->IndexBuffer->GetGPUVirtualAddress();
+        fr->IndexBufferView.SizeInBytes = fr->IndexBufferSize * sizeof(ImDrawIdx);
+        fr->IndexBufferView.Format = sizeof(ImDrawIdx) == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
     }
 
-    // During Unmap() we specify the written range (as per DX12 API, this is informational and for tooling only)
-    range.End = (SIZE_T)((intptr_t)vtx_dst - (intptr_t)vtx_resource);
-    IM_ASSERT(range.End == draw_data->TotalVtxCount * sizeof(ImDrawVert));
-    fr->VertexBuffer->Unmap(0, &range);
-    range.End = (SIZE_T)((intptr_t)idx_dst - (intptr_t)idx_resource);
-    IM_ASSERT(range.End == draw_data->TotalIdxCount * sizeof(ImDrawIdx));
-    fr->IndexBuffer->Unmap(0, &range);
-
     // Setup desired DX state
     ImGui_ImplDX12_SetupRenderState(draw_data, command_list, fr);
 
@@ -274,6 +379,7 @@ void ImGui_ImplDX12_RenderDrawData(ImDrawData* draw_data, ID3D12GraphicsCommandL
     int global_vtx_offset = 0;
     int global_idx_offset = 0;
     ImVec2 clip_off = draw_data->DisplayPos;
+    ImGui_ImplDX12_MergedDraw merged = {};
     for (int n = 0; n < draw_data->CmdListsCount; n++)
     {
         const ImDrawList* draw_list = draw_data->CmdLists[n];
@@ -282,6 +388,8 @@ void ImGui_ImplDX12_RenderDrawData(ImDrawData* draw_data, ID3D12GraphicsCommandL
             const ImDrawCmd* pcmd = &draw_list->CmdBuffer[cmd_i];
             if (pcmd->UserCallback != nullptr)
             {
+                ImGui_ImplDX12_FlushMergedDraw(command_list, &merged);
+
                 // User callback, registered via ImDrawList::AddCallback()
                 // (ImDrawCallback_ResetRenderState is a special callback value used by the user to request the renderer to reset render state.)
                 if (pcmd->UserCallback == ImDrawCallback_ResetRenderState)
@@ -299,6 +407,23 @@ void ImGui_ImplDX12_RenderDrawData(ImDrawData* draw_data, ID3D12GraphicsCommandL
 
                 // Apply scissor/clipping rectangle
                 const D3D12_RECT r = { (LONG)clip_min.x, (LONG)clip_min.y, (LONG)clip_max.x, (LONG)clip_max.y };
+                if (bd->Bindless)
+                {
+                    // Nothing to bind per texture: a draw under the same scissor that continues the pending one's
+                    // indices extends it
+                    const UINT idx_start = pcmd->IdxOffset + global_idx_offset;
+                    const INT vtx_start = (INT)pcmd->VtxOffset + global_vtx_offset;
+                    if (merged.IdxCount == 0 || idx_start != merged.IdxStart + merged.IdxCount || vtx_start != merged.VtxStart ||
+                        memcmp(&r, &merged.Scissor, sizeof(r)) != 0)
+                    {
+                        ImGui_ImplDX12_FlushMergedDraw(command_list, &merged);
+                        merged.Scissor = r;
+                        merged.IdxStart = idx_start;
+                        merged.VtxStart = vtx_start;
+                    }
+                    merged.IdxCount += pcmd->ElemCount;
+                    continue;
+                }
                 command_list->RSSetScissorRects(1, &r);
 
                 // Bind texture, Draw
@@ -311,6 +436,7 @@ void ImGui_ImplDX12_RenderDrawData(ImDrawData* draw_data, ID3D12GraphicsCommandL
         global_idx_offset += draw_list->IdxBuffer.Size;
         global_vtx_offset += draw_list->VtxBuffer.Size;
     }
+    ImGui_ImplDX12_FlushMergedDraw(command_list, &merged);
     platform_io.Renderer_RenderState = nullptr;
 }
 
@@ -464,7 +590,13 @@ bool    ImGui_ImplDX12_CreateDeviceObjects()
     if (bd->pPipelineState)
         ImGui_ImplDX12_InvalidateDeviceObjects();
 
+    // Bindless: the root signature comes with the vertex shader
+    if (bd->Bindless && bd->pd3dDevice->CreateRootSignature(0, bd->InitInfo.BindlessVertexShader.pShaderBytecode,
+        bd->InitInfo.BindlessVertexShader.BytecodeLength, IID_PPV_ARGS(&bd->pRootSignature)) != S_OK)
+        bd->Bindless = false;
+
     // Create the root signature
+    if (!bd->Bindless)
     {
         D3D12_DESCRIPTOR_RANGE descRange = {};
         descRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
@@ -497,7 +629,7 @@ bool    ImGui_ImplDX12_CreateDeviceObjects()
         staticSampler.ComparisonFunc = D3D12_COMPARISON_FUNC_ALWAYS;
         staticSampler.BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
         staticSampler.MinLOD = 0.f;
-        staticSampler.MaxLOD = 0.f;
+        staticSampler.MaxLOD = D3D12_FLOAT32_MAX; // Mipped textures (the browser view) use their levels
         staticSampler.ShaderRegister = 0;
         staticSampler.RegisterSpace = 0;
         staticSampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
@@ -564,10 +696,25 @@ bool    ImGui_ImplDX12_CreateDeviceObjects()
     psoDesc.SampleDesc.Count = 1;
     psoDesc.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
 
-    ID3DBlob* vertexShaderBlob;
-    ID3DBlob* pixelShaderBlob;
+    ID3DBlob* vertexShaderBlob = nullptr;
+    ID3DBlob* pixelShaderBlob = nullptr;
+
+    if (bd->Bindless)
+    {
+        psoDesc.VS = bd->InitInfo.BindlessVertexShader;
+        psoDesc.PS = bd->InitInfo.BindlessPixelShader;
+        static D3D12_INPUT_ELEMENT_DESC bindless_layout[] =
+        {
+            { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT,   0, (UINT)offsetof(ImGui_ImplDX12_BindlessVert, pos), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+            { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,   0, (UINT)offsetof(ImGui_ImplDX12_BindlessVert, uv),  D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+            { "COLOR",    0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, (UINT)offsetof(ImGui_ImplDX12_BindlessVert, col), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+            { "TEXINDEX", 0, DXGI_FORMAT_R32_UINT,       0, (UINT)offsetof(ImGui_ImplDX12_BindlessVert, tex), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        };
+        psoDesc.InputLayout = { bindless_layout, 4 };
+    }
 
     // Create the vertex shader
+    if (!bd->Bindless)
     {
         static const char* vertexShader =
             "cbuffer vertexBuffer : register(b0) \
@@ -612,6 +759,7 @@ bool    ImGui_ImplDX12_CreateDeviceObjects()
     }
 
     // Create the pixel shader
+    if (!bd->Bindless)
     {
         static const char* pixelShader =
             "struct PS_INPUT\
@@ -625,7 +773,10 @@ bool    ImGui_ImplDX12_CreateDeviceObjects()
             \
             float4 main(PS_INPUT input) : SV_Target\
             {\
-              float4 out_col = input.col * texture0.Sample(sampler0, input.uv); \
+              bool field = input.uv.x >= 1.5f; /* Distance field glyph: U moved up by 2 */ \
+              float4 tex = texture0.Sample(sampler0, float2(input.uv.x - (field ? 2.0f : 0.0f), input.uv.y)); \
+              float coverage = saturate((tex.a - 0.5f) / max(fwidth(tex.a), 0.0001f) + 0.5f); \
+              float4 out_col = input.col * (field ? float4(1.0f, 1.0f, 1.0f, coverage) : tex); \
               return out_col; \
             }";
 
@@ -680,8 +831,15 @@ bool    ImGui_ImplDX12_CreateDeviceObjects()
     }
 
     HRESULT result_pipeline_state = bd->pd3dDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&bd->pPipelineState));
-    vertexShaderBlob->Release();
-    pixelShaderBlob->Release();
+    SafeRelease(vertexShaderBlob);
+    SafeRelease(pixelShaderBlob);
+    if (result_pipeline_state != S_OK && bd->Bindless)
+    {
+        // Try again with the regular pipeline
+        SafeRelease(bd->pRootSignature);
+        bd->Bindless = false;
+        return ImGui_ImplDX12_CreateDeviceObjects();
+    }
     if (result_pipeline_state != S_OK)
         return false;
 
@@ -735,6 +893,13 @@ bool ImGui_ImplDX12_Init(ImGui_ImplDX12_InitInfo* init_info)
     bd->DSVFormat = init_info->DSVFormat;
     bd->numFramesInFlight = init_info->NumFramesInFlight;
     bd->pd3dSrvDescHeap = init_info->SrvDescriptorHeap;
+    bd->Bindless = init_info->BindlessVertexShader.pShaderBytecode != nullptr && init_info->BindlessPixelShader.pShaderBytecode != nullptr &&
+        init_info->SrvDescriptorHeap != nullptr;
+    if (bd->Bindless)
+    {
+        bd->SrvHeapGpuStart = init_info->SrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart().ptr;
+        bd->SrvDescriptorSize = bd->pd3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    }
 
     io.BackendRendererUserData = (void*)bd;
     io.BackendRendererName = "imgui_impl_dx12";
@@ -833,6 +998,12 @@ void ImGui_ImplDX12_NewFrame()
         ImGui_ImplDX12_CreateDeviceObjects();
 }
 
+bool ImGui_ImplDX12_IsBindless()
+{
+    ImGui_ImplDX12_Data* bd = ImGui_ImplDX12_GetBackendData();
+    return bd != nullptr && bd->Bindless && bd->pPipelineState != nullptr;
+}
+
 //-----------------------------------------------------------------------------
 
 #endif // #ifndef IMGUI_DISABLE
@@ -38,6 +38,18 @@ struct ImGui_ImplDX12_InitInfo
     ID3D12DescriptorHeap*       SrvDescriptorHeap;
     void                        (*SrvDescriptorAllocFn)(ImGui_ImplDX12_InitInfo* info, D3D12_CPU_DESCRIPTOR_HANDLE* out_cpu_desc_handle, D3D12_GPU_DESCRIPTOR_HANDLE* out_gpu_desc_handle);
     void                        (*SrvDescriptorFreeFn)(ImGui_ImplDX12_InitInfo* info, D3D12_CPU_DESCRIPTOR_HANDLE cpu_desc_handle, D3D12_GPU_DESCRIPTOR_HANDLE gpu_desc_handle);
+
+    // Optional: vertex/index memory for one RenderDrawData call, from persistently mapped upload memory that stays
+    // valid until the GPU is done with the frame (e.g. an upload ring). Return false to use the backend's own buffers.
+    bool                        (*GeometryAllocFn)(ImGui_ImplDX12_InitInfo* info, UINT64 size, UINT64 alignment, void** out_cpu_address, D3D12_GPU_VIRTUAL_ADDRESS* out_gpu_address);
+
+    // Optional: bindless rendering through Shader Model 6.6 ResourceDescriptorHeap. Texture ids stay GPU handles in
+    // SrvDescriptorHeap; each vertex carries its texture's heap index (POSITION, TEXCOORD0, COLOR0, then TEXINDEX as a
+    // uint), so no descriptor table is bound per draw and consecutive draws under one clip rect merge. DXIL for both
+    // stages; the vertex shader embeds the root signature (16 vertex root constants at b0 as param 0, a static sampler
+    // at s0, CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED). Falls back to the regular pipeline when either is missing or fails.
+    D3D12_SHADER_BYTECODE       BindlessVertexShader;
+    D3D12_SHADER_BYTECODE       BindlessPixelShader;
 #ifndef IMGUI_DISABLE_OBSOLETE_FUNCTIONS
     D3D12_CPU_DESCRIPTOR_HANDLE LegacySingleSrvCpuDescriptor; // To facilitate transition from single descriptor to allocator callback, you may use those.
     D3D12_GPU_DESCRIPTOR_HANDLE LegacySingleSrvGpuDescriptor;
@@ -51,6 +63,7 @@ IMGUI_IMPL_API bool     ImGui_ImplDX12_Init(ImGui_ImplDX12_InitInfo* info);
 IMGUI_IMPL_API void     ImGui_ImplDX12_Shutdown();
 IMGUI_IMPL_API void     ImGui_ImplDX12_NewFrame();
 IMGUI_IMPL_API void     ImGui_ImplDX12_RenderDrawData(ImDrawData* draw_data, ID3D12GraphicsCommandList* graphics_command_list);
+IMGUI_IMPL_API bool     ImGui_ImplDX12_IsBindless();    // The bindless pipeline was created (see InitInfo)
 
 #ifndef IMGUI_DISABLE_OBSOLETE_FUNCTIONS
 // Legacy initialization API Obsoleted in 1.91.5
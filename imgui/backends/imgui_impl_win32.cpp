@@ -115,6 +115,8 @@ struct ImGui_ImplWin32_Data
     INT64                       TicksPerSecond;
     ImGuiMouseCursor            LastMouseCursor;
     UINT32                      KeyboardCodePage;
+    bool                        HasDisplayArea;     // ImGui_ImplWin32_SetDisplayArea
+    RECT                        DisplayArea;
 
 #ifndef IMGUI_IMPL_WIN32_DISABLE_GAMEPAD
     bool                        HasGamepad;
@@ -315,7 +317,9 @@ static void ImGui_ImplWin32_UpdateMouseData(ImGuiIO& io)
         if (io.WantSetMousePos)
         {
             POINT pos = { (int)io.MousePos.x, (int)io.MousePos.y };
-            if (::ClientToScreen(bd->hWnd, &pos))
+            if (bd->HasDisplayArea)
+                ::SetCursorPos(pos.x + bd->DisplayArea.left, pos.y + bd->DisplayArea.top);
+            else if (::ClientToScreen(bd->hWnd, &pos))
                 ::SetCursorPos(pos.x, pos.y);
         }
 
@@ -324,7 +328,9 @@ static void ImGui_ImplWin32_UpdateMouseData(ImGuiIO& io)
         if (!io.WantSetMousePos && bd->MouseTrackedArea == 0)
         {
             POINT pos;
-            if (::GetCursorPos(&pos) && ::ScreenToClient(bd->hWnd, &pos))
+            if (bd->HasDisplayArea && ::GetCursorPos(&pos))
+                io.AddMousePosEvent((float)(pos.x - bd->DisplayArea.left), (float)(pos.y - bd->DisplayArea.top));
+            else if (::GetCursorPos(&pos) && ::ScreenToClient(bd->hWnd, &pos))
                 io.AddMousePosEvent((float)pos.x, (float)pos.y);
         }
     }
@@ -388,6 +394,25 @@ static void ImGui_ImplWin32_UpdateGamepads(ImGuiIO& io)
 #endif
 }
 
+void    ImGui_ImplWin32_SetDisplayArea(const void* screen_rect)
+{
+    ImGui_ImplWin32_Data* bd = ImGui_ImplWin32_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Context or backend not initialized? Did you call ImGui_ImplWin32_Init()?");
+    bd->HasDisplayArea = screen_rect != nullptr;
+    if (screen_rect)
+        bd->DisplayArea = *(const RECT*)screen_rect;
+}
+
+ImVec2  ImGui_ImplWin32_GetWindowOffset()
+{
+    ImGui_ImplWin32_Data* bd = ImGui_ImplWin32_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Context or backend not initialized? Did you call ImGui_ImplWin32_Init()?");
+    POINT origin = { 0, 0 };
+    if (!bd->HasDisplayArea || !::ClientToScreen(bd->hWnd, &origin))
+        return ImVec2(0.0f, 0.0f);
+    return ImVec2((float)(origin.x - bd->DisplayArea.left), (float)(origin.y - bd->DisplayArea.top));
+}
+
 void    ImGui_ImplWin32_NewFrame()
 {
     ImGui_ImplWin32_Data* bd = ImGui_ImplWin32_GetBackendData();
@@ -396,7 +421,10 @@ void    ImGui_ImplWin32_NewFrame()
 
     // Setup display size (every frame to accommodate for window resizing)
     RECT rect = { 0, 0, 0, 0 };
-    ::GetClientRect(bd->hWnd, &rect);
+    if (bd->HasDisplayArea)
+        rect = bd->DisplayArea;
+    else
+        ::GetClientRect(bd->hWnd, &rect);
     io.DisplaySize = ImVec2((float)(rect.right - rect.left), (float)(rect.bottom - rect.top));
 
     // Setup time step
@@ -644,7 +672,14 @@ IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandlerEx(HWND hwnd, UINT msg, WPA
             bd->MouseTrackedArea = area;
         }
         POINT mouse_pos = { (LONG)GET_X_LPARAM(lParam), (LONG)GET_Y_LPARAM(lParam) };
-        if (msg == WM_NCMOUSEMOVE && ::ScreenToClient(hwnd, &mouse_pos) == FALSE) // WM_NCMOUSEMOVE are provided in absolute coordinates.
+        if (bd->HasDisplayArea)
+        {
+            if (msg == WM_MOUSEMOVE && ::ClientToScreen(hwnd, &mouse_pos) == FALSE)
+                return 0;
+            mouse_pos.x -= bd->DisplayArea.left;
+            mouse_pos.y -= bd->DisplayArea.top;
+        }
+        else if (msg == WM_NCMOUSEMOVE && ::ScreenToClient(hwnd, &mouse_pos) == FALSE) // WM_NCMOUSEMOVE are provided in absolute coordinates.
             return 0;
         io.AddMouseSourceEvent(mouse_source);
         io.AddMousePosEvent((float)mouse_pos.x, (float)mouse_pos.y);
@@ -26,6 +26,13 @@ IMGUI_IMPL_API bool     ImGui_ImplWin32_InitForOpenGL(void* hwnd);
 IMGUI_IMPL_API void     ImGui_ImplWin32_Shutdown();
 IMGUI_IMPL_API void     ImGui_ImplWin32_NewFrame();
 
+// Optional: lay Dear ImGui out in a screen area larger than the window (e.g. a window that is moved and resized to
+// cover only the visible panels). Mouse positions are reported relative to the area's top-left corner, DisplaySize
+// is the area's size, and the renderer must translate draw data by the window's position within it (see
+// ImGui_ImplWin32_GetWindowOffset). Pass nullptr to go back to the window's client area.
+IMGUI_IMPL_API void     ImGui_ImplWin32_SetDisplayArea(const void* screen_rect); // const RECT*
+IMGUI_IMPL_API ImVec2   ImGui_ImplWin32_GetWindowOffset();                      // Client area origin in display coordinates
+
 // Win32 message handler your application need to call.
 // - Intentionally commented out in a '#if 0' block to avoid dragging dependencies on <windows.h> from this helper.
 // - You should COPY the line below into your .cpp code to forward declare the function and then you can call it.
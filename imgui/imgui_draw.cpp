@@ -709,9 +709,200 @@ void ImDrawList::PrimUnreserve(int idx_count, int vtx_count)
     IdxBuffer.shrink(IdxBuffer.Size - idx_count);
 }
 
+//-----------------------------------------------------------------------------
+// GameOverlay: SIMD quad emission for PrimRect, PrimRectUV and ImFont::RenderText
+//-----------------------------------------------------------------------------
+// A quad is (x1, y1, x2, y2) and (u1, v1, u2, v2); each of its four vertices is one 16-byte store
+// of pos and uv (two shuffles of the pair) plus its color. RenderText gathers a run's visible glyph
+// quads as the scalar loop computes them (clipping included) and writes 4 (SSE2) or 8 (AVX2) per
+// iteration, indices as whole vectors from a pattern table. The output is the scalar path's, bit
+// for bit. The kernel is picked from CPUID on first use; ImFontSetGlyphEmitKernel overrides it.
+
+#if defined(IMGUI_ENABLE_SSE) && defined(_MSC_VER)
+#define IMGUI_ENABLE_GLYPH_BATCH
+#include <intrin.h>     // __cpuid, _xgetbv
+#endif
+
+struct ImGlyphQuad
+{
+    float Pos[4];       // x1, y1, x2, y2
+    float Uv[4];        // u1, v1, u2, v2
+};
+static const int IM_GLYPH_BATCH_SIZE = 8;
+typedef void (*ImGlyphEmitFunc)(ImDrawVert* vtx, ImDrawIdx* idx, unsigned int vtx_index, const ImGlyphQuad* quads, const ImU32* cols, int count);
+
+static int GImGlyphEmitKernel = -1; // Unresolved: scalar rects until the first RenderText or ImFontSetGlyphEmitKernel
+
+static int ImGetBestGlyphEmitKernel()
+{
+#ifdef IMGUI_ENABLE_GLYPH_BATCH
+    // AVX2 needs the OS to save YMM state (OSXSAVE + XCR0 bits 1 and 2); SSE2 is baseline on x64
+    int info[4] = {};
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return ImGlyphEmitKernel_SSE2;
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+        return ImGlyphEmitKernel_SSE2;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0 ? ImGlyphEmitKernel_AVX2 : ImGlyphEmitKernel_SSE2;
+#else
+    return ImGlyphEmitKernel_Scalar;
+#endif
+}
+
+void ImFontSetGlyphEmitKernel(int kernel)
+{
+    const int best = ImGetBestGlyphEmitKernel();
+    GImGlyphEmitKernel = kernel < 0 ? best : ImMin(kernel, best);
+}
+
+int ImFontGetGlyphEmitKernel()
+{
+    if (GImGlyphEmitKernel < 0)
+        GImGlyphEmitKernel = ImGetBestGlyphEmitKernel();
+    return GImGlyphEmitKernel;
+}
+
+const char* ImFontGetGlyphEmitKernelName(int kernel)
+{
+    switch (kernel)
+    {
+    case ImGlyphEmitKernel_Scalar: return "Scalar";
+    case ImGlyphEmitKernel_SSE2: return "SSE2";
+    case ImGlyphEmitKernel_AVX2: return "AVX2";
+    default: return "Unknown";
+    }
+}
+
+#ifdef IMGUI_ENABLE_GLYPH_BATCH
+IM_STATIC_ASSERT(sizeof(ImDrawVert) == 20 && offsetof(ImDrawVert, uv) == 8 && offsetof(ImDrawVert, col) == 16);
+
+// Each quad's six indices, relative to the batch's first vertex
+alignas(32) static const ImDrawIdx GImQuadIndexPattern[IM_GLYPH_BATCH_SIZE * 6] =
+{
+    0, 1, 2, 0, 2, 3,
+    4, 5, 6, 4, 6, 7,
+    8, 9, 10, 8, 10, 11,
+    12, 13, 14, 12, 14, 15,
+    16, 17, 18, 16, 18, 19,
+    20, 21, 22, 20, 22, 23,
+    24, 25, 26, 24, 26, 27,
+    28, 29, 30, 28, 30, 31
+};
+
+// Vertex 0 (x1, y1, u1, v1), 1 (x2, y1, u2, v1), 2 (x2, y2, u2, v2), 3 (x1, y2, u1, v2)
+static inline void ImEmitQuadVerticesSSE(ImDrawVert* v, __m128 p, __m128 t, ImU32 col)
+{
+    _mm_storeu_ps(&v[0].pos.x, _mm_shuffle_ps(p, t, _MM_SHUFFLE(1, 0, 1, 0)));
+    _mm_storeu_ps(&v[1].pos.x, _mm_shuffle_ps(p, t, _MM_SHUFFLE(1, 2, 1, 2)));
+    _mm_storeu_ps(&v[2].pos.x, _mm_shuffle_ps(p, t, _MM_SHUFFLE(3, 2, 3, 2)));
+    _mm_storeu_ps(&v[3].pos.x, _mm_shuffle_ps(p, t, _MM_SHUFFLE(3, 0, 3, 0)));
+    v[0].col = col; v[1].col = col; v[2].col = col; v[3].col = col;
+}
+
+static inline void ImEmitQuadIndices(ImDrawIdx* idx, unsigned int vtx_index)
+{
+    idx[0] = (ImDrawIdx)(vtx_index); idx[1] = (ImDrawIdx)(vtx_index + 1); idx[2] = (ImDrawIdx)(vtx_index + 2);
+    idx[3] = (ImDrawIdx)(vtx_index); idx[4] = (ImDrawIdx)(vtx_index + 2); idx[5] = (ImDrawIdx)(vtx_index + 3);
+}
+
+static void ImEmitGlyphQuadsSSE2(ImDrawVert* vtx, ImDrawIdx* idx, unsigned int vtx_index, const ImGlyphQuad* quads, const ImU32* cols, int count)
+{
+    const __m128i* pattern = (const __m128i*)GImQuadIndexPattern;
+    const int index_vectors = 4 * 6 * (int)sizeof(ImDrawIdx) / 16; // Four quads' indices
+    int q = 0;
+    for (; q + 4 <= count; q += 4, vtx += 16, idx += 24, vtx_index += 16)
+    {
+        for (int k = 0; k < 4; k++)
+            ImEmitQuadVerticesSSE(vtx + k * 4, _mm_loadu_ps(quads[q + k].Pos), _mm_loadu_ps(quads[q + k].Uv), cols[q + k]);
+        const __m128i base = sizeof(ImDrawIdx) == 2 ? _mm_set1_epi16((short)vtx_index) : _mm_set1_epi32((int)vtx_index);
+        for (int k = 0; k < index_vectors; k++)
+        {
+            const __m128i relative = _mm_load_si128(pattern + k);
+            _mm_storeu_si128((__m128i*)idx + k, sizeof(ImDrawIdx) == 2 ? _mm_add_epi16(relative, base) : _mm_add_epi32(relative, base));
+        }
+    }
+    for (; q < count; q++, vtx += 4, idx += 6, vtx_index += 4)
+    {
+        ImEmitQuadVerticesSSE(vtx, _mm_loadu_ps(quads[q].Pos), _mm_loadu_ps(quads[q].Uv), cols[q]);
+        ImEmitQuadIndices(idx, vtx_index);
+    }
+}
+
+static void ImEmitGlyphQuadsAVX2(ImDrawVert* vtx, ImDrawIdx* idx, unsigned int vtx_index, const ImGlyphQuad* quads, const ImU32* cols, int count)
+{
+    const __m256i* pattern = (const __m256i*)GImQuadIndexPattern;
+    const int index_vectors = 8 * 6 * (int)sizeof(ImDrawIdx) / 32; // Eight quads' indices
+    int q = 0;
+    for (; q + 8 <= count; q += 8, vtx += 32, idx += 48, vtx_index += 32)
+    {
+        // Two quads per register, one per 128-bit lane (the shuffles stay within lanes)
+        for (int k = 0; k < 8; k += 2)
+        {
+            const __m256 p = _mm256_set_m128(_mm_loadu_ps(quads[q + k + 1].Pos), _mm_loadu_ps(quads[q + k].Pos));
+            const __m256 t = _mm256_set_m128(_mm_loadu_ps(quads[q + k + 1].Uv), _mm_loadu_ps(quads[q + k].Uv));
+            const __m256 v0 = _mm256_shuffle_ps(p, t, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 v1 = _mm256_shuffle_ps(p, t, _MM_SHUFFLE(1, 2, 1, 2));
+            const __m256 v2 = _mm256_shuffle_ps(p, t, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 v3 = _mm256_shuffle_ps(p, t, _MM_SHUFFLE(3, 0, 3, 0));
+            ImDrawVert* v = vtx + k * 4;
+            _mm_storeu_ps(&v[0].pos.x, _mm256_castps256_ps128(v0));
+            _mm_storeu_ps(&v[1].pos.x, _mm256_castps256_ps128(v1));
+            _mm_storeu_ps(&v[2].pos.x, _mm256_castps256_ps128(v2));
+            _mm_storeu_ps(&v[3].pos.x, _mm256_castps256_ps128(v3));
+            _mm_storeu_ps(&v[4].pos.x, _mm256_extractf128_ps(v0, 1));
+            _mm_storeu_ps(&v[5].pos.x, _mm256_extractf128_ps(v1, 1));
+            _mm_storeu_ps(&v[6].pos.x, _mm256_extractf128_ps(v2, 1));
+            _mm_storeu_ps(&v[7].pos.x, _mm256_extractf128_ps(v3, 1));
+            const ImU32 col_a = cols[q + k], col_b = cols[q + k + 1];
+            v[0].col = col_a; v[1].col = col_a; v[2].col = col_a; v[3].col = col_a;
+            v[4].col = col_b; v[5].col = col_b; v[6].col = col_b; v[7].col = col_b;
+        }
+        const __m256i base = sizeof(ImDrawIdx) == 2 ? _mm256_set1_epi16((short)vtx_index) : _mm256_set1_epi32((int)vtx_index);
+        for (int k = 0; k < index_vectors; k++)
+        {
+            const __m256i relative = _mm256_load_si256(pattern + k);
+            _mm256_storeu_si256((__m256i*)idx + k, sizeof(ImDrawIdx) == 2 ? _mm256_add_epi16(relative, base) : _mm256_add_epi32(relative, base));
+        }
+    }
+    _mm256_zeroupper(); // Before any legacy SSE code, the tail's included
+    if (q < count)
+        ImEmitGlyphQuadsSSE2(vtx, idx, vtx_index, quads + q, cols + q, count - q);
+}
+#endif // IMGUI_ENABLE_GLYPH_BATCH
+
+// NULL for the scalar path
+static inline ImGlyphEmitFunc ImGetGlyphEmitFunc()
+{
+#ifdef IMGUI_ENABLE_GLYPH_BATCH
+    switch (ImFontGetGlyphEmitKernel())
+    {
+    case ImGlyphEmitKernel_SSE2: return ImEmitGlyphQuadsSSE2;
+    case ImGlyphEmitKernel_AVX2: return ImEmitGlyphQuadsAVX2;
+    default: break;
+    }
+#endif
+    return NULL;
+}
+
 // Fully unrolled with inline call to keep our debug builds decently fast.
 void ImDrawList::PrimRect(const ImVec2& a, const ImVec2& c, ImU32 col)
 {
+#ifdef IMGUI_ENABLE_GLYPH_BATCH
+    if (GImGlyphEmitKernel > ImGlyphEmitKernel_Scalar)
+    {
+        ImEmitQuadVerticesSSE(_VtxWritePtr, _mm_setr_ps(a.x, a.y, c.x, c.y),
+            _mm_setr_ps(_Data->TexUvWhitePixel.x, _Data->TexUvWhitePixel.y, _Data->TexUvWhitePixel.x, _Data->TexUvWhitePixel.y), col);
+        ImEmitQuadIndices(_IdxWritePtr, _VtxCurrentIdx);
+        _VtxWritePtr += 4;
+        _VtxCurrentIdx += 4;
+        _IdxWritePtr += 6;
+        return;
+    }
+#endif
     ImVec2 b(c.x, a.y), d(a.x, c.y), uv(_Data->TexUvWhitePixel);
     ImDrawIdx idx = (ImDrawIdx)_VtxCurrentIdx;
     _IdxWritePtr[0] = idx; _IdxWritePtr[1] = (ImDrawIdx)(idx+1); _IdxWritePtr[2] = (ImDrawIdx)(idx+2);
@@ -727,6 +918,17 @@ void ImDrawList::PrimRect(const ImVec2& a, const ImVec2& c, ImU32 col)
 
 void ImDrawList::PrimRectUV(const ImVec2& a, const ImVec2& c, const ImVec2& uv_a, const ImVec2& uv_c, ImU32 col)
 {
+#ifdef IMGUI_ENABLE_GLYPH_BATCH
+    if (GImGlyphEmitKernel > ImGlyphEmitKernel_Scalar)
+    {
+        ImEmitQuadVerticesSSE(_VtxWritePtr, _mm_setr_ps(a.x, a.y, c.x, c.y), _mm_setr_ps(uv_a.x, uv_a.y, uv_c.x, uv_c.y), col);
+        ImEmitQuadIndices(_IdxWritePtr, _VtxCurrentIdx);
+        _VtxWritePtr += 4;
+        _VtxCurrentIdx += 4;
+        _IdxWritePtr += 6;
+        return;
+    }
+#endif
     ImVec2 b(c.x, a.y), d(a.x, c.y), uv_b(uv_c.x, uv_a.y), uv_d(uv_a.x, uv_c.y);
     ImDrawIdx idx = (ImDrawIdx)_VtxCurrentIdx;
     _IdxWritePtr[0] = idx; _IdxWritePtr[1] = (ImDrawIdx)(idx+1); _IdxWritePtr[2] = (ImDrawIdx)(idx+2);
@@ -4188,6 +4390,12 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, const ImVec2& pos, Im
     const ImU32 col_untinted = col | ~IM_COL32_A_MASK;
     const char* word_wrap_eol = NULL;
 
+    // GameOverlay: visible quads are batched for the SIMD kernel, flushed when full and at the end
+    const ImGlyphEmitFunc emit_quads = ImGetGlyphEmitFunc();
+    ImGlyphQuad batch_quads[IM_GLYPH_BATCH_SIZE];
+    ImU32 batch_cols[IM_GLYPH_BATCH_SIZE];
+    int batch_count = 0;
+
     while (s < text_end)
     {
         if (word_wrap_enabled)
@@ -4282,6 +4490,22 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, const ImVec2& pos, Im
                 // Support for untinted glyphs
                 ImU32 glyph_col = glyph->Colored ? col_untinted : col;
 
+                if (emit_quads)
+                {
+                    ImGlyphQuad& quad = batch_quads[batch_count];
+                    quad.Pos[0] = x1; quad.Pos[1] = y1; quad.Pos[2] = x2; quad.Pos[3] = y2;
+                    quad.Uv[0] = u1; quad.Uv[1] = v1; quad.Uv[2] = u2; quad.Uv[3] = v2;
+                    batch_cols[batch_count] = glyph_col;
+                    if (++batch_count == IM_GLYPH_BATCH_SIZE)
+                    {
+                        emit_quads(vtx_write, idx_write, vtx_index, batch_quads, batch_cols, batch_count);
+                        vtx_write += batch_count * 4;
+                        vtx_index += batch_count * 4;
+                        idx_write += batch_count * 6;
+                        batch_count = 0;
+                    }
+                }
+                else
                 // We are NOT calling PrimRectUV() here because non-inlined causes too much overhead in a debug builds. Inlined here:
                 {
                     vtx_write[0].pos.x = x1; vtx_write[0].pos.y = y1; vtx_write[0].col = glyph_col; vtx_write[0].uv.x = u1; vtx_write[0].uv.y = v1;
@@ -4298,6 +4522,13 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, const ImVec2& pos, Im
         }
         x += char_width;
     }
+    if (batch_count > 0)
+    {
+        emit_quads(vtx_write, idx_write, vtx_index, batch_quads, batch_cols, batch_count);
+        vtx_write += batch_count * 4;
+        vtx_index += batch_count * 4;
+        idx_write += batch_count * 6;
+    }
 
     // Give back unused vertices (clipped ones, blanks) ~ this is essentially a PrimUnreserve() action.
     draw_list->VtxBuffer.Size = (int)(vtx_write - draw_list->VtxBuffer.Data); // Same as calling shrink()
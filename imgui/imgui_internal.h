@@ -3602,6 +3602,18 @@ IMGUI_API void      ImFontAtlasBuildGetOversampleFactors(const ImFontConfig* src
 
 IMGUI_API bool      ImFontAtlasGetMouseCursorTexData(ImFontAtlas* atlas, ImGuiMouseCursor cursor_type, ImVec2* out_offset, ImVec2* out_size, ImVec2 out_uv_border[2], ImVec2 out_uv_fill[2]);
 
+// GameOverlay: vertex emission kernel for ImFont::RenderText, PrimRect and PrimRectUV (imgui_draw.cpp)
+enum ImGlyphEmitKernel_
+{
+    ImGlyphEmitKernel_Scalar,
+    ImGlyphEmitKernel_SSE2,     // 4 glyph quads per iteration
+    ImGlyphEmitKernel_AVX2,     // 8 glyph quads per iteration
+    ImGlyphEmitKernel_COUNT
+};
+IMGUI_API void      ImFontSetGlyphEmitKernel(int kernel);   // -1: the best the CPU supports (the default); clamped to it
+IMGUI_API int       ImFontGetGlyphEmitKernel();
+IMGUI_API const char* ImFontGetGlyphEmitKernelName(int kernel);
+
 //-----------------------------------------------------------------------------
 // [SECTION] Test Engine specific hooks (imgui_test_engine)
 //-----------------------------------------------------------------------------
@@ -6,212 +6,933 @@
 #include <memory>
 #include <stdexcept>
 #include <vector> // Include vector for buffer copy
+#include <chrono>
+#include <algorithm>
+#include <cstring>
 #include "GameOverlay.h"
 #include "PipelineStateManager.h"
-#include "CommandAllocatorPool.h"
 #include "ResourceManager.h" // Include ResourceManager
+#include "AllocationTracker.h"
+#include "FileUtil.h"
+#include "Log.h"
+#include "JobSystem.h"
+#include "CpuProfiler.h"
+#include "TraceCapture.h"
+#include "PolicyTrace.h"
+#include "SettingsStore.h"
+#include "SettingsDatabase.h"
+#include "PresentHookInjector.h"
+#include "StartupGraph.h"
+#include "TrayIcon.h"
+#include "InputLatency.h"
+#include "ThreadCycles.h"
 
 // Forward declarations
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
 // Global references for WindowProc
 HotkeyManager* g_hotkeyManager = nullptr; // TODO: Consider better context passing than globals
+RenderSystem* g_renderSystem = nullptr;   // For render-on-demand invalidation
+PerformanceOptimizer* g_performanceOptimizer = nullptr; // Activation, minimize and power events
+BrowserView* g_browserView = nullptr;     // Keyboard input while the page has focus
+TrayIcon* g_trayIcon = nullptr;           // Notification area messages
+std::chrono::steady_clock::time_point g_lastWindowInputTime; // Frames shortly after input aren't steady state
+
+// Messages that can change what the overlay shows (input, focus, size)
+static bool IsFrameDamagingMessage(UINT uMsg) {
+    return (uMsg >= WM_MOUSEFIRST && uMsg <= WM_MOUSELAST) ||
+        (uMsg >= WM_KEYFIRST && uMsg <= WM_KEYLAST) ||
+        uMsg == WM_MOUSELEAVE || uMsg == WM_SIZE || uMsg == WM_ACTIVATEAPP ||
+        uMsg == WM_SETFOCUS || uMsg == WM_KILLFOCUS || uMsg == WM_DISPLAYCHANGE ||
+        uMsg == WM_SHOWWINDOW || uMsg == WM_WINDOWPOSCHANGED;
+}
+
+// Value of a --name=value switch (up to the next space), empty when absent
+static std::string GetCommandLineValue(const char* cmdLine, const char* name) {
+    if (!cmdLine) return std::string();
+    std::string prefix = std::string("--") + name + "=";
+    const char* start = strstr(cmdLine, prefix.c_str());
+    if (!start) return std::string();
+    start += prefix.size();
+    const char* end = strchr(start, ' ');
+    return end ? std::string(start, end) : std::string(start);
+}
+
+// %LOCALAPPDATA%\GameOverlay\Logs (created by the log writer), empty without LOCALAPPDATA
+static std::string GetLogDirectory() {
+    std::string directory = GetAppDataDirectory();
+    if (directory.empty()) return std::string();
+    return directory + "\\Logs";
+}
+
+// Poll interval while nothing of the overlay is visible
+static constexpr DWORD OCCLUDED_POLL_INTERVAL_MS = 250;
+
+// Upper bound on waiting for the swap chain (avoids hanging on a lost device)
+static constexpr DWORD FRAME_LATENCY_TIMEOUT_MS = 1000;
+
+// --assert-zero-alloc: frames count as steady state this long after startup and after input
+static constexpr float ZERO_ALLOC_DEFAULT_WARMUP_SECONDS = 5.0f;
+static constexpr auto ZERO_ALLOC_INPUT_SETTLE = std::chrono::seconds(1);
 
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
-    try {
-        // Create window manager
-        auto windowManager = std::make_unique<WindowManager>(hInstance, WindowProc);
+    const auto appStartTime = std::chrono::steady_clock::now();
+    PROFILE_THREAD("Main");
+    ThreadCycles::RegisterThread(ThreadSubsystem::Render);
 
-        // Create DirectX 12 render system
-        auto renderSystem = std::make_unique<RenderSystem>(windowManager->GetHWND(), windowManager->GetWidth(), windowManager->GetHeight());
+    // CEF launches its subprocesses from this executable: they leave before any window or device exists
+    int subprocessExitCode = 0;
+    if (BrowserManager::RunSubprocess(hInstance, subprocessExitCode)) {
+        return subprocessExitCode;
+    }
+    LogSession logSession(GetLogDirectory());
 
-        // Get Resource Manager (created inside RenderSystem)
-        ResourceManager* resourceManager = renderSystem->GetResourceManager();
-        if (!resourceManager) {
-            throw std::runtime_error("Failed to get Resource Manager from Render System");
+    // Tool mode: replay a --record-policy recording through the optimizer's state policy and exit
+    const std::string simulatePolicyPath = GetCommandLineValue(lpCmdLine, "simulate-policy");
+    if (!simulatePolicyPath.empty()) {
+        return PolicySimulator::Run(simulatePolicyPath, GetCommandLineValue(lpCmdLine, "policy-variants"),
+            GetCommandLineValue(lpCmdLine, "perf-report"));
+    }
+    BrowserManager::PrefetchRuntime(); // Until CEF starts after the first frame
+
+    try {
+        // Native resolution on every monitor: DWM would otherwise stretch the whole overlay on a
+        // scaled display (before any window exists; the fallback is system DPI awareness)
+        if (!SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2)) {
+            SetProcessDPIAware();
         }
 
-        // Create performance monitor
-        auto performanceMonitor = std::make_unique<PerformanceMonitor>();
+        // Startup phases; each needs only what its dependencies made (see StartupGraph). Declared in
+        // the old construction order, so they are still destroyed in reverse of it.
+        std::unique_ptr<WindowManager> windowManager;
+        std::unique_ptr<RenderSystem> renderSystem;
+        std::unique_ptr<PerformanceMonitor> performanceMonitor;
+        std::unique_ptr<TraceCapture> traceCapture; // Outlives its hotkey
+        std::unique_ptr<HotkeyManager> hotkeyManager;
+        std::unique_ptr<PipelineStateManager> pipelineStateManager;
+        std::unique_ptr<BrowserView> browserView;
+        std::unique_ptr<PerformanceOptimizer> performanceOptimizer;
+        std::unique_ptr<ImGuiSystem> imguiSystem;
+        std::unique_ptr<UISystem> uiSystem;
+        const std::string perfReportPath = GetCommandLineValue(lpCmdLine, "perf-report");
+        using Affinity = StartupGraph::Affinity;
+        StartupGraph startup(appStartTime);
+
+        // Settings file and database, read while the window and device are created
+        auto settings = startup.Add("Settings", Affinity::Worker, {}, []() {
+            SettingsDatabase::Get();
+            });
+
+        auto window = startup.Add("Window", Affinity::MainThread, {}, [&]() {
+            windowManager = std::make_unique<WindowManager>(hInstance, WindowProc);
+            });
+
+        // Context and Win32 backend now, so the font atlas bakes while the device is created
+        auto imguiContext = startup.Add("ImGui Context", Affinity::MainThread, { window }, [&]() {
+            imguiSystem = std::make_unique<ImGuiSystem>(windowManager->GetHWND(), windowManager->GetDpiScale());
+            });
+        auto fonts = startup.Add("Font Atlas", Affinity::Worker, { imguiContext }, [&]() {
+            imguiSystem->LoadFonts();
+            });
+
+        // Swap chain for the window: main thread
+        auto device = startup.Add("Device", Affinity::MainThread, { window }, [&]() {
+            renderSystem = std::make_unique<RenderSystem>(windowManager->GetHWND(), windowManager->GetWidth(),
+                windowManager->GetHeight(), windowManager->UsesComposition());
+            if (!renderSystem->GetResourceManager()) {
+                throw std::runtime_error("Failed to get Resource Manager from Render System");
+            }
+            g_renderSystem = renderSystem.get();
+            });
+
+        // Pipeline library and root signatures only need the (free-threaded) device
+        auto pipelines = startup.Add("Pipelines", Affinity::Worker, { device }, [&]() {
+            pipelineStateManager = std::make_unique<PipelineStateManager>(renderSystem.get());
+            pipelineStateManager->Initialize(); // Pre-create common states
+            });
 
-        // Create hotkey manager
-        auto hotkeyManager = std::make_unique<HotkeyManager>(windowManager.get());
-        g_hotkeyManager = hotkeyManager.get(); // Set global reference
+        auto services = startup.Add("Services", Affinity::MainThread, { device }, [&]() {
+            performanceMonitor = std::make_unique<PerformanceMonitor>();
 
-        // Create pipeline state manager for DirectX 12
-        auto pipelineStateManager = std::make_unique<PipelineStateManager>(renderSystem.get());
-        pipelineStateManager->Initialize(); // Pre-create common states
+            // Trace capture keeps zones recording; created first so it outlives its hotkey
+            traceCapture = std::make_unique<TraceCapture>();
 
-        // Create command allocator pool (Optional - RenderSystem might manage internally)
-        // If RenderSystem handles allocators, this isn't strictly needed here.
-        // Assuming RenderSystem needs it or uses a similar pattern:
-        auto commandAllocatorPool = std::make_unique<CommandAllocatorPool>(
-            renderSystem->GetDevice(), D3D12_COMMAND_LIST_TYPE_DIRECT);
+            // --no-input-thread: hotkeys through the keyboard hook, for input latency comparisons
+            hotkeyManager = std::make_unique<HotkeyManager>(windowManager.get(),
+                !(lpCmdLine && strstr(lpCmdLine, "--no-input-thread")));
+            g_hotkeyManager = hotkeyManager.get(); // Set global reference
 
-        // Create browser view (Needs RenderSystem)
-        auto browserView = std::make_unique<BrowserView>(renderSystem.get());
-        if (!browserView->Initialize()) {
-            // Initialize might return false if it's a CEF subprocess, which isn't an error for the main app.
-            // Check manager state if needed, or rely on Initialize throwing for real errors.
-            if (browserView->GetBrowserManager() && !browserView->GetBrowserManager()->m_isSubprocess) {
-                MessageBoxA(nullptr, "Failed to initialize browser view", "Error", MB_OK | MB_ICONERROR);
-                return 1;
+            // Hotkey actions may change overlay state, so redraw after each one
+            RenderSystem* renderSystemPtr = renderSystem.get();
+            hotkeyManager->SetHotkeyTriggeredCallback([renderSystemPtr]() { renderSystemPtr->InvalidateFrame(); });
+
+            // Dump the last seconds of profiler data (Ctrl+Alt+P)
+            if (traceCapture->IsAvailable()) {
+                TraceCapture* traceCapturePtr = traceCapture.get();
+                hotkeyManager->RegisterHotkey("capture_trace", Hotkey('P', true, true), [traceCapturePtr]() {
+                    traceCapturePtr->RequestCapture();
+                    });
+            }
+
+            // Save the overlay's next frame as a PNG without stalling the render thread (Ctrl+Alt+S)
+            if (FrameReadback* frameReadback = renderSystem->GetFrameReadback()) {
+                hotkeyManager->RegisterHotkey("capture_screenshot", Hotkey('S', true, true), [frameReadback]() {
+                    frameReadback->RequestScreenshot();
+                    });
+            }
+            });
+
+        // CEF itself starts after the first overlay frame, on this thread (see StartBrowser)
+        auto browser = startup.Add("Browser View", Affinity::MainThread, { device }, [&]() {
+            browserView = std::make_unique<BrowserView>(renderSystem.get());
+            g_browserView = browserView.get();
+            // Optionally give CEF its own UI thread so page work never lands inside a frame
+            if (lpCmdLine && strstr(lpCmdLine, "--cef-multi-threaded-loop")) {
+                browserView->GetBrowserManager()->SetMultiThreadedMessageLoopEnabled(true);
+            }
+            // Subprocesses already left through BrowserManager::RunSubprocess
+            if (!browserView->Initialize()) {
+                throw std::runtime_error("CEF subprocess reached the overlay startup");
             }
+            // Paint recording needs CPU paints; a replay stands in for CEF entirely
+            std::string replayPaintsPath = GetCommandLineValue(lpCmdLine, "replay-paints");
+            if (!replayPaintsPath.empty()) {
+                browserView->StartPaintReplay(replayPaintsPath);
+            }
+            else if (lpCmdLine && strstr(lpCmdLine, "--record-paints")) {
+                browserView->GetBrowserManager()->SetSharedTextureEnabled(false);
+                browserView->GetBrowserManager()->GetPaintRecorder().Start(PaintTraceRecorder::MakeRecordingPath());
+            }
+
+            // Initial URL, loaded when the browser starts
+            std::string startUrl = GetCommandLineValue(lpCmdLine, "start-url");
+            browserView->Navigate(startUrl.empty() ? "https://www.google.com" : startUrl);
+            });
+
+        // Game profiles come from the settings database; applied settings may need the pipelines
+        auto optimizer = startup.Add("Optimizer", Affinity::MainThread, { services, browser, settings, pipelines }, [&]() {
+            renderSystem->SetPipelineStateManager(pipelineStateManager.get()); // Upscale pass
+            performanceOptimizer = std::make_unique<PerformanceOptimizer>(
+                windowManager.get(),
+                renderSystem.get(),
+                browserView.get(),
+                performanceMonitor.get());
+            performanceOptimizer->Initialize(); // Start optimizer background tasks etc.
+            if (lpCmdLine && strstr(lpCmdLine, "--record-policy")) {
+                performanceOptimizer->StartPolicyRecording(PolicyTraceRecorder::MakeRecordingPath());
+            }
+            g_performanceOptimizer = performanceOptimizer.get();
+            });
+
+        auto imguiRenderer = startup.Add("ImGui Renderer", Affinity::MainThread, { device, fonts }, [&]() {
+            imguiSystem->InitializeRenderer(renderSystem.get());
+            });
+
+        startup.Add("UI", Affinity::MainThread, { optimizer, imguiRenderer }, [&]() {
+            performanceOptimizer->SetMemoryTrimCallback([&imguiSystem]() { imguiSystem->ReleaseDeviceObjects(); });
+
+            uiSystem = std::make_unique<UISystem>(
+                renderSystem.get(),
+                browserView.get(),
+                hotkeyManager.get(),
+                performanceOptimizer.get(),
+                performanceMonitor.get());
+
+            // Saved bindings replace the defaults once every action is registered
+            hotkeyManager->LoadBindings();
+            });
+
+        startup.Run();
+        startup.LogTimings();
+        ResourceManager* resourceManager = renderSystem->GetResourceManager();
+        for (const StartupGraph::PhaseTiming& timing : startup.GetTimings()) {
+            performanceMonitor->RecordStartupPhase(timing.name, static_cast<float>(timing.startMs),
+                static_cast<float>(timing.durationMs));
+        }
+
+        // Scripted runs for comparing builds: a fixed duration, then a JSON summary on exit
+        const int perfRunSeconds = atoi(GetCommandLineValue(lpCmdLine, "perf-run-seconds").c_str());
+        if (perfRunSeconds > 0) {
+            // Thread timer: dispatched by the message pump even while the loop sleeps
+            SetTimer(nullptr, 0, static_cast<UINT>(perfRunSeconds) * 1000u,
+                [](HWND, UINT, UINT_PTR, DWORD) { PostQuitMessage(0); });
         }
 
-        // Create performance optimizer (Needs WindowManager, RenderSystem, BrowserView, PerfMonitor)
-        auto performanceOptimizer = std::make_unique<PerformanceOptimizer>(
-            windowManager.get(),
-            renderSystem.get(),
-            browserView.get(),
-            performanceMonitor.get());
-        performanceOptimizer->Initialize(); // Start optimizer background tasks etc.
-
-        // Load initial URL if manager is initialized (not a subprocess)
-        if (browserView->GetBrowserManager() && browserView->GetBrowserManager()->m_initialized) {
-            browserView->Navigate("https://www.google.com");
+        // Allocation check for scripted runs: once warmed up, an idle or browser-repaint frame
+        // must not touch the heap. Offenders are logged with their worst zone and fail the run
+        // (exit code 3); a build without allocation tracking fails it outright.
+        const bool assertZeroAlloc = lpCmdLine && strstr(lpCmdLine, "--assert-zero-alloc");
+        float zeroAllocWarmupSeconds = ZERO_ALLOC_DEFAULT_WARMUP_SECONDS;
+        if (assertZeroAlloc) {
+            const std::string warmup = GetCommandLineValue(lpCmdLine, "assert-zero-alloc");
+            if (!warmup.empty()) zeroAllocWarmupSeconds = static_cast<float>(atof(warmup.c_str()));
+            if (AllocationTracker::IsCompiledIn()) {
+                AllocationTracker::SetZoneAttributionEnabled(true);
+            }
+            else {
+                LOG_WARNING("--assert-zero-alloc needs a GAMEOVERLAY_ALLOCATION_TRACKING build");
+            }
         }
 
-        // Create ImGui system (Needs HWND, RenderSystem)
-        auto imguiSystem = std::make_unique<ImGuiSystem>(windowManager->GetHWND(), renderSystem.get());
+        // Optionally shrink the overlay window to the visible panels instead of the whole screen
+        if (lpCmdLine && strstr(lpCmdLine, "--compact-window")) {
+            imguiSystem->SetCompactWindow(true, windowManager->GetScreenRect());
+            uiSystem->SetStaticChromeEnabled(false);
+            uiSystem->GetHudLayer().SetAvailable(false);
+        }
 
-        // Create UI system (Needs RenderSystem, BrowserView, HotkeyManager, PerfOptimizer, PerfMonitor)
-        auto uiSystem = std::make_unique<UISystem>(
-            renderSystem.get(),
-            browserView.get(),
-            hotkeyManager.get(),
-            performanceOptimizer.get(),
-            performanceMonitor.get());
+        // Optionally build each frame's UI on a UI thread while the last one is recorded and
+        // presented (one frame of added UI latency)
+        if (lpCmdLine && strstr(lpCmdLine, "--pipelined-ui")) {
+            imguiSystem->SetPipelinedBuild(true);
+        }
+
+        // Optionally time ImGui's scalar and SIMD vertex emission over the first UI builds
+        // (--bench-text-emission[=builds]; also on the performance page), into the perf report
+        int textEmissionBenchmarkFrames = 200;
+        if (lpCmdLine && strstr(lpCmdLine, "--bench-text-emission")) {
+            const std::string frames = GetCommandLineValue(lpCmdLine, "bench-text-emission");
+            if (!frames.empty()) textEmissionBenchmarkFrames = std::max(1, atoi(frames.c_str()));
+            performanceMonitor->RequestTextEmissionBenchmark();
+        }
+
+        // Optionally draw inside the game: GameOverlayHook.dll presents the shared layer from the
+        // game's own Present, which also works where this window can't appear (exclusive fullscreen)
+        std::unique_ptr<PresentHookInjector> presentHook;
+        if (lpCmdLine && strstr(lpCmdLine, "--present-hook")) {
+            renderSystem->EnableSharedLayer();
+            if (renderSystem->GetSharedLayer()) {
+                presentHook = std::make_unique<PresentHookInjector>();
+            }
+        } else if (lpCmdLine && strstr(lpCmdLine, "--share-layer")) {
+            // Published for external consumers only (capture tools); the window keeps drawing
+            renderSystem->EnableSharedLayer();
+        }
+
+        // Dismissing the overlay leaves it resident; the tray brings it back or exits
+        auto trayIcon = std::make_unique<TrayIcon>(windowManager->GetHWND(), hInstance);
+        g_trayIcon = trayIcon.get();
+        WindowManager* windowManagerPtr = windowManager.get();
+        trayIcon->SetToggleCallback([windowManagerPtr]() { windowManagerPtr->SetVisible(!windowManagerPtr->IsVisible()); });
+        trayIcon->SetExitCallback([]() { PostQuitMessage(0); });
 
         // Main message loop
+        // Sleeps in MsgWaitForMultipleObjectsEx until a message, a job continuation, a CEF pump
+        // request, the frame limiter, the swap chain or the GPU lets the loop make progress
         MSG msg = {};
         bool running = true;
+        bool frameWanted = true; // Render the first frame
+        // Input-to-photon per configuration (InputLatency.h); --no-frame-latency-wait leaves the
+        // swap chain's waitable object alone so its share of the latency shows
+        if (lpCmdLine && strstr(lpCmdLine, "--measure-input-latency")) {
+            SetInputLatencyMeasurement(true);
+        }
+        const bool frameLatencyWait = !(lpCmdLine && strstr(lpCmdLine, "--no-frame-latency-wait"));
+
+        bool halted = false;
+        bool occluded = false; // Halted but shown: polled, nothing notifies the end of occlusion
+        bool panelsShown = true; // As last drawn; the HUD keeps drawing while they are hidden
+        bool firstFramePresented = false;
+        bool firstBrowserPaintPresented = false;
+        std::vector<NavigationTiming> navigationTimings; // Reused each frame
+        auto lastRedrawTime = std::chrono::steady_clock::now();
+        // A latency wait spans loop iterations: messages and other handles wake it before it ends
+        bool latencyWaitActive = false;
+        auto latencyWaitStart = lastRedrawTime;
+        performanceMonitor->BeginFrame();
 
         while (running) {
+            // --- Wait For Work ---
+            const auto& optimizerConfig = performanceOptimizer->GetConfig();
+            HANDLE waitHandles[3] = {};
+            DWORD handleCount = 0;
+            DWORD waitTimeoutMs = INFINITE;
+            DWORD latencyHandleIndex = MAXDWORD;
+            FrameWait waitKind = FrameWait::Throttle; // What the wait below blocks on, for the frame breakdown
+
+            // Continuations of finished jobs
+            if (HANDLE continuationEvent = JobSystem::Get().GetRenderThreadEvent()) {
+                waitHandles[handleCount++] = continuationEvent;
+            }
+
+            BrowserManager* browserManager = browserView->GetBrowserManager();
+            if (browserView->IsBrowserStarted() && !browserView->IsProcessingSuspended()) {
+                waitHandles[handleCount++] = browserManager->GetPumpWorkEvent();
+                waitTimeoutMs = std::min(waitTimeoutMs, browserManager->GetPumpWorkTimeoutMs());
+            }
+
+            if (!halted) {
+                // Wake for the next browser begin frame
+                waitTimeoutMs = std::min(waitTimeoutMs,
+                    browserView->GetBeginFrameTimeoutMs(performanceOptimizer->GetTargetFrameTime()));
+            }
+
+            if (occluded) {
+                waitTimeoutMs = std::min(waitTimeoutMs, OCCLUDED_POLL_INTERVAL_MS);
+            }
+            else if (frameWanted) {
+                // Wait on the first thing that still blocks the next frame
+                HANDLE frameReadyEvent = nullptr;
+                bool frameDue = performanceOptimizer->IsFrameDue();
+                if (!frameDue) {
+                    auto spinStart = std::chrono::steady_clock::now();
+                    frameDue = performanceOptimizer->SpinUntilFrameDue();
+                    performanceMonitor->AddFrameWaitTime(FrameWait::Throttle, std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - spinStart).count() / 1000.0f);
+                }
+                if (!frameDue) {
+                    if (HANDLE frameTimer = performanceOptimizer->ArmFrameTimer()) {
+                        waitHandles[handleCount++] = frameTimer;
+                    }
+                    else {
+                        waitTimeoutMs = std::min(waitTimeoutMs, 1UL); // No timer, or inside its margin: poll
+                    }
+                }
+                else if (renderSystem->IsSubmissionPending()) {
+                    waitKind = FrameWait::GpuWait; // The UI recording job; its continuation wakes the wait
+                }
+                else if (HANDLE latencyObject = frameLatencyWait ? renderSystem->GetFrameLatencyWaitableObject() : nullptr) {
+                    if (!latencyWaitActive) {
+                        latencyWaitActive = true;
+                        latencyWaitStart = std::chrono::steady_clock::now();
+                    }
+                    auto latencyWaited = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - latencyWaitStart).count();
+                    latencyHandleIndex = handleCount;
+                    waitKind = FrameWait::PresentBlock;
+                    waitHandles[handleCount++] = latencyObject;
+                    waitTimeoutMs = std::min(waitTimeoutMs, latencyWaited >= static_cast<long long>(FRAME_LATENCY_TIMEOUT_MS) ?
+                        0UL : static_cast<DWORD>(FRAME_LATENCY_TIMEOUT_MS - latencyWaited));
+                }
+                else if ((frameReadyEvent = renderSystem->GetFrameReadyEvent()) != nullptr) {
+                    waitKind = FrameWait::GpuWait;
+                    waitHandles[handleCount++] = frameReadyEvent;
+                }
+                else {
+                    waitTimeoutMs = 0; // Everything is ready
+                }
+            }
+            else if (performanceOptimizer->IsRenderOnDemand() && optimizerConfig.idleRedrawIntervalMs > 0) {
+                // Wake for the periodic redraw
+                auto sinceRedraw = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - lastRedrawTime).count();
+                DWORD untilRedraw = sinceRedraw >= static_cast<long long>(optimizerConfig.idleRedrawIntervalMs) ? 0 :
+                    static_cast<DWORD>(optimizerConfig.idleRedrawIntervalMs - sinceRedraw);
+                waitTimeoutMs = std::min(waitTimeoutMs, untilRedraw);
+            }
+
+            if (latencyHandleIndex == MAXDWORD) latencyWaitActive = false; // Nothing to resume
+
+            auto waitStart = std::chrono::steady_clock::now();
+            DWORD waitResult;
+            {
+                PROFILE_ZONE("Wait");
+                waitResult = MsgWaitForMultipleObjectsEx(handleCount, waitHandles, waitTimeoutMs,
+                    QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+            }
+            performanceMonitor->AddFrameWaitTime(waitKind, std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - waitStart).count() / 1000.0f);
+
+            // The wait consumed the latency object's count, or gave up on it once FRAME_LATENCY_TIMEOUT_MS
+            // passed over all iterations; a shorter timeout (another handle's) or a message keeps it going
+            if (latencyHandleIndex != MAXDWORD) {
+                auto waited = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - latencyWaitStart);
+                bool signaled = waitResult == WAIT_OBJECT_0 + latencyHandleIndex;
+                bool timedOut = waitResult == WAIT_TIMEOUT &&
+                    waited >= std::chrono::milliseconds(FRAME_LATENCY_TIMEOUT_MS);
+                if (signaled || timedOut) {
+                    renderSystem->CompleteFrameLatencyWait(signaled, waited.count() / 1000.0f);
+                    latencyWaitActive = false;
+                }
+            }
+
             // Process Windows messages
-            while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
-                TranslateMessage(&msg);
-                DispatchMessage(&msg);
+            {
+                PROFILE_ZONE("Message Pump");
+                ThreadCycleScope cycles(ThreadSubsystem::Input);
+                while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+                    TranslateMessage(&msg);
+                    DispatchMessage(&msg);
 
-                if (msg.message == WM_QUIT) {
-                    running = false;
-                    break;
+                    if (msg.message == WM_QUIT) {
+                        running = false;
+                        break;
+                    }
                 }
             }
 
             if (!running) break;
 
-            // --- Frame Start ---
-            performanceMonitor->BeginFrame();
-            performanceOptimizer->UpdateState(); // Determine current performance state
+            // --- Job Continuations ---
+            JobSystem::Get().RunRenderThreadContinuations();
+
+            {
+                PROFILE_ZONE("Optimizer Update");
+                ThreadCycleScope cycles(ThreadSubsystem::Optimizer);
+                performanceOptimizer->UpdateState(); // Determine current performance state
+            }
 
             // --- Browser Update ---
-            // Process CEF message loop and check for paint events
+            // Process CEF message loop work if it was scheduled and check for paint events
             // This might trigger BrowserView::SignalTextureUpdateFromHandler via OnPaint
-            if (browserView->GetBrowserManager() && browserView->GetBrowserManager()->m_initialized) {
-                browserView->Update();
+            if (browserView->IsBrowserStarted()) {
+                PROFILE_ZONE("Browser Update");
+                ThreadCycleScope cycles(ThreadSubsystem::Browser);
+                // CEF's share of the frame: up to the next frame while none is due, otherwise what
+                // the frame's own work (recent average, CEF excluded) leaves of the interval.
+                // Without a frame to make, no deadline: the slice count still bounds the call.
+                const auto now = std::chrono::steady_clock::now();
+                const auto frameInterval = performanceOptimizer->GetTargetFrameTime();
+                auto pumpDeadline = std::chrono::steady_clock::time_point::max();
+                if (!halted && frameWanted) {
+                    pumpDeadline = now + frameInterval;
+                    const auto frameDeadline = performanceOptimizer->GetFrameDeadline();
+                    if (frameDeadline > now) {
+                        pumpDeadline = frameDeadline;
+                    }
+                    else {
+                        const float frameWorkMs = std::max(performanceMonitor->GetAverageFrameTimeBreakdown().workMs -
+                            performanceMonitor->GetCefPumpStats().averageFrameMs, 0.0f);
+                        pumpDeadline -= std::chrono::microseconds(static_cast<long long>(frameWorkMs * 1000.0f));
+                    }
+                }
+                browserView->SetWindowHidden(!windowManager->IsVisible() || windowManager->IsMinimized());
+                browserView->Update(pumpDeadline, frameInterval);
             }
 
-            // Apply frame throttling based on optimizer state *before* rendering
-            performanceOptimizer->ThrottleFrame();
+            // --- Present Hook ---
+            // Follows the foreground game once it is detected as one; the hook only draws into that
+            // game's window, and only while the overlay is visible
+            SharedLayer* sharedLayer = renderSystem->GetSharedLayer();
+            if (sharedLayer) {
+                sharedLayer->SetVisible(windowManager->IsWindowShown());
+                HWND gameWindow = performanceOptimizer->GetDetectedGameWindow();
+                DWORD gameProcessId = 0;
+                if (gameWindow) {
+                    GetWindowThreadProcessId(gameWindow, &gameProcessId);
+                    if (presentHook) presentHook->Attach(gameWindow);
+                }
+                sharedLayer->SetTarget(gameProcessId, gameWindow);
+            }
+
+            // --- Occlusion ---
+            // Hidden, minimized or fully covered: stop GPU submission entirely. The wait returns
+            // early on any message, so visibility changes resume rendering immediately. While the
+            // hook draws into the game, covering this window doesn't matter. Hidden panels leave
+            // the window up while the HUD has widgets to show.
+            windowManager->SetShownWhileHidden(uiSystem->GetHudLayer().IsShown());
+            bool windowHidden = !windowManager->IsWindowShown() || windowManager->IsMinimized();
+            bool drawnInGame = sharedLayer && sharedLayer->IsConsumerAttached();
+            halted = windowHidden || (!drawnInGame && renderSystem->IsOccluded() && renderSystem->TestOcclusion());
+            occluded = halted && !windowHidden; // Hidden (resident) sleeps until a message or CEF work
+            if (BrowserManager* browserManager = browserView->GetBrowserManager()) {
+                browserManager->SetWidgetsFrozen(halted); // Nothing shows the HUD's web widgets
+            }
+            if (trayIcon) trayIcon->SetOverlayVisible(windowManager->IsVisible());
+            if (halted) {
+                continue;
+            }
+
+            // --- Browser Begin Frame ---
+            // One per frame interval we could show (longer when Inactive/Background); CEF only
+            // paints when the page actually changed
+            browserView->SendBeginFrameIfDue(performanceOptimizer->GetTargetFrameTime());
+
+            // --- Damage Tracking ---
+            // Skip recording, execution and present entirely when nothing changed
+            auto now = std::chrono::steady_clock::now();
+            if (performanceOptimizer->IsRenderOnDemand()) {
+                if (browserView->TextureNeedsGPUCopy()) {
+                    renderSystem->InvalidateFrame(); // New browser paint
+                }
+
+                if (optimizerConfig.idleRedrawIntervalMs > 0 &&
+                    now - lastRedrawTime >= std::chrono::milliseconds(optimizerConfig.idleRedrawIntervalMs)) {
+                    renderSystem->InvalidateFrame(); // Perf graph tick
+                }
+
+                if (uiSystem->GetHudLayer().IsRefreshDue(now)) {
+                    renderSystem->InvalidateFrame(); // HUD widget tick
+                }
+
+                WebWidgetAtlas* webWidgetAtlas = browserView->GetWebWidgetAtlas();
+                if (webWidgetAtlas && webWidgetAtlas->HasPendingUploads()) {
+                    renderSystem->InvalidateFrame(); // Pinned widget paint
+                }
+
+                FrameReadback* frameReadback = renderSystem->GetFrameReadback();
+                if (frameReadback && frameReadback->HasPendingCopies()) {
+                    renderSystem->InvalidateFrame(); // Screenshot waiting for its copy
+                }
+
+                if (windowManager->IsVisible() != panelsShown) {
+                    renderSystem->InvalidateFrame(); // Panels shown or hidden over the HUD
+                }
+
+                frameWanted = renderSystem->IsFrameInvalidated();
+            }
+            else {
+                frameWanted = true;
+            }
+
+            if (!frameWanted) {
+                continue;
+            }
+
+            // --- Frame Pacing ---
+            // Not ready yet: the next wait covers whichever of these still blocks
+            if (!performanceOptimizer->IsFrameDue() || !renderSystem->IsFrameLatencyReady() ||
+                !renderSystem->IsFrameSlotReady()) {
+                continue;
+            }
+
+            if (performanceOptimizer->IsRenderOnDemand()) {
+                renderSystem->ConsumeFrameInvalidation();
+                lastRedrawTime = now;
+            }
+            performanceOptimizer->MarkFrameStart();
+            performanceMonitor->RecordFrameLatencyWait(renderSystem->GetLastFrameLatencyWaitMs());
+
+            // --- Monitor ---
+            // The overlay follows the game to its monitor, at that monitor's resolution and DPI
+            if (windowManager->FollowMonitor(performanceOptimizer->GetForegroundGameWindow(),
+                !imguiSystem->IsCompactWindow())) {
+                imguiSystem->SetDpiScale(windowManager->GetDpiScale());
+                if (imguiSystem->IsCompactWindow()) {
+                    imguiSystem->SetCompactWindow(true, windowManager->GetScreenRect());
+                }
+                else {
+                    renderSystem->Resize(windowManager->GetWidth(), windowManager->GetHeight());
+                }
+                renderSystem->InvalidateFrame();
+            }
+
+            // --- Compact Window ---
+            // Fitted to last frame's panels before this frame's back buffer is acquired; moves are
+            // free, size changes resize the swap chain (rare, see GetCompactBounds)
+            RECT contentBounds = {};
+            if (imguiSystem->GetContentBounds(contentBounds)) {
+                RECT bounds = windowManager->GetCompactBounds(contentBounds);
+                const int width = bounds.right - bounds.left;
+                const int height = bounds.bottom - bounds.top;
+                if (width != renderSystem->GetWidth() || height != renderSystem->GetHeight()) {
+                    renderSystem->Resize(width, height);
+                }
+                windowManager->SetBounds(bounds);
+            }
 
             // --- Render Preparation ---
-            renderSystem->BeginFrame(); // Resets command list, sets RT, clears
+            {
+                PROFILE_ZONE("Begin Frame");
+                renderSystem->BeginFrame(); // Resets command list, sets RT, clears
+            }
             ID3D12GraphicsCommandList* commandList = renderSystem->GetCommandList();
+            bool browserPaintCopied = false;
+
+            // --- Tab Thumbnail ---
+            // The tab that gave up the texture leaves its frame as a thumbnail; the new tab's paint
+            // waits a frame, as a copy-queue upload would otherwise overwrite it first
+            const bool thumbnailCaptured = browserView->RecordTabThumbnailCapture(commandList);
+            if (thumbnailCaptured) {
+                imguiSystem->InvalidateUiLayer(); // Tooltips and the switch placeholder sample it in place
+            }
 
             // --- Browser Texture GPU Copy ---
             // Check if the browser signalled a texture update and perform the GPU copy
-            if (browserView->TextureNeedsGPUCopy()) {
-                // Lock to safely access buffer details potentially written by CEF thread
-                std::lock_guard<std::mutex> lock(browserView->m_bufferMutex); // Use the mutex from BrowserView
+            if (!thumbnailCaptured && browserView->TextureNeedsGPUCopy()) {
+                PROFILE_ZONE("Browser Copy");
+                ThreadCycleScope cycles(ThreadSubsystem::Browser);
+                // Cleared first: a paint published while this runs sets it again
+                browserView->ClearTextureUpdateFlag();
+                performanceMonitor->RecordBrowserUploadPath(browserView->GetUploadPath());
+                resourceManager->NotifyResourceUsed(browserView->GetTexture()); // Resident before the copy
 
-                const void* cpuBuffer = browserView->GetCpuBufferData();
-                int cpuBufferWidth = browserView->GetCpuBufferWidth();
-                int cpuBufferHeight = browserView->GetCpuBufferHeight();
+                // Lock to safely access the shared texture potentially replaced by the CEF thread
+                std::lock_guard<ProfiledMutex> lock(browserView->m_bufferMutex); // Use the mutex from BrowserView
 
-                if (cpuBuffer && cpuBufferWidth > 0 && cpuBufferHeight > 0 &&
-                    browserView->GetUploadTexture() && browserView->GetTexture())
-                {
-                    // 1. Copy CPU data (from CEF buffer) to Upload Buffer
-                    D3D12_RANGE readRange = { 0, 0 }; // We are writing, not reading
-                    void* mappedData = nullptr;
-                    HRESULT hr = browserView->GetUploadTexture()->Map(0, &readRange, &mappedData);
-                    if (SUCCEEDED(hr)) {
-                        size_t srcRowPitch = static_cast<size_t>(cpuBufferWidth) * 4; // BGRA
-                        size_t dstRowPitch = (srcRowPitch + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) & ~(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1);
-                        size_t dstBufferSize = dstRowPitch * cpuBufferHeight; // Use actual buffer height
-
-                        // Ensure buffer is large enough
-                        D3D12_RESOURCE_DESC uploadDesc = browserView->GetUploadTexture()->GetDesc();
-                        if (dstBufferSize <= uploadDesc.Width) {
-                            // Copy row by row
-                            for (int y = 0; y < cpuBufferHeight; ++y) {
-                                memcpy(
-                                    static_cast<uint8_t*>(mappedData) + y * dstRowPitch,
-                                    static_cast<const uint8_t*>(cpuBuffer) + y * srcRowPitch,
-                                    srcRowPitch // Copy only the valid data width
-                                );
-                            }
-                            // Range written (can be conservative)
-                            D3D12_RANGE writeRange = { 0, dstBufferSize };
-                            browserView->GetUploadTexture()->Unmap(0, &writeRange);
-
-                            // 2. Record GPU copy command (Upload Buffer -> Target Texture)
-                            resourceManager->TransitionResource(
-                                commandList,
-                                browserView->GetTexture(), // Target GPU texture
-                                D3D12_RESOURCE_STATE_COPY_DEST
-                            );
-
-                            D3D12_TEXTURE_COPY_LOCATION srcLocation = {};
-                            srcLocation.pResource = browserView->GetUploadTexture();
-                            srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
-                            srcLocation.PlacedFootprint.Offset = 0;
-                            srcLocation.PlacedFootprint.Footprint.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
-                            srcLocation.PlacedFootprint.Footprint.Width = cpuBufferWidth;
-                            srcLocation.PlacedFootprint.Footprint.Height = cpuBufferHeight;
-                            srcLocation.PlacedFootprint.Footprint.Depth = 1;
-                            srcLocation.PlacedFootprint.Footprint.RowPitch = (UINT)dstRowPitch; // Use aligned pitch
-
-                            D3D12_TEXTURE_COPY_LOCATION dstLocation = {};
-                            dstLocation.pResource = browserView->GetTexture();
-                            dstLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-                            dstLocation.SubresourceIndex = 0;
-
-                            commandList->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, nullptr);
-
-                            // 3. Transition target texture back for rendering
-                            resourceManager->TransitionResource(
-                                commandList,
-                                browserView->GetTexture(),
-                                D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
-                            );
-                        }
-                        else {
-                            // Buffer size mismatch - log error
-                            OutputDebugStringA("Error: Upload buffer size mismatch during browser texture copy.\n");
-                            browserView->GetUploadTexture()->Unmap(0, nullptr); // Unmap even on error
+                ID3D12Resource* sharedTexture = browserView->GetSharedTexture();
+                BrowserView::UploadSlot* uploadSlot = nullptr;
+
+                if (browserView->UsesGpuConversion()) {
+                    // Compute path: convert to RGBA and rebuild the mips over the dirty region, on
+                    // the direct queue (ImGui's texture flush covers the transition back)
+                    renderSystem->BeginGpuPass(GpuPass::BrowserCopy);
+                    if (sharedTexture) {
+                        browserView->RecordFrameConversion(commandList, sharedTexture);
+                        browserView->ConsumeSharedTexture(); // Reused once this frame is done with it
+                        browserPaintCopied = true;
+                    }
+                    else if ((uploadSlot = browserView->TakePublishedUploadSlot()) != nullptr) {
+                        if (!browserView->RecordFrameConversion(commandList, uploadSlot)) {
+                            browserView->RequestFullUpload();
                         }
+                        browserView->ReleaseUploadSlot(uploadSlot, renderSystem->GetCurrentFenceValue());
+                        browserPaintCopied = true;
+                    }
+                    renderSystem->EndGpuPass(GpuPass::BrowserCopy);
+                }
+                else if (sharedTexture && browserView->GetTexture()) {
+                    // Accelerated paint: GPU-to-GPU copy out of CEF's shared texture, no CPU round trip
+                    ID3D12GraphicsCommandList* copyList = renderSystem->BeginCopyCommands();
+                    const bool useCopyQueue = copyList != nullptr;
+                    if (!useCopyQueue) {
+                        copyList = commandList;
+                        renderSystem->BeginGpuPass(GpuPass::BrowserCopy);
+                        resourceManager->TransitionResource(commandList, browserView->GetTexture(), D3D12_RESOURCE_STATE_COPY_DEST);
+                    }
+
+                    // CEF's texture follows the browser size, which can lag a resize by a frame
+                    D3D12_RESOURCE_DESC srcDesc = sharedTexture->GetDesc();
+                    D3D12_RESOURCE_DESC dstDesc = browserView->GetTexture()->GetDesc();
+                    D3D12_BOX srcBox = {};
+                    srcBox.right = static_cast<UINT>(std::min(srcDesc.Width, dstDesc.Width));
+                    srcBox.bottom = std::min(srcDesc.Height, dstDesc.Height);
+                    srcBox.back = 1;
+
+                    D3D12_TEXTURE_COPY_LOCATION srcLocation = {};
+                    srcLocation.pResource = sharedTexture;
+                    srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+                    srcLocation.SubresourceIndex = 0;
+
+                    D3D12_TEXTURE_COPY_LOCATION dstLocation = {};
+                    dstLocation.pResource = browserView->GetTexture();
+                    dstLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+                    dstLocation.SubresourceIndex = 0;
+
+                    copyList->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, &srcBox);
+
+                    if (useCopyQueue) {
+                        renderSystem->SubmitCopyCommands();
                     }
                     else {
-                        OutputDebugStringA("Error: Failed to map upload buffer for browser texture.\n");
+                        // Split: the transition overlaps the work recorded before ImGui samples it
+                        resourceManager->BeginSplitTransition(browserView->GetTexture(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+                        resourceManager->FlushBarriers(commandList);
+                        renderSystem->EndGpuPass(GpuPass::BrowserCopy);
                     }
+
+                    // Reused once this frame is done with it
+                    browserView->ConsumeSharedTexture();
+                    browserView->SetShownContentSize(static_cast<int>(srcBox.right), static_cast<int>(srcBox.bottom));
+                    browserPaintCopied = true;
                 }
-                browserView->ClearTextureUpdateFlag(); // Clear flag regardless of success/failure
+                else if (browserView->UsesGpuUploadTextures()) {
+                    // OnPaint wrote straight into a texture in VRAM; nothing to record, it is shown from now
+                    if ((uploadSlot = browserView->TakePublishedUploadSlot()) != nullptr) {
+                        browserView->ShowUploadSlot(uploadSlot, renderSystem->GetCurrentFenceValue());
+                        browserPaintCopied = true;
+                    }
+                }
+                else if (browserView->GetTexture()) {
+                    // OnPaint already wrote the dirty regions into a slot; only the GPU copies are recorded
+                    // here (on the copy queue when available), within the frame's upload budget
+                    browserPaintCopied = browserView->RecordScheduledUploads(commandList);
+                }
+
+                // Dropdowns and autocomplete: only the small popup layer is uploaded
+                browserView->RecordPopupUpload(commandList);
+            }
+            renderSystem->TagFrameBrowserPaint(browserView->TakeShownPaintTime()); // Paint-to-photon
+
+            // Pinned web widgets, each within its own upload budget; the HUD draws them
+            if (WebWidgetAtlas* webWidgetAtlas = browserView->GetWebWidgetAtlas()) {
+                webWidgetAtlas->RecordUploads(commandList);
             }
 
             // --- UI Rendering ---
-            imguiSystem->BeginFrame(); // Starts ImGui frame
-            uiSystem->Render();        // Renders all UI pages and elements
-            imguiSystem->EndFrame();   // Generates ImGui draw data and records render commands
+            // A maximized browser page that fills the frame 1:1 is copied into it; nothing else is
+            // under its UI, so the chrome is skipped too. With the panels hidden only the HUD draws.
+            panelsShown = windowManager->IsVisible();
+            if (panelsShown && !browserView->RecordFullscreenCopy(uiSystem->IsBrowserMaximized())) {
+                renderSystem->DrawStaticLayers(); // Pre-recorded chrome, beneath the UI
+            }
+            // Input handled so far (messages, dispatched hotkeys) is what this frame reflects
+            renderSystem->TagFrameInput(TakeInputStamp());
+            performanceMonitor->SetInputLatencyConfiguration({ frameLatencyWait && renderSystem->GetFrameLatencyWaitableObject(),
+                renderSystem->GetFramesInFlight(), hotkeyManager->IsRawInputActive() });
+            // Browser paints change these without changing the draw data, so the cached UI layer
+            // stops short of them: the page texture, then the popup's (zero without one)
+            auto getLiveTextures = [&](D3D12_GPU_DESCRIPTOR_HANDLE (&textures)[2]) {
+                textures[0] = browserView->GetTextureGpuHandle();
+                RECT popupRect = {};
+                if (!browserView->GetPopupLayer(textures[1], popupRect)) textures[1] = {};
+            };
+            if (performanceMonitor->TakeTextEmissionBenchmarkRequest()) {
+                // Between builds: the UI thread is idle here
+                performanceMonitor->RecordTextEmissionBenchmark(imguiSystem->RunTextEmissionBenchmark(
+                    [&]() { uiSystem->Render(); }, textEmissionBenchmarkFrames));
+            }
+            const bool pipelinedUi = imguiSystem->IsPipelinedBuild();
+            if (pipelinedUi) {
+                // The UI thread builds the next frame's UI while this one records the last
+                imguiSystem->StartFrameBuild([&, panelsShown]() {
+                    if (panelsShown) {
+                        PROFILE_ZONE("UI Render");
+                        uiSystem->Render();
+                    }
+                    D3D12_GPU_DESCRIPTOR_HANDLE builtTextures[2];
+                    getLiveTextures(builtTextures);
+                    for (const D3D12_GPU_DESCRIPTOR_HANDLE& texture : builtTextures) {
+                        imguiSystem->AddLiveTexture(texture);
+                    }
+                });
+                uiSystem->RenderHud();
+                D3D12_GPU_DESCRIPTOR_HANDLE liveTextures[2];
+                getLiveTextures(liveTextures);
+                {
+                    PROFILE_ZONE("ImGui Record");
+                    imguiSystem->RecordBuiltFrame(liveTextures, 2);
+                }
+            }
+            else {
+                uiSystem->RenderHud();
+                imguiSystem->BeginFrame(); // Starts ImGui frame
+                if (panelsShown) {
+                    PROFILE_ZONE("UI Render");
+                    ThreadCycleScope cycles(ThreadSubsystem::UI);
+                    uiSystem->Render();    // Renders all UI pages and elements
+                }
+                D3D12_GPU_DESCRIPTOR_HANDLE liveTextures[2];
+                getLiveTextures(liveTextures);
+                for (const D3D12_GPU_DESCRIPTOR_HANDLE& texture : liveTextures) {
+                    imguiSystem->AddLiveTexture(texture);
+                }
+                {
+                    PROFILE_ZONE("ImGui EndFrame");
+                    ThreadCycleScope cycles(ThreadSubsystem::UI);
+                    imguiSystem->EndFrame(); // Generates ImGui draw data and records render commands
+                }
+                windowManager->SetHitRects(imguiSystem->GetHitRects()); // Clicks outside panels reach the game
+            }
 
             // --- Frame End ---
-            renderSystem->EndFrame(); // Executes command list, presents swap chain
+            if (sharedLayer) {
+                const RECT bounds = windowManager->GetBounds();
+                sharedLayer->SetOrigin(bounds.left, bounds.top);
+            }
+            {
+                PROFILE_ZONE("End Frame");
+                renderSystem->EndFrame(); // Executes command list, presents swap chain
+            }
+            if (pipelinedUi) {
+                imguiSystem->FinishFrameBuild(); // The UI thread is idle from here to the next StartFrameBuild
+                windowManager->SetHitRects(imguiSystem->GetHitRects());
+            }
+
+            // Keep rendering while ImGui animates without input (text cursor, drags)
+            if (imguiSystem->WantsContinuousUpdate()) {
+                renderSystem->InvalidateFrame();
+            }
+            performanceMonitor->RecordPresentedArea(renderSystem->GetLastPresentedPixels(), renderSystem->GetBackBufferPixels());
+            performanceMonitor->RecordPresentationMode(renderSystem->GetPresentationMode(), renderSystem->IsOverlayPlaneSupported());
+            performanceMonitor->RecordDisplayStatistics(renderSystem->GetDisplayStatistics());
+            performanceMonitor->RecordOptimizerState(static_cast<uint32_t>(performanceOptimizer->GetPerformanceState()),
+                renderSystem->GetRenderScale());
+
+            // --- Resident Wake ---
+            float wakeLatencyMs = performanceOptimizer->TakeWakeLatencyMs();
+            if (wakeLatencyMs >= 0.0f) {
+                performanceMonitor->RecordWakeLatency(wakeLatencyMs);
+                if (wakeLatencyMs > PerformanceOptimizer::RESIDENT_WAKE_TARGET_MS) {
+                    LOG_WARNING("Wake from resident took %.1f ms", wakeLatencyMs);
+                }
+            }
+
+            // --- Startup Milestones ---
+            auto sinceStartMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - appStartTime).count();
+            if (!firstFramePresented) {
+                firstFramePresented = true;
+                performanceMonitor->RecordTimeToFirstFrame(sinceStartMs);
+            }
+            if (browserPaintCopied && !firstBrowserPaintPresented) {
+                firstBrowserPaintPresented = true;
+                performanceMonitor->RecordTimeToFirstBrowserPaint(sinceStartMs);
+            }
+
+            // --- Lazy Browser Startup ---
+            // The overlay is on screen; now pay for CefInitialize and the first browser
+            if (!browserView->IsBrowserStarted() && !browserView->HasBrowserStartFailed() &&
+                (!optimizerConfig.deferBrowserUntilOpened || browserView->IsBrowserStartRequested())) {
+                browserView->GetBrowserManager()->SetGpuPolicy(performanceOptimizer->GetBrowserGpuPolicy());
+                if (browserView->StartBrowser()) {
+                    performanceMonitor->RecordBrowserGpuPolicy(browserView->GetBrowserManager()->GetGpuPolicy());
+                    renderSystem->InvalidateFrame(); // Show the browser page's new state
+                }
+            }
+
+            // GPU timestamps (from a frame that has already completed)
+            performanceMonitor->RecordGpuFrameTime(renderSystem->GetGpuFrameTimeMs());
+            for (size_t i = 0; i < static_cast<size_t>(GpuPass::Count); i++) {
+                GpuPass pass = static_cast<GpuPass>(i);
+                performanceMonitor->RecordGpuPassTime(pass, renderSystem->GetGpuPassTimeMs(pass));
+            }
+            performanceMonitor->RecordBrowserUploadedBytes(browserView->GetUploadedBytes());
+            performanceMonitor->RecordBrowserTileStats(browserView->GetTileStats());
+            performanceMonitor->RecordBrowserPaintStats(browserView->GetPaintStats());
+            if (browserView->IsBrowserStarted()) {
+                BrowserManager* browserManager = browserView->GetBrowserManager();
+                browserManager->PollPageMetrics();
+                performanceMonitor->RecordPageMetrics(browserManager->GetPageMetrics());
+                browserManager->TakeNavigationTimings(navigationTimings);
+                for (const NavigationTiming& timing : navigationTimings) {
+                    performanceMonitor->RecordNavigation(timing);
+                }
+            }
+
+            // --- Allocations ---
+            const AllocationCounters frameAllocations = AllocationTracker::EndFrame();
+            performanceMonitor->RecordFrameAllocations(frameAllocations);
+            if (assertZeroAlloc && sinceStartMs >= zeroAllocWarmupSeconds * 1000.0f &&
+                std::chrono::steady_clock::now() - g_lastWindowInputTime >= ZERO_ALLOC_INPUT_SETTLE) {
+                performanceMonitor->RecordSteadyStateFrame();
+                if (frameAllocations.allocations > 0) {
+                    ZoneAllocations worst;
+                    const char* zone = AllocationTracker::GetLastFrameZones(&worst, 1) > 0 ? worst.name : nullptr;
+                    performanceMonitor->RecordSteadyStateAllocation(frameAllocations, zone);
+                    LOG_WARNING("Steady-state %s frame made %llu allocations (%llu bytes), most in %s",
+                        browserPaintCopied ? "browser repaint" : "idle", static_cast<unsigned long long>(frameAllocations.allocations),
+                        static_cast<unsigned long long>(frameAllocations.bytes), zone ? zone : "no zone");
+                }
+            }
+            performanceMonitor->AddFrameWaitTime(FrameWait::GpuWait, renderSystem->GetLastFrameSlotWaitMs());
+            performanceMonitor->AddFrameWaitTime(FrameWait::PresentBlock, renderSystem->GetLastPresentBlockMs());
+            if (browserView->IsBrowserStarted()) {
+                performanceMonitor->RecordCefPumpFrame(browserView->GetBrowserManager()->TakePumpFrame());
+            }
             performanceMonitor->EndFrame(); // Collect metrics
+            performanceMonitor->BeginFrame(); // Frame time spans present to present, waits included
+            PROFILE_FRAME(); // Same boundary for the CPU timeline
+
+            // --- Page Telemetry ---
+            // One batched message per frame for web widgets
+            if (browserView->IsBrowserStarted()) {
+                ThreadCycleScope cycles(ThreadSubsystem::Telemetry);
+                TelemetryBridge& telemetry = browserView->GetBrowserManager()->GetTelemetryBridge();
+                telemetry.SetValue("overlay.fps", performanceMonitor->GetFramesPerSecond());
+                telemetry.SetValue("overlay.frameTimeMs", performanceMonitor->GetFrameTime() * 1000.0f);
+                telemetry.SetValue("overlay.gpuFrameTimeMs", performanceMonitor->GetGpuFrameTimeMs());
+                telemetry.SetValue("overlay.cpuPercent", performanceMonitor->GetCpuUsagePercent());
+                telemetry.SetValue("overlay.memoryMB", performanceMonitor->GetTotalMemoryUsageMB());
+                browserView->GetBrowserManager()->FlushTelemetry();
+            }
+
+            // --- Deferred Browser Work ---
+            // What the frame had no budget for, in the time left before the next one is due
+            if (browserView->IsBrowserStarted() && !browserView->IsProcessingSuspended()) {
+                PROFILE_ZONE("Deferred Browser Work");
+                ThreadCycleScope cycles(ThreadSubsystem::Browser);
+                browserManager->DoScheduledMessageLoopWork(performanceOptimizer->GetFrameDeadline(),
+                    performanceOptimizer->GetTargetFrameTime());
+            }
         }
 
         // --- Cleanup ---
+        if (!perfReportPath.empty() && !performanceMonitor->WritePerformanceReport(perfReportPath)) {
+            LOG_WARNING("Failed to write performance report: %s", perfReportPath);
+        }
         performanceOptimizer->Suspend(); // Stop optimizer tasks cleanly
+        performanceOptimizer->SetMemoryTrimCallback(nullptr);
 
         // Wait for GPU before destroying anything that might be in use
         renderSystem->WaitForGpu();
@@ -220,15 +941,29 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         // (Manager shutdown is handled within BrowserView's destructor)
         if (browserView) browserView->Shutdown(); // Ensure browser is down
 
+        // Settings changed in the last moments are still waiting for their debounce; the window
+        // layout saved when ImGui shuts down is written when the store is destroyed
+        SettingsDatabase::Get().Save();
+        SettingsStore::Get().Flush();
+
         // Destructors handle the rest in reverse order of declaration:
-        // uiSystem, imguiSystem, performanceOptimizer, browserView, commandAllocatorPool,
+        // uiSystem, imguiSystem, performanceOptimizer, browserView,
         // pipelineStateManager, hotkeyManager, performanceMonitor, renderSystem, windowManager
 
         g_hotkeyManager = nullptr; // Clear global reference
+        g_renderSystem = nullptr;
+        g_performanceOptimizer = nullptr;
+        g_browserView = nullptr;
+        g_trayIcon = nullptr;
+        renderSystem->SetPipelineStateManager(nullptr); // Destroyed before the render system
 
+        if (assertZeroAlloc && (!AllocationTracker::IsCompiledIn() || performanceMonitor->GetSteadyStateAllocatingFrames() > 0)) {
+            return 3; // Allocation check failed
+        }
         return static_cast<int>(msg.wParam); // Return quit code
     }
     catch (const std::exception& e) {
+        LOG_ERROR("Fatal: %s", e.what());
         MessageBoxA(nullptr, e.what(), "Fatal Error", MB_OK | MB_ICONERROR);
         return 1; // Return error code
     }
@@ -240,7 +975,18 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 
 // Window Procedure
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
-    // Let ImGui handle input first
+    // Any input or size change means the next frame must be drawn
+    if (g_renderSystem && IsFrameDamagingMessage(uMsg)) {
+        g_renderSystem->InvalidateFrame();
+        g_lastWindowInputTime = std::chrono::steady_clock::now();
+        if (uMsg != WM_MOUSEMOVE && ((uMsg >= WM_MOUSEFIRST && uMsg <= WM_MOUSELAST) || (uMsg >= WM_KEYFIRST && uMsg <= WM_KEYLAST))) {
+            StampInput(QueryInputTime());
+        }
+    }
+
+    // Keys go to the web page while it has keyboard focus, otherwise ImGui handles input first
+    if (g_browserView && g_browserView->HandleKeyMessage(uMsg, wParam, lParam))
+        return 0;
     if (ImGuiSystem::ProcessMessage(hwnd, uMsg, wParam, lParam))
         return true; // ImGui handled it
 
@@ -248,6 +994,9 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
     // Using GetWindowLongPtr for 64-bit compatibility
     WindowManager* pWindowManager = reinterpret_cast<WindowManager*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
 
+    if (g_trayIcon && g_trayIcon->HandleMessage(uMsg, wParam, lParam))
+        return 0;
+
     switch (uMsg) {
     case WM_CREATE: {
         // Store the 'this' pointer passed from CreateWindowEx
@@ -265,20 +1014,70 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
             // Currently called from main loop is likely okay, but check implications.
             // For now, just update WindowManager's state.
             pWindowManager->HandleResize(LOWORD(lParam), HIWORD(lParam));
-            // TODO: Trigger RenderSystem->Resize() here if needed immediately
+
+            // Debounced: the swap chain is resized once the drag settles
+            if (g_renderSystem) {
+                g_renderSystem->RequestResize(LOWORD(lParam), HIWORD(lParam));
+            }
+        }
+        // Minimizing and restoring change the performance state
+        if (g_performanceOptimizer && (wParam == SIZE_MINIMIZED || wParam == SIZE_RESTORED)) {
+            g_performanceOptimizer->NotifyWindowStateChanged();
         }
         return 0;
     }
 
                 // Intercept activation messages to update optimizer state
     case WM_ACTIVATEAPP: {
-        // TODO: Signal Active/Inactive state change to PerformanceOptimizer
-        // if (pPerformanceOptimizer) {
-        //     pPerformanceOptimizer->SetApplicationActive(wParam == TRUE);
-        // }
+        if (g_performanceOptimizer) {
+            g_performanceOptimizer->NotifyApplicationActive(wParam == TRUE);
+        }
         break; // Still pass to DefWindowProc
     }
 
+    case WM_DPICHANGED:
+    case WM_DISPLAYCHANGE:
+        // The main loop re-reads the monitor; the suggested window rect is ignored, the overlay
+        // always covers the monitor's native resolution
+        if (pWindowManager) {
+            pWindowManager->InvalidateMonitor();
+        }
+        if (g_renderSystem) {
+            g_renderSystem->InvalidateFrame();
+        }
+        if (uMsg == WM_DPICHANGED) return 0;
+        break;
+
+    case WM_NCHITTEST:
+        // Panels take the mouse, the rest of the screen belongs to the game
+        if (pWindowManager) {
+            return pWindowManager->OnNcHitTest(lParam);
+        }
+        break;
+
+    case WM_TIMER:
+        if (pWindowManager && wParam == WindowManager::HIT_TEST_TIMER_ID) {
+            pWindowManager->UpdateClickThrough();
+            return 0;
+        }
+        break;
+
+    case HotkeyManager::WM_HOTKEY_ACTIONS:
+        // Matched on the hotkey input thread
+        if (g_hotkeyManager) {
+            g_hotkeyManager->DispatchPendingActions();
+        }
+        return 0;
+
+    case WM_POWERBROADCAST: {
+        // AC/DC, battery saver and power scheme (registered by the optimizer)
+        if (wParam == PBT_POWERSETTINGCHANGE && g_performanceOptimizer) {
+            g_performanceOptimizer->NotifyPowerSettingChange(reinterpret_cast<const POWERBROADCAST_SETTING*>(lParam));
+            return TRUE;
+        }
+        break;
+    }
+
                        // Handle standard keyboard input for hotkeys (if hook doesn't catch everything)
     case WM_KEYDOWN:
     case WM_SYSKEYDOWN:
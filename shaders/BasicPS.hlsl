@@ -0,0 +1,17 @@
+// GameOverlay - BasicPS.hlsl
+// Pixel shader for basic rendering
+
+struct PSInput
+{
+    float4 position : SV_POSITION;
+    float2 texCoord : TEXCOORD;
+    float4 color : COLOR;
+};
+
+Texture2D g_texture : register(t0);
+SamplerState g_sampler : register(s0);
+
+float4 main(PSInput input) : SV_TARGET
+{
+    return input.color;
+}
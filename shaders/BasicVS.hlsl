@@ -0,0 +1,25 @@
+// GameOverlay - BasicVS.hlsl
+// Vertex shader for basic rendering
+
+struct VSInput
+{
+    float3 position : POSITION;
+    float2 texCoord : TEXCOORD;
+    float4 color : COLOR;
+};
+
+struct VSOutput
+{
+    float4 position : SV_POSITION;
+    float2 texCoord : TEXCOORD;
+    float4 color : COLOR;
+};
+
+VSOutput main(VSInput input)
+{
+    VSOutput output;
+    output.position = float4(input.position, 1.0f);
+    output.texCoord = input.texCoord;
+    output.color = input.color;
+    return output;
+}
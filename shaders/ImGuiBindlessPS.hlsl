@@ -0,0 +1,27 @@
+// GameOverlay - ImGuiBindlessPS.hlsl
+// Pixel shader for ImGui draw data, sampling the texture its vertices name in the descriptor heap (SM 6.6)
+
+struct PSInput
+{
+    float4 position : SV_POSITION;
+    float4 color : COLOR0;
+    float2 texCoord : TEXCOORD0;
+    nointerpolation uint texIndex : TEXINDEX;
+};
+
+SamplerState g_sampler : register(s0);
+
+float4 main(PSInput input) : SV_TARGET
+{
+    // Distance field glyphs have their U moved up by 2 (DistanceFieldFont::UV_OFFSET)
+    bool field = input.texCoord.x >= 1.5f;
+    float2 texCoord = float2(input.texCoord.x - (field ? 2.0f : 0.0f), input.texCoord.y);
+
+    // Merged draws mix textures within a wave
+    Texture2D texture = ResourceDescriptorHeap[NonUniformResourceIndex(input.texIndex)];
+    float4 color = texture.Sample(g_sampler, texCoord);
+
+    // The edge is at 0.5, antialiased over one screen pixel at any scale
+    float coverage = saturate((color.a - 0.5f) / max(fwidth(color.a), 0.0001f) + 0.5f);
+    return input.color * (field ? float4(1.0f, 1.0f, 1.0f, coverage) : color);
+}
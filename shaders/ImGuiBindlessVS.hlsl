@@ -0,0 +1,43 @@
+// GameOverlay - ImGuiBindlessVS.hlsl
+// Vertex shader for ImGui draw data with per-vertex texture heap indices (SM 6.6)
+
+// Created from this shader by the ImGui backend; parameter 0 is the projection, as in its own
+#define ImGuiBindlessRootSignature \
+    "RootFlags(ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT | CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED | " \
+    "DENY_HULL_SHADER_ROOT_ACCESS | DENY_DOMAIN_SHADER_ROOT_ACCESS | DENY_GEOMETRY_SHADER_ROOT_ACCESS), " \
+    "RootConstants(num32BitConstants = 16, b0, visibility = SHADER_VISIBILITY_VERTEX), " \
+    "StaticSampler(s0, filter = FILTER_MIN_MAG_MIP_LINEAR, addressU = TEXTURE_ADDRESS_CLAMP, " \
+    "addressV = TEXTURE_ADDRESS_CLAMP, addressW = TEXTURE_ADDRESS_CLAMP, comparisonFunc = COMPARISON_ALWAYS, " \
+    "borderColor = STATIC_BORDER_COLOR_TRANSPARENT_BLACK, visibility = SHADER_VISIBILITY_PIXEL)"
+
+cbuffer vertexBuffer : register(b0)
+{
+    float4x4 ProjectionMatrix;
+};
+
+struct VSInput
+{
+    float2 position : POSITION;
+    float4 color : COLOR0;
+    float2 texCoord : TEXCOORD0;
+    uint texIndex : TEXINDEX;
+};
+
+struct VSOutput
+{
+    float4 position : SV_POSITION;
+    float4 color : COLOR0;
+    float2 texCoord : TEXCOORD0;
+    nointerpolation uint texIndex : TEXINDEX;
+};
+
+[RootSignature(ImGuiBindlessRootSignature)]
+VSOutput main(VSInput input)
+{
+    VSOutput output;
+    output.position = mul(ProjectionMatrix, float4(input.position, 0.0f, 1.0f));
+    output.color = input.color;
+    output.texCoord = input.texCoord;
+    output.texIndex = input.texIndex;
+    return output;
+}
@@ -0,0 +1,37 @@
+// GameOverlay - SpriteVS.hlsl
+// Instanced quad vertex shader for SpriteBatch (one SpriteInstance per quad, no vertex buffer)
+
+cbuffer SpriteConstants : register(b0)
+{
+    float2 g_pixelToClip; // 2 / target size in pixels
+    float2 g_padding;
+};
+
+struct VSInput
+{
+    uint vertexId : SV_VertexID;  // Triangle strip corner, 0-3
+    float2 origin : ORIGIN;       // Pixels
+    float2 axisX : AXIS0;         // Quad edges in pixels
+    float2 axisY : AXIS1;
+    float4 texRect : TEXRECT;     // u0, v0, u1, v1
+    float4 color : COLOR;
+};
+
+struct VSOutput
+{
+    float4 position : SV_POSITION;
+    float2 texCoord : TEXCOORD;
+    float4 color : COLOR;
+};
+
+VSOutput main(VSInput input)
+{
+    float2 corner = float2(input.vertexId & 1, input.vertexId >> 1);
+    float2 pixel = input.origin + corner.x * input.axisX + corner.y * input.axisY;
+
+    VSOutput output;
+    output.position = float4(pixel * g_pixelToClip * float2(1.0f, -1.0f) + float2(-1.0f, 1.0f), 0.0f, 1.0f);
+    output.texCoord = lerp(input.texRect.xy, input.texRect.zw, corner);
+    output.color = input.color;
+    return output;
+}
@@ -0,0 +1,104 @@
+// GameOverlay - TextureConvertCS.hlsl
+// Converts a BGRA frame into an RGBA texture and rebuilds its mips, 16x16 texels per group
+
+#define CONVERT_BUFFER_SOURCE  1 // Source is a raw BGRA buffer (t0), otherwise a texture (t1)
+#define CONVERT_WRITE_FIRST    2 // Write the source level to u0 (off when downsampling an existing mip)
+#define CONVERT_PREMULTIPLY    4
+#define CONVERT_LINEAR_MIPS    8 // Content is sRGB; average mips in linear light
+
+cbuffer TextureConvertConstants : register(b0)
+{
+    uint2 g_origin;      // First texel of the region in the source level, a multiple of 16
+    uint2 g_sourceSize;  // Source level size in texels
+    uint g_rowPitch;     // Buffer source: bytes per row
+    uint g_mipCount;     // Levels written after the source level (u1-u4), 0-4
+    uint g_flags;
+    uint g_padding;
+};
+
+ByteAddressBuffer g_sourceBuffer : register(t0);
+Texture2D<float4> g_sourceTexture : register(t1);
+RWTexture2D<unorm float4> g_level0 : register(u0);
+RWTexture2D<unorm float4> g_level1 : register(u1);
+RWTexture2D<unorm float4> g_level2 : register(u2);
+RWTexture2D<unorm float4> g_level3 : register(u3);
+RWTexture2D<unorm float4> g_level4 : register(u4);
+
+groupshared float4 g_tile[16][16];
+
+float3 SrgbToLinear(float3 c)
+{
+    return lerp(pow((c + 0.055f) / 1.055f, 2.4f), c / 12.92f, step(c, 0.04045f));
+}
+
+float3 LinearToSrgb(float3 c)
+{
+    return lerp(1.055f * pow(c, 1.0f / 2.4f) - 0.055f, c * 12.92f, step(c, 0.0031308f));
+}
+
+float4 LoadSource(uint2 texel)
+{
+    texel = min(texel, g_sourceSize - 1); // Edge texels repeat into partial tiles
+    float4 color;
+    if (g_flags & CONVERT_BUFFER_SOURCE) {
+        uint packed = g_sourceBuffer.Load(texel.y * g_rowPitch + texel.x * 4);
+        color = float4((packed >> 16) & 0xFF, (packed >> 8) & 0xFF, packed & 0xFF, packed >> 24) / 255.0f;
+    }
+    else {
+        color = g_sourceTexture.Load(int3(texel, 0)); // BGRA views already read as RGBA
+    }
+    if (g_flags & CONVERT_PREMULTIPLY) {
+        color.rgb *= color.a;
+    }
+    return color;
+}
+
+void StoreLevel(uint level, uint2 texel, float4 color)
+{
+    uint2 levelSize = max(g_sourceSize >> level, 1);
+    if (any(texel >= levelSize)) return;
+    if (g_flags & CONVERT_LINEAR_MIPS) {
+        color.rgb = LinearToSrgb(color.rgb);
+    }
+    if (level == 1) g_level1[texel] = color;
+    else if (level == 2) g_level2[texel] = color;
+    else if (level == 3) g_level3[texel] = color;
+    else g_level4[texel] = color;
+}
+
+[numthreads(16, 16, 1)]
+void main(uint3 groupId : SV_GroupID, uint3 localId : SV_GroupThreadID)
+{
+    uint2 texel = g_origin + groupId.xy * 16 + localId.xy;
+    float4 color = LoadSource(texel);
+    if ((g_flags & CONVERT_WRITE_FIRST) && all(texel < g_sourceSize)) {
+        g_level0[texel] = color;
+    }
+
+    if (g_flags & CONVERT_LINEAR_MIPS) {
+        color.rgb = SrgbToLinear(color.rgb);
+    }
+    g_tile[localId.y][localId.x] = color;
+    GroupMemoryBarrierWithGroupSync();
+
+    // Each level halves the tile in place: read the 2x2 block, sync, write
+    [unroll]
+    for (uint level = 1; level <= 4; level++) {
+        uint size = 16 >> level;
+        bool active = all(localId.xy < size);
+        float4 average = 0.0f;
+        if (active) {
+            uint2 source = localId.xy * 2;
+            average = 0.25f * (g_tile[source.y][source.x] + g_tile[source.y][source.x + 1] +
+                g_tile[source.y + 1][source.x] + g_tile[source.y + 1][source.x + 1]);
+        }
+        GroupMemoryBarrierWithGroupSync();
+        if (active) {
+            g_tile[localId.y][localId.x] = average;
+            if (level <= g_mipCount) {
+                StoreLevel(level, (g_origin >> level) + groupId.xy * size + localId.xy, average);
+            }
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+}
@@ -0,0 +1,91 @@
+// GameOverlay - ThumbnailEncodeCS.hlsl
+// Downsamples the browser texture into BC1 blocks for a tab thumbnail, one 4x4 block per thread
+
+cbuffer ThumbnailEncodeConstants : register(b0)
+{
+    float2 g_texelToUv;  // Source UV per thumbnail texel
+    float2 g_uvMax;      // Painted part of the source; taps past it would read stale texels
+    uint2 g_blockCount;
+    uint g_rowPitch;     // Output bytes per row of blocks
+    float g_sourceLod;   // Mip the taps read (the copy path has only level 0)
+};
+
+Texture2D<float4> g_source : register(t0);
+RWByteAddressBuffer g_blocks : register(u0);
+SamplerState g_linearClamp : register(s0);
+
+uint PackColor565(float3 c)
+{
+    uint3 q = uint3(round(saturate(c) * float3(31.0f, 63.0f, 31.0f)));
+    return (q.r << 11) | (q.g << 5) | q.b;
+}
+
+float3 UnpackColor565(uint c)
+{
+    return float3((c >> 11) & 31, (c >> 5) & 63, c & 31) / float3(31.0f, 63.0f, 31.0f);
+}
+
+float3 LoadTexel(float2 texel)
+{
+    // Four bilinear taps, so a source several texels per thumbnail texel is averaged rather than skipped
+    float2 center = texel * g_texelToUv;
+    float2 offset = g_texelToUv * 0.25f;
+    float3 color = g_source.SampleLevel(g_linearClamp, min(center + float2(-offset.x, -offset.y), g_uvMax), g_sourceLod).rgb;
+    color += g_source.SampleLevel(g_linearClamp, min(center + float2(offset.x, -offset.y), g_uvMax), g_sourceLod).rgb;
+    color += g_source.SampleLevel(g_linearClamp, min(center + float2(-offset.x, offset.y), g_uvMax), g_sourceLod).rgb;
+    color += g_source.SampleLevel(g_linearClamp, min(center + float2(offset.x, offset.y), g_uvMax), g_sourceLod).rgb;
+    return color * 0.25f;
+}
+
+[numthreads(8, 8, 1)]
+void main(uint3 dispatchId : SV_DispatchThreadID)
+{
+    if (any(dispatchId.xy >= g_blockCount)) return;
+
+    float3 texels[16];
+    float3 minColor = 1.0f;
+    float3 maxColor = 0.0f;
+    [unroll]
+    for (uint i = 0; i < 16; i++) {
+        texels[i] = LoadTexel(float2(dispatchId.xy * 4 + uint2(i % 4, i / 4)) + 0.5f);
+        minColor = min(minColor, texels[i]);
+        maxColor = max(maxColor, texels[i]);
+    }
+
+    // Endpoints from the block's bounding box, inset by a sixteenth so one outlier doesn't stretch it
+    float3 inset = (maxColor - minColor) / 16.0f;
+    uint color0 = PackColor565(maxColor - inset);
+    uint color1 = PackColor565(minColor + inset);
+    if (color0 < color1) {
+        uint swapped = color0;
+        color0 = color1;
+        color1 = swapped;
+    }
+
+    // color0 > color1 selects four-color mode; equal endpoints leave every index at 0
+    uint indices = 0;
+    if (color0 != color1) {
+        float3 palette[4];
+        palette[0] = UnpackColor565(color0);
+        palette[1] = UnpackColor565(color1);
+        palette[2] = (2.0f * palette[0] + palette[1]) / 3.0f;
+        palette[3] = (palette[0] + 2.0f * palette[1]) / 3.0f;
+        [unroll]
+        for (uint t = 0; t < 16; t++) {
+            uint best = 0;
+            float bestDistance = 4.0f;
+            [unroll]
+            for (uint p = 0; p < 4; p++) {
+                float3 delta = texels[t] - palette[p];
+                float distance = dot(delta, delta);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+            indices |= best << (2 * t);
+        }
+    }
+
+    g_blocks.Store2(dispatchId.y * g_rowPitch + dispatchId.x * 8, uint2(color0 | (color1 << 16), indices));
+}
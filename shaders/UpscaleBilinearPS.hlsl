@@ -0,0 +1,26 @@
+// GameOverlay - UpscaleBilinearPS.hlsl
+// Bilinear upscale pixel shader
+
+cbuffer UpscaleConstants : register(b0)
+{
+    float2 g_texelSize;
+    float g_sharpness;
+    float g_outputScale;
+};
+
+Texture2D g_source : register(t0);
+SamplerState g_linearSampler : register(s0);
+
+// scRGB output: the premultiplied sRGB scene to linear, SDR white at g_outputScale
+float4 ToOutput(float4 color)
+{
+    if (g_outputScale <= 0.0f) return color;
+    float3 straight = color.rgb / max(color.a, 1e-5f);
+    float3 linearColor = lerp(straight / 12.92f, pow((straight + 0.055f) / 1.055f, 2.4f), step(0.04045f, straight));
+    return float4(linearColor * color.a * g_outputScale, color.a);
+}
+
+float4 main(float4 position : SV_POSITION, float2 texCoord : TEXCOORD) : SV_TARGET
+{
+    return ToOutput(g_source.Sample(g_linearSampler, texCoord));
+}
@@ -0,0 +1,46 @@
+// GameOverlay - UpscaleSharpenPS.hlsl
+// Sharpening upscale pixel shader: bilinear resample followed by
+// contrast-adaptive sharpening in the spirit of FSR1 RCAS
+
+cbuffer UpscaleConstants : register(b0)
+{
+    float2 g_texelSize;
+    float g_sharpness;
+    float g_outputScale;
+};
+
+Texture2D g_source : register(t0);
+SamplerState g_linearSampler : register(s0);
+
+// scRGB output: the premultiplied sRGB scene to linear, SDR white at g_outputScale
+float4 ToOutput(float4 color)
+{
+    if (g_outputScale <= 0.0f) return color;
+    float3 straight = color.rgb / max(color.a, 1e-5f);
+    float3 linearColor = lerp(straight / 12.92f, pow((straight + 0.055f) / 1.055f, 2.4f), step(0.04045f, straight));
+    return float4(linearColor * color.a * g_outputScale, color.a);
+}
+
+float4 main(float4 position : SV_POSITION, float2 texCoord : TEXCOORD) : SV_TARGET
+{
+    float4 c = g_source.Sample(g_linearSampler, texCoord);
+    float4 n = g_source.Sample(g_linearSampler, texCoord + float2(0.0f, -g_texelSize.y));
+    float4 s = g_source.Sample(g_linearSampler, texCoord + float2(0.0f, g_texelSize.y));
+    float4 w = g_source.Sample(g_linearSampler, texCoord + float2(-g_texelSize.x, 0.0f));
+    float4 e = g_source.Sample(g_linearSampler, texCoord + float2(g_texelSize.x, 0.0f));
+
+    // Limit the negative lobe so the ring never pushes outside the local min/max
+    float4 minRing = min(min(n, s), min(w, e));
+    float4 maxRing = max(max(n, s), max(w, e));
+    float4 hitMin = minRing / (4.0f * maxRing + 1e-5f);
+    float4 hitMax = (1.0f - maxRing) / (4.0f * minRing - 4.0f - 1e-5f);
+    float4 lobe4 = max(-hitMin, hitMax);
+    float lobe = max(-0.1875f, min(max(max(lobe4.r, lobe4.g), max(lobe4.b, lobe4.a)), 0.0f)) * g_sharpness;
+
+    float4 result = (lobe * (n + s + w + e) + c) / (4.0f * lobe + 1.0f);
+
+    // Stay a valid premultiplied color
+    result.a = saturate(result.a);
+    result.rgb = min(saturate(result.rgb), result.a);
+    return ToOutput(result);
+}
@@ -0,0 +1,16 @@
+// GameOverlay - UpscaleVS.hlsl
+// Fullscreen triangle vertex shader for the upscale pass (no vertex buffer)
+
+struct VSOutput
+{
+    float4 position : SV_POSITION;
+    float2 texCoord : TEXCOORD;
+};
+
+VSOutput main(uint vertexId : SV_VertexID)
+{
+    VSOutput output;
+    output.texCoord = float2((vertexId << 1) & 2, vertexId & 2);
+    output.position = float4(output.texCoord * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f), 0.0f, 1.0f);
+    return output;
+}